@@ -0,0 +1,415 @@
+/**
+ * @file HostMain.cpp
+ * @brief 主机构建的入口：基准测试和重放模糊测试输入
+ * @details 用法：
+ * - program bench [按键数]   随机按键序列的吞吐量及按状态转移表动作分类的每次耗时，
+ *                            数字格式化（含程序员模式整数）的吞吐量，
+ *                            以及批量表达式（HostLink批量求值的解析和求值部分）的吞吐量
+ * - program math [次数]      科学函数（FastMath）与libm比较：最大相对误差和每次调用的耗时
+ * - program chord            撤销/重做和直通切换组合键（Tab+⌫、Tab+=、Tab+±）经ChordFilter和TapHold
+ *                            送入计算器，检查成员键没有单独执行：撤销恢复到最后一次编辑之前，
+ *                            重做再恢复，直通切换只切换一次、不改变当前数字
+ * - program 文件...          把文件作为模糊测试输入重放（复现libFuzzer发现的崩溃）
+ * 以libFuzzer构建（HOST_FUZZER）时入口由libFuzzer提供，本文件不参与
+ *
+ * @author Calculator Project
+ */
+
+#ifndef HOST_FUZZER
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "KeyFuzz.h"
+#include "CalculatorCore.h"
+#include "ChordFilter.h"
+#include "TapHold.h"
+#include "HostDisplay.h"
+#include "NumberFormatter.h"
+#include "FastMath.h"
+#include "Expression.h"
+#include "ExpressionParser.h"
+
+static const uint32_t DEFAULT_BENCH_KEYS = 5000000;
+static const size_t BENCH_CHUNK = 4096;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 固定种子的xorshift，每次运行的按键序列相同
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// 只用短按，时间间隔固定，避免长时间停在错误或长按状态
+static void fillKeyChunk(uint8_t* chunk) {
+    uint32_t state = 0x9E3779B9;
+    for (size_t i = 0; i < BENCH_CHUNK; i++) {
+        chunk[i] = (uint8_t)(0x40 | nextRandom(state) % 22);
+    }
+}
+
+static void benchKeys(uint32_t keys) {
+    CalcDisplay display;
+    CalculatorCore core;
+    core.begin();
+    core.setDisplay(&display);
+
+    uint8_t chunk[BENCH_CHUNK];
+    fillKeyChunk(chunk);
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t handled = 0;
+    for (uint32_t done = 0; done < keys; done += BENCH_CHUNK) {
+        handled += runKeySequence(core, chunk, BENCH_CHUNK);
+    }
+    double seconds = secondsSince(start);
+    uint32_t total = (keys + BENCH_CHUNK - 1) / BENCH_CHUNK * BENCH_CHUNK;
+    printf("按键: %u 次 %.3f 秒  %.2f M次/秒  (处理 %u, 显示更新 %u, 提交 %u)\n", total, seconds,
+           total / seconds / 1e6, handled, display.updates, display.refreshes);
+}
+
+// 同一按键序列逐键计时，按按键时的状态转移表动作分类（Tab单独一类）
+static void benchKeyActions(uint32_t keys) {
+    static const char* const ACTION_NAMES[] = {
+        "NONE", "DIGIT_APPEND", "DIGIT_START", "DIGIT_FRESH", "DECIMAL_APPEND", "DECIMAL_START",
+        "DECIMAL_FRESH", "OPERATOR_PUSH", "OPERATOR_APPEND", "OPERATOR_RESTART", "FUNCTION", "CLEAR",
+        "BACKSPACE", "MEMORY", "MODE_SWITCH", "REFRESH", "PASS", "UNHANDLED", "Tab",
+    };
+    static const uint8_t TAB = (uint8_t)KeyAction::COUNT;
+    static_assert(sizeof(ACTION_NAMES) / sizeof(ACTION_NAMES[0]) == (size_t)KeyAction::COUNT + 1,
+                  "名称须与KeyAction一一对应");
+
+    CalcDisplay display;
+    CalculatorCore core;
+    core.begin();
+    core.setDisplay(&display);
+
+    uint8_t chunk[BENCH_CHUNK];
+    fillKeyChunk(chunk);
+
+    uint32_t counts[TAB + 1] = {};
+    double seconds[TAB + 1] = {};
+    for (uint32_t done = 0; done < keys; done += BENCH_CHUNK) {
+        for (size_t i = 0; i < BENCH_CHUNK; i++) {
+            uint8_t position = (chunk[i] & 0x1F) % 22 + 1;
+            uint8_t action = TAB;
+            if (position != keyboardConfig.getLayoutConfig().tabKeyPosition) {
+                const KeyConfig* key = keyboardConfig.getKeyConfig(position, keyboardConfig.getCurrentLayer());
+                if (!key) key = keyboardConfig.getKeyConfig(position, KeyLayer::PRIMARY);
+                action = (uint8_t)(key ? CalculatorCore::keyAction(core.getState(), key->type)
+                                       : KeyAction::UNHANDLED);
+            }
+            hostAdvanceMillis((chunk[i] >> 6) * 50);
+            auto start = std::chrono::steady_clock::now();
+            core.handleKeyInput(position, false);
+            seconds[action] += secondsSince(start);
+            counts[action]++;
+        }
+    }
+    for (uint8_t action = 0; action <= TAB; action++) {
+        if (counts[action] == 0) continue;
+        printf("  %-16s %8u 次  %7.0f ns/次\n", ACTION_NAMES[action], counts[action],
+               seconds[action] / counts[action] * 1e9);
+    }
+}
+
+static void benchFormat(uint32_t count) {
+    char buf[NumberFormatter::BUFFER_SIZE];
+    uint32_t state = 0x2545F491;
+    size_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        double value = (int32_t)nextRandom(state) / 1000.0;
+        sink += NumberFormatter::formatTo(value, buf, sizeof(buf));
+    }
+    double seconds = secondsSince(start);
+    printf("格式化: %u 次 %.3f 秒  %.2f M次/秒  (%zu 字符)\n", count, seconds, count / seconds / 1e6, sink);
+
+    // 程序员模式的64位整数，依次为16、10、2进制
+    static const uint8_t BASES[] = {16, 10, 2};
+    char wide[72];
+    for (uint8_t base : BASES) {
+        sink = 0;
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t value = ((uint64_t)nextRandom(state) << 32) | nextRandom(state);
+            sink += NumberFormatter::formatInteger(value, base, wide, sizeof(wide));
+        }
+        seconds = secondsSince(start);
+        printf("整数%2u进制: %u 次 %.3f 秒  %.2f M次/秒  (%zu 字符)\n", base, count, seconds,
+               count / seconds / 1e6, sink);
+    }
+}
+
+// 与HostLink相同：一批最多一帧负载的表达式文本，逐个解析求值
+static void benchEval(uint32_t count) {
+    static const size_t BATCH_SIZE = 1024;
+    char batch[BATCH_SIZE];
+    size_t length = 0;
+    uint32_t lines = 0;
+    uint32_t state = 0x9E3779B9;
+    for (;;) {
+        char line[64];
+        int n = snprintf(line, sizeof(line), "%.2f*(%u+%u.%02u)^2-%u/%u\n", (int32_t)nextRandom(state) / 100.0,
+                         nextRandom(state) % 1000, nextRandom(state) % 100, nextRandom(state) % 100,
+                         nextRandom(state) % 10000, nextRandom(state) % 97 + 1);
+        if (length + n > BATCH_SIZE) break;
+        memcpy(batch + length, line, n);
+        length += n;
+        lines++;
+    }
+
+    Expression expression;
+    uint32_t errors = 0;
+    double sink = 0.0;
+    uint32_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (total < count) {
+        size_t offset = 0;
+        while (offset < length) {
+            size_t consumed;
+            double value;
+            if (ExpressionParser::evaluate(ExpressionParser::TEXT, (const uint8_t*)batch + offset, length - offset,
+                                           consumed, expression, value) != CalculatorError::NONE) {
+                errors++;
+            } else {
+                sink += value;
+            }
+            offset += consumed;
+            total++;
+        }
+    }
+    double seconds = secondsSince(start);
+    printf("批量求值: %u 个表达式 %.3f 秒  %.2f M个/秒  (每批 %u 个, 错误 %u, 和 %g)\n", total, seconds,
+           total / seconds / 1e6, lines, errors, sink);
+}
+
+static const uint32_t DEFAULT_MATH_SAMPLES = 1000000;
+
+// 在函数的测试区间内取样，区间为正时可按对数均匀
+static void fillSamples(const FastMath::Function& fn, std::vector<double>& xs) {
+    uint32_t state = 0x6C8E9CF5;
+    for (double& x : xs) {
+        double u = nextRandom(state) / 4294967296.0;
+        x = fn.logScale ? std::exp(std::log(fn.lo) + u * (std::log(fn.hi) - std::log(fn.lo)))
+                        : fn.lo + u * (fn.hi - fn.lo);
+    }
+}
+
+template <typename Fn>
+static double nsPerCall(const std::vector<double>& xs, Fn fn) {
+    volatile double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (double x : xs) sink = sink + fn(x);
+    return secondsSince(start) * 1e9 / xs.size();
+}
+
+static int benchMath(uint32_t samples) {
+    std::vector<double> xs(samples ? samples : 1);
+    bool ok = true;
+    printf("%-6s %12s %24s %10s %10s\n", "函数", "最大相对误差", "出现在", "ns/次", "libm ns/次");
+    for (uint8_t i = 0; i < FastMath::FUNCTION_COUNT; i++) {
+        const FastMath::Function& fn = FastMath::FUNCTIONS[i];
+        fillSamples(fn, xs);
+
+        double worst = 0, worstAt = 0;
+        for (double x : xs) {
+            double expected = fn.reference(x);
+            double error = std::fabs(fn.fn(x) - expected) / std::fmax(std::fabs(expected), 1e-300);
+            if (error > worst) {
+                worst = error;
+                worstAt = x;
+            }
+        }
+        // 15位有效数字的显示需要相对误差在1e-15量级以内
+        ok &= worst < 1e-15;
+        printf("%-6s %12.3g %24.17g %10.1f %10.1f\n", fn.name, worst, worstAt,
+               nsPerCall(xs, fn.fn), nsPerCall(xs, fn.reference));
+    }
+
+    // xʸ：整数指数应精确，其余与libm比较
+    double worst = 0;
+    uint32_t state = 0x1B873593;
+    for (uint32_t i = 0; i < samples; i++) {
+        double x = std::exp((nextRandom(state) / 4294967296.0 - 0.5) * 40);
+        double y = (nextRandom(state) / 4294967296.0 - 0.5) * 40;
+        double expected = std::pow(x, y);
+        worst = std::fmax(worst, std::fabs(FastMath::pow(x, y) - expected) / expected);
+    }
+    bool exact = FastMath::pow(2, 10) == 1024 && FastMath::pow(-3, 3) == -27 && FastMath::pow(10, -2) == std::pow(10, -2);
+    ok &= exact && worst < 1e-13;
+    printf("%-6s %12.3g %24s  整数指数%s\n", "pow", worst, "", exact ? "精确" : "不精确");
+    printf("%s\n", ok ? "精度检查通过" : "精度检查失败");
+    return ok ? 0 : 1;
+}
+
+static int replay(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        FILE* f = fopen(argv[i], "rb");
+        if (!f) {
+            fprintf(stderr, "无法打开 %s\n", argv[i]);
+            return 1;
+        }
+        std::vector<uint8_t> data;
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            data.insert(data.end(), buf, buf + n);
+        }
+        fclose(f);
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+        printf("%s: %zu 个按键\n", argv[i], data.size());
+    }
+    return 0;
+}
+
+// 组合键检查：与main.cpp相同的注册和事件处理顺序（组合事件、双功能键、其余按键）
+namespace {
+
+const uint8_t KEY_TAB = 6;
+const uint8_t KEY_BACKSPACE = 15;
+const uint8_t KEY_SIGN = 20;
+const uint8_t KEY_EQUALS = 22;
+const uint8_t CHORD_UNDO = 0x20;
+const uint8_t CHORD_REDO = 0x21;
+const uint8_t CHORD_PASSTHROUGH = 0x22;
+
+class ChordRig {
+public:
+    ChordRig() : passThroughToggles(0), _chords(KEYPAD_CHORD_WINDOW_MS, onEvent, this), _pressed(0), _now(0) {
+        const uint8_t undoChord[2] = {KEY_TAB, KEY_BACKSPACE};
+        const uint8_t redoChord[2] = {KEY_TAB, KEY_EQUALS};
+        const uint8_t passThroughChord[2] = {KEY_TAB, KEY_SIGN};
+        _chords.add(undoChord, 2, CHORD_UNDO);
+        _chords.add(redoChord, 2, CHORD_REDO);
+        _chords.add(passThroughChord, 2, CHORD_PASSTHROUGH);
+        core.begin();
+        core.setDisplay(&_display);
+    }
+
+    void tap(uint8_t key) {
+        down(key);
+        wait(30);
+        up(key);
+        wait(100);
+    }
+
+    // 两个键先后按下；held为true时按住到窗口结束后才松开
+    void chord(uint8_t modifier, uint8_t key, bool held) {
+        down(modifier);
+        wait(15);
+        down(key);
+        wait(held ? KEYPAD_CHORD_WINDOW_MS : 15);
+        up(key);
+        up(modifier);
+        wait(100);
+    }
+
+    CalculatorCore core;
+    uint32_t passThroughToggles;    ///< 直通模式只记切换次数（主机上没有HID）
+
+private:
+    void down(uint8_t key) {
+        _pressed |= 1UL << (key - 1);
+        _chords.onKey(KEY_EVENT_PRESS, key, _now);
+        _chords.update(_pressed, _now);
+    }
+
+    void up(uint8_t key) {
+        _pressed &= ~(1UL << (key - 1));
+        _chords.onKey(KEY_EVENT_RELEASE, key, _now);
+        _chords.update(_pressed, _now);
+    }
+
+    void wait(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            _now++;
+            _chords.update(_pressed, _now);
+            if (uint8_t held = _tapHold.poll(_now)) core.handleKeyInput(held, true);
+        }
+    }
+
+    static void onEvent(KeyEventType type, uint8_t key, const uint8_t*, uint8_t, void* context) {
+        ChordRig* self = static_cast<ChordRig*>(context);
+        if (type == KEY_EVENT_COMBO) {
+            if (key == CHORD_UNDO) self->core.undo();
+            if (key == CHORD_REDO) self->core.redo();
+            if (key == CHORD_PASSTHROUGH) self->passThroughToggles++;
+        } else if (type == KEY_EVENT_PRESS) {
+            if (uint8_t tapped = self->_tapHold.interrupt()) self->core.handleKeyInput(tapped);
+            const KeyConfig* keyConfig = keyboardConfig.getActiveKeyConfig(key);
+            if (keyConfig && keyConfig->holdMs) {
+                self->_tapHold.press(key, keyConfig->holdMs, self->_now);
+            } else {
+                self->core.handleKeyInput(key);
+            }
+        } else if (type == KEY_EVENT_RELEASE) {
+            if (self->_tapHold.release(key)) self->core.handleKeyInput(key);
+        }
+    }
+
+    CalcDisplay _display;
+    ChordFilter _chords;
+    TapHold _tapHold;
+    uint32_t _pressed;
+    uint32_t _now;
+};
+
+bool expect(const char* what, const ChordRig& rig, const char* display) {
+    bool ok = strcmp(rig.core.getCurrentDisplay(), display) == 0 &&
+              keyboardConfig.getCurrentLayer() == KeyLayer::PRIMARY;
+    printf("%s → %s  %s\n", what, rig.core.getCurrentDisplay(), ok ? "通过" : "失败");
+    return ok;
+}
+
+int checkChords() {
+    bool ok = true;
+    for (int held = 0; held <= 1; held++) {
+        ChordRig rig;
+        // 12+34：最后一次编辑是输入4
+        const uint8_t keys[] = {4, 9, 18, 13, 3};
+        for (uint8_t key : keys) rig.tap(key);
+        printf("%s\n", held ? "按住到组合窗口结束:" : "窗口内松开:");
+        ok &= expect("  输入 12+34", rig, "34");
+        rig.chord(KEY_TAB, KEY_BACKSPACE, held);
+        ok &= expect("  Tab+⌫ 撤销", rig, "3");
+        rig.chord(KEY_TAB, KEY_EQUALS, held);
+        ok &= expect("  Tab+= 重做", rig, "34");
+        rig.chord(KEY_TAB, KEY_SIGN, held);
+        ok &= expect("  Tab+± 切换直通", rig, "34") && rig.passThroughToggles == 1;
+    }
+    printf("%s\n", ok ? "组合键检查通过" : "组合键检查失败");
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        uint32_t keys = argc >= 3 ? (uint32_t)strtoul(argv[2], nullptr, 10) : DEFAULT_BENCH_KEYS;
+        benchKeys(keys);
+        benchKeyActions(keys);
+        benchFormat(keys);
+        benchEval(keys / 10);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "math") == 0) {
+        return benchMath(argc >= 3 ? (uint32_t)strtoul(argv[2], nullptr, 10) : DEFAULT_MATH_SAMPLES);
+    }
+    if (argc >= 2 && strcmp(argv[1], "chord") == 0) {
+        return checkChords();
+    }
+    if (argc >= 2) {
+        return replay(argc, argv);
+    }
+    printf("用法: %s bench [按键数] | %s math [次数] | %s chord | %s 文件...\n", argv[0], argv[0], argv[0], argv[0]);
+    return 1;
+}
+
+#endif // HOST_FUZZER
@@ -0,0 +1,95 @@
+/**
+ * @file HostStubs.cpp
+ * @brief 主机构建中替代固件模块的最小实现
+ * @details 只实现计算逻辑链接时用到的部分：
+ * - 时钟由主机程序推进，不读系统时间，同一输入每次运行结果一致
+ * - Serial默认丢弃输出
+ * - Logger在LOG_COMPILE_LEVEL=0下只剩跟踪开关
+ * - ConfigManager只保存内存寄存器和商务比率，不落盘；汇率表总是默认表
+ * - SettingsStore没有分区：没有保存的段，写入总是成功（按键布局每次从默认表开始）
+ * - TimerWheel不计时：create()返回INVALID，start()/cancel()不做任何事
+ *
+ * @author Calculator Project
+ */
+
+#include <Arduino.h>
+#include "Logger.h"
+#include "ConfigManager.h"
+#include "SettingsStore.h"
+#include "TimerWheel.h"
+
+static uint32_t hostMillis = 0;
+
+uint32_t millis() { return hostMillis; }
+uint32_t micros() { return hostMillis * 1000; }
+void delay(uint32_t ms) { hostMillis += ms; }
+void hostAdvanceMillis(uint32_t ms) { hostMillis += ms; }
+
+HardwareSerial Serial;
+EspClass ESP;
+
+int Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    write(buf);
+    return n;
+}
+
+size_t HardwareSerial::write(const char* s) {
+    size_t n = strlen(s);
+    if (_echo) fwrite(s, 1, n, stdout);
+    return n;
+}
+
+// ---- Logger：日志在编译期去掉，只有跟踪开关 ----
+
+Logger* Logger::_instance = nullptr;
+log_level_t Logger::_slotLevel[Logger::TAG_SLOTS] = {};
+uint32_t Logger::_traceMask = 0;
+
+Logger& Logger::getInstance() { return *_instance; }
+void Logger::trace(const char*, ...) {}
+
+// ---- ConfigManager：内存寄存器只保存在内存中 ----
+
+ConfigManager& ConfigManager::getInstance() {
+    static ConfigManager instance;
+    return instance;
+}
+
+bool ConfigManager::loadMemoryRegisters(MemoryRegisterData &data) {
+    if (!_memory.count) return false;
+    data = _memory;
+    return true;
+}
+
+void ConfigManager::setMemoryRegisters(const MemoryRegisterData &data) {
+    _memory = data;
+}
+
+void ConfigManager::setTaxRate(uint32_t rate) { _config.taxRate = rate; }
+void ConfigManager::setMarkupRate(uint32_t rate) { _config.markupRate = rate; }
+void ConfigManager::setDiscountRate(uint32_t rate) { _config.discountRate = rate; }
+
+bool ConfigManager::loadCurrencyTable(CurrencyTableData &data) { return false; }
+bool ConfigManager::saveCurrencyTable(const CurrencyTableData &data) { return true; }
+
+// ---- SettingsStore：不落盘 ----
+
+SettingsStore::SettingsStore()
+    : _partition(nullptr), _mmapHandle(0), _base(nullptr), _slotCount(0), _current(nullptr), _currentSlot(0),
+      _loadUs(0), _writes(0) {}
+
+const void* SettingsStore::find(SettingsSection id, size_t& length) const { return nullptr; }
+bool SettingsStore::write(SettingsSection id, const void* data, size_t length) { return true; }
+
+// ---- TimerWheel：不计时 ----
+
+TimerWheel::TimerWheel() : _created(0), _now(0) {}
+
+TimerWheel::TimerId TimerWheel::create(const char* name, Callback callback, void* context) { return INVALID; }
+void TimerWheel::start(TimerId id, uint32_t delayMs) {}
+void TimerWheel::cancel(TimerId id) {}
@@ -0,0 +1,39 @@
+/**
+ * @file KeyFuzz.cpp
+ * @brief 按键序列模糊测试入口（libFuzzer接口）
+ * @details 每个输入字节是一次按键：
+ * - 低5位对22取模得到按键位置1-22
+ * - 第5位为长按
+ * - 高2位为距上一次按键的时间，每级50ms
+ * 每个输入从全新的CalculatorCore开始，并接上替身显示，显示更新路径也会执行。
+ * 越界、未定义行为等问题由sanitizer发现
+ *
+ * @author Calculator Project
+ */
+
+#include "KeyFuzz.h"
+#include "CalculatorCore.h"
+#include "HostDisplay.h"
+
+static const size_t MAX_KEYS_PER_INPUT = 4096;
+
+uint32_t runKeySequence(CalculatorCore& core, const uint8_t* data, size_t size) {
+    uint32_t handled = 0;
+    for (size_t i = 0; i < size; i++) {
+        uint8_t b = data[i];
+        hostAdvanceMillis((b >> 6) * 50);
+        handled += core.handleKeyInput((b & 0x1F) % 22 + 1, (b & 0x20) != 0);
+    }
+    return handled;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > MAX_KEYS_PER_INPUT) return 0;
+
+    CalcDisplay display;
+    CalculatorCore core;
+    core.begin();
+    core.setDisplay(&display);
+    runKeySequence(core, data, size);
+    return 0;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file KeyFuzz.h
+ * @brief 主机构建的按键序列驱动（模糊测试与基准共用）
+ *
+ * @author Calculator Project
+ */
+
+#ifndef KEY_FUZZ_H
+#define KEY_FUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class CalculatorCore;
+
+/**
+ * @brief 把字节序列作为按键依次送入计算器（编码见KeyFuzz.cpp）
+ * @return 处理成功的按键数
+ */
+uint32_t runKeySequence(CalculatorCore& core, const uint8_t* data, size_t size);
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+#endif // KEY_FUZZ_H
@@ -0,0 +1,306 @@
+/**
+ * @file HostGfx.cpp
+ * @brief Arduino_GFX替身的实现（host/shim/Arduino_GFX_Library.h）
+ * @details 行为按GFX Library for Arduino 1.6：公共绘制函数裁剪后调用虚函数write*Preclipped，
+ *          设备（Canvas、面板）只需实现画点，其余有默认实现
+ *
+ * @author Calculator Project
+ */
+
+#include <Arduino_GFX_Library.h>
+#include "canvas/Arduino_Canvas.h"
+
+namespace {
+
+// 标准5x7 ASCII字形（0x20~0x7E），每个字符5列，每列低位在上，第8行用于下行笔画
+const uint8_t FONT_FIRST = 0x20;
+const uint8_t FONT_LAST = 0x7E;
+const uint8_t FONT[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+    {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+    {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+    {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},
+    {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+    {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+static_assert(sizeof(FONT) / sizeof(FONT[0]) == FONT_LAST - FONT_FIRST + 1, "字形表与字符范围不一致");
+
+} // namespace
+
+// ---- Arduino_GFX ----
+
+Arduino_GFX::Arduino_GFX(int16_t w, int16_t h)
+    : Arduino_G(w, h),
+      _width(w),
+      _height(h),
+      _maxX(w - 1),
+      _maxY(h - 1),
+      _rotation(0),
+      _cursorX(0),
+      _cursorY(0),
+      _textColor(0xFFFF),
+      _textBgColor(0xFFFF),
+      _textSizeX(1),
+      _textSizeY(1),
+      _wrap(true) {
+}
+
+void Arduino_GFX::setRotation(uint8_t r) {
+    _rotation = r & 3;
+    bool swap = _rotation & 1;
+    _width = swap ? HEIGHT : WIDTH;
+    _height = swap ? WIDTH : HEIGHT;
+    _maxX = _width - 1;
+    _maxY = _height - 1;
+}
+
+void Arduino_GFX::writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t j = 0; j < h; j++) {
+        for (int16_t i = 0; i < w; i++) {
+            writePixelPreclipped(x + i, y + j, color);
+        }
+    }
+}
+
+void Arduino_GFX::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    writeFillRect(x, y, 1, h, color);
+}
+
+void Arduino_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    writeFillRect(x, y, w, 1, color);
+}
+
+void Arduino_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
+    if (x >= 0 && x < _width && y >= 0 && y < _height) {
+        writePixelPreclipped(x, y, color);
+    }
+}
+
+void Arduino_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w < 0) {
+        x += w + 1;
+        w = -w;
+    }
+    if (h < 0) {
+        y += h + 1;
+        h = -h;
+    }
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (x + w > _width) w = _width - x;
+    if (y + h > _height) h = _height - y;
+    if (w > 0 && h > 0) writeFillRectPreclipped(x, y, w, h, color);
+}
+
+void Arduino_GFX::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    startWrite();
+    writePixel(x, y, color);
+    endWrite();
+}
+
+void Arduino_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    startWrite();
+    writeFastVLine(x, y, h, color);
+    endWrite();
+}
+
+void Arduino_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    startWrite();
+    writeFastHLine(x, y, w, color);
+    endWrite();
+}
+
+void Arduino_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    startWrite();
+    writeFillRect(x, y, w, h, color);
+    endWrite();
+}
+
+void Arduino_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    startWrite();
+    writeFastHLine(x, y, w, color);
+    writeFastHLine(x, y + h - 1, w, color);
+    writeFastVLine(x, y, h, color);
+    writeFastVLine(x + w - 1, y, h, color);
+    endWrite();
+}
+
+void Arduino_GFX::draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) {
+    startWrite();
+    for (int16_t j = 0; j < h; j++) {
+        for (int16_t i = 0; i < w; i++) {
+            writePixel(x + i, y + j, bitmap[(int32_t)j * w + i]);
+        }
+    }
+    endWrite();
+}
+
+void Arduino_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg) {
+    drawChar(x, y, c, color, bg, _textSizeX, _textSizeY);
+}
+
+void Arduino_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg,
+                           uint8_t sizeX, uint8_t sizeY) {
+    if (x > _maxX || y > _maxY || x + 6 * sizeX - 1 < 0 || y + 8 * sizeY - 1 < 0) return;
+    const uint8_t *glyph = (c >= FONT_FIRST && c <= FONT_LAST) ? FONT[c - FONT_FIRST] : FONT[0];
+
+    // 与GFX相同：背景色与前景色相同时不画背景，第6列为字符间隔
+    startWrite();
+    for (int8_t i = 0; i < 6; i++) {
+        uint8_t line = i < 5 ? glyph[i] : 0;
+        for (int8_t j = 0; j < 8; j++, line >>= 1) {
+            if (line & 1) {
+                writeFillRect(x + i * sizeX, y + j * sizeY, sizeX, sizeY, color);
+            } else if (bg != color) {
+                writeFillRect(x + i * sizeX, y + j * sizeY, sizeX, sizeY, bg);
+            }
+        }
+    }
+    endWrite();
+}
+
+size_t Arduino_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        _cursorX = 0;
+        _cursorY += (int16_t)_textSizeY * 8;
+    } else if (c != '\r') {
+        if (_wrap && _cursorX + _textSizeX * 6 - 1 > _maxX) {
+            _cursorX = 0;
+            _cursorY += (int16_t)_textSizeY * 8;
+        }
+        drawChar(_cursorX, _cursorY, c, _textColor, _textBgColor);
+        _cursorX += (int16_t)_textSizeX * 6;
+    }
+    return 1;
+}
+
+size_t Arduino_GFX::write(const char *s) {
+    size_t n = 0;
+    for (; s && *s; s++) n += write((uint8_t)*s);
+    return n;
+}
+
+// ---- Arduino_TFT ----
+
+Arduino_TFT::Arduino_TFT(Arduino_DataBus *bus, int8_t rst, uint8_t r, bool ips, int16_t w, int16_t h,
+                         uint8_t colOffset1, uint8_t rowOffset1, uint8_t colOffset2, uint8_t rowOffset2)
+    : Arduino_GFX(w, h),
+      _bus(bus) {
+    setRotation(r);
+}
+
+bool Arduino_TFT::begin(int32_t speed) {
+    return speed == GFX_SKIP_OUTPUT_BEGIN || _bus->begin(speed);
+}
+
+void Arduino_TFT::writePixelPreclipped(int16_t x, int16_t y, uint16_t color) {
+    writeAddrWindow(x, y, 1, 1);
+    _bus->writePixels(&color, 1);
+}
+
+void Arduino_TFT::writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    writeAddrWindow(x, y, w, h);
+    for (int32_t i = (int32_t)w * h; i > 0; i--) {
+        _bus->writePixels(&color, 1);
+    }
+}
+
+void Arduino_TFT::draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) {
+    if (x < 0 || y < 0 || x + w > _width || y + h > _height) {
+        Arduino_GFX::draw16bitRGBBitmap(x, y, bitmap, w, h);
+        return;
+    }
+    startWrite();
+    writeAddrWindow(x, y, w, h);
+    _bus->writePixels(bitmap, (uint32_t)w * h);
+    endWrite();
+}
+
+// ---- Arduino_Canvas ----
+
+Arduino_Canvas::Arduino_Canvas(int16_t w, int16_t h, Arduino_G *output, int16_t outputX, int16_t outputY,
+                               uint8_t rotation)
+    : Arduino_GFX(w, h),
+      _framebuffer(nullptr),
+      _output(output),
+      _output_x(outputX),
+      _output_y(outputY) {
+    setRotation(rotation);
+}
+
+Arduino_Canvas::~Arduino_Canvas() {
+    free(_framebuffer);
+    _framebuffer = nullptr;
+}
+
+bool Arduino_Canvas::begin(int32_t speed) {
+    if (speed != GFX_SKIP_OUTPUT_BEGIN && _output && !_output->begin(speed)) return false;
+    if (!_framebuffer) {
+        _framebuffer = (uint16_t *)calloc((size_t)WIDTH * HEIGHT, sizeof(uint16_t));
+    }
+    return _framebuffer != nullptr;
+}
+
+void Arduino_Canvas::writePixelPreclipped(int16_t x, int16_t y, uint16_t color) {
+    // 旋转后的坐标换算到缓冲（未旋转）坐标
+    int16_t px = x, py = y;
+    switch (_rotation) {
+        case 1: px = WIDTH - 1 - y; py = x; break;
+        case 2: px = WIDTH - 1 - x; py = HEIGHT - 1 - y; break;
+        case 3: px = y; py = HEIGHT - 1 - x; break;
+        default: break;
+    }
+    _framebuffer[(int32_t)py * WIDTH + px] = color;
+}
+
+void Arduino_Canvas::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    writeFillRect(x, y, 1, h, color);
+}
+
+void Arduino_Canvas::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    writeFillRect(x, y, w, 1, color);
+}
+
+void Arduino_Canvas::writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    Arduino_GFX::writeFillRectPreclipped(x, y, w, h, color);
+}
+
+void Arduino_Canvas::draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) {
+    Arduino_GFX::draw16bitRGBBitmap(x, y, bitmap, w, h);
+}
+
+void Arduino_Canvas::flush(void) {
+    if (_output) _output->draw16bitRGBBitmap(_output_x, _output_y, _framebuffer, WIDTH, HEIGHT);
+}
@@ -0,0 +1,50 @@
+/**
+ * @file HostPanel.cpp
+ * @brief 面板和总线替身的实现
+ *
+ * @author Calculator Project
+ */
+
+#include "HostPanel.h"
+
+HostBus::HostBus(int16_t width, int16_t height)
+    : _width(width),
+      _height(height),
+      _gram((size_t)width * height, 0),
+      _winX(0),
+      _winY(0),
+      _winW(width),
+      _winH(height),
+      _cursor(0) {
+}
+
+void HostBus::setWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    _winX = x;
+    _winY = y;
+    _winW = w;
+    _winH = h;
+    _cursor = 0;
+    _stats.windows++;
+}
+
+void HostBus::writePixels(uint16_t *data, uint32_t len) {
+    // 超出窗口的像素面板会回到窗口开头，这里同样处理
+    uint32_t area = (uint32_t)_winW * _winH;
+    if (!area) return;
+    for (uint32_t i = 0; i < len; i++) {
+        int16_t x = _winX + _cursor % _winW;
+        int16_t y = _winY + _cursor / _winW;
+        if (++_cursor >= area) _cursor = 0;
+        _stats.pixels++;
+        if (x < 0 || y < 0 || x >= _width || y >= _height) continue;
+        uint16_t &cell = _gram[(size_t)y * _width + x];
+        if (cell == data[i]) _stats.unchanged++;
+        cell = data[i];
+    }
+}
+
+BusStats HostBus::takeStats() {
+    BusStats stats = _stats;
+    _stats = BusStats();
+    return stats;
+}
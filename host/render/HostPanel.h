@@ -0,0 +1,74 @@
+/**
+ * @file HostPanel.h
+ * @brief 渲染模拟器的面板和总线替身：GRAM在内存中，按帧统计推送量
+ * @details RegionCanvas把区域经 writeAddrWindow() + writePixels() 推送到这里，与设备上经SPI写入
+ *          ST7789的GRAM一致：地址窗口内按行依次写入，写满一行换到窗口的下一行。
+ *          统计的是总线上的量（像素、字节、地址窗口），以及推送的像素中GRAM原本就是同样颜色的个数
+ *          （白推的部分，脏区域划得比实际变化大时出现）
+ *
+ * @author Calculator Project
+ */
+
+#ifndef HOST_PANEL_H
+#define HOST_PANEL_H
+
+#include <Arduino_GFX_Library.h>
+#include <vector>
+
+/**
+ * @brief 一帧（一次或多次推送之间）的总线统计
+ */
+struct BusStats {
+    uint32_t windows = 0;       ///< 设置地址窗口的次数
+    uint32_t pixels = 0;        ///< 推送的像素
+    uint32_t unchanged = 0;     ///< 推送的像素中GRAM已经是同样颜色的
+    uint32_t commands = 0;      ///< 其他命令（SLPIN/SLPOUT等）
+
+    uint32_t bytes() const { return pixels * 2; }
+};
+
+class HostBus : public Arduino_DataBus {
+public:
+    HostBus(int16_t width, int16_t height);
+
+    void writeCommand(uint8_t c) override { _stats.commands++; }
+    void writeC8D8(uint8_t c, uint8_t d) override { _stats.commands++; }
+    void writePixels(uint16_t *data, uint32_t len) override;
+
+    /**
+     * @brief 设置地址窗口，之后写入的像素从窗口左上角开始
+     */
+    void setWindow(int16_t x, int16_t y, uint16_t w, uint16_t h);
+
+    const uint16_t *gram() const { return _gram.data(); }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    /**
+     * @brief 取出自上次调用以来的统计并清零
+     */
+    BusStats takeStats();
+
+private:
+    int16_t _width, _height;
+    std::vector<uint16_t> _gram;
+    int16_t _winX, _winY;
+    uint16_t _winW, _winH;
+    uint32_t _cursor;           ///< 窗口内下一个像素的序号
+    BusStats _stats;
+};
+
+class HostPanel : public Arduino_TFT {
+public:
+    HostPanel(HostBus *bus, int16_t width, int16_t height)
+        : Arduino_TFT(bus, GFX_NOT_DEFINED, 0, false, width, height), _hostBus(bus) {}
+
+    void writeAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) override {
+        _hostBus->setWindow(x, y, w, h);
+    }
+
+private:
+    HostBus *_hostBus;
+};
+
+#endif // HOST_PANEL_H
@@ -0,0 +1,156 @@
+/**
+ * @file PngFile.cpp
+ * @brief PNG读写的实现
+ *
+ * @author Calculator Project
+ */
+
+#include "PngFile.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+const size_t STORED_BLOCK = 65535;      // 不压缩的deflate块最多65535字节
+
+uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length) {
+    static uint32_t table[256];
+    if (!table[1]) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t *data, size_t length) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < length; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+void putBe32(std::vector<uint8_t> &out, uint32_t v) {
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+uint32_t getBe32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+void putChunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data) {
+    putBe32(out, data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putBe32(out, crc32(0, &out[start], out.size() - start));
+}
+
+} // namespace
+
+bool writePng(const char *path, const uint16_t *pixels, int width, int height) {
+    // 每行：过滤类型0 + RGB，5/6位分量按高位复制展开，读回时右移即可还原
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)(width * 3 + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        for (int x = 0; x < width; x++) {
+            uint16_t c = pixels[(size_t)y * width + x];
+            uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+            raw.push_back((r << 3) | (r >> 2));
+            raw.push_back((g << 2) | (g >> 4));
+            raw.push_back((b << 3) | (b >> 2));
+        }
+    }
+
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    for (size_t offset = 0; offset < raw.size(); offset += STORED_BLOCK) {
+        size_t length = raw.size() - offset < STORED_BLOCK ? raw.size() - offset : STORED_BLOCK;
+        zlib.push_back(offset + length >= raw.size() ? 1 : 0);
+        zlib.push_back(length);
+        zlib.push_back(length >> 8);
+        zlib.push_back(~length);
+        zlib.push_back(~length >> 8);
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    }
+    putBe32(zlib, adler32(raw.data(), raw.size()));
+
+    std::vector<uint8_t> header;
+    putBe32(header, width);
+    putBe32(header, height);
+    header.insert(header.end(), {8, 2, 0, 0, 0});     // 8位RGB，不隔行
+
+    std::vector<uint8_t> file(SIGNATURE, SIGNATURE + sizeof(SIGNATURE));
+    putChunk(file, "IHDR", header);
+    putChunk(file, "IDAT", zlib);
+    putChunk(file, "IEND", std::vector<uint8_t>());
+
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(file.data(), 1, file.size(), f) == file.size();
+    return fclose(f) == 0 && ok;
+}
+
+bool readPng(const char *path, std::vector<uint16_t> &pixels, int &width, int &height) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> file;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) file.insert(file.end(), buffer, buffer + n);
+    fclose(f);
+    if (file.size() < sizeof(SIGNATURE) || memcmp(file.data(), SIGNATURE, sizeof(SIGNATURE)) != 0) return false;
+
+    std::vector<uint8_t> zlib;
+    width = height = 0;
+    for (size_t pos = sizeof(SIGNATURE); pos + 12 <= file.size();) {
+        uint32_t length = getBe32(&file[pos]);
+        if (pos + 12 + length > file.size()) return false;
+        const uint8_t *type = &file[pos + 4];
+        const uint8_t *data = &file[pos + 8];
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13 || data[8] != 8 || data[9] != 2 || data[12] != 0) return false;
+            width = getBe32(data);
+            height = getBe32(data + 4);
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            zlib.insert(zlib.end(), data, data + length);
+        }
+        pos += 12 + length;
+    }
+    if (width <= 0 || height <= 0 || zlib.size() < 2) return false;
+
+    std::vector<uint8_t> raw;
+    for (size_t pos = 2;;) {
+        if (pos + 5 > zlib.size() || (zlib[pos] & 0x06) != 0) return false;     // 只接受存储块
+        bool last = zlib[pos] & 1;
+        size_t length = zlib[pos + 1] | (zlib[pos + 2] << 8);
+        pos += 5;
+        if (pos + length > zlib.size()) return false;
+        raw.insert(raw.end(), zlib.begin() + pos, zlib.begin() + pos + length);
+        pos += length;
+        if (last) break;
+    }
+    size_t stride = (size_t)width * 3 + 1;
+    if (raw.size() != stride * height) return false;
+
+    pixels.resize((size_t)width * height);
+    for (int y = 0; y < height; y++) {
+        const uint8_t *row = &raw[y * stride];
+        if (row[0] != 0) return false;
+        for (int x = 0; x < width; x++) {
+            const uint8_t *p = row + 1 + x * 3;
+            pixels[(size_t)y * width + x] = (uint16_t)(((p[0] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[2] >> 3));
+        }
+    }
+    return true;
+}
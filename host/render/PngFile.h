@@ -0,0 +1,28 @@
+/**
+ * @file PngFile.h
+ * @brief RGB565画面与PNG文件之间的转换（不依赖zlib）
+ * @details 写出的PNG为8位RGB，zlib数据只用不压缩的存储块（480x135的画面约190 KB），
+ *          任何看图工具都能打开。读取只支持本模块写出的文件（存储块），用于与参考截图逐像素比较
+ *
+ * @author Calculator Project
+ */
+
+#ifndef PNG_FILE_H
+#define PNG_FILE_H
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @brief 把RGB565画面写成PNG
+ * @return 文件无法写入时返回false
+ */
+bool writePng(const char *path, const uint16_t *pixels, int width, int height);
+
+/**
+ * @brief 读取writePng()写出的PNG，转回RGB565
+ * @return 文件不存在、格式不符（如压缩过的PNG）时返回false
+ */
+bool readPng(const char *path, std::vector<uint16_t> &pixels, int &width, int &height);
+
+#endif // PNG_FILE_H
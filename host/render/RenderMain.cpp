@@ -0,0 +1,267 @@
+/**
+ * @file RenderMain.cpp
+ * @brief 渲染模拟器的入口：把真实的CalcDisplay画到内存中的面板，逐帧统计并保存PNG截图
+ * @details 与固件相同的CalcDisplay、RegionCanvas、字形缓存和动画代码（同步模式，不启动渲染任务），
+ *          面板和总线由HostPanel替代。时钟由本程序推进：每个按键之后按1 ms步进调用tick()，
+ *          直到动画结束、所有修改推送完毕，帧率上限与设备上一致。
+ *
+ * 用法：program <按键序列> [--out 目录] [--ref 目录]
+ * - 按键序列按主层按键符号逐个匹配（如 12+3=）；别名 * / < n t 分别为 × ÷ ⌫ ± Tab，
+ *   前缀 _ 表示长按下一个键
+ * - 每一帧输出：Canvas中与上一帧不同的像素、推送的像素和字节、地址窗口数、推送了但GRAM没变的像素
+ * - 每个按键结束后检查GRAM与Canvas是否一致（不一致说明有修改漏推送）
+ * - --out：初始画面和每个按键结束后的GRAM保存为 目录/NNN.png（000为初始画面），目录不存在时逐级创建
+ * - --ref：与另一次--out保存的截图逐像素比较，有不同时返回1
+ *
+ * Canvas中变化的像素按帧前后的内容比较得出：字形缓存、行平移和像素内核直接写帧缓冲，
+ * 不经过GFX的画点函数，无法逐次计数
+ *
+ * @author Calculator Project
+ */
+
+#include <sys/stat.h>
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "CalculatorCore.h"
+#include "KeyboardConfig.h"
+#include "RegionCanvas.h"
+#include "calc_display.h"
+#include "HostPanel.h"
+#include "PngFile.h"
+
+RegionCanvas *canvas = nullptr;
+
+namespace {
+
+const uint32_t SETTLE_LIMIT_MS = 5000;      // 一个按键之后最多模拟的时间
+
+struct KeyAlias {
+    char alias;
+    const char *symbol;
+};
+
+const KeyAlias ALIASES[] = {
+    {'*', "×"}, {'/', "÷"}, {'<', "⌫"}, {'n', "±"}, {'t', "TAB"},
+};
+
+struct FrameStats {
+    uint8_t regions = 0;        ///< 本帧推送的矩形数（合并、扩展为整行之后）
+    uint32_t changed = 0;       ///< Canvas中与上一帧不同的像素
+};
+
+struct Simulator {
+    HostBus bus;
+    HostPanel panel;
+    std::vector<uint16_t> shown;    ///< 上一帧推送时的Canvas内容
+    FrameStats frame;
+    bool framed = false;            ///< 自上次取出以来是否有一帧
+
+    Simulator() : bus(DISPLAY_WIDTH, DISPLAY_HEIGHT), panel(&bus, DISPLAY_WIDTH, DISPLAY_HEIGHT),
+                  shown((size_t)DISPLAY_WIDTH * DISPLAY_HEIGHT, 0) {}
+
+    // 推送前由RegionCanvas调用：此时Canvas已是这一帧的内容
+    static void onRegions(const DirtyRegions &regions, void *ctx) {
+        Simulator *self = static_cast<Simulator *>(ctx);
+        std::vector<uint16_t> row(DISPLAY_WIDTH);
+        uint32_t changed = 0;
+        for (int16_t y = 0; y < DISPLAY_HEIGHT; y++) {
+            canvas->readPixels(0, y, DISPLAY_WIDTH, row.data());
+            uint16_t *prev = &self->shown[(size_t)y * DISPLAY_WIDTH];
+            for (int16_t x = 0; x < DISPLAY_WIDTH; x++) {
+                if (prev[x] != row[x]) changed++;
+                prev[x] = row[x];
+            }
+        }
+        self->frame.regions += regions.count();
+        self->frame.changed += changed;
+        self->framed = true;
+    }
+
+    // GRAM与Canvas不同的像素数
+    uint32_t stalePixels() const {
+        std::vector<uint16_t> row(DISPLAY_WIDTH);
+        uint32_t stale = 0;
+        for (int16_t y = 0; y < DISPLAY_HEIGHT; y++) {
+            canvas->readPixels(0, y, DISPLAY_WIDTH, row.data());
+            const uint16_t *gram = bus.gram() + (size_t)y * DISPLAY_WIDTH;
+            for (int16_t x = 0; x < DISPLAY_WIDTH; x++) {
+                if (gram[x] != row[x]) stale++;
+            }
+        }
+        return stale;
+    }
+};
+
+struct Totals {
+    uint32_t frames = 0;
+    uint32_t changed = 0;
+    uint64_t pixels = 0;
+    uint64_t unchanged = 0;
+    uint32_t windows = 0;
+};
+
+// 有一帧推送过时输出这一帧的统计
+void reportFrame(Simulator &sim, Totals &totals, uint32_t atMs) {
+    if (!sim.framed) return;
+    BusStats bus = sim.bus.takeStats();
+    printf("    帧 %-3u %5u ms  区域 %u  变化 %6u 像素  推送 %6u 像素 %7u 字节  窗口 %u  白推 %6u 像素\n",
+           totals.frames + 1, atMs, sim.frame.regions, sim.frame.changed, bus.pixels, bus.bytes(), bus.windows,
+           bus.unchanged);
+    totals.frames++;
+    totals.changed += sim.frame.changed;
+    totals.pixels += bus.pixels;
+    totals.unchanged += bus.unchanged;
+    totals.windows += bus.windows;
+    sim.frame = FrameStats();
+    sim.framed = false;
+}
+
+// 按1 ms推进时钟并调度帧，直到显示空闲
+void settle(CalcDisplay &display, Simulator &sim, Totals &totals) {
+    uint32_t start = millis();
+    reportFrame(sim, totals, 0);
+    while (!display.waitIdle(0)) {
+        reportFrame(sim, totals, millis() - start);
+        if (millis() - start >= SETTLE_LIMIT_MS) {
+            printf("    %u ms 后仍未空闲（动画没有结束？）\n", SETTLE_LIMIT_MS);
+            break;
+        }
+        hostAdvanceMillis(1);
+    }
+    reportFrame(sim, totals, millis() - start);
+}
+
+// 从序列开头匹配一个按键，返回消耗的字节数，没有匹配时返回0
+size_t matchKey(const char *text, uint8_t &position) {
+    const char *symbol = nullptr;
+    for (const KeyAlias &alias : ALIASES) {
+        if (*text == alias.alias) symbol = alias.symbol;
+    }
+    size_t best = 0;
+    for (uint8_t p = 1; p <= 22; p++) {
+        const KeyConfig *key = keyboardConfig.getKeyConfig(p, KeyLayer::PRIMARY);
+        if (!key || !key->symbol || !key->symbol[0]) continue;
+        size_t length = strlen(key->symbol);
+        if (symbol ? strcmp(symbol, key->symbol) == 0 : strncmp(text, key->symbol, length) == 0 && length > best) {
+            position = p;
+            best = symbol ? 1 : length;
+            if (symbol) break;
+        }
+    }
+    return best;
+}
+
+// 逐级创建目录（同mkdir -p），已存在不算错误
+bool makeDirs(const std::string &dir) {
+    for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1)) {
+        std::string part = dir.substr(0, pos);
+        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) {
+            printf("无法创建目录 %s: %s\n", part.c_str(), strerror(errno));
+            return false;
+        }
+        if (pos == std::string::npos) return true;
+    }
+}
+
+bool saveShot(const std::string &dir, uint32_t index, const HostBus &bus) {
+    if (dir.empty()) return true;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%03u.png", dir.c_str(), index);
+    if (writePng(path, bus.gram(), bus.width(), bus.height())) return true;
+    printf("无法写入 %s\n", path);
+    return false;
+}
+
+// 与参考截图比较，返回是否一致
+bool compareShot(const std::string &dir, uint32_t index, const HostBus &bus) {
+    if (dir.empty()) return true;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%03u.png", dir.c_str(), index);
+    std::vector<uint16_t> ref;
+    int width, height;
+    if (!readPng(path, ref, width, height) || width != bus.width() || height != bus.height()) {
+        printf("  参考截图 %s 缺失或尺寸不符\n", path);
+        return false;
+    }
+    uint32_t diff = 0;
+    for (size_t i = 0; i < ref.size(); i++) {
+        if (ref[i] != bus.gram()[i]) diff++;
+    }
+    if (diff) printf("  与参考截图 %s 有 %u 个像素不同\n", path, diff);
+    return diff == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const char *keys = nullptr;
+    std::string outDir, refDir;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (strcmp(argv[i], "--ref") == 0 && i + 1 < argc) {
+            refDir = argv[++i];
+        } else if (!keys) {
+            keys = argv[i];
+        } else {
+            keys = nullptr;
+            break;
+        }
+    }
+    if (!keys) {
+        printf("用法: %s <按键序列> [--out 目录] [--ref 目录]\n", argv[0]);
+        return 2;
+    }
+    if (!outDir.empty() && !makeDirs(outDir)) return 2;
+
+    Simulator sim;
+    canvas = new RegionCanvas(DISPLAY_WIDTH, DISPLAY_HEIGHT, &sim.panel, &sim.bus);
+    canvas->begin(GFX_SKIP_OUTPUT_BEGIN);
+    canvas->setRegionsCallback(Simulator::onRegions, &sim);
+
+    Totals totals;
+    bool same = true;
+    printf("初始画面\n");
+    CalcDisplay display(canvas, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    CalculatorCore core;
+    core.begin();
+    core.setDisplay(&display);
+    settle(display, sim, totals);
+    saveShot(outDir, 0, sim.bus);
+    same = compareShot(refDir, 0, sim.bus) && same;
+
+    uint32_t index = 0;
+    double hostSeconds = 0;
+    for (const char *p = keys; *p;) {
+        bool longPress = *p == '_';
+        if (longPress) p++;
+        uint8_t position = 0;
+        size_t used = *p ? matchKey(p, position) : 0;
+        if (!used) {
+            printf("无法识别的按键: %s\n", p);
+            return 2;
+        }
+        index++;
+        printf("按键 %u: %.*s%s（位置 %u）\n", index, (int)used, p, longPress ? " 长按" : "", position);
+        p += used;
+
+        auto start = std::chrono::steady_clock::now();
+        core.handleKeyInput(position, longPress);
+        settle(display, sim, totals);
+        hostSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint32_t stale = sim.stalePixels();
+        if (stale) printf("  GRAM与Canvas有 %u 个像素不一致（修改没有推送）\n", stale);
+        saveShot(outDir, index, sim.bus);
+        same = compareShot(refDir, index, sim.bus) && same;
+    }
+
+    printf("合计: %u 个按键 %u 帧，变化 %u 像素，推送 %llu 像素 %llu 字节（白推 %.1f%%），地址窗口 %u\n", index,
+           totals.frames, totals.changed, (unsigned long long)totals.pixels,
+           (unsigned long long)totals.pixels * 2, totals.pixels ? totals.unchanged * 100.0 / totals.pixels : 0.0,
+           totals.windows);
+    if (index) printf("主机上每个按键的绘制耗时（含模拟的帧调度）: %.1f us\n", hostSeconds / index * 1e6);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file RenderStubs.cpp
+ * @brief 渲染模拟器额外需要的固件模块替身（计算逻辑用到的在 host/HostStubs.cpp）
+ * @details
+ * - PowerLock：主机上没有调频，begin()返回false，之后为空操作（与库未启用电源管理时一致）
+ * - AllocTracer：不跟踪分配，ALLOC_TAG只保留作用域名的嵌套
+ *
+ * @author Calculator Project
+ */
+
+#include "PowerManager.h"
+#include "AllocTracer.h"
+
+bool PowerLock::begin(const char*) { return false; }
+void PowerLock::acquire() {}
+void PowerLock::release() {}
+
+static const char* hostAllocTag = nullptr;
+
+const char* AllocTracer::pushTag(const char* tag) {
+    const char* previous = hostAllocTag;
+    hostAllocTag = tag;
+    return previous;
+}
+
+void AllocTracer::popTag(const char* previous) { hostAllocTag = previous; }
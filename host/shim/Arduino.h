@@ -0,0 +1,172 @@
+/**
+ * @file Arduino.h
+ * @brief 主机构建用的Arduino最小替身
+ * @details 只提供计算逻辑和显示代码用到的部分：String、millis/micros/delay、Print/Stream、
+ *          空操作的引脚函数、ESP.getCycleCount()和常用宏。
+ *          时间由主机程序推进（hostAdvanceMillis），同一输入序列每次运行结果一致
+ *
+ * @author Calculator Project
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include "freertos/FreeRTOS.h"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define PROGMEM
+#define F(s) (s)
+
+using std::min;
+using std::max;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void hostAdvanceMillis(uint32_t ms);    ///< 推进主机构建的时钟
+
+// 引脚：主机上没有硬件，全部为空操作（常量不用宏，不与计算逻辑中的同名枚举值冲突）
+const uint8_t INPUT = 0x01;
+const uint8_t OUTPUT = 0x03;
+const int RISING = 0x01;
+const int FALLING = 0x02;
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return 0; }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterruptArg(uint8_t, void (*)(void*), void*, int) {}
+inline void detachInterrupt(uint8_t) {}
+
+class EspClass {
+public:
+    uint32_t getCycleCount() { return micros() * 240; }     ///< 按240 MHz由主机时钟换算
+};
+
+extern EspClass ESP;
+
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    explicit String(int value) : _s(std::to_string(value)) {}
+    explicit String(unsigned int value) : _s(std::to_string(value)) {}
+    explicit String(long value) : _s(std::to_string(value)) {}
+    explicit String(unsigned long value) : _s(std::to_string(value)) {}
+    String(double value, unsigned int decimals = 2) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+        _s = buf;
+    }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return (unsigned int)_s.size(); }
+    bool isEmpty() const { return _s.empty(); }
+    char charAt(unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    void remove(unsigned int index) { if (index < _s.size()) _s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < _s.size()) _s.erase(index, count); }
+    void reserve(unsigned int size) { _s.reserve(size); }
+    void trim() {
+        size_t b = _s.find_first_not_of(" \t\r\n");
+        size_t e = _s.find_last_not_of(" \t\r\n");
+        _s = b == std::string::npos ? std::string() : _s.substr(b, e - b + 1);
+    }
+
+    String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < to && from < _s.size() ? String(_s.substr(from, to - from)) : String();
+    }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t i = _s.find(c, from);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    int indexOf(const char* s, unsigned int from = 0) const {
+        size_t i = _s.find(s, from);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    bool startsWith(const char* s) const { return _s.compare(0, strlen(s), s) == 0; }
+    bool endsWith(const char* s) const {
+        size_t n = strlen(s);
+        return n <= _s.size() && _s.compare(_s.size() - n, n, s) == 0;
+    }
+    bool equals(const char* s) const { return _s == s; }
+
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return (float)atof(_s.c_str()); }
+    double toDouble() const { return atof(_s.c_str()); }
+
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { _s += s; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    bool concat(const char* s) { _s += s; return true; }
+
+    friend String operator+(String a, const String& b) { return a += b; }
+    friend String operator+(String a, const char* b) { return a += b; }
+    friend String operator+(String a, char b) { return a += b; }
+    friend String operator+(const char* a, const String& b) { return String(a) += b; }
+    bool operator==(const String& s) const { return _s == s._s; }
+    bool operator==(const char* s) const { return _s == s; }
+    bool operator!=(const String& s) const { return _s != s._s; }
+    bool operator!=(const char* s) const { return _s != s; }
+    bool operator<(const String& s) const { return _s < s._s; }
+
+private:
+    std::string _s;
+};
+
+/**
+ * @brief 文本输出接口（Serial默认丢弃输出，setEcho(true)后写到stdout）
+ */
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(const char* s) = 0;
+
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { char s[2] = {c, 0}; return write(s); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int decimals = 2) { return printf("%.*f", decimals, v); }
+    size_t println() { return write("\n"); }
+    template <typename T> size_t println(T v) { return print(v) + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    void flush() {}
+    void setEcho(bool echo) { _echo = echo; }
+    size_t write(const char* s) override;
+    explicit operator bool() const { return true; }
+
+private:
+    bool _echo = false;
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H
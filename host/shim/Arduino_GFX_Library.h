@@ -0,0 +1,124 @@
+/**
+ * @file Arduino_GFX_Library.h
+ * @brief 主机构建用的Arduino_GFX替身（渲染模拟器 host/render 使用）
+ * @details 只提供固件显示代码用到的部分，类层次和虚函数与GFX Library for Arduino 1.6一致：
+ * - Arduino_GFX：裁剪、矩形/线、内置6x8字体（标准5x7 ASCII字形，0x20~0x7E以外为空白）
+ * - Arduino_TFT：writeAddrWindow()由具体面板实现，整帧位图经总线writePixels()发送
+ * - Arduino_Canvas：内存中的RGB565帧缓冲，支持旋转，flush()整帧交给输出设备
+ * - Arduino_DataBus：默认什么都不发送，模拟器的总线替身在writePixels()中写入面板GRAM
+ *
+ * @author Calculator Project
+ */
+
+#ifndef ARDUINO_GFX_LIBRARY_H
+#define ARDUINO_GFX_LIBRARY_H
+
+#include <Arduino.h>
+
+#define GFX_NOT_DEFINED -1
+#define GFX_SKIP_OUTPUT_BEGIN -2
+
+#define RGB565(r, g, b) ((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3))
+
+class Arduino_DataBus {
+public:
+    virtual ~Arduino_DataBus() {}
+
+    virtual bool begin(int32_t speed = GFX_NOT_DEFINED, int8_t dataMode = GFX_NOT_DEFINED) { return true; }
+    virtual void beginWrite() {}
+    virtual void endWrite() {}
+    virtual void writeCommand(uint8_t c) {}
+    virtual void writeC8D8(uint8_t c, uint8_t d) {}
+    virtual void writePixels(uint16_t *data, uint32_t len) {}
+
+    void sendCommand(uint8_t c) {
+        beginWrite();
+        writeCommand(c);
+        endWrite();
+    }
+};
+
+class Arduino_G {
+public:
+    Arduino_G(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {}
+    virtual ~Arduino_G() {}
+
+    virtual bool begin(int32_t speed = GFX_NOT_DEFINED) = 0;
+    virtual void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) = 0;
+
+protected:
+    int16_t WIDTH, HEIGHT;      ///< 未旋转时的宽高
+};
+
+class Arduino_GFX : public Print, public Arduino_G {
+public:
+    Arduino_GFX(int16_t w, int16_t h);
+
+    // 具体设备实现
+    virtual void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void startWrite() {}
+    virtual void endWrite() {}
+    virtual void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void setRotation(uint8_t r);
+    void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override;
+
+    void writePixel(int16_t x, int16_t y, uint16_t color);
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    // 内置字体：每个字符6x8（5x7字形加一列间隔），按字号整数倍放大
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t sizeX, uint8_t sizeY);
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+    void setTextSize(uint8_t s) { setTextSize(s, s); }
+    void setTextSize(uint8_t sx, uint8_t sy) { _textSizeX = sx ? sx : 1; _textSizeY = sy ? sy : 1; }
+    void setTextColor(uint16_t c) { _textColor = _textBgColor = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { _textColor = c; _textBgColor = bg; }
+    void setTextWrap(bool wrap) { _wrap = wrap; }
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+
+    size_t write(const char *s) override;
+    size_t write(uint8_t c);
+
+    uint8_t getRotation() const { return _rotation; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+protected:
+    int16_t _width, _height;    ///< 旋转后的宽高
+    int16_t _maxX, _maxY;
+    uint8_t _rotation;
+    int16_t _cursorX, _cursorY;
+    uint16_t _textColor, _textBgColor;
+    uint8_t _textSizeX, _textSizeY;
+    bool _wrap;
+};
+
+class Arduino_TFT : public Arduino_GFX {
+public:
+    Arduino_TFT(Arduino_DataBus *bus, int8_t rst, uint8_t r, bool ips, int16_t w, int16_t h,
+                uint8_t colOffset1 = 0, uint8_t rowOffset1 = 0, uint8_t colOffset2 = 0, uint8_t rowOffset2 = 0);
+
+    bool begin(int32_t speed = GFX_NOT_DEFINED) override;
+    void startWrite() override { _bus->beginWrite(); }
+    void endWrite() override { _bus->endWrite(); }
+    void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override;
+    void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override;
+
+    virtual void writeAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) = 0;
+
+protected:
+    Arduino_DataBus *_bus;
+};
+
+#endif // ARDUINO_GFX_LIBRARY_H
@@ -0,0 +1,17 @@
+/**
+ * @file FastLED.h
+ * @brief 主机构建用的FastLED替身：只有config.h声明LED数组所需的CRGB
+ *
+ * @author Calculator Project
+ */
+
+#ifndef FASTLED_H
+#define FASTLED_H
+
+#include <stdint.h>
+
+struct CRGB {
+    uint8_t r, g, b;
+};
+
+#endif // FASTLED_H
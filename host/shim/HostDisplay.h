@@ -0,0 +1,37 @@
+/**
+ * @file HostDisplay.h
+ * @brief 主机构建用的CalcDisplay替身
+ * @details 与calc_display.h中CalculatorCore用到的接口一致，只统计调用次数，不绘制。
+ *          主机程序可以把它交给setDisplay()，让显示更新路径也被执行
+ *
+ * @author Calculator Project
+ */
+
+#ifndef HOST_DISPLAY_H
+#define HOST_DISPLAY_H
+
+#include <Arduino.h>
+#include "DisplayModel.h"
+
+class CalcDisplay {
+public:
+    // 与上一个模型逐行比较，统计变化的行数
+    void publish(const DisplayModel& model) {
+        for (uint8_t i = 0; i < DisplayModel::LINE_COUNT; i++) {
+            if (strcmp(model.text[i], _shown.text[i]) != 0) updates++;
+        }
+        _shown = model;
+        refreshes++;
+    }
+
+    uint16_t getLineWidthBudget() const { return 240 - 2 * 8; }
+    uint8_t getMinCharWidth(uint8_t) const { return 12; }
+
+    uint32_t updates = 0;       ///< 行内容变化次数
+    uint32_t refreshes = 0;     ///< 提交次数
+
+private:
+    DisplayModel _shown;
+};
+
+#endif // HOST_DISPLAY_H
@@ -0,0 +1,63 @@
+/**
+ * @file Preferences.h
+ * @brief 主机构建用的Preferences替身：键值保存在内存中，进程退出即丢失
+ *
+ * @author Calculator Project
+ */
+
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) { (void)name; (void)readOnly; return true; }
+    void end() {}
+    bool clear() { _values.clear(); return true; }
+    bool remove(const char* key) { return _values.erase(key) > 0; }
+    bool isKey(const char* key) { return _values.count(key) > 0; }
+
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(value);
+        _values[key].assign(p, p + len);
+        return len;
+    }
+    size_t getBytesLength(const char* key) { return isKey(key) ? _values[key].size() : 0; }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        if (!isKey(key)) return 0;
+        const std::vector<uint8_t>& v = _values[key];
+        size_t n = v.size() < maxLen ? v.size() : maxLen;
+        memcpy(buf, v.data(), n);
+        return n;
+    }
+
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value); }
+    size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value) + 1); }
+
+    uint8_t getUChar(const char* key, uint8_t def = 0) { return get(key, def); }
+    uint16_t getUShort(const char* key, uint16_t def = 0) { return get(key, def); }
+    uint32_t getUInt(const char* key, uint32_t def = 0) { return get(key, def); }
+    bool getBool(const char* key, bool def = false) { return get<uint8_t>(key, def) != 0; }
+    String getString(const char* key, const char* def = "") {
+        return isKey(key) ? String((const char*)_values[key].data()) : String(def);
+    }
+
+private:
+    template <typename T>
+    T get(const char* key, T def) {
+        T value = def;
+        if (getBytesLength(key) == sizeof(T)) getBytes(key, &value, sizeof(T));
+        return value;
+    }
+
+    std::map<std::string, std::vector<uint8_t>> _values;
+};
+
+#endif // PREFERENCES_H
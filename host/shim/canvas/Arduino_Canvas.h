@@ -0,0 +1,35 @@
+/**
+ * @file Arduino_Canvas.h
+ * @brief 主机构建用的Arduino_Canvas替身：内存中的RGB565帧缓冲
+ *
+ * @author Calculator Project
+ */
+
+#ifndef ARDUINO_CANVAS_H
+#define ARDUINO_CANVAS_H
+
+#include "../Arduino_GFX_Library.h"
+
+class Arduino_Canvas : public Arduino_GFX {
+public:
+    Arduino_Canvas(int16_t w, int16_t h, Arduino_G *output, int16_t outputX = 0, int16_t outputY = 0,
+                   uint8_t rotation = 0);
+    ~Arduino_Canvas();
+
+    bool begin(int32_t speed = GFX_NOT_DEFINED) override;
+    void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override;
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override;
+    virtual void flush(void);
+
+    uint16_t *getFramebuffer() { return _framebuffer; }
+
+protected:
+    uint16_t *_framebuffer;
+    Arduino_G *_output;
+    int16_t _output_x, _output_y;
+};
+
+#endif // ARDUINO_CANVAS_H
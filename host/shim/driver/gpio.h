@@ -0,0 +1,15 @@
+/**
+ * @file gpio.h
+ * @brief 主机构建用的GPIO驱动替身（只有类型，引脚操作为空）
+ */
+
+#ifndef DRIVER_GPIO_H
+#define DRIVER_GPIO_H
+
+#include <stdint.h>
+
+typedef int gpio_num_t;
+
+inline int gpio_set_level(gpio_num_t, uint32_t) { return 0; }
+
+#endif // DRIVER_GPIO_H
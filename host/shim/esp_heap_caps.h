@@ -0,0 +1,19 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief 主机构建用的heap_caps替身：忽略内存类型，直接使用malloc
+ */
+
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t caps) { (void)caps; return malloc(size); }
+static inline void heap_caps_free(void* ptr) { free(ptr); }
+
+#endif // ESP_HEAP_CAPS_H
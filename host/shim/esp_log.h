@@ -0,0 +1,18 @@
+/**
+ * @file esp_log.h
+ * @brief 主机构建用的esp_log替身（Logger.h只用到级别类型）
+ */
+
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#endif // ESP_LOG_H
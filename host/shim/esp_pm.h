@@ -0,0 +1,11 @@
+/**
+ * @file esp_pm.h
+ * @brief 主机构建用的电源管理替身（只有类型）
+ */
+
+#ifndef ESP_PM_H
+#define ESP_PM_H
+
+typedef void* esp_pm_lock_handle_t;
+
+#endif // ESP_PM_H
@@ -0,0 +1,20 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief 主机构建用的ROM CRC替身（与ROM中的esp_rom_crc32_le结果一致）
+ */
+
+#ifndef ESP_ROM_CRC_H
+#define ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+#endif // ESP_ROM_CRC_H
@@ -0,0 +1,13 @@
+/**
+ * @file esp_timer.h
+ * @brief 主机构建用的esp_timer替身：时间取主机构建的时钟（micros()）
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <Arduino.h>
+
+inline int64_t esp_timer_get_time() { return micros(); }
+
+#endif // ESP_TIMER_H
@@ -0,0 +1,19 @@
+/**
+ * @file semphr.h
+ * @brief 主机构建用的FreeRTOS信号量替身：创建总是失败，依赖信号量的功能（TE同步）不启用
+ */
+
+#ifndef FREERTOS_SEMPHR_H
+#define FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+typedef void* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return nullptr; }
+inline void vSemaphoreDelete(SemaphoreHandle_t) {}
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdFALSE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdFALSE; }
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t, BaseType_t*) { return pdFALSE; }
+
+#endif // FREERTOS_SEMPHR_H
@@ -0,0 +1,26 @@
+/**
+ * @file task.h
+ * @brief 主机构建用的FreeRTOS任务替身
+ * @details 任务创建总是失败：渲染任务、推送任务等都退回同步模式，主机程序单线程运行
+ */
+
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t,
+                                          TaskHandle_t* handle, BaseType_t) {
+    if (handle) *handle = nullptr;
+    return pdFAIL;
+}
+inline void vTaskDelete(TaskHandle_t) {}
+inline void vTaskDelay(TickType_t) {}
+inline void xTaskNotifyGive(TaskHandle_t) {}
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*) {}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+
+#endif // FREERTOS_TASK_H
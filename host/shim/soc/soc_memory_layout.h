@@ -0,0 +1,11 @@
+/**
+ * @file soc_memory_layout.h
+ * @brief 主机构建用的内存布局替身：主机上没有PSRAM
+ */
+
+#ifndef SOC_MEMORY_LAYOUT_H
+#define SOC_MEMORY_LAYOUT_H
+
+inline bool esp_ptr_external_ram(const void*) { return false; }
+
+#endif // SOC_MEMORY_LAYOUT_H
@@ -14,20 +14,7 @@
 #include <Arduino.h>
 #include <vector>
 #include "CalculatorCore.h"
-
-/**
- * @brief 数字格式化选项
- */
-struct NumberFormat {
-    bool useThousandsSeparator;     ///< 使用千位分隔符
-    bool showTrailingZeros;         ///< 显示尾随零
-    uint8_t decimalPlaces;          ///< 小数位数
-    bool scientificNotation;        ///< 科学计数法
-    bool showSign;                  ///< 显示正负号
-    String currency;                ///< 货币符号
-    String thousandsSeparator;      ///< 千位分隔符
-    String decimalSeparator;        ///< 小数分隔符
-};
+#include "NumberFormatter.h"    // NumberFormat
 
 /**
  * @brief 显示主题配置
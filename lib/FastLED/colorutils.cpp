@@ -217,9 +217,13 @@ void fill_gradient_RGB( CRGB* leds, uint16_t numLeds, const CRGB& c1, const CRGB
 
 void nscale8_video( CRGB* leds, uint16_t num_leds, uint8_t scale)
 {
+#if FASTLED_SCALE8_BULK
+    scale8_video_bulk( leds->raw, num_leds * 3, scale);
+#else
     for( uint16_t i = 0; i < num_leds; ++i) {
         leds[i].nscale8_video( scale);
     }
+#endif
 }
 
 void fade_video(CRGB* leds, uint16_t num_leds, uint8_t fadeBy)
@@ -252,9 +256,13 @@ void nscale8_raw( CRGB* leds, uint16_t num_leds, uint8_t scale)
 
 void nscale8( CRGB* leds, uint16_t num_leds, uint8_t scale)
 {
+#if FASTLED_SCALE8_BULK
+    scale8_bulk( leds->raw, num_leds * 3, scale);
+#else
     for( uint16_t i = 0; i < num_leds; ++i) {
         leds[i].nscale8( scale);
     }
+#endif
 }
 
 void fadeUsingColor( CRGB* leds, uint16_t numLeds, const CRGB& colormask)
@@ -309,11 +317,18 @@ CRGB& nblend( CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay )
 
 void nblend( CRGB* existing, CRGB* overlay, uint16_t count, fract8 amountOfOverlay)
 {
+#if FASTLED_SCALE8_BULK
+    if( amountOfOverlay == 0) {
+        return;
+    }
+    blend8_bulk( existing->raw, overlay->raw, existing->raw, count * 3, amountOfOverlay);
+#else
     for( uint16_t i = count; i; --i) {
         nblend( *existing, *overlay, amountOfOverlay);
         ++existing;
         ++overlay;
     }
+#endif
 }
 
 CRGB blend( const CRGB& p1, const CRGB& p2, fract8 amountOfP2 )
@@ -325,9 +340,13 @@ CRGB blend( const CRGB& p1, const CRGB& p2, fract8 amountOfP2 )
 
 CRGB* blend( const CRGB* src1, const CRGB* src2, CRGB* dest, uint16_t count, fract8 amountOfsrc2 )
 {
+#if FASTLED_SCALE8_BULK
+    blend8_bulk( src1->raw, src2->raw, dest->raw, count * 3, amountOfsrc2);
+#else
     for( uint16_t i = 0; i < count; ++i) {
         dest[i] = blend(src1[i], src2[i], amountOfsrc2);
     }
+#endif
     return dest;
 }
 
@@ -379,6 +379,7 @@
 
 #include "lib8tion/math8.h"
 #include "lib8tion/scale8.h"
+#include "lib8tion/scale8_bulk.h"
 #include "lib8tion/random8.h"
 #include "lib8tion/trig8.h"
 
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string.h>
+
+#include "lib8static.h"
+#include "namespace.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+/// @file scale8_bulk.h
+/// Scaling and blending of whole byte arrays, two channels per
+/// 32-bit multiply.
+
+/// @addtogroup lib8tion
+/// @{
+
+/// @defgroup ScalingBulk Bulk Scaling Functions
+/// Array versions of scale8(), scale8_video() and blend8() that give
+/// bit-identical results.
+///
+/// Four bytes are loaded as one 32-bit word and split into the even
+/// and odd bytes, each held in the low byte of a 16-bit lane
+/// (mask 0x00FF00FF). One 32-bit multiply then scales two channels:
+/// the largest lane product, 255 * 256 + 255, still fits in 16 bits,
+/// so nothing carries into the neighbouring lane. On cores with a
+/// single-cycle 32-bit multiplier (Xtensa LX6/LX7, Cortex-M3 and up)
+/// this roughly halves the multiplies and loads of the per-byte loop.
+///
+/// Enabled by default on ESP32 when the FIXED scale and blend
+/// formulas are in use; define FASTLED_SCALE8_BULK to 0 to use the
+/// per-pixel loops instead.
+/// @{
+
+#ifndef FASTLED_SCALE8_BULK
+#if defined(ESP32) && (FASTLED_SCALE8_FIXED == 1) && (FASTLED_BLEND_FIXED == 1)
+#define FASTLED_SCALE8_BULK 1
+#else
+#define FASTLED_SCALE8_BULK 0
+#endif
+#endif
+
+/// Mask of the two 16-bit lanes' low bytes
+#define SCALE8_BULK_LANES 0x00FF00FFu
+
+/// Load four bytes regardless of alignment
+LIB8STATIC_ALWAYS_INLINE uint32_t scale8_bulk_load(const uint8_t *p) {
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/// Store four bytes regardless of alignment
+LIB8STATIC_ALWAYS_INLINE void scale8_bulk_store(uint8_t *p, uint32_t w) {
+    memcpy(p, &w, sizeof(w));
+}
+
+/// Scale the two lanes of @p lanes by scale8() (FIXED formula)
+LIB8STATIC_ALWAYS_INLINE uint32_t scale8_lanes(uint32_t lanes,
+                                               uint32_t scale_fixed) {
+    return ((lanes * scale_fixed) >> 8) & SCALE8_BULK_LANES;
+}
+
+/// Scale the two lanes of @p lanes by scale8_video()
+LIB8STATIC_ALWAYS_INLINE uint32_t scale8_video_lanes(uint32_t lanes,
+                                                     uint32_t scale,
+                                                     uint32_t nonzero) {
+    // lane + 255 reaches bit 8 exactly when the lane is non-zero
+    uint32_t bump = ((lanes + SCALE8_BULK_LANES) >> 8) & nonzero;
+    return (((lanes * scale) >> 8) & SCALE8_BULK_LANES) + bump;
+}
+
+/// Blend the two lanes of @p a toward @p b by blend8() (FIXED formula)
+LIB8STATIC_ALWAYS_INLINE uint32_t blend8_lanes(uint32_t a, uint32_t b,
+                                               uint32_t amount_a,
+                                               uint32_t amount_b) {
+    // A*(256-amountOfB) + B*(amountOfB+1) <= 255*257, one lane each
+    return ((a * amount_a + b * amount_b) >> 8) & SCALE8_BULK_LANES;
+}
+
+/// Scale @p count bytes in place by scale8()
+LIB8STATIC void scale8_bulk(uint8_t *data, uint32_t count, fract8 scale) {
+    const uint32_t scale_fixed = (uint32_t)scale + 1;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32_t w = scale8_bulk_load(data + i);
+        uint32_t even = scale8_lanes(w & SCALE8_BULK_LANES, scale_fixed);
+        uint32_t odd = scale8_lanes((w >> 8) & SCALE8_BULK_LANES, scale_fixed);
+        scale8_bulk_store(data + i, even | (odd << 8));
+    }
+    for (; i < count; ++i) {
+        data[i] = (uint8_t)(((uint16_t)data[i] * scale_fixed) >> 8);
+    }
+}
+
+/// Scale @p count bytes in place by scale8_video()
+LIB8STATIC void scale8_video_bulk(uint8_t *data, uint32_t count, fract8 scale) {
+    const uint32_t nonzero = scale ? 0x00010001u : 0;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32_t w = scale8_bulk_load(data + i);
+        uint32_t even = scale8_video_lanes(w & SCALE8_BULK_LANES, scale, nonzero);
+        uint32_t odd = scale8_video_lanes((w >> 8) & SCALE8_BULK_LANES, scale, nonzero);
+        scale8_bulk_store(data + i, even | (odd << 8));
+    }
+    for (; i < count; ++i) {
+        uint8_t v = data[i];
+        data[i] = (uint8_t)((((uint16_t)v * scale) >> 8) + ((v && scale) ? 1 : 0));
+    }
+}
+
+/// Blend @p count bytes of @p a toward @p b by blend8() into @p out
+/// @note @p out may be the same array as @p a or @p b
+LIB8STATIC void blend8_bulk(const uint8_t *a, const uint8_t *b, uint8_t *out,
+                            uint32_t count, fract8 amountOfB) {
+    const uint32_t amount_a = 256 - (uint32_t)amountOfB;
+    const uint32_t amount_b = (uint32_t)amountOfB + 1;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32_t wa = scale8_bulk_load(a + i);
+        uint32_t wb = scale8_bulk_load(b + i);
+        uint32_t even = blend8_lanes(wa & SCALE8_BULK_LANES, wb & SCALE8_BULK_LANES,
+                                     amount_a, amount_b);
+        uint32_t odd = blend8_lanes((wa >> 8) & SCALE8_BULK_LANES,
+                                    (wb >> 8) & SCALE8_BULK_LANES,
+                                    amount_a, amount_b);
+        scale8_bulk_store(out + i, even | (odd << 8));
+    }
+    for (; i < count; ++i) {
+        out[i] = (uint8_t)((a[i] * amount_a + b[i] * amount_b) >> 8);
+    }
+}
+
+/// @} ScalingBulk
+/// @} lib8tion
+
+FASTLED_NAMESPACE_END
@@ -16,6 +16,7 @@
 #include "idf4_rmt.h"
 #include "idf4_rmt_impl.h"
 #include "clock_cycles.h"
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -94,6 +95,19 @@ extern "C"
 #define MAX_PULSES (FASTLED_RMT_MEM_WORDS_PER_CHANNEL * FASTLED_RMT_MEM_BLOCKS)
 #define PULSES_PER_FILL (MAX_PULSES / 2) /* Half of the channel buffer */
 
+// -- Byte-to-pulse lookup table
+//    The first controller's zero/one items are expanded into a table of the
+//    eight RMT items for every byte value (256 x 8 words = 8KB of internal
+//    RAM), so the refill interrupt copies eight words per byte instead of
+//    testing and shifting each bit. A shorter interrupt leaves more slack
+//    before the other half of the buffer runs dry, which keeps the wire
+//    timing intact when other interrupts delay the refill. Controllers with
+//    different timing keep the bit-by-bit conversion.
+//    Define FASTLED_RMT_BYTE_TABLE to 0 to save the RAM.
+#ifndef FASTLED_RMT_BYTE_TABLE
+#define FASTLED_RMT_BYTE_TABLE 1
+#endif
+
 // -- Configuration constants
 #define DIVIDER 2 /* 4, 8 still seem to work, but timings become marginal */
 
@@ -203,6 +217,14 @@ static xSemaphoreHandle gTX_sem = NULL;
 CMinWait<50> gWait;
 
 static bool gInitialized = false;
+
+#if FASTLED_RMT_BYTE_TABLE
+// -- Pulse table shared by all controllers with the same timing
+//    Read from the refill interrupt, so it must stay in internal RAM
+DRAM_ATTR static uint32_t gByteTable[256][8];
+static uint32_t gByteTableZero = 0;
+static uint32_t gByteTableOne = 0;
+#endif
 // -- Stored values for FASTLED_RMT_MAX_CHANNELS and FASTLED_RMT_MEM_BLOCKS
 int ESP32RMTController::gMaxChannel;
 int ESP32RMTController::gMemBlocks;
@@ -256,6 +278,22 @@ FASTLED_FORCE_INLINE void IRAM_ATTR convert_byte_to_rmt(
     out[7].val = tmp[7];
 }
 
+// -- Copy one byte's worth of RMT pulses from the lookup table
+//    RMT memory only takes 32-bit writes, so copy word by word
+FASTLED_FORCE_INLINE void IRAM_ATTR copy_byte_to_rmt(
+    const uint32_t *pulses,
+    volatile rmt_item32_t *out)
+{
+    out[0].val = pulses[0];
+    out[1].val = pulses[1];
+    out[2].val = pulses[2];
+    out[3].val = pulses[3];
+    out[4].val = pulses[4];
+    out[5].val = pulses[5];
+    out[6].val = pulses[6];
+    out[7].val = pulses[7];
+}
+
 void IRAM_ATTR GiveGTX_sem()
 {
     if (gTX_sem != NULL)
@@ -273,7 +311,8 @@ ESP32RMTController::ESP32RMTController(int DATA_PIN, int T1, int T2, int T3, int
       mBuffer(0),
       mBufferSize(0),
       mCurPulse(0),
-      mBuiltInDriver(built_in_driver)
+      mBuiltInDriver(built_in_driver),
+      mByteTable(0)
 {
     // -- Store the max channel and mem blocks parameters
     gMaxChannel = maxChannel;
@@ -295,6 +334,24 @@ ESP32RMTController::ESP32RMTController(int DATA_PIN, int T1, int T2, int T3, int
     mZero.level1 = 0;
     mZero.duration1 = ESP_TO_RMT_CYCLES(T2 + T3); // TO_RMT_CYCLES(T2 + T3);
 
+#if FASTLED_RMT_BYTE_TABLE
+    // -- Build the pulse table for the first controller, share it with
+    //    any later controller using the same timing
+    if (gByteTableZero == 0)
+    {
+        for (int byteval = 0; byteval < 256; byteval++)
+        {
+            convert_byte_to_rmt(byteval, mZero.val, mOne.val, (volatile rmt_item32_t *)gByteTable[byteval]);
+        }
+        gByteTableZero = mZero.val;
+        gByteTableOne = mOne.val;
+    }
+    if (gByteTableZero == mZero.val && gByteTableOne == mOne.val)
+    {
+        mByteTable = gByteTable;
+    }
+#endif
+
     gControllers[gNumControllers] = this;
     gNumControllers++;
 
@@ -877,14 +934,22 @@ void ESP32RMTController::fillNext(bool check_time)
 
     // -- Use locals for speed
     volatile FASTLED_REGISTER rmt_item32_t *pItem = mRMT_mem_ptr;
+    const uint32_t (*byte_table)[8] = mByteTable;
 
     for (FASTLED_REGISTER int i = 0; i < PULSES_PER_FILL / 8; i++)
     {
         if (mCur < mSize)
         {
 
-            // -- Get the next four bytes of pixel data
-            convert_byte_to_rmt(mPixelData[mCur], zero_val, one_val, pItem);
+            // -- Get the next byte of pixel data
+            if (byte_table)
+            {
+                copy_byte_to_rmt(byte_table[mPixelData[mCur]], pItem);
+            }
+            else
+            {
+                convert_byte_to_rmt(mPixelData[mCur], zero_val, one_val, pItem);
+            }
             pItem += 8;
             mCur++;
         }
@@ -928,7 +993,14 @@ void ESP32RMTController::initPulseBuffer(int size_in_bytes)
 //    This function is only used when the built-in RMT driver is chosen
 void ESP32RMTController::ingest(uint8_t byteval)
 {
-    convert_byte_to_rmt(byteval, mZero.val, mOne.val, mBuffer + mCurPulse);
+    if (mByteTable)
+    {
+        memcpy(mBuffer + mCurPulse, mByteTable[byteval], sizeof(mByteTable[byteval]));
+    }
+    else
+    {
+        convert_byte_to_rmt(byteval, mZero.val, mOne.val, mBuffer + mCurPulse);
+    }
     mCurPulse += 8;
 }
 
@@ -102,6 +102,10 @@ private:
     int mCurPulse;
     bool mBuiltInDriver;
 
+    // -- Pulses for every byte value (FASTLED_RMT_BYTE_TABLE), or null when
+    //    this controller's timing differs from the shared table
+    const uint32_t (*mByteTable)[8];
+
     // -- These values need to be real variables, so we can access them
     //    in the cpp file
     static int gMaxChannel;
@@ -0,0 +1,181 @@
+/**
+ * @file AllocTracer.cpp
+ * @brief 按键路径的堆分配跟踪实现
+ *
+ * @author Calculator Project
+ */
+
+#include "AllocTracer.h"
+#include "Console.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+volatile bool AllocTracer::_active = false;
+uint16_t AllocTracer::_armed = 0;
+uint16_t AllocTracer::_presses = 0;
+uint32_t AllocTracer::_allocs = 0;
+uint32_t AllocTracer::_bytes = 0;
+uint32_t AllocTracer::_frees = 0;
+uint32_t AllocTracer::_droppedSites = 0;
+AllocTracer::Site AllocTracer::_sites[MAX_SITES];
+uint8_t AllocTracer::_siteCount = 0;
+const char* AllocTracer::_tag = nullptr;
+void* AllocTracer::_tagTask = nullptr;
+
+namespace {
+
+portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 窗口寄存器调用的返回地址高2位是调用窗口大小，还原成代码地址并指回call指令
+inline uint32_t callerAddress(void* ret) {
+    return (((uint32_t)ret & 0x3FFFFFFF) | 0x40000000) - 3;
+}
+
+void cmdAllocTrace(const ConsoleArgs& args) {
+    int presses = 1;
+    if (args.count > 1 && (!args.toInt(1, presses) || presses < 1 || presses > 1000)) {
+        Serial.println("用法: alloc_trace [1-1000]");
+        return;
+    }
+    AllocTracer::arm(presses);
+    Serial.printf("接下来 %d 次按键将统计堆分配\n", presses);
+}
+
+constexpr ConsoleCommand ALLOC_COMMANDS[] = {
+    {"alloc_trace", "[n]", "统计接下来n次按键处理中的堆分配（次数、字节、调用位置）", cmdAllocTrace},
+};
+static_assert(consoleSorted(ALLOC_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+// 链接参数 -Wl,--wrap=malloc 等把所有调用转到这里，__real_* 是原函数
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    void* p = __real_malloc(size);
+    if (AllocTracer::isActive() && p) {
+        AllocTracer::recordAlloc(size, callerAddress(__builtin_return_address(0)));
+    }
+    return p;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void* p = __real_calloc(count, size);
+    if (AllocTracer::isActive() && p) {
+        AllocTracer::recordAlloc(count * size, callerAddress(__builtin_return_address(0)));
+    }
+    return p;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    void* p = __real_realloc(ptr, size);
+    if (AllocTracer::isActive()) {
+        // realloc(p, 0)相当于释放；扩容即使原地完成也计一次分配
+        if (size == 0) {
+            if (ptr) AllocTracer::recordFree();
+        } else if (p) {
+            AllocTracer::recordAlloc(size, callerAddress(__builtin_return_address(0)));
+        }
+    }
+    return p;
+}
+
+void __wrap_free(void* ptr) {
+    if (AllocTracer::isActive() && ptr) {
+        AllocTracer::recordFree();
+    }
+    __real_free(ptr);
+}
+}
+
+void AllocTracer::begin() {
+    Console::instance().addCommands(ALLOC_COMMANDS);
+}
+
+void AllocTracer::reset() {
+    _presses = 0;
+    _allocs = 0;
+    _bytes = 0;
+    _frees = 0;
+    _droppedSites = 0;
+    _siteCount = 0;
+}
+
+void AllocTracer::arm(uint16_t presses) {
+    _active = false;
+    reset();
+    _armed = presses;
+}
+
+void AllocTracer::onKeyPress() {
+    if (_armed) {
+        _active = true;
+    }
+}
+
+void AllocTracer::onLoopEnd() {
+    if (!_active) return;
+    _active = false;
+    _presses++;
+    if (--_armed == 0) {
+        print(Serial);
+    }
+}
+
+void AllocTracer::recordAlloc(size_t size, uint32_t caller) {
+    const char* tag = xTaskGetCurrentTaskHandle() == _tagTask ? _tag : nullptr;
+
+    portENTER_CRITICAL_SAFE(&traceMux);
+    _allocs++;
+    _bytes += size;
+    uint8_t i = 0;
+    while (i < _siteCount && (_sites[i].caller != caller || _sites[i].tag != tag)) i++;
+    if (i == _siteCount && _siteCount < MAX_SITES) {
+        _sites[_siteCount++] = {caller, tag, 0, 0};
+    }
+    if (i < _siteCount) {
+        _sites[i].count++;
+        _sites[i].bytes += size;
+    } else {
+        _droppedSites++;
+    }
+    portEXIT_CRITICAL_SAFE(&traceMux);
+}
+
+void AllocTracer::recordFree() {
+    portENTER_CRITICAL_SAFE(&traceMux);
+    _frees++;
+    portEXIT_CRITICAL_SAFE(&traceMux);
+}
+
+const char* AllocTracer::pushTag(const char* tag) {
+    const char* previous = _tag;
+    _tag = tag;
+    _tagTask = xTaskGetCurrentTaskHandle();
+    return previous;
+}
+
+void AllocTracer::popTag(const char* previous) {
+    _tag = previous;
+}
+
+void AllocTracer::print(Print& out) {
+    out.printf("堆分配跟踪: %u 次按键, 分配 %lu 次 / %lu 字节, 释放 %lu 次（目标: 每次按键0次分配）\n",
+               _presses, (unsigned long)_allocs, (unsigned long)_bytes, (unsigned long)_frees);
+    if (_presses) {
+        out.printf(" - 平均每次按键: 分配 %lu.%02lu 次, %lu 字节\n", (unsigned long)(_allocs / _presses),
+                   (unsigned long)(_allocs * 100 / _presses % 100), (unsigned long)(_bytes / _presses));
+    }
+    for (uint8_t i = 0; i < _siteCount; i++) {
+        const Site& site = _sites[i];
+        out.printf(" - 0x%08lx %-16s %6lu 次 %8lu 字节\n", (unsigned long)site.caller,
+                   site.tag ? site.tag : "-", (unsigned long)site.count, (unsigned long)site.bytes);
+    }
+    if (_droppedSites) {
+        out.printf(" - 另有 %lu 次分配的调用位置未记录（表已满）\n", (unsigned long)_droppedSites);
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * @file AllocTracer.h
+ * @brief 按键路径的堆分配跟踪
+ * @details 链接时用 -Wl,--wrap 包装 malloc/calloc/realloc/free（见platformio.ini），
+ * 跟踪开启时统计每次分配：
+ * - 串口命令 alloc_trace [n] 布置跟踪，之后的n次按键各跟踪一轮：
+ *   从按键事件分发开始，到这一轮loop()结束（计算、显示提交都在其中）
+ * - 窗口内所有任务的分配都计入，按调用位置归类：ALLOC_TAG标记的作用域名 + malloc的调用者地址
+ *   （String等库函数内部分配时调用者是库函数，作用域名才能看出来自哪个模块）
+ * - 结束后输出次数、字节数、释放次数和各调用位置，目标是每次按键0次分配
+ * - 包装函数在跟踪关闭时只多一次判断；malloc可能在静态构造之前调用，状态全部为零初始化的静态成员
+ * - 地址可用 xtensa-esp32s3-elf-addr2line -e firmware.elf 解析
+ *
+ * @author Calculator Project
+ */
+
+#ifndef ALLOC_TRACER_H
+#define ALLOC_TRACER_H
+
+#include <Arduino.h>
+
+class AllocTracer {
+public:
+    static const uint8_t MAX_SITES = 16;
+
+    /**
+     * @brief 注册串口命令
+     */
+    static void begin();
+
+    /**
+     * @brief 布置跟踪
+     * @param presses 跟踪的按键次数
+     */
+    static void arm(uint16_t presses);
+
+    /**
+     * @brief 按键事件分发前调用：已布置时开始跟踪这一次按键
+     */
+    static void onKeyPress();
+
+    /**
+     * @brief loop()每轮结束时调用：结束这一次按键的跟踪，全部完成后输出报告
+     */
+    static void onLoopEnd();
+
+    /**
+     * @brief 包装函数中调用，记录一次分配
+     * @param size 分配的字节数
+     * @param caller malloc的调用者地址
+     */
+    static void recordAlloc(size_t size, uint32_t caller);
+    static void recordFree();
+
+    static bool isActive() { return _active; }
+
+    /**
+     * @brief 进入一个标记作用域，返回之前的标记（AllocTag使用）
+     */
+    static const char* pushTag(const char* tag);
+    static void popTag(const char* previous);
+
+    static void print(Print& out);
+
+private:
+    struct Site {
+        uint32_t caller;        ///< malloc调用者地址
+        const char* tag;        ///< 所在的标记作用域，nullptr表示未标记
+        uint32_t count;
+        uint32_t bytes;
+    };
+
+    static void reset();
+
+    static volatile bool _active;
+    static uint16_t _armed;         ///< 还要跟踪的按键次数
+    static uint16_t _presses;       ///< 已跟踪的按键次数
+    static uint32_t _allocs;
+    static uint32_t _bytes;
+    static uint32_t _frees;
+    static uint32_t _droppedSites;  ///< 调用位置表已满时未归类的分配
+    static Site _sites[MAX_SITES];
+    static uint8_t _siteCount;
+    static const char* _tag;        ///< 当前标记（只在loop任务中设置）
+    static void* _tagTask;          ///< 设置标记的任务，其他任务的分配不使用该标记
+};
+
+/**
+ * @brief 标记作用域：其中的分配在报告中归到该名称下
+ */
+class AllocTag {
+public:
+    explicit AllocTag(const char* tag) : _previous(AllocTracer::pushTag(tag)) {}
+    ~AllocTag() { AllocTracer::popTag(_previous); }
+
+private:
+    const char* _previous;
+};
+
+#define ALLOC_TAG_CONCAT_(a, b) a##b
+#define ALLOC_TAG_CONCAT(a, b) ALLOC_TAG_CONCAT_(a, b)
+#define ALLOC_TAG(name) AllocTag ALLOC_TAG_CONCAT(_allocTag, __LINE__)(name)
+
+#endif // ALLOC_TRACER_H
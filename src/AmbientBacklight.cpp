@@ -0,0 +1,215 @@
+/**
+ * @file AmbientBacklight.cpp
+ * @brief 自动背光亮度实现
+ *
+ * @author Calculator Project
+ */
+
+#include "AmbientBacklight.h"
+#include "BackLightControl.h"
+#include "ConfigManager.h"
+#include "Console.h"
+#include "LoopScheduler.h"
+#include "Logger.h"
+#include "config.h"
+#include <sys/time.h>
+#include <time.h>
+
+#define TAG_AMBIENT "Ambient"
+
+namespace {
+
+// 环境光输入（每256一档）对应的亮度百分比：12 + 88 * ln(1 + 50x) / ln(51)
+// 暗处每一档变化大、亮处变化小，与人眼对亮度的对数感知一致
+const uint8_t PERCEPTUAL_TABLE[17] = {
+    12, 44, 56, 64, 70, 75, 79, 82, 85, 87, 90, 92, 94, 95, 97, 99, 100
+};
+
+// 没有传感器时每个整点估算的环境光（0-4095），13点最亮，20点到次日6点为夜间
+const uint16_t SCHEDULE_TABLE[25] = {
+    0, 0, 0, 0, 0, 0, 0, 842, 1684, 2468, 3142, 3659, 3984,
+    4095, 3984, 3659, 3142, 2468, 1684, 842, 0, 0, 0, 0, 0
+};
+
+void cmdBacklight(const ConsoleArgs& args) {
+    AmbientBacklight& ambient = AmbientBacklight::instance();
+    int percent;
+    if (args.count < 2) {
+        Serial.printf("背光: %s, 当前 %d%%, 固定亮度 %d%%\n", ambient.isAuto() ? "自动" : "固定",
+                      ambient.getAppliedPercent(), ConfigManager::getInstance().getBacklightBrightness());
+        if (ambient.hasInput()) {
+            Serial.printf("环境光输入(%s): %u -> %d%%\n", ambient.hasSensor() ? "传感器" : "时间表",
+                          ambient.getFilteredInput(), AmbientBacklight::lookup(ambient.getFilteredInput()));
+        } else if (ambient.isAuto()) {
+            Serial.println("没有环境光输入：无传感器且未设置时钟（clock HH:MM）");
+        }
+    } else if (args.is(1, "auto")) {
+        ambient.setAuto(true);
+        Serial.println("自动亮度已启用");
+    } else if (args.toInt(1, percent) && percent >= 0 && percent <= 100) {
+        ambient.setFixed((uint8_t)percent);
+        Serial.printf("背光亮度已设置为 %d%%\n", percent);
+    } else {
+        Serial.println("用法: backlight <0-100|auto>");
+    }
+}
+
+void cmdClock(const ConsoleArgs& args) {
+    int hour = 0;
+    int minute = 0;
+    if (sscanf(args.arg(1), "%d:%d", &hour, &minute) != 2 || hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        Serial.println("用法: clock HH:MM");
+        return;
+    }
+    AmbientBacklight::instance().setClock((uint8_t)hour, (uint8_t)minute);
+    Serial.printf("时钟已设置为 %02d:%02d\n", hour, minute);
+}
+
+constexpr ConsoleCommand AMBIENT_COMMANDS[] = {
+    {"backlight", "<0-100|auto>", "设置背光亮度或启用自动亮度", cmdBacklight},
+    {"clock", "<HH:MM>", "设置时钟（没有环境光传感器时自动亮度按时间表）", cmdClock},
+};
+static_assert(consoleSorted(AMBIENT_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+AmbientBacklight::AmbientBacklight()
+    : _fixed(100),
+      _auto(false),
+      _suspended(false),
+      _clockSet(false),
+      _filtered(0),
+      _hasInput(false),
+      _lastSample(0),
+      _applied(0) {
+}
+
+void AmbientBacklight::begin(uint8_t fixedPercent, bool autoEnabled) {
+    _fixed = fixedPercent;
+    _auto = autoEnabled;
+    Console::instance().addCommands(AMBIENT_COMMANDS);
+    ConfigManager::getInstance().addObserver(CONFIG_BACKLIGHT_FIELDS, onConfigChanged, this);
+#if AMBIENT_LIGHT_PIN >= 0
+    pinMode(AMBIENT_LIGHT_PIN, INPUT);
+#endif
+    LOG_I(TAG_AMBIENT, "背光: %s, 输入: %s", _auto ? "自动" : "固定", hasSensor() ? "环境光传感器" : "时间表");
+}
+
+bool AmbientBacklight::hasSensor() const {
+    return AMBIENT_LIGHT_PIN >= 0;
+}
+
+uint8_t AmbientBacklight::lookup(uint16_t input) {
+    if (input >= INPUT_MAX) return PERCEPTUAL_TABLE[16];
+    uint8_t index = input >> 8;
+    int low = PERCEPTUAL_TABLE[index];
+    int high = PERCEPTUAL_TABLE[index + 1];
+    return (uint8_t)(low + (high - low) * (input & 0xFF) / 256);
+}
+
+bool AmbientBacklight::readInput(uint16_t& value) {
+#if AMBIENT_LIGHT_PIN >= 0
+    value = (uint16_t)analogRead(AMBIENT_LIGHT_PIN);
+    if (value > INPUT_MAX) value = INPUT_MAX;
+    return true;
+#else
+    if (!_clockSet) return false;
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    int low = SCHEDULE_TABLE[local.tm_hour];
+    int high = SCHEDULE_TABLE[local.tm_hour + 1];
+    value = (uint16_t)(low + (high - low) * local.tm_min / 60);
+    return true;
+#endif
+}
+
+void AmbientBacklight::sample() {
+    _lastSample = millis();
+    uint16_t raw;
+    if (!readInput(raw)) return;
+
+    // 一阶低通：每次向新读数靠近1/2^AUTO_BACKLIGHT_IIR_SHIFT；第一次直接采用读数
+    int32_t scaled = (int32_t)raw << FILTER_FRACTION_BITS;
+    if (!_hasInput) {
+        _filtered = scaled;
+        _hasInput = true;
+    } else {
+        _filtered += (scaled - _filtered) >> AUTO_BACKLIGHT_IIR_SHIFT;
+    }
+}
+
+uint8_t AmbientBacklight::targetPercent() const {
+    return (_auto && _hasInput) ? lookup(getFilteredInput()) : _fixed;
+}
+
+void AmbientBacklight::apply(uint8_t percent, uint16_t fadeMs) {
+    _applied = percent;
+    BacklightControl::getInstance().setBacklight(percent, fadeMs);
+}
+
+void AmbientBacklight::update() {
+    if (!_auto || _suspended) return;
+
+    uint32_t interval = hasSensor() ? AUTO_BACKLIGHT_SAMPLE_MS : AUTO_BACKLIGHT_SCHEDULE_MS;
+    uint32_t now = millis();
+    if (now - _lastSample < interval) {
+        LoopScheduler::instance().at(_lastSample + interval);
+        return;
+    }
+
+    sample();
+    LoopScheduler::instance().at(_lastSample + interval);
+    if (!_hasInput) return;
+
+    // 滞回：变化不到阈值时不动背光
+    uint8_t percent = lookup(getFilteredInput());
+    int change = (int)percent - (int)_applied;
+    if (change >= AUTO_BACKLIGHT_HYSTERESIS || change <= -AUTO_BACKLIGHT_HYSTERESIS) {
+        apply(percent, AUTO_BACKLIGHT_FADE_MS);
+    }
+}
+
+void AmbientBacklight::restore(uint16_t fadeMs) {
+    _suspended = false;
+    if (_auto) sample();
+    apply(targetPercent(), fadeMs);
+}
+
+void AmbientBacklight::onConfigChanged(uint32_t changed, const PersistentConfig& config, void* context) {
+    AmbientBacklight& self = *(AmbientBacklight*)context;
+    // setAuto/setFixed先更新自身再写配置，这里看到的是相同的值
+    if (self._fixed == config.backlightBrightness && self._auto == config.backlightAuto) return;
+    self._fixed = config.backlightBrightness;
+    self._auto = config.backlightAuto;
+    if (!self._suspended) self.restore(AUTO_BACKLIGHT_FADE_MS);
+}
+
+void AmbientBacklight::setAuto(bool enabled) {
+    _auto = enabled;
+    ConfigManager::getInstance().setBacklightAuto(enabled);
+    if (!_suspended) restore(AUTO_BACKLIGHT_FADE_MS);
+}
+
+void AmbientBacklight::setFixed(uint8_t percent) {
+    _fixed = percent;
+    _auto = false;
+    ConfigManager::getInstance().setBacklightBrightness(percent);
+    ConfigManager::getInstance().setBacklightAuto(false);
+    if (!_suspended) apply(percent, 300);
+}
+
+bool AmbientBacklight::setClock(uint8_t hour, uint8_t minute) {
+    // 没有日期信息，只保证一天内的时刻正确
+    struct timeval tv;
+    tv.tv_sec = (time_t)hour * 3600 + (time_t)minute * 60;
+    tv.tv_usec = 0;
+    if (settimeofday(&tv, nullptr) != 0) return false;
+    _clockSet = true;
+
+    // 时间跳变后不再平滑，直接采用新时刻的估算值
+    _hasInput = false;
+    LoopScheduler::instance().after(0);
+    _lastSample = millis() - AUTO_BACKLIGHT_SCHEDULE_MS;
+    return true;
+}
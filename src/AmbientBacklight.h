@@ -0,0 +1,101 @@
+/**
+ * @file AmbientBacklight.h
+ * @brief 自动背光亮度
+ * @details 输入为环境光传感器的ADC读数（AMBIENT_LIGHT_PIN，0-4095）；没有传感器时按一天中的时间估算环境光：
+ * - 读数先经一阶IIR低通滤波，再查感知亮度表（按对数感知预先算好，段内线性插值）得到亮度百分比，
+ *   百分比到占空比的gamma换算由BacklightControl完成
+ * - 结果与当前亮度相差达到AUTO_BACKLIGHT_HYSTERESIS才调整，环境光轻微波动时背光不动
+ * - 时间表需要时钟：串口命令 clock HH:MM 设置，未设置时使用固定亮度
+ * - 休眠期间暂停，唤醒时restore()恢复到当前应有的亮度
+ *
+ * @author Calculator Project
+ */
+
+#ifndef AMBIENT_BACKLIGHT_H
+#define AMBIENT_BACKLIGHT_H
+
+#include <Arduino.h>
+
+struct PersistentConfig;
+
+class AmbientBacklight {
+public:
+    static const uint16_t INPUT_MAX = 4095;    ///< 环境光输入的最大值（12位ADC）
+
+    static AmbientBacklight& instance() {
+        static AmbientBacklight instance;
+        return instance;
+    }
+
+    /**
+     * @brief 设置初始模式，注册串口命令和配置观察者，不改变背光（随后调用restore()）
+     * @details 之后配置中的背光亮度或自动模式改变（例如load_config、主机导入）时直接生效
+     * @param fixedPercent 固定亮度，也是自动模式没有输入时的亮度
+     * @param autoEnabled 是否启用自动亮度
+     */
+    void begin(uint8_t fixedPercent, bool autoEnabled);
+
+    /**
+     * @brief 主循环调用：到采样时间才读取输入
+     */
+    void update();
+
+    /**
+     * @brief 恢复到当前应有的亮度（启动、休眠唤醒时调用）
+     */
+    void restore(uint16_t fadeMs);
+
+    /**
+     * @brief 暂停自动调整（进入休眠时调用），由restore()恢复
+     */
+    void suspend() { _suspended = true; }
+
+    /**
+     * @brief 启用/关闭自动亮度，并写入配置
+     */
+    void setAuto(bool enabled);
+
+    /**
+     * @brief 设置固定亮度并关闭自动亮度，写入配置
+     */
+    void setFixed(uint8_t percent);
+
+    /**
+     * @brief 设置时间表使用的时钟
+     */
+    bool setClock(uint8_t hour, uint8_t minute);
+
+    bool isAuto() const { return _auto; }
+    bool hasSensor() const;
+    bool hasInput() const { return _hasInput; }
+    uint16_t getFilteredInput() const { return (uint16_t)(_filtered >> FILTER_FRACTION_BITS); }
+    uint8_t getAppliedPercent() const { return _applied; }
+
+    /**
+     * @brief 环境光输入对应的亮度百分比（查表插值）
+     */
+    static uint8_t lookup(uint16_t input);
+
+private:
+    static const uint8_t FILTER_FRACTION_BITS = 4;
+
+    AmbientBacklight();
+
+    bool readInput(uint16_t& value);
+    uint8_t targetPercent() const;
+    void sample();
+    void apply(uint8_t percent, uint16_t fadeMs);
+    static void onConfigChanged(uint32_t changed, const PersistentConfig& config, void* context);
+
+    uint8_t _fixed;
+    bool _auto;
+    bool _suspended;
+    bool _clockSet;
+
+    int32_t _filtered;              ///< 滤波后的输入，低FILTER_FRACTION_BITS位为小数
+    bool _hasInput;                 ///< _filtered已有有效值
+    uint32_t _lastSample;
+    uint8_t _applied;               ///< 最后一次设置的亮度百分比
+};
+
+#endif // AMBIENT_BACKLIGHT_H
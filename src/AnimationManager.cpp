@@ -0,0 +1,138 @@
+/**
+ * @file AnimationManager.cpp
+ * @brief 固定容量动画管理器实现
+ *
+ * @author Calculator Project
+ */
+
+#include "AnimationManager.h"
+
+AnimationManager::AnimationManager() : _activeCount(0) {
+    for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+        _slots[i].active = false;
+    }
+    for (uint8_t i = 0; i < MAX_TARGETS; i++) {
+        _values[i] = 0;
+    }
+}
+
+bool AnimationManager::start(uint8_t target, int16_t from, int16_t to, uint16_t durationMs,
+                             Easing easing, uint32_t nowMs) {
+    if (target >= MAX_TARGETS) return false;
+
+    // 同一目标只保留一个动画
+    Slot *slot = nullptr;
+    for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+        if (_slots[i].active && _slots[i].target == target) {
+            slot = &_slots[i];
+            _activeCount--;
+            break;
+        }
+    }
+    if (!slot) {
+        for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+            if (!_slots[i].active) {
+                slot = &_slots[i];
+                break;
+            }
+        }
+    }
+    if (!slot) return false;
+
+    if (durationMs == 0) {
+        slot->active = false;
+        _values[target] = to;
+        return true;
+    }
+
+    slot->active = true;
+    slot->target = target;
+    slot->easing = easing;
+    slot->from = from;
+    slot->to = to;
+    slot->durationMs = durationMs;
+    slot->startMs = nowMs;
+    _values[target] = from;
+    _activeCount++;
+    return true;
+}
+
+bool AnimationManager::update(uint32_t nowMs) {
+    bool changed = false;
+
+    for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+        Slot &slot = _slots[i];
+        if (!slot.active) continue;
+
+        uint32_t elapsed = nowMs - slot.startMs;
+        int16_t value;
+        if (elapsed >= slot.durationMs) {
+            value = slot.to;
+            slot.active = false;
+            _activeCount--;
+        } else {
+            int32_t t = (int32_t)(((uint64_t)elapsed << 16) / slot.durationMs);
+            int32_t p = ease(slot.easing, t);
+            value = slot.from + (int16_t)(((int64_t)(slot.to - slot.from) * p) >> 16);
+        }
+
+        if (_values[slot.target] != value) {
+            _values[slot.target] = value;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+bool AnimationManager::finishAll() {
+    bool changed = false;
+
+    for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+        Slot &slot = _slots[i];
+        if (!slot.active) continue;
+
+        if (_values[slot.target] != slot.to) {
+            _values[slot.target] = slot.to;
+            changed = true;
+        }
+        slot.active = false;
+    }
+    _activeCount = 0;
+
+    return changed;
+}
+
+int16_t AnimationManager::getValue(uint8_t target) const {
+    return target < MAX_TARGETS ? _values[target] : 0;
+}
+
+int32_t AnimationManager::ease(Easing easing, int32_t t) {
+    if (t <= 0) return 0;
+    if (t >= Q16_ONE) return Q16_ONE;
+
+    switch (easing) {
+        case Easing::EASE_OUT_QUAD: {
+            // 1 - (1-t)^2
+            int64_t u = Q16_ONE - t;
+            return Q16_ONE - (int32_t)((u * u) >> 16);
+        }
+        case Easing::EASE_OUT_CUBIC: {
+            // 1 - (1-t)^3
+            int64_t u = Q16_ONE - t;
+            int64_t u2 = (u * u) >> 16;
+            return Q16_ONE - (int32_t)((u2 * u) >> 16);
+        }
+        case Easing::EASE_IN_OUT_QUAD: {
+            // t<0.5: 2t^2；否则 1 - 2(1-t)^2
+            if (t < Q16_ONE / 2) {
+                return (int32_t)(((int64_t)t * t) >> 15);
+            }
+            int64_t u = Q16_ONE - t;
+            return Q16_ONE - (int32_t)((u * u) >> 15);
+        }
+        case Easing::LINEAR:
+        default:
+            return t;
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file AnimationManager.h
+ * @brief 固定容量、无动态分配的动画管理器
+ * @details 每个动画把一个目标（如显示行的Y偏移）从起始值插值到结束值：
+ * - 进度与缓动曲线使用Q16定点数计算，不依赖浮点
+ * - 同一目标同时只有一个动画，新动画会替换旧动画
+ * - finishAll() 立即跳到所有动画的结束值，用于新按键到来时打断动画
+ * - 由调用方在tick中传入当前时间推进，不创建任务也不分配内存
+ *
+ * @author Calculator Project
+ */
+
+#ifndef ANIMATION_MANAGER_H
+#define ANIMATION_MANAGER_H
+
+#include <stdint.h>
+
+/**
+ * @brief 缓动曲线类型
+ */
+enum class Easing : uint8_t {
+    LINEAR,             ///< 线性
+    EASE_OUT_QUAD,      ///< 二次减速
+    EASE_OUT_CUBIC,     ///< 三次减速
+    EASE_IN_OUT_QUAD    ///< 二次先加速后减速
+};
+
+class AnimationManager {
+public:
+    static const uint8_t MAX_ANIMATIONS = 4;    ///< 同时进行的动画上限
+    static const uint8_t MAX_TARGETS = 4;       ///< 可动画的目标数量
+    static const int32_t Q16_ONE = 65536;       ///< Q16定点数中的1.0
+
+    AnimationManager();
+
+    /**
+     * @brief 启动动画（同一目标已有动画时替换）
+     * @param target 目标编号（0 ~ MAX_TARGETS-1）
+     * @param from 起始值
+     * @param to 结束值
+     * @param durationMs 时长，0表示直接跳到结束值
+     * @param easing 缓动曲线
+     * @param nowMs 当前时间
+     * @return 目标编号无效或没有空闲槽位返回false
+     */
+    bool start(uint8_t target, int16_t from, int16_t to, uint16_t durationMs,
+               Easing easing, uint32_t nowMs);
+
+    /**
+     * @brief 按当前时间推进所有动画
+     * @return 有目标值发生变化返回true
+     */
+    bool update(uint32_t nowMs);
+
+    /**
+     * @brief 所有动画立即跳到结束值
+     * @return 有目标值发生变化返回true
+     */
+    bool finishAll();
+
+    /**
+     * @brief 获取目标当前值（没有动画过的目标为0）
+     */
+    int16_t getValue(uint8_t target) const;
+
+    /**
+     * @brief 正在进行的动画数量
+     */
+    uint8_t getActiveCount() const { return _activeCount; }
+
+    /**
+     * @brief 是否有动画正在进行
+     */
+    bool isActive() const { return _activeCount > 0; }
+
+    /**
+     * @brief 计算缓动后的进度
+     * @param easing 缓动曲线
+     * @param t 线性进度（Q16，0 ~ Q16_ONE）
+     * @return 缓动进度（Q16）
+     */
+    static int32_t ease(Easing easing, int32_t t);
+
+private:
+    struct Slot {
+        bool active;
+        uint8_t target;
+        Easing easing;
+        int16_t from;
+        int16_t to;
+        uint16_t durationMs;
+        uint32_t startMs;
+    };
+
+    Slot _slots[MAX_ANIMATIONS];
+    int16_t _values[MAX_TARGETS];
+    uint8_t _activeCount;
+};
+
+#endif // ANIMATION_MANAGER_H
@@ -0,0 +1,239 @@
+/**
+ * @file AudioOutput.cpp
+ * @brief 按键音I2S PDM输出实现
+ *
+ * @author Calculator Project
+ */
+
+#include "AudioOutput.h"
+#include "AudioSamples.h"
+#include "Logger.h"
+#include <driver/i2s.h>
+#include <string.h>
+
+#define TAG_AUDIO "Audio"
+
+#define AUDIO_I2S_PORT I2S_NUM_0        // S3只有I2S0支持PDM发送
+
+static_assert(AUDIO_SAMPLES_COUNT == AUDIO_SAMPLE_COUNT, "AudioSamples.h与AudioSampleId不一致，重新运行 tools/audio_bake.py");
+static_assert(AUDIO_SAMPLES_RATE == AUDIO_SAMPLE_RATE, "采样率已修改，重新运行 tools/audio_bake.py");
+
+namespace {
+
+const uint32_t WAVE_MASK = ((1UL << AUDIO_WAVE_BITS) << 16) - 1;
+const uint16_t RAMP_SAMPLES = AUDIO_SAMPLE_RATE * BUZZER_RELEASE_MS / 1000;
+
+} // namespace
+
+AudioOutput::AudioOutput()
+    : _task(nullptr),
+      _started(false),
+      _busy(false),
+      _noteHead(0),
+      _noteCount(0) {
+    memset(_voices, 0, sizeof(_voices));
+}
+
+bool AudioOutput::begin(uint8_t pin) {
+    if (_task) return true;
+
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_PDM);
+    config.sample_rate = AUDIO_SAMPLE_RATE;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    config.dma_buf_count = AUDIO_DMA_BUFFERS;
+    config.dma_buf_len = AUDIO_BLOCK_SAMPLES;
+    config.tx_desc_auto_clear = true;       // 来不及填充时输出静音而不是重复旧数据
+    esp_err_t err = i2s_driver_install(AUDIO_I2S_PORT, &config, 0, nullptr);
+    if (err != ESP_OK) {
+        LOG_E(TAG_AUDIO, "I2S安装失败: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    // PDM只需要数据线，时钟不引出
+    i2s_pin_config_t pins = {};
+    pins.mck_io_num = I2S_PIN_NO_CHANGE;
+    pins.bck_io_num = I2S_PIN_NO_CHANGE;
+    pins.ws_io_num = I2S_PIN_NO_CHANGE;
+    pins.data_out_num = pin;
+    pins.data_in_num = I2S_PIN_NO_CHANGE;
+    i2s_set_pin(AUDIO_I2S_PORT, &pins);
+    i2s_stop(AUDIO_I2S_PORT);
+
+    if (xTaskCreatePinnedToCore(taskEntry, "audio", 2560, this, AUDIO_TASK_PRIO, &_task,
+                                AUDIO_TASK_CORE) != pdPASS) {
+        _task = nullptr;
+        LOG_E(TAG_AUDIO, "播放任务创建失败");
+        i2s_driver_uninstall(AUDIO_I2S_PORT);
+        return false;
+    }
+    LOG_I(TAG_AUDIO, "I2S PDM输出: GPIO%d, %d Hz, %d×%d 采样DMA缓冲", pin, AUDIO_SAMPLE_RATE,
+          AUDIO_DMA_BUFFERS, AUDIO_BLOCK_SAMPLES);
+    return true;
+}
+
+uint16_t AudioOutput::volumeGain(uint8_t volume) {
+    // 按音量的平方取幅度，与LEDC占空比的听感一致
+    if (volume > 100) volume = 100;
+    return (uint16_t)(256UL * volume * volume / 10000);
+}
+
+bool AudioOutput::send(const Command& command) {
+    if (!_task || !_commands.push(command)) return false;
+    _busy.store(true, std::memory_order_release);
+    xTaskNotifyGive(_task);
+    return true;
+}
+
+bool AudioOutput::playSample(AudioSampleId id, uint8_t volume) {
+    if (id >= AUDIO_SAMPLE_COUNT) return false;
+    Command command = {CMD_SAMPLE, (uint8_t)id, 0, 0, volumeGain(volume)};
+    return send(command);
+}
+
+bool AudioOutput::playTone(uint16_t freq, uint16_t durationMs, uint8_t volume) {
+    Command command = {CMD_TONE, 0, freq, durationMs, volumeGain(volume)};
+    return send(command);
+}
+
+bool AudioOutput::enqueueTone(uint16_t freq, uint16_t durationMs, uint8_t volume) {
+    Command command = {CMD_NOTE, 0, freq, durationMs, volumeGain(volume)};
+    return send(command);
+}
+
+void AudioOutput::stop() {
+    Command command = {CMD_STOP, 0, 0, 0, 0};
+    send(command);
+}
+
+void AudioOutput::taskEntry(void* arg) {
+    static_cast<AudioOutput*>(arg)->run();
+}
+
+void AudioOutput::run() {
+    int16_t block[AUDIO_BLOCK_SAMPLES];
+    Command command;
+    size_t written;
+
+    for (;;) {
+        if (!active()) {
+            if (_started) {
+                // 排队的块放完后再停，尾音不被截断；停止后输出保持低电平
+                memset(block, 0, sizeof(block));
+                for (uint8_t i = 0; i < AUDIO_DMA_BUFFERS; i++) {
+                    i2s_write(AUDIO_I2S_PORT, block, sizeof(block), &written, portMAX_DELAY);
+                }
+                i2s_stop(AUDIO_I2S_PORT);
+                _started = false;
+            }
+            _busy.store(false, std::memory_order_release);
+            while (!_commands.pop(command)) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+            _busy.store(true, std::memory_order_release);
+            apply(command);
+        }
+        while (_commands.pop(command)) {
+            apply(command);
+        }
+        if (!active()) continue;
+
+        if (!_started) {
+            i2s_zero_dma_buffer(AUDIO_I2S_PORT);
+            i2s_start(AUDIO_I2S_PORT);
+            _started = true;
+        }
+        render(block);
+        // DMA缓冲都在排队时在这里等待，任务按块的节奏运行
+        i2s_write(AUDIO_I2S_PORT, block, sizeof(block), &written, portMAX_DELAY);
+    }
+}
+
+void AudioOutput::apply(const Command& command) {
+    switch (command.type) {
+        case CMD_SAMPLE: {
+            // 1号声音优先放采样；都在用时新的采样替换1号声音
+            Voice* voice = &_voices[1];
+            if (voice->data && !_voices[0].data && !_noteCount) voice = &_voices[0];
+            const AudioPcm& pcm = AUDIO_PCM[command.sample];
+            memset(voice, 0, sizeof(Voice));
+            voice->data = pcm.data;
+            voice->length = pcm.length;
+            voice->gain = command.gain;
+            break;
+        }
+        case CMD_TONE:
+            _noteCount = 0;
+            startTone(command);
+            break;
+        case CMD_NOTE:
+            if (!_voices[0].data) {
+                startTone(command);
+            } else if (_noteCount < COMMAND_QUEUE) {
+                _notes[(_noteHead + _noteCount++) % COMMAND_QUEUE] = command;
+            }
+            break;
+        case CMD_STOP:
+            _noteCount = 0;
+            memset(_voices, 0, sizeof(_voices));
+            break;
+    }
+}
+
+void AudioOutput::startTone(const Command& command) {
+    Voice& voice = _voices[0];
+    memset(&voice, 0, sizeof(Voice));
+    voice.data = AUDIO_SINE;
+    voice.length = (uint32_t)AUDIO_SAMPLE_RATE * command.durationMs / 1000;
+    voice.step = (uint32_t)(((uint64_t)command.freq << (AUDIO_WAVE_BITS + 16)) / AUDIO_SAMPLE_RATE);
+    voice.gain = command.freq ? command.gain : 0;     // 休止符只占时间
+    voice.ramp = RAMP_SAMPLES < voice.length / 4 ? RAMP_SAMPLES : voice.length / 4;
+    if (!voice.length) voice.data = nullptr;
+}
+
+bool AudioOutput::active() const {
+    return _voices[0].data || _voices[1].data || _noteCount;
+}
+
+void AudioOutput::render(int16_t* block) {
+    int32_t mix[AUDIO_BLOCK_SAMPLES];
+    memset(mix, 0, sizeof(mix));
+
+    for (uint8_t v = 0; v < VOICE_COUNT; v++) {
+        Voice& voice = _voices[v];
+        for (uint16_t i = 0; i < AUDIO_BLOCK_SAMPLES && voice.data; i++) {
+            int32_t sample;
+            if (voice.step) {
+                sample = voice.data[(voice.phase & WAVE_MASK) >> 16];
+                voice.phase += voice.step;
+            } else {
+                sample = voice.data[voice.pos];
+            }
+            int32_t gain = voice.gain;
+            if (voice.ramp) {
+                // 线性起音和收音，音的起止没有咔哒声
+                uint32_t edge = voice.pos < voice.length - voice.pos ? voice.pos : voice.length - voice.pos;
+                if (edge < voice.ramp) gain = gain * (int32_t)edge / voice.ramp;
+            }
+            mix[i] += sample * gain;
+
+            if (++voice.pos >= voice.length) {
+                voice.data = nullptr;
+                // 0号声音接着放排队的音
+                if (v == 0 && _noteCount) {
+                    Command next = _notes[_noteHead];
+                    _noteHead = (_noteHead + 1) % COMMAND_QUEUE;
+                    _noteCount--;
+                    startTone(next);
+                }
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        int32_t s = mix[i];
+        block[i] = s > INT16_MAX ? INT16_MAX : s < INT16_MIN ? INT16_MIN : (int16_t)s;
+    }
+}
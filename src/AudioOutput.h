@@ -0,0 +1,138 @@
+/**
+ * @file AudioOutput.h
+ * @brief 按键音：I2S PDM输出PCM采样，DMA推送
+ * @details LEDC方波（BuzzerSequencer）只能发单一频率的方波，音色单调，每个音符还要定时器切换。
+ * 这里把蜂鸣器引脚交给I2S0的PDM发送：
+ * - 采样是闪存中的8位PCM（tools/audio_bake.py 生成 AudioSamples.h）：按下/松开的“哒”声、确认和错误提示音
+ * - 任意频率的音（钢琴模式、长按音）循环读取一个周期的正弦波表，加起音和收音包络
+ * - 两个声音叠加：0号声音放音（新的音打断旧的，排队的音依次接上），1号声音优先放采样，
+ *   按键音和提示音同时响时不互相打断
+ * - 播放任务每块（AUDIO_BLOCK_SAMPLES）合成一次写入DMA缓冲，之后由DMA逐个采样输出；
+ *   没有逐采样的中断，也没有逐音符的定时器。DMA缓冲有 AUDIO_DMA_BUFFERS 块，新声音最多晚这么多块
+ * - 调用方只把命令放进无锁队列（SpscQueue）并通知播放任务，不等待、不进内核队列；
+ *   命令只能从主循环发出（按键反馈、串口命令）
+ * - 全部声音结束后送出静音块再停止I2S（停止后不占用时钟，不阻止浅睡眠）
+ *
+ * 压电片本身是低通滤波器，PDM的高频成分听不到；需要更大的音量时在引脚后加RC滤波和功放。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef AUDIO_OUTPUT_H
+#define AUDIO_OUTPUT_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "SpscQueue.h"
+
+/**
+ * @brief 预置采样（顺序同 tools/audio_bake.py 的 SAMPLES）
+ */
+enum AudioSampleId : uint8_t {
+    AUDIO_SAMPLE_CLICK,         ///< 按下
+    AUDIO_SAMPLE_RELEASE,       ///< 松开（双音效）
+    AUDIO_SAMPLE_CONFIRM,       ///< 确认：两个上行短音
+    AUDIO_SAMPLE_ERROR,         ///< 错误：两个下行低音
+    AUDIO_SAMPLE_COUNT
+};
+
+class AudioOutput {
+public:
+    static const uint8_t VOICE_COUNT = 2;
+    static const uint8_t COMMAND_QUEUE = 64;        ///< 命令队列，可用63条（22个音符加休止符的音阶也放得下）
+
+    static AudioOutput& instance() {
+        static AudioOutput instance;
+        return instance;
+    }
+
+    /**
+     * @brief 安装I2S0（PDM发送）并创建播放任务
+     * @details 以下播放和停止函数只能在主循环中调用（队列只有一个生产者）
+     * @param pin 输出引脚
+     */
+    bool begin(uint8_t pin);
+
+    /**
+     * @brief 播放采样，与正在放的音叠加
+     * @param volume 0-100
+     * @return 命令队列已满时返回false
+     */
+    bool playSample(AudioSampleId id, uint8_t volume);
+
+    /**
+     * @brief 打断正在放的音（和排队的音），立即放一个音
+     * @param freq 频率(Hz)，0为休止
+     */
+    bool playTone(uint16_t freq, uint16_t durationMs, uint8_t volume);
+
+    /**
+     * @brief 排在之前的音之后
+     */
+    bool enqueueTone(uint16_t freq, uint16_t durationMs, uint8_t volume);
+
+    /**
+     * @brief 停止全部声音
+     */
+    void stop();
+
+    /**
+     * @brief 有声音在放或有命令未处理
+     */
+    bool isPlaying() const { return _busy.load(std::memory_order_acquire); }
+
+private:
+    enum CommandType : uint8_t {
+        CMD_SAMPLE,
+        CMD_TONE,
+        CMD_NOTE,
+        CMD_STOP
+    };
+
+    struct Command {
+        CommandType type;
+        uint8_t sample;
+        uint16_t freq;
+        uint16_t durationMs;
+        uint16_t gain;
+    };
+
+    struct Voice {
+        const int8_t* data;         ///< nullptr表示空闲；音指向正弦波表
+        uint32_t length;            ///< 总采样数
+        uint32_t pos;               ///< 已输出的采样数
+        uint32_t phase;             ///< 波表相位（16.16定点），只用于音
+        uint32_t step;              ///< 每采样的相位增量，0表示按顺序播放采样
+        uint16_t gain;              ///< 音量（Q8，256为满幅）
+        uint16_t ramp;              ///< 起音/收音的采样数，0表示不加包络
+    };
+
+    AudioOutput();
+    AudioOutput(const AudioOutput&) = delete;
+    AudioOutput& operator=(const AudioOutput&) = delete;
+
+    static uint16_t volumeGain(uint8_t volume);
+    bool send(const Command& command);
+
+    // 以下只在播放任务中调用
+    static void taskEntry(void* arg);
+    void run();
+    void apply(const Command& command);
+    void startTone(const Command& command);
+    bool active() const;
+    void render(int16_t* block);
+
+    TaskHandle_t _task;
+    SpscQueue<Command, COMMAND_QUEUE> _commands;
+    bool _started;                  ///< I2S正在输出
+    std::atomic<bool> _busy;
+    Voice _voices[VOICE_COUNT];
+    Command _notes[COMMAND_QUEUE];  ///< 排队的音
+    uint8_t _noteHead;
+    uint8_t _noteCount;
+};
+
+#endif // AUDIO_OUTPUT_H
@@ -0,0 +1,428 @@
+// 由 tools/audio_bake.py 生成，不要手工修改
+// 16000 Hz 8位PCM，4 个采样共 9184 字节
+
+#ifndef AUDIO_SAMPLES_H
+#define AUDIO_SAMPLES_H
+
+#include <stdint.h>
+
+static const uint32_t AUDIO_SAMPLES_RATE = 16000;
+static const uint8_t AUDIO_SAMPLES_COUNT = 4;
+static const uint8_t AUDIO_WAVE_BITS = 6;
+
+static const int8_t AUDIO_PCM_CLICK[128] = {
+    -23, 127, 84, -80, -102, -3, 102, 69, -72, -104, 14, 74, 55, -62, -69, 8, 53, 51, -23, -68, -13, 51, 41, -32,
+    -51, -2, 31, 18, -24, -36, -5, 28, 15, -20, -33, -7, 32, 17, -13, -28, 6, 26, 9, -14, -17, 2, 22, 10,
+    -7, -14, -2, 15, 11, -6, -13, 1, 9, 5, -5, -11, -2, 10, 7, -5, -9, 0, 8, 6, -4, -7, 0, 5,
+    2, -3, -4, 0, 5, 2, -3, -3, 1, 4, 3, -3, -4, 1, 3, 2, -2, -3, 1, 2, 2, -1, -2, 0,
+    3, 1, -1, -2, 0, 2, 1, -1, -2, 0, 1, 1, -1, -1, 0, 1, 0, -1, -1, 0, 1, 1, 0, -1,
+    0, 1, 1, -1, -1, 0, 1, 0,
+};
+
+static const int8_t AUDIO_PCM_RELEASE[96] = {
+    10, 68, 56, 12, -30, -55, -30, 13, 49, 40, 1, -39, -40, -13, 24, 40, 24, -9, -29, -25, -4, 17, 23, 6,
+    -14, -18, -11, 6, 15, 11, -1, -14, -14, -2, 8, 11, 8, -2, -9, -7, 1, 8, 8, 4, -3, -8, -4, 2,
+    6, 5, 0, -4, -5, -1, 2, 5, 3, -1, -3, -2, 0, 3, 3, 1, -1, -3, -1, 1, 2, 2, 0, -1,
+    -2, -1, 1, 2, 1, -1, -1, -1, 0, 1, 1, 0, 0, -1, 0, 0, 1, 1, 0, 0, -1, 0, 0, 0,
+};
+
+static const int8_t AUDIO_PCM_CONFIRM[2880] = {
+    0, 2, 5, 6, 3, -5, -13, -16, -11, 2, 17, 26, 23, 7, -15, -33, -36, -21, 7, 34, 48, 38, 8, -29,
+    -54, -55, -28, 15, 54, 69, 51, 6, -45, -76, -72, -32, 26, 75, 89, 60, 0, -63, -99, -87, -32, 41, 98, 109,
+    67, -9, -81, -114, -92, -27, 52, 106, 109, 60, -18, -87, -114, -87, -18, 60, 109, 106, 52, -27, -92, -114, -81, -9,
+    67, 111, 102, 44, -35, -97, -113, -74, 0, 74, 113, 97, 35, -44, -102, -111, -67, 9, 81, 114, 92, 27, -52, -106,
+    -109, -60, 18, 87, 114, 87, 18, -60, -109, -106, -52, 27, 92, 114, 81, 9, -67, -111, -102, -44, 35, 97, 113, 74,
+    0, -74, -113, -97, -35, 44, 102, 111, 67, -9, -81, -114, -92, -27, 52, 106, 109, 60, -18, -87, -114, -87, -18, 60,
+    109, 106, 52, -27, -92, -114, -81, -9, 67, 111, 102, 44, -35, -97, -113, -74, 0, 74, 113, 97, 35, -44, -102, -111,
+    -67, 9, 81, 114, 92, 27, -52, -106, -109, -60, 18, 87, 114, 87, 18, -60, -109, -106, -52, 27, 92, 114, 81, 9,
+    -67, -111, -102, -44, 35, 97, 113, 74, 0, -74, -113, -97, -35, 44, 102, 111, 67, -9, -81, -114, -92, -27, 52, 106,
+    109, 60, -18, -87, -114, -87, -18, 60, 109, 106, 52, -27, -92, -114, -81, -9, 67, 111, 102, 44, -35, -97, -113, -74,
+    0, 74, 113, 97, 35, -44, -102, -111, -67, 9, 81, 114, 92, 27, -52, -106, -109, -60, 18, 87, 114, 87, 18, -60,
+    -109, -106, -52, 27, 92, 114, 81, 9, -67, -111, -102, -44, 35, 97, 113, 74, 0, -74, -113, -97, -35, 44, 102, 111,
+    67, -9, -81, -114, -92, -27, 52, 106, 109, 60, -18, -87, -114, -87, -18, 60, 109, 106, 52, -27, -92, -114, -81, -9,
+    67, 111, 102, 44, -35, -97, -113, -74, 0, 74, 113, 97, 35, -44, -102, -111, -67, 9, 81, 114, 92, 27, -52, -106,
+    -109, -60, 18, 87, 114, 87, 18, -60, -109, -106, -52, 27, 92, 114, 81, 9, -67, -111, -102, -44, 35, 97, 113, 74,
+    0, -74, -113, -97, -35, 44, 102, 111, 67, -9, -81, -114, -92, -27, 52, 106, 109, 60, -18, -87, -114, -87, -18, 60,
+    109, 106, 52, -27, -92, -114, -81, -9, 67, 111, 102, 44, -35, -97, -113, -74, 0, 74, 113, 97, 35, -44, -102, -111,
+    -67, 9, 81, 114, 92, 27, -52, -106, -109, -60, 18, 87, 114, 87, 18, -60, -109, -106, -52, 27, 92, 114, 81, 9,
+    -67, -111, -102, -44, 35, 97, 113, 74, 0, -74, -113, -97, -35, 44, 102, 111, 67, -9, -81, -114, -92, -27, 52, 106,
+    109, 60, -18, -87, -114, -87, -18, 60, 109, 106, 52, -27, -92, -114, -81, -9, 67, 111, 102, 44, -35, -97, -113, -74,
+    0, 74, 113, 97, 35, -44, -102, -111, -67, 9, 81, 114, 92, 27, -52, -106, -109, -60, 18, 87, 114, 87, 18, -60,
+    -109, -106, -52, 27, 92, 114, 81, 9, -67, -111, -102, -44, 35, 97, 113, 74, 0, -74, -113, -97, -35, 44, 102, 111,
+    67, -9, -81, -114, -92, -27, 52, 106, 109, 60, -18, -87, -114, -87, -18, 60, 109, 106, 52, -27, -92, -114, -81, -9,
+    67, 111, 102, 44, -35, -97, -113, -74, 0, 74, 113, 97, 35, -44, -102, -111, -67, 9, 81, 114, 92, 27, -52, -106,
+    -109, -60, 18, 87, 114, 87, 18, -60, -109, -106, -52, 27, 92, 114, 81, 9, -67, -111, -102, -44, 35, 97, 113, 74,
+    0, -74, -113, -97, -35, 44, 102, 111, 67, -9, -81, -114, -92, -27, 52, 106, 109, 60, -18, -87, -114, -87, -18, 60,
+    109, 106, 52, -27, -92, -114, -81, -9, 67, 111, 102, 44, -35, -97, -113, -74, 0, 74, 113, 97, 35, -44, -102, -111,
+    -67, 9, 81, 114, 92, 27, -52, -106, -109, -60, 18, 87, 114, 87, 18, -60, -109, -106, -52, 27, 92, 114, 81, 9,
+    -67, -111, -102, -44, 35, 97, 113, 74, 0, -74, -113, -97, -35, 44, 102, 111, 67, -9, -81, -114, -92, -27, 52, 106,
+    109, 60, -18, -87, -114, -87, -18, 60, 109, 106, 52, -27, -92, -114, -81, -9, 67, 111, 102, 44, -35, -97, -113, -74,
+    0, 74, 113, 97, 35, -44, -102, -111, -67, 9, 81, 114, 92, 27, -52, -106, -109, -60, 18, 87, 114, 87, 18, -60,
+    -109, -106, -52, 27, 92, 114, 81, 9, -67, -111, -102, -44, 35, 97, 113, 74, 0, -74, -113, -97, -35, 44, 102, 111,
+    67, -9, -81, -114, -92, -27, 52, 106, 109, 60, -18, -87, -114, -87, -18, 60, 109, 106, 52, -27, -92, -114, -81, -9,
+    67, 111, 102, 44, -35, -97, -113, -74, 0, 74, 113, 97, 35, -44, -102, -111, -67, 9, 81, 114, 92, 27, -52, -106,
+    -109, -60, 18, 87, 114, 87, 18, -60, -109, -106, -52, 27, 92, 114, 81, 9, -67, -111, -102, -44, 35, 97, 113, 74,
+    0, -74, -113, -97, -35, 44, 102, 111, 67, -9, -81, -114, -92, -27, 52, 106, 109, 60, -18, -87, -114, -87, -18, 60,
+    109, 106, 52, -27, -92, -114, -81, -9, 67, 111, 102, 44, -35, -97, -113, -74, 0, 73, 110, 94, 34, -41, -94, -101,
+    -60, 8, 71, 98, 79, 22, -43, -86, -87, -47, 14, 66, 86, 64, 13, -43, -76, -73, -35, 18, 60, 73, 51, 5,
+    -40, -65, -59, -25, 19, 52, 59, 38, 0, -36, -54, -45, -16, 19, 43, 46, 27, -3, -30, -41, -32, -9, 17, 33,
+    33, 17, -5, -23, -29, -21, -4, 13, 22, 20, 9, -4, -14, -16, -10, -1, 7, 10, 8, 3, -2, -4, -3, -1,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 2, 5, 2, -6, -12, -8, 5, 18, 17, 0, -21, -27, -10, 20, 36, 22, -13, -41, -37, 0, 40, 50, 17,
+    -34, -60, -36, 20, 63, 56, 0, -60, -72, -24, 48, 83, 50, -27, -86, -75, 0, 79, 95, 32, -62, -107, -64, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35,
+    109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92,
+    -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114,
+    67, -35, -109, -92, 0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92,
+    0, 92, 109, 35, -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 92, 109, 35,
+    -67, -114, -67, 35, 109, 92, 0, -92, -109, -35, 67, 114, 67, -35, -109, -92, 0, 91, 106, 34, -64, -107, -62, 32,
+    98, 82, 0, -80, -92, -30, 55, 93, 54, -28, -84, -71, 0, 68, 79, 25, -47, -79, -45, 23, 71, 59, 0, -57,
+    -65, -21, 39, 64, 37, -19, -57, -47, 0, 45, 52, 16, -30, -50, -29, 15, 43, 36, 0, -34, -38, -12, 22, 36,
+    20, -10, -30, -24, 0, 22, 24, 8, -13, -21, -12, 6, 16, 13, 0, -10, -11, -3, 5, 7, 3, -1, -3, -1,
+};
+
+static const int8_t AUDIO_PCM_ERROR[6080] = {
+    0, 1, 3, 6, 9, 13, 16, 17, 17, 15, 10, 3, -5, -14, -24, -33, -40, -45, -46, -44, -37, -27, -14, 2,
+    20, 37, 52, 65, 73, 76, 73, 64, 50, 30, 7, -18, -43, -66, -86, -99, -106, -104, -95, -77, -53, -23, 10, 43,
+    75, 100, 117, 126, 125, 115, 97, 71, 39, 5, -30, -62, -90, -111, -123, -127, -121, -106, -82, -53, -20, 15, 49, 79,
+    103, 119, 127, 125, 113, 93, 66, 34, 0, -34, -66, -93, -113, -125, -127, -119, -103, -79, -49, -15, 20, 53, 82, 106,
+    121, 127, 123, 111, 90, 62, 30, -5, -39, -71, -97, -115, -125, -126, -117, -100, -75, -44, -10, 25, 58, 86, 108, 122,
+    127, 122, 108, 86, 58, 25, -10, -44, -75, -100, -117, -126, -125, -115, -97, -71, -39, -5, 30, 62, 90, 111, 123, 127,
+    121, 106, 82, 53, 20, -15, -49, -79, -103, -119, -127, -125, -113, -93, -66, -34, 0, 34, 66, 93, 113, 125, 127, 119,
+    103, 79, 49, 15, -20, -53, -82, -106, -121, -127, -123, -111, -90, -62, -30, 5, 39, 71, 97, 115, 125, 126, 117, 100,
+    75, 44, 10, -25, -58, -86, -108, -122, -127, -122, -108, -86, -58, -25, 10, 44, 75, 100, 117, 126, 125, 115, 97, 71,
+    39, 5, -30, -62, -90, -111, -123, -127, -121, -106, -82, -53, -20, 15, 49, 79, 103, 119, 127, 125, 113, 93, 66, 34,
+    0, -34, -66, -93, -113, -125, -127, -119, -103, -79, -49, -15, 20, 53, 82, 106, 121, 127, 123, 111, 90, 62, 30, -5,
+    -39, -71, -97, -115, -125, -126, -117, -100, -75, -44, -10, 25, 58, 86, 108, 122, 127, 122, 108, 86, 58, 25, -10, -44,
+    -75, -100, -117, -126, -125, -115, -97, -71, -39, -5, 30, 62, 90, 111, 123, 127, 121, 106, 82, 53, 20, -15, -49, -79,
+    -103, -119, -127, -125, -113, -93, -66, -34, 0, 34, 66, 93, 113, 125, 127, 119, 103, 79, 49, 15, -20, -53, -82, -106,
+    -121, -127, -123, -111, -90, -62, -30, 5, 39, 71, 97, 115, 125, 126, 117, 100, 75, 44, 10, -25, -58, -86, -108, -122,
+    -127, -122, -108, -86, -58, -25, 10, 44, 75, 100, 117, 126, 125, 115, 97, 71, 39, 5, -30, -62, -90, -111, -123, -127,
+    -121, -106, -82, -53, -20, 15, 49, 79, 103, 119, 127, 125, 113, 93, 66, 34, 0, -34, -66, -93, -113, -125, -127, -119,
+    -103, -79, -49, -15, 20, 53, 82, 106, 121, 127, 123, 111, 90, 62, 30, -5, -39, -71, -97, -115, -125, -126, -117, -100,
+    -75, -44, -10, 25, 58, 86, 108, 122, 127, 122, 108, 86, 58, 25, -10, -44, -75, -100, -117, -126, -125, -115, -97, -71,
+    -39, -5, 30, 62, 90, 111, 123, 127, 121, 106, 82, 53, 20, -15, -49, -79, -103, -119, -127, -125, -113, -93, -66, -34,
+    0, 34, 66, 93, 113, 125, 127, 119, 103, 79, 49, 15, -20, -53, -82, -106, -121, -127, -123, -111, -90, -62, -30, 5,
+    39, 71, 97, 115, 125, 126, 117, 100, 75, 44, 10, -25, -58, -86, -108, -122, -127, -122, -108, -86, -58, -25, 10, 44,
+    75, 100, 117, 126, 125, 115, 97, 71, 39, 5, -30, -62, -90, -111, -123, -127, -121, -106, -82, -53, -20, 15, 49, 79,
+    103, 119, 127, 125, 113, 93, 66, 34, 0, -34, -66, -93, -113, -125, -127, -119, -103, -79, -49, -15, 20, 53, 82, 106,
+    121, 127, 123, 111, 90, 62, 30, -5, -39, -71, -97, -115, -125, -126, -117, -100, -75, -44, -10, 25, 58, 86, 108, 122,
+    127, 122, 108, 86, 58, 25, -10, -44, -75, -100, -117, -126, -125, -115, -97, -71, -39, -5, 30, 62, 90, 111, 123, 127,
+    121, 106, 82, 53, 20, -15, -49, -79, -103, -119, -127, -125, -113, -93, -66, -34, 0, 34, 66, 93, 113, 125, 127, 119,
+    103, 79, 49, 15, -20, -53, -82, -106, -121, -127, -123, -111, -90, -62, -30, 5, 39, 71, 97, 115, 125, 126, 117, 100,
+    75, 44, 10, -25, -58, -86, -108, -122, -127, -122, -108, -86, -58, -25, 10, 44, 75, 100, 117, 126, 125, 115, 97, 71,
+    39, 5, -30, -62, -90, -111, -123, -127, -121, -106, -82, -53, -20, 15, 49, 79, 103, 119, 127, 125, 113, 93, 66, 34,
+    0, -34, -66, -93, -113, -125, -127, -119, -103, -79, -49, -15, 20, 53, 82, 106, 121, 127, 123, 111, 90, 62, 30, -5,
+    -39, -71, -97, -115, -125, -126, -117, -100, -75, -44, -10, 25, 58, 86, 108, 122, 127, 122, 108, 86, 58, 25, -10, -44,
+    -75, -100, -117, -126, -125, -115, -97, -71, -39, -5, 30, 62, 90, 111, 123, 127, 121, 106, 82, 53, 20, -15, -49, -79,
+    -103, -119, -127, -125, -113, -93, -66, -34, 0, 34, 66, 93, 113, 125, 127, 119, 103, 79, 49, 15, -20, -53, -82, -106,
+    -121, -127, -123, -111, -90, -62, -30, 5, 39, 71, 97, 115, 125, 126, 117, 100, 75, 44, 10, -25, -58, -86, -108, -122,
+    -127, -122, -108, -86, -58, -25, 10, 44, 75, 100, 117, 126, 125, 115, 97, 71, 39, 5, -30, -62, -90, -111, -123, -127,
+    -121, -106, -82, -53, -20, 15, 49, 79, 103, 119, 127, 125, 113, 93, 66, 34, 0, -34, -66, -93, -113, -125, -127, -119,
+    -103, -79, -49, -15, 20, 53, 82, 106, 121, 127, 123, 111, 90, 62, 30, -5, -39, -71, -97, -115, -125, -126, -117, -100,
+    -75, -44, -10, 25, 58, 86, 108, 122, 127, 122, 108, 86, 58, 25, -10, -44, -75, -100, -117, -126, -125, -115, -97, -71,
+    -39, -5, 30, 62, 90, 111, 123, 127, 121, 106, 82, 53, 20, -15, -49, -79, -103, -119, -127, -125, -113, -93, -66, -34,
+    0, 34, 66, 93, 113, 125, 127, 119, 103, 79, 49, 15, -20, -53, -82, -106, -121, -127, -123, -111, -90, -62, -30, 5,
+    39, 71, 97, 115, 125, 126, 117, 100, 75, 44, 10, -25, -58, -86, -108, -122, -127, -122, -108, -86, -58, -25, 10, 44,
+    75, 100, 117, 126, 125, 115, 97, 71, 39, 5, -30, -62, -90, -111, -123, -127, -121, -106, -82, -53, -20, 15, 49, 79,
+    103, 119, 127, 125, 113, 93, 66, 34, 0, -34, -66, -93, -113, -125, -127, -119, -103, -79, -49, -15, 20, 53, 82, 106,
+    121, 127, 123, 111, 90, 62, 30, -5, -39, -71, -97, -115, -125, -126, -117, -100, -75, -44, -10, 25, 58, 86, 108, 122,
+    127, 122, 108, 86, 58, 25, -10, -44, -75, -100, -117, -126, -125, -115, -97, -71, -39, -5, 30, 62, 90, 111, 123, 127,
+    121, 106, 82, 53, 20, -15, -49, -79, -103, -119, -127, -125, -113, -93, -66, -34, 0, 34, 66, 93, 113, 125, 127, 119,
+    103, 79, 49, 15, -20, -53, -82, -106, -121, -127, -123, -111, -90, -62, -30, 5, 39, 71, 97, 115, 125, 126, 117, 100,
+    75, 44, 10, -25, -58, -86, -108, -122, -127, -122, -108, -86, -58, -25, 10, 44, 75, 100, 117, 126, 125, 115, 97, 71,
+    39, 5, -30, -62, -90, -111, -123, -127, -121, -106, -82, -53, -20, 15, 49, 79, 103, 119, 127, 125, 113, 93, 66, 34,
+    0, -34, -66, -93, -113, -125, -127, -119, -103, -79, -49, -15, 20, 53, 82, 106, 121, 127, 123, 111, 90, 62, 30, -5,
+    -39, -71, -97, -115, -125, -126, -117, -100, -75, -44, -10, 25, 58, 86, 108, 122, 127, 122, 108, 86, 58, 25, -10, -44,
+    -75, -100, -117, -126, -125, -115, -97, -71, -39, -5, 30, 62, 90, 111, 123, 127, 121, 106, 82, 53, 20, -15, -49, -79,
+    -103, -119, -127, -125, -113, -93, -66, -34, 0, 34, 66, 93, 113, 125, 127, 119, 103, 79, 49, 15, -20, -53, -82, -106,
+    -121, -127, -123, -111, -90, -62, -30, 5, 39, 71, 97, 115, 125, 126, 117, 100, 75, 44, 10, -25, -58, -86, -108, -122,
+    -127, -122, -108, -86, -58, -25, 10, 44, 75, 100, 117, 126, 125, 115, 97, 71, 39, 5, -30, -62, -90, -111, -123, -127,
+    -121, -106, -82, -53, -20, 15, 49, 79, 103, 119, 127, 125, 113, 93, 66, 34, 0, -34, -66, -93, -113, -125, -127, -119,
+    -103, -79, -49, -15, 20, 53, 82, 106, 121, 127, 123, 111, 90, 62, 30, -5, -39, -71, -97, -115, -125, -126, -117, -100,
+    -75, -44, -10, 25, 58, 86, 108, 122, 127, 122, 108, 86, 58, 25, -10, -44, -75, -100, -117, -126, -125, -115, -97, -71,
+    -39, -5, 30, 62, 90, 111, 123, 127, 121, 106, 82, 53, 20, -15, -49, -79, -103, -119, -127, -125, -113, -93, -66, -34,
+    0, 34, 66, 93, 113, 125, 127, 119, 103, 79, 49, 15, -20, -53, -82, -106, -121, -127, -123, -111, -90, -62, -30, 5,
+    39, 71, 97, 115, 125, 126, 117, 100, 75, 44, 10, -25, -58, -86, -108, -122, -127, -122, -108, -86, -58, -25, 10, 44,
+    75, 100, 117, 126, 125, 115, 97, 71, 39, 5, -30, -62, -90, -111, -123, -127, -121, -106, -82, -53, -20, 15, 49, 79,
+    103, 119, 127, 125, 113, 93, 66, 34, 0, -34, -66, -93, -113, -125, -127, -119, -103, -79, -49, -15, 20, 53, 82, 106,
+    121, 127, 123, 111, 90, 62, 30, -5, -39, -71, -97, -115, -125, -126, -117, -100, -75, -44, -10, 25, 58, 86, 108, 122,
+    127, 122, 108, 86, 58, 25, -10, -44, -75, -100, -117, -126, -125, -115, -97, -71, -39, -5, 30, 62, 90, 111, 123, 127,
+    121, 106, 82, 53, 20, -15, -49, -79, -103, -119, -127, -125, -113, -93, -66, -34, 0, 34, 66, 93, 113, 125, 127, 119,
+    103, 79, 49, 15, -20, -53, -82, -106, -121, -127, -123, -111, -90, -62, -30, 5, 39, 71, 97, 115, 125, 126, 117, 100,
+    75, 44, 10, -25, -58, -86, -108, -122, -127, -122, -108, -86, -58, -25, 10, 44, 75, 100, 117, 126, 125, 115, 97, 71,
+    39, 5, -30, -62, -90, -111, -123, -127, -121, -106, -82, -53, -20, 15, 49, 79, 103, 119, 127, 125, 113, 93, 66, 34,
+    0, -34, -66, -93, -113, -125, -127, -119, -103, -79, -49, -15, 20, 53, 82, 106, 121, 127, 123, 111, 90, 62, 30, -5,
+    -39, -71, -97, -115, -125, -126, -117, -100, -75, -44, -10, 25, 58, 86, 108, 122, 127, 122, 108, 86, 58, 25, -10, -44,
+    -75, -100, -117, -126, -125, -115, -97, -71, -39, -5, 30, 62, 90, 111, 123, 127, 121, 106, 82, 53, 20, -15, -49, -79,
+    -103, -119, -127, -125, -113, -93, -66, -34, 0, 34, 66, 93, 113, 125, 127, 119, 103, 79, 49, 15, -20, -53, -82, -106,
+    -121, -127, -123, -111, -90, -62, -30, 5, 39, 71, 97, 115, 125, 126, 117, 100, 75, 44, 10, -25, -58, -86, -108, -122,
+    -127, -122, -108, -86, -58, -25, 10, 44, 75, 100, 117, 126, 125, 115, 97, 71, 39, 5, -30, -62, -90, -111, -123, -127,
+    -121, -106, -82, -53, -20, 15, 49, 79, 103, 119, 127, 125, 113, 93, 66, 34, 0, -34, -65, -90, -107, -117, -117, -109,
+    -92, -70, -43, -13, 17, 45, 68, 86, 97, 100, 96, 84, 67, 46, 21, -4, -27, -49, -65, -76, -82, -80, -73, -61,
+    -45, -26, -6, 14, 32, 46, 57, 63, 64, 60, 51, 40, 26, 11, -4, -18, -30, -39, -44, -46, -44, -39, -31, -22,
+    -12, -1, 8, 16, 22, 26, 28, 27, 24, 20, 14, 9, 3, -2, -6, -9, -10, -10, -9, -8, -6, -3, -2, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 7, 10, 14, 17,
+    21, 24, 26, 27, 27, 26, 23, 19, 13, 6, -2, -11, -20, -30, -40, -49, -57, -63, -68, -71, -72, -70, -66, -59,
+    -50, -38, -24, -9, 7, 25, 42, 59, 75, 89, 101, 110, 116, 118, 117, 112, 103, 88, 71, 51, 30, 7, -15, -37,
+    -58, -77, -93, -107, -117, -124, -127, -126, -121, -112, -100, -84, -66, -46, -25, -2, 20, 42, 62, 81, 97, 110, 119, 125,
+    127, 125, 119, 110, 97, 81, 62, 42, 20, -2, -25, -46, -66, -84, -100, -112, -121, -126, -127, -124, -117, -107, -93, -77,
+    -58, -37, -15, 7, 30, 51, 71, 88, 103, 114, 122, 126, 127, 123, 115, 104, 90, 73, 53, 32, 10, -12, -34, -55,
+    -75, -92, -106, -116, -123, -127, -126, -122, -113, -101, -86, -68, -49, -27, -5, 17, 39, 60, 79, 95, 108, 118, 125, 127,
+    125, 120, 111, 98, 82, 64, 44, 22, 0, -22, -44, -64, -82, -98, -111, -120, -125, -127, -125, -118, -108, -95, -79, -60,
+    -39, -17, 5, 27, 49, 68, 86, 101, 113, 122, 126, 127, 123, 116, 106, 92, 75, 55, 34, 12, -10, -32, -53, -73,
+    -90, -104, -115, -123, -127, -126, -122, -114, -103, -88, -71, -51, -30, -7, 15, 37, 58, 77, 93, 107, 117, 124, 127, 126,
+    121, 112, 100, 84, 66, 46, 25, 2, -20, -42, -62, -81, -97, -110, -119, -125, -127, -125, -119, -110, -97, -81, -62, -42,
+    -20, 2, 25, 46, 66, 84, 100, 112, 121, 126, 127, 124, 117, 107, 93, 77, 58, 37, 15, -7, -30, -51, -71, -88,
+    -103, -114, -122, -126, -127, -123, -115, -104, -90, -73, -53, -32, -10, 12, 34, 55, 75, 92, 106, 116, 123, 127, 126, 122,
+    113, 101, 86, 68, 49, 27, 5, -17, -39, -60, -79, -95, -108, -118, -125, -127, -125, -120, -111, -98, -82, -64, -44, -22,
+    0, 22, 44, 64, 82, 98, 111, 120, 125, 127, 125, 118, 108, 95, 79, 60, 39, 17, -5, -27, -49, -68, -86, -101,
+    -113, -122, -126, -127, -123, -116, -106, -92, -75, -55, -34, -12, 10, 32, 53, 73, 90, 104, 115, 123, 127, 126, 122, 114,
+    103, 88, 71, 51, 30, 7, -15, -37, -58, -77, -93, -107, -117, -124, -127, -126, -121, -112, -100, -84, -66, -46, -25, -2,
+    20, 42, 62, 81, 97, 110, 119, 125, 127, 125, 119, 110, 97, 81, 62, 42, 20, -2, -25, -46, -66, -84, -100, -112,
+    -121, -126, -127, -124, -117, -107, -93, -77, -58, -37, -15, 7, 30, 51, 71, 88, 103, 114, 122, 126, 127, 123, 115, 104,
+    90, 73, 53, 32, 10, -12, -34, -55, -75, -92, -106, -116, -123, -127, -126, -122, -113, -101, -86, -68, -49, -27, -5, 17,
+    39, 60, 79, 95, 108, 118, 125, 127, 125, 120, 111, 98, 82, 64, 44, 22, 0, -22, -44, -64, -82, -98, -111, -120,
+    -125, -127, -125, -118, -108, -95, -79, -60, -39, -17, 5, 27, 49, 68, 86, 101, 113, 122, 126, 127, 123, 116, 106, 92,
+    75, 55, 34, 12, -10, -32, -53, -73, -90, -104, -115, -123, -127, -126, -122, -114, -103, -88, -71, -51, -30, -7, 15, 37,
+    58, 77, 93, 107, 117, 124, 127, 126, 121, 112, 100, 84, 66, 46, 25, 2, -20, -42, -62, -81, -97, -110, -119, -125,
+    -127, -125, -119, -110, -97, -81, -62, -42, -20, 2, 25, 46, 66, 84, 100, 112, 121, 126, 127, 124, 117, 107, 93, 77,
+    58, 37, 15, -7, -30, -51, -71, -88, -103, -114, -122, -126, -127, -123, -115, -104, -90, -73, -53, -32, -10, 12, 34, 55,
+    75, 92, 106, 116, 123, 127, 126, 122, 113, 101, 86, 68, 49, 27, 5, -17, -39, -60, -79, -95, -108, -118, -125, -127,
+    -125, -120, -111, -98, -82, -64, -44, -22, 0, 22, 44, 64, 82, 98, 111, 120, 125, 127, 125, 118, 108, 95, 79, 60,
+    39, 17, -5, -27, -49, -68, -86, -101, -113, -122, -126, -127, -123, -116, -106, -92, -75, -55, -34, -12, 10, 32, 53, 73,
+    90, 104, 115, 123, 127, 126, 122, 114, 103, 88, 71, 51, 30, 7, -15, -37, -58, -77, -93, -107, -117, -124, -127, -126,
+    -121, -112, -100, -84, -66, -46, -25, -2, 20, 42, 62, 81, 97, 110, 119, 125, 127, 125, 119, 110, 97, 81, 62, 42,
+    20, -2, -25, -46, -66, -84, -100, -112, -121, -126, -127, -124, -117, -107, -93, -77, -58, -37, -15, 7, 30, 51, 71, 88,
+    103, 114, 122, 126, 127, 123, 115, 104, 90, 73, 53, 32, 10, -12, -34, -55, -75, -92, -106, -116, -123, -127, -126, -122,
+    -113, -101, -86, -68, -49, -27, -5, 17, 39, 60, 79, 95, 108, 118, 125, 127, 125, 120, 111, 98, 82, 64, 44, 22,
+    0, -22, -44, -64, -82, -98, -111, -120, -125, -127, -125, -118, -108, -95, -79, -60, -39, -17, 5, 27, 49, 68, 86, 101,
+    113, 122, 126, 127, 123, 116, 106, 92, 75, 55, 34, 12, -10, -32, -53, -73, -90, -104, -115, -123, -127, -126, -122, -114,
+    -103, -88, -71, -51, -30, -7, 15, 37, 58, 77, 93, 107, 117, 124, 127, 126, 121, 112, 100, 84, 66, 46, 25, 2,
+    -20, -42, -62, -81, -97, -110, -119, -125, -127, -125, -119, -110, -97, -81, -62, -42, -20, 2, 25, 46, 66, 84, 100, 112,
+    121, 126, 127, 124, 117, 107, 93, 77, 58, 37, 15, -7, -30, -51, -71, -88, -103, -114, -122, -126, -127, -123, -115, -104,
+    -90, -73, -53, -32, -10, 12, 34, 55, 75, 92, 106, 116, 123, 127, 126, 122, 113, 101, 86, 68, 49, 27, 5, -17,
+    -39, -60, -79, -95, -108, -118, -125, -127, -125, -120, -111, -98, -82, -64, -44, -22, 0, 22, 44, 64, 82, 98, 111, 120,
+    125, 127, 125, 118, 108, 95, 79, 60, 39, 17, -5, -27, -49, -68, -86, -101, -113, -122, -126, -127, -123, -116, -106, -92,
+    -75, -55, -34, -12, 10, 32, 53, 73, 90, 104, 115, 123, 127, 126, 122, 114, 103, 88, 71, 51, 30, 7, -15, -37,
+    -58, -77, -93, -107, -117, -124, -127, -126, -121, -112, -100, -84, -66, -46, -25, -2, 20, 42, 62, 81, 97, 110, 119, 125,
+    127, 125, 119, 110, 97, 81, 62, 42, 20, -2, -25, -46, -66, -84, -100, -112, -121, -126, -127, -124, -117, -107, -93, -77,
+    -58, -37, -15, 7, 30, 51, 71, 88, 103, 114, 122, 126, 127, 123, 115, 104, 90, 73, 53, 32, 10, -12, -34, -55,
+    -75, -92, -106, -116, -123, -127, -126, -122, -113, -101, -86, -68, -49, -27, -5, 17, 39, 60, 79, 95, 108, 118, 125, 127,
+    125, 120, 111, 98, 82, 64, 44, 22, 0, -22, -44, -64, -82, -98, -111, -120, -125, -127, -125, -118, -108, -95, -79, -60,
+    -39, -17, 5, 27, 49, 68, 86, 101, 113, 122, 126, 127, 123, 116, 106, 92, 75, 55, 34, 12, -10, -32, -53, -73,
+    -90, -104, -115, -123, -127, -126, -122, -114, -103, -88, -71, -51, -30, -7, 15, 37, 58, 77, 93, 107, 117, 124, 127, 126,
+    121, 112, 100, 84, 66, 46, 25, 2, -20, -42, -62, -81, -97, -110, -119, -125, -127, -125, -119, -110, -97, -81, -62, -42,
+    -20, 2, 25, 46, 66, 84, 100, 112, 121, 126, 127, 124, 117, 107, 93, 77, 58, 37, 15, -7, -30, -51, -71, -88,
+    -103, -114, -122, -126, -127, -123, -115, -104, -90, -73, -53, -32, -10, 12, 34, 55, 75, 92, 106, 116, 123, 127, 126, 122,
+    113, 101, 86, 68, 49, 27, 5, -17, -39, -60, -79, -95, -108, -118, -125, -127, -125, -120, -111, -98, -82, -64, -44, -22,
+    0, 22, 44, 64, 82, 98, 111, 120, 125, 127, 125, 118, 108, 95, 79, 60, 39, 17, -5, -27, -49, -68, -86, -101,
+    -113, -122, -126, -127, -123, -116, -106, -92, -75, -55, -34, -12, 10, 32, 53, 73, 90, 104, 115, 123, 127, 126, 122, 114,
+    103, 88, 71, 51, 30, 7, -15, -37, -58, -77, -93, -107, -117, -124, -127, -126, -121, -112, -100, -84, -66, -46, -25, -2,
+    20, 42, 62, 81, 97, 110, 119, 125, 127, 125, 119, 110, 97, 81, 62, 42, 20, -2, -25, -46, -66, -84, -100, -112,
+    -121, -126, -127, -124, -117, -107, -93, -77, -58, -37, -15, 7, 30, 51, 71, 88, 103, 114, 122, 126, 127, 123, 115, 104,
+    90, 73, 53, 32, 10, -12, -34, -55, -75, -92, -106, -116, -123, -127, -126, -122, -113, -101, -86, -68, -49, -27, -5, 17,
+    39, 60, 79, 95, 108, 118, 125, 127, 125, 120, 111, 98, 82, 64, 44, 22, 0, -22, -44, -64, -82, -98, -111, -120,
+    -125, -127, -125, -118, -108, -95, -79, -60, -39, -17, 5, 27, 49, 68, 86, 101, 113, 122, 126, 127, 123, 116, 106, 92,
+    75, 55, 34, 12, -10, -32, -53, -73, -90, -104, -115, -123, -127, -126, -122, -114, -103, -88, -71, -51, -30, -7, 15, 37,
+    58, 77, 93, 107, 117, 124, 127, 126, 121, 112, 100, 84, 66, 46, 25, 2, -20, -42, -62, -81, -97, -110, -119, -125,
+    -127, -125, -119, -110, -97, -81, -62, -42, -20, 2, 25, 46, 66, 84, 100, 112, 121, 126, 127, 124, 117, 107, 93, 77,
+    58, 37, 15, -7, -30, -51, -71, -88, -103, -114, -122, -126, -127, -123, -115, -104, -90, -73, -53, -32, -10, 12, 34, 55,
+    75, 92, 106, 116, 123, 127, 126, 122, 113, 101, 86, 68, 49, 27, 5, -17, -39, -60, -79, -95, -108, -118, -125, -127,
+    -125, -120, -111, -98, -82, -64, -44, -22, 0, 22, 44, 64, 82, 98, 111, 120, 125, 127, 125, 118, 108, 95, 79, 60,
+    39, 17, -5, -27, -49, -68, -86, -101, -113, -122, -126, -127, -123, -116, -106, -92, -75, -55, -34, -12, 10, 32, 53, 73,
+    90, 104, 115, 123, 127, 126, 122, 114, 103, 88, 71, 51, 30, 7, -15, -37, -58, -77, -93, -107, -117, -124, -127, -126,
+    -121, -112, -100, -84, -66, -46, -25, -2, 20, 42, 62, 81, 97, 110, 119, 125, 127, 125, 119, 110, 97, 81, 62, 42,
+    20, -2, -25, -46, -66, -84, -100, -112, -121, -126, -127, -124, -117, -107, -93, -77, -58, -37, -15, 7, 30, 51, 71, 88,
+    103, 114, 122, 126, 127, 123, 115, 104, 90, 73, 53, 32, 10, -12, -34, -55, -75, -92, -106, -116, -123, -127, -126, -122,
+    -113, -101, -86, -68, -49, -27, -5, 17, 39, 60, 79, 95, 108, 118, 125, 127, 125, 120, 111, 98, 82, 64, 44, 22,
+    0, -22, -44, -64, -82, -98, -111, -120, -125, -127, -125, -118, -108, -95, -79, -60, -39, -17, 5, 27, 49, 68, 86, 101,
+    113, 122, 126, 127, 123, 116, 106, 92, 75, 55, 34, 12, -10, -32, -53, -73, -90, -104, -115, -123, -127, -126, -122, -114,
+    -103, -88, -71, -51, -30, -7, 15, 37, 58, 77, 93, 107, 117, 124, 127, 126, 121, 112, 100, 84, 66, 46, 25, 2,
+    -20, -42, -62, -81, -97, -110, -119, -125, -127, -125, -119, -110, -97, -81, -62, -42, -20, 2, 25, 46, 66, 84, 100, 112,
+    121, 126, 127, 124, 117, 107, 93, 77, 58, 37, 15, -7, -30, -51, -71, -88, -103, -114, -122, -126, -127, -123, -115, -104,
+    -90, -73, -53, -32, -10, 12, 34, 55, 75, 92, 106, 116, 123, 127, 126, 122, 113, 101, 86, 68, 49, 27, 5, -17,
+    -39, -60, -79, -95, -108, -118, -125, -127, -125, -120, -111, -98, -82, -64, -44, -22, 0, 22, 44, 64, 82, 98, 111, 120,
+    125, 127, 125, 118, 108, 95, 79, 60, 39, 17, -5, -27, -49, -68, -86, -101, -113, -122, -126, -127, -123, -116, -106, -92,
+    -75, -55, -34, -12, 10, 32, 53, 73, 90, 104, 115, 123, 127, 126, 122, 114, 103, 88, 71, 51, 30, 7, -15, -37,
+    -58, -77, -93, -107, -117, -124, -127, -126, -121, -112, -100, -84, -66, -46, -25, -2, 20, 42, 62, 81, 97, 110, 119, 125,
+    127, 125, 119, 110, 97, 81, 62, 42, 20, -2, -25, -46, -66, -84, -100, -112, -121, -126, -127, -124, -117, -107, -93, -77,
+    -58, -37, -15, 7, 30, 51, 71, 88, 103, 114, 122, 126, 127, 123, 115, 104, 90, 73, 53, 32, 10, -12, -34, -55,
+    -75, -92, -106, -116, -123, -127, -126, -122, -113, -101, -86, -68, -49, -27, -5, 17, 39, 60, 79, 95, 108, 118, 125, 127,
+    125, 120, 111, 98, 82, 64, 44, 22, 0, -22, -44, -64, -82, -98, -111, -120, -125, -127, -125, -118, -108, -95, -79, -60,
+    -39, -17, 5, 27, 49, 68, 86, 101, 113, 122, 126, 127, 123, 116, 106, 92, 75, 55, 34, 12, -10, -32, -53, -73,
+    -90, -104, -115, -123, -127, -126, -122, -114, -103, -88, -71, -51, -30, -7, 15, 37, 58, 77, 93, 107, 117, 124, 127, 126,
+    121, 112, 100, 84, 66, 46, 25, 2, -20, -42, -62, -81, -97, -110, -119, -125, -127, -125, -119, -110, -97, -81, -62, -42,
+    -20, 2, 25, 46, 66, 84, 100, 112, 121, 126, 127, 124, 117, 107, 93, 77, 58, 37, 15, -7, -30, -51, -71, -88,
+    -103, -114, -122, -126, -127, -123, -115, -104, -90, -73, -53, -32, -10, 12, 34, 55, 75, 92, 106, 116, 123, 127, 126, 122,
+    113, 101, 86, 68, 49, 27, 5, -17, -39, -60, -79, -95, -108, -118, -125, -127, -125, -120, -111, -98, -82, -64, -44, -22,
+    0, 22, 44, 64, 82, 98, 111, 120, 125, 127, 125, 118, 108, 95, 79, 60, 39, 17, -5, -27, -49, -68, -86, -101,
+    -113, -122, -126, -127, -123, -116, -106, -92, -75, -55, -34, -12, 10, 32, 53, 73, 90, 104, 115, 123, 127, 126, 122, 114,
+    103, 88, 71, 51, 30, 7, -15, -37, -58, -77, -93, -107, -117, -124, -127, -126, -121, -112, -100, -84, -66, -46, -25, -2,
+    20, 42, 62, 81, 97, 110, 119, 125, 127, 125, 119, 110, 97, 81, 62, 42, 20, -2, -25, -46, -66, -84, -100, -112,
+    -121, -126, -127, -124, -117, -107, -93, -77, -58, -37, -15, 7, 30, 51, 71, 88, 103, 114, 122, 126, 127, 123, 115, 104,
+    90, 73, 53, 32, 10, -12, -34, -55, -75, -92, -106, -116, -123, -127, -126, -122, -113, -101, -86, -68, -49, -27, -5, 17,
+    39, 60, 79, 95, 108, 118, 125, 127, 125, 120, 111, 98, 82, 64, 44, 22, 0, -22, -44, -64, -82, -98, -111, -120,
+    -125, -127, -125, -118, -108, -95, -79, -60, -39, -17, 5, 27, 49, 68, 86, 101, 113, 122, 126, 127, 123, 116, 106, 92,
+    75, 55, 34, 12, -10, -32, -53, -73, -90, -104, -115, -123, -127, -126, -122, -114, -103, -88, -71, -51, -30, -7, 15, 37,
+    58, 77, 93, 107, 117, 124, 127, 126, 121, 112, 100, 84, 66, 46, 25, 2, -20, -42, -62, -81, -97, -110, -119, -125,
+    -127, -125, -119, -110, -97, -81, -62, -42, -20, 2, 25, 46, 66, 84, 100, 112, 121, 126, 127, 124, 117, 107, 93, 77,
+    58, 37, 15, -7, -30, -51, -71, -88, -103, -114, -122, -126, -127, -123, -115, -104, -90, -73, -53, -32, -10, 12, 34, 55,
+    75, 92, 106, 116, 123, 127, 126, 122, 113, 101, 86, 68, 49, 27, 5, -17, -39, -60, -79, -95, -108, -118, -125, -127,
+    -125, -120, -111, -98, -82, -64, -44, -22, 0, 22, 44, 64, 82, 98, 111, 120, 125, 127, 125, 118, 108, 95, 79, 60,
+    39, 17, -5, -27, -49, -68, -86, -101, -113, -122, -126, -127, -123, -116, -106, -92, -75, -55, -34, -12, 10, 32, 53, 73,
+    90, 104, 115, 123, 127, 126, 122, 114, 103, 88, 71, 51, 30, 7, -15, -37, -58, -77, -93, -107, -117, -124, -127, -126,
+    -121, -112, -100, -84, -66, -46, -25, -2, 20, 42, 62, 81, 97, 110, 119, 125, 127, 125, 119, 110, 97, 81, 62, 42,
+    20, -2, -25, -46, -66, -84, -100, -112, -121, -126, -127, -124, -117, -107, -93, -77, -58, -37, -15, 7, 30, 51, 71, 88,
+    103, 114, 122, 126, 127, 123, 115, 104, 90, 73, 53, 32, 10, -12, -34, -55, -75, -92, -106, -116, -123, -127, -126, -122,
+    -113, -101, -86, -68, -49, -27, -5, 17, 39, 60, 79, 95, 108, 118, 125, 127, 125, 120, 111, 98, 82, 64, 44, 22,
+    0, -22, -44, -64, -82, -98, -111, -120, -125, -127, -125, -118, -108, -95, -79, -60, -39, -17, 5, 27, 49, 68, 86, 101,
+    113, 122, 126, 127, 123, 116, 106, 92, 75, 55, 34, 12, -10, -32, -53, -73, -90, -104, -115, -123, -127, -126, -122, -114,
+    -103, -88, -71, -51, -30, -7, 15, 37, 58, 77, 93, 107, 117, 124, 127, 126, 121, 112, 100, 84, 66, 46, 25, 2,
+    -20, -42, -62, -81, -97, -110, -119, -125, -127, -125, -119, -110, -97, -81, -62, -42, -20, 2, 25, 46, 66, 84, 100, 112,
+    121, 126, 127, 124, 117, 107, 93, 77, 58, 37, 15, -7, -30, -51, -71, -88, -103, -114, -122, -126, -127, -123, -115, -104,
+    -90, -73, -53, -32, -10, 12, 34, 55, 75, 92, 106, 116, 123, 127, 126, 122, 113, 101, 86, 68, 49, 27, 5, -17,
+    -39, -60, -79, -95, -108, -118, -125, -127, -125, -120, -111, -98, -82, -64, -44, -22, 0, 22, 44, 64, 82, 98, 111, 120,
+    125, 127, 125, 118, 108, 95, 79, 60, 39, 17, -5, -27, -49, -68, -86, -101, -113, -122, -126, -127, -123, -116, -106, -92,
+    -75, -55, -34, -12, 10, 32, 53, 73, 90, 104, 115, 123, 127, 126, 122, 114, 103, 88, 71, 51, 30, 7, -15, -37,
+    -58, -77, -93, -107, -117, -124, -127, -126, -121, -112, -100, -84, -66, -46, -25, -2, 20, 42, 62, 81, 97, 110, 119, 125,
+    127, 125, 119, 110, 97, 81, 62, 42, 20, -2, -25, -46, -66, -84, -100, -112, -121, -126, -127, -124, -117, -107, -93, -77,
+    -58, -37, -15, 7, 30, 51, 71, 88, 103, 114, 122, 126, 127, 123, 115, 104, 90, 73, 53, 32, 10, -12, -34, -55,
+    -75, -92, -106, -116, -123, -127, -126, -122, -113, -101, -86, -68, -49, -27, -5, 17, 39, 60, 79, 95, 108, 118, 125, 127,
+    125, 120, 111, 98, 82, 64, 44, 22, 0, -22, -44, -64, -82, -98, -111, -120, -125, -127, -125, -118, -108, -95, -79, -60,
+    -39, -17, 5, 27, 49, 68, 86, 101, 113, 122, 126, 127, 123, 116, 106, 92, 75, 55, 34, 12, -10, -32, -53, -73,
+    -90, -104, -115, -123, -127, -126, -122, -114, -103, -88, -71, -51, -30, -7, 15, 37, 58, 77, 93, 107, 117, 124, 127, 126,
+    121, 112, 100, 84, 66, 46, 25, 2, -20, -42, -62, -81, -97, -110, -119, -125, -127, -125, -119, -110, -97, -81, -62, -42,
+    -20, 2, 25, 46, 66, 84, 100, 112, 121, 126, 127, 124, 117, 107, 93, 77, 58, 37, 15, -7, -30, -51, -71, -88,
+    -103, -114, -122, -126, -127, -123, -115, -104, -90, -73, -53, -32, -10, 12, 34, 55, 75, 92, 106, 116, 123, 127, 126, 122,
+    113, 101, 86, 68, 49, 27, 5, -17, -39, -60, -79, -95, -108, -118, -125, -127, -125, -120, -111, -98, -82, -64, -44, -22,
+    0, 22, 44, 64, 82, 98, 111, 120, 125, 127, 125, 118, 108, 95, 79, 60, 39, 17, -5, -27, -49, -68, -86, -101,
+    -113, -122, -126, -127, -123, -116, -106, -92, -75, -55, -34, -12, 10, 32, 53, 73, 90, 104, 115, 123, 127, 126, 122, 114,
+    103, 88, 71, 51, 30, 7, -15, -37, -58, -77, -93, -107, -117, -124, -127, -126, -121, -112, -100, -84, -66, -46, -25, -2,
+    20, 42, 62, 81, 97, 110, 119, 125, 127, 125, 119, 110, 97, 81, 62, 42, 20, -2, -25, -46, -66, -84, -100, -112,
+    -121, -126, -127, -124, -117, -107, -93, -77, -58, -37, -15, 7, 30, 51, 71, 88, 103, 114, 122, 126, 127, 123, 115, 104,
+    90, 73, 53, 32, 10, -12, -34, -55, -75, -92, -106, -116, -123, -127, -126, -122, -113, -101, -86, -68, -49, -27, -5, 17,
+    39, 60, 79, 95, 108, 118, 125, 127, 125, 120, 111, 98, 82, 64, 44, 22, 0, -22, -44, -64, -82, -98, -111, -120,
+    -125, -127, -125, -118, -108, -95, -79, -60, -39, -17, 5, 27, 49, 68, 86, 101, 113, 122, 126, 127, 123, 116, 106, 92,
+    75, 55, 34, 12, -10, -32, -53, -73, -90, -104, -115, -123, -127, -126, -122, -114, -103, -88, -71, -51, -30, -7, 15, 37,
+    58, 77, 93, 107, 117, 124, 127, 126, 121, 112, 100, 84, 66, 46, 25, 2, -20, -42, -62, -81, -97, -110, -119, -125,
+    -127, -123, -116, -105, -92, -76, -57, -38, -18, 2, 22, 40, 56, 71, 82, 91, 97, 99, 98, 95, 88, 79, 68, 55,
+    40, 25, 10, -5, -19, -32, -44, -54, -62, -67, -70, -71, -70, -66, -61, -53, -45, -35, -25, -15, -4, 5, 15, 23,
+    30, 35, 40, 42, 43, 43, 41, 38, 34, 29, 24, 18, 12, 6, 1, -4, -8, -11, -14, -15, -16, -16, -16, -14,
+    -13, -10, -8, -6, -4, -2, -1, 0,
+};
+
+static const int8_t AUDIO_SINE[64] = {
+    0, 12, 25, 37, 49, 60, 71, 81, 90, 98, 106, 112, 117, 122, 125, 126, 127, 126, 125, 122, 117, 112, 106, 98,
+    90, 81, 71, 60, 49, 37, 25, 12, 0, -12, -25, -37, -49, -60, -71, -81, -90, -98, -106, -112, -117, -122, -125, -126,
+    -127, -126, -125, -122, -117, -112, -106, -98, -90, -81, -71, -60, -49, -37, -25, -12,
+};
+
+struct AudioPcm {
+    const int8_t* data;
+    uint16_t length;
+};
+
+// 顺序同 AudioOutput.h 的 AudioSampleId
+static const AudioPcm AUDIO_PCM[4] = {
+    {AUDIO_PCM_CLICK, 128},
+    {AUDIO_PCM_RELEASE, 96},
+    {AUDIO_PCM_CONFIRM, 2880},
+    {AUDIO_PCM_ERROR, 6080},
+};
+
+#endif // AUDIO_SAMPLES_H
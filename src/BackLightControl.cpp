@@ -1,59 +1,110 @@
 #include "BackLightControl.h"
+#include "LoopScheduler.h"
+#include <driver/ledc.h>
+#include <math.h>
 
 // 动态计算最大占空比，基于 LEDC_TIMER_BIT 位数
 #define MAX_DUTY_CYCLE ((1 << LEDC_TIMER_BIT) - 1)
 
+// ESP32-S3只有低速通道；Arduino的0-7号通道即低速组的0-7号通道
+#define BACKLIGHT_SPEED_MODE LEDC_LOW_SPEED_MODE
+#define BACKLIGHT_CHANNEL ((ledc_channel_t)LEDC_CHANNEL_0)
+
 void BacklightControl::begin() {
     if (!_initialized) {
         // 配置 LEDC 通道并附加到 GPIO (使用兼容API)
         ledcSetup(LEDC_CHANNEL_0, LEDC_BASE_FREQ, LEDC_TIMER_BIT);
         ledcAttachPin(LCD_BL, LEDC_CHANNEL_0);
-        
+
+        // 硬件渐变需要LEDC中断服务
+        ledc_fade_func_install(0);
+
         // 设置初始值
-        _currentBrightness = 0;
-        ledcWrite(LEDC_CHANNEL_0, _currentBrightness);
-        
+        _startLevel = 0;
+        _targetBrightness = 0;
+        ledcWrite(LEDC_CHANNEL_0, 0);
+
         _initialized = true;
-        
+
         #ifdef DEBUG_MODE
         Serial.println("背光控制器初始化完成");
         #endif
     }
 }
 
+// 人眼对亮度的感知接近幂函数，百分比按gamma换算后低亮度段不再明显跳变
+uint32_t BacklightControl::percentToDuty(float percent) {
+    if (percent <= 0) return 0;
+    if (percent >= 100) return MAX_DUTY_CYCLE;
+    uint32_t duty = (uint32_t)(powf(percent / 100.0f, BACKLIGHT_GAMMA) * MAX_DUTY_CYCLE + 0.5f);
+    return duty ? duty : 1;  // 非零亮度至少保留一级，避免直接熄灭
+}
+
+float BacklightControl::levelAt(uint32_t elapsed) const {
+    if (elapsed >= _fadeDuration) return _targetBrightness;
+    return _startLevel + (_targetBrightness - _startLevel) * elapsed / _fadeDuration;
+}
+
 void BacklightControl::update() {
     if (!_initialized || !_isFading) return;
 
     uint32_t currentTime = millis();
+
+    // 等硬件把当前一段走完再继续
+    if (_segmentBusy) {
+        if ((int32_t)(currentTime - _segmentEnd) < 0) {
+            LoopScheduler::instance().at(_segmentEnd);
+            return;
+        }
+        if (ledc_get_duty(BACKLIGHT_SPEED_MODE, BACKLIGHT_CHANNEL) != _segmentDuty) {
+            LoopScheduler::instance().after(1);
+            return;
+        }
+        _segmentBusy = false;
+    }
+
     uint32_t elapsedTime = currentTime - _fadeStartTime;
 
     if (elapsedTime >= _fadeDuration) {
-        // 渐变结束
-        _currentBrightness = _targetBrightness;
-        ledcWrite(LEDC_CHANNEL_0, _currentBrightness);
+        // 渐变结束（分段渐变的最后一段已到达目标，这里只处理无渐变时间的直接设置）
+        uint32_t duty = percentToDuty(_targetBrightness);
+        if (ledc_get_duty(BACKLIGHT_SPEED_MODE, BACKLIGHT_CHANNEL) != duty) {
+            ledcWrite(LEDC_CHANNEL_0, duty);
+        }
+        _startLevel = _targetBrightness;
         _isFading = false;
-        
+
         #ifdef DEBUG_MODE
-        Serial.printf("渐变完成. 亮度: %d\n", _currentBrightness);
+        Serial.printf("渐变完成. 亮度: %d%% (占空比 %u)\n", _targetBrightness, (unsigned)duty);
         #endif
+        return;
+    }
+
+    // 启动下一段：段内占空比由硬件线性推进
+    uint32_t segmentEnd = elapsedTime + BACKLIGHT_FADE_SEGMENT_MS;
+    if (segmentEnd > _fadeDuration) segmentEnd = _fadeDuration;
+    uint32_t segmentMs = segmentEnd - elapsedTime;
+    _segmentLevel = levelAt(segmentEnd);
+    _segmentDuty = percentToDuty(_segmentLevel);
+
+    if (ledc_set_fade_with_time(BACKLIGHT_SPEED_MODE, BACKLIGHT_CHANNEL, _segmentDuty, segmentMs) == ESP_OK &&
+        ledc_fade_start(BACKLIGHT_SPEED_MODE, BACKLIGHT_CHANNEL, LEDC_FADE_NO_WAIT) == ESP_OK) {
+        _segmentBusy = true;
+        _segmentEnd = currentTime + segmentMs;
+        LoopScheduler::instance().at(_segmentEnd);
     } else {
-        // 计算当前应该的亮度，使用浮点数确保平滑渐变
-        float progress = (float)elapsedTime / _fadeDuration;
-        float brightnessDiff = _targetBrightness - _startBrightness;  // 使用起始亮度
-        _currentBrightness = _startBrightness + (brightnessDiff * progress);
-        
-        // 将当前计算的亮度写入LEDC
-        ledcWrite(LEDC_CHANNEL_0, _currentBrightness);
-        
-        #ifdef DEBUG_MODE
-        if(elapsedTime % 100 == 0) {  // 每100ms打印一次调试信息
-            Serial.printf("渐变中... 进度: %.2f%%, 亮度: %d\n", 
-                        progress * 100, _currentBrightness);
-        }
-        #endif
+        // 硬件渐变不可用时直接跳到段终点
+        ledcWrite(LEDC_CHANNEL_0, _segmentDuty);
+        LoopScheduler::instance().after(segmentMs);
     }
 }
 
+uint8_t BacklightControl::getCurrentBrightness() const {
+    if (!_isFading) return _targetBrightness;
+    if (_segmentBusy && (int32_t)(millis() - _segmentEnd) >= 0) return (uint8_t)(_segmentLevel + 0.5f);
+    return (uint8_t)(levelAt(millis() - _fadeStartTime) + 0.5f);
+}
+
 bool BacklightControl::setBacklight(uint8_t targetPercent, float fadeTime) {
     if (!_initialized) {
         begin();
@@ -62,24 +113,28 @@ bool BacklightControl::setBacklight(uint8_t targetPercent, float fadeTime) {
     // 限制目标亮度百分比在 0-100 之间
     targetPercent = constrain(targetPercent, 0, 100);
 
-    // 将百分比转换为 0 到 MAX_DUTY_CYCLE 的 PWM 值
-    uint8_t newTargetBrightness = map(targetPercent, 0, 100, 0, MAX_DUTY_CYCLE);
-
     // 如果目标亮度与当前亮度相同，不需要渐变
-    if (newTargetBrightness == _currentBrightness) {
+    if (!_isFading && targetPercent == _targetBrightness) {
         return true;
     }
 
-    // 保存起始亮度，用于渐变计算
-    _startBrightness = _currentBrightness;
-    _targetBrightness = newTargetBrightness;
+    // 新渐变从正在执行的一段的终点开始，否则从当前亮度开始
+    uint32_t now = millis();
+    if (_segmentBusy) {
+        _startLevel = _segmentLevel;
+        _fadeStartTime = (int32_t)(now - _segmentEnd) < 0 ? _segmentEnd : now;
+    } else {
+        _startLevel = _isFading ? levelAt(now - _fadeStartTime) : _targetBrightness;
+        _fadeStartTime = now;
+    }
+    _targetBrightness = targetPercent;
     _fadeDuration = fadeTime;
-    _fadeStartTime = millis();
     _isFading = true;
+    LoopScheduler::instance().after(0);
 
     #ifdef DEBUG_MODE
-    Serial.printf("开始渐变从 %d 到 %d 持续 %.0f毫秒\n", 
-                 _startBrightness, _targetBrightness, fadeTime);
+    Serial.printf("开始渐变从 %.1f%% 到 %d%% 持续 %.0f毫秒\n",
+                 _startLevel, _targetBrightness, fadeTime);
     #endif
 
     return true;
@@ -92,4 +147,4 @@ void initLEDC() {
 
 bool setBacklight(uint8_t targetPercent, float fadeTime) {
     return BacklightControl::getInstance().setBacklight(targetPercent, fadeTime);
-}
\ No newline at end of file
+}
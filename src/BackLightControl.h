@@ -12,6 +12,12 @@
     #error "LCD_BL pin is not defined. Please define the LCD_BL pin in config.h or another header."
 #endif
 
+/**
+ * 背光渐变由LEDC硬件完成：亮度百分比经gamma校正换算为占空比，
+ * 渐变按BACKLIGHT_FADE_SEGMENT_MS分段，每段交给ledc_fade_start()非阻塞执行，
+ * 主循环只在段结束时启动下一段。
+ * 正在执行的段不会被打断（IDF在硬件渐变期间会阻塞新的渐变请求），新的亮度请求从该段结束处开始。
+ */
 class BacklightControl {
 public:
     static BacklightControl& getInstance() {
@@ -22,22 +28,31 @@ public:
     void begin();
     void update();  // 新增：需要在主循环中调用以更新渐变效果
     bool setBacklight(uint8_t targetPercent, float fadeTime = 500);
-    uint8_t getCurrentBrightness() const { return _currentBrightness; }
+    uint8_t getCurrentBrightness() const;  // 当前亮度百分比（0-100），渐变中按进度估算
+    bool isFading() const { return _isFading; }
 
 private:
     BacklightControl() {}  // 私有构造函数
-    
+
+    float levelAt(uint32_t elapsed) const;      // 渐变开始后elapsed毫秒时的亮度百分比
+    static uint32_t percentToDuty(float percent);
+
     bool _initialized = false;
-    uint8_t _currentBrightness = 0;
-    uint8_t _startBrightness = 0;   // 新增：渐变开始时的亮度
-    uint8_t _targetBrightness = 0;
+    float _startLevel = 0;          // 渐变开始时的亮度百分比
+    uint8_t _targetBrightness = 0;  // 目标亮度百分比
     uint32_t _fadeStartTime = 0;
     uint32_t _fadeDuration = 0;
     bool _isFading = false;
+
+    // 正在由硬件执行的一段
+    bool _segmentBusy = false;
+    uint32_t _segmentEnd = 0;       // 预计结束时间（millis）
+    uint32_t _segmentDuty = 0;      // 段结束时的占空比
+    float _segmentLevel = 0;        // 段结束时的亮度百分比
 };
 
 // 为了保持与现有代码兼容的全局函数
 void initLEDC();
 bool setBacklight(uint8_t targetPercent, float fadeTime = 500);
 
-#endif // BACKLIGHT_CONTROL_H
\ No newline at end of file
+#endif // BACKLIGHT_CONTROL_H
@@ -0,0 +1,58 @@
+/**
+ * @file BannerCache.cpp
+ * @brief 结果行错误信息的预渲染像素缓存实现
+ *
+ * @author Calculator Project
+ */
+
+#include "BannerCache.h"
+#include "BufferPlacement.h"
+#include "PixelKernels.h"
+
+BannerCache::BannerCache() : _next(0) {
+    for (uint8_t i = 0; i < SLOTS; i++) {
+        _slots[i].key = 0;
+        _slots[i].pixels = nullptr;
+        _slots[i].w = 0;
+        _slots[i].h = 0;
+    }
+}
+
+BannerCache::~BannerCache() {
+    for (uint8_t i = 0; i < SLOTS; i++) {
+        placedFree(_slots[i].pixels);
+    }
+}
+
+bool BannerCache::draw(uint64_t key, uint16_t *fb, int16_t fbW, int16_t fbH, int16_t x, int16_t y) {
+    if (!fb) return false;
+    for (uint8_t i = 0; i < SLOTS; i++) {
+        const Slot &slot = _slots[i];
+        if (!slot.pixels || slot.key != key) continue;
+        if (!fits(fbW, fbH, x, y, slot.w, slot.h)) return false;
+        for (int16_t r = 0; r < slot.h; r++) {
+            pixelCopy(fb + (int32_t)(y + r) * fbW + x, slot.pixels + (int32_t)r * slot.w, slot.w);
+        }
+        return true;
+    }
+    return false;
+}
+
+void BannerCache::capture(uint64_t key, const uint16_t *fb, int16_t fbW, int16_t fbH,
+                          int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (!fb || !fits(fbW, fbH, x, y, w, h)) return;
+
+    Slot &slot = _slots[_next];
+    if (!slot.pixels || (int32_t)slot.w * slot.h != (int32_t)w * h) {
+        placedFree(slot.pixels);
+        slot.pixels = (uint16_t *)placedAlloc("error_banner", (size_t)w * h * 2, PLACE_PSRAM);
+        if (!slot.pixels) return;
+    }
+    _next = (_next + 1) % SLOTS;
+    for (int16_t r = 0; r < h; r++) {
+        pixelCopy(slot.pixels + (int32_t)r * w, fb + (int32_t)(y + r) * fbW + x, w);
+    }
+    slot.key = key;
+    slot.w = w;
+    slot.h = h;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file BannerCache.h
+ * @brief 结果行错误信息的预渲染像素缓存
+ * @details 错误信息是中文，不能走字形缓存，CjkText逐点合并线段绘制比复制字形慢得多：
+ * - 第一次显示某个错误时照常用CjkText画到Canvas帧缓冲，随后把那块像素整块复制保存
+ * - 之后同一错误（同字号、同颜色）直接逐行复制回帧缓冲，与字形缓存的开销相同
+ * - 以错误码、字号和前景/背景色为键，主题切换后颜色不同自然不命中，不需要单独清除
+ * - 每个槽位按信息实际大小单独分配（优先PSRAM），槽位用完时轮流替换；错误种类只有几个，实际上不会替换
+ * 只用于16位帧缓冲；调色板Canvas或直接驱动屏幕时调用方照常绘制。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef BANNER_CACHE_H
+#define BANNER_CACHE_H
+
+#include <stdint.h>
+
+class BannerCache {
+public:
+    static const uint8_t SLOTS = 4;             ///< 缓存的错误信息数
+
+    BannerCache();
+    ~BannerCache();
+
+    static uint64_t key(uint8_t error, uint8_t drawSize, uint16_t fg, uint16_t bg) {
+        return (uint64_t)error << 40 | (uint64_t)drawSize << 32 | (uint32_t)fg << 16 | bg;
+    }
+
+    /**
+     * @brief 命中时把缓存的像素复制到帧缓冲
+     * @return 未命中或放不下时返回false，调用方照常绘制后调用capture()
+     */
+    bool draw(uint64_t key, uint16_t *fb, int16_t fbW, int16_t fbH, int16_t x, int16_t y);
+
+    /**
+     * @brief 保存帧缓冲中刚画好的一块像素（分配失败时不缓存）
+     */
+    void capture(uint64_t key, const uint16_t *fb, int16_t fbW, int16_t fbH,
+                 int16_t x, int16_t y, int16_t w, int16_t h);
+
+private:
+    struct Slot {
+        uint64_t key;
+        uint16_t *pixels;                       ///< w×h，nullptr表示空槽
+        int16_t w;
+        int16_t h;
+    };
+
+    static bool fits(int16_t fbW, int16_t fbH, int16_t x, int16_t y, int16_t w, int16_t h) {
+        return x >= 0 && y >= 0 && w > 0 && h > 0 && x + w <= fbW && y + h <= fbH;
+    }
+
+    Slot _slots[SLOTS];
+    uint8_t _next;                              ///< 下一个被替换的槽位
+};
+
+#endif // BANNER_CACHE_H
@@ -0,0 +1,229 @@
+/**
+ * @file BatteryMonitor.cpp
+ * @brief 电池电量监测实现
+ *
+ * @author Calculator Project
+ */
+
+#include "BatteryMonitor.h"
+
+#if BATTERY_ADC_PIN >= 0
+
+#include "Console.h"
+#include "Logger.h"
+
+#define BATTERY_BURST_TIMEOUT_MS 100    // 一批转换的最长等待（正常约BATTERY_SAMPLES/频率）
+
+namespace {
+
+// 锂电池开路电压（毫伏）到电量百分比，小电流放电时的典型曲线
+struct VoltagePoint {
+    uint16_t millivolts;
+    uint8_t percent;
+};
+
+const VoltagePoint DISCHARGE_TABLE[] = {
+    {3300, 0},  {3500, 5},  {3610, 10}, {3690, 20}, {3740, 30}, {3770, 40},
+    {3800, 50}, {3840, 60}, {3890, 70}, {3960, 80}, {4050, 90}, {4150, 100},
+};
+const size_t DISCHARGE_POINTS = sizeof(DISCHARGE_TABLE) / sizeof(DISCHARGE_TABLE[0]);
+
+void cmdBattery(const ConsoleArgs&) {
+    BatteryMonitor::instance().printStatus();
+}
+
+constexpr ConsoleCommand BATTERY_COMMANDS[] = {
+    {"battery", "", "显示电池电压、电量和采样统计", cmdBattery},
+};
+static_assert(consoleSorted(BATTERY_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+BatteryMonitor::BatteryMonitor()
+    : _task(nullptr),
+      _channel(0),
+      _busy(false),
+      _filtered(0),
+      _millivolts(0),
+      _percent(0),
+      _hasReading(false),
+      _notified(0),
+      _bursts(0),
+      _failures(0),
+      _lastRaw(0),
+      _lastSamples(0),
+      _levelCallback(nullptr),
+      _levelContext(nullptr) {
+    memset(&_calibration, 0, sizeof(_calibration));
+}
+
+bool BatteryMonitor::begin() {
+    if (_task) return true;
+
+    int8_t channel = digitalPinToAnalogChannel(BATTERY_ADC_PIN);
+    if (channel < 0 || channel >= SOC_ADC_CHANNEL_NUM(0)) {
+        BATTERY_LOG_E("GPIO%d 不是ADC1引脚", BATTERY_ADC_PIN);
+        return false;
+    }
+    _channel = (uint8_t)channel;
+
+    // 每批一次中断：DMA结果攒满BUFFER_BYTES才交给驱动
+    adc_digi_init_config_t init = {};
+    init.max_store_buf_size = BUFFER_BYTES * 2;
+    init.conv_num_each_intr = BUFFER_BYTES;
+    init.adc1_chan_mask = BIT(_channel);
+    init.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&init) != ESP_OK) {
+        BATTERY_LOG_E("ADC连续模式初始化失败");
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_11;
+    pattern.channel = _channel;
+    pattern.unit = 0;                   // ADC1
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+    adc_digi_configuration_t config = {};
+    config.conv_limit_en = false;
+    config.conv_limit_num = 250;
+    config.pattern_num = 1;
+    config.adc_pattern = &pattern;
+    config.sample_freq_hz = BATTERY_ADC_FREQ_HZ;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    if (adc_digi_controller_configure(&config) != ESP_OK) {
+        BATTERY_LOG_E("ADC连续模式配置失败");
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    esp_adc_cal_value_t source = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                                          1100, &_calibration);
+
+    Console::instance().addCommands(BATTERY_COMMANDS);
+    if (xTaskCreatePinnedToCore(taskEntry, "battery", 3072, this, BATTERY_TASK_PRIO, &_task,
+                                BATTERY_TASK_CORE) != pdPASS) {
+        _task = nullptr;
+        adc_digi_deinitialize();
+        BATTERY_LOG_E("监测任务创建失败");
+        return false;
+    }
+    BATTERY_LOG_I("电池监测: GPIO%d（ADC1通道%u），校准: %s", BATTERY_ADC_PIN, _channel,
+                  source == ESP_ADC_CAL_VAL_EFUSE_TP_FIT ? "eFuse两点拟合"
+                  : source == ESP_ADC_CAL_VAL_EFUSE_TP ? "eFuse两点" : "默认参考电压");
+    return true;
+}
+
+void BatteryMonitor::taskEntry(void* arg) {
+    static_cast<BatteryMonitor*>(arg)->run();
+}
+
+void BatteryMonitor::run() {
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        uint32_t average;
+        if (sampleBurst(average)) {
+            update(average);
+        } else {
+            _failures++;
+        }
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(BATTERY_SAMPLE_MS));
+    }
+}
+
+bool BatteryMonitor::sampleBurst(uint32_t& average) {
+    _busy = true;
+    uint32_t length = 0;
+    // 上一批停止前多转换的结果留在环形缓冲里，先取走
+    while (adc_digi_read_bytes(_buffer, BUFFER_BYTES, &length, 0) == ESP_OK && length) {
+    }
+
+    if (adc_digi_start() != ESP_OK) {
+        _busy = false;
+        return false;
+    }
+    // 任务阻塞到DMA写满一批；溢出（ESP_ERR_INVALID_STATE）时数据仍然有效
+    esp_err_t err = adc_digi_read_bytes(_buffer, BUFFER_BYTES, &length, BATTERY_BURST_TIMEOUT_MS);
+    adc_digi_stop();
+    _busy = false;
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return false;
+    }
+
+    uint32_t sum = 0;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* result = reinterpret_cast<const adc_digi_output_data_t*>(_buffer + i);
+        if (result->type2.unit == 0 && result->type2.channel == _channel) {
+            sum += result->type2.data;
+            count++;
+        }
+    }
+    _lastSamples = count;
+    if (!count) {
+        return false;
+    }
+    average = (sum + count / 2) / count;
+    _lastRaw = average;
+    _bursts++;
+    return true;
+}
+
+void BatteryMonitor::update(uint32_t raw) {
+    uint32_t pin = esp_adc_cal_raw_to_voltage(raw, &_calibration);
+    int32_t millivolts = (int32_t)(pin * BATTERY_DIVIDER_NUM / BATTERY_DIVIDER_DEN);
+
+    // 一阶低通：每批向新读数靠近1/2^BATTERY_IIR_SHIFT；第一批直接采用
+    int32_t scaled = millivolts << FILTER_FRACTION_BITS;
+    bool first = !_hasReading;
+    if (first) {
+        _filtered = scaled;
+    } else {
+        _filtered += (scaled - _filtered) >> BATTERY_IIR_SHIFT;
+    }
+    _millivolts = (uint16_t)(_filtered >> FILTER_FRACTION_BITS);
+    _percent = lookup(_millivolts);
+    _hasReading = true;
+
+    int change = (int)_percent - (int)_notified;
+    if (first || change >= BATTERY_HYSTERESIS || change <= -BATTERY_HYSTERESIS) {
+        _notified = _percent;
+        BATTERY_LOG_D("电池 %u mV，%u%%", _millivolts, _percent);
+        if (_levelCallback) {
+            _levelCallback(_percent, _levelContext);
+        }
+    }
+}
+
+uint8_t BatteryMonitor::lookup(uint16_t millivolts) {
+    if (millivolts <= DISCHARGE_TABLE[0].millivolts) return 0;
+    for (size_t i = 1; i < DISCHARGE_POINTS; i++) {
+        const VoltagePoint& high = DISCHARGE_TABLE[i];
+        if (millivolts < high.millivolts) {
+            const VoltagePoint& low = DISCHARGE_TABLE[i - 1];
+            return (uint8_t)(low.percent + (high.percent - low.percent) * (millivolts - low.millivolts) /
+                                               (high.millivolts - low.millivolts));
+        }
+    }
+    return 100;
+}
+
+uint8_t BatteryMonitor::bars(uint8_t percent) {
+    return (percent >= BATTERY_LOW_PERCENT) + (percent >= 50) + (percent >= 85);
+}
+
+void BatteryMonitor::printStatus() const {
+    Serial.println("--- 电池 ---");
+    if (!_hasReading) {
+        Serial.println("还没有读数");
+    } else {
+        Serial.printf("电压: %u mV，电量: %u%%%s\n", _millivolts, _percent,
+                      _percent < BATTERY_LOW_PERCENT ? "（低电量）" : "");
+    }
+    Serial.printf("采样: 每 %u ms 一批 %u 次（%u Hz），完成 %lu 批，失败 %lu 批\n", BATTERY_SAMPLE_MS,
+                  BATTERY_SAMPLES, BATTERY_ADC_FREQ_HZ, (unsigned long)_bursts, (unsigned long)_failures);
+    Serial.printf("最近一批: 原始均值 %lu，有效结果 %lu\n", (unsigned long)_lastRaw, (unsigned long)_lastSamples);
+}
+
+#endif // BATTERY_ADC_PIN >= 0
@@ -0,0 +1,116 @@
+/**
+ * @file BatteryMonitor.h
+ * @brief 电池电量监测
+ * @details 电池电压经分压（BATTERY_DIVIDER_NUM/DEN）接到ADC1引脚BATTERY_ADC_PIN：
+ * - 采样用ADC连续模式：每BATTERY_SAMPLE_MS由低优先级任务启动一批BATTERY_SAMPLES次转换，
+ *   DMA写满缓冲才产生一次中断，期间CPU不参与；取平均后停止ADC
+ *   （运行期间ADC驱动持有APB频率锁，停止后释放，不妨碍动态调频和浅睡眠）
+ * - 平均值按eFuse中的出厂校准换算为毫伏，一阶IIR滤波后查锂电池开路电压表得到电量百分比
+ * - 百分比变化达到BATTERY_HYSTERESIS时通知（状态栏图标、休眠管理器的低电量缩短）
+ *
+ * 充电时测到的是充电电压，百分比偏高。没有电池测量电路时BATTERY_ADC_PIN为-1，不编译。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if BATTERY_ADC_PIN >= 0
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+
+class BatteryMonitor {
+public:
+    /**
+     * @brief 电量变化的通知（在监测任务中调用）
+     */
+    typedef void (*LevelCallback)(uint8_t percent, void* context);
+
+    static BatteryMonitor& instance() {
+        static BatteryMonitor instance;
+        return instance;
+    }
+
+    /**
+     * @brief 初始化ADC连续模式和校准，注册串口命令并创建监测任务
+     */
+    bool begin();
+
+    void setLevelCallback(LevelCallback callback, void* context) {
+        _levelContext = context;
+        _levelCallback = callback;
+    }
+
+    bool hasReading() const { return _hasReading; }
+    uint16_t getMillivolts() const { return _millivolts; }     ///< 电池电压（滤波后）
+    uint8_t getPercent() const { return _percent; }
+
+    /**
+     * @brief 正在采样（ADC运行中，期间不能浅睡眠）
+     */
+    bool isBusy() const { return _busy; }
+
+    /**
+     * @brief 电池电压对应的电量百分比（查表插值）
+     */
+    static uint8_t lookup(uint16_t millivolts);
+
+    /**
+     * @brief 电量格数（0-3），状态栏图标用
+     */
+    static uint8_t bars(uint8_t percent);
+
+    void printStatus() const;
+
+private:
+    static const uint8_t FILTER_FRACTION_BITS = 4;
+    static const uint32_t BUFFER_BYTES = BATTERY_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES;
+
+    BatteryMonitor();
+
+    static void taskEntry(void* arg);
+    void run();
+
+    /**
+     * @brief 启动一批转换，等DMA写满后停止
+     * @param average 输出：本批原始读数的平均值
+     */
+    bool sampleBurst(uint32_t& average);
+
+    /**
+     * @brief 滤波并更新百分比，变化足够大时通知
+     */
+    void update(uint32_t raw);
+
+    TaskHandle_t _task;
+    uint8_t _buffer[BUFFER_BYTES];  ///< 从DMA环形缓冲取出的一批结果
+    uint8_t _channel;               ///< ADC1通道
+    esp_adc_cal_characteristics_t _calibration;
+    volatile bool _busy;
+
+    int32_t _filtered;              ///< 滤波后的电压（毫伏，FILTER_FRACTION_BITS位小数）
+    volatile uint16_t _millivolts;
+    volatile uint8_t _percent;
+    volatile bool _hasReading;
+    uint8_t _notified;              ///< 上次通知的百分比
+
+    // 统计
+    uint32_t _bursts;               ///< 完成的批数
+    uint32_t _failures;             ///< 读取失败或没有本通道数据的批数
+    uint32_t _lastRaw;              ///< 最近一批的平均原始读数
+    uint32_t _lastSamples;          ///< 最近一批属于本通道的结果数
+
+    LevelCallback _levelCallback;
+    void* _levelContext;
+};
+
+#endif // BATTERY_ADC_PIN >= 0
+
+#endif // BATTERY_MONITOR_H
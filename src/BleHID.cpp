@@ -0,0 +1,218 @@
+/**
+ * @file BleHID.cpp
+ * @brief BLE HID键盘传输实现
+ *
+ * @author Calculator Project
+ */
+
+#include "BleHID.h"
+
+#if BLE_HID_ENABLED
+
+#include "Logger.h"
+#include <BLESecurity.h>
+
+#define TAG_BLE "BleHID"
+
+class BleHID::ServerCallbacks : public BLEServerCallbacks {
+public:
+    void onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) override {
+        BleHID::instance().onConnect(param->connect.remote_bda, param->connect.conn_params.interval,
+                                     param->connect.conn_params.latency);
+    }
+
+    void onDisconnect(BLEServer* server) override {
+        BleHID::instance().onDisconnect();
+    }
+};
+
+class BleHID::OutputCallbacks : public BLECharacteristicCallbacks {
+public:
+    void onWrite(BLECharacteristic* characteristic) override {
+        BleHID& self = BleHID::instance();
+        std::string value = characteristic->getValue();
+        if (self._outputCallback && !value.empty()) {
+            self._outputCallback(self._outputReportId, (const uint8_t*)value.data(), value.length(),
+                                 self._outputContext);
+        }
+    }
+};
+
+BleHID::BleHID()
+    : _server(nullptr)
+    , _device(nullptr)
+    , _reportCount(0)
+    , _outputReportId(0)
+    , _idleTimer(nullptr)
+    , _connected(false)
+    , _fast(false)
+    , _interval(0)
+    , _latency(0)
+    , _lastSend(0)
+    , _paramUpdates(0)
+    , _connectionCallback(nullptr)
+    , _connectionContext(nullptr)
+    , _outputCallback(nullptr)
+    , _outputContext(nullptr) {
+    memset(_inputs, 0, sizeof(_inputs));
+    memset(_reportIds, 0, sizeof(_reportIds));
+    memset(_peer, 0, sizeof(_peer));
+}
+
+bool BleHID::begin(const uint8_t* reportMap, size_t length, const uint8_t* reportIds, uint8_t reportCount,
+                   uint8_t outputReportId) {
+    if (_server) {
+        return true;
+    }
+    if (reportCount > MAX_REPORTS) {
+        return false;
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = idleTimerEntry;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "bleIdle";
+    if (esp_timer_create(&args, &_idleTimer) != ESP_OK) {
+        LOG_E(TAG_BLE, "空闲定时器创建失败");
+        return false;
+    }
+
+    LOG_I(TAG_BLE, "启动蓝牙协议栈");
+    BLEDevice::init(BLE_HID_NAME);
+    BLEDevice::setCustomGapHandler(gapHandler);
+    _server = BLEDevice::createServer();
+    _server->setCallbacks(new ServerCallbacks());
+
+    _device = new BLEHIDDevice(_server);
+    for (uint8_t i = 0; i < reportCount; i++) {
+        _reportIds[i] = reportIds[i];
+        _inputs[i] = _device->inputReport(reportIds[i]);
+    }
+    _reportCount = reportCount;
+    _outputReportId = outputReportId;
+    _device->outputReport(outputReportId)->setCallbacks(new OutputCallbacks());
+    _device->manufacturer()->setValue("PawCounter");
+    _device->pnp(0x02, 0x303A, 0x4002, 0x0100);     // USB VID来源，乐鑫VID
+    _device->hidInfo(0x00, 0x03);                   // 非本地化，远程唤醒，常连接（normally connectable）
+    _device->reportMap(const_cast<uint8_t*>(reportMap), length);
+    _device->startServices();
+    _device->setBatteryLevel(100);
+
+    // 键盘需要绑定，主机重连时不必重新配对
+    BLESecurity* security = new BLESecurity();
+    security->setAuthenticationMode(ESP_LE_AUTH_BOND);
+
+    BLEAdvertising* advertising = _server->getAdvertising();
+    advertising->setAppearance(HID_KEYBOARD);
+    advertising->addServiceUUID(_device->hidService()->getUUID());
+    advertising->start();
+    LOG_I(TAG_BLE, "开始广播: %s", BLE_HID_NAME);
+    return true;
+}
+
+void BleHID::onConnect(const esp_bd_addr_t address, uint16_t interval, uint16_t latency) {
+    memcpy(_peer, address, sizeof(_peer));
+    _interval = interval;
+    _latency = latency;
+    _fast = false;
+    _connected = true;
+    LOG_I(TAG_BLE, "已连接，间隔 %u×1.25ms，从机延迟 %u", interval, latency);
+    // 连接后先用空闲参数，有输入时再加快
+    requestParams(false);
+    if (_connectionCallback) {
+        _connectionCallback(true, _connectionContext);
+    }
+}
+
+void BleHID::onDisconnect() {
+    _connected = false;
+    esp_timer_stop(_idleTimer);
+    LOG_I(TAG_BLE, "连接断开，重新广播");
+    _server->startAdvertising();
+    if (_connectionCallback) {
+        _connectionCallback(false, _connectionContext);
+    }
+}
+
+void BleHID::gapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    if (event != ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT || param->update_conn_params.status != ESP_BT_STATUS_SUCCESS) {
+        return;
+    }
+    // 主机可能只接受部分参数，按实际值控制发送节奏
+    BleHID& self = instance();
+    self._interval = param->update_conn_params.conn_int;
+    self._latency = param->update_conn_params.latency;
+    self._paramUpdates++;
+    LOG_D(TAG_BLE, "连接参数: 间隔 %u×1.25ms，从机延迟 %u", self._interval, self._latency);
+}
+
+void BleHID::idleTimerEntry(void* arg) {
+    BleHID* self = static_cast<BleHID*>(arg);
+    if (self->_connected && self->_fast) {
+        self->requestParams(false);
+    }
+}
+
+void BleHID::requestParams(bool fast) {
+    _fast = fast;
+    if (fast) {
+        _server->updateConnParams(_peer, BLE_HID_FAST_INTERVAL, BLE_HID_FAST_INTERVAL, 0, BLE_HID_TIMEOUT);
+    } else {
+        _server->updateConnParams(_peer, BLE_HID_IDLE_INTERVAL, BLE_HID_IDLE_INTERVAL,
+                                  BLE_HID_IDLE_LATENCY, BLE_HID_TIMEOUT);
+    }
+}
+
+bool BleHID::ready() const {
+    if (!_connected) {
+        return false;
+    }
+    // 一个连接事件只发一批；间隔未知时按快速间隔
+    int64_t interval = (int64_t)(_interval ? _interval : BLE_HID_FAST_INTERVAL) * 1250;
+    return esp_timer_get_time() - _lastSend >= interval;
+}
+
+bool BleHID::send(uint8_t reportId, const void* report, size_t size) {
+    if (!_connected) {
+        return false;
+    }
+    BLECharacteristic* input = nullptr;
+    for (uint8_t i = 0; i < _reportCount; i++) {
+        if (_reportIds[i] == reportId) {
+            input = _inputs[i];
+            break;
+        }
+    }
+    if (!input) {
+        return false;
+    }
+
+    input->setValue(static_cast<uint8_t*>(const_cast<void*>(report)), size);
+    input->notify();
+    _lastSend = esp_timer_get_time();
+
+    // 有输入：加快连接事件，空闲计时从这个报告重新开始
+    if (!_fast) {
+        requestParams(true);
+    }
+    esp_timer_stop(_idleTimer);     // 定时器没在运行时返回错误，忽略
+    esp_timer_start_once(_idleTimer, (uint64_t)BLE_HID_IDLE_MS * 1000);
+    return true;
+}
+
+void BleHID::printStatus() const {
+    Serial.println("--- BLE HID ---");
+    if (!_server) {
+        Serial.println("蓝牙未启动");
+        return;
+    }
+    Serial.printf("连接: %s\n", _connected ? "已连接" : "广播中");
+    if (_connected) {
+        Serial.printf("连接间隔: %u.%02u ms，从机延迟: %u（%s参数）\n", _interval * 125 / 100,
+                      _interval * 125 % 100, _latency, _fast ? "快速" : "空闲");
+        Serial.printf("参数更新: %lu 次\n", (unsigned long)_paramUpdates);
+    }
+}
+
+#endif // BLE_HID_ENABLED
@@ -0,0 +1,132 @@
+/**
+ * @file BleHID.h
+ * @brief BLE HID键盘传输（HID over GATT）
+ * @details SimpleHID的另一种报告出口：报告的生成、合并和宏展开都在SimpleHID中，
+ * 这里只负责蓝牙连接和把报告作为输入报告特征值通知出去。报告描述符与USB相同。
+ *
+ * 连接参数按输入活动切换：
+ * - 发送报告时若处于空闲参数，请求BLE_HID_FAST_INTERVAL（7.5ms）、无从机延迟
+ * - 最后一个报告之后BLE_HID_IDLE_MS，请求BLE_HID_IDLE_INTERVAL加从机延迟，
+ *   没有数据时设备可连续跳过几个连接事件，射频大部分时间关闭
+ * 参数由主机决定是否接受（部分系统不接受7.5ms），实际值以连接参数更新事件为准。
+ *
+ * 每个连接事件一批报告：ready()在距上次发送不足一个连接间隔时返回false，
+ * SimpleHID把这期间的按键变化合并到同一批报告中，不会在控制器里排队等待多个连接事件。
+ *
+ * 主机LED状态由主机写入键盘报告ID的输出报告特征值，在蓝牙任务中交给setOutputCallback()的处理函数。
+ *
+ * 蓝牙协议栈占用较多内存，第一次切换到BLE时才启动。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef BLE_HID_H
+#define BLE_HID_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if BLE_HID_ENABLED
+
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLEHIDDevice.h>
+#include <esp_timer.h>
+
+class BleHID {
+public:
+    static const uint8_t MAX_REPORTS = 3;       ///< 输入报告数（键盘、消费者控制、系统控制）
+
+    /**
+     * @brief 连接状态变化时的通知（在蓝牙任务中调用）
+     */
+    typedef void (*ConnectionCallback)(bool connected, void* context);
+
+    /**
+     * @brief 主机写入输出报告时的通知（在蓝牙任务中调用）
+     */
+    typedef void (*OutputCallback)(uint8_t reportId, const uint8_t* data, size_t length, void* context);
+
+    static BleHID& instance() {
+        static BleHID instance;
+        return instance;
+    }
+
+    /**
+     * @brief 启动蓝牙协议栈、HID服务并开始广播（已启动时直接返回true）
+     * @param reportMap 报告描述符，需在整个运行期间有效
+     * @param reportIds 描述符中的输入报告ID，最多MAX_REPORTS个
+     * @param outputReportId 描述符中的输出报告ID（主机LED）
+     */
+    bool begin(const uint8_t* reportMap, size_t length, const uint8_t* reportIds, uint8_t reportCount,
+               uint8_t outputReportId);
+
+    bool isStarted() const { return _server != nullptr; }
+    bool isConnected() const { return _connected; }
+
+    /**
+     * @brief 是否可以发送下一批报告：已连接且距上一批至少一个连接间隔
+     */
+    bool ready() const;
+
+    /**
+     * @brief 通知一个输入报告；处于空闲参数时请求快速连接参数
+     * @return 未连接或报告ID未知时返回false
+     */
+    bool send(uint8_t reportId, const void* report, size_t size);
+
+    void setConnectionCallback(ConnectionCallback callback, void* context) {
+        _connectionContext = context;
+        _connectionCallback = callback;
+    }
+
+    void setOutputCallback(OutputCallback callback, void* context) {
+        _outputContext = context;
+        _outputCallback = callback;
+    }
+
+    /**
+     * @brief 打印连接状态和当前连接参数
+     */
+    void printStatus() const;
+
+private:
+    BleHID();
+
+    class ServerCallbacks;
+    class OutputCallbacks;
+    friend class ServerCallbacks;
+    friend class OutputCallbacks;
+
+    static void gapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+    static void idleTimerEntry(void* arg);
+
+    void onConnect(const esp_bd_addr_t address, uint16_t interval, uint16_t latency);
+    void onDisconnect();
+    void requestParams(bool fast);
+
+    BLEServer* _server;
+    BLEHIDDevice* _device;
+    BLECharacteristic* _inputs[MAX_REPORTS];
+    uint8_t _reportIds[MAX_REPORTS];
+    uint8_t _reportCount;
+    uint8_t _outputReportId;
+    esp_timer_handle_t _idleTimer;
+
+    volatile bool _connected;
+    esp_bd_addr_t _peer;
+    volatile bool _fast;            ///< 最近一次请求的是快速参数
+    volatile uint16_t _interval;    ///< 当前连接间隔（1.25ms）
+    volatile uint16_t _latency;     ///< 当前从机延迟
+    int64_t _lastSend;              ///< 上一批报告的发送时刻（µs）
+    uint32_t _paramUpdates;         ///< 主机接受的参数更新次数
+
+    ConnectionCallback _connectionCallback;
+    void* _connectionContext;
+    OutputCallback _outputCallback;
+    void* _outputContext;
+};
+
+#endif // BLE_HID_ENABLED
+
+#endif // BLE_HID_H
@@ -0,0 +1,30 @@
+/**
+ * @file BootProfiler.cpp
+ * @brief 启动阶段计时实现
+ *
+ * @author Calculator Project
+ */
+
+#include "BootProfiler.h"
+#include <esp_timer.h>
+
+BootProfiler::Stage BootProfiler::_stages[BootProfiler::MAX_STAGES];
+uint8_t BootProfiler::_count = 0;
+
+void BootProfiler::mark(const char* stage) {
+    if (_count >= MAX_STAGES) return;
+    _stages[_count].name = stage;
+    _stages[_count].us = (uint32_t)esp_timer_get_time();
+    _count++;
+}
+
+void BootProfiler::print(Print& out) {
+    out.println("启动耗时:");
+    uint32_t previous = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        const Stage& stage = _stages[i];
+        out.printf("  %7.1f ms  (累计 %7.1f ms)  %s\n",
+                   (stage.us - previous) / 1000.0f, stage.us / 1000.0f, stage.name);
+        previous = stage.us;
+    }
+}
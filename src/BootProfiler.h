@@ -0,0 +1,45 @@
+/**
+ * @file BootProfiler.h
+ * @brief 启动阶段计时
+ * @details 每个启动阶段结束时调用mark()，记录从上电起的时刻（esp_timer_get_time()）；
+ * print()输出各阶段的耗时和累计时间。只保存名称指针，阶段名必须是字符串常量。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <Arduino.h>
+
+class BootProfiler {
+public:
+    static const uint8_t MAX_STAGES = 24;
+
+    /**
+     * @brief 记录一个阶段结束
+     * @param stage 阶段名（字符串常量）
+     */
+    static void mark(const char* stage);
+
+    /**
+     * @brief 输出各阶段耗时
+     */
+    static void print(Print& out);
+
+    /**
+     * @brief 最后一个阶段结束的时刻（微秒）
+     */
+    static uint32_t lastMarkUs() { return _count ? _stages[_count - 1].us : 0; }
+
+private:
+    struct Stage {
+        const char* name;
+        uint32_t us;        ///< 阶段结束时刻，从上电计
+    };
+
+    static Stage _stages[MAX_STAGES];
+    static uint8_t _count;
+};
+
+#endif // BOOT_PROFILER_H
@@ -0,0 +1,164 @@
+/**
+ * @file BootSplash.cpp
+ * @brief 启动画面实现
+ *
+ * @author Calculator Project
+ */
+
+#include "BootSplash.h"
+#include "BufferPlacement.h"
+#include "Logger.h"
+#include "config.h"
+#include "SplashData.h"
+#include <esp_timer.h>
+
+#define TAG_SPLASH "Splash"
+
+static_assert(SPLASH_WIDTH == DISPLAY_WIDTH && SPLASH_HEIGHT == DISPLAY_HEIGHT,
+              "SplashData.h与屏幕尺寸不一致，重新运行tools/splash_pack.py");
+
+namespace {
+
+// QOI565解码器，格式说明见tools/splash_pack.py
+class Qoi565Decoder {
+public:
+    Qoi565Decoder(const uint8_t* data, uint32_t size)
+        : _p(data), _end(data + size), _prev(0), _run(0) {
+        memset(_index, 0, sizeof(_index));
+    }
+
+    // 解码count个像素；数据提前结束时用前一像素补齐
+    void decode(uint16_t* out, uint32_t count) {
+        while (count) {
+            if (_run) {
+                uint32_t n = _run < count ? _run : count;
+                for (uint32_t i = 0; i < n; i++) *out++ = _prev;
+                _run -= n;
+                count -= n;
+                continue;
+            }
+            if (_p >= _end) {
+                _run = count;
+                continue;
+            }
+
+            uint8_t op = *_p++;
+            if (op == OP_RGB) {
+                _prev = (uint16_t)((_p[0] << 8) | _p[1]);
+                _p += 2;
+            } else if ((op & 0xC0) == OP_INDEX) {
+                _prev = _index[op & 63];
+                *out++ = _prev;
+                count--;
+                continue;
+            } else if ((op & 0xC0) == OP_DIFF) {
+                _prev = pack(red() + ((op >> 4) & 3) - 2, green() + ((op >> 2) & 3) - 2, blue() + (op & 3) - 2);
+            } else if ((op & 0xC0) == OP_LUMA) {
+                int dg = (op & 0x3F) - 32;
+                uint8_t extra = *_p++;
+                _prev = pack(red() + (dg >> 1) + (extra >> 4) - 8, green() + dg, blue() + (dg >> 1) + (extra & 0x0F) - 8);
+            } else {
+                _run = (op & 0x3F) + 1;
+                continue;
+            }
+            _index[hash(_prev)] = _prev;
+            *out++ = _prev;
+            count--;
+        }
+    }
+
+private:
+    static const uint8_t OP_INDEX = 0x00;
+    static const uint8_t OP_DIFF = 0x40;
+    static const uint8_t OP_LUMA = 0x80;
+    static const uint8_t OP_RGB = 0xFE;
+
+    int red() const { return (_prev >> 11) & 0x1F; }
+    int green() const { return (_prev >> 5) & 0x3F; }
+    int blue() const { return _prev & 0x1F; }
+
+    // 各通道按位宽回绕
+    static uint16_t pack(int r, int g, int b) {
+        return (uint16_t)(((r & 0x1F) << 11) | ((g & 0x3F) << 5) | (b & 0x1F));
+    }
+
+    static uint8_t hash(uint16_t p) {
+        return (((p >> 11) & 0x1F) * 3 + ((p >> 5) & 0x3F) * 5 + (p & 0x1F) * 7) & 63;
+    }
+
+    const uint8_t* _p;
+    const uint8_t* _end;
+    uint16_t _prev;
+    uint32_t _run;
+    uint16_t _index[64];
+};
+
+} // namespace
+
+BootSplash::BootSplash()
+    : _panel(nullptr), _bus(nullptr), _lines(nullptr), _task(nullptr), _done(nullptr),
+      _shown(false), _drawUs(0) {
+}
+
+bool BootSplash::start(Arduino_TFT* panel, Arduino_DataBus* bus, BaseType_t core) {
+    if (_task || _shown || !panel || !bus) return false;
+
+    _lines = (uint16_t*)placedAlloc("splash_lines", (size_t)SPLASH_WIDTH * DISPLAY_SPLASH_ROWS * 2, PLACE_INTERNAL);
+    _done = xSemaphoreCreateBinary();
+    if (!_lines || !_done) {
+        placedFree(_lines);
+        _lines = nullptr;
+        if (_done) vSemaphoreDelete(_done);
+        _done = nullptr;
+        return false;
+    }
+
+    _panel = panel;
+    _bus = bus;
+    if (xTaskCreatePinnedToCore(taskEntry, "splash", TASK_STACK, this, TASK_PRIO, &_task, core) != pdPASS) {
+        _task = nullptr;
+        placedFree(_lines);
+        _lines = nullptr;
+        vSemaphoreDelete(_done);
+        _done = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void BootSplash::taskEntry(void* arg) {
+    BootSplash* self = static_cast<BootSplash*>(arg);
+    self->draw();
+    xSemaphoreGive(self->_done);
+    vTaskDelete(nullptr);
+}
+
+void BootSplash::draw() {
+    int64_t start = esp_timer_get_time();
+    Qoi565Decoder decoder(SPLASH_DATA, SPLASH_DATA_SIZE);
+
+    // 地址窗口覆盖整屏，像素按行连续写入
+    _panel->startWrite();
+    _panel->writeAddrWindow(0, 0, SPLASH_WIDTH, SPLASH_HEIGHT);
+    for (uint16_t y = 0; y < SPLASH_HEIGHT; y += DISPLAY_SPLASH_ROWS) {
+        uint16_t rows = SPLASH_HEIGHT - y < DISPLAY_SPLASH_ROWS ? SPLASH_HEIGHT - y : DISPLAY_SPLASH_ROWS;
+        uint32_t pixels = (uint32_t)SPLASH_WIDTH * rows;
+        decoder.decode(_lines, pixels);
+        _bus->writePixels(_lines, pixels);
+    }
+    _panel->endWrite();
+
+    _drawUs = (uint32_t)(esp_timer_get_time() - start);
+    _shown = true;
+}
+
+void BootSplash::finish() {
+    if (!_task) return;
+    xSemaphoreTake(_done, portMAX_DELAY);
+    vSemaphoreDelete(_done);
+    _done = nullptr;
+    _task = nullptr;
+    placedFree(_lines);
+    _lines = nullptr;
+    LOG_I(TAG_SPLASH, "启动画面: %u 字节解码推送 %lu us", (unsigned)SPLASH_DATA_SIZE, (unsigned long)_drawUs);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file BootSplash.h
+ * @brief 启动画面
+ * @details 启动图（SplashData.h，由tools/splash_pack.py生成）以QOI565格式压缩存放在闪存中，约5 KB：
+ * - 解码是逐像素流式的，状态只有前一像素和64项颜色表
+ * - 每次解码DISPLAY_SPLASH_ROWS行到一块小的行缓冲，整批交给总线（总线自带内部DMA缓冲），
+ *   不需要整帧Canvas，也不改动Canvas的内容
+ * - 解码和推送在另一核心的临时任务中进行，setup()同时继续初始化LED、背光、键盘等
+ * - 创建CalcDisplay之前调用finish()等待推送结束，之后总线归Canvas使用；
+ *   画面一直保留到计算器首帧推送
+ *
+ * @author Calculator Project
+ */
+
+#ifndef BOOT_SPLASH_H
+#define BOOT_SPLASH_H
+
+#include <Arduino_GFX_Library.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+class BootSplash {
+public:
+    static BootSplash& instance() {
+        static BootSplash instance;
+        return instance;
+    }
+
+    /**
+     * @brief 启动解码推送任务
+     * @param panel 已初始化的面板（决定地址窗口和旋转）
+     * @param bus 面板所在总线
+     * @param core 任务所在核心
+     * @return 任务已启动返回true；行缓冲或任务创建失败返回false，调用方照常清屏
+     */
+    bool start(Arduino_TFT *panel, Arduino_DataBus *bus, BaseType_t core);
+
+    /**
+     * @brief 等待推送完成（之后才能再使用总线）；未启动时立即返回
+     */
+    void finish();
+
+    /**
+     * @brief 启动画面是否已推送到面板
+     */
+    bool isShown() const { return _shown; }
+
+private:
+    static const uint32_t TASK_STACK = 3072;
+    static const UBaseType_t TASK_PRIO = 2;
+
+    BootSplash();
+    BootSplash(const BootSplash&) = delete;
+    BootSplash& operator=(const BootSplash&) = delete;
+
+    static void taskEntry(void* arg);
+    void draw();
+
+    Arduino_TFT* _panel;
+    Arduino_DataBus* _bus;
+    uint16_t* _lines;               ///< 行缓冲 [DISPLAY_SPLASH_ROWS][宽度]
+    TaskHandle_t _task;
+    SemaphoreHandle_t _done;        ///< 任务推送完成后释放
+    volatile bool _shown;
+    uint32_t _drawUs;               ///< 解码加推送耗时
+};
+
+#endif // BOOT_SPLASH_H
@@ -0,0 +1,91 @@
+/**
+ * @file BufferPlacement.cpp
+ * @brief 大块缓冲的内存位置实现
+ *
+ * @author Calculator Project
+ */
+
+#include "BufferPlacement.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+namespace {
+
+struct Placement {
+    const char* name;
+    void* ptr;
+    uint32_t bytes;
+    bool external;          ///< 实际分配在PSRAM
+};
+
+const uint8_t MAX_PLACEMENTS = 32;
+Placement placements[MAX_PLACEMENTS];
+
+void track(const char* name, void* ptr, size_t bytes, bool external) {
+    for (uint8_t i = 0; i < MAX_PLACEMENTS; i++) {
+        if (!placements[i].ptr) {
+            placements[i] = {name, ptr, (uint32_t)bytes, external};
+            return;
+        }
+    }
+}
+
+} // namespace
+
+void* placedAlloc(const char* name, size_t bytes, BufferPlace place) {
+    void* ptr = nullptr;
+    bool external = false;
+    switch (place) {
+        case PLACE_PSRAM:
+        case PLACE_PSRAM_ONLY:
+            ptr = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            external = ptr != nullptr;
+            if (!ptr && place == PLACE_PSRAM) {
+                ptr = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            }
+            break;
+        case PLACE_INTERNAL:
+            ptr = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            break;
+        case PLACE_DMA:
+            ptr = heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            break;
+    }
+    if (ptr) track(name, ptr, bytes, external);
+    return ptr;
+}
+
+void placedFree(void* ptr) {
+    if (!ptr) return;
+    for (uint8_t i = 0; i < MAX_PLACEMENTS; i++) {
+        if (placements[i].ptr == ptr) {
+            placements[i].ptr = nullptr;
+            break;
+        }
+    }
+    heap_caps_free(ptr);
+}
+
+void printPlacements(Print& out) {
+    // 同名的多块缓冲（如各字号的字形）合并为一行
+    for (uint8_t i = 0; i < MAX_PLACEMENTS; i++) {
+        const Placement& p = placements[i];
+        if (!p.ptr) continue;
+        bool seen = false;
+        for (uint8_t j = 0; j < i && !seen; j++) {
+            seen = placements[j].ptr && placements[j].name == p.name && placements[j].external == p.external;
+        }
+        if (seen) continue;
+
+        uint32_t bytes = 0;
+        uint8_t blocks = 0;
+        for (uint8_t j = i; j < MAX_PLACEMENTS; j++) {
+            if (placements[j].ptr && placements[j].name == p.name && placements[j].external == p.external) {
+                bytes += placements[j].bytes;
+                blocks++;
+            }
+        }
+        out.printf("   %-14s %7lu 字节 %2u 块  %s\n", p.name, (unsigned long)bytes, (unsigned)blocks,
+                   p.external ? "PSRAM" : "内部RAM");
+    }
+}
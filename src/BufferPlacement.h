@@ -0,0 +1,50 @@
+/**
+ * @file BufferPlacement.h
+ * @brief 大块缓冲的内存位置
+ * @details 每块大缓冲按用途明确选择heap_caps，并登记实际位置（mem命令输出）：
+ * - PLACE_PSRAM：帧缓冲、字形缓存、录制缓冲等大块数据，放PSRAM，没有PSRAM时退回内部RAM
+ * - PLACE_PSRAM_ONLY：可有可无的数据（历史归档），没有PSRAM时不分配，不挤占内部RAM
+ * - PLACE_INTERNAL：每帧频繁访问的小表
+ * - PLACE_DMA：外设DMA直接读写的缓冲，必须是内部DMA可访问内存
+ *
+ * 屏幕推送时由SPI DMA总线把像素复制到它自己的内部DMA缓冲再发送，
+ * 所以Canvas帧缓冲可以放在PSRAM，腾出的内部RAM留给各任务的栈。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef BUFFER_PLACEMENT_H
+#define BUFFER_PLACEMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Print;
+
+enum BufferPlace : uint8_t {
+    PLACE_PSRAM,            ///< PSRAM优先，退回内部RAM
+    PLACE_PSRAM_ONLY,       ///< 只用PSRAM
+    PLACE_INTERNAL,         ///< 内部RAM
+    PLACE_DMA,              ///< 内部DMA可访问内存
+};
+
+/**
+ * @brief 按位置分配并登记
+ * @param name 缓冲名（字符串常量，mem命令输出用）
+ * @param bytes 字节数
+ * @param place 期望的位置
+ * @return 分配失败返回nullptr
+ */
+void* placedAlloc(const char* name, size_t bytes, BufferPlace place);
+
+/**
+ * @brief 释放placedAlloc()分配的缓冲并取消登记
+ */
+void placedFree(void* ptr);
+
+/**
+ * @brief 输出各缓冲的大小和实际位置
+ */
+void printPlacements(Print& out);
+
+#endif // BUFFER_PLACEMENT_H
@@ -0,0 +1,132 @@
+/**
+ * @file BusinessMath.h
+ * @brief 商务功能的定点运算：含税、去税、加价、折扣和累计总计
+ * @details 金额不经过double运算，只在输入和输出时转换：
+ * - 输入按十进制数字（NumberFormatter::shortestDigits()）转为 EXACT_DECIMALS 位小数的int64，
+ *   键入的19.99就是1999·10⁴，没有二进制尾差
+ * - 比率以百万分之一为单位保存（13% = 130000），乘除只用整数，
+ *   中间结果拆成商和余数避免溢出（Xtensa上没有__int128）
+ * - 结果只舍入一次，按银行家舍入（四舍六入五成双）到 BUSINESS_DECIMALS 位，
+ *   同一组数每次得到同样的分位，与会计规则一致
+ * 累计总计（GT）按 EXACT_DECIMALS 位累加，溢出时报错而不是回绕。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef BUSINESS_MATH_H
+#define BUSINESS_MATH_H
+
+#include <math.h>
+#include <stdint.h>
+#include "config.h"
+#include "CalcBackend.h"
+#include "NumberFormatter.h"
+
+namespace BusinessMath {
+
+const uint8_t EXACT_DECIMALS = 6;           ///< 输入金额和总计的小数位数
+const int64_t RATE_SCALE = 1000000;         ///< 比率的单位：百万分之一
+const uint32_t MAX_RATE = 100 * RATE_SCALE; ///< 税率、加价率上限10000%
+
+/**
+ * @brief 是否为商务功能键（按运算符区间判断，不比较名称）
+ */
+inline bool isBusiness(Operator op) {
+    return op >= Operator::TAX_PLUS && op <= Operator::GRAND_TOTAL;
+}
+
+/**
+ * @brief 按十进制数字转为decimals位小数的定点数，多出的位按银行家舍入
+ * @return 非有限值或超出int64范围时返回false
+ */
+inline bool toScaled(double value, uint8_t decimals, int64_t &out) {
+    if (!isfinite(value)) return false;
+    if (value == 0.0) {
+        out = 0;
+        return true;
+    }
+
+    char digits[17];
+    int point;
+    int count = NumberFormatter::shortestDigits(fabs(value), digits, point);
+    int keep = point + decimals;            // 定点数保留的位数
+    if (keep > 18) return false;
+
+    int64_t q = 0;
+    for (int i = 0; i < keep; i++) {
+        q = q * 10 + (i < count ? digits[i] - '0' : 0);
+    }
+    if (keep >= 0 && keep < count) {
+        int next = digits[keep] - '0';
+        bool rest = false;
+        for (int i = keep + 1; i < count; i++) rest |= digits[i] != '0';
+        if (next > 5 || (next == 5 && (rest || (q & 1)))) q++;
+    }
+    out = value < 0 ? -q : q;
+    return true;
+}
+
+inline double fromScaled(int64_t value, uint8_t decimals) {
+    return (double)value / calcPow10(decimals);
+}
+
+/**
+ * @brief a × num / den，银行家舍入到整数
+ * @param num 非负
+ * @param den 正数
+ * @return 结果溢出时返回false
+ */
+inline bool mulDiv(int64_t a, int64_t num, int64_t den, int64_t &out) {
+    // a = q·den + r，a·num/den = q·num + r·num/den，r·num不超过den·num
+    int64_t hi, lo;
+    if (__builtin_mul_overflow(a / den, num, &hi)) return false;
+    if (__builtin_mul_overflow(a % den, num, &lo)) return false;
+    int64_t q = lo / den;
+    int64_t twice = 2 * (lo % den < 0 ? -(lo % den) : lo % den);
+    if (__builtin_add_overflow(hi, q, &q)) return false;
+    if (twice > den || (twice == den && (q & 1))) {
+        q += a < 0 ? -1 : 1;
+    }
+    out = q;
+    return true;
+}
+
+/**
+ * @brief 商务运算：按rate（百万分之一）作用于value，结果舍入到 BUSINESS_DECIMALS 位
+ * - TAX_PLUS：value × (1 + rate)
+ * - TAX_MINUS：value ÷ (1 + rate)，由含税价求税前价
+ * - MARKUP：value × (1 + rate)
+ * - DISCOUNT：value × (1 − rate)
+ */
+inline CalculatorError apply(Operator op, double value, uint32_t rate, double &out) {
+    int64_t amount;
+    if (!toScaled(value, EXACT_DECIMALS, amount)) return CalculatorError::OVERFLOW;
+
+    // 输入有EXACT_DECIMALS位、结果保留BUSINESS_DECIMALS位，差的位数并入分母，只舍入一次
+    int64_t num = RATE_SCALE;
+    int64_t den = RATE_SCALE * calcPow10(EXACT_DECIMALS - BUSINESS_DECIMALS);
+    switch (op) {
+        case Operator::TAX_PLUS:
+        case Operator::MARKUP:
+            num += rate;
+            break;
+        case Operator::TAX_MINUS:
+            den = (RATE_SCALE + rate) * calcPow10(EXACT_DECIMALS - BUSINESS_DECIMALS);
+            break;
+        case Operator::DISCOUNT:
+            if (rate > RATE_SCALE) return CalculatorError::INVALID_OPERATION;
+            num -= rate;
+            break;
+        default:
+            return CalculatorError::INVALID_OPERATION;
+    }
+
+    int64_t result;
+    if (!mulDiv(amount, num, den, result)) return CalculatorError::OVERFLOW;
+    out = fromScaled(result, BUSINESS_DECIMALS);
+    return CalculatorError::NONE;
+}
+
+} // namespace BusinessMath
+
+#endif // BUSINESS_MATH_H
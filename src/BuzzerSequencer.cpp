@@ -0,0 +1,197 @@
+/**
+ * @file BuzzerSequencer.cpp
+ * @brief 非阻塞的蜂鸣器音符序列实现
+ *
+ * @author Calculator Project
+ */
+
+#include "BuzzerSequencer.h"
+#include "Logger.h"
+#include "config.h"
+#include <driver/ledc.h>
+
+#define TAG_BUZZER "Buzzer"
+
+// 回调最多比预计结束时间早这么多仍视为本阶段的定时器（定时器精度以内）
+#define NOTE_END_SLACK_US 200
+
+// ESP32-S3只有低速通道；Arduino的0-7号通道即低速组的0-7号通道
+#define BUZZER_SPEED_MODE LEDC_LOW_SPEED_MODE
+
+namespace {
+
+const BuzzerNote TONE_CONFIRM[] = {
+    {1800, 60, 0}, {0, 30, 0}, {2400, 90, 0},
+};
+
+const BuzzerNote TONE_ERROR[] = {
+    {700, 120, 0}, {0, 40, 0}, {450, 220, 0},
+};
+
+} // namespace
+
+BuzzerSequencer::BuzzerSequencer()
+    : _channel(0),
+      _timer(nullptr),
+      _mutex(nullptr),
+      _head(0),
+      _count(0),
+      _phase(PHASE_IDLE),
+      _releaseMs(0),
+      _phaseEndUs(0) {
+}
+
+bool BuzzerSequencer::begin(uint8_t channel, uint8_t pin) {
+    if (_timer) return true;
+
+    _channel = channel;
+    ledcSetup(_channel, 2000, RESOLUTION_BITS);
+    ledcAttachPin(pin, _channel);
+    ledcWrite(_channel, 0);
+
+    // 起音和收音用硬件渐变；背光已安装过时返回错误，忽略
+    ledc_fade_func_install(0);
+
+    _mutex = xSemaphoreCreateMutex();
+    esp_timer_create_args_t args = {};
+    args.callback = timerCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "buzzer";
+    if (!_mutex || esp_timer_create(&args, &_timer) != ESP_OK) {
+        LOG_E(TAG_BUZZER, "蜂鸣器定时器创建失败");
+        _timer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool BuzzerSequencer::play(const BuzzerNote* notes, uint8_t count) {
+    if (!_timer) return false;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _head = 0;
+    _count = 0;
+    bool fits = push(notes, count);
+    if (_phase == PHASE_TONE) {
+        startRelease();     // 收音结束后由定时器开始新序列
+    } else if (_phase != PHASE_RELEASE) {
+        startNext();
+    }
+    xSemaphoreGive(_mutex);
+    return fits;
+}
+
+bool BuzzerSequencer::enqueue(const BuzzerNote* notes, uint8_t count) {
+    if (!_timer) return false;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    bool fits = push(notes, count);
+    if (_phase == PHASE_IDLE) startNext();
+    xSemaphoreGive(_mutex);
+    return fits;
+}
+
+bool BuzzerSequencer::playTone(BuzzerTone tone, uint16_t duty) {
+    const BuzzerNote* preset = (tone == BUZZER_TONE_ERROR) ? TONE_ERROR : TONE_CONFIRM;
+    uint8_t count = (tone == BUZZER_TONE_ERROR) ? sizeof(TONE_ERROR) / sizeof(TONE_ERROR[0])
+                                                : sizeof(TONE_CONFIRM) / sizeof(TONE_CONFIRM[0]);
+    BuzzerNote notes[4];
+    for (uint8_t i = 0; i < count; i++) {
+        notes[i] = preset[i];
+        notes[i].duty = duty;
+    }
+    return play(notes, count);
+}
+
+void BuzzerSequencer::stop() {
+    if (!_timer) return;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _head = 0;
+    _count = 0;
+    if (_phase == PHASE_TONE) {
+        startRelease();
+    } else if (_phase == PHASE_REST) {
+        esp_timer_stop(_timer);
+        _phase = PHASE_IDLE;
+    }
+    xSemaphoreGive(_mutex);
+}
+
+bool BuzzerSequencer::push(const BuzzerNote* notes, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (_count >= QUEUE_CAPACITY) return false;
+        _queue[(_head + _count) % QUEUE_CAPACITY] = notes[i];
+        _count++;
+    }
+    return true;
+}
+
+void BuzzerSequencer::startNext() {
+    // 跳过时长为0的音符
+    while (_count > 0 && _queue[_head].durationMs == 0) {
+        _head = (_head + 1) % QUEUE_CAPACITY;
+        _count--;
+    }
+    if (_count == 0) {
+        _phase = PHASE_IDLE;
+        return;
+    }
+
+    const BuzzerNote note = _queue[_head];
+    _head = (_head + 1) % QUEUE_CAPACITY;
+    _count--;
+
+    if (note.freq == 0 || note.duty == 0) {
+        // 休止符：上一个音符已收音到0，只需计时
+        _phase = PHASE_REST;
+        armTimer(note.durationMs);
+        return;
+    }
+
+    // 起音和收音各占音符时长的至多1/4，短促的按键音也能留出持续段
+    uint16_t attackMs = min<uint16_t>(BUZZER_ATTACK_MS, note.durationMs / 4);
+    _releaseMs = min<uint16_t>(BUZZER_RELEASE_MS, note.durationMs / 4);
+
+    // 占空比为0时换频率，不会听到切换；ledcWriteTone会直接写50%占空比，这里不用
+    ledcChangeFrequency(_channel, note.freq, RESOLUTION_BITS);
+    fadeTo(note.duty > MAX_DUTY ? MAX_DUTY : note.duty, attackMs);
+    _phase = PHASE_TONE;
+    armTimer(note.durationMs - _releaseMs);
+}
+
+void BuzzerSequencer::startRelease() {
+    fadeTo(0, _releaseMs);
+    _phase = PHASE_RELEASE;
+    armTimer(_releaseMs);
+}
+
+void BuzzerSequencer::fadeTo(uint16_t duty, uint16_t ms) {
+    // 上一段渐变未结束时IDF会等它结束（最多BUZZER_ATTACK_MS）；渐变在硬件中推进，不占CPU
+    if (ms == 0 ||
+        ledc_set_fade_with_time(BUZZER_SPEED_MODE, (ledc_channel_t)_channel, duty, ms) != ESP_OK ||
+        ledc_fade_start(BUZZER_SPEED_MODE, (ledc_channel_t)_channel, LEDC_FADE_NO_WAIT) != ESP_OK) {
+        ledcWrite(_channel, duty);
+    }
+}
+
+void BuzzerSequencer::armTimer(uint32_t ms) {
+    esp_timer_stop(_timer);     // 定时器没在运行时返回错误，忽略
+    _phaseEndUs = esp_timer_get_time() + (int64_t)ms * 1000;
+    esp_timer_start_once(_timer, (uint64_t)ms * 1000);
+}
+
+void BuzzerSequencer::timerCallback(void* arg) {
+    BuzzerSequencer* self = static_cast<BuzzerSequencer*>(arg);
+    xSemaphoreTake(self->_mutex, portMAX_DELAY);
+    // 等锁期间play()可能已换上新的音符并重新启动定时器，这次回调作废
+    if (self->_phase != PHASE_IDLE && esp_timer_get_time() + NOTE_END_SLACK_US >= self->_phaseEndUs) {
+        if (self->_phase == PHASE_TONE) {
+            self->startRelease();
+        } else {
+            self->startNext();
+        }
+    }
+    xSemaphoreGive(self->_mutex);
+}
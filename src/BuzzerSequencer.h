@@ -0,0 +1,121 @@
+/**
+ * @file BuzzerSequencer.h
+ * @brief 非阻塞的蜂鸣器音符序列
+ * @details 音符（频率、占空比、时长）放入固定容量的队列，由esp_timer单次定时器逐个切换：
+ * - 每个音符结束时在esp_timer任务中切换到下一个，音长不受主循环轮询间隔影响
+ * - play()打断当前序列立即开始（按键音），enqueue()排在当前序列之后（旋律）
+ * - 频率为0的音符是休止符
+ * - 每个音符用LEDC硬件渐变起音和收音，占空比从0升到目标再降回0，起止不再有咔哒声；
+ *   换频率只在占空比为0时进行。收音计入音符时长，音长不变
+ * - 主循环和定时器回调通过互斥锁访问队列和LEDC；回调按预计结束时间判断是否已被play()取代
+ *
+ * @author Calculator Project
+ */
+
+#ifndef BUZZER_SEQUENCER_H
+#define BUZZER_SEQUENCER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * @brief 一个音符
+ */
+struct BuzzerNote {
+    uint16_t freq;          ///< 频率(Hz)，0为休止
+    uint16_t durationMs;    ///< 时长
+    uint16_t duty;          ///< 占空比（RESOLUTION_BITS位分辨率，最大MAX_DUTY）
+};
+
+// 预置提示音
+enum BuzzerTone {
+    BUZZER_TONE_CONFIRM,    ///< 确认：两个上行短音
+    BUZZER_TONE_ERROR,      ///< 错误：两个下行低音
+};
+
+class BuzzerSequencer {
+public:
+    static const uint8_t QUEUE_CAPACITY = 48;      ///< 队列容量（22个音符加休止符的音阶也放得下）
+    static const uint8_t RESOLUTION_BITS = 10;     ///< LEDC占空比分辨率
+    static const uint16_t MAX_DUTY = 1 << (RESOLUTION_BITS - 1);   ///< 50%占空比，无源蜂鸣器最响
+
+    static BuzzerSequencer& instance() {
+        static BuzzerSequencer instance;
+        return instance;
+    }
+
+    /**
+     * @brief 配置LEDC通道并创建定时器
+     * @param channel LEDC通道
+     * @param pin 蜂鸣器引脚
+     */
+    bool begin(uint8_t channel, uint8_t pin);
+
+    /**
+     * @brief 打断当前序列，立即播放notes
+     * @details 正在发声时先收音（BUZZER_RELEASE_MS），再开始新序列
+     * @return 队列放不下时只播放放得下的部分，返回false
+     */
+    bool play(const BuzzerNote* notes, uint8_t count);
+
+    /**
+     * @brief 打断当前序列，立即播放一个音符
+     */
+    bool play(uint16_t freq, uint16_t durationMs, uint16_t duty) {
+        BuzzerNote note = {freq, durationMs, duty};
+        return play(&note, 1);
+    }
+
+    /**
+     * @brief 排在当前序列之后播放
+     * @return 队列已满返回false
+     */
+    bool enqueue(const BuzzerNote* notes, uint8_t count);
+
+    /**
+     * @brief 播放预置提示音
+     */
+    bool playTone(BuzzerTone tone, uint16_t duty);
+
+    /**
+     * @brief 停止并清空队列
+     * @details 正在发声时收音后才静音，isPlaying()在收音结束前仍为true
+     */
+    void stop();
+
+    bool isPlaying() const { return _phase != PHASE_IDLE; }
+
+private:
+    enum Phase : uint8_t {
+        PHASE_IDLE,         ///< 静音，队列为空
+        PHASE_TONE,         ///< 起音和持续，定时器到期时开始收音
+        PHASE_RELEASE,      ///< 收音渐变中，定时器到期时播放下一个音符
+        PHASE_REST,         ///< 休止符
+    };
+
+    BuzzerSequencer();
+
+    static void timerCallback(void* arg);
+
+    // 以下在持有_mutex时调用
+    bool push(const BuzzerNote* notes, uint8_t count);
+    void startNext();
+    void startRelease();
+    void fadeTo(uint16_t duty, uint16_t ms);
+    void armTimer(uint32_t ms);
+
+    uint8_t _channel;
+    esp_timer_handle_t _timer;
+    SemaphoreHandle_t _mutex;
+
+    BuzzerNote _queue[QUEUE_CAPACITY];
+    uint8_t _head;                  ///< 下一个要播放的音符
+    uint8_t _count;                 ///< 队列中的音符数（不含正在播放的）
+    volatile Phase _phase;
+    uint16_t _releaseMs;            ///< 当前音符的收音时长
+    int64_t _phaseEndUs;            ///< 当前阶段的预计结束时间（esp_timer_get_time）
+};
+
+#endif // BUZZER_SEQUENCER_H
@@ -0,0 +1,282 @@
+/**
+ * @file CalcBackend.h
+ * @brief 编译期选择的运算后端
+ * @details 运算后端是只含静态内联函数的策略类，由 CALC_BACKEND 在编译时选定：
+ * - DoubleBackend：直接使用double运算
+ * - FixedBackend：int64定点数，保留 CALC_FIXED_DECIMALS 位小数
+ * - DecimalBackend：34位有效数字的十进制数（Decimal）
+ *
+ * CalculatorCore 直接调用 CalcBackend::apply()，调用被内联到调用处，
+ * 没有虚函数、日志和结果结构的拷贝；未选中的后端不会被实例化，也不占用flash。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CALC_BACKEND_H
+#define CALC_BACKEND_H
+
+#include <math.h>
+#include <stdint.h>
+#include "config.h"
+#include "CalculatorCore.h"
+#include "KeyboardConfig.h"
+#include "FastMath.h"
+
+/**
+ * @brief 10的n次幂（编译期常量）
+ */
+constexpr int64_t calcPow10(uint8_t n) {
+    return n == 0 ? 1 : 10 * calcPow10(n - 1);
+}
+
+/**
+ * @brief 检查double结果，NaN/Inf转换为错误类型
+ */
+inline CalculatorError calcCheckResult(double value) {
+    if (isnan(value)) {
+        return CalculatorError::INVALID_OPERATION;
+    }
+    if (isinf(value)) {
+        return value > 0 ? CalculatorError::OVERFLOW : CalculatorError::UNDERFLOW;
+    }
+    return CalculatorError::NONE;
+}
+
+/**
+ * @brief 乘方（各后端共用，按double计算）
+ */
+inline CalculatorError calcPower(double base, double exponent, double &out) {
+    if (base == 0 && exponent < 0) return CalculatorError::DIVISION_BY_ZERO;
+    out = FastMath::pow(base, exponent);
+    return calcCheckResult(out);
+}
+
+/**
+ * @brief 是否为作用于当前数字的单参数函数
+ */
+inline bool calcIsFunction(Operator op) {
+    return op >= Operator::SQUARE_ROOT && op <= Operator::EXP && op != Operator::POWER;
+}
+
+/**
+ * @brief 单参数函数（各后端共用，按double计算）
+ * @param op calcIsFunction()为true的运算符
+ * @param x 参数
+ * @param out 结果（仅在返回NONE时有效）
+ * @return 错误类型；超出定义域为INVALID_OPERATION
+ */
+inline CalculatorError calcApplyFunction(Operator op, double x, double &out) {
+    switch (op) {
+        case Operator::SQUARE_ROOT: out = FastMath::sqrt(x); break;
+        case Operator::SQUARE:      out = x * x; break;
+        case Operator::RECIPROCAL:
+            if (fabs(x) < 1e-10) return CalculatorError::DIVISION_BY_ZERO;
+            out = 1.0 / x;
+            break;
+        case Operator::SIN:         out = FastMath::sin(x); break;
+        case Operator::COS:         out = FastMath::cos(x); break;
+        case Operator::TAN:         out = FastMath::tan(x); break;
+        case Operator::LN:
+        case Operator::LOG10:
+            // ln(0)是-Inf，按定义域错误处理而不是下溢
+            if (!(x > 0)) return CalculatorError::INVALID_OPERATION;
+            out = op == Operator::LN ? FastMath::ln(x) : FastMath::log10(x);
+            break;
+        case Operator::EXP:         out = FastMath::exp(x); break;
+        default:
+            return CalculatorError::INVALID_OPERATION;
+    }
+    return calcCheckResult(out);
+}
+
+/**
+ * @brief double运算后端
+ */
+struct DoubleBackend {
+    static const char *name() { return "double"; }
+
+    /**
+     * @brief 执行二元运算
+     * @param left 左操作数
+     * @param right 右操作数
+     * @param op 运算符
+     * @param out 运算结果（仅在返回NONE时有效）
+     * @return 错误类型
+     */
+    static inline CalculatorError apply(double left, double right, Operator op, double &out) {
+        switch (op) {
+            case Operator::ADD:      out = left + right; break;
+            case Operator::SUBTRACT: out = left - right; break;
+            case Operator::MULTIPLY: out = left * right; break;
+            case Operator::DIVIDE:
+                if (fabs(right) < 1e-10) return CalculatorError::DIVISION_BY_ZERO;
+                out = left / right;
+                break;
+            case Operator::PERCENT:  out = left * right / 100.0; break;
+            case Operator::POWER:    return calcPower(left, right, out);
+            default:
+                return CalculatorError::INVALID_OPERATION;
+        }
+        return calcCheckResult(out);
+    }
+};
+
+/**
+ * @brief int64定点运算后端
+ * @tparam DECIMALS 小数位数
+ * @details 数值按 value × 10^DECIMALS 取整保存，加减乘为精确整数运算，
+ *          乘除结果四舍五入到DECIMALS位小数。超出int64范围时报告溢出
+ */
+template <uint8_t DECIMALS>
+struct FixedBackend {
+    static_assert(DECIMALS <= 9, "定点小数位数最多9位");
+
+    static const char *name() { return "fixed"; }
+
+    static constexpr int64_t scale() { return calcPow10(DECIMALS); }
+
+    static inline CalculatorError apply(double left, double right, Operator op, double &out) {
+        int64_t a, b, r;
+        if (!toFixed(left, a) || !toFixed(right, b)) return CalculatorError::OVERFLOW;
+
+        switch (op) {
+            case Operator::ADD:
+                if (__builtin_add_overflow(a, b, &r)) return CalculatorError::OVERFLOW;
+                break;
+            case Operator::SUBTRACT:
+                if (__builtin_sub_overflow(a, b, &r)) return CalculatorError::OVERFLOW;
+                break;
+            case Operator::MULTIPLY:
+                if (!mulScaled(a, b, r)) return CalculatorError::OVERFLOW;
+                break;
+            case Operator::DIVIDE:
+                if (b == 0) return CalculatorError::DIVISION_BY_ZERO;
+                if (!divScaled(a, b, r)) return CalculatorError::OVERFLOW;
+                break;
+            case Operator::PERCENT:
+                if (!mulScaled(a, b, r)) return CalculatorError::OVERFLOW;
+                r = roundDiv(r, 100);
+                break;
+            case Operator::POWER: {
+                // 按double计算后舍入到DECIMALS位小数
+                double value;
+                CalculatorError error = calcPower(left, right, value);
+                if (error != CalculatorError::NONE) return error;
+                if (!toFixed(value, r)) return CalculatorError::OVERFLOW;
+                break;
+            }
+            default:
+                return CalculatorError::INVALID_OPERATION;
+        }
+
+        out = (double)r / scale();
+        return CalculatorError::NONE;
+    }
+
+private:
+    static inline bool toFixed(double value, int64_t &out) {
+        double scaled = value * scale();
+        if (!(fabs(scaled) < 9.2e18)) return false;
+        out = llround(scaled);
+        return true;
+    }
+
+    // 整数除法，四舍五入（远离0）
+    static inline int64_t roundDiv(int64_t n, int64_t d) {
+        int64_t q = n / d;
+        int64_t rem = n % d;
+        if (rem < 0) rem = -rem;
+        if (2 * rem >= (d < 0 ? -d : d)) q += ((n < 0) != (d < 0)) ? -1 : 1;
+        return q;
+    }
+
+    // a × b / scale，拆成整数部分和小数部分避免中间乘积溢出
+    static inline bool mulScaled(int64_t a, int64_t b, int64_t &out) {
+        int64_t hi, lo;
+        if (__builtin_mul_overflow(a / scale(), b, &hi)) return false;
+        if (__builtin_mul_overflow(a % scale(), b, &lo)) return false;
+        return !__builtin_add_overflow(hi, roundDiv(lo, scale()), &out);
+    }
+
+    // a × scale / b，逐位长除
+    static inline bool divScaled(int64_t a, int64_t b, int64_t &out) {
+        bool negative = (a < 0) != (b < 0);
+        uint64_t n = a < 0 ? -(uint64_t)a : (uint64_t)a;
+        uint64_t d = b < 0 ? -(uint64_t)b : (uint64_t)b;
+
+        uint64_t q = n / d;
+        uint64_t rem = n % d;
+        for (uint8_t i = 0; i < DECIMALS; i++) {
+            if (rem > UINT64_MAX / 10 || q > UINT64_MAX / 10) return false;
+            rem *= 10;
+            q = q * 10 + rem / d;
+            rem %= d;
+        }
+        if (rem > UINT64_MAX / 2) return false;
+        if (2 * rem >= d) q++;
+        if (q > (uint64_t)INT64_MAX) return false;
+
+        out = negative ? -(int64_t)q : (int64_t)q;
+        return true;
+    }
+};
+
+#if CALC_BACKEND == CALC_BACKEND_DECIMAL
+#include "Decimal.h"
+
+/**
+ * @brief 十进制运算后端
+ * @details 操作数按15位有效数字转换为十进制，运算保留34位有效数字，
+ *          0.1 + 0.2 的结果精确等于0.3
+ */
+struct DecimalBackend {
+    static const char *name() { return "decimal"; }
+
+    static inline CalculatorError apply(double left, double right, Operator op, double &out) {
+        if (calcCheckResult(left) != CalculatorError::NONE ||
+            calcCheckResult(right) != CalculatorError::NONE) {
+            return CalculatorError::INVALID_OPERATION;
+        }
+
+        Decimal a = Decimal::fromDouble(left);
+        Decimal b = Decimal::fromDouble(right);
+        Decimal r;
+
+        switch (op) {
+            case Operator::ADD:      r = Decimal::add(a, b); break;
+            case Operator::SUBTRACT: r = Decimal::sub(a, b); break;
+            case Operator::MULTIPLY: r = Decimal::mul(a, b); break;
+            case Operator::DIVIDE:
+                // 十进制下除数只有精确为0时才无效
+                if (!Decimal::div(a, b, r)) return CalculatorError::DIVISION_BY_ZERO;
+                break;
+            case Operator::PERCENT: {
+                Decimal hundred;
+                Decimal::parse("100", hundred);
+                Decimal::div(Decimal::mul(a, b), hundred, r);
+                break;
+            }
+            case Operator::POWER:
+                // 乘方按double计算，结果不是精确十进制
+                return calcPower(left, right, out);
+            default:
+                return CalculatorError::INVALID_OPERATION;
+        }
+
+        out = r.toDouble();
+        return calcCheckResult(out);
+    }
+};
+#endif
+
+#if CALC_BACKEND == CALC_BACKEND_DOUBLE
+typedef DoubleBackend CalcBackend;
+#elif CALC_BACKEND == CALC_BACKEND_FIXED
+typedef FixedBackend<CALC_FIXED_DECIMALS> CalcBackend;
+#elif CALC_BACKEND == CALC_BACKEND_DECIMAL
+typedef DecimalBackend CalcBackend;
+#else
+#error "未知的CALC_BACKEND"
+#endif
+
+#endif // CALC_BACKEND_H
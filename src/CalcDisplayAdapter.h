@@ -9,6 +9,7 @@
 #include "CalculatorDisplay_base.h"
 #include "calc_display.h"
 #include "NumberFormatter.h"
+#include "Logger.h"
 
 // 前向声明
 class CalculatorCore;
@@ -33,9 +34,9 @@ public:
     bool begin() override { return true; }
     
     void updateDisplay(const String& mainText, const String& expression, CalculatorState state) override {
-        Serial.printf("[DisplayAdapter] updateDisplay called: mainText='%s', expr='%s', state=%d\n",
-                      mainText.c_str(), expression.c_str(), (int)state);
-                      
+        TRACE(TRACE_DISPLAY, "[DisplayAdapter] updateDisplay called: mainText='%s', expr='%s', state=%d",
+              mainText.c_str(), expression.c_str(), (int)state);
+        
         // 检测变化并触发相应动画
         bool mainTextChanged = (mainText != _prevMainText);
         bool expressionChanged = (expression != _prevExpression);
@@ -69,22 +70,8 @@ public:
                 _lastHistorySize = history.size();
                 historyUpdated = true;
                 
-                // 格式化最新的两条历史记录
-                String newLatest = "";
-                String newOlder = "";
-                
-                if (history.size() >= 1) {
-                    const auto& latest = history[history.size() - 1];
-                    newLatest = latest.expression + "=" + NumberFormatter::format(latest.result);
-                }
-                
-                if (history.size() >= 2) {
-                    const auto& older = history[history.size() - 2];
-                    newOlder = older.expression + "=" + NumberFormatter::format(older.result);
-                }
-                
-                // 更新历史记录显示
-                _calcDisplay->updateHistoryDirect(newLatest, newOlder);
+                // 最新的两条历史记录：文本在插入时已格式化，直接引用
+                _calcDisplay->updateHistoryDirect(history.line(0), history.line(1));
             }
         }
         
@@ -95,31 +82,15 @@ public:
         // 统一进行一次全屏刷新
         _calcDisplay->refresh();
         
-        // 同时输出到串口
-        Serial.println("=== 计算器显示 ===");
-        if (!expression.isEmpty()) {
-            Serial.println("表达式: " + expression);
-        }
-        Serial.println("结果: " + mainText);
-        
-        // 显示历史记录状态
-        if (_calculator) {
-            const auto& history = _calculator->getHistory();
-            Serial.printf("历史记录数量: %d\n", history.size());
-            if (history.size() >= 1) {
-                const auto& latest = history[history.size() - 1];
-                Serial.println("最新历史: " + latest.expression + "=" + NumberFormatter::format(latest.result));
-            }
-            if (history.size() >= 2) {
-                const auto& older = history[history.size() - 2];
-                Serial.println("较旧历史: " + older.expression + "=" + NumberFormatter::format(older.result));
+        // 跟踪输出：只在打开显示跟踪时格式化历史记录
+        if (Logger::isTraceEnabled(TRACE_DISPLAY)) {
+            TRACE(TRACE_DISPLAY, "显示: 表达式='%s' 结果='%s'", expression.c_str(), mainText.c_str());
+            if (_calculator) {
+                const auto& history = _calculator->getHistory();
+                TRACE(TRACE_DISPLAY, "历史: %u 条%s, 最新: %s", (unsigned)history.size(),
+                      historyUpdated ? "（已更新）" : "", history.line(0));
             }
         }
-        
-        if (historyUpdated) {
-            Serial.println("✓ 历史记录已更新");
-        }
-        Serial.println("================");
         }
         
         // 始终更新状态缓存，避免重复触发动画
@@ -131,7 +102,7 @@ public:
     void showError(CalculatorError error, const String& message) override {
         _calcDisplay->updateResultDirect("Error: " + message);
         _calcDisplay->refresh();
-        Serial.println("错误: " + message);
+        DISPLAY_LOG_W("错误: %s", message.c_str());
     }
     
     // 移除了showNotification - 基类中不存在此方法
@@ -143,7 +114,7 @@ public:
     }
     
     void showStatus(const String& message) override {
-        Serial.println("状态: " + message);
+        DISPLAY_LOG_I("状态: %s", message.c_str());
     }
     
     void setTheme(const DisplayTheme& theme) override {
@@ -7,6 +7,7 @@
  */
 
 #include "CalculationEngine.h"
+#include "CalcBackend.h"
 #include <cmath>
 
 CalculationEngine::CalculationEngine() {
@@ -47,37 +48,9 @@ bool CalculationEngine::isValidNumber(double number) const {
 }
 
 CalculationResult CalculationEngine::performBasicOperation(double left, double right, Operator op) {
+    // 与CalculatorCore使用同一个编译期选定的后端
     double result = 0.0;
-    
-    switch (op) {
-        case Operator::ADD:
-            result = left + right;
-            break;
-            
-        case Operator::SUBTRACT:
-            result = left - right;
-            break;
-            
-        case Operator::MULTIPLY:
-            result = left * right;
-            break;
-            
-        case Operator::DIVIDE:
-            if (abs(right) < 1e-10) {
-                return createErrorResult(CalculatorError::DIVISION_BY_ZERO);
-            }
-            result = left / right;
-            break;
-            
-        case Operator::PERCENT:
-            result = left * right / 100.0;
-            break;
-            
-        default:
-            return createErrorResult(CalculatorError::INVALID_OPERATION);
-    }
-    
-    CalculatorError error = validateResult(result);
+    CalculatorError error = CalcBackend::apply(left, right, op, result);
     if (error != CalculatorError::NONE) {
         return createErrorResult(error);
     }
@@ -86,32 +59,9 @@ CalculationResult CalculationEngine::performBasicOperation(double left, double r
 }
 
 CalculationResult CalculationEngine::performUnaryOperation(double operand, Operator op) {
+    // 与CalculatorCore的函数键使用同一组固定开销实现（FastMath）
     double result = 0.0;
-    
-    switch (op) {
-        case Operator::SQUARE_ROOT:
-            if (operand < 0) {
-                return createErrorResult(CalculatorError::INVALID_OPERATION);
-            }
-            result = sqrt(operand);
-            break;
-            
-        case Operator::SQUARE:
-            result = operand * operand;
-            break;
-            
-        case Operator::RECIPROCAL:
-            if (abs(operand) < 1e-10) {
-                return createErrorResult(CalculatorError::DIVISION_BY_ZERO);
-            }
-            result = 1.0 / operand;
-            break;
-            
-        default:
-            return createErrorResult(CalculatorError::INVALID_OPERATION);
-    }
-    
-    CalculatorError error = validateResult(result);
+    CalculatorError error = calcApplyFunction(op, operand, result);
     if (error != CalculatorError::NONE) {
         return createErrorResult(error);
     }
@@ -56,7 +56,7 @@ public:
     /**
      * @brief 析构函数
      */
-    ~CalculationEngine() = default;
+    virtual ~CalculationEngine() = default;
     
     /**
      * @brief 初始化计算引擎
@@ -88,25 +88,16 @@ public:
      */
     bool isValidNumber(double number) const;
 
-private:
-    // 简化的私有成员变量
-    
+protected:
     /**
      * @brief 执行基础二元运算
      * @param left 左操作数
      * @param right 右操作数
      * @param op 运算符
      * @return 计算结果
+     * @details 派生引擎可替换数值表示（如DecimalEngine）
      */
-    CalculationResult performBasicOperation(double left, double right, Operator op);
-    
-    /**
-     * @brief 执行一元运算
-     * @param operand 操作数
-     * @param op 运算符
-     * @return 计算结果
-     */
-    CalculationResult performUnaryOperation(double operand, Operator op);
+    virtual CalculationResult performBasicOperation(double left, double right, Operator op);
     
     /**
      * @brief 检查计算结果的有效性
@@ -128,6 +119,15 @@ private:
      * @return 成功结果
      */
     CalculationResult createSuccessResult(double value) const;
+
+private:
+    /**
+     * @brief 执行一元运算
+     * @param operand 操作数
+     * @param op 运算符
+     * @return 计算结果
+     */
+    CalculationResult performUnaryOperation(double operand, Operator op);
 };
 
 // 复杂的数学函数类已被移除，使用简化的基本运算
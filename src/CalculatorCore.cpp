@@ -7,25 +7,87 @@
  */
 
 #include "CalculatorCore.h"
-#include "calc_display.h"
-#include "CalculationEngine.h"
+#if defined(NATIVE_BUILD) && !defined(HOST_RENDER)
+#include "HostDisplay.h"     // 主机构建：只有接口，不绘制
+#else
+#include "calc_display.h"    // 设备和主机渲染模拟器（host/render）
+#endif
+#include "Expression.h"
 #include "KeyboardConfig.h"
+#include "CalcBackend.h"
+#include "BusinessMath.h"
+#include "ConfigManager.h"
 #include "NumberFormatter.h"
+#include "HistoryLog.h"
+#include "PeerSync.h"
+#include "MemoryRegisters.h"
+#include "ProgrammerCalc.h"
+#include "RunningStats.h"
+#include "UndoHistory.h"
+#include "UnitConverter.h"
+#include "ScratchArena.h"
+#include "UiText.h"
+#include <stdlib.h>
 
 // 按键映射表已移除，现在使用KeyboardConfig系统
 
+// 增量输入的尾数上限：超过后双精度已无法精确表示，回退为解析缓冲区
+static const int64_t INPUT_MANTISSA_LIMIT = 100000000000000000LL;  // 1e17
+
+// 10的整数次幂（1e0-1e22均可被double精确表示）
+static const double POW10_TABLE[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const uint8_t POW10_TABLE_SIZE = sizeof(POW10_TABLE) / sizeof(POW10_TABLE[0]);
+
+// 运算符在表达式文本中的符号
+static char operatorSymbol(Operator op) {
+    switch (op) {
+        case Operator::ADD: return '+';
+        case Operator::SUBTRACT: return '-';
+        case Operator::MULTIPLY: return '*';
+        case Operator::DIVIDE: return '/';
+        case Operator::POWER: return '^';
+        default: return '?';
+    }
+}
+
+// 累计总计只在商务方案下累加和显示：只有它有读出和清零GT的键
+static bool grandTotalActive() {
+    return keyboardConfig.getProfile().mode == CalcMode::BUSINESS;
+}
+
+// 光标编辑时表达式行中表示光标的字符，占一格
+static const char EDIT_CURSOR_CHAR = '|';
+
 CalculatorCore::CalculatorCore() 
     : _display(nullptr)
+    , _batching(false)
+    , _displayPending(false)
     , _state(CalculatorState::INPUT_NUMBER)
     , _lastError(CalculatorError::NONE)
+    , _inputMantissa(0)
+    , _inputScale(0)
+    , _inputExact(true)
     , _currentNumber(0.0)
-    , _previousNumber(0.0)
-    , _pendingOperator(Operator::NONE)
+    , _expression(new Expression())
     , _waitingForOperand(false)
     , _hasDecimalPoint(false)
-    , _maxHistorySize(10)
-    , _memoryValue(0.0)
-    , _hasMemoryValue(false) {
+    , _editScroll(0)
+    , _historyCursor(NOT_BROWSING)
+    , _memory(new MemoryRegisters())
+    , _programmer(new ProgrammerCalc())
+    , _stats(new RunningStats())
+    , _grandTotal(0)
+    , _grandTotalOverflow(false)
+    , _constantOp(Operator::NONE)
+    , _constantOperand(0.0)
+    , _undo(new UndoHistory())
+    , _converting(false)
+    , _conversion() {
+    
+    _conversionUnit[0] = '\0';
     
     CALC_LOG_I("计算器核心对象创建完成");
 }
@@ -47,7 +109,7 @@ bool CalculatorCore::begin() {
     const KeyConfig* equalsKey = keyboardConfig.getKeyConfig(22, KeyLayer::PRIMARY);
     if (equalsKey) {
         CALC_LOG_I("等号键 (22) 已配置: 符号='%s', 类型=%d, 操作=%d", 
-                   equalsKey->symbol.c_str(), (int)equalsKey->type, (int)equalsKey->operation);
+                   equalsKey->symbol, (int)equalsKey->type, (int)equalsKey->operation);
     } else {
         CALC_LOG_E("等号键 (22) 在配置中未找到！");
     }
@@ -58,12 +120,22 @@ bool CalculatorCore::begin() {
     // 初始化状态
     _state = CalculatorState::INPUT_NUMBER;
     _currentDisplay = "0";
-    _inputBuffer = "";
-    _expressionDisplay = "";
+    clearInputBuffer();
+    _expressionDisplay.clear();
     
     // 清空历史记录
     _history.clear();
-    _history.reserve(_maxHistorySize);
+    _history.begin();
+#if HISTORY_LOG_ENABLED
+    // 只恢复最近几条，旧记录仍在闪存中
+    HistoryLog::instance().loadTail(_history, HistoryBuffer::RECENT_CAPACITY);
+#endif
+    
+    // 恢复上次保存的内存寄存器
+    _memory->begin(MEMORY_SLOT_COUNT);
+    _stats->begin(STATS_MEDIAN_CAPACITY);
+    _undo->begin(UNDO_DEPTH, UNDO_BUFFER_SIZE);
+    UnitConverter::instance().begin();
     
     CALC_LOG_I("计算器核心初始化完成");
     return true;
@@ -71,11 +143,24 @@ bool CalculatorCore::begin() {
 
 bool CalculatorCore::handleKeyInput(uint8_t keyPosition, bool isLongPress) {
     CALC_LOG_D("处理按键输入: 位置 %d, 长按: %d", keyPosition, isLongPress);
+    // 这次按键拼接的临时文本在返回时一并回收
+    ScratchScope scratch(ScratchArena::keyEvent());
     
     // 首先检查是否为Tab键（层级切换）
     if (keyPosition == keyboardConfig.getLayoutConfig().tabKeyPosition) {
         CALC_LOG_D("检测到Tab键，委托给键盘配置处理");
-        return keyboardConfig.handleTabKey(isLongPress);
+        CalcMode mode = keyboardConfig.getProfile().mode;
+        bool handled = keyboardConfig.handleTabKey(isLongPress);
+        if (keyboardConfig.getProfile().mode != mode) {
+            // 长按Tab切换了方案，两种模式的显示内容不同
+            updateDisplay();
+        }
+        return handled;
+    }
+    
+    // HID方案下按键只作为USB键盘输出（由SimpleHID处理）
+    if (!keyboardConfig.getProfile().calculatorInput) {
+        return true;
     }
     
     // 从键盘配置管理器获取当前层级的按键配置
@@ -91,64 +176,195 @@ bool CalculatorCore::handleKeyInput(uint8_t keyPosition, bool isLongPress) {
     }
     
     CALC_LOG_V("按键映射到: %s (类型: %d, 层级: %d)", 
-               keyConfig->symbol.c_str(), (int)keyConfig->type, (int)keyboardConfig.getCurrentLayer());
+               keyConfig->symbol, (int)keyConfig->type, (int)keyboardConfig.getCurrentLayer());
+    
+    // 程序员模式：整数引擎处理，不经过表达式和double
+    if (keyboardConfig.getProfile().mode == CalcMode::PROGRAMMER && keyConfig->type != KeyType::MODE_SWITCH) {
+        _programmer->handleKey(keyConfig);
+        updateDisplay();
+        return true;
+    }
+    
+    // 按键前后的状态差异记入撤销历史（没有改变状态的按键不记录）
+    _undo->beginStep(*this);
+    bool handled = processKey(keyConfig, keyPosition, isLongPress);
+    _undo->endStep(*this);
+    return handled;
+}
+
+// 状态转移表的各个动作：只改动固定容量的缓冲区和表达式，不分配内存
+struct KeyActions {
+    typedef void (*Action)(CalculatorCore& core, const KeyConfig* keyConfig, bool isLongPress);
     
-    // 清除错误状态
-    if (_lastError != CalculatorError::NONE) {
+    static void digitAppend(CalculatorCore& core, const KeyConfig* keyConfig, bool) {
+        if (keyConfig->symbol[0] != '\0') core.appendDigit(keyConfig->symbol[0]);
+    }
+    static void digitStart(CalculatorCore& core, const KeyConfig* keyConfig, bool) {
+        if (keyConfig->symbol[0] == '\0') return;
+        core.startNumber(false);
+        core.appendDigit(keyConfig->symbol[0]);
+    }
+    static void digitFresh(CalculatorCore& core, const KeyConfig* keyConfig, bool) {
+        if (keyConfig->symbol[0] == '\0') return;
+        core.startNumber(true);
+        core.appendDigit(keyConfig->symbol[0]);
+    }
+    static void decimalAppend(CalculatorCore& core, const KeyConfig*, bool) {
+        if (core._hasDecimalPoint) return;
+        core.appendDigit('.');
+        core._hasDecimalPoint = true;
+    }
+    static void decimalStart(CalculatorCore& core, const KeyConfig*, bool) {
+        if (core._hasDecimalPoint) return;
+        core.startNumber(false);
+        core.appendDigit('.');
+    }
+    static void decimalFresh(CalculatorCore& core, const KeyConfig*, bool) {
+        if (core._hasDecimalPoint) return;
+        core.startNumber(true);
+        core.appendDigit('.');
+    }
+    static void operatorPush(CalculatorCore& core, const KeyConfig* keyConfig, bool) {
+        core._constantOp = Operator::NONE;
+        if (core.isEditing()) {
+            core.insertOperatorAtCursor(keyConfig->operation);
+            return;
+        }
+        // 当前数字进入表达式；优先级由表达式求值处理，不再立即计算
+        if ((core._expression->expectsOperand() || !core._inputBuffer.isEmpty()) && !core.pushCurrentNumber()) {
+            return;
+        }
+        core.appendOperator(keyConfig->operation);
+    }
+    static void operatorAppend(CalculatorCore& core, const KeyConfig* keyConfig, bool) {
+        core._constantOp = Operator::NONE;
+        if (core.isEditing()) {
+            core.insertOperatorAtCursor(keyConfig->operation);
+            return;
+        }
+        core.appendOperator(keyConfig->operation);
+    }
+    static void operatorRestart(CalculatorCore& core, const KeyConfig* keyConfig, bool) {
+        core._constantOp = Operator::NONE;
+        core._expression->clear();
+        core._expressionDisplay.clear();
+        if (!core.pushCurrentNumber()) return;
+        CALC_LOG_D("结果后开始新表达式: %s", core._expressionDisplay.c_str());
+        core.appendOperator(keyConfig->operation);
+    }
+    static void function(CalculatorCore& core, const KeyConfig* keyConfig, bool isLongPress) {
+        core.handleFunctionInput(keyConfig, isLongPress);
+    }
+    static void clear(CalculatorCore& core, const KeyConfig*, bool) {
+        core.handleClear();
+    }
+    static void backspace(CalculatorCore& core, const KeyConfig*, bool) {
+        core.handleBackspace();
+    }
+    static void memory(CalculatorCore& core, const KeyConfig* keyConfig, bool isLongPress) {
+        core.handleMemoryInput(keyConfig, isLongPress);
+    }
+    static void modeSwitch(CalculatorCore& core, const KeyConfig* keyConfig, bool) {
+        core.handleModeSwitch(keyConfig);
+    }
+    static void refresh(CalculatorCore&, const KeyConfig*, bool) {
+    }
+};
+
+namespace {
+
+// 按KeyAction顺序；NONE、PASS、UNHANDLED在分派前处理
+const KeyActions::Action KEY_ACTIONS[] = {
+    nullptr,
+    KeyActions::digitAppend, KeyActions::digitStart, KeyActions::digitFresh,
+    KeyActions::decimalAppend, KeyActions::decimalStart, KeyActions::decimalFresh,
+    KeyActions::operatorPush, KeyActions::operatorAppend, KeyActions::operatorRestart,
+    KeyActions::function, KeyActions::clear, KeyActions::backspace, KeyActions::memory,
+    KeyActions::modeSwitch, KeyActions::refresh,
+    nullptr, nullptr,
+};
+static_assert(sizeof(KEY_ACTIONS) / sizeof(KEY_ACTIONS[0]) == (size_t)KeyAction::COUNT,
+              "动作表须与KeyAction一一对应");
+
+const uint8_t STATE_COUNT = (uint8_t)CalculatorState::WAITING + 1;
+const uint8_t KEY_TYPE_COUNT = (uint8_t)KeyType::MAX_KEY_TYPES;
+const uint8_t RECOVER = 0x80;   // 先清除错误，回到输入数字状态
+
+constexpr uint8_t A(KeyAction action) { return (uint8_t)action; }
+constexpr uint8_t R(KeyAction action) { return (uint8_t)action | RECOVER; }
+
+// 状态转移表[状态][按键类型]，列按KeyType的顺序：
+// NUMBER, OPERATOR, FUNCTION, DECIMAL, MODE_SWITCH, LAYER_SWITCH, CLEAR, DELETE, MEMORY, POWER, RESERVED, MACRO
+#define KEY_ROW(W, digit, decimal, op) { \
+    W(KeyAction::digit), W(KeyAction::op), W(KeyAction::FUNCTION), W(KeyAction::decimal), \
+    W(KeyAction::MODE_SWITCH), W(KeyAction::REFRESH), W(KeyAction::CLEAR), W(KeyAction::BACKSPACE), \
+    W(KeyAction::MEMORY), W(KeyAction::UNHANDLED), W(KeyAction::UNHANDLED), W(KeyAction::PASS) }
+
+constexpr uint8_t KEY_TRANSITIONS[STATE_COUNT][KEY_TYPE_COUNT] = {
+    /* INPUT_NUMBER   */ KEY_ROW(A, DIGIT_APPEND, DECIMAL_APPEND, OPERATOR_PUSH),
+    /* INPUT_OPERATOR */ KEY_ROW(A, DIGIT_START, DECIMAL_START, OPERATOR_APPEND),
+    /* DISPLAY_RESULT */ KEY_ROW(A, DIGIT_FRESH, DECIMAL_FRESH, OPERATOR_RESTART),
+    /* ERROR          */ KEY_ROW(R, DIGIT_APPEND, DECIMAL_APPEND, OPERATOR_PUSH),
+    /* WAITING        */ KEY_ROW(A, DIGIT_APPEND, DECIMAL_APPEND, OPERATOR_APPEND),
+};
+
+#undef KEY_ROW
+
+// 每一项都已填写、动作有效，且只有错误状态一行带RECOVER
+constexpr bool transitionsComplete(uint8_t i = 0) {
+    return i == STATE_COUNT * KEY_TYPE_COUNT ||
+           ((KEY_TRANSITIONS[i / KEY_TYPE_COUNT][i % KEY_TYPE_COUNT] & ~RECOVER) != A(KeyAction::NONE) &&
+            (KEY_TRANSITIONS[i / KEY_TYPE_COUNT][i % KEY_TYPE_COUNT] & ~RECOVER) < A(KeyAction::COUNT) &&
+            ((KEY_TRANSITIONS[i / KEY_TYPE_COUNT][i % KEY_TYPE_COUNT] & RECOVER) != 0) ==
+                (i / KEY_TYPE_COUNT == (uint8_t)CalculatorState::ERROR) &&
+            transitionsComplete(i + 1));
+}
+static_assert(transitionsComplete(), "状态转移表须覆盖所有状态和按键类型");
+
+} // namespace
+
+KeyAction CalculatorCore::keyAction(CalculatorState state, KeyType type) {
+    if ((uint8_t)state >= STATE_COUNT || (uint8_t)type >= KEY_TYPE_COUNT) return KeyAction::UNHANDLED;
+    return (KeyAction)(KEY_TRANSITIONS[(uint8_t)state][(uint8_t)type] & ~RECOVER);
+}
+
+bool CalculatorCore::processKey(const KeyConfig* keyConfig, uint8_t keyPosition, bool isLongPress) {
+    // 浏览历史时上下键和=由浏览处理，其他按键先退出浏览再照常处理
+    if (handleHistoryBrowse(keyConfig, isLongPress)) {
+        return true;
+    }
+    if ((uint8_t)keyConfig->type >= KEY_TYPE_COUNT) {
+        CALC_LOG_W("未处理的按键类型: %d", (int)keyConfig->type);
+        return false;
+    }
+    
+    uint8_t entry = KEY_TRANSITIONS[(uint8_t)_state][(uint8_t)keyConfig->type];
+    if (entry & RECOVER) {
+        // 清除错误状态
         _lastError = CalculatorError::NONE;
         _state = CalculatorState::INPUT_NUMBER;
     }
+    KeyAction action = (KeyAction)(entry & ~RECOVER);
     
-    // 处理不同类型的按键
-    switch (keyConfig->type) {
-        case KeyType::NUMBER:
-            if (!keyConfig->symbol.isEmpty()) {
-                CALC_LOG_D("处理数字键: 位置=%d, 符号='%s'", keyPosition, keyConfig->symbol.c_str());
-                handleDigitInput(keyConfig->symbol[0]);
-            }
-            break;
-            
-        case KeyType::DECIMAL:
-            if (!_hasDecimalPoint) {
-                handleDigitInput('.');
-                _hasDecimalPoint = true;
-            }
-            break;
-            
-        case KeyType::OPERATOR:
-            handleOperatorInput(keyConfig->operation);
-            break;
-            
-        case KeyType::FUNCTION:
-            handleFunctionInput(keyConfig);
-            break;
-            
-        case KeyType::CLEAR:
-            handleClear();
-            break;
-            
-        case KeyType::DELETE:
-            handleBackspace();
-            break;
-            
-        case KeyType::LAYER_SWITCH:
-            // Tab键已在上面处理
-            break;
-            
-        case KeyType::MODE_SWITCH:
-            // handleModeSwitch(); // 模式切换已移除
-            break;
-            
-        default:
-            CALC_LOG_W("未处理的按键类型: %d", (int)keyConfig->type);
-            return false;
+    // 光标在表达式中间时只有插入、删除类按键就地处理，其他按键先把光标移回末尾
+    if (isEditing() && !editsAtCursor(keyConfig)) {
+        finishEdit();
     }
     
+    if (action == KeyAction::PASS) {
+        // 宏只发送到HID（SimpleHID处理）
+        return true;
+    }
+    if (action == KeyAction::UNHANDLED) {
+        CALC_LOG_W("未处理的按键类型: %d", (int)keyConfig->type);
+        return false;
+    }
+    KEY_ACTIONS[(uint8_t)action](*this, keyConfig, isLongPress);
+    
     updateDisplay();
     
-    // 调试日志：确认按键处理状态
-    Serial.printf("[核心] 按键 %d 已处理, 主文本=%s 状态=%d\n",
-                  keyPosition, getCurrentDisplay().c_str(), (int)getState());
+    TRACE(TRACE_CORE, "[核心] 按键 %d 已处理, 主文本=%s 状态=%d",
+          keyPosition, getCurrentDisplay(), (int)getState());
     
     return true;
 }
@@ -158,18 +374,13 @@ void CalculatorCore::setDisplay(CalcDisplay* display) {
     CALC_LOG_I("显示管理器已设置");
 }
 
-void CalculatorCore::setCalculationEngine(std::shared_ptr<CalculationEngine> engine) {
-    _engine = engine;
-    CALC_LOG_I("计算引擎已设置");
-}
-
 // 模式系统相关函数已移除
 // uint8_t CalculatorCore::addMode(...) 
 // bool CalculatorCore::switchMode(...)
 
 void CalculatorCore::clearEntry() {
     CALC_LOG_D("清除当前输入");
-    _inputBuffer = "";
+    clearInputBuffer();
     _currentDisplay = "0";
     _hasDecimalPoint = false;
     _state = CalculatorState::INPUT_NUMBER;
@@ -178,45 +389,144 @@ void CalculatorCore::clearEntry() {
 void CalculatorCore::clearAll() {
     CALC_LOG_D("清除所有内容");
     clearEntry();
-    _expressionDisplay = "";
+    _expressionDisplay.clear();
     _currentNumber = 0.0;
-    _previousNumber = 0.0;
-    _pendingOperator = Operator::NONE;
+    _expression->clear();
     _waitingForOperand = false;
     _lastError = CalculatorError::NONE;
+    _constantOp = Operator::NONE;
+    _converting = false;
     _state = CalculatorState::INPUT_NUMBER;
 }
 
+bool CalculatorCore::undo() {
+    if (keyboardConfig.getProfile().mode == CalcMode::PROGRAMMER) return false;
+    exitHistoryBrowse();
+    if (!_undo->undo(*this)) return false;
+    updateDisplay();
+    return true;
+}
+
+bool CalculatorCore::redo() {
+    if (keyboardConfig.getProfile().mode == CalcMode::PROGRAMMER) return false;
+    exitHistoryBrowse();
+    if (!_undo->redo(*this)) return false;
+    updateDisplay();
+    return true;
+}
+
+void CalculatorCore::endBatch() {
+    _batching = false;
+    if (_displayPending) {
+        updateDisplay();
+    }
+}
+
 void CalculatorCore::updateDisplay() {
+    if (_batching) {
+        // 批量输入：中间状态不上屏，只发布这一批处理完后的结果
+        _displayPending = true;
+        return;
+    }
+    _displayPending = false;
+    _model.error = 0;
+    if (_display && keyboardConfig.getProfile().mode == CalcMode::PROGRAMMER) {
+        _programmer->render(_model);
+        _display->publish(_model);
+        return;
+    }
+    if (_display && _historyCursor != NOT_BROWSING) {
+        showHistoryView();
+        return;
+    }
     if (_display) {
-        Serial.printf("[核心] updateDisplay 调用: 显示='%s', 表达式='%s', 状态=%d\n",
-                      _currentDisplay.c_str(), _expressionDisplay.c_str(), (int)_state);
+        TRACE(TRACE_CORE, "[核心] updateDisplay 调用: 显示='%s', 表达式='%s', 状态=%d",
+              _currentDisplay.c_str(), _expressionDisplay.c_str(), (int)_state);
+        
+        // 实时预览：从表达式已推进的状态出发，每次按键只合并栈顶的少量项
+        ScratchArena& arena = ScratchArena::keyEvent();
+        const char* preview = "";
+        if ((_state == CalculatorState::INPUT_NUMBER || _state == CalculatorState::INPUT_OPERATOR) &&
+            !_expression->isEmpty()) {
+            bool hasOperand = _state == CalculatorState::INPUT_NUMBER &&
+                              (_expression->expectsOperand() || !_inputBuffer.isEmpty());
+            double value = 0.0;
+            if (_expression->preview(_currentNumber, hasOperand, value) == CalculatorError::NONE) {
+                preview = arena.printf("=%s", NumberFormatter::format(value, arena));
+            }
+        }
+        if (keyboardConfig.getProfile().mode == CalcMode::STATISTICS) {
+            // 统计模式：历史两行显示累计的统计量
+            double median = 0.0;
+            bool hasMedian = _stats->median(median);
+            _model.setText(DisplayModel::LINE_OLDER, arena.printf("n=%u sum=%s avg=%s", (unsigned)_stats->count(),
+                           NumberFormatter::format(_stats->sum(), arena),
+                           NumberFormatter::format(_stats->mean(), arena)));
+            _model.setText(DisplayModel::LINE_LATEST, arena.printf("s=%s min=%s max=%s med=%s",
+                           NumberFormatter::format(_stats->stddev(), arena),
+                           NumberFormatter::format(_stats->min(), arena),
+                           NumberFormatter::format(_stats->max(), arena),
+                           hasMedian ? NumberFormatter::format(median, arena) : "-"));
+        } else {
+            _model.setText(DisplayModel::LINE_OLDER, "");
+            if (_converting) {
+                // 换算只是一次乘法，跟随输入实时更新，代替表达式预览
+                preview = arena.printf("=%s %s", NumberFormatter::format(
+                    UnitConverter::apply(_conversion, _currentNumber), arena), _conversionUnit);
+            }
+            _model.setText(DisplayModel::LINE_LATEST, preview);
+        }
+        if (isEditing()) {
+            showEditWindow();
+        } else {
+            _editScroll = 0;
+            _model.setText(DisplayModel::LINE_EXPR, _expressionDisplay.c_str());
+            _model.exprScroll = 0;
+        }
+        _model.setText(DisplayModel::LINE_RESULT, _currentDisplay.c_str());
+        
+        char indicator[DisplayModel::INDICATOR_LEN];
+        size_t length = _memory->formatIndicator(indicator, sizeof(indicator));
+        if (grandTotalActive() && (_grandTotal != 0 || _grandTotalOverflow)) {
+            snprintf(indicator + length, sizeof(indicator) - length, "%sGT", length ? " " : "");
+        }
+        _model.setIndicator(indicator);
         
-        // 直接更新CalcDisplay
-        _display->updateExprDirect(_expressionDisplay);
-        _display->updateResultDirect(_currentDisplay);
-        _display->refresh();
+        // 状态决定动画：输入运算符时表达式从结果行上移，输入数字时结果行滑入
+        if (isEditing() && _state != CalculatorState::INPUT_NUMBER) {
+            _model.state = DisplayModel::STATE_EDIT;
+        } else if (_state == CalculatorState::INPUT_OPERATOR) {
+            _model.state = DisplayModel::STATE_OPERATOR;
+        } else if (_state == CalculatorState::INPUT_NUMBER) {
+            _model.state = DisplayModel::STATE_INPUT;
+        } else {
+            _model.state = DisplayModel::STATE_RESULT;
+        }
+        _model.historyCursor = 0;
+        _model.historyCount = 0;
         
         // 简化错误处理
         if (_lastError != CalculatorError::NONE) {
-            String errorMsg = "错误: ";
+            const char* reason;
             switch (_lastError) {
                 case CalculatorError::DIVISION_BY_ZERO:
-                    errorMsg += "除数为零";
+                    reason = UI_TEXT("除数为零");
                     break;
                 case CalculatorError::OVERFLOW:
-                    errorMsg += "数据溢出";
+                    reason = UI_TEXT("数据溢出");
                     break;
                 case CalculatorError::INVALID_OPERATION:
-                    errorMsg += "无效操作";
+                    reason = UI_TEXT("无效操作");
                     break;
                 default:
-                    errorMsg += "未知错误";
+                    reason = UI_TEXT("未知错误");
                     break;
             }
-            _display->updateResultDirect(errorMsg);
-            _display->refresh();
+            _model.setText(DisplayModel::LINE_RESULT, arena.printf(UI_TEXT("错误: %s"), reason));
+            _model.state = DisplayModel::STATE_ERROR;
+            _model.error = (uint8_t)_lastError;
         }
+        _display->publish(_model);
     }
 }
 
@@ -225,120 +535,88 @@ void CalculatorCore::update() {
     
     // 调试：确认update被调用（但不要频繁打印）
     static unsigned long lastDebugPrint = 0;
-    if (millis() - lastDebugPrint > 5000) { // 每5秒打印一次
+    if (Logger::isTraceEnabled(TRACE_CORE) && millis() - lastDebugPrint > 5000) { // 每5秒打印一次
         lastDebugPrint = millis();
-        Serial.printf("[Core] update() called, display='%s', state=%d\n",
-                      _currentDisplay.c_str(), (int)_state);
+        TRACE(TRACE_CORE, "[Core] update() called, display='%s', state=%d",
+              _currentDisplay.c_str(), (int)_state);
     }
 }
 
 // 私有方法实现
 // findKeyMapping方法已被移除，现在使用KeyboardConfig系统
 
-void CalculatorCore::handleDigitInput(char digit) {
-    CALC_LOG_D("数字输入: '%c', 当前状态=%d, 缓冲区='%s'", digit, (int)_state, _inputBuffer.c_str());
-    
-    if (_state == CalculatorState::DISPLAY_RESULT) {
+void CalculatorCore::startNumber(bool fresh) {
+    if (fresh) {
         // 如果当前显示结果，输入数字开始全新计算
-        _inputBuffer = "";
-        _expressionDisplay = "";  // 清空表达式
-        _state = CalculatorState::INPUT_NUMBER;
-        _hasDecimalPoint = false;
-        _pendingOperator = Operator::NONE;
-        _previousNumber = 0.0;
+        _expressionDisplay.clear();  // 清空表达式
+        _expression->clear();
         _waitingForOperand = false;
-        
         CALC_LOG_D("结果显示后开始新计算");
-    } else if (_state == CalculatorState::INPUT_OPERATOR) {
-        // 如果刚输入运算符，输入数字开始新输入
-        _inputBuffer = "";
-        _state = CalculatorState::INPUT_NUMBER;
-        _hasDecimalPoint = false;
     }
+    clearInputBuffer();
+    _state = CalculatorState::INPUT_NUMBER;
+    _hasDecimalPoint = false;
+}
+
+void CalculatorCore::appendDigit(char digit) {
+    CALC_LOG_D("数字输入: '%c', 当前状态=%d, 缓冲区='%s'", digit, (int)_state, _inputBuffer.c_str());
     
     if (digit == '.') {
         if (_inputBuffer.isEmpty()) {
             _inputBuffer = "0.";
             _hasDecimalPoint = true;
-        } else if (!_hasDecimalPoint) {
-            _inputBuffer += digit;
+        } else if (!_hasDecimalPoint && _inputBuffer.append('.')) {
             _hasDecimalPoint = true;
         }
         // 如果已有小数点，忽略此次输入
     } else {
-        if (_inputBuffer.isEmpty()) {
-            _inputBuffer = String(digit);
-        } else if (_inputBuffer == "0" && digit != '0') {
+        if (_inputBuffer == "0" && digit != '0') {
             // 如果当前是单个"0"且输入的不是"0"，则替换
-            _inputBuffer = String(digit);
-        } else {
-            // 其他情况都是追加，包括"0"后面再输入"0"
-            _inputBuffer += digit;
+            clearInputBuffer();
+        }
+        // 其他情况都是追加，包括"0"后面再输入"0"；缓冲区已满时忽略
+        if (_inputBuffer.append(digit)) {
+            // 增量累加到尾数，不再每次重新解析整个缓冲区
+            int64_t d = digit - '0';
+            if (_inputExact && llabs(_inputMantissa) < INPUT_MANTISSA_LIMIT &&
+                (!_hasDecimalPoint || _inputScale + 1 < POW10_TABLE_SIZE)) {
+                _inputMantissa = _inputMantissa * 10 + (_inputBuffer.charAt(0) == '-' ? -d : d);
+                if (_hasDecimalPoint) {
+                    _inputScale++;
+                }
+            } else {
+                _inputExact = false;
+            }
         }
     }
     
     _currentDisplay = _inputBuffer;
-    _currentNumber = _inputBuffer.toDouble();
+    _currentNumber = inputValue();
     
     CALC_LOG_D("数字输入后: 缓冲区='%s', 数字=%.6f", _inputBuffer.c_str(), _currentNumber);
 }
 
-void CalculatorCore::handleOperatorInput(Operator op) {
+void CalculatorCore::appendOperator(Operator op) {
     CALC_LOG_V("运算符输入: %d", (int)op);
     
-    String opSymbol = "";
-    switch(op) {
-        case Operator::ADD: opSymbol = "+"; break;
-        case Operator::SUBTRACT: opSymbol = "-"; break;
-        case Operator::MULTIPLY: opSymbol = "*"; break;
-        case Operator::DIVIDE: opSymbol = "/"; break;
-        default: opSymbol = "?"; break;
+    char opSymbol = operatorSymbol(op);
+    if (_expression->lastIsOperator()) {
+        // 连续输入运算符时只更换最后一个
+        _expression->replaceLastOperator(op);
+        _expressionDisplay.removeLast();
+        _expressionDisplay += opSymbol;
+        CALC_LOG_D("表达式中的运算符已更改: %s", _expressionDisplay.c_str());
+    } else if (_expressionDisplay.isFull() || !_expression->pushOperator(op)) {
+        // '('之后或表达式已满
+        return;
+    } else {
+        _expressionDisplay += opSymbol;
     }
     
-    if (_state == CalculatorState::DISPLAY_RESULT) {
-        // 如果当前显示结果，开始新的表达式
-        _expressionDisplay = NumberFormatter::format(_currentNumber) + opSymbol;
-        _previousNumber = _currentNumber;
-        _pendingOperator = op;
-        
-        CALC_LOG_D("结果后开始新表达式: %s", _expressionDisplay.c_str());
-        
-    } else if (_state == CalculatorState::INPUT_NUMBER) {
-        // 如果有待处理的运算符，先执行之前的计算
-        if (_pendingOperator != Operator::NONE) {
-            // 先将当前数字添加到表达式中
-            _expressionDisplay += NumberFormatter::format(_currentNumber);
-            
-            // 执行计算但不修改表达式显示
-            if (performCalculation()) {
-                // 计算完成后，在表达式后添加新运算符
-                _expressionDisplay += opSymbol;
-            } else {
-                return; // 计算错误，终止
-            }
-        } else {
-            // 将当前数字添加到表达式中
-            if (_expressionDisplay.isEmpty()) {
-                // 第一个数字和运算符
-                _expressionDisplay = NumberFormatter::format(_currentNumber) + opSymbol;  
-            } else {
-                // 继续积累表达式：添加当前数字和新运算符
-                _expressionDisplay += NumberFormatter::format(_currentNumber) + opSymbol;
-            }
-        }
-        
-        // 设置新的待处理运算符和操作数
-        _previousNumber = _currentNumber;
-        _pendingOperator = op;
-        
-    } else if (_state == CalculatorState::INPUT_OPERATOR) {
-        // 如果已经在等待操作数状态，只是更换最后一个运算符
-        if (!_expressionDisplay.isEmpty()) {
-            // 移除最后一个运算符，添加新的运算符
-            _expressionDisplay = _expressionDisplay.substring(0, _expressionDisplay.length() - 1) + opSymbol;
-        }
-        _pendingOperator = op;
-        CALC_LOG_D("表达式中的运算符已更改: %s", _expressionDisplay.c_str());
+    // 已推进的部分出错（如除以0）
+    if (_expression->getError() != CalculatorError::NONE) {
+        setError(_expression->getError());
+        return;
     }
     
     // 统一设置状态
@@ -347,129 +625,627 @@ void CalculatorCore::handleOperatorInput(Operator op) {
     
     // 重置输入区显示为0，等待下一个数字
     _currentDisplay = "0";
-    _inputBuffer = "";
+    clearInputBuffer();
     _hasDecimalPoint = false;
     
     CALC_LOG_D("表达式累计: %s, 当前显示重置为 0", _expressionDisplay.c_str());
 }
 
-// 旧的handleFunctionInput(KeyMapping*)方法已被移除，使用新的handleFunctionInput(KeyConfig*)
-
-bool CalculatorCore::performCalculation() {
-    if (!_engine || _pendingOperator == Operator::NONE) {
-        return false;
+void CalculatorCore::handleParenInput(bool open) {
+    if (open) {
+        uint8_t mark = _expression->cursor();
+        size_t lengthBefore = _expressionDisplay.length();
+        if (_state == CalculatorState::DISPLAY_RESULT) {
+            _expression->clear();
+            _expressionDisplay.clear();
+        } else if (_state == CalculatorState::INPUT_NUMBER && !_inputBuffer.isEmpty()) {
+            // "2(" 按 2×( 处理
+            if (!pushCurrentNumber()) return;
+        }
+        size_t at = textCursor();
+        if (_expressionDisplay.isFull() || !_expression->openParen() || !_expression->isConsistent()) {
+            if (isEditing()) rollbackInsert(mark, lengthBefore);
+            return;
+        }
+        _expressionDisplay.insert(at, "(", 1);
+    } else {
+        // 中间编辑只插入'('：光标之后以操作数开始，')'接不上
+        if (isEditing() || _expression->getOpenDepth() == 0) return;
+        if (_state == CalculatorState::INPUT_NUMBER &&
+            (_expression->expectsOperand() || !_inputBuffer.isEmpty())) {
+            if (!pushCurrentNumber()) return;
+        }
+        if (_expressionDisplay.isFull() || !_expression->closeParen()) return;
+        _expressionDisplay += ')';
+        
+        if (_expression->getError() != CalculatorError::NONE) {
+            setError(_expression->getError());
+            return;
+        }
     }
     
-    CALC_LOG_D("执行计算: %.6f %d %.6f", 
-               _previousNumber, (int)_pendingOperator, _currentNumber);
+    _state = CalculatorState::INPUT_OPERATOR;
+    _waitingForOperand = true;
+    _currentDisplay = "0";
+    clearInputBuffer();
+    _hasDecimalPoint = false;
     
-    auto result = _engine->calculate(_previousNumber, _currentNumber, _pendingOperator);
+    CALC_LOG_D("括号输入: %s", _expressionDisplay.c_str());
+}
+
+bool CalculatorCore::pushCurrentNumber() {
+    const char* text = NumberFormatter::format(_currentNumber, ScratchArena::keyEvent());
+    size_t length = strlen(text);
     
-    if (result.isValid) {
-        // 更新当前数字和显示
-        _currentNumber = result.value;
-        _previousNumber = result.value;  // 为链式运算准备
-        _currentDisplay = NumberFormatter::format(_currentNumber);
-        
-        // 重置运算符状态
-        _pendingOperator = Operator::NONE;
-        _waitingForOperand = false;
-        _inputBuffer = "";
-        _hasDecimalPoint = false;
-        
-        CALC_LOG_D("计算结果: %.6f", _currentNumber);
-        return true;
-    } else {
-        setError(result.error);
+    // 数字后至少还要能放下一个运算符或括号
+    if (_expressionDisplay.length() + length + 1 >= EXPRESSION_CAPACITY) {
+        CALC_LOG_W("表达式已满");
         return false;
     }
+    size_t at = textCursor();
+    if (!_expression->pushNumber(_currentNumber, (uint8_t)length)) {
+        CALC_LOG_W("表达式记号已满");
+        return false;
+    }
+    _expressionDisplay.insert(at, text, length);
+    return true;
 }
 
 void CalculatorCore::setError(CalculatorError error) {
     _lastError = error;
     _state = CalculatorState::ERROR;
+    _constantOp = Operator::NONE;
+    _converting = false;
+    
+    // 出错后重新开始，不保留无法求值的表达式
+    _expression->clear();
+    _expressionDisplay.clear();
     CALC_LOG_E("计算器错误: %d", (int)error);
 }
 
-void CalculatorCore::addToHistory(const String& expression, double result) {
-    CalculationHistory entry;
-    entry.expression = expression;
-    entry.result = result;
-    entry.timestamp = millis();
-    entry.modeId = 0; // 固定为基本模式
-    
-    _history.push_back(entry);
-    
-    // 历史记录已保存在内部，显示器可以通过getHistory()获取
+void CalculatorCore::addToHistory(double result) {
+    // 以记号形式保存，O(1)追加；显示器可以通过getHistory()按序号读取
+    _history.append(*_expression, result, millis());
+#if HISTORY_LOG_ENABLED
+    HistoryLog::instance().append(*_history.get(0));
+#endif
+#if PEER_SYNC_ENABLED
+    // 广播给同组设备合计
+    PeerSync::instance().publish(*_history.get(0));
+#endif
     
-    // 限制历史记录数量
-    if (_history.size() > _maxHistorySize) {
-        _history.erase(_history.begin());
-    }
-    
-    CALC_LOG_D("已添加到历史记录: %s = %.6f", expression.c_str(), result);
+    CALC_LOG_D("已添加到历史记录: %s = %.6f", _expressionDisplay.c_str(), result);
 }
 
 void CalculatorCore::resetInputState() {
-    _inputBuffer = "";
+    clearInputBuffer();
     _hasDecimalPoint = false;
     _waitingForOperand = false;
 }
 
+void CalculatorCore::clearInputBuffer() {
+    _inputBuffer.clear();
+    _inputMantissa = 0;
+    _inputScale = 0;
+    _inputExact = true;
+}
+
+void CalculatorCore::parseInputBuffer() {
+    _inputMantissa = 0;
+    _inputScale = 0;
+    _inputExact = true;
+    
+    bool negative = false;
+    bool fraction = false;
+    for (size_t i = 0; i < _inputBuffer.length(); i++) {
+        char c = _inputBuffer.charAt(i);
+        if (c == '-' && i == 0) {
+            negative = true;
+        } else if (c == '.' && !fraction) {
+            fraction = true;
+        } else if (c >= '0' && c <= '9' && llabs(_inputMantissa) < INPUT_MANTISSA_LIMIT &&
+                   (!fraction || _inputScale + 1 < POW10_TABLE_SIZE)) {
+            _inputMantissa = _inputMantissa * 10 + (negative ? -(c - '0') : (c - '0'));
+            if (fraction) {
+                _inputScale++;
+            }
+        } else {
+            _inputExact = false;
+            return;
+        }
+    }
+}
+
+double CalculatorCore::inputValue() const {
+    if (!_inputExact) {
+        return strtod(_inputBuffer.c_str(), nullptr);
+    }
+    return (double)_inputMantissa / POW10_TABLE[_inputScale];
+}
+
 // formatNumber方法已被移除，统一使用NumberFormatter::format
 
 // ============================================================================
 // 新的按键处理方法实现
 // ============================================================================
 
-void CalculatorCore::handleFunctionInput(const KeyConfig* keyConfig) {
-    CALC_LOG_V("功能输入 (新): %s", keyConfig->label.c_str());
+void CalculatorCore::handleFunctionInput(const KeyConfig* keyConfig, bool isLongPress) {
+    CALC_LOG_V("功能输入 (新): %s", keyConfig->label);
     
     if (keyConfig->operation == Operator::EQUALS) {
-        CALC_LOG_D("等号键被按下. 待处理运算符: %d, 表达式: '%s'", 
-                   (int)_pendingOperator, _expressionDisplay.c_str());
-        
-        if (_pendingOperator != Operator::NONE && !_expressionDisplay.isEmpty()) {
-            // 将最后输入的数字添加到表达式中，形成完整表达式
-            String completeExpression = _expressionDisplay + NumberFormatter::format(_currentNumber);
-            
-            // 执行计算
-            if (performCalculation()) {
-                // 计算完成后，_currentNumber已经是结果
-                double result = _currentNumber;
-                
-                // 新方案：表达式行显示"公式=结果"格式
-                _expressionDisplay = completeExpression + "=" + NumberFormatter::format(result);
-                _currentDisplay = NumberFormatter::format(result);   // 结果显示在主显示区
-                _state = CalculatorState::DISPLAY_RESULT;
-                
-                // 将完整表达式添加到历史记录
-                addToHistory(completeExpression, result);
-                
-                CALC_LOG_D("等号执行: %s", _expressionDisplay.c_str());
-            }
-        }
+        handleEquals();
     } else if (keyConfig->operation == Operator::PERCENT) {
         // 处理百分比
         if (_state == CalculatorState::INPUT_NUMBER) {
             _currentNumber = _currentNumber / 100.0;
-            _currentDisplay = NumberFormatter::format(_currentNumber);
+            _currentDisplay = NumberFormatter::format(_currentNumber, ScratchArena::keyEvent());
             _inputBuffer = _currentDisplay;
+            parseInputBuffer();
         }
-    } else if (keyConfig->functionName == "sign") {
+    } else if (calcIsFunction(keyConfig->operation)) {
+        handleUnaryFunction(keyConfig->operation);
+    } else if (BusinessMath::isBusiness(keyConfig->operation)) {
+        handleBusinessInput(keyConfig->operation, isLongPress);
+    } else if (strcmp(keyConfig->functionName, "lparen") == 0) {
+        handleParenInput(true);
+    } else if (strcmp(keyConfig->functionName, "rparen") == 0) {
+        handleParenInput(false);
+    } else if (strncmp(keyConfig->functionName, "stat_", 5) == 0) {
+        handleStatsInput(keyConfig->functionName);
+    } else if (strncmp(keyConfig->functionName, "conv:", 5) == 0) {
+        handleConvertInput(keyConfig->functionName + 5, isLongPress);
+    } else if (strcmp(keyConfig->functionName, "cursor_left") == 0) {
+        moveEditCursor(-1);
+    } else if (strcmp(keyConfig->functionName, "cursor_right") == 0) {
+        moveEditCursor(1);
+    } else if (strcmp(keyConfig->functionName, "sign") == 0) {
         // 处理正负号切换
         if (_state == CalculatorState::INPUT_NUMBER) {
             _currentNumber = -_currentNumber;
-            _currentDisplay = NumberFormatter::format(_currentNumber);
+            _currentDisplay = NumberFormatter::format(_currentNumber, ScratchArena::keyEvent());
             _inputBuffer = _currentDisplay;
+            parseInputBuffer();
         }
     } else {
         // 处理其他自定义函数
-        CALC_LOG_I("自定义功能: %s", keyConfig->functionName.c_str());
+        CALC_LOG_I("自定义功能: %s", keyConfig->functionName);
         // 这里可以扩展其他功能
     }
 }
 
+void CalculatorCore::handleEquals() {
+    CALC_LOG_D("等号键被按下. 记号数: %d, 表达式: '%s'", 
+               _expression->size(), _expressionDisplay.c_str());
+    
+    if (_expression->isEmpty() && _constantOp != Operator::NONE &&
+        (_state == CalculatorState::DISPLAY_RESULT || _state == CalculatorState::INPUT_NUMBER)) {
+        repeatConstant();
+        return;
+    }
+    
+    if (_state != CalculatorState::DISPLAY_RESULT && !_expression->isEmpty()) {
+        // 将最后输入的数字添加到表达式中，形成完整表达式
+        if (_expression->expectsOperand() ||
+            (_state == CalculatorState::INPUT_NUMBER && !_inputBuffer.isEmpty())) {
+            if (!pushCurrentNumber()) return;
+        }
+        // 补全未闭合的括号（文本放不下时求值仍会自动闭合）
+        while (_expression->getOpenDepth() > 0 && !_expressionDisplay.isFull() &&
+               _expression->closeParen()) {
+            _expressionDisplay += ')';
+        }
+        FixedString<EXPRESSION_CAPACITY> completeExpression = _expressionDisplay;
+        
+        // 末尾为"运算符 数字"时记下这一步，再按=时以结果为左操作数重复（常数计算）
+        uint8_t count = _expression->size();
+        _constantOp = Operator::NONE;
+        if (count >= 2 && _expression->tokenAt(count - 1).type == ExprTokenType::NUMBER &&
+            _expression->tokenAt(count - 2).type == ExprTokenType::OPERATOR &&
+            _expression->tokenAt(count - 2).textLength > 0) {
+            _constantOp = _expression->tokenAt(count - 2).op;
+            _constantOperand = _expression->tokenAt(count - 1).value;
+        }
+        
+        // 按优先级计算整个表达式
+        double result = 0.0;
+        CalculatorError error = _expression->evaluate(result);
+        if (error != CalculatorError::NONE) {
+            setError(error);
+            return;
+        }
+        commitResult(result);
+        
+        // 新方案：表达式行显示"公式=结果"格式
+        _expressionDisplay = completeExpression;
+        _expressionDisplay += '=';
+        _expressionDisplay += NumberFormatter::format(result, ScratchArena::keyEvent());
+        
+        CALC_LOG_D("等号执行: %s", _expressionDisplay.c_str());
+    }
+}
+
+void CalculatorCore::repeatConstant() {
+    // 以当前数字为左操作数只推进一步，历史记录仍是完整的表达式
+    ScratchArena& arena = ScratchArena::keyEvent();
+    const char* left = NumberFormatter::format(_currentNumber, arena);
+    const char* right = NumberFormatter::format(_constantOperand, arena);
+    _expression->clear();
+    _expression->pushNumber(_currentNumber, (uint8_t)strlen(left));
+    _expression->pushOperator(_constantOp);
+    _expression->pushNumber(_constantOperand, (uint8_t)strlen(right));
+    
+    double result = 0.0;
+    CalculatorError error = _expression->evaluate(result);
+    if (error != CalculatorError::NONE) {
+        setError(error);
+        return;
+    }
+    commitResult(result);
+    
+    // 表达式行只显示重复的一步，连续按=时内容不变，只重绘结果行
+    _expressionDisplay.clear();
+    _expressionDisplay += operatorSymbol(_constantOp);
+    _expressionDisplay += right;
+    _expressionDisplay += '=';
+    
+    CALC_LOG_D("常数计算: %s%s → %s", left, _expressionDisplay.c_str(), _currentDisplay.c_str());
+}
+
+void CalculatorCore::commitResult(double result) {
+    _currentNumber = result;
+    
+    // 将完整表达式添加到历史记录
+    addToHistory(result);
+    int64_t scaled;
+    if (grandTotalActive() &&
+        (!BusinessMath::toScaled(result, BusinessMath::EXACT_DECIMALS, scaled) ||
+         __builtin_add_overflow(_grandTotal, scaled, &_grandTotal))) {
+        _grandTotalOverflow = true;
+    }
+    _expression->clear();
+    _waitingForOperand = false;
+    clearInputBuffer();
+    _hasDecimalPoint = false;
+    
+    // 结果显示在主显示区，按结果行宽度选择表示，放不下时显示器再缩小字号
+    char fitted[NumberFormatter::BUFFER_SIZE];
+    if (_display) {
+        NumberFormatter::formatFit(result, fitted, sizeof(fitted), _resultFormat,
+                                   _display->getLineWidthBudget(), _display->getMinCharWidth(3));
+    } else {
+        NumberFormatter::formatTo(result, fitted, sizeof(fitted), _resultFormat.decimalPlaces);
+    }
+    _currentDisplay = fitted;
+    _state = CalculatorState::DISPLAY_RESULT;
+}
+
+void CalculatorCore::handleUnaryFunction(Operator op) {
+    double result = 0.0;
+    CalculatorError error = calcApplyFunction(op, _currentNumber, result);
+    if (error != CalculatorError::NONE) {
+        setError(error);
+        return;
+    }
+    
+    recallNumber(result);
+    CALC_LOG_D("函数 %d: %s", (int)op, _currentDisplay.c_str());
+}
+
+void CalculatorCore::recallNumber(double value) {
+    if (_state == CalculatorState::DISPLAY_RESULT) {
+        // 作用于上一次的结果或调出数值后，开始新计算
+        _expressionDisplay.clear();
+        _expression->clear();
+        _waitingForOperand = false;
+    }
+    _state = CalculatorState::INPUT_NUMBER;
+    _currentNumber = value;
+    _currentDisplay = NumberFormatter::format(_currentNumber, ScratchArena::keyEvent());
+    _inputBuffer = _currentDisplay;
+    parseInputBuffer();
+    _hasDecimalPoint = strchr(_inputBuffer.c_str(), '.') != nullptr;
+}
+
+void CalculatorCore::handleStatsInput(const char* name) {
+    if (strcmp(name, "stat_add") == 0) {
+        // 有未完成的表达式时先求值，累计的是结果
+        bool evaluated = _state != CalculatorState::DISPLAY_RESULT && !_expression->isEmpty();
+        if (evaluated) {
+            handleEquals();
+            if (_state == CalculatorState::ERROR) return;
+        }
+        _stats->add(_currentNumber);
+        
+        ScratchArena& arena = ScratchArena::keyEvent();
+        const char* added = evaluated ? arena.copy(_expressionDisplay.c_str(), _expressionDisplay.length())
+                                      : NumberFormatter::format(_currentNumber, arena);
+        _expressionDisplay = arena.printf("#%u: %s", (unsigned)_stats->count(), added);
+        _expression->clear();
+        _waitingForOperand = false;
+        clearInputBuffer();
+        _hasDecimalPoint = false;
+        // 再输入数字从头开始
+        _state = CalculatorState::DISPLAY_RESULT;
+        return;
+    }
+    if (strcmp(name, "stat_clear") == 0) {
+        _stats->clear();
+        return;
+    }
+    
+    // 取出统计量作为当前数字，可以接着运算
+    double value = 0.0;
+    if (strcmp(name, "stat_n") == 0) {
+        value = _stats->count();
+    } else if (strcmp(name, "stat_sum") == 0) {
+        value = _stats->sum();
+    } else if (strcmp(name, "stat_mean") == 0) {
+        value = _stats->mean();
+    } else if (strcmp(name, "stat_sd") == 0) {
+        value = _stats->stddev();
+    } else if (strcmp(name, "stat_sdp") == 0) {
+        value = _stats->populationStddev();
+    } else if (strcmp(name, "stat_min") == 0) {
+        value = _stats->min();
+    } else if (strcmp(name, "stat_max") == 0) {
+        value = _stats->max();
+    } else if (strcmp(name, "stat_median") == 0) {
+        if (!_stats->median(value)) {
+            setError(CalculatorError::INVALID_OPERATION);
+            return;
+        }
+    } else {
+        CALC_LOG_W("未知统计操作: %s", name);
+        return;
+    }
+    recallNumber(value);
+}
+
+void CalculatorCore::handleBusinessInput(Operator op, bool isLongPress) {
+    ConfigManager& config = ConfigManager::getInstance();
+    
+    if (op == Operator::GRAND_TOTAL) {
+        if (isLongPress) {
+            _grandTotal = 0;
+            _grandTotalOverflow = false;
+        } else if (_grandTotalOverflow) {
+            setError(CalculatorError::OVERFLOW);
+        } else {
+            recallNumber(BusinessMath::fromScaled(_grandTotal, BusinessMath::EXACT_DECIMALS));
+        }
+        return;
+    }
+    
+    if (isLongPress) {
+        // 当前数字按百分数保存：13 → 13%，即130000（百万分之一）
+        int64_t rate;
+        int64_t limit = op == Operator::DISCOUNT ? BusinessMath::RATE_SCALE : BusinessMath::MAX_RATE;
+        if (!BusinessMath::toScaled(_currentNumber, 4, rate) || rate < 0 || rate > limit) {
+            setError(CalculatorError::INVALID_OPERATION);
+            return;
+        }
+        const char* name;
+        if (op == Operator::MARKUP) {
+            config.setMarkupRate((uint32_t)rate);
+            name = "MU";
+        } else if (op == Operator::DISCOUNT) {
+            config.setDiscountRate((uint32_t)rate);
+            name = "DISC";
+        } else {
+            config.setTaxRate((uint32_t)rate);
+            name = "TAX";
+        }
+        ScratchArena& arena = ScratchArena::keyEvent();
+        _expressionDisplay = arena.printf("%s=%s%%", name, NumberFormatter::format(_currentNumber, arena, 4));
+        _expression->clear();
+        _waitingForOperand = false;
+        clearInputBuffer();
+        _hasDecimalPoint = false;
+        _state = CalculatorState::DISPLAY_RESULT;
+        return;
+    }
+    
+    uint32_t rate = op == Operator::MARKUP ? config.getMarkupRate() :
+                    op == Operator::DISCOUNT ? config.getDiscountRate() : config.getTaxRate();
+    double result = 0.0;
+    CalculatorError error = BusinessMath::apply(op, _currentNumber, rate, result);
+    if (error != CalculatorError::NONE) {
+        setError(error);
+        return;
+    }
+    recallNumber(result);
+    CALC_LOG_D("商务功能 %d (%lu ppm): %s", (int)op, (unsigned long)rate, _currentDisplay.c_str());
+}
+
+void CalculatorCore::handleConvertInput(const char* spec, bool isLongPress) {
+    const char* to = strchr(spec, ':');
+    char from[sizeof(_conversionUnit)];
+    size_t length = to ? to - spec : 0;
+    UnitConverter::Pair pair;
+    if (!length || length >= sizeof(from) || strlen(to + 1) >= sizeof(_conversionUnit)) {
+        CALC_LOG_W("换算键格式无效: %s", spec);
+        return;
+    }
+    memcpy(from, spec, length);
+    from[length] = '\0';
+    to++;
+    if (!UnitConverter::instance().resolve(from, to, pair)) {
+        setError(CalculatorError::INVALID_OPERATION);
+        return;
+    }
+    
+    if (isLongPress) {
+        // 换算结果成为当前数字，可以继续计算
+        _converting = false;
+        recallNumber(UnitConverter::apply(pair, _currentNumber));
+        return;
+    }
+    _conversion = pair;
+    strcpy(_conversionUnit, to);
+    _converting = true;
+    CALC_LOG_D("换算 %s -> %s: x%.9g", from, to, pair.scale);
+}
+
+void CalculatorCore::handleMemoryInput(const KeyConfig* keyConfig, bool isLongPress) {
+    const char *op = keyConfig->label;
+    
+    if (strcmp(op, "M_RECALL") == 0 && isLongPress) {
+        _memory->selectNext();
+        return;
+    }
+    
+    bool isAdd = strcmp(op, "M_ADD") == 0;
+    if (isAdd || strcmp(op, "M_SUB") == 0) {
+        // 作用于当前显示的数字（输入中的数字或上一次的结果）
+        CalculatorError error = isAdd ? _memory->add(_currentNumber) : _memory->subtract(_currentNumber);
+        if (error != CalculatorError::NONE) {
+            setError(error);
+            return;
+        }
+        // 单独的数字存入后，再输入数字从头开始
+        if (_state == CalculatorState::INPUT_NUMBER && _expression->isEmpty()) {
+            _state = CalculatorState::DISPLAY_RESULT;
+        }
+    } else if (strcmp(op, "M_RECALL") == 0) {
+        recallNumber(_memory->recall());
+    } else if (strcmp(op, "M_CLEAR") == 0) {
+        _memory->clear();
+    } else {
+        CALC_LOG_W("未知内存操作: %s", op);
+        return;
+    }
+    
+    CALC_LOG_D("内存操作: %s, M%u = %.6f", op, _memory->getActiveSlot() + 1, _memory->recall());
+}
+
+bool CalculatorCore::handleHistoryBrowse(const KeyConfig* keyConfig, bool isLongPress) {
+    bool function = keyConfig->type == KeyType::FUNCTION;
+    bool up = function && strcmp(keyConfig->functionName, "hist_up") == 0;
+    if (up || (function && strcmp(keyConfig->functionName, "hist_down") == 0)) {
+        int step = isLongPress ? HISTORY_BROWSE_PAGE : 1;
+        browseHistory(up ? step : -step);
+        updateDisplay();
+        return true;
+    }
+    if (_historyCursor == NOT_BROWSING) {
+        return false;
+    }
+    
+    if (keyConfig->operation != Operator::EQUALS) {
+        exitHistoryBrowse();
+        return false;
+    }
+    
+    // 长按=：调出所选记录的表达式再编辑；=：取出所选记录的结果，之后可以直接接着运算
+    const HistoryRecord* record = _history.get(_historyCursor);
+    exitHistoryBrowse();
+    if (record && isLongPress && recallExpression(*record)) {
+        updateDisplay();
+        return true;
+    }
+    if (record) {
+        clearAll();
+        _currentNumber = record->result;
+        _currentDisplay = NumberFormatter::format(record->result, ScratchArena::keyEvent());
+        _state = CalculatorState::DISPLAY_RESULT;
+    }
+    updateDisplay();
+    return true;
+}
+
+bool CalculatorCore::recallExpression(const HistoryRecord& record) {
+    ExprToken tokens[HistoryRecord::MAX_TOKENS];
+    char text[EXPRESSION_CAPACITY];
+    uint8_t count = HistoryBuffer::decode(record, tokens, text, sizeof(text));
+    if (count == 0) {
+        CALC_LOG_D("历史记录过长或无法还原，只取结果");
+        return false;
+    }
+    
+    // 末尾的数字放回输入区，与按=之前的状态相同：可以退格修改，也可以接着输入运算符；
+    // 它前面的隐式乘法由再次推入数字时重新插入
+    uint8_t keep = count;
+    bool trailingNumber = tokens[count - 1].type == ExprTokenType::NUMBER;
+    if (trailingNumber) {
+        keep--;
+        if (keep > 0 && tokens[keep - 1].type == ExprTokenType::OPERATOR && tokens[keep - 1].textLength == 0) {
+            keep--;
+        }
+    }
+    
+    clearAll();
+    // 记号直接重放，检查点随之重建，之后中间编辑和求值与刚输入的表达式一样只重算改动之后的部分
+    if (!_expression->restore(0, tokens, keep)) {
+        _expression->clear();
+        return false;
+    }
+    size_t length = 0;
+    for (uint8_t i = 0; i < keep; i++) {
+        length += tokens[i].textLength;
+    }
+    text[length] = '\0';
+    _expressionDisplay = text;
+    
+    if (trailingNumber) {
+        recallNumber(tokens[count - 1].value);
+    } else {
+        // 以')'结尾：与刚输入')'之后相同
+        _state = CalculatorState::INPUT_OPERATOR;
+        _waitingForOperand = true;
+    }
+    CALC_LOG_D("调出历史表达式: %s (%u个记号)", _expressionDisplay.c_str(), count);
+    return true;
+}
+
+void CalculatorCore::browseHistory(int step) {
+    if (_historyCursor == NOT_BROWSING) {
+        // 向上进入浏览，从最新一条开始
+        if (step > 0 && _history.size() > 0) {
+            _historyCursor = 0;
+        }
+        return;
+    }
+    
+    if (step < 0 && (size_t)-step > _historyCursor) {
+        exitHistoryBrowse();
+        return;
+    }
+    size_t next = _historyCursor + step;
+    if (next >= _history.size()) next = _history.size() - 1;
+    _historyCursor = next;
+}
+
+void CalculatorCore::exitHistoryBrowse() {
+    if (_historyCursor == NOT_BROWSING) return;
+    _historyCursor = NOT_BROWSING;
+}
+
+void CalculatorCore::showHistoryView() {
+    // 相邻两次只差一条，显示器据此把其余两行整行平移，只绘制新露出的一行；
+    // 文本在记录插入时已格式化，这里只取指针
+    const char* rows[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        rows[i] = _history.line(_historyCursor + i);
+    }
+    
+    const HistoryRecord* selected = _history.get(_historyCursor);
+    char fitted[NumberFormatter::BUFFER_SIZE] = "";
+    if (selected) {
+        NumberFormatter::formatFit(selected->result, fitted, sizeof(fitted), _resultFormat,
+                                   _display->getLineWidthBudget(), _display->getMinCharWidth(3));
+    }
+    
+    _model.setText(DisplayModel::LINE_OLDER, rows[2]);
+    _model.setText(DisplayModel::LINE_LATEST, rows[1]);
+    _model.setText(DisplayModel::LINE_EXPR, rows[0]);
+    _model.setText(DisplayModel::LINE_RESULT, fitted);
+    _model.setIndicator("");
+    _model.state = DisplayModel::STATE_BROWSE;
+    _model.historyCursor = (uint16_t)_historyCursor;
+    _model.historyCount = (uint16_t)_history.size();
+    _display->publish(_model);
+}
+
 void CalculatorCore::handleClear() {
     CALC_LOG_D("清除操作");
     clearAll();
@@ -480,8 +1256,8 @@ void CalculatorCore::handleBackspace() {
     
     if (_state == CalculatorState::INPUT_NUMBER && !_inputBuffer.isEmpty()) {
         // 删除最后一个字符
-        char lastChar = _inputBuffer.charAt(_inputBuffer.length() - 1);
-        _inputBuffer.remove(_inputBuffer.length() - 1);
+        char lastChar = _inputBuffer.back();
+        _inputBuffer.removeLast();
         
         // 如果删除的是小数点，重置小数点标志
         if (lastChar == '.') {
@@ -490,18 +1266,242 @@ void CalculatorCore::handleBackspace() {
         
         // 更新当前数字和显示
         if (_inputBuffer.isEmpty()) {
+            clearInputBuffer();
             _currentNumber = 0.0;
             _currentDisplay = "0";
-            _inputBuffer = "";
         } else {
-            _currentNumber = _inputBuffer.toDouble();
+            parseInputBuffer();
+            _currentNumber = inputValue();
             _currentDisplay = _inputBuffer;
         }
         
         CALC_LOG_V("退格后: 缓冲区='%s', 数字=%.6f", 
                    _inputBuffer.c_str(), _currentNumber);
+    } else if (isEditing()) {
+        deleteBeforeCursor();
+        CALC_LOG_V("退格后表达式: '%s'，光标在%u", _expressionDisplay.c_str(), (unsigned)textCursor());
+    } else if (_state == CalculatorState::INPUT_OPERATOR && !_expression->isEmpty()) {
+        // 删除表达式末尾的运算符或括号，表达式从最近的检查点重新求值
+        _expressionDisplay.truncate(_expressionDisplay.length() - _expression->removeLast());
+        reopenLastNumber();
+        
+        CALC_LOG_V("退格后表达式: '%s'", _expressionDisplay.c_str());
+    }
+}
+
+void CalculatorCore::reopenLastNumber() {
+    // 露出的数字回到输入区继续编辑
+    const ExprToken* last = _expression->last();
+    if (!last || last->type != ExprTokenType::NUMBER) return;
+    
+    size_t textStart = _expressionDisplay.length() - last->textLength;
+    _currentNumber = last->value;
+    _inputBuffer.assign(_expressionDisplay.c_str() + textStart);
+    _expressionDisplay.truncate(textStart);
+    _expression->removeLast();
+    parseInputBuffer();
+    _hasDecimalPoint = strchr(_inputBuffer.c_str(), '.') != nullptr;
+    _currentDisplay = _inputBuffer;
+    _state = CalculatorState::INPUT_NUMBER;
+    _waitingForOperand = false;
+}
+
+bool CalculatorCore::isEditing() const {
+    return !_expression->atEnd();
+}
+
+void CalculatorCore::finishEdit() {
+    if (isEditing()) placeCursor(_expression->size());
+}
+
+size_t CalculatorCore::textCursor() const {
+    // 结果、统计等文本不由记号组成，光标在末尾时以文本长度为准
+    return isEditing() ? _expression->textOffset() : _expressionDisplay.length();
+}
+
+bool CalculatorCore::editsAtCursor(const KeyConfig* keyConfig) const {
+    const char* name = keyConfig->functionName;
+    switch (keyConfig->type) {
+        case KeyType::NUMBER:
+        case KeyType::DECIMAL:
+        case KeyType::OPERATOR:
+        case KeyType::CLEAR:
+        case KeyType::DELETE:
+        case KeyType::LAYER_SWITCH:
+        case KeyType::MACRO:
+            return true;
+        case KeyType::FUNCTION:
+            // 只作用于当前数字的功能就地处理；=、统计、商务、换算作用于整个表达式
+            return keyConfig->operation == Operator::PERCENT || calcIsFunction(keyConfig->operation) ||
+                   strcmp(name, "lparen") == 0 || strcmp(name, "rparen") == 0 ||
+                   strcmp(name, "sign") == 0 || strncmp(name, "cursor_", 7) == 0;
+        default:
+            return false;
     }
 }
 
-// 模式切换函数已移除
-// void CalculatorCore::handleModeSwitch() { ... }
\ No newline at end of file
+void CalculatorCore::moveEditCursor(int step) {
+    if (_state == CalculatorState::DISPLAY_RESULT || _state == CalculatorState::ERROR) return;
+    
+    uint8_t position = _expression->cursor();
+    uint8_t size = _expression->size();
+    if (step < 0) {
+        if (!isEditing() && _state == CalculatorState::INPUT_NUMBER && !_inputBuffer.isEmpty()) {
+            // 离开末尾：正在输入的数字先进入表达式，回到末尾时再取出
+            if (!pushCurrentNumber()) return;
+            position = size = _expression->size();
+        }
+        if (position == 0) return;
+        do {
+            position--;
+        } while (position > 0 && !_expression->expectsOperandAt(position));
+    } else {
+        if (!isEditing()) return;
+        do {
+            position++;
+        } while (position < size && !_expression->expectsOperandAt(position));
+    }
+    placeCursor(position);
+    CALC_LOG_D("光标移到第%u个记号后: '%s'", (unsigned)position, _expressionDisplay.c_str());
+}
+
+void CalculatorCore::placeCursor(uint8_t position) {
+    // 越过的记号从检查点重放或逐个推进；中间还没插入的数字只能和运算符一起插入，丢弃
+    _expression->moveCursor(position);
+    clearInputBuffer();
+    _hasDecimalPoint = false;
+    _currentNumber = 0.0;
+    _currentDisplay = "0";
+    _state = CalculatorState::INPUT_OPERATOR;
+    _waitingForOperand = true;
+    if (!isEditing()) {
+        reopenLastNumber();
+    }
+}
+
+void CalculatorCore::insertOperatorAtCursor(Operator op) {
+    char opSymbol = operatorSymbol(op);
+    
+    if (_state != CalculatorState::INPUT_NUMBER || _inputBuffer.isEmpty()) {
+        // 没有新数字：更换光标前的运算符（隐式乘法没有文本，不更换）
+        const ExprToken* last = _expression->last();
+        if (!last || last->type != ExprTokenType::OPERATOR || last->textLength == 0) return;
+        size_t at = _expression->textOffset() - 1;
+        if (!_expression->replaceLastOperator(op)) return;
+        _expressionDisplay.erase(at, 1);
+        _expressionDisplay.insert(at, &opSymbol, 1);
+    } else {
+        // 光标在操作数的位置，插入"数字 运算符"后光标仍在操作数的位置，两侧照样衔接
+        uint8_t mark = _expression->cursor();
+        size_t lengthBefore = _expressionDisplay.length();
+        if (!pushCurrentNumber()) return;
+        size_t at = _expression->textOffset();
+        if (_expressionDisplay.isFull() || !_expression->pushOperator(op) || !_expression->isConsistent()) {
+            rollbackInsert(mark, lengthBefore);
+            return;
+        }
+        _expressionDisplay.insert(at, &opSymbol, 1);
+    }
+    
+    // 光标之前已推进的部分出错（如插入"0"后成为除以0）
+    if (_expression->getError() != CalculatorError::NONE) {
+        setError(_expression->getError());
+        return;
+    }
+    
+    _state = CalculatorState::INPUT_OPERATOR;
+    _waitingForOperand = true;
+    _currentDisplay = "0";
+    clearInputBuffer();
+    _hasDecimalPoint = false;
+    
+    CALC_LOG_D("光标处插入运算符: %s", _expressionDisplay.c_str());
+}
+
+void CalculatorCore::deleteBeforeCursor() {
+    uint8_t cursor = _expression->cursor();
+    const ExprToken* last = _expression->last();
+    if (!last) return;
+    
+    uint8_t from;
+    if (last->type == ExprTokenType::LPAREN) {
+        // "2(" 中的隐式乘法没有文本，只删'('会让数字直接接上光标之后的操作数
+        if (cursor >= 2 && _expression->tokenAt(cursor - 2).textLength == 0) return;
+        from = cursor - 1;
+    } else if (last->type == ExprTokenType::OPERATOR && cursor >= 2 &&
+               _expression->tokenAt(cursor - 2).type == ExprTokenType::NUMBER) {
+        from = cursor - 2;
+    } else {
+        return;     // ')'之后的运算符：删除会拆开括号
+    }
+    
+    size_t length = 0;
+    for (uint8_t i = from; i < cursor; i++) {
+        length += _expression->tokenAt(i).textLength;
+    }
+    _expression->removeFrom(from);
+    if (!_expression->isConsistent()) {
+        // 删除'('后光标之后的')'没有对应的'('：放回
+        _expression->openParen();
+        return;
+    }
+    _expressionDisplay.erase(_expression->textOffset(), length);
+}
+
+void CalculatorCore::rollbackInsert(uint8_t mark, size_t lengthBefore) {
+    _expression->removeFrom(mark);
+    _expressionDisplay.erase(_expression->textOffset(), _expressionDisplay.length() - lengthBefore);
+}
+
+void CalculatorCore::showEditWindow() {
+    // 窗口按最小字号的字符宽度放满一行，光标占一格；光标越出窗口时只滚动到刚好可见，
+    // 渲染侧按exprScroll的变化平移已画的字形，只重画新露出的和光标附近的几格
+    size_t cursor = _expression->textOffset();
+    size_t length = _expressionDisplay.length() + 1;
+    size_t width = _display->getLineWidthBudget() / _display->getMinCharWidth(DisplayModel::LINE_EXPR);
+    if (width > DisplayModel::TEXT_LEN - 1) width = DisplayModel::TEXT_LEN - 1;
+    
+    if (cursor < _editScroll) {
+        _editScroll = (uint8_t)cursor;
+    } else if (cursor >= _editScroll + width) {
+        _editScroll = (uint8_t)(cursor - width + 1);
+    }
+    if (length <= width) {
+        _editScroll = 0;
+    } else if (_editScroll > length - width) {
+        _editScroll = (uint8_t)(length - width);
+    }
+    
+    char window[DisplayModel::TEXT_LEN];
+    const char* text = _expressionDisplay.c_str();
+    size_t count = 0;
+    for (size_t i = _editScroll; i < length && count < width; i++) {
+        window[count++] = i < cursor ? text[i] : (i == cursor ? EDIT_CURSOR_CHAR : text[i - 1]);
+    }
+    window[count] = '\0';
+    _model.setText(DisplayModel::LINE_EXPR, window);
+    _model.exprScroll = _editScroll;
+}
+
+void CalculatorCore::handleModeSwitch(const KeyConfig* keyConfig) {
+    const char* name = keyConfig->functionName;
+    if (strcmp(name, "calculator") == 0) {
+        // 各模式保留自己的状态（统计量、整数引擎），切换回来时继续
+        exitHistoryBrowse();
+        keyboardConfig.selectMode(CalcMode::STANDARD);
+    } else if (strcmp(name, "programmer") == 0) {
+        exitHistoryBrowse();
+        keyboardConfig.selectMode(CalcMode::PROGRAMMER);
+    } else if (strcmp(name, "statistics") == 0) {
+        exitHistoryBrowse();
+        keyboardConfig.selectMode(CalcMode::STATISTICS);
+    } else if (strcmp(name, "base") == 0) {
+        _programmer->nextBase();
+    } else if (strcmp(name, "word") == 0) {
+        _programmer->nextWordSize();
+    } else if (strcmp(name, "signed") == 0) {
+        _programmer->toggleSigned();
+    } else {
+        CALC_LOG_W("未知模式切换: %s", name);
+    }
+}
@@ -23,11 +23,21 @@
 #include <memory>
 #include "Logger.h"
 #include "KeyboardConfig.h"
+#include "FixedString.h"
+#include "HistoryBuffer.h"
+#include "NumberFormatter.h"
+#include "DisplayModel.h"
+#include "UnitConverter.h"
 
 // 前向声明
 class CalcDisplay;
-class CalculationEngine;
+class Expression;
+class MemoryRegisters;
 class NumberFormatter;
+class ProgrammerCalc;
+class RunningStats;
+class UndoHistory;
+class ResumeState;
 
 // 使用 KeyboardConfig.h 中定义的枚举类型
 // 避免重复定义 KeyType 和 Operator
@@ -46,13 +56,28 @@ enum class CalculatorState {
 // 旧的KeyMapping结构已被移除，使用KeyboardConfig系统中的KeyConfig
 
 /**
- * @brief 计算历史记录结构
+ * @brief 按键动作：状态转移表按[状态][按键类型]给出，processKey据此一次查表分派
  */
-struct CalculationHistory {
-    String expression;          ///< 计算表达式
-    double result;              ///< 计算结果
-    uint32_t timestamp;         ///< 时间戳
-    uint8_t modeId;            ///< 计算模式ID
+enum class KeyAction : uint8_t {
+    NONE = 0,           ///< 表中漏填的项（编译期检查不存在）
+    DIGIT_APPEND,       ///< 数字追加到当前输入
+    DIGIT_START,        ///< 运算符之后开始新的数字
+    DIGIT_FRESH,        ///< 结果之后开始全新计算
+    DECIMAL_APPEND,     ///< 小数点，同上三种情况
+    DECIMAL_START,
+    DECIMAL_FRESH,
+    OPERATOR_PUSH,      ///< 当前数字进入表达式，再追加运算符
+    OPERATOR_APPEND,    ///< 只追加或更换运算符
+    OPERATOR_RESTART,   ///< 以结果开始新的表达式
+    FUNCTION,
+    CLEAR,
+    BACKSPACE,
+    MEMORY,
+    MODE_SWITCH,
+    REFRESH,            ///< 只刷新显示（Tab已在handleKeyInput中处理）
+    PASS,               ///< 宏只发送到HID，不刷新显示
+    UNHANDLED,          ///< 计算器不处理的按键类型，返回false
+    COUNT
 };
 
 /**
@@ -98,16 +123,15 @@ public:
     bool handleKeyInput(uint8_t keyPosition, bool isLongPress = false);
     
     /**
-     * @brief 设置显示管理器
-     * @param display 显示管理器指针
+     * @brief 状态转移表：在state下按type类按键执行的动作（错误状态先清除错误，再按输入数字状态处理）
      */
-    void setDisplay(CalcDisplay* display);
+    static KeyAction keyAction(CalculatorState state, KeyType type);
     
     /**
-     * @brief 设置计算引擎
-     * @param engine 计算引擎指针
+     * @brief 设置显示管理器
+     * @param display 显示管理器指针
      */
-    void setCalculationEngine(std::shared_ptr<CalculationEngine> engine);
+    void setDisplay(CalcDisplay* display);
     
     /**
      * @brief 添加计算模式
@@ -134,13 +158,24 @@ public:
      * @brief 获取当前显示内容
      * @return 显示内容字符串
      */
-    String getCurrentDisplay() const { return _currentDisplay; }
+    const char* getCurrentDisplay() const { return _currentDisplay.c_str(); }
     
     /**
      * @brief 获取计算历史
-     * @return 计算历史数组
+     * @return 计算历史（序号0为最新一条）
+     */
+    const HistoryBuffer& getHistory() const { return _history; }
+    void clearHistory() { _history.clear(); }
+    
+    /**
+     * @brief 是否正在浏览历史（次层上下键进入）
+     */
+    bool isBrowsingHistory() const { return _historyCursor != NOT_BROWSING; }
+    
+    /**
+     * @brief 设置结果行的数字格式（按结果行宽度自动选择小数位数或工程计数法）
      */
-    const std::vector<CalculationHistory>& getHistory() const { return _history; }
+    void setResultFormat(const NumberFormat& format) { _resultFormat = format; }
     
     /**
      * @brief 清除当前输入
@@ -152,6 +187,18 @@ public:
      */
     void clearAll();
     
+    /**
+     * @brief 撤销上一次按键对计算状态的改变（内存寄存器、统计量等副作用不撤销）
+     * @return 没有可撤销的步骤时返回false
+     */
+    bool undo();
+    
+    /**
+     * @brief 重做撤销掉的一步
+     * @return 没有可重做的步骤时返回false
+     */
+    bool redo();
+    
     /**
      * @brief 获取最后的错误
      * @return 错误类型
@@ -159,69 +206,174 @@ public:
     CalculatorError getLastError() const { return _lastError; }
     
     /**
-     * @brief 更新显示
+     * @brief 更新显示（批量输入期间只记下需要刷新，endBatch()时发布一次）
      */
     void updateDisplay();
     
+    /**
+     * @brief 开始批量输入：之后的按键只更新状态，不逐键发布显示
+     * @details 连续的快速按键、回放等一批事件逐个处理后只刷新一帧，
+     *          吞吐量取决于按键处理而不是帧时间。重复调用无影响
+     */
+    void beginBatch() { _batching = true; }
+    
+    /**
+     * @brief 结束批量输入：这一批中有改变显示的按键时发布一次
+     */
+    void endBatch();
+    
     /**
      * @brief 定期更新
      */
     void update();
 
 private:
+    friend class UndoHistory;           ///< 撤销历史直接保存和恢复下面的状态字段
+    friend class ResumeState;           ///< 深度睡眠前后同样直接保存和恢复
+    friend struct KeyActions;           ///< 状态转移表的各个动作
+    
     // 核心组件
     CalcDisplay* _display;                              ///< 显示管理器
-    std::shared_ptr<CalculationEngine> _engine;         ///< 计算引擎
+    bool _batching;                                     ///< 批量输入中，显示推迟到endBatch()
+    bool _displayPending;                               ///< 批量输入中有未发布的显示更新
     
     // 状态管理
     CalculatorState _state;             ///< 当前状态
     // uint8_t _currentModeId;            // 移除模式系统
     CalculatorError _lastError;         ///< 最后的错误
     
-    // 输入缓冲
-    String _inputBuffer;                ///< 输入缓冲区
-    String _currentDisplay;             ///< 当前显示内容
-    String _expressionDisplay;          ///< 表达式显示
+    // 输入缓冲（固定容量，按键处理不分配堆内存）
+    static const size_t INPUT_CAPACITY = 32;        ///< 输入/显示缓冲容量（含结尾'\0'）
+    static const size_t EXPRESSION_CAPACITY = 128;  ///< 表达式缓冲容量（含结尾'\0'）
+    FixedString<INPUT_CAPACITY> _inputBuffer;       ///< 输入缓冲区
+    FixedString<INPUT_CAPACITY> _currentDisplay;    ///< 当前显示内容
+    FixedString<EXPRESSION_CAPACITY> _expressionDisplay;  ///< 表达式显示
+    DisplayModel _model;                            ///< 送到显示器的界面状态，每次更新整体填写后发布
+    
+    // 增量数值输入：输入值 = _inputMantissa / 10^_inputScale
+    int64_t _inputMantissa;             ///< 已输入数字组成的整数
+    uint8_t _inputScale;                ///< 小数点后的位数
+    bool _inputExact;                   ///< 尾数未溢出（否则回退为解析缓冲区）
     
     // 计算状态
     double _currentNumber;              ///< 当前数字
-    double _previousNumber;             ///< 上一个数字
-    Operator _pendingOperator;          ///< 待处理的运算符
+    std::unique_ptr<Expression> _expression;  ///< 已输入的表达式（按优先级求值）
     bool _waitingForOperand;           ///< 是否等待操作数
     bool _hasDecimalPoint;             ///< 是否有小数点
+    uint8_t _editScroll;               ///< 光标编辑时表达式行窗口的起点（表达式文本中的位置）
+    NumberFormat _resultFormat;        ///< 结果行的数字格式
     
     // 历史记录
-    std::vector<CalculationHistory> _history;   ///< 计算历史
-    size_t _maxHistorySize;            ///< 最大历史记录数
-    size_t _lastDisplayedHistorySize;   ///< 已显示的历史记录数量
+    HistoryBuffer _history;             ///< 计算历史（近期在内部RAM，归档在PSRAM）
+    static const size_t NOT_BROWSING = SIZE_MAX;
+    size_t _historyCursor;              ///< 浏览历史时所选记录的序号（0为最新），NOT_BROWSING表示未浏览
     
     // 内存功能
-    double _memoryValue;               ///< 内存值
-    bool _hasMemoryValue;              ///< 是否有内存值
+    std::unique_ptr<MemoryRegisters> _memory;   ///< M+/M-/MR/MC寄存器
+    
+    // 程序员模式（布局方案的mode为PROGRAMMER时按键交给整数引擎）
+    std::unique_ptr<ProgrammerCalc> _programmer;
+    
+    // 统计模式的累计量（Σ+加入当前数字）
+    std::unique_ptr<RunningStats> _stats;
+    
+    // 累计总计：商务方案下各次=的结果按BusinessMath::EXACT_DECIMALS位定点累加
+    int64_t _grandTotal;
+    bool _grandTotalOverflow;           ///< 累加溢出，清除前GT报错
+    
+    // 常数计算：上一次=时表达式末尾的运算符和操作数，再按=时对结果重复这一步
+    Operator _constantOp;               ///< NONE表示没有可重复的运算
+    double _constantOperand;
+    
+    // 撤销/重做：每次按键前后的状态差异
+    std::unique_ptr<UndoHistory> _undo;
+    
+    // 换算：按换算键后第二行显示当前数字换算后的值，清除前一直跟随当前数字
+    bool _converting;
+    UnitConverter::Pair _conversion;
+    char _conversionUnit[4];            ///< 目标单位代码
     
     // 按键映射系统 (已废弃，由KeyboardConfig代替)
     // static const KeyConfig _keyMappings[];
     // static const size_t _keyMappingsSize;
     
     /**
-     * @brief 处理数字输入
-     * @param digit 数字字符
+     * @brief 按键配置已确定后的处理（计算器方案），前后由撤销历史记录
      */
-    void handleDigitInput(char digit);
+    bool processKey(const KeyConfig* keyConfig, uint8_t keyPosition, bool isLongPress);
     
     /**
-     * @brief 处理运算符输入
+     * @brief 开始输入新的数字
+     * @param fresh true时同时清除表达式（结果之后开始全新计算）
+     */
+    void startNumber(bool fresh);
+    
+    /**
+     * @brief 数字或小数点追加到当前输入
+     * @param digit '0'-'9'或'.'
+     */
+    void appendDigit(char digit);
+    
+    /**
+     * @brief 运算符追加到表达式末尾（连续输入时更换最后一个）
      * @param op 运算符
      */
-    void handleOperatorInput(Operator op);
+    void appendOperator(Operator op);
     
     // 旧的handleFunctionInput(KeyMapping*)方法已被移除
     
     /**
      * @brief 处理功能键输入 (新版)
      * @param keyConfig 按键配置
+     * @param isLongPress 是否为长按（商务功能键长按保存比率）
+     */
+    void handleFunctionInput(const KeyConfig* keyConfig, bool isLongPress);
+    
+    /**
+     * @brief 等号：求值整个表达式，结果进入历史记录
+     */
+    void handleEquals();
+    
+    /**
+     * @brief 常数计算：当前数字 _constantOp _constantOperand，结果同样进入历史记录
+     */
+    void repeatConstant();
+    
+    /**
+     * @brief 求值得到结果后的共同处理：历史记录、累计总计、结果行和状态
+     */
+    void commitResult(double result);
+    
+    /**
+     * @brief 统计模式的按键：Σ+累计当前数字（先求值未完成的表达式），其余取出统计量
+     * @param name 按键的functionName（stat_add、stat_clear、stat_mean等）
+     */
+    void handleStatsInput(const char* name);
+    
+    /**
+     * @brief 商务功能：含税、去税、加价、折扣作用于当前数字，GT取出累计总计
+     * @param op BusinessMath::isBusiness()为true的运算符
+     * @param isLongPress 长按比率键把当前数字（百分数）保存为该比率，长按GT清除总计
+     */
+    void handleBusinessInput(Operator op, bool isLongPress);
+    
+    /**
+     * @brief 换算键：第二行显示当前数字换算后的值
+     * @param spec "源单位:目标单位"（functionName去掉"conv:"）
+     * @param isLongPress 长按把换算结果作为当前数字
      */
-    void handleFunctionInput(const KeyConfig* keyConfig);
+    void handleConvertInput(const char* spec, bool isLongPress);
+    
+    /**
+     * @brief 把一个数值作为当前输入的数字（MR、函数结果、统计量）
+     */
+    void recallNumber(double value);
+    
+    /**
+     * @brief 单参数函数（√、x²、1/x、sin、ln等）作用于当前数字
+     * @param op calcIsFunction()为true的运算符
+     */
+    void handleUnaryFunction(Operator op);
     
     /**
      * @brief 处理清除操作
@@ -233,16 +385,116 @@ private:
      */
     void handleBackspace();
     
+    // 光标编辑：第二层的◀▶在表达式中间移动光标，只停在操作数的位置（开头、运算符和'('之后）
+    
     /**
-     * @brief 处理模式切换
+     * @brief 光标是否在表达式中间
      */
-    void handleModeSwitch();
+    bool isEditing() const;
     
     /**
-     * @brief 执行计算
-     * @return true 成功，false 失败
+     * @brief 光标在表达式文本中的位置
      */
-    bool performCalculation();
+    size_t textCursor() const;
+    
+    /**
+     * @brief 光标在表达式中间时按键能否就地处理（插入、删除、光标键、作用于当前数字的功能）
+     */
+    bool editsAtCursor(const KeyConfig* keyConfig) const;
+    
+    /**
+     * @brief 按step（±1）移动到相邻的光标位置；离开末尾时正在输入的数字先进入表达式
+     */
+    void moveEditCursor(int step);
+    
+    /**
+     * @brief 把光标放在前position个记号之后，丢弃还没插入的数字；到达末尾时取出末尾的数字继续编辑
+     */
+    void placeCursor(uint8_t position);
+    
+    /**
+     * @brief 光标回到末尾（=和其他作用于整个表达式的按键之前）
+     */
+    void finishEdit();
+    
+    /**
+     * @brief 光标在中间时插入"数字 运算符"，没有新数字时更换光标前的运算符
+     */
+    void insertOperatorAtCursor(Operator op);
+    
+    /**
+     * @brief 光标在中间时删除光标前的"数字 运算符"或'('（两侧仍须能衔接）
+     */
+    void deleteBeforeCursor();
+    
+    /**
+     * @brief 撤回中间插入的记号和文本：记号回到mark个，文本回到lengthBefore
+     */
+    void rollbackInsert(uint8_t mark, size_t lengthBefore);
+    
+    /**
+     * @brief 表达式末尾的数字取回输入区继续编辑
+     */
+    void reopenLastNumber();
+    
+    /**
+     * @brief 光标编辑时表达式行显示包含光标的一段，光标越出时最少量地横向滚动
+     */
+    void showEditWindow();
+    
+    /**
+     * @brief 处理模式切换键：计算器/程序员模式，程序员模式的进制、字长和有无符号
+     * @param keyConfig 按键配置，functionName区分操作
+     */
+    void handleModeSwitch(const KeyConfig* keyConfig);
+    
+    /**
+     * @brief 把当前数字追加到表达式
+     * @return 表达式已满时返回false
+     */
+    bool pushCurrentNumber();
+    
+    /**
+     * @brief 处理括号输入
+     * @param open true为'('，false为')'
+     */
+    void handleParenInput(bool open);
+    
+    /**
+     * @brief 处理内存键（M+、M-、MR、MC）
+     * @param keyConfig 按键配置，label区分操作
+     * @param isLongPress 长按MR切换到下一个寄存器
+     */
+    void handleMemoryInput(const KeyConfig* keyConfig, bool isLongPress);
+    
+    /**
+     * @brief 浏览历史时的按键处理
+     * @param isLongPress 长按=时调出所选记录的表达式再编辑，短按只取结果
+     * @return 按键已被浏览处理（上下键、=）返回true；其他按键退出浏览后返回false，由调用方照常处理
+     */
+    bool handleHistoryBrowse(const KeyConfig* keyConfig, bool isLongPress);
+    
+    /**
+     * @brief 把历史记录的表达式载入编辑：记号由记录直接还原（不解析文本），末尾的数字放回输入区
+     * @return 记录被截断（超过HistoryRecord的容量）或无法还原时返回false，状态不变
+     */
+    bool recallExpression(const HistoryRecord& record);
+    
+    /**
+     * @brief 移动历史浏览位置
+     * @param step 正数向更旧的记录移动；未浏览时向上进入浏览，越过最新一条时退出浏览
+     */
+    void browseHistory(int step);
+    
+    /**
+     * @brief 退出历史浏览，恢复历史行
+     */
+    void exitHistoryBrowse();
+    
+    /**
+     * @brief 显示历史浏览视图：L2为所选记录，L1、L0依次更旧，结果行显示所选结果
+     */
+    void showHistoryView();
     
     /**
      * @brief 设置错误状态
@@ -251,17 +503,31 @@ private:
     void setError(CalculatorError error);
     
     /**
-     * @brief 添加到历史记录
-     * @param expression 表达式
+     * @brief 把当前表达式添加到历史记录
      * @param result 结果
      */
-    void addToHistory(const String& expression, double result);
+    void addToHistory(double result);
     
     /**
      * @brief 重置输入状态
      */
     void resetInputState();
     
+    /**
+     * @brief 清空输入缓冲区和增量数值
+     */
+    void clearInputBuffer();
+    
+    /**
+     * @brief 由输入缓冲区重新计算增量数值（退格、正负号等少见操作使用）
+     */
+    void parseInputBuffer();
+    
+    /**
+     * @brief 由增量数值得到当前输入的数字
+     */
+    double inputValue() const;
+    
     // formatNumber方法已被移除，统一使用NumberFormatter::format
 };
 
@@ -0,0 +1,209 @@
+/**
+ * @file ChordFilter.h
+ * @brief 组合键检测和成员键事件的暂缓
+ * @details 第一个键按下开始一个组合，窗口内按下的键归入同一组合，窗口结束或全部松开时收集结束。
+ * 组合只应执行组合的动作（Tab+1选择方案，不能先把1作为次层的1/x执行）：
+ * - 注册组合时keys[0]为修饰键（如Tab）。组合从修饰键开始时，成员键的事件先暂缓
+ * - 收集到的键不再可能组成已注册的组合（按下了组合外的键）时，暂缓的事件按原顺序放行
+ * - 收集结束时组成了已注册的组合：丢弃暂缓的事件，只上报组合事件，
+ *   之后这些键到松开为止的长按、重复和释放也不上报
+ * - 收集结束时没有组成组合：暂缓的事件按原顺序放行（只按修饰键时它的按下推迟到松开或窗口结束）
+ * 从其他键开始的组合，成员键已作为普通按键上报，组合事件的ID为0。
+ * 不依赖硬件，扫描侧（KeypadControl）和主机检查共用。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CHORD_FILTER_H
+#define CHORD_FILTER_H
+
+#include <stdint.h>
+#include <string.h>
+#include "KeyEventBus.h"
+
+class ChordFilter {
+public:
+    static const uint8_t MAX_KEYS = sizeof(KeyEvent::combo);   ///< 组合内最多的按键数
+    static const uint8_t TABLE_SIZE = 16;                       ///< 组合键表容量（2的幂）
+
+    /**
+     * @brief 事件出口：放行的按键事件和组合事件（combo/count只用于组合事件）
+     */
+    typedef void (*Sink)(KeyEventType type, uint8_t key, const uint8_t* combo, uint8_t count, void* context);
+
+    ChordFilter(uint16_t windowMs, Sink sink, void* context)
+        : _sink(sink), _context(context), _windowMs(windowMs), _modifierMask(0),
+          _mask(0), _start(0), _swallowMask(0), _active(false), _closed(false), _holding(false),
+          _heldCount(0) {
+        memset(_table, 0, sizeof(_table));
+    }
+
+    void setWindow(uint16_t windowMs) { _windowMs = windowMs; }
+
+    /**
+     * @brief 注册组合键
+     * @param keys 组合内的按键编号（1-22），keys[0]为修饰键
+     * @return 表已满或参数无效返回false；相同按键集合重复注册时覆盖原来的ID
+     */
+    bool add(const uint8_t* keys, uint8_t count, uint8_t id) {
+        if (!keys || count < 2 || count > MAX_KEYS || id == 0) return false;
+        uint32_t mask = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (keys[i] < 1 || keys[i] > 22) return false;
+            mask |= 1UL << (keys[i] - 1);
+        }
+        if (__builtin_popcount(mask) < 2) return false;
+
+        uint8_t slot = slotOf(mask);
+        for (uint8_t probe = 0; probe < TABLE_SIZE; probe++) {
+            Entry& entry = _table[slot];
+            if (entry.mask == 0 || entry.mask == mask) {
+                entry.mask = mask;
+                entry.id = id;
+                _modifierMask |= 1UL << (keys[0] - 1);
+                return true;
+            }
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        }
+        return false;
+    }
+
+    /**
+     * @brief 按键集合对应的组合ID，未注册返回0
+     */
+    uint8_t find(uint32_t keyMask) const {
+        if (!keyMask) return 0;
+        uint8_t slot = slotOf(keyMask);
+        for (uint8_t probe = 0; probe < TABLE_SIZE; probe++) {
+            const Entry& entry = _table[slot];
+            if (entry.mask == keyMask) return entry.id;
+            if (entry.mask == 0) return 0;
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief 按键事件（按下、释放、长按、重复）先经过这里，放行的交给sink
+     */
+    void onKey(KeyEventType type, uint8_t key, uint32_t now) {
+        if (key < 1 || key > 22) return;
+        uint32_t bit = 1UL << (key - 1);
+        if (_swallowMask & bit) {
+            if (type == KEY_EVENT_RELEASE) _swallowMask &= ~bit;
+            return;
+        }
+        if (type == KEY_EVENT_PRESS) {
+            if (!_active) {
+                _active = true;
+                _closed = false;
+                _mask = 0;
+                _start = now;
+                _holding = (_modifierMask & bit) != 0;
+            }
+            if (!_closed) {
+                _mask |= bit;
+                if (_holding && !possible(_mask)) release();
+            }
+        }
+        if (_holding && (_mask & bit)) {
+            if (_heldCount < HELD_CAPACITY) {
+                _held[_heldCount].type = (uint8_t)type;
+                _held[_heldCount].key = key;
+                _heldCount++;
+                return;
+            }
+            // 窗口内反复按同一个键：不再暂缓
+            release();
+        }
+        _sink(type, key, nullptr, 0, _context);
+    }
+
+    /**
+     * @brief 每次扫描调用：窗口结束或全部松开时结束收集，至少两个键才上报组合事件
+     * @param pressedMask 当前按下的按键位图
+     */
+    void update(uint32_t pressedMask, uint32_t now) {
+        if (!_active) return;
+        if (!_closed && (now - _start >= _windowMs || !pressedMask)) {
+            _closed = true;
+            uint8_t id = 0;
+            if (_holding) {
+                id = find(_mask);
+                if (id) {
+                    _heldCount = 0;
+                    _holding = false;
+                    _swallowMask |= _mask & pressedMask;
+                } else {
+                    release();
+                }
+            }
+            uint8_t count = __builtin_popcount(_mask);
+            if (count > 1 && count <= MAX_KEYS) {
+                uint8_t keys[MAX_KEYS];
+                uint32_t bits = _mask;
+                for (uint8_t n = 0; bits; n++) {
+                    keys[n] = __builtin_ctz(bits) + 1;
+                    bits &= bits - 1;
+                }
+                _sink(KEY_EVENT_COMBO, id, keys, count, _context);
+            }
+        }
+        // 全部松开后才允许开始下一个组合
+        if (_closed && !pressedMask) {
+            _active = false;
+        }
+    }
+
+private:
+    static const uint8_t HELD_CAPACITY = MAX_KEYS * 2;         ///< 每个成员键一次按下和释放
+
+    // 组合键表项：按键位图为键的开放寻址哈希表
+    struct Entry {
+        uint32_t mask;          ///< 按键位图（0表示空位）
+        uint8_t id;             ///< 组合ID
+    };
+
+    struct Held {
+        uint8_t type;           ///< KeyEventType
+        uint8_t key;
+    };
+
+    // Fibonacci哈希，取高位作为槽位
+    static uint8_t slotOf(uint32_t keyMask) {
+        return (uint8_t)((keyMask * 2654435761UL) >> 28) & (TABLE_SIZE - 1);
+    }
+
+    // 收集到的键是否还是某个已注册组合的子集
+    bool possible(uint32_t keyMask) const {
+        for (const Entry& entry : _table) {
+            if (entry.mask && (entry.mask & keyMask) == keyMask) return true;
+        }
+        return false;
+    }
+
+    // 按原顺序放行暂缓的事件，本次收集不再暂缓
+    void release() {
+        _holding = false;
+        for (uint8_t i = 0; i < _heldCount; i++) {
+            _sink((KeyEventType)_held[i].type, _held[i].key, nullptr, 0, _context);
+        }
+        _heldCount = 0;
+    }
+
+    Sink _sink;
+    void* _context;
+    Entry _table[TABLE_SIZE];   ///< 已注册的组合键
+    uint16_t _windowMs;         ///< 组合键窗口
+    uint32_t _modifierMask;     ///< 各组合的修饰键
+    uint32_t _mask;             ///< 当前组合收集到的按键
+    uint32_t _start;            ///< 当前组合开始时间
+    uint32_t _swallowMask;      ///< 已组成组合、到松开为止不上报的键
+    bool _active;               ///< 正在收集或已结束收集、尚未全部松开
+    bool _closed;               ///< 当前组合已结束收集
+    bool _holding;              ///< 成员键的事件正在暂缓
+    Held _held[HELD_CAPACITY];  ///< 暂缓的事件
+    uint8_t _heldCount;
+};
+
+#endif // CHORD_FILTER_H
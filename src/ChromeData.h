@@ -0,0 +1,17 @@
+// 由 tools/chrome_bake.py 生成，不要手工修改
+// 480x135 颜色角色，行程编码 18 字节，有底图的行 1
+
+#ifndef CHROME_DATA_H
+#define CHROME_DATA_H
+
+#include <stdint.h>
+
+static const uint16_t CHROME_WIDTH = 480;
+static const uint16_t CHROME_HEIGHT = 135;
+static const uint32_t CHROME_DATA_SIZE = 18;
+
+static const uint8_t CHROME_DATA[18] = {
+    0xFF, 0xFF, 0xEC, 0xCE, 0xBF, 0xBF, 0xBF, 0xBF, 0xBF, 0xBF, 0xBF, 0x81, 0xFF, 0xFF, 0xFF, 0xFF, 0xCE, 0x8E,
+};
+
+#endif // CHROME_DATA_H
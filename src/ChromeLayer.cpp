@@ -0,0 +1,146 @@
+/**
+ * @file ChromeLayer.cpp
+ * @brief 固定不变的界面底图实现
+ *
+ * @author Calculator Project
+ */
+
+#include "ChromeLayer.h"
+#include "ChromeData.h"
+#include "BufferPlacement.h"
+#include "PixelKernels.h"
+#include "Logger.h"
+
+#define TAG_CHROME "Chrome"
+
+namespace {
+
+// 行程解码（格式见tools/chrome_bake.py），按像素逐个取角色
+class ChromeDecoder {
+public:
+    ChromeDecoder() : _p(CHROME_DATA), _end(CHROME_DATA + CHROME_DATA_SIZE), _role(0), _left(0) {}
+
+    uint8_t next() {
+        if (_left == 0) {
+            if (_p >= _end) return 0;
+            uint8_t b = *_p++;
+            if ((b & 0xC0) == 0xC0) {
+                _role = 0;
+                _left = (((b & 0x3F) << 8) | (_p < _end ? *_p++ : 0)) + 1;
+            } else {
+                _role = b >> 6;
+                _left = (b & 0x3F) + 1;
+            }
+        }
+        _left--;
+        return _role;
+    }
+
+private:
+    const uint8_t *_p;
+    const uint8_t *_end;
+    uint8_t _role;
+    uint16_t _left;
+};
+
+} // namespace
+
+ChromeLayer::ChromeLayer()
+    : _width(0),
+      _height(0),
+      _rows(nullptr),
+      _rowIndex(nullptr),
+      _rowCount(0),
+      _background(0) {
+}
+
+ChromeLayer::~ChromeLayer() {
+    placedFree(_rows);
+    placedFree(_rowIndex);
+}
+
+bool ChromeLayer::begin(uint16_t width, uint16_t height) {
+    if (_rows) return true;
+    if (width != CHROME_WIDTH || height != CHROME_HEIGHT) {
+        LOG_W(TAG_CHROME, "底图尺寸%ux%u与屏幕不符，不使用", CHROME_WIDTH, CHROME_HEIGHT);
+        return false;
+    }
+
+    _rowIndex = (int16_t *)placedAlloc("chrome_index", height * sizeof(int16_t), PLACE_INTERNAL);
+    if (!_rowIndex) return false;
+
+    ChromeDecoder decoder;
+    _rowCount = 0;
+    for (uint16_t y = 0; y < height; y++) {
+        bool chrome = false;
+        for (uint16_t x = 0; x < width; x++) {
+            chrome |= decoder.next() != 0;
+        }
+        _rowIndex[y] = chrome ? _rowCount++ : -1;
+    }
+    if (_rowCount == 0) {
+        placedFree(_rowIndex);
+        _rowIndex = nullptr;
+        return false;
+    }
+
+    // 几行底图放内部RAM，复制比PSRAM快；放不下再用PSRAM
+    size_t bytes = (size_t)_rowCount * width * 2;
+    _rows = (uint16_t *)placedAlloc("chrome", bytes, PLACE_INTERNAL);
+    if (!_rows) _rows = (uint16_t *)placedAlloc("chrome", bytes, PLACE_PSRAM);
+    if (!_rows) {
+        placedFree(_rowIndex);
+        _rowIndex = nullptr;
+        return false;
+    }
+    _width = width;
+    _height = height;
+    LOG_I(TAG_CHROME, "界面底图: %u行, %u字节", _rowCount, (unsigned)bytes);
+    return true;
+}
+
+void ChromeLayer::setPalette(const uint16_t *palette) {
+    if (!_rows) return;
+    _background = palette[0];
+
+    ChromeDecoder decoder;
+    for (uint16_t y = 0; y < _height; y++) {
+        if (_rowIndex[y] < 0) {
+            for (uint16_t x = 0; x < _width; x++) decoder.next();
+            continue;
+        }
+        uint16_t *row = _rows + (size_t)_rowIndex[y] * _width;
+        for (uint16_t x = 0; x < _width; x++) {
+            row[x] = palette[decoder.next()];
+        }
+    }
+}
+
+void ChromeLayer::restore(Arduino_GFX *gfx, uint16_t *framebuffer, int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > (int16_t)_width) w = _width - x;
+    if (y + h > (int16_t)_height) h = _height - y;
+    if (w <= 0 || h <= 0) return;
+
+    // 没有底图的连续行一次填充，有底图的行逐行复制
+    int16_t bottom = y + h;
+    for (int16_t row = y; row < bottom; ) {
+        bool chrome = _rowIndex[row] >= 0;
+        int16_t end = row + 1;
+        while (end < bottom && (_rowIndex[end] >= 0) == chrome) end++;
+        if (!chrome) {
+            gfx->fillRect(x, row, w, end - row, _background);
+        } else {
+            for (int16_t r = row; r < end; r++) {
+                uint16_t *src = _rows + (size_t)_rowIndex[r] * _width + x;
+                if (framebuffer) {
+                    pixelCopy(framebuffer + (size_t)r * _width + x, src, w);
+                } else {
+                    gfx->draw16bitRGBBitmap(x, r, src, w, 1);
+                }
+            }
+        }
+        row = end;
+    }
+}
@@ -0,0 +1,62 @@
+/**
+ * @file ChromeLayer.h
+ * @brief 固定不变的界面底图
+ * @details 分隔线等固定元素由tools/chrome_bake.py在构建时烘焙进闪存（ChromeData.h，按颜色角色行程编码），
+ * 清除区域时把底图复制回去，而不是先填背景色再逐个重画图元：
+ * - begin()解码一遍，只为有底图的行保存展开后的RGB565（一行960字节），其余行仍按背景色填充
+ * - 底图保存颜色角色，setPalette()按当前主题重新展开
+ * - restore()把矩形内有底图的行从展开的行复制到Canvas帧缓冲（没有帧缓冲时逐行画位图），
+ *   没有底图的行直接填充背景色
+ * - 文本和状态图标按格带背景绘制，会盖住同位置的底图；底图元素应放在行间和边距中
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CHROME_LAYER_H
+#define CHROME_LAYER_H
+
+#include <Arduino_GFX_Library.h>
+
+class ChromeLayer {
+public:
+    ChromeLayer();
+    ~ChromeLayer();
+
+    /**
+     * @brief 解码底图，分配有底图的行
+     * @return 底图与屏幕尺寸一致、不是空白且分配成功时返回true；否则调用方照常填充背景色
+     */
+    bool begin(uint16_t width, uint16_t height);
+
+    /**
+     * @brief 底图是否可用
+     */
+    bool isActive() const { return _rows != nullptr; }
+
+    /**
+     * @brief 按主题调色板展开底图（ThemeColor索引）
+     */
+    void setPalette(const uint16_t *palette);
+
+    /**
+     * @brief 把矩形恢复为底图
+     * @param gfx 绘制目标
+     * @param framebuffer 目标的16位帧缓冲（宽度与底图相同、未旋转），nullptr时经gfx逐行画位图
+     */
+    void restore(Arduino_GFX *gfx, uint16_t *framebuffer, int16_t x, int16_t y, int16_t w, int16_t h);
+
+    /**
+     * @brief 有底图的行数
+     */
+    uint16_t getChromeRows() const { return _rowCount; }
+
+private:
+    uint16_t _width;
+    uint16_t _height;
+    uint16_t *_rows;            ///< 有底图的各行展开后的RGB565，按行号顺序连续存放
+    int16_t *_rowIndex;         ///< 每行在_rows中的序号，-1表示没有底图
+    uint16_t _rowCount;
+    uint16_t _background;       ///< 没有底图的行填充的背景色
+};
+
+#endif // CHROME_LAYER_H
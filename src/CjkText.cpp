@@ -0,0 +1,72 @@
+/**
+ * @file CjkText.cpp
+ * @brief 屏幕文字中的非ASCII字符实现
+ *
+ * @author Calculator Project
+ */
+
+#include "CjkText.h"
+#include "CjkSubsetData.h"   // 构建时由tools/cjk_subset.py生成到构建目录
+
+static const uint8_t GLYPH_PX = 16;            // 子集字形边长
+
+uint16_t CjkText::textUnits(const char *text) {
+    uint16_t units = 0;
+    while (*text) {
+        units += decode(text) < 0x80 ? ASCII_UNITS : WIDE_UNITS;
+    }
+    return units;
+}
+
+const uint8_t *CjkText::find(uint32_t cp) {
+    uint32_t slot = (cp * CJK_HASH_SEED) >> (32 - CJK_HASH_BITS);
+    if (CJK_SLOT_CODE[slot] != cp || cp == 0) return nullptr;
+    return CJK_GLYPHS + (size_t)CJK_SLOT_GLYPH[slot] * GLYPH_PX * 2;
+}
+
+uint8_t CjkText::glyphCount() {
+    return CJK_GLYPH_COUNT;
+}
+
+void CjkText::draw(Arduino_GFX *gfx, int16_t x, int16_t y, const char *text,
+                   uint8_t size, uint16_t fg, uint16_t bg) {
+    gfx->setTextColor(fg, bg);
+    gfx->setTextSize(size);
+    while (*text) {
+        uint32_t cp = decode(text);
+        if (cp < 0x80) {
+            gfx->drawChar(x, y, (unsigned char)cp, fg, bg);
+            x += ASCII_UNITS * size;
+        } else {
+            drawWide(gfx, x, y, find(cp), size, fg, bg);
+            x += WIDE_UNITS * size;
+        }
+    }
+}
+
+void CjkText::drawWide(Arduino_GFX *gfx, int16_t x, int16_t y, const uint8_t *glyph,
+                       uint8_t size, uint16_t fg, uint16_t bg) {
+    const int16_t cell = WIDE_UNITS * size;
+    gfx->writeFillRect(x, y, cell, cell, bg);
+    if (!glyph) {
+        // 子集中没有的字符：空心方框
+        gfx->drawRect(x + size, y + size, cell - 2 * size, cell - 2 * size, fg);
+        return;
+    }
+
+    // 16x16缩放到cell见方（最近邻），每个输出行按连续的点合并为水平线段
+    for (int16_t oy = 0; oy < cell; oy++) {
+        const uint8_t *row = glyph + (oy * GLYPH_PX / cell) * 2;
+        uint16_t bits = ((uint16_t)row[0] << 8) | row[1];
+        int16_t runStart = -1;
+        for (int16_t ox = 0; ox <= cell; ox++) {
+            bool on = ox < cell && (bits & (0x8000 >> (ox * GLYPH_PX / cell)));
+            if (on && runStart < 0) {
+                runStart = ox;
+            } else if (!on && runStart >= 0) {
+                gfx->writeFastHLine(x + runStart, y + oy, ox - runStart, fg);
+                runStart = -1;
+            }
+        }
+    }
+}
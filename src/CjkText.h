@@ -0,0 +1,82 @@
+/**
+ * @file CjkText.h
+ * @brief 屏幕文字中的非ASCII字符（中文错误/状态信息）
+ * @details 内置6x8字体只有ASCII，中文用构建时生成的16x16字形子集（tools/cjk_subset.py）：
+ * - 子集只包含UI_TEXT()标记的字符串里出现的字符，放在flash中
+ * - 码点到字形用完美哈希查找：一次乘法、一次移位、一次比较
+ * - 排版单位与内置字体一致：ASCII宽6、非ASCII宽8（字号1时），高都是8，
+ *   16x16字形按字号缩放到8*textSize见方，与同一行的ASCII底部对齐
+ * - 绘制时每行按连续的点合并为水平线段，比内置字体逐像素fillRect更省
+ * - 子集中没有的字符画成空心方框
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CJK_TEXT_H
+#define CJK_TEXT_H
+
+#include <Arduino_GFX_Library.h>
+
+class CjkText {
+public:
+    static const uint8_t ASCII_UNITS = 6;      ///< 字号1时ASCII字符宽度
+    static const uint8_t WIDE_UNITS = 8;       ///< 字号1时非ASCII字符宽度
+
+    /**
+     * @brief 解码一个UTF-8字符并前移指针
+     * @return 码点；非法序列返回0xFFFD并只跳过一个字节
+     */
+    static uint32_t decode(const char *&p) {
+        uint8_t c = (uint8_t)*p++;
+        if (c < 0x80) return c;
+        uint8_t extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+        if (extra == 0 || c >= 0xF8) return 0xFFFD;
+        uint32_t cp = c & (0x3F >> extra);
+        for (uint8_t i = 0; i < extra; i++) {
+            uint8_t next = (uint8_t)p[i];
+            if ((next & 0xC0) != 0x80) return 0xFFFD;
+            cp = (cp << 6) | (next & 0x3F);
+        }
+        p += extra;
+        return cp;
+    }
+
+    /**
+     * @brief 文本是否全部为ASCII（可以走字形缓存和逐字形局部重绘）
+     */
+    static bool isAscii(const char *text) {
+        for (; *text; text++) {
+            if ((uint8_t)*text >= 0x80) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 字号1时的文本宽度（像素），乘以字号即实际宽度
+     */
+    static uint16_t textUnits(const char *text);
+
+    /**
+     * @brief 查找子集中的字形
+     * @return 32字节16x16点阵（每行2字节，最高位在左），不在子集中返回nullptr
+     */
+    static const uint8_t *find(uint32_t cp);
+
+    /**
+     * @brief 绘制混合ASCII和非ASCII的文本（调用方负责startWrite/endWrite）
+     * @param size 字号，与setTextSize()相同
+     */
+    static void draw(Arduino_GFX *gfx, int16_t x, int16_t y, const char *text,
+                     uint8_t size, uint16_t fg, uint16_t bg);
+
+    /**
+     * @brief 子集中的字形数
+     */
+    static uint8_t glyphCount();
+
+private:
+    static void drawWide(Arduino_GFX *gfx, int16_t x, int16_t y, const uint8_t *glyph,
+                         uint8_t size, uint16_t fg, uint16_t bg);
+};
+
+#endif // CJK_TEXT_H
@@ -0,0 +1,131 @@
+/**
+ * @file CoRunner.cpp
+ * @brief 主循环中的无栈协程实现
+ *
+ * @author Calculator Project
+ */
+
+#include "CoRunner.h"
+#include "Console.h"
+#include "Logger.h"
+
+#define TAG_CO "CORUN"
+
+namespace {
+
+void cmdJobs(const ConsoleArgs& args) {
+    if (args.is(1, "stop")) {
+        uint8_t stopped = CoRunner::instance().stop(args.count > 2 ? args.arg(2) : nullptr);
+        Serial.printf("已停止 %u 个协程\n", stopped);
+    } else {
+        CoRunner::instance().printStatus();
+    }
+}
+
+constexpr ConsoleCommand CO_COMMANDS[] = {
+    {"jobs", "[stop [名称]]", "显示或停止分步运行的诊断命令", cmdJobs},
+};
+static_assert(consoleSorted(CO_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+CoRunner::CoRunner()
+    : _timer(TimerWheel::INVALID),
+      _spawned(0),
+      _resumes(0) {
+    memset(_slots, 0, sizeof(_slots));
+}
+
+void CoRunner::begin() {
+    _timer = TimerWheel::instance().create("corunner", onTimer, this);
+    Console::instance().addCommands(CO_COMMANDS);
+}
+
+bool CoRunner::spawn(const char* name, CoBody body, int32_t arg) {
+    if (find(name) >= 0) {
+        LOG_W(TAG_CO, "%s 正在运行", name);
+        return false;
+    }
+    for (Slot& slot : _slots) {
+        if (slot.body) continue;
+        slot.body = body;
+        slot.name = name;
+        slot.task = CoTask();
+        slot.task.arg = arg;
+        _spawned++;
+        resume(slot);
+        schedule();
+        return true;
+    }
+    LOG_W(TAG_CO, "协程池已满，%s 未启动", name);
+    return false;
+}
+
+uint8_t CoRunner::stop(const char* name) {
+    uint8_t stopped = 0;
+    for (Slot& slot : _slots) {
+        if (!slot.body || (name && strcmp(slot.name, name) != 0)) continue;
+        slot.task.cancelled = true;
+        resume(slot);
+        slot.body = nullptr;        // 函数自己返回了等待（没有用CO_SLEEP）时也不再恢复
+        stopped++;
+    }
+    schedule();
+    return stopped;
+}
+
+void CoRunner::onTimer(void* context) {
+    CoRunner* self = static_cast<CoRunner*>(context);
+    uint32_t now = millis();
+    for (Slot& slot : self->_slots) {
+        if (slot.body && (int32_t)(now - slot.resumeAt) >= 0) {
+            self->resume(slot);
+        }
+    }
+    self->schedule();
+}
+
+int8_t CoRunner::find(const char* name) const {
+    for (uint8_t i = 0; i < CO_RUNNER_CAPACITY; i++) {
+        if (_slots[i].body && strcmp(_slots[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+void CoRunner::resume(Slot& slot) {
+    _resumes++;
+    uint32_t delayMs = slot.body(slot.task);
+    if (delayMs == DONE) {
+        slot.body = nullptr;
+    } else {
+        slot.resumeAt = millis() + delayMs;
+    }
+}
+
+void CoRunner::schedule() {
+    uint32_t now = millis();
+    bool any = false;
+    uint32_t earliest = 0;
+    for (const Slot& slot : _slots) {
+        if (!slot.body) continue;
+        uint32_t wait = (int32_t)(slot.resumeAt - now) > 0 ? slot.resumeAt - now : 0;
+        if (!any || wait < earliest) earliest = wait;
+        any = true;
+    }
+    if (any) {
+        TimerWheel::instance().start(_timer, earliest);
+    } else {
+        TimerWheel::instance().cancel(_timer);
+    }
+}
+
+void CoRunner::printStatus() const {
+    Serial.printf("--- 协程 (启动 %lu 次，恢复 %lu 次) ---\n", (unsigned long)_spawned, (unsigned long)_resumes);
+    bool any = false;
+    for (const Slot& slot : _slots) {
+        if (!slot.body) continue;
+        Serial.printf("  %-14s %ld ms后恢复\n", slot.name, (long)(int32_t)(slot.resumeAt - millis()));
+        any = true;
+    }
+    if (!any) Serial.println("  没有正在运行的协程");
+}
@@ -0,0 +1,109 @@
+/**
+ * @file CoRunner.h
+ * @brief 主循环中的无栈协程：长时间的诊断命令分步执行，步骤之间把主循环让给扫描、HID和渲染
+ * @details 诊断命令（led_test、test_feedback、hid_test）原先在命令处理中用delay()等待，
+ * 期间主循环停住：按键事件积压、HID报告和屏幕推送都要等命令结束。改为协程后：
+ * - 协程是一个函数加一个CoTask状态，CO_SLEEP()记下恢复点并返回等待的毫秒数，
+ *   到期后从恢复点继续执行（switch/case实现，不需要独立的栈）
+ * - 所有协程共用一个时间轮定时器，到期时恢复所有到期的协程，再按最早的恢复时刻重新启动定时器
+ * - 局部变量在让出后不保留，跨让出的状态放在CoTask的arg和i中
+ * - 同名的协程只能运行一个；stop时不再等待，剩余步骤立即执行完（恢复LED、松开按键），
+ *   循环可以检查cancelled提前结束
+ *
+ * 限制：CO_SLEEP()不能放在另一个switch中，同一行不能有两个CO_SLEEP()。
+ * 只能在主循环中使用（协程也在主循环中执行）。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CO_RUNNER_H
+#define CO_RUNNER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "TimerWheel.h"
+
+/**
+ * @brief 协程的状态
+ */
+struct CoTask {
+    uint16_t line;              ///< 恢复点（CO_SLEEP所在的行），0表示从头开始
+    bool cancelled;             ///< 已被stop，之后的CO_SLEEP()不再等待
+    int32_t arg;                ///< spawn()传入的参数
+    int32_t i;                  ///< 跨让出保留的循环变量
+};
+
+/**
+ * @brief 协程函数
+ * @return 到下次恢复的毫秒数，CoRunner::DONE表示结束（由CO_END返回）
+ */
+typedef uint32_t (*CoBody)(CoTask& task);
+
+#define CO_BEGIN(task) switch ((task).line) { case 0:
+
+// 让出delayMs毫秒；已被stop时直接继续
+#define CO_SLEEP(task, delayMs) \
+    do { \
+        if ((task).cancelled) break; \
+        (task).line = __LINE__; \
+        return (delayMs); \
+        case __LINE__:; \
+    } while (0)
+
+#define CO_END(task) } (task).line = 0; return CoRunner::DONE
+
+class CoRunner {
+public:
+    static const uint32_t DONE = UINT32_MAX;
+
+    static CoRunner& instance() {
+        static CoRunner instance;
+        return instance;
+    }
+
+    /**
+     * @brief 创建定时器，注册串口命令（须在TimerWheel::begin()之后）
+     */
+    void begin();
+
+    /**
+     * @brief 启动协程：第一步在这里立即执行，之后由定时器恢复
+     * @param name 名称（jobs命令显示和停止用），需在整个运行期间有效
+     * @return 同名的协程正在运行或池已满（CO_RUNNER_CAPACITY）时返回false
+     */
+    bool spawn(const char* name, CoBody body, int32_t arg = 0);
+
+    /**
+     * @brief 停止协程：剩余步骤立即执行完
+     * @param name nullptr表示全部
+     * @return 停止的个数
+     */
+    uint8_t stop(const char* name);
+
+    bool isRunning(const char* name) const { return find(name) >= 0; }
+
+    void printStatus() const;
+
+private:
+    struct Slot {
+        CoBody body;            ///< nullptr表示空闲
+        const char* name;
+        uint32_t resumeAt;      ///< 恢复时刻（millis）
+        CoTask task;
+    };
+
+    CoRunner();
+
+    static void onTimer(void* context);
+
+    int8_t find(const char* name) const;
+    void resume(Slot& slot);
+    void schedule();            ///< 按最早的恢复时刻启动定时器
+
+    Slot _slots[CO_RUNNER_CAPACITY];
+    TimerWheel::TimerId _timer;
+    uint32_t _spawned;          ///< 启动的次数（累计）
+    uint32_t _resumes;          ///< 恢复的次数（累计）
+};
+
+#endif // CO_RUNNER_H
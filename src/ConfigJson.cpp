@@ -0,0 +1,567 @@
+/**
+ * @file ConfigJson.cpp
+ * @brief 整机配置的JSON导入/导出实现
+ *
+ * @author Calculator Project
+ */
+
+#include "ConfigJson.h"
+#include "BufferPlacement.h"
+#include "BusinessMath.h"
+#include "Console.h"
+#include "DisplayTheme.h"
+#include "calc_display.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+namespace {
+
+// PersistentConfig的一个字段：JSON中的名称与成员名相同
+struct SettingField {
+    const char* name;
+    uint32_t field;             ///< ConfigField位（机群配置的增量按位传输）
+    uint8_t offset;
+    uint8_t size;               ///< 1、2或4字节
+    bool isBool;
+    uint32_t minValue;
+    uint32_t maxValue;
+};
+
+#define SETTING_BOOL(field, bit) {#field, bit, offsetof(PersistentConfig, field), 1, true, 0, 1}
+#define SETTING_INT(field, bit, lo, hi) \
+    {#field, bit, offsetof(PersistentConfig, field), sizeof(PersistentConfig::field), false, lo, hi}
+
+constexpr SettingField SETTINGS[] = {
+    SETTING_BOOL(autoSave, CONFIG_AUTO_SAVE),
+    SETTING_BOOL(backlightAuto, CONFIG_BACKLIGHT_AUTO),
+    SETTING_INT(backlightBrightness, CONFIG_BACKLIGHT_BRIGHTNESS, 0, 100),
+    SETTING_BOOL(buzzerDualTone, CONFIG_BUZZER_DUAL),
+    SETTING_INT(buzzerDuration, CONFIG_BUZZER_DURATION, 0, 65535),
+    SETTING_BOOL(buzzerEnabled, CONFIG_BUZZER_ENABLED),
+    SETTING_BOOL(buzzerFollowKeypress, CONFIG_BUZZER_FOLLOW),
+    SETTING_INT(buzzerMode, CONFIG_BUZZER_MODE, 0, 1),
+    SETTING_INT(buzzerPressFreq, CONFIG_BUZZER_PRESS_FREQ, 20, 20000),
+    SETTING_INT(buzzerReleaseFreq, CONFIG_BUZZER_RELEASE_FREQ, 20, 20000),
+    SETTING_INT(buzzerVolume, CONFIG_BUZZER_VOLUME, 0, 100),
+    SETTING_INT(discountRate, CONFIG_DISCOUNT_RATE, 0, BusinessMath::RATE_SCALE),
+    SETTING_INT(globalBrightness, CONFIG_LED_BRIGHTNESS, 0, 255),
+    SETTING_INT(ledFadeDuration, CONFIG_LED_FADE, 0, 65535),
+    SETTING_BOOL(logEnabled, CONFIG_LOG_ENABLED),
+    SETTING_INT(logLevel, CONFIG_LOG_LEVEL, LOG_LEVEL_NONE, LOG_LEVEL_VERBOSE),
+    SETTING_INT(longPressDelay, CONFIG_LONG_PRESS_DELAY, 0, 65535),
+    SETTING_INT(markupRate, CONFIG_MARKUP_RATE, 0, BusinessMath::MAX_RATE),
+    SETTING_INT(repeatDelay, CONFIG_REPEAT_DELAY, 0, 65535),
+    SETTING_INT(repeatRate, CONFIG_REPEAT_RATE, 0, 65535),
+    SETTING_INT(sleepTimeout, CONFIG_SLEEP_TIMEOUT, 0, UINT32_MAX),
+    SETTING_INT(taxRate, CONFIG_TAX_RATE, 0, BusinessMath::MAX_RATE),
+};
+
+#undef SETTING_BOOL
+#undef SETTING_INT
+
+template <size_t N>
+constexpr bool settingsSorted(const SettingField (&table)[N], size_t i = 1) {
+    return i >= N || (consoleCompare(table[i - 1].name, table[i].name) < 0 && settingsSorted(table, i + 1));
+}
+static_assert(settingsSorted(SETTINGS), "配置字段表必须按名称排序");
+
+template <size_t N>
+constexpr uint32_t settingsFields(const SettingField (&table)[N], size_t i = 0) {
+    return i >= N ? 0 : table[i].field | settingsFields(table, i + 1);
+}
+static_assert(settingsFields(SETTINGS) == CONFIG_ALL_FIELDS, "配置字段表必须覆盖全部ConfigField");
+
+const SettingField* findSetting(const char* name) {
+    size_t low = 0;
+    size_t high = sizeof(SETTINGS) / sizeof(SETTINGS[0]);
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int c = strcmp(SETTINGS[mid].name, name);
+        if (c == 0) return &SETTINGS[mid];
+        if (c < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return nullptr;
+}
+
+const SettingField* findSettingField(uint32_t bit) {
+    for (const SettingField& field : SETTINGS) {
+        if (field.field == bit) return &field;
+    }
+    return nullptr;
+}
+
+uint32_t readSetting(const PersistentConfig& config, const SettingField& field) {
+    const uint8_t* p = (const uint8_t*)&config + field.offset;
+    switch (field.size) {
+        case 1:  return *p;
+        case 2:  return *(const uint16_t*)p;
+        default: return *(const uint32_t*)p;
+    }
+}
+
+void writeSetting(PersistentConfig& config, const SettingField& field, uint32_t value) {
+    uint8_t* p = (uint8_t*)&config + field.offset;
+    switch (field.size) {
+        case 1:  *p = (uint8_t)value; break;
+        case 2:  *(uint16_t*)p = (uint16_t)value; break;
+        default: *(uint32_t*)p = value; break;
+    }
+}
+
+// 写入固定大小的文本缓冲，超出时只记下溢出
+class TextWriter {
+public:
+    TextWriter(char* buffer, size_t size) : _buffer(buffer), _size(size), _length(0), _overflow(false) {
+        _buffer[0] = '\0';
+    }
+
+    void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (_overflow) return;
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(_buffer + _length, _size - _length, format, args);
+        va_end(args);
+        if (n < 0 || (size_t)n >= _size - _length) {
+            _overflow = true;
+            return;
+        }
+        _length += n;
+    }
+
+    // JSON字符串：引号、反斜杠和控制字符转义，UTF-8原样输出
+    void string(const char* text) {
+        printf("\"");
+        for (const char* p = text; *p; p++) {
+            char c = *p;
+            if (c == '"' || c == '\\') {
+                printf("\\%c", c);
+            } else if ((uint8_t)c < 0x20) {
+                printf("\\u%04x", (uint8_t)c);
+            } else {
+                printf("%c", c);
+            }
+        }
+        printf("\"");
+    }
+
+    // 数值：最短能原样读回的写法
+    void number(double value) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.15g", value);
+        if (strtod(text, nullptr) != value) snprintf(text, sizeof(text), "%.17g", value);
+        printf("%s", text);
+    }
+
+    size_t length() const { return _length; }
+    bool overflow() const { return _overflow; }
+
+private:
+    char* _buffer;
+    size_t _size;
+    size_t _length;
+    bool _overflow;
+};
+
+bool isCurrencyCode(const char* code) {
+    for (uint8_t i = 0; i < 3; i++) {
+        if (code[i] < 'A' || code[i] > 'Z') return false;
+    }
+    return code[3] == '\0';
+}
+
+// 串口命令
+void cmdConfigExport(const ConsoleArgs& args) {
+    size_t length = 0;
+    const char* text = ConfigJson::instance().exportText(length);
+    if (!text) {
+        Serial.printf("❌ 导出失败（超过 %u 字节或内存不足）\n", (unsigned)CONFIG_JSON_MAX);
+        return;
+    }
+    Serial.write((const uint8_t*)text, length);
+    Serial.println();
+}
+
+bool consoleSink(const char* data, size_t length, void* context) {
+    JsonReader::Status status = ConfigJson::instance().feed(data, length);
+    if (status == JsonReader::STATUS_MORE) return true;
+    if (status == JsonReader::STATUS_DONE) {
+        Serial.println("✅ 配置已导入");
+    } else {
+        Serial.printf("❌ 配置导入失败（第 %u 字节），未做任何修改\n",
+                      (unsigned)ConfigJson::instance().errorOffset());
+    }
+    return false;
+}
+
+void cmdConfigImport(const ConsoleArgs& args) {
+    ConfigJson::instance().beginImport();
+    Console::instance().setSink(consoleSink, nullptr);
+    Serial.println("请粘贴JSON配置，读完整份文档后一次应用");
+}
+
+constexpr ConsoleCommand CONFIG_JSON_COMMANDS[] = {
+    {"config_export", "", "以JSON导出全部配置（设置、主题、布局、宏、汇率）", cmdConfigExport},
+    {"config_import", "", "粘贴JSON导入配置，完整读完且有效才应用", cmdConfigImport},
+};
+static_assert(consoleSorted(CONFIG_JSON_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+ConfigJson::ConfigJson()
+    : _display(nullptr),
+      _text(nullptr),
+      _importing(false),
+      _keyCount(0),
+      _keyOpen(false),
+      _stringsUsed(0) {
+}
+
+void ConfigJson::begin(CalcDisplay* display) {
+    _display = display;
+    Console::instance().addCommands(CONFIG_JSON_COMMANDS);
+}
+
+const char* ConfigJson::exportText(size_t& length) {
+    if (!_text) {
+        _text = (char*)placedAlloc("config_json", CONFIG_JSON_MAX, PLACE_PSRAM);
+        if (!_text) return nullptr;
+    }
+    TextWriter out(_text, CONFIG_JSON_MAX);
+
+    const PersistentConfig& settings = ConfigManager::getInstance().getConfig();
+    out.printf("{\n\"settings\":{");
+    for (size_t i = 0; i < sizeof(SETTINGS) / sizeof(SETTINGS[0]); i++) {
+        const SettingField& field = SETTINGS[i];
+        uint32_t value = readSetting(settings, field);
+        if (field.isBool) {
+            out.printf("%s\"%s\":%s", i ? "," : "", field.name, value ? "true" : "false");
+        } else {
+            out.printf("%s\"%s\":%lu", i ? "," : "", field.name, (unsigned long)value);
+        }
+    }
+    out.printf("},\n");
+
+    if (_display) {
+        out.printf("\"theme\":");
+        out.string(DISPLAY_THEMES[_display->getTheme()].name);
+        out.printf(",\n");
+    }
+    out.printf("\"profile\":%u,\n", keyboardConfig.getProfileIndex());
+
+    const KeyboardLayoutConfig& layout = keyboardConfig.getLayoutConfig();
+    out.printf("\"layout\":{\"defaultLayer\":%d,\"tabKey\":%u,\"keys\":[",
+               (int)layout.defaultLayer, layout.tabKeyPosition);
+    KeyboardConfigManager::KeyOverride keys[KeyboardConfigManager::MAX_KEY_OVERRIDES];
+    uint8_t count = keyboardConfig.getKeyOverrides(keys, KeyboardConfigManager::MAX_KEY_OVERRIDES);
+    for (uint8_t i = 0; i < count; i++) {
+        const KeyConfig& key = keys[i].config;
+        out.printf("%s\n {\"layer\":%u,\"position\":%u,\"type\":%d,\"operation\":%d,\"symbol\":",
+                   i ? "," : "", keys[i].layer, key.position, (int)key.type, (int)key.operation);
+        if (key.symbol) {
+            out.string(key.symbol);
+        } else {
+            out.printf("null");
+        }
+        out.printf(",\"label\":");
+        if (key.label) {
+            out.string(key.label);
+        } else {
+            out.printf("null");
+        }
+        // 宏是MACRO类型按键的functionName，单独命名便于阅读
+        out.printf(",\"%s\":", key.type == KeyType::MACRO ? "macro" : "function");
+        out.string(key.functionName ? key.functionName : "");
+        out.printf(",\"keyCode\":%u,\"holdMs\":%u,\"autoRepeat\":%s",
+                   key.keyCode, key.holdMs, key.autoRepeat ? "true" : "false");
+        if (keys[i].color != KeyboardConfigManager::NO_COLOR) {
+            out.printf(",\"color\":%lu", (unsigned long)keys[i].color);
+        }
+        out.printf("}");
+    }
+    out.printf("]},\n");
+
+    const CurrencyTableData& currency = UnitConverter::instance().getTable();
+    out.printf("\"currency\":{");
+    for (uint8_t i = 0; i < currency.count; i++) {
+        out.printf("%s\"%s\":", i ? "," : "", currency.rates[i].code);
+        out.number(currency.rates[i].perBase);
+    }
+    out.printf("}\n}");
+
+    if (out.overflow()) return nullptr;
+    length = out.length();
+    return _text;
+}
+
+void ConfigJson::beginImport() {
+    _reader.begin(onEvent, this);
+    _importing = true;
+    _hasSettings = false;
+    _hasLayout = false;
+    _hasCurrency = false;
+    _theme = -1;
+    _profile = -1;
+    _settings = ConfigManager::getInstance().getConfig();
+    _keyCount = 0;
+    _keyOpen = false;
+    _stringsUsed = 0;
+    _currency = CurrencyTableData();
+}
+
+JsonReader::Status ConfigJson::feed(const char* data, size_t length) {
+    if (!_importing) return JsonReader::STATUS_ERROR;
+    JsonReader::Status status = _reader.feed(data, length);
+    if (status == JsonReader::STATUS_MORE) return status;
+
+    _importing = false;
+    if (status == JsonReader::STATUS_ERROR) {
+        LOG_W(TAG_CONFIG, "JSON配置在第 %u 字节处无效", (unsigned)_reader.offset());
+        return status;
+    }
+    return apply() ? JsonReader::STATUS_DONE : JsonReader::STATUS_ERROR;
+}
+
+bool ConfigJson::onEvent(JsonReader::Event event, const JsonReader& reader, void* context) {
+    ConfigJson& self = *(ConfigJson*)context;
+    uint8_t depth = reader.depth();
+    if (depth == 0) {
+        // 顶层必须是对象
+        return event == JsonReader::EVENT_OBJECT || event == JsonReader::EVENT_END;
+    }
+
+    const char* section = reader.name(1);
+    bool isObject = event == JsonReader::EVENT_OBJECT;
+    bool isValue = event == JsonReader::EVENT_VALUE;
+
+    if (strcmp(section, "settings") == 0) {
+        if (depth == 1) {
+            self._hasSettings = true;
+            return !isValue && event != JsonReader::EVENT_ARRAY;
+        }
+        return depth > 2 || !isValue || self.handleSetting(reader);
+    }
+    if (strcmp(section, "layout") == 0) {
+        if (depth == 1) {
+            if (isObject) {
+                // 文档中没有keys时保留现有的覆盖表
+                const KeyboardLayoutConfig& layout = keyboardConfig.getLayoutConfig();
+                self._hasLayout = true;
+                self._defaultLayer = layout.defaultLayer;
+                self._tabKey = layout.tabKeyPosition;
+                self._keyCount = keyboardConfig.getKeyOverrides(self._keys, KeyboardConfigManager::MAX_KEY_OVERRIDES);
+            }
+            return !isValue && event != JsonReader::EVENT_ARRAY;
+        }
+        return self.handleLayout(event, reader);
+    }
+    if (strcmp(section, "currency") == 0) {
+        if (depth == 1) {
+            self._hasCurrency = true;
+            return !isValue && event != JsonReader::EVENT_ARRAY;
+        }
+        return depth > 2 || !isValue || self.handleCurrency(reader);
+    }
+    if (depth > 1) return true;
+
+    if (strcmp(section, "theme") == 0) {
+        if (!isValue || reader.type() != JsonReader::TYPE_STRING) return false;
+        if (!self._display) return true;
+        self._theme = findDisplayTheme(reader.text());
+        return self._theme >= 0;
+    }
+    if (strcmp(section, "profile") == 0) {
+        int64_t index;
+        if (!isValue || !reader.toInt(0, KeyboardConfigManager::getProfileCount() - 1, index)) return false;
+        self._profile = (int8_t)index;
+        return true;
+    }
+    // 不认识的部分忽略
+    return true;
+}
+
+uint32_t ConfigJson::settingField(const char* name) {
+    const SettingField* field = findSetting(name);
+    return field ? field->field : 0;
+}
+
+bool ConfigJson::getSetting(const PersistentConfig& config, uint32_t field, uint32_t& value) {
+    const SettingField* setting = findSettingField(field);
+    if (!setting) return false;
+    value = readSetting(config, *setting);
+    return true;
+}
+
+bool ConfigJson::setSetting(PersistentConfig& config, uint32_t field, uint32_t value) {
+    const SettingField* setting = findSettingField(field);
+    if (!setting || value < setting->minValue || value > setting->maxValue) return false;
+    writeSetting(config, *setting, value);
+    return true;
+}
+
+bool ConfigJson::handleSetting(const JsonReader& reader) {
+    const SettingField* field = findSetting(reader.name());
+    if (!field) return true;
+    if (field->isBool && reader.type() != JsonReader::TYPE_BOOL && reader.type() != JsonReader::TYPE_NUMBER) {
+        return false;
+    }
+    int64_t value;
+    if (!reader.toInt(field->minValue, field->maxValue, value)) {
+        LOG_W(TAG_CONFIG, "配置项 %s 的值 %s 无效", field->name, reader.text());
+        return false;
+    }
+    writeSetting(_settings, *field, (uint32_t)value);
+    return true;
+}
+
+bool ConfigJson::handleLayout(JsonReader::Event event, const JsonReader& reader) {
+    uint8_t depth = reader.depth();
+    const char* name = reader.name(2);
+    int64_t value;
+
+    if (depth == 2) {
+        if (strcmp(name, "keys") == 0) {
+            if (event == JsonReader::EVENT_ARRAY) _keyCount = 0;
+            return event == JsonReader::EVENT_ARRAY || event == JsonReader::EVENT_END;
+        }
+        if (event != JsonReader::EVENT_VALUE) return true;
+        if (strcmp(name, "defaultLayer") == 0) {
+            if (!reader.toInt(0, KeyboardConfigManager::LAYER_COUNT - 1, value)) return false;
+            _defaultLayer = (KeyLayer)value;
+        } else if (strcmp(name, "tabKey") == 0) {
+            if (!reader.toInt(1, KeyboardConfigManager::KEY_COUNT, value)) return false;
+            _tabKey = (uint8_t)value;
+        }
+        return true;
+    }
+    if (strcmp(name, "keys") != 0) return true;
+
+    if (depth == 3) {
+        // keys数组中的一项必须是对象
+        if (event == JsonReader::EVENT_OBJECT) {
+            if (_keyCount >= KeyboardConfigManager::MAX_KEY_OVERRIDES) return false;
+            KeyboardConfigManager::KeyOverride& entry = _keys[_keyCount];
+            memset(&entry, 0, sizeof(entry));
+            entry.config.functionName = "";
+            entry.color = KeyboardConfigManager::NO_COLOR;
+            _keyOpen = true;
+            return true;
+        }
+        if (event == JsonReader::EVENT_END && _keyOpen) {
+            _keyOpen = false;
+            return _keys[_keyCount++].config.position != 0;
+        }
+        return false;
+    }
+    return depth > 4 || event != JsonReader::EVENT_VALUE || handleKey(reader);
+}
+
+bool ConfigJson::handleKey(const JsonReader& reader) {
+    KeyboardConfigManager::KeyOverride& entry = _keys[_keyCount];
+    KeyConfig& key = entry.config;
+    const char* name = reader.name();
+    int64_t value;
+
+    if (strcmp(name, "symbol") == 0 || strcmp(name, "label") == 0 ||
+        strcmp(name, "function") == 0 || strcmp(name, "macro") == 0) {
+        const char* text = nullptr;
+        if (reader.type() == JsonReader::TYPE_STRING) {
+            text = storeString(reader.text());
+            if (!text) return false;
+        } else if (reader.type() != JsonReader::TYPE_NULL) {
+            return false;
+        }
+        if (name[0] == 's') {
+            key.symbol = text;
+        } else if (name[0] == 'l') {
+            key.label = text;
+        } else {
+            key.functionName = text ? text : "";
+        }
+        return true;
+    }
+
+    if (strcmp(name, "layer") == 0) {
+        if (!reader.toInt(0, KeyboardConfigManager::LAYER_COUNT - 1, value)) return false;
+        entry.layer = (uint8_t)value;
+    } else if (strcmp(name, "position") == 0) {
+        if (!reader.toInt(1, KeyboardConfigManager::KEY_COUNT, value)) return false;
+        key.position = (uint8_t)value;
+    } else if (strcmp(name, "type") == 0) {
+        if (!reader.toInt(0, (int)KeyType::MAX_KEY_TYPES - 1, value)) return false;
+        key.type = (KeyType)value;
+    } else if (strcmp(name, "operation") == 0) {
+        if (!reader.toInt(0, 255, value)) return false;
+        key.operation = (Operator)value;
+    } else if (strcmp(name, "keyCode") == 0) {
+        if (!reader.toInt(0, 65535, value)) return false;
+        key.keyCode = (uint16_t)value;
+    } else if (strcmp(name, "holdMs") == 0) {
+        if (!reader.toInt(0, 65535, value)) return false;
+        key.holdMs = (uint16_t)value;
+    } else if (strcmp(name, "autoRepeat") == 0) {
+        if (!reader.toInt(0, 1, value)) return false;
+        key.autoRepeat = value != 0;
+    } else if (strcmp(name, "color") == 0) {
+        if (!reader.toInt(0, 0xFFFFFF, value)) return false;
+        entry.color = (uint32_t)value;
+    }
+    return true;
+}
+
+bool ConfigJson::handleCurrency(const JsonReader& reader) {
+    const char* code = reader.name();
+    double perBase;
+    if (!isCurrencyCode(code) || !reader.toDouble(perBase) || !isfinite(perBase) || perBase <= 0.0) {
+        LOG_W(TAG_CONFIG, "汇率 %s 无效", code);
+        return false;
+    }
+
+    // 按代码排序插入，重复的代码视为无效
+    uint8_t i = 0;
+    while (i < _currency.count && strcmp(_currency.rates[i].code, code) < 0) i++;
+    if (i < _currency.count && strcmp(_currency.rates[i].code, code) == 0) return false;
+    if (_currency.count == CURRENCY_MAX) return false;
+    memmove(&_currency.rates[i + 1], &_currency.rates[i], (_currency.count - i) * sizeof(CurrencyRate));
+    memset(&_currency.rates[i], 0, sizeof(CurrencyRate));
+    memcpy(_currency.rates[i].code, code, 3);
+    _currency.rates[i].perBase = perBase;
+    _currency.count++;
+    return true;
+}
+
+const char* ConfigJson::storeString(const char* text) {
+    size_t length = strlen(text) + 1;
+    if (_stringsUsed + length > sizeof(_strings)) return nullptr;
+    char* stored = _strings + _stringsUsed;
+    memcpy(stored, text, length);
+    _stringsUsed += length;
+    return stored;
+}
+
+bool ConfigJson::apply() {
+    // 布局的字符串最可能超出保存空间，先导入；各部分都已在读取时校验过取值
+    bool ok = true;
+    if (_hasLayout && !keyboardConfig.importOverrides(_keys, _keyCount, _defaultLayer, _tabKey)) {
+        LOG_W(TAG_CONFIG, "JSON中的按键布局无效");
+        return false;
+    }
+    if (_hasCurrency && !UnitConverter::instance().importTable((const uint8_t*)&_currency,
+                                                               CurrencyTableData::sizeFor(_currency.count))) {
+        LOG_W(TAG_CONFIG, "JSON中的汇率表无效");
+        ok = false;
+    }
+    if (_hasSettings && !ConfigManager::getInstance().importConfig(_settings)) {
+        ok = false;
+    }
+    if (_profile >= 0) keyboardConfig.selectProfile(_profile);
+    if (_theme >= 0 && _display) _display->setTheme(_theme);
+    LOG_I(TAG_CONFIG, "JSON配置导入%s: 设置%s 布局%s(%u键) 汇率%s(%u种)", ok ? "完成" : "部分失败",
+          _hasSettings ? "✓" : "-", _hasLayout ? "✓" : "-", _keyCount,
+          _hasCurrency ? "✓" : "-", _currency.count);
+    return ok;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file ConfigJson.h
+ * @brief 整机配置的JSON导入/导出
+ * @details 一份文档包含全部可配置项，批量部署时一次传输代替逐项的串口命令：
+ *
+ *     {
+ *       "settings": {"autoSave": true, "buzzerVolume": 50, ...},     PersistentConfig的全部字段
+ *       "theme": "dark",                                             显示主题（运行时，不保存）
+ *       "profile": 0,                                                布局方案（运行时，不保存）
+ *       "layout": {"defaultLayer": 0, "tabKey": 4,
+ *                  "keys": [{"layer": 0, "position": 5, "type": 11, "operation": 0,
+ *                            "symbol": "S", "label": "求和", "macro": "=SUM(", "keyCode": 0,
+ *                            "holdMs": 0, "autoRepeat": false, "color": 16711680}, ...]},
+ *                                                                    按键覆盖表，宏是MACRO类型的按键，color可省略
+ *       "currency": {"EUR": 0.92, "USD": 1, ...}                     汇率表（整表替换）
+ *     }
+ *
+ * 导入用JsonReader逐字节读取，不建文档树：settings按一张排序的字段表（名称、偏移、宽度、范围）
+ * 直接写入PersistentConfig副本，按键写入覆盖表副本（字符串放在固定大小的字符串区），
+ * 汇率按排序位置插入CurrencyTableData副本。文档完整读完且全部取值有效后才一次性应用，
+ * 中途出错不改变任何配置；文档中没有的部分保持原样，不认识的键忽略。
+ * settings写入ConfigManager后由各模块的配置观察者只重新应用变化的字段。
+ *
+ * 导出按同一张字段表写到一块固定大小的文本缓冲（首次导出时分配）。
+ * 串口：config_export / config_import（之后粘贴文档）；主机通道：HOST_CONFIG_JSON。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CONFIG_JSON_H
+#define CONFIG_JSON_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "ConfigManager.h"
+#include "KeyboardConfig.h"
+#include "JsonReader.h"
+#include "UnitConverter.h"
+
+class CalcDisplay;
+
+class ConfigJson {
+public:
+    static ConfigJson& instance() {
+        static ConfigJson instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册串口命令
+     * @param display 主题的读写对象，nullptr时导出和导入都跳过主题
+     */
+    void begin(CalcDisplay* display);
+
+    /**
+     * @brief 导出当前配置
+     * @param length 输出：文本字节数（不含'\0'）
+     * @return 文本，属于本对象，到下一次导出前有效；缓冲分配失败或超出CONFIG_JSON_MAX时返回nullptr
+     */
+    const char* exportText(size_t& length);
+
+    /**
+     * @brief 开始导入一份新文档（放弃未完成的导入）
+     */
+    void beginImport();
+
+    /**
+     * @brief 送入一块文档数据；读完整份文档时校验并应用
+     * @return STATUS_MORE等待更多数据，STATUS_DONE已应用，STATUS_ERROR文档或取值无效（未做任何修改）
+     */
+    JsonReader::Status feed(const char* data, size_t length);
+
+    bool isImporting() const { return _importing; }
+
+    /**
+     * @brief 上次导入出错的位置（字节）
+     */
+    size_t errorOffset() const { return _reader.offset(); }
+
+    /**
+     * @brief 按名称（与JSON中的相同）查找配置项
+     * @return ConfigField位，不认识的名称返回0
+     */
+    static uint32_t settingField(const char* name);
+
+    /**
+     * @brief 按ConfigField位读写单个配置项（机群配置的二进制增量），写入时检查范围
+     * @return 不是单个已知的位、或取值超出范围时返回false（不修改）
+     */
+    static bool getSetting(const PersistentConfig& config, uint32_t field, uint32_t& value);
+    static bool setSetting(PersistentConfig& config, uint32_t field, uint32_t value);
+
+private:
+    ConfigJson();
+
+    static bool onEvent(JsonReader::Event event, const JsonReader& reader, void* context);
+    bool handleSetting(const JsonReader& reader);
+    bool handleLayout(JsonReader::Event event, const JsonReader& reader);
+    bool handleKey(const JsonReader& reader);
+    bool handleCurrency(const JsonReader& reader);
+    const char* storeString(const char* text);
+    bool apply();
+
+    CalcDisplay* _display;
+    char* _text;                    ///< 导出缓冲，CONFIG_JSON_MAX字节
+
+    // 正在导入的文档：各部分先写入副本，读完后一次应用
+    JsonReader _reader;
+    bool _importing;
+    bool _hasSettings;
+    bool _hasLayout;
+    bool _hasCurrency;
+    int8_t _theme;                  ///< -1表示文档中没有
+    int8_t _profile;
+    PersistentConfig _settings;
+    KeyboardConfigManager::KeyOverride _keys[KeyboardConfigManager::MAX_KEY_OVERRIDES];
+    uint8_t _keyCount;
+    bool _keyOpen;                  ///< 正在读keys数组中的一项
+    KeyLayer _defaultLayer;
+    uint8_t _tabKey;
+    char _strings[KeyboardConfigManager::LAYOUT_BLOB_SIZE];  ///< 按键字符串
+    size_t _stringsUsed;
+    CurrencyTableData _currency;
+};
+
+#endif // CONFIG_JSON_H
@@ -1,46 +1,352 @@
 #include "ConfigManager.h"
+#include "Console.h"
+#include <esp_rom_crc.h>
+#include <stddef.h>
+#include <string.h>
 
 // 单例实例
-ConfigManager* ConfigManager::_instance = nullptr;
-
 ConfigManager& ConfigManager::getInstance() {
-    if (_instance == nullptr) {
-        _instance = new ConfigManager();
+    // 静态存储，首次使用时构造，不分配堆内存
+    static ConfigManager instance;
+    return instance;
+}
+
+// 串口命令
+static void cmdAutoSave(const ConsoleArgs& args) {
+    if (args.is(1, "on")) {
+        ConfigManager::getInstance().setAutoSave(true);
+        Serial.println("✅ 自动保存已开启");
+    } else if (args.is(1, "off")) {
+        ConfigManager::getInstance().setAutoSave(false);
+        Serial.println("✅ 自动保存已关闭");
+    } else {
+        Serial.println("无效的 'auto_save' 命令格式. 使用: auto_save <on|off>");
+    }
+}
+
+static void cmdConfigInfo(const ConsoleArgs& args) {
+    ConfigManager& config = ConfigManager::getInstance();
+    Serial.println("配置系统信息:");
+    Serial.printf("配置结构体大小: %d 字节\n", config.getConfigSize());
+    Serial.printf("配置已初始化: %s\n", config.isInitialized() ? "是" : "否");
+    Serial.printf("配置有更改: %s\n", config.isDirty() ? "是" : "否");
+    Serial.printf("自动保存: %s\n", config.getAutoSave() ? "开启" : "关闭");
+}
+
+static void cmdLoadConfig(const ConsoleArgs& args) {
+    Serial.println("重新加载配置...");
+    if (ConfigManager::getInstance().load()) {
+        Serial.println("✅ 配置加载成功");
+    } else {
+        Serial.println("❌ 配置加载失败");
+    }
+}
+
+static void cmdResetConfig(const ConsoleArgs& args) {
+    Serial.println("重置配置为默认值...");
+    ConfigManager::getInstance().reset();
+    Serial.println("✅ 配置已重置为默认值");
+}
+
+static void cmdSaveConfig(const ConsoleArgs& args) {
+    Serial.println("手动保存配置...");
+    if (ConfigManager::getInstance().save()) {
+        Serial.println("✅ 配置保存成功");
+    } else {
+        Serial.println("❌ 配置保存失败");
     }
-    return *_instance;
 }
 
+static void cmdShowConfig(const ConsoleArgs& args) {
+    ConfigManager::getInstance().printConfig();
+}
+
+static constexpr ConsoleCommand CONFIG_COMMANDS[] = {
+    {"auto_save", "<on|off>", "开启/关闭自动保存", cmdAutoSave},
+    {"config_info", "", "显示配置系统信息", cmdConfigInfo},
+    {"load_config", "", "重新加载配置", cmdLoadConfig},
+    {"reset_config", "", "重置配置为默认值", cmdResetConfig},
+    {"save_config", "", "手动保存当前配置", cmdSaveConfig},
+    {"show_config", "", "显示当前配置", cmdShowConfig},
+};
+static_assert(consoleSorted(CONFIG_COMMANDS), "命令表必须按名称排序");
+
 bool ConfigManager::begin() {
     if (_initialized) {
         return true;
     }
     
     LOG_I(TAG_CONFIG, "初始化配置管理器...");
+    Console::instance().addCommands(CONFIG_COMMANDS);
+    // 连续调节（如亮度）期间不写，停下后才保存一次；连续的M+也只在空闲后写一次
+    TimerWheel& wheel = TimerWheel::instance();
+    _saveTimer = wheel.create("config", [](void *context) {
+        ConfigManager *self = static_cast<ConfigManager *>(context);
+        if (self->_dirty && self->_config.autoSave) self->save();
+    }, this);
+    _memoryTimer = wheel.create("memory", [](void *context) {
+        static_cast<ConfigManager *>(context)->flushMemoryRegisters();
+    }, this);
     
-    // 打开Preferences
-    if (!_preferences.begin(CONFIG_NAMESPACE, false)) {
-        LOG_E(TAG_CONFIG, "无法打开Preferences存储");
-        return false;
-    }
+    // 设置镜像已由SettingsStore::begin()映射，迁移旧版配置时load()需要保存
+    _initialized = true;
     
-    // 加载配置
+    // 加载配置；没有保存的配置时写入默认配置，下次启动不再查找NVS
     if (!load()) {
         LOG_W(TAG_CONFIG, "配置加载失败，使用默认配置");
         loadDefaults();
+        save();
     }
     
-    _initialized = true;
     LOG_I(TAG_CONFIG, "配置管理器初始化完成");
     return true;
 }
 
+// 版本3之前蜂鸣器音量是0-3档，换算为对应的0-100音量（与KeypadControl的BuzzerVolume一致）
+static uint8_t volumeFromLevel(uint8_t level) {
+    static const uint8_t LEVEL_VOLUME[] = {0, 40, 50, 70};
+    return level < sizeof(LEVEL_VOLUME) ? LEVEL_VOLUME[level] : LEVEL_VOLUME[2];
+}
+
+// 版本迁移：CONFIG_MIGRATIONS[v - 1]把版本v的配置升级为版本v + 1，加载时从blob的版本依次执行到当前版本。
+// 新增的字段放在末尾，较短的旧blob复制后这些字段保持默认值；只有含义改变的字段需要迁移函数处理。
+typedef void (*ConfigMigration)(PersistentConfig &config);
+
+static void migrateFromV1(PersistentConfig &config) {
+    // 版本1中backlightAuto所在字节是填充，内容不确定，按默认值迁移
+    config.backlightAuto = PersistentConfig().backlightAuto;
+}
+
+static void migrateFromV2(PersistentConfig &config) {
+    config.buzzerVolume = volumeFromLevel(config.buzzerVolume);
+}
+
+static void migrateFromV3(PersistentConfig &config) {
+    // 商务比率在末尾新增，已是默认值
+}
+
+static const ConfigMigration CONFIG_MIGRATIONS[] = {migrateFromV1, migrateFromV2, migrateFromV3};
+static_assert(sizeof(CONFIG_MIGRATIONS) / sizeof(CONFIG_MIGRATIONS[0]) == CONFIG_BLOB_VERSION - 1,
+              "每个旧版本都需要一个迁移函数");
+
+bool ConfigManager::addObserver(uint32_t fields, ConfigObserver observer, void *context) {
+    if (_observerCount >= MAX_OBSERVERS) {
+        LOG_W(TAG_CONFIG, "配置观察者已满");
+        return false;
+    }
+    _observers[_observerCount++] = {fields, observer, context};
+    return true;
+}
+
+void ConfigManager::notify(uint32_t changed) {
+    if (!changed) return;
+    for (uint8_t i = 0; i < _observerCount; i++) {
+        uint32_t fields = changed & _observers[i].fields;
+        if (fields) _observers[i].callback(fields, _config, _observers[i].context);
+    }
+}
+
+// 各字段的位置，顺序与ConfigField的位一致
+#define CONFIG_FIELD_SPAN(name) {offsetof(PersistentConfig, name), sizeof(PersistentConfig::name)}
+static const struct {
+    uint8_t offset;
+    uint8_t size;
+} CONFIG_FIELD_SPANS[] = {
+    CONFIG_FIELD_SPAN(globalBrightness),
+    CONFIG_FIELD_SPAN(ledFadeDuration),
+    CONFIG_FIELD_SPAN(buzzerEnabled),
+    CONFIG_FIELD_SPAN(buzzerFollowKeypress),
+    CONFIG_FIELD_SPAN(buzzerDualTone),
+    CONFIG_FIELD_SPAN(buzzerMode),
+    CONFIG_FIELD_SPAN(buzzerVolume),
+    CONFIG_FIELD_SPAN(buzzerPressFreq),
+    CONFIG_FIELD_SPAN(buzzerReleaseFreq),
+    CONFIG_FIELD_SPAN(buzzerDuration),
+    CONFIG_FIELD_SPAN(repeatDelay),
+    CONFIG_FIELD_SPAN(repeatRate),
+    CONFIG_FIELD_SPAN(longPressDelay),
+    CONFIG_FIELD_SPAN(backlightBrightness),
+    CONFIG_FIELD_SPAN(backlightAuto),
+    CONFIG_FIELD_SPAN(sleepTimeout),
+    CONFIG_FIELD_SPAN(autoSave),
+    CONFIG_FIELD_SPAN(logEnabled),
+    CONFIG_FIELD_SPAN(logLevel),
+    CONFIG_FIELD_SPAN(taxRate),
+    CONFIG_FIELD_SPAN(markupRate),
+    CONFIG_FIELD_SPAN(discountRate),
+};
+#undef CONFIG_FIELD_SPAN
+static_assert(sizeof(CONFIG_FIELD_SPANS) / sizeof(CONFIG_FIELD_SPANS[0]) == 22 &&
+              CONFIG_ALL_FIELDS == (1u << 22) - 1, "字段表必须与ConfigField一一对应");
+
+uint32_t ConfigManager::diffFields(const PersistentConfig &a, const PersistentConfig &b) {
+    uint32_t changed = 0;
+    for (size_t i = 0; i < sizeof(CONFIG_FIELD_SPANS) / sizeof(CONFIG_FIELD_SPANS[0]); i++) {
+        size_t offset = CONFIG_FIELD_SPANS[i].offset;
+        if (memcmp((const uint8_t *)&a + offset, (const uint8_t *)&b + offset, CONFIG_FIELD_SPANS[i].size) != 0) {
+            changed |= 1u << i;
+        }
+    }
+    return changed;
+}
+
 bool ConfigManager::load() {
+    PersistentConfig previous = _config;
+    bool ok = loadStored();
+    notify(diffFields(previous, _config));
+    return ok;
+}
+
+static const char *const CONFIG_SLOT_KEYS[2] = {KEY_CONFIG_SLOT_A, KEY_CONFIG_SLOT_B};
+
+bool ConfigManager::openLegacy() {
+    if (!_legacyOpen) {
+        _legacyOpen = _preferences.begin(CONFIG_NAMESPACE, false);
+        if (!_legacyOpen) LOG_E(TAG_CONFIG, "无法打开Preferences存储");
+    }
+    return _legacyOpen;
+}
+
+// 读取设置镜像中的一段。镜像中还没有这一段时（旧固件升级后第一次启动）从NVS读出，
+// 写入镜像（没有数据时写入空段）并删除旧键，之后不再读NVS。返回数据长度，没有数据时为0
+size_t ConfigManager::readSection(SettingsSection id, const char *legacyKey, void *out, size_t maxLength) {
+    SettingsStore& store = SettingsStore::instance();
+    size_t length = 0;
+    const void *data = store.find(id, length);
+    if (data) {
+        if (length > maxLength) return 0;
+        memcpy(out, data, length);
+        return length;
+    }
+    
+    length = 0;
+    if (openLegacy() && _preferences.isKey(legacyKey)) {
+        length = _preferences.getBytesLength(legacyKey);
+        if (length > maxLength || _preferences.getBytes(legacyKey, out, length) != length) length = 0;
+    }
+    if (store.write(id, out, length) && length) {
+        _preferences.remove(legacyKey);
+        LOG_I(TAG_CONFIG, "%s 已迁移到设置镜像", legacyKey);
+    }
+    return length;
+}
+
+size_t ConfigManager::readSlot(uint8_t slot, ConfigSlot &data) {
+    if (!_preferences.isKey(CONFIG_SLOT_KEYS[slot])) return 0;
+    // getBytes在存储的数据比缓冲大时返回0
+    size_t length = _preferences.getBytes(CONFIG_SLOT_KEYS[slot], &data, sizeof(data));
+    if (length < offsetof(ConfigSlot, blob)) return 0;
+    length -= offsetof(ConfigSlot, blob);
+    if (!checkBlob(data.blob, length)) {
+        LOG_W(TAG_CONFIG, "配置槽%c无效（版本或校验不符）", 'A' + slot);
+        return 0;
+    }
+    return length;
+}
+
+bool ConfigManager::loadStored() {
+    LOG_I(TAG_CONFIG, "正在加载配置...");
+    
+    // 设置镜像中的配置直接在映射区上校验，当前版本只复制一次
+    size_t length = 0;
+    const void *stored = SettingsStore::instance().find(SETTINGS_CONFIG, length);
+    if (stored) {
+        const ConfigBlob &blob = *static_cast<const ConfigBlob *>(stored);
+        if (!checkBlob(blob, length)) {
+            LOG_W(TAG_CONFIG, "配置数据无效（版本或校验不符）");
+            return false;
+        }
+        loadBlob(blob, length);
+        if (_dirty) save();         // 旧版本迁移后写回
+        return true;
+    }
+    
+    // 以下从NVS迁移，写入设置镜像后删除旧键
+    if (!openLegacy()) return false;
+    
+    // 两个槽各读一次，取序号较新的有效槽
+    ConfigSlot slots[2];
+    size_t lengths[2];
+    int newest = -1;
+    for (uint8_t i = 0; i < 2; i++) {
+        lengths[i] = readSlot(i, slots[i]);
+        if (lengths[i] && (newest < 0 || (int32_t)(slots[i].sequence - slots[newest].sequence) > 0)) {
+            newest = i;
+        }
+    }
+    if (newest >= 0) {
+        loadBlob(slots[newest].blob, lengths[newest]);
+        _committed = ConfigBlob();
+        markDirty();
+        if (save()) {
+            _preferences.remove(KEY_CONFIG_SLOT_A);
+            _preferences.remove(KEY_CONFIG_SLOT_B);
+        }
+        return true;
+    }
+    
+    if (_preferences.isKey(KEY_CONFIG_BLOB)) {
+        // 双槽之前的单个blob：加载（必要时迁移）后写入设置镜像，再删除旧键
+        ConfigBlob blob;
+        size_t length = _preferences.getBytes(KEY_CONFIG_BLOB, &blob, sizeof(blob));
+        if (!checkBlob(blob, length)) {
+            LOG_W(TAG_CONFIG, "配置数据无效（版本或校验不符）");
+            return false;
+        }
+        loadBlob(blob, length);
+        _committed = ConfigBlob();
+        markDirty();
+        if (save()) _preferences.remove(KEY_CONFIG_BLOB);
+        return true;
+    }
+    
+    // 旧版逐项存储的配置读出后改存为blob
+    if (loadLegacy()) {
+        markDirty();
+        if (save()) removeLegacyKeys();
+        return true;
+    }
+    LOG_I(TAG_CONFIG, "未找到保存的配置，使用默认配置");
+    return false;
+}
+
+bool ConfigManager::checkBlob(const ConfigBlob &blob, size_t length) {
+    // 旧版本的字段是当前结构的前缀，CRC紧跟在（可能较短的）config之后
+    if (length < offsetof(ConfigBlob, config) + sizeof(blob.crc) || length > sizeof(blob)) return false;
+    size_t crcOffset = length - sizeof(blob.crc);
+    uint32_t crc;
+    memcpy(&crc, (const uint8_t *)&blob + crcOffset, sizeof(crc));
+    return blob.version != 0 && blob.version <= CONFIG_BLOB_VERSION &&
+           blob.size == crcOffset - offsetof(ConfigBlob, config) &&
+           (blob.version < CONFIG_BLOB_VERSION || blob.size == sizeof(PersistentConfig)) &&
+           crc == esp_rom_crc32_le(0, (const uint8_t *)&blob, crcOffset);
+}
+
+void ConfigManager::loadBlob(const ConfigBlob &blob, size_t length) {
+    if (blob.version == CONFIG_BLOB_VERSION) {
+        memcpy(&_config, &blob.config, sizeof(_config));
+        _committed = blob;
+        _dirty = false;
+        LOG_I(TAG_CONFIG, "配置加载完成");
+        return;
+    }
+    
+    // 旧版本：依次迁移到当前版本，由调用方写回一次
+    _config = PersistentConfig();
+    memcpy(&_config, &blob.config, blob.size);
+    for (uint16_t version = blob.version; version < CONFIG_BLOB_VERSION; version++) {
+        CONFIG_MIGRATIONS[version - 1](_config);
+    }
+    markDirty();
+    LOG_I(TAG_CONFIG, "配置已从版本%d迁移", blob.version);
+}
+
+bool ConfigManager::loadLegacy() {
     if (!_preferences.isKey(KEY_LED_BRIGHTNESS)) {
-        LOG_I(TAG_CONFIG, "未找到保存的配置，使用默认配置");
         return false;
     }
     
-    LOG_I(TAG_CONFIG, "正在加载配置...");
+    LOG_I(TAG_CONFIG, "正在迁移旧版配置...");
     
     // 加载LED配置
     _config.globalBrightness = _preferences.getUChar(KEY_LED_BRIGHTNESS, 255);
@@ -51,7 +357,7 @@ bool ConfigManager::load() {
     _config.buzzerFollowKeypress = _preferences.getBool(KEY_BUZZER_FOLLOW, true);
     _config.buzzerDualTone = _preferences.getBool(KEY_BUZZER_DUAL, false);
     _config.buzzerMode = _preferences.getUChar(KEY_BUZZER_MODE, 0);
-    _config.buzzerVolume = _preferences.getUChar(KEY_BUZZER_VOL, 2);
+    _config.buzzerVolume = volumeFromLevel(_preferences.getUChar(KEY_BUZZER_VOL, 2));
     _config.buzzerPressFreq = _preferences.getUShort(KEY_BUZZER_PRESS_FREQ, 2000);
     _config.buzzerReleaseFreq = _preferences.getUShort(KEY_BUZZER_REL_FREQ, 1500);
     _config.buzzerDuration = _preferences.getUShort(KEY_BUZZER_DUR, 50);
@@ -71,69 +377,209 @@ bool ConfigManager::load() {
     _config.autoSave = _preferences.getBool(KEY_AUTO_SAVE, true);
     _config.logEnabled = _preferences.getBool(KEY_LOG_EN, true);
     _config.logLevel = _preferences.getUChar(KEY_LOG_LEVEL, 3);
-    
-    _dirty = false;
-    LOG_I(TAG_CONFIG, "配置加载完成");
     return true;
 }
 
+void ConfigManager::removeLegacyKeys() {
+    static const char *const LEGACY_KEYS[] = {
+        KEY_LED_BRIGHTNESS, KEY_LED_FADE_DUR,
+        KEY_BUZZER_EN, KEY_BUZZER_FOLLOW, KEY_BUZZER_DUAL, KEY_BUZZER_MODE, KEY_BUZZER_VOL,
+        KEY_BUZZER_PRESS_FREQ, KEY_BUZZER_REL_FREQ, KEY_BUZZER_DUR,
+        KEY_REPEAT_DELAY, KEY_REPEAT_RATE, KEY_LONGPRESS_DELAY,
+        KEY_BACKLIGHT_BRIGHT, KEY_SLEEP_TIMEOUT,
+        KEY_AUTO_SAVE, KEY_LOG_EN, KEY_LOG_LEVEL,
+    };
+    for (const char *key : LEGACY_KEYS) {
+        _preferences.remove(key);
+    }
+    LOG_I(TAG_CONFIG, "旧版配置已迁移");
+}
+
+void ConfigManager::buildBlob(ConfigBlob &blob) const {
+    // 先清零，保证填充字节确定，才能与已写入的内容逐字节比较
+    memset((void *)&blob, 0, sizeof(blob));
+    blob.version = CONFIG_BLOB_VERSION;
+    blob.size = sizeof(PersistentConfig);
+    memcpy(&blob.config, &_config, sizeof(_config));
+    blob.crc = esp_rom_crc32_le(0, (const uint8_t *)&blob, offsetof(ConfigBlob, crc));
+}
+
+bool ConfigManager::isValidBlob(const ConfigBlob &blob, uint16_t version) {
+    return blob.version == version && blob.size == sizeof(PersistentConfig) &&
+           blob.crc == esp_rom_crc32_le(0, (const uint8_t *)&blob, offsetof(ConfigBlob, crc));
+}
+
+bool ConfigManager::importBlob(const ConfigBlob &blob) {
+    if (!isValidBlob(blob)) {
+        LOG_W(TAG_CONFIG, "导入的配置无效（版本或校验不符）");
+        return false;
+    }
+    return importConfig(blob.config);
+}
+
+bool ConfigManager::importConfig(const PersistentConfig &config) {
+    PersistentConfig previous = _config;
+    _config = config;
+    markDirty();
+    bool saved = save();
+    notify(diffFields(previous, _config));
+    return saved;
+}
+
 bool ConfigManager::save() {
     if (!_initialized) {
         LOG_E(TAG_CONFIG, "配置管理器未初始化");
         return false;
     }
     
-    LOG_I(TAG_CONFIG, "正在保存配置...");
+    ConfigBlob blob;
+    buildBlob(blob);
     
-    // 保存LED配置
-    _preferences.putUChar(KEY_LED_BRIGHTNESS, _config.globalBrightness);
-    _preferences.putUShort(KEY_LED_FADE_DUR, _config.ledFadeDuration);
+    // 内容与上次写入的相同（例如改了又改回来）时不擦写闪存
+    if (memcmp(&blob, &_committed, sizeof(blob)) == 0) {
+        _dirty = false;
+        return true;
+    }
     
-    // 保存蜂鸣器配置
-    _preferences.putBool(KEY_BUZZER_EN, _config.buzzerEnabled);
-    _preferences.putBool(KEY_BUZZER_FOLLOW, _config.buzzerFollowKeypress);
-    _preferences.putBool(KEY_BUZZER_DUAL, _config.buzzerDualTone);
-    _preferences.putUChar(KEY_BUZZER_MODE, _config.buzzerMode);
-    _preferences.putUChar(KEY_BUZZER_VOL, _config.buzzerVolume);
-    _preferences.putUShort(KEY_BUZZER_PRESS_FREQ, _config.buzzerPressFreq);
-    _preferences.putUShort(KEY_BUZZER_REL_FREQ, _config.buzzerReleaseFreq);
-    _preferences.putUShort(KEY_BUZZER_DUR, _config.buzzerDuration);
+    // 整个设置镜像写到下一个扇区：掉电时加载回到上一个镜像中的配置
+    if (!SettingsStore::instance().write(SETTINGS_CONFIG, &blob, sizeof(blob))) {
+        LOG_E(TAG_CONFIG, "配置保存失败");
+        return false;
+    }
+    _committed = blob;
+    _dirty = false;
+    LOG_I(TAG_CONFIG, "配置保存完成");
+    return true;
+}
+
+bool ConfigManager::flush() {
+    bool ok = flushMemoryRegisters();
+    ok &= flushKeyStats();
+    if (_dirty && _config.autoSave) {
+        ok &= save();
+    }
+    return ok;
+}
+
+bool ConfigManager::loadMemoryRegisters(MemoryRegisterData &data) {
+    if (!_initialized) {
+        return false;
+    }
     
-    // 保存按键设置
-    _preferences.putUShort(KEY_REPEAT_DELAY, _config.repeatDelay);
-    _preferences.putUShort(KEY_REPEAT_RATE, _config.repeatRate);
-    _preferences.putUShort(KEY_LONGPRESS_DELAY, _config.longPressDelay);
+    MemoryRegisterData stored;
+    size_t length = readSection(SETTINGS_MEMORY, KEY_MEMORY_REGS, &stored, sizeof(stored));
+    if (!length) return false;
+    if (length != sizeof(stored) || stored.count > MEMORY_REGISTER_MAX) {
+        LOG_W(TAG_CONFIG, "内存寄存器数据无效，已忽略");
+        return false;
+    }
     
-    // 保存背光设置
-    _preferences.putUChar(KEY_BACKLIGHT_BRIGHT, _config.backlightBrightness);
+    _memory = stored;
+    data = stored;
+    return true;
+}
+
+void ConfigManager::setMemoryRegisters(const MemoryRegisterData &data) {
+    _memory = data;
+    _memoryDirty = true;
+    // 内存寄存器与自动保存开关无关
+    TimerWheel::instance().start(_memoryTimer, MEMORY_SAVE_IDLE_MS);
+}
+
+bool ConfigManager::flushMemoryRegisters() {
+    if (!_memoryDirty) return true;
+    if (!_initialized) {
+        LOG_E(TAG_CONFIG, "配置管理器未初始化");
+        return false;
+    }
     
-    // 保存休眠设置
-    _preferences.putULong(KEY_SLEEP_TIMEOUT, _config.sleepTimeout);
+    if (!SettingsStore::instance().write(SETTINGS_MEMORY, &_memory, sizeof(_memory))) {
+        LOG_E(TAG_CONFIG, "内存寄存器保存失败");
+        return false;
+    }
+    _memoryDirty = false;
+    LOG_I(TAG_CONFIG, "内存寄存器已保存");
+    return true;
+}
+
+bool ConfigManager::loadKeyStats(KeyStatsData &data) {
+    if (!_initialized) {
+        return false;
+    }
     
-    // 保存系统设置
-    _preferences.putBool(KEY_AUTO_SAVE, _config.autoSave);
-    _preferences.putBool(KEY_LOG_EN, _config.logEnabled);
-    _preferences.putUChar(KEY_LOG_LEVEL, _config.logLevel);
+    KeyStatsData stored;
+    size_t length = readSection(SETTINGS_KEY_STATS, KEY_KEY_STATS, &stored, sizeof(stored));
+    if (!length) return false;
+    if (length != sizeof(stored) || stored.version != KEY_STATS_VERSION || stored.count != KeyStatsData::KEY_COUNT) {
+        LOG_W(TAG_CONFIG, "按键统计数据无效，已忽略");
+        return false;
+    }
     
-    _dirty = false;
-    LOG_I(TAG_CONFIG, "配置保存完成");
+    _keyStats = stored;
+    data = stored;
     return true;
 }
 
-bool ConfigManager::saveIfDirty() {
-    if (_dirty && _config.autoSave) {
-        return save();
+void ConfigManager::setKeyStats(const KeyStatsData &data) {
+    if (memcmp(&_keyStats, &data, sizeof(data)) == 0) return;
+    _keyStats = data;
+    _keyStatsDirty = true;
+}
+
+bool ConfigManager::flushKeyStats() {
+    if (!_keyStatsDirty) return true;
+    if (!_initialized) {
+        LOG_E(TAG_CONFIG, "配置管理器未初始化");
+        return false;
     }
+    
+    if (!SettingsStore::instance().write(SETTINGS_KEY_STATS, &_keyStats, sizeof(_keyStats))) {
+        LOG_E(TAG_CONFIG, "按键统计保存失败");
+        return false;
+    }
+    _keyStatsDirty = false;
+    LOG_D(TAG_CONFIG, "按键统计已保存");
+    return true;
+}
+
+bool ConfigManager::loadCurrencyTable(CurrencyTableData &data) {
+    if (!_initialized) {
+        return false;
+    }
+    
+    size_t length = readSection(SETTINGS_CURRENCY, KEY_CURRENCY, &data, sizeof(data));
+    if (!length) return false;
+    if (length < CurrencyTableData::sizeFor(0) || length != CurrencyTableData::sizeFor(data.count)) {
+        LOG_W(TAG_CONFIG, "汇率表数据无效，已忽略");
+        return false;
+    }
+    return true;
+}
+
+bool ConfigManager::saveCurrencyTable(const CurrencyTableData &data) {
+    if (!_initialized) {
+        LOG_E(TAG_CONFIG, "配置管理器未初始化");
+        return false;
+    }
+    
+    size_t length = CurrencyTableData::sizeFor(data.count);
+    if (!SettingsStore::instance().write(SETTINGS_CURRENCY, &data, length)) {
+        LOG_E(TAG_CONFIG, "汇率表保存失败");
+        return false;
+    }
+    LOG_I(TAG_CONFIG, "汇率表已保存 (%u 字节)", (unsigned)length);
     return true;
 }
 
 void ConfigManager::reset() {
     LOG_I(TAG_CONFIG, "重置配置为默认值");
+    PersistentConfig previous = _config;
     loadDefaults();
     _dirty = true;
     if (_config.autoSave) {
         save();
     }
+    notify(diffFields(previous, _config));
 }
 
 void ConfigManager::loadDefaults() {
@@ -144,22 +590,28 @@ void ConfigManager::loadDefaults() {
 
 void ConfigManager::markDirty() {
     _dirty = true;
+    if (_config.autoSave) {
+        TimerWheel::instance().start(_saveTimer, CONFIG_SAVE_IDLE_MS);
+    }
+}
+
+void ConfigManager::markChanged(uint32_t fields) {
+    markDirty();
+    notify(fields);
 }
 
 // LED配置设置方法
 void ConfigManager::setLEDBrightness(uint8_t brightness) {
     if (_config.globalBrightness != brightness) {
         _config.globalBrightness = brightness;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_LED_BRIGHTNESS);
     }
 }
 
 void ConfigManager::setLEDFadeDuration(uint16_t duration) {
     if (_config.ledFadeDuration != duration) {
         _config.ledFadeDuration = duration;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_LED_FADE);
     }
 }
 
@@ -167,64 +619,57 @@ void ConfigManager::setLEDFadeDuration(uint16_t duration) {
 void ConfigManager::setBuzzerEnabled(bool enabled) {
     if (_config.buzzerEnabled != enabled) {
         _config.buzzerEnabled = enabled;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BUZZER_ENABLED);
     }
 }
 
 void ConfigManager::setBuzzerFollowKeypress(bool follow) {
     if (_config.buzzerFollowKeypress != follow) {
         _config.buzzerFollowKeypress = follow;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BUZZER_FOLLOW);
     }
 }
 
 void ConfigManager::setBuzzerDualTone(bool dual) {
     if (_config.buzzerDualTone != dual) {
         _config.buzzerDualTone = dual;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BUZZER_DUAL);
     }
 }
 
 void ConfigManager::setBuzzerMode(uint8_t mode) {
     if (_config.buzzerMode != mode) {
         _config.buzzerMode = mode;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BUZZER_MODE);
     }
 }
 
 void ConfigManager::setBuzzerVolume(uint8_t volume) {
+    if (volume > 100) volume = 100;
     if (_config.buzzerVolume != volume) {
         _config.buzzerVolume = volume;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BUZZER_VOLUME);
     }
 }
 
 void ConfigManager::setBuzzerPressFreq(uint16_t freq) {
     if (_config.buzzerPressFreq != freq) {
         _config.buzzerPressFreq = freq;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BUZZER_PRESS_FREQ);
     }
 }
 
 void ConfigManager::setBuzzerReleaseFreq(uint16_t freq) {
     if (_config.buzzerReleaseFreq != freq) {
         _config.buzzerReleaseFreq = freq;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BUZZER_RELEASE_FREQ);
     }
 }
 
 void ConfigManager::setBuzzerDuration(uint16_t duration) {
     if (_config.buzzerDuration != duration) {
         _config.buzzerDuration = duration;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BUZZER_DURATION);
     }
 }
 
@@ -232,24 +677,21 @@ void ConfigManager::setBuzzerDuration(uint16_t duration) {
 void ConfigManager::setRepeatDelay(uint16_t delay) {
     if (_config.repeatDelay != delay) {
         _config.repeatDelay = delay;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_REPEAT_DELAY);
     }
 }
 
 void ConfigManager::setRepeatRate(uint16_t rate) {
     if (_config.repeatRate != rate) {
         _config.repeatRate = rate;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_REPEAT_RATE);
     }
 }
 
 void ConfigManager::setLongPressDelay(uint16_t delay) {
     if (_config.longPressDelay != delay) {
         _config.longPressDelay = delay;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_LONG_PRESS_DELAY);
     }
 }
 
@@ -257,8 +699,14 @@ void ConfigManager::setLongPressDelay(uint16_t delay) {
 void ConfigManager::setBacklightBrightness(uint8_t brightness) {
     if (_config.backlightBrightness != brightness) {
         _config.backlightBrightness = brightness;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_BACKLIGHT_BRIGHTNESS);
+    }
+}
+
+void ConfigManager::setBacklightAuto(bool enabled) {
+    if (_config.backlightAuto != enabled) {
+        _config.backlightAuto = enabled;
+        markChanged(CONFIG_BACKLIGHT_AUTO);
     }
 }
 
@@ -266,8 +714,7 @@ void ConfigManager::setBacklightBrightness(uint8_t brightness) {
 void ConfigManager::setSleepTimeout(uint32_t timeout) {
     if (_config.sleepTimeout != timeout) {
         _config.sleepTimeout = timeout;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_SLEEP_TIMEOUT);
     }
 }
 
@@ -275,7 +722,7 @@ void ConfigManager::setSleepTimeout(uint32_t timeout) {
 void ConfigManager::setAutoSave(bool autoSave) {
     if (_config.autoSave != autoSave) {
         _config.autoSave = autoSave;
-        markDirty();
+        markChanged(CONFIG_AUTO_SAVE);
         // 注意：这里不能使用自动保存，因为可能正在关闭自动保存
         save();
     }
@@ -284,16 +731,36 @@ void ConfigManager::setAutoSave(bool autoSave) {
 void ConfigManager::setLogEnabled(bool enabled) {
     if (_config.logEnabled != enabled) {
         _config.logEnabled = enabled;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_LOG_ENABLED);
     }
 }
 
 void ConfigManager::setLogLevel(uint8_t level) {
     if (_config.logLevel != level) {
         _config.logLevel = level;
-        markDirty();
-        if (_config.autoSave) save();
+        markChanged(CONFIG_LOG_LEVEL);
+    }
+}
+
+// 商务功能比率
+void ConfigManager::setTaxRate(uint32_t rate) {
+    if (_config.taxRate != rate) {
+        _config.taxRate = rate;
+        markChanged(CONFIG_TAX_RATE);
+    }
+}
+
+void ConfigManager::setMarkupRate(uint32_t rate) {
+    if (_config.markupRate != rate) {
+        _config.markupRate = rate;
+        markChanged(CONFIG_MARKUP_RATE);
+    }
+}
+
+void ConfigManager::setDiscountRate(uint32_t rate) {
+    if (_config.discountRate != rate) {
+        _config.discountRate = rate;
+        markChanged(CONFIG_DISCOUNT_RATE);
     }
 }
 
@@ -305,7 +772,7 @@ void ConfigManager::printConfig() const {
     Serial.printf("蜂鸣器跟随按键: %s\n", _config.buzzerFollowKeypress ? "是" : "否");
     Serial.printf("蜂鸣器双音调: %s\n", _config.buzzerDualTone ? "是" : "否");
     Serial.printf("蜂鸣器模式: %s\n", _config.buzzerMode ? "钢琴" : "普通");
-    Serial.printf("蜂鸣器音量: %d\n", _config.buzzerVolume);
+    Serial.printf("蜂鸣器音量: %d/100\n", _config.buzzerVolume);
     Serial.printf("蜂鸣器按下频率: %d Hz\n", _config.buzzerPressFreq);
     Serial.printf("蜂鸣器释放频率: %d Hz\n", _config.buzzerReleaseFreq);
     Serial.printf("蜂鸣器持续时间: %d ms\n", _config.buzzerDuration);
@@ -313,10 +780,14 @@ void ConfigManager::printConfig() const {
     Serial.printf("按键重复速率: %d ms\n", _config.repeatRate);
     Serial.printf("长按延迟: %d ms\n", _config.longPressDelay);
     Serial.printf("背光亮度: %d\n", _config.backlightBrightness);
+    Serial.printf("自动亮度: %s\n", _config.backlightAuto ? "是" : "否");
     Serial.printf("休眠超时: %lu ms\n", _config.sleepTimeout);
     Serial.printf("自动保存: %s\n", _config.autoSave ? "是" : "否");
     Serial.printf("日志启用: %s\n", _config.logEnabled ? "是" : "否");
     Serial.printf("日志级别: %d\n", _config.logLevel);
+    Serial.printf("税率: %lu ppm\n", _config.taxRate);
+    Serial.printf("加价率: %lu ppm\n", _config.markupRate);
+    Serial.printf("折扣率: %lu ppm\n", _config.discountRate);
     Serial.printf("配置状态: %s\n", _dirty ? "已修改" : "未修改");
     Serial.println("===============");
 }
@@ -332,9 +803,17 @@ bool ConfigManager::clearAll() {
     }
     
     LOG_I(TAG_CONFIG, "清除所有配置");
-    bool result = _preferences.clear();
+    // 清空的段写为空段（不再从NVS迁移）；按键布局不在此列
+    SettingsStore& store = SettingsStore::instance();
+    bool result = store.write(SETTINGS_MEMORY, nullptr, 0) && store.write(SETTINGS_KEY_STATS, nullptr, 0) &&
+                  store.write(SETTINGS_CURRENCY, nullptr, 0);
     if (result) {
+        if (openLegacy()) _preferences.clear();
+        _committed = ConfigBlob();
         loadDefaults();
+        result = save();
+    }
+    if (result) {
         LOG_I(TAG_CONFIG, "配置已清除并重置为默认值");
     } else {
         LOG_E(TAG_CONFIG, "配置清除失败");
@@ -4,11 +4,24 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include "Logger.h"
+#include "TimerWheel.h"
+#include "KeyStats.h"
+#include "UnitConverter.h"
+#include "SettingsStore.h"
 
-// Preferences命名空间
+// Preferences命名空间（旧固件的数据，只用于迁移到设置镜像）
 #define CONFIG_NAMESPACE "pawcounter"
 
-// 存储键名定义
+// 存储键名定义（只用于迁移）
+#define KEY_CONFIG_SLOT_A "config_a"
+#define KEY_CONFIG_SLOT_B "config_b"
+#define KEY_CONFIG_BLOB "config"      // 双槽之前的单个blob（只用于迁移）
+#define CONFIG_BLOB_VERSION 4         // 2：新增backlightAuto（占用版本1的填充字节，布局不变）
+                                      // 3：buzzerVolume由0-3档改为0-100（布局不变）
+                                      // 4：末尾新增商务比率（旧版本按较短的blob读出，其余取默认值）
+                                      // 新增版本时在ConfigManager.cpp的CONFIG_MIGRATIONS末尾加一个迁移函数
+
+// 旧版逐项存储的键名（只用于迁移）
 #define KEY_LED_BRIGHTNESS "led_bright"
 #define KEY_LED_FADE_DUR "led_fade"
 #define KEY_BUZZER_EN "buzz_en"
@@ -27,6 +40,11 @@
 #define KEY_AUTO_SAVE "auto_save"
 #define KEY_LOG_EN "log_en"
 #define KEY_LOG_LEVEL "log_lvl"
+#define KEY_MEMORY_REGS "mem_regs"
+#define KEY_KEY_STATS "key_stats"
+#define KEY_CURRENCY "currency"
+
+#define MEMORY_REGISTER_MAX 8
 
 // 可持久化配置结构体
 struct PersistentConfig {
@@ -39,7 +57,7 @@ struct PersistentConfig {
     bool buzzerFollowKeypress = true;
     bool buzzerDualTone = false;
     uint8_t buzzerMode = 0;  // 0:普通, 1:钢琴
-    uint8_t buzzerVolume = 2;  // 0:静音, 1:低, 2:中, 3:高
+    uint8_t buzzerVolume = 50;  // 0-100，0为静音
     uint16_t buzzerPressFreq = 2000;
     uint16_t buzzerReleaseFreq = 1500;
     uint16_t buzzerDuration = 50;
@@ -51,6 +69,7 @@ struct PersistentConfig {
     
     // 背光设置
     uint8_t backlightBrightness = 100;
+    bool backlightAuto = false;     // 自动亮度：按环境光或时间表调整，backlightBrightness作为无输入时的亮度
     
     // 休眠设置
     uint32_t sleepTimeout = 10000;  // 毫秒
@@ -59,15 +78,103 @@ struct PersistentConfig {
     bool autoSave = true;
     bool logEnabled = true;
     uint8_t logLevel = 3;  // INFO级别
+    
+    // 商务功能比率，单位为百万分之一（130000 = 13%）
+    uint32_t taxRate = BUSINESS_DEFAULT_TAX_RATE;
+    uint32_t markupRate = 0;
+    uint32_t discountRate = 0;
+};
+
+// 配置的存储格式：整个PersistentConfig作为一个blob（设置镜像的SETTINGS_CONFIG段）
+struct ConfigBlob {
+    uint16_t version;           // CONFIG_BLOB_VERSION
+    uint16_t size;              // sizeof(PersistentConfig)
+    PersistentConfig config;
+    uint32_t crc;               // 前面所有字节的CRC32
+};
+
+// 之前NVS中的双槽存储（只用于迁移）：每次保存写入较旧的槽并把序号加一，加载时取序号最新且校验通过的槽。
+// 掉电保护现在由设置镜像轮流写扇区提供（SettingsStore）
+struct ConfigSlot {
+    uint32_t sequence;
+    ConfigBlob blob;
+};
+
+// 配置变化通知：每个字段一位，观察者只重新应用变化的字段
+enum ConfigField : uint32_t {
+    CONFIG_LED_BRIGHTNESS       = 1u << 0,
+    CONFIG_LED_FADE             = 1u << 1,
+    CONFIG_BUZZER_ENABLED       = 1u << 2,
+    CONFIG_BUZZER_FOLLOW        = 1u << 3,
+    CONFIG_BUZZER_DUAL          = 1u << 4,
+    CONFIG_BUZZER_MODE          = 1u << 5,
+    CONFIG_BUZZER_VOLUME        = 1u << 6,
+    CONFIG_BUZZER_PRESS_FREQ    = 1u << 7,
+    CONFIG_BUZZER_RELEASE_FREQ  = 1u << 8,
+    CONFIG_BUZZER_DURATION      = 1u << 9,
+    CONFIG_REPEAT_DELAY         = 1u << 10,
+    CONFIG_REPEAT_RATE          = 1u << 11,
+    CONFIG_LONG_PRESS_DELAY     = 1u << 12,
+    CONFIG_BACKLIGHT_BRIGHTNESS = 1u << 13,
+    CONFIG_BACKLIGHT_AUTO       = 1u << 14,
+    CONFIG_SLEEP_TIMEOUT        = 1u << 15,
+    CONFIG_AUTO_SAVE            = 1u << 16,
+    CONFIG_LOG_ENABLED          = 1u << 17,
+    CONFIG_LOG_LEVEL            = 1u << 18,
+    CONFIG_TAX_RATE             = 1u << 19,
+    CONFIG_MARKUP_RATE          = 1u << 20,
+    CONFIG_DISCOUNT_RATE        = 1u << 21,
+
+    CONFIG_BUZZER_FIELDS = CONFIG_BUZZER_ENABLED | CONFIG_BUZZER_FOLLOW | CONFIG_BUZZER_DUAL |
+                           CONFIG_BUZZER_MODE | CONFIG_BUZZER_VOLUME | CONFIG_BUZZER_PRESS_FREQ |
+                           CONFIG_BUZZER_RELEASE_FREQ | CONFIG_BUZZER_DURATION,
+    CONFIG_BACKLIGHT_FIELDS = CONFIG_BACKLIGHT_BRIGHTNESS | CONFIG_BACKLIGHT_AUTO,
+    CONFIG_ALL_FIELDS = (1u << 22) - 1
+};
+
+/**
+ * @brief 配置变化回调
+ * @param changed 变化的字段（ConfigField位），只含注册时关心的位
+ * @param config 变化后的配置
+ */
+typedef void (*ConfigObserver)(uint32_t changed, const PersistentConfig &config, void *context);
+
+// 内存寄存器（设置镜像中单独一段，不随配置一起写入）
+struct MemoryRegisterData {
+    uint8_t count = 0;          // 寄存器个数
+    uint8_t used = 0;           // 已存值的寄存器位图
+    uint8_t active = 0;         // 当前寄存器
+    double values[MEMORY_REGISTER_MAX] = {};
 };
 
 class ConfigManager {
 private:
-    static ConfigManager* _instance;
-    Preferences _preferences;
+    Preferences _preferences;       // 只在迁移旧数据时打开（openLegacy）
+    bool _legacyOpen = false;
     PersistentConfig _config;
     bool _initialized = false;
     bool _dirty = false;
+    TimerWheel::TimerId _saveTimer = TimerWheel::INVALID;      // 每次修改重新计时，空闲CONFIG_SAVE_IDLE_MS后自动保存
+    ConfigBlob _committed = {};     // 最后写入的内容，内容相同时不再写
+    
+    // 内存寄存器延迟写回：修改只更新内存副本，空闲一段时间后才写入
+    MemoryRegisterData _memory;
+    bool _memoryDirty = false;
+    TimerWheel::TimerId _memoryTimer = TimerWheel::INVALID;    // 空闲MEMORY_SAVE_IDLE_MS后写回
+    
+    // 按键统计：调用方已按KEY_STATS_SAVE_INTERVAL_MS限制频率，变化后由flushKeyStats()写入
+    KeyStatsData _keyStats;
+    bool _keyStatsDirty = false;
+    
+    // 变化通知
+    static const uint8_t MAX_OBSERVERS = 6;
+    struct Observer {
+        uint32_t fields;
+        ConfigObserver callback;
+        void *context;
+    };
+    Observer _observers[MAX_OBSERVERS] = {};
+    uint8_t _observerCount = 0;
     
     // 私有构造函数（单例模式）
     ConfigManager() = default;
@@ -75,6 +182,19 @@ private:
     // 内部方法
     void loadDefaults();
     void markDirty();
+    void markChanged(uint32_t fields);                      // 单个字段的设置方法：标记并通知
+    void notify(uint32_t changed);
+    static uint32_t diffFields(const PersistentConfig &a, const PersistentConfig &b);
+    bool loadStored();
+    bool openLegacy();              // 打开旧的NVS命名空间（迁移时才需要）
+    size_t readSection(SettingsSection id, const char *legacyKey, void *out, size_t maxLength);
+    bool loadLegacy();              // 读取旧版逐项存储的配置
+    size_t readSlot(uint8_t slot, ConfigSlot &data);        // 返回有效blob的长度，无效或不存在时为0
+    static bool checkBlob(const ConfigBlob &blob, size_t length);     // 任意已知版本（可能较短）
+    void loadBlob(const ConfigBlob &blob, size_t length);   // 旧版本按迁移函数升级并标记待写
+    void removeLegacyKeys();
+    void buildBlob(ConfigBlob &blob) const;
+    static bool isValidBlob(const ConfigBlob &blob, uint16_t version = CONFIG_BLOB_VERSION);
 
 public:
     // 获取单例实例
@@ -83,14 +203,29 @@ public:
     // 初始化配置管理器
     bool begin();
     
+    /**
+     * @brief 注册配置变化的观察者
+     * @details 设置方法改变字段、以及整体替换配置（load/reset/导入）后，按逐字段比较的结果
+     *          回调关心这些字段的观察者；没有变化的字段不会触发。回调中可以再调用设置方法
+     *          （值相同时不会再次通知）
+     * @param fields 关心的字段（ConfigField位）
+     * @return 观察者已满时返回false
+     */
+    bool addObserver(uint32_t fields, ConfigObserver observer, void *context = nullptr);
+    
     // 配置加载和保存
     bool load();
-    bool save();
-    bool saveIfDirty();
+    bool save();                    // 立即保存（内容未变时不写）
+    bool flush();                   // 立即写入所有未保存的修改（休眠前调用）
     
     // 配置重置
     void reset();
     
+    // 整体导出/导入（主机通道），导入的数据校验通过后立即保存
+    void exportBlob(ConfigBlob &blob) const { buildBlob(blob); }
+    bool importBlob(const ConfigBlob &blob);
+    bool importConfig(const PersistentConfig &config);     // 整体替换并立即保存（JSON导入）
+    
     // 获取配置值
     const PersistentConfig& getConfig() const { return _config; }
     
@@ -140,6 +275,9 @@ public:
     uint8_t getBacklightBrightness() const { return _config.backlightBrightness; }
     void setBacklightBrightness(uint8_t brightness);
     
+    bool getBacklightAuto() const { return _config.backlightAuto; }
+    void setBacklightAuto(bool enabled);
+    
     // 休眠设置
     uint32_t getSleepTimeout() const { return _config.sleepTimeout; }
     void setSleepTimeout(uint32_t timeout);
@@ -154,6 +292,28 @@ public:
     uint8_t getLogLevel() const { return _config.logLevel; }
     void setLogLevel(uint8_t level);
     
+    // 商务功能比率（百万分之一）
+    uint32_t getTaxRate() const { return _config.taxRate; }
+    void setTaxRate(uint32_t rate);
+    uint32_t getMarkupRate() const { return _config.markupRate; }
+    void setMarkupRate(uint32_t rate);
+    uint32_t getDiscountRate() const { return _config.discountRate; }
+    void setDiscountRate(uint32_t rate);
+    
+    // 内存寄存器
+    bool loadMemoryRegisters(MemoryRegisterData &data);
+    void setMemoryRegisters(const MemoryRegisterData &data);   // 只更新内存副本
+    bool flushMemoryRegisters();                               // 立即写入（休眠前调用）
+    
+    // 按键统计
+    bool loadKeyStats(KeyStatsData &data);
+    void setKeyStats(const KeyStatsData &data);                // 只更新内存副本，内容不变时不标记
+    bool flushKeyStats();
+    
+    // 汇率表（只保存用到的项，修改很少，立即写入）
+    bool loadCurrencyTable(CurrencyTableData &data);
+    bool saveCurrencyTable(const CurrencyTableData &data);
+    
     // 状态查询
     bool isInitialized() const { return _initialized; }
     bool isDirty() const { return _dirty; }
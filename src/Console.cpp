@@ -0,0 +1,170 @@
+/**
+ * @file Console.cpp
+ * @brief 串口文本命令实现
+ *
+ * @author Calculator Project
+ */
+
+#include "Console.h"
+#include <ctype.h>
+#include <stdlib.h>
+
+bool ConsoleArgs::toInt(uint8_t i, int& value) const {
+    if (i >= count) return false;
+    char* end = nullptr;
+    long parsed = strtol(argv[i], &end, 10);
+    if (end == argv[i] || *end != '\0') return false;
+    value = (int)parsed;
+    return true;
+}
+
+Console::Console()
+    : _tableCount(0),
+      _length(0),
+      _overflow(false),
+      _sink(nullptr),
+      _sinkContext(nullptr) {
+    _line[0] = '\0';
+}
+
+void Console::setSink(ConsoleSink sink, void* context) {
+    _sink = sink;
+    _sinkContext = context;
+    _length = 0;
+    _overflow = false;
+}
+
+bool Console::addCommands(const ConsoleCommand* table, uint8_t count) {
+    for (uint8_t i = 0; i < _tableCount; i++) {
+        if (_tables[i].commands == table) return true;
+    }
+    if (_tableCount >= MAX_TABLES) {
+        Serial.println("命令表已满");
+        return false;
+    }
+    _tables[_tableCount].commands = table;
+    _tables[_tableCount].count = count;
+    _tableCount++;
+    return true;
+}
+
+bool Console::poll(Stream& in) {
+    bool executed = false;
+
+    // 只取已经到达的字节，一行没收完就下次继续
+    while (in.available() > 0) {
+        if (_sink) {
+            // 原始数据：借用行缓冲成块转交
+            size_t length = 0;
+            while (length < LINE_SIZE && in.available() > 0) {
+                int c = in.read();
+                if (c < 0) break;
+                _line[length++] = (char)c;
+            }
+            if (!_sink(_line, length, _sinkContext)) _sink = nullptr;
+            continue;
+        }
+
+        int c = in.read();
+        if (c < 0) break;
+
+        if (c == '\r' || c == '\n') {
+            if (_overflow) {
+                Serial.printf("命令过长 (最多 %u 字符)\n", (unsigned)(LINE_SIZE - 1));
+            } else if (_length > 0) {
+                _line[_length] = '\0';
+                if (execute(_line)) executed = true;
+            }
+            _length = 0;
+            _overflow = false;
+            continue;
+        }
+
+        if (_overflow) continue;
+        if (_length >= LINE_SIZE - 1) {
+            _overflow = true;
+            continue;
+        }
+        _line[_length++] = (char)c;
+    }
+    return executed;
+}
+
+bool Console::execute(char* line) {
+    // 去掉首尾空白
+    while (*line && isspace((unsigned char)*line)) line++;
+    size_t length = strlen(line);
+    while (length > 0 && isspace((unsigned char)line[length - 1])) line[--length] = '\0';
+    if (length == 0) return false;
+
+    ConsoleArgs args;
+    args.count = 0;
+
+    // 命令名之后的原文
+    const char* tail = line;
+    while (*tail && !isspace((unsigned char)*tail)) tail++;
+    while (*tail && isspace((unsigned char)*tail)) tail++;
+    args.tail = tail;
+
+    // 在副本上分词，_line保持原样供tail使用
+    memcpy(_tokens, line, length + 1);
+    char* p = _tokens;
+    while (*p && args.count < ConsoleArgs::MAX_ARGS) {
+        while (*p && isspace((unsigned char)*p)) p++;
+        if (!*p) break;
+        args.argv[args.count++] = p;
+        while (*p && !isspace((unsigned char)*p)) p++;
+        if (*p) *p++ = '\0';
+    }
+
+    for (char* c = _tokens; *c; c++) *c = (char)tolower((unsigned char)*c);
+
+    if (strcmp(args.argv[0], "help") == 0) {
+        printHelp(Serial);
+        return true;
+    }
+
+    const ConsoleCommand* command = find(args.argv[0]);
+    if (!command) {
+        Serial.printf("未知命令: '%s'\n", line);
+        return false;
+    }
+    command->handler(args);
+    return true;
+}
+
+const ConsoleCommand* Console::find(const char* name) const {
+    for (uint8_t t = 0; t < _tableCount; t++) {
+        const ConsoleCommand* commands = _tables[t].commands;
+        int low = 0;
+        int high = (int)_tables[t].count - 1;
+        while (low <= high) {
+            int mid = (low + high) / 2;
+            int order = strcmp(name, commands[mid].name);
+            if (order == 0) return &commands[mid];
+            if (order < 0) {
+                high = mid - 1;
+            } else {
+                low = mid + 1;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void Console::printHelp(Print& out) const {
+    out.println("=== 可用命令 ===");
+    out.println("  help - 显示此帮助");
+    char name[48];
+    for (uint8_t t = 0; t < _tableCount; t++) {
+        for (uint8_t i = 0; i < _tables[t].count; i++) {
+            const ConsoleCommand& command = _tables[t].commands[i];
+            if (command.usage[0]) {
+                snprintf(name, sizeof(name), "%s %s", command.name, command.usage);
+            } else {
+                snprintf(name, sizeof(name), "%s", command.name);
+            }
+            out.printf("  %s - %s\n", name, command.help);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/**
+ * @file Console.h
+ * @brief 串口文本命令
+ * @details
+ * - poll()每次只读取已到达的字节，放入固定大小的行缓冲，收到换行才执行，不等待、不分配内存
+ * - 命令行在副本上按空白分词，处理函数拿到argv；需要原文（如带空格的宏）时用tail
+ * - 命令表由各模块用constexpr定义并在自己的初始化中注册，表内按命令名升序排列
+ *   （static_assert(consoleSorted(表))检查），查找时在每张表中二分
+ * - help按注册顺序列出全部命令
+ * - 需要接收大段原始数据的命令（如粘贴JSON配置）用setSink()接管输入，期间不解析命令
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief 分词后的命令行
+ */
+struct ConsoleArgs {
+    static const uint8_t MAX_ARGS = 8;
+
+    uint8_t count;                  ///< 参数个数，argv[0]为命令名
+    const char* argv[MAX_ARGS];
+    const char* tail;               ///< 命令名之后的原文（首尾空白已去掉）
+
+    const char* arg(uint8_t i) const { return i < count ? argv[i] : ""; }
+
+    /**
+     * @brief 第i个参数是否等于text（不区分大小写）
+     */
+    bool is(uint8_t i, const char* text) const { return i < count && strcasecmp(argv[i], text) == 0; }
+
+    /**
+     * @brief 把第i个参数解析为整数
+     * @return false 参数不存在或不是整数
+     */
+    bool toInt(uint8_t i, int& value) const;
+};
+
+typedef void (*ConsoleHandler)(const ConsoleArgs& args);
+
+/**
+ * @brief 原始数据接收函数
+ * @return false 数据已收完，之后的输入重新作为命令行解析
+ */
+typedef bool (*ConsoleSink)(const char* data, size_t length, void* context);
+
+/**
+ * @brief 命令表项
+ */
+struct ConsoleCommand {
+    const char* name;               ///< 命令名（小写）
+    const char* usage;              ///< 参数说明，没有参数时为""
+    const char* help;               ///< 一行说明
+    ConsoleHandler handler;
+};
+
+/**
+ * @brief 编译期字符串比较（同strcmp）
+ */
+constexpr int consoleCompare(const char* a, const char* b) {
+    return (*a != *b || *a == '\0') ? (int)(unsigned char)*a - (int)(unsigned char)*b
+                                    : consoleCompare(a + 1, b + 1);
+}
+
+/**
+ * @brief 命令表是否按名称严格升序（用于static_assert）
+ */
+template <size_t N>
+constexpr bool consoleSorted(const ConsoleCommand (&table)[N], size_t i = 1) {
+    return i >= N || (consoleCompare(table[i - 1].name, table[i].name) < 0 && consoleSorted(table, i + 1));
+}
+
+class Console {
+public:
+    static const size_t LINE_SIZE = 160;        ///< 一行命令的最大长度（含'\0'）
+    static const uint8_t MAX_TABLES = 20;       ///< 可注册的命令表数
+
+    static Console& instance() {
+        static Console instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册一张命令表（重复注册同一张表无效）
+     * @param table 按名称升序排列，必须是静态存储
+     * @return false 表数已满
+     */
+    bool addCommands(const ConsoleCommand* table, uint8_t count);
+
+    template <size_t N>
+    bool addCommands(const ConsoleCommand (&table)[N]) { return addCommands(table, (uint8_t)N); }
+
+    /**
+     * @brief 读取已到达的字符，收到完整一行时执行
+     * @param in 输入流（通常为Serial）
+     * @return 本次执行了命令返回true
+     */
+    bool poll(Stream& in);
+
+    /**
+     * @brief 执行一行命令
+     * @param line 命令行，会被修改
+     * @return 找到并执行了命令返回true
+     */
+    bool execute(char* line);
+
+    /**
+     * @brief 把之后收到的字节原样交给sink，直到sink返回false
+     */
+    void setSink(ConsoleSink sink, void* context);
+
+    /**
+     * @brief 输出全部命令的帮助
+     */
+    void printHelp(Print& out) const;
+
+private:
+    Console();
+
+    struct Table {
+        const ConsoleCommand* commands;
+        uint8_t count;
+    };
+
+    const ConsoleCommand* find(const char* name) const;
+
+    Table _tables[MAX_TABLES];
+    uint8_t _tableCount;
+
+    char _line[LINE_SIZE];          ///< 正在接收的行
+    size_t _length;
+    bool _overflow;                 ///< 当前行超长，丢弃到换行为止
+    ConsoleSink _sink;              ///< 非nullptr时输入不按命令解析
+    void* _sinkContext;
+    char _tokens[LINE_SIZE];        ///< 分词副本，argv指向这里
+};
+
+#endif // CONSOLE_H
@@ -0,0 +1,344 @@
+/**
+ * @file CpuProfiler.cpp
+ * @brief 各子系统的CPU占用统计实现
+ *
+ * @author Calculator Project
+ */
+
+#include "CpuProfiler.h"
+#include "BufferPlacement.h"
+#include "Console.h"
+#include <esp_timer.h>
+#include <rom/ets_sys.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#if CPU_PROFILER_HW_COUNTERS && __has_include(<xtensa_perfmon_access.h>)
+#define HW_COUNTERS_AVAILABLE 1
+#include <xtensa_perfmon_access.h>
+#include <xtensa_perfmon_masks.h>
+#include <xtensa/config/core-isa.h>
+#include <esp_ipc.h>
+static_assert(CpuProfiler::HW_COUNTERS <= XCHAL_NUM_PERF_COUNTERS, "核心的性能计数器不够");
+#else
+#define HW_COUNTERS_AVAILABLE 0
+#endif
+
+volatile int8_t CpuProfiler::_hwGroup = -1;
+volatile bool CpuProfiler::_tracing = false;
+
+namespace {
+
+const char* const SLOT_NAMES[PROFILE_SLOT_COUNT] = {
+    "timers", "led_effects", "ambient", "backlight", "sleep",
+    "calculator", "display_refresh", "led_show", "key_scan",
+    "key_dispatch", "display_flush", "settings_write",
+};
+
+struct HwEvent {
+    const char* name;
+    uint16_t select;
+    uint16_t mask;
+    bool cycles;                ///< 计数单位是周期，输出占探针周期的比例
+};
+
+struct HwGroup {
+    const char* name;
+    HwEvent events[CpuProfiler::HW_COUNTERS];
+};
+
+#if HW_COUNTERS_AVAILABLE
+const HwGroup HW_GROUPS[] = {
+    {"fetch", {{"取指停顿（周期）", XTPERF_CNT_I_STALL, XTPERF_MASK_I_STALL_ALL, true},
+               {"中断（次）", XTPERF_CNT_EXR, XTPERF_MASK_EXR_LEVEL1_INT | XTPERF_MASK_EXR_LEVELH_INT, false}}},
+    {"data", {{"数据停顿（周期）", XTPERF_CNT_D_STALL, XTPERF_MASK_D_STALL_ALL, true},
+              {"指令（条）", XTPERF_CNT_INSN, XTPERF_MASK_INSN_ALL, false}}},
+};
+const int8_t HW_GROUP_COUNT = sizeof(HW_GROUPS) / sizeof(HW_GROUPS[0]);
+#else
+const HwGroup* const HW_GROUPS = nullptr;
+const int8_t HW_GROUP_COUNT = 0;
+#endif
+
+inline uint32_t cyclesToNs(uint32_t cycles) {
+    // ets_get_cpu_frequency()返回当前频率（MHz），调频时由电源管理更新
+    return (uint32_t)((uint64_t)cycles * 1000 / ets_get_cpu_frequency());
+}
+
+const char* const EVENT_NAMES[PROFILE_EVENT_COUNT] = {
+    "scan_rate",
+};
+
+void cmdProfile(const ConsoleArgs& args) {
+    CpuProfiler& profiler = CpuProfiler::instance();
+    if (args.is(1, "reset")) {
+        profiler.reset();
+        Serial.println("CPU统计已清空");
+    } else if (args.is(1, "hw")) {
+        if (args.count < 3) {
+            Serial.printf("硬件计数器: %s\n", !HW_GROUP_COUNT ? "不可用" : CpuProfiler::hwActive() ? "开启" : "关闭");
+        } else if (!profiler.setHwGroup(args.is(2, "off") ? nullptr : args.arg(2))) {
+            Serial.println(HW_GROUP_COUNT ? "用法: profile hw <fetch|data|off>" : "硬件计数器不可用");
+        } else {
+            Serial.printf("硬件计数器: %s\n", args.arg(2));
+        }
+    } else if (args.is(1, "trace") && args.count >= 3) {
+        if (args.is(2, "on") || args.is(2, "off")) {
+            if (profiler.setTracing(args.is(2, "on"))) {
+                Serial.printf("区间记录: %s\n", CpuProfiler::tracing() ? "开启" : "关闭");
+            } else {
+                Serial.println("区间缓冲分配失败（需要PSRAM）");
+            }
+        } else if (args.is(2, "dump")) {
+            profiler.printTrace(Serial);
+        } else if (args.is(2, "clear")) {
+            profiler.clearTrace();
+            Serial.println("区间记录已清空");
+        } else {
+            Serial.println("用法: profile trace <on|off|dump|clear>");
+        }
+    } else if (args.count < 2) {
+        profiler.print(Serial);
+    } else {
+        Serial.println("用法: profile [reset | hw <fetch|data|off> | trace <on|off|dump|clear>]");
+    }
+}
+
+constexpr ConsoleCommand PROFILER_COMMANDS[] = {
+    {"profile", "[reset|hw 组|trace 操作]", "显示/清空各子系统和任务的CPU占用，hw选择硬件计数器，trace记录区间并输出Chrome trace JSON", cmdProfile},
+};
+static_assert(consoleSorted(PROFILER_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+CpuProfiler::CpuProfiler() : _spans(nullptr), _spanCount(0) {
+    static_assert(sizeof(Span) == 16, "区间记录应为16字节");
+    reset();
+}
+
+void CpuProfiler::begin() {
+    Console::instance().addCommands(PROFILER_COMMANDS);
+}
+
+void CpuProfiler::record(ProfileSlot slot, uint32_t cycles) {
+    uint32_t ns = cyclesToNs(cycles);
+    Slot& s = _slots[slot];
+    s.avgNs = s.calls ? s.avgNs - (s.avgNs >> 3) + (ns >> 3) : ns;
+    if (ns > s.maxNs) s.maxNs = ns;
+    s.totalNs += ns;
+    s.calls++;
+}
+
+void CpuProfiler::record(ProfileSlot slot, uint32_t cycles, const uint32_t* counts) {
+    record(slot, cycles);
+    uint32_t ns = cyclesToNs(cycles);
+    HwSlot& h = _hwSlots[slot];
+    bool slowest = ns >= h.slowestNs;
+    if (slowest) h.slowestNs = ns;
+    h.cycles += cycles;
+    for (uint8_t i = 0; i < HW_COUNTERS; i++) {
+        h.total[i] += counts[i];
+        if (counts[i] > h.max[i]) h.max[i] = counts[i];
+        if (slowest) h.atSlowest[i] = counts[i];
+    }
+    h.calls++;
+}
+
+void CpuProfiler::readCounters(uint32_t* counts) {
+#if HW_COUNTERS_AVAILABLE
+    for (uint8_t i = 0; i < HW_COUNTERS; i++) {
+        counts[i] = xtensa_perfmon_value(i);
+    }
+#else
+    memset(counts, 0, HW_COUNTERS * sizeof(uint32_t));
+#endif
+}
+
+void CpuProfiler::configureCore(void* arg) {
+#if HW_COUNTERS_AVAILABLE
+    int8_t group = *static_cast<const int8_t*>(arg);
+    xtensa_perfmon_stop();
+    if (group < 0) return;
+    for (uint8_t i = 0; i < HW_COUNTERS; i++) {
+        const HwEvent& e = HW_GROUPS[group].events[i];
+        // 不按中断级别过滤（KRNLCNT=0，TRACELEVEL=15）：中断处理中的事件也算在被打断的探针上
+        xtensa_perfmon_init(i, e.select, e.mask, 0, 15);
+        xtensa_perfmon_reset(i);
+    }
+    xtensa_perfmon_start();
+#endif
+}
+
+bool CpuProfiler::setHwGroup(const char* name) {
+    int8_t group = -1;
+    if (name) {
+        for (int8_t i = 0; i < HW_GROUP_COUNT && group < 0; i++) {
+            if (strcasecmp(name, HW_GROUPS[i].name) == 0) group = i;
+        }
+        if (group < 0) return false;
+    }
+    if (!HW_COUNTERS_AVAILABLE) return true;
+
+    // 计数器是每个核心各自的，探针所在的任务分布在两个核心上
+    _hwGroup = -1;
+    configureCore(&group);
+#if HW_COUNTERS_AVAILABLE && !CONFIG_FREERTOS_UNICORE
+    esp_ipc_call_blocking(!xPortGetCoreID(), configureCore, &group);
+#endif
+    memset(_hwSlots, 0, sizeof(_hwSlots));
+    _hwGroup = group;
+    return true;
+}
+
+void CpuProfiler::recordEvent(ProfileEvent event, uint32_t value) {
+    Event& e = _events[_eventCount % EVENT_LOG_SIZE];
+    e.timeMs = millis();
+    e.value = value;
+    e.event = event;
+    _eventCount++;
+}
+
+bool CpuProfiler::setTracing(bool enabled) {
+    if (enabled && !_spans) {
+        _spans = static_cast<Span*>(placedAlloc("trace", CPU_TRACE_SPANS * sizeof(Span), PLACE_PSRAM_ONLY));
+        if (!_spans) return false;
+        clearTrace();
+    }
+    _tracing = enabled;
+    return true;
+}
+
+void CpuProfiler::recordSpan(ProfileSlot slot, uint32_t cycles) {
+    uint32_t ns = cyclesToNs(cycles);
+    uint32_t endUs = (uint32_t)esp_timer_get_time();
+    // 两个核心各自占一个位置，不加锁
+    Span& s = _spans[_spanCount.fetch_add(1, std::memory_order_relaxed) % CPU_TRACE_SPANS];
+    s.startUs = endUs - ns / 1000;
+    s.durationNs = ns;
+    s.cycles = cycles;
+    s.slot = slot;
+    s.core = xPortGetCoreID();
+}
+
+void CpuProfiler::clearTrace() {
+    _spanCount.store(0);
+}
+
+void CpuProfiler::printTrace(Print& out) {
+    if (!_spans) {
+        out.println("没有区间记录（profile trace on）");
+        return;
+    }
+    // 暂停记录，等另一个核心上正在写的一条写完
+    bool wasTracing = _tracing;
+    _tracing = false;
+    delay(2);
+
+    uint32_t total = _spanCount.load();
+    uint32_t count = total < CPU_TRACE_SPANS ? total : CPU_TRACE_SPANS;
+    uint32_t first = total - count;
+    uint32_t origin = count ? _spans[first % CPU_TRACE_SPANS].startUs : 0;
+
+    // Chrome trace格式：每个探针一个完整事件（ph=X），核心作为线程，时间单位µs
+    out.println("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    out.print("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"PawCounter\"}}");
+    for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+        out.printf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"CPU%u\"}}",
+                   core, core);
+    }
+    for (uint32_t i = first; i < total; i++) {
+        const Span& s = _spans[i % CPU_TRACE_SPANS];
+        if (s.slot >= PROFILE_SLOT_COUNT) continue;
+        // 起点早于第一条的（较早开始、较晚结束）按负的相对时间输出
+        int32_t ts = (int32_t)(s.startUs - origin);
+        out.printf(",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%ld,\"dur\":%lu.%03lu,"
+                   "\"args\":{\"cycles\":%lu}}",
+                   SLOT_NAMES[s.slot], s.core, (long)ts, (unsigned long)(s.durationNs / 1000),
+                   (unsigned long)(s.durationNs % 1000), (unsigned long)s.cycles);
+    }
+    out.println("\n]}");
+    if (total > CPU_TRACE_SPANS) {
+        // JSON之后的提示行不影响复制JSON部分
+        out.printf("（共 %lu 条，只保留最近 %u 条）\n", (unsigned long)total, (unsigned)CPU_TRACE_SPANS);
+    }
+    _tracing = wasTracing;
+}
+
+void CpuProfiler::reset() {
+    memset(_slots, 0, sizeof(_slots));
+    memset(_hwSlots, 0, sizeof(_hwSlots));
+    memset(_events, 0, sizeof(_events));
+    _eventCount = 0;
+    _windowStart = esp_timer_get_time();
+}
+
+void CpuProfiler::print(Print& out) const {
+    uint64_t windowUs = esp_timer_get_time() - _windowStart;
+    out.printf("CPU占用（统计 %lu ms）:\n", (unsigned long)(windowUs / 1000));
+    out.printf(" %-16s %8s %9s %9s %7s\n", "探针", "调用", "平均us", "最大us", "占用");
+    for (uint8_t i = 0; i < PROFILE_SLOT_COUNT; i++) {
+        const Slot& s = _slots[i];
+        if (!s.calls) continue;
+        // 占用率以0.01%为单位
+        uint32_t load = windowUs ? (uint32_t)(s.totalNs * 10 / windowUs) : 0;
+        out.printf(" %-16s %8lu %9.1f %9.1f %4lu.%02lu%%\n", SLOT_NAMES[i], (unsigned long)s.calls,
+                   s.avgNs / 1000.0f, s.maxNs / 1000.0f, (unsigned long)(load / 100), (unsigned long)(load % 100));
+    }
+    printHw(out);
+    printEvents(out);
+    printTasks(out);
+}
+
+void CpuProfiler::printHw(Print& out) const {
+    int8_t group = _hwGroup;
+    if (group < 0) return;
+    out.printf("硬件计数器（%s，各探针每次的计数）:\n", HW_GROUPS[group].name);
+    for (uint8_t c = 0; c < HW_COUNTERS; c++) {
+        const HwEvent& e = HW_GROUPS[group].events[c];
+        out.printf(" %s\n", e.name);
+        out.printf("  %-16s %9s %9s %9s %7s\n", "探针", "平均", "最大", "最慢一次", e.cycles ? "占周期" : "");
+        for (uint8_t i = 0; i < PROFILE_SLOT_COUNT; i++) {
+            const HwSlot& h = _hwSlots[i];
+            if (!h.calls) continue;
+            out.printf("  %-16s %9.1f %9lu %9lu", SLOT_NAMES[i], (float)h.total[c] / h.calls,
+                       (unsigned long)h.max[c], (unsigned long)h.atSlowest[c]);
+            if (e.cycles && h.cycles) {
+                // 以0.01%为单位
+                uint32_t share = (uint32_t)(h.total[c] * 10000 / h.cycles);
+                out.printf(" %4lu.%02lu%%", (unsigned long)(share / 100), (unsigned long)(share % 100));
+            }
+            out.println();
+        }
+    }
+}
+
+void CpuProfiler::printEvents(Print& out) const {
+    if (!_eventCount) return;
+    uint32_t shown = _eventCount < EVENT_LOG_SIZE ? _eventCount : EVENT_LOG_SIZE;
+    out.printf("最近事件（共 %lu 次）:\n", (unsigned long)_eventCount);
+    for (uint32_t i = _eventCount - shown; i < _eventCount; i++) {
+        const Event& e = _events[i % EVENT_LOG_SIZE];
+        out.printf(" %10lu ms  %-12s %lu\n", (unsigned long)e.timeMs, EVENT_NAMES[e.event], (unsigned long)e.value);
+    }
+}
+
+void CpuProfiler::printTasks(Print& out) const {
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    static const UBaseType_t MAX_TASKS = 24;
+    static TaskStatus_t tasks[MAX_TASKS];
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(tasks, MAX_TASKS, &totalRunTime);
+    if (count == 0 || totalRunTime == 0) return;
+
+    // 运行时间从启动起累计，不随profile reset清零；双核下各任务占用之和为200%
+    out.println("任务（自启动起）:");
+    for (UBaseType_t i = 0; i < count; i++) {
+        uint32_t load = (uint32_t)((uint64_t)tasks[i].ulRunTimeCounter * 10000 / totalRunTime);
+        out.printf(" %-16s 优先级 %2u  栈余量 %5u  %4lu.%02lu%%\n", tasks[i].pcTaskName,
+                   (unsigned)tasks[i].uxCurrentPriority, (unsigned)tasks[i].usStackHighWaterMark,
+                   (unsigned long)(load / 100), (unsigned long)(load % 100));
+    }
+#else
+    out.println("任务占用不可用（FreeRTOS未启用运行时统计）");
+#endif
+}
@@ -0,0 +1,239 @@
+/**
+ * @file CpuProfiler.h
+ * @brief 各子系统的CPU占用统计
+ * @details 在关键路径上放置作用域探针（PROFILE_SCOPE），用CPU周期计数器计时：
+ * - 每个探针在固定表中累计调用次数、总时间、最大值和滑动平均（1/8权重）
+ * - 周期数按当前CPU频率换算成纳秒，动态调频时各次测量仍可比较
+ * - 占用率 = 探针累计时间 / 统计窗口时长（自上次清零起）
+ * - 探针所在任务必须固定在一个核心上（各核心的周期计数器不同步）
+ * - 状态切换（如按键扫描档位）用PROFILE_EVENT记入最近事件环形记录，与占用一起输出
+ * - 串口命令 profile 输出统计，FreeRTOS启用运行时统计时一并输出各任务的占用
+ * - CPU_PROFILER_ENABLED为0时探针不生成代码
+ *
+ * 周期数只说明多慢，不说明为什么慢。profile hw <组> 打开LX7的性能计数器（两个核心同时配置），
+ * 探针在计时的同时读取计数器，按探针累计每次的平均值、最大值和最慢一次时的值：
+ * - fetch：取指停顿周期（闪存缓存未命中时的等待计入这里）和进入的中断次数
+ * - data：数据停顿周期（PSRAM和闪存常量的缓存未命中、存储缓冲满）和完成的指令数
+ * 核心只有两个计数器，一次只能看一组。关闭时探针不读计数器，开销与原来相同。
+ * 需要CPU_PROFILER_HW_COUNTERS为1，且框架带有IDF的perfmon组件。
+ *
+ * 统计只给出每个探针的总量，看不出两个核心上的工作怎样交错。profile trace on 后探针结束时
+ * 另外往环形缓冲写一条区间（开始时刻、时长、探针、核心，16字节），两个核心无锁写入；
+ * profile trace dump 按Chrome trace JSON输出（每个核心一行），存成文件后用
+ * chrome://tracing 或 ui.perfetto.dev 打开，可以看到扫描、分发、渲染、推送和灯带发送的重叠。
+ * 关闭时探针只多读一次标志。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+/**
+ * @brief 探针编号（顺序即输出顺序）
+ */
+enum ProfileSlot {
+    PROFILE_TIMERS,             ///< 时间轮到期回调（休眠各级、配置保存、历史日志写入等）
+    PROFILE_LED_EFFECTS,        ///< keypad.updateLEDEffects
+    PROFILE_AMBIENT,            ///< 自动背光采样
+    PROFILE_BACKLIGHT,          ///< 背光渐变
+    PROFILE_SLEEP,              ///< 休眠管理（请求和浅睡眠）
+    PROFILE_CALCULATOR,         ///< calculator->update
+    PROFILE_DISPLAY_REFRESH,    ///< CalcDisplay::refresh（调用方一侧）
+    PROFILE_LED_SHOW,           ///< 灯带推送（LedOutput任务中的showInternal）
+    PROFILE_KEY_SCAN,           ///< readShiftRegisters
+    PROFILE_KEY_DISPATCH,       ///< KeypadControl::update：按键事件分发和推迟的计算器处理
+    PROFILE_DISPLAY_FLUSH,      ///< Canvas推送到面板（RegionCanvas的推送任务或同步推送，不含等待TE）
+    PROFILE_SETTINGS_WRITE,     ///< 设置镜像写入闪存（SettingsStore）
+    PROFILE_SLOT_COUNT
+};
+
+/**
+ * @brief 事件编号
+ */
+enum ProfileEvent : uint8_t {
+    PROFILE_EVENT_SCAN_RATE,    ///< 按键扫描档位切换，值为新的扫描频率(Hz)
+    PROFILE_EVENT_COUNT
+};
+
+class CpuProfiler {
+public:
+    static const uint8_t HW_COUNTERS = 2;       ///< LX7的性能计数器个数（XCHAL_NUM_PERF_COUNTERS）
+
+    static CpuProfiler& instance() {
+        static CpuProfiler instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册串口命令
+     */
+    void begin();
+
+    /**
+     * @brief 记录一次测量
+     * @param slot 探针编号
+     * @param cycles 经过的CPU周期数
+     */
+    void record(ProfileSlot slot, uint32_t cycles);
+
+    /**
+     * @brief 记录一个事件（覆盖最旧的记录）
+     * @param event 事件编号
+     * @param value 事件的值
+     * @details 不加锁，输出时恰好被覆盖的一条可能不完整
+     */
+    void recordEvent(ProfileEvent event, uint32_t value);
+
+    /**
+     * @brief 记录一次带硬件计数器的测量
+     * @param counts 各计数器在探针期间的增量
+     */
+    void record(ProfileSlot slot, uint32_t cycles, const uint32_t* counts);
+
+    /**
+     * @brief 选择硬件计数器的事件组并在两个核心上开始计数
+     * @param name 组名（fetch、data），nullptr关闭
+     * @return 组名无效或计数器不可用时返回false
+     */
+    bool setHwGroup(const char* name);
+
+    /**
+     * @brief 探针是否读取硬件计数器
+     */
+    static bool hwActive() { return _hwGroup >= 0; }
+
+    /**
+     * @brief 读取当前核心的计数器
+     */
+    static void readCounters(uint32_t* counts);
+
+    /**
+     * @brief 开始/停止记录区间，第一次开始时分配缓冲
+     * @return 缓冲分配失败（没有PSRAM）时返回false
+     */
+    bool setTracing(bool enabled);
+
+    /**
+     * @brief 探针是否记录区间
+     */
+    static bool tracing() { return _tracing; }
+
+    /**
+     * @brief 记录一个刚结束的区间（探针所在核心调用）
+     */
+    void recordSpan(ProfileSlot slot, uint32_t cycles);
+
+    void clearTrace();
+
+    /**
+     * @brief 按Chrome trace JSON输出缓冲中的区间（输出期间暂停记录）
+     */
+    void printTrace(Print& out);
+
+    void reset();
+    void print(Print& out) const;
+
+private:
+    struct Slot {
+        uint32_t calls;
+        uint32_t avgNs;         ///< 滑动平均
+        uint32_t maxNs;
+        uint64_t totalNs;
+    };
+
+    struct HwSlot {
+        uint32_t calls;
+        uint32_t slowestNs;                 ///< 最慢一次的时间，atSlowest为该次的计数
+        uint64_t cycles;                    ///< 累计周期，停顿类计数按此算占比
+        uint64_t total[HW_COUNTERS];
+        uint32_t max[HW_COUNTERS];
+        uint32_t atSlowest[HW_COUNTERS];
+    };
+
+    /**
+     * @brief 一条区间记录
+     */
+    struct Span {
+        uint32_t startUs;       ///< esp_timer_get_time()的低32位，两个核心共用同一时基
+        uint32_t durationNs;
+        uint32_t cycles;        ///< 探针测得的周期数（调频时与时长的比值会变）
+        uint8_t slot;           ///< ProfileSlot
+        uint8_t core;
+        uint16_t reserved;
+    };
+
+    struct Event {
+        uint32_t timeMs;        ///< millis()
+        uint32_t value;
+        ProfileEvent event;
+    };
+
+    static const uint8_t EVENT_LOG_SIZE = 16;
+
+    CpuProfiler();
+    CpuProfiler(const CpuProfiler&) = delete;
+    CpuProfiler& operator=(const CpuProfiler&) = delete;
+
+    void printTasks(Print& out) const;
+    void printEvents(Print& out) const;
+    void printHw(Print& out) const;
+    static void configureCore(void* arg);
+
+    Slot _slots[PROFILE_SLOT_COUNT];
+    HwSlot _hwSlots[PROFILE_SLOT_COUNT];
+    static volatile int8_t _hwGroup;    ///< 当前事件组，-1为关闭
+    static volatile bool _tracing;
+    Span* _spans;               ///< CPU_TRACE_SPANS条，未打开过时为nullptr
+    std::atomic<uint32_t> _spanCount;   ///< 自清空起写入的总数，下一条位于_spanCount%CPU_TRACE_SPANS
+    Event _events[EVENT_LOG_SIZE];
+    uint32_t _eventCount;       ///< 自清零起的事件总数，最新一条位于(_eventCount-1)%EVENT_LOG_SIZE
+    int64_t _windowStart;       ///< 统计窗口起点（esp_timer_get_time()）
+};
+
+/**
+ * @brief 作用域探针：构造时读周期计数器，析构时记录
+ * @details 硬件计数器打开时同时读取性能计数器，读取放在周期计数之外，不计入测得的时间
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileSlot slot) : _slot(slot), _hw(CpuProfiler::hwActive()) {
+        if (_hw) CpuProfiler::readCounters(_counts);
+        _start = ESP.getCycleCount();
+    }
+
+    ~ProfileScope() {
+        uint32_t cycles = ESP.getCycleCount() - _start;
+        if (CpuProfiler::tracing()) CpuProfiler::instance().recordSpan(_slot, cycles);
+        if (!_hw) {
+            CpuProfiler::instance().record(_slot, cycles);
+            return;
+        }
+        uint32_t end[CpuProfiler::HW_COUNTERS];
+        CpuProfiler::readCounters(end);
+        for (uint8_t i = 0; i < CpuProfiler::HW_COUNTERS; i++) end[i] -= _counts[i];
+        CpuProfiler::instance().record(_slot, cycles, end);
+    }
+
+private:
+    ProfileSlot _slot;
+    bool _hw;
+    uint32_t _start;
+    uint32_t _counts[CpuProfiler::HW_COUNTERS];
+};
+
+#if CPU_PROFILER_ENABLED
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(slot) ProfileScope PROFILE_CONCAT(_profile, __LINE__)(slot)
+#define PROFILE_EVENT(event, value) CpuProfiler::instance().recordEvent(event, value)
+#else
+#define PROFILE_SCOPE(slot) ((void)0)
+#define PROFILE_EVENT(event, value) ((void)0)
+#endif
+
+#endif // CPU_PROFILER_H
@@ -0,0 +1,381 @@
+/**
+ * @file CrashDump.cpp
+ * @brief 崩溃记录实现
+ *
+ * @author Calculator Project
+ */
+
+#include "CrashDump.h"
+#include "Console.h"
+#include "KeyJournal.h"
+#include "Logger.h"
+#include <esp_debug_helpers.h>
+#include <esp_ota_ops.h>
+#include <esp_rom_crc.h>
+#include <esp_spi_flash.h>
+#include <esp_flash_internal.h>
+#include <esp_private/panic_internal.h>
+#include <freertos/task_snapshot.h>
+#include <freertos/xtensa_context.h>
+#include <soc/cpu.h>
+#include <soc/soc_memory_layout.h>
+#include <string.h>
+
+#define TAG_CRASH "Crash"
+
+namespace {
+
+static_assert(sizeof(CrashDump::Header) == 64, "头部布局与host_link.py一致");
+static_assert(CRASH_RECORD_BYTES % 4096 == 0, "记录区按扇区擦除");
+// 各部分都取上限时也放得下，写入时不需要处理截断
+static_assert(sizeof(CrashDump::Header) + CrashDump::REGISTER_COUNT * 4
+              + CRASH_MAX_TASKS * (configMAX_TASK_NAME_LEN + 2 + CRASH_BACKTRACE_DEPTH * 4)
+              + 2 + CRASH_LOG_BYTES + 2 + CRASH_KEY_ENTRIES * sizeof(KeyJournal::Entry) <= CRASH_RECORD_BYTES,
+              "CRASH_RECORD_BYTES放不下一份完整的记录");
+
+/**
+ * @brief 顺序写入记录区，经小缓冲凑整后写闪存，同时累计CRC
+ */
+class RecordWriter {
+public:
+    void start(const esp_partition_t* partition, uint32_t offset) {
+        _partition = partition;
+        _offset = offset;
+        _length = 0;
+        _used = 0;
+        _crc = 0;
+    }
+
+    void put(const void* data, size_t length) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        _crc = esp_rom_crc32_le(_crc, p, length);
+        _length += length;
+        while (length > 0) {
+            size_t chunk = sizeof(_buffer) - _used;
+            if (chunk > length) chunk = length;
+            memcpy(_buffer + _used, p, chunk);
+            _used += chunk;
+            p += chunk;
+            length -= chunk;
+            if (_used == sizeof(_buffer)) flush();
+        }
+    }
+
+    void put16(uint16_t value) { put(&value, sizeof(value)); }
+
+    void flush() {
+        if (_used == 0) return;
+        esp_partition_write(_partition, _offset, _buffer, _used);
+        _offset += _used;
+        _used = 0;
+    }
+
+    uint32_t length() const { return _length; }
+    uint32_t crc() const { return _crc; }
+
+private:
+    const esp_partition_t* _partition;
+    uint32_t _offset;
+    uint32_t _length;
+    uint32_t _crc;
+    size_t _used;
+    uint8_t _buffer[256];
+};
+
+// panic时可能正是栈溢出，写入用到的缓冲都放在静态存储中
+RecordWriter writer;
+TaskSnapshot_t snapshots[CRASH_MAX_TASKS];
+uint32_t pcs[CRASH_BACKTRACE_DEPTH];
+uint8_t logChunk[128];
+
+uint8_t backtrace(esp_backtrace_frame_t frame) {
+    uint8_t depth = 0;
+    pcs[depth++] = esp_cpu_process_stack_pc(frame.pc);
+    while (depth < CRASH_BACKTRACE_DEPTH && frame.next_pc && esp_stack_ptr_is_sane(frame.sp)) {
+        if (!esp_backtrace_get_next_frame(&frame)) break;
+        uint32_t pc = esp_cpu_process_stack_pc(frame.pc);
+        if (!esp_ptr_executable((void*)pc)) break;
+        pcs[depth++] = pc;
+    }
+    return depth;
+}
+
+void writeTask(TaskHandle_t task, uint8_t flags, const esp_backtrace_frame_t* frame) {
+    char name[configMAX_TASK_NAME_LEN] = {0};
+    if (task) strncpy(name, pcTaskGetName(task), sizeof(name) - 1);
+    uint8_t depth = frame ? backtrace(*frame) : 0;
+    writer.put(name, sizeof(name));
+    writer.put(&flags, 1);
+    writer.put(&depth, 1);
+    writer.put(pcs, depth * sizeof(uint32_t));
+}
+
+uint8_t writeTasks(int core, const XtExcFrame* exc) {
+    UBaseType_t tcbSize;
+    UBaseType_t count = uxTaskGetSnapshotAll(snapshots, CRASH_MAX_TASKS, &tcbSize);
+    TaskHandle_t faulted = xTaskGetCurrentTaskHandleForCPU(core);
+    TaskHandle_t other = portNUM_PROCESSORS > 1 ? xTaskGetCurrentTaskHandleForCPU(1 - core) : nullptr;
+
+    uint8_t written = 0;
+    if (exc) {
+        esp_backtrace_frame_t frame = {};
+        frame.pc = exc->pc;
+        frame.sp = exc->a1;
+        frame.next_pc = exc->a0;
+        frame.exc_frame = exc;
+        writeTask(faulted, CrashDump::TASK_FAULTED, &frame);
+        written++;
+    }
+    for (UBaseType_t i = 0; i < count && written < CRASH_MAX_TASKS; i++) {
+        TaskHandle_t task = (TaskHandle_t)snapshots[i].pxTCB;
+        if (exc && task == faulted) continue;
+        if (task == other) {
+            writeTask(task, CrashDump::TASK_RUNNING, nullptr);
+            written++;
+            continue;
+        }
+        // 栈顶指向任务切换时保存的现场：被中断时为XtExcFrame，主动让出时为XtSolFrame
+        const void* top = snapshots[i].pxTopOfStack;
+        if (!esp_stack_ptr_is_sane((uint32_t)top)) {
+            writeTask(task, 0, nullptr);
+        } else {
+            esp_backtrace_frame_t frame = {};
+            const XtExcFrame* saved = (const XtExcFrame*)top;
+            if (saved->exit) {
+                frame.pc = saved->pc;
+                frame.sp = saved->a1;
+                frame.next_pc = saved->a0;
+            } else {
+                const XtSolFrame* sol = (const XtSolFrame*)top;
+                frame.pc = sol->pc;
+                frame.sp = sol->a1;
+                frame.next_pc = sol->a0;
+            }
+            writeTask(task, 0, &frame);
+        }
+        written++;
+    }
+    return written;
+}
+
+void cmdCrash(const ConsoleArgs& args) {
+    if (args.is(1, "clear")) {
+        CrashDump::instance().clear();
+        Serial.println("✅ 崩溃记录已清除，记录区擦除后重新就绪");
+        return;
+    }
+    CrashDump::instance().printStatus(Serial);
+}
+
+constexpr ConsoleCommand CRASH_COMMANDS[] = {
+    {"crash", "[clear]", "上次崩溃的原因、寄存器和回溯（clear：清除记录）", cmdCrash},
+};
+static_assert(consoleSorted(CRASH_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+// 链接参数 -Wl,--wrap=esp_panic_handler 把IDF的panic入口转到这里
+extern "C" {
+void __real_esp_panic_handler(panic_info_t* info);
+
+void __wrap_esp_panic_handler(panic_info_t* info) {
+    // 写记录时再次出错，直接交给原来的处理
+    static bool entered = false;
+    if (!entered) {
+        entered = true;
+        esp_panic_handler_reconfigure_wdts();
+        CrashDump::instance().capture(info);
+    }
+    __real_esp_panic_handler(info);
+}
+}
+
+CrashDump::CrashDump()
+    : _partition(nullptr),
+      _timer(TimerWheel::INVALID),
+      _recordLength(0),
+      _eraseNext(0),
+      _armed(false) {
+    memset(_elfSha, 0, sizeof(_elfSha));
+}
+
+void CrashDump::begin() {
+    Console::instance().addCommands(CRASH_COMMANDS);
+    memcpy(_elfSha, esp_ota_get_app_description()->app_elf_sha256, sizeof(_elfSha));
+
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_COREDUMP, nullptr);
+    if (!_partition || _partition->size < CRASH_RECORD_BYTES) {
+        _partition = nullptr;
+        LOG_W(TAG_CRASH, "没有足够大的coredump分区，崩溃记录不可用");
+        return;
+    }
+    _timer = TimerWheel::instance().create("crash", [](void* context) {
+        static_cast<CrashDump*>(context)->eraseStep();
+    }, this);
+
+    if (validate()) {
+        Header header;
+        read(0, &header, sizeof(header));
+        header.reason[sizeof(header.reason) - 1] = '\0';
+        LOG_W(TAG_CRASH, "上次运行 %lu ms 时崩溃（%s），记录 %lu 字节待取回: host_link.py crash",
+              (unsigned long)header.uptimeMs, header.reason, (unsigned long)_recordLength);
+        return;
+    }
+    if (isBlank()) {
+        _armed = true;
+    } else {
+        _eraseNext = 0;
+        TimerWheel::instance().start(_timer, CRASH_ERASE_DELAY_MS);
+    }
+}
+
+bool CrashDump::validate() {
+    Header header;
+    if (esp_partition_read(_partition, 0, &header, sizeof(header)) != ESP_OK) return false;
+    if (header.magic != MAGIC || header.version != VERSION
+        || header.bodyLength > CRASH_RECORD_BYTES - sizeof(header)) {
+        return false;
+    }
+    uint8_t buffer[256];
+    uint32_t crc = 0;
+    for (uint32_t offset = 0; offset < header.bodyLength; offset += sizeof(buffer)) {
+        uint32_t length = header.bodyLength - offset;
+        if (length > sizeof(buffer)) length = sizeof(buffer);
+        if (esp_partition_read(_partition, sizeof(header) + offset, buffer, length) != ESP_OK) return false;
+        crc = esp_rom_crc32_le(crc, buffer, length);
+    }
+    if (crc != header.bodyCrc) return false;
+    _recordLength = sizeof(header) + header.bodyLength;
+    return true;
+}
+
+bool CrashDump::isBlank() const {
+    uint32_t buffer[64];
+    for (uint32_t offset = 0; offset < CRASH_RECORD_BYTES; offset += sizeof(buffer)) {
+        if (esp_partition_read(_partition, offset, buffer, sizeof(buffer)) != ESP_OK) return false;
+        for (uint32_t word : buffer) {
+            if (word != 0xFFFFFFFF) return false;
+        }
+    }
+    return true;
+}
+
+void CrashDump::eraseStep() {
+    if (esp_partition_erase_range(_partition, _eraseNext, SECTOR_SIZE) != ESP_OK) {
+        LOG_E(TAG_CRASH, "擦除记录区失败 (0x%lx)", (unsigned long)_eraseNext);
+        return;
+    }
+    _eraseNext += SECTOR_SIZE;
+    if (_eraseNext < CRASH_RECORD_BYTES) {
+        TimerWheel::instance().start(_timer, ERASE_STEP_MS);
+    } else {
+        _armed = true;
+        LOG_I(TAG_CRASH, "崩溃记录区已就绪");
+    }
+}
+
+bool CrashDump::read(uint32_t offset, void* out, size_t size) const {
+    if (offset > _recordLength || size > _recordLength - offset) return false;
+    return esp_partition_read(_partition, offset, out, size) == ESP_OK;
+}
+
+void CrashDump::clear() {
+    if (!_partition) return;
+    _recordLength = 0;
+    _armed = false;
+    _eraseNext = 0;
+    TimerWheel::instance().start(_timer, ERASE_STEP_MS);
+}
+
+void CrashDump::capture(const void* panicInfo) {
+    if (!_armed) return;
+    _armed = false;
+    const panic_info_t* info = static_cast<const panic_info_t*>(panicInfo);
+    const XtExcFrame* exc = static_cast<const XtExcFrame*>(info->frame);
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.version = VERSION;
+    header.core = info->core;
+    header.uptimeMs = millis();
+    header.address = (uint32_t)info->addr;
+    memcpy(header.elfSha, _elfSha, sizeof(header.elfSha));
+    if (info->reason) strncpy(header.reason, info->reason, sizeof(header.reason) - 1);
+
+    // 调度器已不可用，闪存操作改用不依赖操作系统的保护
+    spi_flash_guard_set(&g_flash_guard_no_os_ops);
+    esp_flash_app_disable_protect(true);
+
+    writer.start(_partition, sizeof(header));
+    uint32_t registers[REGISTER_COUNT] = {0};
+    if (exc) {
+        registers[0] = exc->pc;
+        registers[1] = exc->ps;
+        registers[2] = exc->exccause;
+        registers[3] = exc->excvaddr;
+        memcpy(&registers[4], &exc->a0, 16 * sizeof(uint32_t));
+    }
+    writer.put(registers, sizeof(registers));
+    header.taskCount = writeTasks(info->core, exc);
+
+    const Logger& logger = Logger::getInstance();
+    size_t logLength = logger.recentLength();
+    writer.put16(logLength);
+    for (size_t offset = 0; offset < logLength; offset += sizeof(logChunk)) {
+        writer.put(logChunk, logger.copyRecent(offset, logChunk, sizeof(logChunk)));
+    }
+
+    const KeyJournal& journal = KeyJournal::instance();
+    uint16_t keys = journal.count() < CRASH_KEY_ENTRIES ? journal.count() : CRASH_KEY_ENTRIES;
+    writer.put16(keys);
+    for (uint16_t i = journal.count() - keys; i < journal.count(); i++) {
+        writer.put(&journal.at(i), sizeof(KeyJournal::Entry));
+    }
+    writer.flush();
+
+    // 头部最后写入，中途断电或再次出错时记录保持无效
+    header.bodyLength = writer.length();
+    header.bodyCrc = writer.crc();
+    header.magic = MAGIC;
+    esp_partition_write(_partition, 0, &header, sizeof(header));
+}
+
+void CrashDump::printStatus(Print& out) const {
+    if (!_partition) {
+        out.println("没有coredump分区，崩溃记录不可用");
+        return;
+    }
+    if (_recordLength == 0) {
+        out.println(_armed ? "没有崩溃记录，记录区已就绪" : "没有崩溃记录，记录区正在擦除");
+        return;
+    }
+
+    Header header;
+    uint32_t registers[REGISTER_COUNT];
+    read(0, &header, sizeof(header));
+    read(sizeof(header), registers, sizeof(registers));
+    header.reason[sizeof(header.reason) - 1] = '\0';
+    out.printf("上次运行 %lu.%03lu s 时在核心%u崩溃: %s\n", (unsigned long)(header.uptimeMs / 1000),
+               (unsigned long)(header.uptimeMs % 1000), header.core, header.reason);
+    out.printf(" 出错地址 0x%08lx，固件ELF ", (unsigned long)header.address);
+    for (uint8_t b : header.elfSha) out.printf("%02x", b);
+    out.println(memcmp(header.elfSha, _elfSha, sizeof(_elfSha)) == 0 ? "（当前固件）" : "（不是当前固件）");
+    out.printf(" PC 0x%08lx  PS 0x%08lx  EXCCAUSE %lu  EXCVADDR 0x%08lx\n", (unsigned long)registers[0],
+               (unsigned long)registers[1], (unsigned long)registers[2], (unsigned long)registers[3]);
+
+    // 出错任务的回溯，其余任务、日志和按键用 host_link.py crash 取回
+    uint32_t offset = sizeof(header) + sizeof(registers);
+    char name[configMAX_TASK_NAME_LEN];
+    uint8_t flags[2];
+    if (header.taskCount > 0 && read(offset, name, sizeof(name)) && read(offset + sizeof(name), flags, 2)) {
+        name[sizeof(name) - 1] = '\0';
+        out.printf(" 任务 %s 回溯:", name);
+        uint32_t pc;
+        for (uint8_t i = 0; i < flags[1] && read(offset + sizeof(name) + 2 + i * 4, &pc, 4); i++) {
+            out.printf(" 0x%08lx", (unsigned long)pc);
+        }
+        out.println();
+    }
+    out.printf(" 记录 %lu 字节，%u 个任务；完整内容: host_link.py crash\n", (unsigned long)_recordLength,
+               header.taskCount);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file CrashDump.h
+ * @brief 崩溃记录：panic时写入闪存，下次启动后由主机通道取回
+ * @details 现场崩溃原本只在UART上打印一次回溯，没接串口就什么也留不下：
+ * - 链接时用 -Wl,--wrap=esp_panic_handler 在IDF的panic处理之前写入一份紧凑的记录
+ *   （partitions.csv中的coredump分区，框架没有启用IDF自带的core dump）
+ * - 记录区在启动后由时间轮预先擦除（每次一个扇区，不拖慢启动），panic时只写不擦，
+ *   总量有上限（CRASH_RECORD_BYTES），写入时间固定在几十毫秒内
+ * - 写入用到的缓冲都是静态的，栈溢出引起的崩溃也能写
+ * - 有效记录一直保留到主机取回后清除（host_link.py crash --clear 或串口 crash clear），
+ *   期间再次崩溃不覆盖第一次的记录
+ * - 取回走USB CDC主机通道（HOST_CMD_GET_CRASH），和历史记录一样每次主循环发一帧
+ *
+ * 记录格式（小端）：头部（Header，64字节，最后写入）之后依次为
+ *     寄存器：PC、PS、EXCCAUSE、EXCVADDR、A0–A15（各4字节）
+ *     各任务（头部给出个数，出错的任务在前）：名称(16) | 标志(1) | 层数(1) | 各层PC(4 × 层数)
+ *     最近日志：长度(2) + Logger的二进制帧（tools/log_decode.py解码）
+ *     按键日志：条数(2) + KeyJournal::Entry（各8字节，最旧的在前）
+ * CRC32覆盖头部之后的全部内容。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef CRASH_DUMP_H
+#define CRASH_DUMP_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "config.h"
+#include "TimerWheel.h"
+
+class CrashDump {
+public:
+    static const uint32_t MAGIC = 0x44524350;       ///< "PCRD"
+    static const uint8_t VERSION = 1;
+    static const uint8_t REGISTER_COUNT = 20;
+    static const uint8_t TASK_FAULTED = 0x01;       ///< 出错的任务，从异常现场回溯
+    static const uint8_t TASK_RUNNING = 0x02;       ///< 另一个核心上正在运行，保存的现场已过时，不回溯
+
+    struct Header {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t core;               ///< 出错的核心
+        uint8_t taskCount;
+        uint8_t reserved;
+        uint32_t bodyLength;        ///< 头部之后的字节数
+        uint32_t bodyCrc;
+        uint32_t uptimeMs;
+        uint32_t address;           ///< 出错地址（异常PC或abort的调用处）
+        uint8_t elfSha[8];          ///< 固件ELF的SHA-256前8字节，对照回溯用的firmware.elf
+        char reason[32];
+    };
+
+    static CrashDump& instance() {
+        static CrashDump instance;
+        return instance;
+    }
+
+    /**
+     * @brief 查找记录区、检查上次的记录并注册串口命令；没有记录时安排擦除
+     */
+    void begin();
+
+    /**
+     * @brief 待取回记录的字节数（含头部），0表示没有
+     */
+    uint32_t recordLength() const { return _recordLength; }
+
+    /**
+     * @brief 读取记录的一段
+     * @return 没有记录或超出范围时返回false
+     */
+    bool read(uint32_t offset, void* out, size_t size) const;
+
+    /**
+     * @brief 丢弃记录，重新擦除记录区
+     */
+    void clear();
+
+    void printStatus(Print& out) const;
+
+    /**
+     * @brief 写入崩溃记录（panic处理中调用，其他核心已停止）
+     * @param info IDF的panic_info_t
+     */
+    void capture(const void* info);
+
+private:
+    static const uint32_t SECTOR_SIZE = 4096;
+    static const uint32_t ERASE_STEP_MS = 100;      ///< 擦除相邻两个扇区的间隔，主循环不会连续停顿
+
+    CrashDump();
+    CrashDump(const CrashDump&) = delete;
+    CrashDump& operator=(const CrashDump&) = delete;
+
+    bool validate();
+    bool isBlank() const;
+    void eraseStep();
+
+    const esp_partition_t* _partition;
+    TimerWheel::TimerId _timer;
+    uint32_t _recordLength;
+    uint32_t _eraseNext;            ///< 下一个要擦除的偏移
+    volatile bool _armed;           ///< 记录区已擦除，崩溃时可以写入
+    uint8_t _elfSha[8];
+};
+
+#endif // CRASH_DUMP_H
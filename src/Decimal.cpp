@@ -0,0 +1,428 @@
+/**
+ * @file Decimal.cpp
+ * @brief 固定精度十进制数实现
+ *
+ * 运算在81位（9个limb）的定长中间数上进行，最后统一舍入到34位有效数字。
+ *
+ * @author Calculator Project
+ */
+
+#include "Decimal.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+const uint32_t LIMB_BASE = 1000000000UL;
+const uint8_t LIMB_DIGITS = 9;
+const uint8_t WIDE_LIMBS = 9;
+const uint8_t WIDE_MAX_DIGITS = WIDE_LIMBS * LIMB_DIGITS;
+const uint8_t ALIGN_MAX_DIGITS = WIDE_MAX_DIGITS - LIMB_DIGITS;    // 加法对齐后的最大位数，留出进位空间
+
+const uint32_t POW10_U32[LIMB_DIGITS + 1] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL,
+    1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+// 中间结果：10^9进制，小端
+struct Wide {
+    uint32_t d[WIDE_LIMBS];
+};
+
+void wideClear(Wide &w) {
+    memset(w.d, 0, sizeof(w.d));
+}
+
+void wideLoad(Wide &w, const uint32_t *coef) {
+    wideClear(w);
+    memcpy(w.d, coef, Decimal::LIMBS * sizeof(uint32_t));
+}
+
+bool wideIsZero(const Wide &w) {
+    for (uint8_t i = 0; i < WIDE_LIMBS; i++) {
+        if (w.d[i]) return false;
+    }
+    return true;
+}
+
+int wideCompare(const Wide &a, const Wide &b) {
+    for (int i = WIDE_LIMBS - 1; i >= 0; i--) {
+        if (a.d[i] != b.d[i]) return a.d[i] < b.d[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+uint8_t wideDigits(const Wide &w) {
+    for (int i = WIDE_LIMBS - 1; i >= 0; i--) {
+        if (w.d[i]) {
+            uint8_t n = 1;
+            while (n < LIMB_DIGITS && w.d[i] >= POW10_U32[n]) n++;
+            return i * LIMB_DIGITS + n;
+        }
+    }
+    return 0;
+}
+
+// 乘以m（m ≤ 10^9），调用方保证结果不超出宽度
+void wideMulSmall(Wide &w, uint32_t m) {
+    uint64_t carry = 0;
+    for (uint8_t i = 0; i < WIDE_LIMBS; i++) {
+        uint64_t v = (uint64_t)w.d[i] * m + carry;
+        w.d[i] = (uint32_t)(v % LIMB_BASE);
+        carry = v / LIMB_BASE;
+    }
+}
+
+void wideAddSmall(Wide &w, uint32_t v) {
+    for (uint8_t i = 0; i < WIDE_LIMBS && v; i++) {
+        uint32_t s = w.d[i] + v;
+        if (s >= LIMB_BASE) {
+            w.d[i] = s - LIMB_BASE;
+            v = 1;
+        } else {
+            w.d[i] = s;
+            v = 0;
+        }
+    }
+}
+
+// 除以m，返回余数
+uint32_t wideDivSmall(Wide &w, uint32_t m) {
+    uint64_t rem = 0;
+    for (int i = WIDE_LIMBS - 1; i >= 0; i--) {
+        uint64_t cur = rem * LIMB_BASE + w.d[i];
+        w.d[i] = (uint32_t)(cur / m);
+        rem = cur % m;
+    }
+    return (uint32_t)rem;
+}
+
+void wideScale10(Wide &w, uint8_t k) {
+    while (k) {
+        uint8_t step = k > LIMB_DIGITS ? LIMB_DIGITS : k;
+        wideMulSmall(w, POW10_U32[step]);
+        k -= step;
+    }
+}
+
+// 截去低k位（向零取整）
+void wideDrop10(Wide &w, uint8_t k) {
+    while (k) {
+        uint8_t step = k > LIMB_DIGITS ? LIMB_DIGITS : k;
+        wideDivSmall(w, POW10_U32[step]);
+        k -= step;
+    }
+}
+
+void wideAdd(Wide &a, const Wide &b) {
+    uint32_t carry = 0;
+    for (uint8_t i = 0; i < WIDE_LIMBS; i++) {
+        uint32_t s = a.d[i] + b.d[i] + carry;
+        carry = s >= LIMB_BASE;
+        a.d[i] = carry ? s - LIMB_BASE : s;
+    }
+}
+
+// a -= b，要求 a >= b
+void wideSub(Wide &a, const Wide &b) {
+    uint32_t borrow = 0;
+    for (uint8_t i = 0; i < WIDE_LIMBS; i++) {
+        uint32_t sub = b.d[i] + borrow;
+        borrow = a.d[i] < sub;
+        a.d[i] = borrow ? a.d[i] + LIMB_BASE - sub : a.d[i] - sub;
+    }
+}
+
+// out = a × b，调用方保证乘积不超出宽度
+void wideMul(const Wide &a, const Wide &b, Wide &out) {
+    wideClear(out);
+    for (uint8_t i = 0; i < WIDE_LIMBS; i++) {
+        if (!a.d[i]) continue;
+        uint64_t carry = 0;
+        for (uint8_t j = 0; i + j < WIDE_LIMBS; j++) {
+            uint64_t v = (uint64_t)a.d[i] * b.d[j] + out.d[i + j] + carry;
+            out.d[i + j] = (uint32_t)(v % LIMB_BASE);
+            carry = v / LIMB_BASE;
+        }
+    }
+}
+
+// 舍入到PRECISION位并去掉末尾的0，结果写入系数
+bool wideNormalize(Wide &c, int32_t &exponent) {
+    uint8_t n = wideDigits(c);
+    if (n > Decimal::PRECISION) {
+        uint8_t drop = n - Decimal::PRECISION;
+        wideDrop10(c, drop - 1);
+        uint32_t digit = wideDivSmall(c, 10);
+        exponent += drop;
+
+        // 四舍五入；999…9进位成1000…0时多出一位
+        if (digit >= 5) {
+            wideAddSmall(c, 1);
+            if (wideDigits(c) > Decimal::PRECISION) {
+                wideDivSmall(c, 10);
+                exponent++;
+            }
+        }
+    }
+
+    if (wideIsZero(c)) return false;
+
+    while (c.d[0] == 0) {
+        memmove(c.d, c.d + 1, (WIDE_LIMBS - 1) * sizeof(uint32_t));
+        c.d[WIDE_LIMBS - 1] = 0;
+        exponent += LIMB_DIGITS;
+    }
+    while (c.d[0] % 10 == 0) {
+        wideDivSmall(c, 10);
+        exponent++;
+    }
+    return true;
+}
+
+} // namespace
+
+Decimal::Decimal() : _exponent(0), _negative(false) {
+    memset(_coef, 0, sizeof(_coef));
+}
+
+Decimal Decimal::fromDouble(double value) {
+    Decimal result;
+    if (!isfinite(value)) return result;
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.15g", value);
+    parse(buf, result);
+    return result;
+}
+
+bool Decimal::parse(const char *text, Decimal &out) {
+    if (!text) return false;
+
+    const char *p = text;
+    while (*p == ' ') p++;
+
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+
+    Wide c;
+    wideClear(c);
+    int32_t exponent = 0;
+    bool anyDigit = false;
+    bool fraction = false;
+
+    for (;; p++) {
+        if (*p >= '0' && *p <= '9') {
+            anyDigit = true;
+            if (wideDigits(c) < ALIGN_MAX_DIGITS) {
+                wideMulSmall(c, 10);
+                wideAddSmall(c, *p - '0');
+                if (fraction) exponent--;
+            } else if (!fraction) {
+                // 超出中间宽度的整数位只计入指数
+                exponent++;
+            }
+        } else if (*p == '.' && !fraction) {
+            fraction = true;
+        } else {
+            break;
+        }
+    }
+    if (!anyDigit) return false;
+
+    if (*p == 'e' || *p == 'E') {
+        p++;
+        bool expNegative = false;
+        if (*p == '-' || *p == '+') {
+            expNegative = *p == '-';
+            p++;
+        }
+        if (*p < '0' || *p > '9') return false;
+
+        int32_t e = 0;
+        for (; *p >= '0' && *p <= '9'; p++) {
+            if (e < 100000) e = e * 10 + (*p - '0');
+        }
+        exponent += expNegative ? -e : e;
+    }
+
+    while (*p == ' ') p++;
+    if (*p) return false;
+
+    out = make(c.d, exponent, negative);
+    return true;
+}
+
+double Decimal::toDouble() const {
+    char buf[56];
+    toString(buf, sizeof(buf));
+    return strtod(buf, nullptr);
+}
+
+size_t Decimal::toString(char *buf, size_t size) const {
+    if (!buf || size == 0) return 0;
+
+    // 系数最多36位数字
+    char digits[LIMBS * 9 + 1];
+    int top = LIMBS - 1;
+    while (top > 0 && !_coef[top]) top--;
+
+    int n = snprintf(digits, sizeof(digits), "%lu", (unsigned long)_coef[top]);
+    for (int i = top - 1; i >= 0; i--) {
+        n += snprintf(digits + n, sizeof(digits) - n, "%09lu", (unsigned long)_coef[i]);
+    }
+
+    int written = snprintf(buf, size, "%s%se%ld", _negative ? "-" : "", digits, (long)_exponent);
+    if (written < 0) {
+        buf[0] = '\0';
+        return 0;
+    }
+    return (size_t)written < size ? (size_t)written : size - 1;
+}
+
+bool Decimal::isZero() const {
+    for (uint8_t i = 0; i < LIMBS; i++) {
+        if (_coef[i]) return false;
+    }
+    return true;
+}
+
+Decimal Decimal::operator-() const {
+    Decimal result = *this;
+    if (!isZero()) result._negative = !_negative;
+    return result;
+}
+
+Decimal Decimal::add(const Decimal &a, const Decimal &b) {
+    if (a.isZero()) return b;
+    if (b.isZero()) return a;
+
+    // hi为指数较大的操作数，对齐到lo的指数
+    const Decimal *hi = &a;
+    const Decimal *lo = &b;
+    if (a._exponent < b._exponent) {
+        hi = &b;
+        lo = &a;
+    }
+
+    Wide h, l;
+    wideLoad(h, hi->_coef);
+    wideLoad(l, lo->_coef);
+
+    int32_t exponent = lo->_exponent;
+    int32_t diff = hi->_exponent - lo->_exponent;
+    int32_t hd = wideDigits(h);
+    int32_t ld = wideDigits(l);
+
+    // 小操作数整体落在大操作数精度之外，不影响结果
+    if (hi->_exponent - (lo->_exponent + ld) > Decimal::PRECISION + 1) {
+        return *hi;
+    }
+
+    // 对齐后超出中间宽度时，先截去小操作数远低于精度的低位
+    if (hd + diff > ALIGN_MAX_DIGITS) {
+        int32_t cut = hd + diff - ALIGN_MAX_DIGITS;
+        wideDrop10(l, (uint8_t)cut);
+        exponent += cut;
+        diff -= cut;
+    }
+    wideScale10(h, (uint8_t)diff);
+
+    if (hi->_negative == lo->_negative) {
+        wideAdd(h, l);
+        return make(h.d, exponent, hi->_negative);
+    }
+
+    int cmp = wideCompare(h, l);
+    if (cmp == 0) return Decimal();
+    if (cmp > 0) {
+        wideSub(h, l);
+        return make(h.d, exponent, hi->_negative);
+    }
+    wideSub(l, h);
+    return make(l.d, exponent, lo->_negative);
+}
+
+Decimal Decimal::sub(const Decimal &a, const Decimal &b) {
+    return add(a, -b);
+}
+
+Decimal Decimal::mul(const Decimal &a, const Decimal &b) {
+    if (a.isZero() || b.isZero()) return Decimal();
+
+    // 两个34位系数的乘积不超过68位
+    Wide x, y, product;
+    wideLoad(x, a._coef);
+    wideLoad(y, b._coef);
+    wideMul(x, y, product);
+    return make(product.d, a._exponent + b._exponent, a._negative != b._negative);
+}
+
+bool Decimal::div(const Decimal &a, const Decimal &b, Decimal &out) {
+    if (b.isZero()) return false;
+    if (a.isZero()) {
+        out = Decimal();
+        return true;
+    }
+
+    Wide r, d;
+    wideLoad(r, a._coef);
+    wideLoad(d, b._coef);
+    int32_t exponent = a._exponent - b._exponent;
+
+    // 把被除数和除数调整到相同位数，再保证 d <= r < 10d，商的第一位即个位
+    uint8_t rd = wideDigits(r);
+    uint8_t dd = wideDigits(d);
+    if (rd < dd) {
+        wideScale10(r, dd - rd);
+        exponent -= dd - rd;
+    } else if (rd > dd) {
+        wideScale10(d, rd - dd);
+        exponent += rd - dd;
+    }
+    if (wideCompare(r, d) < 0) {
+        wideMulSmall(r, 10);
+        exponent--;
+    }
+
+    // 逐位长除，多算一位用于舍入；除尽时提前结束
+    Wide q;
+    wideClear(q);
+    uint8_t produced = 0;
+    for (;;) {
+        uint32_t digit = 0;
+        while (wideCompare(r, d) >= 0) {
+            wideSub(r, d);
+            digit++;
+        }
+        wideMulSmall(q, 10);
+        wideAddSmall(q, digit);
+        produced++;
+
+        if (wideIsZero(r) || produced > Decimal::PRECISION) break;
+        wideMulSmall(r, 10);
+    }
+    exponent -= produced - 1;
+
+    out = make(q.d, exponent, a._negative != b._negative);
+    return true;
+}
+
+Decimal Decimal::make(const uint32_t *wideLimbs, int32_t exponent, bool negative) {
+    Decimal result;
+
+    Wide c;
+    memcpy(c.d, wideLimbs, sizeof(c.d));
+    if (!wideNormalize(c, exponent)) return result;
+
+    // 舍入后系数不超过34位，只占用低4个limb
+    memcpy(result._coef, c.d, sizeof(result._coef));
+    result._exponent = exponent;
+    result._negative = negative;
+    return result;
+}
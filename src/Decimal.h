@@ -0,0 +1,85 @@
+/**
+ * @file Decimal.h
+ * @brief 固定精度的十进制数
+ * @details 数值表示为 (-1)^sign × 系数 × 10^指数：
+ * - 系数最多34位有效数字，以4个10^9进制的limb保存（小端）
+ * - 所有运算使用对象内部的定长数组，不分配堆内存
+ * - 超出精度时按四舍五入（ROUND_HALF_UP）舍入，系数去掉末尾的0
+ *
+ * 0.1 + 0.2 等十进制小数运算的结果是精确的，不会出现二进制浮点的舍入误差。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef DECIMAL_H
+#define DECIMAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Decimal {
+public:
+    static const uint8_t PRECISION = 34;    ///< 最大有效数字位数
+    static const uint8_t LIMBS = 4;         ///< 系数limb数（4×9位 ≥ 34位）
+
+    /**
+     * @brief 构造为0
+     */
+    Decimal();
+
+    /**
+     * @brief 由double构造
+     * @details 取15位有效数字的最短十进制表示，0.1得到精确的0.1而不是其二进制近似值
+     */
+    static Decimal fromDouble(double value);
+
+    /**
+     * @brief 解析十进制文本，支持 [-]整数[.小数][e[-]指数]
+     * @param text 输入文本
+     * @param out 解析结果
+     * @return 格式无效时返回false
+     */
+    static bool parse(const char *text, Decimal &out);
+
+    /**
+     * @brief 转为最接近的double
+     */
+    double toDouble() const;
+
+    /**
+     * @brief 输出为 [-]系数e指数 形式（可直接交给strtod）
+     * @param buf 输出缓冲区（至少48字节可保证不截断）
+     * @param size 缓冲区大小
+     * @return 写入的字符数
+     */
+    size_t toString(char *buf, size_t size) const;
+
+    bool isZero() const;
+    bool isNegative() const { return _negative; }
+    int32_t getExponent() const { return _exponent; }
+
+    Decimal operator-() const;
+
+    static Decimal add(const Decimal &a, const Decimal &b);
+    static Decimal sub(const Decimal &a, const Decimal &b);
+    static Decimal mul(const Decimal &a, const Decimal &b);
+
+    /**
+     * @brief 除法
+     * @return 除数为0时返回false，out不变
+     */
+    static bool div(const Decimal &a, const Decimal &b, Decimal &out);
+
+private:
+    /**
+     * @brief 由中间结果构造：舍入到PRECISION位并去掉末尾的0
+     * @param wideLimbs 9个limb的中间系数
+     */
+    static Decimal make(const uint32_t *wideLimbs, int32_t exponent, bool negative);
+
+    uint32_t _coef[LIMBS];      ///< 系数（10^9进制，小端）
+    int32_t _exponent;          ///< 十进制指数
+    bool _negative;             ///< 符号
+};
+
+#endif // DECIMAL_H
@@ -0,0 +1,112 @@
+/**
+ * @file DirtyRegions.h
+ * @brief 一帧内待推送矩形的列表
+ * @details 绘制时各处记录变化的矩形，推送时整批交给RegionCanvas::flushRegions()：
+ * - 相交或相邻、且合并后多推送的像素不超过MERGE_SLACK的矩形就地合并
+ *   （整行条带上下相接时合并没有浪费，总会合并）
+ * - 列表满时把新矩形并入使浪费最少的那个，不会丢失区域
+ * - 与原来的外接矩形相比，互不相邻的两行（如L1和L3）不再连同中间的行一起推送
+ * 固定容量、无动态内存分配，只在绘制侧使用。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef DIRTY_REGIONS_H
+#define DIRTY_REGIONS_H
+
+#include <stdint.h>
+
+class DirtyRegions {
+public:
+    static const uint8_t CAPACITY = 8;          ///< 最多保存的矩形数
+    static const int32_t MERGE_SLACK = 512;     ///< 合并时允许多推送的像素数（约一次地址窗口设置的开销）
+
+    struct Rect {
+        int16_t x, y, w, h;
+    };
+
+    DirtyRegions() : _count(0) {}
+
+    void clear() { _count = 0; }
+    bool empty() const { return _count == 0; }
+    uint8_t count() const { return _count; }
+    const Rect &operator[](uint8_t i) const { return _rects[i]; }
+
+    /**
+     * @brief 加入一个矩形，能合并时与已有矩形合并
+     */
+    void add(int16_t x, int16_t y, int16_t w, int16_t h) {
+        if (w <= 0 || h <= 0) return;
+        Rect r = {x, y, w, h};
+
+        // 合并后的矩形可能又能与其他矩形合并，直到没有可合并的为止
+        for (uint8_t i = 0; i < _count; ) {
+            if (touches(_rects[i], r) && waste(_rects[i], r) <= MERGE_SLACK) {
+                r = unite(_rects[i], r);
+                _rects[i] = _rects[--_count];
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+
+        if (_count < CAPACITY) {
+            _rects[_count++] = r;
+            return;
+        }
+        uint8_t best = 0;
+        for (uint8_t i = 1; i < _count; i++) {
+            if (waste(_rects[i], r) < waste(_rects[best], r)) best = i;
+        }
+        Rect merged = unite(_rects[best], r);
+        _rects[best] = _rects[--_count];
+        add(merged.x, merged.y, merged.w, merged.h);
+    }
+
+    /**
+     * @brief 所有矩形的外接矩形（列表为空时宽高为0）
+     */
+    Rect bounds() const {
+        if (!_count) return Rect{0, 0, 0, 0};
+        Rect r = _rects[0];
+        for (uint8_t i = 1; i < _count; i++) r = unite(r, _rects[i]);
+        return r;
+    }
+
+    /**
+     * @brief 像素总数
+     */
+    int32_t area() const {
+        int32_t total = 0;
+        for (uint8_t i = 0; i < _count; i++) total += (int32_t)_rects[i].w * _rects[i].h;
+        return total;
+    }
+
+private:
+    // 相交或边相接
+    static bool touches(const Rect &a, const Rect &b) {
+        return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+    }
+
+    static Rect unite(const Rect &a, const Rect &b) {
+        int16_t x0 = a.x < b.x ? a.x : b.x;
+        int16_t y0 = a.y < b.y ? a.y : b.y;
+        int16_t x1 = a.x + a.w > b.x + b.w ? a.x + a.w : b.x + b.w;
+        int16_t y1 = a.y + a.h > b.y + b.h ? a.y + a.h : b.y + b.h;
+        return Rect{x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+    }
+
+    // 合并后比分别推送多出的像素（重叠部分按一次计）
+    static int32_t waste(const Rect &a, const Rect &b) {
+        Rect u = unite(a, b);
+        int32_t ow = (a.x + a.w < b.x + b.w ? a.x + a.w : b.x + b.w) - (a.x > b.x ? a.x : b.x);
+        int32_t oh = (a.y + a.h < b.y + b.h ? a.y + a.h : b.y + b.h) - (a.y > b.y ? a.y : b.y);
+        int32_t overlap = (ow > 0 && oh > 0) ? ow * oh : 0;
+        return (int32_t)u.w * u.h - ((int32_t)a.w * a.h + (int32_t)b.w * b.h - overlap);
+    }
+
+    Rect _rects[CAPACITY];
+    uint8_t _count;
+};
+
+#endif // DIRTY_REGIONS_H
@@ -0,0 +1,77 @@
+/**
+ * @file DisplayModel.h
+ * @brief 显示模型：计算器核心与渲染侧之间按值传递的界面状态
+ * @details 核心每次更新填好一个完整的DisplayModel交给CalcDisplay::publish()：
+ * - 只有定长字符数组和整数，可以直接复制，不涉及String和动态内存
+ * - 核心只描述"显示什么"（各行文本、状态、浏览位置），不再调用动画接口；
+ *   渲染侧逐字段比较上一个和新的模型，决定重绘哪些行、滚动哪些行、播放哪种动画
+ * - 整屏重绘请求用单调递增的redrawSeq表示，中间的模型被跳过时请求也不会丢
+ * - 不依赖显示驱动，主机构建同样可用
+ *
+ * @author Calculator Project
+ */
+
+#ifndef DISPLAY_MODEL_H
+#define DISPLAY_MODEL_H
+
+#include <stdint.h>
+#include <string.h>
+
+struct DisplayModel {
+    static const uint8_t LINE_COUNT = 4;
+    static const uint8_t TEXT_LEN = 64;             ///< 每行最大字节数（超出部分已在屏幕外）
+    static const uint8_t INDICATOR_LEN = 8;         ///< 指示文本最大字节数
+
+    // 行序号：L0较旧的历史，L1最新历史或实时预览，L2表达式，L3结果
+    enum Line : uint8_t {
+        LINE_OLDER,
+        LINE_LATEST,
+        LINE_EXPR,
+        LINE_RESULT
+    };
+
+    enum State : uint8_t {
+        STATE_RESULT,       ///< 显示结果或其他静态内容（默认）
+        STATE_INPUT,        ///< 正在输入数字：结果行变化时滑入
+        STATE_OPERATOR,     ///< 刚输入运算符：表达式行变化时从结果行上移
+        STATE_ERROR,        ///< 结果行显示错误信息
+        STATE_BROWSE,       ///< 浏览历史：表达式行改用历史颜色，L0~L2作为列表逐行滚动
+        STATE_EDIT          ///< 光标在表达式中间：表达式行是含光标的一段，不播放动画
+    };
+
+    char text[LINE_COUNT][TEXT_LEN];
+    char indicator[INDICATOR_LEN];                  ///< 表达式行右侧的小字指示（如内存寄存器"M2"）
+    uint8_t state;                                  ///< State
+    uint8_t error;                                  ///< STATE_ERROR时的CalculatorError，渲染侧据此复用预渲染的错误信息
+    uint16_t historyCursor;                         ///< 浏览时所选记录的序号（0为最新）
+    uint16_t historyCount;                          ///< 浏览时的记录总数
+    uint8_t exprScroll;                             ///< 表达式行显示的一段在完整表达式中的起点，渲染侧按变化量平移字形
+    uint32_t redrawSeq;                             ///< 整屏重绘请求计数，与上一个模型不同即整屏重绘
+
+    DisplayModel() : state(STATE_RESULT), error(0), historyCursor(0), historyCount(0), exprScroll(0), redrawSeq(0) {
+        memset(text, 0, sizeof(text));
+        indicator[0] = '\0';
+    }
+
+    void setText(uint8_t line, const char *value) {
+        if (line >= LINE_COUNT) return;
+        copy(text[line], value, TEXT_LEN);
+    }
+
+    void setIndicator(const char *value) {
+        copy(indicator, value, INDICATOR_LEN);
+    }
+
+    bool isBrowsing() const { return state == STATE_BROWSE; }
+
+private:
+    static void copy(char *dst, const char *src, uint8_t size) {
+        uint8_t length = 0;
+        for (; src && length < size - 1 && src[length]; length++) {
+            dst[length] = src[length];
+        }
+        dst[length] = '\0';
+    }
+};
+
+#endif // DISPLAY_MODEL_H
@@ -0,0 +1,49 @@
+/**
+ * @file DisplayTheme.h
+ * @brief 显示主题：界面颜色按角色组成的小调色板
+ * @details 界面各处只记录颜色角色（ThemeColor），绘制时经当前主题的调色板取实际RGB565值：
+ * - 切换主题只替换调色板表，不需要重启或重建界面
+ * - 字形缓存保存覆盖率，调色板变化后按需重新着色（GlyphAtlas::setPalette）
+ * - 索引0为背景色：调色板Canvas的缓冲清零即为清屏
+ *
+ * @author Calculator Project
+ */
+
+#ifndef DISPLAY_THEME_H
+#define DISPLAY_THEME_H
+
+#include <stdint.h>
+#include <string.h>
+
+enum ThemeColor : uint8_t {
+    THEME_BG,           ///< 背景
+    THEME_FG,           ///< 表达式、结果、激活的状态图标
+    THEME_HIST,         ///< 历史、浏览中的表达式、指示文本、未激活的状态图标
+    THEME_COLOR_COUNT
+};
+
+struct DisplayTheme {
+    const char *name;
+    uint16_t colors[THEME_COLOR_COUNT];     ///< 按ThemeColor索引的RGB565
+};
+
+static const DisplayTheme DISPLAY_THEMES[] = {
+    {"dark",  {0x0000, 0xFFFF, 0x4208}},    // 黑底白字，灰色历史（默认）
+    {"light", {0xFFFF, 0x0000, 0x8410}},    // 白底黑字
+    {"amber", {0x0000, 0xFD20, 0x7A00}},    // 琥珀色
+    {"green", {0x0000, 0x07E0, 0x0300}},    // 绿色磷光屏
+};
+static const uint8_t DISPLAY_THEME_COUNT = sizeof(DISPLAY_THEMES) / sizeof(DISPLAY_THEMES[0]);
+
+/**
+ * @brief 按名称查找主题
+ * @return 主题索引，找不到返回-1
+ */
+inline int8_t findDisplayTheme(const char *name) {
+    for (uint8_t i = 0; i < DISPLAY_THEME_COUNT; i++) {
+        if (strcmp(DISPLAY_THEMES[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+#endif // DISPLAY_THEME_H
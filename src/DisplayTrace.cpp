@@ -0,0 +1,269 @@
+/**
+ * @file DisplayTrace.cpp
+ * @brief 显示更新录制与回放基准实现
+ *
+ * @author Calculator Project
+ */
+
+#include "DisplayTrace.h"
+#include "RegionCanvas.h"
+#include "PerformanceMonitor.h"
+#include "Console.h"
+#include "Logger.h"
+#include "BufferPlacement.h"
+#include <esp_timer.h>
+
+#define TAG_TRACE_DISPLAY "DispTrace"
+
+extern RegionCanvas *canvas;
+
+namespace {
+
+const char* const BACKEND_NAMES[] = {"full", "dirty", "glyph"};
+
+void cmdDisplayTrace(const ConsoleArgs& args) {
+    DisplayTrace& trace = DisplayTrace::instance();
+    if (args.is(1, "start")) {
+        if (trace.start()) Serial.println("开始录制显示更新");
+    } else if (args.is(1, "stop")) {
+        trace.stop();
+        Serial.printf("录制已停止: %u 次提交, %u 字节\n", trace.count(), (unsigned)trace.size());
+    } else if (args.is(1, "clear")) {
+        trace.clear();
+        Serial.println("录制内容已清除");
+    } else if (args.is(1, "dump")) {
+        trace.dump(Serial);
+    } else if (args.count < 2) {
+        Serial.printf("%s: %u 次提交, %u/%u 字节\n", trace.isRecording() ? "录制中" : "已停止",
+                      trace.count(), (unsigned)trace.size(), (unsigned)DisplayTrace::CAPACITY);
+    } else {
+        Serial.println("用法: display_trace [start|stop|clear|dump]");
+    }
+}
+
+void printReplay(const char* name, const DisplayTrace::ReplayResult& r) {
+    Serial.printf(" - %-5s 总耗时 %7u us  推送 %7u 字节/%4u 次  绘制 %7u us  推送 %7u us%s\n", name,
+                  r.totalUs, r.spiBytes, r.frames, r.drawUs, r.flushUs, r.complete ? "" : "  (超时)");
+}
+
+void cmdDisplayReplay(const ConsoleArgs& args) {
+    DisplayTrace& trace = DisplayTrace::instance();
+    int only = -1;
+    for (uint8_t b = 0; b < 3; b++) {
+        if (args.is(1, BACKEND_NAMES[b])) only = b;
+    }
+    if (args.count > 1 && only < 0) {
+        Serial.println("用法: display_replay [full|dirty|glyph]");
+        return;
+    }
+
+    Serial.printf("回放 %u 次提交（%u 字节）:\n", trace.count(), (unsigned)trace.size());
+    for (uint8_t b = 0; b < 3; b++) {
+        if (only >= 0 && only != b) continue;
+        DisplayTrace::ReplayResult result;
+        if (!trace.replay((CalcDisplay::RenderBackend)b, result)) {
+            Serial.println("没有可回放的录制内容（先 display_trace start/stop）");
+            return;
+        }
+        printReplay(BACKEND_NAMES[b], result);
+    }
+}
+
+constexpr ConsoleCommand TRACE_COMMANDS[] = {
+    {"display_replay", "[full|dirty|glyph]", "回放录制的显示更新，比较各绘制方式的耗时和推送字节数", cmdDisplayReplay},
+    {"display_trace", "[start|stop|clear|dump]", "录制显示更新（无参数时显示录制状态）", cmdDisplayTrace},
+};
+static_assert(consoleSorted(TRACE_COMMANDS), "命令表必须按名称排序");
+
+uint8_t putVarint(uint8_t* p, uint32_t value) {
+    uint8_t n = 0;
+    while (value >= 0x80) {
+        p[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (uint8_t)value;
+    return n;
+}
+
+uint32_t getVarint(const uint8_t*& p) {
+    uint32_t value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint8_t b = *p++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+    return value;
+}
+
+} // namespace
+
+DisplayTrace::DisplayTrace()
+    : _display(nullptr),
+      _buffer(nullptr),
+      _used(0),
+      _count(0),
+      _lastTime(0),
+      _recording(false),
+      _last() {
+}
+
+void DisplayTrace::begin(CalcDisplay* display) {
+    _display = display;
+    Console::instance().addCommands(TRACE_COMMANDS);
+}
+
+bool DisplayTrace::start() {
+    if (!_buffer) {
+        _buffer = (uint8_t*)placedAlloc("display_trace", CAPACITY, PLACE_PSRAM);
+        if (!_buffer) {
+            LOG_W(TAG_TRACE_DISPLAY, "录制缓冲分配失败");
+            return false;
+        }
+    }
+    _used = 0;
+    _count = 0;
+    _recording = true;
+    return true;
+}
+
+void DisplayTrace::clear() {
+    _recording = false;
+    _used = 0;
+    _count = 0;
+    if (_buffer) {
+        placedFree(_buffer);
+        _buffer = nullptr;
+    }
+}
+
+const char* DisplayTrace::field(const DisplayModel& model, uint8_t i) const {
+    return i < 4 ? model.text[i] : model.indicator;
+}
+
+char* DisplayTrace::field(DisplayModel& model, uint8_t i) {
+    return i < 4 ? model.text[i] : model.indicator;
+}
+
+size_t DisplayTrace::fieldSize(uint8_t i) const {
+    return i < 4 ? CalcDisplay::TEXT_LEN : CalcDisplay::INDICATOR_LEN;
+}
+
+void DisplayTrace::record(const CalcDisplay& display) {
+    if (!_recording) return;
+
+    const DisplayModel& staged = display._staged;
+    uint8_t flags = 0;
+    size_t bytes = 1 + 5;
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+        if (_count == 0 || strcmp(field(staged, i), field(_last, i)) != 0) {
+            flags |= 1 << i;
+            bytes += 1 + strlen(field(staged, i));
+        }
+    }
+    if (_count == 0 || staged.redrawSeq != _last.redrawSeq) flags |= FLAG_FULL_REDRAW;
+    flags |= CalcDisplay::animationFor(_last, staged) << ANIM_SHIFT;
+
+    // 内容没有变化的提交回放时什么也不做，不记录
+    if (flags == 0) return;
+
+    if (_used + bytes > CAPACITY) {
+        _recording = false;
+        LOG_W(TAG_TRACE_DISPLAY, "录制缓冲已满，停止录制（%u 次提交）", _count);
+        return;
+    }
+
+    uint32_t now = millis();
+    uint8_t* p = _buffer + _used;
+    *p++ = flags;
+    p += putVarint(p, _count ? now - _lastTime : 0);
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+        if (!(flags & (1 << i))) continue;
+        const char* text = field(staged, i);
+        uint8_t len = strlen(text);
+        *p++ = len;
+        memcpy(p, text, len);
+        p += len;
+        memcpy(field(_last, i), text, len + 1);
+    }
+    _last.state = staged.state;
+    _last.redrawSeq = staged.redrawSeq;
+    _used = p - _buffer;
+    _lastTime = now;
+    _count++;
+}
+
+bool DisplayTrace::replay(CalcDisplay::RenderBackend backend, ReplayResult& result) {
+    memset(&result, 0, sizeof(result));
+    if (!_display || !_buffer || _count == 0 || _recording) return false;
+
+    CalcDisplay& display = *_display;
+    CalcDisplay::RenderBackend savedBackend = display.getRenderBackend();
+    uint32_t savedInterval = display._frameIntervalMs;
+    DisplayModel saved = display._staged;
+
+    // 不限帧率，每次提交都完整绘制并推送；先等手上的内容处理完
+    display.setRenderBackend(backend);
+    display._frameIntervalMs = 0;
+    display.waitIdle(COMMIT_TIMEOUT_MS);
+
+    PerformanceMonitor* perf = display.getPerformanceMonitor();
+    perf->reset();
+    uint32_t bytesBefore = canvas ? canvas->getFlushedBytes() : 0;
+
+    result.complete = true;
+    DisplayModel model = saved;
+    const uint8_t* p = _buffer;
+    const uint8_t* end = _buffer + _used;
+    int64_t start = esp_timer_get_time();
+
+    while (p < end) {
+        uint8_t flags = *p++;
+        getVarint(p);
+        for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+            if (!(flags & (1 << i))) continue;
+            uint8_t len = *p++;
+            char* text = field(model, i);
+            size_t copy = len < fieldSize(i) ? len : fieldSize(i) - 1;
+            memcpy(text, p, copy);
+            text[copy] = '\0';
+            p += len;
+        }
+        // 动画由显示器比较前后模型得出，按录制的动画还原对应的状态
+        switch (flags >> ANIM_SHIFT) {
+            case CalcDisplay::ANIM_INPUT_CHANGE: model.state = DisplayModel::STATE_INPUT; break;
+            case CalcDisplay::ANIM_MOVE_TO_EXPR: model.state = DisplayModel::STATE_OPERATOR; break;
+            default: model.state = DisplayModel::STATE_RESULT; break;
+        }
+
+        model.redrawSeq = display._staged.redrawSeq;
+        display._staged = model;
+        if (flags & FLAG_FULL_REDRAW) display.invalidateAll();
+        display.refresh();
+        result.complete &= display.waitIdle(COMMIT_TIMEOUT_MS);
+        result.commits++;
+    }
+
+    result.totalUs = (uint32_t)(esp_timer_get_time() - start);
+    result.spiBytes = (canvas ? canvas->getFlushedBytes() : 0) - bytesBefore;
+
+    static PerfHistogram input, draw, flush, stages[PERF_STAGE_COUNT];
+    perf->snapshot(input, draw, flush, stages);
+    result.frames = flush.getCount();
+    result.drawUs = draw.getAvg() * draw.getCount();
+    result.flushUs = flush.getAvg() * flush.getCount();
+
+    // 恢复回放前的内容和设置
+    display.invalidateAll();
+    display.publish(saved);
+    display.waitIdle(COMMIT_TIMEOUT_MS);
+    display.setRenderBackend(savedBackend);
+    display._frameIntervalMs = savedInterval;
+    return true;
+}
+
+void DisplayTrace::dump(Print& out) const {
+    out.printf("# display trace: %u commits, %u bytes\n", _count, (unsigned)_used);
+    for (size_t i = 0; i < _used; i++) {
+        out.printf("%02X%s", _buffer[i], (i % 32 == 31 || i + 1 == _used) ? "\n" : "");
+    }
+}
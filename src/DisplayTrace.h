@@ -0,0 +1,94 @@
+/**
+ * @file DisplayTrace.h
+ * @brief 显示更新录制与回放基准
+ * @details 录制真实使用中每次refresh()提交的内容，回放时比较不同绘制方式的开销：
+ * - 录制在refresh()入口进行，updateExprDirect/updateResultDirect/updateHistoryDirect等
+ *   写入的暂存内容随下一次refresh()一起记录，只记变化的行
+ * - 每条记录：1字节标志（低5位为变化的L0~L3和指示，bit5整屏重绘，bit6-7动画）、
+ *   距上一条的毫秒数（变长整数）、每个变化字段的长度和文本
+ * - 第一条记录包含全部字段和整屏重绘，回放总从相同的画面开始
+ * - 回放不按录制的间隔等待，每次提交后等到绘制、推送和动画完成，
+ *   统计总耗时、SPI推送字节数以及绘制/推送时间
+ * - 串口命令 display_trace 控制录制，display_replay 回放
+ *
+ * @author Calculator Project
+ */
+
+#ifndef DISPLAY_TRACE_H
+#define DISPLAY_TRACE_H
+
+#include <Arduino.h>
+#include "calc_display.h"
+
+class DisplayTrace {
+public:
+    static const size_t CAPACITY = 16384;           ///< 录制缓冲大小（优先PSRAM）
+
+    struct ReplayResult {
+        uint32_t commits;       ///< 回放的提交次数
+        uint32_t totalUs;       ///< 回放总耗时
+        uint32_t spiBytes;      ///< 推送到屏幕的字节数
+        uint32_t frames;        ///< 推送次数
+        uint32_t drawUs;        ///< 绘制时间合计
+        uint32_t flushUs;       ///< 推送时间合计
+        bool complete;          ///< 所有提交都在超时前完成
+    };
+
+    static DisplayTrace& instance() {
+        static DisplayTrace instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册串口命令
+     * @param display 回放目标
+     */
+    void begin(CalcDisplay* display);
+
+    bool start();               ///< 清空并开始录制
+    void stop() { _recording = false; }
+    void clear();
+    bool isRecording() const { return _recording; }
+    size_t size() const { return _used; }
+    uint32_t count() const { return _count; }
+
+    /**
+     * @brief 录制一次提交（CalcDisplay::refresh()调用，未录制时立即返回）
+     */
+    void record(const CalcDisplay& display);
+
+    /**
+     * @brief 以指定绘制方式回放录制内容
+     * @return 没有录制内容或正在录制时返回false
+     */
+    bool replay(CalcDisplay::RenderBackend backend, ReplayResult& result);
+
+    /**
+     * @brief 以十六进制输出录制内容，便于保存到电脑
+     */
+    void dump(Print& out) const;
+
+private:
+    static const uint8_t FIELD_COUNT = 5;           ///< L0~L3和指示
+    static const uint8_t FLAG_FULL_REDRAW = 1 << 5;
+    static const uint8_t ANIM_SHIFT = 6;
+    static const uint32_t COMMIT_TIMEOUT_MS = 1000;
+
+    DisplayTrace();
+    DisplayTrace(const DisplayTrace&) = delete;
+    DisplayTrace& operator=(const DisplayTrace&) = delete;
+
+    const char* field(const DisplayModel& model, uint8_t i) const;
+    char* field(DisplayModel& model, uint8_t i);
+    size_t fieldSize(uint8_t i) const;
+
+    CalcDisplay* _display;
+    uint8_t* _buffer;
+    size_t _used;
+    uint32_t _count;
+    uint32_t _lastTime;
+    bool _recording;
+    DisplayModel _last;                             ///< 上一条记录后的内容，只记录变化
+};
+
+#endif // DISPLAY_TRACE_H
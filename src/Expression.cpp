@@ -0,0 +1,310 @@
+/**
+ * @file Expression.cpp
+ * @brief 带优先级和括号的表达式实现
+ *
+ * @author Calculator Project
+ */
+
+#include "Expression.h"
+#include "CalcBackend.h"
+#include <string.h>
+
+Expression::Expression() {
+    clear();
+}
+
+void Expression::clear() {
+    _count = 0;
+    _tail = MAX_TOKENS;
+    resetState(_live);
+    _checkpoints[0] = _live;
+}
+
+bool Expression::needsOperandAfter(const ExprToken *token) {
+    return !token || token->type == ExprTokenType::OPERATOR || token->type == ExprTokenType::LPAREN;
+}
+
+bool Expression::pushNumber(double value, uint8_t textLength) {
+    bool implicitMul = !expectsOperand();
+    if (_count + (implicitMul ? 2 : 1) > _tail) return false;
+
+    if (implicitMul) {
+        append({ExprTokenType::OPERATOR, Operator::MULTIPLY, 0, 0.0});
+    }
+    return append({ExprTokenType::NUMBER, Operator::NONE, textLength, value});
+}
+
+bool Expression::pushOperator(Operator op) {
+    if (expectsOperand() || precedence(op) == 0) return false;
+    return append({ExprTokenType::OPERATOR, op, 1, 0.0});
+}
+
+bool Expression::replaceLastOperator(Operator op) {
+    if (!lastIsOperator() || precedence(op) == 0) return false;
+
+    // 只有最后一个记号变化，从检查点重放即可
+    truncate(_count - 1);
+    return append({ExprTokenType::OPERATOR, op, 1, 0.0});
+}
+
+bool Expression::openParen() {
+    if (_live.openDepth >= MAX_PAREN_DEPTH) return false;
+
+    bool implicitMul = !expectsOperand();
+    if (_count + (implicitMul ? 2 : 1) > _tail) return false;
+
+    if (implicitMul) {
+        append({ExprTokenType::OPERATOR, Operator::MULTIPLY, 0, 0.0});
+    }
+    return append({ExprTokenType::LPAREN, Operator::NONE, 1, 0.0});
+}
+
+bool Expression::closeParen() {
+    if (_live.openDepth == 0 || expectsOperand()) return false;
+    return append({ExprTokenType::RPAREN, Operator::NONE, 1, 0.0});
+}
+
+uint8_t Expression::removeLast() {
+    if (_count == 0) return 0;
+
+    uint8_t n = _count - 1;
+    uint8_t removed = _tokens[n].textLength;
+
+    // 连同插入的隐式乘法一起删除
+    if (_tokens[n].type != ExprTokenType::OPERATOR && n > 0 &&
+        _tokens[n - 1].type == ExprTokenType::OPERATOR && _tokens[n - 1].textLength == 0) {
+        n--;
+    }
+
+    truncate(n);
+    return removed;
+}
+
+void Expression::moveCursor(uint8_t position) {
+    if (position > size()) position = size();
+
+    if (position < _count) {
+        // 左移：越过的记号整体搬到间隙之后，前面的求值状态从检查点重放
+        uint8_t moved = _count - position;
+        _tail -= moved;
+        memmove(&_tokens[_tail], &_tokens[position], moved * sizeof(ExprToken));
+        truncate(position);
+    }
+    while (_count < position) {
+        // 右移：逐个搬回间隙之前并推进求值，经过的检查点随之更新
+        ExprToken token = _tokens[_tail++];
+        append(token);
+    }
+}
+
+uint8_t Expression::textOffset() const {
+    uint8_t offset = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        offset += _tokens[i].textLength;
+    }
+    return offset;
+}
+
+bool Expression::isConsistent() const {
+    if (atEnd()) return true;
+
+    ExprTokenType next = _tokens[_tail].type;
+    bool startsOperand = next == ExprTokenType::NUMBER || next == ExprTokenType::LPAREN;
+    if (startsOperand != expectsOperand()) return false;
+
+    uint8_t depth = _live.openDepth;
+    for (uint8_t i = _tail; i < MAX_TOKENS; i++) {
+        if (_tokens[i].type == ExprTokenType::LPAREN) {
+            if (++depth > MAX_PAREN_DEPTH) return false;
+        } else if (_tokens[i].type == ExprTokenType::RPAREN) {
+            if (depth == 0) return false;
+            depth--;
+        }
+    }
+    return true;
+}
+
+bool Expression::restore(uint8_t keep, const ExprToken *tokens, uint8_t count) {
+    if (keep > size() || keep + count > MAX_TOKENS) return false;
+
+    // 光标之后的记号只有前keep个以内的需要保留
+    if (keep < _count) {
+        truncate(keep);
+    } else {
+        moveCursor(keep);
+    }
+    _tail = MAX_TOKENS;
+    for (uint8_t i = 0; i < count; i++) {
+        append(tokens[i]);
+    }
+    return true;
+}
+
+CalculatorError Expression::evaluate(double &out) const {
+    if (_live.error != CalculatorError::NONE) return _live.error;
+
+    // 在副本上走完光标之后的记号再合并，已推进的状态保持不变
+    EvalState state = _live;
+    stepSuffix(state);
+    if (state.error != CalculatorError::NONE) return state.error;
+    if (needsOperandAfter(isEmpty() ? nullptr : &tokenAt(size() - 1))) return CalculatorError::SYNTAX_ERROR;
+    return fold(state, out);
+}
+
+CalculatorError Expression::preview(double operand, bool hasOperand, double &out) const {
+    if (_live.error != CalculatorError::NONE) return _live.error;
+
+    EvalState state = _live;
+    stepSuffix(state);
+    if (hasOperand && atEnd()) {
+        if (!expectsOperand()) {
+            step(state, {ExprTokenType::OPERATOR, Operator::MULTIPLY, 0, 0.0});
+        }
+        step(state, {ExprTokenType::NUMBER, Operator::NONE, 0, operand});
+    } else {
+        // 末尾的运算符和'('都还在栈顶，直接弹出；光标不在末尾时正在输入的数字还没有位置，不计入
+        for (int i = size() - 1; i >= 0 && state.opCount > 0; i--) {
+            ExprTokenType type = tokenAt(i).type;
+            if (type != ExprTokenType::OPERATOR && type != ExprTokenType::LPAREN) break;
+            state.opCount--;
+        }
+    }
+    if (state.valueCount == 0) return CalculatorError::SYNTAX_ERROR;
+    return fold(state, out);
+}
+
+bool Expression::append(const ExprToken &token) {
+    if (_count >= _tail) return false;
+
+    _tokens[_count++] = token;
+    step(_live, token);
+
+    if (_count % CHECKPOINT_INTERVAL == 0 && _count / CHECKPOINT_INTERVAL < CHECKPOINT_COUNT) {
+        _checkpoints[_count / CHECKPOINT_INTERVAL] = _live;
+    }
+    return true;
+}
+
+void Expression::truncate(uint8_t count) {
+    if (count >= _count) return;
+
+    // 检查点之前的记号没有变化，只重放其后的部分
+    uint8_t start = (count / CHECKPOINT_INTERVAL) * CHECKPOINT_INTERVAL;
+    _live = _checkpoints[start / CHECKPOINT_INTERVAL];
+    for (uint8_t i = start; i < count; i++) {
+        step(_live, _tokens[i]);
+    }
+    _count = count;
+}
+
+void Expression::stepSuffix(EvalState &state) const {
+    for (uint8_t i = _tail; i < MAX_TOKENS; i++) {
+        step(state, _tokens[i]);
+    }
+}
+
+void Expression::resetState(EvalState &state) {
+    state.valueCount = 0;
+    state.opCount = 0;
+    state.openDepth = 0;
+    state.error = CalculatorError::NONE;
+}
+
+void Expression::step(EvalState &state, const ExprToken &token) {
+    if (state.error != CalculatorError::NONE) return;
+
+    switch (token.type) {
+        case ExprTokenType::NUMBER:
+            if (state.valueCount >= STACK_DEPTH) {
+                state.error = CalculatorError::MEMORY_ERROR;
+                return;
+            }
+            state.values[state.valueCount++] = token.value;
+            break;
+
+        case ExprTokenType::OPERATOR:
+            // 先算掉栈顶优先级不低于当前运算符的部分（左结合）
+            while (state.opCount > 0 && state.error == CalculatorError::NONE &&
+                   state.ops[state.opCount - 1] != Operator::NONE &&
+                   precedence(state.ops[state.opCount - 1]) >= precedence(token.op)) {
+                reduce(state);
+            }
+            if (state.opCount >= STACK_DEPTH) {
+                state.error = CalculatorError::MEMORY_ERROR;
+                return;
+            }
+            state.ops[state.opCount++] = token.op;
+            break;
+
+        case ExprTokenType::LPAREN:
+            if (state.opCount >= STACK_DEPTH) {
+                state.error = CalculatorError::MEMORY_ERROR;
+                return;
+            }
+            state.ops[state.opCount++] = Operator::NONE;
+            state.openDepth++;
+            break;
+
+        case ExprTokenType::RPAREN:
+            while (state.opCount > 0 && state.error == CalculatorError::NONE &&
+                   state.ops[state.opCount - 1] != Operator::NONE) {
+                reduce(state);
+            }
+            if (state.opCount > 0 && state.error == CalculatorError::NONE) {
+                state.opCount--;
+                state.openDepth--;
+            }
+            break;
+    }
+}
+
+void Expression::reduce(EvalState &state) {
+    if (state.valueCount < 2 || state.opCount == 0) {
+        state.error = CalculatorError::SYNTAX_ERROR;
+        return;
+    }
+
+    Operator op = state.ops[--state.opCount];
+    double right = state.values[--state.valueCount];
+    double left = state.values[state.valueCount - 1];
+
+    double result = 0.0;
+    CalculatorError error = CalcBackend::apply(left, right, op, result);
+    if (error != CalculatorError::NONE) {
+        state.error = error;
+        return;
+    }
+    state.values[state.valueCount - 1] = result;
+}
+
+CalculatorError Expression::fold(EvalState &state, double &out) {
+    // 未闭合的'('直接丢弃
+    while (state.opCount > 0 && state.error == CalculatorError::NONE) {
+        if (state.ops[state.opCount - 1] == Operator::NONE) {
+            state.opCount--;
+        } else {
+            reduce(state);
+        }
+    }
+    if (state.error != CalculatorError::NONE) return state.error;
+    if (state.valueCount != 1) return CalculatorError::SYNTAX_ERROR;
+
+    out = state.values[0];
+    return CalculatorError::NONE;
+}
+
+uint8_t Expression::precedence(Operator op) {
+    switch (op) {
+        case Operator::ADD:
+        case Operator::SUBTRACT:
+            return 1;
+        case Operator::MULTIPLY:
+        case Operator::DIVIDE:
+        case Operator::PERCENT:
+            return 2;
+        case Operator::POWER:
+            return 3;
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,212 @@
+/**
+ * @file Expression.h
+ * @brief 带优先级和括号的表达式
+ * @details 表达式保存为固定容量的记号数组，按调度场算法（shunting-yard）求值：
+ * - 乘方优先于乘除，乘除优先于加减，同级从左到右（2^3^2 = 64）
+ * - 支持括号嵌套，")("、"2(" 之间按隐式乘法处理
+ * - 每追加一个记号即推进一步求值，'=' 时只需合并剩余的栈
+ * - 每 CHECKPOINT_INTERVAL 个记号保存一次求值状态，删除或替换末尾记号时
+ *   从最近的检查点重放，只重新计算变化的后缀
+ * - 记号数组是一个间隙缓冲：光标之前的记号在数组开头，之后的在数组末尾，中间为空闲。
+ *   追加、删除、替换都作用于光标处；求值状态只推进到光标，
+ *   evaluate()/preview()从这里接着走一遍光标之后的记号，在中间编辑时不重算前面的部分
+ *
+ * 所有存储都在对象内部，不分配堆内存。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <stdint.h>
+#include "CalculatorCore.h"
+#include "KeyboardConfig.h"
+
+/**
+ * @brief 表达式记号类型
+ */
+enum class ExprTokenType : uint8_t {
+    NUMBER,         ///< 数字
+    OPERATOR,       ///< 二元运算符
+    LPAREN,         ///< 左括号
+    RPAREN          ///< 右括号
+};
+
+/**
+ * @brief 表达式记号
+ */
+struct ExprToken {
+    ExprTokenType type;     ///< 记号类型
+    Operator op;            ///< 运算符（仅OPERATOR）
+    uint8_t textLength;     ///< 在表达式文本中占用的字符数（隐式乘法为0）
+    double value;           ///< 数值（仅NUMBER）
+};
+
+class Expression {
+public:
+    static const uint8_t MAX_TOKENS = 64;           ///< 最大记号数
+    static const uint8_t MAX_PAREN_DEPTH = 6;       ///< 最大括号嵌套层数
+    static const uint8_t CHECKPOINT_INTERVAL = 8;   ///< 求值检查点间隔（记号数）
+
+    Expression();
+
+    /**
+     * @brief 清空表达式
+     */
+    void clear();
+
+    /**
+     * @brief 追加数字，前一个记号为数字或')'时先插入隐式乘法
+     * @param value 数值
+     * @param textLength 数字在表达式文本中的长度
+     * @return 记号已满时返回false
+     */
+    bool pushNumber(double value, uint8_t textLength);
+
+    /**
+     * @brief 追加二元运算符
+     * @return 当前位置需要操作数或记号已满时返回false
+     */
+    bool pushOperator(Operator op);
+
+    /**
+     * @brief 把末尾的运算符替换为op
+     * @return 末尾不是运算符时返回false
+     */
+    bool replaceLastOperator(Operator op);
+
+    /**
+     * @brief 追加'('，前一个记号为数字或')'时先插入隐式乘法
+     * @return 嵌套过深或记号已满时返回false
+     */
+    bool openParen();
+
+    /**
+     * @brief 追加')'
+     * @return 没有未闭合的'('或当前位置需要操作数时返回false
+     */
+    bool closeParen();
+
+    /**
+     * @brief 删除光标前的记号（以及它前面的隐式乘法）
+     * @return 删除的记号在表达式文本中占用的字符数
+     */
+    uint8_t removeLast();
+
+    /**
+     * @brief 删除光标前从第position个起的全部记号，光标之后的不变
+     */
+    void removeFrom(uint8_t position) { truncate(position); }
+
+    /**
+     * @brief 把光标移到前position个记号之后（超出时移到末尾）
+     * @details 越过的记号在间隙两侧之间搬动；左移从检查点重放，右移逐个推进求值
+     */
+    void moveCursor(uint8_t position);
+
+    uint8_t cursor() const { return _count; }
+    bool atEnd() const { return _tail == MAX_TOKENS; }
+
+    /**
+     * @brief 光标在表达式文本中的位置（光标之前记号的文本长度之和）
+     */
+    uint8_t textOffset() const;
+
+    /**
+     * @brief 光标两侧能否衔接：光标前需要操作数时光标后须以数字或'('开始，否则以运算符或')'开始；
+     *        光标之后的')'都有对应的'('，嵌套不超过MAX_PAREN_DEPTH
+     */
+    bool isConsistent() const;
+
+    /**
+     * @brief 保留前keep个记号，再依次追加tokens（撤销/重做时恢复记号序列）
+     * @details 只重放检查点之后和新追加的记号，不重新求值整个表达式；之后光标在末尾
+     * @return keep超过现有记号数或记号放不下时返回false
+     */
+    bool restore(uint8_t keep, const ExprToken *tokens, uint8_t count);
+
+    /**
+     * @brief 计算整个表达式，未闭合的括号自动闭合
+     * @param out 计算结果
+     * @return 错误类型；表达式以运算符或'('结尾时返回SYNTAX_ERROR
+     */
+    CalculatorError evaluate(double &out) const;
+
+    /**
+     * @brief 计算实时预览值
+     * @param operand 正在输入的操作数
+     * @param hasOperand 是否把operand视为追加在末尾的数字
+     * @param out 预览值
+     * @return 错误类型；没有可计算的内容时返回SYNTAX_ERROR
+     * @details 从已推进的求值状态出发：追加operand，或忽略末尾的运算符和'('，
+     *          再合并栈。开销只与栈深有关，与表达式长度无关
+     */
+    CalculatorError preview(double operand, bool hasOperand, double &out) const;
+
+    /**
+     * @brief 已推进部分的求值错误（如除以0）
+     */
+    CalculatorError getError() const { return _live.error; }
+
+    uint8_t size() const { return _count + (MAX_TOKENS - _tail); }
+    bool isEmpty() const { return size() == 0; }
+    const ExprToken *last() const { return _count ? &_tokens[_count - 1] : nullptr; }   ///< 光标前的记号
+    const ExprToken &tokenAt(uint8_t index) const {
+        return index < _count ? _tokens[index] : _tokens[_tail + (index - _count)];
+    }
+    uint8_t getOpenDepth() const { return _live.openDepth; }   ///< 光标处未闭合的'('数
+
+    /**
+     * @brief 光标处的下一个记号是否应为操作数（光标在开头或前面是运算符、'('）
+     */
+    bool expectsOperand() const { return needsOperandAfter(last()); }
+
+    /**
+     * @brief 前position个记号之后是否应为操作数（光标可以停留、插入"数字 运算符"的位置）
+     */
+    bool expectsOperandAt(uint8_t position) const {
+        return needsOperandAfter(position ? &tokenAt(position - 1) : nullptr);
+    }
+
+    /**
+     * @brief 光标前是否为运算符
+     */
+    bool lastIsOperator() const { return _count && _tokens[_count - 1].type == ExprTokenType::OPERATOR; }
+
+private:
+    static const uint8_t STACK_DEPTH = 4 * MAX_PAREN_DEPTH + 4;  ///< 每层括号最多压入3个值、3个运算符和'('
+    static const uint8_t CHECKPOINT_COUNT = MAX_TOKENS / CHECKPOINT_INTERVAL;
+
+    /**
+     * @brief 调度场算法的求值状态
+     */
+    struct EvalState {
+        double values[STACK_DEPTH];     ///< 操作数栈
+        Operator ops[STACK_DEPTH];      ///< 运算符栈（NONE表示'('）
+        uint8_t valueCount;
+        uint8_t opCount;
+        uint8_t openDepth;              ///< 未闭合的'('数
+        CalculatorError error;          ///< 第一个求值错误
+    };
+
+    bool append(const ExprToken &token);    // 在光标处插入记号并推进求值
+    void truncate(uint8_t count);           // 光标前只保留count个记号，从检查点重放
+
+    static bool needsOperandAfter(const ExprToken *token);      // token为nullptr表示开头
+    void stepSuffix(EvalState &state) const;                    // 从光标处的状态走完光标之后的记号
+
+    static void resetState(EvalState &state);
+    static void step(EvalState &state, const ExprToken &token);
+    static void reduce(EvalState &state);
+    static CalculatorError fold(EvalState &state, double &out);   // 合并剩余的栈
+    static uint8_t precedence(Operator op);
+
+    ExprToken _tokens[MAX_TOKENS];              ///< 间隙缓冲：[0, _count)在光标前，[_tail, MAX_TOKENS)在光标后
+    uint8_t _count;                             ///< 光标前的记号数
+    uint8_t _tail;                              ///< 光标后第一个记号的位置
+    EvalState _live;                            ///< 推进到光标处的求值状态
+    EvalState _checkpoints[CHECKPOINT_COUNT];   ///< 第k项为前k×CHECKPOINT_INTERVAL个记号的状态
+};
+
+#endif // EXPRESSION_H
@@ -0,0 +1,127 @@
+/**
+ * @file ExpressionParser.cpp
+ * @brief 表达式文本/记号流解析实现
+ *
+ * @author Calculator Project
+ */
+
+#include "ExpressionParser.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+inline bool isDigit(uint8_t c) {
+    return c >= '0' && c <= '9';
+}
+
+// 从p开始的数字文本长度：整数部分、小数部分、指数（e后必须有数字）
+size_t numberLength(const uint8_t* p, size_t length) {
+    size_t i = 0;
+    size_t digits = 0;
+    while (i < length && isDigit(p[i])) i++, digits++;
+    if (i < length && p[i] == '.') {
+        i++;
+        while (i < length && isDigit(p[i])) i++, digits++;
+    }
+    if (!digits) return 0;
+    if (i < length && (p[i] == 'e' || p[i] == 'E')) {
+        size_t j = i + 1;
+        if (j < length && (p[j] == '+' || p[j] == '-')) j++;
+        if (j < length && isDigit(p[j])) {
+            while (j < length && isDigit(p[j])) j++;
+            i = j;
+        }
+    }
+    return i;
+}
+
+} // namespace
+
+CalculatorError ExpressionParser::evaluate(Format format, const uint8_t* data, size_t length, size_t& consumed,
+                                           Expression& expression, double& out) {
+    size_t end;
+    if (format == TEXT) {
+        const uint8_t* newline = (const uint8_t*)memchr(data, END, length);
+        end = newline ? newline - data : length;
+    } else {
+        end = tokensEnd(data, length);
+    }
+    consumed = end < length ? end + 1 : length;
+
+    expression.clear();
+    bool ok = format == TEXT ? parseText(data, end, expression) : parseTokens(data, end, expression);
+    if (!ok || expression.isEmpty()) return CalculatorError::SYNTAX_ERROR;
+    return expression.evaluate(out);
+}
+
+bool ExpressionParser::pushOperator(uint8_t c, Expression& expression) {
+    switch (c) {
+        case '+': return expression.pushOperator(Operator::ADD);
+        case '-': return expression.pushOperator(Operator::SUBTRACT);
+        case '*': return expression.pushOperator(Operator::MULTIPLY);
+        case '/': return expression.pushOperator(Operator::DIVIDE);
+        case '^': return expression.pushOperator(Operator::POWER);
+        case '(': return expression.openParen();
+        case ')': return expression.closeParen();
+        default: return false;
+    }
+}
+
+bool ExpressionParser::parseText(const uint8_t* data, size_t length, Expression& expression) {
+    size_t i = 0;
+    while (i < length) {
+        uint8_t c = data[i];
+        if (c == ' ' || c == '\t' || c == '\r') {
+            i++;
+            continue;
+        }
+
+        // 操作数位置的'-'是负号，只能紧跟数字
+        bool negative = c == '-' && expression.expectsOperand();
+        size_t start = negative ? i + 1 : i;
+        size_t n = numberLength(data + start, length - start);
+        if (n) {
+            if (n >= MAX_NUMBER_TEXT) return false;
+            char text[MAX_NUMBER_TEXT];
+            memcpy(text, data + start, n);
+            text[n] = '\0';
+            double value = strtod(text, nullptr);
+            size_t textLength = start + n - i;
+            if (!expression.pushNumber(negative ? -value : value, textLength < 0xFF ? textLength : 0xFF)) {
+                return false;
+            }
+            i = start + n;
+            continue;
+        }
+        if (negative || !pushOperator(c, expression)) return false;
+        i++;
+    }
+    return true;
+}
+
+size_t ExpressionParser::tokensEnd(const uint8_t* data, size_t length) {
+    // 数字的8个字节可能恰好是'\n'，按记号跳过
+    size_t i = 0;
+    while (i < length && data[i] != END) {
+        i += data[i] == TOKEN_NUMBER ? 1 + sizeof(double) : 1;
+    }
+    return i < length ? i : length;
+}
+
+bool ExpressionParser::parseTokens(const uint8_t* data, size_t length, Expression& expression) {
+    size_t i = 0;
+    while (i < length) {
+        if (data[i] == TOKEN_NUMBER) {
+            if (length - i < 1 + sizeof(double)) return false;
+            double value;
+            memcpy(&value, data + i + 1, sizeof(double));
+            if (!expression.pushNumber(value, 0)) return false;
+            i += 1 + sizeof(double);
+            continue;
+        }
+        if (!pushOperator(data[i], expression)) return false;
+        i++;
+    }
+    return true;
+}
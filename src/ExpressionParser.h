@@ -0,0 +1,52 @@
+/**
+ * @file ExpressionParser.h
+ * @brief 把文本或二进制记号流解析为Expression并求值（主机批量求值用）
+ * @details 一批数据中的表达式以'\n'结尾，两种格式：
+ * - TEXT：十进制数（可带小数点和指数，操作数位置的'-'是数字的负号，-3^2 = 9）、+ - * / ^ 和括号，
+ *   空格、'\t'、'\r'忽略。"2(3+4)"按隐式乘法处理，与按键输入相同
+ * - TOKENS：'N' + double(8字节小端) 为数字，'+' '-' '*' '/' '^' '(' ')' 为对应记号，
+ *   主机已解析好数字时省去文本转换
+ * 解析直接推入调用方提供的Expression，不分配内存；求值与按键输入走同一条运算路径（CalcBackend）。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef EXPRESSION_PARSER_H
+#define EXPRESSION_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Expression.h"
+
+class ExpressionParser {
+public:
+    enum Format : uint8_t {
+        TEXT = 0,
+        TOKENS = 1
+    };
+
+    static const uint8_t TOKEN_NUMBER = 'N';        ///< TOKENS格式的数字记号
+    static const uint8_t END = '\n';                ///< 表达式结尾
+    static const uint8_t MAX_NUMBER_TEXT = 40;      ///< 文本数字的最大长度
+
+    /**
+     * @brief 解析一个表达式并求值
+     * @param format 数据格式
+     * @param data 从表达式开头起的数据
+     * @param length 剩余字节数，最后一个表达式可以没有结尾的'\n'
+     * @param consumed 本表达式占用的字节数（含'\n'），出错时也跳到表达式末尾
+     * @param expression 工作用的表达式，调用时清空
+     * @param out 结果
+     * @return 错误类型；无法识别的字符、记号过多或括号过深时返回SYNTAX_ERROR
+     */
+    static CalculatorError evaluate(Format format, const uint8_t* data, size_t length, size_t& consumed,
+                                    Expression& expression, double& out);
+
+private:
+    static bool parseText(const uint8_t* data, size_t length, Expression& expression);
+    static bool parseTokens(const uint8_t* data, size_t length, Expression& expression);
+    static bool pushOperator(uint8_t c, Expression& expression);
+    static size_t tokensEnd(const uint8_t* data, size_t length);
+};
+
+#endif // EXPRESSION_PARSER_H
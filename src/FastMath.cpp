@@ -0,0 +1,225 @@
+/**
+ * @file FastMath.cpp
+ * @brief 固定开销的初等函数实现
+ * @details 多项式系数来自fdlibm（k_sin.c、k_cos.c、e_exp.c、e_log.c）
+ *
+ * @author Calculator Project
+ */
+
+#include "FastMath.h"
+#include <math.h>
+
+namespace FastMath {
+
+namespace {
+
+// π/2 = PIO2_HI + PIO2_LO，PIO2_HI只有33位有效位，k < 2^20时 k·PIO2_HI 精确
+constexpr double INV_PIO2 = 6.36619772367581382433e-01;
+constexpr double PIO2_HI = 1.57079632673412561417e+00;
+constexpr double PIO2_LO = 6.07710050650619224932e-11;
+
+constexpr double S1 = -1.66666666666666324348e-01;
+constexpr double S2 = 8.33333333332248946124e-03;
+constexpr double S3 = -1.98412698298579493134e-04;
+constexpr double S4 = 2.75573137070700676789e-06;
+constexpr double S5 = -2.50507602534068634195e-08;
+constexpr double S6 = 1.58969099521155010221e-10;
+
+constexpr double C1 = 4.16666666666666019037e-02;
+constexpr double C2 = -1.38888888888741095749e-03;
+constexpr double C3 = 2.48015872894767294178e-05;
+constexpr double C4 = -2.75573143513906633035e-07;
+constexpr double C5 = 2.08757232129817482790e-09;
+constexpr double C6 = -1.13596475577881948265e-11;
+
+constexpr double LN2_HI = 6.93147180369123816490e-01;
+constexpr double LN2_LO = 1.90821492927058770002e-10;
+constexpr double INV_LN2 = 1.44269504088896338700e+00;
+constexpr double INV_LN10 = 4.34294481903251816668e-01;
+constexpr double SQRT1_2 = 7.07106781186547524401e-01;
+
+constexpr double P1 = 1.66666666666666019037e-01;
+constexpr double P2 = -2.77777777770155933842e-03;
+constexpr double P3 = 6.61375632143793436117e-05;
+constexpr double P4 = -1.65339022054652515390e-06;
+constexpr double P5 = 4.13813679705723846039e-08;
+
+constexpr double EXP_OVERFLOW = 7.09782712893383973096e+02;
+constexpr double EXP_UNDERFLOW = -7.45133219101941108420e+02;
+
+constexpr double LG1 = 6.666666666666735130e-01;
+constexpr double LG2 = 3.999999999940941908e-01;
+constexpr double LG3 = 2.857142874366239149e-01;
+constexpr double LG4 = 2.222219843214978396e-01;
+constexpr double LG5 = 1.818357216161805012e-01;
+constexpr double LG6 = 1.531383769920937332e-01;
+constexpr double LG7 = 1.479819860511658591e-01;
+
+// |r| ≤ π/4
+inline double kernelSin(double r) {
+    double z = r * r;
+    double p = S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)));
+    return r + z * r * (S1 + z * p);
+}
+
+inline double kernelCos(double r) {
+    double z = r * r;
+    double hz = 0.5 * z;
+    double w = 1.0 - hz;
+    double p = z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+    return w + (((1.0 - w) - hz) + z * p);
+}
+
+/**
+ * @brief 按π/2约简
+ * @return 象限k（x ≈ k·π/2 + r），|x|超过上限或非有限值时返回-1
+ */
+inline int32_t reducePio2(double x, double& r) {
+    if (!(fabs(x) <= TRIG_MAX_ARG)) return -1;
+    double fk = x * INV_PIO2;
+    int32_t k = (int32_t)(fk < 0 ? fk - 0.5 : fk + 0.5);
+    r = (x - k * PIO2_HI) - k * PIO2_LO;
+    return k & 3;
+}
+
+} // namespace
+
+double sin(double x) {
+    double r;
+    switch (reducePio2(x, r)) {
+        case 0: return kernelSin(r);
+        case 1: return kernelCos(r);
+        case 2: return -kernelSin(r);
+        case 3: return -kernelCos(r);
+        default: return NAN;
+    }
+}
+
+double cos(double x) {
+    double r;
+    switch (reducePio2(x, r)) {
+        case 0: return kernelCos(r);
+        case 1: return -kernelSin(r);
+        case 2: return -kernelCos(r);
+        case 3: return kernelSin(r);
+        default: return NAN;
+    }
+}
+
+double tan(double x) {
+    double r;
+    int32_t k = reducePio2(x, r);
+    if (k < 0) return NAN;
+    double s = kernelSin(r);
+    double c = kernelCos(r);
+    // 奇数象限 tan(x) = -cot(r)
+    return (k & 1) ? -c / s : s / c;
+}
+
+double ln(double x) {
+    if (!(x > 0)) return x == 0 ? -INFINITY : NAN;
+    if (isinf(x)) return x;
+
+    int e;
+    double m = frexp(x, &e);
+    if (m < SQRT1_2) {
+        m *= 2;
+        e--;
+    }
+
+    // ln(m) = 2·atanh(s)，s = f/(2+f)
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double w = z * z;
+    double t1 = w * (LG2 + w * (LG4 + w * LG6));
+    double t2 = z * (LG1 + w * (LG3 + w * (LG5 + w * LG7)));
+    double hfsq = 0.5 * f * f;
+    return e * LN2_HI - ((hfsq - (s * (hfsq + t1 + t2) + e * LN2_LO)) - f);
+}
+
+double log10(double x) {
+    return ln(x) * INV_LN10;
+}
+
+double exp(double x) {
+    if (isnan(x)) return x;
+    if (x > EXP_OVERFLOW) return INFINITY;
+    if (x < EXP_UNDERFLOW) return 0.0;
+
+    double fk = x * INV_LN2;
+    int32_t k = (int32_t)(fk < 0 ? fk - 0.5 : fk + 0.5);
+    double hi = x - k * LN2_HI;
+    double lo = k * LN2_LO;
+    double r = hi - lo;
+
+    double z = r * r;
+    double c = r - z * (P1 + z * (P2 + z * (P3 + z * (P4 + z * P5))));
+    double y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+    return ldexp(y, k);
+}
+
+double sqrt(double x) {
+    if (!(x > 0)) return x == 0 ? x : NAN;
+    if (isinf(x)) return x;
+
+    // x = m·2^e，e为偶数，m ∈ [0.5, 2)
+    int e;
+    double m = frexp(x, &e);
+    if (e & 1) {
+        m *= 2;
+        e--;
+    }
+
+    // 单精度初值约24位，每次牛顿迭代精度翻倍
+    double r = 1.0f / sqrtf((float)m);
+    r = r * (1.5 - 0.5 * m * r * r);
+    r = r * (1.5 - 0.5 * m * r * r);
+    double y = m * r;
+    y += 0.5 * r * (m - y * y);
+    return ldexp(y, e / 2);
+}
+
+double pow(double x, double y) {
+    if (y == 0) return 1.0;
+    if (isnan(x) || isnan(y)) return NAN;
+
+    bool integer = fabs(y) < 9007199254740992.0 && y == (double)(int64_t)y;
+    if (x == 0) {
+        return y > 0 ? 0.0 : INFINITY;
+    }
+
+    if (integer && fabs(y) <= POW_INT_MAX) {
+        uint32_t n = (uint32_t)fabs(y);
+        double base = x;
+        double result = 1.0;
+        while (n) {
+            if (n & 1) result *= base;
+            base *= base;
+            n >>= 1;
+        }
+        return y < 0 ? 1.0 / result : result;
+    }
+
+    double sign = 1.0;
+    if (x < 0) {
+        if (!integer) return NAN;
+        // 2^53以上的double都是偶数
+        if (fabs(y) < 9007199254740992.0 && ((int64_t)y & 1)) sign = -1.0;
+        x = -x;
+    }
+    return sign * exp(y * ln(x));
+}
+
+const Function FUNCTIONS[] = {
+    {"sin", sin, ::sin, -100.0, 100.0, false},
+    {"cos", cos, ::cos, -100.0, 100.0, false},
+    {"tan", tan, ::tan, -1.5, 1.5, false},
+    {"ln", ln, ::log, 1e-300, 1e300, true},
+    {"log10", log10, ::log10, 1e-300, 1e300, true},
+    {"exp", exp, ::exp, -700.0, 700.0, false},
+    {"sqrt", sqrt, ::sqrt, 1e-300, 1e300, true},
+};
+const uint8_t FUNCTION_COUNT = sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]);
+
+} // namespace FastMath
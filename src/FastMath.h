@@ -0,0 +1,54 @@
+/**
+ * @file FastMath.h
+ * @brief 固定开销的初等函数
+ * @details 科学函数层（sin/cos/tan、ln/log、eˣ、xʸ、√）的实现，不经过libm：
+ * - 先做区间约简，再用固定次数的极小极大多项式（系数取自fdlibm），没有依赖输入的迭代，
+ *   每个函数的最坏周期数有上界
+ * - sin/cos/tan：按π/2约简（两段Cody-Waite常数），|x| > TRIG_MAX_ARG 时精度已无意义，返回NaN
+ * - ln：拆成 m·2^e，m ∈ [√2/2, √2)，一次除法；log10 = ln × 1/ln10
+ * - exp：按ln2约简，|r| ≤ ln2/2
+ * - sqrt：单精度倒数平方根作初值，双精度牛顿迭代两次加一次修正，没有除法
+ * - pow：|y| ≤ POW_INT_MAX 的整数指数用二进制幂（2^10精确为1024），其余为 exp(y·ln x)
+ * 相对误差在几个ulp以内，足够15位有效数字的显示。定义域之外返回NaN，溢出返回±Inf，
+ * 由调用方（CalcBackend）转换为错误类型。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <stdint.h>
+
+namespace FastMath {
+
+constexpr double TRIG_MAX_ARG = 1e6;    ///< 三角函数参数上限：k·π/2的高位段在k < 2^20时乘积精确
+constexpr int POW_INT_MAX = 64;         ///< 二进制幂的指数上限（最多6次平方）
+
+double sin(double x);
+double cos(double x);
+double tan(double x);
+double ln(double x);
+double log10(double x);
+double exp(double x);
+double sqrt(double x);
+double pow(double x, double y);
+
+/**
+ * @brief 单参数函数表（基准和精度测试用）
+ */
+struct Function {
+    const char* name;
+    double (*fn)(double);
+    double (*reference)(double);    ///< 对应的libm函数
+    double lo;              ///< 测试区间
+    double hi;
+    bool logScale;          ///< 在区间内按对数均匀取样（区间须为正）
+};
+
+extern const Function FUNCTIONS[];
+extern const uint8_t FUNCTION_COUNT;
+
+} // namespace FastMath
+
+#endif // FAST_MATH_H
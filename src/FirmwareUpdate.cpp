@@ -0,0 +1,370 @@
+/**
+ * @file FirmwareUpdate.cpp
+ * @brief 固件更新实现
+ *
+ * @author Calculator Project
+ */
+
+#include "FirmwareUpdate.h"
+#include "BufferPlacement.h"
+#include "Logger.h"
+#include <esp_ota_ops.h>
+#include <esp_image_format.h>
+#include <string.h>
+
+#define TAG_UPDATE "Update"
+
+static_assert(FirmwareUpdate::WINDOW_SIZE % FirmwareUpdate::PAGE_SIZE == 0, "解压窗口必须是整数页");
+
+FirmwareUpdate::FirmwareUpdate()
+    : _active(false),
+      _format(FORMAT_RAW),
+      _partition(nullptr),
+      _imageSize(0),
+      _received(0),
+      _written(0),
+      _flashOffset(0),
+      _erasedEnd(0),
+      _inflateDone(false),
+      _window(nullptr),
+      _windowPos(0),
+      _flushedPos(0),
+      _base(nullptr),
+      _page(nullptr),
+      _pageLength(0),
+      _patchState(PATCH_HEADER),
+      _headerLength(0),
+      _oldSize(0),
+      _oldPos(0),
+      _field(0),
+      _shift(0) {
+    mbedtls_sha256_init(&_sha);
+}
+
+bool FirmwareUpdate::begin(uint32_t imageSize, const uint8_t* sha256, Format format) {
+    abort();
+    _partition = esp_ota_get_next_update_partition(nullptr);
+    if (!_partition) {
+        LOG_W(TAG_UPDATE, "分区表没有OTA分区");
+        return false;
+    }
+    if (imageSize == 0 || imageSize > _partition->size || format > FORMAT_DELTA) {
+        LOG_W(TAG_UPDATE, "镜像大小无效: %u（分区 %u）", imageSize, _partition->size);
+        return false;
+    }
+    _window = (uint8_t*)placedAlloc("update_window", WINDOW_SIZE, PLACE_PSRAM);
+    if (format == FORMAT_DELTA) {
+        _base = esp_ota_get_running_partition();
+        _page = (uint8_t*)placedAlloc("update_page", PAGE_SIZE, PLACE_PSRAM);
+    }
+    if (!_window || (format == FORMAT_DELTA && !_page)) {
+        LOG_E(TAG_UPDATE, "更新缓冲分配失败");
+        release();
+        return false;
+    }
+
+    _format = format;
+    _imageSize = imageSize;
+    memcpy(_expected, sha256, SHA_SIZE);
+    mbedtls_sha256_starts_ret(&_sha, 0);
+    _received = 0;
+    _written = 0;
+    _flashOffset = 0;
+    _erasedEnd = 0;
+    tinfl_init(&_inflator);
+    _inflateDone = false;
+    _windowPos = 0;
+    _flushedPos = 0;
+    _pageLength = 0;
+    _patchState = PATCH_HEADER;
+    _headerLength = 0;
+    _active = true;
+    static const char* const FORMAT_NAMES[] = {"", "（压缩传输）", "（差量）"};
+    LOG_I(TAG_UPDATE, "开始更新: %u 字节%s -> %s", imageSize, FORMAT_NAMES[format], _partition->label);
+    return true;
+}
+
+void FirmwareUpdate::abort() {
+    if (_active) LOG_W(TAG_UPDATE, "更新中止（已写入 %u/%u 字节）", _written, _imageSize);
+    release();
+}
+
+void FirmwareUpdate::release() {
+    _active = false;
+    placedFree(_window);
+    placedFree(_page);
+    _window = nullptr;
+    _page = nullptr;
+}
+
+bool FirmwareUpdate::write(uint32_t offset, const uint8_t* data, size_t length) {
+    if (!_active) return false;
+    if (offset != _received) {
+        LOG_W(TAG_UPDATE, "数据位置不连续: %u（应为 %u）", offset, _received);
+        abort();
+        return false;
+    }
+    _received += length;
+
+    bool ok;
+    if (_format != FORMAT_RAW) {
+        ok = inflate(data, length);
+    } else {
+        // 原样的镜像也经过窗口按页写入
+        ok = true;
+        while (ok && length) {
+            size_t chunk = WINDOW_SIZE - _windowPos;
+            if (chunk > length) chunk = length;
+            memcpy(_window + _windowPos, data, chunk);
+            data += chunk;
+            length -= chunk;
+            ok = produced(chunk);
+        }
+    }
+    if (!ok) abort();
+    return ok;
+}
+
+bool FirmwareUpdate::inflate(const uint8_t* data, size_t length) {
+    for (;;) {
+        if (_inflateDone) return length == 0;      // 压缩流结束后不应再有数据
+        size_t in = length;
+        size_t out = WINDOW_SIZE - _windowPos;
+        // 窗口循环使用：tinfl按32KB字典回绕引用已输出的数据，所以输出必须写在窗口内
+        tinfl_status status = tinfl_decompress(&_inflator, data, &in, _window, _window + _windowPos, &out,
+                                               TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+        data += in;
+        length -= in;
+        if (status < TINFL_STATUS_DONE) {
+            LOG_W(TAG_UPDATE, "解压失败: %d", (int)status);
+            return false;
+        }
+        if (!produced(out)) return false;
+        if (status == TINFL_STATUS_DONE) {
+            _inflateDone = true;
+        } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && length == 0) {
+            return true;
+        }
+        // TINFL_STATUS_HAS_MORE_OUTPUT：窗口已满，写出后继续
+    }
+}
+
+bool FirmwareUpdate::produced(size_t length) {
+    const uint8_t* data = _window + _windowPos;
+    _windowPos += length;
+    if (_format == FORMAT_DELTA) {
+        // 窗口中是补丁，生成的镜像经页缓冲写出
+        if (!patch(data, length)) return false;
+    } else {
+        // 完整的页直接从窗口写出；窗口是整数页，回绕时已全部写出
+        if (!hashImage(data, length)) return false;
+        while (_windowPos - _flushedPos >= PAGE_SIZE) {
+            if (!writePage(_window + _flushedPos, PAGE_SIZE)) return false;
+            _flushedPos += PAGE_SIZE;
+        }
+    }
+    if (_windowPos == WINDOW_SIZE) {
+        _windowPos = 0;
+        _flushedPos = 0;
+    }
+    return true;
+}
+
+bool FirmwareUpdate::hashImage(const uint8_t* data, size_t length) {
+    if (_written + length > _imageSize) {
+        LOG_W(TAG_UPDATE, "数据超出镜像大小");
+        return false;
+    }
+    mbedtls_sha256_update_ret(&_sha, data, length);
+    _written += length;
+    return true;
+}
+
+bool FirmwareUpdate::emit(const uint8_t* data, size_t length) {
+    if (!hashImage(data, length)) return false;
+    while (length) {
+        size_t chunk = PAGE_SIZE - _pageLength;
+        if (chunk > length) chunk = length;
+        memcpy(_page + _pageLength, data, chunk);
+        _pageLength += chunk;
+        data += chunk;
+        length -= chunk;
+        if (_pageLength == PAGE_SIZE) {
+            if (!writePage(_page, PAGE_SIZE)) return false;
+            _pageLength = 0;
+        }
+    }
+    return true;
+}
+
+bool FirmwareUpdate::checkBase() {
+    static const char MAGIC[4] = {'P', 'C', 'D', '1'};
+    if (memcmp(_header, MAGIC, sizeof(MAGIC)) != 0) {
+        LOG_W(TAG_UPDATE, "不是补丁数据");
+        return false;
+    }
+    memcpy(&_oldSize, _header + 4, sizeof(_oldSize));
+    if (!_base || _oldSize > _base->size) {
+        LOG_W(TAG_UPDATE, "补丁的旧镜像大小无效: %u", _oldSize);
+        return false;
+    }
+
+    // 正在运行的分区必须是补丁对照的版本
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+    for (uint32_t offset = 0; offset < _oldSize; offset += OLD_CHUNK) {
+        size_t chunk = _oldSize - offset < OLD_CHUNK ? _oldSize - offset : OLD_CHUNK;
+        if (esp_partition_read(_base, offset, _oldChunk, chunk) != ESP_OK) {
+            mbedtls_sha256_free(&sha);
+            return false;
+        }
+        mbedtls_sha256_update_ret(&sha, _oldChunk, chunk);
+    }
+    uint8_t digest[SHA_SIZE];
+    mbedtls_sha256_finish_ret(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    if (memcmp(digest, _header + 8, SHA_SIZE) != 0) {
+        LOG_W(TAG_UPDATE, "补丁不是对照当前固件生成的");
+        return false;
+    }
+    _oldPos = 0;
+    return true;
+}
+
+bool FirmwareUpdate::patch(const uint8_t* data, size_t length) {
+    while (length) {
+        switch (_patchState) {
+            case PATCH_HEADER: {
+                size_t chunk = PATCH_HEADER_SIZE - _headerLength;
+                if (chunk > length) chunk = length;
+                memcpy(_header + _headerLength, data, chunk);
+                _headerLength += chunk;
+                data += chunk;
+                length -= chunk;
+                if (_headerLength == PATCH_HEADER_SIZE) {
+                    if (!checkBase()) return false;
+                    _patchState = PATCH_CONTROL;
+                    _field = 0;
+                    _shift = 0;
+                    _fields[0] = 0;
+                }
+                break;
+            }
+
+            case PATCH_CONTROL: {
+                uint8_t byte = *data++;
+                length--;
+                if (_shift > 28) return false;
+                _fields[_field] |= (uint32_t)(byte & 0x7F) << _shift;
+                _shift += 7;
+                if (byte & 0x80) break;
+                _shift = 0;
+                if (++_field < 3) {
+                    _fields[_field] = 0;
+                    break;
+                }
+                // 旧位置偏移是zigzag编码的有符号数
+                int32_t seek = (int32_t)(_fields[2] >> 1) ^ -(int32_t)(_fields[2] & 1);
+                _oldPos += seek;
+                if (_fields[1] > _oldSize || _oldPos > _oldSize - _fields[1]) {
+                    LOG_W(TAG_UPDATE, "补丁引用超出旧镜像: %u + %u", _oldPos, _fields[1]);
+                    return false;
+                }
+                _patchState = PATCH_LITERAL;
+                break;
+            }
+
+            case PATCH_LITERAL: {
+                size_t chunk = _fields[0] < length ? _fields[0] : length;
+                if (!emit(data, chunk)) return false;
+                data += chunk;
+                length -= chunk;
+                _fields[0] -= chunk;
+                break;
+            }
+
+            case PATCH_DIFF: {
+                size_t chunk = _fields[1] < length ? _fields[1] : length;
+                if (chunk > OLD_CHUNK) chunk = OLD_CHUNK;
+                if (esp_partition_read(_base, _oldPos, _oldChunk, chunk) != ESP_OK) return false;
+                for (size_t i = 0; i < chunk; i++) _oldChunk[i] += data[i];
+                if (!emit(_oldChunk, chunk)) return false;
+                data += chunk;
+                length -= chunk;
+                _oldPos += chunk;
+                _fields[1] -= chunk;
+                break;
+            }
+        }
+
+        // 字面和差值部分可能为空，读完后进入下一条记录
+        if (_patchState == PATCH_LITERAL && _fields[0] == 0) _patchState = PATCH_DIFF;
+        if (_patchState == PATCH_DIFF && _fields[1] == 0) {
+            _patchState = PATCH_CONTROL;
+            _field = 0;
+            _fields[0] = 0;
+        }
+    }
+    return true;
+}
+
+bool FirmwareUpdate::writePage(const uint8_t* data, size_t length) {
+    if (_flashOffset == 0 && data[0] != ESP_IMAGE_HEADER_MAGIC) {
+        LOG_W(TAG_UPDATE, "不是固件镜像（魔数 0x%02X）", data[0]);
+        return false;
+    }
+    // 按64KB块提前擦除，最后一块只擦到镜像末尾所在的扇区
+    uint32_t imageEnd = (_imageSize + PAGE_SIZE - 1) & ~(uint32_t)(PAGE_SIZE - 1);
+    while (_flashOffset + length > _erasedEnd) {
+        uint32_t end = (_erasedEnd + BLOCK_SIZE) & ~(uint32_t)(BLOCK_SIZE - 1);
+        if (end > imageEnd) end = imageEnd;
+        if (esp_partition_erase_range(_partition, _erasedEnd, end - _erasedEnd) != ESP_OK) {
+            LOG_E(TAG_UPDATE, "擦除失败: 0x%x", _erasedEnd);
+            return false;
+        }
+        _erasedEnd = end;
+    }
+    if (esp_partition_write(_partition, _flashOffset, data, length) != ESP_OK) {
+        LOG_E(TAG_UPDATE, "写入失败: 0x%x", _flashOffset);
+        return false;
+    }
+    _flashOffset += length;
+    return true;
+}
+
+bool FirmwareUpdate::finish() {
+    if (!_active) return false;
+    if (_written != _imageSize || (_format != FORMAT_RAW && !_inflateDone)) {
+        LOG_W(TAG_UPDATE, "镜像不完整: %u/%u 字节", _written, _imageSize);
+        abort();
+        return false;
+    }
+    // 最后不满一页的部分
+    bool ok = _format == FORMAT_DELTA ? (_pageLength == 0 || writePage(_page, _pageLength))
+                                      : (_windowPos == _flushedPos ||
+                                         writePage(_window + _flushedPos, _windowPos - _flushedPos));
+    if (!ok) {
+        abort();
+        return false;
+    }
+
+    uint8_t digest[SHA_SIZE];
+    mbedtls_sha256_finish_ret(&_sha, digest);
+    if (memcmp(digest, _expected, SHA_SIZE) != 0) {
+        LOG_W(TAG_UPDATE, "SHA-256不一致");
+        abort();
+        return false;
+    }
+    esp_err_t err = esp_ota_set_boot_partition(_partition);
+    if (err != ESP_OK) {
+        LOG_W(TAG_UPDATE, "镜像校验失败: %s", esp_err_to_name(err));
+        abort();
+        return false;
+    }
+
+    LOG_I(TAG_UPDATE, "更新完成: %u 字节（传输 %u 字节），重启后从 %s 启动", _written, _received,
+          _partition->label);
+    release();
+    return true;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file FirmwareUpdate.h
+ * @brief 经USB CDC主机通道写入新固件（OTA分区）
+ * @details 主机工具（tools/host_link.py update）发送固件镜像，可以是原样或zlib压缩：
+ * - 压缩镜像用ROM中的inflate（tinfl，与esptool --compress的烧录桩相同）逐帧解压，
+ *   不需要额外的解压代码；32KB解压窗口同时作为写闪存的页缓冲，完整的4KB页直接从窗口写入
+ * - 擦除按64KB块提前进行（整块擦除比逐个扇区快），写入按4KB页；
+ *   主机保持两帧在途，设备擦写闪存时下一帧已经在USB上传输
+ * - 解压后的镜像边写边算SHA-256，结束时与主机给出的值比较，一致后才设为启动分区
+ *   （esp_ota_set_boot_partition另外校验镜像自身的校验和）
+ * - 差量更新（FORMAT_DELTA）：传输的是zlib压缩的补丁，对照正在运行的分区流式生成新镜像，
+ *   只需一页输出缓冲和一小块旧数据缓冲。补丁格式（tools/host_link.py生成，多字节为小端）：
+ *
+ *       "PCD1" | 旧镜像字节数(4) | 旧镜像SHA-256(32) | 记录...
+ *       记录：字面长度(varint) | 差值长度(varint) | 旧位置偏移(zigzag varint) | 字面字节 | 差值字节
+ *
+ *   每条记录先输出字面字节；旧位置加上偏移后，逐字节输出 旧数据 + 差值（模256），旧位置随之前进。
+ *   与bsdiff相同，地址改变了几个字节的代码段差值几乎全是0，压缩后很小。
+ *   补丁头中的旧镜像SHA-256与正在运行的分区不符时拒绝（补丁是对照另一个版本生成的）
+ *
+ * 分区表需要两个OTA应用分区（partitions.csv）。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef FIRMWARE_UPDATE_H
+#define FIRMWARE_UPDATE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+#include "esp32s3/rom/miniz.h"
+
+class FirmwareUpdate {
+public:
+    static const size_t PAGE_SIZE = 4096;           ///< 写入单位（闪存扇区）
+    static const size_t BLOCK_SIZE = 65536;         ///< 擦除单位
+    static const size_t WINDOW_SIZE = TINFL_LZ_DICT_SIZE;   ///< 解压窗口，页大小的整数倍
+    static const size_t SHA_SIZE = 32;
+    static const size_t OLD_CHUNK = 256;            ///< 差值记录每次读取的旧数据字节数
+
+    enum Format : uint8_t {
+        FORMAT_RAW   = 0,           ///< 原样的镜像
+        FORMAT_ZLIB  = 1,           ///< zlib格式（带头和Adler-32）
+        FORMAT_DELTA = 2            ///< zlib压缩的补丁，对照正在运行的分区
+    };
+
+    static FirmwareUpdate& instance() {
+        static FirmwareUpdate instance;
+        return instance;
+    }
+
+    /**
+     * @brief 开始一次更新（放弃未完成的更新）
+     * @param imageSize 解压后的镜像字节数
+     * @param sha256 解压后镜像的SHA-256
+     * @return 没有OTA分区、镜像超出分区或缓冲分配失败时返回false
+     */
+    bool begin(uint32_t imageSize, const uint8_t* sha256, Format format);
+
+    /**
+     * @brief 写入一段传输数据
+     * @param offset 这段数据在传输流中的位置，必须与已收到的字节数相同
+     * @return 位置不连续、数据无效或写闪存失败时返回false（更新中止）
+     */
+    bool write(uint32_t offset, const uint8_t* data, size_t length);
+
+    /**
+     * @brief 写完剩余数据，校验SHA-256和镜像后设为下次启动的分区
+     */
+    bool finish();
+
+    void abort();
+
+    bool isActive() const { return _active; }
+    uint32_t getReceived() const { return _received; }
+    uint32_t getWritten() const { return _written; }
+
+private:
+    FirmwareUpdate();
+
+    // 补丁解析状态
+    enum PatchState : uint8_t {
+        PATCH_HEADER,
+        PATCH_CONTROL,              ///< 读记录的三个varint
+        PATCH_LITERAL,
+        PATCH_DIFF
+    };
+
+    static const size_t PATCH_HEADER_SIZE = 4 + 4 + SHA_SIZE;
+
+    bool inflate(const uint8_t* data, size_t length);
+    bool produced(size_t length);
+    bool hashImage(const uint8_t* data, size_t length);
+    bool patch(const uint8_t* data, size_t length);
+    bool checkBase();
+    bool emit(const uint8_t* data, size_t length);
+    bool writePage(const uint8_t* data, size_t length);
+    void release();
+
+    bool _active;
+    Format _format;
+    const esp_partition_t* _partition;
+    uint32_t _imageSize;
+    uint8_t _expected[SHA_SIZE];
+    mbedtls_sha256_context _sha;
+
+    uint32_t _received;             ///< 已收到的传输字节数
+    uint32_t _written;              ///< 已产生的镜像字节数
+    uint32_t _flashOffset;          ///< 下一页在分区中的位置
+    uint32_t _erasedEnd;            ///< 已擦除到分区中的此位置
+
+    tinfl_decompressor _inflator;
+    bool _inflateDone;
+    uint8_t* _window;               ///< 解压窗口/页缓冲，更新期间分配
+    size_t _windowPos;              ///< 窗口中已产生数据的末尾
+    size_t _flushedPos;             ///< 窗口中已写入闪存的末尾
+
+    // 差量更新
+    const esp_partition_t* _base;   ///< 正在运行的分区
+    uint8_t* _page;                 ///< 输出页缓冲（差量更新时分配）
+    size_t _pageLength;
+    uint8_t _oldChunk[OLD_CHUNK];
+    PatchState _patchState;
+    uint8_t _header[PATCH_HEADER_SIZE];
+    size_t _headerLength;
+    uint32_t _oldSize;
+    uint32_t _oldPos;
+    uint32_t _fields[3];            ///< 字面长度、差值长度、旧位置偏移（zigzag）
+    uint8_t _field;                 ///< 正在读的varint
+    uint8_t _shift;
+};
+
+#endif // FIRMWARE_UPDATE_H
@@ -0,0 +1,137 @@
+/**
+ * @file FixedString.h
+ * @brief 固定容量的内联字符串
+ * @details 字符存放在对象内部的数组中，不使用堆内存：
+ * - 容量N包含结尾的'\0'，最多保存N-1个字符
+ * - 追加超出容量时截断并返回false，不会越界
+ * - 接口与Arduino String常用部分保持一致，便于替换
+ *
+ * @author Calculator Project
+ */
+
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <stddef.h>
+#include <string.h>
+
+template <size_t N>
+class FixedString {
+    static_assert(N >= 2, "FixedString容量至少为2");
+
+public:
+    FixedString() : _length(0) { _data[0] = '\0'; }
+    FixedString(const char *text) : _length(0) { assign(text); }
+
+    static size_t capacity() { return N - 1; }
+
+    const char *c_str() const { return _data; }
+    size_t length() const { return _length; }
+    bool isEmpty() const { return _length == 0; }
+    bool isFull() const { return _length == N - 1; }
+
+    char charAt(size_t index) const { return index < _length ? _data[index] : '\0'; }
+    char back() const { return _length ? _data[_length - 1] : '\0'; }
+
+    void clear() {
+        _length = 0;
+        _data[0] = '\0';
+    }
+
+    /**
+     * @brief 替换为新内容
+     * @return 内容被截断时返回false
+     */
+    bool assign(const char *text) {
+        clear();
+        return append(text);
+    }
+
+    /**
+     * @brief 追加一个字符
+     * @return 已满时返回false
+     */
+    bool append(char c) {
+        if (_length >= N - 1) return false;
+        _data[_length++] = c;
+        _data[_length] = '\0';
+        return true;
+    }
+
+    /**
+     * @brief 追加字符串
+     * @return 内容被截断时返回false
+     */
+    bool append(const char *text) {
+        if (!text) return true;
+        size_t len = strlen(text);
+        size_t room = N - 1 - _length;
+        bool fits = len <= room;
+        if (!fits) len = room;
+        memcpy(_data + _length, text, len);
+        _length += len;
+        _data[_length] = '\0';
+        return fits;
+    }
+
+    /**
+     * @brief 保留前len个字符
+     */
+    void truncate(size_t len) {
+        if (len < _length) {
+            _length = len;
+            _data[_length] = '\0';
+        }
+    }
+
+    /**
+     * @brief 在pos处插入text的前len个字符
+     * @return pos越界或放不下时返回false，内容不变
+     */
+    bool insert(size_t pos, const char *text, size_t len) {
+        if (pos > _length || len > N - 1 - _length) return false;
+        memmove(_data + pos + len, _data + pos, _length - pos + 1);
+        memcpy(_data + pos, text, len);
+        _length += len;
+        return true;
+    }
+
+    /**
+     * @brief 删除从pos起的len个字符
+     */
+    void erase(size_t pos, size_t len) {
+        if (pos >= _length) return;
+        if (len > _length - pos) len = _length - pos;
+        memmove(_data + pos, _data + pos + len, _length - pos - len + 1);
+        _length -= len;
+    }
+
+    /**
+     * @brief 删除最后一个字符
+     */
+    void removeLast() {
+        if (_length) truncate(_length - 1);
+    }
+
+    FixedString &operator=(const char *text) {
+        assign(text);
+        return *this;
+    }
+    FixedString &operator+=(const char *text) {
+        append(text);
+        return *this;
+    }
+    FixedString &operator+=(char c) {
+        append(c);
+        return *this;
+    }
+
+    bool operator==(const char *text) const { return text && strcmp(_data, text) == 0; }
+    bool operator!=(const char *text) const { return !(*this == text); }
+
+private:
+    char _data[N];
+    size_t _length;
+};
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,341 @@
+/**
+ * @file FleetConfig.cpp
+ * @brief 经ESP-NOW群发签名的配置增量的实现
+ *
+ * @author Calculator Project
+ */
+
+#include "FleetConfig.h"
+
+#if FLEET_CONFIG_ENABLED
+
+#include "ConfigJson.h"
+#include "ConfigManager.h"
+#include "Console.h"
+#include "LoopScheduler.h"
+#include "Logger.h"
+#include "PeerSync.h"
+#include <mbedtls/md.h>
+
+#define TAG_FLEET "Fleet"
+
+#define FLEET_NAMESPACE "fleet_cfg"
+
+namespace {
+
+const char* const ACK_NAMES[] = {"已应用", "已有更新的版本", "取值无效"};
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parseKey(const char* text, uint8_t* key) {
+    if (strlen(text) != FleetConfig::KEY_SIZE * 2) return false;
+    for (size_t i = 0; i < FleetConfig::KEY_SIZE; i++) {
+        int hi = hexDigit(text[i * 2]);
+        int lo = hexDigit(text[i * 2 + 1]);
+        if (hi < 0 || lo < 0) return false;
+        key[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+void cmdFleet(const ConsoleArgs& args) {
+    FleetConfig& fleet = FleetConfig::instance();
+    uint8_t key[FleetConfig::KEY_SIZE];
+    if (args.count < 2) {
+        fleet.printStatus();
+    } else if (args.is(1, "key") && args.is(2, "clear")) {
+        fleet.setKey(nullptr);
+        Serial.println("站点密钥已清除");
+    } else if (args.is(1, "key") && parseKey(args.arg(2), key)) {
+        fleet.setKey(key);
+        Serial.println("站点密钥已保存");
+    } else if (args.is(1, "push") && args.count > 2) {
+        uint32_t fields = 0;
+        for (uint8_t i = 2; i < args.count; i++) {
+            uint32_t field = args.is(i, "all") ? CONFIG_ALL_FIELDS : ConfigJson::settingField(args.arg(i));
+            if (!field) {
+                Serial.printf("未知的配置项: %s\n", args.arg(i));
+                return;
+            }
+            fields |= field;
+        }
+        if (fleet.push(fields)) {
+            Serial.printf("已推送第 %u 版，%u 项\n", fleet.version(), __builtin_popcount(fields));
+        } else {
+            Serial.println("推送失败（没有站点密钥？）");
+        }
+    } else {
+        Serial.println("用法: fleet [key <64位十六进制>|key clear|push <配置项>...|push all]");
+    }
+}
+
+constexpr ConsoleCommand FLEET_COMMANDS[] = {
+    {"fleet", "[key <密钥>|push <配置项>...]", "机群配置：经ESP-NOW把本机的配置项推送给同一场地的设备", cmdFleet},
+};
+static_assert(consoleSorted(FLEET_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+FleetConfig::FleetConfig()
+    : _resendTimer(TimerWheel::INVALID),
+      _hasKey(false),
+      _version(0),
+      _frameLength(0),
+      _pushUntil(0),
+      _lastBroadcast(0),
+      _ackCount(0),
+      _broadcasts(0),
+      _applied(0),
+      _badSignatures(0),
+      _dropped(0) {
+    static_assert(sizeof(DeltaHeader) == 8 && sizeof(Ack) == 6, "帧的布局与对端不一致");
+    static_assert(MAX_FIELDS == __builtin_popcount(CONFIG_ALL_FIELDS), "MAX_FIELDS与ConfigField不一致");
+    static_assert(MAX_FRAME <= 250, "ESP-NOW一帧最多250字节");
+    memset(_key, 0, sizeof(_key));
+    memset(_acks, 0, sizeof(_acks));
+}
+
+bool FleetConfig::begin() {
+    if (!_preferences.begin(FLEET_NAMESPACE, false)) {
+        LOG_E(TAG_FLEET, "无法打开NVS");
+        return false;
+    }
+    _hasKey = _preferences.getBytes("key", _key, sizeof(_key)) == sizeof(_key);
+    _version = _preferences.getUShort("ver", 0);
+    _frameLength = (uint8_t)_preferences.getBytes("frame", _frame, sizeof(_frame));
+
+    _resendTimer = TimerWheel::instance().create("fleet", onResend, this);
+    Console::instance().addCommands(FLEET_COMMANDS);
+    if (_hasKey) {
+        LOG_I(TAG_FLEET, "机群配置: 第 %u 版", _version);
+    }
+    return true;
+}
+
+void FleetConfig::poll() {
+    Received received;
+    while (_rx.pop(received)) {
+        if (!_hasKey) continue;
+        if (received.data[1] == FRAME_DELTA) {
+            handleDelta(received);
+        } else if (received.data[1] == FRAME_ACK) {
+            handleAck(received);
+        }
+    }
+}
+
+bool FleetConfig::push(uint32_t fields) {
+    if (!_hasKey || !fields || (fields & ~CONFIG_ALL_FIELDS)) return false;
+    if (_version == UINT16_MAX) {
+        LOG_E(TAG_FLEET, "版本已用完，不能再推送");
+        return false;
+    }
+
+    const PersistentConfig& config = ConfigManager::getInstance().getConfig();
+    DeltaHeader header = {};
+    header.magic = MAGIC;
+    header.type = FRAME_DELTA;
+    header.version = _version + 1;
+    header.fields = fields;
+
+    uint8_t* p = _frame + sizeof(header);
+    for (uint32_t rest = fields; rest; rest &= rest - 1) {
+        uint32_t value = 0;
+        ConfigJson::getSetting(config, rest & -rest, value);
+        memcpy(p, &value, sizeof(value));
+        p += sizeof(value);
+    }
+    memcpy(_frame, &header, sizeof(header));
+    sign(_frame, p - _frame, p);
+    _frameLength = (uint8_t)(p + TAG_SIZE - _frame);
+
+    // 本机的取值就是增量的内容，只记下版本
+    _version = header.version;
+    save();
+    _ackCount = 0;
+    memset(_acks, 0, sizeof(_acks));
+    _pushUntil = millis() + FLEET_CONFIG_PUSH_MS;
+    broadcast();
+    TimerWheel::instance().start(_resendTimer, FLEET_CONFIG_RESEND_MS);
+    LOG_I(TAG_FLEET, "推送第 %u 版: 字段 0x%06lX", _version, (unsigned long)fields);
+    return true;
+}
+
+void FleetConfig::setKey(const uint8_t* key) {
+    _hasKey = key != nullptr;
+    if (key) {
+        memcpy(_key, key, sizeof(_key));
+        _preferences.putBytes("key", _key, sizeof(_key));
+    } else {
+        memset(_key, 0, sizeof(_key));
+        _preferences.remove("key");
+    }
+    // 版本不随密钥重新计：重新输入同一密钥后，以前签名的旧帧仍不大于已应用版本，不会被重放。
+    // 旧的帧是旧密钥签名的，不再转发
+    _frameLength = 0;
+    TimerWheel::instance().cancel(_resendTimer);
+    save();
+}
+
+void FleetConfig::onPeerVersion(uint16_t version) {
+    if (!_hasKey || !_frameLength) return;
+    if (version >= _version) return;
+    // 同时醒来的几台共用一次转发
+    if (millis() - _lastBroadcast < FLEET_CONFIG_RESEND_MS) return;
+    broadcast();
+}
+
+void FleetConfig::onReceive(const uint8_t* mac, const uint8_t* data, int length) {
+    // WiFi任务中：只入队，校验在主循环
+    if (length < (int)sizeof(Ack) || length > (int)MAX_FRAME) return;
+    Received received;
+    memcpy(received.mac, mac, sizeof(received.mac));
+    received.length = (uint8_t)length;
+    memcpy(received.data, data, length);
+    if (!_rx.push(received)) {
+        _dropped++;
+        return;
+    }
+    LoopScheduler::instance().wake();
+}
+
+void FleetConfig::sign(const uint8_t* data, size_t length, uint8_t* tag) const {
+    uint8_t mac[32];
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), _key, sizeof(_key), data, length, mac);
+    memcpy(tag, mac, TAG_SIZE);
+}
+
+void FleetConfig::handleDelta(const Received& received) {
+    DeltaHeader header;
+    if (received.length < sizeof(header) + TAG_SIZE) return;
+    memcpy(&header, received.data, sizeof(header));
+    if (header.fields & ~CONFIG_ALL_FIELDS) return;
+    size_t signedLength = sizeof(header) + __builtin_popcount(header.fields) * sizeof(uint32_t);
+    if (received.length != signedLength + TAG_SIZE) return;
+
+    // 逐字节累积差异，比较时间与出错位置无关
+    uint8_t tag[TAG_SIZE];
+    sign(received.data, signedLength, tag);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < TAG_SIZE; i++) {
+        diff |= tag[i] ^ received.data[signedLength + i];
+    }
+    if (diff) {
+        _badSignatures++;
+        return;
+    }
+
+    if (header.version < _version) {
+        sendAck(ACK_NEWER, header.version);
+        // 发送方落后，顺便把本机的帧发给它
+        onPeerVersion(header.version);
+        return;
+    }
+    if (header.version == _version) {
+        sendAck(ACK_APPLIED, header.version);
+        return;
+    }
+
+    // 先在副本上检查全部取值，有一项无效就整体放弃
+    PersistentConfig config = ConfigManager::getInstance().getConfig();
+    const uint8_t* p = received.data + sizeof(header);
+    for (uint32_t rest = header.fields; rest; rest &= rest - 1) {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        p += sizeof(value);
+        if (!ConfigJson::setSetting(config, rest & -rest, value)) {
+            LOG_W(TAG_FLEET, "第 %u 版的取值无效，未应用", header.version);
+            sendAck(ACK_INVALID, header.version);
+            return;
+        }
+    }
+
+    // 配置先写入（观察者只重新应用变化的字段），再记下版本：中间掉电时重新收到同一版本，应用结果不变
+    ConfigManager::getInstance().importConfig(config);
+    _version = header.version;
+    memcpy(_frame, received.data, received.length);
+    _frameLength = received.length;
+    save();
+    _applied++;
+    _pushUntil = 0;
+    TimerWheel::instance().cancel(_resendTimer);
+    sendAck(ACK_APPLIED, header.version);
+    LOG_I(TAG_FLEET, "已应用第 %u 版: 字段 0x%06lX", _version, (unsigned long)header.fields);
+}
+
+void FleetConfig::handleAck(const Received& received) {
+    Ack ack;
+    if (received.length != sizeof(ack)) return;
+    memcpy(&ack, received.data, sizeof(ack));
+    if (ack.version != _version || ack.status > ACK_INVALID) return;
+
+    // 重发期间同一台会应答多次，按MAC只计一次
+    for (uint8_t i = 0; i < _ackCount; i++) {
+        if (memcmp(_ackMacs[i], received.mac, 6) == 0) return;
+    }
+    if (_ackCount < FLEET_CONFIG_MAX_ACKS) {
+        memcpy(_ackMacs[_ackCount++], received.mac, 6);
+    }
+    _acks[ack.status]++;
+}
+
+void FleetConfig::sendAck(AckStatus status, uint16_t version) {
+    Ack ack = {};
+    ack.magic = MAGIC;
+    ack.type = FRAME_ACK;
+    ack.status = status;
+    ack.version = version;
+    PeerSync::instance().broadcast((const uint8_t*)&ack, sizeof(ack));
+}
+
+void FleetConfig::broadcast() {
+    if (!_frameLength) return;
+    _lastBroadcast = millis();
+    if (PeerSync::instance().broadcast(_frame, _frameLength)) {
+        _broadcasts++;
+    }
+}
+
+void FleetConfig::save() {
+    _preferences.putUShort("ver", _version);
+    if (_frameLength) {
+        _preferences.putBytes("frame", _frame, _frameLength);
+    } else {
+        _preferences.remove("frame");
+    }
+}
+
+void FleetConfig::onResend(void* context) {
+    FleetConfig* self = static_cast<FleetConfig*>(context);
+    if ((int32_t)(millis() - self->_pushUntil) >= 0) return;
+    self->broadcast();
+    TimerWheel::instance().start(self->_resendTimer, FLEET_CONFIG_RESEND_MS);
+}
+
+void FleetConfig::printStatus() const {
+    Serial.println("=== 机群配置 ===");
+    if (!_hasKey) {
+        Serial.println("没有站点密钥（fleet key <64位十六进制>）");
+        return;
+    }
+    Serial.printf("版本: 第 %u 版%s\n", _version, _frameLength ? "" : "（没有可转发的帧）");
+    if ((int32_t)(millis() - _pushUntil) < 0) {
+        Serial.printf("正在推送，还有 %lu 秒\n", (unsigned long)((_pushUntil - millis()) / 1000));
+    }
+    if (_ackCount) {
+        Serial.printf("应答 %u 台:", _ackCount);
+        for (uint8_t status = 0; status < 3; status++) {
+            if (_acks[status]) Serial.printf(" %s %lu", ACK_NAMES[status], (unsigned long)_acks[status]);
+        }
+        Serial.println();
+    }
+    Serial.printf("广播 %lu 次，应用 %lu 次，签名不符 %lu，队列满丢弃 %lu\n", (unsigned long)_broadcasts,
+                  (unsigned long)_applied, (unsigned long)_badSignatures, (unsigned long)_dropped);
+}
+
+#endif // FLEET_CONFIG_ENABLED
@@ -0,0 +1,162 @@
+/**
+ * @file FleetConfig.h
+ * @brief 经ESP-NOW向同一场地的设备群发签名的配置增量
+ * @details 改一项设置（音量、休眠时间、税率等）原先要逐台插线导入。持有站点密钥的设备可以一次推送：
+ * - 增量只含选中的字段：ConfigField位图加上按位顺序排列的取值，最多22项也只有112字节，一帧发完
+ * - 用站点密钥（32字节，fleet key设置，保存在NVS，不会输出）做HMAC-SHA256，截取前16字节附在帧尾；
+ *   版本号是16位（PeerSync的包也带着它），只增不减、不回绕，不大于已应用版本的帧不再应用（防重放）；
+ *   用到65535后不能再推送
+ * - 收到后先在配置副本上逐项检查范围，全部有效才经ConfigManager::importConfig()一次应用：
+ *   观察者只重新应用变化的字段，整份配置作为一个设置镜像写入（中途掉电时仍是旧配置），然后才记下版本
+ * - 每台都回复6字节的应答（已应用/已是更新的版本/取值无效），推送方按MAC记下应答的设备
+ * - 无线由多台合计（PeerSync）开关：推送方在FLEET_CONFIG_PUSH_MS内每FLEET_CONFIG_RESEND_MS重发；
+ *   其他设备的无线只在输入前后打开，打开时的状态请求带着已应用的版本，
+ *   收到的设备（推送方或已应用的任何一台）发现对方落后就转发保存的帧，签名不变
+ * - 设置了站点密钥、未配对多台合计的设备同样在输入前后打开无线
+ *
+ * 接收回调在WiFi任务中，只把帧放进队列并唤醒主循环，校验和应用都在主循环中（poll()）。
+ * 应答不签名：伪造的应答只影响推送方的统计。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef FLEET_CONFIG_H
+#define FLEET_CONFIG_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if FLEET_CONFIG_ENABLED
+
+#include <Preferences.h>
+#include "SpscQueue.h"
+#include "TimerWheel.h"
+
+class FleetConfig {
+public:
+    static const uint8_t MAGIC = 0xC8;          ///< 与PeerSync的包区分
+    static const size_t KEY_SIZE = 32;
+    static const size_t TAG_SIZE = 16;
+    static const uint8_t MAX_FIELDS = 22;       ///< ConfigField的字段数
+    static const size_t MAX_FRAME = 8 + MAX_FIELDS * 4 + TAG_SIZE;
+
+    static FleetConfig& instance() {
+        static FleetConfig instance;
+        return instance;
+    }
+
+    /**
+     * @brief 读取NVS中的密钥、版本和保存的帧，注册串口命令
+     */
+    bool begin();
+
+    /**
+     * @brief 主循环每轮调用：处理收到的帧
+     */
+    void poll();
+
+    /**
+     * @brief 推送本机当前的这些字段（ConfigField位），版本加一
+     * @return 没有站点密钥、字段无效或版本已用完时返回false
+     */
+    bool push(uint32_t fields);
+
+    /**
+     * @brief 设置站点密钥并保存，nullptr表示清除（不再接收和推送）
+     * @details 已应用的版本保留（防重放），只丢弃保存的帧
+     */
+    void setKey(const uint8_t* key);
+
+    bool hasKey() const { return _hasKey; }
+
+    /**
+     * @brief 已应用的版本，0表示没有（PeerSync的包带上它）
+     */
+    uint16_t version() const { return _version; }
+
+    /**
+     * @brief 收到任何设备的PeerSync包时调用：对方的版本落后时转发保存的帧
+     */
+    void onPeerVersion(uint16_t version);
+
+    /**
+     * @brief PeerSync的接收回调转来的帧（WiFi任务中）
+     */
+    void onReceive(const uint8_t* mac, const uint8_t* data, int length);
+
+    void printStatus() const;
+
+private:
+    enum FrameType : uint8_t {
+        FRAME_DELTA = 1,
+        FRAME_ACK = 2
+    };
+
+    enum AckStatus : uint8_t {
+        ACK_APPLIED = 0,            ///< 已应用（或此前已应用了这一版本）
+        ACK_NEWER = 1,              ///< 本机已应用了更新的版本
+        ACK_INVALID = 2             ///< 取值超出范围，没有应用
+    };
+
+    /**
+     * @brief 增量帧的头部（小端，没有填充），之后是取值和签名
+     */
+    struct DeltaHeader {
+        uint8_t magic;
+        uint8_t type;               ///< FRAME_DELTA
+        uint16_t version;
+        uint32_t fields;            ///< ConfigField位，每个置位一个取值
+    };
+
+    struct Ack {
+        uint8_t magic;
+        uint8_t type;               ///< FRAME_ACK
+        uint8_t status;             ///< AckStatus
+        uint8_t reserved;
+        uint16_t version;
+    };
+
+    struct Received {
+        uint8_t mac[6];
+        uint8_t length;
+        uint8_t data[MAX_FRAME];
+    };
+
+    FleetConfig();
+
+    void sign(const uint8_t* data, size_t length, uint8_t* tag) const;
+    void handleDelta(const Received& received);
+    void handleAck(const Received& received);
+    void sendAck(AckStatus status, uint16_t version);
+    void broadcast();
+    void save();
+
+    static void onResend(void* context);
+
+    Preferences _preferences;
+    SpscQueue<Received, 4> _rx;
+    TimerWheel::TimerId _resendTimer;
+
+    uint8_t _key[KEY_SIZE];
+    bool _hasKey;
+    uint16_t _version;              ///< 已应用的版本
+    uint8_t _frame[MAX_FRAME];      ///< 已应用版本的帧（转发给落后的设备）
+    uint8_t _frameLength;
+    uint32_t _pushUntil;            ///< 推送重发的截止时刻（millis）
+    uint32_t _lastBroadcast;
+
+    // 推送方：本次推送的应答
+    uint8_t _ackMacs[FLEET_CONFIG_MAX_ACKS][6];
+    uint8_t _ackCount;
+    uint32_t _acks[3];              ///< 按AckStatus计数
+
+    // 统计
+    uint32_t _broadcasts;
+    uint32_t _applied;
+    uint32_t _badSignatures;
+    uint32_t _dropped;              ///< 接收队列满丢弃的帧
+};
+
+#endif // FLEET_CONFIG_ENABLED
+
+#endif // FLEET_CONFIG_H
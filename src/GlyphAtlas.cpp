@@ -0,0 +1,220 @@
+/**
+ * @file GlyphAtlas.cpp
+ * @brief 预渲染字形缓存实现
+ *
+ * @author Calculator Project
+ */
+
+#include "GlyphAtlas.h"
+#include <Arduino_GFX_Library.h>
+#include "canvas/Arduino_Canvas.h"
+#include "BufferPlacement.h"
+#include "config.h"
+#if DISPLAY_AA_FONT
+#include "AAFontData.h"
+#endif
+
+// 计算器显示会用到的字符：数字、小数点、科学计数法、千位分隔符和运算符
+static constexpr char GLYPH_CHARS[] = "0123456789.-E+*/%e ,";
+static const uint8_t GLYPH_COUNT = sizeof(GLYPH_CHARS) - 1;
+
+#if DISPLAY_AA_FONT
+constexpr bool sameChars(const char *a, const char *b) {
+    return *a == *b && (*a == '\0' || sameChars(a + 1, b + 1));
+}
+static_assert(sameChars(GLYPH_CHARS, AA_FONT_CHARS), "AAFontData.h与GLYPH_CHARS不一致，重新运行tools/font_bake.py");
+#endif
+
+GlyphAtlas::GlyphAtlas() : _setCount(0) {
+    memset(_sets, 0, sizeof(_sets));
+    const DisplayTheme &theme = DISPLAY_THEMES[DISPLAY_THEME_DEFAULT];
+    memcpy(_palette, theme.colors, sizeof(_palette));
+}
+
+GlyphAtlas::~GlyphAtlas() {
+    for (uint8_t i = 0; i < _setCount; i++) {
+        placedFree(_sets[i].rows);
+        if (_sets[i].ownsCoverage) placedFree((void *)_sets[i].coverage);
+    }
+}
+
+int8_t GlyphAtlas::glyphIndex(char c) {
+    for (uint8_t i = 0; i < GLYPH_COUNT; i++) {
+        if (GLYPH_CHARS[i] == c) return i;
+    }
+    return -1;
+}
+
+const GlyphAtlas::GlyphSet *GlyphAtlas::findSet(uint8_t textSize, uint8_t fg, uint8_t bg) const {
+    for (uint8_t i = 0; i < _setCount; i++) {
+        const GlyphSet &set = _sets[i];
+        if (set.textSize == textSize && set.fg == fg && set.bg == bg) {
+            return &set;
+        }
+    }
+    return nullptr;
+}
+
+void GlyphAtlas::setPalette(const uint16_t *colors, uint8_t count) {
+    for (uint8_t i = 0; i < MAX_COLORS && i < count; i++) {
+        _palette[i] = colors[i];
+    }
+}
+
+bool GlyphAtlas::addSet(uint8_t textSize, uint8_t fg, uint8_t bg) {
+    if (textSize == 0 || fg >= MAX_COLORS || bg >= MAX_COLORS) return false;
+    if (findSet(textSize, fg, bg)) return true;
+    if (_setCount >= MAX_SETS) return false;
+
+    const int16_t tileW = FONT_W * textSize;
+    uint8_t rowRepeat = 1;
+    bool ownsCoverage = false;
+    uint32_t coverageBytes = 0;
+    const uint8_t *coverage = antialiasedCoverage(textSize);
+    if (!coverage) {
+        coverage = rasterizeClassic(textSize, coverageBytes);
+        if (!coverage) return false;
+        rowRepeat = textSize;
+        ownsCoverage = true;
+    }
+
+    // 保存的行数：抗锯齿字体全部8*textSize行，内置字体每块只保存一行
+    uint32_t bytes = (uint32_t)GLYPH_COUNT * (FONT_H * textSize / rowRepeat) * tileW * 2;
+    uint16_t *rows = (uint16_t *)placedAlloc("glyph_atlas", bytes, PLACE_PSRAM);
+    if (!rows) {
+        if (ownsCoverage) placedFree((void *)coverage);
+        return false;
+    }
+
+    GlyphSet &set = _sets[_setCount++];
+    set.textSize = textSize;
+    set.fg = fg;
+    set.bg = bg;
+    set.rowRepeat = rowRepeat;
+    set.bytes = bytes + coverageBytes;
+    set.coverage = coverage;
+    set.ownsCoverage = ownsCoverage;
+    set.rows = rows;
+    tint(set);
+    return true;
+}
+
+void GlyphAtlas::tint(GlyphSet &set) const {
+    uint16_t fg = _palette[set.fg];
+    uint16_t bg = _palette[set.bg];
+
+    // 16级覆盖率预先混合为RGB565：各通道在背景色和前景色之间线性插值
+    uint16_t blend[16];
+    for (uint8_t a = 0; a < 16; a++) {
+        uint16_t r = (((fg >> 11) & 0x1F) * a + ((bg >> 11) & 0x1F) * (15 - a) + 7) / 15;
+        uint16_t g = (((fg >> 5) & 0x3F) * a + ((bg >> 5) & 0x3F) * (15 - a) + 7) / 15;
+        uint16_t b = ((fg & 0x1F) * a + (bg & 0x1F) * (15 - a) + 7) / 15;
+        blend[a] = (r << 11) | (g << 5) | b;
+    }
+
+    // 每字节两个像素，高4位在左；格子宽度总是偶数
+    const uint8_t *src = set.coverage;
+    uint16_t *dst = set.rows;
+    const uint16_t *end = set.rows + (size_t)GLYPH_COUNT * (FONT_H * set.textSize / set.rowRepeat) * FONT_W * set.textSize;
+    while (dst < end) {
+        *dst++ = blend[*src >> 4];
+        *dst++ = blend[*src++ & 0x0F];
+    }
+    set.tintFg = fg;
+    set.tintBg = bg;
+}
+
+uint8_t *GlyphAtlas::rasterizeClassic(uint8_t textSize, uint32_t &bytes) {
+    const int16_t tileW = FONT_W * textSize;
+    const int16_t tileH = FONT_H * textSize;
+    bytes = (uint32_t)GLYPH_COUNT * FONT_H * tileW / 2;
+
+    uint8_t *coverage = (uint8_t *)placedAlloc("glyph_atlas", bytes, PLACE_PSRAM);
+    if (!coverage) return nullptr;
+
+    // 用一个无输出的小Canvas借GFX自身的字体绘制，保证与print()逐像素一致
+    Arduino_Canvas tile(tileW, tileH, nullptr);
+    if (!tile.begin(GFX_SKIP_OUTPUT_BEGIN)) {
+        placedFree(coverage);
+        return nullptr;
+    }
+    tile.setTextWrap(false);
+    tile.setTextSize(textSize);
+    tile.setTextColor(0xFFFF, 0x0000);
+
+    uint16_t *fb = tile.getFramebuffer();
+    uint8_t *dst = coverage;
+    for (uint8_t g = 0; g < GLYPH_COUNT; g++) {
+        tile.fillScreen(0x0000);
+        tile.setCursor(0, 0);
+        tile.print(GLYPH_CHARS[g]);
+
+        // 每个源像素行放大后都相同，只取每块的第一行；内置字体只有全覆盖和无覆盖两级
+        for (uint8_t r = 0; r < FONT_H; r++) {
+            const uint16_t *src = fb + (size_t)r * textSize * tileW;
+            for (int16_t c = 0; c < tileW; c += 2) {
+                *dst++ = (src[c] ? 0xF0 : 0x00) | (src[c + 1] ? 0x0F : 0x00);
+            }
+        }
+    }
+    return coverage;
+}
+
+const uint8_t *GlyphAtlas::antialiasedCoverage(uint8_t textSize) {
+#if DISPLAY_AA_FONT
+    if (textSize < AA_FONT_MIN_SIZE || textSize > AA_FONT_MAX_SIZE) return nullptr;
+    return AA_FONT_BITS[textSize - AA_FONT_MIN_SIZE];
+#else
+    (void)textSize;
+    return nullptr;
+#endif
+}
+
+bool GlyphAtlas::canDraw(const char *text, uint8_t textSize, uint8_t fg, uint8_t bg) const {
+    if (!findSet(textSize, fg, bg)) return false;
+    for (const char *p = text; *p; p++) {
+        if (glyphIndex(*p) < 0) return false;
+    }
+    return true;
+}
+
+bool GlyphAtlas::drawText(uint16_t *fb, int16_t fbW, int16_t fbH, int16_t x, int16_t y,
+                          const char *text, uint8_t textSize, uint8_t fg, uint8_t bg) {
+    GlyphSet *set = const_cast<GlyphSet *>(findSet(textSize, fg, bg));
+    if (!set || !fb) return false;
+    if (!canDraw(text, textSize, fg, bg)) return false;
+    // 主题切换后第一次使用时按新颜色重新着色
+    if (set->tintFg != _palette[fg] || set->tintBg != _palette[bg]) tint(*set);
+
+    const int16_t tileW = FONT_W * textSize;
+    const uint8_t storedRows = FONT_H * textSize / set->rowRepeat;
+
+    for (const char *p = text; *p; p++, x += tileW) {
+        // 横向裁剪
+        if (x >= fbW) break;
+        int16_t colStart = x < 0 ? -x : 0;
+        int16_t colEnd = (x + tileW > fbW) ? fbW - x : tileW;
+        if (colEnd <= colStart) continue;
+
+        const uint16_t *glyph = set->rows + (size_t)glyphIndex(*p) * storedRows * tileW;
+
+        for (uint8_t r = 0; r < storedRows; r++) {
+            const uint16_t *src = glyph + (size_t)r * tileW + colStart;
+            int16_t rowTop = y + r * set->rowRepeat;
+            for (uint8_t k = 0; k < set->rowRepeat; k++) {
+                int16_t py = rowTop + k;
+                if (py < 0 || py >= fbH) continue;
+                memcpy(fb + (int32_t)py * fbW + x + colStart, src, (colEnd - colStart) * 2);
+            }
+        }
+    }
+    return true;
+}
+
+uint32_t GlyphAtlas::getMemoryUsage() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < _setCount; i++) {
+        total += _sets[i].bytes;
+    }
+    return total;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file GlyphAtlas.h
+ * @brief 预渲染字形缓存
+ * @details 把内置6x8字体中常用字符按指定字号预先栅格化为RGB565，
+ * 绘制时直接按行复制到Canvas帧缓冲，代替逐像素fillRect。
+ *
+ * 颜色以调色板索引（ThemeColor）指定：
+ * - 每组字形同时保存4-bpp覆盖率，着色时按16级覆盖率在背景色和前景色之间混合
+ * - setPalette()只记录新颜色；各组在下次绘制时发现颜色变化才重新着色，不重新栅格化
+ *
+ * 内置字体放大textSize倍时，每个源像素行会被重复textSize次，
+ * 因此每个字形只保存8条放大后的行（宽6*textSize），绘制时每行复制textSize次。
+ *
+ * DISPLAY_AA_FONT启用时，字号在烘焙范围内的组合改用抗锯齿字体（AAFontData.h，
+ * 由tools/font_bake.py生成的4-bpp覆盖率）：
+ * - 格子与内置字体放大后相同（宽6*textSize、高8*textSize），排版和局部重绘不变
+ * - 覆盖率直接引用闪存中的烘焙数据，着色后保存全部8*textSize行，绘制仍是逐行复制
+ *
+ * @author Calculator Project
+ */
+
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <Arduino.h>
+#include "DisplayTheme.h"
+
+class GlyphAtlas {
+public:
+    static const uint8_t MAX_SETS = 8;          ///< 最多缓存的(字号, 前景色, 背景色)组合
+    static const uint8_t MAX_COLORS = THEME_COLOR_COUNT;  ///< 调色板颜色数
+    static const uint8_t FONT_W = 6;            ///< 内置字体字符宽度（含1像素间隔）
+    static const uint8_t FONT_H = 8;            ///< 内置字体字符高度
+
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    /**
+     * @brief 设置调色板（与绘制在同一任务调用）
+     * @details 已缓存的字形保留覆盖率，下次绘制时才按新颜色重新着色
+     */
+    void setPalette(const uint16_t *colors, uint8_t count);
+
+    /**
+     * @brief 为指定字号和颜色组合预渲染字形
+     * @param fg,bg 调色板索引
+     * @return 成功或已存在返回true；内存不足或组合已满返回false
+     */
+    bool addSet(uint8_t textSize, uint8_t fg, uint8_t bg);
+
+    /**
+     * @brief 文本中的所有字符是否都能用缓存绘制
+     */
+    bool canDraw(const char *text, uint8_t textSize, uint8_t fg, uint8_t bg) const;
+
+    /**
+     * @brief 把文本直接绘制到RGB565帧缓冲（自动裁剪）
+     * @details 组的颜色与当前调色板不同时先重新着色
+     * @return 全部字符都在缓存中并已绘制返回true，否则不绘制任何内容返回false
+     */
+    bool drawText(uint16_t *fb, int16_t fbW, int16_t fbH, int16_t x, int16_t y,
+                  const char *text, uint8_t textSize, uint8_t fg, uint8_t bg);
+
+    /**
+     * @brief 已占用的缓存字节数
+     */
+    uint32_t getMemoryUsage() const;
+
+private:
+    struct GlyphSet {
+        uint8_t textSize;
+        uint8_t fg;                 ///< 前景色调色板索引
+        uint8_t bg;                 ///< 背景色调色板索引
+        uint8_t rowRepeat;          ///< 每条保存的行绘制几次：内置字体为textSize，抗锯齿字体为1
+        uint16_t tintFg;            ///< rows当前着色所用的前景色
+        uint16_t tintBg;            ///< rows当前着色所用的背景色
+        uint32_t bytes;
+        const uint8_t *coverage;    ///< 4-bpp覆盖率，与rows逐像素对应，高4位在左
+        bool ownsCoverage;          ///< coverage为堆内存（内置字体）而非闪存中的烘焙数据
+        uint16_t *rows;             ///< [字形][8*textSize/rowRepeat行][6*textSize像素]
+    };
+
+    const GlyphSet *findSet(uint8_t textSize, uint8_t fg, uint8_t bg) const;
+    void tint(GlyphSet &set) const;
+    static int8_t glyphIndex(char c);
+    static uint8_t *rasterizeClassic(uint8_t textSize, uint32_t &bytes);
+    static const uint8_t *antialiasedCoverage(uint8_t textSize);
+
+    GlyphSet _sets[MAX_SETS];
+    uint8_t _setCount;
+    uint16_t _palette[MAX_COLORS];
+};
+
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,234 @@
+/**
+ * @file HistoryBuffer.cpp
+ * @brief 两级环形缓冲的计算历史实现
+ *
+ * @author Calculator Project
+ */
+
+#include "HistoryBuffer.h"
+#include "Expression.h"
+#include "NumberFormatter.h"
+#include "Logger.h"
+#include "BufferPlacement.h"
+#include <string.h>
+
+HistoryBuffer::HistoryBuffer()
+    : _recentHead(0),
+      _recentCount(0),
+      _archive(nullptr),
+      _archiveHead(0),
+      _archiveCount(0) {
+}
+
+HistoryBuffer::~HistoryBuffer() {
+    if (_archive) {
+        placedFree(_archive);
+        _archive = nullptr;
+    }
+}
+
+bool HistoryBuffer::begin() {
+    if (_archive) return true;
+
+    // 只使用PSRAM：没有PSRAM时不占用内部RAM，只保留近期记录
+    size_t bytes = sizeof(Entry) * ARCHIVE_CAPACITY;
+    _archive = (Entry *)placedAlloc("history", bytes, PLACE_PSRAM_ONLY);
+    if (!_archive) {
+        CALC_LOG_W("历史归档缓冲分配失败，只保留最近%u条", RECENT_CAPACITY);
+        return false;
+    }
+    CALC_LOG_I("历史归档缓冲: %u条, %u字节", ARCHIVE_CAPACITY, (unsigned)bytes);
+    return true;
+}
+
+void HistoryBuffer::clear() {
+    _recentHead = 0;
+    _recentCount = 0;
+    _archiveHead = 0;
+    _archiveCount = 0;
+}
+
+void HistoryBuffer::append(const Expression &expression, double result, uint32_t timestamp) {
+    Entry &slot = push();
+    encode(expression, slot.record);
+    slot.record.result = result;
+    slot.record.timestamp = timestamp;
+    format(slot.record, slot.text, LINE_SIZE);
+}
+
+void HistoryBuffer::appendRecord(const HistoryRecord &record) {
+    Entry &slot = push();
+    memcpy(&slot.record, &record, sizeof(HistoryRecord));
+    format(slot.record, slot.text, LINE_SIZE);
+}
+
+HistoryBuffer::Entry &HistoryBuffer::push() {
+    Entry &slot = _recent[_recentHead];
+
+    // 近期缓冲已满：即将被覆盖的最旧记录连同文本移入归档
+    if (_recentCount == RECENT_CAPACITY) {
+        if (_archive) {
+            memcpy(&_archive[_archiveHead], &slot, sizeof(Entry));
+            _archiveHead = (_archiveHead + 1) % ARCHIVE_CAPACITY;
+            if (_archiveCount < ARCHIVE_CAPACITY) _archiveCount++;
+        }
+    } else {
+        _recentCount++;
+    }
+
+    _recentHead = (_recentHead + 1) % RECENT_CAPACITY;
+    return slot;
+}
+
+const HistoryRecord *HistoryBuffer::get(size_t index) const {
+    const Entry *found = entry(index);
+    return found ? &found->record : nullptr;
+}
+
+const char *HistoryBuffer::line(size_t index) const {
+    const Entry *found = entry(index);
+    return found ? found->text : "";
+}
+
+const HistoryBuffer::Entry *HistoryBuffer::entry(size_t index) const {
+    if (index < _recentCount) {
+        return &_recent[(_recentHead + RECENT_CAPACITY - 1 - index) % RECENT_CAPACITY];
+    }
+    index -= _recentCount;
+    if (index < _archiveCount) {
+        return &_archive[(_archiveHead + ARCHIVE_CAPACITY - 1 - index) % ARCHIVE_CAPACITY];
+    }
+    return nullptr;
+}
+
+void HistoryBuffer::encode(const Expression &expression, HistoryRecord &record) {
+    record.tokenCount = 0;
+    record.truncated = false;
+
+    uint8_t numberCount = 0;
+    for (uint8_t i = 0; i < expression.size(); i++) {
+        const ExprToken &token = expression.tokenAt(i);
+        if (record.tokenCount >= HistoryRecord::MAX_TOKENS ||
+            (token.type == ExprTokenType::NUMBER && numberCount >= HistoryRecord::MAX_NUMBERS)) {
+            record.truncated = true;
+            return;
+        }
+
+        uint8_t code;
+        switch (token.type) {
+            case ExprTokenType::NUMBER:
+                record.numbers[numberCount++] = token.value;
+                code = HistoryRecord::TOKEN_NUMBER;
+                break;
+            case ExprTokenType::LPAREN:
+                code = '(';
+                break;
+            case ExprTokenType::RPAREN:
+                code = ')';
+                break;
+            default:
+                if (token.textLength == 0) {
+                    code = HistoryRecord::TOKEN_IMPLICIT_MUL;
+                    break;
+                }
+                switch (token.op) {
+                    case Operator::ADD: code = '+'; break;
+                    case Operator::SUBTRACT: code = '-'; break;
+                    case Operator::MULTIPLY: code = '*'; break;
+                    case Operator::DIVIDE: code = '/'; break;
+                    case Operator::POWER: code = '^'; break;
+                    default: code = '?'; break;
+                }
+                break;
+        }
+        record.tokens[record.tokenCount++] = code;
+    }
+}
+
+size_t HistoryBuffer::format(const HistoryRecord &record, char *buf, size_t size) {
+    if (!buf || size == 0) return 0;
+
+    size_t len = 0;
+    uint8_t numberIndex = 0;
+    char number[NumberFormatter::BUFFER_SIZE];
+    buf[0] = '\0';
+
+    // 追加文本，放不下时截断
+    auto put = [&](const char *text) {
+        size_t n = strlen(text);
+        if (len + n >= size) n = size - 1 - len;
+        memcpy(buf + len, text, n);
+        len += n;
+        buf[len] = '\0';
+    };
+
+    // 记录可能来自闪存，计数按容量截断
+    uint8_t tokenCount = record.tokenCount < HistoryRecord::MAX_TOKENS ? record.tokenCount : HistoryRecord::MAX_TOKENS;
+    for (uint8_t i = 0; i < tokenCount; i++) {
+        uint8_t code = record.tokens[i];
+        if (code == HistoryRecord::TOKEN_NUMBER) {
+            if (numberIndex >= HistoryRecord::MAX_NUMBERS) break;
+            NumberFormatter::formatTo(record.numbers[numberIndex++], number, sizeof(number));
+            put(number);
+        } else if (code != HistoryRecord::TOKEN_IMPLICIT_MUL) {
+            char symbol[2] = {(char)code, '\0'};
+            put(symbol);
+        }
+    }
+    if (record.truncated) put("...");
+    put("=");
+    NumberFormatter::formatTo(record.result, number, sizeof(number));
+    put(number);
+    return len;
+}
+
+uint8_t HistoryBuffer::decode(const HistoryRecord &record, ExprToken *tokens, char *text, size_t size) {
+    // 只保存了开头部分的记录还原不出原来的表达式
+    if (!tokens || !text || size == 0 || record.truncated ||
+        record.tokenCount == 0 || record.tokenCount > HistoryRecord::MAX_TOKENS) {
+        return 0;
+    }
+
+    size_t len = 0;
+    uint8_t numberIndex = 0;
+    char symbol[NumberFormatter::BUFFER_SIZE];
+    text[0] = '\0';
+
+    for (uint8_t i = 0; i < record.tokenCount; i++) {
+        uint8_t code = record.tokens[i];
+        ExprToken &token = tokens[i];
+        token.type = ExprTokenType::OPERATOR;
+        token.op = Operator::NONE;
+        token.value = 0.0;
+        symbol[0] = (char)code;
+        symbol[1] = '\0';
+
+        switch (code) {
+            case HistoryRecord::TOKEN_NUMBER:
+                if (numberIndex >= HistoryRecord::MAX_NUMBERS) return 0;
+                token.type = ExprTokenType::NUMBER;
+                token.value = record.numbers[numberIndex++];
+                NumberFormatter::formatTo(token.value, symbol, sizeof(symbol));
+                break;
+            case HistoryRecord::TOKEN_IMPLICIT_MUL:
+                token.op = Operator::MULTIPLY;
+                symbol[0] = '\0';
+                break;
+            case '(': token.type = ExprTokenType::LPAREN; break;
+            case ')': token.type = ExprTokenType::RPAREN; break;
+            case '+': token.op = Operator::ADD; break;
+            case '-': token.op = Operator::SUBTRACT; break;
+            case '*': token.op = Operator::MULTIPLY; break;
+            case '/': token.op = Operator::DIVIDE; break;
+            case '^': token.op = Operator::POWER; break;
+            default: return 0;
+        }
+
+        size_t n = strlen(symbol);
+        if (len + n >= size) return 0;
+        memcpy(text + len, symbol, n + 1);
+        len += n;
+        token.textLength = (uint8_t)n;
+    }
+    return record.tokenCount;
+}
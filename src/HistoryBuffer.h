@@ -0,0 +1,125 @@
+/**
+ * @file HistoryBuffer.h
+ * @brief 两级环形缓冲的计算历史
+ * @details 每条记录是定长的紧凑结构（记号编码 + 数字 + 结果），不含String：
+ * - 近期记录保存在对象内部的环形缓冲（内部RAM）
+ * - 近期缓冲写满后，最旧的一条移入PSRAM中的归档环形缓冲，可保存数千条
+ * - 追加和按序号随机访问都是O(1)，序号0为最新一条
+ * - 记录插入后不再改变，"表达式=结果"文本在插入时格式化一次，与记录存放在一起，
+ *   显示时直接引用（line()），翻看历史不再重复格式化数字
+ * - 调出再编辑时由decode()把记号编码直接还原为表达式记号，不经过文本解析
+ *
+ * 没有PSRAM时只保留近期记录，行为与之前的10条上限相同。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef HISTORY_BUFFER_H
+#define HISTORY_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Expression;
+struct ExprToken;
+
+/**
+ * @brief 紧凑的历史记录
+ * @details tokens[]每个字节是一个记号：TOKEN_NUMBER表示按顺序取numbers[]中的下一个数字，
+ *          TOKEN_IMPLICIT_MUL为隐式乘法，其余为运算符或括号的ASCII符号
+ */
+struct HistoryRecord {
+    static const uint8_t MAX_TOKENS = 24;       ///< 最多保存的记号数
+    static const uint8_t MAX_NUMBERS = 12;      ///< 最多保存的数字个数
+    static const uint8_t TOKEN_NUMBER = 0;
+    static const uint8_t TOKEN_IMPLICIT_MUL = 1;
+
+    double result;                  ///< 计算结果
+    double numbers[MAX_NUMBERS];    ///< 表达式中的数字
+    uint32_t timestamp;             ///< 时间戳（millis）
+    uint8_t tokens[MAX_TOKENS];     ///< 记号编码
+    uint8_t tokenCount;             ///< 记号数
+    bool truncated;                 ///< 表达式过长，只保存了开头部分
+};
+
+class HistoryBuffer {
+public:
+    static const uint8_t RECENT_CAPACITY = 16;      ///< 近期记录（内部RAM）条数
+    static const uint16_t ARCHIVE_CAPACITY = 2048;  ///< 归档记录（PSRAM）条数
+    static const size_t LINE_SIZE = 64;             ///< 缓存文本的字节数（含'\0'），与DisplayModel::TEXT_LEN相同
+
+    HistoryBuffer();
+    ~HistoryBuffer();
+
+    /**
+     * @brief 分配PSRAM归档缓冲
+     * @return 归档缓冲可用返回true；失败时只使用近期记录
+     */
+    bool begin();
+
+    /**
+     * @brief 追加一条记录
+     * @param expression 已输入完整的表达式
+     * @param result 计算结果
+     * @param timestamp 时间戳
+     */
+    void append(const Expression &expression, double result, uint32_t timestamp);
+
+    /**
+     * @brief 追加一条已编码的记录（从闪存日志恢复时使用）
+     */
+    void appendRecord(const HistoryRecord &record);
+
+    /**
+     * @brief 按序号访问，0为最新一条
+     * @return 序号超出范围时返回nullptr
+     */
+    const HistoryRecord *get(size_t index) const;
+
+    /**
+     * @brief 插入时格式化好的"表达式=结果"，超出LINE_SIZE - 1的部分已截断
+     * @return 序号超出范围时返回""
+     */
+    const char *line(size_t index) const;
+
+    size_t size() const { return _recentCount + _archiveCount; }
+    size_t capacity() const { return RECENT_CAPACITY + (_archive ? ARCHIVE_CAPACITY : 0); }
+    bool hasArchive() const { return _archive != nullptr; }
+
+    void clear();
+
+    /**
+     * @brief 把记录格式化为 "表达式=结果"（需要完整文本时使用，如主机通道）
+     * @return 写入的字符数
+     */
+    static size_t format(const HistoryRecord &record, char *buf, size_t size);
+
+    /**
+     * @brief 把记录还原为表达式记号和表达式文本（调出历史再编辑时使用，不解析文本）
+     * @param tokens 至少HistoryRecord::MAX_TOKENS个，数字的textLength按text中的长度填写
+     * @param text 输出表达式文本（不含"=结果"）
+     * @return 记号数；记录被截断、含无法识别的记号或文本放不下时返回0
+     */
+    static uint8_t decode(const HistoryRecord &record, ExprToken *tokens, char *text, size_t size);
+
+private:
+    // 记录和它的显示文本
+    struct Entry {
+        HistoryRecord record;
+        char text[LINE_SIZE];
+    };
+
+    Entry &push();              // 占用下一个位置，必要时把最旧的近期记录移入归档
+    const Entry *entry(size_t index) const;
+    static void encode(const Expression &expression, HistoryRecord &record);
+
+    Entry _recent[RECENT_CAPACITY];             ///< 近期环形缓冲
+    uint8_t _recentHead;                        ///< 下一条写入位置
+    uint8_t _recentCount;
+
+    Entry *_archive;                            ///< PSRAM归档环形缓冲
+    uint16_t _archiveHead;                      ///< 下一条写入位置
+    uint16_t _archiveCount;
+};
+
+#endif // HISTORY_BUFFER_H
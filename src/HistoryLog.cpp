@@ -0,0 +1,216 @@
+/**
+ * @file HistoryLog.cpp
+ * @brief 计算历史的闪存日志实现
+ *
+ * @author Calculator Project
+ */
+
+#include "HistoryLog.h"
+#include "Logger.h"
+#include "TimerWheel.h"
+#include <LittleFS.h>
+#include <esp_rom_crc.h>
+#include <stddef.h>
+#include <string.h>
+
+#define HISTORY_LOG_PATH     "/history.log"
+#define HISTORY_LOG_OLD_PATH "/history.old"
+#define HISTORY_LOG_MAGIC    0x48495354UL   // "HIST"
+
+HistoryLog::HistoryLog()
+    : _ready(false),
+      _idleMs(3000),
+      _maxRecords(4096),
+      _sequence(0),
+      _written(0),
+      _flushTimer(TimerWheel::INVALID),
+      _pendingCount(0) {
+}
+
+bool HistoryLog::begin(uint32_t idleMs, uint32_t maxRecords) {
+    _idleMs = idleMs;
+    _maxRecords = maxRecords;
+    _flushTimer = TimerWheel::instance().create("history", [](void *context) {
+        static_cast<HistoryLog *>(context)->flush();
+    }, this);
+
+    // 首次使用时分区未格式化，允许自动格式化
+    if (!LittleFS.begin(true)) {
+        CALC_LOG_E("LittleFS挂载失败，历史记录不会保存");
+        return false;
+    }
+    _ready = true;
+
+    // 序号从最后一条有效记录继续
+    LogRecord last;
+    if (readTail(HISTORY_LOG_PATH, &last, 1) == 1 || readTail(HISTORY_LOG_OLD_PATH, &last, 1) == 1) {
+        _sequence = last.sequence + 1;
+    }
+    CALC_LOG_I("历史日志就绪，下一序号: %lu", (unsigned long)_sequence);
+    return true;
+}
+
+void HistoryLog::append(const HistoryRecord &record) {
+    // 队列满且还没来得及写入时丢弃最旧的一条，按键路径上不访问闪存
+    if (_pendingCount == PENDING_CAPACITY) {
+        memmove(&_pending[0], &_pending[1], sizeof(HistoryRecord) * (PENDING_CAPACITY - 1));
+        _pendingCount--;
+        CALC_LOG_W("历史日志队列已满，丢弃最旧的一条");
+    }
+    memcpy(&_pending[_pendingCount++], &record, sizeof(HistoryRecord));
+    // 队列写满时下一轮就写，否则等最后一次追加后空闲一段时间
+    TimerWheel::instance().start(_flushTimer, _pendingCount == PENDING_CAPACITY ? 0 : _idleMs);
+}
+
+void HistoryLog::flush() {
+    if (!_ready || _pendingCount == 0) return;
+
+    File file = LittleFS.open(HISTORY_LOG_PATH, "a");
+    if (!file) {
+        CALC_LOG_E("历史日志打开失败");
+        return;
+    }
+
+    // 当前段写满时轮换：旧段被覆盖，只保留两段
+    if (file.size() / sizeof(LogRecord) + _pendingCount > _maxRecords) {
+        file.close();
+        LittleFS.remove(HISTORY_LOG_OLD_PATH);
+        LittleFS.rename(HISTORY_LOG_PATH, HISTORY_LOG_OLD_PATH);
+        file = LittleFS.open(HISTORY_LOG_PATH, "a");
+        if (!file) {
+            CALC_LOG_E("历史日志轮换失败");
+            return;
+        }
+        CALC_LOG_I("历史日志已轮换");
+    }
+
+    uint32_t start = millis();
+    LogRecord entry;
+    uint8_t count = _pendingCount;
+    for (uint8_t i = 0; i < count; i++) {
+        memset(&entry, 0, sizeof(entry));
+        entry.magic = HISTORY_LOG_MAGIC;
+        entry.sequence = _sequence++;
+        memcpy(&entry.record, &_pending[i], sizeof(HistoryRecord));
+        entry.crc = recordCrc(entry);
+        if (file.write((const uint8_t *)&entry, sizeof(entry)) != sizeof(entry)) {
+            CALC_LOG_E("历史日志写入失败（分区已满？）");
+            break;
+        }
+        _written++;
+    }
+    file.close();
+    _pendingCount = 0;
+
+    CALC_LOG_D("历史日志写入 %u 条，耗时 %lu ms", count, millis() - start);
+}
+
+size_t HistoryLog::loadTail(HistoryBuffer &history, size_t count) {
+    if (!_ready || count == 0) return 0;
+
+    LogRecord *entries = (LogRecord *)malloc(sizeof(LogRecord) * count);
+    if (!entries) return 0;
+
+    // 当前段不够时从旧段末尾补齐，旧段的记录排在前面
+    size_t loaded = readTail(HISTORY_LOG_PATH, entries, count);
+    if (loaded < count) {
+        size_t missing = count - loaded;
+        memmove(&entries[missing], &entries[0], sizeof(LogRecord) * loaded);
+        size_t older = readTail(HISTORY_LOG_OLD_PATH, entries, missing);
+        if (older < missing) {
+            memmove(&entries[older], &entries[missing], sizeof(LogRecord) * loaded);
+        }
+        loaded += older;
+    }
+
+    for (size_t i = 0; i < loaded; i++) {
+        history.appendRecord(entries[i].record);
+    }
+    free(entries);
+
+    CALC_LOG_I("从历史日志加载 %u 条", (unsigned)loaded);
+    return loaded;
+}
+
+size_t HistoryLog::readFrom(uint32_t sequence, RecordVisitor visit, void *context) {
+    if (!_ready) return 0;
+    size_t visited = 0;
+    if (readSegment(HISTORY_LOG_OLD_PATH, sequence, visit, context, visited)) {
+        readSegment(HISTORY_LOG_PATH, sequence, visit, context, visited);
+    }
+    return visited;
+}
+
+bool HistoryLog::readSegment(const char *path, uint32_t sequence, RecordVisitor visit, void *context,
+                             size_t &visited) {
+    if (!LittleFS.exists(path)) return true;
+
+    File file = LittleFS.open(path, "r");
+    if (!file) return true;
+
+    // 段内序号递增，写入失败时会跳过序号，所以第i条的序号不小于首条序号+i：
+    // 从按序号估计的位置往前退，直到前一条早于要找的序号
+    size_t total = file.size() / sizeof(LogRecord);
+    LogRecord entry;
+    size_t start = 0;
+    if (total && file.read((uint8_t *)&entry, sizeof(entry)) == sizeof(entry) &&
+        entry.magic == HISTORY_LOG_MAGIC && entry.crc == recordCrc(entry) && sequence > entry.sequence) {
+        start = sequence - entry.sequence < total ? sequence - entry.sequence : total;
+        while (start > 1) {
+            file.seek((start - 1) * sizeof(LogRecord));
+            if (file.read((uint8_t *)&entry, sizeof(entry)) == sizeof(entry) &&
+                entry.magic == HISTORY_LOG_MAGIC && entry.crc == recordCrc(entry) && entry.sequence < sequence) {
+                break;
+            }
+            start--;
+        }
+    }
+
+    bool more = true;
+    file.seek(start * sizeof(LogRecord));
+    for (size_t i = start; i < total && more; i++) {
+        if (file.read((uint8_t *)&entry, sizeof(entry)) != sizeof(entry)) break;
+        if (entry.magic != HISTORY_LOG_MAGIC || entry.crc != recordCrc(entry) || entry.sequence < sequence) {
+            continue;
+        }
+        more = visit(entry.sequence, entry.record, context);
+        if (more) visited++;
+    }
+    file.close();
+    return more;
+}
+
+void HistoryLog::erase() {
+    _pendingCount = 0;
+    if (!_ready) return;
+    LittleFS.remove(HISTORY_LOG_PATH);
+    LittleFS.remove(HISTORY_LOG_OLD_PATH);
+    CALC_LOG_I("历史日志已清除");
+}
+
+uint32_t HistoryLog::recordCrc(const LogRecord &entry) {
+    return esp_rom_crc32_le(0, (const uint8_t *)&entry, offsetof(LogRecord, crc));
+}
+
+size_t HistoryLog::readTail(const char *path, LogRecord *out, size_t count) {
+    if (!LittleFS.exists(path)) return 0;
+
+    File file = LittleFS.open(path, "r");
+    if (!file) return 0;
+
+    // 末尾不完整的记录（写入时掉电）直接忽略
+    size_t total = file.size() / sizeof(LogRecord);
+    size_t first = total > count ? total - count : 0;
+    file.seek(first * sizeof(LogRecord));
+
+    size_t valid = 0;
+    for (size_t i = first; i < total; i++) {
+        LogRecord &entry = out[valid];
+        if (file.read((uint8_t *)&entry, sizeof(LogRecord)) != sizeof(LogRecord)) break;
+        if (entry.magic == HISTORY_LOG_MAGIC && entry.crc == recordCrc(entry)) {
+            valid++;
+        }
+    }
+    file.close();
+    return valid;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file HistoryLog.h
+ * @brief 计算历史的闪存日志
+ * @details 历史记录以定长二进制记录追加写入LittleFS（partitions.csv的spiffs分区）：
+ * - 每条记录带魔数、序号和CRC32，掉电写坏的记录在加载时被跳过
+ * - append()只放入内存队列，不访问闪存；空闲一段时间后（时间轮定时器）或进入休眠前批量写入
+ * - 当前日志写满后改名为旧日志再新建，最多保留两段
+ * - 启动时只从文件末尾读取显示需要的几条，不解析整个日志
+ * - readFrom()按序号顺序读取某条之后的记录（历史同步用），可以在其他任务中调用
+ *
+ * @author Calculator Project
+ */
+
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include <Arduino.h>
+#include "HistoryBuffer.h"
+#include "TimerWheel.h"
+
+class HistoryLog {
+public:
+    static const uint8_t PENDING_CAPACITY = 16;     ///< 内存队列容量，写满时立即写入
+
+    /**
+     * @brief readFrom()的记录处理函数
+     * @return false 停止读取
+     */
+    typedef bool (*RecordVisitor)(uint32_t sequence, const HistoryRecord &record, void *context);
+
+    static HistoryLog& instance() {
+        static HistoryLog instance;
+        return instance;
+    }
+
+    /**
+     * @brief 挂载文件系统
+     * @param idleMs 最后一次追加后空闲多久写入闪存
+     * @param maxRecords 单段日志的最大记录数
+     * @return 挂载成功返回true；失败时append()仍可调用，只是不落盘
+     */
+    bool begin(uint32_t idleMs, uint32_t maxRecords);
+
+    /**
+     * @brief 追加一条记录到内存队列（按键路径调用，不访问闪存）
+     */
+    void append(const HistoryRecord &record);
+
+    /**
+     * @brief 立即写入队列中的所有记录（进入休眠前调用）
+     */
+    void flush();
+
+    /**
+     * @brief 从日志末尾读取最近的记录并按时间顺序加入历史
+     * @param history 目标历史缓冲
+     * @param count 最多读取的条数
+     * @return 实际加载的条数
+     */
+    size_t loadTail(HistoryBuffer &history, size_t count);
+
+    /**
+     * @brief 按序号顺序读取已写入闪存的记录（旧段在前）
+     * @param sequence 从这个序号开始（含），更早的记录跳过
+     * @param visit 每条记录调用一次，返回false时停止（这条不计入）
+     * @return visit接受的记录数
+     */
+    size_t readFrom(uint32_t sequence, RecordVisitor visit, void *context);
+
+    /**
+     * @brief 删除全部日志
+     */
+    void erase();
+
+    bool isReady() const { return _ready; }
+    uint32_t getWrittenCount() const { return _written; }
+    uint32_t getNextSequence() const { return _sequence; }
+    uint8_t getPendingCount() const { return _pendingCount; }
+
+private:
+    HistoryLog();
+
+    /**
+     * @brief 闪存中的定长记录
+     */
+    struct LogRecord {
+        uint32_t magic;             ///< 固定魔数，用于识别记录
+        uint32_t sequence;          ///< 递增序号
+        HistoryRecord record;       ///< 历史记录
+        uint32_t crc;               ///< 前面所有字节的CRC32
+    };
+
+    static uint32_t recordCrc(const LogRecord &entry);
+    size_t readTail(const char *path, LogRecord *out, size_t count);   // 读取文件末尾最多count条有效记录
+    bool readSegment(const char *path, uint32_t sequence, RecordVisitor visit, void *context, size_t &visited);
+
+    bool _ready;
+    uint32_t _idleMs;
+    uint32_t _maxRecords;
+    uint32_t _sequence;                         ///< 下一条记录的序号
+    uint32_t _written;                          ///< 本次启动写入的记录数
+    TimerWheel::TimerId _flushTimer;            ///< 每次追加重新计时，空闲_idleMs后写入
+
+    HistoryRecord _pending[PENDING_CAPACITY];   ///< 待写入的记录
+    uint8_t _pendingCount;
+};
+
+#endif // HISTORY_LOG_H
@@ -0,0 +1,407 @@
+/**
+ * @file HistorySync.cpp
+ * @brief 计算历史的后台WiFi同步实现
+ *
+ * @author Calculator Project
+ */
+
+#include "HistorySync.h"
+
+#if HISTORY_SYNC_ENABLED && HISTORY_LOG_ENABLED
+
+#include "HistoryLog.h"
+#include "PeerSync.h"
+#include "Console.h"
+#include "BufferPlacement.h"
+#include "Logger.h"
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+#include <esp_rom_crc.h>
+#include <math.h>
+#include "esp32s3/rom/miniz.h"
+
+#define TAG_SYNC "HistorySync"
+
+#define SYNC_NAMESPACE "history_sync"
+#define SYNC_GZIP_HEADER 10
+#define SYNC_GZIP_TRAILER 8
+#define SYNC_DEFLATE_PROBES 32      // 每个位置的匹配查找次数，文本重复度高，少量查找已足够
+
+namespace {
+
+// sync_ca粘贴的证书，读到结束行后保存
+char* s_caText = nullptr;
+size_t s_caLength = 0;
+
+void cmdSync(const ConsoleArgs& args) {
+    if (args.is(1, "now")) {
+        HistorySync::instance().request();
+        Serial.println("已请求同步");
+    } else {
+        HistorySync::instance().printStatus();
+    }
+}
+
+bool caSink(const char* data, size_t length, void* context) {
+    for (size_t i = 0; i < length; i++) {
+        if (s_caLength + 1 >= HistorySync::CA_MAX) {
+            Serial.println("❌ 证书超过长度上限，未保存");
+            free(s_caText);
+            s_caText = nullptr;
+            return false;
+        }
+        s_caText[s_caLength++] = data[i];
+    }
+    s_caText[s_caLength] = '\0';
+    if (!strstr(s_caText, "-----END CERTIFICATE-----")) {
+        return true;
+    }
+    Serial.println(HistorySync::instance().setCa(s_caText) ? "✅ CA证书已保存" : "❌ CA证书保存失败");
+    free(s_caText);
+    s_caText = nullptr;
+    return false;
+}
+
+void cmdSyncCa(const ConsoleArgs& args) {
+    if (args.is(1, "clear")) {
+        HistorySync::instance().setCa("");
+        Serial.println("CA证书已删除");
+        return;
+    }
+    free(s_caText);
+    s_caText = (char*)malloc(HistorySync::CA_MAX);
+    if (!s_caText) {
+        Serial.println("内存不足");
+        return;
+    }
+    s_caLength = 0;
+    Console::instance().setSink(caSink, nullptr);
+    Serial.println("请粘贴服务器的CA证书（PEM），读到 -----END CERTIFICATE----- 后保存");
+}
+
+void cmdSyncServer(const ConsoleArgs& args) {
+    if (args.count < 2) {
+        Serial.println("使用: sync_server <http(s)://地址> [令牌]");
+    } else if (!HistorySync::instance().setServer(args.arg(1), args.arg(2))) {
+        Serial.println("地址无效、过长或同步进行中");
+    } else {
+        Serial.println("服务器地址已保存");
+    }
+}
+
+void cmdWifiSet(const ConsoleArgs& args) {
+    if (args.count < 2) {
+        Serial.println("使用: wifi_set <名称> [密码]");
+    } else if (!HistorySync::instance().setWifi(args.arg(1), args.arg(2))) {
+        Serial.println("名称或密码过长，或同步进行中");
+    } else {
+        Serial.println("WiFi设置已保存");
+    }
+}
+
+constexpr ConsoleCommand SYNC_COMMANDS[] = {
+    {"sync", "[now]", "显示历史同步状态（now立即同步）", cmdSync},
+    {"sync_ca", "[clear]", "粘贴服务器的CA证书（clear删除）", cmdSyncCa},
+    {"sync_server", "<url> [令牌]", "设置历史同步的服务器地址和令牌", cmdSyncServer},
+    {"wifi_set", "<名称> [密码]", "设置历史同步使用的WiFi", cmdWifiSet},
+};
+static_assert(consoleSorted(SYNC_COMMANDS), "命令表必须按名称排序");
+
+bool copyText(char* out, size_t size, const char* text) {
+    size_t length = strlen(text);
+    if (length >= size) return false;
+    memcpy(out, text, length + 1);
+    return true;
+}
+
+} // namespace
+
+HistorySync::HistorySync()
+    : _task(nullptr),
+      _busy(false),
+      _ca(nullptr),
+      _cursor(0),
+      _batchEnd(0),
+      _text(nullptr),
+      _textLength(0),
+      _gzip(nullptr),
+      _compressor(nullptr),
+      _uploaded(0),
+      _bytesSent(0),
+      _lastSync(0),
+      _lastStatus(0) {
+    _ssid[0] = _password[0] = _url[0] = _token[0] = '\0';
+}
+
+bool HistorySync::begin() {
+    if (!_preferences.begin(SYNC_NAMESPACE, false)) {
+        LOG_E(TAG_SYNC, "无法打开NVS");
+        return false;
+    }
+    _preferences.getString("ssid", _ssid, sizeof(_ssid));
+    _preferences.getString("pass", _password, sizeof(_password));
+    _preferences.getString("url", _url, sizeof(_url));
+    _preferences.getString("token", _token, sizeof(_token));
+    _cursor = _preferences.getULong("cursor", 0);
+    size_t caLength = _preferences.getBytesLength("ca");
+    if (caLength) {
+        _ca = (char*)malloc(caLength + 1);
+        if (_ca) {
+            _preferences.getBytes("ca", _ca, caLength);
+            _ca[caLength] = '\0';
+        }
+    }
+
+    Console::instance().addCommands(SYNC_COMMANDS);
+    if (xTaskCreatePinnedToCore(taskEntry, "historySync", 8192, this, HISTORY_SYNC_TASK_PRIO, &_task,
+                                HISTORY_SYNC_TASK_CORE) != pdPASS) {
+        _task = nullptr;
+        LOG_E(TAG_SYNC, "同步任务创建失败");
+        return false;
+    }
+    LOG_I(TAG_SYNC, "历史同步就绪，上传位置: %lu%s", (unsigned long)_cursor, _ssid[0] ? "" : "（未设置WiFi）");
+    return true;
+}
+
+void HistorySync::request() {
+    if (_task) {
+        xTaskNotifyGive(_task);
+    }
+}
+
+bool HistorySync::setWifi(const char* ssid, const char* password) {
+    if (_busy || !copyText(_ssid, sizeof(_ssid), ssid) || !copyText(_password, sizeof(_password), password)) {
+        return false;
+    }
+    _preferences.putString("ssid", _ssid);
+    _preferences.putString("pass", _password);
+    return true;
+}
+
+bool HistorySync::setServer(const char* url, const char* token) {
+    if (_busy || (strncmp(url, "http://", 7) != 0 && strncmp(url, "https://", 8) != 0)) {
+        return false;
+    }
+    if (!copyText(_url, sizeof(_url), url) || !copyText(_token, sizeof(_token), token)) {
+        return false;
+    }
+    _preferences.putString("url", _url);
+    _preferences.putString("token", _token);
+    return true;
+}
+
+bool HistorySync::setCa(const char* pem) {
+    if (_busy) return false;
+    free(_ca);
+    _ca = nullptr;
+    size_t length = strlen(pem);
+    if (!length) {
+        _preferences.remove("ca");
+        return true;
+    }
+    _ca = (char*)malloc(length + 1);
+    if (!_ca) return false;
+    memcpy(_ca, pem, length + 1);
+    return _preferences.putBytes("ca", pem, length) == length;
+}
+
+void HistorySync::taskEntry(void* arg) {
+    HistorySync* self = static_cast<HistorySync*>(arg);
+    for (;;) {
+        // 定期同步，或进入休眠/sync now时提前
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((uint32_t)HISTORY_SYNC_INTERVAL_MIN * 60 * 1000));
+        self->run();
+    }
+}
+
+void HistorySync::run() {
+    HistoryLog& log = HistoryLog::instance();
+    if (_cursor > log.getNextSequence()) {
+        // 日志被清除后序号重新开始
+        _cursor = 0;
+    }
+    if (!_ssid[0] || !_url[0] || _cursor == log.getNextSequence()) {
+        return;
+    }
+    bool secure = strncmp(_url, "https://", 8) == 0;
+    if (secure && !_ca) {
+        LOG_W(TAG_SYNC, "https地址需要先用sync_ca设置证书");
+        return;
+    }
+
+    _busy = true;
+#if PEER_SYNC_ENABLED
+    // 多台合计正在用无线（先置位再检查，与PeerSync::radioOn()相同），下次再同步
+    if (PeerSync::instance().isRadioOn()) {
+        LOG_I(TAG_SYNC, "多台合计正在使用无线，推迟同步");
+        _busy = false;
+        return;
+    }
+#endif
+    _text = (char*)placedAlloc("sync_text", HISTORY_SYNC_BATCH_BYTES, PLACE_PSRAM);
+    _gzip = (uint8_t*)placedAlloc("sync_gzip", HISTORY_SYNC_BATCH_BYTES + SYNC_GZIP_HEADER + SYNC_GZIP_TRAILER,
+                                  PLACE_PSRAM);
+    _compressor = placedAlloc("sync_deflate", sizeof(tdefl_compressor), PLACE_PSRAM_ONLY);
+
+    if (_text && _gzip && connectWifi()) {
+        // 一个客户端对象发送全部批次，连接（和TLS会话）在批次之间保持
+        if (secure) {
+            WiFiClientSecure client;
+            client.setCACert(_ca);
+            upload(client);
+        } else {
+            WiFiClient client;
+            upload(client);
+        }
+    }
+
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    placedFree(_compressor);
+    placedFree(_gzip);
+    placedFree(_text);
+    _compressor = nullptr;
+    _gzip = nullptr;
+    _text = nullptr;
+    _busy = false;
+}
+
+bool HistorySync::connectWifi() {
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(_ssid, _password[0] ? _password : nullptr);
+    uint32_t start = millis();
+    while (WiFi.status() != WL_CONNECTED) {
+        if (millis() - start >= HISTORY_SYNC_CONNECT_MS) {
+            LOG_W(TAG_SYNC, "WiFi连接超时: %s", _ssid);
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    LOG_I(TAG_SYNC, "WiFi已连接，%lu ms", (unsigned long)(millis() - start));
+    return true;
+}
+
+bool HistorySync::upload(WiFiClient& client) {
+    HTTPClient http;
+    http.setReuse(true);
+    uint32_t start = millis();
+    uint32_t sent = 0;
+
+    for (;;) {
+        uint32_t count = buildBatch();
+        if (!count) break;
+
+        size_t gzipLength = compress();
+        if (!http.begin(client, _url)) {
+            LOG_E(TAG_SYNC, "服务器地址无效: %s", _url);
+            return false;
+        }
+        http.addHeader("Content-Type", "application/x-ndjson");
+        if (_token[0]) {
+            http.addHeader("Authorization", String("Bearer ") + _token);
+        }
+        if (gzipLength) {
+            http.addHeader("Content-Encoding", "gzip");
+            _lastStatus = http.POST(_gzip, gzipLength);
+        } else {
+            _lastStatus = http.POST((uint8_t*)_text, _textLength);
+        }
+        http.end();     // setReuse(true)时保持连接，下一批不再握手
+
+        if (_lastStatus < 200 || _lastStatus >= 300) {
+            LOG_W(TAG_SYNC, "上传失败: %d", _lastStatus);
+            return false;
+        }
+        // 服务器已收下，前进上传位置
+        _cursor = _batchEnd;
+        _preferences.putULong("cursor", _cursor);
+        _uploaded += count;
+        _bytesSent += gzipLength ? gzipLength : _textLength;
+        sent += count;
+    }
+
+    _lastSync = millis();
+    LOG_I(TAG_SYNC, "上传 %lu 条，%lu ms", (unsigned long)sent, (unsigned long)(_lastSync - start));
+    return true;
+}
+
+uint32_t HistorySync::buildBatch() {
+    _textLength = 0;
+    _batchEnd = _cursor;
+    return HistoryLog::instance().readFrom(_cursor, appendRecord, this);
+}
+
+bool HistorySync::appendRecord(uint32_t sequence, const HistoryRecord& record, void* context) {
+    HistorySync* self = static_cast<HistorySync*>(context);
+    char text[HistoryBuffer::LINE_SIZE];
+    HistoryBuffer::format(record, text, sizeof(text));
+
+    // {"seq":..,"ms":..,"text":"..","result":..}\n，text中的引号、反斜杠和控制字符转义
+    char line[64 + HistoryBuffer::LINE_SIZE * 2];
+    int length = snprintf(line, sizeof(line), "{\"seq\":%lu,\"ms\":%lu,\"text\":\"", (unsigned long)sequence,
+                          (unsigned long)record.timestamp);
+    for (const char* p = text; *p && length < (int)sizeof(line) - 8; p++) {
+        if (*p == '"' || *p == '\\') {
+            line[length++] = '\\';
+            line[length++] = *p;
+        } else if ((uint8_t)*p < 0x20) {
+            length += snprintf(line + length, sizeof(line) - length, "\\u%04x", *p);
+        } else {
+            line[length++] = *p;
+        }
+    }
+    length += snprintf(line + length, sizeof(line) - length, "\",\"result\":%.17g}\n",
+                       isfinite(record.result) ? record.result : 0.0);
+    if (length >= (int)sizeof(line)) {
+        length = sizeof(line) - 1;
+    }
+
+    if (self->_textLength + length > HISTORY_SYNC_BATCH_BYTES) {
+        return false;   // 这一批已满，这条留给下一批
+    }
+    memcpy(self->_text + self->_textLength, line, length);
+    self->_textLength += length;
+    self->_batchEnd = sequence + 1;
+    return true;
+}
+
+size_t HistorySync::compress() {
+    if (!_compressor) return 0;
+
+    // gzip：10字节头 | deflate | CRC32 | 原始长度
+    static const uint8_t header[SYNC_GZIP_HEADER] = {0x1F, 0x8B, 0x08, 0, 0, 0, 0, 0, 0, 0xFF};
+    memcpy(_gzip, header, sizeof(header));
+
+    tdefl_compressor* deflator = static_cast<tdefl_compressor*>(_compressor);
+    tdefl_init(deflator, nullptr, nullptr, SYNC_DEFLATE_PROBES);
+    size_t inLength = _textLength;
+    size_t outLength = HISTORY_SYNC_BATCH_BYTES;
+    if (tdefl_compress(deflator, _text, &inLength, _gzip + SYNC_GZIP_HEADER, &outLength, TDEFL_FINISH) !=
+            TDEFL_STATUS_DONE) {
+        // 不可压缩的正文超出缓冲，原样发送
+        return 0;
+    }
+
+    uint8_t* trailer = _gzip + SYNC_GZIP_HEADER + outLength;
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)_text, _textLength);
+    uint32_t size = _textLength;
+    memcpy(trailer, &crc, 4);
+    memcpy(trailer + 4, &size, 4);
+    return SYNC_GZIP_HEADER + outLength + SYNC_GZIP_TRAILER;
+}
+
+void HistorySync::printStatus() const {
+    Serial.println("=== 历史同步 ===");
+    Serial.printf("WiFi: %s\n", _ssid[0] ? _ssid : "（未设置）");
+    Serial.printf("服务器: %s%s\n", _url[0] ? _url : "（未设置）", _ca ? "（已设置CA证书）" : "");
+    Serial.printf("上传位置: %lu / %lu\n", (unsigned long)_cursor,
+                  (unsigned long)HistoryLog::instance().getNextSequence());
+    Serial.printf("状态: %s，上次HTTP状态: %d\n", _busy ? "同步中" : "空闲", _lastStatus);
+    Serial.printf("本次启动上传: %lu 条，%lu 字节\n", (unsigned long)_uploaded, (unsigned long)_bytesSent);
+    if (_lastSync) {
+        Serial.printf("上次成功: %lu 秒前\n", (unsigned long)((millis() - _lastSync) / 1000));
+    }
+}
+
+#endif // HISTORY_SYNC_ENABLED && HISTORY_LOG_ENABLED
@@ -0,0 +1,130 @@
+/**
+ * @file HistorySync.h
+ * @brief 计算历史的后台WiFi同步
+ * @details 定期（HISTORY_SYNC_INTERVAL_MIN）或进入休眠时，把历史日志中还没上传的记录批量发到服务器：
+ * - 全部在一个低优先级任务中完成（HISTORY_SYNC_TASK_CORE，与按键扫描和渲染不在同一核心），
+ *   没有新记录时不打开WiFi；上传完关闭WiFi
+ * - 记录从闪存日志读取（HistoryLog::readFrom()），上传位置（下一条要上传的序号）保存在NVS，
+ *   服务器应答2xx后才前进，失败的批次下次重发，服务器按seq去重
+ * - 每批最多HISTORY_SYNC_BATCH_BYTES的NDJSON，每行一条记录：
+ *       {"seq":12,"ms":345678,"text":"1+2=3","result":3}
+ *   ms为记录时的启动后毫秒数。正文用ROM中的deflate（tdefl）压缩为gzip
+ *   （Content-Encoding: gzip），压缩器约300KB只在同步期间分配在PSRAM，没有PSRAM时不压缩
+ * - 一次同步的所有批次在同一个TLS连接上发送（HTTP keep-alive），只握手一次
+ * - 服务器证书：sync_ca设置的CA证书（PEM）；没有设置时不连接https地址
+ *
+ * WiFi名称、密码、服务器地址、令牌和证书都保存在NVS，串口命令设置，不编译进固件。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef HISTORY_SYNC_H
+#define HISTORY_SYNC_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if HISTORY_SYNC_ENABLED && HISTORY_LOG_ENABLED
+
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "HistoryBuffer.h"
+
+class WiFiClient;
+
+class HistorySync {
+public:
+    static const size_t SSID_SIZE = 33;
+    static const size_t PASSWORD_SIZE = 65;
+    static const size_t URL_SIZE = 128;
+    static const size_t TOKEN_SIZE = 65;
+    static const size_t CA_MAX = 4096;      ///< CA证书（PEM）最大字节数
+
+    static HistorySync& instance() {
+        static HistorySync instance;
+        return instance;
+    }
+
+    /**
+     * @brief 读取NVS中的设置，注册串口命令并创建同步任务
+     */
+    bool begin();
+
+    /**
+     * @brief 请求尽快同步一次（进入休眠时调用，不等待）
+     */
+    void request();
+
+    /**
+     * @brief 保存WiFi名称和密码（密码为""表示开放网络）
+     */
+    bool setWifi(const char* ssid, const char* password);
+
+    /**
+     * @brief 保存服务器地址（http://或https://）和Bearer令牌（""表示不发送）
+     */
+    bool setServer(const char* url, const char* token);
+
+    /**
+     * @brief 保存服务器的CA证书（PEM），""表示删除
+     */
+    bool setCa(const char* pem);
+
+    /**
+     * @brief 同步任务是否在使用WiFi（期间不能浅睡眠）
+     */
+    bool isBusy() const { return _busy; }
+
+    void printStatus() const;
+
+private:
+    HistorySync();
+
+    static void taskEntry(void* arg);
+    void run();
+    bool connectWifi();
+    bool upload(WiFiClient& client);
+
+    /**
+     * @brief 从上传位置起读取一批记录，写成NDJSON
+     * @return 本批记录数，0表示没有新记录
+     */
+    uint32_t buildBatch();
+    static bool appendRecord(uint32_t sequence, const HistoryRecord& record, void* context);
+
+    /**
+     * @brief 把_text压缩为gzip写入_gzip
+     * @return 压缩后字节数，0表示没有压缩器或输出超出缓冲
+     */
+    size_t compress();
+
+    Preferences _preferences;
+    TaskHandle_t _task;
+    volatile bool _busy;
+
+    char _ssid[SSID_SIZE];
+    char _password[PASSWORD_SIZE];
+    char _url[URL_SIZE];
+    char _token[TOKEN_SIZE];
+    char* _ca;                      ///< CA证书，没有设置时为nullptr
+
+    uint32_t _cursor;               ///< 下一条要上传的序号
+    uint32_t _batchEnd;             ///< 本批最后一条之后的序号
+
+    // 同步期间分配的缓冲
+    char* _text;                    ///< 未压缩的正文
+    size_t _textLength;
+    uint8_t* _gzip;                 ///< gzip正文
+    void* _compressor;              ///< tdefl_compressor（PSRAM）
+
+    // 统计
+    uint32_t _uploaded;             ///< 本次启动上传的记录数
+    uint32_t _bytesSent;            ///< 本次启动发送的正文字节数（压缩后）
+    uint32_t _lastSync;             ///< 上次同步成功的时刻（millis），0表示没有
+    int _lastStatus;                ///< 上次请求的HTTP状态码或HTTPClient错误码
+};
+
+#endif // HISTORY_SYNC_ENABLED && HISTORY_LOG_ENABLED
+
+#endif // HISTORY_SYNC_H
@@ -0,0 +1,600 @@
+/**
+ * @file HostLink.cpp
+ * @brief USB CDC二进制主机通道实现
+ *
+ * @author Calculator Project
+ */
+
+#include "HostLink.h"
+#include "Logger.h"
+#include "CalculatorCore.h"
+#include "ConfigManager.h"
+#include "KeyboardConfig.h"
+#include "SimpleHID.h"
+#include "LoopScheduler.h"
+#include "ExpressionParser.h"
+#include "UnitConverter.h"
+#include "ConfigJson.h"
+#include "FirmwareUpdate.h"
+#include "SleepManager.h"
+#include "Metrics.h"
+#include "CrashDump.h"
+#include "ScreenMirror.h"
+#include <esp_rom_crc.h>
+
+#define TAG_HOST "HostLink"
+
+static MetricCounter framesReceived("host.frames_rx");
+static MetricCounter framesDropped("host.frames_dropped");
+
+HostLink::HostLink()
+    : _ready(false),
+      _calculator(nullptr),
+      _perf(nullptr),
+      _hid(nullptr),
+      _rxLength(0),
+      _command(0),
+      _sequence(0),
+      _historySequence(0),
+      _historyNext(0),
+      _historyEnd(0),
+      _jsonText(nullptr),
+      _jsonLength(0),
+      _jsonOffset(0),
+      _jsonSequence(0),
+      _crashNext(0),
+      _crashEnd(0),
+      _crashSequence(0),
+      _screenCommand(0),
+      _screenSequence(0),
+      _evalExpression(nullptr),
+      _batchLength(0),
+      _batchOffset(0),
+      _batchFormat(0),
+      _batchSequence(0),
+      _batchActive(false),
+      _batchCount(0),
+      _batchMicros(0),
+      _restartAt(0) {
+}
+
+void HostLink::begin() {
+    if (_ready) return;
+
+    // 一次能收下一个最大的请求帧，主循环偶尔慢一点也不会丢数据
+    _cdc.setRxBufferSize(sizeof(_rx));
+    // 收到数据时唤醒主循环（回调在USB事件任务中执行）
+    _cdc.onEvent(ARDUINO_USB_CDC_RX_EVENT, [](void*, esp_event_base_t, int32_t, void*) {
+        LoopScheduler::instance().wake();
+    });
+    _cdc.begin();
+    _ready = true;
+    LOG_I(TAG_HOST, "主机通道已注册 (USB CDC)");
+}
+
+void HostLink::attach(CalculatorCore* calculator, PerformanceMonitor* perf, SimpleHID* hid) {
+    _calculator = calculator;
+    _perf = perf;
+    _hid = hid;
+}
+
+uint32_t HostLink::getFramesReceived() const {
+    return framesReceived.get();
+}
+
+uint32_t HostLink::getFramesDropped() const {
+    return framesDropped.get();
+}
+
+void HostLink::poll() {
+    if (!_ready) return;
+
+    if (_restartAt && (int32_t)(millis() - _restartAt) >= 0) {
+        ESP.restart();
+    }
+
+    // 多帧应答每次循环只发一帧
+    if (_historyNext != _historyEnd) {
+        streamHistory();
+    } else if (_jsonText) {
+        streamConfigJson();
+    } else if (_crashNext != _crashEnd) {
+        streamCrash();
+    } else if (_batchActive) {
+        streamEval();
+    } else if (_screenCommand && ScreenMirror::instance().pending()) {
+        streamScreen();
+    }
+
+    // 批量求值时接收缓冲里可能还留着排队的请求，没有新数据也要继续处理
+    if (_cdc.available() > 0 && _rxLength < sizeof(_rx)) {
+        _rxLength += _cdc.read(_rx + _rxLength, sizeof(_rx) - _rxLength);
+    }
+
+    for (;;) {
+        // 丢弃魔数之前的字节
+        size_t start = 0;
+        while (start < _rxLength && _rx[start] != FRAME_MAGIC) start++;
+        if (start) {
+            memmove(_rx, _rx + start, _rxLength - start);
+            _rxLength -= start;
+        }
+        if (_rxLength < HEADER_SIZE) return;
+
+        uint16_t length = _rx[3] | (_rx[4] << 8);
+        if (length > MAX_PAYLOAD) {
+            // 长度不可能有效，跳过这个魔数重新同步
+            framesDropped.add();
+            memmove(_rx, _rx + 1, --_rxLength);
+            continue;
+        }
+        size_t frameSize = HEADER_SIZE + length + CRC_SIZE;
+        if (_rxLength < frameSize) return;    // 帧不完整，等更多数据
+        if (_batchActive) return;             // 上一批还没发完，这一帧留在接收缓冲中
+
+        uint32_t crc;
+        memcpy(&crc, _rx + HEADER_SIZE + length, sizeof(crc));
+        if (crc != esp_rom_crc32_le(0, _rx + 1, HEADER_SIZE - 1 + length)) {
+            framesDropped.add();
+            memmove(_rx, _rx + 1, --_rxLength);
+            continue;
+        }
+
+        framesReceived.add();
+        handleFrame(_rx[1], _rx[2], _rx + HEADER_SIZE, length);
+        _rxLength -= frameSize;
+        memmove(_rx, _rx + frameSize, _rxLength);
+    }
+}
+
+void HostLink::handleFrame(uint8_t command, uint8_t sequence, const uint8_t* payload, uint16_t length) {
+    _command = command;
+    _sequence = sequence;
+    if (_historyNext != _historyEnd || _jsonText || _crashNext != _crashEnd ||
+        _screenCommand == HOST_CMD_GET_SCREEN) {
+        // 历史记录、配置、崩溃记录或截图还在发送，应答帧不能交错
+        reply(HOST_STATUS_BUSY, 0);
+        return;
+    }
+
+    switch (command) {
+        case HOST_CMD_PING: {
+            uint8_t* p = body();
+            *p++ = PROTOCOL_VERSION;
+            p = put16(p, MAX_PAYLOAD);
+            p = put32(p, millis());
+            p = put32(p, ESP.getFreeHeap());
+            reply(HOST_STATUS_OK, p - body());
+            break;
+        }
+        case HOST_CMD_GET_PERF:
+            handleGetPerf();
+            break;
+        case HOST_CMD_RESET_PERF:
+            if (_perf) _perf->reset();
+            if (_hid) _hid->resetLatencyStats();
+            reply(HOST_STATUS_OK, 0);
+            break;
+        case HOST_CMD_GET_METRICS:
+            reply(HOST_STATUS_OK, Metrics::instance().exportBinary(body(), MAX_PAYLOAD - 1));
+            break;
+        case HOST_CMD_GET_CRASH:
+            handleGetCrash();
+            break;
+        case HOST_CMD_CLEAR_CRASH:
+            CrashDump::instance().clear();
+            reply(HOST_STATUS_OK, 0);
+            break;
+        case HOST_CMD_GET_SCREEN:
+        case HOST_CMD_MIRROR:
+            handleScreen(command, payload, length);
+            break;
+        case HOST_CMD_GET_CONFIG:
+            handleGetConfig(payload, length);
+            break;
+        case HOST_CMD_SET_CONFIG:
+            handleSetConfig(payload, length);
+            break;
+        case HOST_CMD_GET_HISTORY:
+            handleGetHistory(payload, length);
+            break;
+        case HOST_CMD_EVAL:
+            handleEval(payload, length);
+            break;
+        case HOST_CMD_UPDATE_BEGIN:
+        case HOST_CMD_UPDATE_DATA:
+        case HOST_CMD_UPDATE_END:
+            handleUpdate(command, payload, length);
+            break;
+        default:
+            LOG_W(TAG_HOST, "未知的主机命令: 0x%02X", command);
+            reply(HOST_STATUS_BAD_COMMAND, 0);
+            break;
+    }
+}
+
+void HostLink::handleGetPerf() {
+    PerfHistogram hist[HOST_PERF_COUNT];
+    if (_perf) {
+        _perf->snapshot(hist[HOST_PERF_INPUT], hist[HOST_PERF_DRAW], hist[HOST_PERF_FLUSH], &hist[HOST_PERF_LED]);
+    }
+    if (_hid) {
+        hist[HOST_PERF_HID_SUBMIT] = _hid->getSubmitLatency();
+        hist[HOST_PERF_HID_COMPLETE] = _hid->getCompleteLatency();
+    }
+
+    // 项数 + 每项（次数、最小、平均、p99、最大）+ 日志丢弃数
+    uint8_t* p = body();
+    *p++ = HOST_PERF_COUNT;
+    for (uint8_t i = 0; i < HOST_PERF_COUNT; i++) {
+        p = putHistogram(p, hist[i]);
+    }
+    p = put32(p, Logger::getInstance().getDroppedCount());
+    reply(HOST_STATUS_OK, p - body());
+}
+
+void HostLink::handleGetConfig(const uint8_t* payload, uint16_t length) {
+    if (length != 1) {
+        reply(HOST_STATUS_BAD_PAYLOAD, 0);
+        return;
+    }
+    if (payload[0] == HOST_CONFIG_JSON) {
+        size_t length = 0;
+        _jsonText = ConfigJson::instance().exportText(length);
+        if (!_jsonText) {
+            reply(HOST_STATUS_UNAVAILABLE, 0);
+            return;
+        }
+        _jsonLength = length;
+        _jsonOffset = 0;
+        _jsonSequence = _sequence;
+        streamConfigJson();
+        return;
+    }
+
+    uint8_t* p = body();
+    *p++ = payload[0];
+    size_t size = 0;
+    if (payload[0] == HOST_CONFIG_SETTINGS) {
+        ConfigBlob blob;
+        ConfigManager::getInstance().exportBlob(blob);
+        memcpy(p, &blob, sizeof(blob));
+        size = sizeof(blob);
+    } else if (payload[0] == HOST_CONFIG_LAYOUT) {
+        // 保存格式要求4字节对齐
+        alignas(4) uint8_t buffer[KeyboardConfigManager::LAYOUT_BLOB_SIZE];
+        size = keyboardConfig.exportLayout(buffer, sizeof(buffer));
+        if (!size) {
+            reply(HOST_STATUS_UNAVAILABLE, 0);
+            return;
+        }
+        memcpy(p, buffer, size);
+    } else if (payload[0] == HOST_CONFIG_CURRENCY) {
+        size = UnitConverter::instance().exportTable(p, MAX_PAYLOAD - 2);
+    } else {
+        reply(HOST_STATUS_BAD_PAYLOAD, 0);
+        return;
+    }
+    reply(HOST_STATUS_OK, 1 + size);
+}
+
+void HostLink::handleSetConfig(const uint8_t* payload, uint16_t length) {
+    if (length < 1) {
+        reply(HOST_STATUS_BAD_PAYLOAD, 0);
+        return;
+    }
+
+    bool ok = false;
+    const uint8_t* data = payload + 1;
+    size_t size = length - 1;
+    if (payload[0] == HOST_CONFIG_SETTINGS && size == sizeof(ConfigBlob)) {
+        ConfigBlob blob;
+        memcpy(&blob, data, sizeof(blob));
+        ok = ConfigManager::getInstance().importBlob(blob);
+    } else if (payload[0] == HOST_CONFIG_LAYOUT) {
+        ok = keyboardConfig.importLayout(data, size);
+    } else if (payload[0] == HOST_CONFIG_CURRENCY) {
+        ok = UnitConverter::instance().importTable(data, size);
+    } else if (payload[0] == HOST_CONFIG_JSON && size >= 1) {
+        // 第一块开始新的文档，之前未完成的导入作废；文档读完才应用
+        ConfigJson& json = ConfigJson::instance();
+        if (data[0] & 1) json.beginImport();
+        JsonReader::Status status = json.feed((const char*)data + 1, size - 1);
+        if (status == JsonReader::STATUS_MORE) {
+            reply(HOST_STATUS_MORE, 0);
+            return;
+        }
+        ok = status == JsonReader::STATUS_DONE;
+    }
+    LOG_I(TAG_HOST, "主机写入配置 %d: %s", payload[0], ok ? "成功" : "无效");
+    reply(ok ? HOST_STATUS_OK : HOST_STATUS_BAD_PAYLOAD, 0);
+}
+
+void HostLink::streamConfigJson() {
+    // 每帧：目标 + 一段文本
+    uint8_t* p = body();
+    *p++ = HOST_CONFIG_JSON;
+    size_t chunk = _jsonLength - _jsonOffset;
+    if (chunk > MAX_PAYLOAD - 2) chunk = MAX_PAYLOAD - 2;
+    memcpy(p, _jsonText + _jsonOffset, chunk);
+    _jsonOffset += chunk;
+
+    _command = HOST_CMD_GET_CONFIG;
+    _sequence = _jsonSequence;
+    if (_jsonOffset == _jsonLength) {
+        _jsonText = nullptr;
+        reply(HOST_STATUS_OK, 1 + chunk);
+    } else {
+        reply(HOST_STATUS_MORE, 1 + chunk);
+        LoopScheduler::instance().after(0);
+    }
+}
+
+void HostLink::handleGetCrash() {
+    uint32_t length = CrashDump::instance().recordLength();
+    if (length == 0) {
+        reply(HOST_STATUS_UNAVAILABLE, 0);
+        return;
+    }
+    _crashNext = 0;
+    _crashEnd = length;
+    _crashSequence = _sequence;
+    streamCrash();
+}
+
+void HostLink::streamCrash() {
+    uint32_t chunk = _crashEnd - _crashNext;
+    if (chunk > MAX_PAYLOAD - 1) chunk = MAX_PAYLOAD - 1;
+    bool ok = CrashDump::instance().read(_crashNext, body(), chunk);
+    _crashNext += chunk;
+
+    _command = HOST_CMD_GET_CRASH;
+    _sequence = _crashSequence;
+    if (!ok) {
+        // 发送期间记录被清除
+        _crashNext = _crashEnd = 0;
+        reply(HOST_STATUS_UNAVAILABLE, 0);
+    } else if (_crashNext == _crashEnd) {
+        _crashNext = _crashEnd = 0;
+        reply(HOST_STATUS_OK, chunk);
+    } else {
+        reply(HOST_STATUS_MORE, chunk);
+        LoopScheduler::instance().after(0);
+    }
+}
+
+void HostLink::handleScreen(uint8_t command, const uint8_t* payload, uint16_t length) {
+    ScreenMirror& mirror = ScreenMirror::instance();
+    if (!mirror.isAvailable()) {
+        reply(HOST_STATUS_UNAVAILABLE, 0);
+        return;
+    }
+    if (command == HOST_CMD_GET_SCREEN) {
+        if (_screenCommand == HOST_CMD_MIRROR) {
+            // 镜像期间主机已经有完整画面
+            reply(HOST_STATUS_BUSY, 0);
+            return;
+        }
+        _screenCommand = HOST_CMD_GET_SCREEN;
+        _screenSequence = _sequence;
+        mirror.requestAll();
+        streamScreen();
+        return;
+    }
+
+    if (length != 1 || payload[0] > 1) {
+        reply(HOST_STATUS_BAD_PAYLOAD, 0);
+        return;
+    }
+    bool live = payload[0] == 1;
+    mirror.setLive(live);
+    _screenCommand = live ? HOST_CMD_MIRROR : 0;
+    _screenSequence = _sequence;
+    LOG_I(TAG_HOST, "屏幕镜像%s", live ? "打开" : "关闭");
+    reply(HOST_STATUS_OK, 0);
+    if (live) LoopScheduler::instance().after(0);
+}
+
+void HostLink::streamScreen() {
+    ScreenMirror& mirror = ScreenMirror::instance();
+    if (_screenCommand == HOST_CMD_MIRROR && !_cdc) {
+        // 主机断开，停止镜像
+        mirror.setLive(false);
+        _screenCommand = 0;
+        return;
+    }
+    size_t size = mirror.encodeFrame(body(), MAX_PAYLOAD - 1);
+
+    _command = _screenCommand;
+    _sequence = _screenSequence;
+    if (_screenCommand == HOST_CMD_GET_SCREEN && !mirror.pending()) {
+        _screenCommand = 0;
+        reply(HOST_STATUS_OK, size);
+    } else {
+        reply(HOST_STATUS_MORE, size);
+        if (mirror.pending()) LoopScheduler::instance().after(0);
+    }
+}
+
+void HostLink::handleUpdate(uint8_t command, const uint8_t* payload, uint16_t length) {
+    FirmwareUpdate& update = FirmwareUpdate::instance();
+    SleepManager::instance().feed();    // 传输期间不进入休眠
+    bool ok;
+    if (command == HOST_CMD_UPDATE_BEGIN) {
+        if (length != 4 + FirmwareUpdate::SHA_SIZE + 1) {
+            reply(HOST_STATUS_BAD_PAYLOAD, 0);
+            return;
+        }
+        uint32_t size;
+        memcpy(&size, payload, sizeof(size));
+        ok = update.begin(size, payload + 4, (FirmwareUpdate::Format)payload[4 + FirmwareUpdate::SHA_SIZE]);
+        reply(ok ? HOST_STATUS_OK : HOST_STATUS_UNAVAILABLE, 0);
+        return;
+    }
+    if (!update.isActive()) {
+        reply(HOST_STATUS_UNAVAILABLE, 0);
+        return;
+    }
+    if (command == HOST_CMD_UPDATE_DATA) {
+        uint32_t offset;
+        ok = length >= 4;
+        if (ok) {
+            memcpy(&offset, payload, sizeof(offset));
+            ok = update.write(offset, payload + 4, length - 4);
+        }
+    } else {
+        ok = update.finish();
+        if (ok) {
+            // 等应答发出后再重启
+            _restartAt = millis() + 200;
+            LoopScheduler::instance().at(_restartAt);
+        }
+    }
+    reply(ok ? HOST_STATUS_OK : HOST_STATUS_BAD_PAYLOAD, 0);
+}
+
+void HostLink::handleGetHistory(const uint8_t* payload, uint16_t length) {
+    if (length != 4) {
+        reply(HOST_STATUS_BAD_PAYLOAD, 0);
+        return;
+    }
+    if (!_calculator) {
+        reply(HOST_STATUS_UNAVAILABLE, 0);
+        return;
+    }
+
+    size_t total = _calculator->getHistory().size();
+    uint16_t start = payload[0] | (payload[1] << 8);
+    uint16_t count = payload[2] | (payload[3] << 8);
+    _historyNext = start < total ? start : total;
+    _historyEnd = (size_t)_historyNext + count < total ? _historyNext + count : total;
+    _historySequence = _sequence;
+    streamHistory();
+}
+
+void HostLink::streamHistory() {
+    const HistoryBuffer& history = _calculator->getHistory();
+    if (_historyEnd > history.size()) {
+        // 发送期间历史被清空
+        _historyEnd = history.size();
+        if (_historyNext > _historyEnd) _historyNext = _historyEnd;
+    }
+
+    // 每条记录：序号(2) + 时间戳(4) + 结果(double) + 文本长度(1) + "表达式=结果"
+    uint8_t* p = body();
+    uint8_t* end = body() + MAX_PAYLOAD - 1;
+    char text[128];
+    while (_historyNext < _historyEnd) {
+        const HistoryRecord* record = history.get(_historyNext);
+        size_t textLength = HistoryBuffer::format(*record, text, sizeof(text));
+        if (textLength > 0xFF) textLength = 0xFF;
+        if (p + 15 + textLength > end) break;
+
+        p = put16(p, _historyNext);
+        p = put32(p, record->timestamp);
+        memcpy(p, &record->result, sizeof(double));
+        p += sizeof(double);
+        *p++ = (uint8_t)textLength;
+        memcpy(p, text, textLength);
+        p += textLength;
+        _historyNext++;
+    }
+
+    _command = HOST_CMD_GET_HISTORY;
+    _sequence = _historySequence;
+    if (_historyNext == _historyEnd) {
+        _historyNext = _historyEnd = 0;
+        reply(HOST_STATUS_OK, p - body());
+    } else {
+        reply(HOST_STATUS_MORE, p - body());
+        LoopScheduler::instance().after(0);
+    }
+}
+
+void HostLink::handleEval(const uint8_t* payload, uint16_t length) {
+    if (length < 1 || payload[0] > ExpressionParser::TOKENS) {
+        reply(HOST_STATUS_BAD_PAYLOAD, 0);
+        return;
+    }
+    if (!_evalExpression) _evalExpression = new Expression();
+
+    // 复制出接收缓冲，_rx可以接着收下一个请求
+    _batchLength = length - 1;
+    memcpy(_batch, payload + 1, _batchLength);
+    _batchOffset = 0;
+    _batchFormat = payload[0];
+    _batchSequence = _sequence;
+    _batchCount = 0;
+    _batchMicros = 0;
+    _batchActive = true;
+    streamEval();
+}
+
+void HostLink::streamEval() {
+    // 每个结果：错误码(1) + 结果(double)；给最后一帧的条数和耗时留出位置
+    static const size_t RESULT_SIZE = 1 + sizeof(double);
+    uint8_t* p = body();
+    uint8_t* end = body() + MAX_PAYLOAD - 1 - 8;
+
+    uint32_t start = micros();
+    while (_batchOffset < _batchLength && p + RESULT_SIZE <= end) {
+        size_t consumed;
+        double value = 0.0;
+        CalculatorError error = ExpressionParser::evaluate((ExpressionParser::Format)_batchFormat,
+                                                           _batch + _batchOffset, _batchLength - _batchOffset,
+                                                           consumed, *_evalExpression, value);
+        _batchOffset += consumed;
+        *p++ = (uint8_t)error;
+        memcpy(p, &value, sizeof(double));
+        p += sizeof(double);
+        _batchCount++;
+    }
+    _batchMicros += micros() - start;
+
+    _command = HOST_CMD_EVAL;
+    _sequence = _batchSequence;
+    if (_batchOffset >= _batchLength) {
+        _batchActive = false;
+        p = put32(p, _batchCount);
+        p = put32(p, _batchMicros);
+        reply(HOST_STATUS_OK, p - body());
+    } else {
+        reply(HOST_STATUS_MORE, p - body());
+        LoopScheduler::instance().after(0);
+    }
+}
+
+void HostLink::reply(uint8_t status, uint16_t length) {
+    uint16_t payload = 1 + length;
+    _tx[0] = FRAME_MAGIC;
+    _tx[1] = _command | 0x80;
+    _tx[2] = _sequence;
+    put16(_tx + 3, payload);
+    _tx[HEADER_SIZE] = status;
+    put32(_tx + HEADER_SIZE + payload, esp_rom_crc32_le(0, _tx + 1, HEADER_SIZE - 1 + payload));
+
+    // 主机没有打开端口时write()会等到超时，直接丢弃
+    if (!_cdc) return;
+    _cdc.write(_tx, HEADER_SIZE + payload + CRC_SIZE);
+}
+
+uint8_t* HostLink::put16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+    return p + 2;
+}
+
+uint8_t* HostLink::put32(uint8_t* p, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        p[i] = (value >> (8 * i)) & 0xFF;
+    }
+    return p + 4;
+}
+
+uint8_t* HostLink::putHistogram(uint8_t* p, const PerfHistogram& hist) {
+    p = put32(p, hist.getCount());
+    p = put32(p, hist.getMin());
+    p = put32(p, hist.getAvg());
+    p = put32(p, hist.getPercentile(990));
+    return put32(p, hist.getMax());
+}
@@ -0,0 +1,198 @@
+/**
+ * @file HostLink.h
+ * @brief USB CDC上的二进制主机通道
+ * @details 与HID键盘组成同一个TinyUSB复合设备，串口命令仍走UART（Serial）。
+ * 主机工具见 tools/host_link.py。
+ *
+ * 帧格式（多字节均为小端）：
+ *     0xA5 | 命令 | 序号 | 负载长度(2) | 负载 | CRC32(4)
+ * CRC32覆盖命令到负载末尾。应答的命令为请求命令 | 0x80，序号原样返回，负载第一个字节为状态码。
+ * 校验失败的帧直接丢弃，从下一个0xA5重新同步。
+ *
+ * 历史记录、JSON配置、崩溃记录和截图分多帧发送：poll()每次只发一帧，中间帧状态为HOST_STATUS_MORE，最后一帧为HOST_STATUS_OK，
+ * 发送期间主循环照常处理按键和显示。JSON配置写入时主机按块连续发送，每块应答HOST_STATUS_MORE，
+ * 读完整份文档并应用后应答HOST_STATUS_OK。
+ *
+ * 批量求值（HOST_CMD_EVAL）：请求复制到单独的批处理缓冲后按同样的方式逐帧求值、逐帧应答，
+ * 接收缓冲同时收下一个请求，等这一批发完再处理，主机可以不等应答连续发送。
+ *
+ * 屏幕镜像（HOST_CMD_MIRROR，ScreenMirror）：打开后应答HOST_STATUS_OK，之后Canvas有变化时主动发送
+ * 命令为HOST_CMD_MIRROR、序号同打开请求、状态为HOST_STATUS_MORE的帧，直到关闭或主机断开。
+ *
+ * 固件更新（HOST_CMD_UPDATE_*，FirmwareUpdate）：BEGIN之后按顺序发送DATA，每帧应答一次，
+ * 主机保持两帧在途；END校验通过后应答HOST_STATUS_OK，随后重启进入新固件。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef HOST_LINK_H
+#define HOST_LINK_H
+
+#include <Arduino.h>
+#include "USB.h"
+#include "USBCDC.h"
+#include "PerformanceMonitor.h"
+
+class CalculatorCore;
+class SimpleHID;
+class Expression;
+
+// 命令
+enum HostCommand : uint8_t {
+    HOST_CMD_PING        = 0x01,    ///< 返回协议版本、最大负载、运行时间、可用堆
+    HOST_CMD_GET_PERF    = 0x10,    ///< 读取性能统计
+    HOST_CMD_RESET_PERF  = 0x11,    ///< 清空性能统计
+    HOST_CMD_GET_METRICS = 0x12,    ///< 所有计数器和直方图的二进制快照（格式见Metrics.h）
+    HOST_CMD_GET_CRASH   = 0x13,    ///< 上次崩溃的记录（格式见CrashDump.h），分多帧返回；没有记录时HOST_STATUS_UNAVAILABLE
+    HOST_CMD_CLEAR_CRASH = 0x14,    ///< 清除崩溃记录，记录区擦除后重新就绪
+    HOST_CMD_GET_SCREEN  = 0x15,    ///< 整屏截图，分多帧返回（格式见ScreenMirror.h）；没有Canvas时HOST_STATUS_UNAVAILABLE
+    HOST_CMD_MIRROR      = 0x16,    ///< 负载：1打开/0关闭实时镜像；打开后按变化的块主动发送（格式同GET_SCREEN）
+    HOST_CMD_GET_CONFIG  = 0x20,    ///< 负载：目标；应答：状态 + 目标 + 配置数据
+    HOST_CMD_SET_CONFIG  = 0x21,    ///< 负载：目标 + 配置数据（格式同GET_CONFIG）
+    HOST_CMD_GET_HISTORY = 0x30,    ///< 负载：起始序号(2) + 条数(2)，0为最新
+    HOST_CMD_EVAL        = 0x40,    ///< 负载：格式（ExpressionParser::Format） + 以'\n'分隔的表达式；
+                                    ///< 应答每个表达式：错误码(1) + 结果(double)，最后一帧另附条数(4) + 求值耗时µs(4)
+    HOST_CMD_UPDATE_BEGIN = 0x50,   ///< 负载：镜像字节数(4) + SHA-256(32) + 格式（FirmwareUpdate::Format）
+    HOST_CMD_UPDATE_DATA  = 0x51,   ///< 负载：传输流中的位置(4) + 数据
+    HOST_CMD_UPDATE_END   = 0x52,   ///< 校验并设为启动分区，应答后重启
+};
+
+// 配置目标
+enum HostConfigTarget : uint8_t {
+    HOST_CONFIG_SETTINGS = 0,       ///< ConfigBlob（ConfigManager）
+    HOST_CONFIG_LAYOUT   = 1,       ///< 键盘布局覆盖表（KeyboardConfigManager保存格式），写入后立即换入、空闲后保存
+    HOST_CONFIG_CURRENCY = 2,       ///< 汇率表（CurrencyTableData，只含用到的项）
+    HOST_CONFIG_JSON     = 3,       ///< 整机配置JSON（ConfigJson）：读取分多帧返回文本；
+                                    ///< 写入每帧为标志(1，bit0表示文档的第一块) + 一段文本
+};
+
+// 应答状态
+enum HostStatus : uint8_t {
+    HOST_STATUS_OK          = 0,
+    HOST_STATUS_MORE        = 1,    ///< 多帧应答的中间帧
+    HOST_STATUS_BAD_COMMAND = 2,
+    HOST_STATUS_BAD_PAYLOAD = 3,
+    HOST_STATUS_UNAVAILABLE = 4,    ///< 对应模块未初始化
+    HOST_STATUS_BUSY        = 5,    ///< 上一个多帧应答尚未发完（批量求值不返回，排队处理）
+};
+
+// 性能统计项（GET_PERF应答中的顺序）
+enum HostPerfItem : uint8_t {
+    HOST_PERF_INPUT = 0,            ///< 输入到上屏
+    HOST_PERF_DRAW,
+    HOST_PERF_FLUSH,
+    HOST_PERF_LED,
+    HOST_PERF_BUZZER,
+    HOST_PERF_HID_SUBMIT,           ///< 扫描到提交HID报告
+    HOST_PERF_HID_COMPLETE,         ///< 扫描到主机取走HID报告
+    HOST_PERF_COUNT
+};
+
+class HostLink {
+public:
+    static const uint8_t PROTOCOL_VERSION = 1;
+    static const uint8_t FRAME_MAGIC = 0xA5;
+    static const uint16_t MAX_PAYLOAD = 1024;       ///< 请求和应答负载的最大字节数
+    static const size_t HEADER_SIZE = 5;            ///< 魔数、命令、序号、长度
+    static const size_t CRC_SIZE = 4;
+
+    static HostLink& instance() {
+        static HostLink instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册CDC接口，必须在USB.begin()之前调用
+     */
+    void begin();
+
+    /**
+     * @brief 设置命令要访问的模块，未设置的模块相关命令返回HOST_STATUS_UNAVAILABLE
+     */
+    void attach(CalculatorCore* calculator, PerformanceMonitor* perf, SimpleHID* hid);
+
+    /**
+     * @brief 主循环调用：处理收到的请求，多帧应答每次前进一帧
+     */
+    void poll();
+
+    bool isConnected() { return _ready && (bool)_cdc; }
+    uint32_t getFramesReceived() const;
+    uint32_t getFramesDropped() const;
+
+private:
+    HostLink();
+
+    void handleFrame(uint8_t command, uint8_t sequence, const uint8_t* payload, uint16_t length);
+    void handleGetPerf();
+    void handleGetConfig(const uint8_t* payload, uint16_t length);
+    void handleSetConfig(const uint8_t* payload, uint16_t length);
+    void handleGetHistory(const uint8_t* payload, uint16_t length);
+    void streamHistory();
+    void handleEval(const uint8_t* payload, uint16_t length);
+    void streamEval();
+    void streamConfigJson();
+    void handleGetCrash();
+    void streamCrash();
+    void handleScreen(uint8_t command, const uint8_t* payload, uint16_t length);
+    void streamScreen();
+    void handleUpdate(uint8_t command, const uint8_t* payload, uint16_t length);
+
+    /**
+     * @brief 发送应答，负载为状态码 + _tx中已写入的length字节（_tx从HEADER_SIZE + 1开始写）
+     */
+    void reply(uint8_t status, uint16_t length);
+
+    // 写入_tx负载区
+    uint8_t* body() { return _tx + HEADER_SIZE + 1; }
+    static uint8_t* put16(uint8_t* p, uint16_t value);
+    static uint8_t* put32(uint8_t* p, uint32_t value);
+    static uint8_t* putHistogram(uint8_t* p, const PerfHistogram& hist);
+
+    USBCDC _cdc;
+    bool _ready;
+    CalculatorCore* _calculator;
+    PerformanceMonitor* _perf;
+    SimpleHID* _hid;
+
+    uint8_t _rx[HEADER_SIZE + MAX_PAYLOAD + CRC_SIZE];
+    size_t _rxLength;
+    uint8_t _tx[HEADER_SIZE + MAX_PAYLOAD + CRC_SIZE];
+
+    // 当前请求（应答使用）和正在发送的历史记录
+    uint8_t _command;
+    uint8_t _sequence;
+    uint8_t _historySequence;       ///< 历史记录请求的序号
+    uint16_t _historyNext;          ///< 下一条要发送的序号
+    uint16_t _historyEnd;           ///< 发送到此序号（不含）为止，等于_historyNext表示没有在发送
+
+    // 正在发送的JSON配置（ConfigJson的导出缓冲）
+    const char* _jsonText;          ///< nullptr表示没有在发送
+    size_t _jsonLength;
+    size_t _jsonOffset;
+    uint8_t _jsonSequence;
+
+    // 正在发送的崩溃记录（从闪存逐帧读出）
+    uint32_t _crashNext;            ///< 下一帧的偏移
+    uint32_t _crashEnd;             ///< 记录长度，等于_crashNext表示没有在发送
+    uint8_t _crashSequence;
+
+    // 正在发送的截图或实时镜像（ScreenMirror逐帧打包变化的块）
+    uint8_t _screenCommand;         ///< HOST_CMD_GET_SCREEN或HOST_CMD_MIRROR，0表示没有在发送
+    uint8_t _screenSequence;
+
+    // 正在求值的批量请求，_rx此时可以接收下一个请求
+    Expression* _evalExpression;    ///< 首次批量求值时分配，之后一直保留
+    uint8_t _batch[MAX_PAYLOAD];
+    uint16_t _batchLength;
+    uint16_t _batchOffset;          ///< 下一个表达式的位置
+    uint8_t _batchFormat;
+    uint8_t _batchSequence;
+    bool _batchActive;
+    uint32_t _batchCount;           ///< 本批已求值的表达式数
+    uint32_t _batchMicros;          ///< 本批解析和求值的累计耗时
+
+    uint32_t _restartAt;            ///< 固件更新完成后重启的时间，0表示没有
+};
+
+#endif // HOST_LINK_H
@@ -0,0 +1,288 @@
+/**
+ * @file JsonReader.cpp
+ * @brief 流式JSON读取实现
+ *
+ * @author Calculator Project
+ */
+
+#include "JsonReader.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+JsonReader::JsonReader() : _handler(nullptr), _context(nullptr) {
+    begin(nullptr, nullptr);
+}
+
+void JsonReader::begin(Handler handler, void* context) {
+    _handler = handler;
+    _context = context;
+    _status = STATUS_MORE;
+    _state = STATE_VALUE;
+    _offset = 0;
+    _depth = 0;
+    _readingKey = false;
+    _type = TYPE_NULL;
+    _value[0] = '\0';
+    _length = 0;
+    _highSurrogate = 0;
+}
+
+const char* JsonReader::name(uint8_t level) const {
+    if (level == 0 || level > _depth || _stack[level - 1].array) return "";
+    return _stack[level - 1].name;
+}
+
+uint16_t JsonReader::index(uint8_t level) const {
+    if (level == 0 || level > _depth || !_stack[level - 1].array) return 0;
+    return _stack[level - 1].index;
+}
+
+bool JsonReader::toInt(int64_t minValue, int64_t maxValue, int64_t& out) const {
+    if (_type == TYPE_BOOL) {
+        out = _value[0] == 't' ? 1 : 0;
+    } else if (_type == TYPE_NUMBER) {
+        char* end;
+        long long value = strtoll(_value, &end, 10);
+        if (*end != '\0') return false;
+        out = value;
+    } else {
+        return false;
+    }
+    return out >= minValue && out <= maxValue;
+}
+
+bool JsonReader::toDouble(double& out) const {
+    if (_type != TYPE_NUMBER) return false;
+    char* end;
+    out = strtod(_value, &end);
+    return *end == '\0';
+}
+
+JsonReader::Status JsonReader::feed(const char* data, size_t length) {
+    for (size_t i = 0; i < length && _status == STATUS_MORE; i++) {
+        if (!step(data[i])) {
+            _status = STATUS_ERROR;
+            break;
+        }
+        _offset++;
+    }
+    return _status;
+}
+
+bool JsonReader::step(char c) {
+    switch (_state) {
+        case STATE_STRING:
+            if (c == '"') {
+                _state = STATE_NEXT;
+                if (_highSurrogate) return false;
+                if (_readingKey) {
+                    Level& level = _stack[_depth - 1];
+                    // 超长的键名截断：不会与任何已知键相同，其值被忽略
+                    strncpy(level.name, _value, KEY_SIZE - 1);
+                    level.name[KEY_SIZE - 1] = '\0';
+                    _readingKey = false;
+                    _state = STATE_COLON;
+                    return true;
+                }
+                _type = TYPE_STRING;
+                return endValue();
+            }
+            if (c == '\\') {
+                _state = STATE_ESCAPE;
+                return true;
+            }
+            if ((uint8_t)c < 0x20 || _highSurrogate) return false;
+            return append(c) || _readingKey;
+
+        case STATE_ESCAPE:
+            _state = STATE_STRING;
+            if (c == 'u') {
+                _state = STATE_UNICODE;
+                _unicode = 0;
+                _unicodeDigits = 0;
+                return true;
+            }
+            if (_highSurrogate) return false;
+            switch (c) {
+                case '"': case '\\': case '/': break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                default: return false;
+            }
+            return append(c) || _readingKey;
+
+        case STATE_UNICODE: {
+            int digit = hexValue(c);
+            if (digit < 0) return false;
+            _unicode = (_unicode << 4) | digit;
+            if (++_unicodeDigits < 4) return true;
+            _state = STATE_STRING;
+            if (_unicode >= 0xD800 && _unicode < 0xDC00) {
+                if (_highSurrogate) return false;
+                _highSurrogate = _unicode;
+                return true;
+            }
+            if (_unicode >= 0xDC00 && _unicode < 0xE000) {
+                if (!_highSurrogate) return false;
+                uint32_t cp = 0x10000 + (((uint32_t)_highSurrogate - 0xD800) << 10) + (_unicode - 0xDC00);
+                _highSurrogate = 0;
+                return appendCodePoint(cp) || _readingKey;
+            }
+            if (_highSurrogate) return false;
+            return appendCodePoint(_unicode) || _readingKey;
+        }
+
+        case STATE_LITERAL:
+            if (isSpace(c) || c == ',' || c == '}' || c == ']') {
+                if (!endLiteral()) return false;
+                return step(c);
+            }
+            return append(c);
+
+        case STATE_DONE:
+            return false;
+
+        default:
+            break;
+    }
+
+    if (isSpace(c)) return true;
+
+    switch (_state) {
+        case STATE_VALUE:
+            return beginValue(c);
+
+        case STATE_KEY:
+            if (c == '}') return endContainer(false);
+            if (c != '"') return false;
+            _readingKey = true;
+            _length = 0;
+            _value[0] = '\0';
+            _state = STATE_STRING;
+            return true;
+
+        case STATE_COLON:
+            if (c != ':') return false;
+            _state = STATE_VALUE;
+            return true;
+
+        case STATE_NEXT:
+            if (_depth == 0) return false;
+            if (c == ',') {
+                Level& level = _stack[_depth - 1];
+                if (level.array) {
+                    level.index++;
+                    _state = STATE_VALUE;
+                } else {
+                    _state = STATE_KEY;
+                }
+                return true;
+            }
+            if (c == '}' || c == ']') return endContainer(c == ']');
+            return false;
+
+        default:
+            return false;
+    }
+}
+
+bool JsonReader::beginValue(char c) {
+    if (c == '{' || c == '[') {
+        bool array = c == '[';
+        if (_depth >= MAX_DEPTH || !emit(array ? EVENT_ARRAY : EVENT_OBJECT)) return false;
+        Level& level = _stack[_depth++];
+        level.array = array;
+        level.index = 0;
+        level.name[0] = '\0';
+        _state = array ? STATE_VALUE : STATE_KEY;
+        return true;
+    }
+    // 空数组：'['之后直接是']'
+    if (c == ']' && _depth && _stack[_depth - 1].array && _stack[_depth - 1].index == 0) {
+        return endContainer(true);
+    }
+    _length = 0;
+    _value[0] = '\0';
+    if (c == '"') {
+        _readingKey = false;
+        _state = STATE_STRING;
+        return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        _state = STATE_LITERAL;
+        return append(c);
+    }
+    return false;
+}
+
+bool JsonReader::endLiteral() {
+    if (strcmp(_value, "true") == 0 || strcmp(_value, "false") == 0) {
+        _type = TYPE_BOOL;
+    } else if (strcmp(_value, "null") == 0) {
+        _type = TYPE_NULL;
+    } else {
+        char* end;
+        strtod(_value, &end);
+        if (*end != '\0' || _value[0] == 't' || _value[0] == 'f' || _value[0] == 'n') return false;
+        _type = TYPE_NUMBER;
+    }
+    return endValue();
+}
+
+bool JsonReader::endValue() {
+    if (!emit(EVENT_VALUE)) return false;
+    _state = _depth ? STATE_NEXT : STATE_DONE;
+    if (!_depth) _status = STATUS_DONE;
+    return true;
+}
+
+bool JsonReader::endContainer(bool array) {
+    if (_depth == 0 || _stack[_depth - 1].array != array) return false;
+    _depth--;
+    if (!emit(EVENT_END)) return false;
+    _state = _depth ? STATE_NEXT : STATE_DONE;
+    if (!_depth) _status = STATUS_DONE;
+    return true;
+}
+
+bool JsonReader::append(char c) {
+    if (_length + 1 >= VALUE_SIZE) return false;
+    _value[_length++] = c;
+    _value[_length] = '\0';
+    return true;
+}
+
+bool JsonReader::appendCodePoint(uint32_t cp) {
+    if (cp < 0x80) return append((char)cp);
+    if (cp < 0x800) {
+        return append((char)(0xC0 | (cp >> 6))) && append((char)(0x80 | (cp & 0x3F)));
+    }
+    if (cp < 0x10000) {
+        return append((char)(0xE0 | (cp >> 12))) && append((char)(0x80 | ((cp >> 6) & 0x3F))) &&
+               append((char)(0x80 | (cp & 0x3F)));
+    }
+    return append((char)(0xF0 | (cp >> 18))) && append((char)(0x80 | ((cp >> 12) & 0x3F))) &&
+           append((char)(0x80 | ((cp >> 6) & 0x3F))) && append((char)(0x80 | (cp & 0x3F)));
+}
+
+bool JsonReader::emit(Event event) {
+    return !_handler || _handler(event, *this, _context);
+}
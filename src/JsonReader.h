@@ -0,0 +1,149 @@
+/**
+ * @file JsonReader.h
+ * @brief 流式JSON读取：逐字节状态机，不建文档树
+ * @details 配置导入用。数据可以分任意多块送入feed()，读取器只保存：
+ * - 当前路径：每层的键名（对象）或下标（数组），最多MAX_DEPTH层
+ * - 正在读的一个键名和一个标量值：键名超过KEY_SIZE时截断（不会与已知键相同，按未知键忽略），
+ *   值超过VALUE_SIZE时报错
+ * 每读完一个标量值、每进入/离开一个对象或数组回调一次，处理函数按路径直接写入目标表，
+ * 不认识的路径直接忽略。内存占用固定，与文档大小无关。
+ *
+ * 字符串支持JSON的全部转义，\\uXXXX（含代理对）转为UTF-8；数字、true/false/null按原文交给处理函数。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class JsonReader {
+public:
+    static const uint8_t MAX_DEPTH = 4;         ///< 最大嵌套层数（顶层对象为第1层）
+    static const uint8_t KEY_SIZE = 24;         ///< 键名最大字节数（含'\0'）
+    static const uint8_t VALUE_SIZE = 128;      ///< 标量值最大字节数（含'\0'）
+
+    enum Event : uint8_t {
+        EVENT_VALUE,            ///< 读完一个标量值
+        EVENT_OBJECT,           ///< 进入对象
+        EVENT_ARRAY,            ///< 进入数组
+        EVENT_END               ///< 离开对象或数组
+    };
+
+    enum Type : uint8_t {
+        TYPE_STRING,
+        TYPE_NUMBER,
+        TYPE_BOOL,
+        TYPE_NULL
+    };
+
+    enum Status : uint8_t {
+        STATUS_MORE,            ///< 文档尚未结束，等待更多数据
+        STATUS_DONE,            ///< 顶层值已读完
+        STATUS_ERROR            ///< 语法错误、超出容量或处理函数拒绝
+    };
+
+    /**
+     * @brief 事件处理函数
+     * @details 事件所指的项由depth()和name()/index()描述：顶层值depth()为0，
+     *          顶层对象的成员为1；EVENT_END与对应的进入事件路径相同
+     * @return false 中止读取（状态变为STATUS_ERROR）
+     */
+    typedef bool (*Handler)(Event event, const JsonReader& reader, void* context);
+
+    JsonReader();
+
+    /**
+     * @brief 开始读取一个新文档
+     */
+    void begin(Handler handler, void* context);
+
+    /**
+     * @brief 送入一块数据
+     * @return 当前状态；读完顶层值后停止，之后的数据不再读取（offset()为文档长度）
+     */
+    Status feed(const char* data, size_t length);
+
+    Status status() const { return _status; }
+    size_t offset() const { return _offset; }      ///< 已读字节数，出错时为出错位置
+
+    uint8_t depth() const { return _depth; }
+
+    /**
+     * @brief 路径上第level层（1起）的键名，该层是数组时返回""
+     */
+    const char* name(uint8_t level) const;
+
+    /**
+     * @brief 路径上第level层（1起）的数组下标，该层是对象时返回0
+     */
+    uint16_t index(uint8_t level) const;
+
+    /**
+     * @brief 当前项的键名（depth()层），顶层值返回""
+     */
+    const char* name() const { return name(_depth); }
+
+    Type type() const { return _type; }
+    const char* text() const { return _value; }
+
+    /**
+     * @brief 数值或布尔值（true为1）转为整数并检查范围
+     * @return 不是整数或超出范围返回false
+     */
+    bool toInt(int64_t minValue, int64_t maxValue, int64_t& out) const;
+
+    /**
+     * @brief 数值转为double
+     */
+    bool toDouble(double& out) const;
+
+private:
+    enum State : uint8_t {
+        STATE_VALUE,            ///< 等待一个值
+        STATE_KEY,              ///< 对象中等待键名或'}'
+        STATE_COLON,            ///< 键名之后等待':'
+        STATE_NEXT,             ///< 值之后等待','或结束符
+        STATE_STRING,           ///< 字符串内
+        STATE_ESCAPE,           ///< '\\'之后
+        STATE_UNICODE,          ///< \\u之后的4位十六进制
+        STATE_LITERAL,          ///< 数字或true/false/null
+        STATE_DONE
+    };
+
+    struct Level {
+        bool array;
+        uint16_t index;
+        char name[KEY_SIZE];
+    };
+
+    bool step(char c);
+    bool beginValue(char c);
+    bool endLiteral();
+    bool endValue();
+    bool endContainer(bool array);
+    bool append(char c);
+    bool appendCodePoint(uint32_t cp);
+    bool emit(Event event);
+
+    Handler _handler;
+    void* _context;
+    Status _status;
+    State _state;
+    size_t _offset;
+
+    Level _stack[MAX_DEPTH];
+    uint8_t _depth;                 ///< 当前所在容器的层数
+
+    bool _readingKey;               ///< STATE_STRING读的是键名
+    Type _type;
+    char _value[VALUE_SIZE];
+    uint8_t _length;
+    uint32_t _unicode;              ///< \\u转义的累计值
+    uint8_t _unicodeDigits;
+    uint16_t _highSurrogate;        ///< 等待低位代理的高位代理，0表示没有
+};
+
+#endif // JSON_READER_H
@@ -0,0 +1,73 @@
+/**
+ * @file KeyEventBus.cpp
+ * @brief 按键事件总线实现
+ *
+ * @author Calculator Project
+ */
+
+#include "KeyEventBus.h"
+#include <string.h>
+#include <esp_attr.h>
+
+bool KeyEventBus::subscribe(const KeySubscriber& subscriber) {
+    if (_count >= MAX_SUBSCRIBERS || !subscriber.handler) return false;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (strcmp(_subscribers[i].name, subscriber.name) == 0) return false;
+    }
+
+    // 插在第一个阶段更大的订阅者之前
+    uint8_t pos = _count;
+    while (pos > 0 && _subscribers[pos - 1].stage > subscriber.stage) {
+        _subscribers[pos] = _subscribers[pos - 1];
+        pos--;
+    }
+    _subscribers[pos] = subscriber;
+    _count++;
+
+    if (subscriber.stage == KEY_STAGE_DEFERRED) {
+        _deferredMask |= subscriber.typeMask;
+    }
+    return true;
+}
+
+void IRAM_ATTR KeyEventBus::publish(const KeyEvent& event) {
+    uint8_t bit = KEY_EVENT_BIT(event.type);
+    uint8_t i = 0;
+    for (; i < _count && _subscribers[i].stage != KEY_STAGE_DEFERRED; i++) {
+        if (_subscribers[i].typeMask & bit) {
+            _subscribers[i].handler(event, _subscribers[i].context);
+        }
+    }
+
+    if (!(_deferredMask & bit)) return;
+    if (_deferredCount == DEFERRED_CAPACITY) {
+        // 一批事件超过容量：提前结束这一批，不丢事件
+        flush();
+    }
+    _deferred[_deferredCount++] = event;
+}
+
+void IRAM_ATTR KeyEventBus::flush() {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_subscribers[i].flush) {
+            _subscribers[i].flush(_subscribers[i].context);
+        }
+    }
+    if (!_deferredCount) return;
+
+    for (uint8_t e = 0; e < _deferredCount; e++) {
+        uint8_t bit = KEY_EVENT_BIT(_deferred[e].type);
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_subscribers[i].stage == KEY_STAGE_DEFERRED && (_subscribers[i].typeMask & bit)) {
+                _subscribers[i].handler(_deferred[e], _subscribers[i].context);
+            }
+        }
+    }
+    _deferredCount = 0;
+
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_subscribers[i].stage == KEY_STAGE_DEFERRED && _subscribers[i].drained) {
+            _subscribers[i].drained(_subscribers[i].context);
+        }
+    }
+}
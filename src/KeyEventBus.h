@@ -0,0 +1,122 @@
+/**
+ * @file KeyEventBus.h
+ * @brief 按键事件总线
+ * @details 键盘只负责产生事件，HID、按键反馈、计算器等消费方各自订阅：
+ * - 订阅表是固定大小的数组，各模块在初始化时登记，不分配内存
+ * - 每个订阅者用类型掩码过滤事件，分发时只是一次位与和一次函数调用
+ * - 订阅者按阶段排序：HID输出最先，其次是蜂鸣器和LED反馈，都在事件到达时立即处理；
+ *   计算器这类耗时的处理登记为推迟阶段，事件复制进定长队列，
+ *   等flush()发出HID报告等批量输出之后再处理；一批推迟的事件处理完后调用drained，
+ *   计算器借此把一批按键的显示合并为一次刷新
+ * 事件只在主循环中分发（扫描任务的事件先经KeypadControl的队列转到主循环，
+ * USB任务收到的主机LED状态由SimpleHID::update()发布），订阅者之间不存在并发。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef KEY_EVENT_BUS_H
+#define KEY_EVENT_BUS_H
+
+#include <stdint.h>
+
+/**
+ * @brief 按键事件类型枚举
+ */
+enum KeyEventType {
+    KEY_EVENT_PRESS,      ///< 按键按下
+    KEY_EVENT_RELEASE,    ///< 按键释放
+    KEY_EVENT_LONGPRESS,  ///< 长按
+    KEY_EVENT_REPEAT,     ///< 自动重复
+    KEY_EVENT_COMBO,      ///< 组合键
+    KEY_EVENT_HOST_LED    ///< 主机LED状态变化（HID输出报告），key为HOST_LED_*位图
+};
+
+#define KEY_EVENT_BIT(type) (1u << (type))
+#define KEY_EVENT_ALL_KEYS (KEY_EVENT_BIT(KEY_EVENT_PRESS) | KEY_EVENT_BIT(KEY_EVENT_RELEASE) | \
+                            KEY_EVENT_BIT(KEY_EVENT_LONGPRESS) | KEY_EVENT_BIT(KEY_EVENT_REPEAT))
+#define KEY_EVENT_ALL (KEY_EVENT_ALL_KEYS | KEY_EVENT_BIT(KEY_EVENT_COMBO))    ///< 不含主机事件
+
+// HID LED报告的位（Usage Page 0x08）
+#define HOST_LED_NUM_LOCK    0x01
+#define HOST_LED_CAPS_LOCK   0x02
+#define HOST_LED_SCROLL_LOCK 0x04
+
+#define KEY_EVENT_FLAG_REPLAY 0x01      ///< 由按键日志回放产生，不是真实按键
+
+/**
+ * @brief 按键事件
+ * @details 组合键事件中combo/count为组合内的按键（按编号升序），
+ *          key为registerChord()注册的组合ID，未注册或不从修饰键开始的组合为0；主机LED事件中key为LED位图
+ */
+struct KeyEvent {
+    KeyEventType type;      ///< 事件类型
+    uint8_t key;            ///< 按键编号
+    uint8_t count;          ///< 组合键数量
+    uint8_t combo[5];       ///< 组合键
+    uint8_t flags;          ///< KEY_EVENT_FLAG_*
+    int64_t timestamp;      ///< 扫描时刻（esp_timer_get_time()，µs），用于统计各环节延迟
+};
+
+/**
+ * @brief 分发阶段，同一事件按阶段从小到大交给订阅者
+ */
+enum KeyEventStage : uint8_t {
+    KEY_STAGE_OUTPUT,       ///< 对外输出（HID），最先处理
+    KEY_STAGE_FEEDBACK,     ///< 本地反馈（蜂鸣器、LED）
+    KEY_STAGE_DEFERRED      ///< 推迟到flush()之后（计算器和显示）
+};
+
+/**
+ * @brief 订阅者
+ */
+struct KeySubscriber {
+    const char* name;                                   ///< 名称（调试输出用）
+    uint8_t typeMask;                                   ///< 关心的事件类型，KEY_EVENT_BIT()的组合
+    KeyEventStage stage;
+    void (*handler)(const KeyEvent& event, void* context);
+    void (*flush)(void* context);                       ///< 一批事件分发完时调用（如发送HID报告），可为nullptr
+    void* context;
+    void (*drained)(void* context);                     ///< 推迟阶段：这一批推迟的事件都处理完后调用，可为nullptr
+};
+
+class KeyEventBus {
+public:
+    static const uint8_t MAX_SUBSCRIBERS = 8;
+    static const uint8_t DEFERRED_CAPACITY = 16;        ///< 一次flush()之间可推迟的事件数
+
+    static KeyEventBus& instance() {
+        static KeyEventBus instance;
+        return instance;
+    }
+
+    /**
+     * @brief 登记订阅者（按阶段插入，同阶段按登记顺序）
+     * @return false 订阅表已满或同名订阅者已存在
+     */
+    bool subscribe(const KeySubscriber& subscriber);
+
+    /**
+     * @brief 分发一个事件：立即阶段的订阅者直接处理，推迟阶段的事件入队
+     */
+    void publish(const KeyEvent& event);
+
+    /**
+     * @brief 结束一批事件：先调用各订阅者的flush，再把推迟的事件交给推迟阶段的订阅者，
+     *        最后调用推迟阶段订阅者的drained
+     */
+    void flush();
+
+    uint8_t getSubscriberCount() const { return _count; }
+    const KeySubscriber& getSubscriber(uint8_t i) const { return _subscribers[i]; }
+
+private:
+    KeyEventBus() : _count(0), _deferredMask(0), _deferredCount(0) {}
+
+    KeySubscriber _subscribers[MAX_SUBSCRIBERS];
+    uint8_t _count;
+    uint8_t _deferredMask;                              ///< 推迟阶段订阅者关心的类型之和
+    KeyEvent _deferred[DEFERRED_CAPACITY];
+    uint8_t _deferredCount;
+};
+
+#endif // KEY_EVENT_BUS_H
@@ -0,0 +1,198 @@
+/**
+ * @file KeyJournal.cpp
+ * @brief 按键日志与回放实现
+ *
+ * @author Calculator Project
+ */
+
+#include "KeyJournal.h"
+#include "Console.h"
+#include "Logger.h"
+#include "BufferPlacement.h"
+#include "LoopScheduler.h"
+#include <esp_timer.h>
+
+#define TAG_JOURNAL "Journal"
+
+static_assert(sizeof(KeyJournal::Entry) == 8, "按键日志每条8字节");
+static_assert(KEY_JOURNAL_ENTRIES <= 0xFFFF, "记录数用16位计数");
+
+namespace {
+
+const char* const TYPE_NAMES[] = {"按下", "释放", "长按", "重复", "组合"};
+
+void cmdJournal(const ConsoleArgs& args) {
+    KeyJournal& journal = KeyJournal::instance();
+    if (args.is(1, "clear")) {
+        journal.clear();
+        Serial.println("按键日志已清空");
+    } else if (args.is(1, "dump")) {
+        journal.dump(Serial);
+    } else if (args.count < 2) {
+        journal.printStatus(Serial);
+    } else {
+        Serial.println("用法: journal [clear|dump]");
+    }
+}
+
+void cmdReplay(const ConsoleArgs& args) {
+    KeyJournal& journal = KeyJournal::instance();
+    if (args.is(1, "stop")) {
+        journal.stopReplay();
+    } else if (args.count > 1 && !args.is(1, "fast")) {
+        Serial.println("用法: replay [fast|stop]");
+    } else if (journal.isReplaying()) {
+        Serial.println("正在回放（replay stop 停止）");
+    } else if (!journal.startReplay(args.is(1, "fast"))) {
+        Serial.println("按键日志为空");
+    } else {
+        Serial.printf("开始%s回放 %u 个按键事件\n", args.is(1, "fast") ? "最快速度" : "按原间隔", journal.count());
+    }
+}
+
+constexpr ConsoleCommand JOURNAL_COMMANDS[] = {
+    {"journal", "[clear|dump]", "按键日志（无参数时显示记录数和时间跨度）", cmdJournal},
+    {"replay", "[fast|stop]", "把按键日志重新送入按键处理流程（按原间隔或最快速度）", cmdReplay},
+};
+static_assert(consoleSorted(JOURNAL_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+KeyJournal::KeyJournal()
+    : _entries(nullptr),
+      _head(0),
+      _count(0),
+      _replaying(false),
+      _replayFast(false),
+      _replayPos(0),
+      _replayEnd(0),
+      _replayOrigin(0),
+      _replayStart(0) {}
+
+bool KeyJournal::begin() {
+    _entries = (Entry*)placedAlloc("key_journal", sizeof(Entry) * KEY_JOURNAL_ENTRIES, PLACE_PSRAM);
+    if (!_entries) {
+        LOG_W(TAG_JOURNAL, "按键日志缓冲分配失败");
+        return false;
+    }
+    Console::instance().addCommands(JOURNAL_COMMANDS);
+    return KeyEventBus::instance().subscribe(KeySubscriber{"journal", KEY_EVENT_ALL, KEY_STAGE_OUTPUT,
+                                                           recordEntry, nullptr, this});
+}
+
+void KeyJournal::clear() {
+    stopReplay();
+    _head = 0;
+    _count = 0;
+}
+
+void KeyJournal::recordEntry(const KeyEvent& event, void* context) {
+    static_cast<KeyJournal*>(context)->record(event);
+}
+
+void KeyJournal::record(const KeyEvent& event) {
+    if (event.flags & KEY_EVENT_FLAG_REPLAY) return;
+    if (_replaying) {
+        // 真实按键打断回放，之后的记录会覆盖回放范围
+        stopReplay();
+    }
+
+    Entry& entry = _entries[_head];
+    entry.timeLo = (uint32_t)event.timestamp;
+    entry.timeHi = (uint16_t)(event.timestamp >> 32);
+    entry.key = event.key;
+    entry.type = (uint8_t)event.type;
+    _head = (_head + 1) % KEY_JOURNAL_ENTRIES;
+    if (_count < KEY_JOURNAL_ENTRIES) _count++;
+}
+
+bool KeyJournal::startReplay(bool fast) {
+    if (!_count) return false;
+    _replaying = true;
+    _replayFast = fast;
+    _replayPos = 0;
+    _replayEnd = _count;
+    _replayOrigin = at(0).time();
+    _replayStart = esp_timer_get_time();
+    LoopScheduler::instance().after(0);
+    return true;
+}
+
+void KeyJournal::stopReplay() {
+    if (!_replaying) return;
+    _replaying = false;
+    Serial.printf("回放已停止: %u/%u 个事件\n", _replayPos, _replayEnd);
+}
+
+void KeyJournal::update() {
+    if (!_replaying) return;
+
+    int64_t now = esp_timer_get_time();
+    bool waiting = false;
+    for (uint8_t n = 0; _replayPos < _replayEnd; n++) {
+        const Entry& entry = at(_replayPos);
+        if (_replayFast) {
+            if (n >= REPLAY_BATCH) break;
+        } else if (entry.time() - _replayOrigin > now - _replayStart) {
+            // 按原间隔：等到下一个事件的时刻
+            LoopScheduler::instance().at(millis() + (uint32_t)((entry.time() - _replayOrigin - (now - _replayStart)) / 1000));
+            waiting = true;
+            break;
+        }
+
+        _replayPos++;
+        inject((KeyEventType)entry.type, entry.key);
+    }
+    // 这一轮回放的事件作为一批：计算器逐个处理，显示只刷新一次
+    KeyEventBus::instance().flush();
+    if (waiting) return;
+
+    if (_replayPos < _replayEnd) {
+        LoopScheduler::instance().after(0);
+    } else {
+        finishReplay();
+    }
+}
+
+void KeyJournal::inject(KeyEventType type, uint8_t key) {
+    KeyEvent event = {};
+    event.type = type;
+    event.key = key;
+    event.flags = KEY_EVENT_FLAG_REPLAY;
+    event.timestamp = esp_timer_get_time();
+    KeyEventBus::instance().publish(event);
+}
+
+void KeyJournal::finishReplay() {
+    _replaying = false;
+    uint32_t elapsedUs = (uint32_t)(esp_timer_get_time() - _replayStart);
+    Serial.printf("回放完成: %u 个事件, 用时 %lu.%03lu ms", _replayEnd,
+                  (unsigned long)(elapsedUs / 1000), (unsigned long)(elapsedUs % 1000));
+    if (_replayFast && elapsedUs) {
+        Serial.printf(", 平均 %lu us/事件", (unsigned long)(elapsedUs / _replayEnd));
+    }
+    Serial.println();
+}
+
+void KeyJournal::printStatus(Print& out) const {
+    out.printf("按键日志: %u/%u 条", _count, (unsigned)KEY_JOURNAL_ENTRIES);
+    if (_count) {
+        int64_t span = at(_count - 1).time() - at(0).time();
+        out.printf(", 时间跨度 %lu ms", (unsigned long)(span / 1000));
+    }
+    if (_replaying) {
+        out.printf(", 回放中 %u/%u", _replayPos, _replayEnd);
+    }
+    out.println();
+}
+
+void KeyJournal::dump(Print& out) const {
+    // 时刻相对第一条记录
+    int64_t origin = _count ? at(0).time() : 0;
+    for (uint16_t i = 0; i < _count; i++) {
+        const Entry& entry = at(i);
+        uint32_t ms = (uint32_t)((entry.time() - origin) / 1000);
+        out.printf("%8lu.%03u  %3u  %s\n", (unsigned long)ms, (unsigned)((entry.time() - origin) % 1000),
+                   entry.key, entry.type < 5 ? TYPE_NAMES[entry.type] : "?");
+    }
+}
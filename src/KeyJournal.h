@@ -0,0 +1,98 @@
+/**
+ * @file KeyJournal.h
+ * @brief 按键日志与回放
+ * @details 作为按键事件总线的订阅者记录每个真实按键事件，用于复现现场问题和端到端基准：
+ * - 每条8字节：48位扫描时刻（µs）、按键编号（组合键为组合ID）、事件类型
+ * - 环形缓冲KEY_JOURNAL_ENTRIES条（优先PSRAM），写满后覆盖最旧的
+ * - 回放把事件重新交给事件总线（带KEY_EVENT_FLAG_REPLAY，HID不输出、日志不记录），
+ *   按原来的间隔或以最快速度（每次主循环一批）；回放期间有真实按键时停止
+ * - 双功能键按释放是否早于判定时间区分轻触和按住，最快速度回放时都按轻触处理
+ * - 串口命令 journal 查看/清空，replay 回放
+ *
+ * @author Calculator Project
+ */
+
+#ifndef KEY_JOURNAL_H
+#define KEY_JOURNAL_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "KeyEventBus.h"
+
+class KeyJournal {
+public:
+    struct Entry {
+        uint32_t timeLo;        ///< 扫描时刻低32位（µs）
+        uint16_t timeHi;        ///< 扫描时刻高16位
+        uint8_t key;            ///< 按键编号，组合键为组合ID
+        uint8_t type;           ///< KeyEventType
+
+        int64_t time() const { return ((int64_t)timeHi << 32) | timeLo; }
+    };
+
+    static const uint8_t REPLAY_BATCH = 8;          ///< 最快速度回放时每次主循环处理的事件数
+
+    static KeyJournal& instance() {
+        static KeyJournal instance;
+        return instance;
+    }
+
+    /**
+     * @brief 分配缓冲、订阅事件总线并注册串口命令
+     */
+    bool begin();
+
+    void clear();
+    uint16_t count() const { return _count; }
+
+    /**
+     * @brief 第i条记录（0为最旧）
+     */
+    const Entry& at(uint16_t i) const {
+        return _entries[(_head + KEY_JOURNAL_ENTRIES - _count + i) % KEY_JOURNAL_ENTRIES];
+    }
+
+    /**
+     * @brief 开始回放当前全部记录
+     * @param fast true以最快速度，false按原来的间隔
+     * @return 没有记录时返回false
+     */
+    bool startReplay(bool fast);
+    void stopReplay();
+    bool isReplaying() const { return _replaying; }
+
+    /**
+     * @brief 把一个合成按键事件送入处理流程（与回放相同：HID不输出，日志不记录）
+     */
+    void inject(KeyEventType type, uint8_t key);
+
+    /**
+     * @brief 推进回放（主循环调用，未回放时立即返回）
+     */
+    void update();
+
+    void printStatus(Print& out) const;
+    void dump(Print& out) const;
+
+private:
+    KeyJournal();
+    KeyJournal(const KeyJournal&) = delete;
+    KeyJournal& operator=(const KeyJournal&) = delete;
+
+    static void recordEntry(const KeyEvent& event, void* context);
+    void record(const KeyEvent& event);
+    void finishReplay();
+
+    Entry* _entries;
+    uint16_t _head;             ///< 下一条写入的位置
+    uint16_t _count;            ///< 有效记录数
+
+    bool _replaying;
+    bool _replayFast;
+    uint16_t _replayPos;        ///< 下一条回放的记录序号（0为最旧）
+    uint16_t _replayEnd;        ///< 回放开始时的记录数
+    int64_t _replayOrigin;      ///< 第一条记录的扫描时刻
+    int64_t _replayStart;       ///< 回放开始的时刻
+};
+
+#endif // KEY_JOURNAL_H
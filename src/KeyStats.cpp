@@ -0,0 +1,36 @@
+/**
+ * @file KeyStats.cpp
+ * @brief 按键开关健康统计输出
+ *
+ * @author Calculator Project
+ */
+
+#include "KeyStats.h"
+
+void KeyStats::print(const KeyStatsData& data, Print& out) {
+    out.printf(" %4s %9s %9s %7s %6s %8s %8s\n", "键", "按下", "抖动", "抖动/次", "连击", "平均ms", "最短ms");
+    uint32_t presses = 0, bounces = 0, chatters = 0, flagged = 0;
+    for (uint8_t i = 0; i < KeyStatsData::KEY_COUNT; i++) {
+        const KeyStatsEntry& e = data.keys[i];
+        if (!e.presses && !e.bounces) continue;
+        presses += e.presses;
+        bounces += e.bounces;
+        chatters += e.chatters;
+
+        // 比例以0.01为单位
+        uint32_t ratio = e.presses ? (uint32_t)((uint64_t)e.bounces * 100 / e.presses) : 0;
+        bool worn = e.chatters > 0 || ratio >= KEY_STATS_WARN_BOUNCE_PCT;
+        if (worn) flagged++;
+        out.printf(" %4u %9lu %9lu %4lu.%02lu %6u %8lu %8u%s\n", i + 1, (unsigned long)e.presses,
+                   (unsigned long)e.bounces, (unsigned long)(ratio / 100), (unsigned long)(ratio % 100),
+                   e.chatters, (unsigned long)(e.presses ? e.pressMs / e.presses : 0), e.shortestMs,
+                   worn ? "  *" : "");
+    }
+    out.printf("合计: 按下 %lu, 抖动 %lu, 连击 %lu", (unsigned long)presses, (unsigned long)bounces,
+               (unsigned long)chatters);
+    if (flagged) {
+        out.printf("；%lu 个按键标*（有连击或抖动/次 >= %u.%02u），可能需要更换开关",
+                   (unsigned long)flagged, KEY_STATS_WARN_BOUNCE_PCT / 100, KEY_STATS_WARN_BOUNCE_PCT % 100);
+    }
+    out.println();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file KeyStats.h
+ * @brief 按键开关健康统计
+ * @details 开关老化的表现是触点抖动变多，严重时抖动越过去抖变成重复输入。每个按键统计：
+ * - 按下次数（去抖后）
+ * - 抖动：原始采样的边沿数减去去抖后的状态变化数，即被去抖吸收掉的边沿
+ * - 连击：释放后KEY_STATS_CHATTER_MS内同一键再次按下，疑似去抖没挡住的抖动
+ * - 累计和最短按住时长
+ * 热路径只有扫描时一次异或判断（没有边沿时直接返回），可以常开。
+ * 表格定长，定期经ConfigManager与其他配置一起写入NVS，串口命令 keystats 查看。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef KEY_STATS_H
+#define KEY_STATS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define KEY_STATS_VERSION 1
+
+// 单个按键的统计
+struct KeyStatsEntry {
+    uint32_t presses;           // 按下次数
+    uint32_t bounces;           // 被去抖吸收的原始边沿数
+    uint32_t pressMs;           // 累计按住时长
+    uint16_t chatters;          // 连击次数
+    uint16_t shortestMs;        // 最短按住时长，0表示还没有完整的按下
+};
+
+// 统计表在NVS中的存储格式
+struct KeyStatsData {
+    static const uint8_t KEY_COUNT = 22;
+    uint16_t version = KEY_STATS_VERSION;
+    uint16_t count = KEY_COUNT;
+    KeyStatsEntry keys[KEY_COUNT] = {};
+};
+
+class KeyStats {
+public:
+    KeyStats() { reset(); }
+
+    /**
+     * @brief 记录一次扫描中原始采样发生变化的按键
+     * @param keyMask 按键位图，bit i 对应按键 i+1
+     */
+    void onRawEdges(uint32_t keyMask) {
+        while (keyMask) {
+            uint8_t i = __builtin_ctz(keyMask);
+            keyMask &= keyMask - 1;
+            if (i < KeyStatsData::KEY_COUNT) _data.keys[i].bounces++;
+        }
+    }
+
+    /**
+     * @brief 去抖后按下
+     * @param index 按键序号（编号-1）
+     */
+    void onPress(uint8_t index, uint32_t now) {
+        if (index >= KeyStatsData::KEY_COUNT) return;
+        KeyStatsEntry& e = _data.keys[index];
+        e.presses++;
+        settleEdge(e);
+        if (_releasedAt[index] && now - _releasedAt[index] < KEY_STATS_CHATTER_MS) e.chatters++;
+    }
+
+    /**
+     * @brief 去抖后释放
+     * @param index 按键序号（编号-1）
+     * @param heldMs 本次按住时长
+     */
+    void onRelease(uint8_t index, uint32_t now, uint32_t heldMs) {
+        if (index >= KeyStatsData::KEY_COUNT) return;
+        KeyStatsEntry& e = _data.keys[index];
+        settleEdge(e);
+        e.pressMs += heldMs;
+        uint16_t held = heldMs > 0xFFFF ? 0xFFFF : (heldMs ? heldMs : 1);
+        if (!e.shortestMs || held < e.shortestMs) e.shortestMs = held;
+        _releasedAt[index] = now ? now : 1;
+    }
+
+    void snapshot(KeyStatsData& out) const { out = _data; }
+
+    /**
+     * @brief 载入保存的统计（版本或按键数不符时忽略）
+     */
+    bool restore(const KeyStatsData& in) {
+        if (in.version != KEY_STATS_VERSION || in.count != KeyStatsData::KEY_COUNT) return false;
+        _data = in;
+        return true;
+    }
+
+    void reset() {
+        _data = KeyStatsData();
+        memset(_releasedAt, 0, sizeof(_releasedAt));
+    }
+
+    /**
+     * @brief 输出统计表，抖动比例或连击超过阈值的按键标出
+     */
+    static void print(const KeyStatsData& data, Print& out);
+
+private:
+    // 去抖后的状态变化对应一个真实边沿，不计为抖动（只有之前记下过的原始边沿才抵消）
+    static void settleEdge(KeyStatsEntry& e) {
+        if (e.bounces) e.bounces--;
+    }
+
+    KeyStatsData _data;
+    uint32_t _releasedAt[KeyStatsData::KEY_COUNT];  // 上次释放时刻，0表示还没有释放过
+};
+
+#endif // KEY_STATS_H
@@ -7,27 +7,82 @@
  */
 
 #include "KeyboardConfig.h"
+#include "LayoutData.h"
+#include "LayoutKeys.h"
+#include "Console.h"
+#include <Preferences.h>
+#include <esp_rom_crc.h>
+#include <stddef.h>
 #include <functional>
 
+#define LAYOUT_BLOB_MAGIC  0x59414C4BUL     // "KLAY"
+#define LAYOUT_BLOB_FORMAT 4              // 2: 按键记录增加holdMs，3: 增加autoRepeat，4: 增加按键颜色
+
 // 静态常量定义
 const char* KeyboardConfigManager::PREF_NAMESPACE = "keyboard_cfg";
 const char* KeyboardConfigManager::PREF_CONFIG_KEY = "layout_data";
-const char* KeyboardConfigManager::PREF_VERSION_KEY = "version";
-const char* KeyboardConfigManager::PREF_CHECKSUM_KEY = "checksum";
 
 // 全局实例定义
 KeyboardConfigManager keyboardConfig;
 
+// ============================================================================
+// 默认布局：按键表和方案表（PROFILES）由 tools/layout_compile.py 从 layouts/keypad.layout
+// 生成到 LayoutData.h，位于Flash
+// ============================================================================
+
+namespace {
+
+constexpr LayerConfig LAYERS[KeyboardConfigManager::LAYER_COUNT] = {
+    {KeyLayer::PRIMARY, "主层", "数字和四则运算"},
+    {KeyLayer::SECONDARY, "次层", "科学计算和内存功能"},
+};
+
+// 串口命令
+void cmdLayout(const ConsoleArgs& args) {
+    keyboardConfig.printConfig();
+}
+
+void cmdProfile(const ConsoleArgs& args) {
+    if (args.count > 1) {
+        int index = 0;
+        if (!args.toInt(1, index) || index < 1 || !keyboardConfig.selectProfile(index - 1)) {
+            Serial.printf("无效的方案编号，范围 1-%d\n", KeyboardConfigManager::getProfileCount());
+        }
+    }
+    Serial.printf("当前布局方案: %s (%d/%d)\n", keyboardConfig.getProfile().name,
+                  keyboardConfig.getProfileIndex() + 1, KeyboardConfigManager::getProfileCount());
+}
+
+constexpr ConsoleCommand KEYBOARD_COMMANDS[] = {
+    {"config", "", "显示当前加载的配置", cmdLayout},
+    {"layout", "", "显示键盘布局", cmdLayout},
+    {"profile", "[n]", "显示或选择布局方案（也可 Tab+1~7 或长按Tab）", cmdProfile},
+};
+static_assert(consoleSorted(KEYBOARD_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
 KeyboardConfigManager::KeyboardConfigManager()
     : _currentLayer(KeyLayer::PRIMARY)
-    , _lastLayerSwitchTime(0) {
+    , _lastLayerSwitchTime(0)
+    , _layerCallback(nullptr)
+    , _layerContext(nullptr)
+    , _profile(&PROFILES[0])
+    , _profileIndex(0)
+    , _active(&_tables[0])
+    , _dirty(false)
+    , _saveTimer(TimerWheel::INVALID) {
+    static_assert(sizeof(LayoutBlobKey) == 20, "按键记录的布局已改变，需要提高LAYOUT_BLOB_FORMAT");
+    
+    clearTable(_tables[0]);
+    clearTable(_tables[1]);
     
     // 初始化Tab键行为配置
     _tabBehavior.shortPressThreshold = 200;      // 200ms内为短按
     _tabBehavior.longPressThreshold = 1000;      // 1000ms以上为长按
     _tabBehavior.enableAutoReturn = true;        // 启用自动返回主层
     _tabBehavior.autoReturnTimeout = 30000;      // 30秒后自动返回
-    _tabBehavior.onLongPress = nullptr;          // 长按回调
+    _tabBehavior.onLongPress = [this]() { nextProfile(); };  // 长按切换布局方案
     _tabBehavior.onDoublePress = nullptr;        // 双击回调
 }
 
@@ -37,12 +92,10 @@ KeyboardConfigManager::~KeyboardConfigManager() {
 
 bool KeyboardConfigManager::begin() {
     KEYBOARD_LOG_I("初始化键盘配置管理器");
-    
-    // 初始化Preferences
-    if (!_preferences.begin(PREF_NAMESPACE, false)) {
-        KEYBOARD_LOG_E("初始化Preferences失败");
-        return false;
-    }
+    Console::instance().addCommands(KEYBOARD_COMMANDS);
+    _saveTimer = TimerWheel::instance().create("layout", [](void* context) {
+        static_cast<KeyboardConfigManager*>(context)->flush();
+    }, this);
     
     // 加载配置
     if (!loadConfig()) {
@@ -54,55 +107,67 @@ bool KeyboardConfigManager::begin() {
     return true;
 }
 
-bool KeyboardConfigManager::loadConfig(bool forceDefault) {
-    if (forceDefault) {
-        KEYBOARD_LOG_I("强制使用默认配置");
-        _layoutConfig = createDefaultConfig();
-        return true;
+bool KeyboardConfigManager::importLayout(const uint8_t* data, size_t size) {
+    if (!loadTable(data, size)) {
+        KEYBOARD_LOG_W("导入的布局数据无效，保留原配置");
+        return false;
     }
+    KEYBOARD_LOG_I("已换入新布局，版本: %s，自定义按键: %d", _layoutConfig.version.c_str(), _active->count);
     
-    // 检查是否有保存的配置
-    if (!_preferences.isKey(PREF_CONFIG_KEY)) {
-        KEYBOARD_LOG_I("未找到已保存的配置，创建默认配置");
-        _layoutConfig = createDefaultConfig();
-        return saveConfig();
+    // HID键码、自动重复和按键颜色随新表生效
+    if (_layerCallback) {
+        _layerCallback(_currentLayer, _layerContext);
     }
-    
-    // 读取配置版本和校验和
-    String savedVersion = _preferences.getString(PREF_VERSION_KEY, "");
-    uint32_t savedChecksum = _preferences.getULong(PREF_CHECKSUM_KEY, 0);
-    
-    // 读取配置数据
-    size_t configSize = _preferences.getBytesLength(PREF_CONFIG_KEY);
-    if (configSize == 0) {
-        KEYBOARD_LOG_E("无效的配置大小");
+    scheduleSave();
+    return true;
+}
+
+bool KeyboardConfigManager::loadTable(const void* data, size_t size) {
+    if (!data || size < sizeof(LayoutBlobHeader) || size > LAYOUT_BLOB_SIZE) {
+        KEYBOARD_LOG_W("布局数据大小无效: %u", (unsigned)size);
         return false;
     }
     
-    uint8_t* buffer = new uint8_t[configSize];
-    size_t readSize = _preferences.getBytes(PREF_CONFIG_KEY, buffer, configSize);
-    
-    if (readSize != configSize) {
-        KEYBOARD_LOG_E("配置读取大小不匹配");
-        delete[] buffer;
+    // 载入备用的一套，当前覆盖表（和它的字符串）在换入之前一直可用
+    OverrideTable& staged = _active == &_tables[0] ? _tables[1] : _tables[0];
+    KeyboardLayoutConfig layout;
+    memcpy(staged.blob, data, size);
+    if (!deserializeConfig(staged, size, layout)) {
         return false;
     }
     
-    // 反序列化配置
-    bool result = deserializeConfig(buffer, configSize);
-    delete[] buffer;
+    _active = &staged;
+    _layoutConfig = layout;
+    return true;
+}
+
+void KeyboardConfigManager::scheduleSave() {
+    _dirty = true;
+    TimerWheel::instance().start(_saveTimer, CONFIG_SAVE_IDLE_MS);
+}
+
+bool KeyboardConfigManager::flush() {
+    return !_dirty || saveConfig();
+}
+
+bool KeyboardConfigManager::loadConfig(bool forceDefault) {
+    if (forceDefault) {
+        KEYBOARD_LOG_I("强制使用默认配置");
+        _layoutConfig = createDefaultConfig();
+        return true;
+    }
     
-    if (!result) {
-        KEYBOARD_LOG_E("反序列化配置失败");
-        return false;
+    // 检查设置镜像中是否有保存的配置
+    size_t configSize = 0;
+    const void* stored = SettingsStore::instance().find(SETTINGS_LAYOUT, configSize);
+    if (!stored) {
+        return migrateConfig();
     }
     
-    // 验证校验和
-    uint32_t calculatedChecksum = calculateChecksum();
-    if (calculatedChecksum != savedChecksum) {
-        KEYBOARD_LOG_W("配置校验和不匹配，使用默认配置");
-        _layoutConfig = createDefaultConfig();
-        return saveConfig();
+    // 从映射区复制到覆盖表的blob，字符串指向这里（含大小、格式和CRC校验）
+    if (!loadTable(stored, configSize)) {
+        KEYBOARD_LOG_E("反序列化配置失败");
+        return false;
     }
     
     // 验证配置完整性
@@ -112,36 +177,57 @@ bool KeyboardConfigManager::loadConfig(bool forceDefault) {
         return saveConfig();
     }
     
-    KEYBOARD_LOG_I("配置加载成功，版本: %s", savedVersion.c_str());
+    KEYBOARD_LOG_I("配置加载成功，版本: %s，自定义按键: %d", _layoutConfig.version.c_str(), _active->count);
     return true;
 }
 
+bool KeyboardConfigManager::migrateConfig() {
+    Preferences legacy;
+    bool migrated = false;
+    if (legacy.begin(PREF_NAMESPACE, false) && legacy.isKey(PREF_CONFIG_KEY)) {
+        alignas(4) uint8_t buffer[LAYOUT_BLOB_SIZE];
+        size_t configSize = legacy.getBytesLength(PREF_CONFIG_KEY);
+        migrated = configSize <= sizeof(buffer) && legacy.getBytes(PREF_CONFIG_KEY, buffer, configSize) == configSize &&
+                   loadTable(buffer, configSize) && validateConfig();
+        if (!migrated) {
+            KEYBOARD_LOG_W("NVS中的布局无效，不迁移");
+        }
+    }
+    
+    if (migrated) {
+        KEYBOARD_LOG_I("布局已从NVS迁移，自定义按键: %d", _active->count);
+    } else {
+        KEYBOARD_LOG_I("未找到已保存的配置，创建默认配置");
+        _layoutConfig = createDefaultConfig();
+    }
+    
+    // 写入设置镜像后旧的命名空间（含更早格式的版本和校验和键）不再需要
+    bool saved = saveConfig();
+    if (saved) legacy.clear();
+    legacy.end();
+    return saved;
+}
+
 bool KeyboardConfigManager::saveConfig() {
     KEYBOARD_LOG_D("正在保存键盘配置");
     
-    // 更新校验和
-    _layoutConfig.checksum = calculateChecksum();
-    
-    // 序列化配置
-    const size_t maxBufferSize = 4096;  // 4KB应该足够
-    uint8_t* buffer = new uint8_t[maxBufferSize];
-    size_t configSize = serializeConfig(buffer, maxBufferSize);
+    // 覆盖表的字符串指向当前的blob或调用者的字符串，先序列化到临时缓冲区
+    alignas(4) uint8_t buffer[LAYOUT_BLOB_SIZE];
+    size_t configSize = serializeConfig(buffer, sizeof(buffer));
     
     if (configSize == 0) {
         KEYBOARD_LOG_E("序列化配置失败");
-        delete[] buffer;
         return false;
     }
     
-    // 保存到Flash
-    bool result = true;
-    result &= _preferences.putString(PREF_VERSION_KEY, _layoutConfig.version);
-    result &= _preferences.putULong(PREF_CHECKSUM_KEY, _layoutConfig.checksum);
-    result &= (_preferences.putBytes(PREF_CONFIG_KEY, buffer, configSize) == configSize);
-    
-    delete[] buffer;
+    // 保存到设置镜像
+    bool result = SettingsStore::instance().write(SETTINGS_LAYOUT, buffer, configSize);
     
     if (result) {
+        // 之后覆盖表引用新保存的数据（换入备用的一套），调用者的字符串不必再保留
+        loadTable(buffer, configSize);
+        _dirty = false;
+        TimerWheel::instance().cancel(_saveTimer);
         KEYBOARD_LOG_I("配置保存成功");
     } else {
         KEYBOARD_LOG_E("配置保存失败");
@@ -154,7 +240,7 @@ bool KeyboardConfigManager::resetToDefault() {
     KEYBOARD_LOG_I("正在重置为默认配置");
     
     _layoutConfig = createDefaultConfig();
-    _currentLayer = _layoutConfig.defaultLayer;
+    setCurrentLayer(_layoutConfig.defaultLayer);
     
     return saveConfig();
 }
@@ -171,13 +257,21 @@ bool KeyboardConfigManager::switchToLayer(KeyLayer layer) {
         return false;
     }
     
-    _currentLayer = layer;
+    setCurrentLayer(layer);
     _lastLayerSwitchTime = millis();
     
-    KEYBOARD_LOG_I("已切换到层: %s", layerConfig->name.c_str());
+    KEYBOARD_LOG_I("已切换到层: %s", layerConfig->name);
     return true;
 }
 
+void KeyboardConfigManager::setCurrentLayer(KeyLayer layer) {
+    bool changed = layer != _currentLayer;
+    _currentLayer = layer;
+    if (changed && _layerCallback) {
+        _layerCallback(layer, _layerContext);
+    }
+}
+
 bool KeyboardConfigManager::handleTabKey(bool isLongPress) {
     if (isLongPress) {
         KEYBOARD_LOG_D("检测到Tab键长按");
@@ -199,91 +293,144 @@ bool KeyboardConfigManager::handleTabKey(bool isLongPress) {
     }
 }
 
+bool KeyboardConfigManager::selectProfile(uint8_t index) {
+    if (index >= getProfileCount()) {
+        KEYBOARD_LOG_E("无效的布局方案: %d", index);
+        return false;
+    }
+    
+    _profile = &PROFILES[index];
+    _profileIndex = index;
+    // 按键映射已经改变，层不变时也通知
+    KeyLayer previous = _currentLayer;
+    setCurrentLayer(_layoutConfig.defaultLayer);
+    if (previous == _currentLayer && _layerCallback) {
+        _layerCallback(_currentLayer, _layerContext);
+    }
+    _lastLayerSwitchTime = millis();
+    
+    KEYBOARD_LOG_I("已切换到布局方案: %s", _profile->name);
+    return true;
+}
+
+uint8_t KeyboardConfigManager::getProfileCount() {
+    return sizeof(PROFILES) / sizeof(PROFILES[0]);
+}
+
+bool KeyboardConfigManager::selectMode(CalcMode mode) {
+    for (uint8_t i = 0; i < getProfileCount(); i++) {
+        if (PROFILES[i].calculatorInput && PROFILES[i].mode == mode) {
+            return selectProfile(i);
+        }
+    }
+    return false;
+}
+
 const KeyConfig* KeyboardConfigManager::getKeyConfig(uint8_t position, KeyLayer layer) const {
-    const LayerConfig* layerConfig = findLayerConfig(layer);
-    if (!layerConfig) {
+    if (position == 0 || position > KEY_COUNT || layer >= KeyLayer::MAX_LAYERS) {
         return nullptr;
     }
     
-    for (const auto& keyConfig : layerConfig->keys) {
-        if (keyConfig.position == position) {
-            return &keyConfig;
+    const OverrideTable& table = *_active;
+    uint8_t slot = _profile->customizable ? table.index[(int)layer][position] : NO_OVERRIDE;
+    const KeyConfig* keyConfig = slot != NO_OVERRIDE ? &table.overrides[slot] : &_profile->keys[(int)layer][position];
+    return keyConfig->symbol ? keyConfig : nullptr;
+}
+
+const KeyConfig* KeyboardConfigManager::getActiveKeyConfig(uint8_t position) const {
+    const KeyConfig* keyConfig = getKeyConfig(position, _currentLayer);
+    return keyConfig ? keyConfig : getKeyConfig(position, KeyLayer::PRIMARY);
+}
+
+uint16_t KeyboardConfigManager::getHIDKeyCode(uint8_t position) const {
+    const KeyConfig* keyConfig = getActiveKeyConfig(position);
+    return keyConfig ? keyConfig->keyCode : 0;
+}
+
+uint16_t KeyboardConfigManager::getHostKeyCode(uint8_t position) const {
+    if (position == 0 || position > KEY_COUNT) {
+        return 0;
+    }
+    uint8_t slot = _active->index[(int)KeyLayer::PRIMARY][position];
+    if (slot != NO_OVERRIDE && _active->overrides[slot].keyCode) {
+        return _active->overrides[slot].keyCode;
+    }
+    return LAYOUT_HOST_CODES[position - 1];
+}
+
+uint32_t KeyboardConfigManager::getKeyColor(uint8_t position) const {
+    if (position == 0 || position > KEY_COUNT) {
+        return 0;
+    }
+    uint8_t slot = _active->index[(int)KeyLayer::PRIMARY][position];
+    if (slot != NO_OVERRIDE && _active->colors[slot] != NO_COLOR) {
+        return _active->colors[slot];
+    }
+    return LAYOUT_KEY_COLORS[position - 1];
+}
+
+uint32_t KeyboardConfigManager::getAutoRepeatMask() const {
+    uint32_t mask = 0;
+    for (uint8_t position = 1; position <= KEY_COUNT; position++) {
+        const KeyConfig* keyConfig = getActiveKeyConfig(position);
+        if (keyConfig && keyConfig->autoRepeat) {
+            mask |= 1UL << (position - 1);
         }
     }
-    
-    return nullptr;
+    return mask;
 }
 
 bool KeyboardConfigManager::setKeyConfig(uint8_t position, const KeyConfig& config, KeyLayer layer) {
-    LayerConfig* layerConfig = findLayerConfig(layer);
+    const LayerConfig* layerConfig = findLayerConfig(layer);
     if (!layerConfig) {
         KEYBOARD_LOG_E("未找到层: %d", (int)layer);
         return false;
     }
+    if (position == 0 || position > KEY_COUNT) {
+        KEYBOARD_LOG_E("无效的按键位置: %d", position);
+        return false;
+    }
     
-    // 查找现有按键配置
-    for (auto& keyConfig : layerConfig->keys) {
-        if (keyConfig.position == position) {
-            keyConfig = config;
-            KEYBOARD_LOG_I("已更新位置 %d 在层 %s 的按键配置", 
-                          position, layerConfig->name.c_str());
-            return true;
+    // 已有覆盖时原位更新（颜色不变）
+    OverrideTable& table = *_active;
+    uint8_t& slot = table.index[(int)layer][position];
+    bool isNew = slot == NO_OVERRIDE;
+    if (isNew) {
+        if (table.count >= MAX_KEY_OVERRIDES) {
+            KEYBOARD_LOG_E("按键覆盖表已满 (%d)，无法修改位置 %d", MAX_KEY_OVERRIDES, position);
+            return false;
         }
+        slot = table.count++;
+        table.colors[slot] = NO_COLOR;
     }
     
-    // 如果没找到，添加新的配置
-    layerConfig->keys.push_back(config);
-    KEYBOARD_LOG_I("已为位置 %d 在层 %s 添加新的按键配置", 
-                  position, layerConfig->name.c_str());
+    KeyConfig& entry = table.overrides[slot];
+    entry = config;
+    entry.position = position;
+    if (!entry.functionName) {
+        entry.functionName = "";
+    }
+    KEYBOARD_LOG_I(isNew ? "已为位置 %d 在层 %s 添加按键覆盖" : "已更新位置 %d 在层 %s 的按键覆盖",
+                  position, layerConfig->name);
     return true;
 }
 
 bool KeyboardConfigManager::validateConfig() const {
-    // 检查基本配置
-    if (_layoutConfig.layers.empty()) {
-        KEYBOARD_LOG_E("未配置任何层");
-        return false;
-    }
-    
-    // 检查必需的层级
-    bool hasPrimary = false, hasSecondary = false;
-    for (const auto& layer : _layoutConfig.layers) {
-        if (layer.layer == KeyLayer::PRIMARY) hasPrimary = true;
-        if (layer.layer == KeyLayer::SECONDARY) hasSecondary = true;
-    }
-    
-    if (!hasPrimary) {
-        KEYBOARD_LOG_E("未找到主层");
-        return false;
-    }
-    if (!hasSecondary) {
-        KEYBOARD_LOG_E("未找到次层");
-        return false;
-    }
-    
     // 验证Tab键位置
-    if (_layoutConfig.tabKeyPosition == 0 || _layoutConfig.tabKeyPosition > 22) {
+    if (_layoutConfig.tabKeyPosition == 0 || _layoutConfig.tabKeyPosition > KEY_COUNT) {
         KEYBOARD_LOG_E("Tab键位置 %d 无效", _layoutConfig.tabKeyPosition);
         return false;
     }
     
-    // 检查每个层
-    for (const auto& layer : _layoutConfig.layers) {
-        std::vector<uint8_t> positions;
-        for (const auto& key : layer.keys) {
-            // 验证按键类型
-            if (key.type >= KeyType::MAX_KEY_TYPES) {
+    // 检查每个层的有效按键（默认表的位置与下标一致由表本身保证）
+    for (uint8_t l = 0; l < LAYER_COUNT; l++) {
+        for (uint8_t position = 1; position <= KEY_COUNT; position++) {
+            const KeyConfig* key = getKeyConfig(position, (KeyLayer)l);
+            if (key && key->type >= KeyType::MAX_KEY_TYPES) {
                 KEYBOARD_LOG_E("在层 %s 的按键位置 %d 有无效的类型 %d", 
-                               layer.name.c_str(), key.position, (int)key.type);
+                               LAYERS[l].name, position, (int)key->type);
                 return false;
             }
-            // 检查重复位置
-            if (std::find(positions.begin(), positions.end(), key.position) != positions.end()) {
-                KEYBOARD_LOG_E("在层 %s 的按键位置 %d 是重复的", 
-                               layer.name.c_str(), key.position);
-                return false;
-            }
-            positions.push_back(key.position);
         }
     }
     
@@ -297,186 +444,253 @@ void KeyboardConfigManager::printConfig() const {
     Serial.printf("版本: %s\n", _layoutConfig.version.c_str());
     Serial.printf("Tab键位置: %d\n", _layoutConfig.tabKeyPosition);
     Serial.printf("当前层: %d\n", (int)_currentLayer);
-    for (const auto& layer : _layoutConfig.layers) {
-        Serial.printf("层: %s (%d 个键)\n", layer.name.c_str(), layer.keys.size());
+    Serial.printf("布局方案: %s (%d/%d)\n", _profile->name, _profileIndex + 1, getProfileCount());
+    for (uint8_t l = 0; l < LAYER_COUNT; l++) {
+        int count = 0;
+        for (uint8_t position = 1; position <= KEY_COUNT; position++) {
+            if (getKeyConfig(position, (KeyLayer)l)) count++;
+        }
+        Serial.printf("层: %s (%d 个键)\n", LAYERS[l].name, count);
     }
+    Serial.printf("按键覆盖: %d/%d%s\n", _active->count, MAX_KEY_OVERRIDES, _dirty ? "（未保存）" : "");
 }
 
 KeyboardLayoutConfig KeyboardConfigManager::createDefaultConfig() {
     KEYBOARD_LOG_D("创建默认键盘配置");
     
+    // 按键来自编译期的方案表，只需恢复覆盖表
+    clearKeyOverrides();
+    
+    return defaultLayout();
+}
+
+KeyboardLayoutConfig KeyboardConfigManager::defaultLayout() {
     KeyboardLayoutConfig config;
     config.name = "标准计算器布局";
     config.version = "1.0";
     config.tabKeyPosition = 6;
     config.defaultLayer = KeyLayer::PRIMARY;
-    
-    // --- 主层 (Primary Layer) ---
-    LayerConfig primaryLayer;
-    primaryLayer.layer = KeyLayer::PRIMARY;
-    primaryLayer.name = "主层";
-    primaryLayer.keys = {
-        {1, KeyType::POWER, "ON", "POWER", Operator::NONE, "power"},
-        {2, KeyType::NUMBER, "7", "SEVEN"},
-        {3, KeyType::NUMBER, "4", "FOUR"},
-        {4, KeyType::NUMBER, "1", "ONE"},
-        {5, KeyType::NUMBER, "0", "ZERO"},
-        {6, KeyType::LAYER_SWITCH, "TAB", "LAYER_SWITCH"},
-        {7, KeyType::NUMBER, "8", "EIGHT"},
-        {8, KeyType::NUMBER, "5", "FIVE"},
-        {9, KeyType::NUMBER, "2", "TWO"},
-        {10, KeyType::FUNCTION, "%", "PERCENT", Operator::PERCENT},
-        {11, KeyType::NUMBER, "9", "NINE"},
-        {12, KeyType::NUMBER, "6", "SIX"},
-        {13, KeyType::NUMBER, "3", "THREE"},
-        {14, KeyType::DECIMAL, ".", "DOT"},
-        {15, KeyType::DELETE, "⌫", "BACKSPACE"},
-        {16, KeyType::OPERATOR, "×", "MUL", Operator::MULTIPLY},
-        {17, KeyType::OPERATOR, "-", "SUB", Operator::SUBTRACT},
-        {18, KeyType::OPERATOR, "+", "ADD", Operator::ADD},
-        {19, KeyType::CLEAR, "C", "CLEAR"},
-        {20, KeyType::FUNCTION, "±", "SIGN"},
-        {21, KeyType::OPERATOR, "÷", "DIV", Operator::DIVIDE},
-        {22, KeyType::FUNCTION, "=", "EQUALS", Operator::EQUALS}
-    };
-    config.layers.push_back(primaryLayer);
-    
-    // --- 次层 (Secondary Layer) ---
-    LayerConfig secondaryLayer;
-    secondaryLayer.layer = KeyLayer::SECONDARY;
-    secondaryLayer.name = "次层";
-    secondaryLayer.keys = {
-        // 示例：可以添加更多科学计算功能
-        {2, KeyType::FUNCTION, "√", "SQRT", Operator::SQUARE_ROOT},
-        {3, KeyType::FUNCTION, "x²", "SQUARE", Operator::SQUARE},
-        {4, KeyType::FUNCTION, "1/x", "RECIPROCAL", Operator::RECIPROCAL},
-        // 其他按键保持与主层一致或禁用
-        {7, KeyType::MEMORY, "M+", "M_ADD"},
-        {8, KeyType::MEMORY, "M-", "M_SUB"},
-        {9, KeyType::MEMORY, "MR", "M_RECALL"},
-        {11, KeyType::MEMORY, "MC", "M_CLEAR"},
-    };
-    config.layers.push_back(secondaryLayer);
-    
     return config;
 }
 
-uint32_t KeyboardConfigManager::calculateChecksum() const {
-    // 简单的校验和算法
-    uint32_t checksum = 0;
-    
-    // 配置名称和版本
-    for (char c : _layoutConfig.name) {
-        checksum += c;
+void KeyboardConfigManager::clearTable(OverrideTable& table) {
+    table.count = 0;
+    memset(table.index, NO_OVERRIDE, sizeof(table.index));
+}
+
+uint32_t KeyboardConfigManager::calculateChecksum(const uint8_t* buffer, size_t size) {
+    return esp_rom_crc32_le(0, buffer + sizeof(LayoutBlobHeader), size - sizeof(LayoutBlobHeader));
+}
+
+namespace {
+
+/**
+ * @brief 把字符串追加到字符串表，已有相同字符串时复用
+ * @param offset 输出字符串表偏移，text为nullptr时为NO_STRING
+ * @return 空间不足返回false
+ */
+bool addBlobString(char* table, size_t capacity, size_t& used, const char* text, uint16_t& offset) {
+    if (!text) {
+        offset = 0xFFFF;
+        return true;
     }
-    for (char c : _layoutConfig.version) {
-        checksum += c;
+    for (size_t pos = 0; pos < used; pos += strlen(table + pos) + 1) {
+        if (strcmp(table + pos, text) == 0) {
+            offset = pos;
+            return true;
+        }
     }
-    
-    // 层级配置
-    for (const auto& layer : _layoutConfig.layers) {
-        checksum += (uint32_t)layer.layer;
-        for (const auto& key : layer.keys) {
-            checksum += key.position;
-            checksum += (uint32_t)key.type;
-            checksum += (uint32_t)key.operation;
+    size_t length = strlen(text) + 1;
+    if (used + length > capacity) {
+        return false;
+    }
+    memcpy(table + used, text, length);
+    offset = used;
+    used += length;
+    return true;
+}
+
+} // namespace
+
+uint8_t KeyboardConfigManager::getKeyOverrides(KeyOverride* out, uint8_t maxCount) const {
+    uint8_t count = 0;
+    for (uint8_t l = 0; l < LAYER_COUNT; l++) {
+        for (uint8_t position = 1; position <= KEY_COUNT && count < maxCount; position++) {
+            uint8_t slot = _active->index[l][position];
+            if (slot == NO_OVERRIDE) continue;
+            out[count].layer = l;
+            out[count].config = _active->overrides[slot];
+            out[count].color = _active->colors[slot];
+            count++;
         }
     }
+    return count;
+}
+
+bool KeyboardConfigManager::importOverrides(const KeyOverride* keys, uint8_t count,
+                                            KeyLayer defaultLayer, uint8_t tabKeyPosition) {
+    if (count > MAX_KEY_OVERRIDES) {
+        KEYBOARD_LOG_W("导入的按键覆盖过多: %d", count);
+        return false;
+    }
+    KeyboardLayoutConfig layout = _layoutConfig;
+    layout.defaultLayer = defaultLayer;
+    layout.tabKeyPosition = tabKeyPosition;
     
-    return checksum;
+    alignas(4) uint8_t buffer[LAYOUT_BLOB_SIZE];
+    size_t size = buildBlob(buffer, sizeof(buffer), layout, keys, count);
+    return size && importLayout(buffer, size);
 }
 
 size_t KeyboardConfigManager::serializeConfig(uint8_t* buffer, size_t maxSize) const {
-    // 简化的序列化实现 - 避免直接复制含有std::vector的结构体
-    if (maxSize < 64) {  // 最小缓冲区大小
+    KeyOverride keys[MAX_KEY_OVERRIDES];
+    uint8_t count = getKeyOverrides(keys, MAX_KEY_OVERRIDES);
+    return buildBlob(buffer, maxSize, _layoutConfig, keys, count);
+}
+
+size_t KeyboardConfigManager::buildBlob(uint8_t* buffer, size_t maxSize, const KeyboardLayoutConfig& layout,
+                                        const KeyOverride* overrides, uint8_t count) {
+    size_t keysSize = count * sizeof(LayoutBlobKey);
+    if (maxSize < sizeof(LayoutBlobHeader) + keysSize) {
         return 0;
     }
     
-    // 只序列化基本信息，避免std::vector的问题
-    size_t offset = 0;
+    LayoutBlobHeader* header = (LayoutBlobHeader*)buffer;
+    LayoutBlobKey* keys = (LayoutBlobKey*)(buffer + sizeof(LayoutBlobHeader));
+    char* strings = (char*)(keys + count);
+    size_t capacity = maxSize - sizeof(LayoutBlobHeader) - keysSize;
+    size_t used = 0;
     
-    // 写入版本信息长度和内容
-    uint8_t versionLen = _layoutConfig.version.length();
-    buffer[offset++] = versionLen;
-    memcpy(buffer + offset, _layoutConfig.version.c_str(), versionLen);
-    offset += versionLen;
-    
-    // 写入其他基本信息
-    buffer[offset++] = (uint8_t)_layoutConfig.defaultLayer;
-    buffer[offset++] = _layoutConfig.tabKeyPosition;
+    header->magic = LAYOUT_BLOB_MAGIC;
+    header->format = LAYOUT_BLOB_FORMAT;
+    header->defaultLayer = (uint8_t)layout.defaultLayer;
+    header->tabKeyPosition = layout.tabKeyPosition;
+    header->keyCount = count;
+    if (!addBlobString(strings, capacity, used, layout.version.c_str(), header->version)) {
+        return 0;
+    }
     
-    // 写入简单的配置标识
-    uint32_t configId = 0x12345678;  // 简单的配置标识
-    memcpy(buffer + offset, &configId, sizeof(configId));
-    offset += sizeof(configId);
+    for (uint8_t i = 0; i < count; i++) {
+        const KeyConfig& config = overrides[i].config;
+        LayoutBlobKey& key = keys[i];
+        key.layer = overrides[i].layer;
+        key.position = config.position;
+        key.type = (uint8_t)config.type;
+        key.operation = (uint8_t)config.operation;
+        key.keyCode = config.keyCode;
+        key.holdMs = config.holdMs;
+        key.autoRepeat = config.autoRepeat;
+        bool colored = overrides[i].color != NO_COLOR;
+        uint32_t color = colored ? overrides[i].color : 0;
+        key.flags = colored ? BLOB_KEY_COLOR : 0;
+        key.color[0] = color >> 16;
+        key.color[1] = color >> 8;
+        key.color[2] = color;
+        key.reserved = 0;
+        if (!addBlobString(strings, capacity, used, config.symbol, key.symbol) ||
+            !addBlobString(strings, capacity, used, config.label, key.label) ||
+            !addBlobString(strings, capacity, used, config.functionName, key.functionName)) {
+            KEYBOARD_LOG_E("按键字符串超出保存空间 (%u 字节)", (unsigned)LAYOUT_BLOB_SIZE);
+            return 0;
+        }
+    }
     
-    return offset;
+    size_t size = sizeof(LayoutBlobHeader) + keysSize + used;
+    header->size = size;
+    header->crc = calculateChecksum(buffer, size);
+    return size;
 }
 
-bool KeyboardConfigManager::deserializeConfig(const uint8_t* buffer, size_t size) {
-    // 简化的反序列化实现 - 避免直接复制含有std::vector的结构体
-    if (size < 8) {  // 最小数据大小
+bool KeyboardConfigManager::deserializeConfig(OverrideTable& table, size_t size, KeyboardLayoutConfig& layout) {
+    const uint8_t* blob = table.blob;
+    const LayoutBlobHeader* header = (const LayoutBlobHeader*)blob;
+    if (size < sizeof(LayoutBlobHeader) || header->magic != LAYOUT_BLOB_MAGIC) {
+        KEYBOARD_LOG_W("不是当前格式的布局数据");
         return false;
     }
-    
-    size_t offset = 0;
-    
-    // 读取版本信息
-    uint8_t versionLen = buffer[offset++];
-    if (offset + versionLen > size) {
+    // 旧格式的按键记录没有末尾新增的字段，按记录长度逐条读取
+    size_t keySize = header->format == 1 ? offsetof(LayoutBlobKey, holdMs) :
+                     header->format == 2 ? offsetof(LayoutBlobKey, autoRepeat) :
+                     header->format == 3 ? offsetof(LayoutBlobKey, color) : sizeof(LayoutBlobKey);
+    if (header->format < 1 || header->format > LAYOUT_BLOB_FORMAT || header->size != size ||
+        header->keyCount > MAX_KEY_OVERRIDES || header->defaultLayer >= LAYER_COUNT ||
+        header->tabKeyPosition == 0 || header->tabKeyPosition > KEY_COUNT ||
+        sizeof(LayoutBlobHeader) + header->keyCount * keySize >= size) {
+        KEYBOARD_LOG_W("布局数据格式 %d 或大小 %u 无效", header->format, (unsigned)size);
         return false;
     }
-    
-    String version;
-    version.reserve(versionLen);
-    for (int i = 0; i < versionLen; i++) {
-        version += (char)buffer[offset++];
-    }
-    
-    // 读取其他基本信息
-    if (offset + 2 + sizeof(uint32_t) > size) {
+    if (header->crc != calculateChecksum(blob, size)) {
+        KEYBOARD_LOG_W("布局数据CRC不匹配");
         return false;
     }
     
-    KeyLayer defaultLayer = (KeyLayer)buffer[offset++];
-    uint8_t tabKeyPosition = buffer[offset++];
-    
-    // 读取配置标识
-    uint32_t configId;
-    memcpy(&configId, buffer + offset, sizeof(configId));
-    offset += sizeof(configId);
+    const uint8_t* keys = blob + sizeof(LayoutBlobHeader);
+    const char* strings = (const char*)(keys + header->keyCount * keySize);
+    size_t stringsSize = size - ((const uint8_t*)strings - blob);
     
-    // 验证配置标识
-    if (configId != 0x12345678) {
-        KEYBOARD_LOG_W("Invalid config ID: 0x%08X", configId);
+    // 字符串表必须以'\0'结尾，偏移都落在表内
+    if (strings[stringsSize - 1] != '\0' || header->version >= stringsSize) {
+        KEYBOARD_LOG_W("布局字符串表无效");
         return false;
     }
+    auto stringAt = [&](uint16_t offset, const char*& text) {
+        if (offset == NO_STRING) {
+            text = nullptr;
+            return true;
+        }
+        text = strings + offset;
+        return offset < stringsSize;
+    };
     
-    // 由于我们无法安全地反序列化std::vector，使用默认配置
-    _layoutConfig = createDefaultConfig();
-    _layoutConfig.version = version;
-    _layoutConfig.defaultLayer = defaultLayer;
-    _layoutConfig.tabKeyPosition = tabKeyPosition;
-    
-    return true;
-}
-
-LayerConfig* KeyboardConfigManager::findLayerConfig(KeyLayer layer) {
-    for (auto& layerConfig : _layoutConfig.layers) {
-        if (layerConfig.layer == layer) {
-            return &layerConfig;
+    clearTable(table);
+    for (uint8_t i = 0; i < header->keyCount; i++) {
+        LayoutBlobKey key;
+        memcpy(&key, keys + i * keySize, keySize);
+        if (key.layer >= LAYER_COUNT || key.position == 0 || key.position > KEY_COUNT ||
+            key.type >= (uint8_t)KeyType::MAX_KEY_TYPES || table.index[key.layer][key.position] != NO_OVERRIDE) {
+            KEYBOARD_LOG_W("布局数据中第 %d 个按键无效", i);
+            clearTable(table);
+            return false;
+        }
+        
+        KeyConfig& entry = table.overrides[i];
+        entry.position = key.position;
+        entry.type = (KeyType)key.type;
+        entry.operation = (Operator)key.operation;
+        entry.keyCode = key.keyCode;
+        entry.isEnabled = false;
+        // 旧格式保存时还没有的字段沿用默认表的设置
+        const KeyConfig& defaults = CALCULATOR_KEYS[key.layer][key.position];
+        entry.holdMs = header->format < 2 ? defaults.holdMs : key.holdMs;
+        entry.autoRepeat = header->format < 3 ? defaults.autoRepeat : key.autoRepeat != 0;
+        bool colored = header->format >= 4 && (key.flags & BLOB_KEY_COLOR);
+        table.colors[i] = colored ? (uint32_t)key.color[0] << 16 | (uint32_t)key.color[1] << 8 | key.color[2] : NO_COLOR;
+        if (!stringAt(key.symbol, entry.symbol) || !stringAt(key.label, entry.label) ||
+            !stringAt(key.functionName, entry.functionName)) {
+            KEYBOARD_LOG_W("布局数据中第 %d 个按键的字符串无效", i);
+            clearTable(table);
+            return false;
+        }
+        if (!entry.functionName) {
+            entry.functionName = "";
         }
+        table.index[key.layer][key.position] = i;
     }
-    return nullptr;
+    table.count = header->keyCount;
+    
+    layout = defaultLayout();
+    layout.version = strings + header->version;
+    layout.defaultLayer = (KeyLayer)header->defaultLayer;
+    layout.tabKeyPosition = header->tabKeyPosition;
+    layout.checksum = header->crc;
+    return true;
 }
 
-const LayerConfig* KeyboardConfigManager::findLayerConfig(KeyLayer layer) const {
-    for (const auto& layerConfig : _layoutConfig.layers) {
-        if (layerConfig.layer == layer) {
-            return &layerConfig;
-        }
+const LayerConfig* KeyboardConfigManager::findLayerConfig(KeyLayer layer) {
+    if (layer >= KeyLayer::MAX_LAYERS) {
+        return nullptr;
     }
-    return nullptr;
+    return &LAYERS[(int)layer];
 }
 
 void KeyboardConfigManager::logMessage(const char* level, const char* format, ...) const {
@@ -8,6 +8,23 @@
  * - Tab键切换层级（短按切换，长按自定义功能）
  * - Flash持久化配置存储
  * - 可自定义的按键映射
+ *
+ * 默认布局是按[层][位置]索引的constexpr表，放在Flash中，由 tools/layout_compile.py 在构建时
+ * 从 layouts/keypad.layout 生成（LayoutData.h）；按物理按键的HID键码和反馈颜色也在同一文件中（LayoutKeys.h）。
+ * setKeyConfig()的修改保存在一个小的覆盖表里。getKeyConfig()是O(1)的数组访问，
+ * 布局本身几乎不占RAM。
+ *
+ * 布局方案（LayoutProfile）是几张编译期的表：计算器、HID小键盘、电子表格快捷键等。
+ * 切换方案只换一个指针（Tab长按或组合键），不读NVS也不分配内存。覆盖表只作用于计算器方案。
+ *
+ * 保存时只写覆盖表，格式见LayoutBlobHeader：头 + 按键记录 + 字符串表，整体带CRC32。
+ * 保存在设置镜像的SETTINGS_LAYOUT段（SettingsStore）。加载时从映射区复制到覆盖表自己的blob，
+ * 覆盖表的字符串指针指向其中的字符串表，不做堆分配。
+ *
+ * 覆盖表有两套（OverrideTable）：新布局（主机推送、启动加载、保存后重新载入）先复制到备用的一套，
+ * 校验通过后只改_active指针。按键事件都在主循环中处理，换入发生在两次事件之间，
+ * 一次按键看到的要么全是旧表、要么全是新表；数据无效时当前的一套原样保留。
+ * 主机推送的布局在空闲CONFIG_SAVE_IDLE_MS后才写入设置镜像，连续推送只写一次。
  * 
  * @author Calculator Project
  * @date 2024-01-07
@@ -18,10 +35,11 @@
 #define KEYBOARD_CONFIG_H
 
 #include <Arduino.h>
-#include <Preferences.h>
 #include <vector>
 #include <memory>
 #include "Logger.h"
+#include "SettingsStore.h"
+#include "TimerWheel.h"
 
 /**
  * @brief 按键层级枚举
@@ -47,6 +65,7 @@ enum class KeyType {
     MEMORY,             ///< 内存操作
     POWER,              ///< 电源相关
     RESERVED,           ///< 保留功能
+    MACRO,              ///< HID宏：functionName为按键序列（见SimpleHID::sendMacro()）
     MAX_KEY_TYPES       ///< 最大类型数量，用于验证
 };
 
@@ -63,32 +82,68 @@ enum class Operator {
     PERCENT,            ///< 百分比
     SQUARE_ROOT,        ///< 平方根
     SQUARE,             ///< 平方
-    RECIPROCAL          ///< 倒数
+    RECIPROCAL,         ///< 倒数
+    POWER,              ///< 乘方 xʸ（二元，优先级高于乘除）
+    SIN,                ///< 正弦（弧度）
+    COS,                ///< 余弦（弧度）
+    TAN,                ///< 正切（弧度）
+    LN,                 ///< 自然对数
+    LOG10,              ///< 常用对数
+    EXP,                ///< eˣ
+    // 以下只用于程序员模式（ProgrammerCalc的整数引擎）
+    MODULO,             ///< 取余
+    BIT_AND,            ///< 按位与
+    BIT_OR,             ///< 按位或
+    BIT_XOR,            ///< 按位异或
+    SHIFT_LEFT,         ///< 左移
+    SHIFT_RIGHT,        ///< 右移（有符号时为算术右移）
+    BIT_NOT,            ///< 按位取反（一元）
+    TAX_PLUS,           ///< 加税（按保存的税率）
+    TAX_MINUS,          ///< 去税：由含税价求税前价
+    MARKUP,             ///< 加价（按保存的加价率）
+    DISCOUNT,           ///< 折扣（按保存的折扣率）
+    GRAND_TOTAL         ///< 累计总计（各次=结果之和）
 };
 
+/**
+ * @brief 计算器方案的工作模式
+ */
+enum class CalcMode : uint8_t {
+    STANDARD = 0,       ///< 四则和科学计算
+    PROGRAMMER,         ///< 整数引擎（ProgrammerCalc）
+    STATISTICS,         ///< 统计：输入的数累计到RunningStats
+    BUSINESS            ///< 商务：与标准相同，另把各次=的结果累计为总计（GT）
+};
+
+// 键码的高4位选择HID报告：0为键盘（ASCII、0x80-0x87修饰键、0x88 + Usage），其余低12位为该报告的Usage
+constexpr uint16_t HID_CODE_PAGE_MASK = 0xF000;
+constexpr uint16_t HID_CODE_CONSUMER  = 0x1000;    ///< 消费者控制（Usage Page 0x0C）
+constexpr uint16_t HID_CODE_SYSTEM    = 0x2000;    ///< 系统控制（Generic Desktop 0x81-0x83）
+
 /**
  * @brief 单个按键配置
+ * @details 字符串字段只保存指针，必须指向静态存储（字符串字面量），不能指向临时的String
  */
 struct KeyConfig {
     uint8_t position;           ///< 物理按键位置 (1-22)
     KeyType type;               ///< 按键类型
-    String symbol;              ///< 显示符号
-    String label;               ///< 按键标签
+    const char* symbol;         ///< 显示符号，nullptr表示该位置未配置
+    const char* label;          ///< 按键标签
     Operator operation;         ///< 对应的运算操作
-    String functionName;        ///< 自定义函数名（仅当type为FUNCTION时使用）
-    uint16_t keyCode;          ///< 键码（用于BLE等）
+    const char* functionName;   ///< 自定义函数名（type为FUNCTION时）或宏序列（type为MACRO时），不用时为""
+    uint16_t keyCode;          ///< HID键码，高4位见HID_CODE_PAGE_MASK
     bool isEnabled;            ///< 是否启用
+    uint16_t holdMs;           ///< 非0表示轻触/按住双功能键：按住达到此时间为长按，之前释放为短按；0为普通键
+    bool autoRepeat;           ///< 按住时自动重复（代替长按）
 };
 
 /**
- * @brief 键盘层配置
+ * @brief 键盘层信息
  */
 struct LayerConfig {
     KeyLayer layer;                     ///< 层级类型
-    String name;                        ///< 层级名称
-    String description;                 ///< 层级描述
-    std::vector<KeyConfig> keys;        ///< 按键配置列表
-    bool isActive;                      ///< 是否为当前活动层
+    const char* name;                   ///< 层级名称
+    const char* description;            ///< 层级描述
 };
 
 /**
@@ -98,7 +153,6 @@ struct KeyboardLayoutConfig {
     String name;                        ///< 布局名称
     String version;                     ///< 版本号
     uint32_t checksum;                  ///< 配置校验和
-    std::vector<LayerConfig> layers;    ///< 层级配置列表
     KeyLayer defaultLayer;              ///< 默认层级
     uint8_t tabKeyPosition;            ///< Tab键位置
     uint32_t layerSwitchTimeout;       ///< 层级切换超时时间(ms)
@@ -123,6 +177,32 @@ struct TabBehaviorConfig {
  */
 class KeyboardConfigManager {
 public:
+    static const uint8_t KEY_COUNT = 22;                                ///< 物理按键数
+    static const uint8_t LAYER_COUNT = (uint8_t)KeyLayer::MAX_LAYERS;   ///< 层数
+    static const uint8_t MAX_KEY_OVERRIDES = 8;                         ///< 覆盖表容量
+    static const size_t LAYOUT_BLOB_SIZE = 512;                         ///< 保存格式的最大字节数
+    static const uint32_t NO_COLOR = 0xFFFFFFFF;                        ///< 覆盖项不改变按键颜色
+    
+    /**
+     * @brief 布局方案：一张按[层][位置]索引的按键表
+     */
+    struct LayoutProfile {
+        const char* name;                                   ///< 方案名称
+        const KeyConfig (*keys)[KEY_COUNT + 1];             ///< [层][位置]按键表，位于Flash
+        bool calculatorInput;                               ///< 按键交给计算器；false时只作为HID键盘（keyCode）
+        bool customizable;                                  ///< 是否应用setKeyConfig()的覆盖表
+        CalcMode mode;                                      ///< 计算器按键的处理模式（calculatorInput时有效）
+    };
+
+    /**
+     * @brief 覆盖表的一项及其所在层（整表导出/导入用）
+     */
+    struct KeyOverride {
+        uint8_t layer;
+        KeyConfig config;                                   ///< config.position为按键位置
+        uint32_t color;                                     ///< 按键反馈颜色0xRRGGBB（只看主层的项），NO_COLOR为布局文件的颜色
+    };
+
     /**
      * @brief 构造函数
      */
@@ -158,12 +238,57 @@ public:
      */
     bool resetToDefault();
     
+    /**
+     * @brief 导出当前配置（保存格式）
+     * @param buffer 输出缓冲区（4字节对齐）
+     * @param maxSize 缓冲区大小，LAYOUT_BLOB_SIZE足够
+     * @return 字节数，失败返回0
+     */
+    size_t exportLayout(uint8_t* buffer, size_t maxSize) const { return serializeConfig(buffer, maxSize); }
+    
+    /**
+     * @brief 导入保存格式的配置：校验到备用覆盖表后换入，发出层变化通知，空闲后保存
+     * @param data 配置数据
+     * @param size 字节数
+     * @return false 数据无效（保留原配置）
+     */
+    bool importLayout(const uint8_t* data, size_t size);
+    
+    /**
+     * @brief 立即保存还没有写入的布局（休眠前）
+     * @return 没有待保存的布局或保存成功时返回true
+     */
+    bool flush();
+    
+    /**
+     * @brief 按[层][位置]顺序列出覆盖表
+     * @param out 输出，字符串指向已加载的保存数据，到下一次导入或保存前有效
+     * @return 项数
+     */
+    uint8_t getKeyOverrides(KeyOverride* out, uint8_t maxCount) const;
+    
+    /**
+     * @brief 整表替换覆盖表：按保存格式写出后走importLayout()的校验、换入和保存
+     * @param keys 新的覆盖表，字符串只需在调用期间有效
+     * @return false 项数超过MAX_KEY_OVERRIDES、字符串超出保存空间或数据无效（保留原配置）
+     */
+    bool importOverrides(const KeyOverride* keys, uint8_t count, KeyLayer defaultLayer, uint8_t tabKeyPosition);
+    
     /**
      * @brief 获取当前活动层级
      * @return 当前层级
      */
     KeyLayer getCurrentLayer() const { return _currentLayer; }
     
+    /**
+     * @brief 当前层或按键映射变化时的通知（切换层、切换布局方案、恢复默认配置、换入新布局）
+     */
+    typedef void (*LayerCallback)(KeyLayer layer, void* context);
+    void setLayerCallback(LayerCallback callback, void* context) {
+        _layerCallback = callback;
+        _layerContext = context;
+    }
+    
     /**
      * @brief 切换到指定层级
      * @param layer 目标层级
@@ -178,20 +303,78 @@ public:
      */
     bool handleTabKey(bool isLongPress = false);
     
+    /**
+     * @brief 选择布局方案（只交换表指针，并回到默认层）
+     * @param index 方案编号，0为计算器
+     * @return true 成功，false 编号无效
+     */
+    bool selectProfile(uint8_t index);
+    
+    /**
+     * @brief 切换到下一个布局方案（Tab长按的默认行为）
+     */
+    void nextProfile() { selectProfile((_profileIndex + 1) % getProfileCount()); }
+    
+    /**
+     * @brief 获取当前布局方案
+     */
+    const LayoutProfile& getProfile() const { return *_profile; }
+    
+    uint8_t getProfileIndex() const { return _profileIndex; }
+    static uint8_t getProfileCount();
+    
+    /**
+     * @brief 切换计算器的工作模式（MODE_SWITCH键）
+     * @param mode 选择第一个该模式的计算器方案
+     */
+    bool selectMode(CalcMode mode);
+    
+    /**
+     * @brief 获取按键在当前层的配置，当前层未配置时回退到主层
+     * @param position 按键位置
+     * @return 按键配置指针，未找到返回nullptr
+     */
+    const KeyConfig* getActiveKeyConfig(uint8_t position) const;
+    
+    /**
+     * @brief 获取HID键码（按当前方案和层级，当前层未配置时回退到主层）
+     * @param position 按键位置
+     * @return 键码，0表示该键不输出
+     */
+    uint16_t getHIDKeyCode(uint8_t position) const;
+    
+    /**
+     * @brief 计算器方案下HID模式发送的键码
+     * @return 主层覆盖项的keyCode（非0时），否则为布局文件的host=键码（LayoutKeys.h）
+     */
+    uint16_t getHostKeyCode(uint8_t position) const;
+    
+    /**
+     * @brief 按键反馈颜色（不分方案和层）
+     * @return 0xRRGGBB：主层覆盖项带颜色时用它，否则为布局文件的color=
+     */
+    uint32_t getKeyColor(uint8_t position) const;
+    
+    /**
+     * @brief 当前方案和层级下自动重复的按键
+     * @return 按键位图，bit i 对应按键 i+1
+     */
+    uint32_t getAutoRepeatMask() const;
+    
     /**
      * @brief 获取指定位置的按键配置
      * @param position 按键位置
      * @param layer 指定层级（默认为当前层级）
-     * @return 按键配置指针，未找到返回nullptr
+     * @return 按键配置指针（覆盖表优先，其次是默认表），未找到返回nullptr
      */
     const KeyConfig* getKeyConfig(uint8_t position, KeyLayer layer = KeyLayer::PRIMARY) const;
     
     /**
      * @brief 修改按键配置
      * @param position 按键位置
-     * @param config 新的按键配置
+     * @param config 新的按键配置，字符串字段必须指向静态存储
      * @param layer 指定层级
-     * @return true 成功，false 失败
+     * @return true 成功，false 失败（位置无效或覆盖表已满）
      */
     bool setKeyConfig(uint8_t position, const KeyConfig& config, KeyLayer layer = KeyLayer::PRIMARY);
     
@@ -231,70 +414,149 @@ public:
     String getConfigVersion() const { return _layoutConfig.version; }
 
 private:
-    Preferences _preferences;                   ///< ESP32 Preferences存储
     KeyboardLayoutConfig _layoutConfig;         ///< 键盘布局配置
     TabBehaviorConfig _tabBehavior;            ///< Tab键行为配置
     KeyLayer _currentLayer;                     ///< 当前活动层级
     uint32_t _lastLayerSwitchTime;             ///< 上次层级切换时间
+    LayerCallback _layerCallback;               ///< 层变化通知
+    void* _layerContext;
+    const LayoutProfile* _profile;              ///< 当前布局方案
+    uint8_t _profileIndex;
     
-    static const char* PREF_NAMESPACE;          ///< Preferences命名空间
-    static const char* PREF_CONFIG_KEY;         ///< 配置键名
-    static const char* PREF_VERSION_KEY;        ///< 版本键名
-    static const char* PREF_CHECKSUM_KEY;       ///< 校验和键名
+    static const uint8_t NO_OVERRIDE = 0xFF;
     
     /**
-     * @brief 创建默认配置
+     * @brief 一套覆盖表和它的字符串所在的保存数据
+     */
+    struct OverrideTable {
+        alignas(4) uint8_t blob[LAYOUT_BLOB_SIZE];          ///< 已加载的保存数据，覆盖项的字符串指向这里
+        KeyConfig overrides[MAX_KEY_OVERRIDES];             ///< 用户修改过的按键
+        uint32_t colors[MAX_KEY_OVERRIDES];                 ///< 各覆盖项的按键颜色，NO_COLOR表示不改变
+        uint8_t count;
+        uint8_t index[LAYER_COUNT][KEY_COUNT + 1];          ///< [层][位置] → overrides下标，NO_OVERRIDE表示用默认表
+    };
+    
+    OverrideTable _tables[2];                   ///< 当前的一套和备用的一套
+    OverrideTable* _active;                     ///< 查找只经过这个指针，换入新布局只改它
+    bool _dirty;                                ///< 换入的布局还没有保存
+    TimerWheel::TimerId _saveTimer;             ///< 每次换入重新计时，空闲后保存
+    
+    /**
+     * @brief 保存格式的头，之后是keyCount条LayoutBlobKey和字符串表
+     */
+    struct LayoutBlobHeader {
+        uint32_t magic;             ///< 固定魔数
+        uint8_t format;             ///< 格式版本
+        uint8_t defaultLayer;
+        uint8_t tabKeyPosition;
+        uint8_t keyCount;           ///< 按键记录数
+        uint16_t size;              ///< 总字节数
+        uint16_t version;           ///< 布局版本号在字符串表中的偏移
+        uint32_t crc;               ///< 头之后全部数据的CRC32
+    };
+    
+    /**
+     * @brief 一条按键记录（覆盖表的一项）
+     */
+    struct LayoutBlobKey {
+        uint8_t layer;
+        uint8_t position;
+        uint8_t type;
+        uint8_t operation;
+        uint16_t symbol;            ///< 字符串表偏移，NO_STRING表示nullptr
+        uint16_t label;
+        uint16_t functionName;
+        uint16_t keyCode;
+        uint16_t holdMs;            ///< 格式2新增，格式1的记录没有此字段
+        uint8_t autoRepeat;         ///< 格式3新增
+        uint8_t flags;              ///< 格式4起使用（之前写0），BLOB_KEY_COLOR表示color有效
+        uint8_t color[3];           ///< 格式4新增：按键反馈颜色R、G、B
+        uint8_t reserved;
+    };
+    
+    static const uint8_t BLOB_KEY_COLOR = 0x01;
+    
+    static const uint16_t NO_STRING = 0xFFFF;
+    
+    static const char* PREF_NAMESPACE;          ///< 旧固件的Preferences命名空间（只用于迁移）
+    static const char* PREF_CONFIG_KEY;         ///< 旧固件的配置键名
+    
+    /**
+     * @brief 设置镜像中还没有布局时，读出旧固件保存在NVS中的布局（没有时用默认配置），
+     *        写入设置镜像并清空旧的命名空间
+     */
+    bool migrateConfig();
+    
+    /**
+     * @brief 创建默认配置（同时清空覆盖表）
      * @return 默认键盘布局配置
      */
     KeyboardLayoutConfig createDefaultConfig();
     
     /**
-     * @brief 创建主层配置
-     * @return 主层配置
+     * @brief 默认的布局信息（不改变覆盖表）
+     */
+    static KeyboardLayoutConfig defaultLayout();
+    
+    /**
+     * @brief 清空当前覆盖表，所有按键恢复为默认表
+     */
+    void clearKeyOverrides() { clearTable(*_active); }
+    static void clearTable(OverrideTable& table);
+    
+    /**
+     * @brief 把保存数据复制到备用覆盖表，校验通过后换入
+     * @return false 数据无效，当前覆盖表不变
      */
-    LayerConfig createPrimaryLayer();
+    bool loadTable(const void* data, size_t size);
     
     /**
-     * @brief 创建第二层配置
-     * @return 第二层配置
+     * @brief 空闲后保存换入的布局
      */
-    LayerConfig createSecondaryLayer();
+    void scheduleSave();
     
     /**
-     * @brief 计算配置校验和
-     * @return 校验和值
+     * @brief 计算保存数据的CRC32（头之后的部分）
+     * @param buffer 保存数据
+     * @param size 总字节数
+     * @return 校验值
      */
-    uint32_t calculateChecksum() const;
+    static uint32_t calculateChecksum(const uint8_t* buffer, size_t size);
     
     /**
-     * @brief 序列化配置为字节数组
-     * @param buffer 输出缓冲区
+     * @brief 序列化配置和覆盖表为保存格式
+     * @param buffer 输出缓冲区（4字节对齐）
      * @param maxSize 缓冲区最大大小
      * @return 实际使用的字节数，失败返回0
      */
     size_t serializeConfig(uint8_t* buffer, size_t maxSize) const;
     
     /**
-     * @brief 从字节数组反序列化配置
-     * @param buffer 输入缓冲区
-     * @param size 缓冲区大小
-     * @return true 成功，false 失败
+     * @brief 把布局信息和一张覆盖表写成保存格式
+     * @return 实际使用的字节数，失败返回0
      */
-    bool deserializeConfig(const uint8_t* buffer, size_t size);
+    static size_t buildBlob(uint8_t* buffer, size_t maxSize, const KeyboardLayoutConfig& layout,
+                            const KeyOverride* keys, uint8_t count);
     
     /**
-     * @brief 查找层级配置
-     * @param layer 层级类型
-     * @return 层级配置指针，未找到返回nullptr
+     * @brief 校验table.blob中的保存数据并载入该覆盖表（不改变当前配置）
+     * @param size 数据字节数
+     * @param layout 输出布局信息
+     * @return true 成功，false 格式、校验或按键数据无效
      */
-    LayerConfig* findLayerConfig(KeyLayer layer);
+    bool deserializeConfig(OverrideTable& table, size_t size, KeyboardLayoutConfig& layout);
     
     /**
-     * @brief 查找层级配置（常量版本）
+     * @brief 查找层级信息
      * @param layer 层级类型
-     * @return 层级配置指针，未找到返回nullptr
+     * @return 层级信息指针，未找到返回nullptr
+     */
+    static const LayerConfig* findLayerConfig(KeyLayer layer);
+    
+    /**
+     * @brief 设置当前层并发出层变化通知
      */
-    const LayerConfig* findLayerConfig(KeyLayer layer) const;
+    void setCurrentLayer(KeyLayer layer);
     
     /**
      * @brief 记录日志
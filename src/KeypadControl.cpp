@@ -1,626 +1,1167 @@
-/**
- * @file KeypadControl.cpp
- * @brief 键盘控制库的实现文件
- * 
- * 实现了键盘控制的各项功能，包括：
- * - 硬件初始化和配置
- * - 按键扫描和状态检测
- * - 按键事件处理
- * - LED效果控制
- * - 蜂鸣器控制
- * 
- * 硬件连接：
- * - 移位寄存器时钟线：SCAN_CLK_PIN
- * - 移位寄存器片选线：SCAN_CE_PIN
- * - 移位寄存器并行加载：SCAN_PL_PIN
- * - 移位寄存器数据输入：SCAN_MISO_PIN
- * - RGB LED数据线：RGB_PIN
- * - 蜂鸣器控制线：BUZZ_PIN
- * 
- * @author Your Name
- * @date 2024-01-07
- */
-
-#include "KeypadControl.h"
-#include "SimpleHID.h"
-#include "Logger.h"
-
-// 按键位置映射表定义
-const uint8_t KeypadControl::KEY_POSITIONS[] = {
-    8,   // Key 1:  第8位
-    7,   // Key 2:  第7位
-    6,   // Key 3:  第6位
-    5,   // Key 4:  第5位
-    4,   // Key 5:  第4位
-    3,   // Key 6:  第3位
-    2,   // Key 7:  第2位
-    1,   // Key 8:  第1位
-    16,  // Key 9:  第16位
-    15,  // Key 10: 第15位
-    14,  // Key 11: 第14位
-    13,  // Key 12: 第13位
-    12,  // Key 13: 第12位
-    11,  // Key 14: 第11位
-    10,  // Key 15: 第10位
-    9,   // Key 16: 第9位
-    24,  // Key 17: 第24位
-    23,  // Key 18: 第23位
-    22,  // Key 19: 第22位
-    21,  // Key 20: 第21位
-    20,  // Key 21: 第20位
-    19   // Key 22: 第19位
-};
-
-// 钢琴音阶频率表定义（500Hz-2500Hz等比分布，5倍频率范围）
-const uint16_t KeypadControl::PIANO_TONES[] = {
-    500,  // Key 1:  低音
-    540,  // Key 2:  低音
-    583,  // Key 3:  低音
-    629,  // Key 4:  低音
-    679,  // Key 5:  低中音
-    733,  // Key 6:  低中音
-    791,  // Key 7:  低中音
-    854,  // Key 8:  中音
-    922,  // Key 9:  中音
-    995,  // Key 10: 中音
-    1074, // Key 11: 中音
-    1159, // Key 12: 中高音
-    1252, // Key 13: 中高音
-    1351, // Key 14: 中高音
-    1459, // Key 15: 高音
-    1575, // Key 16: 高音
-    1700, // Key 17: 高音
-    1836, // Key 18: 很高音
-    1982, // Key 19: 很高音
-    2140, // Key 20: 很高音
-    2310, // Key 21: 超高音
-    2500  // Key 22: 超高音
-};
-
-KeypadControl::KeypadControl()
-    : _currentState(0xFFFFFF), 
-      _lastState(0xFFFFFF),
-      _debouncedState(0xFFFFFF),
-      _lastDebounceTime(0),
-      _lastUpdateTime(0),
-      _pressedKeyCount(0),
-      _eventCallback(nullptr),
-      _repeatDelay(DEFAULT_REPEAT_DELAY),
-      _repeatRate(DEFAULT_REPEAT_RATE),
-      _longPressDelay(DEFAULT_LONGPRESS_DELAY),
-      _globalBrightness(255),
-      _simpleHID(nullptr),
-      _hidEnabled(false) {
-    
-    // 初始化按键状态数组
-    memset(_keyStates, 0, sizeof(_keyStates));
-    // 初始化LED效果数组
-    memset(_ledEffects, 0, sizeof(_ledEffects));
-    // 初始化按键反馈数组
-    memset(_keyFeedback, 0, sizeof(_keyFeedback));
-    
-    // 初始化蜂鸣器配置
-    _buzzerConfig = {
-        .enabled = true,
-        .followKeypress = true,
-        .dualTone = false,
-        .mode = BUZZER_MODE_NORMAL,  // 默认普通模式
-        .volume = BUZZER_MEDIUM,
-        .pressFreq = 2000,      // 2kHz按下音调
-        .releaseFreq = 1500,    // 1.5kHz释放音调
-        .duration = 50          // 50ms持续时间
-    };
-}
-
-void KeypadControl::begin() {
-    KEYPAD_LOG_I("正在初始化按键控制系统");
-    
-    // 初始化引脚
-    pinMode(SCAN_PL_PIN, OUTPUT);
-    pinMode(SCAN_CE_PIN, OUTPUT);
-    pinMode(SCAN_CLK_PIN, OUTPUT);
-    pinMode(SCAN_MISO_PIN, INPUT);
-    KEYPAD_LOG_D("GPIO引脚配置完成");
-
-    // 设置初始状态
-    digitalWrite(SCAN_PL_PIN, HIGH);
-    digitalWrite(SCAN_CE_PIN, LOW);
-    digitalWrite(SCAN_CLK_PIN, LOW);
-    KEYPAD_LOG_D("初始引脚状态设置完成");
-
-    // 初始化蜂鸣器LEDC
-    ledcSetup(BUZZER_CHANNEL, 2000, 8);  // 通道2，2kHz，8位分辨率
-    ledcAttachPin(BUZZ_PIN, BUZZER_CHANNEL);
-    _buzzerActive = false;
-    _buzzerEndTime = 0;
-    KEYPAD_LOG_D("蜂鸣器LEDC初始化完成");
-    
-    KEYPAD_LOG_I("按键控制系统初始化成功");
-}
-
-void KeypadControl::update() {
-    uint32_t currentTime = millis();
-    
-    // 控制更新频率
-    if (currentTime - _lastUpdateTime >= UPDATE_INTERVAL) {
-        // 读取当前按键状态
-        _currentState = readShiftRegisters();
-        
-        // 只在状态改变时输出调试信息，避免刷屏
-        static uint32_t lastDebugState = 0xFFFFFF;
-        if (_currentState != lastDebugState) {
-            KEYPAD_LOG_V("原始扫描状态: 0x%06X", _currentState);
-            lastDebugState = _currentState;
-        }
-        
-        // 去抖动处理
-        if (currentTime - _lastDebounceTime >= DEBOUNCE_DELAY) {
-            if (_currentState != _lastState) {
-                _lastDebounceTime = currentTime;
-                _lastState = _currentState;
-            } else {
-                // 状态稳定，进行处理
-                if (_currentState != _debouncedState) {
-                    _debouncedState = _currentState;
-                    checkKeyStates(_debouncedState);
-                }
-            }
-        }
-        
-        // 更新按键状态
-        updateKeyStates();
-        
-        // 检查组合键
-        checkComboKeys();
-        
-        // 处理自动重复
-        updateAutoRepeat();
-        
-        _lastUpdateTime = currentTime;
-    }
-
-    // 处理非阻塞蜂鸣器
-    updateBuzzer();
-}
-
-void KeypadControl::checkKeyStates(uint32_t buttonState) {
-    _pressedKeyCount = 0;
-    
-    KEYPAD_LOG_V("检查按键状态: 0x%06X", buttonState);
-    
-    // 检查每个按键的状态变化
-    for (uint8_t i = 0; i < 22; i++) {
-        bool isPressed = !(buttonState & (1UL << (KEY_POSITIONS[i] - 1)));
-        
-        // 输出详细的位检查信息
-        if (isPressed) {
-            KEYPAD_LOG_V("按键 %d (位置 %d, 位 %d, 掩码 0x%06X) 检测为按下状态", 
-                        i + 1, KEY_POSITIONS[i], KEY_POSITIONS[i] - 1, 
-                        1UL << (KEY_POSITIONS[i] - 1));
-        }
-        
-        if (isPressed != _keyStates[i].pressed) {
-            _keyStates[i].pressed = isPressed;
-            
-            if (isPressed) {
-                _keyStates[i].pressTime = millis();
-                _keyStates[i].longPressed = false;
-                _pressedKeys[_pressedKeyCount++] = i + 1;
-                handleKeyEvent(KEY_EVENT_PRESS, i + 1);
-            } else {
-                handleKeyEvent(KEY_EVENT_RELEASE, i + 1);
-            }
-        } else if (isPressed) {
-            // 只有在状态没有变化但仍处于按下状态时，才添加到当前按下键列表
-            // 这用于多键组合检测（避免重复添加）
-            _pressedKeys[_pressedKeyCount++] = i + 1;
-        }
-    }
-}
-
-void KeypadControl::updateKeyStates() {
-    uint32_t currentTime = millis();
-    
-    // 检查长按和自动重复
-    for (uint8_t i = 0; i < 22; i++) {
-        if (_keyStates[i].pressed) {
-            // 检查长按
-            if (!_keyStates[i].longPressed && 
-                (currentTime - _keyStates[i].pressTime >= _longPressDelay)) {
-                _keyStates[i].longPressed = true;
-                handleKeyEvent(KEY_EVENT_LONGPRESS, i + 1);
-            }
-        }
-    }
-}
-
-void KeypadControl::checkComboKeys() {
-    if (_pressedKeyCount > 1 && _pressedKeyCount <= 5) {
-        // 复制当前按下的键到组合键缓冲区
-        memcpy(_comboBuffer, _pressedKeys, _pressedKeyCount);
-        
-        // 直接触发注册的回调
-        if (_eventCallback) {
-            _eventCallback(KEY_EVENT_COMBO, _comboBuffer[0], _comboBuffer, _pressedKeyCount);
-        }
-    }
-}
-
-void KeypadControl::updateAutoRepeat() {
-    uint32_t currentTime = millis();
-    
-    for (uint8_t i = 0; i < 22; i++) {
-        if (_keyStates[i].pressed && _keyStates[i].autoRepeat) {
-            uint32_t pressedTime = currentTime - _keyStates[i].pressTime;
-            
-            if (pressedTime >= _repeatDelay) {
-                uint32_t timeSinceLastRepeat = currentTime - _keyStates[i].lastRepeat;
-                if (_keyStates[i].lastRepeat == 0 || timeSinceLastRepeat >= _repeatRate) {
-                    handleKeyEvent(KEY_EVENT_REPEAT, i + 1);
-                    _keyStates[i].lastRepeat = currentTime;
-                }
-            }
-        }
-    }
-}
-
-void KeypadControl::handleKeyEvent(KeyEventType type, uint8_t key) {
-    // 使用日志系统输出按键事件
-    switch (type) {
-        case KEY_EVENT_PRESS:
-            KEYPAD_LOG_I("按键 %d 被按下", key);
-            break;
-        case KEY_EVENT_RELEASE:
-            KEYPAD_LOG_I("按键 %d 被释放", key);
-            break;
-        case KEY_EVENT_LONGPRESS:
-            KEYPAD_LOG_I("按键 %d 长按", key);
-            break;
-        case KEY_EVENT_REPEAT:
-            KEYPAD_LOG_D("按键 %d 重复", key);
-            break;
-        case KEY_EVENT_COMBO:
-            KEYPAD_LOG_I("按键 %d 组合键", key);
-            break;
-        default:
-            KEYPAD_LOG_W("按键 %d 未知事件", key);
-            break;
-    }
-    
-    // 并行处理：同时触发计算器功能和HID功能
-    
-    // 1. 首先触发计算器回调（原有功能）
-    if (_eventCallback) {
-        _eventCallback(type, key, nullptr, 0);
-    }
-    
-    // 2. 同时处理HID功能（新增功能）
-    if (_hidEnabled && _simpleHID) {
-        bool pressed = (type == KEY_EVENT_PRESS || type == KEY_EVENT_LONGPRESS || type == KEY_EVENT_REPEAT);
-        bool released = (type == KEY_EVENT_RELEASE);
-        
-        if (pressed) {
-            _simpleHID->handleKey(key, true);
-        } else if (released) {
-            _simpleHID->handleKey(key, false);
-        }
-    }
-    
-    // 处理按键反馈
-    if (_keyFeedback[key - 1].enabled) {
-        // LED反馈
-        if (_keyFeedback[key - 1].ledMode != LED_INSTANT) {
-            handleLEDEffect(key - 1, _keyFeedback[key - 1].ledMode, 
-                          _keyFeedback[key - 1].color);
-        }
-    }
-    
-    // 蜂鸣器反馈
-    if (_buzzerConfig.followKeypress) {
-        uint16_t freq = _buzzerConfig.pressFreq;  // 默认频率
-        
-        // 根据蜂鸣器模式选择频率
-        if (_buzzerConfig.mode == BUZZER_MODE_PIANO && key >= 1 && key <= 22) {
-            freq = PIANO_TONES[key - 1];  // 使用钢琴音调
-        }
-        
-        switch (type) {
-            case KEY_EVENT_PRESS:
-                startBuzzer(freq, _buzzerConfig.duration);
-                break;
-                
-            case KEY_EVENT_RELEASE:
-                if (_buzzerConfig.dualTone) {
-                    uint16_t releaseFreq = (_buzzerConfig.mode == BUZZER_MODE_PIANO && key >= 1 && key <= 22) 
-                                         ? PIANO_TONES[key - 1] * 0.8  // 钢琴模式下释放音调略低
-                                         : _buzzerConfig.releaseFreq;
-                    startBuzzer(releaseFreq, _buzzerConfig.duration);
-                }
-                break;
-                
-            case KEY_EVENT_LONGPRESS:
-                startBuzzer(freq * 1.2, _buzzerConfig.duration * 1.5);  // 长按音调略高
-                break;
-                
-            case KEY_EVENT_REPEAT:
-                startBuzzer(freq, _buzzerConfig.duration / 2);
-                break;
-                
-            default:
-                break;
-        }
-    }
-}
-
-void KeypadControl::configureBuzzer(const BuzzerConfig& config) {
-    _buzzerConfig = config;
-}
-
-void KeypadControl::setBuzzerVolume(BuzzerVolume volume) {
-    _buzzerConfig.volume = volume;
-}
-
-void KeypadControl::setBuzzerFollowKey(bool enable, bool dualTone) {
-    _buzzerConfig.followKeypress = enable;
-    _buzzerConfig.dualTone = dualTone;
-}
-
-void KeypadControl::setBuzzerMode(BuzzerMode mode) {
-    _buzzerConfig.mode = mode;
-    KEYPAD_LOG_I("蜂鸣器模式设置为: %s", (mode == BUZZER_MODE_PIANO) ? "钢琴模式" : "普通模式");
-}
-
-uint8_t KeypadControl::getVolumeDuty(BuzzerVolume volume) const {
-    switch (volume) {
-        case BUZZER_MUTE:   return 0;
-        case BUZZER_LOW:    return 85;    // 33% duty cycle
-        case BUZZER_MEDIUM: return 127;   // 50% duty cycle
-        case BUZZER_HIGH:   return 255;   // 100% duty cycle
-        default:            return 127;
-    }
-}
-
-void KeypadControl::startBuzzer(uint16_t freq, uint16_t duration) {
-    if (!_buzzerConfig.enabled) return;
-    
-    // 设置频率和占空比
-    ledcWriteTone(BUZZER_CHANNEL, freq);
-    uint8_t duty = getVolumeDuty(_buzzerConfig.volume);
-    ledcWrite(BUZZER_CHANNEL, duty);
-    
-    // 设置结束时间
-    _buzzerActive = true;
-    _buzzerEndTime = millis() + duration;
-    
-    KEYPAD_LOG_D("蜂鸣器启动: 频率=%d Hz, 持续时间=%d ms, 占空比=%d", freq, duration, duty);
-}
-
-void KeypadControl::updateBuzzer() {
-    if (_buzzerActive && millis() >= _buzzerEndTime) {
-        // 停止蜂鸣器
-        ledcWrite(BUZZER_CHANNEL, 0);
-        _buzzerActive = false;
-        KEYPAD_LOG_D("蜂鸣器停止");
-    }
-}
-
-void KeypadControl::handleLEDEffect(uint8_t ledIndex, LEDMode mode, CRGB color) {
-    if (ledIndex >= NUM_LEDS) return;
-    
-    LEDEffect& effect = _ledEffects[ledIndex];
-    effect.active = true;
-    effect.startTime = millis();
-    effect.mode = mode;
-    effect.color = color;
-    
-    switch (mode) {
-        case LED_INSTANT:
-            leds[ledIndex] = color;
-            FastLED.show();
-            break;
-            
-        case LED_FADE:
-            effect.brightness = 255;
-            effect.duration = LED_FADE_DURATION;
-            leds[ledIndex] = color;
-            FastLED.show();
-            break;
-            
-        case LED_BREATH:
-            effect.brightness = 0;
-            effect.duration = 1000;
-            break;
-            
-        case LED_BLINK:
-            effect.duration = 200;
-            leds[ledIndex] = color;
-            FastLED.show();
-            break;
-    }
-}
-
-void KeypadControl::updateLEDEffects() {
-    uint32_t currentTime = millis();
-    bool needUpdate = false;
-
-    for (int i = 0; i < NUM_LEDS; i++) {
-        if (_ledEffects[i].active) {
-            uint32_t elapsed = currentTime - _ledEffects[i].startTime;
-            
-            switch (_ledEffects[i].mode) {
-                case LED_INSTANT:
-                    if (elapsed >= 50) {  // 50ms后熄灭
-                        leds[i] = CRGB::Black;
-                        _ledEffects[i].active = false;
-                        needUpdate = true;
-                    }
-                    break;
-
-                case LED_FADE:
-                    if (elapsed >= _ledEffects[i].duration) {
-                        leds[i] = CRGB::Black;
-                        _ledEffects[i].active = false;
-                        needUpdate = true;
-                    } else {
-                        float fadeProgress = (float)elapsed / _ledEffects[i].duration;
-                        uint8_t brightness = 255 * (1.0 - fadeProgress);
-                        leds[i] = _ledEffects[i].color;
-                        leds[i].nscale8(brightness);
-                        needUpdate = true;
-                    }
-                    break;
-
-                case LED_BREATH:
-                    {
-                        float breathProgress = (float)(elapsed % _ledEffects[i].duration) / _ledEffects[i].duration;
-                        float brightness = sin(breathProgress * PI) * 255;
-                        leds[i] = _ledEffects[i].color;
-                        leds[i].nscale8(abs(brightness));
-                        needUpdate = true;
-                    }
-                    break;
-
-                case LED_BLINK:
-                    if (elapsed >= _ledEffects[i].duration) {
-                        _ledEffects[i].startTime = currentTime;
-                        leds[i] = (elapsed / _ledEffects[i].duration) % 2 ? 
-                                 _ledEffects[i].color : CRGB::Black;
-                        needUpdate = true;
-                    }
-                    break;
-            }
-        }
-    }
-
-    if (needUpdate) {
-        FastLED.show();
-    }
-}
-
-// 其他基本功能实现
-void KeypadControl::enableAutoRepeat(uint8_t key, bool enable) {
-    if (key > 0 && key <= 22) {
-        _keyStates[key - 1].autoRepeat = enable;
-    }
-}
-
-bool KeypadControl::isKeyPressed(uint8_t key) const {
-    if (key > 0 && key <= 22) {
-        return _keyStates[key - 1].pressed;
-    }
-    return false;
-}
-
-bool KeypadControl::isKeyLongPressed(uint8_t key) const {
-    if (key > 0 && key <= 22) {
-        return _keyStates[key - 1].longPressed;
-    }
-    return false;
-}
-
-void KeypadControl::setKeyFeedback(uint8_t keyNumber, const KeyFeedback& feedback) {
-    if (keyNumber > 0 && keyNumber <= 22) {
-        _keyFeedback[keyNumber - 1] = feedback;
-    }
-}
-
-void KeypadControl::setGlobalBrightness(uint8_t brightness) {
-    _globalBrightness = brightness;
-    FastLED.setBrightness(_globalBrightness);
-    FastLED.show();
-}
-
-uint32_t KeypadControl::readShiftRegisters() {
-    uint32_t result = 0;
-
-    // 锁存数据
-    digitalWrite(SCAN_PL_PIN, LOW);   
-    delayMicroseconds(5);
-    digitalWrite(SCAN_PL_PIN, HIGH);  
-
-    // 读取24位数据
-    for (uint8_t i = 0; i < 24; i++) {
-        result <<= 1;
-        if (digitalRead(SCAN_MISO_PIN)) {
-            result |= 1;
-        }
-        digitalWrite(SCAN_CLK_PIN, HIGH);
-        delayMicroseconds(5);
-        digitalWrite(SCAN_CLK_PIN, LOW);
-        delayMicroseconds(5);
-    }
-
-    return result;
-}
-
-uint8_t KeypadControl::getPressedKeys(uint8_t* keyBuffer, uint8_t bufferSize) const {
-    uint8_t count = min(bufferSize, _pressedKeyCount);
-    if (count > 0 && keyBuffer != nullptr) {
-        memcpy(keyBuffer, _pressedKeys, count);
-    }
-    return count;
-}
-
-void KeypadControl::setSimpleHID(SimpleHID* hid) {
-    _simpleHID = hid;
-    KEYPAD_LOG_I("简单HID处理器已设置");
-}
-
-void KeypadControl::setHIDEnabled(bool enabled) {
-    if (_hidEnabled != enabled) {
-        _hidEnabled = enabled;
-        KEYPAD_LOG_I("HID功能已%s", enabled ? "启用" : "禁用");
-    }
-}
-
-#ifdef DEBUG_MODE
-void KeypadControl::testAllBits() {
-    Serial.println(F("=== 测试所有 24 位 ==="));
-    uint32_t state = readShiftRegisters();
-    Serial.print(F("原始寄存器状态: 0x"));
-    Serial.println(state, HEX);
-    
-    for (int bit = 0; bit < 24; bit++) {
-        bool bitState = !(state & (1UL << bit));  // 按键按下时为低电平
-        if (bitState) {
-            Serial.print(F("位 "));
-            Serial.print(bit);
-            Serial.println(F(" 激活 (按下)"));
-        }
-    }
-    Serial.println(F("=== 测试结束 ==="));
-}
-
-void KeypadControl::printDebugInfo() {
-    Serial.println(F("键盘控制调试信息:"));
-    Serial.print(F("当前状态: 0x"));
-    Serial.println(_currentState, HEX);
-    Serial.print(F("按下的按键: "));
-    for (uint8_t i = 0; i < _pressedKeyCount; i++) {
-        Serial.print(_pressedKeys[i]);
-        Serial.print(" ");
-    }
-    Serial.println();
-    
-    Serial.println(F("活跃的LED效果:"));
-    for (uint8_t i = 0; i < NUM_LEDS; i++) {
-        if (_ledEffects[i].active) {
-            Serial.print(F("LED "));
-            Serial.print(i);
-            Serial.print(F(": 模式="));
-            Serial.print(_ledEffects[i].mode);
-            Serial.println();
-        }
-    }
-
-    Serial.println(F("蜂鸣器配置:"));
-    Serial.print(F("启用: "));
-    Serial.println(_buzzerConfig.enabled);
-    Serial.print(F("跟随按键: "));
-    Serial.println(_buzzerConfig.followKeypress);
-    Serial.print(F("双音调: "));
-    Serial.println(_buzzerConfig.dualTone);
-    Serial.print(F("音量: "));
-    Serial.println(_buzzerConfig.volume);
-}
+/**
+ * @file KeypadControl.cpp
+ * @brief 键盘控制库的实现文件
+ * 
+ * 实现了键盘控制的各项功能，包括：
+ * - 硬件初始化和配置
+ * - 按键扫描和状态检测
+ * - 按键事件处理
+ * - LED效果控制
+ * - 蜂鸣器控制
+ * 
+ * 硬件连接：
+ * - 移位寄存器时钟线：SCAN_CLK_PIN
+ * - 移位寄存器片选线：SCAN_CE_PIN
+ * - 移位寄存器并行加载：SCAN_PL_PIN
+ * - 移位寄存器数据输入：SCAN_MISO_PIN
+ * - RGB LED数据线：RGB_PIN
+ * - 蜂鸣器控制线：BUZZ_PIN
+ * 
+ * @author Your Name
+ * @date 2024-01-07
+ */
+
+#include "KeypadControl.h"
+#include "Logger.h"
+#include "PerformanceMonitor.h"
+#include "LedOutput.h"
+#include "LedLayout.h"
+#include "SpatialEffects.h"
+#include "LoopScheduler.h"
+#include "CpuProfiler.h"
+#include "LatencyProbe.h"
+#include "UlpKeyScan.h"
+#include <esp_timer.h>
+#include <driver/gpio.h>
+
+// 按键位置映射表定义
+const uint8_t KeypadControl::KEY_POSITIONS[] = {
+    8,   // Key 1:  第8位
+    7,   // Key 2:  第7位
+    6,   // Key 3:  第6位
+    5,   // Key 4:  第5位
+    4,   // Key 5:  第4位
+    3,   // Key 6:  第3位
+    2,   // Key 7:  第2位
+    1,   // Key 8:  第1位
+    16,  // Key 9:  第16位
+    15,  // Key 10: 第15位
+    14,  // Key 11: 第14位
+    13,  // Key 12: 第13位
+    12,  // Key 13: 第12位
+    11,  // Key 14: 第11位
+    10,  // Key 15: 第10位
+    9,   // Key 16: 第9位
+    24,  // Key 17: 第24位
+    23,  // Key 18: 第23位
+    22,  // Key 19: 第22位
+    21,  // Key 20: 第21位
+    20,  // Key 21: 第20位
+    19   // Key 22: 第19位
+};
+
+// 钢琴音阶频率表定义（500Hz-2500Hz等比分布，5倍频率范围）
+const uint16_t KeypadControl::PIANO_TONES[] = {
+    500,  // Key 1:  低音
+    540,  // Key 2:  低音
+    583,  // Key 3:  低音
+    629,  // Key 4:  低音
+    679,  // Key 5:  低中音
+    733,  // Key 6:  低中音
+    791,  // Key 7:  低中音
+    854,  // Key 8:  中音
+    922,  // Key 9:  中音
+    995,  // Key 10: 中音
+    1074, // Key 11: 中音
+    1159, // Key 12: 中高音
+    1252, // Key 13: 中高音
+    1351, // Key 14: 中高音
+    1459, // Key 15: 高音
+    1575, // Key 16: 高音
+    1700, // Key 17: 高音
+    1836, // Key 18: 很高音
+    1982, // Key 19: 很高音
+    2140, // Key 20: 很高音
+    2310, // Key 21: 超高音
+    2500  // Key 22: 超高音
+};
+
+// LED效果表定义（顺序与LEDMode一致）
+const KeypadControl::LEDEffectDef KeypadControl::LED_EFFECTS[] = {
+    // LED_INSTANT: 常亮50ms后熄灭
+    { 50, false, false, 2, { {0, 255}, {65535, 255} } },
+    // LED_FADE: 线性渐暗
+    { LED_FADE_DURATION, false, false, 2, { {0, 255}, {65535, 0} } },
+    // LED_BREATH: 缓动升降，近似半个正弦周期
+    { 1000, true, true, 3, { {0, 0}, {32768, 255}, {65535, 0} } },
+    // LED_BLINK: 亮200ms、灭200ms
+    { 400, true, false, 4, { {0, 255}, {32767, 255}, {32768, 0}, {65535, 0} } },
+    // LED_SOLID: 常亮
+    { 1000, true, false, 2, { {0, 255}, {65535, 255} } },
+    // LED_PULSE: 300ms渐亮、300ms渐灭，不循环
+    { 600, false, false, 3, { {0, 0}, {32768, 255}, {65535, 0} } }
+};
+
+KeypadControl::KeypadControl()
+    : _currentState(0xFFFFFF), 
+      _debouncedState(0xFFFFFF),
+      _vcState(0),
+      _vcCount0(SCAN_MASK),
+      _vcCount1(SCAN_MASK),
+      _eagerPress(KEYPAD_EAGER_PRESS),
+      _lastUpdateTime(0),
+      _pressedKeyCount(0),
+      _lastRawPressed(0),
+      _chords(KEYPAD_CHORD_WINDOW_MS, chordEntry, this),
+      _repeatDelay(DEFAULT_REPEAT_DELAY),
+      _repeatRate(DEFAULT_REPEAT_RATE),
+      _longPressDelay(DEFAULT_LONGPRESS_DELAY),
+      _globalBrightness(255),
+      _ledLayersChanged(false),
+      _fieldActive(false),
+      _perfMonitor(nullptr),
+      _scanSPI(nullptr),
+      _scanTask(nullptr),
+      _scanPeriodUs(1000),
+      _measurePending(false),
+      _measureReadCycles(0),
+      _measureCheckCycles(0),
+      _scanTimestamp(0),
+      _droppedEvents(0),
+      _scanRate(SCAN_RATE_FAST),
+      _wakePending(false),
+      _wakePressed(0),
+      _wakeHook(nullptr),
+      _wakeContext(nullptr),
+      _passThrough(nullptr),
+      _passThroughContext(nullptr),
+      _idleTimeoutMs(KEYPAD_IDLE_TIMEOUT_MS),
+      _lastActivityTime(0) {
+    
+    // 初始化按键状态
+    _pressedMask = 0;
+    _longPressedMask = 0;
+    _autoRepeatMask = 0;
+    memset(_pressTime, 0, sizeof(_pressTime));
+    _repeatKey = 0;
+    _repeatStart = 0;
+    _nextRepeat = 0;
+    
+    // 由按键位置表生成扫描位到按键编号的反查表
+    memset(_rawBitToKey, 0, sizeof(_rawBitToKey));
+    for (uint8_t i = 0; i < 22; i++) {
+        _rawBitToKey[KEY_POSITIONS[i] - 1] = i + 1;
+    }
+    // 初始化LED效果数组
+    memset(_ledEffects, 0, sizeof(_ledEffects));
+    fill_solid(_field, NUM_LEDS, CRGB::Black);
+    // 初始化按键反馈数组
+    memset(_keyFeedback, 0, sizeof(_keyFeedback));
+    
+    // 初始化蜂鸣器配置
+    _buzzerConfig = {
+        .enabled = true,
+        .followKeypress = true,
+        .dualTone = false,
+        .mode = BUZZER_MODE_NORMAL,  // 默认普通模式
+        .volume = BUZZER_MEDIUM,
+        .pressFreq = 2000,      // 2kHz按下音调
+        .releaseFreq = 1500,    // 1.5kHz释放音调
+        .duration = 50          // 50ms持续时间
+    };
+}
+
+void KeypadControl::begin() {
+    KEYPAD_LOG_I("正在初始化按键控制系统");
+
+#if ULP_KEY_SCAN_ENABLED
+    // 须在引脚初始化之前：由ULP从深度睡眠唤醒时取回它记下的按键，并把引脚还给数字GPIO
+    UlpKeyScan& ulp = UlpKeyScan::instance();
+    uint32_t wakeState;
+    if (ulp.begin() && ulp.takeWake(wakeState)) {
+        _wakePressed = ~wakeState & SCAN_MASK;
+        KEYPAD_LOG_I("ULP唤醒，按下位: 0x%06X", _wakePressed);
+    }
+#endif
+    
+    // 初始化引脚
+    pinMode(SCAN_PL_PIN, OUTPUT);
+    pinMode(SCAN_CE_PIN, OUTPUT);
+    pinMode(SCAN_CLK_PIN, OUTPUT);
+    pinMode(SCAN_MISO_PIN, INPUT);
+    KEYPAD_LOG_D("GPIO引脚配置完成");
+
+    // 设置初始状态
+    digitalWrite(SCAN_PL_PIN, HIGH);
+    digitalWrite(SCAN_CE_PIN, LOW);
+    digitalWrite(SCAN_CLK_PIN, LOW);
+    KEYPAD_LOG_D("初始引脚状态设置完成");
+
+#if KEYPAD_SCAN_USE_SPI
+    // 时钟和数据线交给SPI外设，PL/CE仍由GPIO控制
+    _scanSPI = new SPIClass(KEYPAD_SCAN_SPI_HOST);
+    _scanSPI->begin(SCAN_CLK_PIN, SCAN_MISO_PIN, -1, -1);
+    KEYPAD_LOG_I("按键扫描使用硬件SPI: %d Hz", KEYPAD_SCAN_SPI_FREQ);
+#else
+    KEYPAD_LOG_I("按键扫描使用GPIO逐位读取");
+#endif
+
+#if AUDIO_PDM_ENABLED
+    // 蜂鸣器引脚由I2S PDM输出采样
+    AudioOutput::instance().begin(BUZZ_PIN);
+#else
+    // 初始化蜂鸣器：音符由esp_timer定时切换
+    BuzzerSequencer::instance().begin(BUZZER_CHANNEL, BUZZ_PIN);
+    KEYPAD_LOG_D("蜂鸣器LEDC初始化完成");
+#endif
+    
+    // 按键反馈订阅按键事件，排在HID输出之后
+    KeyEventBus::instance().subscribe(KeySubscriber{"feedback", KEY_EVENT_ALL_KEYS, KEY_STAGE_FEEDBACK,
+                                                    feedbackEntry, nullptr, this});
+    
+    KEYPAD_LOG_I("按键控制系统初始化成功");
+}
+
+void KeypadControl::update() {
+    PROFILE_SCOPE(PROFILE_KEY_DISPATCH);
+    if (_scanTask) {
+        // 扫描在任务中进行，这里只分发事件
+        KeyEvent event;
+        while (_eventQueue.pop(event)) {
+            dispatchKeyEvent(event);
+        }
+    } else {
+        uint32_t currentTime = millis();
+        
+        // 控制更新频率（降频和空闲时按兜底扫描间隔，收到唤醒中断立即扫描）
+        uint32_t interval = UPDATE_INTERVAL;
+        if (_scanRate != SCAN_RATE_FAST && !_wakePending) {
+            interval = pollInterval(_scanRate);
+        }
+        if (currentTime - _lastUpdateTime >= interval) {
+            scanOnce(currentTime);
+            _lastUpdateTime = currentTime;
+        }
+        LoopScheduler::instance().at(_lastUpdateTime + interval);
+    }
+
+    // 本次更新的事件分发完毕：发出HID报告，再处理推迟的计算器事件
+    KeyEventBus::instance().flush();
+}
+
+bool KeypadControl::startScanTask(uint16_t rateHz, UBaseType_t priority, BaseType_t core) {
+    if (_scanTask) return true;
+    if (rateHz == 0) return false;
+
+    _scanPeriodUs = 1000000UL / rateHz;
+    _scanLock.begin("keyScan");
+    if (xTaskCreatePinnedToCore(scanTaskEntry, "keyScan", 4096, this,
+                                priority, &_scanTask, core) != pdPASS) {
+        _scanTask = nullptr;
+        KEYPAD_LOG_E("扫描任务创建失败");
+        return false;
+    }
+
+    KEYPAD_LOG_I("扫描任务已启动: %d Hz, 优先级 %d, 核心 %d", rateHz, (int)priority, (int)core);
+    return true;
+}
+
+// 扫描路径（扫描、去抖、状态变化和事件入队）每个周期都执行，放在IRAM中，耗时不受flash缓存未命中影响
+void IRAM_ATTR KeypadControl::scanTaskEntry(void* arg) {
+    KeypadControl* self = static_cast<KeypadControl*>(arg);
+    TickType_t period = pdMS_TO_TICKS(self->_scanPeriodUs / 1000);
+    if (period == 0) period = 1;
+
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        // 按键时间戳和去抖不受调频影响
+        self->_scanLock.acquire();
+        self->scanOnce(millis());
+        if (self->_measurePending) {
+            self->measureScanSteps();
+            self->_measurePending = false;
+        }
+        self->_scanLock.release();
+
+        ScanRate rate = self->_scanRate;
+        if (rate != SCAN_RATE_FAST) {
+            // 降频/空闲：等待按键边沿中断，超时后做一次兜底扫描
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(pollInterval(rate))) && rate == SCAN_RATE_IDLE &&
+                self->_wakeHook && digitalRead(SCAN_MISO_PIN) == LOW) {
+                self->_wakeHook(self->_wakeContext);
+            }
+            lastWake = xTaskGetTickCount();
+        } else {
+            vTaskDelayUntil(&lastWake, period);
+        }
+    }
+}
+
+void KeypadControl::measureScan(uint32_t& readCycles, uint32_t& checkCycles) {
+    if (_scanTask) {
+        _measurePending = true;
+        xTaskNotifyGive(_scanTask);
+        while (_measurePending) {
+            vTaskDelay(1);
+        }
+    } else {
+        measureScanSteps();
+    }
+    readCycles = _measureReadCycles;
+    checkCycles = _measureCheckCycles;
+}
+
+void KeypadControl::measureScanSteps() {
+    uint32_t start = ESP.getCycleCount();
+    readShiftRegisters();
+    _measureReadCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    checkKeyStates(_debouncedState);
+    _measureCheckCycles = ESP.getCycleCount() - start;
+
+    // 读取拉高过PL，降频和空闲时恢复并行加载（同updateScanRate）
+    if (_scanRate != SCAN_RATE_FAST) {
+        digitalWrite(SCAN_PL_PIN, LOW);
+    }
+}
+
+void IRAM_ATTR KeypadControl::updateScanRate(uint32_t currentTime) {
+    if (_pressedMask || rawToKeyMask(~_currentState & SCAN_MASK)) {
+        _lastActivityTime = currentTime;
+    }
+    _wakePending = false;
+
+    ScanRate rate = SCAN_RATE_FAST;
+    uint32_t quiet = currentTime - _lastActivityTime;
+    if (_idleTimeoutMs && quiet >= _idleTimeoutMs) {
+        rate = SCAN_RATE_IDLE;
+    } else if (_idleTimeoutMs && quiet >= KEYPAD_FAST_HOLD_MS) {
+        rate = SCAN_RATE_RELAXED;
+    }
+
+    if (rate != _scanRate) {
+        setScanRate(rate);
+    } else if (rate != SCAN_RATE_FAST) {
+        // 本次兜底扫描拉高过PL，重新保持并行加载
+        digitalWrite(SCAN_PL_PIN, LOW);
+    }
+}
+
+void KeypadControl::setScanRate(ScanRate rate) {
+    ScanRate previous = _scanRate;
+    if (previous == SCAN_RATE_FAST) {
+        enterIdle();
+    } else if (rate == SCAN_RATE_FAST) {
+        exitIdle();
+    } else {
+        digitalWrite(SCAN_PL_PIN, LOW);
+    }
+    _scanRate = rate;
+
+    // 进出空闲档时主循环据isIdle()获取/释放最高频率锁
+    if (rate == SCAN_RATE_IDLE || previous == SCAN_RATE_IDLE) {
+        LoopScheduler::instance().wake();
+    }
+    PROFILE_EVENT(PROFILE_EVENT_SCAN_RATE, scanRateHz(rate));
+    KEYPAD_LOG_D("扫描档位: %u -> %u (%u Hz)", (unsigned)previous, (unsigned)rate, scanRateHz(rate));
+}
+
+uint32_t KeypadControl::pollInterval(ScanRate rate) {
+    return rate == SCAN_RATE_IDLE ? KEYPAD_IDLE_POLL_MS : KEYPAD_RELAXED_POLL_MS;
+}
+
+uint16_t KeypadControl::scanRateHz(ScanRate rate) const {
+    if (rate != SCAN_RATE_FAST) return 1000 / pollInterval(rate);
+    return _scanTask ? 1000000UL / _scanPeriodUs : 1000 / UPDATE_INTERVAL;
+}
+
+void KeypadControl::enterIdle() {
+    digitalWrite(SCAN_PL_PIN, LOW);
+    attachInterruptArg(digitalPinToInterrupt(SCAN_MISO_PIN), wakeISR, this, FALLING);
+}
+
+void KeypadControl::exitIdle() {
+    detachInterrupt(digitalPinToInterrupt(SCAN_MISO_PIN));
+    digitalWrite(SCAN_PL_PIN, HIGH);
+}
+
+bool KeypadControl::prepareLightSleep() {
+    if (_scanRate != SCAN_RATE_IDLE || _pressedMask || _wakePending || digitalRead(SCAN_MISO_PIN) == LOW) {
+        return false;
+    }
+
+    // 低电平唤醒会改写中断类型，先摘掉下降沿中断，避免醒来后电平中断反复进入
+    detachInterrupt(digitalPinToInterrupt(SCAN_MISO_PIN));
+#if ULP_KEY_SCAN_ENABLED
+    // ULP移位时MISO随各级输入翻转，不能再作为GPIO唤醒源
+    if (UlpKeyScan::instance().isReady()) {
+        UlpKeyScan::instance().arm(_currentState);
+        return true;
+    }
+#endif
+    gpio_wakeup_enable((gpio_num_t)SCAN_MISO_PIN, GPIO_INTR_LOW_LEVEL);
+    return true;
+}
+
+void KeypadControl::finishLightSleep() {
+    bool keyWake;
+#if ULP_KEY_SCAN_ENABLED
+    UlpKeyScan& ulp = UlpKeyScan::instance();
+    if (ulp.isReady()) {
+        ulp.disarm();
+        uint32_t wakeState;
+        keyWake = ulp.takeWake(wakeState);
+        if (keyWake) {
+            _wakePressed = ~wakeState & SCAN_MASK;
+        }
+    } else
+#endif
+    {
+        gpio_wakeup_disable((gpio_num_t)SCAN_MISO_PIN);
+        // MISO仍为低说明是按键唤醒的（定时唤醒时为高）
+        keyWake = digitalRead(SCAN_MISO_PIN) == LOW;
+    }
+    attachInterruptArg(digitalPinToInterrupt(SCAN_MISO_PIN), wakeISR, this, FALLING);
+
+    // 在扫描之前通知
+    if (_wakeHook && keyWake) {
+        _wakeHook(_wakeContext);
+    }
+
+    // 扫描任务优先级高于主循环，通知后立即抢占完成扫描；轮询模式下一次update()扫描
+    _wakePending = true;
+    if (_scanTask) {
+        xTaskNotifyGive(_scanTask);
+    }
+}
+
+bool KeypadControl::prepareDeepSleep() {
+    if (_scanRate != SCAN_RATE_IDLE || _pressedMask || _wakePending || digitalRead(SCAN_MISO_PIN) == LOW) {
+        return false;
+    }
+
+#if ULP_KEY_SCAN_ENABLED
+    if (UlpKeyScan::instance().isReady()) {
+        UlpKeyScan::instance().arm(_currentState);
+        return true;
+    }
+#endif
+
+    // 空闲模式下PL已为低；数字引脚的保持在深度睡眠中需要gpio_deep_sleep_hold_en()，启动时解除
+    gpio_hold_en((gpio_num_t)SCAN_PL_PIN);
+    gpio_deep_sleep_hold_en();
+    return true;
+}
+
+void IRAM_ATTR KeypadControl::wakeISR(void* arg) {
+    KeypadControl* self = static_cast<KeypadControl*>(arg);
+    self->_wakePending = true;
+
+    if (self->_scanTask) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(self->_scanTask, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+void IRAM_ATTR KeypadControl::scanOnce(uint32_t currentTime) {
+    // 读取当前按键状态
+    _currentState = readShiftRegisters();
+    _scanTimestamp = esp_timer_get_time();
+    
+    // 只在状态改变时输出调试信息，避免刷屏
+    static uint32_t lastDebugState = 0xFFFFFF;
+    if (_currentState != lastDebugState) {
+        KEYPAD_LOG_V("原始扫描状态: 0x%06X", _currentState);
+        lastDebugState = _currentState;
+    }
+    
+    // 逐键去抖（按键按下为低电平，先转换为1=按下）
+    uint32_t pressedRaw = ~_currentState & SCAN_MASK;
+    uint32_t rawEdges = pressedRaw ^ _lastRawPressed;
+    if (rawEdges) {
+        // 原始边沿先全部计为抖动，去抖后的状态变化在checkKeyStates中抵消
+        _lastRawPressed = pressedRaw;
+        _keyStats.onRawEdges(rawToKeyMask(rawEdges));
+    }
+#if ULP_KEY_SCAN_ENABLED
+    // ULP已去抖过的按下直接置位；醒来时若已松开，释放照常去抖，仍会报告一次完整的按键
+    uint32_t wakePressed = _wakePressed;
+    if (wakePressed) {
+        _wakePressed = 0;
+        _vcState |= wakePressed;
+    }
+#endif
+    uint32_t pressed = debounce(pressedRaw);
+    uint32_t debounced = ~pressed & SCAN_MASK;
+    
+    if (debounced != _debouncedState) {
+        _debouncedState = debounced;
+        checkKeyStates(_debouncedState);
+    }
+    
+    // 组合键检测（窗口超时需要每次扫描推进）
+    _chords.update(_pressedMask, currentTime);
+    
+    // 更新按键状态
+    updateKeyStates();
+    
+    // 处理自动重复
+    updateAutoRepeat(currentTime);
+    
+    // 按活动时间选择扫描档位
+    updateScanRate(currentTime);
+}
+
+uint32_t IRAM_ATTR KeypadControl::debounce(uint32_t pressedRaw) {
+    // 按下沿立即生效；计数器因采样与状态一致会在下一步复位，释放仍需完整去抖
+    if (_eagerPress) {
+        _vcState |= pressedRaw & ~_vcState;
+    }
+
+    uint32_t changed = (pressedRaw ^ _vcState) & SCAN_MASK;
+
+    // 不同的位计数器递减，相同的位复位为3
+    _vcCount0 = ~(_vcCount0 & changed);
+    _vcCount1 = _vcCount0 ^ (_vcCount1 & changed);
+
+    // 计数器回绕（连续4次不同）的位翻转状态
+    uint32_t toggle = changed & _vcCount0 & _vcCount1;
+    _vcState ^= toggle;
+
+    return _vcState;
+}
+
+void IRAM_ATTR KeypadControl::checkKeyStates(uint32_t buttonState) {
+    _pressedKeyCount = 0;
+    
+    KEYPAD_LOG_V("检查按键状态: 0x%06X", buttonState);
+    
+    uint32_t newPressed = rawToKeyMask(~buttonState & SCAN_MASK);
+    uint32_t changed = newPressed ^ _pressedMask;
+    _pressedMask = newPressed;
+    if (changed) {
+        LATENCY_MARK(LATENCY_POINT_SCAN);
+    }
+    
+    // 只遍历状态发生变化的按键，按编号从小到大发出事件
+    uint32_t currentTime = millis();
+    while (changed) {
+        uint8_t i = __builtin_ctz(changed);
+        changed &= changed - 1;
+        
+        if (newPressed & (1UL << i)) {
+            _pressTime[i] = currentTime;
+            _longPressedMask &= ~(1UL << i);
+            // 新按下的键接管自动重复，不重复的键则停止之前的重复
+            if (_autoRepeatMask & (1UL << i)) {
+                _repeatKey = i + 1;
+                _repeatStart = currentTime;
+                _nextRepeat = currentTime + _repeatDelay;
+            } else {
+                _repeatKey = 0;
+            }
+            _keyStats.onPress(i, currentTime);
+            _chords.onKey(KEY_EVENT_PRESS, i + 1, currentTime);
+        } else {
+            _longPressedMask &= ~(1UL << i);
+            if (_repeatKey == i + 1) {
+                _repeatKey = 0;
+            }
+            _keyStats.onRelease(i, currentTime, currentTime - _pressTime[i]);
+            _chords.onKey(KEY_EVENT_RELEASE, i + 1, currentTime);
+        }
+    }
+    
+    // 当前按下键列表（用于多键组合检测）
+    uint32_t held = newPressed;
+    while (held && _pressedKeyCount < 22) {
+        uint8_t i = __builtin_ctz(held);
+        held &= held - 1;
+        _pressedKeys[_pressedKeyCount++] = i + 1;
+    }
+}
+
+uint32_t IRAM_ATTR KeypadControl::rawToKeyMask(uint32_t pressedRaw) const {
+    uint32_t mask = 0;
+    while (pressedRaw) {
+        uint8_t bit = __builtin_ctz(pressedRaw);
+        pressedRaw &= pressedRaw - 1;
+        if (bit < 24 && _rawBitToKey[bit]) {
+            mask |= 1UL << (_rawBitToKey[bit] - 1);
+        }
+    }
+    return mask;
+}
+
+void IRAM_ATTR KeypadControl::updateKeyStates() {
+    // 只检查按住且尚未触发长按的按键，空闲时不做任何遍历；自动重复的键以重复代替长按
+    uint32_t pending = _pressedMask & ~_longPressedMask & ~_autoRepeatMask;
+    if (!pending) return;
+    
+    uint32_t currentTime = millis();
+    while (pending) {
+        uint8_t i = __builtin_ctz(pending);
+        pending &= pending - 1;
+        
+        if (currentTime - _pressTime[i] >= _longPressDelay) {
+            _longPressedMask |= 1UL << i;
+            _chords.onKey(KEY_EVENT_LONGPRESS, i + 1, currentTime);
+        }
+    }
+}
+
+bool KeypadControl::registerChord(const uint8_t* keys, uint8_t count, uint8_t chordId) {
+    if (_chords.add(keys, count, chordId)) return true;
+    KEYPAD_LOG_W("组合键 %u 无效或组合键表已满", chordId);
+    return false;
+}
+
+uint8_t KeypadControl::findChord(uint32_t keyMask) const {
+    return _chords.find(keyMask);
+}
+
+void IRAM_ATTR KeypadControl::chordEntry(KeyEventType type, uint8_t key, const uint8_t* combo, uint8_t count, void* context) {
+    static_cast<KeypadControl*>(context)->emitKeyEvent(type, key, combo, count);
+}
+
+void IRAM_ATTR KeypadControl::updateAutoRepeat(uint32_t currentTime) {
+    // 只有最后按下的一个键重复，没到下次重复时刻时只做一次比较
+    if (!_repeatKey || (int32_t)(currentTime - _nextRepeat) < 0) return;
+    if (!(_autoRepeatMask & (1UL << (_repeatKey - 1)))) {
+        // 层或方案切换后该键不再重复
+        _repeatKey = 0;
+        return;
+    }
+    
+    _chords.onKey(KEY_EVENT_REPEAT, _repeatKey, currentTime);
+    
+    // 按住越久间隔越短：每KEYPAD_REPEAT_ACCEL_MS减半，最短KEYPAD_REPEAT_MIN_MS
+    uint32_t steps = (currentTime - _repeatStart - _repeatDelay) / KEYPAD_REPEAT_ACCEL_MS;
+    uint32_t interval = steps < 16 ? (uint32_t)_repeatRate >> steps : 0;
+    if (interval < KEYPAD_REPEAT_MIN_MS) {
+        interval = KEYPAD_REPEAT_MIN_MS;
+    }
+    _nextRepeat = currentTime + interval;
+}
+
+void IRAM_ATTR KeypadControl::emitKeyEvent(KeyEventType type, uint8_t key, const uint8_t* combo, uint8_t count) {
+    KeyEvent event;
+    event.type = type;
+    event.key = key;
+    event.timestamp = _scanTimestamp;
+    event.flags = 0;
+    event.count = (combo && count <= sizeof(event.combo)) ? count : 0;
+    if (event.count) {
+        memcpy(event.combo, combo, event.count);
+    }
+
+    if (!_scanTask) {
+        dispatchKeyEvent(event);
+        return;
+    }
+
+    // 直通模式：按下/释放直接交给sink，不唤醒主循环
+    PassThroughSink sink = _passThrough;
+    if (sink && type != KEY_EVENT_COMBO) {
+        if (type == KEY_EVENT_PRESS || type == KEY_EVENT_RELEASE) {
+            sink(key, type == KEY_EVENT_PRESS, _scanTimestamp, _passThroughContext);
+        }
+        return;
+    }
+
+    if (!_eventQueue.push(event)) {
+        _droppedEvents++;
+    }
+    LoopScheduler::instance().wake();
+}
+
+bool KeypadControl::setPassThrough(PassThroughSink sink, void* context) {
+    if (sink && !_scanTask) {
+        return false;
+    }
+    // 先写上下文再写sink，扫描任务读到sink时上下文已经有效
+    _passThroughContext = context;
+    _passThrough = sink;
+    return true;
+}
+
+void KeypadControl::dispatchKeyEvent(const KeyEvent& event) {
+    uint8_t key = event.key;
+    
+    // 使用日志系统输出按键事件
+    switch (event.type) {
+        case KEY_EVENT_PRESS:
+            KEYPAD_LOG_I("按键 %d 被按下", key);
+            break;
+        case KEY_EVENT_RELEASE:
+            KEYPAD_LOG_I("按键 %d 被释放", key);
+            break;
+        case KEY_EVENT_LONGPRESS:
+            KEYPAD_LOG_I("按键 %d 长按", key);
+            break;
+        case KEY_EVENT_REPEAT:
+            KEYPAD_LOG_D("按键 %d 重复", key);
+            break;
+        case KEY_EVENT_COMBO:
+            KEYPAD_LOG_I("按键 %d 组合键", key);
+            break;
+        default:
+            KEYPAD_LOG_W("按键 %d 未知事件", key);
+            break;
+    }
+    
+    // HID最先，其次蜂鸣器和LED反馈，计算器等推迟到update()末尾的flush()
+    KeyEventBus::instance().publish(event);
+}
+
+void KeypadControl::feedbackEntry(const KeyEvent& event, void* context) {
+    static_cast<KeypadControl*>(context)->handleKeyEvent(event);
+}
+
+void KeypadControl::handleKeyEvent(const KeyEvent& event) {
+    KeyEventType type = event.type;
+    uint8_t key = event.key;
+    
+    // 蜂鸣器反馈
+    if (_buzzerConfig.followKeypress) {
+        uint16_t freq = _buzzerConfig.pressFreq;  // 默认频率
+        
+        // 根据蜂鸣器模式选择频率
+        if (_buzzerConfig.mode == BUZZER_MODE_PIANO && key >= 1 && key <= 22) {
+            freq = PIANO_TONES[key - 1];  // 使用钢琴音调
+        }
+        
+        bool buzzed = true;
+        switch (type) {
+            case KEY_EVENT_PRESS:
+                keyClick(false, freq, _buzzerConfig.duration);
+                break;
+                
+            case KEY_EVENT_RELEASE:
+                if (_buzzerConfig.dualTone) {
+                    uint16_t releaseFreq = (_buzzerConfig.mode == BUZZER_MODE_PIANO && key >= 1 && key <= 22) 
+                                         ? PIANO_TONES[key - 1] * 0.8  // 钢琴模式下释放音调略低
+                                         : _buzzerConfig.releaseFreq;
+                    keyClick(true, releaseFreq, _buzzerConfig.duration);
+                } else {
+                    buzzed = false;
+                }
+                break;
+                
+            case KEY_EVENT_LONGPRESS:
+                startBuzzer(freq * 1.2, _buzzerConfig.duration * 1.5);  // 长按音调略高
+                break;
+                
+            case KEY_EVENT_REPEAT:
+                keyClick(false, freq, _buzzerConfig.duration / 2);
+                break;
+                
+            default:
+                buzzed = false;
+                break;
+        }
+        
+        if (_perfMonitor && buzzed && isBuzzerPlaying()) {
+            _perfMonitor->recordStage(PERF_STAGE_BUZZER, (uint32_t)(esp_timer_get_time() - event.timestamp));
+        }
+    }
+    
+    // LED反馈
+    if (_keyFeedback[key - 1].enabled) {
+        if (_keyFeedback[key - 1].ledMode != LED_INSTANT) {
+            handleLEDEffect(LedLayout::instance().keyToLed(key - 1), _keyFeedback[key - 1].ledMode,
+                          _keyFeedback[key - 1].color);
+            if (_perfMonitor) {
+                _perfMonitor->recordStage(PERF_STAGE_LED, (uint32_t)(esp_timer_get_time() - event.timestamp));
+            }
+        }
+    }
+    if (type == KEY_EVENT_PRESS) {
+        SpatialEffects::instance().onKeyPress(LedLayout::instance().keyToLed(key - 1), _keyFeedback[key - 1].color);
+        LoopScheduler::instance().after(0);
+    }
+}
+
+void KeypadControl::configureBuzzer(const BuzzerConfig& config) {
+    _buzzerConfig = config;
+}
+
+void KeypadControl::setBuzzerVolume(uint8_t volume) {
+    _buzzerConfig.volume = volume > BUZZER_MAX ? BUZZER_MAX : volume;
+}
+
+void KeypadControl::setBuzzerFollowKey(bool enable, bool dualTone) {
+    _buzzerConfig.followKeypress = enable;
+    _buzzerConfig.dualTone = dualTone;
+}
+
+void KeypadControl::setBuzzerMode(BuzzerMode mode) {
+    _buzzerConfig.mode = mode;
+    KEYPAD_LOG_I("蜂鸣器模式设置为: %s", (mode == BUZZER_MODE_PIANO) ? "钢琴模式" : "普通模式");
+}
+
+uint16_t KeypadControl::getVolumeDuty(uint8_t volume) {
+    // 无源蜂鸣器在50%占空比时最响；按音量的平方取占空比，听感上接近均匀
+    // 旧版低/中/高三档（10位分辨率下85/127/255）对应音量40/50/70
+    if (volume > BUZZER_MAX) volume = BUZZER_MAX;
+    return (uint16_t)((uint32_t)BuzzerSequencer::MAX_DUTY * volume * volume / (BUZZER_MAX * BUZZER_MAX));
+}
+
+void KeypadControl::startBuzzer(uint16_t freq, uint16_t duration) {
+    if (!_buzzerConfig.enabled) return;
+
+#if AUDIO_PDM_ENABLED
+    AudioOutput::instance().playTone(freq, duration, _buzzerConfig.volume);
+    return;
+#endif
+    // 音长由定时器控制，不需要主循环停止
+    uint16_t duty = getVolumeDuty(_buzzerConfig.volume);
+    BuzzerSequencer::instance().play(freq, duration, duty);
+    
+    KEYPAD_LOG_D("蜂鸣器启动: 频率=%d Hz, 持续时间=%d ms, 占空比=%d", freq, duration, duty);
+}
+
+void KeypadControl::keyClick(bool release, uint16_t freq, uint16_t duration) {
+#if AUDIO_PDM_ENABLED
+    // 普通模式用采样（不再按pressFreq/releaseFreq发方波），钢琴模式仍按音阶放音
+    if (_buzzerConfig.mode != BUZZER_MODE_PIANO) {
+        if (!_buzzerConfig.enabled) return;
+        AudioOutput::instance().playSample(release ? AUDIO_SAMPLE_RELEASE : AUDIO_SAMPLE_CLICK,
+                                           _buzzerConfig.volume);
+        return;
+    }
+#endif
+    (void)release;
+    startBuzzer(freq, duration);
+}
+
+void KeypadControl::playTone(BuzzerTone tone) {
+    if (!_buzzerConfig.enabled) return;
+#if AUDIO_PDM_ENABLED
+    AudioOutput::instance().playSample(tone == BUZZER_TONE_ERROR ? AUDIO_SAMPLE_ERROR : AUDIO_SAMPLE_CONFIRM,
+                                       _buzzerConfig.volume);
+#else
+    BuzzerSequencer::instance().playTone(tone, getVolumeDuty(_buzzerConfig.volume));
+#endif
+}
+
+bool KeypadControl::isBuzzerPlaying() const {
+#if AUDIO_PDM_ENABLED
+    return AudioOutput::instance().isPlaying();
+#else
+    return BuzzerSequencer::instance().isPlaying();
+#endif
+}
+
+void KeypadControl::stopBuzzer() {
+#if AUDIO_PDM_ENABLED
+    AudioOutput::instance().stop();
+#else
+    BuzzerSequencer::instance().stop();
+#endif
+}
+
+void KeypadControl::playPianoScale(uint16_t noteMs, uint16_t gapMs) {
+    if (!_buzzerConfig.enabled) return;
+
+#if AUDIO_PDM_ENABLED
+    AudioOutput& audio = AudioOutput::instance();
+    audio.playTone(PIANO_TONES[0], noteMs, _buzzerConfig.volume);
+    audio.enqueueTone(0, gapMs, 0);
+    for (uint8_t i = 1; i < 22; i++) {
+        audio.enqueueTone(PIANO_TONES[i], noteMs, _buzzerConfig.volume);
+        audio.enqueueTone(0, gapMs, 0);
+    }
+    return;
+#endif
+    uint16_t duty = getVolumeDuty(_buzzerConfig.volume);
+    BuzzerNote notes[44];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < 22; i++) {
+        notes[count++] = {PIANO_TONES[i], noteMs, duty};
+        notes[count++] = {0, gapMs, 0};
+    }
+    BuzzerSequencer::instance().play(notes, count);
+}
+
+void KeypadControl::handleLEDEffect(uint8_t ledIndex, LEDMode mode, CRGB color) {
+    if (ledIndex >= NUM_LEDS) return;
+    
+    setLayerEffect(LED_LAYER_KEY, ledIndex, mode, color);
+    
+    // 立即输出效果的第一帧
+    leds[ledIndex] = composeLED(ledIndex, millis());
+    LedOutput::instance().requestShow();
+}
+
+void KeypadControl::setLayerEffect(LEDLayer layer, uint8_t ledIndex, LEDMode mode, CRGB color) {
+    if (layer >= LED_LAYER_COUNT || ledIndex >= NUM_LEDS) return;
+    
+    LEDEffect& effect = _ledEffects[layer][ledIndex];
+    effect.active = true;
+    effect.startTime = millis();
+    effect.mode = mode;
+    effect.color = color;
+    _ledLayersChanged = true;
+    LoopScheduler::instance().after(0);
+}
+
+void KeypadControl::setLayerEffectAll(LEDLayer layer, LEDMode mode, CRGB color) {
+    for (uint8_t i = 0; i < NUM_LEDS; i++) {
+        setLayerEffect(layer, i, mode, color);
+    }
+}
+
+void KeypadControl::clearLayer(LEDLayer layer) {
+    if (layer >= LED_LAYER_COUNT) return;
+    
+    for (uint8_t i = 0; i < NUM_LEDS; i++) {
+        _ledEffects[layer][i].active = false;
+    }
+    _ledLayersChanged = true;
+    LoopScheduler::instance().after(0);
+}
+
+CRGB KeypadControl::composeLED(uint8_t ledIndex, uint32_t currentTime) {
+    CRGB out = _field[ledIndex];
+    
+    // 从底层到顶层，每层的亮度作为透明度混合到下层结果上
+    for (uint8_t layer = 0; layer < LED_LAYER_COUNT; layer++) {
+        LEDEffect& effect = _ledEffects[layer][ledIndex];
+        if (!effect.active) continue;
+        
+        const LEDEffectDef& def = LED_EFFECTS[effect.mode];
+        uint32_t elapsed = currentTime - effect.startTime;
+        
+        if (!def.loop && elapsed >= def.durationMs) {
+            effect.active = false;
+            _ledLayersChanged = true;
+            continue;
+        }
+        
+        // 周期内相位转为16位定点
+        uint16_t phase = (uint16_t)(((elapsed % def.durationMs) << 16) / def.durationMs);
+        nblend(out, effect.color, effectLevel(def, phase));
+    }
+    
+    return out;
+}
+
+uint8_t KeypadControl::effectLevel(const LEDEffectDef& def, uint16_t phase) {
+    // 找到相位所在的关键帧区间
+    uint8_t k = 1;
+    while (k < def.frameCount - 1 && phase > def.frames[k].at) {
+        k++;
+    }
+    const LEDKeyframe& a = def.frames[k - 1];
+    const LEDKeyframe& b = def.frames[k];
+    
+    uint16_t span = b.at - a.at;
+    if (span == 0) return b.level;
+    
+    // 区间内位置转为8位比例
+    fract8 frac = (uint8_t)(((uint32_t)(phase - a.at) * 255) / span);
+    if (def.eased) {
+        frac = ease8InOutQuad(frac);
+    }
+    return lerp8by8(a.level, b.level, frac);
+}
+
+void KeypadControl::updateLEDEffects() {
+    // 上一帧还没发出时不合成，这期间合成的帧会和下一帧合并推送；发送完成后推送任务唤醒主循环
+    LedOutput& output = LedOutput::instance();
+    if (output.isBusy()) {
+        output.wakeWhenDone();
+        LoopScheduler::instance().after(LED_FRAME_MS);
+        return;
+    }
+
+    uint32_t currentTime = millis();
+    bool needUpdate = _ledLayersChanged;
+    _ledLayersChanged = false;
+
+    // 空间效果作为底色；最后一帧有输出后还要再合成一次把它清掉
+    bool fieldActive = SpatialEffects::instance().render(currentTime, _field);
+    needUpdate |= fieldActive || _fieldActive;
+    _fieldActive = fieldActive;
+
+    // 找出有活动图层的LED，没有任何效果时不做合成
+    bool ledActive[NUM_LEDS];
+    bool animating = false;
+    for (int i = 0; i < NUM_LEDS; i++) {
+        ledActive[i] = false;
+        for (uint8_t layer = 0; layer < LED_LAYER_COUNT; layer++) {
+            const LEDEffect& effect = _ledEffects[layer][i];
+            ledActive[i] |= effect.active;
+            animating |= effect.active && effect.mode != LED_SOLID;
+        }
+        ledActive[i] |= fieldActive;
+        needUpdate |= ledActive[i];
+    }
+    if (!needUpdate) return;
+    
+    // 常亮效果只在图层变化时合成一次，动画效果每帧合成
+    if (animating || fieldActive) {
+        LoopScheduler::instance().after(LED_FRAME_MS);
+    }
+
+    // 一次遍历合成全部LED，效果结束后该LED回落到下层或熄灭
+    for (int i = 0; i < NUM_LEDS; i++) {
+        leds[i] = ledActive[i] ? composeLED(i, currentTime) : CRGB(CRGB::Black);
+    }
+
+    output.requestShow();
+}
+
+// 其他基本功能实现
+void KeypadControl::enableAutoRepeat(uint8_t key, bool enable) {
+    if (key > 0 && key <= 22) {
+        if (enable) {
+            _autoRepeatMask |= 1UL << (key - 1);
+        } else {
+            _autoRepeatMask &= ~(1UL << (key - 1));
+        }
+    }
+}
+
+bool KeypadControl::isKeyPressed(uint8_t key) const {
+    if (key > 0 && key <= 22) {
+        return _pressedMask & (1UL << (key - 1));
+    }
+    return false;
+}
+
+bool KeypadControl::isKeyLongPressed(uint8_t key) const {
+    if (key > 0 && key <= 22) {
+        return _longPressedMask & (1UL << (key - 1));
+    }
+    return false;
+}
+
+void KeypadControl::setKeyFeedback(uint8_t keyNumber, const KeyFeedback& feedback) {
+    if (keyNumber > 0 && keyNumber <= 22) {
+        _keyFeedback[keyNumber - 1] = feedback;
+    }
+}
+
+void KeypadControl::setKeyColor(uint8_t keyNumber, CRGB color) {
+    if (keyNumber > 0 && keyNumber <= 22) {
+        _keyFeedback[keyNumber - 1].color = color;
+    }
+}
+
+void KeypadControl::setGlobalBrightness(uint8_t brightness) {
+    _globalBrightness = brightness;
+    FastLED.setBrightness(_globalBrightness);
+    LedOutput::instance().requestShow();
+}
+
+uint32_t IRAM_ATTR KeypadControl::readShiftRegisters() {
+    PROFILE_SCOPE(PROFILE_KEY_SCAN);
+    if (!_scanSPI) {
+        return readShiftRegistersGPIO();
+    }
+
+    // 锁存数据（两次GPIO写入之间已远超165的最小脉宽）
+    digitalWrite(SCAN_PL_PIN, LOW);
+    digitalWrite(SCAN_PL_PIN, HIGH);
+
+    // 一次事务读取24位，高位先出，与逐位读取的位序一致
+    uint8_t buf[3] = {0, 0, 0};
+    _scanSPI->beginTransaction(SPISettings(KEYPAD_SCAN_SPI_FREQ, MSBFIRST, SPI_MODE0));
+    _scanSPI->transferBytes(buf, buf, sizeof(buf));
+    _scanSPI->endTransaction();
+
+    return ((uint32_t)buf[0] << 16) | ((uint32_t)buf[1] << 8) | buf[2];
+}
+
+uint32_t KeypadControl::readShiftRegistersGPIO() {
+    uint32_t result = 0;
+
+    // 锁存数据
+    digitalWrite(SCAN_PL_PIN, LOW);   
+    delayMicroseconds(5);
+    digitalWrite(SCAN_PL_PIN, HIGH);  
+
+    // 读取24位数据
+    for (uint8_t i = 0; i < 24; i++) {
+        result <<= 1;
+        if (digitalRead(SCAN_MISO_PIN)) {
+            result |= 1;
+        }
+        digitalWrite(SCAN_CLK_PIN, HIGH);
+        delayMicroseconds(5);
+        digitalWrite(SCAN_CLK_PIN, LOW);
+        delayMicroseconds(5);
+    }
+
+    return result;
+}
+
+uint8_t KeypadControl::getPressedKeys(uint8_t* keyBuffer, uint8_t bufferSize) const {
+    uint8_t count = min(bufferSize, _pressedKeyCount);
+    if (count > 0 && keyBuffer != nullptr) {
+        memcpy(keyBuffer, _pressedKeys, count);
+    }
+    return count;
+}
+
+#ifdef DEBUG_MODE
+void KeypadControl::testAllBits() {
+    Serial.println(F("=== 测试所有 24 位 ==="));
+    uint32_t state = readShiftRegisters();
+    Serial.print(F("原始寄存器状态: 0x"));
+    Serial.println(state, HEX);
+    
+    for (int bit = 0; bit < 24; bit++) {
+        bool bitState = !(state & (1UL << bit));  // 按键按下时为低电平
+        if (bitState) {
+            Serial.print(F("位 "));
+            Serial.print(bit);
+            Serial.println(F(" 激活 (按下)"));
+        }
+    }
+    Serial.println(F("=== 测试结束 ==="));
+}
+
+void KeypadControl::printDebugInfo() {
+    Serial.println(F("键盘控制调试信息:"));
+    Serial.print(F("当前状态: 0x"));
+    Serial.println(_currentState, HEX);
+    Serial.print(F("按下的按键: "));
+    for (uint8_t i = 0; i < _pressedKeyCount; i++) {
+        Serial.print(_pressedKeys[i]);
+        Serial.print(" ");
+    }
+    Serial.println();
+    
+    Serial.println(F("活跃的LED效果:"));
+    for (uint8_t layer = 0; layer < LED_LAYER_COUNT; layer++) {
+        for (uint8_t i = 0; i < NUM_LEDS; i++) {
+            if (_ledEffects[layer][i].active) {
+                Serial.print(F("图层 "));
+                Serial.print(layer);
+                Serial.print(F(" LED "));
+                Serial.print(i);
+                Serial.print(F(": 模式="));
+                Serial.print(_ledEffects[layer][i].mode);
+                Serial.println();
+            }
+        }
+    }
+
+    Serial.println(F("蜂鸣器配置:"));
+    Serial.print(F("启用: "));
+    Serial.println(_buzzerConfig.enabled);
+    Serial.print(F("跟随按键: "));
+    Serial.println(_buzzerConfig.followKeypress);
+    Serial.print(F("双音调: "));
+    Serial.println(_buzzerConfig.dualTone);
+    Serial.print(F("音量: "));
+    Serial.println(_buzzerConfig.volume);
+}
 #endif
\ No newline at end of file
@@ -18,7 +18,17 @@
 #define KEYPAD_CONTROL_H
 
 #include <Arduino.h>
+#include <SPI.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "config.h"
+#include "SpscQueue.h"
+#include "PowerManager.h"
+#include "BuzzerSequencer.h"
+#include "AudioOutput.h"
+#include "KeyStats.h"
+#include "KeyEventBus.h"
+#include "ChordFilter.h"
 
 /**
  * @brief LED效果模式枚举
@@ -27,28 +37,32 @@ enum LEDMode {
     LED_INSTANT,    ///< 立即亮起立即熄灭
     LED_FADE,       ///< 渐变效果
     LED_BREATH,     ///< 呼吸效果
-    LED_BLINK       ///< 闪烁效果
+    LED_BLINK,      ///< 闪烁效果
+    LED_SOLID,      ///< 常亮（直到清除所在图层）
+    LED_PULSE       ///< 渐亮再渐灭一次（启动提示）
 };
 
 /**
- * @brief 按键事件类型枚举
+ * @brief LED效果图层，按从下到上的顺序合成
  */
-enum KeyEventType {
-    KEY_EVENT_PRESS,      ///< 按键按下
-    KEY_EVENT_RELEASE,    ///< 按键释放
-    KEY_EVENT_LONGPRESS,  ///< 长按
-    KEY_EVENT_REPEAT,     ///< 自动重复
-    KEY_EVENT_COMBO       ///< 组合键
+enum LEDLayer {
+    LED_LAYER_AMBIENT,  ///< 底层环境光
+    LED_LAYER_HOST,     ///< 主机锁定状态（NumLock、CapsLock）
+    LED_LAYER_KEY,      ///< 按键反馈
+    LED_LAYER_ERROR,    ///< 错误闪烁
+    LED_LAYER_SLEEP,    ///< 休眠呼吸
+    LED_LAYER_COUNT
 };
 
 /**
- * @brief 蜂鸣器音量等级枚举
+ * @brief 蜂鸣器常用音量（音量为0-100，这些值对应旧版的四档）
  */
 enum BuzzerVolume {
     BUZZER_MUTE = 0,     ///< 静音
-    BUZZER_LOW = 1,      ///< 低音量
-    BUZZER_MEDIUM = 2,   ///< 中等音量
-    BUZZER_HIGH = 3      ///< 高音量
+    BUZZER_LOW = 40,     ///< 低音量
+    BUZZER_MEDIUM = 50,  ///< 中等音量
+    BUZZER_HIGH = 70,    ///< 高音量
+    BUZZER_MAX = 100     ///< 最大音量（50%占空比）
 };
 
 /**
@@ -78,25 +92,29 @@ struct BuzzerConfig {
     bool followKeypress;     ///< 是否跟随按键
     bool dualTone;          ///< 是否使用双音效（按下/释放不同音调）
     BuzzerMode mode;        ///< 蜂鸣器模式
-    BuzzerVolume volume;    ///< 音量等级
+    uint8_t volume;         ///< 音量（0-100）
     uint16_t pressFreq;     ///< 按下音调频率（普通模式）
     uint16_t releaseFreq;   ///< 释放音调频率（仅在dualTone为true时使用）
     uint16_t duration;      ///< 蜂鸣持续时间
 };
 
-/**
- * @brief 按键事件回调函数类型
- */
-typedef void (*KeyEventCallback)(KeyEventType type, uint8_t key, uint8_t* combo, uint8_t count);
-
 /**
  * @brief 键盘控制类
  */
 // 前向声明
-class SimpleHID;
+class PerformanceMonitor;
 
 class KeypadControl {
 public:
+    /**
+     * @brief 扫描档位，按最后一次按键活动以来的时间逐级降低
+     */
+    enum ScanRate : uint8_t {
+        SCAN_RATE_FAST,     ///< 有键按住或刚有按键：按startScanTask()的频率扫描（轮询模式为UPDATE_INTERVAL）
+        SCAN_RATE_RELAXED,  ///< 安静超过KEYPAD_FAST_HOLD_MS：MISO下降沿中断唤醒，按KEYPAD_RELAXED_POLL_MS兜底扫描
+        SCAN_RATE_IDLE      ///< 安静超过空闲超时：兜底扫描降到KEYPAD_IDLE_POLL_MS，允许浅睡眠
+    };
+
     /**
      * @brief 构造函数
      */
@@ -109,15 +127,138 @@ public:
 
     /**
      * @brief 更新键盘状态
-     * @details 需要在主循环中定期调用此函数以更新按键状态、LED效果和蜂鸣器
+     * @details 需要在主循环中定期调用此函数以更新按键状态、LED效果和蜂鸣器。
+     *          扫描任务模式下只分发队列中的按键事件，应在每次loop中调用
      */
     void update();
 
     /**
-     * @brief 设置按键事件回调函数
-     * @param callback 回调函数指针
+     * @brief 启动定时扫描任务
+     * @param rateHz 扫描频率
+     * @param priority 任务优先级
+     * @param core 任务所在核心
+     * @return 任务创建成功返回true
+     * @details 扫描、去抖和事件检测移到独立任务中按固定周期执行，
+     *          事件经单生产者单消费者队列交给update()在主循环中分发
+     */
+    bool startScanTask(uint16_t rateHz, UBaseType_t priority, BaseType_t core);
+
+    /**
+     * @brief 设置按下沿立即上报
+     * @param enable true时按下不等待去抖立即生效，只对释放去抖
+     */
+    void setEagerPress(bool enable) { _eagerPress = enable; }
+
+    /**
+     * @brief 设置空闲超时
+     * @param timeoutMs 无按键活动超过此时间进入空闲模式，0表示禁用降频和空闲模式
+     */
+    void setIdleTimeout(uint32_t timeoutMs) { _idleTimeoutMs = timeoutMs; }
+
+    /**
+     * @brief 当前扫描档位
+     * @details 降频和空闲档下PL保持低电平（165持续并行加载），MISO下降沿中断唤醒扫描；
+     *          串行输出只反映链上最后一级的输入，其余按键靠低频兜底扫描发现，
+     *          因此不会漏掉首次按键。发现按键立即回到高频档
+     */
+    ScanRate getScanRate() const { return _scanRate; }
+
+    /**
+     * @brief 是否处于空闲模式（SCAN_RATE_IDLE）
+     */
+    bool isIdle() const { return _scanRate == SCAN_RATE_IDLE; }
+
+    /**
+     * @brief 准备浅睡眠：把MISO的下降沿中断换成低电平唤醒源；ULP可用时改为交给ULP扫描整条链
+     * @return 空闲、无按键按下且MISO为高时返回true，之后必须调用finishLightSleep()
+     */
+    bool prepareLightSleep();
+
+    /**
+     * @brief 浅睡眠结束：恢复下降沿中断并立即扫描一次
+     * @details 睡眠期间的边沿不会触发中断，唤醒的那次按键靠这次扫描发现；
+     *          ULP唤醒时它记下的按下直接计入去抖状态，醒来前已松开的短按也不会丢
+     */
+    void finishLightSleep();
+
+    /**
+     * @brief 准备深度睡眠：保持PL为低，睡眠期间MISO直接反映最后一级的按键，作为ext1唤醒源；
+     *        ULP可用时改为交给ULP扫描，启动时begin()取回唤醒的按键
+     * @return 空闲、无按键按下且MISO为高时返回true；之后不返回（唤醒即重启）
+     */
+    bool prepareDeepSleep();
+
+    /**
+     * @brief 按键唤醒的通知（扫描任务或浅睡眠醒来时的主循环中调用，早于扫描和去抖）
+     * @details 只在空闲模式下最后一级的按键拉低MISO时调用，定时唤醒和兜底扫描不调用
+     */
+    typedef void (*WakeHook)(void* context);
+    void setWakeHook(WakeHook hook, void* context) {
+        _wakeContext = context;
+        _wakeHook = hook;
+    }
+
+    /**
+     * @brief 直通模式：按下/释放在扫描任务中直接交给sink，不进入事件队列
+     * @details 长按和自动重复丢弃，组合键仍进入队列（用于在主循环中退出直通模式）；
+     *          按键统计照常更新，按键灯和蜂鸣器反馈不再触发。sink为nullptr时恢复正常分发
+     * @return 没有扫描任务（主循环轮询）时返回false
+     */
+    typedef void (*PassThroughSink)(uint8_t key, bool pressed, int64_t timestamp, void* context);
+    bool setPassThrough(PassThroughSink sink, void* context);
+    bool isPassThrough() const { return _passThrough != nullptr; }
+
+    /**
+     * @brief 复制按键健康统计（任意任务，计数可能与扫描同时更新）
+     */
+    void getKeyStats(KeyStatsData& data) const { _keyStats.snapshot(data); }
+
+    /**
+     * @brief 载入保存的按键健康统计
+     * @return 数据版本或按键数不符时返回false
+     */
+    bool restoreKeyStats(const KeyStatsData& data) { return _keyStats.restore(data); }
+
+    /**
+     * @brief 清空按键健康统计
+     */
+    void resetKeyStats() { _keyStats.reset(); }
+
+    /**
+     * @brief 因队列满而丢弃的事件数
+     */
+    uint32_t getDroppedEventCount() const { return _droppedEvents; }
+
+    /**
+     * @brief 测量一次扫描中读取和检查按键的CPU周期（基准测试用）
+     * @param readCycles 读取移位寄存器
+     * @param checkCycles 按当前去抖状态检查按键（状态不变，不产生事件）
+     * @details 扫描任务运行时由任务在两次扫描之间测量，不与其争用SPI
+     */
+    void measureScan(uint32_t& readCycles, uint32_t& checkCycles);
+
+    /**
+     * @brief 设置组合键窗口
+     * @param windowMs 第一个键按下后，此时间内按下的键归入同一组合
+     */
+    void setChordWindow(uint16_t windowMs) { _chords.setWindow(windowMs); }
+
+    /**
+     * @brief 注册组合键
+     * @param keys 组合内的按键编号（1-22），keys[0]为修饰键：组合从它开始时成员键的事件暂缓到组合确定
+     * @param count 按键数量（2-5）
+     * @param chordId 组合ID（非0），通过组合键事件的key参数上报
+     * @return 注册成功返回true；表已满或参数无效返回false
+     * @details 相同按键集合重复注册时覆盖原来的ID
+     */
+    bool registerChord(const uint8_t* keys, uint8_t count, uint8_t chordId);
+
+    /**
+     * @brief 查找按键集合对应的组合ID
+     * @param keyMask 按键位图，bit i 对应按键 i+1
+     * @return 组合ID，未注册返回0
      */
-    void setKeyEventCallback(KeyEventCallback callback) { _eventCallback = callback; }
+    uint8_t findChord(uint32_t keyMask) const;
 
     /**
      * @brief 启用或禁用按键自动重复
@@ -126,6 +267,12 @@ public:
      */
     void enableAutoRepeat(uint8_t key, bool enable);
 
+    /**
+     * @brief 一次设置全部自动重复的按键（随布局的层和方案切换更新）
+     * @param keyMask 按键位图，bit i 对应按键 i+1
+     */
+    void setAutoRepeatMask(uint32_t keyMask) { _autoRepeatMask = keyMask; }
+
     /**
      * @brief 设置自动重复延迟时间
      * @param delay 延迟时间（毫秒）
@@ -179,11 +326,37 @@ public:
      */
     void setKeyFeedback(uint8_t keyNumber, const KeyFeedback& feedback);
 
+    /**
+     * @brief 只修改按键反馈颜色（换入新布局时）
+     * @param keyNumber 按键编号（1-22）
+     */
+    void setKeyColor(uint8_t keyNumber, CRGB color);
+
     /**
      * @brief 更新LED效果
      */
     void updateLEDEffects();
 
+    /**
+     * @brief 在指定图层上为一个LED启动效果
+     * @param layer 图层
+     * @param ledIndex LED索引（0-21）
+     * @param mode LED模式
+     * @param color LED颜色
+     * @details 每个图层的亮度作为透明度，与下层颜色混合
+     */
+    void setLayerEffect(LEDLayer layer, uint8_t ledIndex, LEDMode mode, CRGB color);
+
+    /**
+     * @brief 在指定图层上为所有LED启动同一效果
+     */
+    void setLayerEffectAll(LEDLayer layer, LEDMode mode, CRGB color);
+
+    /**
+     * @brief 清除一个图层上的全部效果
+     */
+    void clearLayer(LEDLayer layer);
+
     /**
      * @brief 设置全局LED亮度
      * @param brightness 亮度值（0-255）
@@ -198,9 +371,9 @@ public:
 
     /**
      * @brief 设置蜂鸣器音量
-     * @param volume 音量等级
+     * @param volume 音量（0-100，超出按100）
      */
-    void setBuzzerVolume(BuzzerVolume volume);
+    void setBuzzerVolume(uint8_t volume);
 
     /**
      * @brief 设置蜂鸣器是否跟随按键
@@ -222,29 +395,44 @@ public:
     const BuzzerConfig& getBuzzerConfig() const { return _buzzerConfig; }
 
     /**
-     * @brief 设置简单HID处理器
-     * @param hid 简单HID处理器指针
+     * @brief 设置性能监控，记录LED和蜂鸣器反馈相对扫描时刻的延迟
+     * @param monitor 性能监控（nullptr表示不记录）
      */
-    void setSimpleHID(SimpleHID* hid);
+    void setPerformanceMonitor(PerformanceMonitor* monitor) { _perfMonitor = monitor; }
 
     /**
-     * @brief 启用/禁用HID功能
-     * @param enabled true启用，false禁用
+     * @brief 启动蜂鸣器（打断正在播放的声音）
+     * @param freq 频率
+     * @param duration 持续时间
      */
-    void setHIDEnabled(bool enabled);
+    void startBuzzer(uint16_t freq, uint16_t duration);
 
     /**
-     * @brief 检查HID功能是否启用
-     * @return true启用，false禁用
+     * @brief 按键音：I2S后端的普通模式放采样（release为松开音），其余按频率放音
      */
-    bool isHIDEnabled() const { return _hidEnabled; }
+    void keyClick(bool release, uint16_t freq, uint16_t duration);
 
     /**
-     * @brief 启动蜂鸣器（用于测试）
-     * @param freq 频率
-     * @param duration 持续时间
+     * @brief 按当前音量播放预置提示音（蜂鸣器禁用时无效）
      */
-    void startBuzzer(uint16_t freq, uint16_t duration);
+    void playTone(BuzzerTone tone);
+
+    /**
+     * @brief 按当前音量依次播放22个钢琴音阶，不阻塞
+     * @param noteMs 每个音的时长
+     * @param gapMs 音之间的休止
+     */
+    void playPianoScale(uint16_t noteMs, uint16_t gapMs);
+
+    /**
+     * @brief 按键音是否在播放（LEDC和I2S后端都停在浅睡眠中，等放完再睡）
+     */
+    bool isBuzzerPlaying() const;
+
+    /**
+     * @brief 停止按键音和提示音
+     */
+    void stopBuzzer();
 
     #ifdef DEBUG_MODE
     /**
@@ -263,25 +451,30 @@ private:
     struct LEDEffect {
         bool active;            ///< 效果是否激活
         uint32_t startTime;     ///< 效果开始时间
-        uint8_t brightness;     ///< 当前亮度
         LEDMode mode;          ///< LED模式
         CRGB color;            ///< LED颜色
-        uint16_t duration;      ///< 效果持续时间
     };
 
-    // 按键状态结构体
-    struct KeyState {
-        bool pressed;           ///< 当前是否按下
-        bool longPressed;       ///< 是否触发长按
-        bool autoRepeat;        ///< 是否启用自动重复
-        uint32_t pressTime;     ///< 按下时间
-        uint32_t lastRepeat;    ///< 上次重复触发时间
+    // LED效果关键帧：相位位置为16位定点（0-65535对应一个周期）
+    struct LEDKeyframe {
+        uint16_t at;            ///< 相位位置
+        uint8_t level;          ///< 亮度
+    };
+
+    // LED效果定义：按LEDMode索引，新增效果只需添加表项
+    struct LEDEffectDef {
+        uint16_t durationMs;    ///< 周期时长
+        bool loop;              ///< 是否循环（否则结束后熄灭）
+        bool eased;             ///< 关键帧之间是否使用缓动
+        uint8_t frameCount;     ///< 关键帧数量
+        LEDKeyframe frames[4];  ///< 关键帧（相位递增，首帧为0，末帧为65535）
     };
 
     // 常量定义
     static const uint8_t KEY_POSITIONS[22];  ///< 按键位置映射表
     static const uint16_t PIANO_TONES[22];   ///< 钢琴音阶频率表
-    static const uint32_t DEBOUNCE_DELAY = 20;     ///< 去抖延迟(ms)
+    static const LEDEffectDef LED_EFFECTS[5];  ///< LED效果表（按LEDMode索引）
+    static const uint32_t SCAN_MASK = 0xFFFFFF;    ///< 24位扫描有效位
     static const uint32_t UPDATE_INTERVAL = 10;     ///< 更新间隔(ms)
     static const uint32_t DEFAULT_REPEAT_DELAY = 500;  ///< 默认重复延迟
     static const uint32_t DEFAULT_REPEAT_RATE = 100;   ///< 默认重复速率
@@ -289,20 +482,38 @@ private:
 
     // 成员变量
     uint32_t _currentState;     ///< 当前按键状态
-    uint32_t _lastState;        ///< 上一次的按键状态
-    uint32_t _debouncedState;   ///< 去抖后的状态
-    uint32_t _lastDebounceTime; ///< 上次去抖时间
+    uint32_t _debouncedState;   ///< 去抖后的状态（与原始值同为低电平按下）
+
+    // 垂直计数器去抖：每一位对应一个按键，2位计数器分散在两个字中
+    uint32_t _vcState;          ///< 去抖后的按下位图（1=按下）
+    uint32_t _vcCount0;         ///< 计数器低位
+    uint32_t _vcCount1;         ///< 计数器高位
+    bool _eagerPress;           ///< 按下沿立即上报
     uint32_t _lastUpdateTime;   ///< 上次更新时间
     
-    KeyState _keyStates[22];    ///< 按键状态数组
+    // 按键状态位图：bit i 对应按键 i+1
+    uint32_t _pressedMask;      ///< 当前按下的按键
+    uint32_t _longPressedMask;  ///< 已触发长按的按键
+    volatile uint32_t _autoRepeatMask; ///< 启用自动重复的按键（主循环设置，扫描侧读取）
+    uint32_t _pressTime[22];    ///< 按下时间（仅按住的按键有效）
+    uint8_t _repeatKey;         ///< 正在自动重复的按键，0表示没有
+    uint32_t _repeatStart;      ///< 重复键按下的时间
+    uint32_t _nextRepeat;       ///< 下次重复的时刻
+    uint8_t _rawBitToKey[24];   ///< 扫描位 → 按键编号（0表示未使用）
     uint8_t _pressedKeys[22];   ///< 按下的按键数组
     uint8_t _pressedKeyCount;   ///< 按下的按键数量
-    uint8_t _comboBuffer[5];    ///< 组合键缓冲区（最多5个键）
+    uint32_t _lastRawPressed;   ///< 上次扫描的原始按下位图（统计原始边沿）
+    KeyStats _keyStats;         ///< 按键健康统计
+
+    // 组合键检测：按键事件都先经过它，组合的成员键事件暂缓到组合确定
+    ChordFilter _chords;
     
     KeyFeedback _keyFeedback[22]; ///< 每个按键的反馈配置
-    LEDEffect _ledEffects[NUM_LEDS]; ///< LED效果数组
+    LEDEffect _ledEffects[LED_LAYER_COUNT][NUM_LEDS]; ///< 各图层的LED效果
+    bool _ledLayersChanged;     ///< 有图层效果启动或清除，下一帧需要重新合成
+    CRGB _field[NUM_LEDS];      ///< 空间效果输出，作为图层合成的底色
+    bool _fieldActive;          ///< 上一帧空间效果有输出
     
-    KeyEventCallback _eventCallback; ///< 事件回调函数
     
     uint16_t _repeatDelay;      ///< 自动重复延迟
     uint16_t _repeatRate;       ///< 自动重复速率
@@ -310,20 +521,124 @@ private:
     uint8_t _globalBrightness;  ///< 全局LED亮度
 
     BuzzerConfig _buzzerConfig; ///< 蜂鸣器配置
-    bool _buzzerActive;         ///< 蜂鸣器是否正在发声
-    uint32_t _buzzerEndTime;    ///< 蜂鸣器结束时间
 
-    // HID相关成员
-    SimpleHID* _simpleHID;      ///< 简单HID处理器
-    bool _hidEnabled;           ///< HID功能是否启用
+    PerformanceMonitor* _perfMonitor; ///< 反馈延迟统计（可为空）
+
+    // 扫描后端
+    SPIClass* _scanSPI;         ///< 硬件SPI扫描（nullptr表示使用GPIO逐位读取）
+
+    // 扫描任务
+    TaskHandle_t _scanTask;     ///< 扫描任务（nullptr表示主循环轮询）
+    PowerLock _scanLock;        ///< 扫描期间保持最高频率
+    uint32_t _scanPeriodUs;     ///< 扫描周期
+    volatile bool _measurePending; ///< 等待扫描任务执行measureScan
+    uint32_t _measureReadCycles;  ///< 最近一次测量结果
+    uint32_t _measureCheckCycles;
+    SpscQueue<KeyEvent, 32> _eventQueue;  ///< 扫描任务 → 主循环
+    int64_t _scanTimestamp;     ///< 本次扫描的采样时刻(µs)
+    uint32_t _droppedEvents;    ///< 队列满时丢弃的事件数
+
+    // 扫描档位
+    volatile ScanRate _scanRate; ///< 当前档位（扫描任务写入，主循环读取）
+    volatile bool _wakePending; ///< 降频或空闲期间收到唤醒中断
+    volatile uint32_t _wakePressed; ///< ULP唤醒时已去抖的按下位（主循环写入，下一次扫描取走）
+    WakeHook _wakeHook;         ///< 按键唤醒的通知
+    void* _wakeContext;
+    PassThroughSink volatile _passThrough;  ///< 直通模式的接收者，nullptr表示正常分发
+    void* volatile _passThroughContext;
+    uint32_t _idleTimeoutMs;    ///< 空闲超时，0表示禁用降频和空闲模式
+    uint32_t _lastActivityTime; ///< 上次有按键活动的时间
 
     // 内部函数
     /**
      * @brief 读取移位寄存器状态
      * @return 24位按键状态值
+     * @details 优先通过硬件SPI一次读取3字节，未启用SPI时回退到GPIO逐位读取
      */
     uint32_t readShiftRegisters();
 
+    /**
+     * @brief 通过GPIO逐位读取移位寄存器
+     * @return 24位按键状态值
+     */
+    uint32_t readShiftRegistersGPIO();
+
+    /**
+     * @brief 对一次原始采样做逐键去抖
+     * @param pressedRaw 原始按下位图（1=按下）
+     * @return 去抖后的按下位图
+     * @details 每个按键的计数器在采样与当前状态不同时递减，相同时复位，
+     *          连续4次不同才翻转状态；所有按键用位运算并行处理
+     */
+    uint32_t debounce(uint32_t pressedRaw);
+
+    /**
+     * @brief 执行一次扫描、去抖和事件检测
+     * @param currentTime 当前时间(ms)
+     */
+    void scanOnce(uint32_t currentTime);
+
+    /**
+     * @brief 在扫描上下文中测量读取和检查按键的周期数
+     */
+    void measureScanSteps();
+
+    /**
+     * @brief 扫描任务入口
+     */
+    static void scanTaskEntry(void* arg);
+
+    /**
+     * @brief 根据活动时间选择扫描档位
+     * @param currentTime 当前时间(ms)
+     */
+    void updateScanRate(uint32_t currentTime);
+
+    /**
+     * @brief 切换扫描档位，并记入CPU统计的事件记录
+     */
+    void setScanRate(ScanRate rate);
+
+    /**
+     * @brief 降频和空闲档的兜底扫描间隔(ms)
+     */
+    static uint32_t pollInterval(ScanRate rate);
+
+    /**
+     * @brief 档位对应的扫描频率（Hz，兜底扫描按间隔折算）
+     */
+    uint16_t scanRateHz(ScanRate rate) const;
+
+    /**
+     * @brief 离开高频档：PL保持低电平并挂上MISO下降沿中断
+     */
+    void enterIdle();
+
+    /**
+     * @brief 回到高频档：移除中断并恢复PL
+     */
+    void exitIdle();
+
+    /**
+     * @brief MISO下降沿中断：唤醒扫描
+     */
+    static void IRAM_ATTR wakeISR(void* arg);
+
+    /**
+     * @brief 发出按键事件：任务模式下入队，否则直接处理
+     * @param type 事件类型
+     * @param key 按键编号
+     * @param combo 组合键（仅组合键事件）
+     * @param count 组合键数量
+     */
+    void emitKeyEvent(KeyEventType type, uint8_t key, const uint8_t* combo = nullptr, uint8_t count = 0);
+    static void chordEntry(KeyEventType type, uint8_t key, const uint8_t* combo, uint8_t count, void* context);
+
+    /**
+     * @brief 记录日志并把事件交给事件总线
+     */
+    void dispatchKeyEvent(const KeyEvent& event);
+
     /**
      * @brief 检查按键状态变化
      * @param buttonState 当前按键状态
@@ -331,26 +646,28 @@ private:
     void checkKeyStates(uint32_t buttonState);
 
     /**
-     * @brief 更新按键状态
+     * @brief 原始按下位图转换为按键位图
+     * @param pressedRaw 扫描位按下位图（1=按下）
+     * @return 按键位图，bit i 对应按键 i+1
      */
-    void updateKeyStates();
+    uint32_t rawToKeyMask(uint32_t pressedRaw) const;
 
     /**
-     * @brief 处理按键事件
-     * @param type 事件类型
-     * @param key 按键编号
+     * @brief 更新按键状态
      */
-    void handleKeyEvent(KeyEventType type, uint8_t key);
+    void updateKeyStates();
 
     /**
-     * @brief 检查组合键
+     * @brief 按键反馈（蜂鸣器和LED），作为事件总线的订阅者
+     * @param event 按键事件
      */
-    void checkComboKeys();
+    void handleKeyEvent(const KeyEvent& event);
+    static void feedbackEntry(const KeyEvent& event, void* context);
 
     /**
-     * @brief 更新自动重复
+     * @brief 到达下次重复时刻时发出重复事件
      */
-    void updateAutoRepeat();
+    void updateAutoRepeat(uint32_t currentTime);
 
     /**
      * @brief 处理LED效果
@@ -361,16 +678,27 @@ private:
     void handleLEDEffect(uint8_t keyNumber, LEDMode mode, CRGB color);
 
     /**
-     * @brief 获取音量对应的PWM占空比
-     * @param volume 音量等级
-     * @return PWM占空比值
+     * @brief 按关键帧计算效果亮度
+     * @param def 效果定义
+     * @param phase 周期内相位（16位定点）
+     * @return 亮度（0-255）
      */
-    uint8_t getVolumeDuty(BuzzerVolume volume) const;
+    static uint8_t effectLevel(const LEDEffectDef& def, uint16_t phase);
 
     /**
-     * @brief 更新蜂鸣器状态
+     * @brief 合成一个LED所有图层的颜色
+     * @param ledIndex LED索引
+     * @param currentTime 当前时间(ms)
+     * @return 合成后的颜色；已结束的效果在此处停用
+     */
+    CRGB composeLED(uint8_t ledIndex, uint32_t currentTime);
+
+    /**
+     * @brief 获取音量对应的PWM占空比
+     * @param volume 音量（0-100）
+     * @return 10位分辨率下的占空比，最大为50%
      */
-    void updateBuzzer();
+    static uint16_t getVolumeDuty(uint8_t volume);
 };
 
 #endif // KEYPAD_CONTROL_H
\ No newline at end of file
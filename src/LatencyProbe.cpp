@@ -0,0 +1,138 @@
+/**
+ * @file LatencyProbe.cpp
+ * @brief 端到端延迟测试实现
+ *
+ * @author Calculator Project
+ */
+
+#include "LatencyProbe.h"
+#include "Console.h"
+#include "KeyJournal.h"
+#include "LoopScheduler.h"
+#include "Logger.h"
+
+#define TAG_LATENCY "Latency"
+
+namespace {
+
+void printHistogram(const char* name, const PerfHistogram& hist) {
+    Serial.printf("  %-14s min %6lu  avg %6lu  p99 %6lu  max %6lu us\n", name,
+                  (unsigned long)hist.getMin(), (unsigned long)hist.getAvg(),
+                  (unsigned long)hist.getPercentile(990), (unsigned long)hist.getMax());
+}
+
+void cmdLatencyTest(const ConsoleArgs& args) {
+    LatencyProbe& probe = LatencyProbe::instance();
+    long samples = args.count > 1 ? atol(args.arg(1)) : 20;
+    if (samples < 1 || samples > 1000) {
+        Serial.println("用法: latency_test [次数1-1000]");
+    } else if (!probe.startTest((uint16_t)samples)) {
+        Serial.println("延迟测试进行中");
+    } else {
+        Serial.printf("注入 %ld 次按键，间隔 %d ms\n", samples, LATENCY_TEST_INTERVAL_MS);
+    }
+}
+
+constexpr ConsoleCommand LATENCY_COMMANDS[] = {
+    {"latency_test", "[n]", "注入n次合成按键，统计到屏幕推送开始/结束的延迟", cmdLatencyTest},
+};
+static_assert(consoleSorted(LATENCY_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+LatencyProbe::LatencyProbe()
+    : _level(0),
+      _remaining(0),
+      _samples(0),
+      _timeouts(0),
+      _waiting(false),
+      _digitNext(true),
+      _injectedAt(0),
+      _injectedMs(0),
+      _nextInjectMs(0),
+      _baseStart(0),
+      _baseEnd(0) {
+    for (uint8_t i = 0; i < LATENCY_POINT_COUNT; i++) {
+        _time[i] = 0;
+        _count[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyProbe::begin() {
+#if LATENCY_PROBE_PIN >= 0
+    gpio_reset_pin((gpio_num_t)LATENCY_PROBE_PIN);
+    gpio_set_direction((gpio_num_t)LATENCY_PROBE_PIN, GPIO_MODE_OUTPUT);
+    gpio_set_level((gpio_num_t)LATENCY_PROBE_PIN, 0);
+    LOG_I(TAG_LATENCY, "延迟探测引脚 GPIO%d", LATENCY_PROBE_PIN);
+#endif
+    Console::instance().addCommands(LATENCY_COMMANDS);
+}
+
+bool LatencyProbe::startTest(uint16_t samples) {
+    if (isTesting()) return false;
+    _toFlushStart.reset();
+    _toFlushEnd.reset();
+    _samples = samples;
+    _remaining = samples;
+    _timeouts = 0;
+    _nextInjectMs = millis();
+    LoopScheduler::instance().after(0);
+    return true;
+}
+
+void LatencyProbe::inject() {
+    _baseStart = _count[LATENCY_POINT_FLUSH_START].load(std::memory_order_acquire);
+    _baseEnd = _count[LATENCY_POINT_FLUSH_END].load(std::memory_order_acquire);
+    _injectedAt = (uint32_t)esp_timer_get_time();
+    _injectedMs = millis();
+    _waiting = true;
+    _remaining--;
+
+    // “1”和退格交替，测试结束后显示内容与开始时相同
+    uint8_t key = _digitNext ? TEST_KEY_DIGIT : TEST_KEY_BACKSPACE;
+    _digitNext = !_digitNext;
+    KeyJournal& journal = KeyJournal::instance();
+    journal.inject(KEY_EVENT_PRESS, key);
+    journal.inject(KEY_EVENT_RELEASE, key);
+}
+
+void LatencyProbe::update() {
+    if (!isTesting()) return;
+
+    uint32_t nowMs = millis();
+    if (_waiting) {
+        // 推送可能在推送任务中完成，这里轮询经过次数
+        if (_count[LATENCY_POINT_FLUSH_END].load(std::memory_order_acquire) != _baseEnd) {
+            if (_count[LATENCY_POINT_FLUSH_START].load(std::memory_order_acquire) != _baseStart) {
+                _toFlushStart.record(_time[LATENCY_POINT_FLUSH_START] - _injectedAt);
+            }
+            _toFlushEnd.record(_time[LATENCY_POINT_FLUSH_END] - _injectedAt);
+        } else if (nowMs - _injectedMs < LATENCY_TEST_TIMEOUT_MS) {
+            LoopScheduler::instance().after(1);
+            return;
+        } else {
+            _timeouts++;
+        }
+        _waiting = false;
+        _nextInjectMs = _injectedMs + LATENCY_TEST_INTERVAL_MS;
+    }
+
+    if (!_remaining) {
+        finishTest();
+    } else if ((int32_t)(nowMs - _nextInjectMs) >= 0) {
+        inject();
+        LoopScheduler::instance().after(1);
+    } else {
+        LoopScheduler::instance().at(_nextInjectMs);
+    }
+}
+
+void LatencyProbe::finishTest() {
+    Serial.printf("延迟测试完成: %u 次注入", _samples);
+    if (_timeouts) {
+        Serial.printf(", %u 次 %d ms 内没有推送", _timeouts, LATENCY_TEST_TIMEOUT_MS);
+    }
+    Serial.println();
+    printHistogram("注入→推送开始", _toFlushStart);
+    printHistogram("注入→推送结束", _toFlushEnd);
+}
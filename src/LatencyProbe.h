@@ -0,0 +1,108 @@
+/**
+ * @file LatencyProbe.h
+ * @brief 端到端延迟测试
+ * @details 用逻辑分析仪或示波器测量“按键→HID报告→屏幕”的各段延迟：
+ * - 扫描发现按键变化、提交HID报告、开始推送屏幕、推送结束四处各翻转一次
+ *   LATENCY_PROBE_PIN的电平（翻转而不是脉冲，采样率不高时也不会漏掉），
+ *   同时记下esp_timer时刻，供没有仪器时在设备上统计
+ * - 串口命令 latency_test [n] 经按键日志注入n次合成按键（“1”和退格交替，显示内容不变），
+ *   统计注入到推送开始、注入到推送结束的延迟；合成按键不发HID报告，
+ *   HID提交延迟看 hid 命令中真实按键的统计
+ * - LATENCY_PROBE_ENABLED为0时探针不生成代码，也不注册命令
+ *
+ * @author Calculator Project
+ */
+
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include "config.h"
+#include "PerformanceMonitor.h"
+
+/**
+ * @brief 探测点
+ */
+enum LatencyPoint : uint8_t {
+    LATENCY_POINT_SCAN,         ///< 扫描发现按键状态变化（扫描任务）
+    LATENCY_POINT_HID_SUBMIT,   ///< 提交HID报告
+    LATENCY_POINT_FLUSH_START,  ///< 开始推送屏幕（推送任务或调用方）
+    LATENCY_POINT_FLUSH_END,    ///< 屏幕推送结束
+    LATENCY_POINT_COUNT
+};
+
+class LatencyProbe {
+public:
+    static const uint8_t TEST_KEY_DIGIT = 4;        ///< 主层“1”
+    static const uint8_t TEST_KEY_BACKSPACE = 15;   ///< 主层退格
+
+    static LatencyProbe& instance() {
+        static LatencyProbe instance;
+        return instance;
+    }
+
+    /**
+     * @brief 配置探测引脚并注册串口命令
+     */
+    void begin();
+
+    /**
+     * @brief 经过探测点：翻转引脚并记下时刻（任意任务中调用，不加锁）
+     */
+    void mark(LatencyPoint point) {
+        uint32_t now = (uint32_t)esp_timer_get_time();
+        _time[point] = now;
+        _count[point].fetch_add(1, std::memory_order_release);
+#if LATENCY_PROBE_PIN >= 0
+        gpio_set_level((gpio_num_t)LATENCY_PROBE_PIN, _level.fetch_xor(1, std::memory_order_relaxed) ^ 1);
+#endif
+    }
+
+    /**
+     * @brief 开始注入测试
+     * @return 已在测试中返回false
+     */
+    bool startTest(uint16_t samples);
+    bool isTesting() const { return _remaining || _waiting; }
+
+    /**
+     * @brief 推进测试（主循环调用，未测试时立即返回）
+     */
+    void update();
+
+private:
+    LatencyProbe();
+    LatencyProbe(const LatencyProbe&) = delete;
+    LatencyProbe& operator=(const LatencyProbe&) = delete;
+
+    void inject();
+    void finishTest();
+
+    volatile uint32_t _time[LATENCY_POINT_COUNT];           ///< 最近一次经过的时刻（µs低32位）
+    std::atomic<uint32_t> _count[LATENCY_POINT_COUNT];      ///< 经过次数，先写时刻再递增
+    std::atomic<uint32_t> _level;
+
+    uint16_t _remaining;            ///< 还要注入的次数
+    uint16_t _samples;
+    uint16_t _timeouts;             ///< 超时没有推送的次数
+    bool _waiting;                  ///< 已注入，等待推送结束
+    bool _digitNext;                ///< 下一次注入“1”还是退格
+    uint32_t _injectedAt;           ///< 注入时刻（µs低32位）
+    uint32_t _injectedMs;
+    uint32_t _nextInjectMs;
+    uint32_t _baseStart;            ///< 注入时的推送开始/结束次数
+    uint32_t _baseEnd;
+    PerfHistogram _toFlushStart;
+    PerfHistogram _toFlushEnd;
+};
+
+#if LATENCY_PROBE_ENABLED
+#define LATENCY_MARK(point) LatencyProbe::instance().mark(point)
+#else
+#define LATENCY_MARK(point) ((void)0)
+#endif
+
+#endif // LATENCY_PROBE_H
@@ -0,0 +1,397 @@
+// 由 tools/layout_compile.py 从 layouts/keypad.layout 生成，不要手工修改
+// 7 个布局方案
+
+#ifndef LAYOUT_DATA_H
+#define LAYOUT_DATA_H
+
+#include "KeyboardConfig.h"
+
+// 计算器
+constexpr KeyConfig CALCULATOR_KEYS[KeyboardConfigManager::LAYER_COUNT][KeyboardConfigManager::KEY_COUNT + 1] = {
+    {   // primary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::POWER, "ON", "POWER", Operator::NONE, "power", 0, false, 0, false},
+        {2, KeyType::NUMBER, "7", "SEVEN", Operator::NONE, "", 0, false, 0, true},
+        {3, KeyType::NUMBER, "4", "FOUR", Operator::NONE, "", 0, false, 0, true},
+        {4, KeyType::NUMBER, "1", "ONE", Operator::NONE, "", 0, false, 0, true},
+        {5, KeyType::NUMBER, "0", "ZERO", Operator::NONE, "", 0, false, 0, true},
+        {6, KeyType::LAYER_SWITCH, "TAB", "LAYER_SWITCH", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {7, KeyType::NUMBER, "8", "EIGHT", Operator::NONE, "", 0, false, 0, true},
+        {8, KeyType::NUMBER, "5", "FIVE", Operator::NONE, "", 0, false, 0, true},
+        {9, KeyType::NUMBER, "2", "TWO", Operator::NONE, "", 0, false, 0, true},
+        {10, KeyType::FUNCTION, "%", "PERCENT", Operator::PERCENT, "", 0, false, 0, false},
+        {11, KeyType::NUMBER, "9", "NINE", Operator::NONE, "", 0, false, 0, true},
+        {12, KeyType::NUMBER, "6", "SIX", Operator::NONE, "", 0, false, 0, true},
+        {13, KeyType::NUMBER, "3", "THREE", Operator::NONE, "", 0, false, 0, true},
+        {14, KeyType::DECIMAL, ".", "DOT", Operator::NONE, "", 0, false, 0, false},
+        {15, KeyType::DELETE, "⌫", "BACKSPACE", Operator::NONE, "", 0, false, 0, true},
+        {16, KeyType::OPERATOR, "×", "MUL", Operator::MULTIPLY, "", 0, false, 0, false},
+        {17, KeyType::OPERATOR, "-", "SUB", Operator::SUBTRACT, "", 0, false, 0, false},
+        {18, KeyType::OPERATOR, "+", "ADD", Operator::ADD, "", 0, false, 0, false},
+        {19, KeyType::CLEAR, "C", "CLEAR", Operator::NONE, "", 0, false, 0, false},
+        {20, KeyType::FUNCTION, "±", "SIGN", Operator::NONE, "sign", 0, false, 0, false},
+        {21, KeyType::OPERATOR, "÷", "DIV", Operator::DIVIDE, "", 0, false, 0, false},
+        {22, KeyType::FUNCTION, "=", "EQUALS", Operator::EQUALS, "", 0, false, 0, false},
+    },
+    {   // secondary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::FUNCTION, "◀", "CURSOR_LEFT", Operator::NONE, "cursor_left", 0, false, 0, true},
+        {2, KeyType::FUNCTION, "√", "SQRT", Operator::SQUARE_ROOT, "", 0, false, 0, false},
+        {3, KeyType::FUNCTION, "x²", "SQUARE", Operator::SQUARE, "", 0, false, 0, false},
+        {4, KeyType::FUNCTION, "1/x", "RECIPROCAL", Operator::RECIPROCAL, "", 0, false, 0, false},
+        {5, KeyType::MACRO, "⇥R", "TYPE_RESULT", Operator::NONE, "{RESULT}", 0, false, 0, false},
+        {6, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {7, KeyType::MEMORY, "M+", "M_ADD", Operator::NONE, "", 0, false, 0, false},
+        {8, KeyType::MEMORY, "M-", "M_SUB", Operator::NONE, "", 0, false, 0, false},
+        {9, KeyType::MEMORY, "MR", "M_RECALL", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {10, KeyType::OPERATOR, "x^y", "POWER", Operator::POWER, "", 0, false, 0, false},
+        {11, KeyType::MEMORY, "MC", "M_CLEAR", Operator::NONE, "", 0, false, 0, false},
+        {12, KeyType::FUNCTION, "(", "LPAREN", Operator::NONE, "lparen", 0, false, 0, false},
+        {13, KeyType::FUNCTION, ")", "RPAREN", Operator::NONE, "rparen", 0, false, 0, false},
+        {14, KeyType::FUNCTION, "↑", "HIST_UP", Operator::NONE, "hist_up", 0, false, 0, false},
+        {15, KeyType::FUNCTION, "↓", "HIST_DOWN", Operator::NONE, "hist_down", 0, false, 0, false},
+        {16, KeyType::FUNCTION, "sin", "SIN", Operator::SIN, "", 0, false, 0, false},
+        {17, KeyType::FUNCTION, "cos", "COS", Operator::COS, "", 0, false, 0, false},
+        {18, KeyType::FUNCTION, "tan", "TAN", Operator::TAN, "", 0, false, 0, false},
+        {19, KeyType::FUNCTION, "ln", "LN", Operator::LN, "", 0, false, 0, false},
+        {20, KeyType::FUNCTION, "log", "LOG10", Operator::LOG10, "", 0, false, 0, false},
+        {21, KeyType::FUNCTION, "e^x", "EXP", Operator::EXP, "", 0, false, 0, false},
+        {22, KeyType::FUNCTION, "▶", "CURSOR_RIGHT", Operator::NONE, "cursor_right", 0, false, 0, true},
+    },
+};
+
+// HID小键盘
+constexpr KeyConfig NUMPAD_KEYS[KeyboardConfigManager::LAYER_COUNT][KeyboardConfigManager::KEY_COUNT + 1] = {
+    {   // primary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::POWER, "ON", "POWER", Operator::NONE, "power", 0, false, 0, false},
+        {2, KeyType::RESERVED, "7", "SEVEN", Operator::NONE, "", 0x37, false, 0, false},
+        {3, KeyType::RESERVED, "4", "FOUR", Operator::NONE, "", 0x34, false, 0, false},
+        {4, KeyType::RESERVED, "1", "ONE", Operator::NONE, "", 0x31, false, 0, false},
+        {5, KeyType::RESERVED, "0", "ZERO", Operator::NONE, "", 0x30, false, 0, false},
+        {6, KeyType::LAYER_SWITCH, "TAB", "LAYER_SWITCH", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {7, KeyType::RESERVED, "8", "EIGHT", Operator::NONE, "", 0x38, false, 0, false},
+        {8, KeyType::RESERVED, "5", "FIVE", Operator::NONE, "", 0x35, false, 0, false},
+        {9, KeyType::RESERVED, "2", "TWO", Operator::NONE, "", 0x32, false, 0, false},
+        {10, KeyType::RESERVED, "%", "PERCENT", Operator::NONE, "", 0x25, false, 0, false},
+        {11, KeyType::RESERVED, "9", "NINE", Operator::NONE, "", 0x39, false, 0, false},
+        {12, KeyType::RESERVED, "6", "SIX", Operator::NONE, "", 0x36, false, 0, false},
+        {13, KeyType::RESERVED, "3", "THREE", Operator::NONE, "", 0x33, false, 0, false},
+        {14, KeyType::RESERVED, ".", "DOT", Operator::NONE, "", 0x2E, false, 0, false},
+        {15, KeyType::RESERVED, "⌫", "BACKSPACE", Operator::NONE, "", 0xB2, false, 0, false},
+        {16, KeyType::RESERVED, "*", "MUL", Operator::NONE, "", 0x2A, false, 0, false},
+        {17, KeyType::RESERVED, "-", "SUB", Operator::NONE, "", 0x2D, false, 0, false},
+        {18, KeyType::RESERVED, "+", "ADD", Operator::NONE, "", 0x2B, false, 0, false},
+        {19, KeyType::RESERVED, "Esc", "ESC", Operator::NONE, "", 0xB1, false, 0, false},
+        {20, KeyType::RESERVED, "Tab", "TAB", Operator::NONE, "", 0xB3, false, 0, false},
+        {21, KeyType::RESERVED, "/", "DIV", Operator::NONE, "", 0x2F, false, 0, false},
+        {22, KeyType::RESERVED, "↵", "ENTER", Operator::NONE, "", 0xB0, false, 0, false},
+    },
+    {   // secondary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::RESERVED, "Slp", "SLEEP", Operator::NONE, "", 0x2082, false, 0, false},
+        {2, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {3, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {4, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {5, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {6, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {7, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {8, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {9, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {10, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {11, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {12, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {13, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {14, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {15, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {16, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {17, KeyType::RESERVED, "Vol-", "VOLUME_DOWN", Operator::NONE, "", 0x10EA, false, 0, false},
+        {18, KeyType::RESERVED, "Vol+", "VOLUME_UP", Operator::NONE, "", 0x10E9, false, 0, false},
+        {19, KeyType::RESERVED, "Wake", "WAKE", Operator::NONE, "", 0x2083, false, 0, false},
+        {20, KeyType::RESERVED, "Mute", "MUTE", Operator::NONE, "", 0x10E2, false, 0, false},
+        {21, KeyType::RESERVED, "Calc", "CALCULATOR", Operator::NONE, "", 0x1192, false, 0, false},
+        {22, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+    },
+};
+
+// 电子表格
+constexpr KeyConfig SHEET_KEYS[KeyboardConfigManager::LAYER_COUNT][KeyboardConfigManager::KEY_COUNT + 1] = {
+    {   // primary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::POWER, "ON", "POWER", Operator::NONE, "power", 0, false, 0, false},
+        {2, KeyType::RESERVED, "7", "SEVEN", Operator::NONE, "", 0x37, false, 0, false},
+        {3, KeyType::RESERVED, "4", "FOUR", Operator::NONE, "", 0x34, false, 0, false},
+        {4, KeyType::RESERVED, "1", "ONE", Operator::NONE, "", 0x31, false, 0, false},
+        {5, KeyType::RESERVED, "0", "ZERO", Operator::NONE, "", 0x30, false, 0, false},
+        {6, KeyType::LAYER_SWITCH, "TAB", "LAYER_SWITCH", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {7, KeyType::RESERVED, "8", "EIGHT", Operator::NONE, "", 0x38, false, 0, false},
+        {8, KeyType::RESERVED, "5", "FIVE", Operator::NONE, "", 0x35, false, 0, false},
+        {9, KeyType::RESERVED, "2", "TWO", Operator::NONE, "", 0x32, false, 0, false},
+        {10, KeyType::RESERVED, "%", "PERCENT", Operator::NONE, "", 0x25, false, 0, false},
+        {11, KeyType::RESERVED, "9", "NINE", Operator::NONE, "", 0x39, false, 0, false},
+        {12, KeyType::RESERVED, "6", "SIX", Operator::NONE, "", 0x36, false, 0, false},
+        {13, KeyType::RESERVED, "3", "THREE", Operator::NONE, "", 0x33, false, 0, false},
+        {14, KeyType::RESERVED, ".", "DOT", Operator::NONE, "", 0x2E, false, 0, false},
+        {15, KeyType::RESERVED, "⌫", "BACKSPACE", Operator::NONE, "", 0xB2, false, 0, false},
+        {16, KeyType::RESERVED, "*", "MUL", Operator::NONE, "", 0x2A, false, 0, false},
+        {17, KeyType::RESERVED, "-", "SUB", Operator::NONE, "", 0x2D, false, 0, false},
+        {18, KeyType::RESERVED, "+", "ADD", Operator::NONE, "", 0x2B, false, 0, false},
+        {19, KeyType::RESERVED, "Esc", "CANCEL", Operator::NONE, "", 0xB1, false, 0, false},
+        {20, KeyType::RESERVED, "F2", "EDIT", Operator::NONE, "", 0xC3, false, 0, false},
+        {21, KeyType::RESERVED, "/", "DIV", Operator::NONE, "", 0x2F, false, 0, false},
+        {22, KeyType::RESERVED, "=", "ENTER", Operator::NONE, "", 0xB0, false, 0, false},
+    },
+    {   // secondary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {2, KeyType::MACRO, "Σ(", "SUM", Operator::NONE, "=SUM(", 0, false, 0, false},
+        {3, KeyType::RESERVED, "←", "LEFT", Operator::NONE, "", 0xD8, false, 0, false},
+        {4, KeyType::MACRO, "⇥↵", "TAB_ENTER", Operator::NONE, "{TAB}{ENTER}", 0, false, 0, false},
+        {5, KeyType::MACRO, "R↵", "PASTE_RESULT", Operator::NONE, "{RESULT}{ENTER}", 0, false, 0, false},
+        {6, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {7, KeyType::RESERVED, "↑", "UP", Operator::NONE, "", 0xDA, false, 0, false},
+        {8, KeyType::RESERVED, "↵", "ENTER", Operator::NONE, "", 0xB0, false, 0, false},
+        {9, KeyType::RESERVED, "↓", "DOWN", Operator::NONE, "", 0xD9, false, 0, false},
+        {10, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {11, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {12, KeyType::RESERVED, "→", "RIGHT", Operator::NONE, "", 0xD7, false, 0, false},
+        {13, KeyType::RESERVED, ")", "RPAREN", Operator::NONE, "", 0x29, false, 0, false},
+        {14, KeyType::RESERVED, "Tab", "NEXT_CELL", Operator::NONE, "", 0xB3, false, 0, false},
+        {15, KeyType::RESERVED, "Del", "DELETE", Operator::NONE, "", 0xD4, false, 0, false},
+        {16, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {17, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {18, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {19, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {20, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {21, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {22, KeyType::RESERVED, "=", "FORMULA", Operator::NONE, "", 0x3D, false, 0, false},
+    },
+};
+
+// 程序员
+constexpr KeyConfig PROGRAMMER_KEYS[KeyboardConfigManager::LAYER_COUNT][KeyboardConfigManager::KEY_COUNT + 1] = {
+    {   // primary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::POWER, "ON", "POWER", Operator::NONE, "power", 0, false, 0, false},
+        {2, KeyType::NUMBER, "7", "SEVEN", Operator::NONE, "", 0, false, 0, true},
+        {3, KeyType::NUMBER, "4", "FOUR", Operator::NONE, "", 0, false, 0, true},
+        {4, KeyType::NUMBER, "1", "ONE", Operator::NONE, "", 0, false, 0, true},
+        {5, KeyType::NUMBER, "0", "ZERO", Operator::NONE, "", 0, false, 0, true},
+        {6, KeyType::LAYER_SWITCH, "TAB", "LAYER_SWITCH", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {7, KeyType::NUMBER, "8", "EIGHT", Operator::NONE, "", 0, false, 0, true},
+        {8, KeyType::NUMBER, "5", "FIVE", Operator::NONE, "", 0, false, 0, true},
+        {9, KeyType::NUMBER, "2", "TWO", Operator::NONE, "", 0, false, 0, true},
+        {10, KeyType::OPERATOR, "mod", "MOD", Operator::MODULO, "", 0, false, 0, false},
+        {11, KeyType::NUMBER, "9", "NINE", Operator::NONE, "", 0, false, 0, true},
+        {12, KeyType::NUMBER, "6", "SIX", Operator::NONE, "", 0, false, 0, true},
+        {13, KeyType::NUMBER, "3", "THREE", Operator::NONE, "", 0, false, 0, true},
+        {14, KeyType::FUNCTION, "~", "NOT", Operator::BIT_NOT, "", 0, false, 0, false},
+        {15, KeyType::DELETE, "⌫", "BACKSPACE", Operator::NONE, "", 0, false, 0, true},
+        {16, KeyType::OPERATOR, "×", "MUL", Operator::MULTIPLY, "", 0, false, 0, false},
+        {17, KeyType::OPERATOR, "-", "SUB", Operator::SUBTRACT, "", 0, false, 0, false},
+        {18, KeyType::OPERATOR, "+", "ADD", Operator::ADD, "", 0, false, 0, false},
+        {19, KeyType::CLEAR, "C", "CLEAR", Operator::NONE, "", 0, false, 0, false},
+        {20, KeyType::FUNCTION, "±", "SIGN", Operator::NONE, "sign", 0, false, 0, false},
+        {21, KeyType::OPERATOR, "÷", "DIV", Operator::DIVIDE, "", 0, false, 0, false},
+        {22, KeyType::FUNCTION, "=", "EQUALS", Operator::EQUALS, "", 0, false, 0, false},
+    },
+    {   // secondary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {2, KeyType::NUMBER, "A", "HEX_A", Operator::NONE, "", 0, false, 0, true},
+        {3, KeyType::NUMBER, "B", "HEX_B", Operator::NONE, "", 0, false, 0, true},
+        {4, KeyType::NUMBER, "C", "HEX_C", Operator::NONE, "", 0, false, 0, true},
+        {5, KeyType::MODE_SWITCH, "BASE", "BASE", Operator::NONE, "base", 0, false, 0, false},
+        {6, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {7, KeyType::NUMBER, "D", "HEX_D", Operator::NONE, "", 0, false, 0, true},
+        {8, KeyType::NUMBER, "E", "HEX_E", Operator::NONE, "", 0, false, 0, true},
+        {9, KeyType::NUMBER, "F", "HEX_F", Operator::NONE, "", 0, false, 0, true},
+        {10, KeyType::MODE_SWITCH, "WORD", "WORD_SIZE", Operator::NONE, "word", 0, false, 0, false},
+        {11, KeyType::MODE_SWITCH, "S/U", "SIGNEDNESS", Operator::NONE, "signed", 0, false, 0, false},
+        {12, KeyType::OPERATOR, "<<", "SHL", Operator::SHIFT_LEFT, "", 0, false, 0, false},
+        {13, KeyType::OPERATOR, ">>", "SHR", Operator::SHIFT_RIGHT, "", 0, false, 0, false},
+        {14, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {15, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {16, KeyType::OPERATOR, "AND", "AND", Operator::BIT_AND, "", 0, false, 0, false},
+        {17, KeyType::OPERATOR, "OR", "OR", Operator::BIT_OR, "", 0, false, 0, false},
+        {18, KeyType::OPERATOR, "XOR", "XOR", Operator::BIT_XOR, "", 0, false, 0, false},
+        {19, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {20, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {21, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {22, KeyType::MODE_SWITCH, "CALC", "CALCULATOR", Operator::NONE, "calculator", 0, false, 0, false},
+    },
+};
+
+// 统计
+constexpr KeyConfig STATS_KEYS[KeyboardConfigManager::LAYER_COUNT][KeyboardConfigManager::KEY_COUNT + 1] = {
+    {   // primary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::POWER, "ON", "POWER", Operator::NONE, "power", 0, false, 0, false},
+        {2, KeyType::NUMBER, "7", "SEVEN", Operator::NONE, "", 0, false, 0, true},
+        {3, KeyType::NUMBER, "4", "FOUR", Operator::NONE, "", 0, false, 0, true},
+        {4, KeyType::NUMBER, "1", "ONE", Operator::NONE, "", 0, false, 0, true},
+        {5, KeyType::NUMBER, "0", "ZERO", Operator::NONE, "", 0, false, 0, true},
+        {6, KeyType::LAYER_SWITCH, "TAB", "LAYER_SWITCH", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {7, KeyType::NUMBER, "8", "EIGHT", Operator::NONE, "", 0, false, 0, true},
+        {8, KeyType::NUMBER, "5", "FIVE", Operator::NONE, "", 0, false, 0, true},
+        {9, KeyType::NUMBER, "2", "TWO", Operator::NONE, "", 0, false, 0, true},
+        {10, KeyType::FUNCTION, "%", "PERCENT", Operator::PERCENT, "", 0, false, 0, false},
+        {11, KeyType::NUMBER, "9", "NINE", Operator::NONE, "", 0, false, 0, true},
+        {12, KeyType::NUMBER, "6", "SIX", Operator::NONE, "", 0, false, 0, true},
+        {13, KeyType::NUMBER, "3", "THREE", Operator::NONE, "", 0, false, 0, true},
+        {14, KeyType::DECIMAL, ".", "DOT", Operator::NONE, "", 0, false, 0, false},
+        {15, KeyType::DELETE, "⌫", "BACKSPACE", Operator::NONE, "", 0, false, 0, true},
+        {16, KeyType::OPERATOR, "×", "MUL", Operator::MULTIPLY, "", 0, false, 0, false},
+        {17, KeyType::OPERATOR, "-", "SUB", Operator::SUBTRACT, "", 0, false, 0, false},
+        {18, KeyType::OPERATOR, "+", "ADD", Operator::ADD, "", 0, false, 0, false},
+        {19, KeyType::CLEAR, "C", "CLEAR", Operator::NONE, "", 0, false, 0, false},
+        {20, KeyType::FUNCTION, "±", "SIGN", Operator::NONE, "sign", 0, false, 0, false},
+        {21, KeyType::OPERATOR, "÷", "DIV", Operator::DIVIDE, "", 0, false, 0, false},
+        {22, KeyType::FUNCTION, "Σ+", "STAT_ADD", Operator::NONE, "stat_add", 0, false, 0, false},
+    },
+    {   // secondary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {2, KeyType::FUNCTION, "n", "STAT_N", Operator::NONE, "stat_n", 0, false, 0, false},
+        {3, KeyType::FUNCTION, "Σx", "STAT_SUM", Operator::NONE, "stat_sum", 0, false, 0, false},
+        {4, KeyType::FUNCTION, "avg", "STAT_MEAN", Operator::NONE, "stat_mean", 0, false, 0, false},
+        {5, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {6, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {7, KeyType::FUNCTION, "s", "STAT_SD", Operator::NONE, "stat_sd", 0, false, 0, false},
+        {8, KeyType::FUNCTION, "σ", "STAT_SDP", Operator::NONE, "stat_sdp", 0, false, 0, false},
+        {9, KeyType::FUNCTION, "med", "STAT_MEDIAN", Operator::NONE, "stat_median", 0, false, 0, false},
+        {10, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {11, KeyType::FUNCTION, "min", "STAT_MIN", Operator::NONE, "stat_min", 0, false, 0, false},
+        {12, KeyType::FUNCTION, "max", "STAT_MAX", Operator::NONE, "stat_max", 0, false, 0, false},
+        {13, KeyType::FUNCTION, "=", "EQUALS", Operator::EQUALS, "", 0, false, 0, false},
+        {14, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {15, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {16, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {17, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {18, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {19, KeyType::FUNCTION, "CΣ", "STAT_CLEAR", Operator::NONE, "stat_clear", 0, false, 0, false},
+        {20, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {21, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {22, KeyType::MODE_SWITCH, "CALC", "CALCULATOR", Operator::NONE, "calculator", 0, false, 0, false},
+    },
+};
+
+// 商务
+constexpr KeyConfig BUSINESS_KEYS[KeyboardConfigManager::LAYER_COUNT][KeyboardConfigManager::KEY_COUNT + 1] = {
+    {   // primary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::POWER, "ON", "POWER", Operator::NONE, "power", 0, false, 0, false},
+        {2, KeyType::NUMBER, "7", "SEVEN", Operator::NONE, "", 0, false, 0, true},
+        {3, KeyType::NUMBER, "4", "FOUR", Operator::NONE, "", 0, false, 0, true},
+        {4, KeyType::NUMBER, "1", "ONE", Operator::NONE, "", 0, false, 0, true},
+        {5, KeyType::NUMBER, "0", "ZERO", Operator::NONE, "", 0, false, 0, true},
+        {6, KeyType::LAYER_SWITCH, "TAB", "LAYER_SWITCH", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {7, KeyType::NUMBER, "8", "EIGHT", Operator::NONE, "", 0, false, 0, true},
+        {8, KeyType::NUMBER, "5", "FIVE", Operator::NONE, "", 0, false, 0, true},
+        {9, KeyType::NUMBER, "2", "TWO", Operator::NONE, "", 0, false, 0, true},
+        {10, KeyType::FUNCTION, "%", "PERCENT", Operator::PERCENT, "", 0, false, 0, false},
+        {11, KeyType::NUMBER, "9", "NINE", Operator::NONE, "", 0, false, 0, true},
+        {12, KeyType::NUMBER, "6", "SIX", Operator::NONE, "", 0, false, 0, true},
+        {13, KeyType::NUMBER, "3", "THREE", Operator::NONE, "", 0, false, 0, true},
+        {14, KeyType::DECIMAL, ".", "DOT", Operator::NONE, "", 0, false, 0, false},
+        {15, KeyType::DELETE, "⌫", "BACKSPACE", Operator::NONE, "", 0, false, 0, true},
+        {16, KeyType::OPERATOR, "×", "MUL", Operator::MULTIPLY, "", 0, false, 0, false},
+        {17, KeyType::OPERATOR, "-", "SUB", Operator::SUBTRACT, "", 0, false, 0, false},
+        {18, KeyType::OPERATOR, "+", "ADD", Operator::ADD, "", 0, false, 0, false},
+        {19, KeyType::CLEAR, "C", "CLEAR", Operator::NONE, "", 0, false, 0, false},
+        {20, KeyType::FUNCTION, "±", "SIGN", Operator::NONE, "sign", 0, false, 0, false},
+        {21, KeyType::OPERATOR, "÷", "DIV", Operator::DIVIDE, "", 0, false, 0, false},
+        {22, KeyType::FUNCTION, "=", "EQUALS", Operator::EQUALS, "", 0, false, 0, false},
+    },
+    {   // secondary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {2, KeyType::FUNCTION, "TAX+", "TAX_PLUS", Operator::TAX_PLUS, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {3, KeyType::FUNCTION, "TAX-", "TAX_MINUS", Operator::TAX_MINUS, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {4, KeyType::FUNCTION, "GT", "GRAND_TOTAL", Operator::GRAND_TOTAL, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {5, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {6, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {7, KeyType::MEMORY, "M+", "M_ADD", Operator::NONE, "", 0, false, 0, false},
+        {8, KeyType::MEMORY, "M-", "M_SUB", Operator::NONE, "", 0, false, 0, false},
+        {9, KeyType::MEMORY, "MR", "M_RECALL", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {10, KeyType::FUNCTION, "MU", "MARKUP", Operator::MARKUP, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {11, KeyType::MEMORY, "MC", "M_CLEAR", Operator::NONE, "", 0, false, 0, false},
+        {12, KeyType::FUNCTION, "(", "LPAREN", Operator::NONE, "lparen", 0, false, 0, false},
+        {13, KeyType::FUNCTION, ")", "RPAREN", Operator::NONE, "rparen", 0, false, 0, false},
+        {14, KeyType::FUNCTION, "↑", "HIST_UP", Operator::NONE, "hist_up", 0, false, 0, false},
+        {15, KeyType::FUNCTION, "↓", "HIST_DOWN", Operator::NONE, "hist_down", 0, false, 0, false},
+        {16, KeyType::FUNCTION, "DISC", "DISCOUNT", Operator::DISCOUNT, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {17, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {18, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {19, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {20, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {21, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {22, KeyType::MODE_SWITCH, "CALC", "CALCULATOR", Operator::NONE, "calculator", 0, false, 0, false},
+    },
+};
+
+// 换算
+constexpr KeyConfig CONVERT_KEYS[KeyboardConfigManager::LAYER_COUNT][KeyboardConfigManager::KEY_COUNT + 1] = {
+    {   // primary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::POWER, "ON", "POWER", Operator::NONE, "power", 0, false, 0, false},
+        {2, KeyType::NUMBER, "7", "SEVEN", Operator::NONE, "", 0, false, 0, true},
+        {3, KeyType::NUMBER, "4", "FOUR", Operator::NONE, "", 0, false, 0, true},
+        {4, KeyType::NUMBER, "1", "ONE", Operator::NONE, "", 0, false, 0, true},
+        {5, KeyType::NUMBER, "0", "ZERO", Operator::NONE, "", 0, false, 0, true},
+        {6, KeyType::LAYER_SWITCH, "TAB", "LAYER_SWITCH", Operator::NONE, "", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {7, KeyType::NUMBER, "8", "EIGHT", Operator::NONE, "", 0, false, 0, true},
+        {8, KeyType::NUMBER, "5", "FIVE", Operator::NONE, "", 0, false, 0, true},
+        {9, KeyType::NUMBER, "2", "TWO", Operator::NONE, "", 0, false, 0, true},
+        {10, KeyType::FUNCTION, "%", "PERCENT", Operator::PERCENT, "", 0, false, 0, false},
+        {11, KeyType::NUMBER, "9", "NINE", Operator::NONE, "", 0, false, 0, true},
+        {12, KeyType::NUMBER, "6", "SIX", Operator::NONE, "", 0, false, 0, true},
+        {13, KeyType::NUMBER, "3", "THREE", Operator::NONE, "", 0, false, 0, true},
+        {14, KeyType::DECIMAL, ".", "DOT", Operator::NONE, "", 0, false, 0, false},
+        {15, KeyType::DELETE, "⌫", "BACKSPACE", Operator::NONE, "", 0, false, 0, true},
+        {16, KeyType::OPERATOR, "×", "MUL", Operator::MULTIPLY, "", 0, false, 0, false},
+        {17, KeyType::OPERATOR, "-", "SUB", Operator::SUBTRACT, "", 0, false, 0, false},
+        {18, KeyType::OPERATOR, "+", "ADD", Operator::ADD, "", 0, false, 0, false},
+        {19, KeyType::CLEAR, "C", "CLEAR", Operator::NONE, "", 0, false, 0, false},
+        {20, KeyType::FUNCTION, "±", "SIGN", Operator::NONE, "sign", 0, false, 0, false},
+        {21, KeyType::OPERATOR, "÷", "DIV", Operator::DIVIDE, "", 0, false, 0, false},
+        {22, KeyType::FUNCTION, "=", "EQUALS", Operator::EQUALS, "", 0, false, 0, false},
+    },
+    {   // secondary
+        {0, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {1, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {2, KeyType::FUNCTION, "in→cm", "IN_CM", Operator::NONE, "conv:in:cm", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {3, KeyType::FUNCTION, "ft→m", "FT_M", Operator::NONE, "conv:ft:m", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {4, KeyType::FUNCTION, "mi→km", "MI_KM", Operator::NONE, "conv:mi:km", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {5, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {6, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, "", 0, false, 0, false},
+        {7, KeyType::FUNCTION, "cm→in", "CM_IN", Operator::NONE, "conv:cm:in", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {8, KeyType::FUNCTION, "m→ft", "M_FT", Operator::NONE, "conv:m:ft", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {9, KeyType::FUNCTION, "km→mi", "KM_MI", Operator::NONE, "conv:km:mi", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {10, KeyType::FUNCTION, "lb→kg", "LB_KG", Operator::NONE, "conv:lb:kg", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {11, KeyType::FUNCTION, "kg→lb", "KG_LB", Operator::NONE, "conv:kg:lb", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {12, KeyType::FUNCTION, "oz→g", "OZ_G", Operator::NONE, "conv:oz:g", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {13, KeyType::FUNCTION, "g→oz", "G_OZ", Operator::NONE, "conv:g:oz", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {14, KeyType::FUNCTION, "F→C", "F_C", Operator::NONE, "conv:F:C", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {15, KeyType::FUNCTION, "C→F", "C_F", Operator::NONE, "conv:C:F", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {16, KeyType::FUNCTION, "$→¥", "USD_CNY", Operator::NONE, "conv:USD:CNY", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {17, KeyType::FUNCTION, "¥→$", "CNY_USD", Operator::NONE, "conv:CNY:USD", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {18, KeyType::FUNCTION, "€→¥", "EUR_CNY", Operator::NONE, "conv:EUR:CNY", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {19, KeyType::FUNCTION, "¥→€", "CNY_EUR", Operator::NONE, "conv:CNY:EUR", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {20, KeyType::FUNCTION, "JPY→¥", "JPY_CNY", Operator::NONE, "conv:JPY:CNY", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {21, KeyType::FUNCTION, "¥→JPY", "CNY_JPY", Operator::NONE, "conv:CNY:JPY", 0, false, TAP_HOLD_DEFAULT_MS, false},
+        {22, KeyType::MODE_SWITCH, "CALC", "CALCULATOR", Operator::NONE, "calculator", 0, false, 0, false},
+    },
+};
+
+constexpr KeyboardConfigManager::LayoutProfile PROFILES[] = {
+    {"计算器", CALCULATOR_KEYS, true, true, CalcMode::STANDARD},
+    {"HID小键盘", NUMPAD_KEYS, false, false, CalcMode::STANDARD},
+    {"电子表格", SHEET_KEYS, false, false, CalcMode::STANDARD},
+    {"程序员", PROGRAMMER_KEYS, true, false, CalcMode::PROGRAMMER},
+    {"统计", STATS_KEYS, true, false, CalcMode::STATISTICS},
+    {"商务", BUSINESS_KEYS, true, false, CalcMode::BUSINESS},
+    {"换算", CONVERT_KEYS, true, false, CalcMode::STANDARD},
+};
+
+#endif // LAYOUT_DATA_H
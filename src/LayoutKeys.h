@@ -0,0 +1,89 @@
+// 由 tools/layout_compile.py 从 layouts/keypad.layout 生成，不要手工修改
+// 按物理按键（下标为位置-1）的属性，来自默认方案（计算器）的主层
+
+#ifndef LAYOUT_KEYS_H
+#define LAYOUT_KEYS_H
+
+#include <stdint.h>
+
+static const uint8_t LAYOUT_KEY_COUNT = 22;
+
+// 计算器方案下HID模式发送的键码（见 SimpleHID::getHIDKeyCode()），0表示不发送
+static const uint16_t LAYOUT_HOST_CODES[22] = {
+    0x1192,    // 1  ON
+    0x0037,    // 2  7
+    0x0034,    // 3  4
+    0x0031,    // 4  1
+    0x0030,    // 5  0
+    0x0009,    // 6  TAB
+    0x0038,    // 7  8
+    0x0035,    // 8  5
+    0x0032,    // 9  2
+    0x0025,    // 10 %
+    0x0039,    // 11 9
+    0x0036,    // 12 6
+    0x0033,    // 13 3
+    0x002E,    // 14 .
+    0x0008,    // 15 ⌫
+    0x002A,    // 16 ×
+    0x002D,    // 17 -
+    0x002B,    // 18 +
+    0x0043,    // 19 C
+    0x0000,    // 20 ±
+    0x002F,    // 21 ÷
+    0x003D,    // 22 =
+};
+
+// 直通模式的键码（0x88 + 键盘Usage），0表示无映射
+static const uint8_t LAYOUT_PASSTHROUGH_CODES[22] = {
+    0xDB,    // 1  ON
+    0xE7,    // 2  7
+    0xE4,    // 3  4
+    0xE1,    // 4  1
+    0xEA,    // 5  0
+    0x00,    // 6  TAB
+    0xE8,    // 7  8
+    0xE5,    // 8  5
+    0xE2,    // 9  2
+    0x00,    // 10 %
+    0xE9,    // 11 9
+    0xE6,    // 12 6
+    0xE3,    // 13 3
+    0xEB,    // 14 .
+    0xB2,    // 15 ⌫
+    0xDD,    // 16 ×
+    0xDE,    // 17 -
+    0xDF,    // 18 +
+    0xB1,    // 19 C
+    0x00,    // 20 ±
+    0xDC,    // 21 ÷
+    0xE0,    // 22 =
+};
+
+// 按键反馈颜色（0xRRGGBB）
+static const uint32_t LAYOUT_KEY_COLORS[22] = {
+    0xFFFFFF,    // 1  ON
+    0xFFFFFF,    // 2  7
+    0xFFFFFF,    // 3  4
+    0xFFFFFF,    // 4  1
+    0xFFFFFF,    // 5  0
+    0xFFFFFF,    // 6  TAB
+    0xFFFFFF,    // 7  8
+    0xFFFFFF,    // 8  5
+    0xFFFFFF,    // 9  2
+    0xFFFFFF,    // 10 %
+    0xFFFFFF,    // 11 9
+    0xFFFFFF,    // 12 6
+    0xFFFFFF,    // 13 3
+    0xFFFFFF,    // 14 .
+    0xFFFFFF,    // 15 ⌫
+    0xFFFFFF,    // 16 ×
+    0xFFFFFF,    // 17 -
+    0xFFFFFF,    // 18 +
+    0xFFFFFF,    // 19 C
+    0xFFFFFF,    // 20 ±
+    0xFFFFFF,    // 21 ÷
+    0xFFFFFF,    // 22 =
+};
+
+#endif // LAYOUT_KEYS_H
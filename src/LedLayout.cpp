@@ -0,0 +1,51 @@
+/**
+ * @file LedLayout.cpp
+ * @brief 按键、LED与面板坐标的查找表实现
+ *
+ * @author Calculator Project
+ */
+
+#include "LedLayout.h"
+#include <math.h>
+
+LedLayout::LedLayout() : _maxDistance(0) {
+    // 每个键覆盖的格子坐标之和与格数，求中心
+    uint16_t sumX[NUM_LEDS] = {};
+    uint16_t sumY[NUM_LEDS] = {};
+    uint8_t cells[NUM_LEDS] = {};
+
+    for (uint8_t row = 0; row < ROWS; row++) {
+        for (uint8_t col = 0; col < COLS; col++) {
+            int key = KEY_MATRIX[row][col];
+            if (key < 0 && row + 1 < ROWS && KEY_MATRIX[row + 1][col] >= 0) {
+                key = KEY_MATRIX[row + 1][col];     // 竖向占两格的键（+、=）
+            } else if (key < 0 && col > 0) {
+                key = KEY_MATRIX[row][col - 1];     // 横向占两格的键（0）
+            }
+            if (key < 0 || key >= NUM_LEDS) continue;
+            sumX[key] += col * UNIT + UNIT / 2;
+            sumY[key] += row * UNIT + UNIT / 2;
+            cells[key]++;
+        }
+    }
+
+    memset(_pos, 0, sizeof(_pos));
+    for (uint8_t key = 0; key < NUM_LEDS; key++) {
+        uint8_t led = KEY_LED_MAP[key];
+        _keyToLed[key] = led < NUM_LEDS ? led : NO_LED;
+        if (led < NUM_LEDS && cells[key]) {
+            _pos[led].x = sumX[key] / cells[key];
+            _pos[led].y = sumY[key] / cells[key];
+        }
+    }
+
+    for (uint8_t from = 0; from < NUM_LEDS; from++) {
+        for (uint8_t to = 0; to < NUM_LEDS; to++) {
+            int dx = (int)_pos[from].x - _pos[to].x;
+            int dy = (int)_pos[from].y - _pos[to].y;
+            uint8_t d = (uint8_t)(sqrtf((float)(dx * dx + dy * dy)) + 0.5f);
+            _distance[from][to] = d;
+            if (d > _maxDistance) _maxDistance = d;
+        }
+    }
+}
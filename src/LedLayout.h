@@ -0,0 +1,72 @@
+/**
+ * @file LedLayout.h
+ * @brief 按键、LED与面板坐标的查找表
+ * @details 空间效果（从按下的键扩散、按行扫过）每帧只查表，不再假设LED序号等于按键序号：
+ * - 按键 -> LED 由config.h的KEY_LED_MAP给出
+ * - 坐标由KEY_MATRIX推出：每格一个键距（UNIT），占两格的键（0、+、=）取两格的中点；
+ *   矩阵中的-1格属于下方的键，下方没有键时属于左侧的键
+ * - LED两两之间的距离在构造时算好，按起点LED连续存放，一次扩散只读一行NUM_LEDS个字节
+ *
+ * @author Calculator Project
+ */
+
+#ifndef LED_LAYOUT_H
+#define LED_LAYOUT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class LedLayout {
+public:
+    static const uint8_t UNIT = 16;         ///< 坐标单位：一个键距为16
+    static const uint8_t ROWS = 5;
+    static const uint8_t COLS = 5;
+    static const uint8_t NO_LED = 0xFF;
+
+    static const LedLayout& instance() {
+        static LedLayout instance;
+        return instance;
+    }
+
+    /**
+     * @brief 按键对应的LED
+     * @param keyIndex 按键下标（0起，即按键编号-1）
+     * @return 没有对应LED时返回NO_LED
+     */
+    uint8_t keyToLed(uint8_t keyIndex) const { return keyIndex < NUM_LEDS ? _keyToLed[keyIndex] : NO_LED; }
+
+    uint8_t x(uint8_t led) const { return _pos[led].x; }   ///< LED所在键的中心列坐标
+    uint8_t y(uint8_t led) const { return _pos[led].y; }   ///< LED所在键的中心行坐标
+
+    /**
+     * @brief 两个LED之间的距离（UNIT为单位，四舍五入）
+     */
+    uint8_t distance(uint8_t from, uint8_t to) const { return _distance[from][to]; }
+
+    /**
+     * @brief 从from到各LED的距离，按LED序号连续存放
+     */
+    const uint8_t* distancesFrom(uint8_t from) const { return _distance[from]; }
+
+    /**
+     * @brief 任意两个LED之间的最大距离（扩散效果据此决定何时结束）
+     */
+    uint8_t maxDistance() const { return _maxDistance; }
+
+private:
+    struct Point {
+        uint8_t x;
+        uint8_t y;
+    };
+
+    LedLayout();
+    LedLayout(const LedLayout&) = delete;
+    LedLayout& operator=(const LedLayout&) = delete;
+
+    uint8_t _keyToLed[NUM_LEDS];
+    Point _pos[NUM_LEDS];                   ///< 按LED序号
+    uint8_t _distance[NUM_LEDS][NUM_LEDS];  ///< [起点LED][终点LED]
+    uint8_t _maxDistance;
+};
+
+#endif // LED_LAYOUT_H
@@ -0,0 +1,226 @@
+/**
+ * @file LedOutput.cpp
+ * @brief 非阻塞的LED输出实现
+ *
+ * @author Calculator Project
+ */
+
+#include "LedOutput.h"
+#include "CpuProfiler.h"
+#include "LoopScheduler.h"
+#include "Metrics.h"
+#include <esp_timer.h>
+#include <power_mgt.h>
+
+#define LED_OUTPUT_TASK_STACK 3072
+#define LED_OUTPUT_TASK_PRIO  1
+
+namespace {
+
+// 编译期生成gamma表。constexpr函数只能有一条return（C++11），pow用递归的ln/exp级数实现
+constexpr double GAMMA_LN2 = 0.6931471805599453;
+
+constexpr double gammaSq(double v) { return v * v; }
+
+// atanh(y) = y + y³/3 + y⁵/5 + ...
+constexpr double gammaAtanh(double y2, double term, int k) {
+    return k > 41 ? 0 : term / k + gammaAtanh(y2, term * y2, k + 2);
+}
+
+constexpr double gammaLnReduced(double y) { return 2 * gammaAtanh(y * y, y, 1); }
+
+// ln(x) = 2·atanh((x-1)/(x+1))；先把x乘2缩到[0.5, 1]，级数收敛快
+constexpr double gammaLn(double x) {
+    return x < 0.5 ? gammaLn(x * 2) - GAMMA_LN2 : gammaLnReduced((x - 1) / (x + 1));
+}
+
+constexpr double gammaExpTaylor(double z, double term, int n) {
+    return n > 16 ? term : term + gammaExpTaylor(z, term * z / n, n + 1);
+}
+
+// exp(z) = exp(z/2)²，减半到|z| <= 0.5后用泰勒级数
+constexpr double gammaExp(double z) {
+    return z < -0.5 ? gammaSq(gammaExp(z / 2)) : gammaExpTaylor(z, 1.0, 1);
+}
+
+constexpr uint16_t gamma16(int i) {
+    return i == 0 ? 0 : (uint16_t)(gammaExp(LED_GAMMA * gammaLn(i / 255.0)) * 65535 + 0.5);
+}
+
+#define GAMMA16_4(i) gamma16(i), gamma16(i + 1), gamma16(i + 2), gamma16(i + 3)
+#define GAMMA16_16(i) GAMMA16_4(i), GAMMA16_4(i + 4), GAMMA16_4(i + 8), GAMMA16_4(i + 12)
+#define GAMMA16_64(i) GAMMA16_16(i), GAMMA16_16(i + 16), GAMMA16_16(i + 32), GAMMA16_16(i + 48)
+
+// 8位颜色值 -> 16位线性亮度
+DRAM_ATTR constexpr uint16_t GAMMA16[256] = {
+    GAMMA16_64(0), GAMMA16_64(64), GAMMA16_64(128), GAMMA16_64(192),
+};
+static_assert(GAMMA16[255] == 65535 && GAMMA16[128] > 0, "gamma表生成错误");
+
+// 时间抖动阈值：按位反转顺序排列，相邻帧的舍入方向交替，平均为128（即四舍五入）
+DRAM_ATTR const uint8_t DITHER_THRESHOLDS[8] = {16, 144, 80, 208, 48, 176, 112, 240};
+#define DITHER_SETTLED 128
+
+// 每次推送从开始填充RMT到发送完成的耗时
+MetricHistogram showTime("led.show_us");
+
+} // namespace
+
+bool LedOutput::begin(uint16_t frameMs, BaseType_t core) {
+    if (_task) return true;
+
+    _frameMs = frameMs ? frameMs : 1;
+    EngineEvents::addListener(this);
+    if (xTaskCreatePinnedToCore(taskEntry, "ledShow", LED_OUTPUT_TASK_STACK, this,
+                                LED_OUTPUT_TASK_PRIO, &_task, core) != pdPASS) {
+        _task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void LedOutput::requestShow() {
+    _requests++;
+
+    // 找出变化的LED范围，帧内容变化时才重新计算功率
+    uint16_t first = 0;
+    uint16_t last = NUM_LEDS;
+    if (_shadowValid) {
+        while (first < NUM_LEDS && _shadow[first] == leds[first]) first++;
+        while (last > first && _shadow[last - 1] == leds[last - 1]) last--;
+    }
+    bool frameChanged = first < last;
+    if (frameChanged) {
+        memcpy(_shadow + first, leds + first, (last - first) * sizeof(CRGB));
+        markDirty(first, last);
+        _unscaledPowerMw = calculate_unscaled_power_mW(_shadow, NUM_LEDS);
+    }
+
+    // 与上次推送的内容和亮度比较，相同则跳过（呼吸灯等效果量化后常有重复帧）
+    uint8_t brightness = limitBrightness(FastLED.getBrightness());
+    if (_shadowValid && !frameChanged && brightness == _shadowBrightness) {
+        _skipped++;
+        return;
+    }
+    _shadowBrightness = brightness;
+    _shadowValid = true;
+
+    if (!_task) {
+        // 没有推送任务时不会有后续帧来平均抖动误差，只做四舍五入
+        render(true);
+        return;
+    }
+
+    // 通知值在任务取走前会累加，推送期间的多次请求只引起一次后续推送
+    _pending++;
+    xTaskNotifyGive(_task);
+}
+
+void LedOutput::markDirty(uint16_t first, uint16_t last) {
+    uint32_t current = _dirty.load(std::memory_order_relaxed);
+    uint32_t merged;
+    do {
+        uint16_t lo = current & 0xFFFF;
+        uint16_t hi = current >> 16;
+        merged = (first < lo ? first : lo) | ((uint32_t)(last > hi ? last : hi) << 16);
+    } while (!_dirty.compare_exchange_weak(current, merged, std::memory_order_release, std::memory_order_relaxed));
+}
+
+uint8_t LedOutput::limitBrightness(uint8_t target) const {
+    if (_powerBudgetMw == 0) return target;
+
+    uint32_t available = _powerBudgetMw > _externalLoadMw ? _powerBudgetMw - _externalLoadMw : 0;
+
+    // 同 power_mgt：功率与亮度近似成正比
+    uint32_t requested = (_unscaledPowerMw * target) / 256;
+    if (requested <= available) return target;
+
+    return (uint8_t)((target * available) / requested);
+}
+
+void IRAM_ATTR LedOutput::render(bool settled) {
+    CLEDController& strip = FastLED[0];
+
+    // 亮度255对应256，颜色校正（未校正时为255）同样换算到256为1后乘进各通道的系数；
+    // gamma之后在16位上缩放，低亮度不会先被截成几级
+    uint32_t brightness = _shadowBrightness + (_shadowBrightness >> 7);
+    CRGB correction = strip.getAdjustment(255);
+    uint16_t scale[3];
+    for (uint8_t c = 0; c < 3; c++) {
+        scale[c] = (brightness * (correction.raw[c] + 1)) >> 8;
+    }
+
+    // 只重算变化过的LED；系数变了整条重算
+    uint32_t dirty = _dirty.exchange(DIRTY_NONE, std::memory_order_acquire);
+    uint16_t first = dirty & 0xFFFF;
+    uint16_t last = dirty >> 16;
+    if (memcmp(scale, _levelScale, sizeof(scale)) != 0) {
+        memcpy(_levelScale, scale, sizeof(scale));
+        first = 0;
+        last = NUM_LEDS;
+    }
+    for (uint16_t i = first; i < last; i++) {
+        for (uint8_t c = 0; c < 3; c++) {
+            _level[i][c] = (GAMMA16[_shadow[i].raw[c]] * scale[c]) >> 8;
+        }
+    }
+
+    bool fractional = false;
+    bool changed = !_frameValid;
+    for (uint8_t i = 0; i < NUM_LEDS; i++) {
+        // 各LED错开相位，整条灯带不会同步闪烁
+        uint32_t threshold = settled ? DITHER_SETTLED : DITHER_THRESHOLDS[(_ditherFrame + i) & 7];
+        for (uint8_t c = 0; c < 3; c++) {
+            uint32_t level = _level[i][c];
+            fractional |= (level & 0xFF) != 0;
+            uint32_t out = (level + threshold) >> 8;
+            uint8_t value = out > 255 ? 255 : out;
+            changed |= value != _frame[i].raw[c];
+            _frame[i].raw[c] = value;
+        }
+    }
+    _ditherFrame++;
+    _dithered = fractional && !settled;
+    if (!changed) {
+        _unchanged++;
+        return;
+    }
+
+    // 亮度和颜色校正已经算进_frame，推送时暂时去掉控制器的校正；
+    // 绕过FastLED.show()，灯带的数据指针仍是leds[]，测试命令可直接写
+    PROFILE_SCOPE(PROFILE_LED_SHOW);
+    CRGB colorCorrection = strip.getCorrection();
+    CRGB colorTemperature = strip.getTemperature();
+    strip.setCorrection(UncorrectedColor);
+    strip.setTemperature(UncorrectedTemperature);
+    int64_t started = esp_timer_get_time();
+    void* state = strip.beginShowLeds();
+    strip.showInternal(_frame, NUM_LEDS, 255);
+    strip.endShowLeds(state);
+    showTime.record((uint32_t)(esp_timer_get_time() - started));
+    strip.setCorrection(colorCorrection);
+    strip.setTemperature(colorTemperature);
+    _frameValid = true;
+    _shows++;
+}
+
+void LedOutput::taskEntry(void* arg) {
+    LedOutput* self = static_cast<LedOutput*>(arg);
+    for (;;) {
+        // 上一帧带抖动时最多等一帧：没有新请求（画面已静止）就按四舍五入再推一次，停在准确的颜色
+        TickType_t wait = self->_dithered ? pdMS_TO_TICKS(self->_frameMs) : portMAX_DELAY;
+        bool requested = ulTaskNotifyTake(pdTRUE, wait) > 0;
+
+        TickType_t start = xTaskGetTickCount();
+        uint32_t pending = self->_pending;
+        self->render(!requested);
+        self->_served = pending;
+        if (self->_wakeLoop) {
+            self->_wakeLoop = false;
+            LoopScheduler::instance().wake();
+        }
+
+        // 限制到每帧一次，这段时间内的请求合并到下一次推送
+        vTaskDelayUntil(&start, pdMS_TO_TICKS(self->_frameMs));
+    }
+}
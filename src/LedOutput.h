@@ -0,0 +1,191 @@
+/**
+ * @file LedOutput.h
+ * @brief 非阻塞的LED输出
+ * @details FastLED.show() 推送22颗WS2812约需700µs，且在IDF4的RMT驱动中会等待发送完成。
+ * 这里把show()放到独立的低优先级任务中：
+ * - requestShow() 只发出任务通知，立即返回，按键处理不再等待LED线
+ * - 任务每帧最多执行一次show()，一帧内的多次请求合并为一次
+ * - 未启动任务时 requestShow() 退回同步show()，行为与之前一致
+ * - 保存上次推送的 leds[] 副本，输出字节和亮度都没变时不再推送
+ * - 请求时找出与副本不同的LED范围（脏范围，多次请求合并），推送时只对这些LED重新查gamma表和缩放，
+ *   缩放后的16位线性值按LED缓存；亮度或颜色校正变化时整条重算。
+ *   抖动后的输出字节与上次推送的相同时（如静止画面的最后一次四舍五入）不再发送到灯带
+ * - FastLED的颜色校正和色温预先乘进各通道的缩放系数，推送时驱动不再逐字节校正
+ * - 按功率预算限制亮度：帧内容变化时用 power_mgt 重新计算未缩放功率并缓存，
+ *   每次推送按预算减去背光等外部负载后的剩余功率求出亮度上限
+ * - 推送时把 leds[] 副本经gamma表（LED_GAMMA）换算为16位，按亮度缩放后加时间抖动取高8位：
+ *   低亮度渐变时相邻帧在两级之间交替，平均出中间值；画面静止后再推一帧四舍五入的结果，不会闪烁。
+ *   FastLED自带的抖动已关闭，测试命令直接调用 FastLED.show() 时输出未经gamma的原值
+ * - RMT中断在第一次show()的核心（即本任务所在核心）上分配。灯带独占4块RMT内存
+ *   （platformio.ini中的FASTLED_RMT_MEM_BLOCKS），每次补充96个脉冲，
+ *   中断可被推迟约120µs而不断帧；补充时每个字节按查找表复制8个脉冲（FASTLED_RMT_BYTE_TABLE），
+ *   中断本身更短，留给其他中断的余量更大
+ * - IDF4的RMT驱动在show()中等到发送完成才返回，每次推送的耗时记入直方图 led.show_us（metrics命令）。
+ *   推送完成后按需唤醒主循环：上一帧还没发出时主循环不合成下一帧（isBusy/wakeWhenDone），
+ *   合成和发送交替进行，不会合成注定被合并掉的帧
+ * - 订阅FastLED的引擎事件：测试命令等直接调用 FastLED.show() 后自动使副本失效
+ *
+ * @author Calculator Project
+ */
+
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "config.h"
+
+class LedOutput : private EngineEvents::Listener {
+public:
+    /**
+     * @brief 获取单例实例
+     */
+    static LedOutput& instance() {
+        static LedOutput instance;
+        return instance;
+    }
+
+    /**
+     * @brief 启动LED推送任务
+     * @param frameMs 两次show()之间的最小间隔
+     * @param core 任务所在核心
+     * @return 任务创建成功返回true
+     */
+    bool begin(uint16_t frameMs, BaseType_t core);
+
+    /**
+     * @brief 请求把 leds[] 推送到灯带（不阻塞）
+     */
+    void requestShow();
+
+    /**
+     * @brief 设置LED可用的总功率预算
+     * @param budgetMw 总预算(mW)，0表示不限制
+     */
+    void setPowerBudget(uint32_t budgetMw) { _powerBudgetMw = budgetMw; }
+
+    /**
+     * @brief 设置LED以外的负载功率（基础功耗、背光等）
+     * @param loadMw 外部负载(mW)，从总预算中扣除
+     */
+    void setExternalLoad(uint32_t loadMw) { _externalLoadMw = loadMw; }
+
+    /**
+     * @brief 最近一次推送使用的亮度（已按功率预算限制）
+     */
+    uint8_t getAppliedBrightness() const { return _shadowBrightness; }
+
+    /**
+     * @brief 使上次推送的副本失效，下一次请求一定推送
+     * @details 绕过本模块直接调用 FastLED.show() 后使用
+     */
+    void invalidate() {
+        _shadowValid = false;
+        _frameValid = false;
+    }
+
+    /**
+     * @brief 已请求的推送是否都已完成（浅睡眠前检查，睡眠期间RMT停止）
+     */
+    bool isIdle() const { return _served == _pending && !_dithered; }
+
+    /**
+     * @brief 已请求的推送还没有发送完成（同步推送时总是false）
+     */
+    bool isBusy() const { return _served != _pending; }
+
+    /**
+     * @brief 当前推送发送完成后唤醒主循环（LoopScheduler::wake），只唤醒一次
+     */
+    void wakeWhenDone() { _wakeLoop = true; }
+
+    /**
+     * @brief 是否使用异步推送
+     */
+    bool isAsync() const { return _task != nullptr; }
+
+    /**
+     * @brief 累计收到的推送请求数
+     */
+    uint32_t getRequestCount() const { return _requests; }
+
+    /**
+     * @brief 累计实际执行的show()次数
+     */
+    uint32_t getShowCount() const { return _shows; }
+
+    /**
+     * @brief 因输出未变化而跳过的请求数
+     */
+    uint32_t getSkippedCount() const { return _skipped; }
+
+    /**
+     * @brief 输出字节与上次推送相同而没有发送的帧数
+     */
+    uint32_t getUnchangedCount() const { return _unchanged; }
+
+private:
+    static const uint32_t DIRTY_NONE = 0x0000FFFF;     ///< 空的脏范围（起点0xFFFF，终点0）
+
+    LedOutput() : _task(nullptr), _frameMs(10), _requests(0), _shows(0), _skipped(0), _unchanged(0),
+                  _pending(0), _served(0), _wakeLoop(false),
+                  _shadowBrightness(0), _shadowValid(false), _dirty(DIRTY_NONE),
+                  _levelScale{0, 0, 0}, _frameValid(false), _ditherFrame(0), _dithered(false),
+                  _powerBudgetMw(0), _externalLoadMw(0), _unscaledPowerMw(0) {}
+
+    /**
+     * @brief 把[first, last)并入脏范围（请求方调用，推送任务取走）
+     */
+    void markDirty(uint16_t first, uint16_t last);
+
+    /**
+     * @brief 按功率预算求亮度上限
+     * @param target 期望亮度
+     */
+    uint8_t limitBrightness(uint8_t target) const;
+
+    /**
+     * @brief 把 _shadow 经gamma和亮度换算后写入 _frame 并推送
+     * @param settled true时四舍五入，false时加本帧的抖动阈值
+     */
+    void render(bool settled);
+
+    // EngineEvents::Listener：FastLED.show() 推送了 leds[]，灯带上已不是_frame
+    void onEndShowLeds() override { invalidate(); }
+
+    LedOutput(const LedOutput&) = delete;
+    LedOutput& operator=(const LedOutput&) = delete;
+
+    static void taskEntry(void* arg);
+
+    TaskHandle_t _task;         ///< 推送任务
+    uint16_t _frameMs;          ///< 最小推送间隔
+    volatile uint32_t _requests; ///< 推送请求数
+    volatile uint32_t _shows;   ///< 实际推送次数
+    uint32_t _skipped;          ///< 跳过的请求数
+    volatile uint32_t _unchanged; ///< 输出未变而没有发送的帧数
+    volatile uint32_t _pending; ///< 发给任务的推送请求数
+    volatile uint32_t _served;  ///< 任务开始推送时看到的请求数，推送完成后更新
+    volatile bool _wakeLoop;    ///< 推送完成后唤醒主循环
+
+    CRGB _shadow[NUM_LEDS];     ///< 上次请求推送的 leds[]
+    uint8_t _shadowBrightness;  ///< 上次请求推送时的亮度（已按功率预算限制）
+    bool _shadowValid;          ///< 副本是否有效
+    std::atomic<uint32_t> _dirty; ///< 副本中还没有重新缩放的LED范围：起点(低16位) | 终点(高16位，不含)
+
+    uint16_t _level[NUM_LEDS][3]; ///< gamma和缩放之后的16位线性值（推送任务独占）
+    uint16_t _levelScale[3];    ///< _level使用的各通道缩放系数（亮度乘颜色校正，256为1）
+    CRGB _frame[NUM_LEDS];      ///< gamma、亮度和抖动之后实际推送的数据
+    bool _frameValid;           ///< 灯带上显示的就是_frame
+    uint8_t _ditherFrame;       ///< 抖动相位，每次推送加一
+    volatile bool _dithered;    ///< 最后推送的帧带抖动，静止后还需推一次四舍五入的结果
+
+    // 功率限制
+    uint32_t _powerBudgetMw;    ///< 总功率预算（0表示不限制）
+    uint32_t _externalLoadMw;   ///< LED以外的负载
+    uint32_t _unscaledPowerMw;  ///< 当前帧满亮度时的功率（帧变化时更新）
+};
+
+#endif // LED_OUTPUT_H
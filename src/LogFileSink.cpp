@@ -0,0 +1,197 @@
+/**
+ * @file LogFileSink.cpp
+ * @brief 日志闪存环形文件实现
+ *
+ * @author Calculator Project
+ */
+
+#include "LogFileSink.h"
+#include <LittleFS.h>
+#include <esp_rom_crc.h>
+#include <string.h>
+
+#define LOG_FILE_PATH  "/diag.log"
+#define LOG_PAGE_MAGIC 0x44494147UL     // "DIAG"
+
+// 这里不能调用Logger（写入就发生在日志输出路径上），错误只打印到串口
+
+LogFileSink::LogFileSink()
+    : _ready(false),
+      _pageCount(0),
+      _pageIndex(0),
+      _sequence(0),
+      _pagesWritten(0),
+      _dirty(false),
+      _mutex(nullptr),
+      _page(nullptr) {
+}
+
+bool LogFileSink::begin(uint16_t pageCount) {
+    if (_ready) return true;
+    if (pageCount == 0) return false;
+
+    _page = (uint8_t*)malloc(PAGE_SIZE);
+    _mutex = xSemaphoreCreateMutex();
+    if (!_page || !_mutex) {
+        Serial.println("⚠️ 日志文件缓冲分配失败");
+        return false;
+    }
+    memset(_page, 0, PAGE_SIZE);
+    _pageCount = pageCount;
+
+    // 首次使用时分区未格式化，允许自动格式化
+    if (!LittleFS.begin(true)) {
+        Serial.println("⚠️ LittleFS挂载失败，日志不会保存到闪存");
+        return false;
+    }
+
+    // 文件大小不对（首次使用或页数改变）时重建，之后只在原位置覆盖
+    File file = LittleFS.exists(LOG_FILE_PATH) ? LittleFS.open(LOG_FILE_PATH, "r") : File();
+    bool valid = file && file.size() == (size_t)pageCount * PAGE_SIZE;
+    uint32_t newest = 0;
+    int32_t newestIndex = -1;
+    if (valid) {
+        // 只读页头，找到最新的一页
+        PageHeader header;
+        for (uint16_t i = 0; i < pageCount; i++) {
+            if (!file.seek((size_t)i * PAGE_SIZE) ||
+                file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
+                break;
+            }
+            if (header.magic == LOG_PAGE_MAGIC &&
+                (newestIndex < 0 || (int32_t)(header.sequence - newest) > 0)) {
+                newest = header.sequence;
+                newestIndex = i;
+            }
+        }
+    }
+    if (file) file.close();
+
+    if (!valid) {
+        file = LittleFS.open(LOG_FILE_PATH, "w");
+        if (!file) {
+            Serial.println("⚠️ 日志文件创建失败");
+            return false;
+        }
+        for (uint16_t i = 0; i < pageCount; i++) {
+            file.write(_page, PAGE_SIZE);
+        }
+        file.close();
+    }
+
+    // 从最新一页之后的新页开始，不续写上次启动的半页
+    _sequence = newestIndex >= 0 ? newest + 1 : 0;
+    _pageIndex = newestIndex >= 0 ? (newestIndex + 1) % pageCount : 0;
+    _ready = true;
+
+    static const char BOOT_MARK[] = "\n--- 启动 ---\n";
+    write((const uint8_t*)BOOT_MARK, sizeof(BOOT_MARK) - 1, false);
+    return true;
+}
+
+void LogFileSink::write(const uint8_t* data, size_t length, bool urgent) {
+    if (!_ready || length > PAGE_DATA) return;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    PageHeader* header = (PageHeader*)_page;
+    if (header->used + length > PAGE_DATA) {
+        writePage();
+        nextPage();
+    }
+    memcpy(_page + sizeof(PageHeader) + header->used, data, length);
+    header->used += length;
+    _dirty = true;
+
+    if (urgent) {
+        writePage();
+    }
+    xSemaphoreGive(_mutex);
+}
+
+void LogFileSink::flush() {
+    if (!_ready) return;
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    writePage();
+    xSemaphoreGive(_mutex);
+}
+
+bool LogFileSink::writePage() {
+    if (!_dirty) return true;
+
+    PageHeader* header = (PageHeader*)_page;
+    header->magic = LOG_PAGE_MAGIC;
+    header->sequence = _sequence;
+    header->reserved = 0;
+    header->crc = esp_rom_crc32_le(0, _page + sizeof(PageHeader), header->used);
+
+    // 总是写整页，写入位置与LittleFS块对齐
+    File file = LittleFS.open(LOG_FILE_PATH, "r+");
+    if (!file) return false;
+    bool ok = file.seek((size_t)_pageIndex * PAGE_SIZE) && file.write(_page, PAGE_SIZE) == PAGE_SIZE;
+    file.close();
+
+    if (ok) {
+        _dirty = false;
+        _pagesWritten++;
+    }
+    return ok;
+}
+
+void LogFileSink::nextPage() {
+    _pageIndex = (_pageIndex + 1) % _pageCount;
+    _sequence++;
+    ((PageHeader*)_page)->used = 0;
+}
+
+void LogFileSink::dump(Print& out) {
+    if (!_ready) {
+        out.println("日志文件不可用");
+        return;
+    }
+    flush();
+
+    uint8_t* buffer = (uint8_t*)malloc(PAGE_SIZE);
+    if (!buffer) {
+        out.println("内存不足");
+        return;
+    }
+
+    // 当前页之后的一页是最旧的，按环形顺序输出即为时间顺序
+    File file = LittleFS.open(LOG_FILE_PATH, "r");
+    uint16_t start = (_pageIndex + 1) % _pageCount;
+    uint16_t pages = 0;
+    for (uint16_t n = 0; file && n < _pageCount; n++) {
+        uint16_t index = (start + n) % _pageCount;
+        if (!file.seek((size_t)index * PAGE_SIZE) || file.read(buffer, PAGE_SIZE) != PAGE_SIZE) break;
+
+        const PageHeader* header = (const PageHeader*)buffer;
+        if (header->magic != LOG_PAGE_MAGIC || header->used > PAGE_DATA ||
+            header->crc != esp_rom_crc32_le(0, buffer + sizeof(PageHeader), header->used)) {
+            continue;
+        }
+        out.printf("\n=== 日志页 %lu ===\n", (unsigned long)header->sequence);
+        out.write(buffer + sizeof(PageHeader), header->used);
+        pages++;
+    }
+    if (file) file.close();
+    free(buffer);
+
+    out.printf("\n=== 共 %u 页 ===\n", pages);
+}
+
+void LogFileSink::erase() {
+    if (!_ready) return;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    memset(_page, 0, PAGE_SIZE);
+    File file = LittleFS.open(LOG_FILE_PATH, "w");
+    if (file) {
+        for (uint16_t i = 0; i < _pageCount; i++) {
+            file.write(_page, PAGE_SIZE);
+        }
+        file.close();
+    }
+    _pageIndex = 0;
+    _dirty = false;
+    xSemaphoreGive(_mutex);
+}
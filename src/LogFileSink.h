@@ -0,0 +1,91 @@
+/**
+ * @file LogFileSink.h
+ * @brief 日志的闪存环形文件（LOG_OUTPUT_FILE）
+ * @details 日志以二进制帧（与串口二进制输出相同的格式）保存在LittleFS中一个固定大小的文件里：
+ * - 文件按4KB分页，页是写入单位；每页带序号和CRC，写满后覆盖最旧的一页
+ * - 帧先放进内存中的当前页，页写满时整页写入；错误日志或进入休眠前立即写入当前页
+ * - 启动时只读各页的页头，按最大序号继续
+ * - dump()按时间顺序输出全部有效页，用 tools/log_decode.py 解码
+ *
+ * @author Calculator Project
+ */
+
+#ifndef LOG_FILE_SINK_H
+#define LOG_FILE_SINK_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+class LogFileSink {
+public:
+    static const size_t PAGE_SIZE = 4096;       ///< 页大小，与LittleFS块大小一致
+
+    static LogFileSink& instance() {
+        static LogFileSink instance;
+        return instance;
+    }
+
+    /**
+     * @brief 挂载文件系统并打开（必要时创建）环形文件
+     * @param pageCount 页数，文件大小为pageCount × PAGE_SIZE
+     * @return 成功返回true；失败时write()直接丢弃
+     */
+    bool begin(uint16_t pageCount);
+
+    /**
+     * @brief 追加一帧
+     * @param urgent true时立即写入当前页（错误日志）
+     */
+    void write(const uint8_t* data, size_t length, bool urgent);
+
+    /**
+     * @brief 把当前页写入闪存（进入休眠前调用）
+     */
+    void flush();
+
+    /**
+     * @brief 按时间顺序输出全部有效页的内容
+     * @param out 输出目标（通常为Serial）
+     */
+    void dump(Print& out);
+
+    /**
+     * @brief 清空全部页
+     */
+    void erase();
+
+    bool isReady() const { return _ready; }
+    uint16_t getPageCount() const { return _pageCount; }
+    uint32_t getPagesWritten() const { return _pagesWritten; }
+
+private:
+    LogFileSink();
+
+    /**
+     * @brief 页头
+     */
+    struct PageHeader {
+        uint32_t magic;             ///< 固定魔数
+        uint32_t sequence;          ///< 页序号，递增，决定时间顺序
+        uint16_t used;              ///< 页头之后已用的字节数
+        uint16_t reserved;
+        uint32_t crc;               ///< 已用数据的CRC32
+    };
+
+    static const size_t PAGE_DATA = PAGE_SIZE - sizeof(PageHeader);
+
+    bool writePage();                           // 写入当前页（不换页）
+    void nextPage();                            // 换到下一页
+
+    bool _ready;
+    uint16_t _pageCount;
+    uint16_t _pageIndex;                        ///< 当前页在文件中的位置
+    uint32_t _sequence;                         ///< 当前页的序号
+    uint32_t _pagesWritten;                     ///< 本次启动写入闪存的次数
+    bool _dirty;                                ///< 当前页有未写入的数据
+    SemaphoreHandle_t _mutex;                   ///< 输出任务和主循环都会调用
+    uint8_t* _page;                             ///< 当前页缓冲（页头 + 数据）
+};
+
+#endif // LOG_FILE_SINK_H
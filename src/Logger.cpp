@@ -8,14 +8,105 @@
  */
 
 #include "Logger.h"
+#include "LogFileSink.h"
+#include "ConfigManager.h"
+#include "Console.h"
 #include <stdarg.h>
 #include <stdio.h>
+#include <stddef.h>
 #include <time.h>
 #include <sys/time.h>
 #include <string.h>
 
+// 最近日志环形缓冲的锁（同步输出时多个任务可能同时写入）
+static portMUX_TYPE recentMux = portMUX_INITIALIZER_UNLOCKED;
+// 令牌桶的锁（各核心的调用方共用）
+static portMUX_TYPE bucketMux = portMUX_INITIALIZER_UNLOCKED;
+static_assert((CRASH_LOG_BYTES & (CRASH_LOG_BYTES - 1)) == 0, "CRASH_LOG_BYTES必须是2的幂（累计字节数回绕后位置连续）");
+
 // 静态成员初始化
 Logger* Logger::_instance = nullptr;
+log_level_t Logger::_slotLevel[Logger::TAG_SLOTS] = {};     // 全为LOG_LEVEL_NONE，begin()之前不输出
+uint32_t Logger::_traceMask = 0;
+
+// 串口命令
+static void cmdLogBinary(const ConsoleArgs& args) {
+    if (args.is(1, "on")) {
+        Logger::getInstance().setBinaryOutput(true);
+    } else if (args.is(1, "off")) {
+        Logger::getInstance().setBinaryOutput(false);
+    } else {
+        Serial.println("无效的 'log_binary' 命令格式. 使用: log_binary <on|off>");
+    }
+}
+
+static void cmdLogClear(const ConsoleArgs& args) {
+    LogFileSink::instance().erase();
+    Serial.println("闪存日志已清空");
+}
+
+static void cmdLogDump(const ConsoleArgs& args) {
+    Logger::getInstance().flush();
+    LogFileSink::instance().dump(Serial);
+}
+
+static void cmdLogLevel(const ConsoleArgs& args) {
+    int level;
+    if (!args.toInt(1, level)) {
+        Serial.println("无效的 'log_level' 命令格式. 使用: log_level <0-5>");
+    } else if (level >= LOG_LEVEL_NONE && level <= LOG_LEVEL_VERBOSE) {
+        ConfigManager::getInstance().setLogLevel(level);      // 由main注册的配置观察者生效
+        Serial.printf("日志级别已设置为 %d 并保存到配置\n", level);
+    } else {
+        Serial.println("无效的日志级别");
+    }
+}
+
+static void cmdLogTag(const ConsoleArgs& args) {
+    Logger& logger = Logger::getInstance();
+    int level;
+    if (args.count == 1) {
+        logger.printTagLevels(Serial);
+    } else if (args.count == 3 && args.is(2, "off")) {
+        logger.clearTagLevel(args.arg(1));
+    } else if (args.count == 3 && args.toInt(2, level) && level >= LOG_LEVEL_NONE && level <= LOG_LEVEL_VERBOSE) {
+        if (!logger.setTagLevel(args.arg(1), (log_level_t)level)) {
+            Serial.printf("单独设置级别的标签已满（%u个）\n", Logger::MAX_TAG_LEVELS);
+        }
+    } else {
+        Serial.println("无效的 'log_tag' 命令格式. 使用: log_tag <标签> <0-5|off>");
+    }
+}
+
+static void cmdTrace(const ConsoleArgs& args) {
+    Logger& logger = Logger::getInstance();
+    if (args.count == 1) {
+        uint32_t mask = logger.getTraceMask();
+        Serial.printf("跟踪: key=%s core=%s display=%s\n",
+                      (mask & TRACE_KEY) ? "开" : "关",
+                      (mask & TRACE_CORE) ? "开" : "关",
+                      (mask & TRACE_DISPLAY) ? "开" : "关");
+        return;
+    }
+
+    uint32_t category = Logger::traceCategoryFromName(args.arg(1));
+    if (category && (args.is(2, "on") || args.is(2, "off"))) {
+        uint32_t mask = logger.getTraceMask();
+        logger.setTraceMask(args.is(2, "on") ? (mask | category) : (mask & ~category));
+    } else {
+        Serial.println("无效的 'trace' 命令格式. 使用: trace <key|core|display|all> <on|off>");
+    }
+}
+
+static constexpr ConsoleCommand LOG_COMMANDS[] = {
+    {"log_binary", "<on|off>", "二进制日志输出（用 tools/log_decode.py 解码）", cmdLogBinary},
+    {"log_clear", "", "清空闪存中保存的日志", cmdLogClear},
+    {"log_dump", "", "输出闪存中保存的日志（二进制帧，用 tools/log_decode.py 解码）", cmdLogDump},
+    {"log_level", "<lvl>", "设置日志级别 (0:无, 1:错误, 2:警告, 3:信息, 4:调试, 5:详细)", cmdLogLevel},
+    {"log_tag", "[标签 <0-5|off>]", "单独设置某个标签的日志级别（不保存）；不带参数列出已设置的标签", cmdLogTag},
+    {"trace", "[key|core|display|all] [on|off]", "开关跟踪输出；不带参数显示当前状态", cmdTrace},
+};
+static_assert(consoleSorted(LOG_COMMANDS), "命令表必须按名称排序");
 
 Logger& Logger::getInstance() {
     static Logger instance;
@@ -32,13 +123,15 @@ LoggerConfig Logger::getDefaultConfig() {
     config.level = LOG_LEVEL_INFO;
     #endif
     
-    config.output = LOG_OUTPUT_SERIAL;
+    config.output = LOG_FILE_ENABLED ? LOG_OUTPUT_BOTH : LOG_OUTPUT_SERIAL;
     config.showTimestamp = true;
     config.showLevel = true;
     config.showTag = true;
     config.colorOutput = true;
     config.baudRate = 115200;
     config.bufferSize = 1024;
+    config.asyncOutput = true;
+    config.binaryOutput = false;
     
     return config;
 }
@@ -58,31 +151,123 @@ bool Logger::begin(const LoggerConfig& config) {
     
     // 设置ESP-IDF日志级别
     esp_log_level_set("*", toEspLogLevel(_config.level));
+    esp_log_level_set(TAG_TRACE, ESP_LOG_VERBOSE);     // 跟踪由类别掩码过滤
     
     // 配置ESP-IDF日志输出格式
     if (_config.colorOutput) {
         esp_log_set_vprintf(vprintf);
     }
     
+    rebuildSlots();
+    for (uint8_t s = 0; s < TAG_SLOTS; s++) {
+        _buckets[s].refillMs = millis();
+        _buckets[s].tokens = LOG_RATE_BURST;
+        _buckets[s].suppressed = 0;
+        _buckets[s].tag = nullptr;
+    }
+    _suppressReportMs = millis();
+    
+    // 闪存日志文件不可用时只输出到串口
+    if ((_config.output & LOG_OUTPUT_FILE) && !LogFileSink::instance().begin(LOG_FILE_PAGES)) {
+        _config.output = (log_output_t)(_config.output & ~LOG_OUTPUT_FILE);
+    }
     _initialized = true;
+    Console::instance().addCommands(LOG_COMMANDS);
+    
+    // 按键路径上的日志只入队，由低优先级任务输出
+    if (_config.asyncOutput && !_drainTask) {
+        if (xTaskCreate(drainTaskEntry, "logDrain", DRAIN_TASK_STACK, this,
+                        DRAIN_TASK_PRIO, &_drainTask) != pdPASS) {
+            _drainTask = nullptr;
+            Serial.println("⚠️ 日志输出任务创建失败，使用同步输出");
+        }
+    }
     
     // 输出系统启动日志
     info(TAG_SYSTEM, "日志级别: %s", getLevelString(_config.level));
     info(TAG_SYSTEM, "彩色输出: %s", _config.colorOutput ? "已启用" : "已禁用");
     info(TAG_SYSTEM, "波特率: %lu", _config.baudRate);
+    info(TAG_SYSTEM, "输出方式: %s", _drainTask ? "异步" : "同步");
     
     return true;
 }
 
 void Logger::setLevel(log_level_t level) {
     _config.level = level;
+    rebuildSlots();
     esp_log_level_set("*", toEspLogLevel(level));
+    esp_log_level_set(TAG_TRACE, ESP_LOG_VERBOSE);     // "*"会清除各标签的设置，重新设置
+    for (uint8_t i = 0; i < _tagLevelCount; i++) {
+        esp_log_level_set(_tagLevels[i].tag, toEspLogLevel(_tagLevels[i].level));
+    }
     info(TAG_SYSTEM, "全局日志级别设置为: %s", getLevelString(level));
 }
 
-void Logger::setTagLevel(const char* tag, log_level_t level) {
-    esp_log_level_set(tag, toEspLogLevel(level));
-    info(TAG_SYSTEM, "标签 '%s' 的日志级别设置为: %s", tag, getLevelString(level));
+bool Logger::setTagLevel(const char* tag, log_level_t level) {
+    uint8_t i = 0;
+    while (i < _tagLevelCount && strcmp(_tagLevels[i].tag, tag) != 0) i++;
+    if (i == _tagLevelCount) {
+        if (_tagLevelCount == MAX_TAG_LEVELS) return false;
+        strncpy(_tagLevels[i].tag, tag, TAG_NAME_BYTES - 1);
+        _tagLevels[i].tag[TAG_NAME_BYTES - 1] = '\0';
+        _tagLevels[i].slot = tagSlot(_tagLevels[i].tag);
+        _tagLevelCount++;
+    }
+    _tagLevels[i].level = level;
+    rebuildSlots();
+    // 输出时仍经过esp_log的按标签过滤，保持一致（只有通过了上面检查的日志才会走到那里）
+    esp_log_level_set(_tagLevels[i].tag, toEspLogLevel(level));
+    info(TAG_SYSTEM, "标签 '%s' 的日志级别设置为: %s", _tagLevels[i].tag, getLevelString(level));
+    return true;
+}
+
+void Logger::clearTagLevel(const char* tag) {
+    for (uint8_t i = 0; i < _tagLevelCount; i++) {
+        if (strcmp(_tagLevels[i].tag, tag) != 0) continue;
+        esp_log_level_set(_tagLevels[i].tag, toEspLogLevel(_config.level));
+        _tagLevels[i] = _tagLevels[--_tagLevelCount];
+        rebuildSlots();
+        info(TAG_SYSTEM, "标签 '%s' 恢复为全局日志级别", tag);
+        return;
+    }
+}
+
+void Logger::printTagLevels(Print& out) {
+    out.printf("全局日志级别: %s\n", getLevelString(_config.level));
+    if (_tagLevelCount == 0) {
+        out.println("没有单独设置级别的标签");
+        return;
+    }
+    for (uint8_t i = 0; i < _tagLevelCount; i++) {
+        out.printf(" - %-16s %-8s 槽位 %u\n", _tagLevels[i].tag, getLevelString(_tagLevels[i].level),
+                   _tagLevels[i].slot);
+    }
+}
+
+void Logger::rebuildSlots() {
+    log_level_t slots[TAG_SLOTS];
+    uint64_t overrides = 0;
+    for (uint8_t s = 0; s < TAG_SLOTS; s++) slots[s] = _config.level;
+    for (uint8_t i = 0; i < _tagLevelCount; i++) {
+        const TagLevel& entry = _tagLevels[i];
+        overrides |= 1ULL << entry.slot;
+        if (entry.level > slots[entry.slot]) slots[entry.slot] = entry.level;
+    }
+    // 先放宽确认条件再改槽位级别，其他任务的调用在两步之间也不会漏掉确认
+    _overrideSlots |= overrides;
+    memcpy(_slotLevel, slots, sizeof(slots));
+    _overrideSlots = overrides;
+}
+
+bool Logger::tagAllows(log_level_t level, const char* tag, uint8_t slot) const {
+    if (level > _slotLevel[slot]) return false;
+    if (!(_overrideSlots & (1ULL << slot))) return true;      // 槽位级别即全局级别
+    for (uint8_t i = 0; i < _tagLevelCount; i++) {
+        if (_tagLevels[i].slot == slot && strcmp(_tagLevels[i].tag, tag) == 0) {
+            return level <= _tagLevels[i].level;
+        }
+    }
+    return level <= _config.level;      // 与单独设置的标签共用槽位
 }
 
 void Logger::setColorOutput(bool enable) {
@@ -90,6 +275,13 @@ void Logger::setColorOutput(bool enable) {
     info(TAG_SYSTEM, "彩色输出 %s", enable ? "已启用" : "已禁用");
 }
 
+void Logger::setBinaryOutput(bool enable) {
+    // 切换前输出提示，保证它以当前格式出现
+    info(TAG_SYSTEM, "二进制日志输出 %s", enable ? "已启用" : "已禁用");
+    flush();
+    _config.binaryOutput = enable;
+}
+
 void Logger::setCustomFormat(bool enable) {
     _customFormat = enable;
     if (enable) {
@@ -151,105 +343,165 @@ const char* Logger::getLevelChar(log_level_t level) {
 }
 
 void Logger::error(const char* tag, const char* format, ...) {
-    if (!_initialized) return;
-    
     va_list args;
     va_start(args, format);
-    
-    if (_customFormat) {
-        formatAndPrint(LOG_LEVEL_ERROR, tag, format, args);
-    } else {
-        char newFormat[256];
-        size_t len = strlen(format);
-        if (len > 0 && format[len - 1] != '\n' && len < sizeof(newFormat) - 2) {
-            strcpy(newFormat, format);
-            newFormat[len] = '\n';
-            newFormat[len + 1] = '\0';
-            format = newFormat;
-        }
-        esp_log_writev(ESP_LOG_ERROR, tag, format, args);
-    }
-    
+    logv(LOG_LEVEL_ERROR, tag, format, args);
     va_end(args);
 }
 
 void Logger::warn(const char* tag, const char* format, ...) {
-    if (!_initialized) return;
-    
     va_list args;
     va_start(args, format);
-    
-    if (_customFormat) {
-        formatAndPrint(LOG_LEVEL_WARN, tag, format, args);
-    } else {
-        char newFormat[256];
-        size_t len = strlen(format);
-        if (len > 0 && format[len - 1] != '\n' && len < sizeof(newFormat) - 2) {
-            strcpy(newFormat, format);
-            newFormat[len] = '\n';
-            newFormat[len + 1] = '\0';
-            format = newFormat;
-        }
-        esp_log_writev(ESP_LOG_WARN, tag, format, args);
-    }
-    
+    logv(LOG_LEVEL_WARN, tag, format, args);
     va_end(args);
 }
 
 void Logger::info(const char* tag, const char* format, ...) {
-    if (!_initialized) return;
-    
     va_list args;
     va_start(args, format);
-    
-    if (_customFormat) {
-        formatAndPrint(LOG_LEVEL_INFO, tag, format, args);
-    } else {
-        char newFormat[256];
-        size_t len = strlen(format);
-        if (len > 0 && format[len - 1] != '\n' && len < sizeof(newFormat) - 2) {
-            strcpy(newFormat, format);
-            newFormat[len] = '\n';
-            newFormat[len + 1] = '\0';
-            format = newFormat;
-        }
-        esp_log_writev(ESP_LOG_INFO, tag, format, args);
-    }
-    
+    logv(LOG_LEVEL_INFO, tag, format, args);
     va_end(args);
 }
 
 void Logger::debug(const char* tag, const char* format, ...) {
-    if (!_initialized) return;
-    
     va_list args;
     va_start(args, format);
-    
-    if (_customFormat) {
-        formatAndPrint(LOG_LEVEL_DEBUG, tag, format, args);
-    } else {
-        char newFormat[256];
-        size_t len = strlen(format);
-        if (len > 0 && format[len - 1] != '\n' && len < sizeof(newFormat) - 2) {
-            strcpy(newFormat, format);
-            newFormat[len] = '\n';
-            newFormat[len + 1] = '\0';
-            format = newFormat;
-        }
-        esp_log_writev(ESP_LOG_DEBUG, tag, format, args);
-    }
-    
+    logv(LOG_LEVEL_DEBUG, tag, format, args);
     va_end(args);
 }
 
 void Logger::verbose(const char* tag, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logv(LOG_LEVEL_VERBOSE, tag, format, args);
+    va_end(args);
+}
+
+void Logger::trace(const char* format, ...) {
     if (!_initialized) return;
-    
     va_list args;
     va_start(args, format);
+    dispatch(LOG_LEVEL_DEBUG, TAG_TRACE, format, args);
+    va_end(args);
+}
+
+void Logger::setTraceMask(uint32_t mask) {
+    _traceMask = mask;
+    info(TAG_SYSTEM, "跟踪类别: 0x%02lx", (unsigned long)mask);
+}
+
+uint32_t Logger::traceCategoryFromName(const char* name) {
+    static const struct {
+        const char* name;
+        uint32_t category;
+    } CATEGORIES[] = {
+        {"key", TRACE_KEY},
+        {"core", TRACE_CORE},
+        {"display", TRACE_DISPLAY},
+        {"all", TRACE_ALL},
+    };
+    for (const auto& entry : CATEGORIES) {
+        if (strcasecmp(name, entry.name) == 0) return entry.category;
+    }
+    return 0;
+}
+
+void Logger::logv(log_level_t level, const char* tag, const char* format, va_list args) {
+    // 标签的级别不允许或超过限速的日志直接丢掉，不占队列（直接调用info()等时也在这里过滤）
+    if (!_initialized) return;
+    uint8_t slot = tagSlot(tag);
+    if (!tagAllows(level, tag, slot) || !rateAllows(level, tag, slot)) return;
+    dispatch(level, tag, format, args);
+}
+
+bool Logger::rateAllows(log_level_t level, const char* tag, uint8_t slot) {
+#if LOG_RATE_PER_SEC
+    if (level == LOG_LEVEL_ERROR) return true;
+    static const uint32_t FULL_MS = (uint32_t)LOG_RATE_BURST * 1000 / LOG_RATE_PER_SEC;
+    RateBucket& bucket = _buckets[slot];
+    uint32_t now = millis();
+    bool allowed;
+    portENTER_CRITICAL_SAFE(&bucketMux);
+    uint32_t elapsed = now - bucket.refillMs;
+    if (elapsed >= FULL_MS) {
+        bucket.tokens = LOG_RATE_BURST;
+        bucket.refillMs = now;
+    } else {
+        uint32_t refill = elapsed * LOG_RATE_PER_SEC / 1000;
+        if (refill) {
+            bucket.tokens = bucket.tokens + refill > LOG_RATE_BURST ? LOG_RATE_BURST : bucket.tokens + refill;
+            bucket.refillMs += refill * 1000 / LOG_RATE_PER_SEC;    // 不足一个令牌的时间留到下次
+        }
+    }
+    allowed = bucket.tokens > 0;
+    if (allowed) {
+        bucket.tokens--;
+    } else {
+        if (bucket.suppressed < UINT16_MAX) bucket.suppressed++;
+        bucket.tag = tag;
+    }
+    portEXIT_CRITICAL_SAFE(&bucketMux);
+    return allowed;
+#else
+    (void)level;
+    (void)tag;
+    (void)slot;
+    return true;
+#endif
+}
+
+void Logger::reportSuppressed() {
+    uint32_t now = millis();
+    if (now - _suppressReportMs < LOG_SUPPRESS_REPORT_MS) return;
+    uint32_t seconds = (now - _suppressReportMs + 500) / 1000;
+    _suppressReportMs = now;
+    for (uint8_t s = 0; s < TAG_SLOTS; s++) {
+        portENTER_CRITICAL(&bucketMux);
+        uint16_t suppressed = _buckets[s].suppressed;
+        const char* tag = _buckets[s].tag;
+        _buckets[s].suppressed = 0;
+        portEXIT_CRITICAL(&bucketMux);
+        if (suppressed == 0) continue;
+        char message[96];
+        snprintf(message, sizeof(message), "⚠️ 标签 %s 超过限速，%lu 秒内丢弃 %u 条",
+                 tag, (unsigned long)seconds, suppressed);
+        printMessage(LOG_LEVEL_WARN, TAG_SYSTEM, message, now);
+    }
+}
+
+void Logger::dispatch(log_level_t level, const char* tag, const char* format, va_list args) {
+    if (_drainTask) {
+        if (!enqueue(level, tag, format, args)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    
+    // 同步输出（输出任务启动前）同样编码一帧，保留在最近日志中
+    LogRecord record;
+    record.sequence = 0;
+    record.timestamp = millis();
+    record.tag = tag;
+    record.format = format;
+    record.level = level;
+    va_list copy;
+    va_copy(copy, args);
+    capture(record, copy);
+    va_end(copy);
+    
+    uint8_t frame[BINARY_FRAME_SIZE];
+    size_t length = encodeBinary(record, frame);
+    keepRecent(frame, length);
+    if (_config.output & LOG_OUTPUT_FILE) {
+        LogFileSink::instance().write(frame, length, level == LOG_LEVEL_ERROR);
+    }
+    if (_config.binaryOutput) {
+        Serial.write(frame, length);
+        return;
+    }
     
     if (_customFormat) {
-        formatAndPrint(LOG_LEVEL_VERBOSE, tag, format, args);
+        formatAndPrint(level, tag, format, args);
     } else {
         char newFormat[256];
         size_t len = strlen(format);
@@ -259,13 +511,25 @@ void Logger::verbose(const char* tag, const char* format, ...) {
             newFormat[len + 1] = '\0';
             format = newFormat;
         }
-        esp_log_writev(ESP_LOG_VERBOSE, tag, format, args);
+        esp_log_writev(toEspLogLevel(level), tag, format, args);
     }
-    
-    va_end(args);
 }
 
 void Logger::flush() {
+    // 等输出任务把队列清空（最多约200ms），再等串口发送完
+    if (_drainTask && xTaskGetCurrentTaskHandle() != _drainTask) {
+        for (uint8_t i = 0; i < 200; i++) {
+            bool empty = true;
+            for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+                empty &= _queues[core].empty();
+            }
+            if (empty) break;
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+    }
+    if (_config.output & LOG_OUTPUT_FILE) {
+        LogFileSink::instance().flush();
+    }
     if (_config.output & LOG_OUTPUT_SERIAL) {
         Serial.flush();
     }
@@ -277,10 +541,9 @@ int Logger::customVprintf(const char* format, va_list args) {
         char buffer[512];
         int len = vsnprintf(buffer, sizeof(buffer), format, args);
         
-        // 只输出到串口，不再通过 ESP-IDF 系统
+        // 只输出到串口，不再通过 ESP-IDF 系统；写入发送缓冲即返回，不等发完
         if (len > 0) {
             Serial.print(buffer);
-            Serial.flush();
         }
         return len;
     }
@@ -290,9 +553,26 @@ int Logger::customVprintf(const char* format, va_list args) {
 }
 
 void Logger::formatAndPrint(log_level_t level, const char* tag, const char* format, va_list args) {
-    // 获取时间戳
+    // 格式化消息内容
+    char message[512];
+    vsnprintf(message, sizeof(message), format, args);
+    printMessage(level, tag, message, millis());
+}
+
+void Logger::printMessage(log_level_t level, const char* tag, const char* text, uint32_t timestamp) {
+    if (!_customFormat) {
+        // 与同步模式的esp_log_writev输出一致：只有消息本身
+        size_t len = strlen(text);
+        esp_log_write(toEspLogLevel(level), tag, (len > 0 && text[len - 1] == '\n') ? "%s" : "%s\n", text);
+        return;
+    }
+    
+    // 获取时间戳（异步输出时回推到日志产生的时刻）
     struct timeval tv;
     gettimeofday(&tv, NULL);
+    int64_t us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec - (int64_t)(millis() - timestamp) * 1000;
+    tv.tv_sec = us / 1000000;
+    tv.tv_usec = us % 1000000;
     struct tm* timeinfo = localtime(&tv.tv_sec);
     
     char timeStr[32];
@@ -303,9 +583,9 @@ void Logger::formatAndPrint(log_level_t level, const char* tag, const char* form
         strcpy(timeStr, "");
     }
     
-    // 格式化消息内容
     char message[512];
-    vsnprintf(message, sizeof(message), format, args);
+    strncpy(message, text, sizeof(message) - 1);
+    message[sizeof(message) - 1] = '\0';
     
     // 移除末尾的换行符（如果有）
     size_t msgLen = strlen(message);
@@ -348,7 +628,386 @@ void Logger::formatAndPrint(log_level_t level, const char* tag, const char* form
     // 添加换行符
     pos += snprintf(finalOutput + pos, sizeof(finalOutput) - pos, "\n");
     
-    // 输出到串口
+    // 输出到串口（写入发送缓冲，需要等发完时调用flush()）
     Serial.print(finalOutput);
-    Serial.flush();
-}
\ No newline at end of file
+}
+const char* Logger::parseSpec(const char* p, FormatSpec& spec) {
+    spec.conversion = 0;
+    spec.longCount = 0;
+    spec.lengthModifier = 0;
+    spec.starCount = 0;
+    
+    // 标志
+    while (*p && strchr("-+ #0", *p)) p++;
+    
+    // 宽度和精度
+    if (*p == '*') {
+        spec.starCount++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec.starCount++;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') p++;
+        }
+    }
+    
+    // 长度修饰符
+    for (;;) {
+        if (*p == 'l') {
+            spec.longCount++;
+        } else if (*p == 'z' || *p == 'j' || *p == 't' || *p == 'L') {
+            spec.lengthModifier = *p;
+        } else if (*p != 'h') {
+            break;
+        }
+        p++;
+    }
+    
+    spec.conversion = *p;
+    return *p ? p + 1 : p;
+}
+
+bool Logger::enqueue(log_level_t level, const char* tag, const char* format, va_list args) {
+    MpscQueue<LogRecord, QUEUE_DEPTH>& queue = _queues[xPortGetCoreID()];
+    uint32_t ticket;
+    LogRecord* record = queue.reserve(ticket);
+    if (!record) return false;
+    
+    record->sequence = _sequence.fetch_add(1, std::memory_order_relaxed);
+    record->timestamp = millis();
+    record->tag = tag;
+    record->format = format;
+    record->level = level;
+    capture(*record, args);
+    
+    queue.commit(ticket);
+    return true;
+}
+
+void Logger::capture(LogRecord& record, va_list args) {
+    record.argCount = 0;
+    record.stringBytes = 0;
+    record.truncated = false;
+    
+    // 按格式说明符取出参数，类型必须与va_arg一致
+    const char* p = record.format;
+    while ((p = strchr(p, '%')) != nullptr) {
+        p++;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        
+        FormatSpec spec;
+        p = parseSpec(p, spec);
+        if (record.argCount + spec.starCount + 1 > MAX_ARGS) {
+            record.truncated = true;
+            break;
+        }
+        for (uint8_t i = 0; i < spec.starCount; i++) {
+            record.args[record.argCount++] = (uint64_t)(int64_t)va_arg(args, int);
+        }
+        
+        uint64_t value = 0;
+        switch (spec.conversion) {
+            case 'd': case 'i':
+                if (spec.longCount >= 2 || spec.lengthModifier == 'j') value = (uint64_t)va_arg(args, long long);
+                else if (spec.longCount == 1) value = (uint64_t)(int64_t)va_arg(args, long);
+                else if (spec.lengthModifier == 'z' || spec.lengthModifier == 't') value = (uint64_t)(int64_t)va_arg(args, ptrdiff_t);
+                else value = (uint64_t)(int64_t)va_arg(args, int);
+                break;
+            case 'u': case 'x': case 'X': case 'o': case 'c':
+                if (spec.longCount >= 2 || spec.lengthModifier == 'j') value = va_arg(args, unsigned long long);
+                else if (spec.longCount == 1) value = va_arg(args, unsigned long);
+                else if (spec.lengthModifier == 'z' || spec.lengthModifier == 't') value = va_arg(args, size_t);
+                else value = va_arg(args, unsigned int);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                double d = spec.lengthModifier == 'L' ? (double)va_arg(args, long double) : va_arg(args, double);
+                memcpy(&value, &d, sizeof(value));
+                break;
+            }
+            case 's': {
+                // 字符串可能在调用返回后失效，复制到记录里
+                const char* str = va_arg(args, const char*);
+                if (!str) str = "(null)";
+                size_t room = STRING_BYTES - record.stringBytes;
+                if (room < 2) {
+                    value = STRING_TRUNCATED;
+                    break;
+                }
+                size_t len = strlen(str);
+                if (len > room - 1) len = room - 1;
+                memcpy(record.strings + record.stringBytes, str, len);
+                record.strings[record.stringBytes + len] = '\0';
+                value = record.stringBytes;
+                record.stringBytes += len + 1;
+                break;
+            }
+            case 'p':
+            case 'n':
+                value = (uint64_t)(uintptr_t)va_arg(args, void*);
+                break;
+            default:
+                // 无法识别的说明符之后的参数类型未知，不再继续
+                record.truncated = true;
+                break;
+        }
+        if (record.truncated) break;
+        record.args[record.argCount++] = value;
+    }
+}
+
+void Logger::render(const LogRecord& record, char* buffer, size_t size) {
+    size_t pos = 0;
+    uint8_t argIndex = 0;
+    const char* p = record.format;
+    buffer[0] = '\0';
+    
+    while (*p && pos + 1 < size) {
+        if (*p != '%') {
+            buffer[pos++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            buffer[pos++] = '%';
+            p += 2;
+            continue;
+        }
+        
+        const char* start = p;
+        FormatSpec spec;
+        p = parseSpec(p + 1, spec);
+        if (argIndex + spec.starCount + 1 > record.argCount) {
+            // 参数没有保存（过多或说明符无法识别）
+            if (record.truncated) {
+                pos += snprintf(buffer + pos, size - pos, "...");
+            }
+            break;
+        }
+        
+        // 复制说明符，'*'替换为保存的数值，长度修饰符由下面按类型重新生成
+        char fmt[24];
+        size_t n = 0;
+        for (const char* q = start; q < p - 1 && n < sizeof(fmt) - 12; q++) {
+            if (*q == '*') {
+                n += snprintf(fmt + n, sizeof(fmt) - n, "%d", (int)(int64_t)record.args[argIndex++]);
+            } else if (!strchr("hlzjtL", *q)) {
+                fmt[n++] = *q;
+            }
+        }
+        
+        uint64_t value = record.args[argIndex++];
+        int written = 0;
+        size_t room = size - pos;
+        switch (spec.conversion) {
+            case 'd': case 'i':
+                memcpy(fmt + n, "lld", 4);
+                written = snprintf(buffer + pos, room, fmt, (long long)value);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                fmt[n] = 'l';
+                fmt[n + 1] = 'l';
+                fmt[n + 2] = spec.conversion;
+                fmt[n + 3] = '\0';
+                written = snprintf(buffer + pos, room, fmt, (unsigned long long)value);
+                break;
+            case 'c':
+                memcpy(fmt + n, "c", 2);
+                written = snprintf(buffer + pos, room, fmt, (int)value);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                fmt[n] = spec.conversion;
+                fmt[n + 1] = '\0';
+                written = snprintf(buffer + pos, room, fmt, d);
+                break;
+            }
+            case 's':
+                memcpy(fmt + n, "s", 2);
+                written = snprintf(buffer + pos, room, fmt,
+                                   value == STRING_TRUNCATED ? "..." : record.strings + value);
+                break;
+            case 'p':
+                memcpy(fmt + n, "p", 2);
+                written = snprintf(buffer + pos, room, fmt, (void*)(uintptr_t)value);
+                break;
+            default:
+                break;
+        }
+        if (written > 0) {
+            pos += (size_t)written < room ? (size_t)written : room - 1;
+        }
+    }
+    buffer[pos < size ? pos : size - 1] = '\0';
+}
+
+size_t Logger::encodeBinary(const LogRecord& record, uint8_t* frame) {
+    // 无符号LEB128变长整数
+    size_t pos = 2;
+    auto putVarint = [&](uint64_t value) {
+        while (value >= 0x80) {
+            frame[pos++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        frame[pos++] = (uint8_t)value;
+    };
+    // 有符号数先做zigzag，小的负数也只占一两个字节
+    auto putSigned = [&](uint64_t value) {
+        int64_t v = (int64_t)value;
+        putVarint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+    };
+    auto putAddress = [&](const void* address) {
+        uint32_t value = (uint32_t)(uintptr_t)address;
+        memcpy(frame + pos, &value, sizeof(value));
+        pos += sizeof(value);
+    };
+    
+    frame[0] = BINARY_FRAME_MAGIC;
+    frame[pos++] = record.level | (record.truncated ? 0x80 : 0);
+    putVarint(record.timestamp);
+    putAddress(record.tag);
+    putAddress(record.format);
+    
+    // 参数按格式串的顺序打包，解码端解析同一个格式串得到类型
+    uint8_t argIndex = 0;
+    const char* p = record.format;
+    while ((p = strchr(p, '%')) != nullptr) {
+        p++;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        
+        FormatSpec spec;
+        p = parseSpec(p, spec);
+        if (argIndex + spec.starCount + 1 > record.argCount) break;
+        for (uint8_t i = 0; i < spec.starCount; i++) {
+            putSigned(record.args[argIndex++]);
+        }
+        
+        uint64_t value = record.args[argIndex++];
+        switch (spec.conversion) {
+            case 'd': case 'i':
+                putSigned(value);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                memcpy(frame + pos, &value, sizeof(value));
+                pos += sizeof(value);
+                break;
+            case 's': {
+                // 长度字节0xFF表示字符串没有保存下来
+                if (value == STRING_TRUNCATED) {
+                    frame[pos++] = 0xFF;
+                    break;
+                }
+                const char* str = record.strings + value;
+                size_t len = strlen(str);
+                frame[pos++] = (uint8_t)len;
+                memcpy(frame + pos, str, len);
+                pos += len;
+                break;
+            }
+            default:
+                putVarint(value);
+                break;
+        }
+    }
+    
+    uint8_t checksum = 0;
+    for (size_t i = 2; i < pos; i++) {
+        checksum += frame[i];
+    }
+    frame[1] = (uint8_t)(pos - 2);
+    frame[pos++] = checksum;
+    return pos;
+}
+
+void Logger::keepRecent(const uint8_t* frame, size_t length) {
+    // 输出任务是唯一的写入者；同步输出时可能有多个任务，短暂加锁
+    portENTER_CRITICAL_SAFE(&recentMux);
+    for (size_t i = 0; i < length; i++) {
+        _recent[(_recentEnd + i) % CRASH_LOG_BYTES] = frame[i];
+    }
+    _recentEnd += length;
+    portEXIT_CRITICAL_SAFE(&recentMux);
+}
+
+size_t Logger::copyRecent(size_t offset, uint8_t* out, size_t size) const {
+    size_t length = recentLength();
+    if (offset >= length) return 0;
+    if (size > length - offset) size = length - offset;
+    uint32_t start = _recentEnd - length + offset;
+    for (size_t i = 0; i < size; i++) {
+        out[i] = _recent[(start + i) % CRASH_LOG_BYTES];
+    }
+    return size;
+}
+
+void Logger::drainTaskEntry(void* arg) {
+    static_cast<Logger*>(arg)->drainLoop();
+}
+
+void Logger::drainLoop() {
+    for (;;) {
+        while (drainOne()) {
+        }
+        
+        uint32_t dropped = _dropped.load(std::memory_order_relaxed);
+        if (dropped != _reportedDropped) {
+            char message[64];
+            snprintf(message, sizeof(message), "⚠️ 日志队列已满，丢弃 %lu 条", (unsigned long)(dropped - _reportedDropped));
+            printMessage(LOG_LEVEL_WARN, TAG_SYSTEM, message, millis());
+            _reportedDropped = dropped;
+        }
+        reportSuppressed();
+        
+        vTaskDelay(pdMS_TO_TICKS(DRAIN_IDLE_MS));
+    }
+}
+
+bool Logger::drainOne() {
+    // 各核心的队列按全局序号合并，输出顺序与调用顺序一致
+    int8_t oldest = -1;
+    uint32_t oldestSequence = 0;
+    for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+        const LogRecord* record = _queues[core].front();
+        if (record && (oldest < 0 || (int32_t)(record->sequence - oldestSequence) < 0)) {
+            oldest = core;
+            oldestSequence = record->sequence;
+        }
+    }
+    if (oldest < 0) return false;
+    
+    const LogRecord* record = _queues[oldest].front();
+    log_level_t level = (log_level_t)record->level;
+    bool toFile = _config.output & LOG_OUTPUT_FILE;
+    uint8_t frame[BINARY_FRAME_SIZE];
+    size_t length = encodeBinary(*record, frame);
+    keepRecent(frame, length);
+    
+    // 闪存写入在本任务中进行，按键路径不等待
+    if (_config.binaryOutput) {
+        _queues[oldest].pop();
+        if (toFile) LogFileSink::instance().write(frame, length, level == LOG_LEVEL_ERROR);
+        Serial.write(frame, length);
+        return true;
+    }
+    
+    char message[512];
+    render(*record, message, sizeof(message));
+    const char* tag = record->tag;
+    uint32_t timestamp = record->timestamp;
+    _queues[oldest].pop();
+    
+    if (toFile) LogFileSink::instance().write(frame, length, level == LOG_LEVEL_ERROR);
+    printMessage(level, tag, message, timestamp);
+    return true;
+}
@@ -9,7 +9,34 @@
  * - 可配置的输出格式
  * - 串口和可选的文件输出
  * - 运行时日志级别调整
+ * - 异步输出：调用方只把格式串指针和原始参数放入本核心的无锁队列，
+ *   由低优先级任务格式化并输出，队列满时丢弃并计数，不会阻塞
  * 
+ * 异步模式下格式串和标签只保存指针，必须是字符串常量（LOG_*宏的用法都满足）；
+ * %s参数在调用时复制。
+ *
+ * 跟踪通道：TRACE(类别, ...)按运行时打开的类别掩码输出，不受日志级别限制，
+ * 关闭时只有一次掩码检查；用于按键路径上逐键的状态跟踪，代替直接的Serial.printf。
+ *
+ * 二进制输出（binaryOutput）：每条日志只输出一帧
+ *   0xFF | 长度 | 级别 | 时间戳 | 标签地址 | 格式串地址 | 打包参数 | 校验和
+ * 格式串和标签本身留在固件的只读数据段里，由 tools/log_decode.py 从编译生成的
+ * firmware.elf 中按地址取出并还原为文本；非帧的普通串口输出原样显示。
+ *
+ * 最近CRASH_LOG_BYTES字节的二进制帧（不论输出方式）另外保存在环形缓冲中，
+ * 崩溃时由CrashDump原样写入崩溃记录。
+ *
+ * LOG_*宏先用内联的isEnabled()检查级别，被过滤时不求值参数也不调用；
+ * 低于LOG_COMPILE_LEVEL（config.h，可用-D覆盖）的宏在编译期被去掉。
+ *
+ * 按标签的级别：标签在编译期哈希为槽位号（logTagHash，TAG_SLOTS个槽位），isEnabled()只读一次
+ * 槽位的级别做比较，不查字符串。槽位级别是全局级别和落在该槽位的各标签级别中最详细的；
+ * 单独设置过级别的槽位在logv()中再按名称确认（几个标签可能共用一个槽位）。
+ * 因此可以只调高某个模块的级别，其他模块的日志仍在调用处被过滤。
+ *
+ * 限速：每个槽位一个令牌桶（LOG_RATE_PER_SEC，容量LOG_RATE_BURST），通过级别检查后取令牌，
+ * 取不到就丢弃并计数，不格式化也不入队；输出任务每LOG_SUPPRESS_REPORT_MS汇总一次各标签丢弃的条数。
+ * 错误级别不限速。卡住的按键或刷屏的模块不会占满日志队列和串口。
  * @author Calculator Project
  * @date 2024-01-07
  * @version 1.0
@@ -21,6 +48,11 @@
 #include <Arduino.h>
 #include "esp_log.h"
 #include "config.h"
+#include "MpscQueue.h"
+#include <atomic>
+#include <type_traits>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 /**
  * @brief 日志级别枚举
@@ -34,12 +66,22 @@ typedef enum {
     LOG_LEVEL_VERBOSE      ///< 详细级别
 } log_level_t;
 
+/**
+ * @brief 跟踪类别（位掩码）
+ */
+typedef enum {
+    TRACE_KEY     = 1 << 0,     ///< 按键事件
+    TRACE_CORE    = 1 << 1,     ///< 计算核心的按键处理和状态
+    TRACE_DISPLAY = 1 << 2,     ///< 显示适配器的更新
+    TRACE_ALL     = TRACE_KEY | TRACE_CORE | TRACE_DISPLAY
+} trace_category_t;
+
 /**
  * @brief 日志输出目标枚举
  */
 typedef enum {
     LOG_OUTPUT_SERIAL = 1,  ///< 串口输出
-    LOG_OUTPUT_FILE = 2,    ///< 文件输出（预留）
+    LOG_OUTPUT_FILE = 2,    ///< 闪存环形文件（见LogFileSink）
     LOG_OUTPUT_BOTH = 3     ///< 同时输出到串口和文件
 } log_output_t;
 
@@ -55,8 +97,17 @@ struct LoggerConfig {
     bool colorOutput;               ///< 是否使用彩色输出
     uint32_t baudRate;              ///< 串口波特率
     size_t bufferSize;              ///< 日志缓冲区大小
+    bool asyncOutput;               ///< 是否由后台任务格式化输出
+    bool binaryOutput;              ///< 是否输出二进制帧（由主机端解码）
 };
 
+/**
+ * @brief 标签的FNV-1a哈希，LOG_*宏在编译期对标签字符串常量求值
+ */
+constexpr uint32_t logTagHash(const char* s, uint32_t h = 2166136261u) {
+    return *s ? logTagHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+
 /**
  * @brief 日志系统管理类
  */
@@ -68,6 +119,27 @@ public:
      */
     static Logger& getInstance();
 
+    static const uint8_t TAG_SLOTS = 64;            ///< 标签槽位数（2的幂）
+    static const uint8_t MAX_TAG_LEVELS = 16;       ///< 最多单独设置级别的标签数
+    static const uint8_t TAG_NAME_BYTES = 16;
+
+    /**
+     * @brief 标签的槽位号（constexpr，LOG_*宏中在编译期算出）
+     */
+    static constexpr uint8_t tagSlot(const char* tag) { return logTagHash(tag) & (TAG_SLOTS - 1); }
+
+    /**
+     * @brief 是否可能输出该级别的日志（LOG_*宏在求值参数前调用）
+     * @param slot 标签的槽位号
+     * @details 只与该槽位的级别比较，未初始化时总返回false
+     */
+    static bool isEnabled(log_level_t level, uint8_t slot) { return level <= _slotLevel[slot]; }
+
+    /**
+     * @brief 跟踪类别是否打开（TRACE宏在求值参数前调用）
+     */
+    static bool isTraceEnabled(uint32_t category) { return (_traceMask & category) != 0; }
+
     /**
      * @brief 初始化日志系统
      * @param config 日志配置
@@ -82,11 +154,22 @@ public:
     void setLevel(log_level_t level);
 
     /**
-     * @brief 设置特定标签的日志级别
+     * @brief 设置特定标签的日志级别（可比全局级别更详细或更简略，名称会复制）
      * @param tag 模块标签
      * @param level 日志级别
+     * @return 单独设置的标签已满时返回false
+     */
+    bool setTagLevel(const char* tag, log_level_t level);
+
+    /**
+     * @brief 取消特定标签的级别，恢复为全局级别
      */
-    void setTagLevel(const char* tag, log_level_t level);
+    void clearTagLevel(const char* tag);
+
+    /**
+     * @brief 列出单独设置了级别的标签
+     */
+    void printTagLevels(Print& out);
 
     /**
      * @brief 获取默认配置
@@ -134,6 +217,26 @@ public:
      */
     void verbose(const char* tag, const char* format, ...);
 
+    /**
+     * @brief 记录跟踪信息（不受日志级别限制，由TRACE宏按类别过滤）
+     * @param format 格式化字符串
+     * @param ... 可变参数
+     */
+    void trace(const char* format, ...);
+
+    /**
+     * @brief 设置打开的跟踪类别
+     * @param mask trace_category_t的组合，0关闭全部
+     */
+    void setTraceMask(uint32_t mask);
+    uint32_t getTraceMask() const { return _traceMask; }
+
+    /**
+     * @brief 按名称查找跟踪类别（key、core、display、all）
+     * @return 未知名称返回0
+     */
+    static uint32_t traceCategoryFromName(const char* name);
+
     /**
      * @brief 刷新日志缓冲区
      */
@@ -157,8 +260,94 @@ public:
      */
     void setColorOutput(bool enable);
 
+    /**
+     * @brief 启用/禁用二进制输出
+     * @param enable true输出二进制帧，false输出文本
+     */
+    void setBinaryOutput(bool enable);
+    bool isBinaryOutput() const { return _config.binaryOutput; }
+
+    /**
+     * @brief 因队列满而丢弃的日志条数
+     */
+    uint32_t getDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 后台输出任务是否在运行
+     */
+    bool isAsync() const { return _drainTask != nullptr; }
+
+    /**
+     * @brief 最近日志的字节数（最多CRASH_LOG_BYTES）
+     */
+    size_t recentLength() const { return _recentEnd < CRASH_LOG_BYTES ? _recentEnd : CRASH_LOG_BYTES; }
+
+    /**
+     * @brief 复制最近日志的一段（按时间顺序，最旧的一帧可能只剩后半段）
+     * @details 不加锁，供崩溃处理在其他核心停止后分段调用
+     * @return 复制的字节数
+     */
+    size_t copyRecent(size_t offset, uint8_t* out, size_t size) const;
+
 private:
-    Logger() = default;
+    static const uint8_t MAX_ARGS = 8;              ///< 每条日志最多保存的参数个数
+    static const uint8_t STRING_BYTES = 64;         ///< 每条日志中%s参数的复制空间
+    static const uint32_t QUEUE_DEPTH = 32;         ///< 每个核心的队列深度（2的幂）
+    static const uint32_t DRAIN_TASK_STACK = 6144;
+    static const UBaseType_t DRAIN_TASK_PRIO = 1;
+    static const uint32_t DRAIN_IDLE_MS = 10;       ///< 队列为空时的轮询间隔
+    static const uint16_t STRING_TRUNCATED = 0xFFFF;    ///< %s参数放不下时的偏移标记
+    static const uint8_t BINARY_FRAME_MAGIC = 0xFF;     ///< 帧起始字节（UTF-8文本中不会出现）
+    static const size_t BINARY_FRAME_SIZE = 256;        ///< 帧缓冲大小，足够容纳MAX_ARGS个参数和全部字符串
+
+    /**
+     * @brief 延迟格式化的日志记录
+     */
+    struct LogRecord {
+        uint32_t sequence;                  ///< 全局序号，按序号合并各核心的队列
+        uint32_t timestamp;                 ///< 调用时的millis()
+        const char* tag;                    ///< 标签（字符串常量）
+        const char* format;                 ///< 格式串（字符串常量）
+        uint8_t level;                      ///< log_level_t
+        uint8_t argCount;                   ///< 已保存的参数个数
+        uint8_t stringBytes;                ///< strings[]已用字节数
+        bool truncated;                     ///< 参数过多，格式化到此为止
+        uint64_t args[MAX_ARGS];            ///< 原始参数：整数扩展为64位，double按位保存，字符串为strings[]偏移
+        char strings[STRING_BYTES];         ///< 复制的%s参数
+    };
+
+    /**
+     * @brief 格式说明符的解析结果
+     */
+    struct FormatSpec {
+        char conversion;                    ///< 转换字符，0表示格式串结束
+        uint8_t longCount;                  ///< 'l'的个数
+        char lengthModifier;                ///< 'z'、'j'、't'、'L'或0
+        uint8_t starCount;                  ///< 宽度/精度中'*'的个数
+    };
+
+    /**
+     * @brief 单独设置了级别的标签
+     */
+    struct TagLevel {
+        char tag[TAG_NAME_BYTES];
+        uint8_t slot;
+        log_level_t level;
+    };
+
+    /**
+     * @brief 每个槽位的令牌桶
+     */
+    struct RateBucket {
+        uint32_t refillMs;          ///< 上次补充令牌的时刻
+        uint16_t tokens;
+        uint16_t suppressed;        ///< 上次汇总之后丢弃的条数
+        const char* tag;            ///< 最近被丢弃的标签（汇总时显示）
+    };
+
+    Logger() : _initialized(false), _customFormat(false), _tagLevelCount(0), _overrideSlots(0),
+               _suppressReportMs(0), _sequence(0), _dropped(0), _reportedDropped(0), _drainTask(nullptr),
+               _recentEnd(0) {}
     ~Logger() = default;
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
@@ -167,6 +356,49 @@ private:
     bool _initialized;              ///< 初始化状态
     bool _customFormat;             ///< 是否使用自定义格式
     static Logger* _instance;       ///< 单例实例指针（用于静态回调）
+    static log_level_t _slotLevel[TAG_SLOTS];   ///< 各槽位的级别：全局级别和该槽位各标签级别中最详细的
+    TagLevel _tagLevels[MAX_TAG_LEVELS];
+    uint8_t _tagLevelCount;
+    uint64_t _overrideSlots;        ///< 有单独设置级别的标签的槽位（位图）
+    RateBucket _buckets[TAG_SLOTS];
+    uint32_t _suppressReportMs;     ///< 上次汇总限速丢弃的时刻
+    static uint32_t _traceMask;     ///< 打开的跟踪类别
+
+    // 异步输出
+    MpscQueue<LogRecord, QUEUE_DEPTH> _queues[portNUM_PROCESSORS];   ///< 每个核心一个队列，生产者只写本核心的
+    std::atomic<uint32_t> _sequence;    ///< 下一条日志的序号
+    std::atomic<uint32_t> _dropped;     ///< 队列满丢弃的条数
+    uint32_t _reportedDropped;          ///< 已报告过的丢弃条数（输出任务独占）
+    TaskHandle_t _drainTask;            ///< 输出任务句柄，nullptr表示同步输出
+
+    // 最近日志的二进制帧（崩溃记录用）
+    uint8_t _recent[CRASH_LOG_BYTES];
+    uint32_t _recentEnd;                ///< 累计写入的字节数，环形保存最后CRASH_LOG_BYTES字节
+
+    /**
+     * @brief 把一帧追加到最近日志的环形缓冲
+     */
+    void keepRecent(const uint8_t* frame, size_t length);
+
+    /**
+     * @brief 按全局级别和各标签的级别重新计算槽位级别
+     */
+    void rebuildSlots();
+
+    /**
+     * @brief 按标签确认是否输出（槽位中有单独设置的标签时按名称比较）
+     */
+    bool tagAllows(log_level_t level, const char* tag, uint8_t slot) const;
+
+    /**
+     * @brief 从标签槽位的令牌桶取一个令牌，取不到时计入丢弃
+     */
+    bool rateAllows(log_level_t level, const char* tag, uint8_t slot);
+
+    /**
+     * @brief 汇总各标签限速丢弃的条数（输出任务中调用）
+     */
+    void reportSuppressed();
 
     /**
      * @brief 转换日志级别到ESP-IDF格式
@@ -206,6 +438,54 @@ private:
      */
     void formatAndPrint(log_level_t level, const char* tag, const char* format, va_list args);
 
+    /**
+     * @brief 各级别日志的公共入口：按级别过滤后交给dispatch()
+     */
+    void logv(log_level_t level, const char* tag, const char* format, va_list args);
+
+    /**
+     * @brief 输出一条已通过过滤的日志：异步模式入队，否则同步输出
+     */
+    void dispatch(log_level_t level, const char* tag, const char* format, va_list args);
+
+    /**
+     * @brief 输出已格式化的消息（两种格式共用）
+     * @param timestamp 日志产生时的millis()
+     */
+    void printMessage(log_level_t level, const char* tag, const char* message, uint32_t timestamp);
+
+    /**
+     * @brief 保存参数并放入本核心的队列
+     * @return 队列已满返回false
+     */
+    bool enqueue(log_level_t level, const char* tag, const char* format, va_list args);
+
+    /**
+     * @brief 按格式说明符取出参数保存到记录（record的format已设置）
+     */
+    static void capture(LogRecord& record, va_list args);
+
+    /**
+     * @brief 把记录编码为二进制帧
+     * @return 帧长度
+     */
+    static size_t encodeBinary(const LogRecord& record, uint8_t* frame);
+
+    /**
+     * @brief 按保存的参数格式化日志记录
+     */
+    static void render(const LogRecord& record, char* buffer, size_t size);
+
+    /**
+     * @brief 解析'%'之后的格式说明符
+     * @return 说明符之后的位置
+     */
+    static const char* parseSpec(const char* p, FormatSpec& spec);
+
+    static void drainTaskEntry(void* arg);
+    void drainLoop();
+    bool drainOne();                // 输出序号最小的一条，没有可输出的返回false
+
     /**
      * @brief 获取日志级别缩写
      * @param level 日志级别
@@ -224,13 +504,46 @@ private:
 #define TAG_SYSTEM      "SYSTEM"
 #define TAG_INIT        "INIT"
 #define TAG_MODE        "MODE"
+#define TAG_TRACE       "TRACE"
 
 // 便捷宏定义
-#define LOG_E(tag, format, ...) Logger::getInstance().error(tag, format, ##__VA_ARGS__)
-#define LOG_W(tag, format, ...) Logger::getInstance().warn(tag, format, ##__VA_ARGS__)
-#define LOG_I(tag, format, ...) Logger::getInstance().info(tag, format, ##__VA_ARGS__)
-#define LOG_D(tag, format, ...) Logger::getInstance().debug(tag, format, ##__VA_ARGS__)
-#define LOG_V(tag, format, ...) Logger::getInstance().verbose(tag, format, ##__VA_ARGS__)
+// 先检查级别再求值参数；编译期去掉的级别保留if (0)，参数仍做类型检查但不生成代码
+// 标签必须是字符串常量，槽位号作为模板参数在编译期算出，检查只是一次数组读取和比较
+#define LOG_TAG_SLOT(tag) (std::integral_constant<uint8_t, Logger::tagSlot(tag)>::value)
+#define LOG_AT(level, method, tag, format, ...) \
+    do { if (Logger::isEnabled(level, LOG_TAG_SLOT(tag))) Logger::getInstance().method(tag, format, ##__VA_ARGS__); } while (0)
+#define LOG_STRIPPED(method, tag, format, ...) \
+    do { if (0) Logger::getInstance().method(tag, format, ##__VA_ARGS__); } while (0)
+
+#if LOG_COMPILE_LEVEL >= 1
+#define LOG_E(tag, format, ...) LOG_AT(LOG_LEVEL_ERROR, error, tag, format, ##__VA_ARGS__)
+#else
+#define LOG_E(tag, format, ...) LOG_STRIPPED(error, tag, format, ##__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL >= 2
+#define LOG_W(tag, format, ...) LOG_AT(LOG_LEVEL_WARN, warn, tag, format, ##__VA_ARGS__)
+#else
+#define LOG_W(tag, format, ...) LOG_STRIPPED(warn, tag, format, ##__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL >= 3
+#define LOG_I(tag, format, ...) LOG_AT(LOG_LEVEL_INFO, info, tag, format, ##__VA_ARGS__)
+#else
+#define LOG_I(tag, format, ...) LOG_STRIPPED(info, tag, format, ##__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL >= 4
+#define LOG_D(tag, format, ...) LOG_AT(LOG_LEVEL_DEBUG, debug, tag, format, ##__VA_ARGS__)
+#else
+#define LOG_D(tag, format, ...) LOG_STRIPPED(debug, tag, format, ##__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL >= 5
+#define LOG_V(tag, format, ...) LOG_AT(LOG_LEVEL_VERBOSE, verbose, tag, format, ##__VA_ARGS__)
+#else
+#define LOG_V(tag, format, ...) LOG_STRIPPED(verbose, tag, format, ##__VA_ARGS__)
+#endif
+
+// 跟踪宏：类别未打开时不求值参数
+#define TRACE(category, format, ...) \
+    do { if (Logger::isTraceEnabled(category)) Logger::getInstance().trace(format, ##__VA_ARGS__); } while (0)
 
 // 模块专用日志宏
 #define KEYPAD_LOG_E(format, ...) LOG_E(TAG_KEYPAD, format, ##__VA_ARGS__)
@@ -0,0 +1,47 @@
+/**
+ * @file LoopScheduler.cpp
+ * @brief 主循环的等待与唤醒实现
+ *
+ * @author Calculator Project
+ */
+
+#include "LoopScheduler.h"
+
+void LoopScheduler::begin() {
+    _task = xTaskGetCurrentTaskHandle();
+}
+
+void LoopScheduler::at(uint32_t deadline) {
+    // millis()回绕后按差值比较
+    if (!_hasDeadline || (int32_t)(deadline - _deadline) < 0) {
+        _deadline = deadline;
+        _hasDeadline = true;
+    }
+}
+
+void LoopScheduler::wait(uint32_t maxMs) {
+    uint32_t timeout = maxMs;
+    if (_hasDeadline) {
+        int32_t left = (int32_t)(_deadline - millis());
+        if (left <= 0) {
+            timeout = 0;
+        } else if ((uint32_t)left < timeout) {
+            timeout = left;
+        }
+        _hasDeadline = false;
+    }
+
+    if (timeout == 0 || !_task) {
+        _immediateRuns++;
+        return;
+    }
+
+    // 通知值在等待前已累加时立即返回，等待期间的多次唤醒合并为一次
+    TickType_t ticks = pdMS_TO_TICKS(timeout);
+    if (ticks == 0) ticks = 1;
+    if (ulTaskNotifyTake(pdTRUE, ticks)) {
+        _eventWakeups++;
+    } else {
+        _timedWakeups++;
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @file LoopScheduler.h
+ * @brief 主循环的等待与唤醒
+ * @details 主循环做完一轮后调用wait()阻塞，直到以下两者中较早的一个：
+ * - 本轮中各模块用at()/after()登记的最早截止时间（背光渐变、LED动画帧、蜂鸣器停止、延迟保存等）
+ * - 其他任务调用wake()（按键事件入队、串口/CDC收到数据、键盘进入空闲）
+ *
+ * 截止时间每轮清空，模块在自己的update()中只要还有定时工作就重新登记；
+ * 没有登记也没有唤醒时最多等待maxMs，作为兜底。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef LOOP_SCHEDULER_H
+#define LOOP_SCHEDULER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+class LoopScheduler {
+public:
+    static LoopScheduler& instance() {
+        static LoopScheduler instance;
+        return instance;
+    }
+
+    /**
+     * @brief 记录主循环所在任务，在setup()中调用
+     */
+    void begin();
+
+    /**
+     * @brief 唤醒主循环（任意任务）
+     */
+    void wake() {
+        if (_task) xTaskNotifyGive(_task);
+    }
+
+    /**
+     * @brief 登记本轮之后最迟在deadline（millis()）再运行一次，只能在主循环中调用
+     */
+    void at(uint32_t deadline);
+
+    /**
+     * @brief 登记delayMs毫秒后再运行一次，0表示下一轮不等待
+     */
+    void after(uint32_t delayMs) { at(millis() + delayMs); }
+
+    /**
+     * @brief 等待到最早的截止时间或被唤醒，然后清空截止时间
+     * @param maxMs 最长等待时间
+     */
+    void wait(uint32_t maxMs);
+
+    uint32_t getEventWakeups() const { return _eventWakeups; }      ///< 被wake()唤醒的次数
+    uint32_t getTimedWakeups() const { return _timedWakeups; }      ///< 截止时间到达的次数
+    uint32_t getImmediateRuns() const { return _immediateRuns; }    ///< 截止时间已过、不等待的次数
+
+private:
+    LoopScheduler()
+        : _task(nullptr),
+          _deadline(0),
+          _hasDeadline(false),
+          _eventWakeups(0),
+          _timedWakeups(0),
+          _immediateRuns(0) {}
+
+    TaskHandle_t _task;
+    uint32_t _deadline;
+    bool _hasDeadline;
+
+    uint32_t _eventWakeups;
+    uint32_t _timedWakeups;
+    uint32_t _immediateRuns;
+};
+
+#endif // LOOP_SCHEDULER_H
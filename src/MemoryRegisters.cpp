@@ -0,0 +1,90 @@
+/**
+ * @file MemoryRegisters.cpp
+ * @brief 计算器内存寄存器实现
+ *
+ * @author Calculator Project
+ */
+
+#include "MemoryRegisters.h"
+#include "CalcBackend.h"
+
+MemoryRegisters::MemoryRegisters() {
+    _data.count = 1;
+}
+
+void MemoryRegisters::begin(uint8_t slotCount) {
+    if (slotCount == 0) slotCount = 1;
+    if (slotCount > MEMORY_REGISTER_MAX) slotCount = MEMORY_REGISTER_MAX;
+
+    MemoryRegisterData stored;
+    if (ConfigManager::getInstance().loadMemoryRegisters(stored)) {
+        _data = stored;
+        CALC_LOG_I("已恢复内存寄存器: 位图0x%02X", _data.used);
+    }
+
+    // 寄存器个数变少时丢弃多出的部分
+    _data.count = slotCount;
+    _data.used &= (uint8_t)((1u << slotCount) - 1);
+    if (_data.active >= slotCount) _data.active = 0;
+}
+
+CalculatorError MemoryRegisters::add(double value) {
+    return accumulate(value, Operator::ADD);
+}
+
+CalculatorError MemoryRegisters::subtract(double value) {
+    return accumulate(value, Operator::SUBTRACT);
+}
+
+double MemoryRegisters::recall() const {
+    return get(_data.active);
+}
+
+void MemoryRegisters::clear() {
+    uint8_t mask = 1 << _data.active;
+    if (!(_data.used & mask) && _data.values[_data.active] == 0.0) return;
+
+    _data.values[_data.active] = 0.0;
+    _data.used &= ~mask;
+    store();
+}
+
+void MemoryRegisters::selectNext() {
+    _data.active = (_data.active + 1) % _data.count;
+    store();
+    CALC_LOG_D("当前内存寄存器: M%u", _data.active + 1);
+}
+
+size_t MemoryRegisters::formatIndicator(char *buf, size_t size) const {
+    if (!buf || size == 0) return 0;
+
+    int n;
+    if (_data.count == 1) {
+        n = snprintf(buf, size, "%s", _data.used ? "M" : "");
+    } else if (_data.used || _data.active != 0) {
+        // 切换过寄存器或有存值时显示当前编号，存值的寄存器后加'*'
+        n = snprintf(buf, size, "M%u%s", _data.active + 1, isSet(_data.active) ? "*" : "");
+    } else {
+        n = snprintf(buf, size, "%s", "");
+    }
+    return n < 0 ? 0 : ((size_t)n < size ? (size_t)n : size - 1);
+}
+
+CalculatorError MemoryRegisters::accumulate(double value, Operator op) {
+    double result = 0.0;
+    CalculatorError error = CalcBackend::apply(_data.values[_data.active], value, op, result);
+    if (error != CalculatorError::NONE) {
+        CALC_LOG_W("内存寄存器运算失败: %d", (int)error);
+        return error;
+    }
+
+    _data.values[_data.active] = result;
+    _data.used |= 1 << _data.active;
+    store();
+    return CalculatorError::NONE;
+}
+
+void MemoryRegisters::store() {
+    // 只更新RAM副本，连续按M+不会每次都写闪存
+    ConfigManager::getInstance().setMemoryRegisters(_data);
+}
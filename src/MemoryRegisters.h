@@ -0,0 +1,56 @@
+/**
+ * @file MemoryRegisters.h
+ * @brief 计算器内存寄存器（M+、M-、MR、MC）
+ * @details 多个寄存器，同一时间只有一个是当前寄存器，M键都作用在当前寄存器上：
+ * - 累加走CalcBackend，与计算使用同样的精度和溢出检查
+ * - 修改只写入ConfigManager的内存副本，空闲MEMORY_SAVE_IDLE_MS后由ConfigManager写入设置分区（SettingsStore）
+ *
+ * @author Calculator Project
+ */
+
+#ifndef MEMORY_REGISTERS_H
+#define MEMORY_REGISTERS_H
+
+#include <Arduino.h>
+#include "CalculatorCore.h"
+#include "ConfigManager.h"
+
+class MemoryRegisters {
+public:
+    MemoryRegisters();
+
+    /**
+     * @brief 设置寄存器个数并从ConfigManager恢复保存的值
+     * @param slotCount 寄存器个数（1~MEMORY_REGISTER_MAX）
+     */
+    void begin(uint8_t slotCount);
+
+    CalculatorError add(double value);          // M+
+    CalculatorError subtract(double value);     // M-
+    double recall() const;                      // MR，未存值时为0
+    void clear();                               // MC，只清除当前寄存器
+
+    /**
+     * @brief 切换到下一个寄存器（循环）
+     */
+    void selectNext();
+
+    uint8_t getActiveSlot() const { return _data.active; }
+    uint8_t getSlotCount() const { return _data.count; }
+    bool isSet(uint8_t slot) const { return slot < _data.count && (_data.used & (1 << slot)); }
+    double get(uint8_t slot) const { return slot < _data.count ? _data.values[slot] : 0.0; }
+
+    /**
+     * @brief 显示指示文本，如"M2"；只有一个寄存器时为"M"，当前寄存器未存值且其他也为空时为空串
+     * @return 写入的字符数
+     */
+    size_t formatIndicator(char *buf, size_t size) const;
+
+private:
+    CalculatorError accumulate(double value, Operator op);
+    void store();                               // 交给ConfigManager延迟写回
+
+    MemoryRegisterData _data;
+};
+
+#endif // MEMORY_REGISTERS_H
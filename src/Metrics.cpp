@@ -0,0 +1,168 @@
+/**
+ * @file Metrics.cpp
+ * @brief 命名计数器和延迟直方图的集中登记实现
+ *
+ * @author Calculator Project
+ */
+
+#include "Metrics.h"
+#include "Console.h"
+#include <string.h>
+
+namespace {
+
+const size_t HEADER_SIZE = 9;
+const size_t HEX_BUFFER_SIZE = 1024;
+
+uint8_t* put32(uint8_t* p, uint32_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+    return p + 4;
+}
+
+// 名称长度(1) + 名称
+uint8_t* putName(uint8_t* p, const char* name, size_t length) {
+    *p++ = (uint8_t)length;
+    memcpy(p, name, length);
+    return p + length;
+}
+
+size_t nameLength(const char* name) {
+    size_t length = strlen(name);
+    return length < 255 ? length : 255;
+}
+
+void cmdMetrics(const ConsoleArgs& args) {
+    if (args.is(1, "reset")) {
+        Metrics::instance().reset();
+        Serial.println("✅ 计数器和直方图已清零");
+    } else if (args.is(1, "hex")) {
+        Metrics::instance().printHex();
+    } else {
+        Metrics::instance().printStatus();
+    }
+}
+
+constexpr ConsoleCommand METRICS_COMMANDS[] = {
+    {"metrics", "[hex|reset]", "计数器和直方图（hex：一行二进制快照）", cmdMetrics},
+};
+static_assert(consoleSorted(METRICS_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+MetricCounter::MetricCounter(const char* name)
+    : _name(name),
+      _value(0) {
+    Metrics& metrics = Metrics::instance();
+    _next = metrics._counters;
+    metrics._counters = this;
+    metrics._counterCount++;
+}
+
+MetricHistogram::MetricHistogram(const char* name)
+    : _name(name) {
+    reset();
+    Metrics& metrics = Metrics::instance();
+    _next = metrics._histograms;
+    metrics._histograms = this;
+    metrics._histogramCount++;
+}
+
+uint32_t MetricHistogram::count() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < BUCKETS; i++) {
+        total += bucket(i);
+    }
+    return total;
+}
+
+void MetricHistogram::reset() {
+    for (uint8_t i = 0; i < BUCKETS; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::begin() {
+    Console::instance().addCommands(METRICS_COMMANDS);
+}
+
+size_t Metrics::exportBinary(uint8_t* out, size_t size) const {
+    if (size < HEADER_SIZE) return 0;
+    uint8_t* p = out;
+    uint8_t* end = out + size;
+    *p++ = SNAPSHOT_VERSION;
+    uint8_t* flags = p++;
+    *flags = 0;
+    p = put32(p, millis());
+    uint8_t* counterCount = p++;
+    uint8_t* histogramCount = p++;
+    *p++ = MetricHistogram::BUCKETS;
+    *counterCount = 0;
+    *histogramCount = 0;
+
+    for (const MetricCounter* c = _counters; c; c = c->_next) {
+        size_t length = nameLength(c->_name);
+        if ((size_t)(end - p) < 1 + length + 4) {
+            *flags |= SNAPSHOT_TRUNCATED;
+            continue;
+        }
+        p = putName(p, c->_name, length);
+        p = put32(p, c->get());
+        (*counterCount)++;
+    }
+    for (const MetricHistogram* h = _histograms; h; h = h->_next) {
+        size_t length = nameLength(h->_name);
+        if ((size_t)(end - p) < 1 + length + 4 * MetricHistogram::BUCKETS) {
+            *flags |= SNAPSHOT_TRUNCATED;
+            continue;
+        }
+        p = putName(p, h->_name, length);
+        for (uint8_t i = 0; i < MetricHistogram::BUCKETS; i++) {
+            p = put32(p, h->bucket(i));
+        }
+        (*histogramCount)++;
+    }
+    return p - out;
+}
+
+void Metrics::reset() {
+    for (MetricCounter* c = _counters; c; c = c->_next) {
+        c->reset();
+    }
+    for (MetricHistogram* h = _histograms; h; h = h->_next) {
+        h->reset();
+    }
+}
+
+void Metrics::printStatus() const {
+    Serial.printf("--- 计数器 (%u) ---\n", _counterCount);
+    for (const MetricCounter* c = _counters; c; c = c->_next) {
+        Serial.printf("  %-24s %lu\n", c->_name, (unsigned long)c->get());
+    }
+    Serial.printf("--- 直方图 (%u) ---\n", _histogramCount);
+    for (const MetricHistogram* h = _histograms; h; h = h->_next) {
+        Serial.printf("  %-24s n=%lu\n", h->_name, (unsigned long)h->count());
+        for (uint8_t i = 0; i < MetricHistogram::BUCKETS; i++) {
+            uint32_t n = h->bucket(i);
+            if (n == 0) continue;
+            if (i == MetricHistogram::BUCKETS - 1) {
+                Serial.printf("    >=%-8lu %lu\n", (unsigned long)MetricHistogram::bucketLower(i), (unsigned long)n);
+            } else {
+                Serial.printf("    <%-9lu %lu\n", (unsigned long)MetricHistogram::bucketLower(i + 1),
+                              (unsigned long)n);
+            }
+        }
+    }
+}
+
+void Metrics::printHex() const {
+    static uint8_t buffer[HEX_BUFFER_SIZE];
+    size_t length = exportBinary(buffer, sizeof(buffer));
+    Serial.print("METRICS ");
+    for (size_t i = 0; i < length; i++) {
+        Serial.printf("%02x", buffer[i]);
+    }
+    Serial.println();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file Metrics.h
+ * @brief 命名计数器和延迟直方图的集中登记
+ * @details 各模块在自己的.cpp中以静态对象声明计数器和直方图，构造时登记到Metrics：
+ *
+ *     static MetricCounter framesDropped("host.frames_dropped");
+ *     static MetricHistogram keyTime("core.key_us");
+ *     framesDropped.add();
+ *     keyTime.record(us);
+ *
+ * - 每次更新只有一次原子加（relaxed），可在热路径、其他任务和中断中调用
+ * - 直方图为固定的2的幂桶：第0桶为0，第i桶为[2^(i-1), 2^i)，最后一桶收下更大的值；
+ *   次数为各桶之和，不另外计数
+ * - metrics命令输出文本；metrics hex在一行中输出与HostLink GET_METRICS相同的二进制快照，
+ *   供批量监控脚本从UART读取
+ *
+ * 二进制快照（小端）：
+ *     版本(1) | 标志(1，bit0表示放不下而截断) | 运行时间ms(4) | 计数器数(1) | 直方图数(1) | 每个直方图的桶数(1)
+ *     计数器：名称长度(1) + 名称 + 值(4)
+ *     直方图：名称长度(1) + 名称 + 各桶次数(4 × 桶数)
+ *
+ * @author Calculator Project
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+class MetricCounter {
+public:
+    explicit MetricCounter(const char* name);
+
+    void add(uint32_t n = 1) { _value.fetch_add(n, std::memory_order_relaxed); }
+    uint32_t get() const { return _value.load(std::memory_order_relaxed); }
+    void reset() { _value.store(0, std::memory_order_relaxed); }
+    const char* name() const { return _name; }
+
+private:
+    friend class Metrics;
+    const char* _name;
+    std::atomic<uint32_t> _value;
+    MetricCounter* _next;
+};
+
+class MetricHistogram {
+public:
+    static const uint8_t BUCKETS = 16;      ///< 0、1、2-3、…、8192-16383、16384以上
+
+    explicit MetricHistogram(const char* name);
+
+    void record(uint32_t value) { _buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed); }
+    uint32_t bucket(uint8_t i) const { return _buckets[i].load(std::memory_order_relaxed); }
+    uint32_t count() const;
+    void reset();
+    const char* name() const { return _name; }
+
+    static uint8_t bucketOf(uint32_t value) {
+        uint8_t bits = value ? 32 - __builtin_clz(value) : 0;
+        return bits < BUCKETS ? bits : BUCKETS - 1;
+    }
+
+    /**
+     * @brief 第i桶的下界
+     */
+    static uint32_t bucketLower(uint8_t i) { return i ? 1UL << (i - 1) : 0; }
+
+private:
+    friend class Metrics;
+    const char* _name;
+    std::atomic<uint32_t> _buckets[BUCKETS];
+    MetricHistogram* _next;
+};
+
+class Metrics {
+public:
+    static const uint8_t SNAPSHOT_VERSION = 1;
+    static const uint8_t SNAPSHOT_TRUNCATED = 0x01;
+
+    static Metrics& instance() {
+        static Metrics instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册串口命令
+     */
+    void begin();
+
+    /**
+     * @brief 写入二进制快照，放不下的计数器或直方图整个略去并设置截断标志
+     * @return 写入的字节数，size小于头部时为0
+     */
+    size_t exportBinary(uint8_t* out, size_t size) const;
+
+    void reset();
+    void printStatus() const;
+    void printHex() const;
+
+private:
+    friend class MetricCounter;
+    friend class MetricHistogram;
+
+    Metrics() : _counters(nullptr), _histograms(nullptr), _counterCount(0), _histogramCount(0) {}
+
+    // 登记只在静态构造期间进行，之后链表不再变化
+    MetricCounter* _counters;
+    MetricHistogram* _histograms;
+    uint8_t _counterCount;
+    uint8_t _histogramCount;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,110 @@
+/**
+ * @file MpscQueue.h
+ * @brief 多生产者单消费者无锁环形队列
+ * @details 固定容量、无动态内存分配，每个槽位带序号（Vyukov有界队列）：
+ * - 任意任务（包括同一核心上互相抢占的任务）都可以调用push()，只用一次CAS占位
+ * - 只允许一个任务调用front()/pop()
+ * - 生产者占位后、写完前被抢占时，消费者只会暂时看到队列为空，不会阻塞生产者
+ * - 容量N必须是2的幂，N个槽位全部可用
+ *
+ * @author Calculator Project
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint32_t N>
+class MpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscQueue容量必须是2的幂");
+
+public:
+    MpscQueue() : _enqueuePos(0), _dequeuePos(0) {
+        for (uint32_t i = 0; i < N; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 占用一个槽位，由调用方在返回的位置就地写入，再调用commit()
+     * @return 队列已满返回nullptr
+     */
+    T *reserve(uint32_t &ticket) {
+        uint32_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = _cells[pos & (N - 1)];
+            uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    ticket = pos;
+                    return &cell.item;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief 发布reserve()占用的槽位
+     */
+    void commit(uint32_t ticket) {
+        _cells[ticket & (N - 1)].sequence.store(ticket + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 入队（任意生产者调用）
+     * @return 队列已满返回false
+     */
+    bool push(const T &item) {
+        uint32_t ticket;
+        T *slot = reserve(ticket);
+        if (!slot) return false;
+        *slot = item;
+        commit(ticket);
+        return true;
+    }
+
+    /**
+     * @brief 查看队首（仅消费者调用）
+     * @return 队列为空或队首尚未写完返回nullptr
+     */
+    const T *front() const {
+        const Cell &cell = _cells[_dequeuePos & (N - 1)];
+        uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+        if ((int32_t)(seq - (_dequeuePos + 1)) < 0) return nullptr;
+        return &cell.item;
+    }
+
+    /**
+     * @brief 丢弃队首（仅消费者调用，front()非空时）
+     */
+    void pop() {
+        _cells[_dequeuePos & (N - 1)].sequence.store(_dequeuePos + N, std::memory_order_release);
+        _dequeuePos++;
+    }
+
+    /**
+     * @brief 队列是否为空（仅消费者调用）
+     */
+    bool empty() const {
+        return front() == nullptr;
+    }
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> sequence;             ///< 槽位状态：等于写入位置表示可写，等于位置+1表示可读
+        T item;
+    };
+
+    Cell _cells[N];
+    std::atomic<uint32_t> _enqueuePos;              ///< 下一个占用位置（生产者共享）
+    uint32_t _dequeuePos;                           ///< 下一个读取位置（消费者独占）
+};
+
+#endif // MPSC_QUEUE_H
@@ -0,0 +1,494 @@
+/**
+ * @file NumberFormatter.cpp
+ * @brief 数字格式化实现（Grisu2最短表示 + 十进制舍入）
+ *
+ * @author Calculator Project
+ */
+
+#include "NumberFormatter.h"
+#include "ScratchArena.h"
+#include <string.h>
+
+namespace {
+
+/**
+ * @brief 64位尾数的浮点数 f × 2^e
+ */
+struct DiyFp {
+    uint64_t f;
+    int e;
+
+    DiyFp() : f(0), e(0) {}
+    DiyFp(uint64_t fp, int exp) : f(fp), e(exp) {}
+
+    DiyFp operator-(const DiyFp &rhs) const {
+        return DiyFp(f - rhs.f, e);
+    }
+
+    // 只取128位乘积的高64位（四舍五入），Xtensa上没有__int128，按32位拆分
+    DiyFp operator*(const DiyFp &rhs) const {
+        const uint64_t M32 = 0xFFFFFFFFULL;
+        uint64_t a = f >> 32, b = f & M32;
+        uint64_t c = rhs.f >> 32, d = rhs.f & M32;
+        uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32) + (1ULL << 31);
+        return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + rhs.e + 64);
+    }
+
+    DiyFp normalize() const {
+        int shift = __builtin_clzll(f);
+        return DiyFp(f << shift, e - shift);
+    }
+};
+
+const uint64_t DP_HIDDEN_BIT = 0x0010000000000000ULL;
+const uint64_t DP_SIGNIFICAND_MASK = 0x000FFFFFFFFFFFFFULL;
+const int DP_EXPONENT_BIAS = 0x3FF + 52;
+
+DiyFp fromDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased = (int)((bits >> 52) & 0x7FF);
+    uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+    if (biased != 0) {
+        return DiyFp(significand + DP_HIDDEN_BIT, biased - DP_EXPONENT_BIAS);
+    }
+    return DiyFp(significand, 1 - DP_EXPONENT_BIAS);   // 非规格化数
+}
+
+// 与相邻double的中点，即可以还原为value的区间边界
+void boundaries(const DiyFp &v, DiyFp &minus, DiyFp &plus) {
+    DiyFp pl((v.f << 1) + 1, v.e - 1);
+    while (!(pl.f & (DP_HIDDEN_BIT << 1))) {
+        pl.f <<= 1;
+        pl.e--;
+    }
+    pl.f <<= 10;
+    pl.e -= 10;
+
+    // 尾数为2的幂时下边界更近
+    DiyFp mi = (v.f == DP_HIDDEN_BIT) ? DiyFp((v.f << 2) - 1, v.e - 2) : DiyFp((v.f << 1) - 1, v.e - 1);
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    minus = mi;
+    plus = pl;
+}
+
+// 10^k（k = -348, -340, ..., 340）的64位规格化近似值
+const struct {
+    uint64_t f;
+    int16_t e;
+} CACHED_POWERS[] = {
+    {0xfa8fd5a0081c0288ULL, -1220}, {0xbaaee17fa23ebf76ULL, -1193}, {0x8b16fb203055ac76ULL, -1166},
+    {0xcf42894a5dce35eaULL, -1140}, {0x9a6bb0aa55653b2dULL, -1113}, {0xe61acf033d1a45dfULL, -1087},
+    {0xab70fe17c79ac6caULL, -1060}, {0xff77b1fcbebcdc4fULL, -1034}, {0xbe5691ef416bd60cULL, -1007},
+    {0x8dd01fad907ffc3cULL, -980}, {0xd3515c2831559a83ULL, -954}, {0x9d71ac8fada6c9b5ULL, -927},
+    {0xea9c227723ee8bcbULL, -901}, {0xaecc49914078536dULL, -874}, {0x823c12795db6ce57ULL, -847},
+    {0xc21094364dfb5637ULL, -821}, {0x9096ea6f3848984fULL, -794}, {0xd77485cb25823ac7ULL, -768},
+    {0xa086cfcd97bf97f4ULL, -741}, {0xef340a98172aace5ULL, -715}, {0xb23867fb2a35b28eULL, -688},
+    {0x84c8d4dfd2c63f3bULL, -661}, {0xc5dd44271ad3cdbaULL, -635}, {0x936b9fcebb25c996ULL, -608},
+    {0xdbac6c247d62a584ULL, -582}, {0xa3ab66580d5fdaf6ULL, -555}, {0xf3e2f893dec3f126ULL, -529},
+    {0xb5b5ada8aaff80b8ULL, -502}, {0x87625f056c7c4a8bULL, -475}, {0xc9bcff6034c13053ULL, -449},
+    {0x964e858c91ba2655ULL, -422}, {0xdff9772470297ebdULL, -396}, {0xa6dfbd9fb8e5b88fULL, -369},
+    {0xf8a95fcf88747d94ULL, -343}, {0xb94470938fa89bcfULL, -316}, {0x8a08f0f8bf0f156bULL, -289},
+    {0xcdb02555653131b6ULL, -263}, {0x993fe2c6d07b7facULL, -236}, {0xe45c10c42a2b3b06ULL, -210},
+    {0xaa242499697392d3ULL, -183}, {0xfd87b5f28300ca0eULL, -157}, {0xbce5086492111aebULL, -130},
+    {0x8cbccc096f5088ccULL, -103}, {0xd1b71758e219652cULL, -77}, {0x9c40000000000000ULL, -50},
+    {0xe8d4a51000000000ULL, -24}, {0xad78ebc5ac620000ULL, 3}, {0x813f3978f8940984ULL, 30},
+    {0xc097ce7bc90715b3ULL, 56}, {0x8f7e32ce7bea5c70ULL, 83}, {0xd5d238a4abe98068ULL, 109},
+    {0x9f4f2726179a2245ULL, 136}, {0xed63a231d4c4fb27ULL, 162}, {0xb0de65388cc8ada8ULL, 189},
+    {0x83c7088e1aab65dbULL, 216}, {0xc45d1df942711d9aULL, 242}, {0x924d692ca61be758ULL, 269},
+    {0xda01ee641a708deaULL, 295}, {0xa26da3999aef774aULL, 322}, {0xf209787bb47d6b85ULL, 348},
+    {0xb454e4a179dd1877ULL, 375}, {0x865b86925b9bc5c2ULL, 402}, {0xc83553c5c8965d3dULL, 428},
+    {0x952ab45cfa97a0b3ULL, 455}, {0xde469fbd99a05fe3ULL, 481}, {0xa59bc234db398c25ULL, 508},
+    {0xf6c69a72a3989f5cULL, 534}, {0xb7dcbf5354e9beceULL, 561}, {0x88fcf317f22241e2ULL, 588},
+    {0xcc20ce9bd35c78a5ULL, 614}, {0x98165af37b2153dfULL, 641}, {0xe2a0b5dc971f303aULL, 667},
+    {0xa8d9d1535ce3b396ULL, 694}, {0xfb9b7cd9a4a7443cULL, 720}, {0xbb764c4ca7a44410ULL, 747},
+    {0x8bab8eefb6409c1aULL, 774}, {0xd01fef10a657842cULL, 800}, {0x9b10a4e5e9913129ULL, 827},
+    {0xe7109bfba19c0c9dULL, 853}, {0xac2820d9623bf429ULL, 880}, {0x80444b5e7aa7cf85ULL, 907},
+    {0xbf21e44003acdd2dULL, 933}, {0x8e679c2f5e44ff8fULL, 960}, {0xd433179d9c8cb841ULL, 986},
+    {0x9e19db92b4e31ba9ULL, 1013}, {0xeb96bf6ebadf77d9ULL, 1039}, {0xaf87023b9bf0ee6bULL, 1066},
+};
+
+// 选一个10^-K，使乘积的二进制指数落在[-60, -32]，整数部分可以放进uint32_t
+DiyFp cachedPower(int e, int &K) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    if (dk - k > 0.0) k++;
+
+    unsigned index = (unsigned)((k >> 3) + 1);
+    K = -(-348 + (int)(index << 3));
+    return DiyFp(CACHED_POWERS[index].f, CACHED_POWERS[index].e);
+}
+
+const uint32_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+int countDecimalDigits(uint32_t n) {
+    int digits = 1;
+    while (digits < 10 && n >= POW10[digits]) digits++;
+    return digits;
+}
+
+// 在允许区间内把最后一位向真实值靠拢
+void roundWeed(char *buffer, int len, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t wpW) {
+    while (rest < wpW && delta - rest >= tenKappa &&
+           (rest + tenKappa < wpW || wpW - rest > rest + tenKappa - wpW)) {
+        buffer[len - 1]--;
+        rest += tenKappa;
+    }
+}
+
+int digitGen(const DiyFp &W, const DiyFp &Mp, uint64_t delta, char *buffer, int &K) {
+    const DiyFp one(1ULL << -Mp.e, Mp.e);
+    const DiyFp wpW = Mp - W;
+    uint32_t p1 = (uint32_t)(Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = countDecimalDigits(p1);
+    int len = 0;
+
+    // 整数部分
+    while (kappa > 0) {
+        uint32_t d = p1 / POW10[kappa - 1];
+        p1 %= POW10[kappa - 1];
+        if (d || len) buffer[len++] = (char)('0' + d);
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta) {
+            K += kappa;
+            roundWeed(buffer, len, delta, rest, (uint64_t)POW10[kappa] << -one.e, wpW.f);
+            return len;
+        }
+    }
+
+    // 小数部分
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || len) buffer[len++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            K += kappa;
+            int index = -kappa;
+            roundWeed(buffer, len, delta, p2, one.f, wpW.f * (index < 10 ? POW10[index] : 0));
+            return len;
+        }
+    }
+}
+
+/**
+ * @brief 把digits[0..len)四舍五入到keep位
+ * @return 舍入后的位数（去掉尾随的零）；keep<=0且不进位时返回0
+ */
+int roundDigits(char *digits, int len, int &point, int keep) {
+    if (keep < 0) return 0;
+    if (keep < len) {
+        bool up = digits[keep] >= '5';
+        len = keep;
+        if (up) {
+            int i = len - 1;
+            while (i >= 0 && digits[i] == '9') i--;
+            if (i < 0) {
+                // 全是9（或keep为0）：进位成1，小数点右移一位
+                digits[0] = '1';
+                len = 1;
+                point++;
+            } else {
+                digits[i]++;
+                len = i + 1;
+            }
+        }
+    }
+    while (len > 0 && digits[len - 1] == '0') len--;
+    return len;
+}
+
+/**
+ * @brief 有界的字符写入器，放不下时截断
+ */
+struct Writer {
+    char *buf;
+    size_t size;
+    size_t len;
+
+    void put(char c) {
+        if (len + 1 < size) buf[len++] = c;
+    }
+    void put(const char *text, int n) {
+        for (int i = 0; i < n; i++) put(text[i]);
+    }
+    void putInt(int value) {
+        char tmp[12];
+        int n = 0;
+        unsigned u = value < 0 ? (unsigned)-value : (unsigned)value;
+        if (value < 0) put('-');
+        do {
+            tmp[n++] = (char)('0' + u % 10);
+            u /= 10;
+        } while (u);
+        while (n > 0) put(tmp[--n]);
+    }
+};
+
+int decimalLength(int value) {
+    int n = value < 0 ? 2 : 1;
+    for (unsigned u = value < 0 ? (unsigned)-value : (unsigned)value; u >= 10; u /= 10) n++;
+    return n;
+}
+
+// 定点表示的字符数：整数部分、千位分隔符、小数分隔符和frac位小数
+int fixedLength(int point, int frac, const NumberFormat &format, bool grouping) {
+    int intLen = point > 0 ? point : 1;
+    int len = intLen;
+    if (grouping) {
+        len += (intLen - 1) / 3 * format.thousandsSeparator.length();
+    }
+    if (frac > 0) {
+        len += format.decimalSeparator.length() + frac;
+    }
+    return len;
+}
+
+// 写出 digits × 10^(point-len) 的定点形式，保留frac位小数（不足补零）
+void writeFixed(Writer &out, const char *digits, int len, int point, int frac,
+                const NumberFormat &format, bool grouping) {
+    if (point <= 0) {
+        out.put('0');
+    } else {
+        for (int i = 0; i < point; i++) {
+            if (grouping && i > 0 && (point - i) % 3 == 0) {
+                out.put(format.thousandsSeparator.c_str(), format.thousandsSeparator.length());
+            }
+            out.put(i < len ? digits[i] : '0');
+        }
+    }
+    if (frac > 0) {
+        out.put(format.decimalSeparator.c_str(), format.decimalSeparator.length());
+        for (int j = 0; j < frac; j++) {
+            int index = point + j;
+            out.put(index >= 0 && index < len ? digits[index] : '0');
+        }
+    }
+}
+
+// 向下取整到3的倍数
+int engineeringExponent(int exponent) {
+    return exponent >= 0 ? exponent / 3 * 3 : -((-exponent + 2) / 3 * 3);
+}
+
+// 整数格式化的数字表：十进制每次除以100取两位，2/8/16进制每位是固定宽度的位段
+const char RADIX_DIGITS[] = "0123456789ABCDEF";
+const char DIGIT_PAIRS[] =
+    "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+    "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+} // namespace
+
+size_t NumberFormatter::formatInteger(uint64_t value, uint8_t base, char *buf, size_t size, uint8_t minDigits) {
+    if (!buf || size == 0) return 0;
+
+    // 从低位向高位写入，64位二进制最多64位数字
+    char digits[64];
+    char *p = digits + sizeof(digits);
+    if (base == 10) {
+        while (value >= 100) {
+            uint32_t pair = (uint32_t)(value % 100);
+            value /= 100;
+            p -= 2;
+            memcpy(p, DIGIT_PAIRS + pair * 2, 2);
+        }
+        if (value >= 10) {
+            p -= 2;
+            memcpy(p, DIGIT_PAIRS + value * 2, 2);
+        } else {
+            *--p = (char)('0' + value);
+        }
+    } else {
+        uint8_t shift = base == 16 ? 4 : base == 8 ? 3 : 1;
+        uint8_t mask = (1 << shift) - 1;
+        do {
+            *--p = RADIX_DIGITS[value & mask];
+            value >>= shift;
+        } while (value);
+    }
+
+    size_t length = digits + sizeof(digits) - p;
+    size_t pad = minDigits > length ? minDigits - length : 0;
+    if (pad + length >= size) {
+        buf[0] = '\0';
+        return 0;
+    }
+    memset(buf, '0', pad);
+    memcpy(buf + pad, p, length);
+    buf[pad + length] = '\0';
+    return pad + length;
+}
+
+int NumberFormatter::shortestDigits(double value, char *digits, int &point) {
+    DiyFp v = fromDouble(value);
+    DiyFp minus, plus;
+    boundaries(v, minus, plus);
+
+    int K;
+    const DiyFp cached = cachedPower(plus.e, K);
+    const DiyFp W = v.normalize() * cached;
+    DiyFp Wp = plus * cached;
+    DiyFp Wm = minus * cached;
+    // 乘法各有最多1ulp的误差，区间向内收缩保证结果可以还原
+    Wm.f++;
+    Wp.f--;
+
+    int len = digitGen(W, Wp, Wp.f - Wm.f, digits, K);
+    point = len + K;
+    return len;
+}
+
+const char* NumberFormatter::format(double value, ScratchArena &arena, int maxDecimals) {
+    char buf[BUFFER_SIZE];
+    size_t length = formatTo(value, buf, sizeof(buf), maxDecimals);
+    return arena.copy(buf, length);
+}
+
+size_t NumberFormatter::formatTo(double value, char *buf, size_t size, int maxDecimals) {
+    if (!buf || size == 0) return 0;
+    Writer out = {buf, size, 0};
+
+    if (isnan(value)) {
+        out.put("nan", 3);
+    } else if (isinf(value)) {
+        if (value < 0) out.put('-');
+        out.put("inf", 3);
+    } else if (value == 0.0) {
+        out.put('0');
+    } else {
+        if (maxDecimals < 0) maxDecimals = 0;
+        if (maxDecimals > MAX_DECIMALS) maxDecimals = MAX_DECIMALS;
+
+        char digits[20];
+        int point;
+        int len = shortestDigits(value < 0 ? -value : value, digits, point);
+
+        // 先按小数位数舍入，整数位过多或舍入后为0时改用科学计数法
+        char fixed[20];
+        memcpy(fixed, digits, len);
+        int fixedPoint = point;
+        int fixedLen = roundDigits(fixed, len, fixedPoint, point + maxDecimals);
+
+        if (fixedLen > 0 && fixedPoint <= MAX_FIXED_DIGITS) {
+            if (value < 0) out.put('-');
+            if (fixedPoint <= 0) {
+                out.put('0');
+                out.put('.');
+                for (int i = fixedPoint; i < 0; i++) out.put('0');
+                out.put(fixed, fixedLen);
+            } else if (fixedPoint >= fixedLen) {
+                out.put(fixed, fixedLen);
+                for (int i = fixedLen; i < fixedPoint; i++) out.put('0');
+            } else {
+                out.put(fixed, fixedPoint);
+                out.put('.');
+                out.put(fixed + fixedPoint, fixedLen - fixedPoint);
+            }
+        } else {
+            // 尾数保留1位整数和maxDecimals位小数
+            len = roundDigits(digits, len, point, 1 + maxDecimals);
+            if (value < 0) out.put('-');
+            out.put(digits[0]);
+            if (len > 1) {
+                out.put('.');
+                out.put(digits + 1, len - 1);
+            }
+            out.put('e');
+            out.putInt(point - 1);
+        }
+    }
+
+    buf[out.len] = '\0';
+    return out.len;
+}
+
+size_t NumberFormatter::formatFit(double value, char *buf, size_t size, const NumberFormat &format,
+                                  uint16_t widthPx, uint8_t charWidthPx) {
+    if (!buf || size == 0) return 0;
+    if (isnan(value) || isinf(value)) {
+        return formatTo(value, buf, size);
+    }
+
+    int maxChars = charWidthPx > 0 ? widthPx / charWidthPx : (int)size - 1;
+    if (maxChars > (int)size - 1) maxChars = (int)size - 1;
+    int maxDecimals = format.decimalPlaces > MAX_DECIMALS ? MAX_DECIMALS : format.decimalPlaces;
+
+    bool negative = value < 0;
+    bool zero = value == 0.0;
+    char digits[20];
+    int point = 0;
+    int len = zero ? 0 : shortestDigits(negative ? -value : value, digits, point);
+
+    Writer out = {buf, size, 0};
+    int prefixLen = format.currency.length() + ((negative || format.showSign) ? 1 : 0);
+    auto putPrefix = [&]() {
+        if (negative) {
+            out.put('-');
+        } else if (format.showSign) {
+            out.put('+');
+        }
+        out.put(format.currency.c_str(), format.currency.length());
+    };
+
+    // 1. 定点：从全部小数位开始逐位减少，舍入后为0的非零值不用定点表示
+    char work[20];
+    if (!format.scientificNotation) {
+        for (int decimals = maxDecimals; decimals >= 0; decimals--) {
+            memcpy(work, digits, len);
+            int workPoint = point;
+            int workLen = zero ? 0 : roundDigits(work, len, workPoint, point + decimals);
+            if (!zero && workLen == 0) break;
+            if (workPoint > MAX_FIXED_DIGITS) break;
+
+            int frac = format.showTrailingZeros ? decimals : workLen - workPoint;
+            if (frac < 0) frac = 0;
+            if (prefixLen + fixedLength(workPoint, frac, format, format.useThousandsSeparator) <= maxChars || (zero && decimals == 0)) {
+                putPrefix();
+                writeFixed(out, work, workLen, workPoint, frac, format, format.useThousandsSeparator);
+                buf[out.len] = '\0';
+                return out.len;
+            }
+        }
+    }
+
+    // 2. 工程计数法：尾数整数部分1~3位，小数位同样逐位减少，都放不下时使用最短的一种
+    if (zero) {
+        digits[0] = '0';
+        len = 1;
+        point = 1;
+    }
+    for (int decimals = maxDecimals; decimals >= 0; decimals--) {
+        int exponent = engineeringExponent(point - 1);
+        int intDigits = point - exponent;
+
+        memcpy(work, digits, len);
+        int workPoint = point;
+        int workLen = roundDigits(work, len, workPoint, intDigits + decimals);
+        if (workPoint != point) {
+            // 进位到下一个数量级（如999.96e3 → 1e6）
+            exponent = engineeringExponent(workPoint - 1);
+            intDigits = workPoint - exponent;
+        }
+
+        int frac = format.showTrailingZeros ? decimals : workLen - intDigits;
+        if (frac < 0) frac = 0;
+        int total = prefixLen + fixedLength(intDigits, frac, format, false) + 1 + decimalLength(exponent);
+        if (total <= maxChars || decimals == 0) {
+            putPrefix();
+            writeFixed(out, work, workLen, intDigits, frac, format, false);
+            out.put('e');
+            out.putInt(exponent);
+            break;
+        }
+    }
+
+    buf[out.len] = '\0';
+    return out.len;
+}
@@ -2,12 +2,18 @@
  * @file NumberFormatter.h
  * @brief 数字格式化工具类
  * @details 提供统一的数字格式化功能，支持智能小数显示和精度控制
- * 
+ *
  * 格式化规则：
  * - 整数显示为整数（如：3）
  * - 小数显示最多3位小数并去尾零（如：0.625、2.5）
- * - 采用四舍五入规则
- * 
+ * - 采用四舍五入规则，在最短十进制表示上进行（2.675显示为2.68）
+ * - 整数部分超过15位，或非零值舍入后为0时使用科学计数法（如：1.235e20、1e-5）
+ *
+ * 最短表示由Grisu2算法生成：只用整数运算，不分配内存，结果可以精确还原为原double。
+ *
+ * formatFit()按NumberFormat选项和行的像素宽度选择表示：完整小数 → 减少小数位 → 工程计数法，
+ * 各候选的长度直接由数字位数算出，不需要试绘。
+ *
  * @author Calculator Project
  * @date 2024-01-07
  * @version 1.0
@@ -19,44 +25,111 @@
 #include <Arduino.h>
 #include <math.h>
 
+class ScratchArena;
+
+/**
+ * @brief 数字格式化选项
+ */
+struct NumberFormat {
+    bool useThousandsSeparator;     ///< 使用千位分隔符
+    bool showTrailingZeros;         ///< 显示尾随零
+    uint8_t decimalPlaces;          ///< 小数位数
+    bool scientificNotation;        ///< 科学计数法（工程计数法，指数为3的倍数）
+    bool showSign;                  ///< 显示正负号
+    String currency;                ///< 货币符号
+    String thousandsSeparator;      ///< 千位分隔符
+    String decimalSeparator;        ///< 小数分隔符
+
+    NumberFormat()
+        : useThousandsSeparator(false),
+          showTrailingZeros(false),
+          decimalPlaces(3),
+          scientificNotation(false),
+          showSign(false),
+          thousandsSeparator(","),
+          decimalSeparator(".") {
+    }
+};
+
 /**
  * @brief 数字格式化工具类
  */
 class NumberFormatter {
 public:
+    static const size_t BUFFER_SIZE = 32;       ///< formatTo()缓冲区的推荐大小
+    static const int MAX_FIXED_DIGITS = 15;     ///< 整数部分超过此位数时使用科学计数法
+    static const int MAX_DECIMALS = 15;         ///< maxDecimals的上限
+
     /**
      * @brief 智能格式化数字
      * @param value 要格式化的数字
      * @param maxDecimals 最大小数位数（默认为3）
      * @return 格式化后的字符串
-     * 
+     *
      * 规则：
      * - 如果是整数，不显示小数点
      * - 如果是小数，最多显示maxDecimals位，去掉尾随的零
      */
     static String format(double value, int maxDecimals = 3) {
-        // 首先进行四舍五入到指定精度
-        double rounded = roundTo(value, maxDecimals);
-        
-        // 检查是否为整数
-        if (isInteger(rounded)) {
-            return String((long)rounded);
-        }
-        
-        // 格式化为字符串并去掉尾随的零
-        String result = String(rounded, maxDecimals);
-        
-        // 去掉尾随的零和可能的小数点
-        while (result.endsWith("0") && result.indexOf('.') != -1) {
-            result.remove(result.length() - 1);
-        }
-        if (result.endsWith(".")) {
-            result.remove(result.length() - 1);
-        }
-        
-        return result;
+        char buf[BUFFER_SIZE];
+        formatTo(value, buf, sizeof(buf), maxDecimals);
+        return String(buf);
     }
-    
+
+    /**
+     * @brief 格式化到临时内存（规则同format()，不经过堆）
+     * @param value 要格式化的数字
+     * @param arena 临时内存，结果在所在作用域结束前有效
+     * @param maxDecimals 最大小数位数
+     * @return 格式化结果，临时内存不足时为空串
+     */
+    static const char* format(double value, ScratchArena &arena, int maxDecimals = 3);
+
+    /**
+     * @brief 格式化到调用者提供的缓冲区（规则同format()，不分配内存）
+     * @param value 要格式化的数字
+     * @param buf 输出缓冲区，总以'\0'结尾
+     * @param size 缓冲区大小，BUFFER_SIZE足够容纳任何结果
+     * @param maxDecimals 最大小数位数
+     * @return 写入的字符数（不含'\0'）
+     */
+    static size_t formatTo(double value, char *buf, size_t size, int maxDecimals = 3);
+
+    /**
+     * @brief 按显示宽度格式化
+     * @param value 要格式化的数字
+     * @param buf 输出缓冲区，总以'\0'结尾
+     * @param size 缓冲区大小
+     * @param format 格式选项，decimalPlaces为最多显示的小数位数
+     * @param widthPx 可用的像素宽度
+     * @param charWidthPx 每个字符的像素宽度（等宽字体，取该行允许的最小字号）
+     * @return 写入的字符数（不含'\0'）
+     *
+     * 依次选择第一个放得下的表示：全部小数位、逐位减少小数位、工程计数法（尾数同样逐位减少）。
+     */
+    static size_t formatFit(double value, char *buf, size_t size, const NumberFormat &format,
+                            uint16_t widthPx, uint8_t charWidthPx);
+
+    /**
+     * @brief 格式化无符号整数（程序员模式），查表逐位写出，不分配内存
+     * @param value 数值（负数由调用者取补码后自行加'-'）
+     * @param base 2、8、10或16，16进制用大写字母
+     * @param buf 输出缓冲区，总以'\0'结尾；64位二进制需要65字节
+     * @param size 缓冲区大小
+     * @param minDigits 不足时在前面补0（如按字长显示全部位）
+     * @return 写入的字符数（不含'\0'），缓冲区不足时为0且结果为空串
+     */
+    static size_t formatInteger(uint64_t value, uint8_t base, char *buf, size_t size, uint8_t minDigits = 1);
+
+    /**
+     * @brief 生成最短的往返十进制表示
+     * @param value 有限的正数
+     * @param digits 输出数字（不含小数点），至少17字节，不以'\0'结尾
+     * @param point 输出小数点位置：value = 0.d1d2...dn × 10^point
+     * @return 数字位数
+     */
+    static int shortestDigits(double value, char *digits, int &point);
+
     /**
      * @brief 四舍五入到指定小数位数
      * @param value 要处理的数字
@@ -67,11 +140,11 @@ public:
         if (decimals <= 0) {
             return round(value);
         }
-        
+
         double multiplier = pow(10.0, decimals);
         return round(value * multiplier) / multiplier;
     }
-    
+
     /**
      * @brief 检查数字是否为整数（在浮点精度范围内）
      * @param value 要检查的数字
@@ -80,7 +153,7 @@ public:
     static bool isInteger(double value) {
         return abs(value - round(value)) < 1e-9;  // 考虑浮点精度误差
     }
-    
+
     /**
      * @brief 格式化为固定小数位数（不去零）
      * @param value 要格式化的数字
@@ -93,4 +166,4 @@ public:
     }
 };
 
-#endif // NUMBER_FORMATTER_H
\ No newline at end of file
+#endif // NUMBER_FORMATTER_H
@@ -0,0 +1,25 @@
+/**
+ * @file PaletteLut.cpp
+ * @brief 预先展开的256项颜色查找表实现
+ *
+ * @author Calculator Project
+ */
+
+#include "PaletteLut.h"
+#include <string.h>
+
+PaletteLut::PaletteLut() {
+    memset(_entries, 0, sizeof(_entries));
+}
+
+void PaletteLut::compile(const CRGBPalette16& palette, TBlendType blend) {
+    for (uint16_t i = 0; i < SIZE; i++) {
+        _entries[i] = ColorFromPalette(palette, i, 255, blend);
+    }
+}
+
+void PaletteLut::compile(CRGB (*map)(uint8_t index)) {
+    for (uint16_t i = 0; i < SIZE; i++) {
+        _entries[i] = map(i);
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file PaletteLut.h
+ * @brief 预先展开的256项颜色查找表
+ * @details ColorFromPalette每次调用都要在16项调色板的相邻两项之间插值，HeatColor、
+ * CHSV转RGB也都是逐像素的分段计算。效果只在满亮度下用到这些映射时，可以在启动时
+ * 展开成256项RGB表（768字节，放在内部RAM），每个像素的着色变成一次下标读取：
+ * - compile(palette, blend)：逐项调用ColorFromPalette（亮度255），和运行时调用的结果逐位一致
+ * - compile(map)：任意 uint8_t → CRGB 的映射（HeatColor、满饱和满亮度的色相等）
+ * - 亮度由调用方在查表之后缩放
+ *
+ * @author Calculator Project
+ */
+
+#ifndef PALETTE_LUT_H
+#define PALETTE_LUT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class PaletteLut {
+public:
+    static const uint16_t SIZE = 256;
+
+    /**
+     * @brief 全黑，compile之前查表得到黑色
+     */
+    PaletteLut();
+
+    /**
+     * @brief 展开16项调色板
+     * @param palette 调色板
+     * @param blend LINEARBLEND在相邻两项之间插值，NOBLEND取最近的一项
+     */
+    void compile(const CRGBPalette16& palette, TBlendType blend = LINEARBLEND);
+
+    /**
+     * @brief 展开任意映射（每项调用一次map）
+     */
+    void compile(CRGB (*map)(uint8_t index));
+
+    const CRGB& operator[](uint8_t index) const { return _entries[index]; }
+
+private:
+    CRGB _entries[SIZE];
+};
+
+#endif // PALETTE_LUT_H
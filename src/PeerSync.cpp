@@ -0,0 +1,381 @@
+/**
+ * @file PeerSync.cpp
+ * @brief 同组设备之间经ESP-NOW合计计算结果的实现
+ *
+ * @author Calculator Project
+ */
+
+#include "PeerSync.h"
+
+#if PEER_SYNC_ENABLED
+
+#include "Console.h"
+#include "FleetConfig.h"
+#include "HistorySync.h"
+#include "LoopScheduler.h"
+#include "Logger.h"
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <math.h>
+
+#define TAG_PEER "PeerSync"
+
+#define PEER_NAMESPACE "peer_sync"
+#define PEER_MAGIC 0xC7
+
+namespace {
+
+const uint8_t BROADCAST[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+void cmdPeer(const ConsoleArgs& args) {
+    PeerSync& peers = PeerSync::instance();
+    int group = 0;
+    if (args.count < 2) {
+        peers.printStatus();
+    } else if (args.is(1, "pair") && args.toInt(2, group) && group >= 0 && group <= 0xFFFF) {
+        peers.setGroup((uint16_t)group);
+        Serial.println(group ? "组号已保存" : "已取消配对");
+    } else if (args.is(1, "clear")) {
+        peers.clear();
+        Serial.println("已开始新的一轮");
+    } else {
+        Serial.println("用法: peer [pair <组号>|clear]");
+    }
+}
+
+constexpr ConsoleCommand PEER_COMMANDS[] = {
+    {"peer", "[pair <组号>|clear]", "多台合计：显示全组总和（pair设置组号，0取消；clear全组清零）", cmdPeer},
+};
+static_assert(consoleSorted(PEER_COMMANDS), "命令表必须按名称排序");
+
+void printMac(const uint8_t* mac) {
+    Serial.printf("%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+} // namespace
+
+PeerSync::PeerSync()
+    : _radioOn(false),
+      _idleTimer(TimerWheel::INVALID),
+      _group(GROUP_NONE),
+      _epoch(0),
+      _sequence(0),
+      _total(0),
+      _dirty(false),
+      _active(false),
+      _peerCount(0),
+      _sent(0),
+      _sendErrors(0),
+      _received(0),
+      _dropped(0),
+      _radioStarts(0),
+      _radioOnMs(0),
+      _radioSince(0) {
+    static_assert(sizeof(Packet) == 32, "Packet的布局与对端不一致");
+}
+
+bool PeerSync::begin() {
+    if (!_preferences.begin(PEER_NAMESPACE, false)) {
+        LOG_E(TAG_PEER, "无法打开NVS");
+        return false;
+    }
+    _group = _preferences.getUShort("group", GROUP_NONE);
+    _epoch = _preferences.getUShort("epoch", 0);
+    _sequence = _preferences.getULong("seq", 0);
+    _total = _preferences.getDouble("total", 0);
+
+    _idleTimer = TimerWheel::instance().create("peer", onIdle, this);
+    Console::instance().addCommands(PEER_COMMANDS);
+    if (_group == GROUP_NONE) {
+        LOG_I(TAG_PEER, "多台合计未配对");
+    } else {
+        LOG_I(TAG_PEER, "多台合计: 组 %u，第 %u 轮，本机 %lu 个结果", _group, _epoch, (unsigned long)_sequence);
+    }
+    return true;
+}
+
+void PeerSync::poll() {
+    Received received;
+    while (_rx.pop(received)) {
+        handle(received);
+    }
+}
+
+void PeerSync::publish(const HistoryRecord &record) {
+    if (_group == GROUP_NONE || !isfinite(record.result)) return;
+
+    _sequence++;
+    _total += record.result;
+    _dirty = true;
+    // 无线没开（或历史同步在用）时只计入本机，下次打开无线时的状态包带上
+    if (radioOn()) {
+        send(PACKET_RESULT, record.result, record.timestamp);
+        touch();
+    }
+}
+
+void PeerSync::setActive(bool active) {
+    _active = active;
+    if (!isEnabled()) return;
+    if (active) {
+        // 输入期间一直开着，不计时
+        if (radioOn()) TimerWheel::instance().cancel(_idleTimer);
+    } else if (_radioOn) {
+        touch();
+    }
+}
+
+void PeerSync::setGroup(uint16_t group) {
+    if (group == _group) return;
+    if (_radioOn) radioOff();
+
+    // 换组后从零开始，旧组的累计不带过去；组里已有更新的轮次时收到第一个包就跟上
+    _group = group;
+    _peerCount = 0;
+    startEpoch(0);
+    save();
+    if (radioOn()) touch();
+}
+
+void PeerSync::clear() {
+    startEpoch(_epoch + 1);
+    save();
+    if (radioOn()) {
+        send(PACKET_STATE, 0, 0);
+        touch();
+    }
+}
+
+double PeerSync::getGrandTotal() const {
+    double total = _total;
+    for (uint8_t i = 0; i < _peerCount; i++) {
+        total += _peers[i].total;
+    }
+    return total;
+}
+
+bool PeerSync::isEnabled() const {
+#if FLEET_CONFIG_ENABLED
+    if (FleetConfig::instance().hasKey()) return true;
+#endif
+    return _group != GROUP_NONE;
+}
+
+bool PeerSync::radioOn() {
+    if (_radioOn) return true;
+    if (!isEnabled()) return false;
+
+    // 与历史同步互斥：先置位再检查对方，两边同时打开时至少一方退让
+    _radioOn.store(true);
+#if HISTORY_SYNC_ENABLED && HISTORY_LOG_ENABLED
+    if (HistorySync::instance().isBusy()) {
+        _radioOn.store(false);
+        return false;
+    }
+#endif
+
+    uint32_t start = micros();
+    // 只启动STA接口给ESP-NOW用，不连接路由器
+    WiFi.mode(WIFI_STA);
+    esp_wifi_set_channel(PEER_SYNC_CHANNEL, WIFI_SECOND_CHAN_NONE);
+    if (esp_now_init() != ESP_OK) {
+        LOG_E(TAG_PEER, "ESP-NOW初始化失败");
+        WiFi.mode(WIFI_OFF);
+        _radioOn.store(false);
+        return false;
+    }
+    esp_now_register_recv_cb(onReceive);
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, BROADCAST, sizeof(BROADCAST));
+    peer.channel = PEER_SYNC_CHANNEL;
+    peer.ifidx = WIFI_IF_STA;
+    esp_now_add_peer(&peer);
+
+    _radioStarts++;
+    _radioSince = millis();
+    LOG_I(TAG_PEER, "无线已打开，%lu us", (unsigned long)(micros() - start));
+    // 请求无线开着的同组设备报告累计
+    send(PACKET_HELLO, 0, 0);
+    return true;
+}
+
+void PeerSync::radioOff() {
+    if (!_radioOn) return;
+    TimerWheel::instance().cancel(_idleTimer);
+    esp_now_unregister_recv_cb();
+    esp_now_deinit();
+    WiFi.mode(WIFI_OFF);
+    _radioOnMs += millis() - _radioSince;
+    // 关闭之后历史同步才可以打开WiFi
+    _radioOn.store(false);
+    LOG_I(TAG_PEER, "无线已关闭，打开 %lu ms", (unsigned long)(millis() - _radioSince));
+    if (_dirty) save();
+}
+
+void PeerSync::touch() {
+    if (!_active) {
+        TimerWheel::instance().start(_idleTimer, PEER_SYNC_IDLE_MS);
+    }
+}
+
+void PeerSync::onIdle(void *context) {
+    static_cast<PeerSync*>(context)->radioOff();
+}
+
+bool PeerSync::broadcast(const uint8_t *data, size_t length) {
+    if (!radioOn()) return false;
+    touch();
+    if (esp_now_send(BROADCAST, data, length) != ESP_OK) {
+        _sendErrors++;
+        return false;
+    }
+    _sent++;
+    return true;
+}
+
+void PeerSync::send(PacketType type, double result, uint32_t timestamp) {
+    Packet packet;
+    packet.magic = PEER_MAGIC;
+    packet.type = type;
+    packet.group = _group;
+    packet.epoch = _epoch;
+#if FLEET_CONFIG_ENABLED
+    packet.fleetVersion = FleetConfig::instance().version();
+#else
+    packet.fleetVersion = 0;
+#endif
+    packet.sequence = _sequence;
+    packet.timestamp = timestamp;
+    packet.total = _total;
+    packet.result = result;
+    if (esp_now_send(BROADCAST, (const uint8_t*)&packet, sizeof(packet)) == ESP_OK) {
+        _sent++;
+    } else {
+        _sendErrors++;
+    }
+}
+
+void PeerSync::onReceive(const uint8_t *mac, const uint8_t *data, int length) {
+    // WiFi任务中：只入队，解析在主循环
+    PeerSync& self = instance();
+#if FLEET_CONFIG_ENABLED
+    if (length > 0 && data[0] == FleetConfig::MAGIC) {
+        FleetConfig::instance().onReceive(mac, data, length);
+        return;
+    }
+#endif
+    if (length != (int)sizeof(Packet) || data[0] != PEER_MAGIC) return;
+    Received received;
+    memcpy(received.mac, mac, sizeof(received.mac));
+    memcpy(&received.packet, data, sizeof(Packet));
+    if (!self._rx.push(received)) {
+        self._dropped++;
+        return;
+    }
+    LoopScheduler::instance().wake();
+}
+
+void PeerSync::handle(const Received &received) {
+    const Packet& packet = received.packet;
+#if FLEET_CONFIG_ENABLED
+    // 不论组号：对方的机群配置落后时转发
+    FleetConfig::instance().onPeerVersion(packet.fleetVersion);
+#endif
+    if (_group == GROUP_NONE || packet.group != _group) return;
+    _received++;
+    if (_radioOn) touch();
+
+    int16_t age = (int16_t)(packet.epoch - _epoch);
+    if (age < 0) {
+        // 对方还在旧的一轮，回复本机状态让它跟上
+        send(PACKET_STATE, 0, 0);
+        return;
+    }
+    if (age > 0) {
+        LOG_I(TAG_PEER, "同组设备开始了第 %u 轮，累计清零", packet.epoch);
+        startEpoch(packet.epoch);
+        save();
+    }
+
+    Peer* peer = findPeer(received.mac);
+    if (!peer) {
+        if (_peerCount >= PEER_SYNC_MAX_PEERS) {
+            LOG_W(TAG_PEER, "同组设备超过 %d 台，忽略新设备", PEER_SYNC_MAX_PEERS);
+            return;
+        }
+        peer = &_peers[_peerCount++];
+        memcpy(peer->mac, received.mac, sizeof(peer->mac));
+        peer->sequence = 0;
+        peer->total = 0;
+        peer->lastResult = NAN;
+    }
+    if (packet.sequence >= peer->sequence) {
+        peer->sequence = packet.sequence;
+        peer->total = packet.total;
+        peer->lastSeen = millis();
+        if (packet.type == PACKET_RESULT) {
+            peer->lastResult = packet.result;
+        }
+    }
+    if (packet.type == PACKET_HELLO) {
+        send(PACKET_STATE, 0, 0);
+    }
+}
+
+void PeerSync::startEpoch(uint16_t epoch) {
+    _epoch = epoch;
+    _sequence = 0;
+    _total = 0;
+    _dirty = true;
+    for (uint8_t i = 0; i < _peerCount; i++) {
+        _peers[i].sequence = 0;
+        _peers[i].total = 0;
+        _peers[i].lastResult = NAN;
+    }
+}
+
+void PeerSync::save() {
+    _preferences.putUShort("group", _group);
+    _preferences.putUShort("epoch", _epoch);
+    _preferences.putULong("seq", _sequence);
+    _preferences.putDouble("total", _total);
+    _dirty = false;
+}
+
+PeerSync::Peer *PeerSync::findPeer(const uint8_t *mac) {
+    for (uint8_t i = 0; i < _peerCount; i++) {
+        if (memcmp(_peers[i].mac, mac, sizeof(_peers[i].mac)) == 0) {
+            return &_peers[i];
+        }
+    }
+    return nullptr;
+}
+
+void PeerSync::printStatus() const {
+    Serial.println("=== 多台合计 ===");
+    if (_group == GROUP_NONE) {
+        Serial.println("未配对（peer pair <组号>）");
+        return;
+    }
+    uint32_t onMs = _radioOnMs + (_radioOn ? millis() - _radioSince : 0);
+    Serial.printf("组号: %u，第 %u 轮，信道 %d\n", _group, _epoch, PEER_SYNC_CHANNEL);
+    Serial.printf("无线: %s，打开 %lu 次，共 %lu ms（运行时间的 %.2f%%）\n", _radioOn ? "打开" : "关闭",
+                  (unsigned long)_radioStarts, (unsigned long)onMs, onMs * 100.0 / (millis() ? millis() : 1));
+    Serial.printf("本机: %lu 个结果，累计 %.12g\n", (unsigned long)_sequence, _total);
+    for (uint8_t i = 0; i < _peerCount; i++) {
+        const Peer& peer = _peers[i];
+        Serial.print("  ");
+        printMac(peer.mac);
+        Serial.printf(": %lu 个结果，累计 %.12g", (unsigned long)peer.sequence, peer.total);
+        if (!isnan(peer.lastResult)) {
+            Serial.printf("，最近 %.12g", peer.lastResult);
+        }
+        Serial.printf("，%lu 秒前\n", (unsigned long)((millis() - peer.lastSeen) / 1000));
+    }
+    Serial.printf("全组总和: %.12g\n", getGrandTotal());
+    Serial.printf("发送 %lu（失败 %lu），接收 %lu（队列满丢弃 %lu）\n", (unsigned long)_sent,
+                  (unsigned long)_sendErrors, (unsigned long)_received, (unsigned long)_dropped);
+}
+
+#endif // PEER_SYNC_ENABLED
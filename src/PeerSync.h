@@ -0,0 +1,172 @@
+/**
+ * @file PeerSync.h
+ * @brief 同组设备之间经ESP-NOW合计计算结果
+ * @details 同一场地的几台计算器各自计数，需要一个共同的总和：
+ * - 每完成一次计算（CalculatorCore::addToHistory），把历史中的这条记录压缩成32字节的二进制包广播给同组设备，
+ *   不连接路由器，无线已打开时从按键到发出在几毫秒内
+ * - 包中带发送方本轮的累计和与结果数，而不是增量：丢包、关机或无线关闭期间漏掉的包，
+ *   由同一台设备的下一个包补齐；序号小于已记录的包（乱序）直接丢弃
+ * - 全组总和 = 本机累计 + 每台同组设备最近报告的累计
+ * - peer clear 开始新的一轮（轮次加1）并广播，收到更新轮次的设备清零后跟上；轮次旧的包被忽略并回复本机状态
+ * - 无线按占空比开关：按键扫描离开空闲模式时提前打开（第一个结果不用等无线启动），输入期间保持，
+ *   扫描回到空闲、且最后一次发送或接收之后PEER_SYNC_IDLE_MS关闭；
+ *   打开时广播一次状态请求，无线开着的同组设备回复各自的累计
+ * - 无线打开期间不进入浅睡眠；与历史同步（HistorySync）互斥，哪个先打开无线哪个先用
+ * - 组号、轮次、本机累计和序号保存在NVS，关闭无线时写入
+ * - 机群配置（FleetConfig）借用这里的无线：包中带本机已应用的配置版本，它的帧按首字节转交；
+ *   设置了站点密钥时，未配对的设备也在输入前后打开无线
+ *
+ * 接收回调在WiFi任务中，只把包放进队列并唤醒主循环，解析和合计都在主循环中（poll()）。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef PEER_SYNC_H
+#define PEER_SYNC_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if PEER_SYNC_ENABLED
+
+#include <Preferences.h>
+#include <atomic>
+#include "HistoryBuffer.h"
+#include "SpscQueue.h"
+#include "TimerWheel.h"
+
+class PeerSync {
+public:
+    static const uint16_t GROUP_NONE = 0;
+
+    static PeerSync& instance() {
+        static PeerSync instance;
+        return instance;
+    }
+
+    /**
+     * @brief 读取NVS中的组号和累计，注册串口命令
+     */
+    bool begin();
+
+    /**
+     * @brief 主循环每轮调用：处理收到的包
+     */
+    void poll();
+
+    /**
+     * @brief 完成了一次计算，计入本机累计并广播（主循环调用）
+     */
+    void publish(const HistoryRecord &record);
+
+    /**
+     * @brief 按键扫描进入/离开空闲模式时调用：输入期间保持无线打开，回到空闲后开始计时关闭
+     */
+    void setActive(bool active);
+
+    /**
+     * @brief 设置组号并保存，GROUP_NONE取消配对（关闭无线）
+     */
+    void setGroup(uint16_t group);
+
+    /**
+     * @brief 开始新的一轮：本机和已知设备的累计清零，并通知同组设备
+     */
+    void clear();
+
+    /**
+     * @brief 本机累计加上同组设备最近报告的累计
+     */
+    double getGrandTotal() const;
+
+    /**
+     * @brief 无线是否打开（期间不能睡眠，历史同步也不打开WiFi）
+     */
+    bool isRadioOn() const { return _radioOn.load(); }
+
+    /**
+     * @brief 广播其他模块的一帧（机群配置），无线没开时先打开，之后重新计时关闭
+     * @return 无线打不开或发送失败时返回false
+     */
+    bool broadcast(const uint8_t *data, size_t length);
+
+    void printStatus() const;
+
+private:
+    enum PacketType : uint8_t {
+        PACKET_RESULT = 1,          ///< 新的结果，附带累计
+        PACKET_STATE = 2,           ///< 只有累计
+        PACKET_HELLO = 3            ///< 累计，并请求同组设备回复PACKET_STATE
+    };
+
+    /**
+     * @brief 无线上传输的记录（小端，没有填充）
+     */
+    struct Packet {
+        uint8_t magic;
+        uint8_t type;               ///< PacketType
+        uint16_t group;             ///< 组号，不同组的包忽略
+        uint16_t epoch;             ///< 轮次，peer clear时加1
+        uint16_t fleetVersion;      ///< 发送方已应用的机群配置版本，0表示没有
+        uint32_t sequence;          ///< 发送方本轮的结果数
+        uint32_t timestamp;         ///< 结果的时间戳（发送方millis）
+        double total;               ///< 发送方本轮的累计
+        double result;              ///< 结果（PACKET_RESULT）
+    };
+
+    struct Received {
+        uint8_t mac[6];
+        Packet packet;
+    };
+
+    struct Peer {
+        uint8_t mac[6];
+        uint32_t sequence;
+        uint32_t lastSeen;          ///< 最后收到的时刻（millis）
+        double total;
+        double lastResult;
+    };
+
+    PeerSync();
+
+    bool isEnabled() const;         ///< 配对了或设置了站点密钥，可以打开无线
+    bool radioOn();
+    void radioOff();
+    void touch();                   ///< 重新开始计时关闭无线
+    void send(PacketType type, double result, uint32_t timestamp);
+    void handle(const Received &received);
+    void startEpoch(uint16_t epoch);
+    void save();
+    Peer *findPeer(const uint8_t *mac);
+
+    static void onReceive(const uint8_t *mac, const uint8_t *data, int length);
+    static void onIdle(void *context);
+
+    Preferences _preferences;
+    SpscQueue<Received, PEER_SYNC_RX_QUEUE> _rx;
+    std::atomic<bool> _radioOn;
+    TimerWheel::TimerId _idleTimer;
+
+    uint16_t _group;
+    uint16_t _epoch;
+    uint32_t _sequence;             ///< 本机本轮的结果数
+    double _total;                  ///< 本机本轮的累计
+    bool _dirty;                    ///< 累计有变化，关闭无线时保存
+    bool _active;                   ///< 正在输入，不关闭无线
+
+    Peer _peers[PEER_SYNC_MAX_PEERS];
+    uint8_t _peerCount;
+
+    // 统计
+    uint32_t _sent;
+    uint32_t _sendErrors;
+    uint32_t _received;
+    uint32_t _dropped;              ///< 接收队列满丢弃的包
+    uint32_t _radioStarts;
+    uint32_t _radioOnMs;            ///< 无线累计打开时间
+    uint32_t _radioSince;
+};
+
+#endif // PEER_SYNC_ENABLED
+
+#endif // PEER_SYNC_H
@@ -0,0 +1,197 @@
+/**
+ * @file PerformanceMonitor.cpp
+ * @brief 显示性能监控实现
+ *
+ * @author Calculator Project
+ */
+
+#include "PerformanceMonitor.h"
+#include <esp_timer.h>
+
+// ========== PerfHistogram ==========
+
+void PerfHistogram::reset() {
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _min = UINT32_MAX;
+    _max = 0;
+    _sum = 0;
+}
+
+uint8_t IRAM_ATTR PerfHistogram::bucketOf(uint32_t us) {
+    if (us < 16) return us;
+
+    uint8_t exp = 31 - __builtin_clz(us);       // floor(log2(us))，>= 4
+    uint8_t sub = (us >> (exp - 2)) & 0x03;     // 次高两位
+    uint32_t bucket = 16 + (exp - 4) * 4 + sub;
+    return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1;
+}
+
+uint32_t PerfHistogram::bucketUpper(uint8_t bucket) {
+    if (bucket < 16) return bucket;
+
+    uint8_t exp = (bucket - 16) / 4 + 4;
+    uint8_t sub = (bucket - 16) % 4;
+    return ((uint32_t)(4 + sub + 1) << (exp - 2)) - 1;
+}
+
+void IRAM_ATTR PerfHistogram::record(uint32_t us) {
+    _buckets[bucketOf(us)]++;
+    _count++;
+    _sum += us;
+    if (us < _min) _min = us;
+    if (us > _max) _max = us;
+}
+
+uint32_t PerfHistogram::getPercentile(uint16_t permille) const {
+    if (_count == 0) return 0;
+
+    uint32_t target = ((uint64_t)_count * permille + 999) / 1000;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += _buckets[i];
+        if (seen >= target) {
+            uint32_t upper = bucketUpper(i);
+            return upper < _max ? upper : _max;
+        }
+    }
+    return _max;
+}
+
+uint32_t PerfHistogram::getPercentileSince(const PerfHistogram& base, uint16_t permille) const {
+    if (_count < base._count) return getPercentile(permille);
+    uint32_t count = _count - base._count;
+    if (count == 0) return 0;
+
+    uint32_t target = ((uint64_t)count * permille + 999) / 1000;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        if (_buckets[i] > base._buckets[i]) seen += _buckets[i] - base._buckets[i];
+        if (seen >= target) return bucketUpper(i);
+    }
+    return _max;
+}
+
+// ========== PerformanceMonitor ==========
+
+PerformanceMonitor::PerformanceMonitor()
+    : _inputTime(0),
+      _inputPending(false),
+      _frameCount(0),
+      _windowStart(esp_timer_get_time()) {
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void PerformanceMonitor::markInput() {
+    markInput(esp_timer_get_time());
+}
+
+void PerformanceMonitor::markInput(int64_t eventTimestamp) {
+    _inputTime.store((uint32_t)eventTimestamp, std::memory_order_relaxed);
+    _inputPending.store(true, std::memory_order_release);
+}
+
+void PerformanceMonitor::recordStage(PerfStage stage, uint32_t us) {
+    if (stage >= PERF_STAGE_COUNT) return;
+
+    portENTER_CRITICAL(&_lock);
+    _stageTime[stage].record(us);
+    portEXIT_CRITICAL(&_lock);
+}
+
+void PerformanceMonitor::recordDraw(uint32_t us) {
+    portENTER_CRITICAL(&_lock);
+    _drawTime.record(us);
+    portEXIT_CRITICAL(&_lock);
+}
+
+void IRAM_ATTR PerformanceMonitor::recordFlush(uint32_t us) {
+    uint32_t now = (uint32_t)esp_timer_get_time();
+
+    // 按键之后第一次推送完成即视为该按键上屏
+    bool hasInput = _inputPending.exchange(false, std::memory_order_acquire);
+    uint32_t latency = now - _inputTime.load(std::memory_order_relaxed);
+
+    portENTER_CRITICAL(&_lock);
+    _flushTime.record(us);
+    _frameCount++;
+    if (hasInput && latency < INPUT_LATENCY_TIMEOUT_US) {
+        _inputLatency.record(latency);
+    }
+    portEXIT_CRITICAL(&_lock);
+}
+
+void PerformanceMonitor::reset() {
+    portENTER_CRITICAL(&_lock);
+    _inputLatency.reset();
+    _drawTime.reset();
+    _flushTime.reset();
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        _stageTime[i].reset();
+    }
+    _frameCount = 0;
+    _windowStart = esp_timer_get_time();
+    portEXIT_CRITICAL(&_lock);
+    _inputPending.store(false, std::memory_order_relaxed);
+}
+
+void PerformanceMonitor::snapshot(PerfHistogram &inputLatency, PerfHistogram &drawTime,
+                                  PerfHistogram &flushTime, PerfHistogram *stageTime) {
+    portENTER_CRITICAL(&_lock);
+    inputLatency = _inputLatency;
+    drawTime = _drawTime;
+    flushTime = _flushTime;
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        stageTime[i] = _stageTime[i];
+    }
+    portEXIT_CRITICAL(&_lock);
+}
+
+void PerformanceMonitor::snapshotInput(PerfHistogram &inputLatency) {
+    portENTER_CRITICAL(&_lock);
+    inputLatency = _inputLatency;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void PerformanceMonitor::printHistogram(const char *name, const PerfHistogram &hist) {
+    Serial.printf("  %-10s n=%-6lu min=%-6lu avg=%-6lu p99=%-6lu max=%lu (µs)\n",
+                  name,
+                  (unsigned long)hist.getCount(),
+                  (unsigned long)hist.getMin(),
+                  (unsigned long)hist.getAvg(),
+                  (unsigned long)hist.getPercentile(990),
+                  (unsigned long)hist.getMax());
+}
+
+void PerformanceMonitor::printReport() {
+    // 先在临界区内复制一份，串口输出较慢，不能长时间关中断
+    PerfHistogram inputLatency, drawTime, flushTime;
+    PerfHistogram stageTime[PERF_STAGE_COUNT];
+    uint32_t frames;
+    int64_t windowStart;
+
+    portENTER_CRITICAL(&_lock);
+    inputLatency = _inputLatency;
+    drawTime = _drawTime;
+    flushTime = _flushTime;
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        stageTime[i] = _stageTime[i];
+    }
+    frames = _frameCount;
+    windowStart = _windowStart;
+    _frameCount = 0;
+    _windowStart = esp_timer_get_time();
+    portEXIT_CRITICAL(&_lock);
+
+    int64_t windowUs = esp_timer_get_time() - windowStart;
+    float fps = windowUs > 0 ? frames * 1000000.0f / windowUs : 0.0f;
+
+    Serial.println("显示性能统计:");
+    printHistogram("输入延迟", inputLatency);
+    printHistogram("绘制", drawTime);
+    printHistogram("推送", flushTime);
+    printHistogram("LED反馈", stageTime[PERF_STAGE_LED]);
+    printHistogram("蜂鸣器", stageTime[PERF_STAGE_BUZZER]);
+    Serial.printf("  帧率: %.1f fps (%lu 帧 / %.1f 秒)\n",
+                  fps, (unsigned long)frames, windowUs / 1000000.0f);
+}
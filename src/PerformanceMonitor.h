@@ -0,0 +1,144 @@
+/**
+ * @file PerformanceMonitor.h
+ * @brief 显示性能监控
+ * @details 使用 esp_timer_get_time() 记录：
+ * - 按键事件到推送完成的延迟（输入到上屏）
+ * - 每帧绘制时间
+ * - 每次DMA推送时间
+ * - 推送帧率
+ * - LED、蜂鸣器等反馈环节相对扫描时刻的处理延迟
+ *
+ * 每项数据保存在固定大小的对数直方图中，可给出最小/平均/最大/p99，
+ * 记录过程无动态内存分配，可在渲染任务和推送任务中调用。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef PERFORMANCE_MONITOR_H
+#define PERFORMANCE_MONITOR_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief 微秒级对数直方图
+ * @details 16µs以下每微秒一个桶，之后每个2的幂区间分为4个桶，相对误差不超过25%
+ */
+class PerfHistogram {
+public:
+    static const uint8_t BUCKET_COUNT = 100;
+
+    PerfHistogram() { reset(); }
+
+    void reset();
+    void record(uint32_t us);
+
+    uint32_t getCount() const { return _count; }
+    uint32_t getMin() const { return _count ? _min : 0; }
+    uint32_t getMax() const { return _max; }
+    uint32_t getAvg() const { return _count ? (uint32_t)(_sum / _count) : 0; }
+
+    /**
+     * @brief 百分位数（返回所在桶的上界）
+     * @param permille 千分位，例如990表示p99
+     */
+    uint32_t getPercentile(uint16_t permille) const;
+
+    /**
+     * @brief 自base（同一直方图较早的副本）以来新增记录的百分位数
+     * @details base之后被reset()过时按全部记录计算；只有桶的上界，不受最大值截断
+     */
+    uint32_t getPercentileSince(const PerfHistogram& base, uint16_t permille) const;
+
+private:
+    static uint8_t bucketOf(uint32_t us);
+    static uint32_t bucketUpper(uint8_t bucket);
+
+    uint32_t _buckets[BUCKET_COUNT];
+    uint32_t _count;
+    uint32_t _min;
+    uint32_t _max;
+    uint64_t _sum;
+};
+
+/**
+ * @brief 按键反馈环节
+ */
+enum PerfStage {
+    PERF_STAGE_LED,         ///< LED反馈
+    PERF_STAGE_BUZZER,      ///< 蜂鸣器反馈
+    PERF_STAGE_COUNT
+};
+
+class PerformanceMonitor {
+public:
+    PerformanceMonitor();
+
+    /**
+     * @brief 记录一次按键事件（调用方任务中调用）
+     */
+    void markInput();
+
+    /**
+     * @brief 记录一次按键事件，输入延迟从扫描时刻起算
+     * @param eventTimestamp 按键扫描时刻（esp_timer_get_time()）
+     */
+    void markInput(int64_t eventTimestamp);
+
+    /**
+     * @brief 记录一个反馈环节相对扫描时刻的延迟
+     */
+    void recordStage(PerfStage stage, uint32_t us);
+
+    /**
+     * @brief 记录一帧绘制耗时
+     */
+    void recordDraw(uint32_t us);
+
+    /**
+     * @brief 记录一次推送完成（推送任务或调用方任务中调用）
+     * @param us 本次推送耗时
+     */
+    void recordFlush(uint32_t us);
+
+    /**
+     * @brief 复制一份统计（在临界区内完成，调用方再慢慢输出）
+     * @param stageTime 至少PERF_STAGE_COUNT项
+     */
+    void snapshot(PerfHistogram &inputLatency, PerfHistogram &drawTime, PerfHistogram &flushTime,
+                  PerfHistogram *stageTime);
+
+    /**
+     * @brief 只复制输入延迟的统计
+     */
+    void snapshotInput(PerfHistogram &inputLatency);
+
+    /**
+     * @brief 清空全部统计
+     */
+    void reset();
+
+    /**
+     * @brief 输出统计到串口，并开始新的帧率统计窗口
+     */
+    void printReport();
+
+private:
+    static const uint32_t INPUT_LATENCY_TIMEOUT_US = 1000000;  // 超过1秒未上屏视为该按键没有引起显示变化
+
+    void printHistogram(const char *name, const PerfHistogram &hist);
+
+    PerfHistogram _inputLatency;
+    PerfHistogram _drawTime;
+    PerfHistogram _flushTime;
+    PerfHistogram _stageTime[PERF_STAGE_COUNT];
+
+    std::atomic<uint32_t> _inputTime;    ///< 最近一次按键时间（µs低32位）
+    std::atomic<bool> _inputPending;     ///< 按键后尚未有推送完成
+    uint32_t _frameCount;                ///< 当前窗口内推送完成的帧数
+    int64_t _windowStart;                ///< 帧率窗口起点
+
+    portMUX_TYPE _lock;
+};
+
+#endif // PERFORMANCE_MONITOR_H
@@ -0,0 +1,124 @@
+/**
+ * @file PixelKernels.cpp
+ * @brief RGB565像素的填充、复制和字节交换实现
+ *
+ * @author Calculator Project
+ */
+
+#include "PixelKernels.h"
+#include <Arduino.h>
+#include <string.h>
+
+namespace {
+
+#if CONFIG_IDF_TARGET_ESP32S3
+// q0四个32位通道都写入word，每次迭代存16字节
+inline void fill128(uint8_t* dst, size_t blocks, uint32_t word) {
+    asm volatile(
+        "ee.movi.32.q q0, %[w], 0\n"
+        "ee.movi.32.q q0, %[w], 1\n"
+        "ee.movi.32.q q0, %[w], 2\n"
+        "ee.movi.32.q q0, %[w], 3\n"
+        "loopnez %[n], 1f\n"
+        "ee.vst.128.ip q0, %[d], 16\n"
+        "1:\n"
+        : [d] "+r"(dst)
+        : [n] "r"(blocks), [w] "r"(word)
+        : "memory");
+}
+
+inline void copy128(uint8_t* dst, const uint8_t* src, size_t blocks) {
+    asm volatile(
+        "loopnez %[n], 1f\n"
+        "ee.vld.128.ip q0, %[s], 16\n"
+        "ee.vst.128.ip q0, %[d], 16\n"
+        "1:\n"
+        : [d] "+r"(dst), [s] "+r"(src)
+        : [n] "r"(blocks)
+        : "memory");
+}
+#else
+inline void fill128(uint8_t* dst, size_t blocks, uint32_t word) {
+    uint32_t* p = (uint32_t*)dst;
+    for (size_t i = 0; i < blocks * 4; i++) p[i] = word;
+}
+
+inline void copy128(uint8_t* dst, const uint8_t* src, size_t blocks) {
+    memcpy(dst, src, blocks * 16);
+}
+#endif
+
+// 到下一个16字节边界还差几个像素（地址为奇数时无法对齐，返回全部）
+inline size_t headPixels(const void* p, size_t count) {
+    uintptr_t addr = (uintptr_t)p;
+    if (addr & 1) return count;
+    size_t head = ((16 - (addr & 15)) & 15) / 2;
+    return head < count ? head : count;
+}
+
+} // namespace
+
+void pixelFill(uint16_t* dst, size_t count, uint16_t color) {
+    size_t head = headPixels(dst, count);
+    for (size_t i = 0; i < head; i++) *dst++ = color;
+    count -= head;
+
+    size_t blocks = count / 8;
+    if (blocks) {
+        fill128((uint8_t*)dst, blocks, ((uint32_t)color << 16) | color);
+        dst += blocks * 8;
+        count -= blocks * 8;
+    }
+    while (count--) *dst++ = color;
+}
+
+void pixelCopy(uint16_t* dst, const uint16_t* src, size_t count) {
+    if ((((uintptr_t)dst ^ (uintptr_t)src) & 15) != 0) {
+        memcpy(dst, src, count * 2);
+        return;
+    }
+    size_t head = headPixels(dst, count);
+    for (size_t i = 0; i < head; i++) *dst++ = *src++;
+    count -= head;
+
+    size_t blocks = count / 8;
+    if (blocks) {
+        copy128((uint8_t*)dst, (const uint8_t*)src, blocks);
+        dst += blocks * 8;
+        src += blocks * 8;
+        count -= blocks * 8;
+    }
+    while (count--) *dst++ = *src++;
+}
+
+void pixelCopySwap(uint16_t* dst, const uint16_t* src, size_t count) {
+    // 两边都4字节对齐时按32位处理两个像素
+    if (((((uintptr_t)dst | (uintptr_t)src) & 3) == 0)) {
+        uint32_t* d = (uint32_t*)dst;
+        const uint32_t* s = (const uint32_t*)src;
+        size_t words = count / 2;
+        for (size_t i = 0; i < words; i++) {
+            uint32_t w = s[i];
+            d[i] = ((w << 8) & 0xFF00FF00) | ((w >> 8) & 0x00FF00FF);
+        }
+        dst += words * 2;
+        src += words * 2;
+        count -= words * 2;
+    }
+    while (count--) {
+        uint16_t p = *src++;
+        *dst++ = (uint16_t)((p << 8) | (p >> 8));
+    }
+}
+
+void pixelFillRect(uint16_t* fb, int16_t fbW, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w <= 0 || h <= 0) return;
+    uint16_t* row = fb + (int32_t)y * fbW + x;
+    if (w == fbW) {
+        pixelFill(row, (size_t)w * h, color);
+        return;
+    }
+    for (int16_t r = 0; r < h; r++, row += fbW) {
+        pixelFill(row, w, color);
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * @file PixelKernels.h
+ * @brief RGB565像素的填充、复制和字节交换
+ * @details Canvas清屏、清行和双缓冲回写都是大段连续像素：
+ * - 填充/复制在ESP32-S3上用PIE的128位寄存器（ee.vst.128.ip / ee.vld.128.ip），每条指令16字节
+ * - 目标地址先用标量写到16字节对齐，剩余不足16字节的尾部再用标量写
+ * - 复制要求源和目标相对16字节的偏移相同，否则退回memcpy
+ * - 字节交换（SPI按大端发送像素）一次处理32位两个像素
+ * - 其他目标上全部为等价的标量实现
+ *
+ * @author Calculator Project
+ */
+
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 用一种颜色填充连续像素
+ */
+void pixelFill(uint16_t* dst, size_t count, uint16_t color);
+
+/**
+ * @brief 复制连续像素（区域不能重叠）
+ */
+void pixelCopy(uint16_t* dst, const uint16_t* src, size_t count);
+
+/**
+ * @brief 复制连续像素并交换每个像素的高低字节
+ */
+void pixelCopySwap(uint16_t* dst, const uint16_t* src, size_t count);
+
+/**
+ * @brief 在帧缓冲中填充矩形（调用方已裁剪）
+ * @details 整行宽度的矩形在内存中连续，一次填充
+ */
+void pixelFillRect(uint16_t* fb, int16_t fbW, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+#endif // PIXEL_KERNELS_H
@@ -0,0 +1,304 @@
+/**
+ * @file PowerBench.cpp
+ * @brief 功耗基准实现
+ *
+ * @author Calculator Project
+ */
+
+#include "PowerBench.h"
+#include "Console.h"
+#include "KeyJournal.h"
+#include "LoopScheduler.h"
+#include "Logger.h"
+#include <driver/gpio.h>
+#include <string.h>
+
+#define TAG_BENCH "Bench"
+
+namespace {
+
+// 主层按键编号
+const uint8_t K1 = 4, K2 = 9, K3 = 13, K4 = 3, K5 = 8, K6 = 12, K7 = 2, K8 = 7, K9 = 11, K0 = 5;
+const uint8_t K_DOT = 14, K_MUL = 16, K_SUB = 17, K_ADD = 18, K_DIV = 21, K_EQ = 22, K_CLEAR = 19, K_BACK = 15;
+
+const uint16_t GAP_MS = 180;        // 连续输入时两次按键的间隔
+const uint16_t RESULT_MS = 1200;    // 按下等号后看结果的时间
+
+struct TypingStep {
+    uint8_t key;
+    uint16_t gapMs;                 ///< 松开后到下一次按下的时间
+};
+
+// 12+34= → 7.5×8= → 96÷3-40= → 退格 → 清除；每轮结束时显示回到初始状态
+const TypingStep TYPING_TRACE[] = {
+    {K1, GAP_MS}, {K2, GAP_MS}, {K_ADD, GAP_MS}, {K3, GAP_MS}, {K4, GAP_MS}, {K_EQ, RESULT_MS},
+    {K7, GAP_MS}, {K_DOT, GAP_MS}, {K5, GAP_MS}, {K_MUL, GAP_MS}, {K8, GAP_MS}, {K_EQ, RESULT_MS},
+    {K9, GAP_MS}, {K6, GAP_MS}, {K_DIV, GAP_MS}, {K3, GAP_MS}, {K_SUB, GAP_MS}, {K4, GAP_MS},
+    {K0, GAP_MS}, {K_EQ, RESULT_MS},
+    {K_BACK, GAP_MS}, {K_CLEAR, RESULT_MS},
+};
+const uint8_t TYPING_STEPS = sizeof(TYPING_TRACE) / sizeof(TYPING_TRACE[0]);
+
+void cmdPowerBench(const ConsoleArgs& args) {
+    PowerBench& bench = PowerBench::instance();
+    if (args.count < 2) {
+        bench.printStatus(Serial);
+        bench.printReport(Serial);
+    } else if (args.is(1, "start") && (args.count == 2 || args.is(2, "journal"))) {
+        bool journal = args.count > 2;
+        if (bench.isRunning()) {
+            Serial.println("功耗基准进行中");
+        } else if (!bench.start(journal)) {
+            Serial.println("按键日志为空，先录一段按键或去掉 journal");
+        } else {
+            bench.printStatus(Serial);
+        }
+    } else if (args.is(1, "stop")) {
+        bench.stop();
+    } else {
+        Serial.println("用法: power_bench [start [journal]|stop]");
+    }
+}
+
+constexpr ConsoleCommand BENCH_COMMANDS[] = {
+    {"power_bench", "[start [journal]|stop]", "功耗基准：回放输入后逐级休眠，标记引脚翻转，报告各阶段频率和睡眠占比",
+     cmdPowerBench},
+};
+static_assert(consoleSorted(BENCH_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+PowerBench::PowerBench()
+    : _timer(TimerWheel::INVALID),
+      _running(false),
+      _journal(false),
+      _completed(false),
+      _keyDown(false),
+      _phase(0),
+      _phaseCount(0),
+      _round(0),
+      _step(0),
+      _markerLevel(0),
+      _phaseStart(0),
+      _baseResidencyCount(0) {
+    memset(_baseResidency, 0, sizeof(_baseResidency));
+    memset(_baseStateMs, 0, sizeof(_baseStateMs));
+    memset(_reports, 0, sizeof(_reports));
+}
+
+void PowerBench::begin() {
+#if POWER_BENCH_MARKER_PIN >= 0
+    gpio_reset_pin((gpio_num_t)POWER_BENCH_MARKER_PIN);
+    gpio_set_direction((gpio_num_t)POWER_BENCH_MARKER_PIN, GPIO_MODE_OUTPUT);
+    gpio_set_level((gpio_num_t)POWER_BENCH_MARKER_PIN, 0);
+#endif
+    _timer = TimerWheel::instance().create("bench", onTimer, this);
+    KeyEventBus::instance().subscribe(KeySubscriber{"bench", KEY_EVENT_BIT(KEY_EVENT_PRESS), KEY_STAGE_FEEDBACK,
+                                                    onKey, nullptr, this});
+    Console::instance().addCommands(BENCH_COMMANDS);
+}
+
+const char* PowerBench::phaseName(Phase phase) {
+    switch (phase) {
+        case PHASE_TYPING: return "输入";
+        case PHASE_ACTIVE: return "活跃";
+        case PHASE_DIM: return "调暗";
+        case PHASE_LEDS_OFF: return "关灯";
+        case PHASE_PANEL_OFF: return "关屏";
+        case PHASE_LIGHT_SLEEP: return "浅睡眠";
+        default: return "?";
+    }
+}
+
+bool PowerBench::start(bool journal) {
+    if (_running) return false;
+    if (journal && !KeyJournal::instance().startReplay(false)) return false;
+
+    _running = true;
+    _journal = journal;
+    _completed = false;
+    _phaseCount = 0;
+    memset(_reports, 0, sizeof(_reports));
+
+    // 从活跃阶段开始，之后由基准控制阶段
+    SleepManager& sleep = SleepManager::instance();
+    sleep.feed();
+    sleep.setLadderHold(true);
+    LOG_I(TAG_BENCH, "功耗基准开始 (%s)", journal ? "回放按键日志" : "内置输入");
+    enterPhase(PHASE_TYPING);
+    return true;
+}
+
+void PowerBench::stop() {
+    if (!_running) return;
+    if (_journal) KeyJournal::instance().stopReplay();
+    finish(false);
+}
+
+void PowerBench::enterPhase(uint8_t phase) {
+    _phase = phase;
+    _phaseStart = millis();
+    snapshot();
+    toggleMarker();
+
+    if (phase == PHASE_TYPING) {
+        _round = 0;
+        _step = 0;
+        _keyDown = false;
+        TimerWheel::instance().start(_timer, _journal ? JOURNAL_POLL_MS : 0);
+        return;
+    }
+
+    // 活跃阶段对应SleepManager::State::ACTIVE，之后各阶段依次对应
+    SleepManager::instance().setState((SleepManager::State)(phase - PHASE_ACTIVE));
+    TimerWheel::instance().start(_timer, POWER_BENCH_STAGE_MS);
+    // 浅睡眠在主循环的SleepManager::update()中进入
+    LoopScheduler::instance().after(0);
+}
+
+void PowerBench::snapshot() {
+    _baseResidencyCount = PowerManager::instance().getResidency(_baseResidency);
+    for (uint8_t i = 0; i < SleepManager::STATE_COUNT; i++) {
+        _baseStateMs[i] = SleepManager::instance().getStateMs((SleepManager::State)i);
+    }
+}
+
+void PowerBench::closePhase() {
+    PhaseReport& report = _reports[_phase];
+    report.ms = millis() - _phaseStart;
+
+    PowerManager::Residency now[PowerManager::RESIDENCY_SLOTS];
+    report.residencyCount = PowerManager::instance().getResidency(now);
+    for (uint8_t i = 0; i < report.residencyCount; i++) {
+        report.residency[i] = now[i];
+        // 新出现的频率没有基准值，整段都算本阶段
+        for (uint8_t j = 0; j < _baseResidencyCount; j++) {
+            if (_baseResidency[j].mhz == now[i].mhz) {
+                report.residency[i].us -= _baseResidency[j].us;
+                break;
+            }
+        }
+    }
+    for (uint8_t i = 0; i < SleepManager::STATE_COUNT; i++) {
+        report.stateMs[i] = SleepManager::instance().getStateMs((SleepManager::State)i) - _baseStateMs[i];
+    }
+    _phaseCount = _phase + 1;
+}
+
+void PowerBench::onTimer(void* context) {
+    PowerBench* self = static_cast<PowerBench*>(context);
+    if (!self->_running) return;
+
+    if (self->_phase == PHASE_TYPING) {
+        if (self->_journal && KeyJournal::instance().isReplaying()) {
+            TimerWheel::instance().start(self->_timer, JOURNAL_POLL_MS);
+            return;
+        }
+        if (!self->_journal && self->_round < POWER_BENCH_TYPING_ROUNDS) {
+            self->typeStep();
+            return;
+        }
+    }
+
+    self->closePhase();
+    uint8_t next = self->_phase + 1;
+    // 关闭自动休眠（超时为0）时SleepManager不进入浅睡眠
+    SleepManager& sleep = SleepManager::instance();
+    bool lightSleep = sleep.isLightSleepEnabled() && sleep.getTimeout() != 0;
+    if (next == PHASE_LIGHT_SLEEP && !lightSleep) next = PHASE_COUNT;
+    if (next < PHASE_COUNT) {
+        self->enterPhase(next);
+    } else {
+        self->finish(true);
+    }
+}
+
+void PowerBench::typeStep() {
+    const TypingStep& step = TYPING_TRACE[_step];
+    KeyJournal& journal = KeyJournal::instance();
+    if (!_keyDown) {
+        journal.inject(KEY_EVENT_PRESS, step.key);
+        _keyDown = true;
+        TimerWheel::instance().start(_timer, KEY_HOLD_MS);
+        return;
+    }
+
+    journal.inject(KEY_EVENT_RELEASE, step.key);
+    _keyDown = false;
+    if (++_step == TYPING_STEPS) {
+        _step = 0;
+        _round++;
+    }
+    // 最后一轮之后的间隔留给结果显示，到期时进入下一阶段
+    TimerWheel::instance().start(_timer, step.gapMs);
+}
+
+void PowerBench::onKey(const KeyEvent& event, void* context) {
+    PowerBench* self = static_cast<PowerBench*>(context);
+    if (!self->_running || (event.flags & KEY_EVENT_FLAG_REPLAY)) return;
+    LOG_I(TAG_BENCH, "有按键，功耗基准中止");
+    self->stop();
+}
+
+void PowerBench::finish(bool completed) {
+    TimerWheel::instance().cancel(_timer);
+    if (!completed) closePhase();
+    toggleMarker();
+    _running = false;
+    _completed = completed;
+
+    SleepManager& sleep = SleepManager::instance();
+    sleep.setLadderHold(false);
+    sleep.feed();
+    LOG_I(TAG_BENCH, "功耗基准%s", completed ? "完成" : "中止");
+    if (completed) printReport(Serial);
+}
+
+void PowerBench::toggleMarker() {
+    _markerLevel ^= 1;
+#if POWER_BENCH_MARKER_PIN >= 0
+    gpio_set_level((gpio_num_t)POWER_BENCH_MARKER_PIN, _markerLevel);
+#endif
+}
+
+void PowerBench::printStatus(Print& out) const {
+    if (_running) {
+        out.printf("功耗基准: %s阶段 %lu/%lu s", phaseName((Phase)_phase),
+                   (unsigned long)((millis() - _phaseStart) / 1000),
+                   (unsigned long)(_phase == PHASE_TYPING ? 0 : POWER_BENCH_STAGE_MS / 1000));
+        if (_phase == PHASE_TYPING && !_journal) {
+            out.printf("，第 %u/%u 轮", _round + 1, POWER_BENCH_TYPING_ROUNDS);
+        }
+        out.println();
+    } else {
+        out.printf("功耗基准: 未运行，标记引脚 GPIO%d，每阶段 %d s\n", POWER_BENCH_MARKER_PIN,
+                   POWER_BENCH_STAGE_MS / 1000);
+    }
+}
+
+void PowerBench::printReport(Print& out) const {
+    if (!_phaseCount) return;
+    out.printf("最近一次%s，%u 个阶段:\n", _completed ? "完成" : "中止", _phaseCount);
+    for (uint8_t p = 0; p < _phaseCount; p++) {
+        const PhaseReport& report = _reports[p];
+        out.printf("  %-8s %7lu ms  CPU", phaseName((Phase)p), (unsigned long)report.ms);
+        for (uint8_t i = 0; i < report.residencyCount; i++) {
+            uint32_t ms = (uint32_t)(report.residency[i].us / 1000);
+            if (!ms) continue;
+            uint32_t permille = report.ms ? (uint32_t)((uint64_t)ms * 1000 / report.ms) : 0;
+            if (report.residency[i].mhz) {
+                out.printf("  %uMHz", report.residency[i].mhz);
+            } else {
+                out.print("  睡眠");
+            }
+            out.printf(" %lu.%lu%%", (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+        }
+        out.print("\n           休眠阶段");
+        for (uint8_t s = 0; s < SleepManager::STATE_COUNT; s++) {
+            if (!report.stateMs[s]) continue;
+            out.printf("  %s %lu ms", SleepManager::stateName((SleepManager::State)s),
+                       (unsigned long)report.stateMs[s]);
+        }
+        out.println();
+    }
+}
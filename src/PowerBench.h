@@ -0,0 +1,113 @@
+/**
+ * @file PowerBench.h
+ * @brief 功耗基准：固定的操作脚本，配合外部功率计比较各版本固件的功耗
+ * @details 串口命令 power_bench start [journal] 依次运行各阶段：
+ * - 输入：内置的一段计算器输入（数字、运算、清除）重复 POWER_BENCH_TYPING_ROUNDS 轮，
+ *   经按键日志注入；带 journal 时改为实时回放按键日志中录下的按键
+ * - 活跃、调暗、关灯、关屏、浅睡眠：暂停自动逐级进入（SleepManager::setLadderHold()），
+ *   每个阶段用 setState() 进入后停留 POWER_BENCH_STAGE_MS；浅睡眠阶段只在启用浅睡眠时运行
+ * - 开始、每个阶段边界和结束时翻转 POWER_BENCH_MARKER_PIN，功率计的波形按翻转切分即可对齐各阶段
+ * - 每个阶段结束时记下各CPU频率和浅睡眠的停留时间（PowerManager::getResidency()）
+ *   以及休眠各阶段的停留时间，结束后打印报告
+ * - 运行中有真实按键时中止，恢复正常的休眠计时
+ *
+ * @author Calculator Project
+ */
+
+#ifndef POWER_BENCH_H
+#define POWER_BENCH_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "KeyEventBus.h"
+#include "PowerManager.h"
+#include "SleepManager.h"
+#include "TimerWheel.h"
+
+class PowerBench {
+public:
+    enum Phase : uint8_t {
+        PHASE_TYPING,
+        PHASE_ACTIVE,
+        PHASE_DIM,
+        PHASE_LEDS_OFF,
+        PHASE_PANEL_OFF,
+        PHASE_LIGHT_SLEEP,
+        PHASE_COUNT
+    };
+
+    static PowerBench& instance() {
+        static PowerBench instance;
+        return instance;
+    }
+
+    /**
+     * @brief 配置标记引脚、订阅按键并注册串口命令
+     */
+    void begin();
+
+    /**
+     * @brief 开始基准
+     * @param journal 输入阶段回放按键日志，而不是内置的输入
+     * @return 已在运行或按键日志为空时返回false
+     */
+    bool start(bool journal);
+
+    /**
+     * @brief 中止基准，已完成的阶段仍保留在报告中
+     */
+    void stop();
+
+    bool isRunning() const { return _running; }
+
+    void printStatus(Print& out) const;
+    void printReport(Print& out) const;
+
+    static const char* phaseName(Phase phase);
+
+private:
+    static const uint16_t KEY_HOLD_MS = 90;         ///< 内置输入每次按住的时间
+    static const uint16_t JOURNAL_POLL_MS = 100;    ///< 回放按键日志时检查是否结束的间隔
+
+    struct PhaseReport {
+        uint32_t ms;
+        uint8_t residencyCount;
+        PowerManager::Residency residency[PowerManager::RESIDENCY_SLOTS];  ///< 本阶段的增量
+        uint32_t stateMs[SleepManager::STATE_COUNT];                       ///< 本阶段的增量
+    };
+
+    PowerBench();
+    PowerBench(const PowerBench&) = delete;
+    PowerBench& operator=(const PowerBench&) = delete;
+
+    static void onTimer(void* context);
+    static void onKey(const KeyEvent& event, void* context);
+
+    void typeStep();
+    void enterPhase(uint8_t phase);
+    void closePhase();
+    void finish(bool completed);
+    void snapshot();
+    void toggleMarker();
+
+    TimerWheel::TimerId _timer;
+    bool _running;
+    bool _journal;
+    bool _completed;                ///< 最近一次是否走完全部阶段
+    bool _keyDown;                  ///< 内置输入：当前按键已按下，等待松开
+    uint8_t _phase;
+    uint8_t _phaseCount;            ///< 最近一次已完成的阶段数
+    uint8_t _round;
+    uint8_t _step;
+    uint8_t _markerLevel;
+    uint32_t _phaseStart;
+
+    // 阶段开始时的累计值，阶段结束时求差
+    uint8_t _baseResidencyCount;
+    PowerManager::Residency _baseResidency[PowerManager::RESIDENCY_SLOTS];
+    uint32_t _baseStateMs[SleepManager::STATE_COUNT];
+
+    PhaseReport _reports[PHASE_COUNT];
+};
+
+#endif // POWER_BENCH_H
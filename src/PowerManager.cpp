@@ -0,0 +1,125 @@
+/**
+ * @file PowerManager.cpp
+ * @brief 动态调频实现
+ *
+ * @author Calculator Project
+ */
+
+#include "PowerManager.h"
+#include "Logger.h"
+#include <esp_timer.h>
+
+#define TAG_PM "PM"
+
+namespace {
+
+// PowerLock可能在渲染任务中获取，统计由各核心共用
+portMUX_TYPE residencyMux = portMUX_INITIALIZER_UNLOCKED;
+
+} // namespace
+
+bool PowerLock::begin(const char* name) {
+    if (_handle) return true;
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, name, &_handle) != ESP_OK) {
+        _handle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void PowerLock::acquire() {
+    if (!_handle) return;
+    esp_pm_lock_acquire(_handle);
+    PowerManager::instance().lockChanged(true);
+}
+
+void PowerLock::release() {
+    if (!_handle) return;
+    PowerManager::instance().lockChanged(false);
+    esp_pm_lock_release(_handle);
+}
+
+bool PowerManager::begin(int maxMhz, int minMhz, bool lightSleep) {
+    esp_pm_config_esp32s3_t config = {};
+    config.max_freq_mhz = maxMhz;
+    config.min_freq_mhz = minMhz;
+    config.light_sleep_enable = lightSleep;
+
+    esp_err_t err = esp_pm_configure(&config);
+    if (err != ESP_OK && lightSleep) {
+        // 未启用tickless idle时不支持自动浅睡眠，只开DFS
+        LOG_W(TAG_PM, "自动浅睡眠不可用 (%s)，只启用动态调频", esp_err_to_name(err));
+        config.light_sleep_enable = false;
+        lightSleep = false;
+        err = esp_pm_configure(&config);
+    }
+    if (err != ESP_OK) {
+        LOG_W(TAG_PM, "动态调频不可用 (%s)，保持固定频率", esp_err_to_name(err));
+        return false;
+    }
+
+    _enabled = true;
+    _lightSleep = lightSleep;
+    _minMhz = minMhz;
+    _maxMhz = maxMhz;
+    LOG_I(TAG_PM, "动态调频已启用: %d-%d MHz, 自动浅睡眠%s", minMhz, maxMhz, lightSleep ? "开" : "关");
+    return true;
+}
+
+uint16_t PowerManager::_effectiveMhz() const {
+    if (_sleeping) return 0;
+    if (_enabled) return _holders > 0 ? _maxMhz : _minMhz;
+    return getCpuFrequencyMhz();
+}
+
+void PowerManager::_account() {
+    int64_t now = esp_timer_get_time();
+    if (_since) _slots[_current].us += now - _since;
+    _since = now;
+
+    uint16_t mhz = _effectiveMhz();
+    if (_slotCount && _slots[_current].mhz == mhz) return;
+    for (uint8_t i = 0; i < _slotCount; i++) {
+        if (_slots[i].mhz == mhz) {
+            _current = i;
+            return;
+        }
+    }
+    // 频率种类有限（最低、最高、浅睡眠，外加手动设定的），满了就记到最后一项
+    if (_slotCount < RESIDENCY_SLOTS) {
+        _slots[_slotCount].mhz = mhz;
+        _slots[_slotCount].us = 0;
+        _current = _slotCount++;
+    }
+}
+
+uint8_t PowerManager::getResidency(Residency* out) {
+    portENTER_CRITICAL(&residencyMux);
+    _account();
+    uint8_t count = _slotCount;
+    memcpy(out, _slots, count * sizeof(Residency));
+    portEXIT_CRITICAL(&residencyMux);
+    return count;
+}
+
+void PowerManager::lockChanged(bool acquired) {
+    portENTER_CRITICAL(&residencyMux);
+    _account();
+    _holders += acquired ? 1 : -1;
+    _account();
+    portEXIT_CRITICAL(&residencyMux);
+}
+
+void PowerManager::noteFrequency() {
+    portENTER_CRITICAL(&residencyMux);
+    _account();
+    portEXIT_CRITICAL(&residencyMux);
+}
+
+void PowerManager::noteSleep(bool sleeping) {
+    portENTER_CRITICAL(&residencyMux);
+    _account();
+    _sleeping = sleeping;
+    _account();
+    portEXIT_CRITICAL(&residencyMux);
+}
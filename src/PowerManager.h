@@ -0,0 +1,115 @@
+/**
+ * @file PowerManager.h
+ * @brief 动态调频（ESP-IDF电源管理）
+ * @details
+ * - begin() 调用 esp_pm_configure() 打开DFS：没有任务持有锁时CPU降到最低频率，
+ *   任一 PowerLock 被持有时升到最高频率
+ * - 最低频率取80MHz时APB保持80MHz，UART波特率、LEDC、RMT和SPI时钟都不受调频影响
+ * - 自动浅睡眠需要FreeRTOS tickless idle，且睡眠期间USB和UART接收停止；
+ *   请求失败时退回只用DFS
+ * - 库未启用CONFIG_PM_ENABLE时begin()返回false，PowerLock不做任何事，频率保持不变
+ * - 按频率和浅睡眠累计停留时间（getResidency()，功耗基准用）：频率由 PowerLock 的持有情况推算，
+ *   只统计固件自己的锁，IDF内部的锁（BLE等）不计入；没有DFS时按 getCpuFrequencyMhz() 记录
+ *
+ * @author Calculator Project
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <esp_pm.h>
+
+/**
+ * @brief 最高频率锁（ESP_PM_CPU_FREQ_MAX），可重复获取，获取几次就要释放几次
+ */
+class PowerLock {
+public:
+    PowerLock() : _handle(nullptr) {}
+
+    /**
+     * @brief 创建锁（不在静态初始化阶段调用IDF）
+     * @param name 锁名（字符串常量，esp_pm_dump_locks()中显示）
+     * @return 电源管理不可用时返回false，之后的acquire()/release()为空操作
+     */
+    bool begin(const char* name);
+
+    void acquire();
+    void release();
+
+private:
+    esp_pm_lock_handle_t _handle;
+};
+
+class PowerManager {
+public:
+    static PowerManager& instance() {
+        static PowerManager instance;
+        return instance;
+    }
+
+    /**
+     * @brief 打开动态调频
+     * @param maxMhz 持有锁时的频率
+     * @param minMhz 空闲时的频率
+     * @param lightSleep 是否请求自动浅睡眠
+     * @return 电源管理不可用时返回false
+     */
+    bool begin(int maxMhz, int minMhz, bool lightSleep);
+
+    bool isEnabled() const { return _enabled; }
+    bool isLightSleepEnabled() const { return _lightSleep; }
+    int getMinFreqMhz() const { return _minMhz; }
+    int getMaxFreqMhz() const { return _maxMhz; }
+
+    static const uint8_t RESIDENCY_SLOTS = 4;
+
+    struct Residency {
+        uint16_t mhz;               ///< 0表示浅睡眠
+        uint64_t us;
+    };
+
+    /**
+     * @brief 各频率（和浅睡眠）的累计时间，含当前状态到现在为止的部分
+     * @param out 至少 RESIDENCY_SLOTS 项
+     * @return 有效项数
+     */
+    uint8_t getResidency(Residency* out);
+
+    /**
+     * @brief PowerLock 持有数变化（由 PowerLock 调用）
+     */
+    void lockChanged(bool acquired);
+
+    /**
+     * @brief 固定频率被 setCpuFrequencyMhz() 改变后调用
+     */
+    void noteFrequency();
+
+    /**
+     * @brief 手动浅睡眠（esp_light_sleep_start()）前后调用
+     */
+    void noteSleep(bool sleeping);
+
+private:
+    PowerManager()
+        : _enabled(false), _lightSleep(false), _minMhz(0), _maxMhz(0),
+          _holders(0), _sleeping(false), _slotCount(0), _current(0), _since(0) {}
+
+    uint16_t _effectiveMhz() const;
+    void _account();                ///< 把上次记录以来的时间计入当前状态，并按现在的状态切换（持锁调用）
+
+    bool _enabled;
+    bool _lightSleep;
+    int _minMhz;
+    int _maxMhz;
+
+    int _holders;                   ///< 所有 PowerLock 的持有总数
+    bool _sleeping;
+    Residency _slots[RESIDENCY_SLOTS];
+    uint8_t _slotCount;
+    uint8_t _current;               ///< 当前状态所在的项
+    int64_t _since;                 ///< 0表示还没开始统计
+};
+
+#endif // POWER_MANAGER_H
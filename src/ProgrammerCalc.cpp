@@ -0,0 +1,353 @@
+/**
+ * @file ProgrammerCalc.cpp
+ * @brief 程序员模式整数引擎实现
+ *
+ * @author Calculator Project
+ */
+
+#include "ProgrammerCalc.h"
+#include "NumberFormatter.h"
+#include "UiText.h"
+#include <string.h>
+
+namespace {
+
+// 各行格式化缓冲：64位二进制加前缀
+const size_t LINE_BUFFER_SIZE = 72;
+
+const char* baseName(uint8_t base) {
+    switch (base) {
+        case 16: return "HEX";
+        case 8:  return "OCT";
+        case 2:  return "BIN";
+        default: return "DEC";
+    }
+}
+
+} // namespace
+
+ProgrammerCalc::ProgrammerCalc()
+    : _base(10),
+      _bits(64),
+      _signed(true) {
+    clearAll();
+}
+
+void ProgrammerCalc::clearAll() {
+    _state = State::INPUT;
+    _error = CalculatorError::NONE;
+    _value = 0;
+    _stack.valueCount = 0;
+    _stack.opCount = 0;
+    _beforeOp = _stack;
+    _expression.clear();
+    _beforeOpLength = 0;
+}
+
+void ProgrammerCalc::handleKey(const KeyConfig* keyConfig) {
+    if (_state == State::ERROR) {
+        clearAll();
+    }
+
+    switch (keyConfig->type) {
+        case KeyType::NUMBER: {
+            char c = keyConfig->symbol[0];
+            handleDigit(c <= '9' ? c - '0' : c - 'A' + 10);
+            break;
+        }
+        case KeyType::OPERATOR:
+            handleOperator(keyConfig->operation);
+            break;
+        case KeyType::FUNCTION:
+            if (keyConfig->operation == Operator::EQUALS) {
+                handleEquals();
+            } else if (keyConfig->operation == Operator::BIT_NOT) {
+                handleUnary(Operator::BIT_NOT);
+            } else if (strcmp(keyConfig->functionName, "sign") == 0) {
+                handleUnary(Operator::SUBTRACT);
+            }
+            break;
+        case KeyType::CLEAR:
+            clearAll();
+            break;
+        case KeyType::DELETE:
+            handleBackspace();
+            break;
+        default:
+            // 小数点、内存、科学函数等在整数模式下没有意义
+            break;
+    }
+}
+
+void ProgrammerCalc::nextBase() {
+    switch (_base) {
+        case 10: _base = 16; break;
+        case 16: _base = 8; break;
+        case 8:  _base = 2; break;
+        default: _base = 10; break;
+    }
+}
+
+void ProgrammerCalc::nextWordSize() {
+    _bits = _bits > 8 ? _bits / 2 : 64;
+    uint64_t m = mask();
+    _value &= m;
+    for (uint8_t i = 0; i < _stack.valueCount; i++) _stack.values[i] &= m;
+    for (uint8_t i = 0; i < _beforeOp.valueCount; i++) _beforeOp.values[i] &= m;
+}
+
+int64_t ProgrammerCalc::toSigned(uint64_t value) const {
+    if (_bits >= 64) return (int64_t)value;
+    uint64_t sign = 1ULL << (_bits - 1);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+uint8_t ProgrammerCalc::precedence(Operator op) {
+    switch (op) {
+        case Operator::MULTIPLY:
+        case Operator::DIVIDE:
+        case Operator::MODULO:
+            return 6;
+        case Operator::ADD:
+        case Operator::SUBTRACT:
+            return 5;
+        case Operator::SHIFT_LEFT:
+        case Operator::SHIFT_RIGHT:
+            return 4;
+        case Operator::BIT_AND:
+            return 3;
+        case Operator::BIT_XOR:
+            return 2;
+        case Operator::BIT_OR:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+const char* ProgrammerCalc::symbolOf(Operator op) {
+    switch (op) {
+        case Operator::ADD:         return "+";
+        case Operator::SUBTRACT:    return "-";
+        case Operator::MULTIPLY:    return "*";
+        case Operator::DIVIDE:      return "/";
+        case Operator::MODULO:      return "%";
+        case Operator::BIT_AND:     return "&";
+        case Operator::BIT_OR:      return "|";
+        case Operator::BIT_XOR:     return "^";
+        case Operator::SHIFT_LEFT:  return "<<";
+        case Operator::SHIFT_RIGHT: return ">>";
+        default:                    return "?";
+    }
+}
+
+CalculatorError ProgrammerCalc::apply(Operator op, uint64_t a, uint64_t b, uint64_t& out) const {
+    switch (op) {
+        case Operator::ADD:         out = a + b; break;
+        case Operator::SUBTRACT:    out = a - b; break;
+        case Operator::MULTIPLY:    out = a * b; break;
+        case Operator::BIT_AND:     out = a & b; break;
+        case Operator::BIT_OR:      out = a | b; break;
+        case Operator::BIT_XOR:     out = a ^ b; break;
+        case Operator::DIVIDE:
+        case Operator::MODULO: {
+            if (b == 0) return CalculatorError::DIVISION_BY_ZERO;
+            bool divide = op == Operator::DIVIDE;
+            if (!_signed) {
+                out = divide ? a / b : a % b;
+            } else if (toSigned(b) == -1) {
+                // 最小负数除以-1在C中未定义，按补码回绕
+                out = divide ? 0 - a : 0;
+            } else {
+                int64_t sa = toSigned(a), sb = toSigned(b);
+                out = (uint64_t)(divide ? sa / sb : sa % sb);
+            }
+            break;
+        }
+        case Operator::SHIFT_LEFT:
+            out = b >= _bits ? 0 : a << b;
+            break;
+        case Operator::SHIFT_RIGHT:
+            if (_signed) {
+                // 符号扩展到64位后算术右移，移出字长时全为符号位
+                out = (uint64_t)(toSigned(a) >> (b >= _bits ? 63 : b));
+            } else {
+                out = b >= _bits ? 0 : a >> b;
+            }
+            break;
+        default:
+            return CalculatorError::INVALID_OPERATION;
+    }
+    out &= mask();
+    return CalculatorError::NONE;
+}
+
+void ProgrammerCalc::handleDigit(uint8_t digit) {
+    if (digit >= _base) return;
+
+    if (_state == State::RESULT) {
+        clearAll();
+    } else if (_state == State::OPERATOR) {
+        _value = 0;
+        _state = State::INPUT;
+    }
+
+    // 有符号十进制按绝对值追加，上限为该字长的最大正数（负数多1）
+    bool negative = _signed && _base == 10 && toSigned(_value) < 0;
+    uint64_t magnitude = negative ? (0 - _value) & mask() : _value;
+    uint64_t limit = _signed && _base == 10 ? (mask() >> 1) + negative : mask();
+    if (magnitude > (limit - digit) / _base) {
+        return;     // 超出字长，忽略
+    }
+    magnitude = magnitude * _base + digit;
+    _value = (negative ? 0 - magnitude : magnitude) & mask();
+}
+
+void ProgrammerCalc::handleBackspace() {
+    if (_state != State::INPUT) return;
+    bool negative = _signed && _base == 10 && toSigned(_value) < 0;
+    uint64_t magnitude = (negative ? (0 - _value) & mask() : _value) / _base;
+    _value = (negative ? 0 - magnitude : magnitude) & mask();
+}
+
+void ProgrammerCalc::handleOperator(Operator op) {
+    if (_state == State::OPERATOR && _stack.opCount > 0) {
+        // 连续输入运算符时只更换最后一个，已按它归约的部分一并撤回
+        _stack = _beforeOp;
+        _expression.truncate(_beforeOpLength);
+    } else {
+        if (_state == State::RESULT) {
+            // 以结果开始新的表达式
+            _stack.valueCount = 0;
+            _stack.opCount = 0;
+            _expression.clear();
+        }
+        _stack.values[_stack.valueCount++] = _value;
+        appendValue(_value);
+        _beforeOp = _stack;
+        _beforeOpLength = _expression.length();
+    }
+
+    if (!reduce(precedence(op))) return;
+    _stack.ops[_stack.opCount++] = op;
+    appendText(symbolOf(op));
+    _beforeOpLength = _expression.length() - strlen(symbolOf(op));
+
+    _state = State::OPERATOR;
+    _value = 0;
+}
+
+void ProgrammerCalc::handleEquals() {
+    if (_state == State::RESULT || _stack.opCount == 0) return;
+
+    _stack.values[_stack.valueCount++] = _value;
+    appendValue(_value);
+    if (!reduce(0)) return;
+
+    _value = _stack.values[0];
+    _stack.valueCount = 0;
+    _stack.opCount = 0;
+    appendText("=");
+    appendValue(_value);
+    _state = State::RESULT;
+    CALC_LOG_D("程序员模式结果: %s", _expression.c_str());
+}
+
+void ProgrammerCalc::handleUnary(Operator op) {
+    if (_state == State::RESULT) {
+        // 作用于上一次的结果，之后开始新计算
+        _expression.clear();
+    }
+    _value = (op == Operator::BIT_NOT ? ~_value : 0 - _value) & mask();
+    _state = State::INPUT;
+}
+
+bool ProgrammerCalc::reduce(uint8_t minPrecedence) {
+    while (_stack.opCount > 0 && precedence(_stack.ops[_stack.opCount - 1]) >= minPrecedence) {
+        Operator op = _stack.ops[--_stack.opCount];
+        uint64_t b = _stack.values[--_stack.valueCount];
+        uint64_t& a = _stack.values[_stack.valueCount - 1];
+        CalculatorError error = apply(op, a, b, a);
+        if (error != CalculatorError::NONE) {
+            setError(error);
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProgrammerCalc::setError(CalculatorError error) {
+    _error = error;
+    _state = State::ERROR;
+    _stack.valueCount = 0;
+    _stack.opCount = 0;
+    _expression.clear();
+}
+
+void ProgrammerCalc::appendValue(uint64_t value) {
+    char buf[LINE_BUFFER_SIZE];
+    format(value, _base, buf, sizeof(buf));
+    appendText(buf);
+}
+
+void ProgrammerCalc::appendText(const char* text) {
+    size_t length = strlen(text);
+    if (_expression.length() + length > _expression.capacity()) {
+        // 放不下时只保留末尾：表达式行宽有限，前面的部分本来也看不到
+        size_t keep = (_expression.capacity() - 3 - length) / 2;
+        if (keep > _expression.length()) keep = _expression.length();
+        FixedString<EXPRESSION_CAPACITY> tail("...");
+        tail += _expression.c_str() + _expression.length() - keep;
+        _expression = tail.c_str();
+    }
+    _expression += text;
+}
+
+size_t ProgrammerCalc::format(uint64_t value, uint8_t base, char* buf, size_t size) const {
+    if (base == 10 && _signed && toSigned(value) < 0) {
+        if (size < 2) return 0;
+        buf[0] = '-';
+        return 1 + NumberFormatter::formatInteger(0 - (uint64_t)toSigned(value), 10, buf + 1, size - 1);
+    }
+    return NumberFormatter::formatInteger(value, base, buf, size);
+}
+
+void ProgrammerCalc::render(DisplayModel& model) const {
+    char line[LINE_BUFFER_SIZE];
+
+    // 另外两种进制：十进制或十六进制在上，二进制（当前为二进制时为十进制）在下
+    uint8_t upper = _base == 16 ? 10 : 16;
+    uint8_t lower = _base == 2 ? 10 : 2;
+    memcpy(line, baseName(upper), 3);
+    line[3] = ' ';
+    format(_value, upper, line + 4, sizeof(line) - 4);
+    model.setText(DisplayModel::LINE_OLDER, line);
+    memcpy(line, baseName(lower), 3);
+    line[3] = ' ';
+    format(_value, lower, line + 4, sizeof(line) - 4);
+    model.setText(DisplayModel::LINE_LATEST, line);
+    model.setText(DisplayModel::LINE_EXPR, _expression.c_str());
+
+    char indicator[DisplayModel::INDICATOR_LEN];
+    memcpy(indicator, baseName(_base), 3);
+    NumberFormatter::formatInteger(_bits, 10, indicator + 3, 3);
+    if (!_signed) strcat(indicator, "u");
+    model.setIndicator(indicator);
+    model.historyCursor = 0;
+    model.historyCount = 0;
+
+    switch (_state) {
+        case State::INPUT:    model.state = DisplayModel::STATE_INPUT; break;
+        case State::OPERATOR: model.state = DisplayModel::STATE_OPERATOR; break;
+        case State::RESULT:   model.state = DisplayModel::STATE_RESULT; break;
+        case State::ERROR:    model.state = DisplayModel::STATE_ERROR; break;
+    }
+
+    if (_state == State::ERROR) {
+        model.setText(DisplayModel::LINE_RESULT, _error == CalculatorError::DIVISION_BY_ZERO ?
+                      UI_TEXT("错误: 除数为零") : UI_TEXT("错误: 无效操作"));
+    } else {
+        format(_value, _base, line, sizeof(line));
+        model.setText(DisplayModel::LINE_RESULT, line);
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * @file ProgrammerCalc.h
+ * @brief 程序员模式的整数引擎
+ * @details 布局方案的programmer为true时，CalculatorCore把按键交给这里，完全不经过double：
+ * - 数值按字长（8/16/32/64位）保存为补码位型，每次运算后按字长截断（回绕，不报溢出）
+ * - 有符号时除法、取余、右移按符号扩展后的值计算，十进制按有符号显示；
+ *   16/8/2进制总是显示位型
+ * - 运算符按C的优先级：乘除取余 > 加减 > 移位 > 与 > 异或 > 或，同级从左到右；
+ *   每输入一个运算符即归约栈顶，栈深不超过优先级层数
+ * - 数字用NumberFormatter::formatInteger()查表写出，不拼接String
+ * 结果行为当前进制，上面两行同时显示另外两种进制（HEX/DEC和BIN），指示文本为进制和字长。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef PROGRAMMER_CALC_H
+#define PROGRAMMER_CALC_H
+
+#include <stdint.h>
+#include "CalculatorCore.h"
+#include "KeyboardConfig.h"
+#include "FixedString.h"
+#include "DisplayModel.h"
+
+class ProgrammerCalc {
+public:
+    static const uint8_t STACK_DEPTH = 8;           ///< 优先级层数 + 1
+
+    ProgrammerCalc();
+
+    /**
+     * @brief 处理程序员模式布局中的一个按键
+     */
+    void handleKey(const KeyConfig* keyConfig);
+
+    /**
+     * @brief 填写显示模型（结果行、另外两种进制、表达式和指示）
+     */
+    void render(DisplayModel& model) const;
+
+    void clearAll();
+
+    /**
+     * @brief 依次切换进制：DEC → HEX → OCT → BIN
+     */
+    void nextBase();
+
+    /**
+     * @brief 依次切换字长：64 → 32 → 16 → 8，已有的值按新字长截断
+     */
+    void nextWordSize();
+
+    void toggleSigned() { _signed = !_signed; }
+
+    uint8_t getBase() const { return _base; }
+    uint8_t getWordBits() const { return _bits; }
+    bool isSigned() const { return _signed; }
+    uint64_t getValue() const { return _value; }
+    CalculatorError getError() const { return _error; }
+
+    /**
+     * @brief 二元运算（按当前字长和有无符号）
+     * @return 除数为0时返回DIVISION_BY_ZERO，其余运算回绕不报错
+     */
+    CalculatorError apply(Operator op, uint64_t a, uint64_t b, uint64_t& out) const;
+
+private:
+    enum class State : uint8_t {
+        INPUT,          ///< 正在输入数字
+        OPERATOR,       ///< 刚输入运算符，等待操作数
+        RESULT,         ///< 显示结果
+        ERROR           ///< 显示错误
+    };
+
+    // 操作数栈和运算符栈，运算符总比操作数少一个（或相等，等待下一个操作数时）
+    struct Stack {
+        uint64_t values[STACK_DEPTH];
+        Operator ops[STACK_DEPTH];
+        uint8_t valueCount;
+        uint8_t opCount;
+    };
+
+    static const size_t EXPRESSION_CAPACITY = 128;
+
+    static uint8_t precedence(Operator op);
+    static const char* symbolOf(Operator op);
+
+    uint64_t mask() const { return _bits >= 64 ? ~0ULL : (1ULL << _bits) - 1; }
+    int64_t toSigned(uint64_t value) const;
+
+    void handleDigit(uint8_t digit);
+    void handleOperator(Operator op);
+    void handleEquals();
+    void handleUnary(Operator op);
+    void handleBackspace();
+
+    /**
+     * @brief 合并栈顶优先级不低于minPrecedence的运算
+     */
+    bool reduce(uint8_t minPrecedence);
+    void setError(CalculatorError error);
+    void appendValue(uint64_t value);
+    void appendText(const char* text);
+
+    /**
+     * @brief 按进制格式化（十进制有符号时带负号）
+     * @return 写入的字符数
+     */
+    size_t format(uint64_t value, uint8_t base, char* buf, size_t size) const;
+
+    uint8_t _base;                  ///< 2、8、10、16
+    uint8_t _bits;                  ///< 字长
+    bool _signed;
+    State _state;
+    CalculatorError _error;
+    uint64_t _value;                ///< 输入中的数或结果（已按字长截断）
+    Stack _stack;
+    Stack _beforeOp;                ///< 最后一个运算符入栈前的栈，连续输入运算符时从这里替换
+    FixedString<EXPRESSION_CAPACITY> _expression;
+    size_t _beforeOpLength;         ///< 最后一个运算符之前的表达式文本长度
+};
+
+#endif // PROGRAMMER_CALC_H
@@ -0,0 +1,646 @@
+/**
+ * @file RegionCanvas.cpp
+ * @brief 支持局部推送的离屏Canvas实现
+ *
+ * @author Calculator Project
+ */
+
+#include "RegionCanvas.h"
+#include "config.h"
+#include <esp_heap_caps.h>
+#include <soc/soc_memory_layout.h>
+#include <esp_timer.h>
+#include "Logger.h"
+#include "LatencyProbe.h"
+#include "CpuProfiler.h"
+
+#define TAG_CANVAS "Canvas"
+
+// 宽度超过此比例时直接扩展为整行条带：一次连续DMA比逐行写更快
+#define REGION_FULL_ROW_RATIO_NUM 3
+#define REGION_FULL_ROW_RATIO_DEN 4
+
+// 推送任务：与Arduino loop（核心1）分开，放在核心0
+#define REGION_FLUSH_TASK_STACK 4096
+#define REGION_FLUSH_TASK_PRIO  2
+#define REGION_FLUSH_TASK_CORE  0
+
+// 调色板模式：每字节4个像素，行首按字节对齐
+#define PACKED_STRIDE(w) (((w) + 3) / 4)
+
+static_assert(DISPLAY_TILE_W % 4 == 0, "块宽必须是4的倍数（调色板模式下块按字节对齐）");
+
+// 块哈希：FNV-1a，按32位字累加
+static inline uint32_t tileHashBytes(uint32_t hash, const uint8_t *p, size_t n) {
+    for (; n >= 4; n -= 4, p += 4) {
+        uint32_t word;
+        memcpy(&word, p, 4);
+        hash = (hash ^ word) * 16777619u;
+    }
+    for (; n; n--) hash = (hash ^ *p++) * 16777619u;
+    return hash;
+}
+
+RegionCanvas::RegionCanvas(int16_t w, int16_t h, Arduino_TFT *panel, Arduino_DataBus *bus)
+    : Arduino_Canvas(w, h, panel),
+      _panel(panel),
+      _bus(bus),
+      _flushedBytes(0),
+      _flushDoneCb(nullptr),
+      _flushDoneCtx(nullptr),
+      _regionsCb(nullptr),
+      _regionsCtx(nullptr),
+      _placedFramebuffer(false),
+      _paletteCount(0),
+      _lastColor(0),
+      _lastIndex(0),
+      _packed(nullptr),
+      _expandLut(nullptr),
+      _lineBuffer(nullptr),
+      _tePin(-1),
+      _teSync(false),
+      _teCount(0),
+      _teMisses(0),
+      _teFlushSem(nullptr),
+      _teFrameSem(nullptr),
+      _panelAsleep(false),
+      _panelWakeMs(0),
+      _backBuffer(nullptr),
+      _frontBuffer(nullptr),
+      _flushTask(nullptr),
+      _flushBusy(false),
+      _tileHash(nullptr),
+      _tilesX(0),
+      _tilesY(0),
+      _tileHashValid(false) {
+}
+
+RegionCanvas::~RegionCanvas() {
+    if (_flushTask) {
+        waitFlush();
+        vTaskDelete(_flushTask);
+        _flushTask = nullptr;
+    }
+    if (_tePin >= 0) {
+        detachInterrupt(digitalPinToInterrupt(_tePin));
+        _tePin = -1;
+        _teSync = false;
+    }
+    if (_teFlushSem) vSemaphoreDelete(_teFlushSem);
+    if (_teFrameSem) vSemaphoreDelete(_teFrameSem);
+    if (_backBuffer) {
+        placedFree(_backBuffer);
+        _backBuffer = nullptr;
+    }
+    placedFree(_packed);
+    placedFree(_expandLut);
+    placedFree(_lineBuffer);
+    placedFree(_tileHash);
+    _packed = nullptr;
+    _tileHash = nullptr;
+    if (_framebuffer) {
+        // 双缓冲交换后两块缓冲的来源不再固定，都由这里释放（heap_caps_free也能释放malloc的内存）；
+        // 基类析构时_framebuffer为空，不会再释放
+        placedFree(_framebuffer);
+        _framebuffer = nullptr;
+    }
+}
+
+void RegionCanvas::setPalette(const uint16_t *colors, uint8_t count) {
+    if (count > 4) count = 4;
+    if (_packed) {
+        // 已分配的缓冲保存的是索引：只替换颜色，颜色数量不变，下次推送即为新颜色
+        if (count != _paletteCount) return;
+        waitFlush();
+    }
+    _paletteCount = count;
+    if (!count) return;
+    for (uint8_t i = 0; i < 4; i++) _palette[i] = colors[i < count ? i : 0];
+    _lastColor = _palette[0];
+    _lastIndex = 0;
+    if (_packed) buildExpandLut();
+}
+
+bool RegionCanvas::begin(int32_t speed) {
+    if (_paletteCount && !_packed && !_framebuffer) {
+        if (speed != GFX_SKIP_OUTPUT_BEGIN && !_output->begin(speed)) return false;
+        if (beginPacked()) return true;
+        // 内存不足时回退到16位帧缓冲
+        _paletteCount = 0;
+        speed = GFX_SKIP_OUTPUT_BEGIN;
+    }
+    if (_packed) return true;
+    if (!Arduino_Canvas::begin(speed)) return false;
+    if (_placedFramebuffer) return true;
+
+    bool external = esp_ptr_external_ram(_framebuffer);
+    bool wantExternal = DISPLAY_FRAMEBUFFER_PLACE == PLACE_PSRAM || DISPLAY_FRAMEBUFFER_PLACE == PLACE_PSRAM_ONLY;
+    if (external == wantExternal && DISPLAY_FRAMEBUFFER_PLACE != PLACE_DMA) return true;
+
+    size_t bytes = (size_t)WIDTH * HEIGHT * 2;
+    uint16_t *placed = (uint16_t *)placedAlloc("canvas", bytes, DISPLAY_FRAMEBUFFER_PLACE);
+    if (!placed) return true;   // 目标位置不足，保留基类分配的缓冲
+
+    memcpy(placed, _framebuffer, bytes);
+    free(_framebuffer);
+    _framebuffer = placed;
+    _placedFramebuffer = true;
+    return true;
+}
+
+void RegionCanvas::writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (_packed) {
+        fillPacked(x, y, w, h, paletteIndex(color));
+        return;
+    }
+    if (!_framebuffer || getRotation() != 0) {
+        Arduino_Canvas::writeFillRectPreclipped(x, y, w, h, color);
+        return;
+    }
+    pixelFillRect(_framebuffer, WIDTH, x, y, w, h, color);
+}
+
+bool RegionCanvas::beginPacked() {
+    size_t packedBytes = (size_t)PACKED_STRIDE(WIDTH) * HEIGHT;
+    _packed = (uint8_t *)placedAlloc("canvas_2bpp", packedBytes, PLACE_INTERNAL);
+    _expandLut = (uint16_t *)placedAlloc("canvas_lut", 256 * 4 * 2, PLACE_INTERNAL);
+    _lineBuffer = (uint16_t *)placedAlloc("canvas_lines", (size_t)WIDTH * DISPLAY_PALETTE_FLUSH_ROWS * 2,
+                                          PLACE_INTERNAL);
+    if (!_packed || !_expandLut || !_lineBuffer) {
+        placedFree(_packed);
+        placedFree(_expandLut);
+        placedFree(_lineBuffer);
+        _packed = nullptr;
+        _expandLut = nullptr;
+        _lineBuffer = nullptr;
+        return false;
+    }
+
+    buildExpandLut();
+    memset(_packed, 0, packedBytes);
+    return true;
+}
+
+void RegionCanvas::buildExpandLut() {
+    // 查找表：字节的第k个2位字段对应第k个像素
+    for (uint16_t b = 0; b < 256; b++) {
+        for (uint8_t k = 0; k < 4; k++) {
+            _expandLut[b * 4 + k] = _palette[(b >> (k * 2)) & 3];
+        }
+    }
+}
+
+size_t RegionCanvas::getBufferBytes() const {
+    if (_packed) return (size_t)PACKED_STRIDE(WIDTH) * HEIGHT;
+    size_t bytes = (size_t)WIDTH * HEIGHT * 2;
+    return _backBuffer ? bytes * 2 : bytes;
+}
+
+uint8_t RegionCanvas::paletteIndex(uint16_t color) {
+    if (color == _lastColor) return _lastIndex;
+
+    // 精确匹配优先，否则取RGB各分量平方距离最小的颜色
+    uint8_t best = 0;
+    uint32_t bestDist = UINT32_MAX;
+    for (uint8_t i = 0; i < _paletteCount; i++) {
+        uint16_t p = _palette[i];
+        int32_t dr = (int32_t)(color >> 11) - (p >> 11);
+        int32_t dg = (int32_t)((color >> 5) & 0x3F) - ((p >> 5) & 0x3F);
+        int32_t db = (int32_t)(color & 0x1F) - (p & 0x1F);
+        uint32_t dist = (uint32_t)(dr * dr * 4 + dg * dg + db * db * 4);
+        if (dist < bestDist) {
+            bestDist = dist;
+            best = i;
+        }
+        if (dist == 0) break;
+    }
+    _lastColor = color;
+    _lastIndex = best;
+    return best;
+}
+
+void RegionCanvas::fillPacked(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index) {
+    const int16_t stride = PACKED_STRIDE(WIDTH);
+    const uint8_t fill = index * 0x55;
+    uint8_t *row = _packed + (int32_t)y * stride;
+
+    if (x == 0 && w == WIDTH && (WIDTH & 3) == 0) {
+        memset(row, fill, (size_t)stride * h);
+        return;
+    }
+
+    for (int16_t r = 0; r < h; r++, row += stride) {
+        int16_t px = x;
+        int16_t left = w;
+        // 首尾不满一个字节的像素逐个改写2位，中间整字节memset
+        for (; left > 0 && (px & 3); px++, left--) {
+            uint8_t shift = (px & 3) * 2;
+            row[px >> 2] = (row[px >> 2] & ~(3 << shift)) | (index << shift);
+        }
+        memset(row + (px >> 2), fill, left >> 2);
+        px += left & ~3;
+        for (left &= 3; left > 0; px++, left--) {
+            uint8_t shift = (px & 3) * 2;
+            row[px >> 2] = (row[px >> 2] & ~(3 << shift)) | (index << shift);
+        }
+    }
+}
+
+void RegionCanvas::writePixelPreclipped(int16_t x, int16_t y, uint16_t color) {
+    if (!_packed) {
+        if (_framebuffer && getRotation() == 0) {
+            // 未旋转时直接写入，不经过Arduino_Canvas按旋转方向的分支
+            _framebuffer[(int32_t)y * WIDTH + x] = color;
+            return;
+        }
+        Arduino_Canvas::writePixelPreclipped(x, y, color);
+        return;
+    }
+    uint8_t *p = _packed + (int32_t)y * PACKED_STRIDE(WIDTH) + (x >> 2);
+    uint8_t shift = (x & 3) * 2;
+    *p = (*p & ~(3 << shift)) | (paletteIndex(color) << shift);
+}
+
+void RegionCanvas::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    if (!_packed) {
+        Arduino_Canvas::writeFastVLine(x, y, h, color);
+        return;
+    }
+    writeFillRect(x, y, 1, h, color);
+}
+
+void RegionCanvas::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    if (!_packed) {
+        Arduino_Canvas::writeFastHLine(x, y, w, color);
+        return;
+    }
+    writeFillRect(x, y, w, 1, color);
+}
+
+void RegionCanvas::draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) {
+    if (!_packed) {
+        Arduino_Canvas::draw16bitRGBBitmap(x, y, bitmap, w, h);
+        return;
+    }
+    for (int16_t j = 0; j < h; j++) {
+        for (int16_t i = 0; i < w; i++) {
+            writePixel(x + i, y + j, bitmap[(int32_t)j * w + i]);
+        }
+    }
+}
+
+bool RegionCanvas::beginTearSync(int8_t pin) {
+    if (pin < 0 || _tePin >= 0) return _teSync;
+
+    if (!_teFlushSem) _teFlushSem = xSemaphoreCreateBinary();
+    if (!_teFrameSem) _teFrameSem = xSemaphoreCreateBinary();
+    if (!_teFlushSem || !_teFrameSem) return false;
+
+    _tePin = pin;
+    pinMode(pin, INPUT);
+    attachInterruptArg(digitalPinToInterrupt(pin), tearIsr, this, RISING);
+
+    // 确认TE确实在跳变（未接线或面板未打开TE输出时不启用）
+    if (!waitTearEffect(DISPLAY_TE_TIMEOUT_MS)) {
+        detachInterrupt(digitalPinToInterrupt(pin));
+        _tePin = -1;
+        LOG_W(TAG_CANVAS, "GPIO%d 上没有TE信号，不启用TE同步", pin);
+        return false;
+    }
+    _teMisses = 0;
+    _teSync = true;
+    LOG_I(TAG_CANVAS, "TE同步已启用: GPIO%d", pin);
+    return true;
+}
+
+void IRAM_ATTR RegionCanvas::tearIsr(void *arg) {
+    RegionCanvas *self = static_cast<RegionCanvas *>(arg);
+    self->_teCount++;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->_teFlushSem, &woken);
+    xSemaphoreGiveFromISR(self->_teFrameSem, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+bool RegionCanvas::waitTearEffect(uint32_t timeoutMs) {
+    if (_tePin < 0 || !_teFrameSem) return false;
+    // 丢掉已经过去的TE，只等下一个
+    xSemaphoreTake(_teFrameSem, 0);
+    return xSemaphoreTake(_teFrameSem, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+
+void RegionCanvas::waitFlushSlot() {
+    if (!_teSync) return;
+
+    xSemaphoreTake(_teFlushSem, 0);
+    if (xSemaphoreTake(_teFlushSem, pdMS_TO_TICKS(DISPLAY_TE_TIMEOUT_MS)) == pdTRUE) {
+        _teMisses = 0;
+        return;
+    }
+    if (++_teMisses >= DISPLAY_TE_MAX_MISSES) {
+        _teSync = false;
+        LOG_W(TAG_CANVAS, "连续%u次等不到TE，关闭TE同步", _teMisses);
+    }
+}
+
+bool RegionCanvas::beginDoubleBuffer() {
+    if (!_framebuffer || _flushTask) return _flushTask != nullptr;
+
+    size_t bytes = (size_t)WIDTH * HEIGHT * 2;
+
+    _backBuffer = (uint16_t *)placedAlloc("canvas_back", bytes, DISPLAY_FRAMEBUFFER_PLACE);
+    if (!_backBuffer) return false;
+
+    memcpy(_backBuffer, _framebuffer, bytes);
+
+    _flushLock.begin("canvasFlush");
+    if (xTaskCreatePinnedToCore(flushTaskEntry, "canvasFlush", REGION_FLUSH_TASK_STACK, this,
+                                REGION_FLUSH_TASK_PRIO, &_flushTask, REGION_FLUSH_TASK_CORE) != pdPASS) {
+        _flushTask = nullptr;
+        placedFree(_backBuffer);
+        _backBuffer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void RegionCanvas::flushRegion(int16_t x, int16_t y, int16_t w, int16_t h) {
+    DirtyRegions regions;
+    regions.add(x, y, w, h);
+    flushRegions(regions);
+}
+
+void RegionCanvas::flushRegions(const DirtyRegions &regions) {
+    if ((!_framebuffer && !_packed) || _panelAsleep) return;
+
+    // 裁剪到Canvas范围，较宽的区域扩展为整行；扩展后相接的条带重新合并
+    DirtyRegions batch;
+    for (uint8_t i = 0; i < regions.count(); i++) {
+        int16_t x = regions[i].x, y = regions[i].y, w = regions[i].w, h = regions[i].h;
+        if (x < 0) { w += x; x = 0; }
+        if (y < 0) { h += y; y = 0; }
+        if (x + w > WIDTH) w = WIDTH - x;
+        if (y + h > HEIGHT) h = HEIGHT - y;
+        if (w <= 0 || h <= 0) continue;
+        if (w * REGION_FULL_ROW_RATIO_DEN >= WIDTH * REGION_FULL_ROW_RATIO_NUM) {
+            x = 0;
+            w = WIDTH;
+        }
+        batch.add(x, y, w, h);
+    }
+    if (batch.empty()) return;
+    if (_regionsCb) _regionsCb(batch, _regionsCtx);
+
+    if (_packed) {
+        transferPacked(batch);
+        return;
+    }
+
+    if (!_flushTask) {
+        transferRegions(_framebuffer, batch);
+        return;
+    }
+
+    // 双缓冲：等上一帧发送完，交换缓冲后交给推送任务
+    waitFlush();
+
+    uint16_t *drawn = _framebuffer;
+    _framebuffer = _backBuffer;
+    _backBuffer = drawn;
+    _frontBuffer = drawn;
+
+    // 两块缓冲只在本批区域内不同，复制这些行即可恢复一致
+    for (uint8_t i = 0; i < batch.count(); i++) {
+        size_t offset = (size_t)batch[i].y * WIDTH;
+        pixelCopy(_framebuffer + offset, drawn + offset, (size_t)batch[i].h * WIDTH);
+    }
+
+    _pendRegions = batch;
+    _flushBusy = true;
+    xTaskNotifyGive(_flushTask);
+}
+
+bool RegionCanvas::beginTileHash() {
+    if (_tileHash) return true;
+    if (!_framebuffer && !_packed) return false;
+
+    _tilesX = (WIDTH + DISPLAY_TILE_W - 1) / DISPLAY_TILE_W;
+    _tilesY = (HEIGHT + DISPLAY_TILE_H - 1) / DISPLAY_TILE_H;
+    _tileHash = (uint32_t *)placedAlloc("canvas_tiles", (size_t)_tilesX * _tilesY * sizeof(uint32_t), PLACE_INTERNAL);
+    _tileHashValid = false;
+    return _tileHash != nullptr;
+}
+
+uint32_t RegionCanvas::hashTile(int16_t tx, int16_t ty) const {
+    int16_t x = tx * DISPLAY_TILE_W;
+    int16_t y = ty * DISPLAY_TILE_H;
+    int16_t w = WIDTH - x < DISPLAY_TILE_W ? WIDTH - x : DISPLAY_TILE_W;
+    int16_t h = HEIGHT - y < DISPLAY_TILE_H ? HEIGHT - y : DISPLAY_TILE_H;
+    uint32_t hash = 2166136261u;
+
+    if (_packed) {
+        // 块的左边界按字节对齐；最右一块不足一字节的像素连同行尾的填充位一起算
+        const int16_t stride = PACKED_STRIDE(WIDTH);
+        const uint8_t *row = _packed + (int32_t)y * stride + x / 4;
+        for (int16_t r = 0; r < h; r++, row += stride) {
+            hash = tileHashBytes(hash, row, PACKED_STRIDE(w));
+        }
+        return hash;
+    }
+
+    const uint16_t *row = _framebuffer + (int32_t)y * WIDTH + x;
+    for (int16_t r = 0; r < h; r++, row += WIDTH) {
+        hash = tileHashBytes(hash, (const uint8_t *)row, (size_t)w * 2);
+    }
+    return hash;
+}
+
+uint16_t RegionCanvas::flushChanged() {
+    if (!_tileHash || _panelAsleep) return 0;
+
+    // 每个块行中相邻的变化块合并为一段，段的宽高由flushRegions()裁剪到Canvas范围
+    DirtyRegions regions;
+    uint16_t changed = 0;
+    for (uint8_t ty = 0; ty < _tilesY; ty++) {
+        uint32_t *hashes = _tileHash + ty * _tilesX;
+        int16_t runStart = -1;
+        for (uint8_t tx = 0; tx <= _tilesX; tx++) {
+            bool dirty = false;
+            if (tx < _tilesX) {
+                uint32_t hash = hashTile(tx, ty);
+                dirty = !_tileHashValid || hash != hashes[tx];
+                hashes[tx] = hash;
+            }
+            if (dirty) {
+                changed++;
+                if (runStart < 0) runStart = tx;
+            } else if (runStart >= 0) {
+                regions.add(runStart * DISPLAY_TILE_W, ty * DISPLAY_TILE_H,
+                            (tx - runStart) * DISPLAY_TILE_W, DISPLAY_TILE_H);
+                runStart = -1;
+            }
+        }
+    }
+    _tileHashValid = true;
+
+    if (!regions.empty()) flushRegions(regions);
+    return changed;
+}
+
+void RegionCanvas::flush(void) {
+    if (_panelAsleep) return;
+    if (_flushTask || _packed) {
+        flushRegion(0, 0, WIDTH, HEIGHT);
+        return;
+    }
+    if (_regionsCb) {
+        DirtyRegions all;
+        all.add(0, 0, WIDTH, HEIGHT);
+        _regionsCb(all, _regionsCtx);
+    }
+    waitFlushSlot();
+    PROFILE_SCOPE(PROFILE_DISPLAY_FLUSH);
+    int64_t start = esp_timer_get_time();
+    LATENCY_MARK(LATENCY_POINT_FLUSH_START);
+    Arduino_Canvas::flush();
+    LATENCY_MARK(LATENCY_POINT_FLUSH_END);
+    _flushedBytes += (uint32_t)WIDTH * HEIGHT * 2;
+    if (_flushDoneCb) {
+        _flushDoneCb((uint32_t)(esp_timer_get_time() - start), _flushDoneCtx);
+    }
+}
+
+void RegionCanvas::readPixels(int16_t x, int16_t y, int16_t w, uint16_t *out) const {
+    if (_packed) {
+        const uint8_t *row = _packed + (int32_t)y * PACKED_STRIDE(WIDTH);
+        for (int16_t px = x; px < x + w; px++) {
+            *out++ = _palette[(row[px >> 2] >> ((px & 3) * 2)) & 3];
+        }
+        return;
+    }
+    if (_framebuffer) {
+        memcpy(out, _framebuffer + (int32_t)y * WIDTH + x, (size_t)w * 2);
+    } else {
+        memset(out, 0, (size_t)w * 2);
+    }
+}
+
+void RegionCanvas::setPanelSleep(bool sleep) {
+    if (sleep == _panelAsleep || !_bus) return;
+    waitFlush();
+
+    if (sleep) {
+        uint32_t sinceWake = millis() - _panelWakeMs;
+        if (_panelWakeMs && sinceWake < DISPLAY_SLPIN_GUARD_MS) {
+            delay(DISPLAY_SLPIN_GUARD_MS - sinceWake);
+        }
+        _bus->sendCommand(0x10);    // SLPIN
+        _panelAsleep = true;
+        LOG_I(TAG_CANVAS, "面板睡眠");
+        return;
+    }
+
+    _bus->sendCommand(0x11);        // SLPOUT
+    delay(DISPLAY_SLPOUT_DELAY_MS);
+    _panelWakeMs = millis();
+    _panelAsleep = false;
+    // 睡眠期间的绘制都在Canvas里，整帧推送一次
+    flush();
+    LOG_I(TAG_CANVAS, "面板唤醒");
+}
+
+void RegionCanvas::waitFlush() {
+    while (_flushBusy) {
+        vTaskDelay(1);
+    }
+}
+
+void RegionCanvas::flushTaskEntry(void *arg) {
+    RegionCanvas *self = static_cast<RegionCanvas *>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->_flushLock.acquire();
+        self->transferRegions(self->_frontBuffer, self->_pendRegions);
+        self->_flushLock.release();
+        self->_flushBusy = false;
+    }
+}
+
+void RegionCanvas::transferRegions(uint16_t *buf, const DirtyRegions &regions) {
+    waitFlushSlot();
+    PROFILE_SCOPE(PROFILE_DISPLAY_FLUSH);
+    int64_t start = esp_timer_get_time();
+    LATENCY_MARK(LATENCY_POINT_FLUSH_START);
+    uint32_t pixels = 0;
+
+    // 整批在一次总线事务中发送：TE等待、片选和推送完成回调每帧只有一次
+    _panel->startWrite();
+    for (uint8_t i = 0; i < regions.count(); i++) {
+        const DirtyRegions::Rect &r = regions[i];
+        uint16_t *src = buf + (int32_t)r.y * WIDTH + r.x;
+        _panel->writeAddrWindow(_output_x + r.x, _output_y + r.y, r.w, r.h);
+        if (r.w == WIDTH) {
+            // 整行条带在framebuffer中是连续的，一次交给DMA
+            _bus->writePixels(src, (uint32_t)r.w * r.h);
+        } else {
+            // 窄矩形：地址窗口内逐行写入
+            for (int16_t row = 0; row < r.h; row++) {
+                _bus->writePixels(src, r.w);
+                src += WIDTH;
+            }
+        }
+        pixels += (uint32_t)r.w * r.h;
+    }
+    _panel->endWrite();
+    LATENCY_MARK(LATENCY_POINT_FLUSH_END);
+
+    _flushedBytes += pixels * 2;
+    if (_flushDoneCb) {
+        _flushDoneCb((uint32_t)(esp_timer_get_time() - start), _flushDoneCtx);
+    }
+}
+
+void RegionCanvas::transferPacked(const DirtyRegions &regions) {
+    waitFlushSlot();
+    PROFILE_SCOPE(PROFILE_DISPLAY_FLUSH);
+    int64_t start = esp_timer_get_time();
+    LATENCY_MARK(LATENCY_POINT_FLUSH_START);
+    const int16_t stride = PACKED_STRIDE(WIDTH);
+    uint32_t pixels = 0;
+
+    _panel->startWrite();
+    for (uint8_t i = 0; i < regions.count(); i++) {
+        const int16_t x = regions[i].x, y = regions[i].y, w = regions[i].w, h = regions[i].h;
+        const uint8_t *row = _packed + (int32_t)y * stride;
+        _panel->writeAddrWindow(_output_x + x, _output_y + y, w, h);
+        for (int16_t done = 0; done < h; ) {
+            // 每批展开若干行到行缓冲，整批一次写入（地址窗口内像素连续）
+            int16_t rows = h - done;
+            if (rows > DISPLAY_PALETTE_FLUSH_ROWS) rows = DISPLAY_PALETTE_FLUSH_ROWS;
+            uint16_t *out = _lineBuffer;
+            for (int16_t r = 0; r < rows; r++, row += stride) {
+                int16_t px = x;
+                int16_t end = x + w;
+                for (; px < end && (px & 3); px++) {
+                    *out++ = _palette[(row[px >> 2] >> ((px & 3) * 2)) & 3];
+                }
+                for (; px + 4 <= end; px += 4, out += 4) {
+                    memcpy(out, _expandLut + row[px >> 2] * 4, 8);
+                }
+                for (; px < end; px++) {
+                    *out++ = _palette[(row[px >> 2] >> ((px & 3) * 2)) & 3];
+                }
+            }
+            _bus->writePixels(_lineBuffer, (uint32_t)w * rows);
+            done += rows;
+        }
+        pixels += (uint32_t)w * h;
+    }
+    _panel->endWrite();
+    LATENCY_MARK(LATENCY_POINT_FLUSH_END);
+
+    _flushedBytes += pixels * 2;
+    if (_flushDoneCb) {
+        _flushDoneCb((uint32_t)(esp_timer_get_time() - start), _flushDoneCtx);
+    }
+}
@@ -0,0 +1,299 @@
+/**
+ * @file RegionCanvas.h
+ * @brief 支持局部推送的离屏Canvas
+ * @details 在Arduino_Canvas基础上增加 flushRegion()：
+ * - 只为受影响的矩形设置一次地址窗口
+ * - 整行宽度的条带直接作为一段连续内存交给DMA
+ * - 窄矩形逐行写入同一个地址窗口，避免重复的窗口设置
+ *
+ * 可选的双缓冲模式（beginDoubleBuffer）：
+ * - 前台缓冲由后台推送任务通过SPI DMA发送
+ * - 绘制始终写入后台缓冲，推送提交时交换两块缓冲
+ * - 交换后只需把刚推送的行区间复制回新的后台缓冲，两块缓冲即保持一致
+ *
+ * 可选的调色板模式（begin()之前调用setPalette；之后再调用只替换颜色，用于切换主题）：
+ * - 界面只用少数几种颜色，每像素存2位调色板索引，480x135的缓冲从约127 KB降到约16 KB
+ * - 推送时逐行按查找表展开为RGB565，分批写入一块小的行缓冲再交给总线（总线自带内部DMA缓冲）
+ * - 不在调色板中的颜色映射到最接近的调色板颜色
+ * - 没有16位帧缓冲（getFramebuffer()返回nullptr），也不支持双缓冲
+ *
+ * 可选的TE同步（beginTearSync）：
+ * - 面板每帧进入垂直消隐时TE引脚输出上升沿，中断释放信号量
+ * - 每次推送都等到下一个上升沿才开始发送，写入GRAM与面板扫描不交错，画面不撕裂
+ * - 渲染侧可用waitTearEffect()按面板帧推进动画
+ *
+ * 可选的块哈希（beginTileHash）：
+ * - Canvas按DISPLAY_TILE_W x DISPLAY_TILE_H分块，flushChanged()对每块算一次32位哈希，
+ *   与上次推送时的哈希比较，只推送内容变化的块
+ * - 同一块行中相邻的变化块合并为一段，上下相接的段再由DirtyRegions合并成条带
+ * - 绘制方不必标记变化区域（菜单、状态栏、动画等随意绘制后直接调用）；
+ *   每次要读一遍整个缓冲，480x135的RGB565缓冲约130 KB
+ * - 启用后的第一次flushChanged()推送全部块，之后只推送变化的块
+ *
+ * @author Calculator Project
+ */
+
+#ifndef REGION_CANVAS_H
+#define REGION_CANVAS_H
+
+#include <Arduino_GFX_Library.h>
+#include "canvas/Arduino_Canvas.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "PowerManager.h"
+#include "BufferPlacement.h"
+#include "PixelKernels.h"
+#include "DirtyRegions.h"
+
+class RegionCanvas : public Arduino_Canvas {
+public:
+    /**
+     * @brief 推送完成回调
+     * @param us 本次推送耗时（微秒）
+     * @param ctx 注册时传入的上下文
+     * @details 双缓冲模式下在推送任务中调用，回调内不要做耗时操作
+     */
+    typedef void (*FlushDoneCallback)(uint32_t us, void *ctx);
+
+    /**
+     * @brief 推送区域回调
+     * @param regions 本批推送的矩形（已裁剪、合并）
+     * @param ctx 注册时传入的上下文
+     * @details 在绘制侧提交推送时调用（渲染任务或调用flush的任务），此时Canvas中这些区域已画完
+     */
+    typedef void (*RegionsCallback)(const DirtyRegions &regions, void *ctx);
+
+    /**
+     * @brief 构造函数
+     * @param w Canvas宽度
+     * @param h Canvas高度
+     * @param panel 输出屏幕驱动（需要地址窗口操作）
+     * @param bus 屏幕使用的数据总线（用于逐行写像素）
+     */
+    RegionCanvas(int16_t w, int16_t h, Arduino_TFT *panel, Arduino_DataBus *bus);
+    ~RegionCanvas();
+
+    /**
+     * @brief 分配帧缓冲
+     * @details Arduino_Canvas按是否有PSRAM自行选择位置；这里再按DISPLAY_FRAMEBUFFER_PLACE
+     *          重新放置，位置已符合时不移动
+     */
+    bool begin(int32_t speed = GFX_NOT_DEFINED) override;
+
+    /**
+     * @brief 启用2位调色板模式
+     * @param colors 调色板颜色（RGB565），索引0为清屏背景色
+     * @param count 颜色数量，1~4
+     * @details 启用需在begin()之前调用；begin()分配失败时回退到16位帧缓冲。
+     * 调色板模式下begin()之后调用只替换同样数量的颜色：缓冲中的索引不变，下次推送即显示新颜色
+     */
+    void setPalette(const uint16_t *colors, uint8_t count);
+
+    /**
+     * @brief 是否处于调色板模式
+     */
+    bool isPaletted() const { return _packed != nullptr; }
+
+    /**
+     * @brief 绘制缓冲占用的字节数（双缓冲时含第二块缓冲）
+     */
+    size_t getBufferBytes() const;
+
+    /**
+     * @brief 填充已裁剪的矩形（fillScreen/fillRect最终调用这里）
+     * @details 未旋转时用pixelFillRect()按128位写入；整行宽度的矩形连续填充
+     */
+    void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+
+    // 调色板模式下直接写2位缓冲；未旋转时画点直接写帧缓冲（面板方向在MADCTL中，见DISPLAY_ROTATION），
+    // 其余交给Arduino_Canvas
+    void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override;
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override;
+
+    /**
+     * @brief 启用TE同步
+     * @param pin 面板TE输出接的GPIO（面板需已用TEON命令打开TE输出）
+     * @return 在超时时间内收到TE返回true；否则不启用，推送行为不变
+     * @details 推送时连续DISPLAY_TE_MAX_MISSES次等不到TE会自动关闭同步
+     */
+    bool beginTearSync(int8_t pin);
+
+    /**
+     * @brief TE同步是否生效
+     */
+    bool hasTearSync() const { return _teSync; }
+
+    /**
+     * @brief 等待下一个TE上升沿（渲染侧帧节拍用，与推送侧互不影响）
+     * @return 超时或未启用时返回false
+     */
+    bool waitTearEffect(uint32_t timeoutMs);
+
+    /**
+     * @brief 累计收到的TE次数（面板帧数）
+     */
+    uint32_t getTearCount() const { return _teCount; }
+
+    /**
+     * @brief 启用双缓冲异步推送
+     * @return 第二块缓冲分配成功且推送任务已创建返回true
+     * @details 需在begin()成功之后调用；第二块缓冲与帧缓冲使用相同的位置。
+     *          失败时保持同步推送模式，行为与之前一致
+     */
+    bool beginDoubleBuffer();
+
+    /**
+     * @brief 将Canvas中的一个矩形区域推送到屏幕
+     * @param x 左上角X
+     * @param y 左上角Y
+     * @param w 宽度
+     * @param h 高度
+     * @details 区域会被裁剪到Canvas范围内；较宽的区域会扩展为整行条带，
+     *          以一次连续DMA传输完成。双缓冲模式下只提交推送即返回，
+     *          若上一帧仍在发送则先等待其完成
+     */
+    void flushRegion(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    /**
+     * @brief 把一帧的多个矩形作为一批推送
+     * @details 各矩形先裁剪、较宽的扩展为整行，再合并相交或相接的条带；
+     *          整批只等待一次TE、设置一次片选，每个矩形只多一次地址窗口设置，
+     *          双缓冲模式下只交换一次缓冲、通知一次推送任务
+     */
+    void flushRegions(const DirtyRegions &regions);
+
+    /**
+     * @brief 启用块哈希
+     * @return 哈希表分配成功返回true
+     * @details 需在begin()成功之后调用
+     */
+    bool beginTileHash();
+
+    /**
+     * @brief 块哈希是否启用
+     */
+    bool hasTileHash() const { return _tileHash != nullptr; }
+
+    /**
+     * @brief 比较各块的哈希，只推送内容变化的块
+     * @return 变化的块数
+     * @details 直接调用flush()/flushRegions()推送的区域不更新哈希，之后这些块可能再推送一次
+     */
+    uint16_t flushChanged();
+
+    /**
+     * @brief 整帧推送（统计字节数后交给Arduino_Canvas）
+     */
+    void flush(void) override;
+
+    /**
+     * @brief 推送[top, bottom)之间的整行条带
+     */
+    void flushRows(int16_t top, int16_t bottom) { flushRegion(0, top, WIDTH, bottom - top); }
+
+    /**
+     * @brief 上一次异步推送是否仍在进行
+     */
+    bool isFlushBusy() const { return _flushBusy; }
+
+    /**
+     * @brief 等待正在进行的异步推送完成
+     */
+    void waitFlush();
+
+    /**
+     * @brief 是否处于双缓冲异步推送模式
+     */
+    bool isDoubleBuffered() const { return _flushTask != nullptr; }
+
+    /**
+     * @brief 面板睡眠（SLPIN/SLPOUT）
+     * @details 睡眠期间flush()/flushRegion()不发送，Canvas内容照常绘制并保留；
+     *          唤醒时整帧推送一次，醒来后第一帧就是最新内容
+     */
+    void setPanelSleep(bool sleep);
+    bool isPanelAsleep() const { return _panelAsleep; }
+
+    /**
+     * @brief 获取累计推送的字节数（用于评估总线占用）
+     */
+    uint32_t getFlushedBytes() const { return _flushedBytes; }
+
+    /**
+     * @brief 设置推送完成回调（用于性能统计）
+     */
+    void setFlushDoneCallback(FlushDoneCallback cb, void *ctx) { _flushDoneCtx = ctx; _flushDoneCb = cb; }
+
+    /**
+     * @brief 设置推送区域回调（屏幕镜像按同样的区域发送）
+     */
+    void setRegionsCallback(RegionsCallback cb, void *ctx) { _regionsCtx = ctx; _regionsCb = cb; }
+
+    /**
+     * @brief 读取一行像素（RGB565），调色板模式下按当前调色板展开
+     * @details 读的是绘制缓冲，坐标需在Canvas范围内
+     */
+    void readPixels(int16_t x, int16_t y, int16_t w, uint16_t *out) const;
+
+private:
+    static void flushTaskEntry(void *arg);                 // 推送任务入口
+    static void IRAM_ATTR tearIsr(void *arg);              // TE上升沿中断
+    void waitFlushSlot();                                  // TE同步时等到下一个消隐期再开始发送
+    void transferRegions(uint16_t *buf, const DirtyRegions &regions);  // 在一次总线事务中同步发送一批矩形
+    void transferPacked(const DirtyRegions &regions);      // 展开调色板缓冲并同步发送一批矩形
+    bool beginPacked();                                    // 分配调色板模式的缓冲
+    uint8_t paletteIndex(uint16_t color);                  // 颜色对应的调色板索引
+    void buildExpandLut();                                 // 按调色板重建展开查找表
+    void fillPacked(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index);  // 在2位缓冲中填充矩形
+    uint32_t hashTile(int16_t tx, int16_t ty) const;       // 一块内容的哈希
+
+    Arduino_TFT *_panel;        ///< 输出屏幕
+    Arduino_DataBus *_bus;      ///< 屏幕数据总线
+    uint32_t _flushedBytes;     ///< 累计推送字节数
+    FlushDoneCallback _flushDoneCb;  ///< 推送完成回调
+    void *_flushDoneCtx;        ///< 回调上下文
+    RegionsCallback _regionsCb; ///< 推送区域回调
+    void *_regionsCtx;          ///< 推送区域回调上下文
+
+    bool _placedFramebuffer;    ///< 帧缓冲由placedAlloc()分配（析构时由本类释放）
+
+    // 调色板模式
+    uint16_t _palette[4];       ///< 调色板颜色
+    uint8_t _paletteCount;      ///< 调色板颜色数量（0=未启用）
+    uint16_t _lastColor;        ///< 上次查找的颜色
+    uint8_t _lastIndex;         ///< 上次查找的索引
+    uint8_t *_packed;           ///< 2位索引缓冲，每字节4个像素（低位在左）
+    uint16_t *_expandLut;       ///< 每个字节展开成的4个RGB565像素 [256][4]
+    uint16_t *_lineBuffer;      ///< 推送时展开的行缓冲
+
+    // TE同步
+    int8_t _tePin;              ///< TE引脚，-1表示未启用
+    volatile bool _teSync;      ///< 推送前等待TE
+    volatile uint32_t _teCount; ///< 收到的TE次数
+    uint8_t _teMisses;          ///< 推送时连续等不到TE的次数
+    SemaphoreHandle_t _teFlushSem;  ///< 推送侧的TE信号量
+    SemaphoreHandle_t _teFrameSem;  ///< 帧节拍侧的TE信号量
+
+    // 面板睡眠
+    bool _panelAsleep;          ///< 已发送SLPIN，暂停推送
+    uint32_t _panelWakeMs;      ///< 上次SLPOUT的时间
+
+    // 双缓冲
+    uint16_t *_backBuffer;      ///< 另一块缓冲（交换后成为绘制目标）
+    uint16_t *_frontBuffer;     ///< 正在发送的缓冲
+    TaskHandle_t _flushTask;    ///< 推送任务
+    PowerLock _flushLock;       ///< 推送期间保持最高频率
+    volatile bool _flushBusy;   ///< 推送任务正在发送
+    DirtyRegions _pendRegions;  ///< 已提交的推送区域
+
+    // 块哈希
+    uint32_t *_tileHash;        ///< 各块上次推送时的哈希，按行排列
+    uint8_t _tilesX;            ///< 每行的块数
+    uint8_t _tilesY;            ///< 块的行数
+    bool _tileHashValid;        ///< 哈希表已填充（启用后第一次推送全部块）
+};
+
+#endif // REGION_CANVAS_H
@@ -0,0 +1,246 @@
+/**
+ * @file ResourceMonitor.cpp
+ * @brief 任务栈余量和各类堆用量的趋势实现
+ *
+ * @author Calculator Project
+ */
+
+#include "ResourceMonitor.h"
+#include "BufferPlacement.h"
+#include "Console.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+namespace {
+
+// 创建时记录的栈大小，按名称查找（同名任务重建时更新）
+struct StackSize {
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t bytes;
+};
+
+const uint8_t MAX_STACK_SIZES = 32;
+StackSize stackSizes[MAX_STACK_SIZES];
+uint8_t stackSizeCount = 0;
+portMUX_TYPE stackMux = portMUX_INITIALIZER_UNLOCKED;
+
+const char* const HEAP_NAMES[] = {"内部RAM", "DMA", "PSRAM"};
+const uint32_t HEAP_CAPS[] = {
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_DMA,
+    MALLOC_CAP_SPIRAM,
+};
+
+void cmdHeapTrend(const ConsoleArgs&) {
+    ResourceMonitor::instance().printHeap(Serial);
+}
+
+void cmdTasks(const ConsoleArgs& args) {
+    if (args.is(1, "sample")) {
+        ResourceMonitor::instance().sample();
+    }
+    ResourceMonitor::instance().printTasks(Serial);
+}
+
+constexpr ConsoleCommand RESOURCE_COMMANDS[] = {
+    {"heap_trend", "", "各类堆的可用量、最小剩余和每小时变化，各子系统的大块缓冲", cmdHeapTrend},
+    {"tasks", "[sample]", "各任务的栈大小、余量峰值和建议大小（sample：先采样一次）", cmdTasks},
+};
+static_assert(consoleSorted(RESOURCE_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+// 链接参数 -Wl,--wrap=xTaskCreatePinnedToCore 把所有调用转到这里（xTaskCreate也调用它）
+extern "C" {
+BaseType_t __real_xTaskCreatePinnedToCore(TaskFunction_t code, const char* const name, const uint32_t stackDepth,
+                                          void* const parameters, UBaseType_t priority,
+                                          TaskHandle_t* const created, const BaseType_t core);
+
+BaseType_t __wrap_xTaskCreatePinnedToCore(TaskFunction_t code, const char* const name, const uint32_t stackDepth,
+                                          void* const parameters, UBaseType_t priority,
+                                          TaskHandle_t* const created, const BaseType_t core) {
+    BaseType_t result = __real_xTaskCreatePinnedToCore(code, name, stackDepth, parameters, priority, created, core);
+    if (result == pdPASS && name) {
+        // ESP-IDF中栈深度以字节计
+        ResourceMonitor::recordStack(name, stackDepth);
+    }
+    return result;
+}
+}
+
+void ResourceMonitor::recordStack(const char* name, uint32_t bytes) {
+    portENTER_CRITICAL_SAFE(&stackMux);
+    uint8_t i = 0;
+    while (i < stackSizeCount && strncmp(stackSizes[i].name, name, configMAX_TASK_NAME_LEN - 1) != 0) i++;
+    if (i == stackSizeCount && stackSizeCount < MAX_STACK_SIZES) {
+        strncpy(stackSizes[i].name, name, configMAX_TASK_NAME_LEN - 1);
+        stackSizeCount++;
+    }
+    if (i < stackSizeCount) {
+        stackSizes[i].bytes = bytes;
+    }
+    portEXIT_CRITICAL_SAFE(&stackMux);
+}
+
+uint32_t ResourceMonitor::stackSizeOf(const char* name) {
+    uint32_t bytes = 0;
+    portENTER_CRITICAL_SAFE(&stackMux);
+    for (uint8_t i = 0; i < stackSizeCount; i++) {
+        if (strncmp(stackSizes[i].name, name, configMAX_TASK_NAME_LEN - 1) == 0) {
+            bytes = stackSizes[i].bytes;
+            break;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&stackMux);
+    return bytes;
+}
+
+ResourceMonitor::ResourceMonitor()
+    : _timer(TimerWheel::INVALID),
+      _taskCount(0),
+      _heapCount(0) {
+    memset(_tasks, 0, sizeof(_tasks));
+    memset(_heap, 0, sizeof(_heap));
+}
+
+void ResourceMonitor::begin() {
+    Console::instance().addCommands(RESOURCE_COMMANDS);
+    _timer = TimerWheel::instance().create("resources", [](void* context) {
+        ResourceMonitor* monitor = static_cast<ResourceMonitor*>(context);
+        monitor->sample();
+        TimerWheel::instance().start(monitor->_timer, RESOURCE_SAMPLE_MS);
+    }, this);
+    sample();
+    TimerWheel::instance().start(_timer, RESOURCE_SAMPLE_MS);
+}
+
+void ResourceMonitor::sample() {
+    uint32_t now = millis();
+    sampleTasks(now);
+
+    HeapSample& heap = _heap[_heapCount % RESOURCE_HISTORY];
+    heap.timeMs = now;
+    for (uint8_t kind = 0; kind < HEAP_KIND_COUNT; kind++) {
+        heap.free[kind] = heap_caps_get_free_size(HEAP_CAPS[kind]);
+    }
+    _heapCount++;
+}
+
+ResourceMonitor::TaskRecord* ResourceMonitor::findTask(const char* name, UBaseType_t number) {
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        if (_tasks[i].number == number) return &_tasks[i];
+    }
+    // 新任务：表满时占用已结束任务的位置
+    TaskRecord* record = nullptr;
+    if (_taskCount < MAX_TASKS) {
+        record = &_tasks[_taskCount++];
+    } else {
+        for (uint8_t i = 0; i < MAX_TASKS && !record; i++) {
+            if (!_tasks[i].alive) record = &_tasks[i];
+        }
+        if (!record) return nullptr;
+    }
+    memset(record, 0, sizeof(*record));
+    strncpy(record->name, name, configMAX_TASK_NAME_LEN - 1);
+    record->number = number;
+    record->firstFree = UINT32_MAX;
+    record->minFree = UINT32_MAX;
+    return record;
+}
+
+void ResourceMonitor::sampleTasks(uint32_t now) {
+#if configUSE_TRACE_FACILITY
+    // 数组小于当前任务数时uxTaskGetSystemState什么也不返回，留出余量
+    static const UBaseType_t MAX_STATUS = MAX_TASKS + 8;
+    static TaskStatus_t status[MAX_STATUS];
+    UBaseType_t count = uxTaskGetSystemState(status, MAX_STATUS, nullptr);
+    if (count == 0) return;
+
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        _tasks[i].alive = false;
+    }
+    for (UBaseType_t i = 0; i < count; i++) {
+        TaskRecord* record = findTask(status[i].pcTaskName, status[i].xTaskNumber);
+        if (!record) continue;
+        uint32_t free = status[i].usStackHighWaterMark;
+        if (record->firstFree == UINT32_MAX) record->firstFree = free;
+        if (free < record->minFree) {
+            record->minFree = free;
+            record->changedMs = now;
+        }
+        record->priority = status[i].uxCurrentPriority;
+        record->alive = true;
+    }
+#else
+    (void)now;
+#endif
+}
+
+uint32_t ResourceMonitor::lowestStackFree(const char** name) const {
+    const TaskRecord* lowest = nullptr;
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        if (_tasks[i].alive && (!lowest || _tasks[i].minFree < lowest->minFree)) lowest = &_tasks[i];
+    }
+    if (name) *name = lowest ? lowest->name : "";
+    return lowest ? lowest->minFree : 0;
+}
+
+void ResourceMonitor::printTasks(Print& out) const {
+#if configUSE_TRACE_FACILITY
+    out.printf("任务栈（%u个，每%lu秒采样）:\n", _taskCount, (unsigned long)(RESOURCE_SAMPLE_MS / 1000));
+    out.println(" 名称             优先级   栈大小  已用峰值  余量峰值  首次余量  建议大小  最近变小");
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        const TaskRecord& task = _tasks[i];
+        uint32_t size = stackSizeOf(task.name);
+        out.printf(" %-16s %6u ", task.name, (unsigned)task.priority);
+        if (size && size >= task.minFree) {
+            // 建议大小按256字节取整
+            uint32_t used = size - task.minFree;
+            uint32_t suggested = (used + STACK_MARGIN_BYTES + 255) & ~255UL;
+            out.printf(" %7lu  %8lu", (unsigned long)size, (unsigned long)used);
+            out.printf("  %8lu  %8lu  %8lu", (unsigned long)task.minFree, (unsigned long)task.firstFree,
+                       (unsigned long)suggested);
+        } else {
+            out.printf(" %7s  %8s  %8lu  %8lu  %8s", "-", "-", (unsigned long)task.minFree,
+                       (unsigned long)task.firstFree, "-");
+        }
+        if (!task.alive) {
+            out.println("  已结束");
+        } else {
+            out.printf("  %lus前\n", (unsigned long)((millis() - task.changedMs) / 1000));
+        }
+    }
+    out.println("余量峰值仍在变小的任务还没有测到最坏情况，按它缩小栈之前多运行一段时间");
+#else
+    out.println("任务列表不可用（FreeRTOS未启用跟踪功能）");
+#endif
+}
+
+void ResourceMonitor::printHeap(Print& out) const {
+    uint32_t samples = _heapCount < RESOURCE_HISTORY ? _heapCount : RESOURCE_HISTORY;
+    if (samples == 0) {
+        out.println("还没有采样");
+        return;
+    }
+    const HeapSample& latest = _heap[(_heapCount - 1) % RESOURCE_HISTORY];
+    const HeapSample& oldest = _heap[(_heapCount - samples) % RESOURCE_HISTORY];
+    uint32_t span = latest.timeMs - oldest.timeMs;
+
+    out.printf("堆（最近%lu次采样，%lu秒）:\n", (unsigned long)samples, (unsigned long)(span / 1000));
+    for (uint8_t kind = 0; kind < HEAP_KIND_COUNT; kind++) {
+        uint32_t total = heap_caps_get_total_size(HEAP_CAPS[kind]);
+        if (total == 0) continue;
+        out.printf(" - %-8s 可用 %7lu / %7lu, 最小剩余 %7lu, 最大块 %7lu", HEAP_NAMES[kind],
+                   (unsigned long)latest.free[kind], (unsigned long)total,
+                   (unsigned long)heap_caps_get_minimum_free_size(HEAP_CAPS[kind]),
+                   (unsigned long)heap_caps_get_largest_free_block(HEAP_CAPS[kind]));
+        if (span > 0) {
+            int64_t change = (int64_t)latest.free[kind] - oldest.free[kind];
+            out.printf(", 每小时 %+lld 字节\n", (long long)(change * 3600000 / span));
+        } else {
+            out.println();
+        }
+    }
+    out.println(" - 各子系统的大块缓冲:");
+    printPlacements(out);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file ResourceMonitor.h
+ * @brief 任务栈余量和各类堆用量的趋势
+ * @details 扫描、渲染、推送、日志、HID发送等各有自己的任务，栈大小需要实测数据支持：
+ * - 链接时用 -Wl,--wrap=xTaskCreatePinnedToCore 记录每个任务创建时的名称和栈大小
+ *   （包括框架和IDF内部创建的任务，xTaskCreate也经过它）
+ * - 每RESOURCE_SAMPLE_MS由时间轮采样一次：各任务的栈余量峰值（uxTaskGetSystemState）、
+ *   内部RAM、DMA可用内存和PSRAM的可用量、最小剩余和最大块
+ * - 栈余量记录首次采样值和最近一次变小的时刻，余量还在变小说明尚未测到最坏情况
+ * - 堆保留最近RESOURCE_HISTORY次采样，按首尾之差给出每小时的变化（持续下降即泄漏）
+ * - 大块缓冲按用途（placedAlloc的名称）列出，即各子系统占用的内存
+ *
+ * 串口命令 tasks 列出各任务的栈（大小已知时给出建议大小：已用峰值 + STACK_MARGIN_BYTES），
+ * heap_trend 列出各类堆的当前值、趋势和各子系统的大块缓冲。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef RESOURCE_MONITOR_H
+#define RESOURCE_MONITOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "TimerWheel.h"
+
+class ResourceMonitor {
+public:
+    static const uint8_t MAX_TASKS = 24;
+
+    static ResourceMonitor& instance() {
+        static ResourceMonitor instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册串口命令，立即采样一次并开始定期采样
+     */
+    void begin();
+
+    /**
+     * @brief 采样各任务栈余量和各类堆
+     */
+    void sample();
+
+    /**
+     * @brief 最近一次采样时仍存在的任务中最小的栈余量峰值（字节）
+     * @param name 可为nullptr，输出该任务的名称
+     * @return 还没有采样时返回0
+     */
+    uint32_t lowestStackFree(const char** name) const;
+
+    void printTasks(Print& out) const;
+    void printHeap(Print& out) const;
+
+    /**
+     * @brief 记录任务的栈大小（包装函数中调用，可在静态构造之前和任意任务中调用）
+     */
+    static void recordStack(const char* name, uint32_t bytes);
+
+private:
+    enum HeapKind : uint8_t {
+        HEAP_INTERNAL,
+        HEAP_DMA,
+        HEAP_PSRAM,
+        HEAP_KIND_COUNT
+    };
+
+    struct TaskRecord {
+        char name[configMAX_TASK_NAME_LEN];
+        UBaseType_t number;         ///< FreeRTOS任务编号，同名任务重建后编号不同
+        uint32_t firstFree;         ///< 首次采样时的栈余量峰值（字节）
+        uint32_t minFree;           ///< 当前的栈余量峰值
+        uint32_t changedMs;         ///< 余量最近一次变小的时刻
+        uint8_t priority;
+        bool alive;                 ///< 最近一次采样时仍存在
+    };
+
+    struct HeapSample {
+        uint32_t timeMs;
+        uint32_t free[HEAP_KIND_COUNT];
+    };
+
+    ResourceMonitor();
+
+    static uint32_t stackSizeOf(const char* name);
+    void sampleTasks(uint32_t now);
+    TaskRecord* findTask(const char* name, UBaseType_t number);
+
+    TimerWheel::TimerId _timer;
+    TaskRecord _tasks[MAX_TASKS];
+    uint8_t _taskCount;
+    HeapSample _heap[RESOURCE_HISTORY];
+    uint32_t _heapCount;            ///< 累计采样次数，环形保存最近RESOURCE_HISTORY次
+};
+
+#endif // RESOURCE_MONITOR_H
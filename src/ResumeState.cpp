@@ -0,0 +1,145 @@
+/**
+ * @file ResumeState.cpp
+ * @brief 深度睡眠前后保留的计算器状态实现
+ *
+ * @author Calculator Project
+ */
+
+#include "ResumeState.h"
+#include "Expression.h"
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include <esp_rom_crc.h>
+#include <string.h>
+
+#define TAG_RESUME "RESUME"
+
+namespace {
+
+const uint32_t SNAPSHOT_MAGIC = 0x52534D45;     // "RSME"
+const uint16_t SNAPSHOT_VERSION = 2;
+
+struct Snapshot {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    double currentNumber;
+    double constantOperand;
+    int64_t inputMantissa;
+    int64_t grandTotal;
+    Operator constantOp;
+    CalculatorState state;
+    CalculatorError lastError;
+    uint8_t inputScale;
+    bool inputExact;
+    bool waitingForOperand;
+    bool hasDecimalPoint;
+    bool grandTotalOverflow;
+    uint8_t tokenCount;
+    uint8_t cursor;                                 // 表达式光标（前cursor个记号之后）
+    uint8_t historyCount;
+    ExprToken tokens[Expression::MAX_TOKENS];
+    char expression[128];
+    char input[32];
+    char display[32];
+    HistoryRecord history[RESUME_HISTORY_RECORDS];  // 0为最新一条
+    uint32_t crc;                                   // 之前所有字节
+};
+
+// 深度睡眠期间保持；冷启动时为零，魔数不匹配
+RTC_DATA_ATTR Snapshot snapshot;
+
+} // namespace
+
+uint32_t ResumeState::checksum() {
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(&snapshot), offsetof(Snapshot, crc));
+}
+
+void ResumeState::save(const CalculatorCore& core) {
+    static_assert(sizeof(snapshot.expression) == CalculatorCore::EXPRESSION_CAPACITY &&
+                  sizeof(snapshot.input) == CalculatorCore::INPUT_CAPACITY,
+                  "快照文本容量须与CalculatorCore一致");
+
+    snapshot.magic = SNAPSHOT_MAGIC;
+    snapshot.version = SNAPSHOT_VERSION;
+    snapshot.size = sizeof(Snapshot);
+    snapshot.currentNumber = core._currentNumber;
+    snapshot.constantOperand = core._constantOperand;
+    snapshot.inputMantissa = core._inputMantissa;
+    snapshot.grandTotal = core._grandTotal;
+    snapshot.constantOp = core._constantOp;
+    snapshot.state = core._state;
+    snapshot.lastError = core._lastError;
+    snapshot.inputScale = core._inputScale;
+    snapshot.inputExact = core._inputExact;
+    snapshot.waitingForOperand = core._waitingForOperand;
+    snapshot.hasDecimalPoint = core._hasDecimalPoint;
+    snapshot.grandTotalOverflow = core._grandTotalOverflow;
+
+    const Expression& expression = *core._expression;
+    snapshot.tokenCount = expression.size();
+    snapshot.cursor = expression.cursor();
+    for (uint8_t i = 0; i < snapshot.tokenCount; i++) {
+        snapshot.tokens[i] = expression.tokenAt(i);
+    }
+    memset(snapshot.expression, 0, sizeof(snapshot.expression));
+    memset(snapshot.input, 0, sizeof(snapshot.input));
+    memset(snapshot.display, 0, sizeof(snapshot.display));
+    memcpy(snapshot.expression, core._expressionDisplay.c_str(), core._expressionDisplay.length());
+    memcpy(snapshot.input, core._inputBuffer.c_str(), core._inputBuffer.length());
+    memcpy(snapshot.display, core._currentDisplay.c_str(), core._currentDisplay.length());
+
+    size_t historyCount = core._history.size();
+    if (historyCount > RESUME_HISTORY_RECORDS) historyCount = RESUME_HISTORY_RECORDS;
+    snapshot.historyCount = (uint8_t)historyCount;
+    for (size_t i = 0; i < historyCount; i++) {
+        snapshot.history[i] = *core._history.get(i);
+    }
+
+    snapshot.crc = checksum();
+    LOG_I(TAG_RESUME, "已保存计算器状态: %u个记号，%u条历史", snapshot.tokenCount, snapshot.historyCount);
+}
+
+bool ResumeState::available() {
+    return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_EXT1 && snapshot.magic == SNAPSHOT_MAGIC &&
+           snapshot.version == SNAPSHOT_VERSION && snapshot.size == sizeof(Snapshot) &&
+           snapshot.tokenCount <= Expression::MAX_TOKENS && snapshot.historyCount <= RESUME_HISTORY_RECORDS &&
+           snapshot.crc == checksum();
+}
+
+bool ResumeState::restore(CalculatorCore& core) {
+    if (!available()) return false;
+    snapshot.magic = 0;     // 只用一次：之后的复位照常冷启动
+
+    if (!core._expression->restore(0, snapshot.tokens, snapshot.tokenCount)) {
+        LOG_W(TAG_RESUME, "表达式恢复失败，冷启动");
+        core._expression->clear();
+        return false;
+    }
+    core._expression->moveCursor(snapshot.cursor);
+    core._expressionDisplay.assign(snapshot.expression);
+    core._inputBuffer.assign(snapshot.input);
+    core._currentDisplay.assign(snapshot.display);
+
+    core._currentNumber = snapshot.currentNumber;
+    core._constantOperand = snapshot.constantOperand;
+    core._inputMantissa = snapshot.inputMantissa;
+    core._grandTotal = snapshot.grandTotal;
+    core._constantOp = snapshot.constantOp;
+    core._state = snapshot.state;
+    core._lastError = snapshot.lastError;
+    core._inputScale = snapshot.inputScale;
+    core._inputExact = snapshot.inputExact;
+    core._waitingForOperand = snapshot.waitingForOperand;
+    core._hasDecimalPoint = snapshot.hasDecimalPoint;
+    core._grandTotalOverflow = snapshot.grandTotalOverflow;
+
+    // 历史日志已经载入最近的记录时不重复追加
+    if (core._history.size() == 0) {
+        for (uint8_t i = snapshot.historyCount; i > 0; i--) {
+            core._history.appendRecord(snapshot.history[i - 1]);
+        }
+    }
+    LOG_I(TAG_RESUME, "已恢复计算器状态: %u个记号，%u条历史", snapshot.tokenCount, snapshot.historyCount);
+    return true;
+}
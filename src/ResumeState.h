@@ -0,0 +1,48 @@
+/**
+ * @file ResumeState.h
+ * @brief 深度睡眠前后保留的计算器状态
+ * @details 进入深度睡眠前把CalculatorCore的状态写入RTC慢速内存（深度睡眠期间保持供电）：
+ * - 状态、错误、当前数值、输入尾数、常数运算和累计总计等标量
+ * - 表达式记号序列和光标、表达式文本、输入缓冲和当前显示
+ * - 最近RESUME_HISTORY_RECORDS条历史记录（没有历史日志时启动后历史为空，用它补回）
+ * 按键唤醒重新启动时，setup()在创建计算器后用它代替clearAll()并立即绘制首帧，
+ * 看起来和没有关机一样；同时跳过启动画面和启动提示灯。
+ *
+ * 快照带魔数、版本和CRC，只有ext1（按键）唤醒时才使用，使用一次后作废；
+ * 其他复位方式或固件升级后快照无效，照常冷启动。
+ * 内存寄存器已由ConfigManager保存在NVS中（PANEL_OFF阶段写回），不重复保存；
+ * 程序员模式的数值和撤销历史不保留。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef RESUME_STATE_H
+#define RESUME_STATE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "CalculatorCore.h"
+
+class ResumeState {
+public:
+    /**
+     * @brief 保存计算器状态（深度睡眠阶段的进入回调中调用）
+     */
+    static void save(const CalculatorCore& core);
+
+    /**
+     * @brief 本次启动是否由按键从深度睡眠唤醒且快照有效（在setup()最前面即可调用）
+     */
+    static bool available();
+
+    /**
+     * @brief 把快照恢复到计算器并作废快照；调用前计算器应已begin()并clearAll()
+     * @return 没有有效快照或恢复失败时返回false，计算器保持清除后的状态
+     */
+    static bool restore(CalculatorCore& core);
+
+private:
+    static uint32_t checksum();
+};
+
+#endif // RESUME_STATE_H
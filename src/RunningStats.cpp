@@ -0,0 +1,113 @@
+/**
+ * @file RunningStats.cpp
+ * @brief 统计模式累计统计量实现
+ *
+ * @author Calculator Project
+ */
+
+#include "RunningStats.h"
+#include "BufferPlacement.h"
+#include <math.h>
+
+RunningStats::RunningStats()
+    : _lower{nullptr, 0, true},
+      _upper{nullptr, 0, false},
+      _medianCapacity(0) {
+    clear();
+}
+
+RunningStats::~RunningStats() {
+    placedFree(_lower.data);
+}
+
+void RunningStats::begin(uint32_t medianCapacity) {
+    if (!medianCapacity || _lower.data) return;
+    // 两个堆各占一半，较小一半最多多1个
+    uint32_t half = medianCapacity / 2 + 1;
+    double* buffer = (double*)placedAlloc("stats_median", sizeof(double) * half * 2, PLACE_PSRAM);
+    if (!buffer) return;
+    _lower.data = buffer;
+    _upper.data = buffer + half;
+    _medianCapacity = medianCapacity;
+}
+
+void RunningStats::clear() {
+    _count = 0;
+    _mean = 0.0;
+    _m2 = 0.0;
+    _sum = 0.0;
+    _compensation = 0.0;
+    _min = 0.0;
+    _max = 0.0;
+    _lower.count = 0;
+    _upper.count = 0;
+}
+
+void RunningStats::add(double x) {
+    _count++;
+    double delta = x - _mean;
+    _mean += delta / _count;
+    _m2 += delta * (x - _mean);
+
+    // Neumaier：较小的一项丢掉的低位累计到补偿项
+    double t = _sum + x;
+    _compensation += fabs(_sum) >= fabs(x) ? (_sum - t) + x : (x - t) + _sum;
+    _sum = t;
+
+    if (_count == 1 || x < _min) _min = x;
+    if (_count == 1 || x > _max) _max = x;
+
+    if (!_medianCapacity || _count > _medianCapacity) return;
+    if (_lower.count == 0 || x <= _lower.top()) {
+        _lower.push(x);
+    } else {
+        _upper.push(x);
+    }
+    // 保持较小一半的个数等于或多1
+    if (_lower.count > _upper.count + 1) {
+        _upper.push(_lower.pop());
+    } else if (_upper.count > _lower.count) {
+        _lower.push(_upper.pop());
+    }
+}
+
+double RunningStats::stddev() const {
+    return sqrt(variance());
+}
+
+double RunningStats::populationStddev() const {
+    return sqrt(populationVariance());
+}
+
+bool RunningStats::median(double& out) const {
+    if (!_count || !_medianCapacity || _count > _medianCapacity) return false;
+    out = _lower.count > _upper.count ? _lower.top() : (_lower.top() + _upper.top()) / 2;
+    return true;
+}
+
+void RunningStats::Heap::push(double x) {
+    uint32_t i = count++;
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!before(x, data[parent])) break;
+        data[i] = data[parent];
+        i = parent;
+    }
+    data[i] = x;
+}
+
+double RunningStats::Heap::pop() {
+    double result = data[0];
+    double last = data[--count];
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= count) break;
+        if (child + 1 < count && before(data[child + 1], data[child])) child++;
+        if (!before(data[child], last)) break;
+        data[i] = data[child];
+        i = child;
+    }
+    data[i] = last;
+    return result;
+}
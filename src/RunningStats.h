@@ -0,0 +1,85 @@
+/**
+ * @file RunningStats.h
+ * @brief 统计模式的累计统计量
+ * @details 每输入一个数只做常数次运算，不保存数列：
+ * - 均值和方差用Welford算法逐个更新（避免Σx²−n·x̄²的相消误差）
+ * - 总和用Neumaier补偿求和，一列金额累加后不出现0.1+0.2式的尾差
+ * - 最小值、最大值直接比较
+ * 中位数需要保留数值：PSRAM中的两个堆（较小一半为最大堆、较大一半为最小堆），
+ * 每次插入O(log n)，中位数由两个堆顶得到；超过STATS_MEDIAN_CAPACITY个数后不再提供中位数，
+ * 其他统计量不受影响。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <stdint.h>
+
+class RunningStats {
+public:
+    RunningStats();
+    ~RunningStats();
+
+    /**
+     * @brief 分配中位数用的缓冲（优先PSRAM，失败时只是没有中位数）
+     * @param medianCapacity 最多保留的数值个数，0表示不计算中位数
+     */
+    void begin(uint32_t medianCapacity);
+
+    void add(double x);
+    void clear();
+
+    uint32_t count() const { return _count; }
+    double sum() const { return _sum + _compensation; }
+    double mean() const { return _mean; }
+    double min() const { return _min; }
+    double max() const { return _max; }
+
+    /**
+     * @brief 样本方差（n−1），少于2个数时为0
+     */
+    double variance() const { return _count > 1 ? _m2 / (_count - 1) : 0.0; }
+
+    /**
+     * @brief 总体方差（n），没有数时为0
+     */
+    double populationVariance() const { return _count ? _m2 / _count : 0.0; }
+
+    double stddev() const;
+    double populationStddev() const;
+
+    /**
+     * @brief 中位数
+     * @return 没有数、未分配缓冲或超出容量时返回false
+     */
+    bool median(double& out) const;
+
+private:
+    // 数组中的二叉堆，maxHeap为true时堆顶最大
+    struct Heap {
+        double* data;
+        uint32_t count;
+        bool maxHeap;
+
+        bool before(double a, double b) const { return maxHeap ? a > b : a < b; }
+        double top() const { return data[0]; }
+        void push(double x);
+        double pop();
+    };
+
+    uint32_t _count;
+    double _mean;
+    double _m2;                 ///< 与均值之差的平方和
+    double _sum;
+    double _compensation;       ///< 补偿求和累计的舍入误差
+    double _min;
+    double _max;
+
+    Heap _lower;                ///< 较小的一半（最大堆），个数等于或多1
+    Heap _upper;                ///< 较大的一半（最小堆）
+    uint32_t _medianCapacity;
+};
+
+#endif // RUNNING_STATS_H
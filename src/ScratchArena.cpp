@@ -0,0 +1,63 @@
+/**
+ * @file ScratchArena.cpp
+ * @brief 按键事件的临时内存实现
+ *
+ * @author Calculator Project
+ */
+
+#include "ScratchArena.h"
+#include "config.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+ScratchArena::ScratchArena(uint8_t* buffer, size_t capacity)
+    : _buffer(buffer),
+      _capacity(capacity),
+      _used(0),
+      _highWater(0),
+      _failures(0) {
+}
+
+ScratchArena& ScratchArena::keyEvent() {
+    alignas(8) static uint8_t buffer[KEY_SCRATCH_BYTES];
+    static ScratchArena arena(buffer, sizeof(buffer));
+    return arena;
+}
+
+void* ScratchArena::alloc(size_t size, size_t align) {
+    size_t start = (_used + align - 1) & ~(align - 1);
+    if (start > _capacity || size > _capacity - start) {
+        _failures++;
+        return nullptr;
+    }
+    _used = start + size;
+    if (_used > _highWater) _highWater = _used;
+    return _buffer + start;
+}
+
+const char* ScratchArena::copy(const char* text, size_t length) {
+    if (!text) return "";
+    if (length == SIZE_MAX) length = strlen(text);
+    char* out = (char*)alloc(length + 1, 1);
+    if (!out) return "";
+    memcpy(out, text, length);
+    out[length] = '\0';
+    return out;
+}
+
+const char* ScratchArena::printf(const char* format, ...) {
+    char* out = (char*)_buffer + _used;
+    size_t room = _capacity - _used;
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(out, room, format, args);
+    va_end(args);
+
+    if (length < 0 || (size_t)length >= room) {
+        _failures++;
+        return "";
+    }
+    return (const char*)alloc(length + 1, 1);
+}
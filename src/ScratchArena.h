@@ -0,0 +1,80 @@
+/**
+ * @file ScratchArena.h
+ * @brief 按键事件的临时内存（线性分配）
+ * @details 按键处理中拼接的文本（数字格式化、预览、错误提示）从固定缓冲中顺序分配：
+ * - 分配只移动偏移，不释放单个对象；ScratchScope析构时回到进入时的位置
+ * - 按键事件处理完（onKeyEvent返回）整个缓冲归零，耗时固定，不经过堆
+ * - 作用域可以嵌套，内层作用域只回收自己的分配
+ * - 只在loop任务中使用，没有锁
+ * - 空间不足时alloc()返回nullptr，文本接口返回空串，计入失败次数（mem命令显示）
+ *
+ * @author Calculator Project
+ */
+
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class ScratchArena {
+public:
+    ScratchArena(uint8_t* buffer, size_t capacity);
+
+    /**
+     * @brief 按键事件共用的临时内存（KEY_SCRATCH_BYTES）
+     */
+    static ScratchArena& keyEvent();
+
+    /**
+     * @brief 分配内存（不清零）
+     * @param size 字节数
+     * @param align 对齐（2的幂）
+     * @return 空间不足时返回nullptr
+     */
+    void* alloc(size_t size, size_t align = 4);
+
+    /**
+     * @brief 复制字符串
+     * @param length 复制的字节数，SIZE_MAX表示到'\0'为止
+     */
+    const char* copy(const char* text, size_t length = SIZE_MAX);
+
+    /**
+     * @brief 格式化字符串，先按剩余空间写入，再收回多余部分
+     */
+    const char* printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    size_t mark() const { return _used; }
+    void rewind(size_t mark) { if (mark < _used) _used = mark; }
+
+    size_t used() const { return _used; }
+    size_t capacity() const { return _capacity; }
+    size_t highWater() const { return _highWater; }
+    uint32_t failures() const { return _failures; }
+
+private:
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    uint8_t* _buffer;
+    size_t _capacity;
+    size_t _used;
+    size_t _highWater;              ///< 历史最大占用，用于确定KEY_SCRATCH_BYTES
+    uint32_t _failures;             ///< 空间不足的次数
+};
+
+/**
+ * @brief 作用域：析构时回收作用域内的全部分配
+ */
+class ScratchScope {
+public:
+    explicit ScratchScope(ScratchArena& arena) : _arena(arena), _mark(arena.mark()) {}
+    ~ScratchScope() { _arena.rewind(_mark); }
+
+private:
+    ScratchArena& _arena;
+    size_t _mark;
+};
+
+#endif // SCRATCH_ARENA_H
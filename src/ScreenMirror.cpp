@@ -0,0 +1,231 @@
+/**
+ * @file ScreenMirror.cpp
+ * @brief 屏幕镜像实现
+ *
+ * @author Calculator Project
+ */
+
+#include "ScreenMirror.h"
+#include "RegionCanvas.h"
+#include "LoopScheduler.h"
+#include "Metrics.h"
+#include <freertos/FreeRTOS.h>
+#include <string.h>
+
+namespace {
+
+MetricCounter tilesSent("mirror.tiles");
+MetricCounter bytesSent("mirror.bytes");
+
+portMUX_TYPE dirtyMux = portMUX_INITIALIZER_UNLOCKED;
+
+// QOI565操作码（同 tools/splash_pack.py 和 BootSplash 的解码器）
+const uint8_t OP_INDEX = 0x00;
+const uint8_t OP_DIFF = 0x40;
+const uint8_t OP_LUMA = 0x80;
+const uint8_t OP_RUN = 0xC0;
+const uint8_t OP_RGB = 0xFE;
+const uint8_t MAX_RUN = 62;
+
+inline uint8_t hash565(uint16_t p) {
+    return (((p >> 11) & 0x1F) * 3 + ((p >> 5) & 0x3F) * 5 + (p & 0x1F) * 7) & 63;
+}
+
+// 差值回绕到 [-2^(bits-1), 2^(bits-1))
+inline int wrap(int value, int bits) {
+    int half = 1 << (bits - 1);
+    return ((value + half) & ((1 << bits) - 1)) - half;
+}
+
+} // namespace
+
+ScreenMirror::ScreenMirror()
+    : _canvas(nullptr),
+      _live(false),
+      _next(0) {
+    memset(_dirty, 0, sizeof(_dirty));
+}
+
+void ScreenMirror::attach(RegionCanvas* canvas) {
+    _canvas = canvas;
+    if (canvas) canvas->setRegionsCallback(onRegions, this);
+}
+
+void ScreenMirror::setLive(bool live) {
+    _live = live;
+    if (live) {
+        markAll();
+    } else {
+        portENTER_CRITICAL(&dirtyMux);
+        memset(_dirty, 0, sizeof(_dirty));
+        portEXIT_CRITICAL(&dirtyMux);
+    }
+}
+
+void ScreenMirror::requestAll() {
+    markAll();
+}
+
+void ScreenMirror::markAll() {
+    portENTER_CRITICAL(&dirtyMux);
+    for (uint16_t t = 0; t < TILE_COUNT; t++) {
+        _dirty[t >> 5] |= 1UL << (t & 31);
+    }
+    portEXIT_CRITICAL(&dirtyMux);
+}
+
+bool ScreenMirror::pending() const {
+    for (uint16_t i = 0; i < TILE_WORDS; i++) {
+        if (_dirty[i]) return true;
+    }
+    return false;
+}
+
+void ScreenMirror::onRegions(const DirtyRegions& regions, void* ctx) {
+    ScreenMirror* self = static_cast<ScreenMirror*>(ctx);
+    if (!self->_live) return;
+
+    portENTER_CRITICAL(&dirtyMux);
+    for (uint8_t i = 0; i < regions.count(); i++) {
+        const DirtyRegions::Rect& r = regions[i];
+        if (r.w <= 0 || r.h <= 0) continue;
+        int16_t tx0 = r.x / DISPLAY_TILE_W;
+        int16_t ty0 = r.y / DISPLAY_TILE_H;
+        int16_t tx1 = (r.x + r.w - 1) / DISPLAY_TILE_W;
+        int16_t ty1 = (r.y + r.h - 1) / DISPLAY_TILE_H;
+        if (tx1 >= TILES_X) tx1 = TILES_X - 1;
+        if (ty1 >= TILES_Y) ty1 = TILES_Y - 1;
+        for (int16_t ty = ty0; ty <= ty1; ty++) {
+            for (int16_t tx = tx0; tx <= tx1; tx++) {
+                uint16_t t = ty * TILES_X + tx;
+                self->_dirty[t >> 5] |= 1UL << (t & 31);
+            }
+        }
+    }
+    portEXIT_CRITICAL(&dirtyMux);
+    LoopScheduler::instance().wake();
+}
+
+size_t ScreenMirror::encodeFrame(uint8_t* out, size_t capacity) {
+    uint8_t* p = out;
+    *p++ = DISPLAY_WIDTH & 0xFF;
+    *p++ = DISPLAY_WIDTH >> 8;
+    *p++ = DISPLAY_HEIGHT & 0xFF;
+    *p++ = DISPLAY_HEIGHT >> 8;
+    *p++ = DISPLAY_TILE_W;
+    *p++ = DISPLAY_TILE_H;
+    uint8_t* countField = p++;
+    uint8_t count = 0;
+    if (!_canvas) {
+        *countField = 0;
+        return p - out;
+    }
+
+    // 从上一帧停下的位置继续，画面持续变化时各块也都能轮到
+    for (uint16_t n = 0; n < TILE_COUNT; n++) {
+        uint16_t t = (_next + n) % TILE_COUNT;
+        if (!(_dirty[t >> 5] & (1UL << (t & 31)))) continue;
+
+        uint8_t tx = t % TILES_X;
+        uint8_t ty = t / TILES_X;
+        int16_t x = tx * DISPLAY_TILE_W;
+        int16_t y = ty * DISPLAY_TILE_H;
+        int16_t w = DISPLAY_WIDTH - x < DISPLAY_TILE_W ? DISPLAY_WIDTH - x : DISPLAY_TILE_W;
+        int16_t h = DISPLAY_HEIGHT - y < DISPLAY_TILE_H ? DISPLAY_HEIGHT - y : DISPLAY_TILE_H;
+        size_t rawSize = (size_t)w * h * 2;
+        size_t room = capacity - (p - out);
+        if (room < TILE_HEADER + 1) break;
+
+        // 先清标记再读，读出期间的绘制会随推送重新标记
+        portENTER_CRITICAL(&dirtyMux);
+        _dirty[t >> 5] &= ~(1UL << (t & 31));
+        portEXIT_CRITICAL(&dirtyMux);
+        for (int16_t row = 0; row < h; row++) {
+            _canvas->readPixels(x, y + row, w, _pixels + row * w);
+        }
+
+        uint8_t* data = p + TILE_HEADER;
+        size_t limit = room - TILE_HEADER;
+        size_t length = encodeTile(_pixels, (size_t)w * h, data, limit < rawSize ? limit : rawSize);
+        uint8_t encoding = TILE_QOI565;
+        if (length == 0 && rawSize <= limit) {
+            memcpy(data, _pixels, rawSize);
+            length = rawSize;
+            encoding = TILE_RAW;
+        }
+        if (length == 0) {
+            // 这一帧放不下，留到下一帧
+            portENTER_CRITICAL(&dirtyMux);
+            _dirty[t >> 5] |= 1UL << (t & 31);
+            portEXIT_CRITICAL(&dirtyMux);
+            _next = t;
+            break;
+        }
+        p[0] = tx;
+        p[1] = ty;
+        p[2] = encoding;
+        p[3] = length & 0xFF;
+        p[4] = length >> 8;
+        p = data + length;
+        _next = (t + 1) % TILE_COUNT;
+        tilesSent.add();
+        if (++count == UINT8_MAX) break;
+    }
+    *countField = count;
+    bytesSent.add(p - out);
+    return p - out;
+}
+
+size_t ScreenMirror::encodeTile(const uint16_t* pixels, size_t count, uint8_t* out, size_t capacity) {
+    uint16_t index[64];
+    memset(index, 0, sizeof(index));
+    uint16_t prev = 0;
+    uint8_t run = 0;
+    size_t n = 0;
+
+    // 每条操作最多3字节，写之前检查余量，超出时放弃压缩
+    for (size_t i = 0; i < count; i++) {
+        uint16_t px = pixels[i];
+        if (px == prev) {
+            if (++run == MAX_RUN) {
+                if (n + 1 > capacity) return 0;
+                out[n++] = OP_RUN | (run - 1);
+                run = 0;
+            }
+            continue;
+        }
+        if (n + 4 > capacity) return 0;
+        if (run) {
+            out[n++] = OP_RUN | (run - 1);
+            run = 0;
+        }
+
+        uint8_t slot = hash565(px);
+        if (index[slot] == px) {
+            out[n++] = OP_INDEX | slot;
+        } else {
+            index[slot] = px;
+            int dr = wrap(((px >> 11) & 0x1F) - ((prev >> 11) & 0x1F), 5);
+            int dg = wrap(((px >> 5) & 0x3F) - ((prev >> 5) & 0x3F), 6);
+            int db = wrap((px & 0x1F) - (prev & 0x1F), 5);
+            int drdg = wrap(dr - (dg >> 1), 5);
+            int dbdg = wrap(db - (dg >> 1), 5);
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                out[n++] = OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2);
+            } else if (drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7) {
+                out[n++] = OP_LUMA | (dg + 32);
+                out[n++] = ((drdg + 8) << 4) | (dbdg + 8);
+            } else {
+                out[n++] = OP_RGB;
+                out[n++] = px >> 8;
+                out[n++] = px & 0xFF;
+            }
+        }
+        prev = px;
+    }
+    if (run) {
+        if (n + 1 > capacity) return 0;
+        out[n++] = OP_RUN | (run - 1);
+    }
+    return n;
+}
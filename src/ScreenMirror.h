@@ -0,0 +1,97 @@
+/**
+ * @file ScreenMirror.h
+ * @brief 屏幕镜像：把Canvas的内容按块发送给主机（截图和实时镜像）
+ * @details 变化的区域来自Canvas推送面板时的区域（RegionCanvas::setRegionsCallback），
+ * 不另外比较画面：
+ * - 屏幕按 DISPLAY_TILE_W × DISPLAY_TILE_H 分块（同块哈希），推送区域覆盖的块标记为待发送
+ * - 实时镜像打开时才标记；截图或打开镜像时标记全部块
+ * - 主机通道每帧打包若干块，每块用QOI565压缩（格式同 tools/splash_pack.py），
+ *   压缩后更大时原样发送；一帧放不下的块留到下一帧
+ * - 块在读出前清除标记，读出时渲染任务正在画的块会随之后的推送再次标记，画面最终一致
+ *
+ * 一帧的格式（小端）：宽(2) | 高(2) | 块宽(1) | 块高(1) | 块数(1)，之后各块：
+ *     列(1) | 行(1) | 编码(1，TILE_QOI565或TILE_RAW) | 长度(2) | 数据
+ * 原样数据为逐行的RGB565（小端），边缘的块按实际宽高。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef SCREEN_MIRROR_H
+#define SCREEN_MIRROR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "DirtyRegions.h"
+
+class RegionCanvas;
+
+class ScreenMirror {
+public:
+    static const uint8_t TILE_QOI565 = 0;
+    static const uint8_t TILE_RAW = 1;
+    static const size_t FRAME_HEADER = 7;
+    static const size_t TILE_HEADER = 5;
+
+    static ScreenMirror& instance() {
+        static ScreenMirror instance;
+        return instance;
+    }
+
+    /**
+     * @brief 关联Canvas并注册推送区域回调，没有Canvas时截图和镜像不可用
+     */
+    void attach(RegionCanvas* canvas);
+
+    bool isAvailable() const { return _canvas != nullptr; }
+    bool isLive() const { return _live; }
+
+    /**
+     * @brief 打开或关闭实时镜像，打开时先发送整屏
+     */
+    void setLive(bool live);
+
+    /**
+     * @brief 标记全部块待发送（截图）
+     */
+    void requestAll();
+
+    /**
+     * @brief 是否有待发送的块
+     */
+    bool pending() const;
+
+    /**
+     * @brief 把待发送的块打包成一帧
+     * @param out 输出缓冲
+     * @param capacity 缓冲大小，至少放得下帧头和一个原样块
+     * @return 写入的字节数
+     */
+    size_t encodeFrame(uint8_t* out, size_t capacity);
+
+private:
+    static const uint16_t TILES_X = (DISPLAY_WIDTH + DISPLAY_TILE_W - 1) / DISPLAY_TILE_W;
+    static const uint16_t TILES_Y = (DISPLAY_HEIGHT + DISPLAY_TILE_H - 1) / DISPLAY_TILE_H;
+    static const uint16_t TILE_COUNT = TILES_X * TILES_Y;
+    static const uint16_t TILE_WORDS = (TILE_COUNT + 31) / 32;
+
+    ScreenMirror();
+    ScreenMirror(const ScreenMirror&) = delete;
+    ScreenMirror& operator=(const ScreenMirror&) = delete;
+
+    static void onRegions(const DirtyRegions& regions, void* ctx);
+    void markAll();
+
+    /**
+     * @brief QOI565压缩一块
+     * @return 压缩后的字节数，超过capacity时返回0
+     */
+    static size_t encodeTile(const uint16_t* pixels, size_t count, uint8_t* out, size_t capacity);
+
+    RegionCanvas* _canvas;
+    volatile bool _live;
+    uint32_t _dirty[TILE_WORDS];    ///< 待发送的块，推送区域回调（渲染任务）和主循环共用
+    uint16_t _next;                 ///< 下一帧从这一块开始找，各块轮流发送
+    uint16_t _pixels[DISPLAY_TILE_W * DISPLAY_TILE_H];
+};
+
+#endif // SCREEN_MIRROR_H
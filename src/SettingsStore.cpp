@@ -0,0 +1,251 @@
+/**
+ * @file SettingsStore.cpp
+ * @brief 设置镜像分区的实现
+ *
+ * @author Calculator Project
+ */
+
+#include "SettingsStore.h"
+#include "BufferPlacement.h"
+#include "Console.h"
+#include "CpuProfiler.h"
+#include "Logger.h"
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <stddef.h>
+#include <string.h>
+
+#define TAG_SETTINGS "Settings"
+
+namespace {
+
+void cmdSettings(const ConsoleArgs& args) {
+    SettingsStore::instance().printStatus();
+}
+
+constexpr ConsoleCommand SETTINGS_COMMANDS[] = {
+    {"settings", "", "显示设置镜像（分区、序号、各段大小）", cmdSettings},
+};
+static_assert(consoleSorted(SETTINGS_COMMANDS), "命令表必须按名称排序");
+
+const char* const SECTION_NAMES[] = {"", "配置", "按键布局", "按键统计", "内存寄存器", "汇率表"};
+static_assert(sizeof(SECTION_NAMES) / sizeof(SECTION_NAMES[0]) == SETTINGS_SECTION_END, "段名与SettingsSection不一致");
+
+size_t align4(size_t n) {
+    return (n + 3) & ~(size_t)3;
+}
+
+const esp_partition_t* partitionOf(const void* partition) {
+    return static_cast<const esp_partition_t*>(partition);
+}
+
+} // namespace
+
+SettingsStore::SettingsStore()
+    : _partition(nullptr),
+      _mmapHandle(0),
+      _base(nullptr),
+      _slotCount(0),
+      _current(nullptr),
+      _currentSlot(0),
+      _loadUs(0),
+      _writes(0) {
+    static_assert(sizeof(Header) == 20 && sizeof(Entry) == 8, "镜像头部布局已改变，需要提高VERSION");
+}
+
+bool SettingsStore::begin() {
+    if (_base) return true;
+    Console::instance().addCommands(SETTINGS_COMMANDS);
+
+    uint32_t start = micros();
+    const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                                SETTINGS_PARTITION_LABEL);
+    if (!partition || partition->size < SETTINGS_SLOT_BYTES * 2) {
+        LOG_E(TAG_SETTINGS, "没有settings分区，设置不会保存");
+        return false;
+    }
+    const void* mapped;
+    spi_flash_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &mapped, &handle);
+    if (err != ESP_OK) {
+        LOG_E(TAG_SETTINGS, "分区映射失败: %s", esp_err_to_name(err));
+        return false;
+    }
+    _partition = partition;
+    _mmapHandle = handle;
+    _base = static_cast<const uint8_t*>(mapped);
+    _slotCount = partition->size / SETTINGS_SLOT_BYTES;
+
+    // 只比较各扇区头部的序号，从最新的开始做CRC校验，第一个通过的就是当前镜像
+    bool bounded = false;
+    uint32_t bound = 0;
+    for (;;) {
+        const Header* newest = nullptr;
+        uint32_t newestSlot = 0;
+        for (uint32_t i = 0; i < _slotCount; i++) {
+            const Header* header = slot(i);
+            if (header->magic != MAGIC || header->version != VERSION) continue;
+            if (bounded && (int32_t)(header->sequence - bound) >= 0) continue;
+            if (!newest || (int32_t)(header->sequence - newest->sequence) > 0) {
+                newest = header;
+                newestSlot = i;
+            }
+        }
+        if (!newest) break;
+        if (isValid(newest)) {
+            _current = newest;
+            _currentSlot = newestSlot;
+            break;
+        }
+        LOG_W(TAG_SETTINGS, "镜像 %lu（扇区%lu）校验失败，使用上一个", (unsigned long)newest->sequence,
+              (unsigned long)newestSlot);
+        bounded = true;
+        bound = newest->sequence;
+    }
+    _loadUs = micros() - start;
+
+    if (_current) {
+        LOG_I(TAG_SETTINGS, "设置镜像 %lu: %u 段，%lu 字节，%lu us", (unsigned long)_current->sequence,
+              _current->sectionCount, (unsigned long)_current->size, (unsigned long)_loadUs);
+    } else {
+        LOG_I(TAG_SETTINGS, "没有设置镜像，从NVS迁移或使用默认值");
+    }
+    return true;
+}
+
+const SettingsStore::Header* SettingsStore::slot(uint32_t index) const {
+    return reinterpret_cast<const Header*>(_base + index * SETTINGS_SLOT_BYTES);
+}
+
+bool SettingsStore::isValid(const Header* header) const {
+    if (header->magic != MAGIC || header->version != VERSION || header->sectionCount > MAX_SECTIONS) return false;
+    size_t directory = sizeof(Header) + header->sectionCount * sizeof(Entry);
+    if (header->size < directory || header->size > SETTINGS_SLOT_BYTES) return false;
+    const Entry* entries = reinterpret_cast<const Entry*>(header + 1);
+    for (uint8_t i = 0; i < header->sectionCount; i++) {
+        if (entries[i].offset < directory || entries[i].offset + entries[i].length > header->size) return false;
+    }
+    return imageCrc(header) == header->crc;
+}
+
+uint32_t SettingsStore::imageCrc(const Header* header) {
+    uint32_t crc = esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(header), offsetof(Header, crc));
+    return esp_rom_crc32_le(crc, reinterpret_cast<const uint8_t*>(header + 1), header->size - sizeof(Header));
+}
+
+const void* SettingsStore::find(SettingsSection id, size_t& length) const {
+    if (!_current) return nullptr;
+    const Entry* entries = reinterpret_cast<const Entry*>(_current + 1);
+    for (uint8_t i = 0; i < _current->sectionCount; i++) {
+        if (entries[i].id == id) {
+            length = entries[i].length;
+            return reinterpret_cast<const uint8_t*>(_current) + entries[i].offset;
+        }
+    }
+    return nullptr;
+}
+
+bool SettingsStore::write(SettingsSection id, const void* data, size_t length) {
+    if (!_base) return false;
+    if (length > 0xFFFF || (length && !data)) return false;
+
+    // 其余段从当前镜像（映射区）复制，在擦除下一个扇区之前拼好
+    const void* sources[MAX_SECTIONS];
+    size_t lengths[MAX_SECTIONS];
+    uint8_t ids[MAX_SECTIONS];
+    uint8_t count = 0;
+    for (uint8_t s = SETTINGS_CONFIG; s < SETTINGS_SECTION_END; s++) {
+        size_t sectionLength = 0;
+        const void* source = nullptr;
+        if (s == id) {
+            source = data;
+            sectionLength = length;
+        } else {
+            source = find((SettingsSection)s, sectionLength);
+            if (!source) continue;
+        }
+        ids[count] = s;
+        sources[count] = source;
+        lengths[count] = sectionLength;
+        count++;
+    }
+
+    size_t size = align4(sizeof(Header) + count * sizeof(Entry));
+    for (uint8_t i = 0; i < count; i++) {
+        size = align4(size + lengths[i]);
+    }
+    if (size > SETTINGS_SLOT_BYTES) {
+        LOG_E(TAG_SETTINGS, "设置镜像 %u 字节，超过扇区大小", (unsigned)size);
+        return false;
+    }
+
+    uint8_t* image = static_cast<uint8_t*>(placedAlloc("settings", size, PLACE_INTERNAL));
+    if (!image) {
+        LOG_E(TAG_SETTINGS, "内存不足，设置未保存");
+        return false;
+    }
+    memset(image, 0, size);
+    Header* header = reinterpret_cast<Header*>(image);
+    Entry* entries = reinterpret_cast<Entry*>(header + 1);
+    size_t offset = align4(sizeof(Header) + count * sizeof(Entry));
+    for (uint8_t i = 0; i < count; i++) {
+        entries[i].id = ids[i];
+        entries[i].length = (uint16_t)lengths[i];
+        entries[i].offset = offset;
+        if (lengths[i]) memcpy(image + offset, sources[i], lengths[i]);
+        offset = align4(offset + lengths[i]);
+    }
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->sectionCount = count;
+    header->sequence = _current ? _current->sequence + 1 : 1;
+    header->size = size;
+    header->crc = imageCrc(header);
+
+    // 写到下一个扇区，当前镜像保持不动：掉电时启动仍能找到它
+    const esp_partition_t* partition = partitionOf(_partition);
+    uint32_t target = _current ? (_currentSlot + 1) % _slotCount : 0;
+    uint32_t sequence = header->sequence;
+    esp_err_t err;
+    {
+        PROFILE_SCOPE(PROFILE_SETTINGS_WRITE);
+        err = esp_partition_erase_range(partition, target * SETTINGS_SLOT_BYTES, SETTINGS_SLOT_BYTES);
+        if (err == ESP_OK) err = esp_partition_write(partition, target * SETTINGS_SLOT_BYTES, image, size);
+    }
+    placedFree(image);
+
+    // 写入后经映射区重新校验（IDF在写闪存后清除映射区的缓存）
+    const Header* written = slot(target);
+    if (err != ESP_OK || written->sequence != sequence || !isValid(written)) {
+        LOG_E(TAG_SETTINGS, "设置写入失败: %s", esp_err_to_name(err));
+        return false;
+    }
+    _current = written;
+    _currentSlot = target;
+    _writes++;
+    LOG_D(TAG_SETTINGS, "设置镜像 %lu 已写入扇区%lu", (unsigned long)sequence, (unsigned long)target);
+    return true;
+}
+
+void SettingsStore::printStatus() const {
+    Serial.println("=== 设置镜像 ===");
+    if (!_base) {
+        Serial.println("没有settings分区");
+        return;
+    }
+    const esp_partition_t* partition = partitionOf(_partition);
+    Serial.printf("分区: 0x%06lX，%lu KB，%lu 个扇区轮流写入\n", (unsigned long)partition->address,
+                  (unsigned long)(partition->size / 1024), (unsigned long)_slotCount);
+    Serial.printf("启动时查找和校验: %lu us，本次启动写入 %lu 次\n", (unsigned long)_loadUs, (unsigned long)_writes);
+    if (!_current) {
+        Serial.println("没有有效镜像");
+        return;
+    }
+    Serial.printf("当前镜像: 序号 %lu，扇区%lu，%lu 字节\n", (unsigned long)_current->sequence,
+                  (unsigned long)_currentSlot, (unsigned long)_current->size);
+    const Entry* entries = reinterpret_cast<const Entry*>(_current + 1);
+    for (uint8_t i = 0; i < _current->sectionCount; i++) {
+        const char* name = entries[i].id < SETTINGS_SECTION_END ? SECTION_NAMES[entries[i].id] : "?";
+        Serial.printf("  %-10s %5u 字节%s\n", name, entries[i].length, entries[i].length ? "" : "（已迁移，没有数据）");
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file SettingsStore.h
+ * @brief 全部持久化设置合为一个镜像，存放在单独的闪存分区，启动时映射后一次校验
+ * @details 之前启动时打开两个NVS命名空间（pawcounter、keyboard_cfg），逐个探测、读取约20个键。
+ * 现在设备配置、按键布局、按键统计、内存寄存器和汇率表都是同一个镜像中的段：
+ * - 分区（partitions.csv中的settings）用esp_partition_mmap整体映射到数据地址空间，
+ *   find()返回指向映射区的指针，读取就是解引用，不经过NVS的页表查找
+ * - 启动时只看每个扇区的头部，取序号最大的镜像做一次CRC校验；校验失败时退到上一个
+ * - 每个镜像占一个扇区（SETTINGS_SLOT_BYTES），写入时整个镜像写到下一个扇区，
+ *   分区内的扇区轮流使用（磨损均衡）；写到一半掉电时上一个镜像仍完整
+ * - 镜像中没有的段（旧固件的数据还在NVS）由各管理器从NVS读出后写入，之后不再打开NVS；
+ *   长度为0的段表示“已迁移、没有数据”
+ *
+ * 镜像格式（小端，4字节对齐）：
+ *     Header | Entry × sectionCount | 各段数据（按4字节对齐）
+ * CRC32覆盖头部crc之前的字段和头部之后的全部内容。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * @brief 镜像中的段
+ */
+enum SettingsSection : uint8_t {
+    SETTINGS_CONFIG = 1,        ///< ConfigBlob（ConfigManager）
+    SETTINGS_LAYOUT,            ///< 按键布局（KeyboardConfigManager的保存格式）
+    SETTINGS_KEY_STATS,         ///< KeyStatsData
+    SETTINGS_MEMORY,            ///< MemoryRegisterData
+    SETTINGS_CURRENCY,          ///< CurrencyTableData（按汇率条数截短）
+    SETTINGS_SECTION_END
+};
+
+class SettingsStore {
+public:
+    static const uint32_t MAGIC = 0x54534350;       ///< "PCST"
+    static const uint16_t VERSION = 1;
+    static const uint8_t MAX_SECTIONS = SETTINGS_SECTION_END - 1;
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint8_t sectionCount;
+        uint8_t reserved;
+        uint32_t sequence;          ///< 每次写入加一，启动时取最大的有效镜像
+        uint32_t size;              ///< 头部、目录和数据的总字节数
+        uint32_t crc;
+    };
+
+    struct Entry {
+        uint8_t id;                 ///< SettingsSection
+        uint8_t reserved;
+        uint16_t length;            ///< 数据字节数，0表示已迁移、没有数据
+        uint32_t offset;            ///< 数据相对镜像开头的偏移
+    };
+
+    static SettingsStore& instance() {
+        static SettingsStore instance;
+        return instance;
+    }
+
+    /**
+     * @brief 映射分区并找出最新的有效镜像，注册串口命令
+     * @return 没有settings分区或映射失败时返回false，之后find()都返回nullptr、write()都失败
+     */
+    bool begin();
+
+    /**
+     * @brief 查找段
+     * @param length 输出数据字节数
+     * @return 指向映射区的数据（只读，下一次write()之前有效）；镜像中没有这一段时返回nullptr
+     */
+    const void* find(SettingsSection id, size_t& length) const;
+
+    /**
+     * @brief 替换一个段（其余段原样保留），新镜像立即写入下一个扇区
+     * @param length 可以为0（标记为已迁移、没有数据）
+     */
+    bool write(SettingsSection id, const void* data, size_t length);
+
+    bool isReady() const { return _base != nullptr; }
+    bool hasImage() const { return _current != nullptr; }
+
+    void printStatus() const;
+
+private:
+    SettingsStore();
+
+    const Header* slot(uint32_t index) const;
+    bool isValid(const Header* header) const;
+    static uint32_t imageCrc(const Header* header);
+
+    const void* _partition;         ///< esp_partition_t
+    uint32_t _mmapHandle;
+    const uint8_t* _base;           ///< 映射区开头
+    uint32_t _slotCount;
+    const Header* _current;         ///< 最新的有效镜像，没有时为nullptr
+    uint32_t _currentSlot;
+    uint32_t _loadUs;               ///< 启动时查找和校验的耗时
+    uint32_t _writes;               ///< 本次启动写入的次数
+};
+
+#endif // SETTINGS_STORE_H
@@ -8,43 +8,279 @@
 
 #include "SimpleHID.h"
 #include "Logger.h"
+#include "KeyboardConfig.h"
+#include "LayoutKeys.h"
+#include "Console.h"
+#include "CoRunner.h"
+#include "LoopScheduler.h"
+#include "LatencyProbe.h"
+#include <esp_timer.h>
+#include "esp32-hal-tinyusb.h"
+#include <driver/gpio.h>
 
 #define TAG_HID "SimpleHID"
 
-// 物理按键 -> USB HID Usage (十六进制)
-// 参考 KeyboardConfig.cpp 主层定义
-// 使用数字小键盘键码，方便在主机侧直接输入数字 / 运算符
-const uint8_t SimpleHID::_keyMapping[22] = {
-    0x00,  // 1  POWER        -> 无 HID 输出
-    0x37,  // 2  "7"          -> ASCII '7'
-    0x34,  // 3  "4"          -> ASCII '4'
-    0x31,  // 4  "1"          -> ASCII '1'
-    0x30,  // 5  "0"          -> ASCII '0'
-    0x09,  // 6  TAB           -> ASCII Tab
-    0x38,  // 7  "8"          -> ASCII '8'
-    0x35,  // 8  "5"          -> ASCII '5'
-    0x32,  // 9  "2"          -> ASCII '2'
-    0x25,  // 10 "%"          -> ASCII '%'
-    0x39,  // 11 "9"          -> ASCII '9'
-    0x36,  // 12 "6"          -> ASCII '6'
-    0x33,  // 13 "3"          -> ASCII '3'
-    0x2E,  // 14 "."          -> ASCII '.'
-    0x08,  // 15 Backspace     -> ASCII Backspace
-    0x2A,  // 16 "×"(乘号)    -> ASCII '*'
-    0x2D,  // 17 "-"          -> ASCII '-'
-    0x2B,  // 18 "+"          -> ASCII '+'
-    0x43,  // 19 "C"(Clear)   -> ASCII 'C'
-    0x00,  // 20 "±"          -> 无映射
-    0x2F,  // 21 "÷"          -> ASCII '/'
-    0x3D   // 22 "="          -> ASCII '='
+#define HID_SHIFT 0x80          // _asciiUsage中表示需要Shift
+#define HID_MOD_LEFT_SHIFT 0x02
+
+// NKRO报告描述符：8个修饰键位 + Usage 0x00-0x7F 的位图
+static const uint8_t _reportDescriptor[] = {
+    0x05, 0x01,                     // Usage Page (Generic Desktop)
+    0x09, 0x06,                     // Usage (Keyboard)
+    0xA1, 0x01,                     // Collection (Application)
+    0x85, SimpleHID::NKRO_REPORT_ID, //   Report ID
+    0x05, 0x07,                     //   Usage Page (Keyboard/Keypad)
+    0x19, 0xE0,                     //   Usage Minimum (Left Control)
+    0x29, 0xE7,                     //   Usage Maximum (Right GUI)
+    0x15, 0x00,                     //   Logical Minimum (0)
+    0x25, 0x01,                     //   Logical Maximum (1)
+    0x75, 0x01,                     //   Report Size (1)
+    0x95, 0x08,                     //   Report Count (8)
+    0x81, 0x02,                     //   Input (Data, Variable, Absolute)
+    0x19, 0x00,                     //   Usage Minimum (0)
+    0x29, SimpleHID::NKRO_USAGE_COUNT - 1, //   Usage Maximum
+    0x95, SimpleHID::NKRO_USAGE_COUNT,     //   Report Count
+    0x81, 0x02,                     //   Input (Data, Variable, Absolute)
+    0x05, 0x08,                     //   Usage Page (LEDs)：主机的锁定状态（输出报告）
+    0x19, 0x01,                     //   Usage Minimum (Num Lock)
+    0x29, 0x05,                     //   Usage Maximum (Kana)
+    0x95, 0x05,                     //   Report Count (5)
+    0x91, 0x02,                     //   Output (Data, Variable, Absolute)
+    0x95, 0x01,                     //   Report Count (1)
+    0x75, 0x03,                     //   Report Size (3)
+    0x91, 0x01,                     //   Output (Constant) 填充
+    0xC0,                           // End Collection
+
+    // 消费者控制：同时最多CONSUMER_USAGE_SLOTS个16位Usage
+    0x05, 0x0C,                     // Usage Page (Consumer)
+    0x09, 0x01,                     // Usage (Consumer Control)
+    0xA1, 0x01,                     // Collection (Application)
+    0x85, SimpleHID::CONSUMER_REPORT_ID, //   Report ID
+    0x15, 0x00,                     //   Logical Minimum (0)
+    0x26, 0xFF, 0x03,               //   Logical Maximum (0x3FF)
+    0x19, 0x00,                     //   Usage Minimum (0)
+    0x2A, 0xFF, 0x03,               //   Usage Maximum (0x3FF)
+    0x75, 0x10,                     //   Report Size (16)
+    0x95, SimpleHID::CONSUMER_USAGE_SLOTS, //   Report Count
+    0x81, 0x00,                     //   Input (Data, Array, Absolute)
+    0xC0,                           // End Collection
+
+    // 系统控制：Power Down、Sleep、Wake Up 三个位
+    0x05, 0x01,                     // Usage Page (Generic Desktop)
+    0x09, 0x80,                     // Usage (System Control)
+    0xA1, 0x01,                     // Collection (Application)
+    0x85, SimpleHID::SYSTEM_REPORT_ID, //   Report ID
+    0x19, 0x81,                     //   Usage Minimum (System Power Down)
+    0x29, 0x83,                     //   Usage Maximum (System Wake Up)
+    0x15, 0x00,                     //   Logical Minimum (0)
+    0x25, 0x01,                     //   Logical Maximum (1)
+    0x75, 0x01,                     //   Report Size (1)
+    0x95, 0x03,                     //   Report Count (3)
+    0x81, 0x02,                     //   Input (Data, Variable, Absolute)
+    0x95, 0x05,                     //   Report Count (5)
+    0x81, 0x01,                     //   Input (Constant) 填充
+    0xC0                            // End Collection
+};
+
+// ASCII -> HID Usage（美式布局），HID_SHIFT表示需要Shift
+// 运算符使用小键盘的Usage，不需要Shift，也与NumLock无关
+static const uint8_t _asciiUsage[128] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,     // 0x00
+    0x2A, 0x2B, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00,     // 0x08 BS TAB LF
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,     // 0x10
+    0x00, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00, 0x00,     // 0x18 ESC
+    0x2C, 0x1E | HID_SHIFT, 0x34 | HID_SHIFT, 0x20 | HID_SHIFT,     // ' ' ! " #
+    0x21 | HID_SHIFT, 0x22 | HID_SHIFT, 0x24 | HID_SHIFT, 0x34,     // $ % & '
+    0x26 | HID_SHIFT, 0x27 | HID_SHIFT, 0x55, 0x57,                 // ( ) * +
+    0x36, 0x56, 0x37, 0x54,                                         // , - . /
+    0x27, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24,     // 0-7
+    0x25, 0x26, 0x33 | HID_SHIFT, 0x33,                 // 8 9 : ;
+    0x36 | HID_SHIFT, 0x2E, 0x37 | HID_SHIFT, 0x38 | HID_SHIFT,     // < = > ?
+    0x1F | HID_SHIFT,                                   // @
+    0x04 | HID_SHIFT, 0x05 | HID_SHIFT, 0x06 | HID_SHIFT, 0x07 | HID_SHIFT, 0x08 | HID_SHIFT,   // A-E
+    0x09 | HID_SHIFT, 0x0A | HID_SHIFT, 0x0B | HID_SHIFT, 0x0C | HID_SHIFT, 0x0D | HID_SHIFT,   // F-J
+    0x0E | HID_SHIFT, 0x0F | HID_SHIFT, 0x10 | HID_SHIFT, 0x11 | HID_SHIFT, 0x12 | HID_SHIFT,   // K-O
+    0x13 | HID_SHIFT, 0x14 | HID_SHIFT, 0x15 | HID_SHIFT, 0x16 | HID_SHIFT, 0x17 | HID_SHIFT,   // P-T
+    0x18 | HID_SHIFT, 0x19 | HID_SHIFT, 0x1A | HID_SHIFT, 0x1B | HID_SHIFT, 0x1C | HID_SHIFT,   // U-Y
+    0x1D | HID_SHIFT,                                   // Z
+    0x2F, 0x31, 0x30, 0x23 | HID_SHIFT, 0x2D | HID_SHIFT, 0x35,     // [ \ ] ^ _ `
+    0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D,     // a-j
+    0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,     // k-t
+    0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D,                             // u-z
+    0x2F | HID_SHIFT, 0x31 | HID_SHIFT, 0x30 | HID_SHIFT, 0x35 | HID_SHIFT, 0x00   // { | } ~ DEL
+};
+
+// 串口命令操作的实例（begin()时设置）
+static SimpleHID* s_consoleHID = nullptr;
+
+static void cmdHidStatus(const ConsoleArgs& args) {
+    Serial.println("=== 简单HID系统状态 ===");
+    if (args.is(1, "reset")) {
+        s_consoleHID->resetLatencyStats();
+        Serial.println(" - 延迟统计已清空");
+        return;
+    }
+    Serial.printf(" - HID功能: %s\n", s_consoleHID->isEnabled() ? "已启用" : "已禁用");
+    Serial.printf(" - USB连接: %s\n", !s_consoleHID->isUsbConnected() ? "未连接"
+                  : s_consoleHID->isUsbSuspended() ? "已连接（主机休眠）" : "已连接");
+    Serial.printf(" - 报告出口: %s\n", s_consoleHID->getTransport() == SimpleHID::TRANSPORT_BLE ? "BLE" : "USB");
+    Serial.printf(" - 功能模式: 并行模式（计算器+HID键盘同时生效）\n");
+    Serial.printf(" - GPIO19 (USB_DN): 自动配置为USB D-信号\n");
+    Serial.printf(" - GPIO20 (USB_DP): 自动配置为USB D+信号\n");
+    s_consoleHID->printDebugInfo();
+#if BLE_HID_ENABLED
+    BleHID::instance().printStatus();
+#endif
+}
+
+static void cmdHidMode(const ConsoleArgs& args) {
+    SimpleHID::Transport transport;
+    if (args.is(1, "usb")) {
+        transport = SimpleHID::TRANSPORT_USB;
+    } else if (args.is(1, "ble")) {
+        transport = SimpleHID::TRANSPORT_BLE;
+    } else {
+        Serial.printf("报告出口: %s。使用: hid_mode usb|ble\n",
+                      s_consoleHID->getTransport() == SimpleHID::TRANSPORT_BLE ? "BLE" : "USB");
+        return;
+    }
+    if (!s_consoleHID->setTransport(transport)) {
+        Serial.println("BLE不可用（未编译或蓝牙启动失败）");
+    } else {
+        Serial.printf("报告出口切换为 %s\n", args.arg(1));
+    }
+}
+
+// 按下后等待100 ms再松开，等待期间主循环照常运行（CoRunner.h）
+static uint32_t hidTestTask(CoTask& task) {
+    CO_BEGIN(task);
+    s_consoleHID->handleKey(task.arg, true);
+    s_consoleHID->flush();
+    CO_SLEEP(task, 100);
+    s_consoleHID->handleKey(task.arg, false);
+    s_consoleHID->flush();
+    Serial.println("HID按键测试完成");
+    CO_END(task);
+}
+
+static void cmdHidTest(const ConsoleArgs& args) {
+    int key;
+    if (!s_consoleHID->isEnabled()) {
+        Serial.println("HID功能未启用或未初始化");
+    } else if (!args.toInt(1, key)) {
+        Serial.println("无效的 'hid_test' 命令格式. 使用: hid_test <key>");
+    } else if (key < 1 || key > 22) {
+        Serial.println("按键编号必须在 1-22 之间");
+    } else {
+        if (CoRunner::instance().spawn("hid_test", hidTestTask, key)) {
+            Serial.printf("测试HID按键 %d 发送\n", key);
+        } else {
+            Serial.println("上一次HID测试尚未结束");
+        }
+    }
+}
+
+static void cmdHidType(const ConsoleArgs& args) {
+    if (!s_consoleHID->isEnabled()) {
+        Serial.println("HID功能未启用或未初始化");
+    } else if (s_consoleHID->sendMacro(args.tail)) {
+        Serial.println("宏已加入发送队列");
+    } else {
+        Serial.println("宏无效或队列已满");
+    }
+}
+
+static constexpr ConsoleCommand HID_COMMANDS[] = {
+    {"hid_mode", "[usb|ble]", "切换HID报告出口（USB或蓝牙键盘）", cmdHidMode},
+    {"hid_status", "[reset]", "显示简单HID状态和报告延迟（reset清空统计）", cmdHidStatus},
+    {"hid_test", "<key>", "测试HID按键发送", cmdHidTest},
+    {"hid_type", "<宏>", "通过HID输入宏序列，如 =SUM({RESULT}){ENTER}", cmdHidType},
 };
+static_assert(consoleSorted(HID_COMMANDS), "命令表必须按名称排序");
 
 SimpleHID::SimpleHID() 
     : _enabled(false)
     , _initialized(false)
-    , _pressedKeyCount(0) {
-    // 初始化按键数组
-    memset(_pressedKeys, 0, sizeof(_pressedKeys));
+    , _dirty(false)
+    , _unsentPress(0)
+    , _deferredRelease(0)
+    , _systemReport(0)
+    , _reportsSent(0)
+    , _pendingSince(0)
+    , _macroHead(0)
+    , _macroTail(0)
+    , _macroKey(0)
+    , _resultProvider(nullptr)
+    , _connectionCallback(nullptr)
+    , _connectionContext(nullptr)
+    , _suspendCallback(nullptr)
+    , _suspendContext(nullptr)
+    , _transport(TRANSPORT_USB)
+    , _nextTransport(TRANSPORT_USB)
+    , _hostLeds(0)
+    , _hostLedsPending(false)
+    , _publishedLeds(0xFF)
+    , _wakeupSent(false)
+    , _wakeupTime(0)
+    , _resumeWakeArmed(false)
+    , _txTask(nullptr) {
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    memset(_heldCodes, 0, sizeof(_heldCodes));
+    memset(_report, 0, sizeof(_report));
+    memset(_consumerReport, 0, sizeof(_consumerReport));
+    
+    // 描述符在USB.begin()时生成，设备必须在此之前注册
+    static bool registered = false;
+    if (!registered) {
+        registered = true;
+        USBHID::addDevice(this, sizeof(_reportDescriptor));
+    }
+}
+
+uint16_t SimpleHID::_onGetDescriptor(uint8_t* buffer) {
+    memcpy(buffer, _reportDescriptor, sizeof(_reportDescriptor));
+    return sizeof(_reportDescriptor);
+}
+
+void SimpleHID::_onOutput(uint8_t reportId, const uint8_t* buffer, uint16_t length) {
+    // USB任务中调用
+    if (reportId == NKRO_REPORT_ID && length >= 1 && _transport == TRANSPORT_USB) {
+        receiveHostLeds(buffer[0]);
+    }
+}
+
+void SimpleHID::bleOutputEntry(uint8_t reportId, const uint8_t* buffer, size_t length, void* context) {
+    // 蓝牙任务中调用
+    SimpleHID* hid = static_cast<SimpleHID*>(context);
+    if (reportId == NKRO_REPORT_ID && length >= 1 && hid->_transport == TRANSPORT_BLE) {
+        hid->receiveHostLeds(buffer[0]);
+    }
+}
+
+void SimpleHID::receiveHostLeds(uint8_t leds) {
+    // 主机每次都发送完整状态；只记下最新值，由主循环发布到事件总线
+    _hostLeds = leds;
+    _hostLedsPending = true;
+    LoopScheduler::instance().wake();
+}
+
+void SimpleHID::update() {
+    if (!_hostLedsPending) {
+        return;
+    }
+    _hostLedsPending = false;
+    uint8_t leds = _hostLeds;
+    if (leds == _publishedLeds) {
+        return;
+    }
+    _publishedLeds = leds;
+    LOG_D(TAG_HID, "主机LED: 0x%02X", leds);
+
+    KeyEvent event = {};
+    event.type = KEY_EVENT_HOST_LED;
+    event.key = leds;
+    event.timestamp = esp_timer_get_time();
+    KeyEventBus::instance().publish(event);
 }
 
 bool SimpleHID::begin() {
@@ -54,20 +290,87 @@ bool SimpleHID::begin() {
 
     LOG_I(TAG_HID, "初始化简单HID键盘功能");
 
-    // 初始化USB
+    // 初始化HID接口和USB
+    // 连接事件可能在USB.begin()返回前到达
+    s_consoleHID = this;
+    _hid.begin();
+    USB.onEvent(usbEventHandler);
     USB.begin();
     
-    // 初始化HID键盘
-    _keyboard.begin();
-    
     _initialized = true;
     _enabled = true;
+    Console::instance().addCommands(HID_COMMANDS);
+    KeyEventBus::instance().subscribe(KeySubscriber{"hid", KEY_EVENT_ALL_KEYS, KEY_STAGE_OUTPUT,
+                                                    keyEventEntry, flushEntry, this});
+
+#if HID_TX_TASK
+    if (xTaskCreatePinnedToCore(txTaskEntry, "hidTx", 4096, this,
+                                HID_TX_TASK_PRIO, &_txTask, HID_TX_TASK_CORE) != pdPASS) {
+        _txTask = nullptr;
+        LOG_W(TAG_HID, "HID发送任务创建失败，改为同步发送");
+    }
+#endif
     
-    LOG_I(TAG_HID, "HID键盘功能初始化完成");
+    LOG_I(TAG_HID, "HID键盘功能初始化完成 (NKRO)");
     return true;
 }
 
-bool SimpleHID::handleKey(uint8_t keyPosition, bool pressed) {
+void SimpleHID::usbEventHandler(void* arg, esp_event_base_t base, int32_t id, void* data) {
+    SimpleHID* hid = s_consoleHID;
+    if (base != ARDUINO_USB_EVENTS || !hid) return;
+
+    if (id == ARDUINO_USB_SUSPEND_EVENT || id == ARDUINO_USB_RESUME_EVENT) {
+        hid->_wakeupSent = false;
+        if (hid->_suspendCallback) {
+            hid->_suspendCallback(id == ARDUINO_USB_SUSPEND_EVENT, hid->_suspendContext);
+        }
+    }
+    if (id == ARDUINO_USB_RESUME_EVENT && hid->hasPending()) {
+        // 主机恢复：挂起期间的按键（包括唤醒主机的那次）立即发出
+        if (hid->_txTask) {
+            xTaskNotifyGive(hid->_txTask);
+        } else {
+            LoopScheduler::instance().wake();
+        }
+    }
+    if (!hid->_connectionCallback || hid->_transport != TRANSPORT_USB) return;
+
+    switch (id) {
+        case ARDUINO_USB_STARTED_EVENT:
+        case ARDUINO_USB_RESUME_EVENT:
+            hid->_connectionCallback(true, hid->_connectionContext);
+            break;
+        case ARDUINO_USB_STOPPED_EVENT:
+        case ARDUINO_USB_SUSPEND_EVENT:
+            hid->_connectionCallback(false, hid->_connectionContext);
+            break;
+        default:
+            break;
+    }
+}
+
+void SimpleHID::bleConnectionEntry(bool connected, void* context) {
+    SimpleHID* hid = static_cast<SimpleHID*>(context);
+    if (hid->_transport == TRANSPORT_BLE && hid->_connectionCallback) {
+        hid->_connectionCallback(connected, hid->_connectionContext);
+    }
+}
+
+void SimpleHID::keyEventEntry(const KeyEvent& event, void* context) {
+    // 回放的按键日志不输出到主机
+    if (event.flags & KEY_EVENT_FLAG_REPLAY) return;
+    // 长按和重复都当作按下，状态不变时handleKey()直接返回
+    static_cast<SimpleHID*>(context)->handleKey(event.key, event.type != KEY_EVENT_RELEASE, event.timestamp);
+}
+
+void SimpleHID::flushEntry(void* context) {
+    SimpleHID* hid = static_cast<SimpleHID*>(context);
+    if (hid->_enabled) {
+        hid->flush();
+    }
+}
+
+bool SimpleHID::handleKey(uint8_t keyPosition, bool pressed, int64_t scanTimestamp) {
     // 检查HID功能是否启用
     if (!_enabled || !_initialized) {
         return false;
@@ -79,130 +382,560 @@ bool SimpleHID::handleKey(uint8_t keyPosition, bool pressed) {
         return false;
     }
 
-    // 获取HID键码
-    uint8_t keyCode = getHIDKeyCode(keyPosition);
-    if (keyCode == 0) {
-        // 该按键无HID映射，忽略
+    // 宏按键：按下时把序列放入队列，释放不需要处理
+    uint8_t index = keyPosition - 1;
+    const KeyConfig* keyConfig = keyboardConfig.getActiveKeyConfig(keyPosition);
+    if (keyConfig && keyConfig->type == KeyType::MACRO && !_heldCodes[index]) {
+        if (pressed && !sendMacro(keyConfig->functionName)) {
+            LOG_W(TAG_HID, "宏队列已满，按键 %d 的宏未发送", keyPosition);
+        }
         return true;
     }
 
-    LOG_D(TAG_HID, "处理按键事件: 位置=%d, 按下=%s, HID码=0x%02X", 
+    // 获取HID键码：释放时用按下时的键码
+    uint16_t keyCode = pressed ? getHIDKeyCode(keyPosition) : _heldCodes[index];
+    if (keyCode == 0 || _heldCodes[index] == (pressed ? keyCode : 0)) {
+        // 该按键无HID映射，或状态没有变化（重复事件）
+        return true;
+    }
+
+    LOG_D(TAG_HID, "处理按键事件: 位置=%d, 按下=%s, HID码=0x%04X", 
           keyPosition, pressed ? "是" : "否", keyCode);
 
-    bool success = false;
+    uint32_t bit = 1UL << index;
+    portENTER_CRITICAL(&_lock);
     if (pressed) {
-        // 按键按下
-        success = addKey(keyCode);
-        if (success) {
-            _keyboard.press(keyCode);
-        }
+        _unsentPress |= bit;
+        _heldCodes[index] = keyCode;
+    } else if (_unsentPress & bit) {
+        // 按下和释放落在同一次更新里：等按下发出去再释放，否则主机看不到这次按键
+        _deferredRelease |= bit;
     } else {
-        // 按键释放
-        success = removeKey(keyCode);
-        if (success) {
-            _keyboard.release(keyCode);
+        _heldCodes[index] = 0;
+    }
+    _dirty = true;
+    if (!_pendingSince) {
+        _pendingSince = scanTimestamp ? scanTimestamp : esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&_lock);
+    return true;
+}
+
+void SimpleHID::passThroughEntry(uint8_t keyPosition, bool pressed, int64_t scanTimestamp, void* context) {
+    SimpleHID* hid = static_cast<SimpleHID*>(context);
+    if (!hid->_enabled || keyPosition < 1 || keyPosition > 22) return;
+    uint8_t index = keyPosition - 1;
+    uint32_t bit = 1UL << index;
+
+    portENTER_CRITICAL(&hid->_lock);
+    // 释放时清除原来的键码：切换前按下的键也能正常释放
+    uint16_t keyCode = pressed ? LAYOUT_PASSTHROUGH_CODES[index] : 0;
+    if (hid->_heldCodes[index] == keyCode) {
+        portEXIT_CRITICAL(&hid->_lock);
+        return;
+    }
+    if (pressed) {
+        hid->_unsentPress |= bit;
+        hid->_heldCodes[index] = keyCode;
+    } else if (hid->_unsentPress & bit) {
+        hid->_deferredRelease |= bit;
+    } else {
+        hid->_heldCodes[index] = 0;
+    }
+    hid->_dirty = true;
+    if (!hid->_pendingSince) {
+        hid->_pendingSince = scanTimestamp;
+    }
+    portEXIT_CRITICAL(&hid->_lock);
+    xTaskNotifyGive(hid->_txTask);
+}
+
+bool SimpleHID::flush() {
+    if (!_initialized || !hasPending()) {
+        return true;
+    }
+    if (_txTask) {
+        // 通知值在任务取走前会累加，发送期间的多次变化合并到后续报告
+        xTaskNotifyGive(_txTask);
+        return true;
+    }
+    bool sent = sendNext();
+    if (hasPending()) {
+        // 端点忙或宏未发完，下一个毫秒继续；主机休眠时等恢复事件
+        bool suspended = _transport == TRANSPORT_USB && tud_suspended();
+        LoopScheduler::instance().after(suspended ? HID_RESUME_WAIT_MS : 1);
+    }
+    return sent;
+}
+
+void SimpleHID::txTaskEntry(void* arg) {
+    SimpleHID* self = static_cast<SimpleHID*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 每次提交都等主机取走，宏的速度只受主机轮询间隔限制
+        while (self->hasPending()) {
+            if (!self->sendNext()) {
+                if (self->_transport == TRANSPORT_USB && tud_suspended()) {
+                    // 主机休眠：等恢复事件或新的按键，不按毫秒空转
+                    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(HID_RESUME_WAIT_MS));
+                } else {
+                    // 端点忙或USB未连接，稍后重试
+                    vTaskDelay(1);
+                }
+            }
+        }
+    }
+}
+
+bool SimpleHID::sendNext() {
+    if (_transport != _nextTransport && !isConnected()) {
+        // 原来的出口未连接，主机那边没有按下的键，直接切换
+        switchTransport();
+    }
+
+    // 端点忙说明上一个报告还没被主机取走，变化留到下一次一起发送
+    if (!transportReady()) {
+        // 主机休眠时端点不会就绪；不能拉低MISO的按键在这里才请求远程唤醒
+        requestRemoteWakeup();
+        return false;
+    }
+
+    uint8_t report[NKRO_REPORT_SIZE];
+    uint16_t consumer[CONSUMER_USAGE_SLOTS];
+    uint8_t system;
+    portENTER_CRITICAL(&_lock);
+    // 按键变化优先发送，没有时宏前进一步
+    if (!_dirty) {
+        advanceMacro();
+    }
+    buildReport(report);
+    buildControlReports(consumer, system);
+    uint32_t unsent = _unsentPress;
+    uint32_t released = _deferredRelease;
+    int64_t pendingSince = _pendingSince;
+    _dirty = false;
+    _unsentPress = 0;
+    _pendingSince = 0;
+    portEXIT_CRITICAL(&_lock);
+
+    // 键盘报告先发；已发出的报告更新了上次内容，失败后重试时不会重复发送
+    int64_t latencyFrom = pendingSince;
+    if (!sendIfChanged(NKRO_REPORT_ID, report, _report, sizeof(report), latencyFrom) ||
+        !sendIfChanged(CONSUMER_REPORT_ID, consumer, _consumerReport, sizeof(consumer), latencyFrom) ||
+        !sendIfChanged(SYSTEM_REPORT_ID, &system, &_systemReport, sizeof(system), latencyFrom)) {
+        portENTER_CRITICAL(&_lock);
+        _dirty = true;
+        _unsentPress |= unsent;
+        if (!_pendingSince) {
+            _pendingSince = pendingSince;
+        }
+        portEXIT_CRITICAL(&_lock);
+        return false;
+    }
+
+    if (released) {
+        // 按下已经发出，补上推迟的释放，延迟仍从原来的扫描时刻算起
+        portENTER_CRITICAL(&_lock);
+        for (uint8_t i = 0; i < 22; i++) {
+            if (released & (1UL << i)) {
+                _heldCodes[i] = 0;
+            }
+        }
+        _deferredRelease &= ~released;
+        _dirty = true;
+        if (!_pendingSince) {
+            _pendingSince = pendingSince;
+        }
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    if (_transport != _nextTransport && !_dirty && !isMacroActive()) {
+        // 释放报告已在原来的出口发出
+        switchTransport();
+    }
+    return true;
+}
+
+bool SimpleHID::transportReady() {
+#if BLE_HID_ENABLED
+    if (_transport == TRANSPORT_BLE) {
+        return BleHID::instance().ready();
+    }
+#endif
+    return _hid.ready();
+}
+
+bool SimpleHID::setTransport(Transport transport) {
+    if (!_initialized) {
+        return false;
+    }
+    if (transport == TRANSPORT_BLE) {
+#if BLE_HID_ENABLED
+        static const uint8_t reportIds[] = {NKRO_REPORT_ID, CONSUMER_REPORT_ID, SYSTEM_REPORT_ID};
+        if (!BleHID::instance().begin(_reportDescriptor, sizeof(_reportDescriptor), reportIds, sizeof(reportIds),
+                                      NKRO_REPORT_ID)) {
+            return false;
+        }
+        BleHID::instance().setConnectionCallback(bleConnectionEntry, this);
+        BleHID::instance().setOutputCallback(bleOutputEntry, this);
+#else
+        return false;
+#endif
+    }
+    if (transport == _nextTransport) {
+        return true;
+    }
+
+    // 释放全部按键和未发完的宏，发出后由sendNext()切换
+    portENTER_CRITICAL(&_lock);
+    memset(_heldCodes, 0, sizeof(_heldCodes));
+    _unsentPress = 0;
+    _deferredRelease = 0;
+    _macroHead = _macroTail = 0;
+    _macroKey = 0;
+    _dirty = true;
+    _nextTransport = transport;
+    portEXIT_CRITICAL(&_lock);
+    LOG_I(TAG_HID, "HID报告出口切换为%s", transport == TRANSPORT_BLE ? "BLE" : "USB");
+    flush();
+    return true;
+}
+
+void SimpleHID::switchTransport() {
+    _transport = _nextTransport;
+    // 锁定状态以新出口的主机为准，收到它的输出报告后再发布
+    _publishedLeds = 0xFF;
+    // 新出口的主机上没有按下的键
+    memset(_report, 0, sizeof(_report));
+    memset(_consumerReport, 0, sizeof(_consumerReport));
+    _systemReport = 0;
+    if (_connectionCallback) {
+        _connectionCallback(isConnected(), _connectionContext);
+    }
+}
+
+bool SimpleHID::sendIfChanged(uint8_t reportId, const void* report, void* last, size_t size,
+                              int64_t& pendingSince) {
+    if (memcmp(report, last, size) == 0) {
+        return true;
+    }
+
+    // SendReport()等到主机取走报告（tud_hid_report_complete_cb）才返回
+    int64_t submitted = esp_timer_get_time();
+    LATENCY_MARK(LATENCY_POINT_HID_SUBMIT);
+#if BLE_HID_ENABLED
+    // BLE通知交给控制器即返回，在下一个连接事件发出
+    bool sent = _transport == TRANSPORT_BLE ? BleHID::instance().send(reportId, report, size)
+                                            : _hid.SendReport(reportId, report, size);
+#else
+    bool sent = _hid.SendReport(reportId, report, size);
+#endif
+    if (!sent) {
+        LOG_W(TAG_HID, "HID报告 %d 发送失败", reportId);
+        return false;
+    }
+    int64_t completed = esp_timer_get_time();
+    if (pendingSince) {
+        _submitLatency.record((uint32_t)(submitted - pendingSince));
+        _completeLatency.record((uint32_t)(completed - pendingSince));
+        pendingSince = 0;
+    }
+    memcpy(last, report, size);
+    _reportsSent++;
+    return true;
+}
+
+void SimpleHID::buildControlReports(uint16_t* consumer, uint8_t& system) const {
+    memset(consumer, 0, CONSUMER_USAGE_SLOTS * sizeof(uint16_t));
+    system = 0;
+    uint8_t slots = 0;
+    for (uint8_t i = 0; i < 22; i++) {
+        uint16_t usage = _heldCodes[i] & ~HID_CODE_PAGE_MASK;
+        switch (_heldCodes[i] & HID_CODE_PAGE_MASK) {
+            case HID_CODE_CONSUMER:
+                // 数组报告：超出的按键忽略
+                if (slots < CONSUMER_USAGE_SLOTS) {
+                    consumer[slots++] = usage;
+                }
+                break;
+            case HID_CODE_SYSTEM:
+                if (usage >= 0x81 && usage <= 0x83) {
+                    system |= 1 << (usage - 0x81);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void SimpleHID::buildReport(uint8_t* report) const {
+    memset(report, 0, NKRO_REPORT_SIZE);
+    for (uint8_t i = 0; i <= 22; i++) {
+        // 最后一项是宏当前按下的键
+        uint16_t keyCode = i < 22 ? _heldCodes[i] : _macroKey;
+        uint8_t usage, modifiers;
+        if (keyCode && toUsage(keyCode, usage, modifiers)) {
+            report[0] |= modifiers;
+            if (usage) {
+                report[1 + usage / 8] |= 1 << (usage % 8);
+            }
+        }
+    }
+}
+
+namespace {
+
+struct MacroToken {
+    const char* name;
+    uint8_t keyCode;
+};
+
+// 键码同Keyboard.press()：0x88 + HID Usage
+const MacroToken MACRO_TOKENS[] = {
+    {"TAB", 0xB3}, {"ENTER", 0xB0}, {"ESC", 0xB1}, {"BS", 0xB2}, {"DEL", 0xD4},
+    {"UP", 0xDA}, {"DOWN", 0xD9}, {"LEFT", 0xD8}, {"RIGHT", 0xD7}, {"F2", 0xC3},
+};
+
+} // namespace
+
+bool SimpleHID::pushMacroKey(uint16_t& head, uint8_t keyCode) {
+    if ((uint16_t)(head - _macroTail) >= MACRO_QUEUE_SIZE) {
+        return false;
+    }
+    _macroQueue[head & (MACRO_QUEUE_SIZE - 1)] = keyCode;
+    head++;
+    return true;
+}
+
+bool SimpleHID::sendMacro(const char* macro) {
+    if (!macro || !_enabled || !_initialized) {
+        return false;
+    }
+
+    // 先写到队列尾部之后，整个序列展开成功才提交
+    uint16_t head = _macroHead;
+    for (const char* p = macro; *p; p++) {
+        if (*p != '{') {
+            // 非ASCII字符（UTF-8）无法用键码输入，跳过
+            if ((uint8_t)*p < 0x80 && !pushMacroKey(head, *p)) return false;
+            continue;
+        }
+        if (p[1] == '{') {
+            if (!pushMacroKey(head, '{')) return false;
+            p++;
+            continue;
+        }
+
+        const char* end = strchr(p, '}');
+        if (!end) {
+            LOG_W(TAG_HID, "宏缺少 '}': %s", macro);
+            return false;
+        }
+        size_t length = end - p - 1;
+        if (length == 6 && strncmp(p + 1, "RESULT", 6) == 0) {
+            char text[32];
+            size_t count = _resultProvider ? _resultProvider(text, sizeof(text)) : 0;
+            for (size_t i = 0; i < count && text[i]; i++) {
+                if (!pushMacroKey(head, text[i])) return false;
+            }
+        } else {
+            uint8_t keyCode = 0;
+            for (const MacroToken& token : MACRO_TOKENS) {
+                if (strlen(token.name) == length && strncmp(p + 1, token.name, length) == 0) {
+                    keyCode = token.keyCode;
+                    break;
+                }
+            }
+            if (!keyCode) {
+                LOG_W(TAG_HID, "未知的宏键: %.*s", (int)length, p + 1);
+                return false;
+            }
+            if (!pushMacroKey(head, keyCode)) return false;
         }
+        p = end;
     }
 
-    return success;
+    portENTER_CRITICAL(&_lock);
+    _macroHead = head;
+    portEXIT_CRITICAL(&_lock);
+    return true;
+}
+
+void SimpleHID::advanceMacro() {
+    uint8_t next = _macroHead != _macroTail ? _macroQueue[_macroTail & (MACRO_QUEUE_SIZE - 1)] : 0;
+    if (_macroKey && next) {
+        // Usage不同且修饰键相同时，释放当前键和按下下一个键放在同一个报告里
+        uint8_t usage, modifiers, nextUsage, nextModifiers;
+        bool overlap = toUsage(_macroKey, usage, modifiers) && toUsage(next, nextUsage, nextModifiers) &&
+                       usage != nextUsage && modifiers == nextModifiers;
+        if (!overlap) {
+            next = 0;
+        }
+    }
+    if (next) {
+        _macroTail++;
+    }
+    _macroKey = next;
+    _dirty = true;
+}
+
+bool SimpleHID::toUsage(uint16_t keyCode, uint8_t& usage, uint8_t& modifiers) {
+    usage = 0;
+    modifiers = 0;
+    if (keyCode & HID_CODE_PAGE_MASK) {
+        // 消费者控制和系统控制键不在键盘报告中
+        return false;
+    } else if (keyCode >= 0x88) {
+        // 特殊键：0x88 + HID Usage
+        usage = keyCode - 0x88;
+    } else if (keyCode >= 0x80) {
+        // 修饰键
+        modifiers = 1 << (keyCode - 0x80);
+        return true;
+    } else {
+        usage = _asciiUsage[keyCode] & ~HID_SHIFT;
+        if (_asciiUsage[keyCode] & HID_SHIFT) {
+            modifiers = HID_MOD_LEFT_SHIFT;
+        }
+    }
+    return usage != 0 && usage < NKRO_USAGE_COUNT;
 }
 
 bool SimpleHID::isConnected() const {
+#if BLE_HID_ENABLED
+    if (_transport == TRANSPORT_BLE) {
+        return BleHID::instance().isConnected();
+    }
+#endif
+    return isUsbConnected();
+}
+
+bool SimpleHID::isUsbConnected() const {
     // 检查USB是否已连接 (Arduino-ESP32 TinyUSB 提供 connected())
     return (bool)USB;
 }
 
+bool SimpleHID::isUsbSuspended() const {
+    return tud_suspended();
+}
+
+void SimpleHID::requestRemoteWakeup() {
+#if HID_REMOTE_WAKEUP
+    if (!_enabled || _transport != TRANSPORT_USB || !tud_suspended()) {
+        return;
+    }
+    uint32_t now = millis();
+    if (_wakeupSent && now - _wakeupTime < HID_RESUME_WAIT_MS) {
+        return;
+    }
+    _wakeupTime = now;
+    _wakeupSent = true;
+    // 主机未允许远程唤醒（SET_FEATURE）时返回false
+    if (tud_remote_wakeup()) {
+        LOG_I(TAG_HID, "发出远程唤醒");
+    }
+#endif
+}
+
+bool SimpleHID::allowsLightSleep() const {
+#if BLE_HID_ENABLED
+    // BLE连接不能在浅睡眠中保持
+    if (_transport == TRANSPORT_BLE && BleHID::instance().isConnected()) {
+        return false;
+    }
+#endif
+    // 睡眠期间USB控制器停止，主机会认为设备失去响应；主机休眠时总线上没有通信
+#if HID_REMOTE_WAKEUP
+    return !isUsbConnected() || tud_suspended();
+#else
+    return !isUsbConnected();
+#endif
+}
+
+void SimpleHID::prepareLightSleep() {
+#if HID_REMOTE_WAKEUP
+    // 挂起时总线为J状态（D-为低），主机恢复信号持续20ms，醒来后有足够时间响应
+    if (isUsbConnected() && tud_suspended()) {
+        gpio_wakeup_enable((gpio_num_t)USB_DN_PIN, GPIO_INTR_HIGH_LEVEL);
+        _resumeWakeArmed = true;
+    }
+#endif
+}
+
+void SimpleHID::finishLightSleep() {
+    if (_resumeWakeArmed) {
+        gpio_wakeup_disable((gpio_num_t)USB_DN_PIN);
+        _resumeWakeArmed = false;
+    }
+}
+
 void SimpleHID::setEnabled(bool enabled) {
     _enabled = enabled;
     LOG_I(TAG_HID, "HID功能%s", enabled ? "已启用" : "已禁用");
     
     if (!enabled) {
         // 禁用时释放所有按键
-        _keyboard.releaseAll();
-        _pressedKeyCount = 0;
-        memset(_pressedKeys, 0, sizeof(_pressedKeys));
+        portENTER_CRITICAL(&_lock);
+        memset(_heldCodes, 0, sizeof(_heldCodes));
+        _unsentPress = 0;
+        _deferredRelease = 0;
+        _macroHead = _macroTail = 0;
+        _macroKey = 0;
+        _dirty = true;
+        portEXIT_CRITICAL(&_lock);
+        flush();
     }
 }
 
-uint8_t SimpleHID::getHIDKeyCode(uint8_t keyPosition) const {
+uint16_t SimpleHID::getHIDKeyCode(uint8_t keyPosition) const {
     if (keyPosition < 1 || keyPosition > 22) {
         return 0;
     }
-    return _keyMapping[keyPosition - 1];
+    if (!keyboardConfig.getProfile().calculatorInput) {
+        return keyboardConfig.getHIDKeyCode(keyPosition);
+    }
+    return keyboardConfig.getHostKeyCode(keyPosition);
+}
+
+void SimpleHID::resetLatencyStats() {
+    _submitLatency.reset();
+    _completeLatency.reset();
 }
 
 void SimpleHID::printDebugInfo() const {
     Serial.println("=== 简单HID键盘状态 ===");
     Serial.printf("初始化状态: %s\n", _initialized ? "已初始化" : "未初始化");
     Serial.printf("启用状态: %s\n", _enabled ? "已启用" : "已禁用");
-    Serial.printf("USB连接: %s\n", isConnected() ? "已连接" : "未连接");
-    Serial.printf("当前按下按键数: %d\n", _pressedKeyCount);
+    Serial.printf("连接: %s\n", isConnected() ? "已连接" : "未连接");
+    Serial.printf("已发送报告: %lu\n", (unsigned long)_reportsSent);
+    Serial.println("延迟（从按键扫描起）:");
+    const PerfHistogram* stats[] = {&_submitLatency, &_completeLatency};
+    const char* names[] = {"提交报告", "主机取走"};
+    for (uint8_t i = 0; i < 2; i++) {
+        Serial.printf("  %-8s n=%-6lu min=%-6lu avg=%-6lu p99=%-6lu max=%lu (µs)\n", names[i],
+                      (unsigned long)stats[i]->getCount(), (unsigned long)stats[i]->getMin(),
+                      (unsigned long)stats[i]->getAvg(), (unsigned long)stats[i]->getPercentile(990),
+                      (unsigned long)stats[i]->getMax());
+    }
     
-    if (_pressedKeyCount > 0) {
-        Serial.print("按下的按键: ");
-        for (uint8_t i = 0; i < _pressedKeyCount; i++) {
-            Serial.printf("0x%02X ", _pressedKeys[i]);
+    Serial.print("按下的按键: ");
+    for (uint8_t i = 0; i < 22; i++) {
+        if (_heldCodes[i]) {
+            Serial.printf("%d(0x%04X) ", i + 1, _heldCodes[i]);
         }
-        Serial.println();
     }
+    Serial.println();
     
     Serial.println("\n--- 按键映射表 ---");
     for (uint8_t i = 0; i < 22; i++) {
-        uint8_t keyCode = _keyMapping[i];
+        uint16_t keyCode = getHIDKeyCode(i + 1);
         if (keyCode != 0) {
-            Serial.printf("按键%2d -> HID 0x%02X\n", i + 1, keyCode);
+            Serial.printf("按键%2d -> HID 0x%04X\n", i + 1, keyCode);
         } else {
             Serial.printf("按键%2d -> 无映射\n", i + 1);
         }
     }
     Serial.println("======================");
 }
-
-bool SimpleHID::addKey(uint8_t keyCode) {
-    // 检查是否已经按下
-    if (isKeyPressed(keyCode)) {
-        return true; // 已经在列表中
-    }
-    
-    // 检查是否还有空间
-    if (_pressedKeyCount >= 6) {
-        LOG_W(TAG_HID, "按键缓冲区已满，无法添加按键 0x%02X", keyCode);
-        return false;
-    }
-    
-    // 添加到列表
-    _pressedKeys[_pressedKeyCount] = keyCode;
-    _pressedKeyCount++;
-    
-    LOG_D(TAG_HID, "添加按键 0x%02X，当前按键数: %d", keyCode, _pressedKeyCount);
-    return true;
-}
-
-bool SimpleHID::removeKey(uint8_t keyCode) {
-    // 查找按键
-    for (uint8_t i = 0; i < _pressedKeyCount; i++) {
-        if (_pressedKeys[i] == keyCode) {
-            // 找到了，移除它
-            for (uint8_t j = i; j < _pressedKeyCount - 1; j++) {
-                _pressedKeys[j] = _pressedKeys[j + 1];
-            }
-            _pressedKeyCount--;
-            _pressedKeys[_pressedKeyCount] = 0; // 清零最后一个位置
-            
-            LOG_D(TAG_HID, "移除按键 0x%02X，当前按键数: %d", keyCode, _pressedKeyCount);
-            return true;
-        }
-    }
-    
-    LOG_W(TAG_HID, "未找到要移除的按键 0x%02X", keyCode);
-    return false;
-}
-
-bool SimpleHID::isKeyPressed(uint8_t keyCode) const {
-    for (uint8_t i = 0; i < _pressedKeyCount; i++) {
-        if (_pressedKeys[i] == keyCode) {
-            return true;
-        }
-    }
-    return false;
-}
\ No newline at end of file
@@ -9,6 +9,30 @@
  * 
  * 按键同时触发计算器功能和HID功能，无需模式切换
  * 
+ * 使用自定义的NKRO（全键无冲）报告：修饰键 + HID Usage 0x00-0x7F 的位图，
+ * 同时按下的键数不受6键限制。消费者控制（音量、静音、启动计算器）和系统控制（睡眠、唤醒）
+ * 使用另外两个报告ID，与键盘报告在同一次更新中生成，只有内容变化的报告才发送，
+ * 键盘报告总是先发，不会因为这两个报告而推迟。begin()时订阅按键事件总线的输出阶段：
+ * handleKey()只修改按键状态，总线在每次键盘更新的事件分发完后调用flush()，
+ * 一次扫描内的所有变化合并为一个报告，先于计算器和显示的处理发出；端点忙时留到下一次发送。
+ * 
+ * 发送任务（HID_TX_TASK）：flush()只通知任务。任务每次提交一个报告，SendReport()等到主机取走
+ * （tud_hid_report_complete_cb）才返回，所以报告按主机轮询节奏一个接一个发送，
+ * 长宏（如输入计算结果）发送期间主循环照常处理按键和显示。
+ * 
+ * 宏：sendMacro()把字符序列展开为键码放入预分配的队列，每个报告前进一步
+ * （相邻两键可以合并时释放和按下在同一个报告里），不像Keyboard.print()那样阻塞主循环。
+ * 
+ * 端点轮询间隔：Arduino-ESP32 (2.0.x) 的USBHID接口描述符中bInterval为1，全速设备即1ms（1kHz）。
+ * 延迟探针记录每个报告从按键扫描时刻到提交、到主机取走（SendReport()返回）的时间，hid_status输出。
+ * 
+ * 主机LED（NumLock、CapsLock等）：键盘报告的输出部分，_onOutput()在USB任务中（BLE为写入输出报告特征值）
+ * 只记下最新状态并唤醒主循环，update()在主循环中发布KEY_EVENT_HOST_LED，由订阅者切换层和点亮按键灯。
+ * 
+ * 报告出口（hid_mode）：USB（默认）或BLE（BleHID.h，同一份报告描述符，HID over GATT）。
+ * 切换时先在原来的出口释放全部按键，发出后再切换；BLE出口每个连接事件发送一批报告，
+ * 一个连接间隔内的按键变化合并到同一批中（合并方式与USB端点忙时相同）。
+ * 
  * @author PawCounter Team
  * @date 2024-01-08
  */
@@ -19,13 +43,43 @@
 #include <Arduino.h>
 #include <stdint.h>
 #include "USB.h"
-#include "USBHIDKeyboard.h"
+#include "USBHID.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "PerformanceMonitor.h"
+#include "KeyEventBus.h"
+#include "BleHID.h"
 
 /**
  * @brief 简单HID键盘类
  */
-class SimpleHID {
+class SimpleHID : public USBHIDDevice {
 public:
+    static const uint8_t NKRO_REPORT_ID = 8;        ///< 报告ID，避开Arduino内置设备使用的ID
+    static const uint8_t NKRO_USAGE_COUNT = 128;    ///< 位图覆盖的键盘Usage数量
+    static const uint8_t NKRO_REPORT_SIZE = 1 + NKRO_USAGE_COUNT / 8;  ///< 修饰键字节 + 位图
+    static const uint8_t CONSUMER_REPORT_ID = 9;    ///< 消费者控制报告ID
+    static const uint8_t CONSUMER_USAGE_SLOTS = 2;  ///< 同时按下的消费者控制键数
+    static const uint8_t SYSTEM_REPORT_ID = 10;     ///< 系统控制报告ID
+    static const uint16_t MACRO_QUEUE_SIZE = 256;   ///< 宏队列容量（键码数），2的幂
+
+    /**
+     * @brief 报告出口
+     */
+    enum Transport : uint8_t {
+        TRANSPORT_USB,
+        TRANSPORT_BLE
+    };
+
+    /**
+     * @brief 宏中{RESULT}的内容来源
+     * @param buffer 输出缓冲区
+     * @param size 缓冲区大小
+     * @return 写入的字符数
+     */
+    typedef size_t (*TextProvider)(char* buffer, size_t size);
+
     /**
      * @brief 构造函数
      */
@@ -38,19 +92,129 @@ public:
     bool begin();
 
     /**
-     * @brief 处理按键事件
+     * @brief 处理按键事件（只修改按键状态，由flush()发送）
      * @param keyPosition 物理按键位置（1-22）
      * @param pressed true为按下，false为释放
+     * @param scanTimestamp 按键扫描时刻（esp_timer_get_time()），0表示取当前时间
      * @return true 处理成功，false 处理失败
      */
-    bool handleKey(uint8_t keyPosition, bool pressed);
+    bool handleKey(uint8_t keyPosition, bool pressed, int64_t scanTimestamp = 0);
+
+    /**
+     * @brief 把宏序列加入发送队列
+     * @param macro 序列：普通字符原样输入；{TAB} {ENTER} {ESC} {BS} {DEL} {UP} {DOWN} {LEFT} {RIGHT} {F2}
+     *              为特殊键，{RESULT}为计算结果，{{为字符'{'
+     * @return false 队列空间不足或序列无效（整个序列都不发送）
+     */
+    bool sendMacro(const char* macro);
+
+    /**
+     * @brief 设置{RESULT}的内容来源
+     */
+    void setResultProvider(TextProvider provider) { _resultProvider = provider; }
+
+    /**
+     * @brief 宏是否还在发送
+     */
+    bool isMacroActive() const { return _macroKey || _macroHead != _macroTail; }
+
+    /**
+     * @brief 发布收到的主机LED状态（主循环中调用，没有新状态时直接返回）
+     */
+    void update();
 
     /**
-     * @brief 检查HID是否已连接
+     * @brief 最近一次收到的主机LED状态（HOST_LED_*）
+     */
+    uint8_t getHostLeds() const { return _hostLeds; }
+
+    /**
+     * @brief 按键状态有变化或宏未发完时发送报告
+     * @return true 已发送、已交给发送任务或无需发送，false 端点忙（保留到下一次）
+     */
+    bool flush();
+
+    /**
+     * @brief 检查当前出口是否已连接
      * @return true 已连接，false 未连接
      */
     bool isConnected() const;
 
+    /**
+     * @brief USB是否已连接（与出口无关，主机通道也使用USB）
+     */
+    bool isUsbConnected() const;
+
+    /**
+     * @brief 主机是否处于休眠（USB挂起）
+     */
+    bool isUsbSuspended() const;
+
+    /**
+     * @brief 主机休眠时请求远程唤醒（任意任务）
+     * @details 每次挂起只发一次，HID_RESUME_WAIT_MS内主机没有恢复时再发；主机未允许远程唤醒时无效，
+     * 按键留到主机自己恢复后发出
+     */
+    void requestRemoteWakeup();
+
+    /**
+     * @brief 出口是否允许浅睡眠：USB未连接或主机休眠（HID_REMOTE_WAKEUP），且BLE未连接
+     */
+    bool allowsLightSleep() const;
+
+    /**
+     * @brief 浅睡眠前调用：主机休眠时把D-设为唤醒源，主机发出恢复信号（K状态，D-为高）时醒来
+     */
+    void prepareLightSleep();
+
+    /**
+     * @brief 浅睡眠结束：取消D-唤醒源
+     */
+    void finishLightSleep();
+
+    /**
+     * @brief 切换报告出口
+     * @details 第一次切换到BLE时启动蓝牙协议栈；按键在原来的出口释放后才切换
+     * @return false BLE未编译（BLE_HID_ENABLED）或启动失败
+     */
+    bool setTransport(Transport transport);
+
+    /**
+     * @brief 当前出口（切换完成前仍为原来的出口）
+     */
+    Transport getTransport() const { return _transport; }
+
+    /**
+     * @brief USB连接状态变化时的通知（枚举完成/断开/主机挂起/恢复，在USB事件任务中调用）
+     */
+    typedef void (*ConnectionCallback)(bool connected, void* context);
+    void setConnectionCallback(ConnectionCallback callback, void* context) {
+        _connectionContext = context;
+        _connectionCallback = callback;
+    }
+
+    /**
+     * @brief USB总线挂起/恢复时的通知（与出口无关，在USB事件任务中调用）
+     * @details 挂起期间设备从总线取电受限，用于立即进入省电阶段
+     */
+    typedef void (*SuspendCallback)(bool suspended, void* context);
+    void setSuspendCallback(SuspendCallback callback, void* context) {
+        _suspendContext = context;
+        _suspendCallback = callback;
+    }
+
+    /**
+     * @brief 直通模式的按键入口（KeypadControl::PassThroughSink，在扫描任务中调用）
+     * @details 按固定的数字小键盘表取键码，不查布局方案和宏，不输出日志；
+     *          写入报告状态后立即通知发送任务，扫描到提交报告只有几微秒
+     */
+    static void passThroughEntry(uint8_t keyPosition, bool pressed, int64_t scanTimestamp, void* context);
+
+    /**
+     * @brief 是否可以使用直通模式（需要发送任务，扫描任务中不能同步发送）
+     */
+    bool canPassThrough() const { return _initialized && _enabled && _txTask; }
+
     /**
      * @brief 启用/禁用HID功能
      * @param enabled true 启用，false 禁用
@@ -67,53 +231,146 @@ public:
      * @brief 获取按键映射的HID键码
      * @param keyPosition 物理按键位置（1-22）
      * @return HID键码，0表示无映射
+     * @details 计算器方案使用布局文件中的host=键码（LayoutKeys.h，主层覆盖项的keyCode优先），HID方案（小键盘、电子表格）使用布局方案中的keyCode。
+     *          键盘键码与Arduino Keyboard.press()的参数相同：ASCII字符、0x80-0x87修饰键、0x88 + HID Usage；
+     *          HID_CODE_CONSUMER / HID_CODE_SYSTEM | Usage 为消费者控制和系统控制键
      */
-    uint8_t getHIDKeyCode(uint8_t keyPosition) const;
+    uint16_t getHIDKeyCode(uint8_t keyPosition) const;
 
     /**
-     * @brief 打印调试信息
+     * @brief 打印调试信息（含延迟统计）
      */
     void printDebugInfo() const;
 
+    /**
+     * @brief 清空延迟统计
+     */
+    void resetLatencyStats();
+
+    const PerfHistogram& getSubmitLatency() const { return _submitLatency; }
+    const PerfHistogram& getCompleteLatency() const { return _completeLatency; }
+
+    // USBHIDDevice
+    uint16_t _onGetDescriptor(uint8_t* buffer) override;
+    void _onOutput(uint8_t reportId, const uint8_t* buffer, uint16_t length) override;
+
 private:
-    USBHIDKeyboard _keyboard;  // USB HID键盘对象
+    // 按键事件总线的订阅入口
+    static void keyEventEntry(const KeyEvent& event, void* context);
+    static void flushEntry(void* context);
+    static void bleConnectionEntry(bool connected, void* context);
+    static void bleOutputEntry(uint8_t reportId, const uint8_t* buffer, size_t length, void* context);
+
+    /**
+     * @brief 记下主机LED状态并唤醒主循环（任意任务）
+     */
+    void receiveHostLeds(uint8_t leds);
+
+    USBHID _hid;               // TinyUSB HID接口
     bool _enabled;             // HID功能是否启用
     bool _initialized;         // 是否已初始化
-    uint8_t _pressedKeys[6];   // 当前按下的按键（最多6个）
-    uint8_t _pressedKeyCount;  // 按下的按键数量
+    bool _dirty;               // 按键状态变化后尚未发送
+    uint16_t _heldCodes[22];   // 各按键按下时发送的键码，释放时使用（期间可能切换了方案或层级）
+    uint32_t _unsentPress;     // 按下后还未发送过的按键位置（位图），释放前必须先发送
+    uint32_t _deferredRelease; // 按下还未发送时就已释放的按键（位图），按下发送后再释放
+    uint8_t _report[NKRO_REPORT_SIZE];    // 最近一次发送的报告
+    uint16_t _consumerReport[CONSUMER_USAGE_SLOTS];  // 最近一次发送的消费者控制报告
+    uint8_t _systemReport;     // 最近一次发送的系统控制报告
+    uint32_t _reportsSent;     // 已发送的报告数
+    int64_t _pendingSince;     // 未发送的变化中最早的扫描时刻，0表示没有
+    PerfHistogram _submitLatency;      // 扫描 → 提交报告
+    PerfHistogram _completeLatency;    // 扫描 → 主机取走报告
+
+    uint8_t _macroQueue[MACRO_QUEUE_SIZE];  // 待发送的宏键码
+    uint16_t _macroHead;       // 下一个写入位置
+    uint16_t _macroTail;       // 下一个读出位置
+    uint8_t _macroKey;         // 宏当前按下的键码，0表示没有
+    TextProvider _resultProvider;
+    ConnectionCallback _connectionCallback;
+    void* _connectionContext;
+    SuspendCallback _suspendCallback;
+    void* _suspendContext;
+    volatile Transport _transport;      // 当前出口
+    volatile Transport _nextTransport;  // 请求切换到的出口
+    volatile uint8_t _hostLeds;         // 最近收到的主机LED状态
+    volatile bool _hostLedsPending;     // 收到新的输出报告，等主循环发布
+    uint8_t _publishedLeds;             // 上次发布的状态，0xFF表示还没有发布过
+    volatile bool _wakeupSent;          // 本次挂起已发出远程唤醒
+    volatile uint32_t _wakeupTime;      // 发出远程唤醒的时刻（millis）
+    bool _resumeWakeArmed;              // 浅睡眠期间D-为唤醒源
+
+    TaskHandle_t _txTask;      // 发送任务，nullptr表示在flush()中同步发送
+    portMUX_TYPE _lock;        // 保护按键状态和宏队列（主循环写，发送任务读）
+
+    /**
+     * @brief 发送任务：收到通知后连续发送，直到没有待发送的变化
+     */
+    static void txTaskEntry(void* arg);
+
+    /**
+     * @brief USB事件（ARDUINO_USB_EVENTS）转为连接状态通知
+     */
+    static void usbEventHandler(void* arg, esp_event_base_t base, int32_t id, void* data);
+
+    /**
+     * @brief 是否有待发送的按键变化或宏
+     */
+    bool hasPending() const { return _dirty || isMacroActive() || _transport != _nextTransport; }
+
+    /**
+     * @brief 当前出口能否发送下一批报告
+     */
+    bool transportReady();
+
+    /**
+     * @brief 按键都已释放后完成出口切换
+     */
+    void switchTransport();
+
+    /**
+     * @brief 生成并提交一个报告（等待主机取走）
+     * @return true 已发送或无需发送，false 端点忙或发送失败
+     */
+    bool sendNext();
+
+    /**
+     * @brief 宏前进一步：释放当前键和/或按下下一个键
+     */
+    void advanceMacro();
 
     /**
-     * @brief 按键映射表
-     * 将22个物理按键映射到HID键码
-     * 0表示无映射
+     * @brief 把键码追加到待提交的宏序列
+     * @return false 队列已满
      */
-    static const uint8_t _keyMapping[22];
+    bool pushMacroKey(uint16_t& head, uint8_t keyCode);
 
     /**
-     * @brief 更新HID报告
+     * @brief 根据当前按下的键生成报告
+     * @param report 输出报告（不含报告ID）
      */
-    void updateReport();
+    void buildReport(uint8_t* report) const;
 
     /**
-     * @brief 添加按键到报告
-     * @param keyCode HID键码
-     * @return true 成功，false 失败（报告已满）
+     * @brief 生成消费者控制和系统控制报告
      */
-    bool addKey(uint8_t keyCode);
+    void buildControlReports(uint16_t* consumer, uint8_t& system) const;
 
     /**
-     * @brief 从报告中移除按键
-     * @param keyCode HID键码
-     * @return true 成功，false 未找到
+     * @brief 报告与上次发送的不同时发送，并记录第一个报告的延迟
+     * @param last 上次发送的内容，成功后更新
+     * @param pendingSince 扫描时刻，记录后清零
+     * @return false 发送失败
      */
-    bool removeKey(uint8_t keyCode);
+    bool sendIfChanged(uint8_t reportId, const void* report, void* last, size_t size, int64_t& pendingSince);
 
     /**
-     * @brief 检查按键是否在报告中
-     * @param keyCode HID键码
-     * @return true 存在，false 不存在
+     * @brief 把键码转换为HID Usage和修饰键
+     * @param keyCode 键码
+     * @param usage 输出Usage，0表示只有修饰键
+     * @param modifiers 输出修饰键位
+     * @return false 键码无法表示
      */
-    bool isKeyPressed(uint8_t keyCode) const;
+    static bool toUsage(uint16_t keyCode, uint8_t& usage, uint8_t& modifiers);
 };
 
-#endif // SIMPLE_HID_H
\ No newline at end of file
+#endif // SIMPLE_HID_H
@@ -1,115 +1,404 @@
 #include "SleepManager.h"
+#include "ConfigManager.h"
+#include "Console.h"
+#include "LoopScheduler.h"
+#include "PowerManager.h"
+#include "StallMonitor.h"
+#include "TimerWheel.h"
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/uart.h>
+
+// 串口命令
+static void cmdSleep(const ConsoleArgs& args) {
+    int sec = 0;
+    SleepManager& sleep = SleepManager::instance();
+    if (args.count < 2) {
+        Serial.printf("当前阶段: %s，各级延迟（从上一级开始，%u%%）:\n", SleepManager::stateName(sleep.getState()),
+                      sleep.getTimeoutScale());
+        for (uint8_t i = 1; i < SleepManager::STATE_COUNT; i++) {
+            SleepManager::State stage = (SleepManager::State)i;
+            uint32_t delay = sleep.getStageDelay(stage);
+            if (delay == SleepManager::STAGE_NEVER) {
+                Serial.printf("  %-12s 不进入\n", SleepManager::stateName(stage));
+            } else {
+                Serial.printf("  %-12s %lu 秒\n", SleepManager::stateName(stage), (unsigned long)(delay / 1000));
+            }
+        }
+        return;
+    } else if (args.is(1, "off")) {
+        ConfigManager::getInstance().setSleepTimeout(0);      // 关闭休眠，由配置观察者生效
+        Serial.println("自动休眠已关闭并保存到配置");
+    } else if (args.toInt(1, sec) && sec > 0) {
+        uint32_t timeout = sec * 1000;
+        ConfigManager::getInstance().setSleepTimeout(timeout);
+        Serial.printf("自动休眠改为 %d 秒并保存到配置\n", sec);
+    } else {
+        Serial.println("无效的 'sleep' 命令格式. 使用: sleep [sec|off]");
+    }
+    sleep.feed();   // 命令本身也算活动
+}
+
+static constexpr ConsoleCommand SLEEP_COMMANDS[] = {
+    {"sleep", "[sec|off]", "显示休眠阶梯，或设置自动休眠时间(秒)，off关闭自动休眠", cmdSleep},
+};
 
 void SleepManager::begin(uint32_t timeoutMs) {
     if (!_initialized) {
+        Console::instance().addCommands(SLEEP_COMMANDS);
+        ConfigManager::getInstance().addObserver(
+            CONFIG_SLEEP_TIMEOUT,
+            [](uint32_t, const PersistentConfig& config, void*) { instance().setTimeout(config.sleepTimeout); });
         _timeoutMs = timeoutMs;
-        _lastActivity = millis();
+        _stageStart = millis();
+        _stateSince = _stageStart;
         _state = State::ACTIVE;
+        _stageTimer = TimerWheel::instance().create("sleep", _stageTimerEntry, this);
         _initialized = true;
-        
+        _armStageTimer();
+
         LOG_I(TAG_SLEEP, "休眠管理器初始化完成，超时时间：%u ms", _timeoutMs);
     } else {
         _timeoutMs = timeoutMs;
         LOG_I(TAG_SLEEP, "休眠管理器超时时间已更新：%u ms", _timeoutMs);
+        _armStageTimer();
+    }
+}
+
+const char* SleepManager::stateName(State state) {
+    switch (state) {
+        case State::ACTIVE:      return "活跃";
+        case State::DIM:         return "调暗";
+        case State::LEDS_OFF:    return "关灯";
+        case State::PANEL_OFF:   return "面板睡眠";
+        case State::LIGHT_SLEEP: return "浅睡眠";
+        case State::DEEP_SLEEP:  return "深度睡眠";
+        default:                 return "?";
     }
 }
 
+uint32_t SleepManager::getStageDelay(State stage) const {
+    switch (stage) {
+        case State::DIM:         return _timeoutMs ? _timeoutMs : STAGE_NEVER;
+        case State::LIGHT_SLEEP: return _lightSleepEnabled ? _lightSleep.delayMs : STAGE_NEVER;
+        case State::DEEP_SLEEP:  return _deepSleepEnabled ? _deepSleep.delayMs : STAGE_NEVER;
+        case State::LEDS_OFF:
+        case State::PANEL_OFF:   return _stageDelays[(uint8_t)stage];
+        default:                 return STAGE_NEVER;
+    }
+}
+
+uint32_t SleepManager::_stageDelay(State stage) const {
+    uint32_t delay = getStageDelay(stage);
+    if (delay == STAGE_NEVER) return STAGE_NEVER;
+    return (uint32_t)((uint64_t)delay * _timeoutScale / 100);
+}
+
+void SleepManager::setStageDelay(State stage, uint32_t delayMs) {
+    if (stage != State::LEDS_OFF && stage != State::PANEL_OFF) {
+        LOG_W(TAG_SLEEP, "阶段 %s 的延迟不能单独设置", stateName(stage));
+        return;
+    }
+    _stageDelays[(uint8_t)stage] = delayMs;
+    _armStageTimer();
+}
+
 void SleepManager::update() {
     if (!_initialized) return;
-    
+
+    // 其他任务的请求在关闭自动休眠时也执行
+    _applyRequest();
+    if (_rearm.exchange(false)) _armStageTimer();
+
     // 休眠禁用检查
     if (_timeoutMs == 0) return;
-    
-    uint32_t currentTime = millis();
-    uint32_t inactivityTime = currentTime - _lastActivity;
-    
-    // 状态检查与切换
-    if (_state == State::ACTIVE) {
-        if (inactivityTime > _timeoutMs) {
-            // 切换到休眠状态
-            _state = State::SLEEPING;
-            LOG_I(TAG_SLEEP, "系统进入休眠状态，不活动时间：%u ms", inactivityTime);
-            _notifySleep();
+
+    if (_state == State::LIGHT_SLEEP) {
+        // 浅睡眠阶段持续足够久时尝试深度睡眠（不返回），否则接着睡
+        uint32_t deepDelay = _stageDelay(State::DEEP_SLEEP);
+        if (!_ladderHeld && deepDelay != STAGE_NEVER && millis() - _stageStart >= deepDelay) {
+            _enterDeepSleep();
         }
-    } else if (_state == State::SLEEPING) {
-        // 已在休眠状态，无需额外操作
+        _enterLightSleep();
     }
 }
 
-void SleepManager::feed() {
-    _lastActivity = millis();
-    
-    // 如果处于休眠状态，唤醒
-    if (_state == State::SLEEPING) {
-        _state = State::ACTIVE;
-        LOG_I(TAG_SLEEP, "系统唤醒");
-        _notifyWake();
+void SleepManager::_armStageTimer() {
+    if (!_initialized) return;
+    uint32_t delay = STAGE_NEVER;
+    if (_timeoutMs && _state < State::LIGHT_SLEEP && !_ladderHeld) {
+        delay = _stageDelay((State)((uint8_t)_state + 1));
+    }
+    if (delay == STAGE_NEVER) {
+        TimerWheel::instance().cancel(_stageTimer);
+        return;
+    }
+    uint32_t elapsed = millis() - _stageStart;
+    TimerWheel::instance().start(_stageTimer, delay > elapsed ? delay - elapsed : 0);
+}
+
+void SleepManager::_stageTimerEntry(void* context) {
+    SleepManager* self = static_cast<SleepManager*>(context);
+    // 逐级进入：一次可以连续进入延迟为0的几级
+    while (self->_timeoutMs && self->_state < State::LIGHT_SLEEP && !self->_ladderHeld) {
+        State next = (State)((uint8_t)self->_state + 1);
+        uint32_t delay = self->_stageDelay(next);
+        uint32_t elapsed = millis() - self->_stageStart;
+        if (delay == STAGE_NEVER || elapsed < delay) break;
+        LOG_I(TAG_SLEEP, "进入%s，%s持续 %u ms", stateName(next), stateName(self->_state), elapsed);
+        self->_descendTo(next);
+    }
+    if (self->_state == State::LIGHT_SLEEP) {
+        // 刚进入浅睡眠阶段，下一轮主循环开始睡
+        LoopScheduler::instance().after(0);
+    }
+    self->_armStageTimer();
+}
+
+void SleepManager::enableLightSleep(const LightSleepConfig& config) {
+    if (!config.prepare || !config.resume) {
+        LOG_W(TAG_SLEEP, "浅睡眠配置无效");
+        return;
+    }
+    _lightSleep = config;
+    _lightSleepEnabled = true;
+
+    // 唤醒源在睡眠之间保持有效，只需设置一次
+    esp_sleep_enable_gpio_wakeup();
+    if (_lightSleep.ulpWakeup) {
+        esp_sleep_enable_ulp_wakeup();
+    }
+    uart_set_wakeup_threshold(UART_NUM_0, 3);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+    if (_lightSleep.pollMs) {
+        esp_sleep_enable_timer_wakeup((uint64_t)_lightSleep.pollMs * 1000);
+    }
+
+    LOG_I(TAG_SLEEP, "浅睡眠已启用：面板睡眠 %u ms 后进入，定时唤醒 %u ms", _lightSleep.delayMs, _lightSleep.pollMs);
+    _armStageTimer();
+}
+
+void SleepManager::enableDeepSleep(const DeepSleepConfig& config) {
+    if (!_lightSleepEnabled || (!config.wakePinMask && !config.ulpWakeup)) {
+        LOG_W(TAG_SLEEP, "深度睡眠配置无效（需要浅睡眠和唤醒引脚）");
+        return;
+    }
+    _deepSleep = config;
+    _deepSleepEnabled = true;
+    LOG_I(TAG_SLEEP, "深度睡眠已启用：浅睡眠 %u ms 后进入", _deepSleep.delayMs);
+}
+
+void SleepManager::_enterLightSleep() {
+    if (!_lightSleep.prepare(_lightSleep.context)) {
+        // 等背光、LED或屏幕推送完成，或USB断开
+        LoopScheduler::instance().after(_lightSleep.pollMs ? _lightSleep.pollMs : 10);
+        return;
+    }
+
+    // 睡眠期间UART时钟停止，发送FIFO中的字符会乱码
+    Serial.flush();
+
+    int64_t start = esp_timer_get_time();
+    PowerManager::instance().noteSleep(true);
+    esp_light_sleep_start();
+    PowerManager::instance().noteSleep(false);
+    int64_t wake = esp_timer_get_time();
+    _lightSleepUs += wake - start;
+    _lightSleepCount++;
+
+    _lightSleep.resume(_lightSleep.context);
+#if STALL_MONITOR_ENABLED
+    // 睡眠时长不算阻塞
+    StallMonitor::instance().iterationBegin();
+#endif
+
+    // 醒来后跑一轮主循环（分发按键、推进定时工作），没有活动就接着睡
+    LoopScheduler::instance().after(0);
+
+    // 定时唤醒不算活动；GPIO和串口唤醒只退出浅睡眠，面板等按键事件喂狗时再打开
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    if (cause == ESP_SLEEP_WAKEUP_GPIO || cause == ESP_SLEEP_WAKEUP_ULP || cause == ESP_SLEEP_WAKEUP_UART) {
+        feed(State::PANEL_OFF);
+        _lastResumeUs = (uint32_t)(esp_timer_get_time() - wake);
+    }
+}
+
+void SleepManager::_enterDeepSleep() {
+    if (!_deepSleep.prepare || !_deepSleep.prepare(_deepSleep.context)) {
+        return;
+    }
+    LOG_I(TAG_SLEEP, "进入深度睡眠，浅睡眠持续 %u ms", millis() - _stageStart);
+    _descendTo(State::DEEP_SLEEP);
+    Serial.flush();
+
+    // 只留按键唤醒：定时唤醒会让设备每次重启
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    if (_deepSleep.ulpWakeup) {
+        esp_sleep_enable_ulp_wakeup();
+    } else {
+        esp_sleep_enable_ext1_wakeup(_deepSleep.wakePinMask, ESP_EXT1_WAKEUP_ALL_LOW);
+    }
+    esp_deep_sleep_start();
+}
+
+void SleepManager::feed(State level) {
+    if (_state > level) {
+        LOG_I(TAG_SLEEP, "从%s唤醒到%s", stateName(_state), stateName(level));
+        _climbTo(level);
+        _stageStart = millis();
+        _armStageTimer();
+    } else if (_state == level) {
+        _stageStart = millis();
+        _armStageTimer();
     }
 }
 
+void SleepManager::requestSleep(State level) {
+    if (level > State::PANEL_OFF) level = State::PANEL_OFF;
+    _request = (uint8_t)level | REQUEST_SLEEP;
+    LoopScheduler::instance().wake();
+}
+
+void SleepManager::requestFeed(State level) {
+    _request = (uint8_t)level;
+    LoopScheduler::instance().wake();
+}
+
+void SleepManager::_applyRequest() {
+    uint8_t request = _request.exchange(REQUEST_NONE);
+    if (request == REQUEST_NONE) return;
+
+    State level = (State)(request & ~REQUEST_SLEEP);
+    if (!(request & REQUEST_SLEEP)) {
+        feed(level);
+    } else if (_state < level) {
+        LOG_I(TAG_SLEEP, "请求进入%s（当前%s）", stateName(level), stateName(_state));
+        _descendTo(level);
+        _armStageTimer();
+    }
+}
+
+void SleepManager::setTimeoutScale(uint8_t percent) {
+    if (percent == 0 || percent > 100) percent = 100;
+    if (_timeoutScale == percent) return;
+    _timeoutScale = percent;
+    LOG_I(TAG_SLEEP, "各级休眠延迟按 %u%% 计算", percent);
+    // 可能在其他任务中调用：由主循环重新设置定时器
+    _rearm = true;
+    LoopScheduler::instance().wake();
+}
+
 void SleepManager::setTimeout(uint32_t timeoutMs) {
     if (_timeoutMs != timeoutMs) {
         _timeoutMs = timeoutMs;
-        
+
         if (_timeoutMs == 0) {
             LOG_I(TAG_SLEEP, "休眠功能已禁用");
-            // 如果当前处于休眠状态，则唤醒
-            if (_state == State::SLEEPING) {
-                _state = State::ACTIVE;
-                _notifyWake();
-            }
+            // 如果当前处于休眠阶段，则唤醒
+            _climbTo(State::ACTIVE);
         } else {
             LOG_I(TAG_SLEEP, "休眠超时时间已设置为：%u ms", _timeoutMs);
         }
-        
+
         // 重置活动计时器
-        _lastActivity = millis();
+        _stageStart = millis();
+        _armStageTimer();
     }
 }
 
 void SleepManager::setState(State state) {
-    if (_state != state) {
-        State prevState = _state;
-        _state = state;
-        
-        // 处理状态变化
-        if (prevState == State::ACTIVE && state == State::SLEEPING) {
-            LOG_I(TAG_SLEEP, "系统手动切换到休眠状态");
-            _notifySleep();
-        } else if (prevState == State::SLEEPING && state == State::ACTIVE) {
-            LOG_I(TAG_SLEEP, "系统手动切换到活动状态");
-            _notifyWake();
-        }
-        
-        // 重置活动计时器
-        _lastActivity = millis();
+    if (state >= State::DEEP_SLEEP || _state == state) return;
+
+    LOG_I(TAG_SLEEP, "手动切换：%s → %s", stateName(_state), stateName(state));
+    if (state > _state) {
+        _descendTo(state);
+    } else {
+        _climbTo(state);
+    }
+
+    // 重置活动计时器
+    _stageStart = millis();
+    _armStageTimer();
+}
+
+void SleepManager::_descendTo(State target) {
+    while (_state < target) {
+        _noteStateTime();
+        _state = (State)((uint8_t)_state + 1);
+        _stageStart = millis();
+        _notifyEnter(_state);
+    }
+}
+
+void SleepManager::_noteStateTime() {
+    uint32_t now = millis();
+    _stateMs[(uint8_t)_state] += now - _stateSince;
+    _stateSince = now;
+}
+
+uint32_t SleepManager::getStateMs(State state) const {
+    uint32_t ms = _stateMs[(uint8_t)state];
+    if (state == _state && _initialized) ms += millis() - _stateSince;
+    return ms;
+}
+
+void SleepManager::setLadderHold(bool hold) {
+    _ladderHeld = hold;
+    _armStageTimer();
+}
+
+void SleepManager::_climbTo(State target) {
+    while (_state > target) {
+        State leaving = _state;
+        _noteStateTime();
+        _state = (State)((uint8_t)_state - 1);
+        _notifyExit(leaving);
     }
 }
 
 SleepManager::CallbackID SleepManager::addCallback(
-    CallbackFunc onSleep, 
-    CallbackFunc onWake, 
-    void* context
+    State stage,
+    CallbackFunc onEnter,
+    CallbackFunc onExit,
+    void* context,
+    uint8_t priority
 ) {
+    if (stage == State::ACTIVE || stage >= State::COUNT) {
+        LOG_W(TAG_SLEEP, "无法添加回调：无效阶段");
+        return 0xFF;
+    }
     if (_callbackCount >= MAX_CALLBACKS) {
         LOG_W(TAG_SLEEP, "无法添加回调：已达最大数量 (%d)", MAX_CALLBACKS);
         return 0xFF;  // 失败
     }
-    
+
     // 寻找空闲槽位
     for (uint8_t i = 0; i < MAX_CALLBACKS; i++) {
         if (!_callbacks[i].active) {
-            _callbacks[i].onSleepFunc = onSleep;
-            _callbacks[i].onWakeFunc = onWake;
+            _callbacks[i].onEnterFunc = onEnter;
+            _callbacks[i].onExitFunc = onExit;
             _callbacks[i].context = context;
+            _callbacks[i].stage = stage;
+            _callbacks[i].priority = priority;
             _callbacks[i].active = true;
+
+            // 插入排序：同阶段同优先级按注册顺序
+            uint8_t pos = _callbackCount;
+            while (pos > 0) {
+                const SleepCallback& prev = _callbacks[_order[pos - 1]];
+                if (prev.stage < stage || (prev.stage == stage && prev.priority <= priority)) break;
+                _order[pos] = _order[pos - 1];
+                pos--;
+            }
+            _order[pos] = i;
             _callbackCount++;
-            
-            LOG_D(TAG_SLEEP, "添加回调成功，ID：%d，总数：%d", i, _callbackCount);
+
+            LOG_D(TAG_SLEEP, "添加回调成功，ID：%d，阶段：%s，优先级：%u，总数：%d", i, stateName(stage), priority,
+                  _callbackCount);
             return i;  // 返回ID
         }
     }
-    
+
     // 不应该到达这里
     LOG_W(TAG_SLEEP, "添加回调失败：未知错误");
     return 0xFF;
@@ -120,29 +409,37 @@ bool SleepManager::removeCallback(CallbackID id) {
         LOG_W(TAG_SLEEP, "移除回调失败：无效ID %d", id);
         return false;
     }
-    
+
     _callbacks[id].active = false;
-    _callbacks[id].onSleepFunc = nullptr;
-    _callbacks[id].onWakeFunc = nullptr;
+    _callbacks[id].onEnterFunc = nullptr;
+    _callbacks[id].onExitFunc = nullptr;
     _callbacks[id].context = nullptr;
+
+    uint8_t pos = 0;
+    while (_order[pos] != id) pos++;
+    for (; pos + 1 < _callbackCount; pos++) {
+        _order[pos] = _order[pos + 1];
+    }
     _callbackCount--;
-    
+
     LOG_D(TAG_SLEEP, "成功移除回调 ID：%d，剩余：%d", id, _callbackCount);
     return true;
 }
 
-void SleepManager::_notifySleep() {
-    for (uint8_t i = 0; i < MAX_CALLBACKS; i++) {
-        if (_callbacks[i].active && _callbacks[i].onSleepFunc) {
-            _callbacks[i].onSleepFunc(_callbacks[i].context);
+void SleepManager::_notifyEnter(State stage) {
+    for (uint8_t i = 0; i < _callbackCount; i++) {
+        const SleepCallback& callback = _callbacks[_order[i]];
+        if (callback.stage == stage && callback.onEnterFunc) {
+            callback.onEnterFunc(callback.context);
         }
     }
 }
 
-void SleepManager::_notifyWake() {
-    for (uint8_t i = 0; i < MAX_CALLBACKS; i++) {
-        if (_callbacks[i].active && _callbacks[i].onWakeFunc) {
-            _callbacks[i].onWakeFunc(_callbacks[i].context);
+void SleepManager::_notifyExit(State stage) {
+    for (uint8_t i = _callbackCount; i-- > 0;) {
+        const SleepCallback& callback = _callbacks[_order[i]];
+        if (callback.stage == stage && callback.onExitFunc) {
+            callback.onExitFunc(callback.context);
         }
     }
-} 
\ No newline at end of file
+}
@@ -2,30 +2,76 @@
 #define SLEEP_MANAGER_H
 
 #include <Arduino.h>
+#include <atomic>
 #include "Logger.h"
+#include "TimerWheel.h"
 
 #define TAG_SLEEP "SLEEP"
 
 /**
- * 休眠管理器 - 管理系统自动休眠功能
- * 
- * 检测用户活动并在指定时间后自动进入休眠状态
- * 通过回调机制通知其他模块系统休眠/唤醒
+ * 休眠管理器 - 分级的省电阶梯
+ *
+ * 没有活动时逐级进入：ACTIVE → DIM（背光调暗）→ LEDS_OFF（按键灯关闭）→ PANEL_OFF（面板睡眠）
+ * → LIGHT_SLEEP（浅睡眠）→ DEEP_SLEEP（深度睡眠）。每一级的延迟从进入上一级时开始计算，
+ * 第一级的延迟就是配置的休眠超时；延迟为STAGE_NEVER的一级及其后各级不会进入。
+ * 下一级的进入时刻由时间轮定时器触发，主循环不轮询。
+ *
+ * 各模块按阶段注册进入/退出回调：进入时按优先级从小到大调用，退出时反过来。
+ * 唤醒只回退到需要的那一级：feed()回到ACTIVE，feed(State::PANEL_OFF)只退出浅睡眠、
+ * 面板保持关闭（例如主机通道传输、串口唤醒），之后从这一级重新计时。
+ * 其他任务（例如USB挂起/恢复事件）用requestSleep()/requestFeed()请求，下一次update()中执行。
+ *
+ * 浅睡眠阶段主循环在update()中反复调用esp_light_sleep_start()：
+ * 每次睡前由prepare检查各模块是否空闲并配置GPIO唤醒源，醒来后先调用resume，
+ * GPIO、ULP或串口唤醒时回到PANEL_OFF，按键事件再喂狗完全唤醒；定时器唤醒只做一次兜底扫描，没有按键就继续睡。
+ * 串口唤醒时触发唤醒的前几个字符会丢失。
+ *
+ * 深度睡眠不返回：唤醒即重启，只有ext1唤醒引脚（或ULP按键扫描）能唤醒。
  */
 class SleepManager {
 public:
-    // 系统状态枚举
-    enum class State {
-        ACTIVE,     // 活跃状态
-        SLEEPING    // 休眠状态
+    // 省电阶段，数值越大越省电
+    enum class State : uint8_t {
+        ACTIVE,         // 活跃
+        DIM,            // 背光调暗
+        LEDS_OFF,       // 按键灯关闭
+        PANEL_OFF,      // 面板睡眠、背光关闭、降频（原来的休眠状态）
+        LIGHT_SLEEP,    // 浅睡眠
+        DEEP_SLEEP,     // 深度睡眠
+        COUNT
     };
-    
+
+    static const uint8_t STATE_COUNT = (uint8_t)State::COUNT;
+    static const uint32_t STAGE_NEVER = 0xFFFFFFFF;     // 不进入该阶段
+
     // 回调ID类型
     using CallbackID = uint8_t;
-    
+
     // 标准回调类型：void function(void* context)
     using CallbackFunc = void (*)(void*);
-    
+
+    // 检查类型：返回false表示本次不执行
+    using CheckFunc = bool (*)(void*);
+
+    // 浅睡眠配置
+    struct LightSleepConfig {
+        uint32_t delayMs;       // 面板睡眠后多久开始浅睡眠
+        uint32_t pollMs;        // 睡眠中的定时唤醒间隔，0表示只由GPIO和串口唤醒
+        CheckFunc prepare;      // 每次睡前调用，返回true时须已配置好GPIO唤醒源（或已交给ULP）
+        CallbackFunc resume;    // 每次醒来后调用（定时唤醒也调用）
+        void* context;
+        bool ulpWakeup;         // 同时允许ULP唤醒（UlpKeyScan）
+    };
+
+    // 深度睡眠配置
+    struct DeepSleepConfig {
+        uint32_t delayMs;       // 浅睡眠阶段持续多久后深度睡眠
+        uint64_t wakePinMask;   // ext1唤醒引脚（RTC GPIO位图），全部为低电平时唤醒
+        CheckFunc prepare;      // 返回false时本次不进入（例如USB已连接），继续浅睡眠
+        void* context;
+        bool ulpWakeup;         // 由ULP唤醒（prepare已交给ULP），不用ext1
+    };
+
     /**
      * 获取单例实例
      */
@@ -33,56 +79,87 @@ public:
         static SleepManager instance;
         return instance;
     }
-    
+
     /**
      * 初始化休眠管理器
-     * @param timeoutMs 无活动后进入休眠的时间(毫秒)，0表示禁用休眠
+     * @param timeoutMs 无活动后进入第一级（DIM）的时间(毫秒)，0表示禁用休眠
      */
     void begin(uint32_t timeoutMs = 10000);
-    
+
     /**
-     * 更新休眠状态 - 在主循环中调用
+     * 更新休眠状态 - 在主循环中调用：执行其他任务的请求，浅睡眠阶段在这里睡眠
      */
     void update();
-    
+
     /**
-     * 喂狗 - 记录用户活动，重置休眠计时器
+     * 喂狗 - 记录用户活动，回退到level（已经不比level深时只重新计时）
+     * @param level 这次活动需要的阶段，默认完全唤醒
      */
-    void feed();
-    
+    void feed(State level = State::ACTIVE);
+
     /**
-     * 设置休眠超时时间
+     * 从其他任务请求立即进入level（最深PANEL_OFF），已经不比level浅时不变；下一次update()中执行
+     * 之后的各级照常按延迟进入。只保留最近一次请求
+     */
+    void requestSleep(State level);
+
+    /**
+     * 从其他任务请求feed(level)，下一次update()中执行
+     */
+    void requestFeed(State level = State::ACTIVE);
+
+    /**
+     * 设置休眠超时时间（第一级的延迟）
      * @param timeoutMs 超时时间(毫秒)，0表示禁用休眠
      */
     void setTimeout(uint32_t timeoutMs);
-    
+
     /**
      * 获取当前休眠超时时间
      * @return 超时时间(毫秒)
      */
     uint32_t getTimeout() const { return _timeoutMs; }
-    
+
     /**
-     * 获取当前系统状态
-     * @return 当前状态(ACTIVE/SLEEPING)
+     * 设置某一级的延迟（从进入上一级开始计算）
+     * @param stage LEDS_OFF或PANEL_OFF；其余各级由setTimeout()和浅睡眠/深度睡眠配置设置
+     * @param delayMs 延迟(毫秒)，STAGE_NEVER表示不进入
+     */
+    void setStageDelay(State stage, uint32_t delayMs);
+    uint32_t getStageDelay(State stage) const;
+
+    /**
+     * 按比例缩短各级延迟（低电量时，任意任务）
+     * @param percent 实际使用的百分比，100表示不缩短
+     */
+    void setTimeoutScale(uint8_t percent);
+    uint8_t getTimeoutScale() const { return _timeoutScale; }
+
+    /**
+     * 获取当前阶段
      */
     State getState() const { return _state; }
-    
+
     /**
-     * 直接设置系统状态(用于强制休眠/唤醒)
-     * @param state 目标状态
+     * 直接切换阶段(用于强制休眠/唤醒)，中间各级的回调依次调用
+     * @param state 目标阶段，不能是DEEP_SLEEP
      */
     void setState(State state);
-    
+
+    static const char* stateName(State state);
+
     /**
-     * 添加休眠/唤醒回调函数
-     * @param onSleep 进入休眠时调用的函数
-     * @param onWake 唤醒时调用的函数
+     * 添加阶段回调
+     * @param stage 阶段（DIM及以后）
+     * @param onEnter 进入该阶段时调用的函数
+     * @param onExit 退出该阶段（回退到更浅的阶段）时调用的函数
      * @param context 回调上下文(可选)
+     * @param priority 同一阶段中的顺序：进入时从小到大，退出时从大到小
      * @return 回调ID，用于后续移除；失败返回0xFF
      */
-    CallbackID addCallback(CallbackFunc onSleep, CallbackFunc onWake, void* context = nullptr);
-    
+    CallbackID addCallback(State stage, CallbackFunc onEnter, CallbackFunc onExit, void* context = nullptr,
+                           uint8_t priority = 100);
+
     /**
      * 移除回调
      * @param id 要移除的回调ID
@@ -90,43 +167,131 @@ public:
      */
     bool removeCallback(CallbackID id);
 
+    /**
+     * 启用浅睡眠
+     * @param config 浅睡眠配置，prepare和resume不能为空
+     */
+    void enableLightSleep(const LightSleepConfig& config);
+
+    /**
+     * 启用深度睡眠（需先启用浅睡眠）
+     * @param config 深度睡眠配置，wakePinMask和ulpWakeup至少有一个
+     */
+    void enableDeepSleep(const DeepSleepConfig& config);
+
+    /**
+     * 浅睡眠统计
+     */
+    uint32_t getLightSleepCount() const { return _lightSleepCount; }
+    uint32_t getLightSleepMs() const { return (uint32_t)(_lightSleepUs / 1000); }
+    uint32_t getLastResumeUs() const { return _lastResumeUs; }  // 最近一次完全唤醒时从醒来到唤醒回调完成的时间
+    bool isLightSleepEnabled() const { return _lightSleepEnabled; }
+
+    /**
+     * 各阶段的累计停留时间（自begin()起，含当前阶段到现在为止的部分）
+     */
+    uint32_t getStateMs(State state) const;
+
+    /**
+     * 暂停自动逐级进入（功耗基准等由调用方用setState()控制阶段时），也不进入深度睡眠
+     * 浅睡眠阶段仍照常睡眠和唤醒
+     */
+    void setLadderHold(bool hold);
+
 private:
     // 私有构造函数(单例)
-    SleepManager() : 
-        _initialized(false), 
-        _timeoutMs(10000), 
-        _lastActivity(0), 
-        _state(State::ACTIVE), 
-        _callbackCount(0) {
+    SleepManager() :
+        _initialized(false),
+        _timeoutMs(10000),
+        _state(State::ACTIVE),
+        _stageStart(0),
+        _timeoutScale(100),
+        _request(REQUEST_NONE),
+        _rearm(false),
+        _stageTimer(TimerWheel::INVALID),
+        _callbackCount(0),
+        _lightSleepEnabled(false),
+        _deepSleepEnabled(false),
+        _lightSleepCount(0),
+        _lightSleepUs(0),
+        _lastResumeUs(0),
+        _ladderHeld(false),
+        _stateSince(0) {
         // 初始化回调数组
         for (uint8_t i = 0; i < MAX_CALLBACKS; i++) {
             _callbacks[i].active = false;
         }
+        for (uint8_t i = 0; i < STATE_COUNT; i++) {
+            _stageDelays[i] = STAGE_NEVER;
+            _stateMs[i] = 0;
+        }
     }
-    
+
     // 回调结构定义
     struct SleepCallback {
-        CallbackFunc onSleepFunc;
-        CallbackFunc onWakeFunc;
+        CallbackFunc onEnterFunc;
+        CallbackFunc onExitFunc;
         void* context;
+        State stage;
+        uint8_t priority;
         bool active;
     };
-    
-    static const uint8_t MAX_CALLBACKS = 8;  // 最大支持的回调数量
-    
+
+    static const uint8_t MAX_CALLBACKS = 12;  // 最大支持的回调数量
+    static const uint8_t REQUEST_NONE = 0xFF;
+    static const uint8_t REQUEST_SLEEP = 0x80;  // 与阶段合并：进入；否则为喂狗
+
     bool _initialized;           // 是否已初始化
-    uint32_t _timeoutMs;         // 休眠超时时间(毫秒)
-    uint32_t _lastActivity;      // 最后活动时间
-    State _state;                // 当前状态
-    
+    uint32_t _timeoutMs;         // 休眠超时时间(毫秒)，即DIM的延迟
+    State _state;                // 当前阶段
+    uint32_t _stageStart;        // 进入当前阶段（或最近一次在该阶段喂狗）的时间
+    volatile uint8_t _timeoutScale;  // 各级延迟的比例(百分比)
+    uint32_t _stageDelays[STATE_COUNT];  // LEDS_OFF、PANEL_OFF的延迟，其余各级见stageDelay()
+    std::atomic<uint8_t> _request;       // 其他任务的请求：阶段（| REQUEST_SLEEP），REQUEST_NONE表示没有
+    std::atomic<bool> _rearm;            // 延迟比例已变，下一次update()重新计算下一级的时刻
+    TimerWheel::TimerId _stageTimer;     // 进入下一级的定时器
+
     SleepCallback _callbacks[MAX_CALLBACKS];  // 回调数组
+    uint8_t _order[MAX_CALLBACKS];            // 活动回调的槽位，按(阶段, 优先级)排序
     uint8_t _callbackCount;                   // 当前活动回调数量
-    
-    // 执行所有休眠回调
-    void _notifySleep();
-    
-    // 执行所有唤醒回调
-    void _notifyWake();
+
+    LightSleepConfig _lightSleep;
+    DeepSleepConfig _deepSleep;
+    bool _lightSleepEnabled;
+    bool _deepSleepEnabled;
+    uint32_t _lightSleepCount;   // 浅睡眠次数
+    uint64_t _lightSleepUs;      // 浅睡眠累计时间
+    uint32_t _lastResumeUs;
+    bool _ladderHeld;            // setLadderHold()
+    uint32_t _stateMs[STATE_COUNT];  // 各阶段的累计时间，不含当前阶段的这一段
+    uint32_t _stateSince;        // 进入当前阶段的时间（不随喂狗重置，与_stageStart不同）
+
+    // 离开当前阶段前累计停留时间
+    void _noteStateTime();
+
+    // 进入stage的延迟（已按比例缩短），STAGE_NEVER表示不进入
+    uint32_t _stageDelay(State stage) const;
+
+    // 逐级进入到target，或回退到target
+    void _descendTo(State target);
+    void _climbTo(State target);
+
+    // 执行其他任务的请求
+    void _applyRequest();
+
+    // 按当前阶段和_stageStart重新设置下一级的定时器
+    void _armStageTimer();
+    static void _stageTimerEntry(void* context);
+
+    // 执行一次浅睡眠
+    void _enterLightSleep();
+
+    // 进入深度睡眠，prepare拒绝时返回
+    void _enterDeepSleep();
+
+    // 执行某一阶段的进入/退出回调
+    void _notifyEnter(State stage);
+    void _notifyExit(State stage);
 };
 
-#endif // SLEEP_MANAGER_H 
\ No newline at end of file
+#endif // SLEEP_MANAGER_H
@@ -0,0 +1,351 @@
+/**
+ * @file SoakTest.cpp
+ * @brief 浸泡测试实现
+ *
+ * @author Calculator Project
+ */
+
+#include "SoakTest.h"
+#include "Console.h"
+#include "KeyJournal.h"
+#include "Logger.h"
+#include "ResourceMonitor.h"
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <string.h>
+
+#define TAG_SOAK "Soak"
+
+namespace {
+
+// 按键编号（主层；次层的功能见各处注释）
+const uint8_t DIGIT_KEYS[10] = {5, 4, 9, 13, 3, 8, 12, 2, 7, 11};     // 0-9
+const uint8_t OPERATOR_KEYS[4] = {18, 17, 16, 21};                  // + - × ÷
+const uint8_t K_TAB = 6, K_PERCENT = 10, K_DOT = 14, K_BACK = 15, K_CLEAR = 19, K_SIGN = 20, K_DIV = 21, K_EQ = 22;
+// 次层：√ x² 1/x sin cos ln e^x
+const uint8_t SCIENTIFIC_KEYS[7] = {2, 3, 4, 16, 17, 19, 21};
+const uint8_t K_HIST_UP = 14, K_HIST_DOWN = 15;
+
+void cmdSoak(const ConsoleArgs& args) {
+    SoakTest& soak = SoakTest::instance();
+    int seed = 0;
+    if (args.count < 2) {
+        soak.printStatus(Serial);
+    } else if (args.is(1, "start") && (args.count == 2 || args.toInt(2, seed))) {
+        if (!soak.start((uint32_t)seed)) {
+            Serial.println("浸泡测试进行中");
+        } else {
+            soak.printStatus(Serial);
+        }
+    } else if (args.is(1, "stop")) {
+        soak.stop();
+    } else if (args.is(1, "windows")) {
+        soak.printWindows(Serial);
+    } else {
+        Serial.println("用法: soak [start [seed]|stop|windows]");
+    }
+}
+
+constexpr ConsoleCommand SOAK_COMMANDS[] = {
+    {"soak", "[start [seed]|stop|windows]", "浸泡测试：持续注入随机按键，按窗口检查堆、栈和输入延迟的漂移", cmdSoak},
+};
+static_assert(consoleSorted(SOAK_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+SoakTest::SoakTest()
+    : _perf(nullptr),
+      _keyTimer(TimerWheel::INVALID),
+      _sampleTimer(TimerWheel::INVALID),
+      _running(false),
+      _keyDown(false),
+      _seed(0),
+      _rng(1),
+      _startMs(0),
+      _sequenceLength(0),
+      _sequencePos(0),
+      _keys(0),
+      _samples(0),
+      _windowKeysBase(0),
+      _windowCount(0) {
+    memset(_last, 0, sizeof(_last));
+    memset(&_current, 0, sizeof(_current));
+    memset(_windows, 0, sizeof(_windows));
+    memset(_driftCount, 0, sizeof(_driftCount));
+}
+
+void SoakTest::begin(PerformanceMonitor* perf) {
+    _perf = perf;
+    _keyTimer = TimerWheel::instance().create("soak_key", onKeyTimer, this);
+    _sampleTimer = TimerWheel::instance().create("soak_sample", onSampleTimer, this);
+    KeyEventBus::instance().subscribe(KeySubscriber{"soak", KEY_EVENT_BIT(KEY_EVENT_PRESS), KEY_STAGE_FEEDBACK,
+                                                    onKey, nullptr, this});
+    Console::instance().addCommands(SOAK_COMMANDS);
+}
+
+const char* SoakTest::metricName(Metric metric) {
+    switch (metric) {
+        case METRIC_HEAP_FREE: return "内部RAM可用";
+        case METRIC_LARGEST_BLOCK: return "最大块";
+        case METRIC_STACK_FREE: return "栈余量";
+        case METRIC_KEY_P99: return "输入延迟p99";
+        default: return "?";
+    }
+}
+
+bool SoakTest::start(uint32_t seed) {
+    if (_running) return false;
+    _seed = seed ? seed : esp_random();
+    _rng = _seed ? _seed : 1;
+    _running = true;
+    _keyDown = false;
+    _startMs = millis();
+    _sequenceLength = 0;
+    _sequencePos = 0;
+    _keys = 0;
+    _samples = 0;
+    _windowCount = 0;
+    _windowKeysBase = 0;
+    memset(_last, 0, sizeof(_last));
+    memset(_driftCount, 0, sizeof(_driftCount));
+    for (uint8_t m = 0; m < METRIC_COUNT; m++) _current.value[m] = UINT32_MAX;
+    if (_perf) {
+        _perf->snapshotInput(_sampleBase);
+        _windowBase = _sampleBase;
+    }
+
+    LOG_I(TAG_SOAK, "浸泡测试开始，种子 %lu", (unsigned long)_seed);
+    TimerWheel::instance().start(_keyTimer, 0);
+    TimerWheel::instance().start(_sampleTimer, SOAK_SAMPLE_MS);
+    return true;
+}
+
+void SoakTest::stop() {
+    if (!_running) return;
+    TimerWheel::instance().cancel(_keyTimer);
+    TimerWheel::instance().cancel(_sampleTimer);
+    if (_keyDown) {
+        KeyJournal::instance().inject(KEY_EVENT_RELEASE, _sequence[_sequencePos - 1]);
+        _keyDown = false;
+    }
+    _running = false;
+    LOG_I(TAG_SOAK, "浸泡测试停止: 种子 %lu，运行 %lu 分钟，%lu 个按键，漂移 堆%lu 块%lu 栈%lu 延迟%lu",
+          (unsigned long)_seed, (unsigned long)((millis() - _startMs) / 60000), (unsigned long)_keys,
+          (unsigned long)_driftCount[METRIC_HEAP_FREE], (unsigned long)_driftCount[METRIC_LARGEST_BLOCK],
+          (unsigned long)_driftCount[METRIC_STACK_FREE], (unsigned long)_driftCount[METRIC_KEY_P99]);
+}
+
+uint32_t SoakTest::random(uint32_t bound) {
+    // xorshift32：同一种子得到同一按键序列
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng % bound;
+}
+
+void SoakTest::push(uint8_t key) {
+    if (_sequenceLength < SEQUENCE_CAPACITY) _sequence[_sequenceLength++] = key;
+}
+
+void SoakTest::pushNumber(uint8_t maxDigits) {
+    uint8_t digits = 1 + random(maxDigits);
+    for (uint8_t i = 0; i < digits; i++) {
+        push(DIGIT_KEYS[random(10)]);
+    }
+    if (random(4) == 0) {
+        push(K_DOT);
+        push(DIGIT_KEYS[random(10)]);
+    }
+}
+
+void SoakTest::generate() {
+    _sequenceLength = 0;
+    _sequencePos = 0;
+
+    uint32_t kind = random(100);
+    if (kind < 50) {
+        // 四则运算，一半带第二个运算符
+        pushNumber(4);
+        push(OPERATOR_KEYS[random(4)]);
+        pushNumber(4);
+        if (random(2)) {
+            push(OPERATOR_KEYS[random(4)]);
+            pushNumber(3);
+        }
+        push(K_EQ);
+    } else if (kind < 60) {
+        // 除以零出错，再清除
+        pushNumber(3);
+        push(K_DIV);
+        push(DIGIT_KEYS[0]);
+        push(K_EQ);
+        push(K_CLEAR);
+    } else if (kind < 70) {
+        // 超过输入长度上限
+        for (uint8_t i = 0; i < 24; i++) {
+            push(DIGIT_KEYS[random(10)]);
+        }
+        push(K_CLEAR);
+    } else if (kind < 80) {
+        // 退格、正负号、百分号
+        pushNumber(5);
+        push(K_BACK);
+        push(K_BACK);
+        pushNumber(2);
+        push(K_SIGN);
+        push(K_PERCENT);
+        push(OPERATOR_KEYS[random(4)]);
+        pushNumber(2);
+        push(K_EQ);
+    } else if (kind < 90) {
+        // 切换到次层做一次科学函数，再切回
+        pushNumber(2);
+        push(K_TAB);
+        push(SCIENTIFIC_KEYS[random(sizeof(SCIENTIFIC_KEYS))]);
+        push(K_TAB);
+        push(K_EQ);
+    } else {
+        // 在次层翻阅历史
+        push(K_TAB);
+        uint8_t steps = 1 + random(4);
+        for (uint8_t i = 0; i < steps; i++) {
+            push(K_HIST_UP);
+        }
+        push(K_HIST_DOWN);
+        push(K_TAB);
+        push(K_CLEAR);
+    }
+}
+
+void SoakTest::onKeyTimer(void* context) {
+    SoakTest* self = static_cast<SoakTest*>(context);
+    if (!self->_running) return;
+
+    KeyJournal& journal = KeyJournal::instance();
+    if (self->_keyDown) {
+        journal.inject(KEY_EVENT_RELEASE, self->_sequence[self->_sequencePos - 1]);
+        self->_keyDown = false;
+        TimerWheel::instance().start(self->_keyTimer, SOAK_KEY_GAP_MS);
+        return;
+    }
+
+    if (self->_sequencePos >= self->_sequenceLength) self->generate();
+    journal.inject(KEY_EVENT_PRESS, self->_sequence[self->_sequencePos++]);
+    self->_keyDown = true;
+    self->_keys++;
+    TimerWheel::instance().start(self->_keyTimer, KEY_HOLD_MS);
+}
+
+void SoakTest::onSampleTimer(void* context) {
+    SoakTest* self = static_cast<SoakTest*>(context);
+    if (!self->_running) return;
+    TimerWheel::instance().start(self->_sampleTimer, SOAK_SAMPLE_MS);
+    self->sample();
+}
+
+void SoakTest::sample() {
+    _last[METRIC_HEAP_FREE] = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    _last[METRIC_LARGEST_BLOCK] = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    // 栈余量用ResourceMonitor最近一次（同样每分钟）的采样
+    _last[METRIC_STACK_FREE] = ResourceMonitor::instance().lowestStackFree(nullptr);
+    _last[METRIC_KEY_P99] = 0;
+    if (_perf) {
+        PerfHistogram now;
+        _perf->snapshotInput(now);
+        _last[METRIC_KEY_P99] = now.getPercentileSince(_sampleBase, 990);
+        _sampleBase = now;
+    }
+    _samples++;
+
+    for (uint8_t m = METRIC_HEAP_FREE; m <= METRIC_STACK_FREE; m++) {
+        if (_last[m] < _current.value[m]) _current.value[m] = _last[m];
+    }
+    if (_samples % SOAK_WINDOW_SAMPLES == 0) closeWindow();
+}
+
+void SoakTest::closeWindow() {
+    _current.value[METRIC_KEY_P99] = 0;
+    if (_perf) {
+        PerfHistogram now;
+        _perf->snapshotInput(now);
+        _current.value[METRIC_KEY_P99] = now.getPercentileSince(_windowBase, 990);
+        _windowBase = now;
+    }
+    _current.keys = _keys - _windowKeysBase;
+    _windowKeysBase = _keys;
+
+    _windows[_windowCount % SOAK_WINDOWS] = _current;
+    _windowCount++;
+    LOG_I(TAG_SOAK, "窗口 %lu: 可用 %lu 最大块 %lu 栈余量 %lu p99 %lu us，%lu 个按键",
+          (unsigned long)_windowCount, (unsigned long)_current.value[METRIC_HEAP_FREE],
+          (unsigned long)_current.value[METRIC_LARGEST_BLOCK], (unsigned long)_current.value[METRIC_STACK_FREE],
+          (unsigned long)_current.value[METRIC_KEY_P99], (unsigned long)_current.keys);
+    checkDrift();
+
+    for (uint8_t m = 0; m < METRIC_COUNT; m++) _current.value[m] = UINT32_MAX;
+}
+
+void SoakTest::checkDrift() {
+    static_assert(SOAK_DRIFT_WINDOWS < SOAK_WINDOWS, "漂移检查的窗口数必须小于保留的窗口数");
+    if (_windowCount <= SOAK_DRIFT_WINDOWS) return;
+
+    for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+        bool worsening = true;
+        for (uint32_t i = 0; i < SOAK_DRIFT_WINDOWS && worsening; i++) {
+            uint32_t newer = _windows[(_windowCount - 1 - i) % SOAK_WINDOWS].value[m];
+            uint32_t older = _windows[(_windowCount - 2 - i) % SOAK_WINDOWS].value[m];
+            worsening = m == METRIC_KEY_P99 ? newer > older : newer < older;
+        }
+        if (!worsening) continue;
+
+        _driftCount[m]++;
+        uint32_t first = _windows[(_windowCount - 1 - SOAK_DRIFT_WINDOWS) % SOAK_WINDOWS].value[m];
+        uint32_t last = _windows[(_windowCount - 1) % SOAK_WINDOWS].value[m];
+        LOG_W(TAG_SOAK, "%s连续 %d 个窗口变差: %lu → %lu（种子 %lu，第 %lu 个窗口）", metricName((Metric)m),
+              SOAK_DRIFT_WINDOWS, (unsigned long)first, (unsigned long)last, (unsigned long)_seed,
+              (unsigned long)_windowCount);
+    }
+}
+
+void SoakTest::printStatus(Print& out) const {
+    if (!_running) {
+        out.printf("浸泡测试: 未运行，采样间隔 %lu s，窗口 %d 次采样\n",
+                   (unsigned long)(SOAK_SAMPLE_MS / 1000), SOAK_WINDOW_SAMPLES);
+    } else {
+        out.printf("浸泡测试: 种子 %lu，运行 %lu 分钟，%lu 个按键，%lu 次采样，%lu 个窗口\n",
+                   (unsigned long)_seed, (unsigned long)((millis() - _startMs) / 60000), (unsigned long)_keys,
+                   (unsigned long)_samples, (unsigned long)_windowCount);
+    }
+    if (!_samples) return;
+    out.printf("  最近采样: 可用 %lu  最大块 %lu  栈余量 %lu  p99 %lu us\n",
+               (unsigned long)_last[METRIC_HEAP_FREE], (unsigned long)_last[METRIC_LARGEST_BLOCK],
+               (unsigned long)_last[METRIC_STACK_FREE], (unsigned long)_last[METRIC_KEY_P99]);
+    out.print("  漂移次数:");
+    for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+        out.printf("  %s %lu", metricName((Metric)m), (unsigned long)_driftCount[m]);
+    }
+    out.println();
+}
+
+void SoakTest::printWindows(Print& out) const {
+    uint32_t count = _windowCount < SOAK_WINDOWS ? _windowCount : SOAK_WINDOWS;
+    if (!count) {
+        out.println("还没有完整的窗口");
+        return;
+    }
+    out.println(" 窗口      可用    最大块  栈余量  p99(us)    按键");
+    for (uint32_t i = _windowCount - count; i < _windowCount; i++) {
+        const Window& w = _windows[i % SOAK_WINDOWS];
+        out.printf(" %4lu  %8lu  %8lu  %6lu  %7lu  %6lu\n", (unsigned long)(i + 1),
+                   (unsigned long)w.value[METRIC_HEAP_FREE], (unsigned long)w.value[METRIC_LARGEST_BLOCK],
+                   (unsigned long)w.value[METRIC_STACK_FREE], (unsigned long)w.value[METRIC_KEY_P99],
+                   (unsigned long)w.keys);
+    }
+}
+
+void SoakTest::onKey(const KeyEvent& event, void* context) {
+    SoakTest* self = static_cast<SoakTest*>(context);
+    if (!self->_running || (event.flags & KEY_EVENT_FLAG_REPLAY)) return;
+    LOG_I(TAG_SOAK, "有按键，浸泡测试停止");
+    self->stop();
+}
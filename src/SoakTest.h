@@ -0,0 +1,116 @@
+/**
+ * @file SoakTest.h
+ * @brief 浸泡测试：长时间注入随机按键，检查堆、栈和输入延迟是否持续恶化
+ * @details 泄漏和碎片要连续使用几天才看得出来：
+ * - 串口命令 soak start [seed] 开始，经按键日志每 SOAK_KEY_GAP_MS 注入一个按键；
+ *   按键序列随机组合四则运算、除以零出错、长数字、退格和正负号、Tab切换到次层做科学函数、
+ *   翻阅历史，等号不断产生的计算记录让历史日志反复写满回绕
+ * - 每 SOAK_SAMPLE_MS 采样内部RAM可用量、最大块、各任务中最小的栈余量（ResourceMonitor）
+ *   和这段时间的输入延迟p99（PerformanceMonitor）
+ * - 每 SOAK_WINDOW_SAMPLES 次采样合成一个窗口（可用量、最大块、栈余量取最小值，p99取整个窗口的），
+ *   保留最近 SOAK_WINDOWS 个；某项连续 SOAK_DRIFT_WINDOWS 个窗口都比前一个差时记一次漂移，
+ *   写入日志（日志文件在断开主机时也保留，之后用 log_dump 取回）
+ * - 有真实按键时停止，种子和已运行时间写入日志，出问题时可用同一种子复现
+ *
+ * @author Calculator Project
+ */
+
+#ifndef SOAK_TEST_H
+#define SOAK_TEST_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "KeyEventBus.h"
+#include "PerformanceMonitor.h"
+#include "TimerWheel.h"
+
+class SoakTest {
+public:
+    /**
+     * @brief 检查的指标
+     */
+    enum Metric : uint8_t {
+        METRIC_HEAP_FREE,       ///< 内部RAM可用量（变小为差）
+        METRIC_LARGEST_BLOCK,   ///< 内部RAM最大块（变小为差）
+        METRIC_STACK_FREE,      ///< 最小的栈余量（变小为差）
+        METRIC_KEY_P99,         ///< 输入延迟p99（变大为差）
+        METRIC_COUNT
+    };
+
+    static SoakTest& instance() {
+        static SoakTest instance;
+        return instance;
+    }
+
+    /**
+     * @brief 订阅按键并注册串口命令
+     * @param perf 输入延迟的来源，nullptr时不统计延迟
+     */
+    void begin(PerformanceMonitor* perf);
+
+    /**
+     * @brief 开始测试，之前的采样和窗口清空
+     * @param seed 随机种子，0表示取硬件随机数
+     * @return 已在运行时返回false
+     */
+    bool start(uint32_t seed);
+    void stop();
+    bool isRunning() const { return _running; }
+
+    void printStatus(Print& out) const;
+    void printWindows(Print& out) const;
+
+    static const char* metricName(Metric metric);
+
+private:
+    static const uint16_t KEY_HOLD_MS = 60;     ///< 每次按住的时间，短于Tab的长按
+    static const uint8_t SEQUENCE_CAPACITY = 32;
+
+    struct Window {
+        uint32_t value[METRIC_COUNT];
+        uint32_t keys;              ///< 本窗口注入的按键数
+    };
+
+    SoakTest();
+    SoakTest(const SoakTest&) = delete;
+    SoakTest& operator=(const SoakTest&) = delete;
+
+    static void onKeyTimer(void* context);
+    static void onSampleTimer(void* context);
+    static void onKey(const KeyEvent& event, void* context);
+
+    uint32_t random(uint32_t bound);
+    void push(uint8_t key);
+    void pushNumber(uint8_t maxDigits);
+    void generate();
+    void sample();
+    void closeWindow();
+    void checkDrift();
+
+    PerformanceMonitor* _perf;
+    TimerWheel::TimerId _keyTimer;
+    TimerWheel::TimerId _sampleTimer;
+    bool _running;
+    bool _keyDown;
+    uint32_t _seed;
+    uint32_t _rng;
+    uint32_t _startMs;
+
+    uint8_t _sequence[SEQUENCE_CAPACITY];  ///< 待注入的按键
+    uint8_t _sequenceLength;
+    uint8_t _sequencePos;
+
+    uint32_t _keys;                 ///< 累计注入的按键数
+    uint32_t _samples;              ///< 累计采样次数
+    uint32_t _last[METRIC_COUNT];   ///< 最近一次采样
+    Window _current;                ///< 正在累计的窗口
+    uint32_t _windowKeysBase;
+    PerfHistogram _sampleBase;      ///< 上次采样时的输入延迟统计
+    PerfHistogram _windowBase;      ///< 窗口开始时的输入延迟统计
+
+    Window _windows[SOAK_WINDOWS];
+    uint32_t _windowCount;          ///< 累计窗口数，环形保存最近SOAK_WINDOWS个
+    uint32_t _driftCount[METRIC_COUNT];
+};
+
+#endif // SOAK_TEST_H
@@ -0,0 +1,238 @@
+/**
+ * @file SpatialEffects.cpp
+ * @brief 按面板坐标计算的按键灯效果实现
+ *
+ * @author Calculator Project
+ */
+
+#include "SpatialEffects.h"
+#include "LedLayout.h"
+#include "Console.h"
+#include "Logger.h"
+#include "LoopScheduler.h"
+#include <esp_timer.h>
+
+#define TAG_SPATIAL "Spatial"
+
+// 涟漪：每60ms扩散一个键距，环宽一个键距
+#define RIPPLE_SPEED_Q8 (LedLayout::UNIT * 256 / 60)   // 每毫秒的半径增量（UNIT，Q8定点）
+#define RIPPLE_WIDTH LedLayout::UNIT
+
+// 热度：每次按键加48，每250ms乘231/256（约14秒从满热度冷却到0）
+#define HEAT_BUMP 48
+#define HEAT_DECAY_MS 250
+#define HEAT_DECAY_SCALE 230
+#define HEAT_BRIGHTNESS 96
+
+// 噪声：空间上每个键距16个噪声单位（整个面板约5个格点），时间上每毫秒3/16个单位
+#define NOISE_SPACE_SCALE 16
+#define NOISE_TIME_Q4 3
+#define NOISE_FADE_IN_SHIFT 2       // 空闲后约1秒渐显到满亮度
+#define NOISE_BRIGHTNESS 64
+
+namespace {
+
+const char* const EFFECT_NAMES[SPATIAL_EFFECT_COUNT] = {"ripple", "heat", "noise"};
+
+void cmdFx(const ConsoleArgs& args) {
+    SpatialEffects& fx = SpatialEffects::instance();
+    if (args.count < 2) {
+        fx.printStats();
+        return;
+    }
+    for (uint8_t e = 0; e < SPATIAL_EFFECT_COUNT; e++) {
+        if (!args.is(1, EFFECT_NAMES[e])) continue;
+        if (args.is(2, "on") || args.is(2, "off")) {
+            fx.setEnabled((SpatialEffect)e, args.is(2, "on"));
+            Serial.printf("%s 效果已%s\n", EFFECT_NAMES[e], args.is(2, "on") ? "开启" : "关闭");
+            return;
+        }
+        break;
+    }
+    Serial.println("用法: fx [ripple|heat|noise <on|off>]");
+}
+
+constexpr ConsoleCommand SPATIAL_COMMANDS[] = {
+    {"fx", "[ripple|heat|noise <on|off>]", "开关按键灯空间效果，无参数时显示各效果耗时", cmdFx},
+};
+static_assert(consoleSorted(SPATIAL_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+SpatialEffects::SpatialEffects()
+    : _enabled(0),
+      _nextRipple(0),
+      _heatDecayAt(0),
+      _lastKeyTime(0) {
+    memset(_ripples, 0, sizeof(_ripples));
+    memset(_heat, 0, sizeof(_heat));
+    memset(_stats, 0, sizeof(_stats));
+}
+
+void SpatialEffects::begin() {
+    // 热度的着色连同亮度一起展开；色相表是满饱和满亮度的彩虹色
+    _heatLut.compile([](uint8_t heat) -> CRGB {
+        CRGB c = HeatColor(heat);
+        return c.nscale8_video(HEAT_BRIGHTNESS);
+    });
+    _hueLut.compile([](uint8_t hue) -> CRGB { return CHSV(hue, 255, 255); });
+    Console::instance().addCommands(SPATIAL_COMMANDS);
+}
+
+void SpatialEffects::setEnabled(SpatialEffect effect, bool enabled) {
+    if (effect >= SPATIAL_EFFECT_COUNT) return;
+    if (enabled) {
+        _enabled |= 1 << effect;
+        _stats[effect].strikes = 0;
+    } else {
+        _enabled &= ~(1 << effect);
+    }
+}
+
+void SpatialEffects::onKeyPress(uint8_t led, CRGB color) {
+    uint32_t now = millis();
+    _lastKeyTime = now;
+    if (led >= NUM_LEDS) return;
+
+    if (isEnabled(SPATIAL_RIPPLE)) {
+        // 找空位，没有则覆盖最早的
+        uint8_t slot = _nextRipple;
+        for (uint8_t i = 0; i < MAX_RIPPLES; i++) {
+            if (!_ripples[i].active) {
+                slot = i;
+                break;
+            }
+        }
+        _ripples[slot] = {true, led, now, color};
+        _nextRipple = (slot + 1) % MAX_RIPPLES;
+    }
+
+    if (isEnabled(SPATIAL_HEAT)) {
+        if (_heatDecayAt == 0) _heatDecayAt = now + HEAT_DECAY_MS;
+        _heat[led] = qadd8(_heat[led], HEAT_BUMP);
+    }
+}
+
+bool SpatialEffects::render(uint32_t now, CRGB* out) {
+    fill_solid(out, NUM_LEDS, CRGB::Black);
+    if (!_enabled) return false;
+
+    bool active = false;
+    for (uint8_t e = 0; e < SPATIAL_EFFECT_COUNT; e++) {
+        if (!isEnabled((SpatialEffect)e)) continue;
+
+        int64_t start = esp_timer_get_time();
+        switch (e) {
+            case SPATIAL_RIPPLE: active |= renderRipples(now, out); break;
+            case SPATIAL_HEAT:   active |= renderHeat(now, out); break;
+            case SPATIAL_NOISE:  active |= renderNoise(now, out); break;
+        }
+        checkBudget((SpatialEffect)e, (uint32_t)(esp_timer_get_time() - start));
+    }
+    return active;
+}
+
+bool SpatialEffects::renderRipples(uint32_t now, CRGB* out) {
+    const LedLayout& layout = LedLayout::instance();
+    const uint32_t reach = layout.maxDistance() + RIPPLE_WIDTH;
+    bool active = false;
+
+    for (uint8_t r = 0; r < MAX_RIPPLES; r++) {
+        Ripple& ripple = _ripples[r];
+        if (!ripple.active) continue;
+
+        uint32_t radius = ((now - ripple.startTime) * RIPPLE_SPEED_Q8) >> 8;
+        if (radius >= reach) {
+            ripple.active = false;
+            continue;
+        }
+        active = true;
+
+        // 越往外越暗，到达最远的键时熄灭
+        uint8_t fade = 255 - radius * 255 / reach;
+        const uint8_t* distances = layout.distancesFrom(ripple.origin);
+        for (uint8_t i = 0; i < NUM_LEDS; i++) {
+            int32_t diff = (int32_t)distances[i] - (int32_t)radius;
+            if (diff < 0) diff = -diff;
+            if (diff >= RIPPLE_WIDTH) continue;
+            uint8_t level = scale8(255 - diff * 255 / RIPPLE_WIDTH, fade);
+            CRGB c = ripple.color;
+            out[i] += c.nscale8_video(level);
+        }
+    }
+    return active;
+}
+
+bool SpatialEffects::renderHeat(uint32_t now, CRGB* out) {
+    // 按固定步长衰减，与帧率无关；长时间没有刷新时最多补32步（足够冷却到0）
+    uint8_t steps = 0;
+    while (_heatDecayAt && (int32_t)(now - _heatDecayAt) >= 0 && steps < 32) {
+        _heatDecayAt += HEAT_DECAY_MS;
+        steps++;
+    }
+
+    bool active = false;
+    for (uint8_t i = 0; i < NUM_LEDS; i++) {
+        for (uint8_t s = 0; s < steps && _heat[i]; s++) {
+            _heat[i] = scale8(_heat[i], HEAT_DECAY_SCALE);
+        }
+        if (!_heat[i]) continue;
+        active = true;
+        out[i] += _heatLut[_heat[i]];
+    }
+    if (!active) _heatDecayAt = 0;
+    return active;
+}
+
+bool SpatialEffects::renderNoise(uint32_t now, CRGB* out) {
+    uint32_t idle = now - _lastKeyTime;
+    if (idle < SPATIAL_IDLE_MS) {
+        LoopScheduler::instance().at(_lastKeyTime + SPATIAL_IDLE_MS);
+        return false;
+    }
+
+    uint32_t fadeIn = (idle - SPATIAL_IDLE_MS) >> NOISE_FADE_IN_SHIFT;
+    uint8_t level = fadeIn >= 255 ? NOISE_BRIGHTNESS : scale8(fadeIn, NOISE_BRIGHTNESS);
+
+    // 时间为Q4定点，16位噪声坐标回绕时噪声场是连续的
+    const LedLayout& layout = LedLayout::instance();
+    uint16_t z = (uint16_t)((now * NOISE_TIME_Q4) >> 4);
+    uint8_t hueDrift = z >> 8;
+    for (uint8_t i = 0; i < NUM_LEDS; i++) {
+        uint8_t n = inoise8(layout.x(i) * NOISE_SPACE_SCALE, layout.y(i) * NOISE_SPACE_SCALE, z);
+        // 等同于 CHSV(hue, 255, v)：hsv2rgb_rainbow在满饱和时先算满亮度的颜色，
+        // 再按 scale8_video(v, v) 逐通道缩放
+        CRGB c = _hueLut[(uint8_t)(hueDrift + n)];
+        uint8_t v = scale8(n, level);
+        if (v != 255) c.nscale8(scale8_video(v, v));
+        out[i] += c;
+    }
+    return true;
+}
+
+void SpatialEffects::checkBudget(SpatialEffect effect, uint32_t us) {
+    EffectStats& stats = _stats[effect];
+    stats.lastUs = us > 0xFFFF ? 0xFFFF : us;
+    if (stats.lastUs > stats.maxUs) stats.maxUs = stats.lastUs;
+
+    if (us <= SPATIAL_EFFECT_BUDGET_US) {
+        stats.strikes = 0;
+        return;
+    }
+    // 偶尔被中断或高优先级任务打断不算；连续超时才关闭
+    stats.overruns++;
+    if (++stats.strikes >= SPATIAL_BUDGET_STRIKES) {
+        setEnabled(effect, false);
+        LOG_W(TAG_SPATIAL, "%s 效果连续%d帧超过%dus，已关闭", EFFECT_NAMES[effect],
+              SPATIAL_BUDGET_STRIKES, SPATIAL_EFFECT_BUDGET_US);
+    }
+}
+
+void SpatialEffects::printStats() const {
+    Serial.printf("空间效果（每帧预算 %dus）:\n", SPATIAL_EFFECT_BUDGET_US);
+    for (uint8_t e = 0; e < SPATIAL_EFFECT_COUNT; e++) {
+        const EffectStats& stats = _stats[e];
+        Serial.printf(" - %-6s %s  上一帧 %uus  最大 %uus  超预算 %u 帧\n", EFFECT_NAMES[e],
+                      isEnabled((SpatialEffect)e) ? "开" : "关", stats.lastUs, stats.maxUs, stats.overruns);
+    }
+}
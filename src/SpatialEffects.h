@@ -0,0 +1,100 @@
+/**
+ * @file SpatialEffects.h
+ * @brief 按面板坐标计算的按键灯效果
+ * @details 效果按位置和时间求值，每帧只算NUM_LEDS个点，结果作为按键灯图层合成的底色：
+ * - 涟漪：从按下的键向外扩散的圆环，距离查LedLayout的距离表，半径按毫秒定点推进
+ * - 热度：每次按键给该键加热，按固定步长衰减，按HeatColor着色（启动时展开成查找表）
+ * - 噪声：无按键SPATIAL_IDLE_MS后渐显的inoise8流动色场，色相查表
+ * - 每个效果每帧计时，连续SPATIAL_BUDGET_STRIKES帧超过SPATIAL_EFFECT_BUDGET_US就关闭该效果
+ * - 默认全部关闭，串口命令 fx 开关和查看耗时
+ *
+ * @author Calculator Project
+ */
+
+#ifndef SPATIAL_EFFECTS_H
+#define SPATIAL_EFFECTS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "PaletteLut.h"
+
+enum SpatialEffect {
+    SPATIAL_RIPPLE,     ///< 按键涟漪
+    SPATIAL_HEAT,       ///< 使用热度
+    SPATIAL_NOISE,      ///< 空闲噪声场
+    SPATIAL_EFFECT_COUNT
+};
+
+class SpatialEffects {
+public:
+    static SpatialEffects& instance() {
+        static SpatialEffects instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册串口命令
+     */
+    void begin();
+
+    void setEnabled(SpatialEffect effect, bool enabled);
+    bool isEnabled(SpatialEffect effect) const { return _enabled & (1 << effect); }
+
+    /**
+     * @brief 按键按下：起一个涟漪并给该键加热
+     * @param led 按键对应的LED
+     * @param color 涟漪颜色（按键反馈色）
+     */
+    void onKeyPress(uint8_t led, CRGB color);
+
+    /**
+     * @brief 计算当前帧的颜色
+     * @param now 当前时间(ms)
+     * @param out NUM_LEDS个颜色，先清零再叠加各效果
+     * @return 有效果在输出（需要继续逐帧刷新）
+     */
+    bool render(uint32_t now, CRGB* out);
+
+    /**
+     * @brief 打印各效果的开关状态和耗时
+     */
+    void printStats() const;
+
+private:
+    static const uint8_t MAX_RIPPLES = 4;
+
+    struct Ripple {
+        bool active;
+        uint8_t origin;         ///< 起点LED
+        uint32_t startTime;
+        CRGB color;
+    };
+
+    struct EffectStats {
+        uint16_t lastUs;        ///< 上一帧耗时
+        uint16_t maxUs;         ///< 最大耗时
+        uint8_t strikes;        ///< 连续超预算的帧数
+        uint32_t overruns;      ///< 累计超预算的帧数
+    };
+
+    SpatialEffects();
+    SpatialEffects(const SpatialEffects&) = delete;
+    SpatialEffects& operator=(const SpatialEffects&) = delete;
+
+    bool renderRipples(uint32_t now, CRGB* out);
+    bool renderHeat(uint32_t now, CRGB* out);
+    bool renderNoise(uint32_t now, CRGB* out);
+    void checkBudget(SpatialEffect effect, uint32_t us);
+
+    uint8_t _enabled;           ///< 各效果的开关位
+    Ripple _ripples[MAX_RIPPLES];
+    uint8_t _nextRipple;        ///< 没有空位时覆盖最早的涟漪
+    uint8_t _heat[NUM_LEDS];
+    PaletteLut _heatLut;        ///< 热度 → 颜色（已按HEAT_BRIGHTNESS缩放）
+    PaletteLut _hueLut;         ///< 色相 → 满亮度彩虹色
+    uint32_t _heatDecayAt;      ///< 下一次衰减的时间
+    uint32_t _lastKeyTime;      ///< 最后一次按键，噪声场在空闲后才出现
+    EffectStats _stats[SPATIAL_EFFECT_COUNT];
+};
+
+#endif // SPATIAL_EFFECTS_H
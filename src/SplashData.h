@@ -0,0 +1,224 @@
+// 由 tools/splash_pack.py 生成，不要手工修改
+// 来源: 默认画面（字体: DejaVuSansMono.ttf）
+// 480x135 RGB565，QOI565压缩 4963 字节（原始 129600 字节）
+
+#ifndef SPLASH_DATA_H
+#define SPLASH_DATA_H
+
+#include <stdint.h>
+
+static const uint16_t SPLASH_WIDTH = 480;
+static const uint16_t SPLASH_HEIGHT = 135;
+static const uint32_t SPLASH_DATA_SIZE = 4963;
+
+static const uint8_t SPLASH_DATA[4963] = {
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC6, 0xA8, 0xA4, 0xAB, 0xB3, 0xA3, 0xA7, 0x9A, 0x6B, 0x95, 0x6E, 0x00, 0xD1,
+    0x3A, 0x09, 0x21, 0x34, 0x25, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xCD, 0x34, 0xFE, 0xDC, 0x80, 0xA5, 0xA6, 0xC3, 0x95, 0x6E, 0xFE,
+    0x41, 0x60, 0x00, 0xCD, 0x34, 0x05, 0x2A, 0xC3, 0x1B, 0x0F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC9, 0xA2, 0x97, 0xFE, 0xAB, 0x60,
+    0x2A, 0xC7, 0x09, 0x00, 0xCA, 0x10, 0x06, 0x2A, 0xC7, 0x09, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC8, 0xFE, 0xCC, 0x20, 0x2A, 0xC9,
+    0x21, 0x00, 0xC9, 0x30, 0x2A, 0xC9, 0x21, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC6, 0xFE, 0x9B, 0x20, 0x2A, 0xCB, 0xFE, 0x51, 0xA0,
+    0x00, 0xC7, 0x36, 0x2A, 0xCB, 0x1F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC4, 0x0F, 0x2A, 0xCC, 0x9D, 0x8A, 0x10, 0x00, 0xC5, 0x0F,
+    0x2A, 0xCC, 0x15, 0x10, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC3, 0x05, 0x2A, 0xCD, 0x21, 0x00, 0xC5, 0x05, 0x2A, 0xCD, 0x21, 0x00,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC2, 0x0F, 0x2A, 0xCE, 0x15, 0x10, 0x00, 0xC3, 0x0F, 0x2A, 0xCE, 0x15, 0x10, 0x00, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xC1, 0x06, 0x2A, 0xCF, 0x34, 0x00, 0xC3, 0x06, 0x2A, 0xCF, 0x34, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC1,
+    0x15, 0x2A, 0xCF, 0x36, 0x00, 0xC3, 0x15, 0x2A, 0xCF, 0x36, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC0, 0x0F, 0x2A, 0xD0, 0x15, 0x00,
+    0xC2, 0x0F, 0x2A, 0xD0, 0x15, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC0, 0x34, 0x2A, 0xD1, 0x10, 0x00, 0xC1, 0x34, 0x2A, 0xD1, 0x10,
+    0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xC1, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xC1, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0x1B, 0x2A, 0xD1, 0x0F,
+    0x00, 0xC1, 0x1B, 0x2A, 0xD1, 0x0F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xC1, 0x21, 0x2A, 0xD1, 0x0F,
+    0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xC1, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0x34, 0x2A, 0xD1, 0x10, 0x00, 0xC1, 0x34, 0x2A, 0xD1, 0x10, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0x0F, 0x2A, 0xD0, 0x15,
+    0x00, 0xC2, 0x0F, 0x2A, 0xD0, 0x15, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC1, 0x15, 0x2A, 0xCF, 0x36, 0x00, 0xC3, 0x15, 0x2A, 0xCF,
+    0x36, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC1, 0x06, 0x2A, 0xCF, 0x34, 0x00, 0xC3, 0x06, 0x2A, 0xCF, 0x34, 0x00, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xF1, 0x0F, 0x21, 0xC0, 0x34, 0x25, 0x00, 0xC7, 0x0F, 0x2A, 0xCE, 0x15, 0x10, 0x00, 0xC3, 0x0F, 0x2A, 0xCE, 0x15, 0x10, 0x00,
+    0xC7, 0x0F, 0x21, 0xC0, 0x34, 0x25, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xE1, 0x21, 0x15, 0x2A, 0xC3, 0x05, 0x0F, 0x00, 0xC6, 0x05, 0x2A,
+    0xCD, 0x21, 0x00, 0xC5, 0x05, 0x2A, 0xCD, 0x21, 0x00, 0xC6, 0x21, 0x15, 0x2A, 0xC3, 0x05, 0x0F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xDD,
+    0x25, 0x30, 0x2A, 0xC7, 0x36, 0x00, 0xC5, 0x0F, 0x2A, 0xCC, 0x15, 0x10, 0x00, 0xC5, 0x0F, 0x2A, 0xCC, 0x15, 0x10, 0x00, 0xC4, 0x25, 0x30, 0x2A,
+    0xC7, 0x36, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xDB, 0x10, 0x15, 0x2A, 0xC9, 0x36, 0x00, 0xC5, 0x36, 0x2A, 0xCB, 0x1F, 0x00, 0xC7, 0x36,
+    0x2A, 0xCB, 0x1F, 0x00, 0xC4, 0x10, 0x15, 0x2A, 0xC9, 0x36, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xDA, 0x30, 0x2A, 0xCB, 0x21, 0x00, 0xC5,
+    0x30, 0x2A, 0xC9, 0x21, 0x00, 0xC9, 0x30, 0x2A, 0xC9, 0x21, 0x00, 0xC5, 0x30, 0x2A, 0xCB, 0x21, 0x00, 0xFD, 0xFD, 0xC7, 0xB1, 0x88, 0x97, 0x99,
+    0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xCD, 0x21, 0x2A, 0xCD, 0x3A, 0x00, 0xC4, 0xA2, 0x97, 0x06, 0x2A, 0xC7, 0x09, 0x00, 0xCA, 0x10, 0x06, 0x2A, 0xC7,
+    0x09, 0x00, 0xC5, 0x21, 0x2A, 0xCD, 0x3A, 0x00, 0xDC, 0x82, 0x88, 0xCB, 0x25, 0x9B, 0x99, 0x00, 0xFD, 0xD1, 0xA4, 0x88, 0xB5, 0x88, 0xB1, 0x99,
+    0xAD, 0x88, 0xA8, 0x88, 0xC3, 0x21, 0x24, 0x35, 0x28, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xC7, 0x10, 0x15, 0x2A, 0xCD, 0x1B, 0x00, 0xC6, 0x34, 0x05,
+    0x2A, 0xC3, 0x1B, 0x0F, 0x00, 0xCD, 0x34, 0x05, 0x2A, 0xC3, 0x1B, 0x0F, 0x00, 0xC5, 0x10, 0x15, 0x2A, 0xCD, 0x1B, 0x00, 0xDC, 0x31, 0xCD, 0x9C,
+    0x88, 0x8B, 0x99, 0x38, 0x00, 0xFD, 0xCD, 0x14, 0x09, 0x31, 0xCA, 0x3C, 0x82, 0x88, 0x00, 0xFD, 0xE6, 0x28, 0x25, 0xC2, 0x28, 0x00, 0xFD, 0xFD,
+    0xD5, 0xFE, 0x8A, 0xC0, 0x2A, 0xCF, 0x3A, 0x00, 0xC7, 0x3A, 0xAB, 0xB3, 0x21, 0x34, 0x95, 0x6E, 0x00, 0xD1, 0x3A, 0x09, 0x21, 0x34, 0x25, 0x00,
+    0xC7, 0x21, 0x2A, 0xCF, 0x3A, 0x00, 0xDB, 0x31, 0xD0, 0x24, 0x28, 0x00, 0xFD, 0xC9, 0x38, 0x87, 0x88, 0x31, 0xCD, 0x14, 0x00, 0xFD, 0xE6, 0xB1,
+    0x88, 0x31, 0xC2, 0x25, 0x00, 0xFD, 0xFD, 0xD5, 0x05, 0x2A, 0xCF, 0x21, 0x00, 0xED, 0x05, 0x2A, 0xCF, 0x21, 0x00, 0xDB, 0x31, 0xD1, 0x98, 0x88,
+    0x38, 0x00, 0xFD, 0xC7, 0x38, 0x8F, 0x88, 0x31, 0xC5, 0x39, 0x9B, 0x99, 0x39, 0x31, 0xC4, 0x14, 0x00, 0xFD, 0xE6, 0x25, 0x31, 0xC2, 0x25, 0x00,
+    0xFD, 0xFD, 0xD4, 0x3A, 0x2A, 0xD0, 0x05, 0x00, 0xEC, 0x3A, 0x2A, 0xD0, 0x05, 0x00, 0xDB, 0x31, 0xC3, 0x14, 0xC5, 0x24, 0x21, 0x31, 0xC4, 0x39,
+    0x28, 0x00, 0xFD, 0xC5, 0x10, 0x09, 0x31, 0xC3, 0x3C, 0x25, 0x00, 0xC3, 0x25, 0x14, 0x09, 0x31, 0xC0, 0x14, 0x00, 0xFD, 0xE6, 0x25, 0x31, 0xC2,
+    0x25, 0x00, 0xFD, 0xFD, 0xD4, 0x34, 0x2A, 0xD1, 0x00, 0xEC, 0x34, 0x2A, 0xD1, 0x00, 0xDB, 0x31, 0xC3, 0x00, 0xC7, 0x35, 0x21, 0x31, 0xC3, 0x14,
+    0x00, 0xFD, 0xC5, 0x0C, 0x31, 0xC2, 0x09, 0x25, 0x00, 0xC7, 0x28, 0x14, 0x09, 0x14, 0x00, 0xFD, 0xE6, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xFD, 0xFD,
+    0xD4, 0xFE, 0x8A, 0xC0, 0x2A, 0xD1, 0x0F, 0x00, 0xEB, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xDA, 0x31, 0xC3, 0x00, 0xC8, 0x28, 0x39, 0x31, 0xC2, 0x09,
+    0x28, 0x00, 0xFD, 0xC3, 0x35, 0x31, 0xC2, 0x09, 0x38, 0x00, 0xCA, 0x38, 0xA9, 0x88, 0x00, 0xFD, 0xE6, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xFD, 0xFD,
+    0xD4, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xEB, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xDA, 0x31, 0xC3, 0x00, 0xC9, 0x38, 0x31, 0xC3, 0x35, 0x00, 0xFD, 0xC3,
+    0x09, 0x31, 0xC2, 0x0D, 0x00, 0xFD, 0xF5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xFD, 0xFD, 0xD4, 0x1B, 0x2A, 0xD1, 0x0F, 0x00, 0xEB, 0x1B, 0x2A, 0xD1,
+    0x0F, 0x00, 0xDA, 0x31, 0xC3, 0x00, 0xCA, 0x24, 0x31, 0xC2, 0x3C, 0x00, 0xCD, 0x38, 0x25, 0x10, 0x00, 0xEE, 0x35, 0x31, 0xC2, 0x0C, 0x00, 0xDF,
+    0x38, 0x25, 0x00, 0xFA, 0x25, 0x38, 0x00, 0xD3, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xDB, 0x38, 0xC0, 0x00, 0xE0, 0x25, 0x38, 0x00, 0xFD, 0xCF, 0x21,
+    0x2A, 0xD1, 0x0F, 0x00, 0xEB, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xDA, 0x31, 0xC3, 0x00, 0xCA, 0x35, 0x31, 0xC2, 0x0C, 0x00, 0xC7, 0x28, 0x0D, 0x14,
+    0x0C, 0x31, 0xC4, 0x09, 0x24, 0x35, 0x28, 0x00, 0xC6, 0x28, 0x14, 0xC2, 0x10, 0x00, 0xD2, 0x14, 0xC2, 0x25, 0x00, 0xC2, 0x39, 0x31, 0xC2, 0x35,
+    0x00, 0xDB, 0x35, 0x24, 0x09, 0x31, 0xC3, 0x0C, 0x8F, 0x88, 0x28, 0x00, 0xCB, 0x10, 0x14, 0xC2, 0x10, 0x00, 0xC9, 0x14, 0xC2, 0x10, 0x00, 0xC6,
+    0x25, 0x14, 0xC1, 0x35, 0x00, 0xC1, 0x10, 0x3C, 0x09, 0x31, 0xC2, 0x39, 0x1D, 0x28, 0x00, 0xC8, 0x25, 0x14, 0xC4, 0x3C, 0x31, 0xC2, 0x3C, 0x14,
+    0xC7, 0x10, 0x00, 0xCC, 0x10, 0x1D, 0x0C, 0x31, 0xC3, 0x98, 0x88, 0x3C, 0x25, 0x00, 0xCF, 0x10, 0x14, 0xC2, 0x00, 0xC2, 0x10, 0x3C, 0x21, 0x31,
+    0xC2, 0x21, 0x3C, 0x38, 0x00, 0xFD, 0xCB, 0xFE, 0x8A, 0xC0, 0x2A, 0xD1, 0x0F, 0x00, 0xEB, 0x21, 0x2A, 0xD1, 0x0F, 0x00, 0xDA, 0x31, 0xC3, 0x00,
+    0xCA, 0x25, 0x31, 0xC2, 0x0C, 0x00, 0xC5, 0x0D, 0x24, 0x31, 0xCB, 0x09, 0x1D, 0x00, 0xC6, 0x09, 0x31, 0xC1, 0x1D, 0x00, 0xD1, 0x28, 0x31, 0xC2,
+    0x0D, 0x00, 0xC1, 0x10, 0x31, 0xC2, 0x09, 0x00, 0xDA, 0x0D, 0x82, 0x88, 0x31, 0xC8, 0x09, 0x14, 0x00, 0xCA, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9,
+    0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC0, 0x14, 0x31, 0xC7, 0x21, 0x38, 0x00, 0xC7, 0x14, 0x31, 0xD3, 0x25, 0x00, 0xCA,
+    0x28, 0x3C, 0x31, 0xC9, 0x0C, 0x10, 0x00, 0xCD, 0x25, 0x31, 0xC2, 0x00, 0xC0, 0x28, 0x14, 0x31, 0xC8, 0x14, 0x00, 0xFD, 0xCA, 0x34, 0x2A, 0xD1,
+    0x00, 0xEC, 0x34, 0x2A, 0xD1, 0x00, 0xDB, 0x31, 0xC3, 0x00, 0xCA, 0x25, 0x31, 0xC2, 0x0C, 0x00, 0xC5, 0x0C, 0x31, 0xCE, 0x3C, 0x28, 0x00, 0xC4,
+    0x0C, 0x31, 0xC1, 0x3C, 0x00, 0xD1, 0x25, 0x31, 0xC2, 0x28, 0x00, 0xC1, 0x0D, 0x31, 0xC2, 0x24, 0x00, 0xD9, 0x14, 0x31, 0xCC, 0x0C, 0x28, 0x00,
+    0xC8, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0x3C, 0x31, 0xC9, 0x09, 0x28, 0x00, 0xC6,
+    0x14, 0x31, 0xD3, 0x25, 0x00, 0xC9, 0x38, 0x09, 0x31, 0xCB, 0x09, 0x38, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x00, 0x28, 0x39, 0x31, 0xC9, 0x0C, 0x00,
+    0xFD, 0xCA, 0x3A, 0x2A, 0xD0, 0x05, 0x00, 0xD0, 0x3A, 0x0F, 0xC0, 0xA8, 0xA4, 0xA3, 0xA7, 0xC1, 0x1F, 0x0F, 0xC0, 0x9A, 0x7B, 0x00, 0xCF, 0x3A,
+    0x2A, 0xD0, 0x05, 0x00, 0xDB, 0x31, 0xC3, 0x00, 0xCA, 0xB1, 0x88, 0x31, 0xC2, 0x0C, 0x00, 0xC5, 0x0C, 0x31, 0xC3, 0x98, 0x88, 0x0C, 0x3C, 0x14,
+    0x0C, 0xC0, 0x31, 0xC4, 0x3C, 0x00, 0xC4, 0x14, 0x31, 0xC1, 0x39, 0x00, 0xD1, 0x14, 0x31, 0xC1, 0x39, 0x00, 0xC2, 0x14, 0x31, 0xC2, 0x14, 0x00,
+    0xD8, 0x1D, 0x31, 0xC4, 0x39, 0x24, 0x3C, 0x0C, 0x31, 0xC4, 0x24, 0x00, 0xC8, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6,
+    0x14, 0x31, 0xC1, 0x0C, 0x14, 0x31, 0xC1, 0x9C, 0x88, 0x0C, 0xC1, 0x31, 0xC4, 0x3C, 0x00, 0xC6, 0x14, 0x31, 0xD3, 0x25, 0x00, 0xC8, 0x38, 0x09,
+    0x31, 0xC3, 0x21, 0x0C, 0x14, 0x24, 0x39, 0x31, 0xC3, 0x09, 0x38, 0x00, 0xCB, 0x25, 0x31, 0xC2, 0x00, 0x24, 0x31, 0xCA, 0x0C, 0x00, 0xFD, 0xCB,
+    0x05, 0x2A, 0xCF, 0xFE, 0x8A, 0xC0, 0x00, 0xCB, 0xA5, 0xA6, 0xAE, 0xB1, 0x21, 0x1B, 0x2A, 0xCA, 0x15, 0x1B, 0x21, 0x1F, 0x95, 0x6E, 0x00, 0xCB,
+    0x05, 0x2A, 0xCF, 0x21, 0x00, 0xDB, 0x31, 0xC3, 0x00, 0xCA, 0x14, 0x31, 0xC2, 0x0C, 0x00, 0xC5, 0x0C, 0x31, 0xC0, 0x3C, 0x0D, 0x28, 0x00, 0xC5,
+    0x35, 0x82, 0x88, 0x31, 0xC2, 0x35, 0x00, 0xC3, 0xB1, 0x88, 0x31, 0xC2, 0x28, 0x00, 0xD0, 0x0C, 0x31, 0xC1, 0x3C, 0x00, 0xC2, 0x0C, 0x31, 0xC2,
+    0x0D, 0x00, 0xD7, 0x38, 0x31, 0xC3, 0x24, 0xBE, 0x88, 0x00, 0xC2, 0x28, 0x14, 0x31, 0xC3, 0x1D, 0x00, 0xC7, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9,
+    0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x98, 0x88, 0x31, 0xC0, 0x21, 0x0D, 0x00, 0xC2, 0x28, 0x3C, 0x31, 0xC3, 0x10, 0x00, 0xCC, 0x25,
+    0x31, 0xC2, 0x25, 0x00, 0xD1, 0x28, 0x09, 0x31, 0xC2, 0x39, 0x25, 0x00, 0xC3, 0x10, 0x14, 0x31, 0xC2, 0x21, 0x00, 0xCB, 0x25, 0x31, 0xC2, 0x25,
+    0x31, 0xC1, 0x21, 0x35, 0x10, 0x00, 0xC1, 0x28, 0x0D, 0x24, 0x31, 0x0C, 0x00, 0xFD, 0xCB, 0xFE, 0x8A, 0xC0, 0x2A, 0xCF, 0x3A, 0x00, 0xC8, 0xA5,
+    0xA6, 0xAE, 0xB1, 0x30, 0x2A, 0xD3, 0x06, 0x34, 0x92, 0x5F, 0x00, 0xC8, 0x21, 0x2A, 0xCF, 0x3A, 0x00, 0xDB, 0x31, 0xC3, 0x00, 0xCA, 0x97, 0x88,
+    0x31, 0xC2, 0x14, 0x00, 0xC5, 0x24, 0x14, 0x28, 0x00, 0xC9, 0x38, 0x8F, 0x88, 0x31, 0xC1, 0x21, 0x00, 0xC4, 0x31, 0xC2, 0xB2, 0x88, 0x00, 0xD0,
+    0x09, 0x31, 0xC1, 0x35, 0x00, 0xC2, 0x21, 0x31, 0xC2, 0x25, 0x00, 0xD7, 0x0C, 0x31, 0xC2, 0x3C, 0x00, 0xC6, 0x35, 0x31, 0xC2, 0x09, 0x28, 0x00,
+    0xC6, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC3, 0x39, 0x28, 0x00, 0xC5, 0x3C, 0x31, 0xC2, 0x1D, 0x00,
+    0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xD1, 0x24, 0x31, 0xC2, 0x3C, 0x00, 0xC7, 0x35, 0x31, 0xC2, 0x14, 0x00, 0xCA, 0x25, 0x31, 0xC2, 0x0C, 0x31,
+    0xC0, 0x1D, 0x00, 0xC7, 0x25, 0x14, 0x00, 0xFD, 0xCB, 0x10, 0x15, 0x2A, 0xCD, 0x1B, 0x00, 0xC7, 0x0F, 0x1B, 0x2A, 0xD9, 0x36, 0xFE, 0x20, 0xA0,
+    0x00, 0xC6, 0x10, 0x15, 0x2A, 0xCD, 0x1B, 0x00, 0xDC, 0x31, 0xC3, 0x00, 0xC9, 0x14, 0x31, 0xC3, 0x38, 0x00, 0xD4, 0x14, 0x31, 0xC2, 0x38, 0x00,
+    0xC3, 0x0C, 0x31, 0xC1, 0x14, 0x00, 0xCF, 0xA8, 0x88, 0x31, 0xC2, 0x10, 0x00, 0xC2, 0x31, 0xC3, 0x00, 0xD7, 0x38, 0x31, 0xC2, 0x21, 0x00, 0xC8,
+    0x14, 0x31, 0xC2, 0x1D, 0x00, 0xC6, 0xB1, 0x88, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC3, 0x38, 0x00, 0xC6,
+    0x28, 0x31, 0xC2, 0x24, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xD0, 0x25, 0x31, 0xC2, 0x0C, 0x00, 0xC9, 0x24, 0x31, 0xC1, 0x21, 0x00, 0xCA,
+    0x25, 0x31, 0xC4, 0x35, 0x00, 0xFD, 0xD8, 0xFE, 0x8A, 0xC0, 0x2A, 0xCD, 0x3A, 0x00, 0xC5, 0x0F, 0x1B, 0x2A, 0xDD, 0x36, 0xFE, 0x20, 0xA0, 0x00,
+    0xC5, 0x21, 0x2A, 0xCD, 0x3A, 0x00, 0xDC, 0x31, 0xC3, 0x00, 0xC8, 0x1D, 0x31, 0xC3, 0x98, 0x88, 0x00, 0xD5, 0x10, 0x31, 0xC2, 0x0D, 0x00, 0xC3,
+    0x14, 0x31, 0xC1, 0x0C, 0x00, 0xCF, 0x35, 0x31, 0xC1, 0x21, 0x00, 0xC3, 0x31, 0xC3, 0x00, 0xD7, 0x14, 0x31, 0xC2, 0x35, 0x00, 0xC8, 0x10, 0x31,
+    0xC2, 0x39, 0x00, 0xC6, 0xB1, 0x88, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC2, 0x3C, 0x00, 0xC8, 0x0C, 0x31,
+    0xC1, 0x39, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xD0, 0x24, 0x31, 0xC2, 0x10, 0x00, 0xC9, 0x38, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x25, 0x31,
+    0xC3, 0x3C, 0x00, 0xFD, 0xDA, 0x30, 0x2A, 0xCB, 0xFE, 0x8A, 0xC0, 0x00, 0xC4, 0xA5, 0xA6, 0x1B, 0x2A, 0xE1, 0x21, 0xFE, 0x10, 0x40, 0x00, 0xC4,
+    0x30, 0x2A, 0xCB, 0x21, 0x00, 0xDD, 0x31, 0xC3, 0x00, 0xC5, 0xA8, 0x88, 0x35, 0x0C, 0x31, 0xC4, 0xB2, 0x88, 0x00, 0xD6, 0x31, 0xC2, 0x14, 0x00,
+    0xC3, 0x0D, 0x31, 0xC1, 0x09, 0x00, 0xC4, 0x38, 0x14, 0xC1, 0x0D, 0x00, 0xC4, 0x14, 0x31, 0xC1, 0x24, 0x00, 0xC3, 0x31, 0xC3, 0x00, 0xD7, 0x39,
+    0x31, 0xC1, 0x09, 0x00, 0xCA, 0x24, 0x31, 0xC2, 0x28, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31,
+    0xC2, 0x0D, 0x00, 0xC8, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x28, 0x31, 0xC2, 0x24, 0x00, 0xCB, 0x97, 0x88, 0x31,
+    0xC1, 0x14, 0x00, 0xC9, 0x25, 0x31, 0xC3, 0x10, 0x00, 0xFD, 0xDA, 0xA2, 0x97, 0x15, 0x2A, 0xC9, 0x36, 0x00, 0xC4, 0xFE, 0x72, 0x60, 0x15, 0x2A,
+    0xE3, 0x30, 0x3A, 0x00, 0xC3, 0x10, 0x15, 0x2A, 0xC9, 0x36, 0x00, 0xDE, 0x31, 0xD2, 0x14, 0x00, 0xD7, 0x0C, 0x31, 0xC1, 0x14, 0x00, 0xC3, 0x28,
+    0x31, 0xC2, 0xA9, 0x99, 0x00, 0xC3, 0x14, 0x31, 0xC1, 0x21, 0x00, 0xC4, 0x0C, 0x31, 0xC1, 0x1D, 0x00, 0xC3, 0x31, 0xC3, 0x00, 0xD7, 0x31, 0xC2,
+    0x0C, 0x00, 0xCA, 0x1D, 0x31, 0xC2, 0x25, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC2, 0x28,
+    0x00, 0xC8, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x0D, 0x31, 0xC2, 0x35, 0x00, 0xCB, 0x3C, 0x31, 0xC1, 0x0C, 0x00,
+    0xC9, 0x25, 0x31, 0xC2, 0x0C, 0x00, 0xFD, 0xDC, 0xA5, 0xA6, 0x30, 0x2A, 0xC7, 0x36, 0x00, 0xC3, 0xA2, 0x97, 0x1B, 0x2A, 0xE7, 0xFE, 0x8A, 0xC0,
+    0x00, 0xC3, 0x25, 0x30, 0x2A, 0xC7, 0x36, 0x00, 0xDF, 0x31, 0xD1, 0x14, 0x00, 0xCD, 0x28, 0xAD, 0x88, 0x1D, 0x14, 0xC6, 0xB5, 0x88, 0x31, 0xC1,
+    0x14, 0x00, 0xC4, 0x21, 0x31, 0xC1, 0x35, 0x00, 0xC3, 0x39, 0x31, 0xC2, 0xA9, 0x99, 0x00, 0xC3, 0x31, 0xC2, 0x38, 0x00, 0xC3, 0x31, 0xC3, 0x00,
+    0xD6, 0x25, 0x31, 0xC2, 0x14, 0x00, 0xCA, 0x25, 0x31, 0xC2, 0x14, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6,
+    0x14, 0x31, 0xC2, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x14, 0x31, 0xC2, 0x10, 0x00, 0xCB, 0x14, 0x31,
+    0xC1, 0x21, 0x00, 0xC9, 0x25, 0x31, 0xC2, 0x14, 0x00, 0xFD, 0xDE, 0xFE, 0x8A, 0xC0, 0x15, 0x2A, 0xC3, 0x05, 0x0F, 0x00, 0xC3, 0xA2, 0x97, 0x30,
+    0x2A, 0xE9, 0x36, 0x00, 0xC4, 0x21, 0x15, 0x2A, 0xC3, 0x05, 0x0F, 0x00, 0xE0, 0x31, 0xCF, 0x0C, 0x25, 0x00, 0xCB, 0x28, 0x1D, 0x39, 0x31, 0xCD,
+    0x14, 0x00, 0xC4, 0x3C, 0x31, 0xC1, 0x14, 0x00, 0xC2, 0xA8, 0x88, 0x31, 0xC3, 0x1D, 0x00, 0xC2, 0x25, 0x31, 0xC2, 0x00, 0xC4, 0x31, 0xC3, 0x00,
+    0xD6, 0x25, 0x31, 0xC2, 0x1D, 0x00, 0xCA, 0x10, 0x31, 0xC2, 0x14, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6,
+    0x14, 0x31, 0xC2, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x0C, 0x31, 0xC2, 0x14, 0xCC, 0x0C, 0x31, 0xC2,
+    0x00, 0xC9, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xFD, 0xE0, 0x0F, 0x21, 0xC0, 0x34, 0x95, 0x6E, 0x00, 0xC4, 0xA2, 0x97, 0x30, 0x2A, 0xEB, 0x36, 0x00,
+    0xC5, 0x0F, 0x21, 0xC0, 0x34, 0x25, 0x00, 0xE2, 0x31, 0xCB, 0x39, 0x24, 0x1D, 0x8B, 0x99, 0x00, 0xCC, 0x0D, 0x86, 0x88, 0x31, 0xCF, 0x14, 0x00,
+    0xC4, 0x35, 0x31, 0xC1, 0x0C, 0x00, 0xC2, 0x35, 0x31, 0xC0, 0x09, 0x31, 0xC0, 0x24, 0x00, 0xC2, 0x1D, 0x31, 0xC1, 0x0C, 0x00, 0xC4, 0x31, 0xC3,
+    0x00, 0xD6, 0x1D, 0x31, 0xC2, 0xB2, 0x88, 0x00, 0xCB, 0x31, 0xC2, 0x0C, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00,
+    0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x0C, 0x31, 0xD5, 0x00, 0xC9, 0x25,
+    0x31, 0xC2, 0x25, 0x00, 0xFD, 0xEA, 0xA2, 0x97, 0x15, 0x2A, 0xED, 0x36, 0x00, 0xED, 0x31, 0xC3, 0x00, 0xD7, 0x35, 0x31, 0xD1, 0x14, 0x00, 0xC4,
+    0xA8, 0x88, 0x31, 0xC2, 0x00, 0xC2, 0x24, 0x31, 0xC0, 0x14, 0x31, 0xC0, 0x09, 0x00, 0xC2, 0x24, 0x31, 0xC1, 0x14, 0x00, 0xC4, 0x09, 0x31, 0xC2,
+    0x25, 0x00, 0xD5, 0x14, 0x31, 0xC2, 0x25, 0x00, 0xCB, 0x31, 0xC2, 0x0C, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00,
+    0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x0C, 0x31, 0xD5, 0x00, 0xC9, 0x25,
+    0x31, 0xC2, 0x38, 0x00, 0xFD, 0xEA, 0x1B, 0x2A, 0xEF, 0xFE, 0x72, 0x60, 0x00, 0xEC, 0x31, 0xC3, 0x00, 0xD6, 0x0D, 0x31, 0xC3, 0x98, 0x88, 0x1D,
+    0x38, 0x00, 0xC6, 0x0C, 0x31, 0xC1, 0x14, 0x00, 0xC5, 0x9B, 0x88, 0x31, 0xC1, 0x25, 0x00, 0xC1, 0x09, 0x31, 0xC0, 0x10, 0x39, 0x31, 0xC0, 0x25,
+    0x00, 0xC1, 0x21, 0x31, 0xC1, 0x25, 0x00, 0xC4, 0x0C, 0x31, 0xC2, 0x25, 0x00, 0xD5, 0x14, 0x31, 0xC2, 0x25, 0x00, 0xCB, 0x31, 0xC2, 0x0C, 0x00,
+    0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25,
+    0x31, 0xC2, 0x25, 0x00, 0xCF, 0x0C, 0x31, 0xD5, 0x00, 0xC9, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xEA, 0xFE, 0x8A, 0xC0, 0x2A, 0xF1, 0x0F, 0x00, 0xEB,
+    0x31, 0xC3, 0x00, 0xD6, 0x97, 0x88, 0x31, 0xC2, 0x1D, 0x00, 0xC9, 0x39, 0x31, 0xC1, 0x14, 0x00, 0xC5, 0x24, 0x31, 0xC1, 0x1D, 0x00, 0xC0, 0x38,
+    0x31, 0xC0, 0x21, 0x00, 0x14, 0x31, 0xC0, 0x14, 0x00, 0xC0, 0x28, 0x31, 0xC2, 0x00, 0xC5, 0x14, 0x31, 0xC2, 0x14, 0x00, 0xD5, 0x1D, 0x31, 0xC2,
+    0x25, 0x00, 0xCB, 0x31, 0xC2, 0x0C, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC9, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00,
+    0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x0C, 0x31, 0xC1, 0x0C, 0x00, 0xDC, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE9,
+    0x1F, 0x2A, 0xF2, 0x15, 0xFE, 0x10, 0x40, 0x00, 0xEA, 0x31, 0xC3, 0x00, 0xD5, 0x25, 0x31, 0xC2, 0x14, 0x00, 0xCA, 0x31, 0xC2, 0x14, 0x00, 0xC5,
+    0x1D, 0x31, 0xC1, 0x3C, 0x00, 0xC0, 0x14, 0x31, 0xC0, 0x14, 0x00, 0x38, 0x31, 0xC0, 0x39, 0x00, 0xC0, 0x0D, 0x31, 0xC1, 0x39, 0x00, 0xC5, 0x35,
+    0x31, 0xC2, 0x24, 0x00, 0xD5, 0x25, 0x31, 0xC2, 0x1D, 0x00, 0xCA, 0xA8, 0x88, 0x31, 0xC2, 0x14, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC8,
+    0x25, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x0C,
+    0x31, 0xC1, 0x39, 0x00, 0xDC, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE9, 0x05, 0x2A, 0xF3, 0xFE, 0x8A, 0xC0, 0x00, 0xEA, 0x31, 0xC3, 0x00, 0xD5, 0x14,
+    0x31, 0xC2, 0x28, 0x00, 0xC9, 0x28, 0x31, 0xC2, 0x14, 0x00, 0xC5, 0x25, 0x31, 0xC1, 0x98, 0x88, 0x00, 0xC0, 0x0C, 0x31, 0xC0, 0x0D, 0x00, 0xC0,
+    0x09, 0x31, 0xC0, 0x10, 0x00, 0x14, 0x31, 0xC1, 0x14, 0x00, 0xC5, 0x10, 0x31, 0xC2, 0x09, 0x00, 0xD5, 0x25, 0x31, 0xC2, 0x14, 0x00, 0xCA, 0x25,
+    0x31, 0xC2, 0x14, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC8, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14,
+    0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x14, 0x31, 0xC2, 0x00, 0xDC, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE8, 0x34, 0x2A, 0xF4,
+    0x15, 0xFE, 0x10, 0x40, 0x00, 0xE9, 0x31, 0xC3, 0x00, 0xD5, 0x24, 0x31, 0xC1, 0x0C, 0x00, 0xCA, 0x0D, 0x31, 0xC2, 0x14, 0x00, 0xC6, 0x31, 0xC2,
+    0x28, 0xC0, 0x31, 0xC0, 0x09, 0x00, 0xC1, 0x3C, 0x31, 0xC0, 0x35, 0x00, 0x0C, 0x31, 0xC1, 0x0D, 0x00, 0xC6, 0x39, 0x31, 0xC2, 0x0D, 0x00, 0xD5,
+    0x31, 0xC2, 0x0C, 0x00, 0xCA, 0x1D, 0x31, 0xC2, 0x0D, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC8, 0x0D, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14,
+    0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x35, 0x31, 0xC2, 0x38, 0x00, 0xDB, 0x25, 0x31,
+    0xC2, 0x00, 0xFD, 0xE8, 0x05, 0x2A, 0xF5, 0x36, 0x00, 0xE9, 0x31, 0xC3, 0x00, 0xD5, 0x0C, 0x31, 0xC1, 0x0C, 0x00, 0xCA, 0x3C, 0x31, 0xC2, 0x14,
+    0x00, 0xC6, 0x0C, 0x31, 0xC1, 0x25, 0x0D, 0x31, 0xC0, 0x24, 0x00, 0xC1, 0x35, 0x31, 0xC0, 0x3C, 0x00, 0x09, 0x31, 0xC1, 0x28, 0x00, 0xC6, 0x1D,
+    0x31, 0xC2, 0x0C, 0x00, 0xD5, 0x39, 0x31, 0xC1, 0x09, 0x00, 0xCA, 0x24, 0x31, 0xC2, 0xA9, 0x99, 0x00, 0xC5, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC8,
+    0x14, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCC, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xCF, 0x28,
+    0x31, 0xC2, 0x14, 0x00, 0xDB, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE7, 0x1F, 0x2A, 0xF7, 0x00, 0xE9, 0x31, 0xC3, 0x00, 0xD5, 0x0C, 0x31, 0xC1, 0x39,
+    0x00, 0xC9, 0x28, 0x09, 0x31, 0xC2, 0x14, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x14, 0x3C, 0x31, 0xC0, 0x35, 0x00, 0xC1, 0x28, 0x31, 0xC0, 0x09, 0x38,
+    0x31, 0xC1, 0x21, 0x00, 0xC7, 0x28, 0x09, 0x31, 0xC2, 0x25, 0x00, 0xD4, 0x14, 0x31, 0xC2, 0x35, 0x00, 0xC8, 0x28, 0x31, 0xC2, 0x39, 0x00, 0xC6,
+    0x28, 0x31, 0xC2, 0x14, 0x00, 0xC8, 0x21, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCD, 0x31,
+    0xC2, 0x1D, 0x00, 0xD0, 0x0C, 0x31, 0xC1, 0x09, 0x28, 0x00, 0xDA, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE7, 0x36, 0x2A, 0xF7, 0x1F, 0x00, 0xE8, 0x31,
+    0xC3, 0x00, 0xD5, 0x14, 0x31, 0xC2, 0x10, 0x00, 0xC8, 0x24, 0x31, 0xC3, 0x14, 0x00, 0xC6, 0x25, 0x31, 0xC1, 0x0C, 0x21, 0x31, 0xC0, 0x10, 0x00,
+    0xC2, 0x39, 0x31, 0xC0, 0x14, 0x31, 0xC1, 0x3C, 0x00, 0xC8, 0x14, 0x31, 0xC2, 0x09, 0x38, 0x00, 0xCA, 0x10, 0x0D, 0x00, 0xC5, 0x38, 0x31, 0xC2,
+    0x39, 0x00, 0xC8, 0x14, 0x31, 0xC2, 0x1D, 0x00, 0xC7, 0x09, 0x31, 0xC1, 0x39, 0x00, 0xC7, 0x35, 0x31, 0xC3, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1,
+    0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCD, 0x31, 0xC2, 0x24, 0x00, 0xD0, 0x25, 0x31, 0xC2, 0x3C, 0x00, 0xCD, 0x28, 0x00, 0xCA, 0x25, 0x31,
+    0xC2, 0x00, 0xFD, 0xE7, 0x05, 0x2A, 0xF7, 0x36, 0x00, 0xE8, 0x31, 0xC3, 0x00, 0xD5, 0x0D, 0x31, 0xC2, 0x24, 0x00, 0xC7, 0x14, 0x31, 0xC4, 0x14,
+    0x00, 0xC6, 0x28, 0x31, 0xC1, 0x09, 0x31, 0xC0, 0x39, 0x00, 0xC3, 0x1D, 0x31, 0xC4, 0x35, 0x00, 0xC9, 0x39, 0x31, 0xC2, 0x21, 0x38, 0x00, 0xC8,
+    0x1D, 0x09, 0x14, 0x00, 0xC6, 0x0C, 0x31, 0xC2, 0x3C, 0x00, 0xC6, 0x35, 0x31, 0xC2, 0x09, 0x28, 0x00, 0xC7, 0x24, 0x31, 0xC2, 0x35, 0x00, 0xC5,
+    0x38, 0x09, 0x31, 0xC3, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCD, 0x24, 0x31, 0xC2, 0x38, 0x00, 0xD0,
+    0x0C, 0x31, 0xC2, 0x3C, 0x00, 0xCA, 0x10, 0x14, 0x09, 0x00, 0xCA, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE6, 0x3A, 0x2A, 0xF8, 0x05, 0x00, 0xE8, 0x31,
+    0xC3, 0x00, 0xD6, 0x09, 0x31, 0xC2, 0x3C, 0x28, 0x00, 0xC3, 0x10, 0x24, 0x31, 0xC1, 0x21, 0x31, 0xC1, 0x14, 0x00, 0xC7, 0x39, 0x31, 0xC3, 0x14,
+    0x00, 0xC3, 0x38, 0x31, 0xC4, 0x38, 0x00, 0xC9, 0x38, 0x09, 0x31, 0xC3, 0x3C, 0x38, 0x00, 0xC3, 0x38, 0x14, 0x21, 0x31, 0xC0, 0x14, 0x00, 0xC6,
+    0x25, 0x31, 0xC3, 0x24, 0x10, 0x00, 0xC3, 0x14, 0x31, 0xC3, 0x14, 0x00, 0xC8, 0x35, 0x31, 0xC3, 0x1D, 0x00, 0xC3, 0x35, 0x09, 0x31, 0x21, 0x31,
+    0xC2, 0x25, 0x00, 0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCD, 0x35, 0x31, 0xC2, 0x09, 0x14, 0x25, 0x00, 0xCE, 0x10,
+    0x09, 0x31, 0xC2, 0x39, 0x35, 0x00, 0xC5, 0x10, 0x35, 0x24, 0x31, 0xC1, 0x00, 0xCA, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE6, 0x1F, 0x2A, 0xF9, 0x00,
+    0xE8, 0x31, 0xC3, 0x00, 0xD6, 0x35, 0x31, 0xC4, 0x0C, 0x14, 0xC1, 0x39, 0x31, 0xC2, 0x14, 0x0C, 0x31, 0xC1, 0x14, 0x00, 0xC7, 0x14, 0x31, 0xC3,
+    0x25, 0x00, 0xC4, 0x21, 0x31, 0xC2, 0x09, 0x00, 0xCB, 0x38, 0x09, 0x31, 0xC5, 0x0C, 0xC1, 0x31, 0xC4, 0x14, 0x00, 0xC7, 0x14, 0x31, 0xC4, 0x0C,
+    0x14, 0xC0, 0x0C, 0x09, 0x31, 0xC3, 0x0C, 0x00, 0xCA, 0x21, 0x31, 0xC3, 0x09, 0x0C, 0xC1, 0x09, 0x31, 0xC1, 0x25, 0x31, 0xC2, 0x25, 0x00, 0xC6,
+    0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCE, 0x21, 0x31, 0xCA, 0x25, 0x00, 0xC8, 0x38, 0x09, 0x31, 0xC3, 0x09, 0x0C, 0x14,
+    0xC1, 0x0C, 0x21, 0x31, 0xC4, 0x00, 0xCA, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE6, 0xFE, 0x8A, 0xC0, 0x2A, 0xF9, 0x3A, 0x00, 0xE7, 0x31, 0xC3, 0x00,
+    0xD7, 0x3C, 0x31, 0xCB, 0x3C, 0x00, 0x0C, 0x31, 0xC1, 0x14, 0x00, 0xC7, 0x0D, 0x31, 0xC2, 0x09, 0x00, 0xC5, 0x3C, 0x31, 0xC2, 0x24, 0x00, 0xCC,
+    0x38, 0x8B, 0x88, 0x31, 0xCD, 0x14, 0x00, 0xC8, 0x3C, 0x31, 0xCC, 0x39, 0x28, 0x00, 0xCA, 0x25, 0x31, 0xCA, 0x35, 0x00, 0x31, 0xC2, 0x25, 0x00,
+    0xC6, 0x14, 0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCE, 0x38, 0x09, 0x31, 0xC9, 0x25, 0x00, 0xC9, 0x38, 0x21, 0x31, 0xCF, 0x00,
+    0xCA, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE6, 0xFE, 0x8A, 0xC0, 0x2A, 0xF9, 0x0F, 0x00, 0xE7, 0x31, 0xC3, 0x00, 0xD8, 0x14, 0x31, 0xC9, 0x14, 0x00,
+    0xC0, 0x0C, 0x31, 0xC1, 0x14, 0x00, 0xC7, 0x10, 0x31, 0xC2, 0x3C, 0x00, 0xC5, 0x0D, 0x31, 0xC2, 0x1D, 0x00, 0xCD, 0x28, 0x14, 0x31, 0xCB, 0x3C,
+    0x10, 0x00, 0xC9, 0x0D, 0x09, 0x31, 0xC9, 0x14, 0x00, 0xCD, 0x35, 0x09, 0x31, 0xC6, 0x09, 0x35, 0x00, 0xC0, 0x31, 0xC2, 0x25, 0x00, 0xC6, 0x14,
+    0x31, 0xC1, 0x0C, 0x00, 0xC9, 0x14, 0x31, 0xC2, 0x00, 0xCF, 0x28, 0x14, 0x09, 0x31, 0xC7, 0x25, 0x00, 0xCA, 0x28, 0x14, 0x31, 0xCC, 0x24, 0x0D,
+    0x00, 0xCA, 0x25, 0x31, 0xC2, 0x00, 0xFD, 0xE6, 0x36, 0x2A, 0xF9, 0x0F, 0x00, 0xE7, 0x14, 0xC3, 0x00, 0xD9, 0x10, 0x14, 0xB5, 0x88, 0x31, 0xC3,
+    0x39, 0x14, 0x10, 0x00, 0xC1, 0x35, 0x14, 0xC1, 0x25, 0x00, 0xC8, 0x14, 0xC2, 0x25, 0x00, 0xC5, 0x28, 0x14, 0xC2, 0x10, 0x00, 0xCF, 0x28, 0x1D,
+    0x24, 0x31, 0xC4, 0x09, 0x0C, 0x1D, 0x10, 0x00, 0xCC, 0x28, 0x35, 0x0C, 0x31, 0xC4, 0x39, 0x14, 0x10, 0x00, 0xCF, 0x10, 0x3C, 0x09, 0x31, 0xC2,
+    0x21, 0x14, 0x10, 0x00, 0xC1, 0x14, 0xC2, 0x10, 0x00, 0xC6, 0x25, 0x14, 0xC1, 0x35, 0x00, 0xC9, 0x25, 0x14, 0xC2, 0x00, 0xD2, 0x38, 0x35, 0x14,
+    0xC5, 0x10, 0x00, 0xCC, 0x28, 0x1D, 0x0C, 0x09, 0x31, 0xC4, 0x0C, 0x14, 0x0D, 0x28, 0x00, 0xCC, 0x10, 0x14, 0xC2, 0x00, 0xFD, 0xE6, 0xFE, 0x8A,
+    0xC0, 0x2A, 0xF9, 0x0F, 0x00, 0xFD, 0xCD, 0x25, 0xC0, 0x38, 0x00, 0xFB, 0x28, 0x25, 0xC1, 0x00, 0xD5, 0x28, 0x25, 0xC0, 0x10, 0x00, 0xD6, 0x28,
+    0x25, 0xC0, 0x28, 0x00, 0xFD, 0xD9, 0x25, 0xC1, 0x28, 0x00, 0xFD, 0xFD, 0xC0, 0x21, 0x2A, 0xF9, 0x3A, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xED, 0x1F, 0x2A, 0xF9, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xEE, 0x3A, 0x2A, 0xF8, 0x05, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xEF,
+    0x05, 0x2A, 0xF7, 0x36, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xEF, 0x36, 0x2A, 0xF7, 0x1F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xEF,
+    0x1F, 0x2A, 0xF7, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xF1, 0x05, 0x2A, 0xF5, 0x36, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xF1, 0x34,
+    0x2A, 0xF4, 0x15, 0xFE, 0x10, 0x40, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xF2, 0x05, 0x2A, 0xF3, 0x21, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xF3, 0x1F, 0x2A, 0xF2, 0x15, 0x10, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xF4, 0x21, 0x2A, 0xF1, 0x0F, 0x00, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xF6, 0x1B, 0x2A, 0xEF, 0xFE, 0x72, 0x60, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xF7, 0x10, 0x15, 0x2A, 0xED, 0x36, 0x00, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xF9, 0x10, 0x30, 0x2A, 0xEB, 0x36, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFB, 0x10, 0x30, 0x2A, 0xE9, 0x36,
+    0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0x10, 0x1B, 0x2A, 0xE7, 0x21, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC2, 0x09, 0x15,
+    0x2A, 0xE3, 0x30, 0x3A, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xC4, 0xA5, 0xA6, 0x1B, 0x2A, 0xE1, 0x21, 0x10, 0x00, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xC7, 0x0F, 0x1B, 0x2A, 0xDD, 0x36, 0x25, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xCB, 0x0F, 0x1B, 0x2A, 0xD9,
+    0x36, 0x25, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xCF, 0x25, 0x09, 0x30, 0x2A, 0xD3, 0x06, 0x34, 0x10, 0x00, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xD4, 0x25, 0x09, 0x21, 0x1B, 0x2A, 0xCA, 0x15, 0x1B, 0x21, 0x1F, 0x10, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xDC,
+    0x3A, 0x0F, 0xC0, 0x09, 0x21, 0xC1, 0x1F, 0x0F, 0xC0, 0x25, 0x00, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xFD, 0xF7,
+};
+
+#endif // SPLASH_DATA_H
@@ -0,0 +1,90 @@
+/**
+ * @file SpscQueue.h
+ * @brief 单生产者单消费者无锁环形队列
+ * @details 固定容量、无动态内存分配，适合任务间（包括两个核心之间）传递小型数据快照。
+ * - 只允许一个任务调用push()，一个任务调用pop()
+ * - 容量N必须是2的幂，实际可用N-1个槽位
+ * - 头尾索引使用std::atomic（acquire/release）保证跨核可见性
+ * - 生产者和消费者的字段各占一个缓存行（SPSC_CACHE_LINE），互相不写对方的行；
+ *   各自保存对方索引的副本，只在副本显示满/空时才读对方的原子索引，
+ *   连续入队/出队时基本不访问另一个核心正在写的字
+ *
+ * 入队后不会唤醒消费者：阻塞等待的消费者由生产者另外通知（xTaskNotifyGive、LoopScheduler::wake()）。
+ * 跨核吞吐量见串口命令 bench spsc（与FreeRTOS队列对比）。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// ESP32-S3数据缓存行为32字节（PSRAM经缓存访问），取64同时覆盖主机构建
+#define SPSC_CACHE_LINE 64
+
+template <typename T, uint32_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue容量必须是2的幂");
+
+public:
+    SpscQueue() : _head(0), _tailCache(0), _tail(0), _headCache(0) {}
+
+    /**
+     * @brief 入队（仅生产者调用）
+     * @return 队列已满返回false
+     */
+    bool push(const T &item) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t next = (head + 1) & (N - 1);
+        if (next == _tailCache) {
+            // 副本显示已满，再读一次消费者的索引
+            _tailCache = _tail.load(std::memory_order_acquire);
+            if (next == _tailCache) {
+                return false;
+            }
+        }
+        _items[head] = item;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 出队（仅消费者调用）
+     * @return 队列为空返回false
+     */
+    bool pop(T &item) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _headCache) {
+            // 副本显示为空，再读一次生产者的索引
+            _headCache = _head.load(std::memory_order_acquire);
+            if (tail == _headCache) {
+                return false;
+            }
+        }
+        item = _items[tail];
+        _tail.store((tail + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 队列是否为空（任一方可调用，结果仅供参考）
+     */
+    bool empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // 生产者的行
+    alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> _head;   ///< 下一个写入位置
+    uint32_t _tailCache;                                    ///< 生产者看到的读取位置
+
+    // 消费者的行
+    alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> _tail;   ///< 下一个读取位置
+    uint32_t _headCache;                                    ///< 消费者看到的写入位置
+
+    alignas(SPSC_CACHE_LINE) T _items[N];
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,184 @@
+/**
+ * @file StallMonitor.cpp
+ * @brief 主循环阻塞检测实现
+ *
+ * @author Calculator Project
+ */
+
+#include "StallMonitor.h"
+#include "Console.h"
+#include "Logger.h"
+#include <esp_freertos_hooks.h>
+#include <esp_debug_helpers.h>
+#include <soc/cpu.h>
+#include <soc/soc_memory_layout.h>
+#include <freertos/xtensa_context.h>
+#include <xtensa/hal.h>
+
+#define TAG_STALL "Stall"
+
+namespace {
+
+StallMonitor* s_monitor = nullptr;
+
+int formatBacktrace(char* buf, size_t size, const uint32_t* pcs, uint8_t depth) {
+    int len = 0;
+    for (uint8_t i = 0; i < depth && len < (int)size; i++) {
+        len += snprintf(buf + len, size - len, " 0x%08lx", (unsigned long)pcs[i]);
+    }
+    return len;
+}
+
+void cmdStalls(const ConsoleArgs& args) {
+    if (args.is(1, "clear")) {
+        StallMonitor::instance().clear();
+        Serial.println("阻塞统计已清空");
+    } else if (args.count < 2) {
+        StallMonitor::instance().print(Serial);
+    } else {
+        Serial.println("用法: stalls [clear]");
+    }
+}
+
+constexpr ConsoleCommand STALL_COMMANDS[] = {
+    {"stalls", "[clear]", "主循环阻塞的调用点（按最长时长排序）", cmdStalls},
+};
+static_assert(consoleSorted(STALL_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+StallMonitor::StallMonitor()
+    : _task(nullptr),
+      _iterationStart(0),
+      _inIteration(false),
+      _captured(false),
+      _captureDepth(0),
+      _stalls(0),
+      _unsited(0) {
+    memset(_sites, 0, sizeof(_sites));
+}
+
+bool StallMonitor::begin() {
+    _task = xTaskGetCurrentTaskHandle();
+    s_monitor = this;
+    Console::instance().addCommands(STALL_COMMANDS);
+    if (esp_register_freertos_tick_hook_for_cpu(tickHook, xPortGetCoreID()) != ESP_OK) {
+        LOG_W(TAG_STALL, "节拍钩子注册失败，阻塞检测未启用");
+        return false;
+    }
+    return true;
+}
+
+void IRAM_ATTR StallMonitor::tickHook() {
+    StallMonitor* self = s_monitor;
+    if (!self->_inIteration || self->_captured) return;
+    if (xTaskGetTickCountFromISR() - self->_iterationStart < pdMS_TO_TICKS(STALL_THRESHOLD_MS)) return;
+    self->capture();
+    self->_captured = true;
+}
+
+void IRAM_ATTR StallMonitor::capture() {
+    // 被中断的任务还有寄存器窗口未写回栈，先全部写回才能逐帧回溯
+    xthal_window_spill();
+
+    // TCB第一个成员是栈顶：运行中被中断时指向中断现场，阻塞时指向切换时保存的现场
+    const void* top = *(const void* const*)_task;
+    esp_backtrace_frame_t frame;
+    const XtExcFrame* exc = (const XtExcFrame*)top;
+    if (exc->exit) {
+        frame.pc = exc->pc;
+        frame.sp = exc->a1;
+        frame.next_pc = exc->a0;
+    } else {
+        const XtSolFrame* sol = (const XtSolFrame*)top;
+        frame.pc = sol->pc;
+        frame.sp = sol->a1;
+        frame.next_pc = sol->a0;
+    }
+
+    uint8_t depth = 0;
+    _capturePcs[depth++] = esp_cpu_process_stack_pc(frame.pc);
+    while (depth < STALL_BACKTRACE_DEPTH && frame.next_pc && esp_stack_ptr_is_sane(frame.sp)) {
+        if (!esp_backtrace_get_next_frame(&frame)) break;
+        uint32_t pc = esp_cpu_process_stack_pc(frame.pc);
+        if (!esp_ptr_executable((void*)pc)) break;
+        _capturePcs[depth++] = pc;
+    }
+    _captureDepth = depth;
+}
+
+void StallMonitor::iterationEnd() {
+    _inIteration = false;
+    if (!_captured) return;
+
+    uint32_t elapsedMs = (xTaskGetTickCount() - _iterationStart) * portTICK_PERIOD_MS;
+    _stalls++;
+
+    // 按调用链归类：最内层的PC随阻塞时执行到哪里变化，不参与哈希（FNV-1a）
+    uint32_t hash = 2166136261UL;
+    for (uint8_t i = _captureDepth > 1 ? 1 : 0; i < _captureDepth; i++) {
+        hash = (hash ^ _capturePcs[i]) * 16777619UL;
+    }
+    if (!hash) hash = 1;
+
+    char trace[STALL_BACKTRACE_DEPTH * 11 + 1];
+    formatBacktrace(trace, sizeof(trace), _capturePcs, _captureDepth);
+
+    Site* site = findSite(hash);
+    if (!site) {
+        _unsited++;
+        LOG_W(TAG_STALL, "主循环阻塞 %lu ms，回溯:%s", (unsigned long)elapsedMs, trace);
+        return;
+    }
+    site->count++;
+    site->lastMs = elapsedMs;
+    if (elapsedMs > site->maxMs) site->maxMs = elapsedMs;
+    memcpy(site->pcs, _capturePcs, sizeof(site->pcs));
+    site->depth = _captureDepth;
+    LOG_W(TAG_STALL, "主循环阻塞 %lu ms（调用点 #%u 第 %lu 次），回溯:%s", (unsigned long)elapsedMs,
+          (unsigned)(site - _sites), (unsigned long)site->count, trace);
+}
+
+StallMonitor::Site* StallMonitor::findSite(uint32_t hash) {
+    for (uint8_t i = 0; i < STALL_SITE_COUNT; i++) {
+        if (_sites[i].hash == hash) return &_sites[i];
+        if (_sites[i].hash == 0) {
+            _sites[i].hash = hash;
+            return &_sites[i];
+        }
+    }
+    return nullptr;
+}
+
+void StallMonitor::clear() {
+    memset(_sites, 0, sizeof(_sites));
+    _stalls = 0;
+    _unsited = 0;
+}
+
+void StallMonitor::print(Print& out) const {
+    out.printf("主循环阻塞（超过 %d ms）: %lu 次", STALL_THRESHOLD_MS, (unsigned long)_stalls);
+    if (_unsited) {
+        out.printf("，其中 %lu 次调用点表已满未归类", (unsigned long)_unsited);
+    }
+    out.println();
+
+    // 按最长时长从大到小输出
+    bool listed[STALL_SITE_COUNT] = {};
+    for (;;) {
+        int8_t worst = -1;
+        for (uint8_t i = 0; i < STALL_SITE_COUNT; i++) {
+            if (_sites[i].hash && !listed[i] && (worst < 0 || _sites[i].maxMs > _sites[worst].maxMs)) {
+                worst = i;
+            }
+        }
+        if (worst < 0) break;
+        listed[worst] = true;
+
+        const Site& site = _sites[worst];
+        char trace[STALL_BACKTRACE_DEPTH * 11 + 1];
+        formatBacktrace(trace, sizeof(trace), site.pcs, site.depth);
+        out.printf(" #%-2d %6lu 次  最长 %5lu ms  最近 %5lu ms  回溯:%s\n", worst, (unsigned long)site.count,
+                   (unsigned long)site.maxMs, (unsigned long)site.lastMs, trace);
+    }
+}
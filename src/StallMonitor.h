@@ -0,0 +1,83 @@
+/**
+ * @file StallMonitor.h
+ * @brief 主循环阻塞检测
+ * @details 串口测试命令中的delay()、同步的NVS写入等会让唯一的主循环停顿几百毫秒。
+ * 主循环每轮开始和进入等待前各登记一次，FreeRTOS节拍中断（主循环所在核心，每毫秒）检查：
+ * - 一轮超过STALL_THRESHOLD_MS时，在中断里抓取主循环任务的调用栈（最多STALL_BACKTRACE_DEPTH层）
+ *   到固定缓冲，每轮只抓一次；任务正在运行时取中断现场，已阻塞（delay等）时取切换时保存的现场
+ * - 这一轮结束后由主循环按调用链（不含最内层的PC）归入调用点表，记录次数、最长和最近一次的时长，
+ *   再经异步日志输出，中断里不做任何输出
+ * 串口命令 stalls 按最长时长列出各调用点，回溯地址用
+ * xtensa-esp32s3-elf-addr2line -pfiaC -e firmware.elf 解析。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+
+class StallMonitor {
+public:
+    struct Site {
+        uint32_t hash;                          ///< 调用链哈希，0表示空位
+        uint32_t count;
+        uint32_t maxMs;
+        uint32_t lastMs;
+        uint32_t pcs[STALL_BACKTRACE_DEPTH];    ///< 最近一次的回溯
+        uint8_t depth;
+    };
+
+    static StallMonitor& instance() {
+        static StallMonitor instance;
+        return instance;
+    }
+
+    /**
+     * @brief 记录主循环任务并挂到本核心的节拍中断，在setup()中调用
+     */
+    bool begin();
+
+    /**
+     * @brief 主循环一轮开始（等待返回后）
+     */
+    void iterationBegin() {
+        _captured = false;
+        _iterationStart = xTaskGetTickCount();
+        _inIteration = true;
+    }
+
+    /**
+     * @brief 主循环一轮结束（进入等待前），这一轮有阻塞时归入调用点表并输出日志
+     */
+    void iterationEnd();
+
+    void clear();
+    void print(Print& out) const;
+
+private:
+    StallMonitor();
+    StallMonitor(const StallMonitor&) = delete;
+    StallMonitor& operator=(const StallMonitor&) = delete;
+
+    static void tickHook();
+    void capture();
+    Site* findSite(uint32_t hash);
+
+    TaskHandle_t _task;
+    volatile TickType_t _iterationStart;
+    volatile bool _inIteration;
+    volatile bool _captured;                    ///< 这一轮已抓取回溯（中断写，主循环读）
+    uint32_t _capturePcs[STALL_BACKTRACE_DEPTH];
+    uint8_t _captureDepth;
+
+    Site _sites[STALL_SITE_COUNT];
+    uint32_t _stalls;                           ///< 阻塞总次数
+    uint32_t _unsited;                          ///< 调用点表已满、没有归入的次数
+};
+
+#endif // STALL_MONITOR_H
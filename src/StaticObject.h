@@ -0,0 +1,59 @@
+/**
+ * @file StaticObject.h
+ * @brief 在静态存储中就地构造的对象
+ * @details 启动时创建的子系统（显示总线、屏幕驱动、Canvas、CalcDisplay、CalculatorCore、SimpleHID）
+ * 不再new到堆上，而是在全局的StaticObject中就地构造：
+ * - 存储大小在链接时确定（.bss），启动过程不分配堆，也不在开机早期留下碎片
+ * - construct()可以在失败回退时先析构再重新构造（如Canvas失败后换软件SPI总线）
+ * - 没有析构函数：与固件的其他全局对象一样，运行期间一直存在
+ *
+ * 只用于静态存储期的全局对象：构造函数是constexpr，不依赖全局构造顺序。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef STATIC_OBJECT_H
+#define STATIC_OBJECT_H
+
+#include <new>
+#include <stdint.h>
+#include <utility>
+
+template <typename T>
+class StaticObject {
+public:
+    constexpr StaticObject() : _storage(), _constructed(false) {}
+
+    StaticObject(const StaticObject&) = delete;
+    StaticObject& operator=(const StaticObject&) = delete;
+
+    /**
+     * @brief 就地构造（已构造时先析构原对象）
+     * @return 构造出的对象
+     */
+    template <typename... Args>
+    T* construct(Args&&... args) {
+        destroy();
+        T* object = new (_storage) T(std::forward<Args>(args)...);
+        _constructed = true;
+        return object;
+    }
+
+    void destroy() {
+        if (_constructed) {
+            get()->~T();
+            _constructed = false;
+        }
+    }
+
+    /**
+     * @brief 未构造时返回nullptr
+     */
+    T* get() { return _constructed ? reinterpret_cast<T*>(_storage) : nullptr; }
+
+private:
+    alignas(T) uint8_t _storage[sizeof(T)];
+    bool _constructed;
+};
+
+#endif // STATIC_OBJECT_H
@@ -0,0 +1,116 @@
+/**
+ * @file StatusBar.cpp
+ * @brief 屏幕右上角的状态图标条实现
+ *
+ * @author Calculator Project
+ */
+
+#include "StatusBar.h"
+#include "BufferPlacement.h"
+#include "PixelKernels.h"
+
+// 8x8单色图标，每行一字节，最高位在左
+static const uint8_t SPRITE_BITS[][StatusBar::ICON_SIZE] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // 空白
+    {0x18, 0x38, 0x18, 0x18, 0x18, 0x18, 0x3C, 0x00},  // 1：主层
+    {0x3C, 0x66, 0x06, 0x0C, 0x18, 0x30, 0x7E, 0x00},  // 2：第二层
+    {0x24, 0x24, 0x7E, 0x42, 0x42, 0x3C, 0x18, 0x18},  // USB插头（未连接，暗色）
+    {0x24, 0x24, 0x7E, 0x7E, 0x7E, 0x3C, 0x18, 0x18},  // USB插头（已连接）
+    {0xDB, 0xDB, 0x00, 0xDB, 0xDB, 0x00, 0xDB, 0xDB},  // 九宫格：小键盘直通
+    {0x00, 0x66, 0x7E, 0x5A, 0x42, 0x42, 0x42, 0x00},  // M：存储器
+    {0x00, 0x7E, 0x0C, 0x18, 0x30, 0x7E, 0x00, 0x00},  // z：休眠
+    {0x00, 0x7C, 0x44, 0x46, 0x46, 0x44, 0x7C, 0x00},  // 电池：空
+    {0x00, 0x7C, 0x64, 0x66, 0x66, 0x64, 0x7C, 0x00},  // 电池：1格
+    {0x00, 0x7C, 0x74, 0x76, 0x76, 0x74, 0x7C, 0x00},  // 电池：2格
+    {0x00, 0x7C, 0x7C, 0x7E, 0x7E, 0x7C, 0x7C, 0x00},  // 电池：满
+};
+
+StatusBar::StatusBar() : _sprites(nullptr) {
+    for (uint8_t i = 0; i < ITEM_COUNT; i++) {
+        _wanted[i] = 0;
+        _drawn[i] = NOT_DRAWN;
+    }
+}
+
+StatusBar::~StatusBar() {
+    placedFree(_sprites);
+}
+
+bool StatusBar::begin(uint16_t fg, uint16_t dim, uint16_t bg) {
+    if (_sprites) return true;
+    _sprites = (uint16_t *)placedAlloc("status_bar", SPRITE_COUNT * ICON_SIZE * ICON_SIZE * 2, PLACE_INTERNAL);
+    if (!_sprites) return false;
+    setColors(fg, dim, bg);
+    return true;
+}
+
+void StatusBar::setColors(uint16_t fg, uint16_t dim, uint16_t bg) {
+    if (!_sprites) return;
+    for (uint8_t s = 0; s < SPRITE_COUNT; s++) {
+        uint16_t color = s == SPRITE_USB_OFF ? dim : fg;
+        uint16_t *dst = _sprites + s * ICON_SIZE * ICON_SIZE;
+        for (uint8_t r = 0; r < ICON_SIZE; r++) {
+            for (uint8_t c = 0; c < ICON_SIZE; c++) {
+                *dst++ = (SPRITE_BITS[s][r] & (0x80 >> c)) ? color : bg;
+            }
+        }
+    }
+    invalidate();
+}
+
+StatusBar::Sprite StatusBar::spriteFor(Item item, uint8_t state) {
+    switch (item) {
+        case ITEM_LAYER:  return state ? SPRITE_LAYER2 : SPRITE_LAYER1;
+        case ITEM_HID:    return state > 1 ? SPRITE_PASSTHROUGH : state ? SPRITE_USB_ON : SPRITE_USB_OFF;
+        case ITEM_MEMORY: return state ? SPRITE_MEMORY : SPRITE_BLANK;
+        case ITEM_SLEEP:  return state ? SPRITE_SLEEP : SPRITE_BLANK;
+        case ITEM_BATTERY:
+            return state ? (Sprite)(SPRITE_BATTERY_0 + (state > 4 ? 3 : state - 1)) : SPRITE_BLANK;
+        default:          return SPRITE_BLANK;
+    }
+}
+
+bool StatusBar::set(Item item, uint8_t state) {
+    if (item >= ITEM_COUNT || _wanted[item] == state) return false;
+    _wanted[item] = state;
+    return true;
+}
+
+uint8_t StatusBar::pending() const {
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < ITEM_COUNT; i++) {
+        if (_drawn[i] != _wanted[i]) mask |= (1 << i);
+    }
+    return _sprites ? mask : 0;
+}
+
+void StatusBar::invalidate() {
+    for (uint8_t i = 0; i < ITEM_COUNT; i++) {
+        _drawn[i] = NOT_DRAWN;
+    }
+}
+
+void StatusBar::draw(Arduino_GFX *gfx, uint16_t *fb, int16_t fbW, int16_t x, int16_t y,
+                     int16_t &dirtyX, int16_t &dirtyW) {
+    int16_t x0 = INT16_MAX, x1 = INT16_MIN;
+    uint8_t mask = pending();
+    for (uint8_t i = 0; i < ITEM_COUNT; i++) {
+        if (!(mask & (1 << i))) continue;
+
+        uint8_t state = _wanted[i];
+        const uint16_t *sprite = _sprites + spriteFor((Item)i, state) * ICON_SIZE * ICON_SIZE;
+        int16_t ix = x + i * (ICON_SIZE + ICON_GAP);
+        if (fb) {
+            for (uint8_t r = 0; r < ICON_SIZE; r++) {
+                pixelCopy(fb + (int32_t)(y + r) * fbW + ix, sprite + r * ICON_SIZE, ICON_SIZE);
+            }
+        } else {
+            gfx->draw16bitRGBBitmap(ix, y, (uint16_t *)sprite, ICON_SIZE, ICON_SIZE);
+        }
+        _drawn[i] = state;
+        if (ix < x0) x0 = ix;
+        if (ix + ICON_SIZE > x1) x1 = ix + ICON_SIZE;
+    }
+    dirtyX = x0;
+    dirtyW = x1 > x0 ? x1 - x0 : 0;
+}
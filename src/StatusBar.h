@@ -0,0 +1,102 @@
+/**
+ * @file StatusBar.h
+ * @brief 屏幕右上角的状态图标条
+ * @details 按键层、USB HID连接、存储器、休眠和电池五个状态各占一个图标位：
+ * - 图标在begin()时按颜色预渲染为RGB565精灵，绘制时逐行复制；主题切换时由setColors()重新渲染
+ * - set()可以在任意任务中调用，只记录期望状态；绘制在渲染侧进行，只重画状态变化的图标位
+ * - 状态全部由事件驱动（层切换、USB事件、休眠回调、存储器指示、电量通知），不轮询
+ *
+ * 图标条位于L0露出部分的右端，与L1顶部重叠两行；超长的L1文本末尾会被图标盖住。
+ * L0/L1重绘或平移会覆盖图标条所在的像素，此时由CalcDisplay调用invalidate()整条重画。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef STATUS_BAR_H
+#define STATUS_BAR_H
+
+#include <Arduino_GFX_Library.h>
+
+class StatusBar {
+public:
+    enum Item : uint8_t {
+        ITEM_LAYER,         ///< 当前按键层：0主层，1第二层
+        ITEM_HID,           ///< USB HID：0未连接，1已连接，2小键盘直通模式
+        ITEM_MEMORY,        ///< 存储器：0为空，1有值
+        ITEM_SLEEP,         ///< 休眠：0活跃，1休眠
+        ITEM_BATTERY,       ///< 电池：0没有读数，1-4为电量0-3格
+        ITEM_COUNT
+    };
+
+    static const uint8_t ICON_SIZE = 8;         ///< 图标边长（像素）
+    static const uint8_t ICON_GAP = 2;          ///< 图标间距
+    static const int16_t WIDTH = ITEM_COUNT * (ICON_SIZE + ICON_GAP) - ICON_GAP;
+    static const int16_t HEIGHT = ICON_SIZE;
+
+    StatusBar();
+    ~StatusBar();
+
+    /**
+     * @brief 预渲染全部精灵
+     * @param fg 激活状态颜色
+     * @param dim 未激活状态颜色（如USB未连接）
+     * @param bg 背景色
+     */
+    bool begin(uint16_t fg, uint16_t dim, uint16_t bg);
+
+    /**
+     * @brief 按新颜色重新渲染精灵（主题切换，绘制侧调用），下次整条重画
+     */
+    void setColors(uint16_t fg, uint16_t dim, uint16_t bg);
+
+    /**
+     * @brief 设置状态（任意任务）
+     * @return 与当前期望状态不同返回true，调用方据此唤醒渲染
+     */
+    bool set(Item item, uint8_t state);
+
+    /**
+     * @brief 期望状态与已绘制状态不同的图标位图（bit i 对应Item i）
+     */
+    uint8_t pending() const;
+
+    /**
+     * @brief 图标条像素已被覆盖，下次全部重画
+     */
+    void invalidate();
+
+    /**
+     * @brief 重画状态变化的图标
+     * @param x,y 图标条左上角
+     * @param fb Canvas帧缓冲，nullptr时经gfx绘制
+     * @param dirtyX,dirtyW 输出：重画的横向区间，没有重画时dirtyW为0
+     */
+    void draw(Arduino_GFX *gfx, uint16_t *fb, int16_t fbW, int16_t x, int16_t y,
+              int16_t &dirtyX, int16_t &dirtyW);
+
+private:
+    enum Sprite : uint8_t {
+        SPRITE_BLANK,
+        SPRITE_LAYER1,
+        SPRITE_LAYER2,
+        SPRITE_USB_OFF,
+        SPRITE_USB_ON,
+        SPRITE_PASSTHROUGH,
+        SPRITE_MEMORY,
+        SPRITE_SLEEP,
+        SPRITE_BATTERY_0,
+        SPRITE_BATTERY_1,
+        SPRITE_BATTERY_2,
+        SPRITE_BATTERY_3,
+        SPRITE_COUNT
+    };
+    static const uint8_t NOT_DRAWN = 0xFF;
+
+    static Sprite spriteFor(Item item, uint8_t state);
+
+    uint16_t *_sprites;                 ///< [精灵][ICON_SIZE×ICON_SIZE]
+    volatile uint8_t _wanted[ITEM_COUNT];
+    uint8_t _drawn[ITEM_COUNT];         ///< 已绘制的状态，NOT_DRAWN表示需要重画
+};
+
+#endif // STATUS_BAR_H
@@ -0,0 +1,102 @@
+/**
+ * @file TapHold.h
+ * @brief 轻触/按住双功能键的判定
+ * @details 键盘扫描在按下时立即上报PRESS，按住_longPressDelay后再上报LONGPRESS，
+ * 所以长按前总会先执行一次短按动作。布局表中holdMs非0的键改由这里判定，两个动作只执行其一：
+ * - 按下时不动作，记为待定
+ * - 按住达到holdMs：执行按住动作，之后的释放和扫描上报的LONGPRESS都忽略
+ * - 之前释放：执行轻触动作
+ * - 待定期间按下其他键：先按轻触结算，保证动作顺序与按键顺序一致；
+ *   与待定键组成已注册组合的键除外（joinChord()）：待定键作为修饰键，两个动作都不执行
+ * holdMs为0的普通键不经过这里，没有任何附加延迟。同一时刻最多一个待定键。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef TAP_HOLD_H
+#define TAP_HOLD_H
+
+#include <stdint.h>
+
+class TapHold {
+public:
+    TapHold() : _pendingKey(0), _pressedAt(0), _holdMs(0), _ownedMask(0) {}
+
+    /**
+     * @brief 双功能键按下，记为待定（调用前应先用interrupt()结算之前的待定键）
+     */
+    void press(uint8_t key, uint16_t holdMs, uint32_t now) {
+        if (key < 1 || key > 32) return;
+        _pendingKey = key;
+        _pressedAt = now;
+        _holdMs = holdMs;
+        _ownedMask |= 1UL << (key - 1);
+    }
+
+    /**
+     * @brief 按键释放
+     * @return 待定键在判定前释放、应执行轻触动作时返回true
+     */
+    bool release(uint8_t key) {
+        if (key < 1 || key > 32) return false;
+        _ownedMask &= ~(1UL << (key - 1));
+        if (key != _pendingKey) return false;
+        _pendingKey = 0;
+        return true;
+    }
+
+    /**
+     * @brief 其他键按下时结算待定键
+     * @return 被按轻触结算的键，没有待定键时返回0
+     */
+    uint8_t interrupt() {
+        uint8_t key = _pendingKey;
+        _pendingKey = 0;
+        return key;
+    }
+
+    /**
+     * @brief 待定键与新按下的键组成组合：待定键作为修饰键结算，不执行轻触和按住动作
+     * @param key 新按下的键，到释放为止也由这里判定（扫描上报的长按和重复应忽略）
+     */
+    void joinChord(uint8_t key) {
+        _pendingKey = 0;
+        if (key >= 1 && key <= 32) _ownedMask |= 1UL << (key - 1);
+    }
+
+    /**
+     * @brief 检查待定键是否已按住到判定时间
+     * @return 达到判定时间、应执行按住动作的键，否则返回0
+     */
+    uint8_t poll(uint32_t now) {
+        if (!_pendingKey || now - _pressedAt < _holdMs) return 0;
+        return interrupt();
+    }
+
+    /**
+     * @brief 按键当前是否由这里判定（按下后到释放前），扫描上报的LONGPRESS和REPEAT应忽略
+     */
+    bool owns(uint8_t key) const {
+        return key >= 1 && key <= 32 && (_ownedMask & (1UL << (key - 1)));
+    }
+
+    bool pending() const { return _pendingKey != 0; }
+
+    /**
+     * @brief 待定的键，没有时返回0
+     */
+    uint8_t pendingKey() const { return _pendingKey; }
+
+    /**
+     * @brief 待定键的判定时刻（仅在pending()时有意义）
+     */
+    uint32_t deadline() const { return _pressedAt + _holdMs; }
+
+private:
+    uint8_t _pendingKey;        ///< 待定的键，0表示没有
+    uint32_t _pressedAt;        ///< 待定键按下的时刻
+    uint16_t _holdMs;           ///< 待定键的判定时间
+    uint32_t _ownedMask;        ///< 按住中的双功能键，bit i 对应按键 i+1
+};
+
+#endif // TAP_HOLD_H
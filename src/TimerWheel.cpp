@@ -0,0 +1,194 @@
+/**
+ * @file TimerWheel.cpp
+ * @brief 主循环的分层时间轮定时器实现
+ *
+ * @author Calculator Project
+ */
+
+#include "TimerWheel.h"
+#include "Console.h"
+#include "LoopScheduler.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+#define TAG_TIMER "TIMER"
+
+namespace {
+
+MetricCounter timersFired("timer.fired");
+MetricCounter timersCascaded("timer.cascaded");
+
+void cmdTimers(const ConsoleArgs&) {
+    TimerWheel::instance().printStatus();
+}
+
+constexpr ConsoleCommand TIMER_COMMANDS[] = {
+    {"timers", "", "显示时间轮中的定时器和统计", cmdTimers},
+};
+static_assert(consoleSorted(TIMER_COMMANDS), "命令表必须按名称排序");
+
+// 循环右移：第r位移到最低位
+inline uint64_t rotateRight(uint64_t bits, uint8_t r) {
+    return r ? (bits >> r) | (bits << (64 - r)) : bits;
+}
+
+} // namespace
+
+TimerWheel::TimerWheel()
+    : _created(0),
+      _now(0) {
+    memset(_heads, INVALID, sizeof(_heads));
+    memset(_occupied, 0, sizeof(_occupied));
+}
+
+void TimerWheel::begin() {
+    _now = millis();
+    Console::instance().addCommands(TIMER_COMMANDS);
+}
+
+TimerWheel::TimerId TimerWheel::create(const char* name, Callback callback, void* context) {
+    if (_created >= TIMER_WHEEL_CAPACITY) {
+        LOG_E(TAG_TIMER, "定时器池已满，%s 不可用", name);
+        return INVALID;
+    }
+    Timer& timer = _timers[_created];
+    timer.callback = callback;
+    timer.context = context;
+    timer.name = name;
+    timer.expiry = 0;
+    timer.prev = INVALID;
+    timer.next = INVALID;
+    timer.level = NOT_LINKED;
+    timer.index = 0;
+    return _created++;
+}
+
+void TimerWheel::start(TimerId id, uint32_t delayMs) {
+    if (id >= _created) return;
+    if (_timers[id].level != NOT_LINKED) unlink(id);
+
+    // _now落后于millis()时从millis()算起；至少晚1毫秒，不会落在正在执行的槽中
+    uint32_t lag = millis() - _now;
+    if (delayMs == 0) delayMs = 1;
+    if (delayMs > MAX_DELAY_MS - lag) delayMs = MAX_DELAY_MS - lag;
+    uint32_t expiry = millis() + delayMs;
+    _timers[id].expiry = expiry;
+    link(id);
+    LoopScheduler::instance().at(expiry);
+}
+
+void TimerWheel::cancel(TimerId id) {
+    if (id < _created && _timers[id].level != NOT_LINKED) unlink(id);
+}
+
+void TimerWheel::link(TimerId id) {
+    Timer& timer = _timers[id];
+    int32_t delta = (int32_t)(timer.expiry - _now);
+    if (delta < 0) delta = 0;
+
+    // 距到期不足64^(k+1)毫秒的放在第k层
+    uint8_t level = 0;
+    while (level < LEVELS - 1 && (uint32_t)delta >= (1UL << ((level + 1) * SLOT_BITS))) {
+        level++;
+    }
+    uint8_t index = slotIndex(timer.expiry, level);
+
+    timer.level = level;
+    timer.index = index;
+    timer.prev = INVALID;
+    timer.next = _heads[level][index];
+    if (timer.next != INVALID) _timers[timer.next].prev = id;
+    _heads[level][index] = id;
+    _occupied[level] |= 1ULL << index;
+}
+
+void TimerWheel::unlink(TimerId id) {
+    Timer& timer = _timers[id];
+    if (timer.prev != INVALID) {
+        _timers[timer.prev].next = timer.next;
+    } else {
+        _heads[timer.level][timer.index] = timer.next;
+        if (timer.next == INVALID) _occupied[timer.level] &= ~(1ULL << timer.index);
+    }
+    if (timer.next != INVALID) _timers[timer.next].prev = timer.prev;
+    timer.level = NOT_LINKED;
+}
+
+bool TimerWheel::nextEvent(uint32_t& when) const {
+    bool found = false;
+    uint32_t best = 0;
+    for (uint8_t level = 0; level < LEVELS; level++) {
+        if (!_occupied[level]) continue;
+        // 从当前槽的下一个找起：第0层的当前槽已执行，上层的当前槽已下落（同一槽索引表示转一整圈之后）
+        uint8_t shift = level * SLOT_BITS;
+        uint8_t from = (slotIndex(_now, level) + 1) & (SLOTS - 1);
+        uint32_t steps = __builtin_ctzll(rotateRight(_occupied[level], from)) + 1;
+        uint32_t time = ((_now >> shift) << shift) + (steps << shift);
+        if (!found || (int32_t)(time - best) < 0) {
+            best = time;
+            found = true;
+        }
+    }
+    when = best;
+    return found;
+}
+
+void TimerWheel::cascade(uint8_t level) {
+    uint8_t index = slotIndex(_now, level);
+    TimerId id = _heads[level][index];
+    _heads[level][index] = INVALID;
+    _occupied[level] &= ~(1ULL << index);
+    while (id != INVALID) {
+        TimerId next = _timers[id].next;
+        link(id);
+        timersCascaded.add();
+        id = next;
+    }
+}
+
+void TimerWheel::expire() {
+    uint8_t index = slotIndex(_now, 0);
+    // 回调可能启动或取消定时器：每次重新取表头；重新启动的至少晚1毫秒，不会回到这个槽
+    TimerId id;
+    while ((id = _heads[0][index]) != INVALID) {
+        unlink(id);
+        timersFired.add();
+        _timers[id].callback(_timers[id].context);
+    }
+}
+
+void TimerWheel::update() {
+    uint32_t target = millis();
+    uint32_t next;
+    while ((int32_t)(target - _now) > 0) {
+        // 中间没有非空槽的时刻直接跳过
+        if (!nextEvent(next) || (int32_t)(next - target) > 0) {
+            _now = target;
+            break;
+        }
+        _now = next;
+        // 到达上层槽边界时从高到低逐层下落，再执行第0层
+        for (uint8_t level = LEVELS - 1; level > 0; level--) {
+            if ((_now & ((1UL << (level * SLOT_BITS)) - 1)) == 0) cascade(level);
+        }
+        expire();
+    }
+    if (nextEvent(next)) {
+        LoopScheduler::instance().at(next);
+    }
+}
+
+void TimerWheel::printStatus() const {
+    Serial.printf("--- 时间轮 (%u/%u) ---\n", _created, TIMER_WHEEL_CAPACITY);
+    for (TimerId id = 0; id < _created; id++) {
+        const Timer& timer = _timers[id];
+        if (timer.level == NOT_LINKED) {
+            Serial.printf("  %-12s 未启动\n", timer.name);
+        } else {
+            Serial.printf("  %-12s %ld ms后（第%u层）\n", timer.name,
+                          (long)(int32_t)(timer.expiry - millis()), timer.level);
+        }
+    }
+    Serial.printf("已执行 %lu 次，下落 %lu 次\n", (unsigned long)timersFired.get(),
+                  (unsigned long)timersCascaded.get());
+}
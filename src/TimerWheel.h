@@ -0,0 +1,107 @@
+/**
+ * @file TimerWheel.h
+ * @brief 主循环的分层时间轮定时器
+ * @details 各模块的超时（休眠各级、配置和内存寄存器的空闲保存、历史日志的空闲写入、按键统计同步等）
+ * 不再在每轮update()中比较millis()，而是在这里登记回调：
+ * - 定时器从固定容量的池中分配（TIMER_WHEEL_CAPACITY），create()一次，之后反复start()/cancel()
+ * - 4层×64槽，毫秒分辨率，第k层每槽覆盖64^k毫秒，最长约4.6小时；
+ *   start()/cancel()是O(1)的链表操作，上层的槽到达边界时整体下落到下层
+ * - update()推进到当前时刻并执行到期的回调，然后把最早的到期（或下落）时刻交给LoopScheduler，
+ *   没有定时器到期时主循环不为它们醒来；各层用64位占用位图找下一个非空槽，与定时器数量无关
+ *
+ * 只能在主循环中使用（回调也在主循环中执行）。其他任务的定时仍用esp_timer（蜂鸣器）
+ * 或在自己的任务中按固定节拍处理（按键去抖、长按、自动重复在扫描任务中随扫描进行）。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class TimerWheel {
+public:
+    typedef uint8_t TimerId;
+    typedef void (*Callback)(void* context);
+
+    static const TimerId INVALID = 0xFF;
+    static const uint32_t MAX_DELAY_MS = (1UL << 24) - 1;  ///< 最长延迟（约4.6小时），更长的按此计
+
+    static TimerWheel& instance() {
+        static TimerWheel instance;
+        return instance;
+    }
+
+    /**
+     * @brief 注册串口命令，从当前时刻开始计时
+     */
+    void begin();
+
+    /**
+     * @brief 从池中分配一个定时器（未启动）
+     * @param name 名称（timers命令显示），需在整个运行期间有效
+     * @return 池已满时返回INVALID，之后对它的start()/cancel()不做任何事
+     */
+    TimerId create(const char* name, Callback callback, void* context);
+
+    /**
+     * @brief 启动或重新启动：delayMs后调用回调一次（0表示下一毫秒）
+     */
+    void start(TimerId id, uint32_t delayMs);
+
+    void cancel(TimerId id);
+
+    bool isActive(TimerId id) const { return id < _created && _timers[id].level != NOT_LINKED; }
+
+    /**
+     * @brief 推进到当前时刻并执行到期的回调，每轮主循环调用一次
+     */
+    void update();
+
+    void printStatus() const;
+
+private:
+    static const uint8_t LEVELS = 4;
+    static const uint8_t SLOT_BITS = 6;
+    static const uint8_t SLOTS = 1 << SLOT_BITS;
+    static const uint8_t NOT_LINKED = 0xFF;
+
+    struct Timer {
+        Callback callback;
+        void* context;
+        const char* name;
+        uint32_t expiry;        ///< 到期时刻（millis）
+        TimerId prev;
+        TimerId next;
+        uint8_t level;          ///< 所在层，NOT_LINKED表示未启动
+        uint8_t index;          ///< 所在槽
+    };
+
+    TimerWheel();
+
+    static uint8_t slotIndex(uint32_t time, uint8_t level) {
+        return (time >> (level * SLOT_BITS)) & (SLOTS - 1);
+    }
+
+    void link(TimerId id);
+    void unlink(TimerId id);
+
+    /**
+     * @brief 下一个需要处理的时刻：第0层为最早的到期，上层为最早的非空槽的边界
+     * @return 没有启动的定时器时返回false
+     */
+    bool nextEvent(uint32_t& when) const;
+
+    void cascade(uint8_t level);    ///< 把第level层当前槽的定时器重新放到下层
+    void expire();                  ///< 执行第0层当前槽中的回调
+
+    Timer _timers[TIMER_WHEEL_CAPACITY];
+    TimerId _created;
+    TimerId _heads[LEVELS][SLOTS];
+    uint64_t _occupied[LEVELS];     ///< 各层非空槽的位图
+    uint32_t _now;                  ///< 已处理到的时刻
+};
+
+#endif // TIMER_WHEEL_H
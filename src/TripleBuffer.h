@@ -0,0 +1,71 @@
+/**
+ * @file TripleBuffer.h
+ * @brief 单生产者单消费者无锁三缓冲
+ * @details 三个槽位分别归写入方（back）、读取方（front）和中间交换位所有：
+ * - 写入方填好back后publish()，与中间槽交换并置"有新内容"标记
+ * - 读取方acquire()时若有新内容，把front与中间槽交换，得到最新发布的值
+ * - 双方都不会等待对方，发布永远成功；读取方来不及取的旧值被直接覆盖，只保留最新的
+ * - 交换只是一次原子exchange，槽位内容不复制
+ * 只允许一个任务写入、一个任务读取。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : _middle(2), _back(1), _front(0) {}
+
+    /**
+     * @brief 写入方正在填写的槽位（仅写入方调用），内容是两次发布之前的旧值
+     */
+    T &back() { return _slots[_back]; }
+
+    /**
+     * @brief 发布back槽位（仅写入方调用）
+     */
+    void publish() {
+        uint32_t prev = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+        _back = prev & INDEX_MASK;
+    }
+
+    /**
+     * @brief 取得最新发布的值（仅读取方调用）
+     * @return 自上次acquire()以来没有新发布时返回false，front()保持不变
+     */
+    bool acquire() {
+        if (!(_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        uint32_t prev = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = prev & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief 读取方当前持有的值（仅读取方调用）
+     */
+    const T &front() const { return _slots[_front]; }
+
+    /**
+     * @brief 是否有尚未取走的发布（任一方可调用，结果仅供参考）
+     */
+    bool pending() const {
+        return (_middle.load(std::memory_order_acquire) & FRESH) != 0;
+    }
+
+private:
+    static const uint32_t INDEX_MASK = 0x03;
+    static const uint32_t FRESH = 0x04;
+
+    T _slots[3];
+    std::atomic<uint32_t> _middle;  ///< 中间槽序号 | FRESH
+    uint32_t _back;                 ///< 写入方独占
+    uint32_t _front;                ///< 读取方独占
+};
+
+#endif // TRIPLE_BUFFER_H
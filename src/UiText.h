@@ -0,0 +1,16 @@
+/**
+ * @file UiText.h
+ * @brief 标记显示在屏幕上的字符串
+ * @details UI_TEXT("...")在编译时就是字符串本身。构建时tools/cjk_subset.py扫描这些标记，
+ * 把其中的非ASCII字符做成字形子集（CjkText），没有标记的中文在屏幕上只会显示为方框。
+ * 日志、串口输出的字符串不需要标记。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef UI_TEXT_H
+#define UI_TEXT_H
+
+#define UI_TEXT(s) s
+
+#endif // UI_TEXT_H
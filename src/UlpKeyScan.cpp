@@ -0,0 +1,264 @@
+/**
+ * @file UlpKeyScan.cpp
+ * @brief 睡眠期间ULP按键扫描的实现
+ *
+ * @author Calculator Project
+ */
+
+#include "UlpKeyScan.h"
+
+#if ULP_KEY_SCAN_ENABLED
+
+#include "Console.h"
+#include "Logger.h"
+#include <driver/rtc_io.h>
+#include <esp_sleep.h>
+#include <esp32s3/ulp.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/rtc_io_reg.h>
+
+#ifndef CONFIG_ESP32S3_ULP_COPROC_ENABLED
+#error "ULP_KEY_SCAN_ENABLED需要在sdkconfig中启用ULP协处理器"
+#endif
+
+#define TAG_ULP "UlpScan"
+
+#define ULP_STOP_WAIT_US 200    // 停止定时器后等正在进行的一次扫描跑完（一次约几十微秒）
+
+namespace {
+
+// 程序中的标号
+enum Label : uint8_t {
+    L_BIT,
+    L_READ_DONE,
+    L_HI_SAME,
+    L_CHANGED,
+    L_CAND_HI_SAME,
+    L_NEW_CAND,
+    L_WAKE,
+    L_UNCHANGED,
+};
+
+const gpio_num_t SCAN_PINS[] = {(gpio_num_t)SCAN_PL_PIN, (gpio_num_t)SCAN_CE_PIN, (gpio_num_t)SCAN_CLK_PIN,
+                                (gpio_num_t)SCAN_MISO_PIN};
+static_assert(SCAN_PL_PIN <= 21 && SCAN_CE_PIN <= 21 && SCAN_CLK_PIN <= 21 && SCAN_MISO_PIN <= 21,
+              "ULP扫描的引脚必须是RTC GPIO（0-21）");
+
+void cmdUlp(const ConsoleArgs&) {
+    UlpKeyScan::instance().printStatus();
+}
+
+constexpr ConsoleCommand ULP_COMMANDS[] = {
+    {"ulp", "", "显示睡眠期间ULP按键扫描的状态和统计", cmdUlp},
+};
+static_assert(consoleSorted(ULP_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+UlpKeyScan::UlpKeyScan()
+    : _ready(false),
+      _armed(false),
+      _wakePending(false),
+      _wakeState(0),
+      _programWords(0),
+      _arms(0),
+      _wakes(0),
+      _scans(0) {
+}
+
+bool UlpKeyScan::begin() {
+    if (_ready) return true;
+    Console::instance().addCommands(ULP_COMMANDS);
+
+    // 深度睡眠中的定时器和RTC GPIO配置在重启后仍然有效，先停下并收回引脚
+    CLEAR_PERI_REG_MASK(RTC_CNTL_ULP_CP_TIMER_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_ULP) {
+        _wakeState = ((uint32_t)readWord(WORD_WAKE_HI) << 16) | readWord(WORD_WAKE_LO);
+        _wakePending = true;
+        _wakes++;
+        LOG_I(TAG_ULP, "由ULP唤醒，按键状态 0x%06lX", (unsigned long)_wakeState);
+    }
+    releasePins();
+
+    // RTC GPIO的位号：输出在W1TS/W1TC寄存器中，输入在IN寄存器中，都从第10位开始
+    const uint32_t pl = RTC_GPIO_OUT_DATA_W1TS_S + rtc_io_number_get((gpio_num_t)SCAN_PL_PIN);
+    const uint32_t clk = RTC_GPIO_OUT_DATA_W1TS_S + rtc_io_number_get((gpio_num_t)SCAN_CLK_PIN);
+    const uint32_t miso = RTC_GPIO_IN_NEXT_S + rtc_io_number_get((gpio_num_t)SCAN_MISO_PIN);
+
+    // R1：低16位，R3：高8位，R2：位计数，读完后为0，作为数据区基址
+    const ulp_insn_t program[] = {
+        I_MOVI(R2, 0),
+        I_LD(R0, R2, WORD_SCANS),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R2, WORD_SCANS),
+
+        // PL拉高：锁存并切换到移位，第一位已在MISO上；高位先出，与readShiftRegisters()的位序一致
+        I_WR_REG(RTC_GPIO_OUT_W1TS_REG, pl, pl, 1),
+        I_MOVI(R1, 0),
+        I_MOVI(R3, 0),
+        I_MOVI(R2, 24),
+        M_LABEL(L_BIT),
+            I_RSHI(R0, R1, 15),             // 低16位的最高位移入高8位
+            I_LSHI(R3, R3, 1),
+            I_ORR(R3, R3, R0),
+            I_LSHI(R1, R1, 1),
+            I_RD_REG(RTC_GPIO_IN_REG, miso, miso),
+            I_ORR(R1, R1, R0),
+            I_WR_REG(RTC_GPIO_OUT_W1TS_REG, clk, clk, 1),
+            I_WR_REG(RTC_GPIO_OUT_W1TC_REG, clk, clk, 1),
+            I_SUBI(R2, R2, 1),
+            M_BXZ(L_READ_DONE),
+            M_BX(L_BIT),
+        M_LABEL(L_READ_DONE),
+        // PL回到低电平（持续并行加载），与空闲档一致
+        I_WR_REG(RTC_GPIO_OUT_W1TC_REG, pl, pl, 1),
+
+        // 与基准比较（ALU没有异或，逐字相减判断相等）
+        I_LD(R0, R2, WORD_BASE_HI),
+        I_SUBR(R0, R0, R3),
+        M_BXZ(L_HI_SAME),
+        M_BX(L_CHANGED),
+        M_LABEL(L_HI_SAME),
+        I_LD(R0, R2, WORD_BASE_LO),
+        I_SUBR(R0, R0, R1),
+        M_BXZ(L_UNCHANGED),
+
+        // 有变化：与上一次的候选一致才唤醒，否则记为新的候选
+        M_LABEL(L_CHANGED),
+        I_LD(R0, R2, WORD_CAND_VALID),
+        M_BL(L_NEW_CAND, 1),
+        I_LD(R0, R2, WORD_CAND_HI),
+        I_SUBR(R0, R0, R3),
+        M_BXZ(L_CAND_HI_SAME),
+        M_BX(L_NEW_CAND),
+        M_LABEL(L_CAND_HI_SAME),
+        I_LD(R0, R2, WORD_CAND_LO),
+        I_SUBR(R0, R0, R1),
+        M_BXZ(L_WAKE),
+        M_LABEL(L_NEW_CAND),
+        I_ST(R1, R2, WORD_CAND_LO),
+        I_ST(R3, R2, WORD_CAND_HI),
+        I_MOVI(R0, 1),
+        I_ST(R0, R2, WORD_CAND_VALID),
+        I_HALT(),
+
+        // 记下状态，唤醒主CPU并停止定时器（主CPU醒来后disarm()）
+        M_LABEL(L_WAKE),
+        I_ST(R1, R2, WORD_WAKE_LO),
+        I_ST(R3, R2, WORD_WAKE_HI),
+        I_WAKE(),
+        I_WR_REG(RTC_CNTL_ULP_CP_TIMER_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN_S, RTC_CNTL_ULP_CP_SLP_TIMER_EN_S, 0),
+        I_HALT(),
+
+        // 与基准相同：抖动或已松开，丢弃候选
+        M_LABEL(L_UNCHANGED),
+        I_MOVI(R0, 0),
+        I_ST(R0, R2, WORD_CAND_VALID),
+        I_HALT(),
+    };
+
+    size_t size = sizeof(program) / sizeof(ulp_insn_t);
+    esp_err_t err = ulp_process_macros_and_load(DATA_WORDS, program, &size);
+    if (err != ESP_OK) {
+        LOG_E(TAG_ULP, "扫描程序装入失败: %s（保留区 %d 字节）", esp_err_to_name(err),
+              CONFIG_ESP32S3_ULP_COPROC_RESERVE_MEM);
+        return false;
+    }
+    _programWords = size;
+    _ready = true;
+    LOG_I(TAG_ULP, "ULP按键扫描: 程序 %u 字，睡眠中每 %d ms 扫描一次", (unsigned)size, ULP_KEY_SCAN_PERIOD_MS);
+    return true;
+}
+
+uint16_t UlpKeyScan::readWord(uint8_t word) {
+    return RTC_SLOW_MEM[word] & 0xFFFF;
+}
+
+void UlpKeyScan::writeWord(uint8_t word, uint16_t value) {
+    RTC_SLOW_MEM[word] = value;
+}
+
+void UlpKeyScan::arm(uint32_t idleState) {
+    if (!_ready || _armed) return;
+
+    writeWord(WORD_BASE_LO, idleState & 0xFFFF);
+    writeWord(WORD_BASE_HI, (idleState >> 16) & 0xFF);
+    writeWord(WORD_CAND_VALID, 0);
+    writeWord(WORD_SCANS, 0);
+    claimPins();
+
+    // RTC GPIO在RTC外设电源域中，睡眠期间保持供电
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+    ulp_set_wakeup_period(0, ULP_KEY_SCAN_PERIOD_MS * 1000UL);
+    if (ulp_run(DATA_WORDS) != ESP_OK) {
+        LOG_E(TAG_ULP, "ULP启动失败");
+        releasePins();
+        esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_AUTO);
+        return;
+    }
+    _armed = true;
+    _arms++;
+}
+
+void UlpKeyScan::disarm() {
+    if (!_armed) return;
+    CLEAR_PERI_REG_MASK(RTC_CNTL_ULP_CP_TIMER_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+    delayMicroseconds(ULP_STOP_WAIT_US);
+    releasePins();
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_AUTO);
+    _armed = false;
+    _scans += readWord(WORD_SCANS);
+
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_ULP) {
+        _wakeState = ((uint32_t)readWord(WORD_WAKE_HI) << 16) | readWord(WORD_WAKE_LO);
+        _wakePending = true;
+        _wakes++;
+    }
+}
+
+bool UlpKeyScan::takeWake(uint32_t& state) {
+    if (!_wakePending) return false;
+    _wakePending = false;
+    state = _wakeState;
+    return true;
+}
+
+void UlpKeyScan::claimPins() {
+    // 先设电平再设方向，切换时输出不出现毛刺；CE保持为低（165始终使能）
+    for (gpio_num_t pin : SCAN_PINS) {
+        gpio_hold_dis(pin);
+        rtc_gpio_init(pin);
+        if (pin == SCAN_MISO_PIN) {
+            rtc_gpio_set_direction(pin, RTC_GPIO_MODE_INPUT_ONLY);
+            rtc_gpio_pullup_dis(pin);
+            rtc_gpio_pulldown_dis(pin);
+        } else {
+            rtc_gpio_set_level(pin, 0);
+            rtc_gpio_set_direction(pin, RTC_GPIO_MODE_OUTPUT_ONLY);
+        }
+    }
+}
+
+void UlpKeyScan::releasePins() {
+    // IO MUX的功能选择没有改动，切回数字GPIO后SPI的时钟和数据线照常经GPIO矩阵连接
+    for (gpio_num_t pin : SCAN_PINS) {
+        rtc_gpio_deinit(pin);
+    }
+}
+
+void UlpKeyScan::printStatus() const {
+    Serial.println("=== ULP按键扫描 ===");
+    if (!_ready) {
+        Serial.println("未启用（扫描程序没有装入），睡眠只由MISO唤醒");
+        return;
+    }
+    Serial.printf("程序: %u 字 + 数据 %u 字（保留区 %d 字节），睡眠中每 %d ms 扫描一次\n", (unsigned)_programWords,
+                  (unsigned)DATA_WORDS, CONFIG_ESP32S3_ULP_COPROC_RESERVE_MEM, ULP_KEY_SCAN_PERIOD_MS);
+    Serial.printf("交给ULP %lu 次，其中由按键唤醒 %lu 次，睡眠中共扫描 %lu 次\n", (unsigned long)_arms,
+                  (unsigned long)_wakes, (unsigned long)_scans);
+    if (_wakes) {
+        Serial.printf("最近一次唤醒时的状态: 0x%06lX\n", (unsigned long)_wakeState);
+    }
+}
+
+#endif // ULP_KEY_SCAN_ENABLED
@@ -0,0 +1,96 @@
+/**
+ * @file UlpKeyScan.h
+ * @brief 睡眠期间由ULP协处理器扫描按键
+ * @details 没有ULP时浅睡眠和深度睡眠只能靠MISO唤醒：PL保持为低时串行输出只反映链上最后一级的输入，
+ * 其余按键在浅睡眠中靠每KEYPAD_IDLE_POLL_MS一次的定时唤醒兜底扫描发现，深度睡眠中则完全收不到。
+ * 启用后睡眠期间由ULP（FSM协处理器）每ULP_KEY_SCAN_PERIOD_MS读一遍整条165链：
+ * - 扫描程序在启动时用ULP宏汇编生成并装入RTC慢速内存的保留区，不需要另外的工具链
+ * - 睡前arm()把PL、CE、CLK、MISO切换为RTC GPIO交给ULP，写入睡前的状态作为基准
+ * - 与基准不同、且连续两次采样一致（约一个扫描间隔的去抖）时记下这次的状态、唤醒主CPU并停止定时器；
+ *   没有变化时主CPU一直睡，浅睡眠的定时唤醒放宽到ULP_KEY_SCAN_POLL_MS
+ * - 醒来后disarm()把引脚还给数字GPIO（SPI的信号经GPIO矩阵，不需要重新连接），
+ *   takeWake()取出唤醒时的状态；深度睡眠唤醒即重启，启动时begin()取出并保留给按键扫描
+ *
+ * RTC慢速内存布局（32位字，ULP只用低16位）：数据区DATA_WORDS个字，之后是程序。
+ * 24位的状态分为低16位和高8位两个字。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef ULP_KEY_SCAN_H
+#define ULP_KEY_SCAN_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if ULP_KEY_SCAN_ENABLED
+
+class UlpKeyScan {
+public:
+    static UlpKeyScan& instance() {
+        static UlpKeyScan instance;
+        return instance;
+    }
+
+    /**
+     * @brief 生成并装入扫描程序，注册串口命令
+     * @details 从深度睡眠由ULP唤醒时先取出唤醒状态并释放引脚，须在按键引脚初始化之前调用
+     * @return 保留区放不下程序等失败时返回false，之后睡眠照旧只由MISO唤醒
+     */
+    bool begin();
+
+    bool isReady() const { return _ready; }
+
+    /**
+     * @brief 睡前交给ULP扫描
+     * @param idleState 睡前的原始扫描状态（低电平为按下），变化以它为基准
+     */
+    void arm(uint32_t idleState);
+
+    /**
+     * @brief 醒来后停止扫描并把引脚还给数字GPIO（arm()之后必须调用，重复调用无影响）
+     */
+    void disarm();
+
+    /**
+     * @brief 取出ULP唤醒时记下的原始扫描状态（只能取一次）
+     * @return 这次不是ULP唤醒的（定时、串口等）时返回false
+     */
+    bool takeWake(uint32_t& state);
+
+    void printStatus() const;
+
+private:
+    // 数据区的字偏移
+    enum DataWord : uint8_t {
+        WORD_BASE_LO,       ///< 基准状态（arm()写入）
+        WORD_BASE_HI,
+        WORD_CAND_LO,       ///< 上一次与基准不同的采样，下一次一致才唤醒
+        WORD_CAND_HI,
+        WORD_CAND_VALID,
+        WORD_WAKE_LO,       ///< 唤醒时的状态
+        WORD_WAKE_HI,
+        WORD_SCANS,         ///< 本次睡眠的扫描次数（回绕）
+        DATA_WORDS
+    };
+
+    UlpKeyScan();
+
+    static uint16_t readWord(uint8_t word);
+    static void writeWord(uint8_t word, uint16_t value);
+    void claimPins();
+    void releasePins();
+
+    bool _ready;
+    bool _armed;
+    bool _wakePending;          ///< 有未取出的唤醒状态
+    uint32_t _wakeState;
+    size_t _programWords;
+    uint32_t _arms;             ///< 交给ULP的次数
+    uint32_t _wakes;            ///< 其中由ULP唤醒的次数
+    uint32_t _scans;            ///< 睡眠期间ULP的扫描次数（累计）
+};
+
+#endif // ULP_KEY_SCAN_ENABLED
+
+#endif // ULP_KEY_SCAN_H
@@ -0,0 +1,292 @@
+/**
+ * @file UndoHistory.cpp
+ * @brief 计算器状态撤销/重做实现
+ *
+ * @author Calculator Project
+ */
+
+#include "UndoHistory.h"
+#include "BufferPlacement.h"
+#include <string.h>
+
+namespace {
+
+inline size_t alignUp(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+template <size_t N>
+void assignText(FixedString<N>& text, const uint8_t* data, size_t length) {
+    text.clear();
+    for (size_t i = 0; i < length; i++) text.append((char)data[i]);
+}
+
+// 两段文本相同的前缀长度
+size_t commonPrefix(const char* a, size_t aLength, const char* b, size_t bLength) {
+    size_t n = aLength < bLength ? aLength : bLength;
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) i++;
+    return i;
+}
+
+} // namespace
+
+UndoHistory::UndoHistory()
+    : _steps(nullptr),
+      _depth(0),
+      _first(0),
+      _count(0),
+      _cursor(0),
+      _buffer(nullptr),
+      _bufferSize(0),
+      _tail(0),
+      _pending(false),
+      _pendingTokenCount(0) {
+}
+
+UndoHistory::~UndoHistory() {
+    placedFree(_steps);
+    placedFree(_buffer);
+}
+
+bool UndoHistory::begin(uint8_t depth, size_t bufferSize) {
+    if (_steps || !depth || bufferSize > UINT16_MAX) return false;
+    _steps = (Step*)placedAlloc("undo_steps", sizeof(Step) * depth, PLACE_PSRAM);
+    _buffer = (uint8_t*)placedAlloc("undo_data", bufferSize, PLACE_PSRAM);
+    if (!_steps || !_buffer) {
+        placedFree(_steps);
+        placedFree(_buffer);
+        _steps = nullptr;
+        _buffer = nullptr;
+        return false;
+    }
+    _depth = depth;
+    _bufferSize = bufferSize;
+    clear();
+    return true;
+}
+
+void UndoHistory::clear() {
+    _first = 0;
+    _count = 0;
+    _cursor = 0;
+    _tail = 0;
+    _pending = false;
+}
+
+void UndoHistory::capture(const CalculatorCore& core, Scalars& scalars) {
+    scalars.currentNumber = core._currentNumber;
+    scalars.constantOperand = core._constantOperand;
+    scalars.inputMantissa = core._inputMantissa;
+    scalars.constantOp = core._constantOp;
+    scalars.state = core._state;
+    scalars.lastError = core._lastError;
+    scalars.inputScale = core._inputScale;
+    scalars.inputExact = core._inputExact;
+    scalars.waitingForOperand = core._waitingForOperand;
+    scalars.hasDecimalPoint = core._hasDecimalPoint;
+    scalars.cursor = core._expression->cursor();
+}
+
+bool UndoHistory::sameScalars(const Scalars& a, const Scalars& b) {
+    // 按位比较数值：-0与0、结果相同但来历不同的数都算变化；光标不比较，只移动光标不记为一步
+    return memcmp(&a.currentNumber, &b.currentNumber, sizeof(double)) == 0 &&
+           memcmp(&a.constantOperand, &b.constantOperand, sizeof(double)) == 0 &&
+           a.inputMantissa == b.inputMantissa && a.constantOp == b.constantOp &&
+           a.state == b.state && a.lastError == b.lastError && a.inputScale == b.inputScale &&
+           a.inputExact == b.inputExact && a.waitingForOperand == b.waitingForOperand &&
+           a.hasDecimalPoint == b.hasDecimalPoint;
+}
+
+bool UndoHistory::sameToken(const ExprToken& a, const ExprToken& b) {
+    return a.type == b.type && a.op == b.op && a.textLength == b.textLength &&
+           memcmp(&a.value, &b.value, sizeof(double)) == 0;
+}
+
+size_t UndoHistory::sideSize(const Side& side, const Step& step) {
+    return alignUp((side.tokenCount - step.tokenPrefix) * sizeof(ExprToken) +
+                   (side.textLength - step.textPrefix) + side.inputLength + side.displayLength);
+}
+
+void UndoHistory::beginStep(const CalculatorCore& core) {
+    if (!_steps) return;
+    capture(core, _pendingScalars);
+    _pendingTokenCount = core._expression->size();
+    for (uint8_t i = 0; i < _pendingTokenCount; i++) {
+        _pendingTokens[i] = core._expression->tokenAt(i);
+    }
+    _pendingText = core._expressionDisplay.c_str();
+    _pendingInput = core._inputBuffer.c_str();
+    _pendingDisplay = core._currentDisplay.c_str();
+    _pending = true;
+}
+
+void UndoHistory::endStep(const CalculatorCore& core) {
+    if (!_pending) return;
+    _pending = false;
+
+    Step step;
+    capture(core, step.after.scalars);
+    step.before.scalars = _pendingScalars;
+
+    const Expression& expression = *core._expression;
+    step.before.tokenCount = _pendingTokenCount;
+    step.after.tokenCount = expression.size();
+    uint8_t prefix = 0;
+    while (prefix < _pendingTokenCount && prefix < expression.size() &&
+           sameToken(_pendingTokens[prefix], expression.tokenAt(prefix))) {
+        prefix++;
+    }
+    step.tokenPrefix = prefix;
+
+    step.before.textLength = _pendingText.length();
+    step.after.textLength = core._expressionDisplay.length();
+    step.textPrefix = commonPrefix(_pendingText.c_str(), _pendingText.length(),
+                                   core._expressionDisplay.c_str(), core._expressionDisplay.length());
+    step.before.inputLength = _pendingInput.length();
+    step.after.inputLength = core._inputBuffer.length();
+    step.before.displayLength = _pendingDisplay.length();
+    step.after.displayLength = core._currentDisplay.length();
+
+    bool changed = !sameScalars(step.before.scalars, step.after.scalars) ||
+                   prefix != step.before.tokenCount || prefix != step.after.tokenCount ||
+                   step.textPrefix != step.before.textLength || step.textPrefix != step.after.textLength ||
+                   _pendingInput != core._inputBuffer.c_str() || _pendingDisplay != core._currentDisplay.c_str();
+    if (!changed) return;
+
+    // 新的一步之后不能再重做已撤销的步骤
+    _count = _cursor;
+    if (_count) {
+        const Step& newest = stepAt(_count - 1);
+        _tail = newest.offset + newest.size;
+    } else {
+        _tail = 0;
+    }
+    if (_count == _depth) dropOldest();
+
+    size_t beforeSize = sideSize(step.before, step);
+    size_t size = beforeSize + sideSize(step.after, step);
+    uint8_t* data = reserve(size);
+    if (!data) {
+        // 一步的数据比整个缓冲还大：之前的步骤已无法衔接
+        clear();
+        return;
+    }
+    step.offset = (uint16_t)(data - _buffer);
+    step.size = (uint16_t)size;
+
+    // 之前一侧：按键前的记号和文本后缀
+    uint8_t* p = data;
+    size_t n = (step.before.tokenCount - prefix) * sizeof(ExprToken);
+    memcpy(p, _pendingTokens + prefix, n);
+    p += n;
+    memcpy(p, _pendingText.c_str() + step.textPrefix, step.before.textLength - step.textPrefix);
+    p += step.before.textLength - step.textPrefix;
+    memcpy(p, _pendingInput.c_str(), step.before.inputLength);
+    p += step.before.inputLength;
+    memcpy(p, _pendingDisplay.c_str(), step.before.displayLength);
+
+    // 之后一侧：按键后的记号和文本后缀
+    p = data + beforeSize;
+    for (uint8_t i = prefix; i < expression.size(); i++) {
+        memcpy(p, &expression.tokenAt(i), sizeof(ExprToken));
+        p += sizeof(ExprToken);
+    }
+    memcpy(p, core._expressionDisplay.c_str() + step.textPrefix, step.after.textLength - step.textPrefix);
+    p += step.after.textLength - step.textPrefix;
+    memcpy(p, core._inputBuffer.c_str(), step.after.inputLength);
+    p += step.after.inputLength;
+    memcpy(p, core._currentDisplay.c_str(), step.after.displayLength);
+
+    stepAt(_count) = step;
+    _count++;
+    _cursor = _count;
+}
+
+uint8_t* UndoHistory::reserve(size_t size) {
+    if (size > _bufferSize) return nullptr;
+    for (;;) {
+        if (_count == 0) {
+            _tail = 0;
+            break;
+        }
+        size_t head = stepAt(0).offset;
+        if (_tail > head) {
+            // 未回绕：[tail, 末尾)和[0, head)空闲
+            if (_tail + size <= _bufferSize) break;
+            if (size <= head) {
+                _tail = 0;
+                break;
+            }
+        } else if (_tail + size <= head) {
+            // 已回绕：只有[tail, head)空闲
+            break;
+        }
+        dropOldest();
+    }
+    uint8_t* data = _buffer + _tail;
+    _tail += size;
+    return data;
+}
+
+void UndoHistory::dropOldest() {
+    _first = (_first + 1) % _depth;
+    _count--;
+    if (_cursor) _cursor--;
+}
+
+bool UndoHistory::apply(CalculatorCore& core, const Step& step, bool before) {
+    const Side& side = before ? step.before : step.after;
+    const uint8_t* data = _buffer + step.offset + (before ? 0 : sideSize(step.before, step));
+
+    // 当前状态应是另一侧；不是时（例如记录之外改过状态）不能按前缀衔接
+    if (core._expression->size() < step.tokenPrefix || core._expressionDisplay.length() < step.textPrefix) {
+        return false;
+    }
+
+    uint8_t tokens = side.tokenCount - step.tokenPrefix;
+    if (!core._expression->restore(step.tokenPrefix, (const ExprToken*)data, tokens)) return false;
+    data += tokens * sizeof(ExprToken);
+
+    core._expressionDisplay.truncate(step.textPrefix);
+    for (size_t i = step.textPrefix; i < side.textLength; i++) {
+        core._expressionDisplay.append((char)*data++);
+    }
+    assignText(core._inputBuffer, data, side.inputLength);
+    data += side.inputLength;
+    assignText(core._currentDisplay, data, side.displayLength);
+
+    const Scalars& s = side.scalars;
+    core._currentNumber = s.currentNumber;
+    core._constantOperand = s.constantOperand;
+    core._inputMantissa = s.inputMantissa;
+    core._constantOp = s.constantOp;
+    core._state = s.state;
+    core._lastError = s.lastError;
+    core._inputScale = s.inputScale;
+    core._inputExact = s.inputExact;
+    core._waitingForOperand = s.waitingForOperand;
+    core._hasDecimalPoint = s.hasDecimalPoint;
+    core._expression->moveCursor(s.cursor);
+    return true;
+}
+
+bool UndoHistory::undo(CalculatorCore& core) {
+    if (!_cursor) return false;
+    if (!apply(core, stepAt(_cursor - 1), true)) {
+        clear();
+        return false;
+    }
+    _cursor--;
+    return true;
+}
+
+bool UndoHistory::redo(CalculatorCore& core) {
+    if (_cursor == _count) return false;
+    if (!apply(core, stepAt(_cursor), false)) {
+        clear();
+        return false;
+    }
+    _cursor++;
+    return true;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file UndoHistory.h
+ * @brief 计算器状态的撤销/重做
+ * @details 每次按键处理前后各取一次CalculatorCore的状态，有变化时记为一步：
+ * - 数值、状态等标量按值保存（每侧几十字节）
+ * - 记号序列和表达式文本只保存两侧共同前缀之后的部分：输入数字不改变记号，
+ *   运算符只追加一个，只有=和C才保存整个表达式
+ * - 步骤放在固定容量的环中，数据放在一块环形缓冲（优先PSRAM），
+ *   任一个放不下时丢弃最早的步骤；记录新的一步时丢弃可重做的步骤
+ * 撤销/重做只是移动游标、截断并追加保存的后缀，求值状态从表达式的检查点衔接，
+ * 不重新计算整个表达式，也不分配内存。
+ * 内存寄存器、统计量和累计总计是按键的副作用，不在撤销范围内。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef UNDO_HISTORY_H
+#define UNDO_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CalculatorCore.h"
+#include "Expression.h"
+
+class UndoHistory {
+public:
+    UndoHistory();
+    ~UndoHistory();
+
+    /**
+     * @brief 分配步骤环和数据缓冲
+     * @param depth 最多保存的步数
+     * @param bufferSize 记号和文本数据的缓冲字节数
+     * @return 分配失败时返回false，之后的记录和撤销都不做任何事
+     */
+    bool begin(uint8_t depth, size_t bufferSize);
+
+    /**
+     * @brief 按键处理前：记下处理前的状态
+     */
+    void beginStep(const CalculatorCore& core);
+
+    /**
+     * @brief 按键处理后：与处理前比较，有变化时保存为一步
+     */
+    void endStep(const CalculatorCore& core);
+
+    /**
+     * @brief 恢复到上一步之前的状态
+     * @return 没有可撤销的步骤时返回false
+     */
+    bool undo(CalculatorCore& core);
+
+    /**
+     * @brief 重新执行撤销掉的一步
+     * @return 没有可重做的步骤时返回false
+     */
+    bool redo(CalculatorCore& core);
+
+    void clear();
+
+    uint8_t undoCount() const { return _cursor; }
+    uint8_t redoCount() const { return _count - _cursor; }
+
+private:
+    // 表达式和文本以外的核心状态
+    struct Scalars {
+        double currentNumber;
+        double constantOperand;
+        int64_t inputMantissa;
+        Operator constantOp;
+        CalculatorState state;
+        CalculatorError lastError;
+        uint8_t inputScale;
+        bool inputExact;
+        bool waitingForOperand;
+        bool hasDecimalPoint;
+        uint8_t cursor;             ///< 表达式光标（只移动光标不算一步）
+    };
+
+    // 一步的一侧（之前或之后），变长部分依次为记号后缀、表达式文本后缀、输入缓冲、当前显示
+    struct Side {
+        Scalars scalars;
+        uint8_t tokenCount;
+        uint8_t textLength;
+        uint8_t inputLength;
+        uint8_t displayLength;
+    };
+
+    struct Step {
+        Side before;
+        Side after;
+        uint8_t tokenPrefix;        ///< 两侧相同的前缀记号数
+        uint8_t textPrefix;         ///< 两侧相同的表达式文本前缀长度
+        uint16_t offset;            ///< 数据在缓冲中的位置（8字节对齐），之前一侧在前
+        uint16_t size;
+    };
+
+    static void capture(const CalculatorCore& core, Scalars& scalars);
+    static bool sameScalars(const Scalars& a, const Scalars& b);
+    static bool sameToken(const ExprToken& a, const ExprToken& b);
+    static size_t sideSize(const Side& side, const Step& step);
+
+    Step& stepAt(uint8_t index) { return _steps[(_first + index) % _depth]; }
+    uint8_t* reserve(size_t size);
+    void dropOldest();
+    bool apply(CalculatorCore& core, const Step& step, bool before);
+
+    Step* _steps;
+    uint8_t _depth;
+    uint8_t _first;                 ///< 最早一步在环中的位置
+    uint8_t _count;                 ///< 已保存的步数
+    uint8_t _cursor;                ///< 已执行的步数，之后的是可重做的步骤
+    uint8_t* _buffer;
+    size_t _bufferSize;
+    size_t _tail;                   ///< 下一步数据的写入位置
+
+    // 按键处理前的完整状态（结束时只保存变化的部分）
+    bool _pending;
+    Scalars _pendingScalars;
+    ExprToken _pendingTokens[Expression::MAX_TOKENS];
+    uint8_t _pendingTokenCount;
+    FixedString<CalculatorCore::EXPRESSION_CAPACITY> _pendingText;
+    FixedString<CalculatorCore::INPUT_CAPACITY> _pendingInput;
+    FixedString<CalculatorCore::INPUT_CAPACITY> _pendingDisplay;
+};
+
+#endif // UNDO_HISTORY_H
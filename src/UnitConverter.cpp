@@ -0,0 +1,225 @@
+/**
+ * @file UnitConverter.cpp
+ * @brief 单位和货币换算实现
+ *
+ * @author Calculator Project
+ */
+
+#include "UnitConverter.h"
+#include "ConfigManager.h"
+#include "Console.h"
+#include "Logger.h"
+#include <math.h>
+#include <string.h>
+
+#define TAG_CONVERT "Convert"
+
+namespace {
+
+enum class Category : uint8_t {
+    LENGTH,
+    MASS,
+    TEMPERATURE
+};
+
+struct Unit {
+    const char* code;
+    Category category;
+    double scale;           // 1单位 = scale基准单位
+    double offset;          // 先加偏移再乘比例（温度）
+};
+
+// 按代码的字节序排列（大写在小写之前），查找时二分
+constexpr Unit UNITS[] = {
+    {"C", Category::TEMPERATURE, 1.0, 273.15},
+    {"F", Category::TEMPERATURE, 5.0 / 9.0, 459.67},
+    {"K", Category::TEMPERATURE, 1.0, 0.0},
+    {"cm", Category::LENGTH, 0.01, 0.0},
+    {"ft", Category::LENGTH, 0.3048, 0.0},
+    {"g", Category::MASS, 0.001, 0.0},
+    {"in", Category::LENGTH, 0.0254, 0.0},
+    {"jin", Category::MASS, 0.5, 0.0},
+    {"kg", Category::MASS, 1.0, 0.0},
+    {"km", Category::LENGTH, 1000.0, 0.0},
+    {"lb", Category::MASS, 0.45359237, 0.0},
+    {"m", Category::LENGTH, 1.0, 0.0},
+    {"mi", Category::LENGTH, 1609.344, 0.0},
+    {"mm", Category::LENGTH, 0.001, 0.0},
+    {"oz", Category::MASS, 0.028349523125, 0.0},
+    {"yd", Category::LENGTH, 0.9144, 0.0},
+};
+
+// 默认汇率（1美元可兑换的数量），只是出厂值，实际汇率由主机工具更新
+constexpr struct {
+    const char* code;
+    double perBase;
+} DEFAULT_RATES[] = {
+    {"CNY", 7.12},
+    {"EUR", 0.92},
+    {"GBP", 0.79},
+    {"HKD", 7.80},
+    {"JPY", 150.0},
+    {"USD", 1.0},
+};
+
+constexpr int compareCode(const char* a, const char* b) {
+    return *a != *b || !*a ? (unsigned char)*a - (unsigned char)*b : compareCode(a + 1, b + 1);
+}
+
+template <typename T, size_t N>
+constexpr bool codesSorted(const T (&table)[N], size_t i = 1) {
+    return i >= N || (compareCode(table[i - 1].code, table[i].code) < 0 && codesSorted(table, i + 1));
+}
+static_assert(codesSorted(UNITS), "单位表必须按代码排序");
+static_assert(codesSorted(DEFAULT_RATES), "汇率表必须按代码排序");
+static_assert(sizeof(DEFAULT_RATES) / sizeof(DEFAULT_RATES[0]) <= CURRENCY_MAX, "默认汇率超出CURRENCY_MAX");
+
+const Unit* findUnit(const char* code) {
+    size_t low = 0;
+    size_t high = sizeof(UNITS) / sizeof(UNITS[0]);
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int c = strcmp(UNITS[mid].code, code);
+        if (c == 0) return &UNITS[mid];
+        if (c < 0) low = mid + 1; else high = mid;
+    }
+    return nullptr;
+}
+
+// 串口命令
+void cmdRates(const ConsoleArgs& args) {
+    const CurrencyTableData& table = UnitConverter::instance().getTable();
+    Serial.printf("汇率表（%u 种）:\n", table.count);
+    for (uint8_t i = 0; i < table.count; i++) {
+        Serial.printf("  %s  %.6f\n", table.rates[i].code, table.rates[i].perBase);
+    }
+}
+
+void cmdRate(const ConsoleArgs& args) {
+    char* end = nullptr;
+    double rate = args.count > 2 ? strtod(args.arg(2), &end) : 0.0;
+    if (!end || *end || !UnitConverter::instance().setRate(args.arg(1), rate)) {
+        Serial.println("用法: rate <货币代码> <1基准货币兑换的数量>，代码为3个大写字母");
+        return;
+    }
+    Serial.printf("✅ %s = %.6f\n", args.arg(1), rate);
+}
+
+constexpr ConsoleCommand CONVERT_COMMANDS[] = {
+    {"rate", "<code> <rate>", "修改一种货币的汇率并保存", cmdRate},
+    {"rates", "", "显示汇率表", cmdRates},
+};
+static_assert(consoleSorted(CONVERT_COMMANDS), "命令表必须按名称排序");
+
+} // namespace
+
+UnitConverter::UnitConverter() {
+    loadDefaults();
+}
+
+void UnitConverter::begin() {
+    Console::instance().addCommands(CONVERT_COMMANDS);
+    CurrencyTableData stored;
+    if (ConfigManager::getInstance().loadCurrencyTable(stored) && isValid(stored)) {
+        _table = stored;
+        LOG_I(TAG_CONVERT, "已加载汇率表: %u 种货币", _table.count);
+    }
+}
+
+void UnitConverter::loadDefaults() {
+    _table = CurrencyTableData();
+    for (const auto& rate : DEFAULT_RATES) {
+        CurrencyRate& entry = _table.rates[_table.count++];
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.code, rate.code, sizeof(entry.code) - 1);
+        entry.perBase = rate.perBase;
+    }
+}
+
+const CurrencyRate* UnitConverter::findCurrency(const char* code) const {
+    size_t low = 0;
+    size_t high = _table.count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int c = strcmp(_table.rates[mid].code, code);
+        if (c == 0) return &_table.rates[mid];
+        if (c < 0) low = mid + 1; else high = mid;
+    }
+    return nullptr;
+}
+
+bool UnitConverter::resolve(const char* from, const char* to, Pair& pair) const {
+    const Unit* a = findUnit(from);
+    const Unit* b = findUnit(to);
+    if (a && b) {
+        if (a->category != b->category) return false;
+        pair.scale = a->scale / b->scale;
+        pair.offsetIn = a->offset;
+        pair.offsetOut = b->offset;
+        return true;
+    }
+
+    const CurrencyRate* x = findCurrency(from);
+    const CurrencyRate* y = findCurrency(to);
+    if (!x || !y) return false;
+    pair.scale = y->perBase / x->perBase;
+    pair.offsetIn = 0.0;
+    pair.offsetOut = 0.0;
+    return true;
+}
+
+bool UnitConverter::isValidCode(const char* code) {
+    for (uint8_t i = 0; i < 3; i++) {
+        if (code[i] < 'A' || code[i] > 'Z') return false;
+    }
+    return code[3] == '\0';
+}
+
+bool UnitConverter::isValid(const CurrencyTableData& table) {
+    if (table.version != CURRENCY_TABLE_VERSION || table.count > CURRENCY_MAX) return false;
+    for (uint8_t i = 0; i < table.count; i++) {
+        const CurrencyRate& rate = table.rates[i];
+        if (!isValidCode(rate.code) || !isfinite(rate.perBase) || rate.perBase <= 0.0) return false;
+        // 严格递增：有序且没有重复，查找才能二分
+        if (i && strcmp(table.rates[i - 1].code, rate.code) >= 0) return false;
+    }
+    return true;
+}
+
+size_t UnitConverter::exportTable(uint8_t* buffer, size_t size) const {
+    size_t length = CurrencyTableData::sizeFor(_table.count);
+    if (size < length) return 0;
+    memcpy(buffer, &_table, length);
+    return length;
+}
+
+bool UnitConverter::importTable(const uint8_t* data, size_t size) {
+    CurrencyTableData table;
+    if (size < CurrencyTableData::sizeFor(0) || size > sizeof(table)) return false;
+    memcpy(&table, data, size);
+    if (size != CurrencyTableData::sizeFor(table.count) || !isValid(table)) return false;
+    if (!ConfigManager::getInstance().saveCurrencyTable(table)) return false;
+    _table = table;
+    LOG_I(TAG_CONVERT, "汇率表已更新: %u 种货币", _table.count);
+    return true;
+}
+
+bool UnitConverter::setRate(const char* code, double perBase) {
+    if (!isValidCode(code) || !isfinite(perBase) || perBase <= 0.0) return false;
+
+    CurrencyTableData table = _table;
+    uint8_t i = 0;
+    while (i < table.count && strcmp(table.rates[i].code, code) < 0) i++;
+    if (i == table.count || strcmp(table.rates[i].code, code) != 0) {
+        // 新货币：插入到排序位置
+        if (table.count == CURRENCY_MAX) return false;
+        memmove(&table.rates[i + 1], &table.rates[i], (table.count - i) * sizeof(CurrencyRate));
+        memset(&table.rates[i], 0, sizeof(CurrencyRate));
+        memcpy(table.rates[i].code, code, 3);
+        table.count++;
+    }
+    table.rates[i].perBase = perBase;
+    if (!ConfigManager::getInstance().saveCurrencyTable(table)) return false;
+    _table = table;
+    return true;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file UnitConverter.h
+ * @brief 单位和货币换算
+ * @details 换算键的functionName为"conv:源单位:目标单位"（如"conv:in:cm"）：
+ * - 长度、质量、温度单位是Flash中按代码排序的constexpr表，二分查找，
+ *   每项为换算到基准单位（米、千克、开尔文）的比例和偏移
+ * - 货币汇率表在RAM中（也按代码排序），默认值编译在Flash中，
+ *   可经主机通道（HOST_CONFIG_CURRENCY）整表更新，作为一个blob保存在NVS
+ * 按键时把一对单位解析为Pair（一次查表），之后每次显示只是一次乘法（温度另加偏移）。
+ *
+ * @author Calculator Project
+ */
+
+#ifndef UNIT_CONVERTER_H
+#define UNIT_CONVERTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+#define CURRENCY_TABLE_VERSION 1
+
+// 一种货币：1单位基准货币可兑换perBase单位该货币
+struct CurrencyRate {
+    char code[4];               // 3个大写字母，'\0'结尾
+    uint32_t reserved;
+    double perBase;
+};
+
+// 汇率表的存储和主机传输格式：头 + count项（按代码排序），NVS中只保存用到的部分
+struct CurrencyTableData {
+    uint16_t version = CURRENCY_TABLE_VERSION;
+    uint8_t count = 0;
+    uint8_t reserved[5] = {};
+    CurrencyRate rates[CURRENCY_MAX];
+
+    static size_t sizeFor(uint8_t count) { return offsetof(CurrencyTableData, rates) + count * sizeof(CurrencyRate); }
+};
+
+class UnitConverter {
+public:
+    static UnitConverter& instance() {
+        static UnitConverter instance;
+        return instance;
+    }
+
+    /**
+     * @brief 一对单位的换算：结果 = (值 + offsetIn) × scale − offsetOut
+     */
+    struct Pair {
+        double scale;
+        double offsetIn;
+        double offsetOut;
+    };
+
+    /**
+     * @brief 注册串口命令，从NVS加载汇率表（没有或无效时用默认表）
+     */
+    void begin();
+
+    /**
+     * @brief 查找两个单位并算出换算系数
+     * @return 单位不存在或不属于同一类时返回false
+     */
+    bool resolve(const char* from, const char* to, Pair& pair) const;
+
+    static double apply(const Pair& pair, double value) {
+        return (value + pair.offsetIn) * pair.scale - pair.offsetOut;
+    }
+
+    /**
+     * @brief 导出汇率表（CurrencyTableData格式，只含用到的项）
+     * @return 字节数，缓冲不够时返回0
+     */
+    size_t exportTable(uint8_t* buffer, size_t size) const;
+
+    /**
+     * @brief 整表导入，校验通过后立即保存
+     * @return 格式、排序或汇率无效时返回false（保留原表）
+     */
+    bool importTable(const uint8_t* data, size_t size);
+
+    /**
+     * @brief 修改或新增一种货币的汇率并保存
+     */
+    bool setRate(const char* code, double perBase);
+
+    const CurrencyTableData& getTable() const { return _table; }
+
+private:
+    UnitConverter();
+
+    const CurrencyRate* findCurrency(const char* code) const;
+    static bool isValidCode(const char* code);
+    static bool isValid(const CurrencyTableData& table);
+    void loadDefaults();
+
+    CurrencyTableData _table;
+};
+
+#endif // UNIT_CONVERTER_H
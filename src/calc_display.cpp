@@ -1,19 +1,80 @@
 #include "calc_display.h"
+#include "RegionCanvas.h"
 #include "Logger.h"
+#include "config.h"
+#include "LoopScheduler.h"
+#include "DisplayTrace.h"
+#include "CpuProfiler.h"
+#include "AllocTracer.h"
+#include "PixelKernels.h"
+#include "CjkText.h"
+#include <esp_timer.h>
 
 #define TAG_CALC_DISPLAY "CalcDisp"
 
 CalcDisplay::CalcDisplay(Arduino_GFX *d, uint16_t w, uint16_t h)
-    : tft(d), screenWidth(w), screenHeight(h) {
+    : tft(d), screenWidth(w), screenHeight(h),
+      _theme(DISPLAY_THEME_DEFAULT), _themeWanted(DISPLAY_THEME_DEFAULT),
+      _dirtyLines(0), _fullRedraw(true),
+      _frameDirty(false),
+      _frameIntervalMs(0), _lastFlushMs(0), _exprShift(0),
+      _renderTask(nullptr), _renderPasses(0), _backend(BACKEND_GLYPH),
+      _panelSleepWanted(false), _panelAsleep(false) {
     
-    // 初始化历史记录
-    history[0] = "";  // 最新
-    history[1] = "";  // 较旧
+    for (uint8_t i = 0; i < 4; i++) {
+        _drawnWidth[i] = 0;
+    }
+    memset(_layout, 0, sizeof(_layout));
+    memcpy(_palette, DISPLAY_THEMES[_theme].colors, sizeof(_palette));
+    _glyphAtlas.setPalette(_palette, THEME_COLOR_COUNT);
     
     // 初始化行配置
     initializeLines();
+    for (uint8_t i = 0; i < 4; i++) {
+        lines[i].drawSize = fitTextSize(i);
+    }
+    
+    // 暂存模型与行配置保持一致
+    for (uint8_t i = 0; i < 4; i++) {
+        stageLine(i, lines[i].text);
+        _drawnY[i] = lines[i].y;
+    }
+    _shown = _staged;
+    _indicator[0] = '\0';
+    _indicatorDrawn = false;
+    
+    // 为每行可能用到的字号和颜色预渲染常用字形（调色板Canvas没有16位帧缓冲，不需要）
+    extern RegionCanvas *canvas;
+    bool glyphTarget = !(canvas && tft == canvas && canvas->isPaletted());
+    for (uint8_t i = 0; glyphTarget && i < 4; i++) {
+        for (uint8_t size = lines[i].minTextSize; size <= lines[i].textSize; size++) {
+            if (!_glyphAtlas.addSet(size, lines[i].color, THEME_BG)) {
+                LOG_W(TAG_CALC_DISPLAY, "字形缓存创建失败: size=%u", size);
+            }
+        }
+    }
+    LOG_I(TAG_CALC_DISPLAY, "字形缓存占用: %u 字节", _glyphAtlas.getMemoryUsage());
+    if (!_statusBar.begin(_palette[THEME_FG], _palette[THEME_HIST], _palette[THEME_BG])) {
+        LOG_W(TAG_CALC_DISPLAY, "状态图标创建失败");
+    }
+#if DISPLAY_CHROME
+    // 分隔线等固定元素在清除区域时从底图恢复，不再逐个重画
+    if (_chrome.begin(screenWidth, screenHeight)) {
+        _chrome.setPalette(_palette);
+    }
+#endif
+    
+    // 关闭自动换行：超长文本若折行会画到相邻行，破坏按行局部刷新
+    tft->setTextWrap(false);
+    
+    setMaxFps(DISPLAY_MAX_FPS);
     
-    // 绘制初始界面
+    // 推送完成时统计推送耗时和输入到上屏延迟
+    if (canvas && tft == canvas) {
+        canvas->setFlushDoneCallback(onFlushDone, this);
+    }
+    
+    // 绘制初始界面（首帧整屏）
     drawFrame();
     refresh();
     
@@ -26,131 +87,851 @@ CalcDisplay::~CalcDisplay() {
 
 void CalcDisplay::initializeLines() {
     // L0: 历史第2条（最旧）- 部分隐藏营造滚动效果（硬件已扩展5像素）
-    lines[0] = {history[1], 3, COLOR_HIST, -20, 24};
+    lines[0] = {"", 3, THEME_HIST, -20, 24, 3, 3};
     
-    // L1: 历史第1条（较旧）
-    lines[1] = {history[0], 3, COLOR_HIST, 6, 24};
+    // L1: 历史第1条（较旧），输入表达式时显示实时预览
+    lines[1] = {"", 3, THEME_HIST, 6, 24, 3, 3};
     
     // L2: 当前输入表达式
-    lines[2] = {"", 3, COLOR_FG, 32, 24};
+    lines[2] = {"", 3, THEME_FG, 32, 24, 3, 3};
     
-    // L3: 计算结果（超大字体）
-    lines[3] = {"0", 8, COLOR_FG, 60, 64};
+    // L3: 计算结果（超大字体），放不下时逐级缩小到4号
+    lines[3] = {"0", 8, THEME_FG, 60, 64, 4, 8};
 }
 
 void CalcDisplay::drawFrame() {
-    // 清屏为黑色
-    tft->fillScreen(COLOR_BG);
+    // 清屏为主题背景色和界面底图
+    clearArea(0, 0, screenWidth, screenHeight);
 }
 
 void CalcDisplay::drawLine(uint8_t lineIndex) {
     if (lineIndex >= 4) return;
     
-    LineConfig &line = lines[lineIndex];
+    int16_t y = getLineY(lineIndex);
+    if (lineIndex == 3 && _shown.error) {
+        drawErrorBanner(y);
+    } else {
+        drawText(lineIndex, PAD_X, y, lines[lineIndex].text);
+    }
+    
+    // 记录本次实际绘制的宽度和位置，下次局部刷新时旧文本区域也要清除并推送
+    _drawnWidth[lineIndex] = getTextWidth(lineIndex);
+    _drawnY[lineIndex] = y;
+    recordLayout(lineIndex);
+    if (lineIndex == INDICATOR_LINE) drawIndicator(y);
+}
+
+void CalcDisplay::drawText(uint8_t lineIndex, int16_t x, int16_t y, const char *text) {
+    const LineConfig &line = lines[lineIndex];
+    // 缩小字号时与默认字号底部对齐
+    int16_t textY = y + (line.textSize - line.drawSize) * GlyphAtlas::FONT_H;
+    
+    // 中文错误/状态信息：内置字体只有ASCII，用字形子集绘制
+    if (!CjkText::isAscii(text)) {
+        tft->startWrite();
+        CjkText::draw(tft, x, textY, text, line.drawSize, _palette[line.color], _palette[THEME_BG]);
+        tft->endWrite();
+        return;
+    }
+    
+    // 优先用预渲染字形直接复制到Canvas帧缓冲，每行一次memcpy
+    extern RegionCanvas *canvas;
+    if (_backend == BACKEND_GLYPH && canvas && tft == canvas &&
+        _glyphAtlas.drawText(canvas->getFramebuffer(), screenWidth, screenHeight,
+                             x, textY, text, line.drawSize, line.color, THEME_BG)) {
+        return;
+    }
     
     // ★ 真正的防闪烁：一次性批量写入
     tft->startWrite();
     
     // 设置文本属性（第二个参数=背景色，可省fillRect）
-    tft->setTextColor(line.color, COLOR_BG);
-    tft->setTextSize(line.textSize);
-    tft->setCursor(PAD_X, line.y);
-    tft->print(line.text);
+    tft->setTextColor(_palette[line.color], _palette[THEME_BG]);
+    tft->setTextSize(line.drawSize);
+    tft->setCursor(x, textY);
+    tft->print(text);
     
     tft->endWrite();
 }
 
-void CalcDisplay::pushHistory(const String &line) {
-    // 滚动历史记录：旧的向上推
-    history[1] = history[0];  // 最新 → 较旧
-    history[0] = line;        // 新的成为最新
+void CalcDisplay::drawErrorBanner(int16_t y) {
+    const LineConfig &line = lines[3];
+    int16_t textY = y + (line.textSize - line.drawSize) * GlyphAtlas::FONT_H;
+    extern RegionCanvas *canvas;
+    uint16_t *fb = (canvas && tft == canvas) ? canvas->getFramebuffer() : nullptr;
+    uint64_t key = BannerCache::key(_shown.error, line.drawSize, _palette[line.color], _palette[THEME_BG]);
+    if (_errorBanners.draw(key, fb, screenWidth, screenHeight, PAD_X, textY)) return;
     
-    // 更新行配置
-    lines[0].text = history[1];  // L0显示较旧的
-    lines[1].text = history[0];  // L1显示最新的
+    // 第一次显示：照常绘制，再把画好的像素存下来
+    drawText(3, PAD_X, y, line.text);
+    _errorBanners.capture(key, fb, screenWidth, screenHeight, PAD_X, textY,
+                          CjkText::textUnits(line.text) * line.drawSize, GlyphAtlas::FONT_H * line.drawSize);
+}
+
+uint32_t CalcDisplay::layoutKey(const char *text, uint8_t drawSize, uint8_t color) {
+    // FNV-1a，样式一并混入
+    uint32_t hash = 2166136261u;
+    for (const char *p = text; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    hash = (hash ^ drawSize) * 16777619u;
+    return (hash ^ color) * 16777619u;
+}
+
+void CalcDisplay::recordLayout(uint8_t lineIndex) {
+    const LineConfig &line = lines[lineIndex];
+    LineLayout &layout = _layout[lineIndex];
+    memcpy(layout.text, line.text, TEXT_LEN);
+    layout.length = strlen(line.text);
+    layout.drawSize = line.drawSize;
+    layout.color = line.color;
+    layout.key = layoutKey(line.text, line.drawSize, line.color);
+}
+
+uint8_t CalcDisplay::changedGlyphStart(uint8_t lineIndex) const {
+    const LineConfig &line = lines[lineIndex];
+    const LineLayout &layout = _layout[lineIndex];
+    
+    // 字形位置只在原位、同字号时不变；指示画在行右侧，变化时整行重绘
+    if (_backend != BACKEND_GLYPH || _drawnY[lineIndex] != getLineY(lineIndex)) return GLYPHS_ALL;
+    if (layout.drawSize != line.drawSize || layout.color != line.color) return GLYPHS_ALL;
+    if (lineIndex == INDICATOR_LINE && (_indicatorDrawn || _indicator[0] != '\0')) return GLYPHS_ALL;
+    // 非ASCII字符宽度不同，字节下标不对应字形格子
+    if (!CjkText::isAscii(line.text) || !CjkText::isAscii(layout.text)) return GLYPHS_ALL;
+    
+    if (layout.key == layoutKey(line.text, line.drawSize, line.color) && strcmp(layout.text, line.text) == 0) {
+        return layout.length;   // 内容未变，没有要画的字形
+    }
+    uint8_t start = 0;
+    while (line.text[start] != '\0' && line.text[start] == layout.text[start]) start++;
+    return start;
+}
+
+uint8_t CalcDisplay::changedGlyphEnd(uint8_t lineIndex, uint8_t start) const {
+    const LineConfig &line = lines[lineIndex];
+    const LineLayout &layout = _layout[lineIndex];
+    uint8_t length = strlen(line.text);
+    if (length != layout.length) return length > layout.length ? length : layout.length;
+    
+    // 长度不变时末尾相同的字形也不重画（编辑时移动光标只改变光标两侧的几格）
+    uint8_t end = length;
+    while (end > start && line.text[end - 1] == layout.text[end - 1]) end--;
+    return end;
+}
+
+void CalcDisplay::drawChangedGlyphs(uint8_t lineIndex, uint8_t start, uint8_t end) {
+    const LineConfig &line = lines[lineIndex];
+    uint8_t oldLength = _layout[lineIndex].length;
+    uint8_t length = strlen(line.text);
+    uint16_t charW = getCharWidth(line.drawSize);
+    
+    int16_t y = _drawnY[lineIndex];
+    int16_t top, bottom;
+    getLineRows(lineIndex, y, top, bottom);
+    
+    int16_t x0 = PAD_X + start * charW;
+    int16_t x1 = PAD_X + end * charW;
+    if (x1 > (int16_t)screenWidth) x1 = screenWidth;
+    if (x0 < x1 && top < bottom) {
+        // 新字形连同背景整格写入；变短时多出的旧字形另行清除
+        if (oldLength > length) {
+            int16_t clearX = PAD_X + length * charW;
+            if (clearX < x1) clearArea(clearX, top, x1 - clearX, bottom - top);
+        }
+        if (start < length) {
+            char glyphs[TEXT_LEN];
+            uint8_t count = (end < length ? end : length) - start;
+            memcpy(glyphs, line.text + start, count);
+            glyphs[count] = '\0';
+            drawText(lineIndex, x0, y, glyphs);
+        }
+        markFrameDirty(x0, top, x1 - x0, bottom - top);
+    }
+    
+    _drawnWidth[lineIndex] = getTextWidth(lineIndex);
+    recordLayout(lineIndex);
+}
+
+void CalcDisplay::shiftExprGlyphs() {
+    extern RegionCanvas *canvas;
+    const uint8_t lineIndex = DisplayModel::LINE_EXPR;
+    int16_t shift = _exprShift;
+    _exprShift = 0;
+    
+    // 只在字形可以按格比较时平移；否则这一行照常整行重绘
+    LineLayout &layout = _layout[lineIndex];
+    if (!(_dirtyLines & (1 << lineIndex)) || !canvas || tft != canvas || !canvas->getFramebuffer()) return;
+    if (changedGlyphStart(lineIndex) == GLYPHS_ALL) return;
+    uint8_t cells = shift > 0 ? shift : -shift;
+    if (cells >= layout.length) return;
+    
+    int16_t top, bottom;
+    getLineRows(lineIndex, _drawnY[lineIndex], top, bottom);
+    uint16_t charW = getCharWidth(layout.drawSize);
+    uint16_t span = (layout.length - cells) * charW;
+    if (PAD_X + cells * charW + span > screenWidth) return;
+    
+    // 窗口右移时文本左移，反之右移；每行一次memmove，露出的格子交给随后的字形比较
+    uint16_t *fb = canvas->getFramebuffer();
+    uint16_t from = PAD_X + (shift > 0 ? cells * charW : 0);
+    uint16_t to = PAD_X + (shift > 0 ? 0 : cells * charW);
+    for (int16_t row = top; row < bottom; row++) {
+        uint16_t *line = fb + (int32_t)row * screenWidth;
+        memmove(line + to, line + from, span * sizeof(uint16_t));
+    }
+    markFrameDirty(PAD_X, top, span + cells * charW, bottom - top);
     
-    // 全屏刷新
+    // 排版缓存跟着移动；露出的格子记为不可能出现的字符，必然与新文本不同
+    uint8_t kept = layout.length - cells;
+    if (shift > 0) {
+        memmove(layout.text, layout.text + cells, kept);
+        memset(layout.text + kept, '\x01', cells);
+    } else {
+        memmove(layout.text + cells, layout.text, kept);
+        memset(layout.text, '\x01', cells);
+    }
+    layout.key = layoutKey(layout.text, layout.drawSize, layout.color);
+}
+
+void CalcDisplay::drawIndicator(int16_t y) {
+    _indicatorDrawn = _indicator[0] != '\0';
+    if (!_indicatorDrawn) return;
+    
+    // 行已整行清除，直接画在文本之上；超长表达式会被指示盖住末尾
+    int16_t x = screenWidth - PAD_X - strlen(_indicator) * getCharWidth(INDICATOR_SIZE);
+    int16_t iy = y + (lines[INDICATOR_LINE].charHeight - GlyphAtlas::FONT_H * INDICATOR_SIZE) / 2;
+    tft->startWrite();
+    tft->setTextColor(_palette[THEME_HIST], _palette[THEME_BG]);
+    tft->setTextSize(INDICATOR_SIZE);
+    tft->setCursor(x, iy);
+    tft->print(_indicator);
+    tft->endWrite();
+}
+
+void CalcDisplay::drawStatusBar() {
+    if (!_statusBar.pending()) return;
+    
+    extern RegionCanvas *canvas;
+    uint16_t *fb = (canvas && tft == canvas) ? canvas->getFramebuffer() : nullptr;
+    int16_t dirtyX, dirtyW;
+    _statusBar.draw(tft, fb, screenWidth, screenWidth - PAD_X - StatusBar::WIDTH, 0, dirtyX, dirtyW);
+    markFrameDirty(dirtyX, 0, dirtyW, StatusBar::HEIGHT);
+}
+
+void CalcDisplay::setStatus(StatusBar::Item item, uint8_t state) {
+    if (!_statusBar.set(item, state)) return;
+    if (_renderTask) {
+        xTaskNotifyGive(_renderTask);
+    } else {
+        LoopScheduler::instance().wake();
+    }
+}
+
+void CalcDisplay::pushHistory(const char *line) {
+    // 滚动历史记录：旧的向上推（L0显示较旧的，L1显示最新的）
+    memcpy(_staged.text[0], _staged.text[1], TEXT_LEN);
+    stageLine(1, line);
+    
+    refresh();
+}
+
+void CalcDisplay::setExpr(const char *expr) {
+    stageLine(2, expr);
     refresh();
 }
 
-void CalcDisplay::setExpr(const String &expr) {
-    lines[2].text = expr;
-    // 全屏刷新
+void CalcDisplay::setResult(const char *res) {
+    stageLine(3, res);
     refresh();
 }
 
-void CalcDisplay::setResult(const String &res) {
-    lines[3].text = res;
-    // 全屏刷新
+void CalcDisplay::invalidateAll() {
+    _staged.redrawSeq++;
+}
+
+void CalcDisplay::publish(const DisplayModel &model) {
+    // 重绘请求计数由显示器维护，调用方的模型不带这一字段
+    uint32_t redrawSeq = _staged.redrawSeq;
+    _staged = model;
+    _staged.redrawSeq = redrawSeq;
     refresh();
 }
 
 void CalcDisplay::refresh() {
-    // 全屏刷新：先清屏，再重绘所有内容
-    tft->fillScreen(COLOR_BG);                                    // 清屏为黑色
+    PROFILE_SCOPE(PROFILE_DISPLAY_REFRESH);
+    ALLOC_TAG("display_refresh");
+    DisplayTrace::instance().record(*this);
+    
+    if (_renderTask) {
+        // 渲染任务模式：只发布模型，绘制在渲染任务中完成；发布不会失败，也不等待渲染侧
+        _models.back() = _staged;
+        _models.publish();
+        xTaskNotifyGive(_renderTask);
+        return;
+    }
+    
+    applyModel(_staged);
+    renderDirty();
+}
+
+bool CalcDisplay::startRenderTask(uint8_t core) {
+    if (_renderTask) return true;
+    
+    if (xTaskCreatePinnedToCore(renderTaskEntry, "calcRender", RENDER_TASK_STACK, this,
+                                RENDER_TASK_PRIO, &_renderTask, core) != pdPASS) {
+        _renderTask = nullptr;
+        LOG_E(TAG_CALC_DISPLAY, "渲染任务创建失败");
+        return false;
+    }
+    
+    LOG_I(TAG_CALC_DISPLAY, "渲染任务已启动，核心%u", core);
+    return true;
+}
+
+void CalcDisplay::renderTaskEntry(void *arg) {
+    static_cast<CalcDisplay *>(arg)->renderLoop();
+}
+
+void IRAM_ATTR CalcDisplay::onFlushDone(uint32_t us, void *ctx) {
+    static_cast<CalcDisplay *>(ctx)->_performanceMonitor.recordFlush(us);
+}
+
+void CalcDisplay::renderLoop() {
+    for (;;) {
+        // 有待推送的帧或动画进行中时只等到下一帧时刻，否则一直等新模型
+        TickType_t wait = portMAX_DELAY;
+        if (_animations.isActive() && waitForVSync()) {
+            // 动画按面板帧推进：每帧在TE之后推进一步，步长与面板刷新一致
+            wait = 0;
+        } else if ((_frameDirty && !_panelAsleep) || _animations.isActive()) {
+            uint32_t elapsed = millis() - _lastFlushMs;
+            uint32_t remaining = elapsed < _frameIntervalMs ? _frameIntervalMs - elapsed : 0;
+            wait = pdMS_TO_TICKS(remaining);
+            if (wait == 0) wait = 1;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+        
+        // 三缓冲中只有最新发布的模型，中间被覆盖的模型的整屏重绘请求体现在redrawSeq中
+        if (_models.acquire()) {
+            applyModel(_models.front());
+        }
+        
+        advanceAnimations();
+        applyTheme();
+        renderDirty();
+        applyPanelSleep();
+        flushFrame();
+        _renderPasses++;
+    }
+}
+
+void CalcDisplay::stageLine(uint8_t lineIndex, const char *text) {
+    _staged.setText(lineIndex, text);
+}
+
+uint8_t CalcDisplay::animationFor(const DisplayModel &prev, const DisplayModel &next) {
+    // 输入运算符时表达式从结果行上移（B），输入数字时结果行滑入（A）；对应行文本不变时不播放
+    if (prev.isBrowsing() || next.isBrowsing()) return ANIM_NONE;
+    if (next.state == DisplayModel::STATE_OPERATOR &&
+        strcmp(prev.text[DisplayModel::LINE_EXPR], next.text[DisplayModel::LINE_EXPR]) != 0) {
+        return ANIM_MOVE_TO_EXPR;
+    }
+    if (next.state == DisplayModel::STATE_INPUT &&
+        strcmp(prev.text[DisplayModel::LINE_RESULT], next.text[DisplayModel::LINE_RESULT]) != 0) {
+        return ANIM_INPUT_CHANGE;
+    }
+    return ANIM_NONE;
+}
+
+void CalcDisplay::applyModel(const DisplayModel &model) {
+    // 新的显示状态到来时先结束上一段动画，动画不会拖慢按键响应
+    if (_animations.finishAll()) {
+        syncAnimatedLines();
+    }
+    
+    // 进入/退出浏览时表达式行颜色改变，整屏重绘
+    bool fullRedraw = model.redrawSeq != _shown.redrawSeq;
+    _exprShift += (int16_t)model.exprScroll - (int16_t)_shown.exprScroll;
+    if (model.isBrowsing() != _shown.isBrowsing()) {
+        lines[2].color = model.isBrowsing() ? THEME_HIST : THEME_FG;
+        _fullRedraw = true;
+    } else if (!fullRedraw && !_fullRedraw) {
+        scrollLines(model);
+    }
+    
+    for (uint8_t i = 0; i < 4; i++) {
+        if (strcmp(lines[i].text, model.text[i]) != 0) {
+            memcpy(lines[i].text, model.text[i], TEXT_LEN);
+            lines[i].drawSize = fitTextSize(i);
+            _dirtyLines |= (1 << i);
+        }
+    }
+    if (strcmp(_indicator, model.indicator) != 0) {
+        memcpy(_indicator, model.indicator, INDICATOR_LEN);
+        _dirtyLines |= (1 << INDICATOR_LINE);
+        // 指示只由存储器产生，存储器图标随之变化
+        _statusBar.set(StatusBar::ITEM_MEMORY, _indicator[0] != '\0');
+    }
     
-    // 绘制所有行（无边框）
+    if (fullRedraw) {
+        _fullRedraw = true;
+    }
+    
+    uint8_t animation = animationFor(_shown, model);
+    _shown = model;
+    
+    uint32_t now = millis();
+    switch (animation) {
+        case ANIM_INPUT_CHANGE:
+            // A：结果行从下方滑入
+            _animations.start(3, ANIM_SLIDE_OFFSET, 0, ANIM_INPUT_MS, Easing::EASE_OUT_CUBIC, now);
+            break;
+        case ANIM_MOVE_TO_EXPR:
+            // B：表达式从结果行位置上移到表达式行
+            _animations.start(2, lines[3].y - lines[2].y, 0, ANIM_MOVE_MS, Easing::EASE_OUT_CUBIC, now);
+            break;
+        default:
+            break;
+    }
+    syncAnimatedLines();
+}
+
+void CalcDisplay::scrollLines(const DisplayModel &model) {
+    extern RegionCanvas *canvas;
+    if (_backend == BACKEND_FULL || !canvas || tft != canvas || !canvas->getFramebuffer()) return;
+    
+    // 新行出现在下方：L0←L1←L2，按从上到下的顺序复制，源行被覆盖前已读出
+    if (canMoveLine(model, 0, 1) || canMoveLine(model, 1, 2)) {
+        for (uint8_t dst = 0; dst + 1 < SCROLL_LINES; dst++) {
+            if (canMoveLine(model, dst, dst + 1)) moveLine(dst, dst + 1);
+        }
+        return;
+    }
+    // 新行出现在上方：L2←L1←L0，从下到上复制
+    for (uint8_t dst = SCROLL_LINES - 1; dst > 0; dst--) {
+        if (canMoveLine(model, dst, dst - 1)) moveLine(dst, dst - 1);
+    }
+}
+
+bool CalcDisplay::canMoveLine(const DisplayModel &model, uint8_t dst, uint8_t src) const {
+    const LineConfig &to = lines[dst];
+    const LineConfig &from = lines[src];
+    if (model.text[dst][0] == '\0' || strcmp(to.text, model.text[dst]) == 0) return false;
+    if (strcmp(from.text, model.text[dst]) != 0) return false;
+    
+    // 像素相同的前提：字号、颜色、行高一致，两行都停在原位，源行完整在屏幕内
+    if (from.color != to.color || from.charHeight != to.charHeight ||
+        from.textSize != to.textSize || from.minTextSize != to.minTextSize) return false;
+    if (_drawnY[src] != from.y || _drawnY[dst] != to.y) return false;
+    if (from.y < 0 || from.y + from.charHeight > (int16_t)screenHeight) return false;
+    
+    // 指示画在INDICATOR_LINE右侧，不随文本移动
+    if ((dst == INDICATOR_LINE || src == INDICATOR_LINE) &&
+        (_indicatorDrawn || model.indicator[0] != '\0')) return false;
+    return true;
+}
+
+void CalcDisplay::moveLine(uint8_t dst, uint8_t src) {
+    extern RegionCanvas *canvas;
+    uint16_t *fb = canvas->getFramebuffer();
+    
+    // 两行间距大于行高，区域不重叠；整行宽度复制，背景一并带过去
+    int16_t top, bottom;
+    getLineRows(dst, lines[dst].y, top, bottom);
+    if (bottom <= top) return;
+    int16_t offset = lines[src].y - lines[dst].y;
+    pixelCopy(fb + (int32_t)top * screenWidth, fb + (int32_t)(top + offset) * screenWidth,
+              (size_t)(bottom - top) * screenWidth);
+    
+    uint16_t width = _drawnWidth[dst] > _drawnWidth[src] ? _drawnWidth[dst] : _drawnWidth[src];
+    memcpy(lines[dst].text, lines[src].text, TEXT_LEN);
+    lines[dst].drawSize = lines[src].drawSize;
+    _drawnWidth[dst] = _drawnWidth[src];
+    _layout[dst] = _layout[src];
+    markFrameDirty(PAD_X, top, width, bottom - top);
+    if (top < StatusBar::HEIGHT) _statusBar.invalidate();
+}
+
+void CalcDisplay::advanceAnimations() {
+    if (_animations.isActive() && _animations.update(millis())) {
+        syncAnimatedLines();
+    }
+}
+
+void CalcDisplay::syncAnimatedLines() {
     for (uint8_t i = 0; i < 4; i++) {
-        drawLine(i);
+        if (getLineY(i) != _drawnY[i]) {
+            _dirtyLines |= (1 << i);
+        }
     }
+}
+
+int16_t CalcDisplay::getLineY(uint8_t lineIndex) const {
+    return lines[lineIndex].y + _animations.getValue(lineIndex);
+}
+
+void CalcDisplay::renderDirty() {
+    if (!_fullRedraw && _dirtyLines == 0 && !_statusBar.pending()) {
+        return;  // 没有任何变化，不绘制也不推送
+    }
+    if (_backend == BACKEND_FULL) {
+        _fullRedraw = true;
+    }
+    
+    int64_t drawStart = esp_timer_get_time();
+    
+    int16_t top = screenHeight;
+    int16_t bottom = 0;
+    int16_t right = 0;
     
-    // 如果使用Canvas，需要flush到屏幕
-    // 检查tft是否为Arduino_Canvas类型
-    extern Arduino_Canvas *canvas;
+    if (_fullRedraw) {
+        // 整屏刷新：先清屏，再重绘所有内容
+        clearArea(0, 0, screenWidth, screenHeight);
+        for (uint8_t i = 0; i < 4; i++) {
+            drawLine(i);
+        }
+        top = 0;
+        bottom = screenHeight;
+    } else {
+        // 原位修改、字号不变的行按排版缓存只重绘变化的字形（如追加一位数字只画一个字形）
+        if (_exprShift) shiftExprGlyphs();
+        uint8_t glyphStart[4], glyphEnd[4];
+        uint8_t incremental = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            if (!(_dirtyLines & (1 << i))) continue;
+            glyphStart[i] = changedGlyphStart(i);
+            if (glyphStart[i] == GLYPHS_ALL) continue;
+            glyphEnd[i] = changedGlyphEnd(i, glyphStart[i]);
+            incremental |= (1 << i);
+        }
+        
+        // 局部刷新：清除其余脏行的旧位置和新位置（动画中的行会移动），累计需要推送的行区间
+        int16_t clearedTop[8], clearedBottom[8];
+        uint8_t clearedCount = 0;
+        
+        tft->startWrite();
+        for (uint8_t i = 0; i < 4; i++) {
+            if (!(_dirtyLines & (1 << i)) || (incremental & (1 << i))) continue;
+            
+            int16_t positions[2] = {_drawnY[i], getLineY(i)};
+            for (uint8_t p = 0; p < 2; p++) {
+                if (p == 1 && positions[1] == positions[0]) break;
+                
+                int16_t lineTop, lineBottom;
+                getLineRows(i, positions[p], lineTop, lineBottom);
+                if (lineBottom <= lineTop) continue;
+                
+                clearLineArea(i, positions[p], true);
+                clearedTop[clearedCount] = lineTop;
+                clearedBottom[clearedCount] = lineBottom;
+                clearedCount++;
+                if (lineTop < top) top = lineTop;
+                if (lineBottom > bottom) bottom = lineBottom;
+            }
+        }
+        tft->endWrite();
+        
+        // 被清除区域波及的其他行也要重画；按字形增量绘制的行此时像素已不完整，改为整行
+        for (uint8_t i = 0; i < 4; i++) {
+            if (!(incremental & (1 << i))) continue;
+            
+            int16_t lineTop, lineBottom;
+            getLineRows(i, _drawnY[i], lineTop, lineBottom);
+            for (uint8_t c = 0; c < clearedCount; c++) {
+                if (lineTop < clearedBottom[c] && clearedTop[c] < lineBottom) {
+                    incremental &= ~(1 << i);
+                    clearLineArea(i, _drawnY[i]);
+                    if (lineTop < top) top = lineTop;
+                    if (lineBottom > bottom) bottom = lineBottom;
+                    break;
+                }
+            }
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            if (_dirtyLines & (1 << i)) continue;
+            
+            int16_t lineTop, lineBottom;
+            getLineRows(i, _drawnY[i], lineTop, lineBottom);
+            for (uint8_t c = 0; c < clearedCount; c++) {
+                if (lineTop < clearedBottom[c] && clearedTop[c] < lineBottom) {
+                    _dirtyLines |= (1 << i);
+                    break;
+                }
+            }
+        }
+        
+        // 横向范围取新旧文本宽度的较大者，才能覆盖变短时残留的旧像素
+        for (uint8_t i = 0; i < 4; i++) {
+            if (!(_dirtyLines & (1 << i)) || (incremental & (1 << i))) continue;
+            
+            uint16_t width = getTextWidth(i);
+            if (_drawnWidth[i] > width) width = _drawnWidth[i];
+            if ((int16_t)(PAD_X + width) > right) right = PAD_X + width;
+            
+            // 指示在行的最右侧，新旧任一存在时推送到右边缘
+            if (i == INDICATOR_LINE && (_indicatorDrawn || _indicator[0] != '\0')) {
+                right = screenWidth - PAD_X;
+            }
+        }
+        
+        for (uint8_t i = 0; i < 4; i++) {
+            if (incremental & (1 << i)) {
+                drawChangedGlyphs(i, glyphStart[i], glyphEnd[i]);
+            } else if (_dirtyLines & (1 << i)) {
+                drawLine(i);
+            }
+        }
+    }
+    
+    // 状态图标条与L0/L1的行区域重叠，这两行重绘后整条重画
+    if (_fullRedraw || (_dirtyLines & 0x03)) _statusBar.invalidate();
+    drawStatusBar();
+    
+    bool full = _fullRedraw;
+    _exprShift = 0;
+    _dirtyLines = 0;
+    _fullRedraw = false;
+    
+    _performanceMonitor.recordDraw((uint32_t)(esp_timer_get_time() - drawStart));
+    
+    // 只记录待推送区域，由tick()按帧率上限统一推送
+    if (full) {
+        markFrameDirty(0, 0, screenWidth, screenHeight);
+    } else {
+        markFrameDirty(PAD_X, top, right - PAD_X, bottom - top);
+    }
+}
+
+void CalcDisplay::setMaxFps(uint8_t fps) {
+    _frameIntervalMs = fps ? (1000 / fps) : 0;
+    LOG_I(TAG_CALC_DISPLAY, "帧率上限: %u fps", fps);
+}
+
+void CalcDisplay::markFrameDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (w <= 0 || h <= 0) return;
+    
+    // 相交或相接的矩形在列表中合并，互不相邻的行分别推送，不再连同中间的行一起推送
+    _pending.add(x, y, w, h);
+    _frameDirty = true;
+}
+
+void CalcDisplay::flushNow() {
+    if (!_frameDirty) return;
+    
+    flushPending();
+    _pending.clear();
+    _frameDirty = false;
+    _lastFlushMs = millis();
+}
+
+// 逐字段更新方法（只写入暂存模型，refresh()时生效）
+void CalcDisplay::updateHistoryDirect(const char *latest, const char *older) {
+    stageLine(0, older);   // L0显示较旧的
+    stageLine(1, latest);  // L1显示最新的
+}
+
+void CalcDisplay::updateExprDirect(const char *expr) {
+    stageLine(2, expr);
+}
+
+void CalcDisplay::updateResultDirect(const char *res) {
+    stageLine(3, res);
+}
+
+void CalcDisplay::updateIndicatorDirect(const char *indicator) {
+    _staged.setIndicator(indicator);
+}
+
+void CalcDisplay::updatePreviewDirect(const char *preview) {
+    // 预览与历史共用L1；文本不变时applyModel不会标脏，变化时只重绘这一行
+    stageLine(1, preview);
+}
+
+void CalcDisplay::getLineRows(uint8_t lineIndex, int16_t y, int16_t &top, int16_t &bottom) const {
+    const LineConfig &line = lines[lineIndex];
+    
+    // L0 的 y 为负（部分隐藏），需要裁剪到屏幕范围内
+    top = y < 0 ? 0 : y;
+    bottom = y + line.charHeight;
+    if (bottom > (int16_t)screenHeight) bottom = screenHeight;
+    if (bottom < top) bottom = top;
+}
+
+void CalcDisplay::flushPending() {
+    // 如果使用Canvas，只把变化的矩形推送到屏幕；一帧的全部矩形作为一批提交
+    extern RegionCanvas *canvas;
     if (canvas && tft == canvas) {
-        canvas->flush();
+        if (canvas->hasTileHash()) {
+            // 块哈希模式：按Canvas内容找出变化的块，标记的矩形只用来判断需要推送
+            canvas->flushChanged();
+            return;
+        }
+        DirtyRegions::Rect all = _pending.bounds();
+        if (_pending.count() == 1 && all.x == 0 && all.y == 0 &&
+            all.w == (int16_t)screenWidth && all.h == (int16_t)screenHeight) {
+            canvas->flush();
+        } else {
+            canvas->flushRegions(_pending);
+        }
     }
 }
 
-// 直接数据更新方法（不立即刷新）
-void CalcDisplay::updateHistoryDirect(const String &latest, const String &older) {
-    history[0] = latest;
-    history[1] = older;
-    lines[0].text = history[1];  // L0显示较旧的
-    lines[1].text = history[0];  // L1显示最新的
+uint16_t CalcDisplay::getTextWidth(uint8_t lineIndex) {
+    const LineConfig &line = lines[lineIndex];
+    return CjkText::textUnits(line.text) * line.drawSize;
 }
 
-void CalcDisplay::updateExprDirect(const String &expr) {
-    lines[2].text = expr;
+uint8_t CalcDisplay::fitTextSize(uint8_t lineIndex) const {
+    const LineConfig &line = lines[lineIndex];
+    uint16_t units = CjkText::textUnits(line.text);
+    if (units == 0) return line.textSize;
+    
+    uint16_t size = getLineWidthBudget() / units;
+    if (size > line.textSize) size = line.textSize;
+    if (size < line.minTextSize) size = line.minTextSize;
+    return (uint8_t)size;
 }
 
-void CalcDisplay::updateResultDirect(const String &res) {
-    lines[3].text = res;
+uint8_t CalcDisplay::getMinCharWidth(uint8_t lineIndex) const {
+    if (lineIndex >= 4) return GlyphAtlas::FONT_W;
+    return GlyphAtlas::FONT_W * lines[lineIndex].minTextSize;
 }
 
-// 简化的tick更新
 void CalcDisplay::tick() {
-    // --- 推送 Canvas 缓冲到屏幕 ---
-    extern Arduino_Canvas *canvas;
-    if (canvas && tft == canvas) {
-        canvas->flush();
+    if (_renderTask) {
+        // 绘制和推送由渲染任务负责
+        return;
+    }
+    
+    advanceAnimations();
+    applyTheme();
+    renderDirty();
+    applyPanelSleep();
+    flushFrame();
+    
+    // 动画进行中或有未推送的修改时，下一帧再来（面板睡眠时修改留到唤醒）
+    if (_animations.isActive() || (_frameDirty && !_panelAsleep)) {
+        LoopScheduler::instance().after(_frameIntervalMs ? _frameIntervalMs : 1);
     }
 }
 
-// 简化的动画方法（仅记录日志）
-void CalcDisplay::animateInputChange(const String& oldTxt, const String& newTxt) {
-    LOG_D(TAG_CALC_DISPLAY, "输入变更: %s -> %s", oldTxt.c_str(), newTxt.c_str());
-    // 直接刷新显示，不执行动画
-    refresh();
+bool CalcDisplay::waitIdle(uint32_t timeoutMs) {
+    extern RegionCanvas *canvas;
+    uint32_t start = millis();
+    uint32_t passes = _renderPasses;
+    if (_renderTask) {
+        // 模型可能在读取计数前已处理完，再唤醒一轮保证计数会前进
+        xTaskNotifyGive(_renderTask);
+    }
+    
+    for (;;) {
+        bool idle;
+        if (_renderTask) {
+            idle = _renderPasses != passes && !_models.pending() &&
+                   (!_frameDirty || _panelAsleep) && !_animations.isActive();
+        } else {
+            tick();
+            idle = (!_frameDirty || _panelAsleep) && !_animations.isActive();
+        }
+        if (idle && !(canvas && tft == canvas && canvas->isFlushBusy())) return true;
+        if (millis() - start >= timeoutMs) return false;
+        vTaskDelay(1);
+    }
 }
 
-void CalcDisplay::animateMoveInputToExpr(const String& inputTxt, const String& finalExpr) {
-    LOG_D(TAG_CALC_DISPLAY, "移至表达式: %s -> %s", inputTxt.c_str(), finalExpr.c_str());
-    // 直接刷新显示，不执行动画
-    refresh();
+// 帧调度：Canvas自上次推送后有修改，且距上次推送已满一帧间隔时才推送
+void CalcDisplay::flushFrame() {
+    if (!_frameDirty || _panelAsleep) return;
+    
+    // TE同步时推送按面板帧发送，TE节拍有抖动，留一点余量
+    extern RegionCanvas *canvas;
+    uint32_t slack = (canvas && tft == canvas && canvas->hasTearSync()) ? DISPLAY_TE_SLACK_MS : 0;
+    if (_frameIntervalMs && (millis() - _lastFlushMs) + slack < _frameIntervalMs) {
+        return;
+    }
+    
+    // 双缓冲模式下上一帧仍在发送时不等待，下次tick再推送
+    if (canvas && tft == canvas && canvas->isFlushBusy()) {
+        return;
+    }
+    
+    flushNow();
+}
+
+void CalcDisplay::setPanelSleep(bool sleep) {
+    _panelSleepWanted = sleep;
+    if (_renderTask) {
+        xTaskNotifyGive(_renderTask);
+    } else {
+        LoopScheduler::instance().wake();
+    }
+}
+
+void CalcDisplay::applyPanelSleep() {
+    bool wanted = _panelSleepWanted;
+    if (wanted == _panelAsleep) return;
+    
+    // 直接绘制到屏幕时没有保留的帧，不睡眠面板
+    extern RegionCanvas *canvas;
+    if (!canvas || tft != canvas) return;
+    
+    _panelAsleep = wanted;
+    canvas->setPanelSleep(wanted);
+    if (!wanted) {
+        // 唤醒时Canvas已整帧推送，睡眠期间累积的待推送区域一并完成
+        _pending.clear();
+        _frameDirty = false;
+        _lastFlushMs = millis();
+    }
+}
+
+bool CalcDisplay::setTheme(uint8_t index) {
+    if (index >= DISPLAY_THEME_COUNT) return false;
+    _themeWanted = index;
+    if (_renderTask) {
+        xTaskNotifyGive(_renderTask);
+    } else {
+        LoopScheduler::instance().wake();
+    }
+    return true;
+}
+
+void CalcDisplay::applyTheme() {
+    uint8_t wanted = _themeWanted;
+    if (wanted == _theme) return;
+    _theme = wanted;
+    memcpy(_palette, DISPLAY_THEMES[wanted].colors, sizeof(_palette));
+    
+    // 字形缓存只记下新颜色，各组在下次绘制时按覆盖率重新着色；状态图标很小，直接重新渲染
+    _glyphAtlas.setPalette(_palette, THEME_COLOR_COUNT);
+    _statusBar.setColors(_palette[THEME_FG], _palette[THEME_HIST], _palette[THEME_BG]);
+    _chrome.setPalette(_palette);
+    
+    extern RegionCanvas *canvas;
+    if (canvas && tft == canvas && canvas->isPaletted()) {
+        // 调色板Canvas保存的是颜色角色索引，换掉调色板后整帧推送即可，不需要重绘
+        canvas->setPalette(_palette, THEME_COLOR_COUNT);
+        markFrameDirty(0, 0, screenWidth, screenHeight);
+    } else {
+        _fullRedraw = true;
+    }
+    LOG_I(TAG_CALC_DISPLAY, "显示主题: %s", DISPLAY_THEMES[wanted].name);
+}
+
+bool CalcDisplay::waitForVSync() {
+    extern RegionCanvas *canvas;
+    if (!canvas || tft != canvas || !canvas->hasTearSync()) return false;
+    return canvas->waitTearEffect(DISPLAY_TE_TIMEOUT_MS);
 }
 
 // 动画辅助方法
-void CalcDisplay::clearLineArea(uint8_t lineIndex, bool inWriteBatch) {
+void CalcDisplay::clearLineArea(uint8_t lineIndex, int16_t y, bool inWriteBatch) {
     if (lineIndex >= 4) return;
     
-    LineConfig &line = lines[lineIndex];
-    
-    // 计算行区域
-    int16_t x = PAD_X;
-    int16_t y = line.y;
-    uint16_t w = screenWidth - PAD_X * 2;
-    uint16_t h = line.charHeight;
+    // 计算行区域：整行宽度，超出PAD_X的长文本也要一起清除
+    int16_t top, bottom;
+    getLineRows(lineIndex, y, top, bottom);
+    if (bottom <= top) return;
     
     // 根据是否在批量写入中决定是否包装startWrite/endWrite
     if (!inWriteBatch) {
@@ -158,27 +939,46 @@ void CalcDisplay::clearLineArea(uint8_t lineIndex, bool inWriteBatch) {
     }
     
     // 清除区域
-    tft->fillRect(x, y, w, h, COLOR_BG);
+    clearArea(0, top, screenWidth, bottom - top);
     
     if (!inWriteBatch) {
         tft->endWrite();
     }
 }
 
+void CalcDisplay::clearArea(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (!_chrome.isActive()) {
+        tft->fillRect(x, y, w, h, _palette[THEME_BG]);
+        return;
+    }
+    // 有16位帧缓冲时底图行直接复制进缓冲
+    extern RegionCanvas *canvas;
+    uint16_t *fb = (canvas && tft == canvas) ? canvas->getFramebuffer() : nullptr;
+    _chrome.restore(tft, fb, x, y, w, h);
+}
+
 uint16_t CalcDisplay::getCharWidth(uint8_t textSize) {
     // Arduino_GFX标准字符宽度：6像素 * textSize
     return 6 * textSize;
 }
 
-// 简化的动画管理方法
+// 动画管理方法
 void CalcDisplay::interruptCurrentAnimation() {
-    LOG_D(TAG_CALC_DISPLAY, "请求中断动画(简化版)");
+    LOG_D(TAG_CALC_DISPLAY, "请求中断动画");
+    // 任何新模型在渲染侧都会先结束当前动画
+    refresh();
 }
 
 bool CalcDisplay::hasActiveAnimation() const {
-    return false;  // 简化版本总是返回false
+    return _animations.isActive();
 }
 
 uint8_t CalcDisplay::getActiveAnimationCount() const {
-    return 0;  // 简化版本总是返回0
+    return _animations.getActiveCount();
+}
+
+uint8_t CalcDisplay::getPalette(uint16_t *colors) {
+    // 索引0为背景色：调色板缓冲清零即为清屏
+    memcpy(colors, DISPLAY_THEMES[DISPLAY_THEME_DEFAULT].colors, sizeof(DISPLAY_THEMES[0].colors));
+    return THEME_COLOR_COUNT;
 }
\ No newline at end of file
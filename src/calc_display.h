@@ -1,90 +1,215 @@
 #pragma once
 #include <Arduino_GFX_Library.h>
-
-// 前向声明
-class Animation;
-class AnimationManager;
-class PerformanceMonitor;
+#include "GlyphAtlas.h"
+#include "DisplayTheme.h"
+#include "StatusBar.h"
+#include "ChromeLayer.h"
+#include "BannerCache.h"
+#include "AnimationManager.h"
+#include "PerformanceMonitor.h"
+#include "TripleBuffer.h"
+#include "DisplayModel.h"
+#include "DirtyRegions.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 /**
  * @brief 简化版计算器显示UI
  * @details 基于建议的UI设计：
  * - 240×135分辨率，黑底白框
  * - 4行布局：L0历史第2条，L1历史第1条，L2当前表达式，L3计算结果
- * - 局部刷新避免闪烁
+ * - 局部刷新避免闪烁：脏行跟踪，只重绘发生变化的行，并只推送其文本所在矩形
+ * - 一帧内变化的矩形收集到DirtyRegions中合并，整批一次推送
+ * - 调用方发布DisplayModel，渲染侧逐字段比较前后两个模型决定重绘的行和动画
  * - 滚动历史效果（L0部分隐藏）
+ * - 颜色按角色（ThemeColor）经当前主题的调色板取值，setTheme()运行时切换
  * - P1阶段：集成AnimationManager和PerformanceMonitor
  */
 class CalcDisplay {
-    // 允许Animation类访问内部成员
-    friend class Animation;
-    friend class CharSlideAnim;
-    friend class MoveToExprAnim;
-    
 public:
+    // 绘制方式（回放基准比较用，默认BACKEND_GLYPH）
+    enum RenderBackend : uint8_t {
+        BACKEND_FULL,                             // 有变化就整屏重绘并整屏推送
+        BACKEND_DIRTY,                            // 只重绘脏行，文字用GFX逐像素绘制
+        BACKEND_GLYPH                             // 只重绘脏行，文字从字形缓存逐行复制
+    };
+
     CalcDisplay(Arduino_GFX *d, uint16_t w, uint16_t h);
     ~CalcDisplay();
 
-    void pushHistory(const String &line);      // 添加历史记录并滚动
-    void setExpr(const String &expr);          // 设置当前表达式
-    void setResult(const String &res);         // 设置计算结果
-    void refresh();                            // 刷新所有行
-    void tick();                               // 动画tick更新
+    void pushHistory(const char *line);        // 添加历史记录并滚动
+    void setExpr(const char *expr);            // 设置当前表达式
+    void setResult(const char *res);           // 设置计算结果
+    void publish(const DisplayModel &model);   // 整体替换暂存模型并提交（核心每次更新调用一次）
+    void refresh();                            // 提交暂存模型：同步模式直接重绘脏行，渲染任务模式经三缓冲发布
+    void invalidateAll();                      // 标记整屏需要重绘（下一次refresh生效）
+    void tick();                               // 帧调度：有待推送内容且到达帧间隔时推送Canvas
+    void flushNow();                           // 立即推送待推送区域（忽略帧率上限，仅同步模式使用）
+    void setMaxFps(uint8_t fps);               // 设置推送帧率上限，0表示不限制
+    void setRenderBackend(RenderBackend backend) { _backend = backend; }
+    RenderBackend getRenderBackend() const { return _backend; }
+    bool waitIdle(uint32_t timeoutMs);         // 等待已提交的内容绘制、推送完成且动画结束
+    bool startRenderTask(uint8_t core);        // 启动渲染任务，之后绘制和推送都在该任务中进行
     
-    // 直接数据更新方法（用于适配器批量更新）
-    void updateHistoryDirect(const String &latest, const String &older);
-    void updateExprDirect(const String &expr);
-    void updateResultDirect(const String &res);
+    // 逐字段修改暂存模型，refresh()时生效
+    void updateHistoryDirect(const char *latest, const char *older);
+    void updateExprDirect(const char *expr);
+    void updateResultDirect(const char *res);
+    void updatePreviewDirect(const char *preview);     // L1显示实时预览（为空时恢复空行）
+    void updateIndicatorDirect(const char *indicator);  // 表达式行右侧的小字指示（如内存寄存器"M2"）
+    void setStatus(StatusBar::Item item, uint8_t state);  // 右上角状态图标（任意任务，状态变化时才唤醒渲染）
+    void setPanelSleep(bool sleep);            // 面板睡眠/唤醒（任意任务）：睡眠期间照常绘制但不推送，唤醒时整帧推送
+    bool setTheme(uint8_t index);              // 切换显示主题（任意任务，DISPLAY_THEMES的索引），渲染侧替换调色板后重绘
+    uint8_t getTheme() const { return _themeWanted; }
     
-    // P1阶段：AnimationManager集成
-    void animateInputChange(const String& oldTxt, const String& newTxt);   // A1/A2
-    void animateMoveInputToExpr(const String& inputTxt, const String& finalExpr); // B
+    // 行宽度预算：调用方据此格式化数字（NumberFormatter::formatFit），放不下时行内自动缩小字号
+    uint16_t getLineWidthBudget() const { return screenWidth - 2 * PAD_X; }
+    uint8_t getMinCharWidth(uint8_t lineIndex) const;  // 行允许的最小字号下的字符宽度
     
     // 性能监控集成
-    PerformanceMonitor* getPerformanceMonitor() { return _performanceMonitor; }
-    AnimationManager* getAnimationManager() { return _animationManager; }
+    PerformanceMonitor* getPerformanceMonitor() { return &_performanceMonitor; }
+    AnimationManager* getAnimationManager() { return &_animations; }
     
     // 动画管理
     void interruptCurrentAnimation();
     bool hasActiveAnimation() const;
     uint8_t getActiveAnimationCount() const;
+    
+    // 默认主题的全部颜色（调色板Canvas用，按ThemeColor排列），返回颜色数量，colors至少4个元素
+    static uint8_t getPalette(uint16_t *colors);
 
 private:
+    friend class DisplayTrace;                    // 录制与回放直接读写暂存模型
+    
     // UI常量
-    static const uint16_t COLOR_BG = 0x0000;      // 黑色背景
-    static const uint16_t COLOR_FG = 0xFFFF;      // 白色前景
-    static const uint16_t COLOR_HIST = 0x4208;    // 灰色历史
     static const uint8_t PAD_X = 15;               // 左内边距
     
+    // 渲染任务
+    static const uint8_t TEXT_LEN = DisplayModel::TEXT_LEN;
+    static const uint8_t INDICATOR_LEN = DisplayModel::INDICATOR_LEN;
+    static const uint8_t INDICATOR_LINE = 2;      // 指示绘制在哪一行的右侧
+    static const uint8_t INDICATOR_SIZE = 2;      // 指示字号
+    static const uint8_t SCROLL_LINES = 3;        // L0~L2行距、行高相同，滚动时可整行平移
+    static const uint8_t GLYPHS_ALL = 0xFF;       // changedGlyphStart()：需要整行重绘
+    static const uint32_t RENDER_TASK_STACK = 6144;
+    static const UBaseType_t RENDER_TASK_PRIO = 1;
+    
+    // 动画参数
+    static const int16_t ANIM_SLIDE_OFFSET = 16;  // A：结果行滑入的起始偏移（像素）
+    static const uint16_t ANIM_INPUT_MS = 120;    // A：输入变更动画时长
+    static const uint16_t ANIM_MOVE_MS = 180;     // B：表达式上移动画时长
+    
+    enum AnimKind : uint8_t {
+        ANIM_NONE,                                // 无动画
+        ANIM_INPUT_CHANGE,                        // A：结果行滑入
+        ANIM_MOVE_TO_EXPR                         // B：表达式从结果行上移
+    };
+    
     // 行配置
     struct LineConfig {
-        String text;
-        uint8_t textSize;
-        uint16_t color;
+        char text[TEXT_LEN];                      // 与模型同长，更新时直接复制
+        uint8_t textSize;                         // 默认字号
+        uint8_t color;                            // 颜色角色（ThemeColor）
         int16_t y;
         uint8_t charHeight;
+        uint8_t minTextSize;                      // 文本过长时允许缩小到的最小字号
+        uint8_t drawSize;                         // 当前文本实际使用的字号
     };
 
     Arduino_GFX *tft;
     uint16_t screenWidth, screenHeight;
+    uint16_t _palette[THEME_COLOR_COUNT];         // 当前主题的颜色，按ThemeColor索引
+    uint8_t _theme;                               // 已应用的主题
+    volatile uint8_t _themeWanted;                // 调用方请求的主题
     LineConfig lines[4];
-    String history[2];  // history[0]最新，history[1]较旧
+    char _indicator[INDICATOR_LEN];               // 当前指示文本，随INDICATOR_LINE一起重绘
+    bool _indicatorDrawn;                         // 上次绘制INDICATOR_LINE时是否画了指示
     
     // P1阶段：动画系统升级
-    AnimationManager* _animationManager;          // 动画管理器
-    PerformanceMonitor* _performanceMonitor;      // 性能监控器
+    AnimationManager _animations;                 // 动画管理器，目标i为lines[i]的Y偏移
+    PerformanceMonitor _performanceMonitor;       // 性能监控器
+    
+    // 脏区域跟踪
+    uint8_t _dirtyLines;                          // 待重绘行位图，bit i 对应 lines[i]
+    bool _fullRedraw;                             // 是否需要整屏重绘
+    uint16_t _drawnWidth[4];                      // 各行上次绘制的文本像素宽度（从PAD_X起）
+    
+    // 行排版缓存：每行上次实际绘制的内容，等宽字体第k个字形位于 PAD_X + k×字宽
+    struct LineLayout {
+        uint32_t key;                             // 文本、字号、颜色的哈希
+        char text[TEXT_LEN];                      // 已绘制的文本
+        uint8_t length;                           // 字形个数
+        uint8_t drawSize;                         // 绘制字号
+        uint8_t color;                            // 绘制颜色角色
+    };
+    LineLayout _layout[4];
+    int16_t _drawnY[4];                           // 各行上次绘制的Y坐标（含动画偏移）
+    GlyphAtlas _glyphAtlas;                       // 各行字号/颜色的预渲染字形
+    StatusBar _statusBar;                         // 右上角状态图标条
+    ChromeLayer _chrome;                          // 固定的界面底图（DISPLAY_CHROME）
+    BannerCache _errorBanners;                    // 结果行错误信息的预渲染像素
+    
+    // 帧调度
+    bool _frameDirty;                             // Canvas自上次推送后是否被修改
+    DirtyRegions _pending;                        // 待推送区域
+    uint32_t _frameIntervalMs;                    // 最小帧间隔，0表示不限制
+    uint32_t _lastFlushMs;                        // 上次推送时间
     
-    // P0兼容性（暂时保留）
-    class Animation* _currentAnimation;           // 当前播放的动画（P0兼容）
+    // 渲染任务
+    DisplayModel _staged;                         // 调用方写入的暂存模型
+    TripleBuffer<DisplayModel> _models;           // 调用方 → 渲染任务，只保留最新发布的模型
+    DisplayModel _shown;                          // 渲染侧上次应用的模型，与新模型逐字段比较
+    int16_t _exprShift;                           // 表达式行窗口尚未平移的横向滚动（字符数，正数为文本左移）
+    TaskHandle_t _renderTask;                     // 渲染任务句柄，nullptr表示同步模式
+    volatile uint32_t _renderPasses;              // 渲染任务完成的循环次数（waitIdle据此判断模型已处理）
+    RenderBackend _backend;                       // 绘制方式
+    volatile bool _panelSleepWanted;              // 调用方请求的面板睡眠状态
+    bool _panelAsleep;                            // 面板已睡眠，待推送区域保留到唤醒
 
     void drawFrame();                             // 绘制边框
     void drawLine(uint8_t lineIndex);             // 局部刷新指定行
+    void drawText(uint8_t lineIndex, int16_t x, int16_t y, const char *text);  // 按行样式在x处绘制文本（行位于y）
+    void drawErrorBanner(int16_t y);              // 结果行错误信息，优先复制预渲染的像素
+    uint8_t changedGlyphStart(uint8_t lineIndex) const;  // 与排版缓存相比第一个变化的字形，GLYPHS_ALL表示需整行重绘
+    uint8_t changedGlyphEnd(uint8_t lineIndex, uint8_t start) const;  // 长度不变时末尾相同的字形之前，否则为新旧长度的较大者
+    void drawChangedGlyphs(uint8_t lineIndex, uint8_t start, uint8_t end);  // 只清除并重绘[start, end)中变化的字形
+    void shiftExprGlyphs();                       // 按_exprShift平移表达式行已画的字形和排版缓存
+    void recordLayout(uint8_t lineIndex);         // 把行的当前内容记入排版缓存
+    static uint32_t layoutKey(const char *text, uint8_t drawSize, uint8_t color);
+    void drawIndicator(int16_t y);                // 指示文本右对齐绘制在行内
+    void drawStatusBar();                         // 重画状态变化的图标并记录待推送区域
     void initializeLines();                       // 初始化行配置
     
+    // 模型辅助方法
+    void stageLine(uint8_t lineIndex, const char *text);      // 写入暂存模型
+    void applyModel(const DisplayModel &model);   // 与上次应用的模型比较，变化的行标脏并启动对应动画
+    static uint8_t animationFor(const DisplayModel &prev, const DisplayModel &next);  // 前后两个模型对应的动画（AnimKind）
+    void scrollLines(const DisplayModel &model);  // 文本整体错开一行时平移已绘制的行
+    bool canMoveLine(const DisplayModel &model, uint8_t dst, uint8_t src) const;  // src行的像素可直接作为dst行的新内容
+    void moveLine(uint8_t dst, uint8_t src);      // 把src行的像素复制到dst行位置
+    void renderDirty();                           // 重绘脏行并记录待推送区域
+    void advanceAnimations();                     // 推进动画，位置变化的行标脏
+    void syncAnimatedLines();                     // 当前位置与已绘制位置不同的行标脏
+    int16_t getLineY(uint8_t lineIndex) const;    // 行当前Y坐标（含动画偏移）
+    void flushFrame();                            // 按帧率上限推送待推送区域
+    void applyPanelSleep();                       // 在绘制侧执行面板睡眠/唤醒请求
+    void applyTheme();                            // 在绘制侧替换调色板
+    static void renderTaskEntry(void *arg);       // 渲染任务入口
+    static void onFlushDone(uint32_t us, void *ctx);  // Canvas推送完成回调
+    void renderLoop();                            // 渲染任务主循环
+    
+    // 脏区域辅助方法
+    void getLineRows(uint8_t lineIndex, int16_t y, int16_t &top, int16_t &bottom) const;  // 行位于y时在屏幕内的像素行区间[top, bottom)
+    void flushPending();                          // 把待推送区域整批推送到屏幕
+    uint16_t getTextWidth(uint8_t lineIndex);     // 行文本按当前字号的像素宽度
+    uint8_t fitTextSize(uint8_t lineIndex) const; // 放得下当前文本的最大字号（等宽字体，直接计算）
+    void markFrameDirty(int16_t x, int16_t y, int16_t w, int16_t h);  // 加入待推送区域
+    void clearArea(int16_t x, int16_t y, int16_t w, int16_t h);       // 恢复为界面底图，没有底图时填充背景色
+    
     // 动画辅助方法
-    void clearLineArea(uint8_t lineIndex, bool inWriteBatch = false);  // 清除指定行区域
+    void clearLineArea(uint8_t lineIndex, int16_t y, bool inWriteBatch = false);  // 清除行位于y时的区域
     uint16_t getCharWidth(uint8_t textSize);      // 获取字符宽度
     
     // P1阶段：减少闪烁的优化方法
-    void waitForVSync();                          // 简单的垂直同步等待
+    bool waitForVSync();                          // 等待面板下一个TE（未启用TE同步时立即返回false）
 };
\ No newline at end of file
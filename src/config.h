@@ -11,12 +11,90 @@
 #define DEBUG_MODE                      // 启用调试模式
 #define USB_HID_ENABLED                 // 启用USB HID功能
 
+// 编译期日志级别：更详细的LOG_*宏不生成代码（0无 1错误 2警告 3信息 4调试 5详细）
+#ifndef LOG_COMPILE_LEVEL
+#ifdef DEBUG_MODE
+#define LOG_COMPILE_LEVEL 5
+#else
+#define LOG_COMPILE_LEVEL 3
+#endif
+#endif
+
+// CPU占用探针：1=在各子系统入口计时，串口命令 profile 查看；0=探针不生成代码
+#ifndef CPU_PROFILER_ENABLED
+#define CPU_PROFILER_ENABLED 1
+#endif
+
+// 硬件性能计数器：1=探针可同时读取LX7的性能计数器（profile hw 选择事件组），查看停顿和中断；0=不生成代码
+#define CPU_PROFILER_HW_COUNTERS 1
+
+// 探针区间记录：profile trace on 后每次探针记一条开始/结束和核心号（16字节），profile trace dump 输出Chrome trace JSON
+#define CPU_TRACE_SPANS 4096            // 环形记录的条数（放PSRAM，第一次打开时分配），满后覆盖最旧的
+
+// 端到端延迟测试：1=扫描、HID提交、屏幕推送开始/结束时翻转探测引脚，串口命令 latency_test；0=不生成代码
+#define LATENCY_PROBE_ENABLED 0
+#define LATENCY_PROBE_PIN 21            // 探测引脚（未用的GPIO），-1表示只在设备上计时
+#define LATENCY_TEST_INTERVAL_MS 100    // 注入间隔，留出动画结束的时间
+#define LATENCY_TEST_TIMEOUT_MS 250     // 注入后等待推送结束的时间上限
+
+// 功耗基准：1=串口命令 power_bench 回放标准输入后逐级走完休眠阶段，阶段边界翻转标记引脚供外部功率计对齐；0=不编译
+#define POWER_BENCH_ENABLED 1
+#define POWER_BENCH_MARKER_PIN 14       // 标记引脚（未用的GPIO），-1表示只在设备上统计
+#define POWER_BENCH_STAGE_MS 30000      // 每个休眠阶段停留的时间
+#define POWER_BENCH_TYPING_ROUNDS 4     // 内置输入序列重复的次数
+
+// 浸泡测试：1=串口命令 soak 持续注入随机按键（含出错、层切换、历史翻阅），每分钟采样堆、最大块、
+// 栈余量和输入延迟p99，按窗口检查持续恶化并写入日志，可脱离主机运行数天；0=不编译
+#define SOAK_TEST_ENABLED 1
+#define SOAK_SAMPLE_MS 60000            // 采样间隔
+#define SOAK_WINDOW_SAMPLES 60          // 每个趋势窗口的采样次数（1小时）
+#define SOAK_WINDOWS 48                 // 保留的窗口数
+#define SOAK_DRIFT_WINDOWS 4            // 连续这么多个窗口都比前一个差时报告漂移
+#define SOAK_KEY_GAP_MS 150             // 两次注入按键的间隔
+
+// 主循环阻塞检测：1=一轮超过阈值时在节拍中断中抓取调用栈，串口命令 stalls 查看；0=不检测
+#define STALL_MONITOR_ENABLED 1
+#define STALL_THRESHOLD_MS 100          // 一轮主循环超过这么久算阻塞
+#define STALL_BACKTRACE_DEPTH 8         // 回溯层数
+#define STALL_SITE_COUNT 16             // 按调用链区分的调用点数
+
+// 任务栈和堆的趋势（ResourceMonitor）：串口命令 tasks、heap_trend
+#define RESOURCE_SAMPLE_MS 60000        // 采样间隔
+#define RESOURCE_HISTORY 60             // 堆采样保留的次数（约1小时）
+#define STACK_MARGIN_BYTES 768          // 建议栈大小 = 已用峰值 + 余量
+
+// 按键事件临时内存（ScratchArena）：格式化、预览等拼接文本从这里分配，事件处理完整体回收
+#define KEY_SCRATCH_BYTES 512
+
+
+// =================== WiFi和历史同步配置 ===================
+// 历史同步：1=后台任务把新的计算记录从历史日志批量上传到服务器（需要HISTORY_LOG_ENABLED）；0=不编译WiFi
+// WiFi名称、密码、服务器地址和证书保存在NVS（串口命令 wifi_set / sync_server / sync_ca），不写在源码中
+#define HISTORY_SYNC_ENABLED 1
+#define HISTORY_SYNC_INTERVAL_MIN 15      // 定期同步的间隔（分钟）；进入休眠时也同步一次
+#define HISTORY_SYNC_BATCH_BYTES 16384    // 每次上传的未压缩正文上限（NDJSON）
+#define HISTORY_SYNC_CONNECT_MS 15000     // 等待WiFi连接的时间上限
+#define HISTORY_SYNC_TASK_PRIO 1          // 最低的非空闲优先级
+#define HISTORY_SYNC_TASK_CORE 0          // 与按键扫描、渲染（核心1）分开
+
+// 多台合计：同组设备经ESP-NOW（不连接WiFi）互相广播完成的计算结果，每台都保持全组的累计总和
+// 组号用串口命令 peer pair 设置并保存在NVS，0为不配对、不打开无线；无线只在输入和收发前后打开
+#ifndef PEER_SYNC_ENABLED
+#define PEER_SYNC_ENABLED 1
+#endif
+#define PEER_SYNC_CHANNEL 1               // 全组使用同一信道
+#define PEER_SYNC_IDLE_MS 3000            // 最后一次按键、发送或接收之后多久关闭无线
+#define PEER_SYNC_MAX_PEERS 8             // 最多记录的同组设备数
+#define PEER_SYNC_RX_QUEUE 16             // 接收队列（2的幂），接收回调与主循环之间传递
 
-// =================== WiFi和OTA配置 ===================
-#ifdef OTA_ENABLED
-#define WIFI_SSID     "2001C_2.4G"     // WiFi网络名称
-#define WIFI_PASSWORD "741852963Su"    // WiFi密码
+// 机群配置：持有站点密钥的设备经ESP-NOW推送签名的配置增量（FleetConfig.h），无线借用多台合计
+// 站点密钥用串口命令 fleet key 设置并保存在NVS；没有密钥时不接收也不推送
+#ifndef FLEET_CONFIG_ENABLED
+#define FLEET_CONFIG_ENABLED PEER_SYNC_ENABLED
 #endif
+#define FLEET_CONFIG_PUSH_MS 30000        // 推送之后持续重发的时间
+#define FLEET_CONFIG_RESEND_MS 1000       // 重发间隔，也是转发给落后设备的最短间隔
+#define FLEET_CONFIG_MAX_ACKS 64          // 推送方按MAC记录的应答设备数
 
 // =================== LCD 引脚定义 ===================
 #define LCD_RST   48
@@ -25,10 +103,47 @@
 #define LCD_SCK   39
 #define LCD_BL    42
 #define LCD_MOSI  41
+#define LCD_TE    -1    // 面板TE（撕裂效应）输出接的GPIO，-1表示未接线
+
+// 显示总线：0=4线SPI（DC区分命令/数据）+DMA，1=QSPI（4条数据线，命令走QSPI协议，不用DC）+DMA
+// QSPI需要面板IM引脚选择QSPI接口，并按实际硬件接线修改下面的数据线引脚
+#ifndef LCD_QSPI
+#define LCD_QSPI 0
+#endif
+#define LCD_QSPI_D0 LCD_MOSI      // SDA/D0与SPI共用
+#define LCD_QSPI_D1 LCD_DC        // QSPI不用DC，原DC线作D1
+#define LCD_QSPI_D2 40
+#define LCD_QSPI_D3 47
+#define LCD_SPI_HZ  80000000      // 单线SPI时钟
+#define LCD_QSPI_HZ 80000000      // QSPI时钟（4线，同频下吞吐为SPI的4倍）；面板不稳定时降到40 MHz
 
 // =================== 显示屏参数 ===================
 #define DISPLAY_WIDTH 480
 #define DISPLAY_HEIGHT 135
+#define DISPLAY_ROTATION 2         // 面板安装方向（0~3），由面板驱动写入MADCTL，面板按此方向扫描GRAM；
+                                   // Canvas自身保持0，绘制和推送都是线性的（bench rotate）。行偏移140对应方向2
+#define DISPLAY_MAX_FPS 60         // Canvas推送帧率上限，0表示不限制
+#define DISPLAY_DOUBLE_BUFFER 1    // 1=双缓冲异步DMA推送，0=同步推送
+#define DISPLAY_FRAMEBUFFER_PLACE PLACE_PSRAM  // Canvas帧缓冲位置（BufferPlacement.h），推送时总线自带内部DMA缓冲
+#define DISPLAY_PALETTE_CANVAS 0   // 1=2位调色板Canvas（约16 KB，无字形缓存和双缓冲），0=RGB565帧缓冲
+#define DISPLAY_PALETTE_FLUSH_ROWS 8  // 调色板模式推送时每批展开的行数
+#define DISPLAY_TILE_HASH 0        // 1=推送前按块哈希比较Canvas内容，只推送变化的块，0=按绘制时标记的矩形推送
+#define DISPLAY_TILE_W 32          // 块哈希的块宽（4的倍数，调色板模式下按字节对齐）
+#define DISPLAY_TILE_H 15          // 块哈希的块高（480x135分为15x9块）
+#define DISPLAY_CHROME 0           // 1=清除区域时恢复tools/chrome_bake.py烘焙的界面底图（分隔线等），0=只填充背景色
+#define DISPLAY_AA_FONT 1          // 1=字形缓存使用tools/font_bake.py烘焙的抗锯齿字体，0=放大的内置6x8字体
+#define DISPLAY_THEME_DEFAULT 0    // 启动时的显示主题（DisplayTheme.h中DISPLAY_THEMES的索引，0=dark）
+#define DISPLAY_SPLASH 1           // 1=启动时推送tools/splash_pack.py生成的启动画面，保留到计算器首帧
+#define DISPLAY_SPLASH_ROWS 8      // 启动画面每批解码推送的行数（行缓冲 480×8×2 = 7.5 KB）
+#define DISPLAY_SPLASH_CORE 0      // 启动画面解码推送任务所在核心（setup()在核心1上继续初始化）
+#define DISPLAY_TE_TIMEOUT_MS 25   // 等待TE的超时（60 Hz面板一帧约16.7 ms）
+#define DISPLAY_TE_MAX_MISSES 3    // 推送时连续等不到TE的次数达到后关闭TE同步
+#define DISPLAY_TE_SLACK_MS 2      // TE同步时帧间隔判断的余量，TE节拍抖动不会让帧率上限错过一帧
+#define DISPLAY_PANEL_SLEEP 1      // 1=休眠时面板进入睡眠（SLPIN）并停止推送，唤醒时推送保留的Canvas
+#define DISPLAY_SLPOUT_DELAY_MS 5  // SLPOUT后到发送下一条命令的等待
+#define DISPLAY_SLPIN_GUARD_MS 120 // SLPOUT后至少间隔这么久才能再SLPIN
+#define DISPLAY_RENDER_TASK 1      // 1=绘制在独立渲染任务中进行，0=在调用方同步绘制
+#define DISPLAY_RENDER_CORE 0      // 渲染任务所在核心（Arduino loop运行在核心1）
 
 // =================== 按键和LED引脚定义 ===================
 #define SCAN_PL_PIN   15
@@ -37,10 +152,161 @@
 #define SCAN_MISO_PIN 18
 #define BUZZ_PIN      4
 
+// 按键扫描后端：1=硬件SPI一次读取3字节，0=GPIO逐位模拟
+#define KEYPAD_SCAN_USE_SPI 1
+#define KEYPAD_SCAN_SPI_HOST FSPI         // SPI2（显示屏占用SPI3）
+#define KEYPAD_SCAN_SPI_FREQ 4000000      // 4 MHz，24位约6µs
+
+// 按键扫描调度：1=独立高优先级任务定时扫描，事件经队列交给主循环；0=主循环轮询
+#define KEYPAD_SCAN_TASK 1
+#define KEYPAD_SCAN_RATE_HZ 1000          // 扫描频率
+#define KEYPAD_SCAN_TASK_PRIO 5           // 高于Arduino loop(1)和渲染任务
+#define KEYPAD_SCAN_TASK_CORE 1
+
+// 按键去抖：每个按键独立的垂直计数器，连续4次扫描一致才改变状态
+#define KEYPAD_EAGER_PRESS 1              // 1=按下沿立即上报，只对释放去抖
+
+// 按键扫描分档：有键按住或刚有按键时按KEYPAD_SCAN_RATE_HZ扫描；安静后停止高频扫描，
+// 等待MISO下降沿中断唤醒并低频兜底扫描；再久进入空闲，兜底扫描进一步放慢
+#define KEYPAD_FAST_HOLD_MS 1000          // 最后一次按键活动后保持高频扫描的时间
+#define KEYPAD_RELAXED_POLL_MS 20         // 降频档的兜底扫描间隔（50 Hz）
+#define KEYPAD_IDLE_TIMEOUT_MS 2000       // 进入空闲档的时间，0表示禁用降频和空闲模式
+#define KEYPAD_IDLE_POLL_MS 40            // 空闲档的兜底扫描间隔（25 Hz，浅睡眠定时唤醒同此）
+
+// 自动重复：布局表中标记重复的键（退格、数字）按住超过重复延迟后连续输入，
+// 延迟和初始间隔来自ConfigManager，按住越久间隔越短
+#define KEYPAD_REPEAT_ACCEL_MS 1000       // 每重复这么久间隔减半（必须大于0）
+#define KEYPAD_REPEAT_MIN_MS 25           // 最短重复间隔
+
+// 按键健康统计（KeyStats.h）：抖动、连击、按住时长，定期写入NVS
+#define KEY_STATS_CHATTER_MS 60           // 释放后此时间内同一键再次按下记为连击
+#define KEY_STATS_WARN_BOUNCE_PCT 300     // keystats中抖动/次达到此值（3.00）的按键标出
+#define KEY_STATS_SAVE_INTERVAL_MS 600000 // 统计交给配置管理器写入的间隔（10分钟，内容不变时不写）
+
+// 按键日志（KeyJournal.h）：内存中的环形记录，串口命令 replay 回放
+#define KEY_JOURNAL_ENTRIES 4096          // 记录条数（每条8字节，优先PSRAM）
+
+// 轻触/按住双功能键（TapHold.h）：布局表中holdMs非0的键按下时先不动作，
+// 按住达到holdMs执行按住功能，之前释放或按下其他键执行轻触功能；其他键不受影响
+#define TAP_HOLD_DEFAULT_MS 300           // 布局表中双功能键的默认判定时间
+
+// 休眠阶梯（SleepManager.h）：无操作达到配置的休眠时间后背光调暗，之后各级的延迟从进入上一级开始计算
+#define POWER_DIM_PERCENT 10              // 调暗时的背光亮度
+#define POWER_LEDS_OFF_DELAY_MS 10000     // 调暗后多久关闭按键灯
+#define POWER_PANEL_OFF_DELAY_MS 20000    // 关灯后多久面板睡眠（关闭背光、降频、写入未保存的历史和配置）
+
+// 浅睡眠：面板睡眠一段时间后进入esp_light_sleep_start()
+// 由MISO低电平（按键）、串口输入或兜底扫描定时器唤醒；USB已连接时不进入
+#define LIGHT_SLEEP_ENABLED 1
+#define LIGHT_SLEEP_DELAY_MS 30000        // 面板睡眠后多久开始浅睡眠
+
+// 深度睡眠：浅睡眠一段时间后进入，只有最后一级的按键（拉低MISO）能唤醒，唤醒即重新启动
+// 计算器状态保存在RTC内存中，唤醒后直接恢复；USB或BLE已连接时不进入。需要LIGHT_SLEEP_ENABLED
+#define DEEP_SLEEP_ENABLED 1
+#define DEEP_SLEEP_DELAY_MS 1800000       // 浅睡眠后多久进入深度睡眠（30分钟）
+#define RESUME_HISTORY_RECORDS 4          // 随状态保存的最近历史记录条数
+
+// ULP按键扫描（UlpKeyScan.h）：浅睡眠和深度睡眠期间由ULP协处理器读取整条165链，
+// 连续两次采样一致的变化才唤醒主CPU，任何按键都能唤醒，浅睡眠不再需要频繁定时唤醒兜底扫描
+#define ULP_KEY_SCAN_ENABLED 1
+#define ULP_KEY_SCAN_PERIOD_MS 20         // 睡眠中的扫描间隔
+#define ULP_KEY_SCAN_POLL_MS 1000         // 浅睡眠仍保留的定时唤醒，只推进深度睡眠计时和周期性工作
+
+// 动态调频：按键扫描、屏幕推送和按键活动期间持有最高频率锁，其余时间降到最低频率
+// 最低频率不低于80MHz，APB时钟保持不变
+#define PM_DFS_ENABLED 1
+#define PM_MAX_FREQ_MHZ 240
+#define PM_MIN_FREQ_MHZ 80
+#define PM_AUTO_LIGHT_SLEEP 0             // 自动浅睡眠会停掉USB和串口接收，默认关闭
+
+// 主循环：没有截止时间也没有唤醒时的最长等待（兜底）
+#define LOOP_MAX_WAIT_MS 1000
+#define TIMER_WHEEL_CAPACITY 16           // 时间轮定时器池容量（各模块create()的总数）
+#define CO_RUNNER_CAPACITY 4              // 同时运行的诊断协程数（CoRunner.h，共用一个定时器）
+
+// 组合键：第一个键按下后在此窗口内按下的键归入同一组合；从修饰键（Tab）开始时，
+// 成员键的事件推迟到窗口结束或全部松开（ChordFilter.h）
+#define KEYPAD_CHORD_WINDOW_MS 60
+
 #define RGB_PIN 46
 #define NUM_LEDS 22        // 总共22个LED
 #define LED_BRIGHTNESS 255 // LED默认亮度 (0-255)
 #define LED_FADE_DURATION 500  // LED渐变持续时间(ms)
+#define LED_ASYNC_SHOW 1       // 1=在独立任务中推送LED，按键处理不等待
+#define LED_FRAME_MS 10        // LED最小推送间隔(ms)，一帧内的多次更新合并为一次
+#define LED_GAMMA 2.2          // 推送时颜色值到亮度的gamma（16位查表，再做时间抖动）
+#define LED_SHOW_TASK_CORE 0
+
+// 按键灯空间效果（涟漪/热度/噪声，默认关闭，串口命令 fx 开关）
+#define SPATIAL_EFFECT_BUDGET_US 100   // 每个效果每帧的CPU预算(us)
+#define SPATIAL_BUDGET_STRIKES 8       // 连续超预算的帧数达到此值时关闭该效果
+#define SPATIAL_IDLE_MS 10000          // 无按键多久后显示噪声场(ms)
+
+// USB供电预算：LED亮度按剩余功率逐帧限制，避免与背光同时满载时掉电
+#define POWER_BUDGET_MW 2500           // USB 5V 500mA
+#define POWER_BASE_LOAD_MW 700         // 主控、屏幕等基础功耗
+#define POWER_BACKLIGHT_FULL_MW 450    // 背光100%时的功耗
+
+// =================== 计算后端配置 ===================
+#define CALC_BACKEND_DOUBLE  0         // double运算
+#define CALC_BACKEND_FIXED   1         // int64定点运算
+#define CALC_BACKEND_DECIMAL 2         // 34位十进制运算（0.1+0.2==0.3）
+#define CALC_BACKEND CALC_BACKEND_DECIMAL
+#define CALC_FIXED_DECIMALS 6          // 定点后端保留的小数位数
+
+// =================== 历史日志配置 ===================
+#ifndef HISTORY_LOG_ENABLED
+#define HISTORY_LOG_ENABLED 1          // 计算历史写入LittleFS，重启后保留
+#endif
+#define HISTORY_LOG_IDLE_MS 3000       // 最后一次计算后空闲多久写入闪存
+#define HISTORY_LOG_MAX_RECORDS 2048   // 单段日志记录数（约300KB，最多保留两段）
+#define HISTORY_BROWSE_PAGE 10         // 浏览历史时长按上下键一次移动的条数
+
+// =================== 闪存日志配置 ===================
+#define LOG_FILE_ENABLED 1             // 日志同时写入LittleFS中的环形文件，串口命令 log_dump 取回
+#define LOG_FILE_PAGES 16              // 环形文件页数（每页4KB）
+#define LOG_RATE_PER_SEC 20            // 每个标签每秒最多输出的日志条数（错误级别不限），0=不限速
+#define LOG_RATE_BURST 64              // 每个标签可以连续输出的条数（令牌桶容量，启动时的日志不被限速）
+#define LOG_SUPPRESS_REPORT_MS 5000    // 限速丢弃条数的汇总间隔
+
+// =================== 串口输出配置 ===================
+// 串口命令的大段输出先写入驱动的发送环形缓冲，由UART中断逐块填入FIFO，主循环不等115200波特率发完
+#define SERIAL_TX_BUFFER 16384         // 发送缓冲字节数（内部RAM，约1.4秒的输出），0=不用缓冲，FIFO写满后等待
+
+// =================== 崩溃记录配置 ===================
+// 崩溃时把寄存器、各任务回溯、最近日志和按键写入coredump分区，下次启动后由主机通道取回（CrashDump）
+#define CRASH_RECORD_BYTES 8192        // 记录区大小（4KB的整数倍，启动后预先擦除）
+#define CRASH_MAX_TASKS 16             // 回溯的任务数上限
+#define CRASH_BACKTRACE_DEPTH 16       // 每个任务的回溯层数
+#define CRASH_LOG_BYTES 2048           // 最近日志的二进制帧（Logger中的环形缓冲）
+#define CRASH_KEY_ENTRIES 64           // 按键日志的最后若干条
+#define CRASH_ERASE_DELAY_MS 5000      // 启动后多久开始擦除记录区（每次一个扇区）
+
+// =================== 内存寄存器配置 ===================
+#define MEMORY_SLOT_COUNT 4            // M+/M-/MR/MC寄存器个数（最多8个），长按MR切换
+#define MEMORY_SAVE_IDLE_MS 3000       // 最后一次修改后空闲多久写入设置分区
+
+// =================== 统计模式配置 ===================
+#define STATS_MEDIAN_CAPACITY 4096     // 求中位数最多保留的数值个数（每个8字节，优先PSRAM），0为不求中位数
+
+// =================== 商务功能配置 ===================
+#define BUSINESS_DECIMALS 2            // 含税、去税、加价、折扣结果保留的小数位数（银行家舍入）
+#define BUSINESS_DEFAULT_TAX_RATE 130000   // 默认税率，单位为百万分之一（13%）
+
+// =================== 换算配置 ===================
+#define CURRENCY_MAX 24                // 汇率表最多的货币种数
+
+// =================== 撤销配置 ===================
+#define UNDO_DEPTH 32                  // 最多可撤销的按键步数
+#define UNDO_BUFFER_SIZE 8192          // 撤销历史中记号和文本数据的缓冲字节数（优先PSRAM），放不下时丢弃最早的步骤
+
+// =================== 配置保存 ===================
+#define CONFIG_SAVE_IDLE_MS 3000       // 配置最后一次修改后空闲多久自动保存（内容未变时不写）
+#define CONFIG_JSON_MAX 4096           // JSON导出文本的最大字节数（首次导出时分配，优先PSRAM）
+
+// =================== 设置镜像 ===================
+#define SETTINGS_PARTITION_LABEL "settings"    // partitions.csv中的分区，全部设置合为一个镜像（SettingsStore）
+#define SETTINGS_SLOT_BYTES 4096       // 每个镜像占一个扇区，分区内轮流写入
 extern CRGB leds[NUM_LEDS];
 
 // =================== USB HID引脚定义 ===================
@@ -51,15 +317,84 @@ extern CRGB leds[NUM_LEDS];
 // 当启用USB HID功能时会自动配置为USB信号
 #endif
 
+// HID报告发送：1=独立任务发送，每个报告等主机取走后再发下一个，主循环不等待；0=在flush()中同步发送
+#define HID_TX_TASK 1
+#define HID_TX_TASK_PRIO 4                // 低于按键扫描任务，高于Arduino loop(1)
+#define HID_TX_TASK_CORE 1
+
+// 远程唤醒：主机休眠（USB挂起）时设备也可以浅睡眠，唤醒设备的那次按键同时唤醒主机，主机恢复后再发出
+// 配置描述符带remote wakeup属性（Arduino-ESP32默认），主机是否允许由主机设置
+#define HID_REMOTE_WAKEUP 1
+#define HID_RESUME_WAIT_MS 1000           // 发出远程唤醒后等主机恢复的时长，超时重发
+
+// 小键盘直通模式：Tab + ± 切换；按下/释放在扫描任务中直接写入HID报告并通知发送任务，
+// 不经过主循环、计算器、显示和日志。需要扫描任务（KEYPAD_SCAN_TASK）和发送任务（HID_TX_TASK）
+#define HID_PASSTHROUGH_ENABLED 1
+
+// USB挂起省电：主机挂起总线时立即进入PANEL_OFF（背光、按键灯、面板关闭），挂起电流受限；主机恢复时完全唤醒
+#define USB_SUSPEND_POWER_SAVE 1
+
+// 主机LED状态（HID输出报告）：NumLock跟随主机切换计算器层（开=主层，关=第二层），锁定状态显示在按键灯上
+#define HOST_LED_LAYER_SYNC 1
+#define HOST_LED_NUM_KEY 6                // 显示NumLock的按键（Tab键）
+#define HOST_LED_CAPS_KEY 19              // 显示CapsLock的按键
+
+// 主机通道：与HID组成复合设备的USB CDC接口，二进制请求/应答（tools/host_link.py）
+#define HOST_LINK_ENABLED 1
+
+// BLE HID：1=可切换为蓝牙键盘（串口命令 hid_mode ble），报告与USB相同；0=不编译蓝牙协议栈
+// 连接间隔单位1.25ms，监督超时单位10ms；超时必须大于 (1+从机延迟)×空闲间隔×2
+#define BLE_HID_ENABLED 1
+#define BLE_HID_NAME "PawCounter"
+#define BLE_HID_FAST_INTERVAL 6           // 输入期间的连接间隔（7.5ms，BLE允许的最小值）
+#define BLE_HID_IDLE_INTERVAL 48          // 空闲时的连接间隔（60ms）
+#define BLE_HID_IDLE_LATENCY 4            // 空闲时的从机延迟：没有数据时可跳过的连接事件数
+#define BLE_HID_TIMEOUT 400               // 监督超时（4s）
+#define BLE_HID_IDLE_MS 2000              // 最后一个报告之后多久放宽连接参数
+
 
 // =================== 硬件控制参数 ===================
 // 背光控制通道参数设置
-#define LEDC_TIMER_BIT 8    // 8 位分辨率（0-255）
-#define LEDC_BASE_FREQ 1000 // 1kHz 频率
+#define LEDC_TIMER_BIT 13   // 13 位分辨率（0-8191），低亮度段仍有足够的级数
+#define LEDC_BASE_FREQ 5000 // 5kHz 频率（80MHz APB下13位的上限约为9.7kHz）
 #define LEDC_CHANNEL_0 1       // 修改 LEDC 通道为 1，避免与 RMT 冲突
+#define BACKLIGHT_GAMMA 2.2f            // 亮度百分比到占空比的gamma
+#define BACKLIGHT_FADE_SEGMENT_MS 100   // 硬件渐变每段时长，段内由LEDC线性推进
+
+// 自动背光（串口命令 backlight auto 启用）
+#define AMBIENT_LIGHT_PIN -1              // 环境光传感器的ADC引脚，-1表示没有传感器，按时间表估算
+#define AUTO_BACKLIGHT_SAMPLE_MS 500      // 传感器采样间隔
+#define AUTO_BACKLIGHT_SCHEDULE_MS 60000  // 时间表的更新间隔
+#define AUTO_BACKLIGHT_IIR_SHIFT 3        // 低通滤波系数1/8
+#define AUTO_BACKLIGHT_HYSTERESIS 5       // 亮度百分比变化达到该值才调整
+#define AUTO_BACKLIGHT_FADE_MS 1500       // 自动调整时的渐变时间
+
+// 电池监测（BatteryMonitor.h）：ADC连续模式由DMA采一批再取平均，CPU只在每批结束时醒来
+#define BATTERY_ADC_PIN -1                // 分压后的电池电压接入的ADC1引脚（GPIO1-10），-1表示没有测量电路
+#define BATTERY_DIVIDER_NUM 2             // 分压比：电池电压 = 引脚电压 × NUM / DEN
+#define BATTERY_DIVIDER_DEN 1
+#define BATTERY_SAMPLE_MS 5000            // 采样间隔
+#define BATTERY_SAMPLES 256               // 每批转换次数
+#define BATTERY_ADC_FREQ_HZ 20000         // 连续模式转换频率（一批约13ms）
+#define BATTERY_IIR_SHIFT 2               // 低通滤波系数1/4
+#define BATTERY_HYSTERESIS 2              // 电量百分比变化达到该值才通知
+#define BATTERY_LOW_PERCENT 15            // 低于此电量时缩短休眠超时和浅睡眠延迟
+#define BATTERY_LOW_SLEEP_SCALE 25        // 低电量时的休眠超时比例（百分比）
+#define BATTERY_TASK_PRIO 1
+#define BATTERY_TASK_CORE 0
 
 // 蜂鸣器配置
 #define BUZZER_CHANNEL 2        // 使用LEDC通道2
+#define BUZZER_ATTACK_MS 3      // 起音渐变时长（不超过音符时长的1/4）
+#define BUZZER_RELEASE_MS 5     // 收音渐变时长（不超过音符时长的1/4）
+
+// 按键音后端：1=I2S0以PDM输出闪存中的PCM采样（AudioOutput，DMA推送，两个声音叠加）；0=LEDC方波（BuzzerSequencer）
+#define AUDIO_PDM_ENABLED 1
+#define AUDIO_SAMPLE_RATE 16000         // 采样率，改后重新运行 tools/audio_bake.py
+#define AUDIO_BLOCK_SAMPLES 64          // 每块采样数（4ms），也是DMA缓冲大小
+#define AUDIO_DMA_BUFFERS 3             // DMA缓冲数：最多这么多块在排队，决定新声音的延迟上限（12ms）
+#define AUDIO_TASK_PRIO 4               // 低于按键扫描，高于主循环
+#define AUDIO_TASK_CORE 0
 
 // =================== 按键布局矩阵 ===================
 const int KEY_MATRIX[5][5] = {
@@ -70,4 +405,10 @@ const int KEY_MATRIX[5][5] = {
     {4, -1, 13, 17, 21}   // KEY5,KEY14,KEY18,KEY22
 };
 
+// 按键下标(0起) -> LED序号；当前灯带按按键编号顺序布线
+const uint8_t KEY_LED_MAP[NUM_LEDS] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+    11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21
+};
+
 #endif // CONFIG_H
\ No newline at end of file
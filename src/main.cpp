@@ -2,7 +2,12 @@
 #include <Arduino_GFX_Library.h>
 #include <Wire.h>
 #include "databus/Arduino_ESP32SPIDMA.h"
+#include "databus/Arduino_ESP32QSPI.h"
 #include "canvas/Arduino_Canvas.h"
+#include "RegionCanvas.h"
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <driver/gpio.h>
 
 // 项目头文件
 #include "config.h"
@@ -11,42 +16,166 @@
 #include "KeypadControl.h"
 #include "CalculatorCore.h"
 #include "calc_display.h"
-#include "CalculationEngine.h"
+#include "CalcBackend.h"
 #include "KeyboardConfig.h"   // 新增：用于打印键盘配置
 #include "SleepManager.h"  // 新增：休眠管理器头文件
 #include "ConfigManager.h"  // 新增：配置管理器
 #include "SimpleHID.h"  // 简单HID功能
+#include "HostLink.h"
+#include "LedOutput.h"
+#include "HistoryLog.h"
+#include "HistorySync.h"
+#include "PeerSync.h"
+#include "FleetConfig.h"
+#include "LogFileSink.h"
+#include "BootProfiler.h"
+#include "BootSplash.h"
+#include "Console.h"
+#include "PowerManager.h"
+#include "LoopScheduler.h"
+#include "AmbientBacklight.h"
+#include "SpatialEffects.h"
+#include "DisplayTrace.h"
+#include "CpuProfiler.h"
+#include "LatencyProbe.h"
+#include "StallMonitor.h"
+#include "AllocTracer.h"
+#include "ScratchArena.h"
+#include "BufferPlacement.h"
+#include "PixelKernels.h"
+#include "CalculationEngine.h"
+#include "FastMath.h"
+#include "NumberFormatter.h"
+#include "TapHold.h"
+#include "KeyJournal.h"
+#include "ConfigJson.h"
+#include "LedLayout.h"
+#include "LayoutKeys.h"
+#include "UlpKeyScan.h"
+#include "BatteryMonitor.h"
+#include "ResumeState.h"
+#include "StaticObject.h"
+#include "Metrics.h"
+#include "ResourceMonitor.h"
+#include "CrashDump.h"
+#include "TimerWheel.h"
+#include "CoRunner.h"
+#include "ScreenMirror.h"
+#include "PowerBench.h"
+#include "SoakTest.h"
+#include "SpscQueue.h"
+#include "SettingsStore.h"
 
 
-// 全局对象
+// 子系统的静态存储：启动时就地构造，不使用堆（StaticObject.h）
+#if LCD_QSPI
+static StaticObject<Arduino_ESP32QSPI> busStorage;
+#else
+static StaticObject<Arduino_ESP32SPIDMA> busStorage;
+static StaticObject<Arduino_SWSPI> fallbackBusStorage;     // Canvas失败时的软件SPI
+#endif
+static StaticObject<Arduino_NV3041A> gfxStorage;
+static StaticObject<RegionCanvas> canvasStorage;
+static StaticObject<CalcDisplay> displayStorage;
+static StaticObject<CalculatorCore> calculatorStorage;
+static StaticObject<SimpleHID> simpleHIDStorage;
+
+// 全局对象（指向上面的存储，未创建时为nullptr）
 Arduino_DataBus *bus = nullptr;
 Arduino_GFX *gfx = nullptr;
-Arduino_Canvas *canvas = nullptr;
+RegionCanvas *canvas = nullptr;
 KeypadControl keypad;
 
 // LED数组定义（在config.h中声明为extern）
 CRGB leds[NUM_LEDS];
 
 // 计算器系统
-std::shared_ptr<CalculationEngine> engine;
-std::unique_ptr<CalcDisplay> display;
+CalcDisplay* display = nullptr;
 // CalcDisplayAdapter已被移除，直接使用CalcDisplay
-std::shared_ptr<CalculatorCore> calculator;
+CalculatorCore* calculator = nullptr;
 
 // HID系统组件
-std::unique_ptr<SimpleHID> simpleHID;
+SimpleHID* simpleHID = nullptr;
+
+// 布局方案组合键：Tab + 1~7 选择第1~7个方案，组合ID为 CHORD_PROFILE_BASE + 方案编号
+#define CHORD_PROFILE_BASE 0x10
+static const uint8_t PROFILE_CHORD_KEYS[] = {4, 9, 13, 3, 8, 12, 2};
+
+// 撤销/重做组合键：Tab + ⌫ 撤销，Tab + = 重做
+#define CHORD_UNDO 0x20
+#define CHORD_REDO 0x21
+
+// 计算器按键处理耗时和进入错误状态的次数（metrics命令、HostLink GET_METRICS）
+static MetricHistogram keyHandlingTime("core.key_us");
+static MetricCounter calculatorErrors("core.errors");
 
+// 小键盘直通模式：Tab + ± 切换，期间按键不经过主循环（见HID_PASSTHROUGH_ENABLED）
+#define CHORD_PASSTHROUGH 0x22
+
+// 布局表中holdMs非0的双功能键由此判定轻触/按住，其他键按下即处理
+static TapHold tapHold;
+
+
+// 按键活动期间（键盘不在空闲扫描模式）保持最高频率，按键到上屏的处理速度与固定频率时相同
+static PowerLock activeLock;
+static bool activeLockHeld = false;
+
+// 按键从深度睡眠唤醒且RTC内存中有计算器状态：跳过启动画面和提示灯，首帧直接显示恢复的状态
+static bool resuming = false;
 
 // 函数声明
 void initDisplay();
 void initLEDs();
-void onKeyEvent(KeyEventType type, uint8_t key, uint8_t* combo, uint8_t count);
-void handleSerialCommands();
+void applyKeypadConfig(uint32_t changed, const PersistentConfig& config, void*);
+void onKeyEvent(const KeyEvent& event);
+void runChord(uint8_t chord);
+void dispatchKeyInput(uint8_t key, bool isLongPress, int64_t timestamp);
+void simulateKeyEvent(KeyEventType type, uint8_t key);
+void registerCommands();
+bool prepareLightSleep(void*);
+bool prepareDeepSleep(void*);
 void updateSystems();
+void syncKeyStats();
+void applyKeyLayout();
+void runDeferredBoot();
+void initHID();
+void onHostLeds(const KeyEvent& event, void*);
+#if HID_PASSTHROUGH_ENABLED
+void setPassThrough(bool enable);
+#endif
 
 void setup() {
+    // 不等待串口：启动信息走异步日志，首帧之后再输出启动耗时
+#if SERIAL_TX_BUFFER
+    // 发送缓冲必须在begin()之前设置（安装UART驱动时分配）
+    Serial.setTxBufferSize(SERIAL_TX_BUFFER);
+#endif
     Serial.begin(115200);
-    delay(1000); // 等待串口稳定
+    BootProfiler::mark("串口");
+    // 深度睡眠期间保持的引脚（背光、按键PL）在重新配置前解除保持
+    gpio_deep_sleep_hold_dis();
+    gpio_hold_dis((gpio_num_t)LCD_BL);
+    gpio_hold_dis((gpio_num_t)SCAN_PL_PIN);
+#if DEEP_SLEEP_ENABLED
+    resuming = ResumeState::available();
+#endif
+    // 主循环在没有工作时阻塞等待，串口收到数据立即唤醒
+    LoopScheduler::instance().begin();
+    Serial.onReceive([]() { LoopScheduler::instance().wake(); });
+    // 各模块的超时在begin()中登记定时器，时间轮要最先就绪
+    TimerWheel::instance().begin();
+    CoRunner::instance().begin();
+    Metrics::instance().begin();
+    ResourceMonitor::instance().begin();
+    CrashDump::instance().begin();
+    registerCommands();
+#if CPU_PROFILER_ENABLED
+    CpuProfiler::instance().begin();
+#endif
+#if STALL_MONITOR_ENABLED
+    StallMonitor::instance().begin();
+#endif
+    AllocTracer::begin();
     
     Serial.println("=== ESP32-S3 计算器系统启动 ===");
 #ifdef DEBUG_MODE
@@ -54,8 +183,9 @@ void setup() {
 #endif
     Serial.println();
     
-    // 1. 初始化配置管理器
+    // 1. 初始化配置管理器（先映射设置镜像，之后各模块读取设置都是访问映射区）
     Serial.println("1. 初始化配置管理器...");
+    SettingsStore::instance().begin();
     ConfigManager& configManager = ConfigManager::getInstance();
     if (!configManager.begin()) {
         Serial.println("❌ 配置管理器初始化失败");
@@ -63,6 +193,7 @@ void setup() {
         return;
     }
     LOG_I(TAG_MAIN, "✅ 配置管理器初始化完成");
+    BootProfiler::mark("配置");
     
     // 2. 初始化日志系统
     Serial.println("2. 初始化日志系统...");
@@ -70,36 +201,67 @@ void setup() {
     LoggerConfig logConfig = Logger::getDefaultConfig();
     logConfig.level = (log_level_t)configManager.getLogLevel();
     logger.begin(logConfig);
+    configManager.addObserver(CONFIG_LOG_LEVEL, [](uint32_t, const PersistentConfig& config, void*) {
+        Logger::getInstance().setLevel((log_level_t)config.logLevel);
+    });
     LOG_I(TAG_MAIN, "✅ 日志系统初始化完成");
+    BootProfiler::mark("日志");
     
     // 3. 初始化硬件显示系统
     Serial.println("3. 初始化显示系统...");
     initDisplay();
     LOG_I(TAG_MAIN, "显示系统初始化完成");
+    BootProfiler::mark("显示硬件");
     
     // 4. 初始化LED系统
     Serial.println("4. 初始化LED系统...");
     initLEDs();
+    SpatialEffects::instance().begin();
     LOG_I(TAG_MAIN, "LED系统初始化完成");
+    BootProfiler::mark("LED");
     
     // 5. 初始化背光控制
     Serial.println("5. 初始化背光控制...");
     BacklightControl::getInstance().begin();
-    uint8_t savedBrightness = configManager.getBacklightBrightness();
-    BacklightControl::getInstance().setBacklight(savedBrightness, 2000);  // 使用保存的亮度
+    AmbientBacklight::instance().begin(configManager.getBacklightBrightness(), configManager.getBacklightAuto());
+    AmbientBacklight::instance().restore(2000);  // 使用保存的亮度或自动亮度
     LOG_I(TAG_MAIN, "背光控制初始化完成");
+    BootProfiler::mark("背光");
     
     // 6. 初始化键盘控制
     Serial.println("6. 初始化键盘系统...");
     keypad.begin();
-    keypad.setKeyEventCallback(onKeyEvent);
+    // 计算器和显示的处理推迟到HID报告和按键反馈之后；一批按键逐个处理，显示只在这一批之后刷新一次
+    KeyEventBus::instance().subscribe(KeySubscriber{"calculator", KEY_EVENT_ALL, KEY_STAGE_DEFERRED,
+                                                    [](const KeyEvent& event, void*) {
+                                                        if (calculator) calculator->beginBatch();
+                                                        onKeyEvent(event);
+                                                    },
+                                                    nullptr, nullptr,
+                                                    [](void*) { if (calculator) calculator->endBatch(); }});
+    KeyJournal::instance().begin();
+#if LATENCY_PROBE_ENABLED
+    LatencyProbe::instance().begin();
+#endif
+#if POWER_BENCH_ENABLED
+    PowerBench::instance().begin();
+#endif
     
-    // 从配置管理器加载按键设置
+    // 从配置管理器加载按键和蜂鸣器设置，之后配置变化时只重新应用变化的字段
     Serial.println("  - 从配置加载按键设置...");
-    keypad.setRepeatDelay(configManager.getRepeatDelay());
-    keypad.setRepeatRate(configManager.getRepeatRate());
-    keypad.setLongPressDelay(configManager.getLongPressDelay());
-    keypad.setGlobalBrightness(configManager.getLEDBrightness());
+    applyKeypadConfig(CONFIG_ALL_FIELDS, configManager.getConfig(), nullptr);
+    configManager.addObserver(CONFIG_REPEAT_DELAY | CONFIG_REPEAT_RATE | CONFIG_LONG_PRESS_DELAY |
+                              CONFIG_LED_BRIGHTNESS | CONFIG_BUZZER_FIELDS, applyKeypadConfig);
+    KeyStatsData keyStats;
+    if (configManager.loadKeyStats(keyStats)) {
+        keypad.restoreKeyStats(keyStats);
+    }
+    // 按键统计定期交给配置管理器，内容变化时才写入
+    static TimerWheel::TimerId keyStatsTimer = TimerWheel::instance().create("keystats", [](void*) {
+        syncKeyStats();
+        TimerWheel::instance().start(keyStatsTimer, KEY_STATS_SAVE_INTERVAL_MS);
+    }, nullptr);
+    TimerWheel::instance().start(keyStatsTimer, KEY_STATS_SAVE_INTERVAL_MS);
     
     // 配置按键反馈效果
     Serial.println("  - 配置按键反馈效果...");
@@ -111,49 +273,78 @@ void setup() {
         .buzzDuration = 50
     };
     
-    // 为所有22个按键配置反馈效果
-    for (uint8_t i = 1; i <= 22; i++) {
+    // 为所有22个按键配置反馈效果，颜色来自布局文件（color=）
+    for (uint8_t i = 1; i <= LAYOUT_KEY_COUNT; i++) {
+        defaultFeedback.color = CRGB(LAYOUT_KEY_COLORS[i - 1]);
         keypad.setKeyFeedback(i, defaultFeedback);
     }
     
-    // 从配置管理器加载蜂鸣器设置
-    BuzzerConfig buzzerConfig = {
-        .enabled = configManager.getBuzzerEnabled(),
-        .followKeypress = configManager.getBuzzerFollowKeypress(),
-        .dualTone = configManager.getBuzzerDualTone(),
-        .mode = (BuzzerMode)configManager.getBuzzerMode(),
-        .volume = (BuzzerVolume)configManager.getBuzzerVolume(),
-        .pressFreq = configManager.getBuzzerPressFreq(),
-        .releaseFreq = configManager.getBuzzerReleaseFreq(),
-        .duration = configManager.getBuzzerDuration()
-    };
-    keypad.configureBuzzer(buzzerConfig);
+    // Tab在前，是这些组合的修饰键：组合成立时Tab和成员键都不作为普通按键上报
+    for (uint8_t i = 0; i < sizeof(PROFILE_CHORD_KEYS); i++) {
+        uint8_t chord[2] = {6, PROFILE_CHORD_KEYS[i]};
+        keypad.registerChord(chord, 2, CHORD_PROFILE_BASE + i);
+    }
+    const uint8_t undoChord[2] = {6, 15};
+    const uint8_t redoChord[2] = {6, 22};
+    keypad.registerChord(undoChord, 2, CHORD_UNDO);
+    keypad.registerChord(redoChord, 2, CHORD_REDO);
+#if HID_PASSTHROUGH_ENABLED
+    const uint8_t passThroughChord[2] = {6, 20};
+    keypad.registerChord(passThroughChord, 2, CHORD_PASSTHROUGH);
+#endif
+#if KEYPAD_SCAN_TASK
+    // 定时扫描任务：按键检测不再受主循环中慢操作影响
+    if (!keypad.startScanTask(KEYPAD_SCAN_RATE_HZ, KEYPAD_SCAN_TASK_PRIO, KEYPAD_SCAN_TASK_CORE)) {
+        Serial.println("⚠️ 扫描任务启动失败，使用主循环轮询");
+    }
+#endif
     LOG_I(TAG_MAIN, "键盘系统初始化完成，已加载保存的配置");
+    BootProfiler::mark("键盘");
     
-    // 7. 创建计算引擎
-    Serial.println("7. 初始化计算引擎...");
-    engine = std::make_shared<CalculationEngine>();
-    if (!engine->begin()) {
-        LOG_E(TAG_MAIN, "计算引擎初始化失败");
-        Serial.println("❌ 计算引擎初始化失败");
-        return;
-    }
-    LOG_I(TAG_MAIN, "计算引擎初始化完成");
+    // 7. 计算后端在编译时选定（CALC_BACKEND），运算直接内联到CalculatorCore
+    Serial.printf("7. 计算后端: %s\n", CalcBackend::name());
+    LOG_I(TAG_MAIN, "计算后端: %s", CalcBackend::name());
     
     // 8. 创建显示管理器
     Serial.println("8. 初始化显示管理器...");
     Serial.println("  - 使用简化CalcDisplay界面");
     // 使用Canvas优化显示性能，如果Canvas不可用则回退到直接使用gfx
     Arduino_GFX* displayTarget = canvas ? canvas : gfx;
-    display = std::unique_ptr<CalcDisplay>(new CalcDisplay(displayTarget, DISPLAY_WIDTH, DISPLAY_HEIGHT));
+    BootSplash::instance().finish();  // 启动画面推送完后总线才交给CalcDisplay
+    display = displayStorage.construct(displayTarget, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+#if DISPLAY_RENDER_TASK
+    // 绘制移到另一个核心，按键扫描和HID上报不再等待帧绘制
+    if (!display->startRenderTask(DISPLAY_RENDER_CORE)) {
+        Serial.println("⚠️ 渲染任务启动失败，使用同步绘制");
+    }
+#endif
+    DisplayTrace::instance().begin(display);
+    ConfigJson::instance().begin(display);
+    // LED和蜂鸣器反馈延迟与显示统计放在一起，perf命令一并输出
+    keypad.setPerformanceMonitor(display->getPerformanceMonitor());
     // CalcDisplayAdapter已被移除，直接使用CalcDisplay
     LOG_I(TAG_MAIN, "显示管理器初始化完成");
+    BootProfiler::mark("显示管理器");
     
     // 9. 创建计算器核心
     Serial.println("9. 初始化计算器核心...");
-    calculator = std::make_shared<CalculatorCore>();
-    calculator->setDisplay(display.get());
-    calculator->setCalculationEngine(engine);
+#if HISTORY_LOG_ENABLED
+    // 先挂载历史日志，计算器初始化时从中恢复最近的记录
+    if (!HistoryLog::instance().begin(HISTORY_LOG_IDLE_MS, HISTORY_LOG_MAX_RECORDS)) {
+        Serial.println("⚠️ 历史日志不可用，历史记录不会保存");
+    }
+#if HISTORY_SYNC_ENABLED
+    HistorySync::instance().begin();
+#endif
+#endif
+#if FLEET_CONFIG_ENABLED
+    FleetConfig::instance().begin();
+#endif
+#if PEER_SYNC_ENABLED
+    PeerSync::instance().begin();
+#endif
+    calculator = calculatorStorage.construct();
+    calculator->setDisplay(display);
     
     // CalcDisplayAdapter已被移除，直接使用CalcDisplay
     
@@ -163,86 +354,363 @@ void setup() {
         return;
     }
     LOG_I(TAG_MAIN, "计算器核心初始化完成");
+    BootProfiler::mark("计算器核心");
     
     // 10. 初始化计算器界面（直接进入计算器）
     if (calculator && display) {
         // 清除所有内容，设置初始状态
         calculator->clearAll();
         
-        // 立即刷新显示，显示计算器界面（显示"0"）
-        display->updateExprDirect("");
-        display->updateResultDirect(calculator->getCurrentDisplay());
+        if (resuming && ResumeState::restore(*calculator)) {
+            // 深度睡眠唤醒：显示睡前的算式和结果
+            calculator->updateDisplay();
+        } else {
+            resuming = false;
+            // 立即刷新显示，显示计算器界面（显示"0"）
+            display->updateExprDirect("");
+            display->updateResultDirect(calculator->getCurrentDisplay());
+        }
         display->refresh();
         
-        LOG_I(TAG_MAIN, "计算器界面已就绪");
+        BootProfiler::mark("首帧");
+        LOG_I(TAG_MAIN, "计算器界面已就绪 (%lu ms)", (unsigned long)(BootProfiler::lastMarkUs() / 1000));
     }
     
     // 11. 初始化休眠管理器
     Serial.println("11. 初始化休眠管理器...");
     uint32_t sleepTimeout = configManager.getSleepTimeout();
     SleepManager::instance().begin(sleepTimeout);  // 使用配置的超时时间
-    // 注册背光回调
-    SleepManager::instance().addCallback(
+    // 休眠阶梯：调暗 → 关灯 → 面板睡眠，各级的延迟从上一级开始计算
+    SleepManager::instance().setStageDelay(SleepManager::State::LEDS_OFF, POWER_LEDS_OFF_DELAY_MS);
+    SleepManager::instance().setStageDelay(SleepManager::State::PANEL_OFF, POWER_PANEL_OFF_DELAY_MS);
+    SleepManager::instance().addCallback(SleepManager::State::DIM,
+        [](void*) {
+            AmbientBacklight::instance().suspend();
+            BacklightControl::getInstance().setBacklight(POWER_DIM_PERCENT, 800);
+            if (display) display->setStatus(StatusBar::ITEM_SLEEP, 1);
+        },
+        [](void*) {
+            AmbientBacklight::instance().restore(500);  // 恢复固定亮度或自动亮度
+            if (display) display->setStatus(StatusBar::ITEM_SLEEP, 0);
+            LOG_I(TAG_MAIN, "退出休眠: 背光%d%%", AmbientBacklight::instance().getAppliedPercent());
+        });
+    SleepManager::instance().addCallback(SleepManager::State::LEDS_OFF,
+        [](void*) { keypad.setLayerEffectAll(LED_LAYER_SLEEP, LED_SOLID, CRGB::Black); },
+        [](void*) { keypad.clearLayer(LED_LAYER_SLEEP); });
+    SleepManager::instance().addCallback(SleepManager::State::PANEL_OFF,
         [](void*) { 
-            // 进入休眠时：降低背光和CPU频率
-            BacklightControl::getInstance().setBacklight(10, 800);  // 降低到10%亮度
-            setCpuFrequencyMhz(80);  // 降低CPU频率至80MHz (默认通常是240MHz)
-            LOG_I(TAG_MAIN, "进入休眠模式: 降低CPU频率至80MHz, 背光10%%");
+            // 先写入未保存的历史和配置，再关闭面板、降低CPU频率
+#if HISTORY_LOG_ENABLED
+            HistoryLog::instance().flush();
+#if HISTORY_SYNC_ENABLED
+            HistorySync::instance().request();
+#endif
+#endif
+            syncKeyStats();
+            ConfigManager::getInstance().flush();
+            keyboardConfig.flush();
+            BacklightControl::getInstance().setBacklight(0, 300);
+            if (!PowerManager::instance().isEnabled()) {
+                setCpuFrequencyMhz(80);  // 降低CPU频率至80MHz；动态调频时没有锁自然降频
+                PowerManager::instance().noteFrequency();
+            }
+#if DISPLAY_PANEL_SLEEP
+            if (display) display->setPanelSleep(true);
+#endif
+            LOG_I(TAG_MAIN, "面板睡眠: 降低CPU频率至80MHz, %s",
+                  DISPLAY_PANEL_SLEEP ? "面板睡眠、背光关闭" : "背光关闭");
+            Logger::getInstance().flush();  // 日志文件的当前页写入闪存
         },
         [](void*) { 
-            // 唤醒时：恢复背光和CPU频率
-            BacklightControl::getInstance().setBacklight(100, 500);  // 恢复100%亮度
-            setCpuFrequencyMhz(240);  // 恢复CPU频率至240MHz
-            LOG_I(TAG_MAIN, "退出休眠模式: 恢复CPU频率至240MHz, 背光100%%");
-        }
-    );
+            if (!PowerManager::instance().isEnabled()) {
+                setCpuFrequencyMhz(240);  // 恢复CPU频率至240MHz
+                PowerManager::instance().noteFrequency();
+            }
+#if DISPLAY_PANEL_SLEEP
+            if (display) display->setPanelSleep(false);  // 先推送保留的帧，背光随后恢复
+#endif
+            BacklightControl::getInstance().setBacklight(POWER_DIM_PERCENT, 0);
+        });
+#if LIGHT_SLEEP_ENABLED
+    SleepManager::LightSleepConfig lightSleep = {};
+    lightSleep.delayMs = LIGHT_SLEEP_DELAY_MS;
+    lightSleep.pollMs = KEYPAD_IDLE_POLL_MS;      // 只有最后一级的按键能拉低MISO，其余靠兜底扫描
+#if ULP_KEY_SCAN_ENABLED
+    // ULP扫描整条链，任何按键都能唤醒；定时唤醒只用来推进深度睡眠的计时
+    lightSleep.ulpWakeup = UlpKeyScan::instance().isReady();
+    if (lightSleep.ulpWakeup) lightSleep.pollMs = ULP_KEY_SCAN_POLL_MS;
+#endif
+    lightSleep.prepare = prepareLightSleep;
+    lightSleep.resume = [](void*) {
+        keypad.finishLightSleep();
+        if (simpleHID) simpleHID->finishLightSleep();
+    };
+    SleepManager::instance().enableLightSleep(lightSleep);
+#if DEEP_SLEEP_ENABLED
+    SleepManager::DeepSleepConfig deepSleep = {};
+    deepSleep.delayMs = DEEP_SLEEP_DELAY_MS;
+    static_assert(SCAN_MISO_PIN <= 21, "深度睡眠的ext1唤醒引脚必须是RTC GPIO（0-21）");
+    deepSleep.wakePinMask = 1ULL << SCAN_MISO_PIN;
+#if ULP_KEY_SCAN_ENABLED
+    deepSleep.ulpWakeup = UlpKeyScan::instance().isReady();
+#endif
+    deepSleep.prepare = prepareDeepSleep;
+    SleepManager::instance().enableDeepSleep(deepSleep);
+    SleepManager::instance().addCallback(SleepManager::State::DEEP_SLEEP,
+        [](void*) {
+            if (calculator) ResumeState::save(*calculator);
+            LOG_I(TAG_MAIN, "深度睡眠: 按键唤醒后重新启动");
+            Logger::getInstance().flush();
+        }, nullptr);
+#endif
+#endif
+#if BATTERY_ADC_PIN >= 0
+    // 电量：状态栏图标；低电量时更早进入休眠和浅睡眠
+    BatteryMonitor::instance().setLevelCallback([](uint8_t percent, void*) {
+        if (display) display->setStatus(StatusBar::ITEM_BATTERY, 1 + BatteryMonitor::bars(percent));
+        SleepManager::instance().setTimeoutScale(percent < BATTERY_LOW_PERCENT ? BATTERY_LOW_SLEEP_SCALE : 100);
+    }, nullptr);
+    if (!BatteryMonitor::instance().begin()) {
+        LOG_W(TAG_MAIN, "电池监测不可用");
+    }
+#endif
     LOG_I(TAG_MAIN, "休眠管理器初始化完成");
+    BootProfiler::mark("休眠管理器");
+    
+#if PM_DFS_ENABLED
+    // 12. 启动完成后再打开动态调频，启动过程保持最高频率
+    activeLock.begin("loopActive");
+    PowerManager::instance().begin(PM_MAX_FREQ_MHZ, PM_MIN_FREQ_MHZ, PM_AUTO_LIGHT_SLEEP);
+#endif
+    
+    // 启动提示灯、HID枚举和启动报告在首帧之后由loop()中的runDeferredBoot()完成
+}
+
+bool prepareLightSleep(void*) {
+    // USB已连接且主机醒着、或BLE已连接时不睡（主机休眠时靠按键远程唤醒）
+    if (simpleHID && !simpleHID->allowsLightSleep()) return false;
+#if HOST_LINK_ENABLED
+    if (HostLink::instance().isConnected() && !(simpleHID && simpleHID->isUsbSuspended())) return false;
+#endif
     
+    // 睡眠期间LEDC和I2S停止，等提示音放完
+    if (keypad.isBuzzerPlaying()) return false;
+#if HISTORY_SYNC_ENABLED && HISTORY_LOG_ENABLED
+    // 同步任务在用WiFi
+    if (HistorySync::instance().isBusy()) return false;
+#endif
+#if PEER_SYNC_ENABLED
+    // ESP-NOW在等同组设备的包
+    if (PeerSync::instance().isRadioOn()) return false;
+#endif
+#if BATTERY_ADC_PIN >= 0
+    // 一批转换进行中，睡眠会停住DMA
+    if (BatteryMonitor::instance().isBusy()) return false;
+#endif
+    
+    // 背光和按键灯在前面几级已经关闭，等渐变和LED数据发完再睡（睡眠期间PWM和RMT都停止，会停在当前亮度）
+    if (BacklightControl::getInstance().isFading() || !LedOutput::instance().isIdle()) return false;
+    if (canvas && canvas->isFlushBusy()) return false;
+    
+    if (!keypad.prepareLightSleep()) return false;
+    if (simpleHID) simpleHID->prepareLightSleep();
+    return true;
+}
+
+bool prepareDeepSleep(void*) {
+    // 深度睡眠时USB和BLE都会断开，主机休眠时也不进入
+    if (simpleHID && (simpleHID->isUsbConnected() || simpleHID->isConnected())) return false;
+#if HISTORY_SYNC_ENABLED && HISTORY_LOG_ENABLED
+    if (HistorySync::instance().isBusy()) return false;
+#endif
+#if PEER_SYNC_ENABLED
+    if (PeerSync::instance().isRadioOn()) return false;
+#endif
+    if (!keypad.prepareDeepSleep()) return false;
+
+    // 睡眠期间LEDC停止，背光引脚保持为低
+    ledcDetachPin(LCD_BL);
+    pinMode(LCD_BL, OUTPUT);
+    digitalWrite(LCD_BL, LOW);
+    gpio_hold_en((gpio_num_t)LCD_BL);
+    return true;
+}
+
+void runDeferredBoot() {
+    static uint8_t stage = 0;
+    if (stage > 2) return;
+    
+    // 每次循环只做一步，期间按键和显示照常处理
+    LoopScheduler::instance().after(0);
+    switch (stage++) {
+    case 0:
+        // 启动提示：紫色渐亮渐灭一次，由按键LED的图层效果驱动，不阻塞；从深度睡眠恢复时不提示
+        if (!resuming) keypad.setLayerEffectAll(LED_LAYER_AMBIENT, LED_PULSE, CRGB::Purple);
+        BootProfiler::mark("启动提示灯");
+        break;
+    case 1:
+        initHID();
+        BootProfiler::mark("HID");
+        break;
+    default:
+        Serial.println("=== 计算器系统启动完成 ===");
+        Serial.println("系统就绪，发送 'help' 查看命令");
+        BootProfiler::print(Serial);
+        LOG_I(TAG_MAIN, "系统启动完成，所有组件已就绪");
+        break;
+    }
+}
+
+void initHID() {
     // 12. 初始化简单HID系统
     Serial.println("12. 初始化简单HID键盘系统...");
     
+#if HOST_LINK_ENABLED
+    // CDC接口必须在USB.begin()（SimpleHID::begin()中）之前注册，与HID组成同一个复合设备
+    HostLink::instance().begin();
+#endif
+    
     // 初始化简单HID功能
-    simpleHID = std::unique_ptr<SimpleHID>(new SimpleHID());
+    simpleHID = simpleHIDStorage.construct();
     if (!simpleHID->begin()) {
         LOG_E(TAG_MAIN, "简单HID系统初始化失败");
         Serial.println("⚠️ 简单HID系统初始化失败");
-        simpleHID.reset();  // 释放资源
+        simpleHIDStorage.destroy();  // 释放资源
+        simpleHID = nullptr;
     } else {
         LOG_I(TAG_MAIN, "简单HID系统初始化完成");
         Serial.println("✅ 简单HID功能已启用 - 按键将同时触发计算器和USB键盘功能");
         
-        // 将简单HID设置到按键控制器
-        keypad.setSimpleHID(simpleHID.get());
-        keypad.setHIDEnabled(true);  // 启用HID功能
+        // 宏中的{RESULT}输入最近一次计算结果：完整精度、不带千位分隔符，便于粘贴到表格
+        simpleHID->setResultProvider([](char* buffer, size_t size) -> size_t {
+            const HistoryRecord* last = calculator ? calculator->getHistory().get(0) : nullptr;
+            return last ? NumberFormatter::formatTo(last->result, buffer, size, NumberFormatter::MAX_DECIMALS) : 0;
+        });
+        
+        // 主机休眠时，唤醒设备的按键同时唤醒主机（扫描和去抖之前）
+        keypad.setWakeHook([](void* context) {
+            static_cast<SimpleHID*>(context)->requestRemoteWakeup();
+        }, simpleHID);
+        
+        // 主机的NumLock/CapsLock：切换计算器层并显示在按键灯上
+        KeyEventBus::instance().subscribe(KeySubscriber{"hostLed", KEY_EVENT_BIT(KEY_EVENT_HOST_LED),
+                                                        KEY_STAGE_FEEDBACK, onHostLeds, nullptr, nullptr});
+    }
+    
+    // 层、方案切换或换入新布局后更新自动重复的按键、按键颜色和层状态图标
+    applyKeyLayout();
+    keyboardConfig.setLayerCallback([](KeyLayer layer, void*) {
+        applyKeyLayout();
+        if (display) {
+            display->setStatus(StatusBar::ITEM_LAYER, (uint8_t)layer);
+        }
+    }, nullptr);
+    
+    // 状态图标：层切换、USB连接和休眠（见休眠回调）都由事件更新
+    if (display) {
+        display->setStatus(StatusBar::ITEM_LAYER, (uint8_t)keyboardConfig.getCurrentLayer());
+        if (simpleHID) {
+            display->setStatus(StatusBar::ITEM_HID, simpleHID->isConnected());
+            simpleHID->setConnectionCallback([](bool connected, void*) {
+                // 直通模式的图标保持到退出
+                if (!keypad.isPassThrough()) display->setStatus(StatusBar::ITEM_HID, connected);
+            }, nullptr);
+        }
     }
     
-    Serial.println("=== 计算器系统启动完成 ===");
-    Serial.println("系统就绪，发送 'help' 查看命令");
+#if USB_SUSPEND_POWER_SAVE
+    if (simpleHID) {
+        // 在USB事件任务中调用，由主循环的SleepManager::update()执行
+        simpleHID->setSuspendCallback([](bool suspended, void*) {
+            if (suspended) {
+                SleepManager::instance().requestSleep(SleepManager::State::PANEL_OFF);
+            } else {
+                SleepManager::instance().requestFeed();
+            }
+        }, nullptr);
+    }
+#endif
     
-    LOG_I(TAG_MAIN, "系统启动完成，所有组件已就绪");
+#if HOST_LINK_ENABLED
+    HostLink::instance().attach(calculator, display ? display->getPerformanceMonitor() : nullptr,
+                                simpleHID);
+#endif
+#if SOAK_TEST_ENABLED
+    SoakTest::instance().begin(display ? display->getPerformanceMonitor() : nullptr);
+#endif
 }
 
 void loop() {
+#if STALL_MONITOR_ENABLED
+    StallMonitor::instance().iterationBegin();
+#endif
 
-    static unsigned long lastUpdate = 0;
-    unsigned long currentTime = millis();
+    // 扫描任务检测到按键时已退出空闲模式，这次分发就在最高频率下进行
+    bool active = !keypad.isIdle();
+    if (active != activeLockHeld) {
+        if (active) {
+            activeLock.acquire();
+        } else {
+            activeLock.release();
+        }
+        activeLockHeld = active;
+#if PEER_SYNC_ENABLED
+        // 输入期间保持无线打开，结果完成时直接发出
+        PeerSync::instance().setActive(active);
+#endif
+    }
     
-    // 每10ms更新一次系统状态
-    if (currentTime - lastUpdate >= 10) {
-        lastUpdate = currentTime;
+    // 按键事件每次循环都分发（轮询模式下内部仍按UPDATE_INTERVAL扫描）；
+    // 主机LED状态与按键事件在同一批中分发
+    if (simpleHID) {
+        simpleHID->update();
+    }
+    keypad.update();
+    
+    // 更新系统状态：各模块按自己的截止时间推进，没到时间的直接返回
+    {
+        ALLOC_TAG("update_systems");
         updateSystems();
     }
     
-    // 处理串口命令
-    handleSerialCommands();
+    // 首帧之后的启动步骤
+    runDeferredBoot();
+    
+    // 处理串口命令（测试命令直接调用FastLED.show()时，LedOutput经引擎事件得知副本失效）
+    {
+        ALLOC_TAG("console");
+        Console::instance().poll(Serial);
+    }
+    
+#if HOST_LINK_ENABLED
+    // 处理USB CDC主机通道的请求
+    HostLink::instance().poll();
+#endif
+    
+#if PEER_SYNC_ENABLED
+    // 处理同组设备发来的结果
+    PeerSync::instance().poll();
+#endif
+#if FLEET_CONFIG_ENABLED
+    // 校验并应用推送来的配置增量
+    FleetConfig::instance().poll();
+#endif
     
     // 更新动画系统
     if (display) {
+        ALLOC_TAG("display_tick");
         display->tick();
     }
     
-    // 小延迟避免过度占用CPU
-    delay(1);
+    // 按键跟踪窗口到这一轮结束
+    AllocTracer::onLoopEnd();
+    
+#if STALL_MONITOR_ENABLED
+    StallMonitor::instance().iterationEnd();
+#endif
+    
+    // 等待事件或最早的截止时间，期间loop任务不占用CPU，空闲任务可以降频
+    LoopScheduler::instance().wait(LOOP_MAX_WAIT_MS);
 }
 
 void initDisplay() {
@@ -251,63 +719,114 @@ void initDisplay() {
     digitalWrite(LCD_BL, LOW); // 先关闭背光
     
     Serial.println("  - 初始化显示总线...");
+#if LCD_QSPI
+    // QSPI：SPI3四线输出，同样经DMA发送
+    bus = busStorage.construct(LCD_CS, LCD_SCK, LCD_QSPI_D0, LCD_QSPI_D1, LCD_QSPI_D2, LCD_QSPI_D3);
+    const uint32_t busHz = LCD_QSPI_HZ;
+#else
     // 升级到DMA SPI，80 MHz
-    bus = new Arduino_ESP32SPIDMA(LCD_DC, LCD_CS, LCD_SCK, LCD_MOSI,
-                                  /*miso*/ -1, /*host*/ SPI3_HOST, false);
+    bus = busStorage.construct(LCD_DC, LCD_CS, LCD_SCK, LCD_MOSI,
+                               /*miso*/ -1, /*host*/ SPI3_HOST, false);
+    const uint32_t busHz = LCD_SPI_HZ;
+#endif
     
     Serial.println("  - 初始化显示驱动...");
-    gfx = new Arduino_NV3041A(bus,
-                             LCD_RST,
-                             2,             // rotation: 0~3
-                             true,          // IPS 屏
-                             DISPLAY_WIDTH, // 480
-                             DISPLAY_HEIGHT,// 135
-                             0,             // 水平偏移（col_offset）
-                             0,
-                             0,
-                             140);          // 垂直偏移（row_offset）- 向上扩展5像素
+    gfx = gfxStorage.construct(bus,
+                               LCD_RST,
+                               DISPLAY_ROTATION,  // 在面板的MADCTL中完成，不做逐像素变换
+                               true,          // IPS 屏
+                               DISPLAY_WIDTH, // 480
+                               DISPLAY_HEIGHT,// 135
+                               0,             // 水平偏移（col_offset）
+                               0,
+                               0,
+                               140);          // 垂直偏移（row_offset）- 向上扩展5像素
     
     Serial.println("  - 启动显示硬件...");
-    if (!gfx->begin(80 * 1000 * 1000UL)) {  // 80 MHz
+    if (!gfx->begin(busHz)) {
         Serial.println("❌ 显示硬件启动失败！");
         LOG_E(TAG_MAIN, "显示硬件启动失败");
         return;
     }
+#if LCD_TE >= 0
+    // 打开面板TE输出（TEON，只在垂直消隐期输出）
+    bus->beginWrite();
+    bus->writeC8D8(0x35, 0x00);
+    bus->endWrite();
+#endif
     
     // 创建全屏Canvas缓冲区
     Serial.println("  - 创建Canvas缓冲区...");
-    // 去除输出偏移，Canvas直接输出到(0,0)
-    canvas = new Arduino_Canvas(DISPLAY_WIDTH, DISPLAY_HEIGHT, gfx);
+    // 去除输出偏移，Canvas直接输出到(0,0)；RegionCanvas支持按矩形局部推送
+    canvas = canvasStorage.construct(DISPLAY_WIDTH, DISPLAY_HEIGHT, static_cast<Arduino_TFT *>(gfx), bus);
+#if DISPLAY_PALETTE_CANVAS
+    uint16_t palette[4];
+    canvas->setPalette(palette, CalcDisplay::getPalette(palette));
+#endif
     if (!canvas->begin(GFX_SKIP_OUTPUT_BEGIN)) {
-        Serial.println("❌ Canvas初始化失败！回退到软件SPI");
-        delete canvas;
+        canvasStorage.destroy();
         canvas = nullptr;
-        delete bus;
+#if LCD_QSPI
+        // 软件SPI需要DC线，QSPI接线下无法回退，直接在屏幕上绘制
+        Serial.println("❌ Canvas初始化失败！直接绘制到屏幕");
+#else
+        Serial.println("❌ Canvas初始化失败！回退到软件SPI");
+        busStorage.destroy();
         // 回退到软件SPI
-        bus = new Arduino_SWSPI(LCD_DC, LCD_CS, LCD_SCK, LCD_MOSI);
-        delete gfx;
-        gfx = new Arduino_NV3041A(bus, LCD_RST, 2, true, DISPLAY_WIDTH, DISPLAY_HEIGHT, 0, 0, 0, 140);
+        bus = fallbackBusStorage.construct(LCD_DC, LCD_CS, LCD_SCK, LCD_MOSI);
+        gfx = gfxStorage.construct(bus, LCD_RST, DISPLAY_ROTATION, true, DISPLAY_WIDTH, DISPLAY_HEIGHT, 0, 0, 0, 140);
         if (!gfx->begin()) {
             Serial.println("❌ 回退显示硬件启动也失败！");
             return;
         }
+#endif
     } else {
-        Serial.printf("✅ DMA Canvas创建成功: %dx%d, 内存占用: %d KB\n", 
-                     DISPLAY_WIDTH, DISPLAY_HEIGHT, 
-                     (DISPLAY_WIDTH * DISPLAY_HEIGHT * 2) / 1024);
+        Serial.printf("✅ DMA Canvas创建成功: %dx%d%s, 内存占用: %d KB, 总线: %s %lu MHz\n", 
+                     DISPLAY_WIDTH, DISPLAY_HEIGHT, canvas->isPaletted() ? " (2位调色板)" : "",
+                     (int)(canvas->getBufferBytes() / 1024), LCD_QSPI ? "QSPI" : "SPI",
+                     (unsigned long)(busHz / 1000000));
+#if LCD_TE >= 0
+        if (canvas->beginTearSync(LCD_TE)) {
+            Serial.println("✅ TE同步推送已启用");
+        }
+#endif
+#if DISPLAY_DOUBLE_BUFFER
+        if (canvas->isPaletted()) {
+            Serial.println("  - 调色板模式不使用双缓冲，同步推送");
+        } else if (canvas->beginDoubleBuffer()) {
+            Serial.println("✅ 双缓冲异步推送已启用");
+        } else {
+            Serial.println("⚠️ 双缓冲内存不足，使用同步推送");
+            LOG_W(TAG_MAIN, "双缓冲分配失败，回退到同步推送");
+        }
+#endif
+#if DISPLAY_TILE_HASH
+        if (canvas->beginTileHash()) {
+            Serial.println("✅ 按块哈希检测变化区域");
+        } else {
+            LOG_W(TAG_MAIN, "块哈希表分配失败，按标记的矩形推送");
+        }
+#endif
+        // 截图和实时镜像按Canvas推送的区域发送（主机通道）
+        ScreenMirror::instance().attach(canvas);
     }
     
-    // 延迟确保初始化完成
-    delay(100);
-    
     // 背光保持关闭，等待后续软件控制
     Serial.println("  - 背光硬件准备完成，等待软件控制");
     
-    // 清屏
+    bool splash = false;
+#if DISPLAY_SPLASH
+    // 启动画面在另一核心上逐条解码并直接推送到面板，setup()同时继续初始化；创建CalcDisplay前等待结束
+    if (!resuming) {
+        splash = BootSplash::instance().start(static_cast<Arduino_TFT *>(gfx), bus, DISPLAY_SPLASH_CORE);
+    }
+#endif
+    
+    // 清屏；显示启动画面时Canvas留到首帧再推送
     if (canvas) {
         canvas->fillScreen(0x0000);
-        canvas->flush();
-    } else {
+        if (!splash) canvas->flush();
+    } else if (!splash) {
         gfx->fillScreen(0x0000);
     }
     
@@ -317,47 +836,79 @@ void initLEDs() {
     Serial.println("  - 配置FastLED...");
     FastLED.addLeds<WS2812, RGB_PIN, GRB>(leds, NUM_LEDS);
     FastLED.setBrightness(LED_BRIGHTNESS);
+    // LedOutput在gamma之后的16位值上做时间抖动，FastLED的二值抖动会叠加出闪烁
+    FastLED.setDither(DISABLE_DITHER);
     
     Serial.println("  - 清除所有LED...");
     FastLED.clear();
     FastLED.show();
     
-    // 启动LED测试序列
-    Serial.println("  - 执行LED测试序列...");
+    // 紫色启动提示在首帧之后由runDeferredBoot()以LED_PULSE效果播放
     
-    // 设置所有LED为紫色
-    for (int i = 0; i < NUM_LEDS; i++) {
-        leds[i] = CRGB::Purple;
+    LedOutput::instance().setPowerBudget(POWER_BUDGET_MW);
+#if LED_ASYNC_SHOW
+    // 启动序列之后的按键反馈改为异步推送
+    if (!LedOutput::instance().begin(LED_FRAME_MS, LED_SHOW_TASK_CORE)) {
+        Serial.println("⚠️ LED推送任务启动失败，使用同步推送");
     }
-    
-    // 300ms内渐亮
-    const int steps = 30;  // 30步渐变
-    const int stepDelay = 10;  // 每步10ms，总计300ms
-    
-    // 渐亮过程
-    for (int brightness = 0; brightness <= 255; brightness += (255 / steps)) {
-        FastLED.setBrightness(brightness);
-        FastLED.show();
-        delay(stepDelay);
+#endif
+}
+
+void onHostLeds(const KeyEvent& event, void*) {
+    static uint8_t last = 0xFF;
+    uint8_t changed = event.key ^ last;
+    last = event.key;
+
+#if HOST_LED_LAYER_SYNC
+    // 只在主机切换NumLock时同步，之间仍可以用Tab键切换层
+    if (changed & HOST_LED_NUM_LOCK) {
+        keyboardConfig.switchToLayer((event.key & HOST_LED_NUM_LOCK) ? KeyLayer::PRIMARY : KeyLayer::SECONDARY);
     }
-    
-    // 渐灭过程
-    for (int brightness = 255; brightness >= 0; brightness -= (255 / steps)) {
-        FastLED.setBrightness(brightness);
-        FastLED.show();
-        delay(stepDelay);
+#endif
+
+    // 状态灯在环境光之上、按键反馈之下，按键闪烁时仍能看到
+    keypad.clearLayer(LED_LAYER_HOST);
+    if (event.key & HOST_LED_NUM_LOCK) {
+        keypad.setLayerEffect(LED_LAYER_HOST, LedLayout::instance().keyToLed(HOST_LED_NUM_KEY - 1), LED_SOLID,
+                              CRGB::Green);
+    }
+    if (event.key & HOST_LED_CAPS_LOCK) {
+        keypad.setLayerEffect(LED_LAYER_HOST, LedLayout::instance().keyToLed(HOST_LED_CAPS_KEY - 1), LED_SOLID,
+                              CRGB::Orange);
     }
-    
-    // 恢复原始亮度设置并清除LED
-    FastLED.setBrightness(LED_BRIGHTNESS);
-    FastLED.clear();
-    FastLED.show();
-    
 }
 
-void onKeyEvent(KeyEventType type, uint8_t key, uint8_t* combo, uint8_t count) {
+void applyKeypadConfig(uint32_t changed, const PersistentConfig& config, void*) {
+    if (changed & CONFIG_REPEAT_DELAY) keypad.setRepeatDelay(config.repeatDelay);
+    if (changed & CONFIG_REPEAT_RATE) keypad.setRepeatRate(config.repeatRate);
+    if (changed & CONFIG_LONG_PRESS_DELAY) keypad.setLongPressDelay(config.longPressDelay);
+    if (changed & CONFIG_LED_BRIGHTNESS) keypad.setGlobalBrightness(config.globalBrightness);
+    if (changed & CONFIG_BUZZER_FIELDS) {
+        BuzzerConfig buzzerConfig = {
+            .enabled = config.buzzerEnabled,
+            .followKeypress = config.buzzerFollowKeypress,
+            .dualTone = config.buzzerDualTone,
+            .mode = (BuzzerMode)config.buzzerMode,
+            .volume = config.buzzerVolume,
+            .pressFreq = config.buzzerPressFreq,
+            .releaseFreq = config.buzzerReleaseFreq,
+            .duration = config.buzzerDuration
+        };
+        keypad.configureBuzzer(buzzerConfig);
+    }
+}
+
+void onKeyEvent(const KeyEvent& event) {
+    if (event.type == KEY_EVENT_PRESS) {
+        AllocTracer::onKeyPress();
+    }
+    ALLOC_TAG("key_event");
+    // 这次事件中的临时文本（格式化、预览等）在返回时整体回收
+    ScratchScope scratch(ScratchArena::keyEvent());
     SleepManager::instance().feed();  // 按键事件喂狗，重置休眠计时器
     
+    KeyEventType type = event.type;
+    uint8_t key = event.key;
     const char* eventStr;
     switch (type) {
         case KEY_EVENT_PRESS:       eventStr = "按下"; break;
@@ -368,383 +919,1022 @@ void onKeyEvent(KeyEventType type, uint8_t key, uint8_t* combo, uint8_t count) {
         default:                    eventStr = "未知"; break;
     }
     
-    // 完整的日志格式
-    LOG_D(TAG_MAIN, "按键事件: Key=%d, Event=%s", key, eventStr);
-
-    // 简化串口输出
-    Serial.printf("按键事件: Key=%d, Event=%s\n", key, eventStr);
+    TRACE(TRACE_KEY, "按键事件: Key=%d, Event=%s", key, eventStr);
+    
+    if (type == KEY_EVENT_COMBO) {
+        runChord(key);
+        return;
+    }
+#if HID_PASSTHROUGH_ENABLED
+    // 直通期间只有组合键进入主循环
+    if (keypad.isPassThrough()) return;
+#endif
     
     // HID 处理已由 KeypadControl 内部完成，无需单独 usbHID
     
-    // 仅在按下/长按时处理输入，忽略释放等其他事件
-    if (calculator) {
-        if (type == KEY_EVENT_PRESS) {
-            calculator->handleKeyInput(key, /*isLongPress*/ false);
-        } else if (type == KEY_EVENT_LONGPRESS) {
-            calculator->handleKeyInput(key, /*isLongPress*/ true);
+    // 双功能键：按下时只记为待定，释放或按住到判定时间（updateSystems()中检查）才处理；
+    // 按下其他键时待定键先按轻触处理，保持动作顺序。组合窗口过后才加入的组合成员例外：
+    // 待定键作为修饰键结算（不轻触也不按住），执行组合的动作
+    if (type == KEY_EVENT_PRESS) {
+        uint8_t modifier = tapHold.pendingKey();
+        uint8_t chord = modifier ? keypad.findChord((1UL << (modifier - 1)) | (1UL << (key - 1))) : 0;
+        if (chord) {
+            tapHold.joinChord(key);
+            runChord(chord);
+            return;
         }
-    }
-}
-
-void handleSerialCommands() {
-    if (Serial.available()) {
-        String cmd = Serial.readStringUntil('\n');
-        cmd.trim();
-        
-        if (cmd.equalsIgnoreCase("help")) {
-            Serial.println("可用命令:");
-            Serial.println("  help          - 显示此帮助信息");
-            Serial.println("  status        - 显示系统状态");
-            Serial.println("  led <idx> <r> <g> <b> - 设置单个LED颜色");
-            Serial.println("  led all <r> <g> <b> - 设置所有LED颜色");
-            Serial.println("  led off       - 关闭所有LED");
-            Serial.println("  brightness <0-255> - 设置LED亮度");
-            Serial.println("  reboot        - 重启设备");
-            Serial.println("  log_level <lvl> - 设置日志级别 (0:无, 1:错误, 2:警告, 3:信息, 4:调试, 5:详细)");
-            Serial.println("  mem           - 显示内存使用情况");
-            Serial.println("  tasks         - 显示正在运行的任务");
-            Serial.println("  layout        - 显示键盘布局");
-            Serial.println("  config        - 显示当前加载的配置");
-            Serial.println("  sleep <sec>   - 设置自动休眠时间(秒)");
-            Serial.println("  sleep off     - 关闭自动休眠功能");
-            Serial.println("  test_feedback <key> - 测试按键反馈效果");
-            Serial.println("  buzzer <freq> <duration> - 测试蜂鸣器");
-            Serial.println("  piano_mode <on|off> - 切换钢琴模式（500Hz-2500Hz宽频音调）");
-            Serial.println("  piano_test - 测试宽频音阶（播放22个音符，5倍频率范围）");
-            Serial.println("  led_test - 逐个测试所有LED");
-            Serial.println("  save_config - 手动保存当前配置");
-            Serial.println("  load_config - 重新加载配置");
-            Serial.println("  reset_config - 重置配置为默认值");
-            Serial.println("  show_config - 显示当前配置");
-            Serial.println("  config_info - 显示配置系统信息");
-            Serial.println("  auto_save <on|off> - 开启/关闭自动保存");
-            Serial.println("  hid_status - 显示简单HID状态");
-            Serial.println("  hid_test <key> - 测试HID按键发送");
-            Serial.println("  hid_enable <on|off> - 启用/禁用HID功能");
-        } else if (cmd.equalsIgnoreCase("status")) {
-            Serial.println("系统状态:");
-            Serial.printf(" - 可用堆内存: %d 字节\n", ESP.getFreeHeap());
-            Serial.printf(" - CPU 频率: %d MHz\n", getCpuFrequencyMhz());
-            Serial.printf(" - 运行时间: %lu 毫秒\n", millis());
-            Serial.printf(" - 背光亮度: %d%%\n", BacklightControl::getInstance().getCurrentBrightness() * 100 / 255);
-            
-            // 显示休眠状态信息
-            const char* sleepState = (SleepManager::instance().getState() == SleepManager::State::SLEEPING) ? "已休眠" : "活动中";
-            uint32_t sleepTimeout = SleepManager::instance().getTimeout();
-            if (sleepTimeout > 0) {
-                Serial.printf(" - 休眠状态: %s (超时: %lu 秒)\n", sleepState, sleepTimeout / 1000);
-            } else {
-                Serial.printf(" - 休眠状态: 已禁用\n");
-            }
-            
-            if(calculator) {
-                Serial.printf(" - 计算器显示: %s\n", calculator->getCurrentDisplay().c_str());
-            }
-            
-            // 显示蜂鸣器模式状态
-            Serial.printf(" - 蜂鸣器模式: %s\n", 
-                        (keypad.getBuzzerConfig().mode == BUZZER_MODE_PIANO) ? "钢琴模式 (500Hz-2500Hz)" : "普通模式");
-        } else if (cmd.startsWith("led")) {
-            int parts[5];
-            if (cmd.indexOf("all") > 0) {
-                 if (sscanf(cmd.c_str(), "led all %d %d %d", &parts[2], &parts[3], &parts[4]) == 3) {
-                     for (int i = 0; i < NUM_LEDS; i++) {
-                         leds[i].setRGB(parts[2], parts[3], parts[4]);
-                     }
-                     FastLED.show();
-                     Serial.println("所有LED已更新");
-                 } else {
-                     Serial.println("无效的 'led all' 命令格式. 使用: led all <r> <g> <b>");
-                 }
-            } else if (cmd.indexOf("off") > 0) {
-                FastLED.clear();
-                FastLED.show();
-                Serial.println("所有LED已关闭");
-            } else {
-                if (sscanf(cmd.c_str(), "led %d %d %d %d", &parts[1], &parts[2], &parts[3], &parts[4]) == 4) {
-                    if (parts[1] >= 0 && parts[1] < NUM_LEDS) {
-                        leds[parts[1]].setRGB(parts[2], parts[3], parts[4]);
-                        FastLED.show();
-                        Serial.printf("LED %d 已更新\n", parts[1]);
-                    } else {
-                        Serial.println("无效的LED索引");
-                    }
-                } else {
-                    Serial.println("无效的 'led' 命令格式. 使用: led <index> <r> <g> <b>");
-                }
-            }
-        } else if (cmd.startsWith("brightness")) {
-            int brightness;
-            if (sscanf(cmd.c_str(), "brightness %d", &brightness) == 1) {
-                if (brightness >= 0 && brightness <= 255) {
-                    FastLED.setBrightness(brightness);
-                    FastLED.show();
-                    keypad.setGlobalBrightness(brightness);
-                    ConfigManager::getInstance().setLEDBrightness(brightness);
-                    Serial.printf("LED亮度已设置为 %d 并保存到配置\n", brightness);
-                } else {
-                    Serial.println("亮度值必须在 0-255 之间");
-                }
-            } else {
-                Serial.println("无效的 'brightness' 命令格式. 使用: brightness <0-255>");
-            }
-        } else if (cmd.equalsIgnoreCase("reboot")) {
-            Serial.println("正在重启...");
-            ESP.restart();
-        } else if (cmd.startsWith("log_level")) {
-            int level;
-            if (sscanf(cmd.c_str(), "log_level %d", &level) == 1) {
-                if (level >= LOG_LEVEL_NONE && level <= LOG_LEVEL_VERBOSE) {
-                    Logger::getInstance().setLevel((log_level_t)level);
-                    ConfigManager::getInstance().setLogLevel(level);
-                    Serial.printf("日志级别已设置为 %d 并保存到配置\n", level);
-                } else {
-                    Serial.println("无效的日志级别");
-                }
-            } else {
-                 Serial.println("无效的 'log_level' 命令格式. 使用: log_level <0-5>");
-            }
-        } else if (cmd.equalsIgnoreCase("mem")) {
-            Serial.println("内存使用情况:");
-            Serial.printf(" - 总堆大小: %d\n", ESP.getHeapSize());
-            Serial.printf(" - 可用堆大小: %d\n", ESP.getFreeHeap());
-            Serial.printf(" - 最小剩余堆: %d\n", ESP.getMinFreeHeap());
-            Serial.printf(" - 最大分配块: %d\n", ESP.getMaxAllocHeap());
-        } else if (cmd.equalsIgnoreCase("tasks")) {
-            Serial.println("任务列表功能暂时不可用（vTaskList未启用）");
-        } else if (cmd.equalsIgnoreCase("layout")) {
-            keyboardConfig.printConfig();
-        } else if (cmd.equalsIgnoreCase("config")) {
-            keyboardConfig.printConfig();
+        uint8_t tapped = tapHold.interrupt();
+        if (tapped) {
+            dispatchKeyInput(tapped, false, esp_timer_get_time());
         }
-        else if (cmd.startsWith("sleep ")) {
-            if (cmd.endsWith("off")) {
-                SleepManager::instance().setTimeout(0);               // 关闭休眠
-                ConfigManager::getInstance().setSleepTimeout(0);
-                Serial.println("自动休眠已关闭并保存到配置");
-            } else {
-                int sec = cmd.substring(6).toInt();
-                if (sec > 0) {
-                    uint32_t timeout = sec * 1000;
-                    SleepManager::instance().setTimeout(timeout);
-                    ConfigManager::getInstance().setSleepTimeout(timeout);
-                    Serial.printf("自动休眠改为 %d 秒并保存到配置\n", sec);
-                }
-            }
-            SleepManager::instance().feed();   // 命令本身也算活动
+        const KeyConfig* keyConfig = keyboardConfig.getActiveKeyConfig(key);
+        if (keyConfig && keyConfig->holdMs) {
+            tapHold.press(key, keyConfig->holdMs, millis());
+            LoopScheduler::instance().at(tapHold.deadline());
+            return;
         }
-        else if (cmd.startsWith("test_feedback")) {
-            int key;
-            if (sscanf(cmd.c_str(), "test_feedback %d", &key) == 1) {
-                if (key >= 1 && key <= 22) {
-                    Serial.printf("测试按键 %d 反馈效果\n", key);
-                    // 模拟按键按下事件
-                    onKeyEvent(KEY_EVENT_PRESS, key, nullptr, 0);
-                    delay(100);
-                    onKeyEvent(KEY_EVENT_RELEASE, key, nullptr, 0);
-                } else {
-                    Serial.println("按键编号必须在 1-22 之间");
-                }
-            } else {
-                Serial.println("无效的 'test_feedback' 命令格式. 使用: test_feedback <key>");
-            }
+    } else if (type == KEY_EVENT_RELEASE) {
+        if (tapHold.release(key)) {
+            dispatchKeyInput(key, false, esp_timer_get_time());
         }
-        else if (cmd.startsWith("buzzer")) {
-            int freq, duration;
-            if (sscanf(cmd.c_str(), "buzzer %d %d", &freq, &duration) == 2) {
-                if (freq > 0 && duration > 0) {
-                    Serial.printf("测试蜂鸣器: %d Hz, %d ms\n", freq, duration);
-                    BuzzerConfig testConfig = {
-                        .enabled = true,
-                        .followKeypress = false,
-                        .dualTone = false,
-                        .volume = BUZZER_MEDIUM,
-                        .pressFreq = (uint16_t)freq,
-                        .releaseFreq = 0,
-                        .duration = (uint16_t)duration
-                    };
-                    keypad.configureBuzzer(testConfig);
-                    // 临时启用蜂鸣器，直接调用startBuzzer
-                    keypad.startBuzzer(freq, duration);
-                } else {
-                    Serial.println("频率和持续时间必须大于0");
-                }
-            } else {
-                Serial.println("无效的 'buzzer' 命令格式. 使用: buzzer <freq> <duration>");
-            }
+        return;
+    } else if ((type == KEY_EVENT_LONGPRESS || type == KEY_EVENT_REPEAT) && tapHold.owns(key)) {
+        return;
+    }
+    
+    // 按下、长按和自动重复时处理输入，重复按短按处理
+    if (type == KEY_EVENT_PRESS || type == KEY_EVENT_LONGPRESS || type == KEY_EVENT_REPEAT) {
+        dispatchKeyInput(key, type == KEY_EVENT_LONGPRESS, event.timestamp);
+    }
+}
+
+// 已注册的组合键（KeypadControl的组合事件，或待定的双功能键与之后按下的键）
+void runChord(uint8_t chord) {
+#if HID_PASSTHROUGH_ENABLED
+    // 直通期间除切换组合键外都不处理
+    if (chord == CHORD_PASSTHROUGH) {
+        setPassThrough(!keypad.isPassThrough());
+        return;
+    }
+    if (keypad.isPassThrough()) return;
+#endif
+    
+    // 布局方案组合键
+    if (chord >= CHORD_PROFILE_BASE && chord < CHORD_PROFILE_BASE + sizeof(PROFILE_CHORD_KEYS)) {
+        ALLOC_TAG("keyboard_config");
+        keyboardConfig.selectProfile(chord - CHORD_PROFILE_BASE);
+        if (calculator) calculator->updateDisplay();
+        return;
+    }
+    if (chord == CHORD_UNDO || chord == CHORD_REDO) {
+        if (calculator && keyboardConfig.getProfile().calculatorInput) {
+            if (chord == CHORD_UNDO) calculator->undo(); else calculator->redo();
         }
-        else if (cmd.startsWith("piano_mode")) {
-            if (cmd.endsWith("on")) {
-                keypad.setBuzzerMode(BUZZER_MODE_PIANO);
-                ConfigManager::getInstance().setBuzzerMode(1);
-                Serial.println("✅ 宽频音调模式已启用并保存到配置");
-                Serial.println("📊 频率范围: 500Hz-2500Hz (5倍频率差，高品质音调)");
-                Serial.println("🎵 每个按键将播放不同频率的音调，清晰易辨");
-            } else if (cmd.endsWith("off")) {
-                keypad.setBuzzerMode(BUZZER_MODE_NORMAL);
-                ConfigManager::getInstance().setBuzzerMode(0);
-                Serial.println("✅ 宽频音调模式已关闭并保存到配置 - 恢复普通蜂鸣器模式");
-            } else {
-                Serial.println("无效的 'piano_mode' 命令格式. 使用: piano_mode <on|off>");
+    }
+}
+
+#if HID_PASSTHROUGH_ENABLED
+// 扫描任务中调用：按键直接写入HID报告；休眠计时只设请求标志，由主循环重置
+static void passThroughSink(uint8_t key, bool pressed, int64_t timestamp, void* context) {
+    SimpleHID::passThroughEntry(key, pressed, timestamp, context);
+    if (pressed) {
+        SleepManager::instance().requestFeed();
+    }
+}
+
+void setPassThrough(bool enable) {
+    if (enable && !(simpleHID && simpleHID->canPassThrough())) {
+        LOG_W(TAG_MAIN, "HID未启用或没有发送任务，不能进入直通模式");
+        return;
+    }
+    if (!keypad.setPassThrough(enable ? passThroughSink : nullptr, simpleHID)) {
+        LOG_W(TAG_MAIN, "扫描任务未运行，不能进入直通模式");
+        return;
+    }
+    // 待定的双功能键丢弃：它的释放不会再回到主循环
+    tapHold.interrupt();
+    LOG_I(TAG_MAIN, "小键盘直通模式%s", enable ? "开启" : "关闭");
+    // 状态图标是直通期间唯一的绘制
+    if (display) {
+        display->setStatus(StatusBar::ITEM_HID, enable ? 2 : simpleHID->isConnected());
+    }
+}
+#endif
+
+void dispatchKeyInput(uint8_t key, bool isLongPress, int64_t timestamp) {
+    // 记录输入时刻，用于统计输入到上屏延迟（双功能键从判定时刻算起）
+    if (display) {
+        display->getPerformanceMonitor()->markInput(timestamp);
+    }
+    
+    // 长按"="：通过HID输入最近一次计算结果
+    if (isLongPress && simpleHID && simpleHID->isEnabled()) {
+        const KeyConfig* keyConfig = keyboardConfig.getActiveKeyConfig(key);
+        if (keyConfig && keyConfig->operation == Operator::EQUALS) {
+            if (!simpleHID->sendMacro("{RESULT}")) {
+                LOG_W(TAG_MAIN, "HID宏队列已满，计算结果未输入");
             }
+            return;
         }
-        else if (cmd.equalsIgnoreCase("piano_test")) {
-            Serial.println("🎹 播放宽频音阶测试 (500Hz-2500Hz)...");
-            Serial.println("📊 5倍频率范围，音调清晰易辨，适合蜂鸣器");
-            // 临时启用钢琴模式进行测试
-            keypad.setBuzzerMode(BUZZER_MODE_PIANO);
-            
-            // 播放22个音符
-            for (int i = 1; i <= 22; i++) {
-                if (i == 1) Serial.printf("播放按键 %d (500Hz 低音) ", i);
-                else if (i == 6) Serial.printf("播放按键 %d (733Hz 低中音) ", i);
-                else if (i == 11) Serial.printf("播放按键 %d (1074Hz 中音) ", i);
-                else if (i == 16) Serial.printf("播放按键 %d (1575Hz 高音) ", i);
-                else if (i == 22) Serial.printf("播放按键 %d (2500Hz 超高音) ", i);
-                else Serial.printf("播放按键 %d ", i);
-                
-                onKeyEvent(KEY_EVENT_PRESS, i, nullptr, 0);
-                delay(300);  // 增加间隔让音调差异更明显
-            }
-            
-            Serial.println("\n🎵 宽频音阶测试完成");
-            Serial.println("💡 使用 'piano_mode off' 恢复普通模式");
+    }
+    
+    if (calculator) {
+        ALLOC_TAG("calculator");
+        CalculatorState before = calculator->getState();
+        int64_t started = esp_timer_get_time();
+        calculator->handleKeyInput(key, isLongPress);
+        keyHandlingTime.record((uint32_t)(esp_timer_get_time() - started));
+        
+        // 进入错误状态时整排LED闪一下红色，叠加在按键反馈之上
+        if (before != CalculatorState::ERROR && calculator->getState() == CalculatorState::ERROR) {
+            calculatorErrors.add();
+            keypad.setLayerEffectAll(LED_LAYER_ERROR, LED_FADE, CRGB::Red);
         }
-        else if (cmd.equalsIgnoreCase("led_test")) {
-            Serial.println("测试所有LED...");
+    }
+}
+
+void simulateKeyEvent(KeyEventType type, uint8_t key) {
+    KeyEvent event = {};
+    event.type = type;
+    event.key = key;
+    event.timestamp = esp_timer_get_time();
+    onKeyEvent(event);
+}
+
+// 串口命令（其余命令由各模块在初始化时注册）
+static void cmdBoot(const ConsoleArgs& args) {
+    BootProfiler::print(Serial);
+}
+
+static void cmdBrightness(const ConsoleArgs& args) {
+    int brightness;
+    if (!args.toInt(1, brightness)) {
+        Serial.println("无效的 'brightness' 命令格式. 使用: brightness <0-255>");
+    } else if (brightness >= 0 && brightness <= 255) {
+        ConfigManager::getInstance().setLEDBrightness(brightness);     // 由applyKeypadConfig生效
+        Serial.printf("LED亮度已设置为 %d 并保存到配置\n", brightness);
+    } else {
+        Serial.println("亮度值必须在 0-255 之间");
+    }
+}
+
+static void cmdBuzzer(const ConsoleArgs& args) {
+    int freq, duration;
+    if (!args.toInt(1, freq) || !args.toInt(2, duration)) {
+        Serial.println("无效的 'buzzer' 命令格式. 使用: buzzer <freq> <duration>");
+    } else if (freq > 0 && duration > 0) {
+        Serial.printf("测试蜂鸣器: %d Hz, %d ms\n", freq, duration);
+        BuzzerConfig testConfig = {
+            .enabled = true,
+            .followKeypress = false,
+            .dualTone = false,
+            .volume = BUZZER_MEDIUM,
+            .pressFreq = (uint16_t)freq,
+            .releaseFreq = 0,
+            .duration = (uint16_t)duration
+        };
+        keypad.configureBuzzer(testConfig);
+        // 临时启用蜂鸣器，直接调用startBuzzer；占空比已算好，随即恢复配置中的蜂鸣器设置
+        keypad.startBuzzer(freq, duration);
+        applyKeypadConfig(CONFIG_BUZZER_FIELDS, ConfigManager::getInstance().getConfig(), nullptr);
+    } else {
+        Serial.println("频率和持续时间必须大于0");
+    }
+}
+
+static void cmdHidEnable(const ConsoleArgs& args) {
+    if (!simpleHID) {
+        Serial.println("HID功能未初始化");
+    } else if (args.is(1, "on")) {
+        simpleHID->setEnabled(true);
+        Serial.println("✅ HID功能已启用");
+    } else if (args.is(1, "off")) {
+        simpleHID->setEnabled(false);
+        Serial.println("✅ HID功能已禁用");
+    } else {
+        Serial.println("无效参数。使用: hid_enable on 或 hid_enable off");
+    }
+}
+
+static void cmdHistory(const ConsoleArgs& args) {
+    if (args.is(1, "clear")) {
+        if (calculator) calculator->clearHistory();
+#if HISTORY_LOG_ENABLED
+        HistoryLog::instance().erase();
+#endif
+        Serial.println("✅ 历史记录已清除");
+        return;
+    }
+    if (!calculator) {
+        Serial.println("计算器未初始化");
+        return;
+    }
+
+    // 按序号随机访问，可以直接翻到很早的记录
+    int count = 10;
+    int start = 0;
+    args.toInt(1, count);
+    args.toInt(2, start);
+    const HistoryBuffer &history = calculator->getHistory();
+    Serial.printf("历史记录: %u/%u 条%s\n", (unsigned)history.size(), (unsigned)history.capacity(),
+                  history.hasArchive() ? "（PSRAM归档）" : "");
+    char line[128];
+    for (int i = start; i < start + count && i < (int)history.size(); i++) {
+        HistoryBuffer::format(*history.get(i), line, sizeof(line));
+        Serial.printf("  #%d %s\n", i, line);
+    }
+}
+
+static void cmdKeyStats(const ConsoleArgs& args) {
+    if (args.is(1, "reset")) {
+        keypad.resetKeyStats();
+        syncKeyStats();
+        Serial.println("✅ 按键统计已清空");
+        return;
+    }
+    KeyStatsData stats;
+    keypad.getKeyStats(stats);
+    KeyStats::print(stats, Serial);
+}
+
+static void cmdLed(const ConsoleArgs& args) {
+    int index, r, g, b;
+    if (args.is(1, "all")) {
+        if (args.toInt(2, r) && args.toInt(3, g) && args.toInt(4, b)) {
             for (int i = 0; i < NUM_LEDS; i++) {
-                leds[i] = CRGB::Red;
-                FastLED.show();
-                delay(100);
-                leds[i] = CRGB::Black;
-                FastLED.show();
-                delay(50);
+                leds[i].setRGB(r, g, b);
             }
-            Serial.println("LED测试完成");
+            FastLED.show();
+            Serial.println("所有LED已更新");
+        } else {
+            Serial.println("无效的 'led all' 命令格式. 使用: led all <r> <g> <b>");
         }
-        else if (cmd.equalsIgnoreCase("save_config")) {
-            Serial.println("手动保存配置...");
-            if (ConfigManager::getInstance().save()) {
-                Serial.println("✅ 配置保存成功");
-            } else {
-                Serial.println("❌ 配置保存失败");
-            }
+    } else if (args.is(1, "off")) {
+        FastLED.clear();
+        FastLED.show();
+        Serial.println("所有LED已关闭");
+    } else if (args.toInt(1, index) && args.toInt(2, r) && args.toInt(3, g) && args.toInt(4, b)) {
+        if (index >= 0 && index < NUM_LEDS) {
+            leds[index].setRGB(r, g, b);
+            FastLED.show();
+            Serial.printf("LED %d 已更新\n", index);
+        } else {
+            Serial.println("无效的LED索引");
         }
-        else if (cmd.equalsIgnoreCase("load_config")) {
-            Serial.println("重新加载配置...");
-            if (ConfigManager::getInstance().load()) {
-                Serial.println("✅ 配置加载成功");
-                Serial.println("请注意：部分配置需要重启才能生效");
+    } else {
+        Serial.println("无效的 'led' 命令格式. 使用: led <index> <r> <g> <b>");
+    }
+}
+
+// 逐个点亮，步骤之间让出主循环（CoRunner.h）
+static uint32_t ledTestTask(CoTask& task) {
+    CO_BEGIN(task);
+    for (task.i = 0; task.i < NUM_LEDS && !task.cancelled; task.i++) {
+        leds[task.i] = CRGB::Red;
+        FastLED.show();
+        CO_SLEEP(task, 100);
+        leds[task.i] = CRGB::Black;
+        FastLED.show();
+        CO_SLEEP(task, 50);
+    }
+    Serial.println(task.cancelled ? "LED测试已停止" : "LED测试完成");
+    CO_END(task);
+}
+
+static void cmdLedTest(const ConsoleArgs& args) {
+    if (CoRunner::instance().spawn("led_test", ledTestTask)) {
+        Serial.println("测试所有LED...（jobs stop 停止）");
+    } else {
+        Serial.println("LED测试已在运行或协程已满");
+    }
+}
+
+// 面板规模的像素数，比较逐像素循环与lib8tion批量实现（scale8_bulk.h）
+#define BLEND_BENCH_PIXELS 256
+#define BLEND_BENCH_RUNS 8
+
+static CRGB benchSrc[BLEND_BENCH_PIXELS], benchOverlay[BLEND_BENCH_PIXELS];
+static CRGB benchRef[BLEND_BENCH_PIXELS], benchOut[BLEND_BENCH_PIXELS];
+
+// 多次运行取最少周期数；每次运行前恢复输入，复制不计入
+template <typename Kernel>
+static uint32_t benchCycles(CRGB* out, Kernel kernel) {
+    uint32_t best = UINT32_MAX;
+    for (uint8_t run = 0; run < BLEND_BENCH_RUNS; run++) {
+        memcpy(out, benchSrc, sizeof(benchSrc));
+        uint32_t start = ESP.getCycleCount();
+        kernel();
+        uint32_t cycles = ESP.getCycleCount() - start;
+        if (cycles < best) best = cycles;
+    }
+    return best;
+}
+
+static void printBench(const char* name, uint32_t portable, uint32_t bulk) {
+    bool same = memcmp(benchRef, benchOut, sizeof(benchOut)) == 0;
+    Serial.printf(" - %-14s 逐像素 %6u 周期  批量 %6u 周期  %.2fx  %s\n", name, portable, bulk,
+                  bulk ? (float)portable / bulk : 0.0f, same ? "结果一致" : "❌ 结果不一致");
+}
+
+static void cmdBlendBench(const ConsoleArgs& args) {
+    int amount = 96;
+    if (args.count > 1 && (!args.toInt(1, amount) || amount < 0 || amount > 255)) {
+        Serial.println("无效的 'blend_bench' 命令格式. 使用: blend_bench [0-255]");
+        return;
+    }
+    for (uint16_t i = 0; i < BLEND_BENCH_PIXELS; i++) {
+        benchSrc[i] = CRGB(random8(), random8(), random8());
+        benchOverlay[i] = CRGB(random8(), random8(), random8());
+    }
+    uint8_t scale = amount;
+    const uint32_t bytes = BLEND_BENCH_PIXELS * 3;
+    Serial.printf("颜色运算基准（%d像素，系数%d，CPU %u MHz）:\n", BLEND_BENCH_PIXELS, scale,
+                  getCpuFrequencyMhz());
+
+    uint32_t portable = benchCycles(benchRef, [&] {
+        for (uint16_t i = 0; i < BLEND_BENCH_PIXELS; i++) benchRef[i].nscale8(scale);
+    });
+    uint32_t bulk = benchCycles(benchOut, [&] { scale8_bulk(benchOut->raw, bytes, scale); });
+    printBench("nscale8", portable, bulk);
+
+    portable = benchCycles(benchRef, [&] {
+        for (uint16_t i = 0; i < BLEND_BENCH_PIXELS; i++) benchRef[i].nscale8_video(scale);
+    });
+    bulk = benchCycles(benchOut, [&] { scale8_video_bulk(benchOut->raw, bytes, scale); });
+    printBench("nscale8_video", portable, bulk);
+
+    portable = benchCycles(benchRef, [&] {
+        for (uint16_t i = 0; i < BLEND_BENCH_PIXELS; i++) nblend(benchRef[i], benchOverlay[i], scale);
+    });
+    bulk = benchCycles(benchOut, [&] {
+        blend8_bulk(benchOut->raw, benchOverlay->raw, benchOut->raw, bytes, scale);
+    });
+    printBench("nblend", portable, bulk);
+
+    Serial.printf("FASTLED_SCALE8_BULK=%d（为1时nscale8/fadeToBlackBy/nblend/blend数组版本使用批量实现）\n",
+                  FASTLED_SCALE8_BULK);
+}
+
+// 关键路径微基准：每项多次运行，报告最少和平均CPU周期数（ESP.getCycleCount）
+// 运行期间不要按键：刷新和推送与显示渲染任务共用屏幕
+// bench json 每个结果输出一行JSON，tools/bench_check.py 与 tools/bench_baseline.json 比较
+#define BENCH_RUNS 16
+
+struct BenchStats {
+    uint32_t best;
+    uint32_t total;
+    uint8_t runs;
+};
+
+static volatile uint32_t benchSink;     // 保存结果，避免被优化掉
+static bool benchJson;                  // 输出JSON行而不是表格
+static const char* benchItem = "";      // 正在运行的基准项（JSON行的item）
+
+template <typename Fn>
+static BenchStats measureCycles(uint8_t runs, Fn fn) {
+    BenchStats stats = {UINT32_MAX, 0, runs};
+    for (uint8_t run = 0; run < runs; run++) {
+        uint32_t start = ESP.getCycleCount();
+        fn();
+        uint32_t cycles = ESP.getCycleCount() - start;
+        if (cycles < stats.best) stats.best = cycles;
+        stats.total += cycles;
+    }
+    return stats;
+}
+
+static void printCycles(const char* name, const BenchStats& stats) {
+    if (benchJson) {
+        Serial.printf("{\"item\":\"%s\",\"name\":\"%s\",\"best\":%u,\"avg\":%u}\n", benchItem, name,
+                      stats.best, stats.total / stats.runs);
+        return;
+    }
+    Serial.printf(" - %-18s 最少 %9u 周期  平均 %9u 周期  (%.1f us)\n", name, stats.best,
+                  stats.total / stats.runs, (float)stats.best / getCpuFrequencyMhz());
+}
+
+// 无法运行的项：JSON模式下也输出一行，比较时按缺失处理
+static void printSkipped(const char* name, const char* reason) {
+    if (benchJson) {
+        Serial.printf("{\"item\":\"%s\",\"name\":\"%s\",\"skipped\":true}\n", benchItem, name);
+        return;
+    }
+    Serial.printf(" - %-18s %s，跳过\n", name, reason);
+}
+
+static void benchScan() {
+    BenchStats read = {UINT32_MAX, 0, BENCH_RUNS};
+    BenchStats check = {UINT32_MAX, 0, BENCH_RUNS};
+    for (uint8_t run = 0; run < BENCH_RUNS; run++) {
+        uint32_t readCycles, checkCycles;
+        keypad.measureScan(readCycles, checkCycles);
+        if (readCycles < read.best) read.best = readCycles;
+        if (checkCycles < check.best) check.best = checkCycles;
+        read.total += readCycles;
+        check.total += checkCycles;
+    }
+    printCycles("readShiftRegisters", read);
+    printCycles("checkKeyStates", check);
+}
+
+static void benchFormat() {
+    printCycles("format", measureCycles(BENCH_RUNS, [] {
+        benchSink += NumberFormatter::format(-12345.678).length();
+    }));
+    char buf[NumberFormatter::BUFFER_SIZE];
+    printCycles("formatTo", measureCycles(BENCH_RUNS, [&] {
+        benchSink += NumberFormatter::formatTo(-12345.678, buf, sizeof(buf));
+    }));
+}
+
+static void benchCalculate() {
+    CalculationEngine engine;
+    printCycles("calculate", measureCycles(BENCH_RUNS, [&] {
+        benchSink += engine.calculate(1234.5, 6.789, Operator::DIVIDE).isValid;
+    }));
+}
+
+// 科学函数：在测试区间内均匀取点，报告最少和最多周期数（固定开销实现的最坏情况应接近最少）
+#define MATH_BENCH_POINTS 64
+
+static void benchMathFunction(const char* name, double (*fn)(double), const FastMath::Function& range) {
+    uint32_t best = UINT32_MAX, worst = 0;
+    for (uint8_t i = 0; i < MATH_BENCH_POINTS; i++) {
+        double u = (i + 0.5) / MATH_BENCH_POINTS;
+        double x = range.logScale ? ::exp(::log(range.lo) + u * (::log(range.hi) - ::log(range.lo)))
+                                  : range.lo + u * (range.hi - range.lo);
+        volatile double result;
+        uint32_t start = ESP.getCycleCount();
+        result = fn(x);
+        uint32_t cycles = ESP.getCycleCount() - start;
+        (void)result;
+        if (cycles < best) best = cycles;
+        if (cycles > worst) worst = cycles;
+    }
+    if (benchJson) {
+        Serial.printf("{\"item\":\"%s\",\"name\":\"%s\",\"best\":%u,\"worst\":%u}\n", benchItem, name,
+                      best, worst);
+        return;
+    }
+    Serial.printf(" - %-18s 最少 %9u 周期  最多 %9u 周期\n", name, best, worst);
+}
+
+static void benchMath() {
+    char name[24];
+    for (uint8_t i = 0; i < FastMath::FUNCTION_COUNT; i++) {
+        const FastMath::Function& fn = FastMath::FUNCTIONS[i];
+        benchMathFunction(fn.name, fn.fn, fn);
+        snprintf(name, sizeof(name), "%s (libm)", fn.name);
+        benchMathFunction(name, fn.reference, fn);
+    }
+    printCycles("pow(1.0001, 2.5)", measureCycles(BENCH_RUNS, [] {
+        benchSink += (uint32_t)FastMath::pow(1.0001, 2.5);
+    }));
+}
+
+static void benchRefresh() {
+    if (!display) {
+        printSkipped("refresh", "显示未初始化");
+        return;
+    }
+    // 整屏重绘当前内容，画面不变；渲染任务模式下只计发布快照
+    printCycles("refresh", measureCycles(BENCH_RUNS, [] {
+        display->invalidateAll();
+        display->refresh();
+    }));
+}
+
+static void benchFlush() {
+    if (!canvas) {
+        printSkipped("canvas->flush", "Canvas未启用");
+        return;
+    }
+    // 双缓冲模式下等待推送任务发送完成，统计的是整帧上屏时间
+    printCycles("canvas->flush", measureCycles(BENCH_RUNS, [] {
+        canvas->flush();
+        canvas->waitFlush();
+    }));
+}
+
+static void benchLedShow() {
+    // 等推送任务空闲再直接推送，结束后让LedOutput按当前帧重推一次（副本已经由引擎事件作废）
+    LedOutput& output = LedOutput::instance();
+    for (uint8_t i = 0; i < 10 && !output.isIdle(); i++) {
+        delay(LED_FRAME_MS);
+    }
+    printCycles("FastLED.show", measureCycles(BENCH_RUNS, [] { FastLED.show(); }));
+    output.requestShow();
+}
+
+static void benchLog() {
+    printCycles("LOG_I", measureCycles(4, [] { LOG_I(TAG_MAIN, "基准测试日志 %u", benchSink); }));
+}
+
+// 跨核队列：另一个核心上的任务连续入队，主循环出队并检查顺序，报告每条的周期数（含创建生产者任务）
+#define QUEUE_BENCH_ITEMS 8192
+#define QUEUE_BENCH_RUNS 4
+
+struct QueueBench {
+    SpscQueue<uint32_t, 64>* ring;      // nullptr时用FreeRTOS队列
+    QueueHandle_t queue;
+};
+
+static SpscQueue<uint32_t, 64> benchRing;
+
+static void queueBenchProducer(void* arg) {
+    QueueBench* bench = static_cast<QueueBench*>(arg);
+    for (uint32_t i = 0; i < QUEUE_BENCH_ITEMS; i++) {
+        if (bench->ring) {
+            while (!bench->ring->push(i)) {}
+        } else {
+            xQueueSend(bench->queue, &i, portMAX_DELAY);
+        }
+    }
+    vTaskDelete(nullptr);
+}
+
+static void measureQueue(const char* name, QueueBench& bench) {
+    BenchStats stats = {UINT32_MAX, 0, QUEUE_BENCH_RUNS};
+    uint32_t errors = 0;
+    for (uint8_t run = 0; run < QUEUE_BENCH_RUNS; run++) {
+        uint32_t start = ESP.getCycleCount();
+        xTaskCreatePinnedToCore(queueBenchProducer, "benchQueue", 2048, &bench, 1, nullptr, 1 - xPortGetCoreID());
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < QUEUE_BENCH_ITEMS; i++) {
+            if (bench.ring) {
+                while (!bench.ring->pop(value)) {}
             } else {
-                Serial.println("❌ 配置加载失败");
+                xQueueReceive(bench.queue, &value, portMAX_DELAY);
             }
+            if (value != i) errors++;
         }
-        else if (cmd.equalsIgnoreCase("reset_config")) {
-            Serial.println("重置配置为默认值...");
-            ConfigManager::getInstance().reset();
-            Serial.println("✅ 配置已重置为默认值");
-            Serial.println("请注意：部分配置需要重启才能生效");
-        }
-        else if (cmd.equalsIgnoreCase("show_config")) {
-            ConfigManager::getInstance().printConfig();
+        uint32_t cycles = (ESP.getCycleCount() - start) / QUEUE_BENCH_ITEMS;
+        if (cycles < stats.best) stats.best = cycles;
+        stats.total += cycles;
+    }
+    printCycles(name, stats);
+    if (errors && !benchJson) {
+        Serial.printf("   ⚠️ %s 顺序错误 %lu 次\n", name, (unsigned long)errors);
+    }
+}
+
+static void benchSpsc() {
+    QueueBench bench = {&benchRing, nullptr};
+    measureQueue("SpscQueue 跨核", bench);
+    bench.ring = nullptr;
+    bench.queue = xQueueCreate(64, sizeof(uint32_t));
+    if (!bench.queue) {
+        printSkipped("xQueue 跨核", "队列创建失败");
+        return;
+    }
+    measureQueue("xQueue 跨核", bench);
+    vQueueDelete(bench.queue);
+}
+
+// 结果行：整屏宽 × 结果行字高
+#define BENCH_RESULT_ROW_PIXELS ((size_t)DISPLAY_WIDTH * 64)
+#define BENCH_CANVAS_PIXELS     ((size_t)DISPLAY_WIDTH * DISPLAY_HEIGHT)
+
+static void benchPixels() {
+    // 与帧缓冲相同的位置，测得的带宽与实际清屏/回写一致；不动正在显示的Canvas
+    uint16_t* frame = (uint16_t*)placedAlloc("bench_pixels", BENCH_CANVAS_PIXELS * 2, DISPLAY_FRAMEBUFFER_PLACE);
+    uint16_t* row = (uint16_t*)placedAlloc("bench_pixels", BENCH_RESULT_ROW_PIXELS * 2, DISPLAY_FRAMEBUFFER_PLACE);
+    if (!frame || !row) {
+        printSkipped("pixels", "缓冲分配失败");
+        placedFree(frame);
+        placedFree(row);
+        return;
+    }
+
+    // 逐像素标量循环为Arduino_Canvas原来的写法
+    printCycles("fillScreen 标量", measureCycles(BENCH_RUNS, [&] {
+        for (size_t i = 0; i < BENCH_CANVAS_PIXELS; i++) frame[i] = (uint16_t)benchSink;
+    }));
+    printCycles("fillScreen 128位", measureCycles(BENCH_RUNS, [&] {
+        pixelFill(frame, BENCH_CANVAS_PIXELS, (uint16_t)benchSink);
+    }));
+    printCycles("清结果行 标量", measureCycles(BENCH_RUNS, [&] {
+        for (size_t i = 0; i < BENCH_RESULT_ROW_PIXELS; i++) frame[i] = (uint16_t)benchSink;
+    }));
+    printCycles("清结果行 128位", measureCycles(BENCH_RUNS, [&] {
+        pixelFill(frame, BENCH_RESULT_ROW_PIXELS, (uint16_t)benchSink);
+    }));
+    printCycles("复制结果行 memcpy", measureCycles(BENCH_RUNS, [&] {
+        memcpy(row, frame, BENCH_RESULT_ROW_PIXELS * 2);
+    }));
+    printCycles("复制结果行 128位", measureCycles(BENCH_RUNS, [&] {
+        pixelCopy(row, frame, BENCH_RESULT_ROW_PIXELS);
+    }));
+    printCycles("交换字节 标量", measureCycles(BENCH_RUNS, [&] {
+        for (size_t i = 0; i < BENCH_RESULT_ROW_PIXELS; i++) row[i] = (uint16_t)((frame[i] << 8) | (frame[i] >> 8));
+    }));
+    printCycles("交换字节 32位", measureCycles(BENCH_RUNS, [&] {
+        pixelCopySwap(row, frame, BENCH_RESULT_ROW_PIXELS);
+    }));
+
+    placedFree(row);
+    placedFree(frame);
+}
+
+// 旋转开销：Canvas自身旋转时每个像素都要变换坐标；面板的旋转在MADCTL中，推送是地址窗口加一段DMA
+static void benchRotation() {
+    if (!canvas || canvas->isPaletted()) {
+        printSkipped("rotate", "Canvas未启用或为调色板模式");
+        return;
+    }
+    // 单独一块结果行大小的Canvas，位置与帧缓冲相同；不动正在显示的内容
+    const int16_t w = DISPLAY_WIDTH;
+    const int16_t h = 64;
+    RegionCanvas band(w, h, static_cast<Arduino_TFT *>(gfx), bus);
+    if (!band.begin(GFX_SKIP_OUTPUT_BEGIN) || !band.getFramebuffer()) {
+        printSkipped("rotate", "缓冲分配失败");
+        return;
+    }
+    uint16_t* fb = band.getFramebuffer();
+
+    printCycles("画点 直接写", measureCycles(BENCH_RUNS, [&] {
+        for (int16_t y = 0; y < h; y++) {
+            for (int16_t x = 0; x < w; x++) fb[(int32_t)y * w + x] = (uint16_t)benchSink;
         }
-        else if (cmd.equalsIgnoreCase("config_info")) {
-            Serial.println("配置系统信息:");
-            Serial.printf("配置结构体大小: %d 字节\n", ConfigManager::getInstance().getConfigSize());
-            Serial.printf("配置已初始化: %s\n", ConfigManager::getInstance().isInitialized() ? "是" : "否");
-            Serial.printf("配置有更改: %s\n", ConfigManager::getInstance().isDirty() ? "是" : "否");
-            Serial.printf("自动保存: %s\n", ConfigManager::getInstance().getAutoSave() ? "开启" : "关闭");
+    }));
+    printCycles("画点 Canvas分支", measureCycles(BENCH_RUNS, [&] {
+        for (int16_t y = 0; y < h; y++) {
+            for (int16_t x = 0; x < w; x++) band.Arduino_Canvas::writePixelPreclipped(x, y, (uint16_t)benchSink);
         }
-        else if (cmd.startsWith("auto_save")) {
-            if (cmd.endsWith("on")) {
-                ConfigManager::getInstance().setAutoSave(true);
-                Serial.println("✅ 自动保存已开启");
-            } else if (cmd.endsWith("off")) {
-                ConfigManager::getInstance().setAutoSave(false);
-                Serial.println("✅ 自动保存已关闭");
-            } else {
-                Serial.println("无效的 'auto_save' 命令格式. 使用: auto_save <on|off>");
+    }));
+    static const uint8_t ROTATIONS[] = {0, 2};
+    static const char* const PIXEL_NAMES[] = {"画点 旋转0", "画点 旋转2"};
+    static const char* const FILL_NAMES[] = {"填充 旋转0", "填充 旋转2"};
+    static const char* const TEXT_NAMES[] = {"文字 旋转0", "文字 旋转2"};
+    for (uint8_t i = 0; i < sizeof(ROTATIONS); i++) {
+        band.setRotation(ROTATIONS[i]);
+        printCycles(PIXEL_NAMES[i], measureCycles(BENCH_RUNS, [&] {
+            for (int16_t y = 0; y < h; y++) {
+                for (int16_t x = 0; x < w; x++) band.writePixel(x, y, (uint16_t)benchSink);
             }
+        }));
+        printCycles(FILL_NAMES[i], measureCycles(BENCH_RUNS, [&] {
+            band.fillRect(0, 0, w, h, (uint16_t)benchSink);
+        }));
+        printCycles(TEXT_NAMES[i], measureCycles(BENCH_RUNS, [&] {
+            band.setTextSize(4);
+            band.setCursor(0, 16);
+            band.print("-12345.678");
+        }));
+    }
+
+    // 推送：Canvas的整帧推送与直接把帧缓冲交给总线比较，两者之差是推送路径的额外开销
+    canvas->waitFlush();
+    printCycles("推送 Canvas", measureCycles(BENCH_RUNS, [] {
+        canvas->flush();
+        canvas->waitFlush();
+    }));
+    printCycles("推送 直接DMA", measureCycles(BENCH_RUNS, [] {
+        Arduino_TFT* panel = static_cast<Arduino_TFT *>(gfx);
+        panel->startWrite();
+        panel->writeAddrWindow(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        bus->writePixels(canvas->getFramebuffer(), (uint32_t)DISPLAY_WIDTH * DISPLAY_HEIGHT);
+        panel->endWrite();
+    }));
+}
+
+struct BenchItem {
+    const char* name;
+    void (*run)();
+};
+
+static const BenchItem BENCH_ITEMS[] = {
+    {"scan", benchScan},
+    {"format", benchFormat},
+    {"calculate", benchCalculate},
+    {"math", benchMath},
+    {"refresh", benchRefresh},
+    {"flush", benchFlush},
+    {"pixels", benchPixels},
+    {"rotate", benchRotation},
+    {"led", benchLedShow},
+    {"log", benchLog},
+    {"spsc", benchSpsc},
+};
+
+static void cmdBench(const ConsoleArgs& args) {
+    const BenchItem* only = nullptr;
+    uint8_t itemArg = 1;
+    benchJson = args.is(1, "json");
+    if (benchJson) itemArg++;
+    if (args.count > itemArg) {
+        for (const BenchItem& item : BENCH_ITEMS) {
+            if (args.is(itemArg, item.name)) only = &item;
         }
-        else if (cmd.equalsIgnoreCase("hid_status")) {
-            Serial.println("=== 简单HID系统状态 ===");
-            if (simpleHID) {
-                Serial.printf(" - HID功能: %s\n", simpleHID->isEnabled() ? "已启用" : "已禁用");
-                Serial.printf(" - USB连接: %s\n", simpleHID->isConnected() ? "已连接" : "未连接");
-                Serial.printf(" - 功能模式: 并行模式（计算器+HID键盘同时生效）\n");
-                Serial.printf(" - GPIO19 (USB_DN): 自动配置为USB D-信号\n");
-                Serial.printf(" - GPIO20 (USB_DP): 自动配置为USB D+信号\n");
-                simpleHID->printDebugInfo();
-            } else {
-                Serial.println(" - HID功能: 未初始化");
-            }
+        if (!only) {
+            Serial.print("未知的基准项. 可选:");
+            for (const BenchItem& item : BENCH_ITEMS) Serial.printf(" %s", item.name);
+            Serial.println();
+            return;
         }
-        else if (cmd.startsWith("hid_test")) {
-            if (simpleHID && simpleHID->isEnabled()) {
-                int key;
-                if (sscanf(cmd.c_str(), "hid_test %d", &key) == 1) {
-                    if (key >= 1 && key <= 22) {
-                        Serial.printf("测试HID按键 %d 发送\n", key);
-                        // 模拟按键按下和释放
-                        simpleHID->handleKey(key, true);   // 按下
-                        delay(100);
-                        simpleHID->handleKey(key, false);  // 释放
-                        Serial.println("HID按键测试完成");
-                    } else {
-                        Serial.println("按键编号必须在 1-22 之间");
-                    }
-                } else {
-                    Serial.println("无效的 'hid_test' 命令格式. 使用: hid_test <key>");
-                }
-            } else {
-                Serial.println("HID功能未启用或未初始化");
-            }
+    }
+
+    // 测量期间固定最高频率，等待外设时的周期数和换算的时间才与调频无关
+    activeLock.acquire();
+    if (benchJson) {
+        Serial.printf("{\"bench\":\"start\",\"runs\":%d,\"mhz\":%u}\n", BENCH_RUNS, getCpuFrequencyMhz());
+    } else {
+        Serial.printf("关键路径基准（每项%d次，CPU %u MHz）:\n", BENCH_RUNS, getCpuFrequencyMhz());
+    }
+    for (const BenchItem& item : BENCH_ITEMS) {
+        if (only && only != &item) continue;
+        benchItem = item.name;
+        item.run();
+    }
+    if (benchJson) Serial.println("{\"bench\":\"end\"}");
+    activeLock.release();
+}
+
+static void printHeapInfo(const char* name, uint32_t caps) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, caps);
+    size_t total = info.total_free_bytes + info.total_allocated_bytes;
+    if (total == 0) return;
+    // 碎片率：可用空间中不能一次分配出去的比例
+    uint32_t fragmentation = info.total_free_bytes ?
+        100 - (uint32_t)((uint64_t)info.largest_free_block * 100 / info.total_free_bytes) : 0;
+    Serial.printf(" - %s: 可用 %u / %u, 最小剩余 %u, 最大块 %u, 碎片率 %lu%%, 已分配 %u 块, 空闲 %u 块\n",
+                  name, (unsigned)info.total_free_bytes, (unsigned)total, (unsigned)info.minimum_free_bytes,
+                  (unsigned)info.largest_free_block, (unsigned long)fragmentation,
+                  (unsigned)info.allocated_blocks, (unsigned)info.free_blocks);
+}
+
+static void cmdMem(const ConsoleArgs& args) {
+    Serial.println("内存使用情况:");
+    Serial.printf(" - 总堆大小: %d\n", ESP.getHeapSize());
+    Serial.printf(" - 可用堆大小: %d\n", ESP.getFreeHeap());
+    Serial.printf(" - 最小剩余堆: %d\n", ESP.getMinFreeHeap());
+    Serial.printf(" - 最大分配块: %d\n", ESP.getMaxAllocHeap());
+    printHeapInfo("内部RAM", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    printHeapInfo("PSRAM", MALLOC_CAP_SPIRAM);
+    Serial.println(" - 大块缓冲:");
+    printPlacements(Serial);
+    ScratchArena& scratch = ScratchArena::keyEvent();
+    Serial.printf(" - 按键临时内存: 最大占用 %u / %u, 空间不足 %lu 次\n", (unsigned)scratch.highWater(),
+                  (unsigned)scratch.capacity(), (unsigned long)scratch.failures());
+}
+
+static void cmdPerf(const ConsoleArgs& args) {
+    if (!display) {
+        Serial.println("显示未初始化");
+    } else if (args.is(1, "reset")) {
+        display->getPerformanceMonitor()->reset();
+        Serial.println("✅ 性能统计已清空");
+    } else {
+        display->getPerformanceMonitor()->printReport();
+    }
+}
+
+static void cmdPianoMode(const ConsoleArgs& args) {
+    if (args.is(1, "on")) {
+        ConfigManager::getInstance().setBuzzerMode(BUZZER_MODE_PIANO);
+        Serial.println("✅ 宽频音调模式已启用并保存到配置");
+        Serial.println("📊 频率范围: 500Hz-2500Hz (5倍频率差，高品质音调)");
+        Serial.println("🎵 每个按键将播放不同频率的音调，清晰易辨");
+    } else if (args.is(1, "off")) {
+        ConfigManager::getInstance().setBuzzerMode(BUZZER_MODE_NORMAL);
+        Serial.println("✅ 宽频音调模式已关闭并保存到配置 - 恢复普通蜂鸣器模式");
+    } else {
+        Serial.println("无效的 'piano_mode' 命令格式. 使用: piano_mode <on|off>");
+    }
+}
+
+static void cmdPianoTest(const ConsoleArgs& args) {
+    Serial.println("🎹 播放宽频音阶测试 (500Hz-2500Hz)...");
+    Serial.println("📊 5倍频率范围，音调清晰易辨，适合蜂鸣器");
+    // 22个音符进入蜂鸣器队列后立即返回，播放期间按键和显示照常处理
+    keypad.playPianoScale(200, 100);
+    Serial.println("🎵 已开始播放22个音符（约6.6秒）");
+    Serial.println("💡 使用 'piano_mode on' 让按键音使用同一音阶");
+}
+
+static void cmdTone(const ConsoleArgs& args) {
+    if (args.is(1, "confirm")) {
+        keypad.playTone(BUZZER_TONE_CONFIRM);
+    } else if (args.is(1, "error")) {
+        keypad.playTone(BUZZER_TONE_ERROR);
+    } else if (args.is(1, "stop")) {
+        keypad.stopBuzzer();
+    } else {
+        Serial.println("无效的 'tone' 命令格式. 使用: tone <confirm|error|stop>");
+    }
+}
+
+static void cmdVolume(const ConsoleArgs& args) {
+    int volume;
+    if (!args.toInt(1, volume)) {
+        Serial.println("无效的 'volume' 命令格式. 使用: volume <0-100>");
+    } else if (volume >= 0 && volume <= BUZZER_MAX) {
+        ConfigManager::getInstance().setBuzzerVolume(volume);
+        Serial.printf("蜂鸣器音量已设置为 %d 并保存到配置\n", volume);
+        keypad.playTone(BUZZER_TONE_CONFIRM);
+    } else {
+        Serial.println("音量必须在 0-100 之间");
+    }
+}
+
+static void cmdReboot(const ConsoleArgs& args) {
+    Serial.println("正在重启...");
+    Serial.flush();     // 发送缓冲中的输出在重启前发完
+    ESP.restart();
+}
+
+static void cmdStatus(const ConsoleArgs& args) {
+    Serial.println("系统状态:");
+    Serial.printf(" - 可用堆内存: %d 字节\n", ESP.getFreeHeap());
+    Serial.printf(" - CPU 频率: %d MHz\n", getCpuFrequencyMhz());
+    if (PowerManager::instance().isEnabled()) {
+        Serial.printf(" - 动态调频: %d-%d MHz, 自动浅睡眠%s\n", PowerManager::instance().getMinFreqMhz(),
+                      PowerManager::instance().getMaxFreqMhz(),
+                      PowerManager::instance().isLightSleepEnabled() ? "开" : "关");
+    }
+    Serial.printf(" - 运行时间: %lu 毫秒\n", millis());
+    Serial.printf(" - 主循环唤醒: 事件 %lu 次, 定时 %lu 次, 不等待 %lu 次\n",
+                  (unsigned long)LoopScheduler::instance().getEventWakeups(),
+                  (unsigned long)LoopScheduler::instance().getTimedWakeups(),
+                  (unsigned long)LoopScheduler::instance().getImmediateRuns());
+    Serial.printf(" - 日志输出: %s, 已丢弃 %lu 条\n", Logger::getInstance().isAsync() ? "异步" : "同步",
+                  (unsigned long)Logger::getInstance().getDroppedCount());
+    if (LogFileSink::instance().isReady()) {
+        Serial.printf(" - 闪存日志: %u 页, 本次写入 %lu 次\n", LogFileSink::instance().getPageCount(),
+                      (unsigned long)LogFileSink::instance().getPagesWritten());
+    }
+#if HOST_LINK_ENABLED
+    Serial.printf(" - 主机通道: %s, 收到 %lu 帧, 丢弃 %lu 帧\n",
+                  HostLink::instance().isConnected() ? "已连接" : "未连接",
+                  (unsigned long)HostLink::instance().getFramesReceived(),
+                  (unsigned long)HostLink::instance().getFramesDropped());
+#endif
+    Serial.printf(" - 背光亮度: %d%%\n", BacklightControl::getInstance().getCurrentBrightness());
+    
+    // 显示休眠状态信息
+    const char* sleepState = SleepManager::stateName(SleepManager::instance().getState());
+    uint32_t sleepTimeout = SleepManager::instance().getTimeout();
+    if (sleepTimeout > 0) {
+        Serial.printf(" - 休眠状态: %s (超时: %lu 秒)\n", sleepState, sleepTimeout / 1000);
+        if (SleepManager::instance().getTimeoutScale() != 100) {
+            Serial.printf(" - 低电量: 休眠超时和浅睡眠延迟按 %u%% 计算\n", SleepManager::instance().getTimeoutScale());
         }
-        else if (cmd.startsWith("hid_enable")) {
-            if (simpleHID) {
-                String param = cmd.substring(11);
-                param.trim();
-                if (param.equalsIgnoreCase("on")) {
-                    keypad.setHIDEnabled(true);
-                    simpleHID->setEnabled(true);
-                    Serial.println("✅ HID功能已启用");
-                } else if (param.equalsIgnoreCase("off")) {
-                    keypad.setHIDEnabled(false);
-                    simpleHID->setEnabled(false);
-                    Serial.println("✅ HID功能已禁用");
-                } else {
-                    Serial.println("无效参数。使用: hid_enable on 或 hid_enable off");
-                }
-            } else {
-                Serial.println("HID功能未初始化");
-            }
+#if LIGHT_SLEEP_ENABLED
+        Serial.printf(" - 浅睡眠: %lu 次, 共 %lu 毫秒, 最近唤醒耗时 %lu 微秒\n",
+                      (unsigned long)SleepManager::instance().getLightSleepCount(),
+                      (unsigned long)SleepManager::instance().getLightSleepMs(),
+                      (unsigned long)SleepManager::instance().getLastResumeUs());
+#endif
+    } else {
+        Serial.printf(" - 休眠状态: 已禁用\n");
+    }
+    
+    if(calculator) {
+        Serial.printf(" - 计算器显示: %s\n", calculator->getCurrentDisplay());
+    }
+    
+    // 显示蜂鸣器模式状态
+    Serial.printf(" - 蜂鸣器模式: %s\n", 
+                (keypad.getBuzzerConfig().mode == BUZZER_MODE_PIANO) ? "钢琴模式 (500Hz-2500Hz)" : "普通模式");
+}
+
+// 模拟一次按下和释放，按住期间主循环照常运行
+static uint32_t feedbackTestTask(CoTask& task) {
+    CO_BEGIN(task);
+    simulateKeyEvent(KEY_EVENT_PRESS, task.arg);
+    CO_SLEEP(task, 100);
+    simulateKeyEvent(KEY_EVENT_RELEASE, task.arg);
+    CO_END(task);
+}
+
+static void cmdTestFeedback(const ConsoleArgs& args) {
+    int key;
+    if (!args.toInt(1, key)) {
+        Serial.println("无效的 'test_feedback' 命令格式. 使用: test_feedback <key>");
+    } else if (key >= 1 && key <= 22) {
+        if (CoRunner::instance().spawn("test_feedback", feedbackTestTask, key)) {
+            Serial.printf("测试按键 %d 反馈效果\n", key);
+        } else {
+            Serial.println("上一次反馈测试尚未结束");
         }
-        else {
-            Serial.printf("未知命令: '%s'\n", cmd.c_str());
+    } else {
+        Serial.println("按键编号必须在 1-22 之间");
+    }
+}
+
+static void cmdTheme(const ConsoleArgs& args) {
+    if (!display) {
+        Serial.println("显示未初始化");
+        return;
+    }
+    if (args.count < 2) {
+        for (uint8_t i = 0; i < DISPLAY_THEME_COUNT; i++) {
+            Serial.printf("%c %s\n", i == display->getTheme() ? '*' : ' ', DISPLAY_THEMES[i].name);
         }
+        return;
+    }
+    int8_t index = findDisplayTheme(args.arg(1));
+    if (index < 0) {
+        Serial.printf("未知主题: %s\n", args.arg(1));
+    } else {
+        display->setTheme(index);
+        Serial.printf("✅ 显示主题: %s\n", DISPLAY_THEMES[index].name);
+    }
+}
+
+static constexpr ConsoleCommand MAIN_COMMANDS[] = {
+    {"bench", "[json] [scan|format|calculate|math|refresh|flush|pixels|rotate|led|log|spsc]", "测量关键路径的CPU周期数", cmdBench},
+    {"blend_bench", "[0-255]", "比较逐像素与批量颜色缩放/混合的耗时", cmdBlendBench},
+    {"boot", "", "显示启动各阶段耗时", cmdBoot},
+    {"brightness", "<0-255>", "设置LED亮度", cmdBrightness},
+    {"buzzer", "<freq> <duration>", "测试蜂鸣器", cmdBuzzer},
+    {"hid_enable", "<on|off>", "启用/禁用HID功能", cmdHidEnable},
+    {"history", "[n] [start] | clear", "显示计算历史（从第start条起的n条，0为最新）；clear清除（包括闪存日志）", cmdHistory},
+    {"keystats", "[reset]", "显示/清空各按键的抖动、连击和按住时长统计", cmdKeyStats},
+    {"led", "<idx> <r> <g> <b> | all <r> <g> <b> | off", "设置单个/所有LED颜色，或关闭所有LED", cmdLed},
+    {"led_test", "", "逐个测试所有LED", cmdLedTest},
+    {"mem", "", "显示内存使用情况", cmdMem},
+    {"perf", "[reset]", "显示/清空显示性能统计（输入延迟、绘制、推送、帧率）", cmdPerf},
+    {"piano_mode", "<on|off>", "切换钢琴模式（500Hz-2500Hz宽频音调）", cmdPianoMode},
+    {"piano_test", "", "测试宽频音阶（播放22个音符，5倍频率范围）", cmdPianoTest},
+    {"reboot", "", "重启设备", cmdReboot},
+    {"status", "", "显示系统状态", cmdStatus},
+    {"test_feedback", "<key>", "测试按键反馈效果", cmdTestFeedback},
+    {"theme", "[dark|light|amber|green]", "列出/切换显示主题", cmdTheme},
+    {"tone", "<confirm|error|stop>", "播放提示音", cmdTone},
+    {"volume", "<0-100>", "设置蜂鸣器音量", cmdVolume},
+};
+static_assert(consoleSorted(MAIN_COMMANDS), "命令表必须按名称排序");
+
+void registerCommands() {
+    Console::instance().addCommands(MAIN_COMMANDS);
+}
+
+void syncKeyStats() {
+    KeyStatsData stats;
+    keypad.getKeyStats(stats);
+    ConfigManager::getInstance().setKeyStats(stats);
+    ConfigManager::getInstance().flushKeyStats();
+}
+
+void applyKeyLayout() {
+    keypad.setAutoRepeatMask(keyboardConfig.getAutoRepeatMask());
+    for (uint8_t i = 1; i <= LAYOUT_KEY_COUNT; i++) {
+        keypad.setKeyColor(i, CRGB(keyboardConfig.getKeyColor(i)));
     }
 }
 
 void updateSystems() {
-    // 更新键盘扫描
-    keypad.update();
+    // 到期的定时器：休眠各级、配置和内存寄存器的空闲保存、历史日志写入、按键统计同步
+    {
+        PROFILE_SCOPE(PROFILE_TIMERS);
+        TimerWheel::instance().update();
+    }
+    
+    // LED功率预算扣除基础功耗和当前背光功耗
+    LedOutput::instance().setExternalLoad(POWER_BASE_LOAD_MW +
+        POWER_BACKLIGHT_FULL_MW * BacklightControl::getInstance().getCurrentBrightness() / 100);
     
     // 更新LED效果
-    keypad.updateLEDEffects();
+    {
+        PROFILE_SCOPE(PROFILE_LED_EFFECTS);
+        keypad.updateLEDEffects();
+    }
     
-    // 更新背光控制
-    BacklightControl::getInstance().update();
+    // 自动亮度采样，再推进背光渐变
+    {
+        PROFILE_SCOPE(PROFILE_AMBIENT);
+        AmbientBacklight::instance().update();
+    }
+    {
+        PROFILE_SCOPE(PROFILE_BACKLIGHT);
+        BacklightControl::getInstance().update();
+    }
     
     // 更新休眠管理器
-    SleepManager::instance().update();
+    {
+        PROFILE_SCOPE(PROFILE_SLEEP);
+        SleepManager::instance().update();
+    }
     
-    // 更新计算器核心
-    if (calculator) {
+    // 按键日志回放
+    KeyJournal::instance().update();
+#if LATENCY_PROBE_ENABLED
+    LatencyProbe::instance().update();
+#endif
+    
+    // 双功能键按住到判定时间：执行按住动作
+    if (uint8_t held = tapHold.poll(millis())) {
+        ScratchScope scratch(ScratchArena::keyEvent());
+        dispatchKeyInput(held, true, esp_timer_get_time());
+    }
+    
+    // 更新计算器核心（直通期间没有输入，不推进）
+    if (calculator && !keypad.isPassThrough()) {
+        PROFILE_SCOPE(PROFILE_CALCULATOR);
         calculator->update();
     }
     
     // 简单HID无需更新（无状态设计）
-    
-    // 更新配置管理器（自动保存）
-    ConfigManager::getInstance().saveIfDirty();
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+# project/tools/audio_bake.py
+"""
+按键音采样烘焙：合成短的PCM采样，生成 src/AudioSamples.h（AudioOutput 经I2S PDM播放）
+
+采样为8位有符号单声道，采样率取 config.h 的 AUDIO_SAMPLE_RATE，放在闪存中由播放任务直接读取。
+各采样的形状在下面的 SAMPLES 中给出（顺序同 AudioOutput.h 的 AudioSampleId），修改后重新运行本脚本
+（构建时作为 pre 脚本运行，脚本比生成文件新时重新生成）：
+  - click / release：按下和松开的短促“哒”声，衰减的正弦叠加少量噪声，落在压电片的谐振频段
+  - confirm / error：与 BuzzerSequencer 的预置提示音相同的音符，加起音和收音包络
+另外生成一个周期的正弦波表，播放任意频率的音（钢琴模式、长按音）时循环读取。
+
+用法：
+    python tools/audio_bake.py
+"""
+import math
+import os
+import random
+import re
+
+WAVE_BITS = 6           # 正弦波表 64 点
+ATTACK_MS = 3
+RELEASE_MS = 5
+
+
+def damped(rate, freq, ms, tau_ms, amplitude, noise=0.0, seed=1):
+    rng = random.Random(seed)
+    out = []
+    for i in range(int(rate * ms / 1000)):
+        t = i / rate
+        env = math.exp(-t * 1000 / tau_ms)
+        out.append(amplitude * env * (math.sin(2 * math.pi * freq * t) + noise * rng.uniform(-1, 1)))
+    return out
+
+
+def notes(rate, sequence, amplitude):
+    """(频率, 时长ms) 序列，频率0为休止；每个音加线性起音和收音"""
+    out = []
+    for freq, ms in sequence:
+        count = int(rate * ms / 1000)
+        attack = int(rate * ATTACK_MS / 1000)
+        release = int(rate * RELEASE_MS / 1000)
+        for i in range(count):
+            if freq == 0:
+                out.append(0.0)
+                continue
+            env = min(1.0, i / attack if attack else 1.0, (count - i) / release if release else 1.0)
+            out.append(amplitude * env * math.sin(2 * math.pi * freq * i / rate))
+    return out
+
+
+def samples(rate):
+    return [
+        ("CLICK", damped(rate, 3200, 8, 1.5, 1.0, noise=0.25)),
+        ("RELEASE", damped(rate, 2400, 6, 1.2, 0.6, noise=0.15, seed=2)),
+        ("CONFIRM", notes(rate, [(1800, 60), (0, 30), (2400, 90)], 0.9)),
+        ("ERROR", notes(rate, [(700, 120), (0, 40), (450, 220)], 1.0)),
+    ]
+
+
+def quantize(values):
+    return [max(-127, min(127, int(round(v * 127)))) for v in values]
+
+
+def sample_rate(project_dir):
+    with open(os.path.join(project_dir, "src", "config.h"), encoding="utf-8") as f:
+        text = f.read()
+    return int(re.search(r"#define AUDIO_SAMPLE_RATE (\d+)", text).group(1))
+
+
+def format_array(name, data):
+    lines = ["static const int8_t %s[%d] = {" % (name, len(data))]
+    for i in range(0, len(data), 24):
+        lines.append("    " + ", ".join("%d" % v for v in data[i:i + 24]) + ",")
+    lines.append("};")
+    return lines
+
+
+def write_header(output, rate, baked, sine):
+    total = sum(len(data) for _, data in baked)
+    lines = [
+        "// 由 tools/audio_bake.py 生成，不要手工修改",
+        "// %d Hz 8位PCM，%d 个采样共 %d 字节" % (rate, len(baked), total),
+        "",
+        "#ifndef AUDIO_SAMPLES_H",
+        "#define AUDIO_SAMPLES_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "static const uint32_t AUDIO_SAMPLES_RATE = %d;" % rate,
+        "static const uint8_t AUDIO_SAMPLES_COUNT = %d;" % len(baked),
+        "static const uint8_t AUDIO_WAVE_BITS = %d;" % WAVE_BITS,
+        "",
+    ]
+    for name, data in baked:
+        lines += format_array("AUDIO_PCM_" + name, data) + [""]
+    lines += format_array("AUDIO_SINE", sine) + [""]
+    lines.append("struct AudioPcm {")
+    lines.append("    const int8_t* data;")
+    lines.append("    uint16_t length;")
+    lines.append("};")
+    lines.append("")
+    lines.append("// 顺序同 AudioOutput.h 的 AudioSampleId")
+    lines.append("static const AudioPcm AUDIO_PCM[%d] = {" % len(baked))
+    for name, data in baked:
+        lines.append("    {AUDIO_PCM_%s, %d}," % (name, len(data)))
+    lines += ["};", "", "#endif // AUDIO_SAMPLES_H", ""]
+    with open(output, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+def bake(project_dir, force=False):
+    output = os.path.join(project_dir, "src", "AudioSamples.h")
+    if not force and os.path.isfile(output) and os.path.getmtime(output) >= os.path.getmtime(__file__):
+        return
+
+    rate = sample_rate(project_dir)
+    baked = [(name, quantize(values)) for name, values in samples(rate)]
+    sine = quantize([math.sin(2 * math.pi * i / (1 << WAVE_BITS)) for i in range(1 << WAVE_BITS)])
+    write_header(output, rate, baked, sine)
+    print("⮕ audio_bake: %s (%d 字节)" % (output, sum(len(data) for _, data in baked)))
+
+
+if __name__ == "__main__":
+    bake(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), force=True)
+elif __name__ != "audio_bake":
+    from SCons.Script import DefaultEnvironment
+
+    env = DefaultEnvironment()
+    bake(env.subst("$PROJECT_DIR"))
@@ -0,0 +1,180 @@
+# project/tools/bench_check.py
+"""
+关键路径基准的回归检查：在设备上运行 bench json，把结果与 tools/bench_baseline.json 比较
+
+基准文件按 "基准项/名称"（bench json 每行的 item 和 name）给出最少周期数和容差（百分比）：
+  - 结果超过 基准 × (1 + 容差) 为退化，返回1
+  - 基准中有、结果中缺失或跳过（显示未初始化等）的项也算失败，免得退化被跳过掩盖
+  - CPU频率与基准记录时不同时周期数不可比，同样失败
+  - 基准周期数为 null 的项只显示结果，用 --update 在参考板上记录
+  - 明显变快（低于 基准 × (1 - 容差)）时提示用 --update 收紧基准
+结果中基准没有的项（math、pixels等）只显示，不检查。
+
+用法：
+    python tools/bench_check.py --port COM5                  # 运行并比较，有退化时返回1
+    python tools/bench_check.py --port COM5 --save run.jsonl # 同时保存原始结果
+    python tools/bench_check.py --input run.jsonl            # 比较保存的结果
+    python tools/bench_check.py --port COM5 --update         # 用本次结果更新基准的周期数（容差不变）
+    pio run -e esp32-s3 -t bench_check                       # 同第一条，串口取 monitor_port 或环境变量 BENCH_PORT
+"""
+import argparse
+import json
+import os
+import sys
+import time
+
+BAUD = 115200
+TIMEOUT_S = 120         # 全部基准项（含math）的运行时间上限
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "bench_baseline.json")
+
+
+def parse_lines(lines):
+    """从串口输出中取出JSON行，返回 (开始行, {键: 结果})；日志等其他行忽略"""
+    header = None
+    results = {}
+    for line in lines:
+        line = line.strip()
+        if not line.startswith("{"):
+            continue
+        try:
+            record = json.loads(line)
+        except ValueError:
+            continue        # 被异步日志打断的行
+        if record.get("bench") == "start":
+            header = record
+        elif "item" in record:
+            results["%s/%s" % (record["item"], record["name"])] = record
+    return header, results
+
+
+def run_on_device(port):
+    import serial  # pyserial
+
+    with serial.Serial(port, BAUD, timeout=1) as link:
+        link.reset_input_buffer()
+        link.write(b"bench json\n")
+        lines = []
+        deadline = time.time() + TIMEOUT_S
+        while time.time() < deadline:
+            raw = link.readline()
+            if not raw:
+                continue
+            line = raw.decode("utf-8", "replace").rstrip()
+            lines.append(line)
+            if line.startswith('{"bench":"end"'):
+                return lines
+    raise RuntimeError("%d 秒内没有等到基准结束（串口 %s）" % (TIMEOUT_S, port))
+
+
+def compare(baseline, header, results):
+    """打印比较结果，返回失败项数"""
+    failures = 0
+    mhz = header.get("mhz") if header else None
+    if baseline.get("cpu_mhz") and mhz != baseline["cpu_mhz"]:
+        print("失败: CPU %s MHz，基准记录于 %d MHz，周期数不可比" % (mhz, baseline["cpu_mhz"]))
+        failures += 1
+
+    default_tolerance = baseline.get("default_tolerance", 10)
+    print("%-32s %10s %10s %7s %6s" % ("基准项", "基准", "本次", "变化", "容差"))
+    for key, entry in baseline["benchmarks"].items():
+        tolerance = entry.get("tolerance", default_tolerance)
+        expected = entry.get("cycles")
+        result = results.get(key)
+        if result is None or result.get("skipped"):
+            print("%-32s %10s %10s  缺失" % (key, expected if expected is not None else "-", "-"))
+            failures += 1
+            continue
+        best = result["best"]
+        if expected is None:
+            print("%-32s %10s %10d  未记录基准" % (key, "-", best))
+            continue
+        change = (best - expected) * 100.0 / expected
+        verdict = ""
+        if change > tolerance:
+            verdict = "  退化"
+            failures += 1
+        elif change < -tolerance:
+            verdict = "  变快，可用 --update 收紧"
+        print("%-32s %10d %10d %+6.1f%% %5d%%%s" % (key, expected, best, change, tolerance, verdict))
+
+    for key in sorted(set(results) - set(baseline["benchmarks"])):
+        result = results[key]
+        if not result.get("skipped"):
+            print("%-32s %10s %10d  （不检查）" % (key, "-", result["best"]))
+    return failures
+
+
+def update_baseline(path, baseline, header, results):
+    for key, entry in baseline["benchmarks"].items():
+        result = results.get(key)
+        if result is not None and not result.get("skipped"):
+            entry["cycles"] = result["best"]
+    if header:
+        baseline["cpu_mhz"] = header.get("mhz")
+    with open(path, "w", encoding="utf-8", newline="\n") as f:
+        json.dump(baseline, f, ensure_ascii=False, indent=2)
+        f.write("\n")
+    print("已更新 %s" % path)
+
+
+def check(port=None, input_path=None, baseline_path=DEFAULT_BASELINE, save=None, update=False):
+    with open(baseline_path, encoding="utf-8") as f:
+        baseline = json.load(f)
+    if input_path:
+        with open(input_path, encoding="utf-8") as f:
+            lines = f.read().splitlines()
+    else:
+        lines = run_on_device(port)
+        if save:
+            with open(save, "w", encoding="utf-8", newline="\n") as f:
+                f.write("\n".join(lines) + "\n")
+
+    header, results = parse_lines(lines)
+    if not results:
+        print("没有收到基准结果")
+        return 1
+    if update:
+        update_baseline(baseline_path, baseline, header, results)
+        return 0
+    failures = compare(baseline, header, results)
+    print("基准检查%s" % ("通过" if not failures else "失败: %d 项" % failures))
+    return 1 if failures else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="关键路径基准的回归检查")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="设备串口（如 COM5、/dev/ttyUSB0）")
+    source.add_argument("--input", help="保存的 bench json 输出")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="基准文件")
+    parser.add_argument("--save", help="保存本次的原始输出")
+    parser.add_argument("--update", action="store_true", help="用本次结果更新基准的周期数")
+    args = parser.parse_args()
+    try:
+        sys.exit(check(args.port, args.input, args.baseline, args.save, args.update))
+    except (OSError, RuntimeError) as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
+elif __name__ != "bench_check":
+    from SCons.Script import DefaultEnvironment
+
+    env = DefaultEnvironment()
+
+    def run_check(target, source, env):
+        port = os.environ.get("BENCH_PORT") or env.GetProjectOption("monitor_port", "")
+        if not port:
+            print("bench_check: 需要 monitor_port 或环境变量 BENCH_PORT")
+            return 1
+        return check(port)
+
+    env.AddCustomTarget(
+        name="bench_check",
+        dependencies=None,
+        actions=[run_check],
+        title="Bench check",
+        description="运行 bench json 并与 tools/bench_baseline.json 比较，退化时失败",
+    )
@@ -0,0 +1,131 @@
+# project/tools/chrome_bake.py
+"""
+界面底图烘焙：生成固定不变的界面元素（分隔线等）src/ChromeData.h
+
+底图按颜色角色（DisplayTheme.h的ThemeColor）保存，不保存RGB，切换主题时由ChromeLayer重新着色。
+压缩格式是按角色的行程编码，逐像素流式解码，按行优先顺序：
+  0brrnnnnnn           角色r（0~2）重复n+1次（1~64）
+  0b11nnnnnn llllllll  背景（角色0）重复 (n<<8 | l) + 1 次（1~16384）
+界面大部分是背景，整屏底图通常只有几十到几百字节。
+
+底图内容在下面的 chrome_rects() 中按显示尺寸给出，修改后重新运行本脚本（构建时作为 pre 脚本运行，
+脚本比生成文件新时重新生成）。底图只在 config.h 的 DISPLAY_CHROME 为1时使用。
+
+用法：
+    python tools/chrome_bake.py
+"""
+import os
+import re
+
+ROLE_BG = 0
+ROLE_FG = 1
+ROLE_HIST = 2
+
+SHORT_RUN = 64
+LONG_RUN = 1 << 14
+OP_LONG_BG = 0xC0
+
+PAD_X = 15      # 同 CalcDisplay::PAD_X
+
+
+def chrome_rects(width, height):
+    """(角色, x, y, w, h) 列表，后面的覆盖前面的"""
+    return [
+        # 表达式行（L2，y 32~55）与结果行（L3，y 60起）之间的分隔线
+        (ROLE_HIST, PAD_X, 58, width - 2 * PAD_X, 1),
+    ]
+
+
+def render(width, height):
+    roles = [ROLE_BG] * (width * height)
+    for role, x, y, w, h in chrome_rects(width, height):
+        for row in range(max(0, y), min(height, y + h)):
+            for col in range(max(0, x), min(width, x + w)):
+                roles[row * width + col] = role
+    return roles
+
+
+def encode(roles):
+    out = bytearray()
+    i = 0
+    while i < len(roles):
+        role = roles[i]
+        limit = LONG_RUN if role == ROLE_BG else SHORT_RUN
+        run = 1
+        while i + run < len(roles) and roles[i + run] == role and run < limit:
+            run += 1
+        if run > SHORT_RUN:
+            out += bytes((OP_LONG_BG | ((run - 1) >> 8), (run - 1) & 0xFF))
+        else:
+            out.append((role << 6) | (run - 1))
+        i += run
+    return bytes(out)
+
+
+def decode(data, count):
+    roles = []
+    i = 0
+    while i < len(data) and len(roles) < count:
+        b = data[i]
+        i += 1
+        if b & 0xC0 == OP_LONG_BG:
+            roles += [ROLE_BG] * ((((b & 0x3F) << 8) | data[i]) + 1)
+            i += 1
+        else:
+            roles += [b >> 6] * ((b & 0x3F) + 1)
+    return roles
+
+
+def display_size(project_dir):
+    with open(os.path.join(project_dir, "src", "config.h"), encoding="utf-8") as f:
+        text = f.read()
+    width = int(re.search(r"#define DISPLAY_WIDTH (\d+)", text).group(1))
+    height = int(re.search(r"#define DISPLAY_HEIGHT (\d+)", text).group(1))
+    return width, height
+
+
+def write_header(output, width, height, data, chrome_rows):
+    lines = [
+        "// 由 tools/chrome_bake.py 生成，不要手工修改",
+        "// %dx%d 颜色角色，行程编码 %d 字节，有底图的行 %d" % (width, height, len(data), chrome_rows),
+        "",
+        "#ifndef CHROME_DATA_H",
+        "#define CHROME_DATA_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "static const uint16_t CHROME_WIDTH = %d;" % width,
+        "static const uint16_t CHROME_HEIGHT = %d;" % height,
+        "static const uint32_t CHROME_DATA_SIZE = %d;" % len(data),
+        "",
+        "static const uint8_t CHROME_DATA[%d] = {" % len(data),
+    ]
+    for i in range(0, len(data), 24):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 24]) + ",")
+    lines += ["};", "", "#endif // CHROME_DATA_H", ""]
+    with open(output, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+def bake(project_dir, force=False):
+    output = os.path.join(project_dir, "src", "ChromeData.h")
+    if not force and os.path.isfile(output) and os.path.getmtime(output) >= os.path.getmtime(__file__):
+        return
+
+    width, height = display_size(project_dir)
+    roles = render(width, height)
+    data = encode(roles)
+    if decode(data, len(roles)) != roles:
+        raise ValueError("界面底图编码自检失败")
+    chrome_rows = sum(1 for y in range(height) if any(roles[y * width:(y + 1) * width]))
+    write_header(output, width, height, data, chrome_rows)
+    print("⮕ chrome_bake: %s (%d 字节，%d 行)" % (output, len(data), chrome_rows))
+
+
+if __name__ == "__main__":
+    bake(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), force=True)
+elif __name__ != "chrome_bake":
+    from SCons.Script import DefaultEnvironment
+
+    env = DefaultEnvironment()
+    bake(env.subst("$PROJECT_DIR"))
@@ -0,0 +1,169 @@
+# project/tools/cjk_subset.py
+"""
+屏幕文字的CJK字形子集
+
+扫描 src/ 中用 UI_TEXT("...") 标记的字符串（UiText.h），收集其中的非ASCII字符，
+从GNU Unifont的 .hex 点阵字体中取出这些字符的16x16字形，生成 CjkSubsetData.h：
+  - CJK_SLOT_CODE / CJK_SLOT_GLYPH：完美哈希表，slot = (码点 * CJK_HASH_SEED) >> (32 - CJK_HASH_BITS)
+    空槽码点为0；运行时一次乘法、一次比较即可找到字形
+  - CJK_GLYPHS：每个字形32字节，每行2字节，最高位在左
+半角（8x16）字形放在16像素格子的左半边。字体中没有的字符不生成，运行时画成空心方框。
+
+生成到构建目录（$BUILD_DIR/generated），内容不变时不改写文件，不会触发重新编译。
+Unifont 路径用环境变量 CJK_FONT_HEX 指定（支持 .hex.gz），默认查找系统安装位置；
+找不到时生成空子集，非ASCII字符都画成方框。
+
+单独运行（检查会生成哪些字符）：
+    python tools/cjk_subset.py [unifont.hex] [输出目录]
+"""
+import gzip
+import os
+import re
+import sys
+
+UI_TEXT = re.compile(r'UI_TEXT\(\s*"((?:[^"\\]|\\.)*)"\s*\)')
+SOURCE_EXTS = (".cpp", ".h")
+GLYPH_BYTES = 32
+
+DEFAULT_FONTS = [
+    "/usr/share/unifont/unifont.hex",
+    "/usr/share/unifont/unifont.hex.gz",
+    "/usr/local/share/unifont/unifont.hex",
+]
+
+
+def scan_sources(src_dir):
+    codes = set()
+    for root, _, files in os.walk(src_dir):
+        for name in files:
+            if not name.endswith(SOURCE_EXTS):
+                continue
+            with open(os.path.join(root, name), encoding="utf-8", errors="replace") as f:
+                for text in UI_TEXT.findall(f.read()):
+                    codes.update(ord(ch) for ch in text if ord(ch) >= 0x80)
+    return sorted(codes)
+
+
+def load_glyphs(path, codes):
+    wanted = set(codes)
+    glyphs = {}
+    opener = gzip.open if path.endswith(".gz") else open
+    with opener(path, "rt", encoding="ascii", errors="replace") as f:
+        for line in f:
+            code, _, bits = line.strip().partition(":")
+            try:
+                cp = int(code, 16)
+            except ValueError:
+                continue
+            if cp not in wanted:
+                continue
+            raw = bytes.fromhex(bits)
+            if len(raw) == GLYPH_BYTES:
+                glyphs[cp] = raw
+            elif len(raw) == GLYPH_BYTES // 2:
+                glyphs[cp] = b"".join(bytes((b, 0)) for b in raw)
+    return glyphs
+
+
+def perfect_hash(codes):
+    """找到让所有码点落在不同槽位的乘数，表长取不小于2n的2的幂"""
+    bits = 1
+    while (1 << bits) < 2 * len(codes):
+        bits += 1
+    while True:
+        for seed in range(0x9E3779B1, 0x9E3779B1 + 2 * 65536, 2):
+            slots = set(((cp * seed) & 0xFFFFFFFF) >> (32 - bits) for cp in codes)
+            if len(slots) == len(codes):
+                return bits, seed
+        bits += 1
+
+
+def render(codes, glyphs, font_name):
+    present = [cp for cp in codes if cp in glyphs]
+    if len(present) > 255:
+        raise ValueError("字形子集超过255个（CJK_SLOT_GLYPH为uint8_t）")
+    bits, seed = perfect_hash(present) if present else (1, 0x9E3779B1)
+    size = 1 << bits
+    slot_code = [0] * size
+    slot_glyph = [0] * size
+    for index, cp in enumerate(present):
+        slot = ((cp * seed) & 0xFFFFFFFF) >> (32 - bits)
+        slot_code[slot] = cp
+        slot_glyph[slot] = index
+
+    missing = "".join(chr(cp) for cp in codes if cp not in glyphs)
+    lines = [
+        "// 由 tools/cjk_subset.py 生成，不要手工修改",
+        "// 字体: %s" % (font_name or "（未找到，空子集）"),
+        "// 字符: %s" % "".join(chr(cp) for cp in present),
+    ]
+    if missing:
+        lines.append("// 缺少: %s" % missing)
+    lines += [
+        "",
+        "#ifndef CJK_SUBSET_DATA_H",
+        "#define CJK_SUBSET_DATA_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "static const uint8_t CJK_GLYPH_COUNT = %d;" % len(present),
+        "static const uint8_t CJK_HASH_BITS = %d;" % bits,
+        "static const uint32_t CJK_HASH_SEED = 0x%08Xu;" % seed,
+        "",
+        "static const uint32_t CJK_SLOT_CODE[%d] = {" % size,
+        "    " + ", ".join("0x%04X" % cp for cp in slot_code) + ",",
+        "};",
+        "",
+        "static const uint8_t CJK_SLOT_GLYPH[%d] = {" % size,
+        "    " + ", ".join(str(g) for g in slot_glyph) + ",",
+        "};",
+        "",
+        "static const uint8_t CJK_GLYPHS[%d] = {" % max(1, len(present) * GLYPH_BYTES),
+    ]
+    for cp in present:
+        lines.append("    " + ", ".join("0x%02X" % b for b in glyphs[cp]) + ",  // %s" % chr(cp))
+    if not present:
+        lines.append("    0,")
+    lines += ["};", "", "#endif // CJK_SUBSET_DATA_H", ""]
+    return "\n".join(lines), len(present), missing
+
+
+def find_font(explicit=None):
+    for path in [explicit, os.environ.get("CJK_FONT_HEX")] + DEFAULT_FONTS:
+        if path and os.path.isfile(path):
+            return path
+    return None
+
+
+def generate(project_dir, out_dir, explicit=None):
+    codes = scan_sources(os.path.join(project_dir, "src"))
+    font_path = find_font(explicit)
+    glyphs = load_glyphs(font_path, codes) if font_path and codes else {}
+    text, count, missing = render(codes, glyphs, os.path.basename(font_path) if font_path else None)
+
+    os.makedirs(out_dir, exist_ok=True)
+    output = os.path.join(out_dir, "CjkSubsetData.h")
+    if os.path.isfile(output):
+        with open(output, encoding="utf-8") as f:
+            if f.read() == text:
+                return output
+    with open(output, "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+    print("⮕ cjk_subset: %d/%d 个字形 -> %s" % (count, len(codes), output))
+    if missing:
+        print("⮕ cjk_subset: 缺少字形（将显示为方框）: %s" % missing)
+    return output
+
+
+if __name__ == "__main__":
+    project = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    generate(project,
+             sys.argv[2] if len(sys.argv) > 2 else os.path.join(project, ".pio", "generated"),
+             sys.argv[1] if len(sys.argv) > 1 else None)
+else:
+    from SCons.Script import DefaultEnvironment
+
+    env = DefaultEnvironment()
+    gen_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")
+    generate(env.subst("$PROJECT_DIR"), gen_dir)
+    env.Append(CPPPATH=[gen_dir])
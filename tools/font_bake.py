@@ -0,0 +1,354 @@
+# project/tools/font_bake.py
+"""
+抗锯齿字体烘焙：把TrueType字体栅格化为4-bpp覆盖率位图，生成 src/AAFontData.h
+
+每个字号 s 的字形格子与内置6x8字体放大 s 倍完全相同（宽6s、高8s，基线在第7s行），
+排版宽度、逐字形局部重绘等都不受影响；GlyphAtlas 运行时再按前景/背景色混合为RGB565。
+
+  - 只栅格化计算器显示用到的字符（与 GlyphAtlas.cpp 的 GLYPH_CHARS 一致）
+  - 字号范围与 calc_display.cpp 的 initializeLines() 一致（3~8号）
+  - 每像素4x4超采样，非零环绕规则，覆盖率量化为0~15
+  - 只用标准库解析TTF（glyf轮廓），构建机不需要Pillow/FreeType
+
+生成的头文件随仓库提交；找不到字体时保留已有文件，构建照常进行。
+
+用法：
+    python tools/font_bake.py [字体.ttf]
+    构建时作为 pre 脚本运行：脚本比生成文件新、或生成文件不存在时重新烘焙
+字体路径也可以用环境变量 FONT_BAKE_TTF 指定，默认查找系统的 DejaVu Sans Mono。
+"""
+import os
+import struct
+import sys
+
+GLYPH_CHARS = "0123456789.-E+*/%e ,"
+TEXT_SIZES = range(3, 9)
+FONT_W = 6
+FONT_H = 8
+SUPERSAMPLE = 4
+CURVE_STEPS = 8
+
+DEFAULT_FONTS = [
+    "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf",
+    "/usr/share/fonts/TTF/DejaVuSansMono.ttf",
+    "/Library/Fonts/DejaVuSansMono.ttf",
+    "C:/Windows/Fonts/DejaVuSansMono.ttf",
+    "C:/Windows/Fonts/consola.ttf",
+]
+
+
+class TrueTypeFont:
+    """只读取栅格化需要的表：head、maxp、cmap(格式4)、loca、glyf、hmtx"""
+
+    def __init__(self, path, chars=GLYPH_CHARS):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        num_tables = struct.unpack_from(">H", self.data, 4)[0]
+        self.tables = {}
+        for i in range(num_tables):
+            tag, _, offset, length = struct.unpack_from(">4sIII", self.data, 12 + i * 16)
+            self.tables[tag.decode("latin-1")] = (offset, length)
+
+        head = self.tables["head"][0]
+        self.units_per_em = struct.unpack_from(">H", self.data, head + 18)[0]
+        self.long_loca = struct.unpack_from(">h", self.data, head + 50)[0] == 1
+        self.num_glyphs = struct.unpack_from(">H", self.data, self.tables["maxp"][0] + 4)[0]
+        self.num_hmetrics = struct.unpack_from(">H", self.data, self.tables["hhea"][0] + 34)[0]
+        self.cmap = self._read_cmap(chars)
+
+    def _read_cmap(self, chars):
+        base = self.tables["cmap"][0]
+        count = struct.unpack_from(">H", self.data, base + 2)[0]
+        for i in range(count):
+            platform, encoding, offset = struct.unpack_from(">HHI", self.data, base + 4 + i * 8)
+            sub = base + offset
+            if (platform, encoding) in ((3, 1), (0, 3)) and struct.unpack_from(">H", self.data, sub)[0] == 4:
+                return self._read_cmap4(sub, chars)
+        raise ValueError("字体没有 Unicode BMP (格式4) cmap")
+
+    def _read_cmap4(self, sub, chars):
+        seg_count = struct.unpack_from(">H", self.data, sub + 6)[0] // 2
+        ends = sub + 14
+        starts = ends + seg_count * 2 + 2
+        deltas = starts + seg_count * 2
+        range_offsets = deltas + seg_count * 2
+        mapping = {}
+        for ch in chars:
+            code = ord(ch)
+            for s in range(seg_count):
+                end = struct.unpack_from(">H", self.data, ends + s * 2)[0]
+                if code > end:
+                    continue
+                start = struct.unpack_from(">H", self.data, starts + s * 2)[0]
+                if code < start:
+                    break
+                delta = struct.unpack_from(">h", self.data, deltas + s * 2)[0]
+                ro_addr = range_offsets + s * 2
+                ro = struct.unpack_from(">H", self.data, ro_addr)[0]
+                if ro == 0:
+                    glyph = (code + delta) & 0xFFFF
+                else:
+                    glyph = struct.unpack_from(">H", self.data, ro_addr + ro + (code - start) * 2)[0]
+                    if glyph:
+                        glyph = (glyph + delta) & 0xFFFF
+                mapping[ch] = glyph
+                break
+        return mapping
+
+    def advance(self, glyph):
+        hmtx = self.tables["hmtx"][0]
+        index = min(glyph, self.num_hmetrics - 1)
+        return struct.unpack_from(">H", self.data, hmtx + index * 4)[0]
+
+    def _glyph_offset(self, glyph):
+        loca = self.tables["loca"][0]
+        if self.long_loca:
+            start, end = struct.unpack_from(">II", self.data, loca + glyph * 4)
+        else:
+            start, end = (v * 2 for v in struct.unpack_from(">HH", self.data, loca + glyph * 2))
+        return self.tables["glyf"][0] + start, end - start
+
+    def contours(self, glyph):
+        """返回轮廓列表，每个轮廓为 [(x, y, on_curve), ...]（字体单位，y向上）"""
+        offset, length = self._glyph_offset(glyph)
+        if length == 0:
+            return []
+        num_contours = struct.unpack_from(">h", self.data, offset)[0]
+        if num_contours >= 0:
+            return self._simple(offset, num_contours)
+        return self._composite(offset)
+
+    def _simple(self, offset, num_contours):
+        p = offset + 10
+        end_pts = struct.unpack_from(">%dH" % num_contours, self.data, p)
+        p += num_contours * 2
+        p += 2 + struct.unpack_from(">H", self.data, p)[0]
+        count = end_pts[-1] + 1 if num_contours else 0
+
+        flags = []
+        while len(flags) < count:
+            flag = self.data[p]
+            p += 1
+            flags.append(flag)
+            if flag & 0x08:
+                repeat = self.data[p]
+                p += 1
+                flags.extend([flag] * repeat)
+
+        def coords(short_bit, same_bit):
+            nonlocal p
+            values, value = [], 0
+            for flag in flags:
+                if flag & short_bit:
+                    delta = self.data[p]
+                    p += 1
+                    value += delta if flag & same_bit else -delta
+                elif not flag & same_bit:
+                    value += struct.unpack_from(">h", self.data, p)[0]
+                    p += 2
+                values.append(value)
+            return values
+
+        xs = coords(0x02, 0x10)
+        ys = coords(0x04, 0x20)
+        result, start = [], 0
+        for end in end_pts:
+            result.append([(xs[i], ys[i], bool(flags[i] & 1)) for i in range(start, end + 1)])
+            start = end + 1
+        return result
+
+    def _composite(self, offset):
+        p = offset + 10
+        result = []
+        while True:
+            flags, glyph = struct.unpack_from(">HH", self.data, p)
+            p += 4
+            if flags & 0x0001:
+                dx, dy = struct.unpack_from(">hh", self.data, p)
+                p += 4
+            else:
+                dx, dy = struct.unpack_from(">bb", self.data, p)
+                p += 2
+            a, b, c, d = 1.0, 0.0, 0.0, 1.0
+            if flags & 0x0008:
+                a = d = struct.unpack_from(">h", self.data, p)[0] / 16384.0
+                p += 2
+            elif flags & 0x0040:
+                a, d = (v / 16384.0 for v in struct.unpack_from(">hh", self.data, p))
+                p += 4
+            elif flags & 0x0080:
+                a, b, c, d = (v / 16384.0 for v in struct.unpack_from(">hhhh", self.data, p))
+                p += 8
+            for contour in self.contours(glyph):
+                result.append([(a * x + c * y + dx, b * x + d * y + dy, on) for x, y, on in contour])
+            if not flags & 0x0020:
+                return result
+
+
+def flatten(contour):
+    """二次贝塞尔轮廓展开为折线（补齐相邻离线点之间的隐含在线点）"""
+    if not contour:
+        return []
+    points = []
+    n = len(contour)
+    for i in range(n):
+        cur, nxt = contour[i], contour[(i + 1) % n]
+        points.append(cur)
+        if not cur[2] and not nxt[2]:
+            points.append(((cur[0] + nxt[0]) / 2.0, (cur[1] + nxt[1]) / 2.0, True))
+    start = next((i for i, pt in enumerate(points) if pt[2]), None)
+    if start is None:
+        return [(x, y) for x, y, _ in points]
+    points = points[start:] + points[:start]
+
+    line = [(points[0][0], points[0][1])]
+    i, n = 1, len(points)
+    while i <= n:
+        pt = points[i % n]
+        if pt[2]:
+            line.append((pt[0], pt[1]))
+            i += 1
+            continue
+        ctrl, end = pt, points[(i + 1) % n]
+        x0, y0 = line[-1]
+        for k in range(1, CURVE_STEPS + 1):
+            t = k / float(CURVE_STEPS)
+            u = 1 - t
+            line.append((u * u * x0 + 2 * u * t * ctrl[0] + t * t * end[0],
+                         u * u * y0 + 2 * u * t * ctrl[1] + t * t * end[1]))
+        i += 2
+    return line
+
+
+def rasterize(polys, width, height):
+    """非零环绕规则栅格化，返回 height 行、每行 width 个 0~15 覆盖率"""
+    ss = SUPERSAMPLE
+    edges = []
+    for poly in polys:
+        for i in range(len(poly)):
+            (x0, y0), (x1, y1) = poly[i], poly[(i + 1) % len(poly)]
+            if y0 != y1:
+                edges.append((x0, y0, x1, y1))
+
+    coverage = [[0] * width for _ in range(height)]
+    for sy in range(height * ss):
+        y = (sy + 0.5) / ss
+        crossings = []
+        for x0, y0, x1, y1 in edges:
+            if (y0 <= y < y1) or (y1 <= y < y0):
+                x = x0 + (y - y0) * (x1 - x0) / (y1 - y0)
+                crossings.append((x, 1 if y1 > y0 else -1))
+        crossings.sort()
+        row = coverage[sy // ss]
+        winding = 0
+        for k in range(len(crossings) - 1):
+            winding += crossings[k][1]
+            if winding == 0:
+                continue
+            # 采样点中心落在 [xa, xb) 内的列
+            first = max(0, int(crossings[k][0] * ss - 0.5 + 0.999999))
+            last = min(width * ss, int(crossings[k + 1][0] * ss - 0.5 + 0.999999))
+            for sx in range(first, last):
+                row[sx // ss] += 1
+
+    full = ss * ss
+    return [[min(15, (c * 15 + full // 2) // full) for c in row] for row in coverage]
+
+
+def bake_size(font, size):
+    width, height = FONT_W * size, FONT_H * size
+    baseline = 7 * size
+    # 数字高度对齐内置字体的7行，字形在格子里水平居中
+    cap = max(y for contour in font.contours(font.cmap["0"]) for _, y, _ in contour)
+    scale = baseline / float(cap)
+    glyphs = []
+    for ch in GLYPH_CHARS:
+        glyph = font.cmap.get(ch, 0)
+        offset_x = (width - font.advance(glyph) * scale) / 2.0
+        polys = []
+        for contour in font.contours(glyph):
+            polys.append([(offset_x + x * scale, baseline - y * scale) for x, y in flatten(contour)])
+        glyphs.append(rasterize(polys, width, height))
+    return glyphs
+
+
+def pack(glyph):
+    out = []
+    for row in glyph:
+        for i in range(0, len(row), 2):
+            out.append((row[i] << 4) | row[i + 1])
+    return out
+
+
+def write_header(font_path, output):
+    font = TrueTypeFont(font_path)
+    missing = [ch for ch in GLYPH_CHARS if ch != " " and not font.cmap.get(ch)]
+    if missing:
+        raise ValueError("字体缺少字符: %r" % "".join(missing))
+
+    lines = [
+        "// 由 tools/font_bake.py 生成，不要手工修改",
+        "// 字体: %s" % os.path.basename(font_path),
+        "// 每个字号: %d个字形 × (6s×8s) 像素，4-bpp覆盖率，每字节两个像素（高4位在左）" % len(GLYPH_CHARS),
+        "",
+        "#ifndef AA_FONT_DATA_H",
+        "#define AA_FONT_DATA_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        'static constexpr char AA_FONT_CHARS[] = "%s";' % GLYPH_CHARS,
+        "static const uint8_t AA_FONT_MIN_SIZE = %d;" % TEXT_SIZES[0],
+        "static const uint8_t AA_FONT_MAX_SIZE = %d;" % TEXT_SIZES[-1],
+        "",
+    ]
+    total = 0
+    for size in TEXT_SIZES:
+        data = []
+        for glyph in bake_size(font, size):
+            data.extend(pack(glyph))
+        total += len(data)
+        lines.append("static const uint8_t AA_FONT_S%d[%d] = {" % (size, len(data)))
+        for i in range(0, len(data), 24):
+            lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 24]) + ",")
+        lines.append("};")
+        lines.append("")
+    lines.append("static const uint8_t *const AA_FONT_BITS[] = {")
+    lines.append("    " + ", ".join("AA_FONT_S%d" % s for s in TEXT_SIZES) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // AA_FONT_DATA_H")
+    lines.append("")
+
+    with open(output, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+    return total
+
+
+def find_font(explicit=None):
+    for path in [explicit, os.environ.get("FONT_BAKE_TTF")] + DEFAULT_FONTS:
+        if path and os.path.isfile(path):
+            return path
+    return None
+
+
+def bake(project_dir, explicit=None, force=False):
+    output = os.path.join(project_dir, "src", "AAFontData.h")
+    if not force and os.path.isfile(output) and os.path.getmtime(output) >= os.path.getmtime(__file__):
+        return
+    font_path = find_font(explicit)
+    if not font_path:
+        print("⮕ font_bake: 找不到TTF字体（FONT_BAKE_TTF），保留现有 %s" % output)
+        return
+    total = write_header(font_path, output)
+    print("⮕ font_bake: %s -> %s (%d 字节)" % (os.path.basename(font_path), output, total))
+
+
+if __name__ == "__main__":
+    bake(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+         sys.argv[1] if len(sys.argv) > 1 else None, force=True)
+elif __name__ != "font_bake":
+    # 作为构建 pre 脚本运行；被其他工具（splash_pack.py）当作模块导入时只提供函数
+    from SCons.Script import DefaultEnvironment
+
+    env = DefaultEnvironment()
+    bake(env.subst("$PROJECT_DIR"))
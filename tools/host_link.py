@@ -0,0 +1,685 @@
+# project/tools/host_link.py
+"""
+USB CDC 主机通道客户端（固件 HostLink）
+
+帧格式（小端）：
+    0xA5 | 命令 | 序号 | 负载长度(2) | 负载 | CRC32(4)
+  - CRC32 覆盖命令到负载末尾
+  - 应答命令为请求命令 | 0x80，序号原样返回，负载第一个字节为状态码
+  - 历史记录和批量求值分多帧返回，中间帧状态为 MORE(1)，最后一帧为 OK(0)
+  - 屏幕镜像打开后设备主动发送 MORE 帧（序号同打开请求），每帧是若干变化的块
+
+用法：
+    python tools/host_link.py --port COM4 ping
+    python tools/host_link.py --port COM4 perf
+    python tools/host_link.py --port COM4 metrics --json   # 计数器和直方图快照（UART的metrics hex同格式）
+    python tools/host_link.py --port COM4 crash --table logfmt.json --out crash.bin --clear   # 上次崩溃的记录
+    python tools/host_link.py --port COM4 screen screen.png    # 截图
+    python tools/host_link.py --port COM4 mirror live.png      # 实时镜像，画面变化时重写PNG，Ctrl+C结束
+    python tools/host_link.py --port COM4 history --start 0 --count 100
+    python tools/host_link.py --port COM4 config-get layout layout.bin
+    python tools/host_link.py --port COM4 config-set settings settings.bin
+    python tools/host_link.py --port COM4 config-set layout layout.bin   # 换入新布局，下一次按键起生效
+    python tools/host_link.py --port COM4 json-get config.json     # 整机配置JSON
+    python tools/host_link.py --port COM4 json-set config.json
+    python tools/host_link.py --port COM4 update firmware.bin  # 压缩传输新固件，校验后重启
+    python tools/host_link.py --port COM4 update new.bin --base old.bin   # 差量更新（设备正在运行old.bin）
+    python tools/host_link.py --port COM4 eval exprs.txt      # 每行一个表达式，- 为标准输入
+    python tools/host_link.py --port COM4 rates               # 显示汇率表
+    python tools/host_link.py --port COM4 rates rates.csv     # 整表更新：每行"代码,1基准货币兑换的数量"
+"""
+import argparse
+import binascii
+import hashlib
+import os
+import struct
+import sys
+import time
+import zlib
+
+FRAME_MAGIC = 0xA5
+
+CMD_PING = 0x01
+CMD_GET_PERF = 0x10
+CMD_RESET_PERF = 0x11
+CMD_GET_METRICS = 0x12
+CMD_GET_CRASH = 0x13
+CMD_CLEAR_CRASH = 0x14
+CMD_GET_SCREEN = 0x15
+CMD_MIRROR = 0x16
+CMD_GET_CONFIG = 0x20
+CMD_SET_CONFIG = 0x21
+CMD_GET_HISTORY = 0x30
+CMD_EVAL = 0x40
+CMD_UPDATE_BEGIN = 0x50
+CMD_UPDATE_DATA = 0x51
+CMD_UPDATE_END = 0x52
+
+STATUS_OK = 0
+STATUS_MORE = 1
+STATUS_UNAVAILABLE = 4
+STATUS_NAMES = ["OK", "MORE", "BAD_COMMAND", "BAD_PAYLOAD", "UNAVAILABLE", "BUSY"]
+MAX_PAYLOAD = 1024
+
+UPDATE_RAW = 0
+UPDATE_ZLIB = 1
+UPDATE_DELTA = 2
+PATCH_MAGIC = b"PCD1"
+PATCH_BLOCK = 16        # 匹配的最短长度
+
+EVAL_TEXT = 0
+EVAL_RESULT = struct.Struct("<Bd")      # 错误码 + 结果
+EVAL_ERRORS = ["", "除零", "溢出", "下溢", "无效操作", "语法错误", "内存错误"]
+
+CONFIG_TARGETS = {"settings": 0, "layout": 1, "currency": 2}
+CONFIG_JSON = 3
+CURRENCY_VERSION = 1
+CURRENCY_MAX = 24
+CURRENCY_HEADER = struct.Struct("<HB5x")
+CURRENCY_RATE = struct.Struct("<4s4xd")     # 代码（'\0'结尾）+ 汇率
+PERF_NAMES = ["输入延迟", "绘制", "推送", "LED反馈", "蜂鸣器", "HID提交", "HID取走"]
+METRICS_HEADER = struct.Struct("<BBIBBB")    # 版本、标志、运行时间ms、计数器数、直方图数、桶数
+METRICS_TRUNCATED = 0x01
+CRASH_MAGIC = 0x44524350
+CRASH_HEADER = struct.Struct("<IBBBxIIII8s32s")    # 魔数、版本、核心、任务数、长度、CRC、运行时间、出错地址、ELF SHA、原因
+CRASH_REGISTERS = ["PC", "PS", "EXCCAUSE", "EXCVADDR"] + ["A%d" % i for i in range(16)]
+CRASH_TASK_NAME = 16
+CRASH_TASK_FAULTED = 0x01
+CRASH_TASK_RUNNING = 0x02
+KEY_EVENT = struct.Struct("<IHBB")      # KeyJournal::Entry：时刻低32位、高16位、按键、事件类型
+SCREEN_HEADER = struct.Struct("<HHBBB")     # 宽、高、块宽、块高、块数
+SCREEN_TILE = struct.Struct("<BBBH")        # 列、行、编码、长度
+TILE_QOI565 = 0
+TILE_RAW = 1
+
+
+class HostLinkError(Exception):
+    def __init__(self, message, status=None):
+        super().__init__(message)
+        self.status = status
+
+
+def parse_metrics(data):
+    """解析计数器和直方图快照：GET_METRICS应答的负载，或UART上"METRICS <hex>"一行的十六进制部分"""
+    if isinstance(data, str):
+        data = bytes.fromhex(data.split()[-1])
+    version, flags, uptime, counters, histograms, buckets = METRICS_HEADER.unpack_from(data)
+    pos = METRICS_HEADER.size
+    result = {"version": version, "truncated": bool(flags & METRICS_TRUNCATED), "uptime_ms": uptime,
+              "counters": {}, "histograms": {}}
+    for _ in range(counters):
+        length = data[pos]
+        name = data[pos + 1:pos + 1 + length].decode("utf-8", "replace")
+        pos += 1 + length
+        result["counters"][name], = struct.unpack_from("<I", data, pos)
+        pos += 4
+    for _ in range(histograms):
+        length = data[pos]
+        name = data[pos + 1:pos + 1 + length].decode("utf-8", "replace")
+        pos += 1 + length
+        # 第0桶为0，第i桶为[2^(i-1), 2^i)，最后一桶收下更大的值
+        result["histograms"][name] = list(struct.unpack_from("<%dI" % buckets, data, pos))
+        pos += 4 * buckets
+    return result
+
+
+def parse_crash(data):
+    """解析崩溃记录（GET_CRASH应答拼接后的内容，格式见CrashDump.h）"""
+    magic, version, core, task_count, length, crc, uptime, address, elf_sha, reason = CRASH_HEADER.unpack_from(data)
+    if magic != CRASH_MAGIC:
+        raise HostLinkError("不是崩溃记录")
+    body = data[CRASH_HEADER.size:CRASH_HEADER.size + length]
+    if len(body) != length or binascii.crc32(body) != crc:
+        raise HostLinkError("崩溃记录校验失败")
+    result = {"version": version, "core": core, "uptime_ms": uptime, "address": address,
+              "elf_sha": elf_sha.hex(), "reason": reason.split(b"\0")[0].decode("utf-8", "replace"),
+              "registers": dict(zip(CRASH_REGISTERS, struct.unpack_from("<%dI" % len(CRASH_REGISTERS), body))),
+              "tasks": [], "keys": []}
+    pos = 4 * len(CRASH_REGISTERS)
+    for _ in range(task_count):
+        name = body[pos:pos + CRASH_TASK_NAME].split(b"\0")[0].decode("utf-8", "replace")
+        flags, depth = body[pos + CRASH_TASK_NAME], body[pos + CRASH_TASK_NAME + 1]
+        pos += CRASH_TASK_NAME + 2
+        result["tasks"].append((name, flags, list(struct.unpack_from("<%dI" % depth, body, pos))))
+        pos += 4 * depth
+    log_length, = struct.unpack_from("<H", body, pos)
+    result["log"] = body[pos + 2:pos + 2 + log_length]
+    pos += 2 + log_length
+    key_count, = struct.unpack_from("<H", body, pos)
+    pos += 2
+    for _ in range(key_count):
+        low, high, key, event = KEY_EVENT.unpack_from(body, pos)
+        result["keys"].append(((high << 32) | low, key, event))
+        pos += KEY_EVENT.size
+    return result
+
+
+class Screen:
+    """主机侧的画面副本，按 GET_SCREEN / MIRROR 的帧逐块更新（格式见 ScreenMirror.h）"""
+
+    def __init__(self):
+        self.width = 0
+        self.height = 0
+        self.pixels = []
+
+    def apply(self, data):
+        """应用一帧，返回更新的块数"""
+        width, height, tile_w, tile_h, count = SCREEN_HEADER.unpack_from(data)
+        if (width, height) != (self.width, self.height):
+            self.width, self.height = width, height
+            self.pixels = [0] * (width * height)
+        pos = SCREEN_HEADER.size
+        for _ in range(count):
+            tx, ty, encoding, length = SCREEN_TILE.unpack_from(data, pos)
+            pos += SCREEN_TILE.size
+            chunk = data[pos:pos + length]
+            pos += length
+            x, y = tx * tile_w, ty * tile_h
+            w, h = min(tile_w, width - x), min(tile_h, height - y)
+            if encoding == TILE_RAW:
+                tile = struct.unpack("<%dH" % (w * h), chunk)
+            elif encoding == TILE_QOI565:
+                import splash_pack
+                tile = splash_pack.decode(chunk, w * h)
+            else:
+                raise HostLinkError("未知的块编码 %d" % encoding)
+            for row in range(h):
+                start = (y + row) * self.width + x
+                self.pixels[start:start + w] = tile[row * w:(row + 1) * w]
+        return count
+
+    def png(self):
+        """RGB888 PNG 文件内容"""
+        raw = bytearray()
+        for y in range(self.height):
+            raw.append(0)       # 不过滤
+            for p in self.pixels[y * self.width:(y + 1) * self.width]:
+                raw += bytes((((p >> 11) & 0x1F) * 255 // 31, ((p >> 5) & 0x3F) * 255 // 63, (p & 0x1F) * 255 // 31))
+
+        def chunk(kind, body):
+            return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", binascii.crc32(kind + body))
+
+        return (b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", struct.pack(">IIBBBBB", self.width, self.height, 8, 2, 0, 0, 0))
+                + chunk(b"IDAT", zlib.compress(bytes(raw), 6)) + chunk(b"IEND", b""))
+
+    def save(self, path):
+        # 先写临时文件再替换，查看器不会读到写了一半的图
+        temp = path + ".tmp"
+        with open(temp, "wb") as f:
+            f.write(self.png())
+        os.replace(temp, path)
+
+
+def _varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append(value & 0x7F | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def make_patch(old, new):
+    """生成差量补丁（未压缩，格式见固件 FirmwareUpdate.h）
+
+    先找至少 PATCH_BLOCK 字节完全相同的位置（优先沿用上一段的对齐），再像 bsdiff 一样
+    向后延伸到差异明显增多为止：只改了地址的代码段也归入差值区，差值（新-旧）多数为0，压缩后很小。
+    """
+    index = {}
+    for j in range(0, len(old) - PATCH_BLOCK + 1, 4):
+        index.setdefault(old[j:j + PATCH_BLOCK], j)
+
+    out = bytearray(PATCH_MAGIC + struct.pack("<I", len(old)) + hashlib.sha256(old).digest())
+    i = literal_start = old_pos = 0
+    delta = None
+    while i + PATCH_BLOCK <= len(new):
+        block = new[i:i + PATCH_BLOCK]
+        j = i + delta if delta is not None else -1
+        if j < 0 or old[j:j + PATCH_BLOCK] != block:
+            j = index.get(block)
+            if j is None:
+                i += 1
+                continue
+        # 向前延伸相同的字节，不越过字面区的起点
+        while i > literal_start and j > 0 and new[i - 1] == old[j - 1]:
+            i -= 1
+            j -= 1
+        # 向后延伸：相同+1、不同-1，取得分最高处
+        score = best = length = k = 0
+        limit = min(len(new) - i, len(old) - j)
+        while k < limit:
+            score += 1 if new[i + k] == old[j + k] else -1
+            k += 1
+            if score > best:
+                best, length = score, k
+            elif score < best - 32:
+                break
+        seek = j - old_pos
+        out += _varint(i - literal_start) + _varint(length) + _varint(seek * 2 if seek >= 0 else -seek * 2 - 1)
+        out += new[literal_start:i]
+        out += bytes((new[i + t] - old[j + t]) & 0xFF for t in range(length))
+        old_pos = j + length
+        delta = j - i
+        i += length
+        literal_start = i
+    if literal_start < len(new):
+        out += _varint(len(new) - literal_start) + _varint(0) + _varint(0) + new[literal_start:]
+    return bytes(out)
+
+
+class HostLink:
+    def __init__(self, port, timeout=2.0):
+        import serial  # pyserial
+        self._port = serial.Serial(port, timeout=timeout)
+        self._sequence = 0
+        self._buf = bytearray()
+
+    def close(self):
+        self._port.close()
+
+    def _send(self, command, payload=b""):
+        self._sequence = (self._sequence + 1) & 0xFF
+        body = struct.pack("<BBH", command, self._sequence, len(payload)) + payload
+        self._port.write(bytes([FRAME_MAGIC]) + body + struct.pack("<I", binascii.crc32(body)))
+
+    def _receive(self):
+        """读取一帧，返回 (命令, 序号, 状态, 数据)"""
+        while True:
+            start = self._buf.find(FRAME_MAGIC)
+            if start < 0:
+                self._buf.clear()
+            else:
+                del self._buf[:start]
+                if len(self._buf) >= 5:
+                    length, = struct.unpack_from("<H", self._buf, 3)
+                    size = 5 + length + 4
+                    if len(self._buf) >= size:
+                        body = bytes(self._buf[1:5 + length])
+                        crc, = struct.unpack_from("<I", self._buf, 5 + length)
+                        if crc == binascii.crc32(body) and length >= 1:
+                            del self._buf[:size]
+                            return body[0], body[1], body[4], body[5:]
+                        del self._buf[:1]       # 不是有效帧，重新同步
+                        continue
+            data = self._port.read(max(1, self._port.in_waiting))
+            if not data:
+                raise HostLinkError("等待应答超时")
+            self._buf += data
+
+    def request(self, command, payload=b""):
+        """发送请求并收集应答数据（多帧应答拼接在一起）"""
+        self._send(command, payload)
+        return self._collect(command, self._sequence)
+
+    def _frames(self, command, expected):
+        """逐帧产出 (状态, 数据)，直到状态为OK的一帧"""
+        while True:
+            reply, sequence, status, data = self._receive()
+            if reply != command | 0x80 or sequence != expected:
+                continue        # 之前请求的迟到应答
+            if status not in (STATUS_OK, STATUS_MORE):
+                name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else str(status)
+                raise HostLinkError("命令 0x%02x 失败: %s" % (command, name), status)
+            yield status, data
+            if status == STATUS_OK:
+                return
+
+    def _collect(self, command, expected):
+        return b"".join(data for _, data in self._frames(command, expected))
+
+    def ping(self):
+        version, max_payload, uptime, heap = struct.unpack("<BHII", self.request(CMD_PING))
+        return {"version": version, "max_payload": max_payload, "uptime_ms": uptime, "free_heap": heap}
+
+    def perf(self):
+        data = self.request(CMD_GET_PERF)
+        count = data[0]
+        items = [struct.unpack_from("<5I", data, 1 + i * 20) for i in range(count)]
+        dropped, = struct.unpack_from("<I", data, 1 + count * 20)
+        return items, dropped
+
+    def reset_perf(self):
+        self.request(CMD_RESET_PERF)
+
+    def metrics(self):
+        return parse_metrics(self.request(CMD_GET_METRICS))
+
+    def crash(self):
+        """上次崩溃的原始记录，没有记录时返回None"""
+        try:
+            return self.request(CMD_GET_CRASH)
+        except HostLinkError as e:
+            if e.status == STATUS_UNAVAILABLE:
+                return None
+            raise
+
+    def clear_crash(self):
+        self.request(CMD_CLEAR_CRASH)
+
+    def screen(self):
+        """整屏截图，返回 Screen"""
+        screen = Screen()
+        self._send(CMD_GET_SCREEN)
+        for _, data in self._frames(CMD_GET_SCREEN, self._sequence):
+            screen.apply(data)
+        return screen
+
+    def mirror(self, screen):
+        """打开实时镜像，每收到一帧更新 screen 并产出 (块数, 帧字节数)；生成器关闭时关闭镜像"""
+        self.request(CMD_MIRROR, b"\x01")
+        sequence = self._sequence
+        try:
+            while True:
+                try:
+                    reply, seq, status, data = self._receive()
+                except HostLinkError:
+                    continue        # 画面没有变化时设备不发送
+                if reply == CMD_MIRROR | 0x80 and seq == sequence and status == STATUS_MORE:
+                    yield screen.apply(data), len(data)
+        finally:
+            self.request(CMD_MIRROR, b"\x00")
+
+    def history(self, start, count):
+        data = self.request(CMD_GET_HISTORY, struct.pack("<HH", start, count))
+        records = []
+        pos = 0
+        while pos < len(data):
+            index, timestamp, result, length = struct.unpack_from("<HIdB", data, pos)
+            pos += 15
+            records.append((index, timestamp, result, data[pos:pos + length].decode("utf-8", "replace")))
+            pos += length
+        return records
+
+    def get_config(self, target):
+        data = self.request(CMD_GET_CONFIG, bytes([target]))
+        return data[1:]
+
+    def set_config(self, target, blob):
+        self.request(CMD_SET_CONFIG, bytes([target]) + blob)
+
+    def get_json(self):
+        """整机配置的JSON文本；每帧都以目标字节开头"""
+        self._send(CMD_GET_CONFIG, bytes([CONFIG_JSON]))
+        return b"".join(data[1:] for _, data in self._frames(CMD_GET_CONFIG, self._sequence))
+
+    def set_json(self, text):
+        """分块写入JSON文档（首块标志字节bit0置1），固件读完整份文档后才应用"""
+        chunk = MAX_PAYLOAD - 2
+        for i in range(0, max(len(text), 1), chunk):
+            flags = 1 if i == 0 else 0
+            self._send(CMD_SET_CONFIG, bytes([CONFIG_JSON, flags]) + text[i:i + chunk])
+            status, _ = next(self._frames(CMD_SET_CONFIG, self._sequence))
+        if status != STATUS_OK:
+            raise HostLinkError("JSON文档不完整")
+
+    def rates(self):
+        data = self.get_config(CONFIG_TARGETS["currency"])
+        version, count = CURRENCY_HEADER.unpack_from(data)
+        return [(code.rstrip(b"\0").decode("ascii"), rate) for code, rate in
+                (CURRENCY_RATE.unpack_from(data, CURRENCY_HEADER.size + i * CURRENCY_RATE.size) for i in range(count))]
+
+    def set_rates(self, rates):
+        """整表替换汇率，rates 为 {代码: 1基准货币兑换的数量}"""
+        if len(rates) > CURRENCY_MAX:
+            raise HostLinkError("最多 %d 种货币" % CURRENCY_MAX)
+        blob = CURRENCY_HEADER.pack(CURRENCY_VERSION, len(rates))
+        for code in sorted(rates):      # 固件按代码二分查找
+            blob += CURRENCY_RATE.pack(code.upper().encode("ascii"), rates[code])
+        self.set_config(CONFIG_TARGETS["currency"], blob)
+
+    def update(self, image, compress=True, base=None, progress=None):
+        """写入新固件：镜像按zlib压缩后分帧发送，两帧在途；设备校验SHA-256后重启
+
+        给出 base（设备上正在运行的固件）时只发送对照它生成的压缩补丁。
+        """
+        if base is not None:
+            payload, fmt = zlib.compress(make_patch(base, image), 9), UPDATE_DELTA
+        elif compress:
+            payload, fmt = zlib.compress(image, 9), UPDATE_ZLIB
+        else:
+            payload, fmt = image, UPDATE_RAW
+        self.request(CMD_UPDATE_BEGIN, struct.pack("<I", len(image)) + hashlib.sha256(image).digest() + bytes([fmt]))
+        chunk = MAX_PAYLOAD - 4
+        pending = []
+        for offset in range(0, len(payload), chunk):
+            self._send(CMD_UPDATE_DATA, struct.pack("<I", offset) + payload[offset:offset + chunk])
+            pending.append(self._sequence)
+            if len(pending) == 2:
+                self._collect(CMD_UPDATE_DATA, pending.pop(0))
+                if progress:
+                    progress(min(offset, len(payload)), len(payload))
+        for sequence in pending:
+            self._collect(CMD_UPDATE_DATA, sequence)
+        self.request(CMD_UPDATE_END)
+        return len(payload)
+
+    def eval(self, expressions):
+        """批量求值，逐个产出 (表达式, 错误码, 结果)，最后返回设备端的 (条数, 求值耗时µs)
+
+        表达式按行打包成不超过一帧负载的请求；固件在求值一批时接收下一批，
+        所以总是先发出下一个请求再收上一个的应答，链路上始终有两批。
+        """
+        batches = []
+        batch = []
+        size = 1
+        for text in expressions:
+            line = text.strip().encode("ascii") + b"\n"
+            if len(line) + 1 > MAX_PAYLOAD:
+                raise HostLinkError("表达式过长: %s" % text)
+            if size + len(line) > MAX_PAYLOAD:
+                batches.append(batch)
+                batch, size = [], 1
+            batch.append(line)
+            size += len(line)
+        if batch:
+            batches.append(batch)
+
+        count = micros = 0
+        pending = []        # (序号, 行)
+        for i in range(len(batches) + 1):
+            if i < len(batches):
+                self._send(CMD_EVAL, bytes([EVAL_TEXT]) + b"".join(batches[i]))
+                pending.append((self._sequence, batches[i]))
+            if not pending or (len(pending) < 2 and i < len(batches)):
+                continue
+            sequence, lines = pending.pop(0)
+            data = self._collect(CMD_EVAL, sequence)
+            for j, line in enumerate(lines):
+                error, result = EVAL_RESULT.unpack_from(data, j * EVAL_RESULT.size)
+                yield line[:-1].decode("ascii"), error, result
+            n, us = struct.unpack_from("<II", data, len(lines) * EVAL_RESULT.size)
+            count += n
+            micros += us
+        return count, micros
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PawCounter USB CDC 主机通道")
+    parser.add_argument("--port", required=True, help="CDC 串口（如 COM4、/dev/ttyACM0）")
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("ping", help="协议版本、运行时间、可用堆")
+    perf = sub.add_parser("perf", help="性能统计")
+    perf.add_argument("--reset", action="store_true", help="读取后清空")
+    metrics = sub.add_parser("metrics", help="计数器和直方图")
+    metrics.add_argument("--json", action="store_true", help="输出JSON（监控脚本用）")
+    crash = sub.add_parser("crash", help="上次崩溃的记录：原因、寄存器、各任务回溯、最近日志和按键")
+    crash.add_argument("--table", help="logfmt.json 或 firmware.elf，给出时解码最近日志")
+    crash.add_argument("--out", help="另存原始记录")
+    crash.add_argument("--clear", action="store_true", help="取回后清除，记录区重新就绪")
+    sub.add_parser("screen", help="截图保存为PNG").add_argument("file")
+    mirror = sub.add_parser("mirror", help="实时镜像：画面变化时重写PNG，Ctrl+C结束")
+    mirror.add_argument("file")
+    mirror.add_argument("--interval", type=float, default=0.2, help="两次写文件的最短间隔（秒）")
+    history = sub.add_parser("history", help="计算历史")
+    history.add_argument("--start", type=int, default=0, help="起始序号，0为最新")
+    history.add_argument("--count", type=int, default=0xFFFF)
+    for name, text in (("config-get", "读取配置到文件"), ("config-set", "从文件写入配置")):
+        cmd = sub.add_parser(name, help=text)
+        cmd.add_argument("target", choices=sorted(CONFIG_TARGETS))
+        cmd.add_argument("file")
+    for name, text in (("json-get", "导出整机配置JSON到文件"), ("json-set", "从JSON文件导入整机配置")):
+        sub.add_parser(name, help=text).add_argument("file")
+    rates = sub.add_parser("rates", help="显示汇率表，给出文件时整表更新")
+    rates.add_argument("file", nargs="?", help="每行：货币代码,1基准货币兑换的数量")
+    update = sub.add_parser("update", help="写入新固件并重启")
+    update.add_argument("file", help="固件镜像（.pio/build/esp32-s3/firmware.bin）")
+    update.add_argument("--raw", action="store_true", help="不压缩传输")
+    update.add_argument("--base", help="设备上正在运行的固件镜像，给出时只发送差量补丁")
+    evaluate = sub.add_parser("eval", help="批量求值（每行一个表达式）")
+    evaluate.add_argument("file", help="表达式文件，- 为标准输入")
+    args = parser.parse_args()
+
+    link = HostLink(args.port)
+    try:
+        if args.command == "ping":
+            for key, value in link.ping().items():
+                print("%-12s %s" % (key, value))
+        elif args.command == "perf":
+            items, dropped = link.perf()
+            for i, (count, low, avg, p99, high) in enumerate(items):
+                name = PERF_NAMES[i] if i < len(PERF_NAMES) else "#%d" % i
+                print("%-8s n=%-6d min=%-6d avg=%-6d p99=%-6d max=%d (µs)" % (name, count, low, avg, p99, high))
+            print("日志丢弃: %d 条" % dropped)
+            if args.reset:
+                link.reset_perf()
+        elif args.command == "metrics":
+            snapshot = link.metrics()
+            if args.json:
+                import json
+                print(json.dumps(snapshot, ensure_ascii=False))
+            else:
+                for name, value in snapshot["counters"].items():
+                    print("%-24s %d" % (name, value))
+                for name, counts in snapshot["histograms"].items():
+                    print("%-24s n=%d  %s" % (name, sum(counts), " ".join(
+                        "%s:%d" % ("0" if i == 0 else "<%d" % (1 << i) if i < len(counts) - 1
+                                   else ">=%d" % (1 << (i - 1)), n)
+                        for i, n in enumerate(counts) if n)))
+                if snapshot["truncated"]:
+                    print("（快照超出一帧，部分项略去）")
+        elif args.command == "crash":
+            data = link.crash()
+            if data is None:
+                print("没有崩溃记录")
+                return
+            if args.out:
+                with open(args.out, "wb") as f:
+                    f.write(data)
+            record = parse_crash(data)
+            print("运行 %.3f s 时在核心%d崩溃: %s" % (record["uptime_ms"] / 1000.0, record["core"], record["reason"]))
+            print("出错地址 0x%08x，固件ELF %s" % (record["address"], record["elf_sha"]))
+            regs = record["registers"]
+            for i in range(0, len(CRASH_REGISTERS), 4):
+                print("  " + "  ".join("%-8s 0x%08x" % (name, regs[name]) for name in CRASH_REGISTERS[i:i + 4]))
+            print("各任务回溯（xtensa-esp32s3-elf-addr2line -pfiaC -e firmware.elf 地址...）:")
+            for name, flags, pcs in record["tasks"]:
+                mark = "出错" if flags & CRASH_TASK_FAULTED else "运行中" if flags & CRASH_TASK_RUNNING else ""
+                print("  %-16s %-6s %s" % (name, mark, " ".join("0x%08x" % pc for pc in pcs)))
+            print("最近日志（%d 字节）:" % len(record["log"]))
+            if args.table:
+                import log_decode
+                log_decode.decode_stream([record["log"]], log_decode.StringTable.load(args.table), sys.stdout)
+            else:
+                print("  （--table 指定 logfmt.json 或 firmware.elf 后解码）")
+            print("最近按键（%d 条）:" % len(record["keys"]))
+            for time_us, key, event in record["keys"]:
+                print("  %12.3f ms  键 %3d  事件 %d" % (time_us / 1000.0, key, event))
+            if args.clear:
+                link.clear_crash()
+                print("记录已清除")
+        elif args.command == "screen":
+            screen = link.screen()
+            screen.save(args.file)
+            print("%dx%d -> %s" % (screen.width, screen.height, args.file))
+        elif args.command == "mirror":
+            screen = Screen()
+            frames = link.mirror(screen)
+            tiles = received = 0
+            started = saved = time.time()
+            dirty = False
+            try:
+                for count, size in frames:
+                    tiles += count
+                    received += size
+                    dirty = True
+                    now = time.time()
+                    if now - saved >= args.interval:
+                        screen.save(args.file)
+                        saved, dirty = now, False
+                        print("\r%d 块，%.1f KB/s" % (tiles, received / 1024.0 / (now - started)), end="", flush=True)
+            except KeyboardInterrupt:
+                frames.close()
+                if dirty:
+                    screen.save(args.file)
+                print()
+        elif args.command == "history":
+            for index, timestamp, result, text in link.history(args.start, args.count):
+                print("#%-5d %10.3fs  %s" % (index, timestamp / 1000.0, text))
+        elif args.command == "config-get":
+            blob = link.get_config(CONFIG_TARGETS[args.target])
+            with open(args.file, "wb") as f:
+                f.write(blob)
+            print("读取 %d 字节 -> %s" % (len(blob), args.file))
+        elif args.command == "config-set":
+            with open(args.file, "rb") as f:
+                blob = f.read()
+            link.set_config(CONFIG_TARGETS[args.target], blob)
+            print("已写入 %d 字节" % len(blob))
+        elif args.command == "json-get":
+            text = link.get_json()
+            with open(args.file, "wb") as f:
+                f.write(text)
+            print("导出 %d 字节 -> %s" % (len(text), args.file))
+        elif args.command == "json-set":
+            with open(args.file, "rb") as f:
+                text = f.read()
+            link.set_json(text)
+            print("已导入 %d 字节" % len(text))
+        elif args.command == "rates":
+            if args.file:
+                table = {}
+                with open(args.file, encoding="utf-8") as f:
+                    for line in f:
+                        fields = line.replace(",", " ").split()
+                        if fields and not fields[0].startswith("#"):
+                            table[fields[0].upper()] = float(fields[1])
+                link.set_rates(table)
+            for code, rate in link.rates():
+                print("%s  %.6f" % (code, rate))
+        elif args.command == "update":
+            with open(args.file, "rb") as f:
+                image = f.read()
+            base = None
+            if args.base:
+                with open(args.base, "rb") as f:
+                    base = f.read()
+            start = time.time()
+            sent = link.update(image, not args.raw, base,
+                               lambda done, total: print("\r%3d%%" % (done * 100 // total), end="", flush=True))
+            print("\r已写入 %d 字节（传输 %d 字节，%.1f 秒），设备正在重启" % (len(image), sent, time.time() - start))
+        elif args.command == "eval":
+            source = sys.stdin if args.file == "-" else open(args.file, encoding="utf-8")
+            with source:
+                lines = [line for line in source if line.strip()]
+            started = time.perf_counter()
+            results = link.eval(lines)
+            while True:
+                try:
+                    text, error, result = next(results)
+                except StopIteration as done:
+                    count, micros = done.value
+                    break
+                print("%s = %s" % (text, repr(result) if not error else "错误(%s)" % EVAL_ERRORS[error]))
+            elapsed = time.perf_counter() - started
+            print("%d 个表达式：设备求值 %.0f 个/秒，端到端 %.0f 个/秒" % (
+                count, count / (micros / 1e6) if micros else 0, count / elapsed if elapsed else 0),
+                file=sys.stderr)
+    except HostLinkError as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+    finally:
+        link.close()
+
+
+if __name__ == "__main__":
+    main()
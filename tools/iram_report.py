@@ -0,0 +1,68 @@
+# project/tools/iram_report.py
+# 构建后报告IRAM用量：IRAM段的总大小，以及其中本项目的函数（IRAM_ATTR放置的热路径）
+import os
+import struct
+import subprocess
+from SCons.Script import DefaultEnvironment
+
+env = DefaultEnvironment()
+
+SHT_SYMTAB = 2
+STT_FUNC = 2
+IRAM_SECTIONS = (".iram0.vectors", ".iram0.text")
+
+
+def read_elf(path):
+    """返回 ({段名: (序号, 大小)}, [(名称, 大小, 段序号)])，只取函数符号"""
+    with open(path, "rb") as f:
+        data = f.read()
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+    headers = [struct.unpack_from("<10I", data, shoff + i * shentsize) for i in range(shnum)]
+
+    def cstr(offset):
+        return data[offset:data.index(b"\0", offset)].decode("utf-8", "replace")
+
+    names = headers[shstrndx][4]
+    sections = {cstr(names + h[0]): (i, h[5]) for i, h in enumerate(headers)}
+
+    symbols = []
+    for h in headers:
+        if h[1] != SHT_SYMTAB:
+            continue
+        strtab = headers[h[6]][4]
+        for off in range(h[4], h[4] + h[5], 16):
+            name, _, size, info, _, shndx = struct.unpack_from("<IIIBBH", data, off)
+            if info & 0xF == STT_FUNC and size:
+                symbols.append((cstr(strtab + name), size, shndx))
+    return sections, symbols
+
+
+def demangle(names):
+    cxxfilt = env.subst("$CC").replace("gcc", "c++filt")
+    try:
+        out = subprocess.run([cxxfilt], input="\n".join(names), capture_output=True, text=True, check=True)
+        return out.stdout.splitlines()
+    except (OSError, subprocess.CalledProcessError):
+        return names
+
+
+def report_iram(source, target, env):
+    sections, symbols = read_elf(str(target[0]))
+    iram = {sections[s][0] for s in IRAM_SECTIONS if s in sections}
+    total = sum(sections[s][1] for s in IRAM_SECTIONS if s in sections)
+    print(f"⮕ IRAM: {total / 1024:.1f} KB (" +
+          ", ".join(f"{s} {sections[s][1]}" for s in IRAM_SECTIONS if s in sections) + ")")
+
+    # 本项目的类：src/下每个头文件一个
+    src = env.subst("$PROJECT_SRC_DIR")
+    classes = tuple(os.path.splitext(f)[0] + "::" for f in os.listdir(src) if f.endswith(".h"))
+    hot = [(name, size) for name, size, shndx in symbols if shndx in iram]
+    hot = [(d, size) for d, (_, size) in zip(demangle([n for n, _ in hot]), hot) if d.startswith(classes)]
+    hot.sort(key=lambda item: -item[1])
+    print(f"   项目热路径: {len(hot)} 个函数, {sum(size for _, size in hot)} bytes")
+    for name, size in hot:
+        print(f"   {size:6d}  {name}")
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report_iram)
@@ -0,0 +1,337 @@
+# project/tools/layout_compile.py
+"""
+布局编译：把 layouts/keypad.layout 编译为编译期的按键表
+  - src/LayoutData.h：各布局方案的 [层][位置] KeyConfig 表和方案表 PROFILES（只由 KeyboardConfig.cpp 包含）
+  - src/LayoutKeys.h：按物理按键的属性（计算器方案下HID模式发送的键码、直通键码、按键反馈颜色）
+
+布局文件是按行的文本，行首或空白之后的 # 开始注释，字段用空白分隔（字段中不能有空白）：
+  profile <名称> <表名> [calculator] [custom] [mode=STANDARD|PROGRAMMER|STATISTICS|BUSINESS]
+      开始一个方案；表名生成 <表名>_KEYS；第一个方案为默认方案，必须是 calculator custom
+  layer primary|secondary [from <表名>]
+      开始一层；from 先复制另一方案已定义的同一层，之后的行按位置替换
+  <位置> <类型> <符号> <标签> [属性...]
+      类型为 KeyType 的名称，另有 HID（RESERVED，输出由 hid= 决定）；位置 1-22，未列出的位置为空
+      属性：op=<Operator>  fn=<函数名或宏序列>  hid=<键码>  hold[=<ms>]  repeat
+            host=<键码>  pass=<键码>  color=<颜色>（后三项只用于默认方案的主层）
+  <位置> -
+      清空该位置（用于 from 复制的层）
+键码：'c'（字符）、0x..（数值）、键名（RETURN、ESC 等，见 KEY_NAMES）、
+      usage:0x..（0x88 + 键盘Usage）、consumer:0x.. / system:0x..（独立报告，见 HID_CODE_CONSUMER）
+颜色：0xRRGGBB 或 COLOR_NAMES 中的名称，未给出时为白色
+
+生成的头文件随仓库提交；构建时作为 pre 脚本运行，布局文件或脚本比生成文件新时重新生成。
+
+用法：
+    python tools/layout_compile.py
+"""
+import os
+import re
+
+KEY_COUNT = 22
+LAYERS = ("primary", "secondary")
+
+KEY_TYPES = ("NUMBER", "OPERATOR", "FUNCTION", "DECIMAL", "MODE_SWITCH", "LAYER_SWITCH",
+             "CLEAR", "DELETE", "MEMORY", "POWER", "RESERVED", "MACRO")
+OPERATORS = ("NONE", "ADD", "SUBTRACT", "MULTIPLY", "DIVIDE", "EQUALS", "PERCENT", "SQUARE_ROOT",
+             "SQUARE", "RECIPROCAL", "POWER", "SIN", "COS", "TAN", "LN", "LOG10", "EXP", "MODULO",
+             "BIT_AND", "BIT_OR", "BIT_XOR", "SHIFT_LEFT", "SHIFT_RIGHT", "BIT_NOT", "TAX_PLUS",
+             "TAX_MINUS", "MARKUP", "DISCOUNT", "GRAND_TOTAL")
+MODES = ("STANDARD", "PROGRAMMER", "STATISTICS", "BUSINESS")
+
+# Arduino USBHIDKeyboard::press() 的特殊键（0x88 + HID Usage）
+KEY_NAMES = {
+    "RETURN": 0xB0, "ESC": 0xB1, "BACKSPACE": 0xB2, "TAB": 0xB3, "F2": 0xC3,
+    "DELETE": 0xD4, "RIGHT": 0xD7, "LEFT": 0xD8, "DOWN": 0xD9, "UP": 0xDA,
+}
+PAGES = {"consumer": 0x1000, "system": 0x2000}  # 同 KeyboardConfig.h 的 HID_CODE_CONSUMER / HID_CODE_SYSTEM
+USAGE_OFFSET = 0x88
+
+COLOR_NAMES = {
+    "white": 0xFFFFFF, "red": 0xFF0000, "green": 0x008000, "blue": 0x0000FF,
+    "orange": 0xFFA500, "yellow": 0xFFFF00, "cyan": 0x00FFFF, "purple": 0x800080,
+}
+DEFAULT_COLOR = COLOR_NAMES["white"]
+
+COMMENT = re.compile(r"(^|\s)#.*")
+
+
+class LayoutError(ValueError):
+    def __init__(self, path, line, message):
+        ValueError.__init__(self, "%s:%d: %s" % (path, line, message))
+
+
+class Key(object):
+    def __init__(self, position, kind, symbol, label):
+        self.position = position
+        self.kind = kind
+        self.symbol = symbol
+        self.label = label
+        self.op = "NONE"
+        self.fn = ""
+        self.code = 0
+        self.hold = None
+        self.repeat = False
+
+    def copy(self):
+        key = Key(self.position, self.kind, self.symbol, self.label)
+        key.__dict__.update(self.__dict__)
+        return key
+
+
+class Profile(object):
+    def __init__(self, name, table, calculator, custom, mode):
+        self.name = name
+        self.table = table
+        self.calculator = calculator
+        self.custom = custom
+        self.mode = mode
+        self.layers = [{} for _ in LAYERS]
+
+
+def parse_code(text):
+    page, sep, value = text.partition(":")
+    if sep:
+        if page == "usage":
+            code = USAGE_OFFSET + int(value, 0)
+            limit = 0xFF
+        elif page in PAGES:
+            code = PAGES[page] | int(value, 0)
+            limit = PAGES[page] | 0xFFF
+        else:
+            raise ValueError("未知的键码类别 %s" % page)
+        if int(value, 0) < 0 or code > limit:
+            raise ValueError("键码超出范围 %s" % text)
+        return code
+    if len(text) == 3 and text[0] == text[2] == "'":
+        return ord(text[1])
+    if text in KEY_NAMES:
+        return KEY_NAMES[text]
+    code = int(text, 0)
+    if not 0 <= code <= 0xFFF:
+        raise ValueError("键码超出范围 %s" % text)
+    return code
+
+
+def parse_color(text):
+    if text in COLOR_NAMES:
+        return COLOR_NAMES[text]
+    color = int(text, 16) if text.lower().startswith("0x") else None
+    if color is None or not 0 <= color <= 0xFFFFFF:
+        raise ValueError("无效的颜色 %s" % text)
+    return color
+
+
+def parse(path):
+    """返回 (方案列表, 各物理按键的 {host, pass, color})"""
+    profiles = []
+    tables = {}
+    physical = [{"host": 0, "pass": 0, "color": DEFAULT_COLOR} for _ in range(KEY_COUNT)]
+    profile = None
+    layer = None
+
+    with open(path, encoding="utf-8") as f:
+        lines = f.read().splitlines()
+    for number, line in enumerate(lines, 1):
+        fields = COMMENT.sub("", line).split()
+        if not fields:
+            continue
+        try:
+            if fields[0] == "profile":
+                if len(fields) < 3:
+                    raise ValueError("profile 需要名称和表名")
+                flags = fields[3:]
+                mode = "STANDARD"
+                for flag in flags:
+                    if flag.startswith("mode="):
+                        mode = flag[5:]
+                        if mode not in MODES:
+                            raise ValueError("未知的模式 %s" % mode)
+                    elif flag not in ("calculator", "custom"):
+                        raise ValueError("未知的方案属性 %s" % flag)
+                table = fields[2]
+                if not table.isupper() or not table.replace("_", "").isalnum() or table in tables:
+                    raise ValueError("表名 %s 无效或重复" % table)
+                profile = Profile(fields[1], table, "calculator" in flags, "custom" in flags, mode)
+                if not profiles and not (profile.calculator and profile.custom):
+                    raise ValueError("第一个方案是默认方案，必须是 calculator custom")
+                profiles.append(profile)
+                tables[table] = profile
+                layer = None
+            elif fields[0] == "layer":
+                if profile is None:
+                    raise ValueError("layer 之前没有 profile")
+                if len(fields) not in (2, 4) or fields[1] not in LAYERS or \
+                        (len(fields) == 4 and fields[2] != "from"):
+                    raise ValueError("应为 layer primary|secondary [from <表名>]")
+                layer = LAYERS.index(fields[1])
+                if profile.layers[layer]:
+                    raise ValueError("%s 层重复定义" % fields[1])
+                if len(fields) == 4:
+                    source = tables.get(fields[3])
+                    if source is None or source is profile:
+                        raise ValueError("from 的方案 %s 未定义" % fields[3])
+                    profile.layers[layer] = dict((p, k.copy()) for p, k in source.layers[layer].items())
+            else:
+                if layer is None:
+                    raise ValueError("按键行之前没有 layer")
+                parse_key(fields, profile, layer, physical, profile is profiles[0])
+        except ValueError as e:
+            if isinstance(e, LayoutError):
+                raise
+            raise LayoutError(path, number, str(e))
+
+    if not profiles:
+        raise LayoutError(path, len(lines), "没有定义任何方案")
+    return profiles, physical
+
+
+def parse_key(fields, profile, layer, physical, default_profile):
+    position = int(fields[0])
+    if not 1 <= position <= KEY_COUNT:
+        raise ValueError("位置 %d 超出 1-%d" % (position, KEY_COUNT))
+    keys = profile.layers[layer]
+    if fields[1:] == ["-"]:
+        keys.pop(position, None)
+        return
+    if len(fields) < 4:
+        raise ValueError("按键行应为 <位置> <类型> <符号> <标签> [属性...]")
+    kind = "RESERVED" if fields[1] == "HID" else fields[1]
+    if kind not in KEY_TYPES:
+        raise ValueError("未知的按键类型 %s" % fields[1])
+    key = Key(position, kind, fields[2], fields[3])
+    for attr in fields[4:]:
+        name, sep, value = attr.partition("=")
+        if name == "op" and sep:
+            if value not in OPERATORS:
+                raise ValueError("未知的运算符 %s" % value)
+            key.op = value
+        elif name == "fn" and sep:
+            key.fn = value
+        elif name == "hid" and sep:
+            key.code = parse_code(value)
+        elif name == "hold":
+            key.hold = int(value) if sep else "TAP_HOLD_DEFAULT_MS"
+        elif name == "repeat" and not sep:
+            key.repeat = True
+        elif name in ("host", "pass", "color") and sep:
+            if not (default_profile and layer == 0):
+                raise ValueError("%s= 只用于默认方案的主层" % name)
+            if name == "color":
+                physical[position - 1]["color"] = parse_color(value)
+            else:
+                code = parse_code(value)
+                if name == "pass" and code > 0xFF:
+                    raise ValueError("直通键码只能是键盘键码")
+                physical[position - 1][name] = code
+        else:
+            raise ValueError("未知的按键属性 %s" % attr)
+    if fields[1] == "HID" and not key.code:
+        raise ValueError("HID 按键需要 hid=")
+    keys[position] = key
+
+
+def c_string(text):
+    return '"%s"' % text.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def key_initializer(position, key):
+    if key is None:
+        return "{%d, KeyType::RESERVED, nullptr, nullptr, Operator::NONE, \"\", 0, false, 0, false}," % position
+    return "{%d, KeyType::%s, %s, %s, Operator::%s, %s, %s, false, %s, %s}," % (
+        position, key.kind, c_string(key.symbol), c_string(key.label), key.op, c_string(key.fn),
+        "0x%X" % key.code if key.code else "0", key.hold or 0, "true" if key.repeat else "false")
+
+
+def write_file(output, lines):
+    with open(output, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+def write_data(output, source, profiles):
+    lines = [
+        "// 由 tools/layout_compile.py 从 %s 生成，不要手工修改" % source,
+        "// %d 个布局方案" % len(profiles),
+        "",
+        "#ifndef LAYOUT_DATA_H",
+        "#define LAYOUT_DATA_H",
+        "",
+        "#include \"KeyboardConfig.h\"",
+        "",
+    ]
+    for profile in profiles:
+        lines.append("// %s" % profile.name)
+        lines.append("constexpr KeyConfig %s_KEYS[KeyboardConfigManager::LAYER_COUNT][KeyboardConfigManager::KEY_COUNT + 1] = {"
+                     % profile.table)
+        for name, keys in zip(LAYERS, profile.layers):
+            lines.append("    {   // %s" % name)
+            for position in range(KEY_COUNT + 1):
+                lines.append("        " + key_initializer(position, keys.get(position)))
+            lines.append("    },")
+        lines += ["};", ""]
+    lines.append("constexpr KeyboardConfigManager::LayoutProfile PROFILES[] = {")
+    for profile in profiles:
+        lines.append("    {%s, %s_KEYS, %s, %s, CalcMode::%s}," % (
+            c_string(profile.name), profile.table, "true" if profile.calculator else "false",
+            "true" if profile.custom else "false", profile.mode))
+    lines += ["};", "", "#endif // LAYOUT_DATA_H", ""]
+    write_file(output, lines)
+
+
+def write_keys(output, source, profiles, physical):
+    symbols = profiles[0].layers[0]
+    labels = ["%-2d %s" % (i + 1, symbols[i + 1].symbol if i + 1 in symbols else "-") for i in range(KEY_COUNT)]
+    lines = [
+        "// 由 tools/layout_compile.py 从 %s 生成，不要手工修改" % source,
+        "// 按物理按键（下标为位置-1）的属性，来自默认方案（%s）的主层" % profiles[0].name,
+        "",
+        "#ifndef LAYOUT_KEYS_H",
+        "#define LAYOUT_KEYS_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "static const uint8_t LAYOUT_KEY_COUNT = %d;" % KEY_COUNT,
+        "",
+        "// 计算器方案下HID模式发送的键码（见 SimpleHID::getHIDKeyCode()），0表示不发送",
+        "static const uint16_t LAYOUT_HOST_CODES[%d] = {" % KEY_COUNT,
+    ]
+    lines += ["    0x%04X,    // %s" % (k["host"], label) for k, label in zip(physical, labels)]
+    lines += [
+        "};",
+        "",
+        "// 直通模式的键码（0x88 + 键盘Usage），0表示无映射",
+        "static const uint8_t LAYOUT_PASSTHROUGH_CODES[%d] = {" % KEY_COUNT,
+    ]
+    lines += ["    0x%02X,    // %s" % (k["pass"], label) for k, label in zip(physical, labels)]
+    lines += [
+        "};",
+        "",
+        "// 按键反馈颜色（0xRRGGBB）",
+        "static const uint32_t LAYOUT_KEY_COLORS[%d] = {" % KEY_COUNT,
+    ]
+    lines += ["    0x%06X,    // %s" % (k["color"], label) for k, label in zip(physical, labels)]
+    lines += ["};", "", "#endif // LAYOUT_KEYS_H", ""]
+    write_file(output, lines)
+
+
+def compile_layout(project_dir, force=False):
+    source = os.path.join(project_dir, "layouts", "keypad.layout")
+    data_out = os.path.join(project_dir, "src", "LayoutData.h")
+    keys_out = os.path.join(project_dir, "src", "LayoutKeys.h")
+    newest = max(os.path.getmtime(source), os.path.getmtime(__file__))
+    if not force and all(os.path.isfile(p) and os.path.getmtime(p) >= newest for p in (data_out, keys_out)):
+        return
+
+    profiles, physical = parse(source)
+    relative = os.path.relpath(source, project_dir).replace(os.sep, "/")
+    write_data(data_out, relative, profiles)
+    write_keys(keys_out, relative, profiles, physical)
+    print("⮕ layout_compile: %s -> %s, %s (%d 个方案)" % (relative, data_out, keys_out, len(profiles)))
+
+
+if __name__ == "__main__":
+    compile_layout(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), force=True)
+elif __name__ != "layout_compile":
+    from SCons.Script import DefaultEnvironment
+
+    env = DefaultEnvironment()
+    compile_layout(env.subst("$PROJECT_DIR"))
@@ -0,0 +1,292 @@
+# project/tools/log_decode.py
+"""
+二进制日志解码（Logger 的 binaryOutput 模式）
+
+固件每条日志输出一帧：
+    0xFF | 长度 | 级别 | 时间戳 | 标签地址 | 格式串地址 | 打包参数 | 校验和
+  - 级别：低7位为 log_level_t，最高位表示参数没有保存完整
+  - 时间戳、整数参数：LEB128 变长整数，%d/%i 和 '*' 先做 zigzag
+  - 浮点参数：8 字节 double（小端）
+  - 字符串参数：长度字节 + UTF-8 内容，长度 0xFF 表示没有保存
+  - 校验和：长度之后、校验和之前所有字节之和的低8位
+格式串和标签按地址从字符串表中查找。字符串表在构建后由 tools/log_table.py
+从 firmware.elf 提取为 logfmt.json，也可以直接使用 firmware.elf。
+帧以外的字节（启动信息、Serial.printf 等）原样输出。
+
+用法：
+    python tools/log_decode.py .pio/build/esp32-s3/logfmt.json --port COM3
+    python tools/log_decode.py .pio/build/esp32-s3/firmware.elf < capture.bin
+    python tools/log_decode.py --extract firmware.elf logfmt.json
+"""
+import argparse
+import bisect
+import codecs
+import json
+import re
+import struct
+import sys
+
+FRAME_MAGIC = 0xFF
+LEVEL_CHARS = "NEWIDV"
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+
+
+def extract_strings(elf_path):
+    """从 ELF 的只读/数据段中取出所有以 NUL 结尾的 UTF-8 字符串，返回 [(地址, 文本)]"""
+    with open(elf_path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1:
+        raise ValueError("不是 32 位 ELF 文件: %s" % elf_path)
+
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+    strings = []
+    for i in range(shnum):
+        _, sh_type, flags, addr, offset, size = struct.unpack_from("<6I", data, shoff + i * shentsize)
+        if sh_type == SHT_NOBITS or not flags & SHF_ALLOC or flags & SHF_EXECINSTR or addr == 0 or size == 0:
+            continue
+        section = data[offset:offset + size]
+        start = 0
+        while start < len(section):
+            end = section.find(b"\0", start)
+            if end < 0:
+                break
+            if end > start:
+                try:
+                    text = section[start:end].decode("utf-8")
+                    if not re.search(r"[\x00-\x08\x0b\x0c\x0e-\x1a\x1c-\x1f\x7f]", text):
+                        strings.append((addr + start, text))
+                except UnicodeDecodeError:
+                    pass
+            start = end + 1
+    return strings
+
+
+def write_table(elf_path, output):
+    """提取字符串表并保存为 JSON，返回字符串条数"""
+    strings = extract_strings(elf_path)
+    with open(output, "w", encoding="utf-8") as f:
+        json.dump([["%08x" % addr, text] for addr, text in strings], f, ensure_ascii=False)
+    return len(strings)
+
+
+class StringTable:
+    """按地址查找字符串，地址可以落在字符串中间（编译器合并了公共后缀）"""
+
+    def __init__(self, strings):
+        strings = sorted(strings)
+        self._addresses = [addr for addr, _ in strings]
+        self._texts = [text.encode("utf-8") for _, text in strings]
+
+    @classmethod
+    def load(cls, path):
+        if path.endswith(".json"):
+            with open(path, encoding="utf-8") as f:
+                return cls([(int(addr, 16), text) for addr, text in json.load(f)])
+        return cls(extract_strings(path))
+
+    def lookup(self, address):
+        i = bisect.bisect_right(self._addresses, address) - 1
+        if i >= 0:
+            offset = address - self._addresses[i]
+            if offset < len(self._texts[i]):
+                return self._texts[i][offset:].decode("utf-8", "replace")
+        return None
+
+
+class Reader:
+    def __init__(self, payload):
+        self.data = payload
+        self.pos = 0
+
+    def byte(self):
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def varint(self):
+        value = shift = 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                return value
+
+    def signed(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def u32(self):
+        value, = struct.unpack_from("<I", self.data, self.pos)
+        self.pos += 4
+        return value
+
+    def double(self):
+        value, = struct.unpack_from("<d", self.data, self.pos)
+        self.pos += 8
+        return value
+
+    def string(self):
+        length = self.byte()
+        if length == 0xFF:
+            return "..."
+        text = self.data[self.pos:self.pos + length].decode("utf-8", "replace")
+        self.pos += length
+        return text
+
+    def done(self):
+        return self.pos >= len(self.data)
+
+
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?[hlzjtL]*([a-zA-Z%])")
+
+
+def render(fmt, reader, truncated):
+    """按 C 格式串从帧中取出参数并格式化"""
+    out = []
+    last = 0
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, width, precision, conversion = m.groups()
+        if conversion == "%":
+            out.append("%")
+            continue
+        if reader.done():
+            if truncated:
+                out.append("...")
+            return "".join(out)
+
+        if width == "*":
+            width = str(reader.signed())
+        if precision == "*":
+            precision = str(reader.signed())
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+
+        if conversion in "di":
+            out.append((spec + "d") % reader.signed())
+        elif conversion in "uxXo":
+            out.append((spec + ("d" if conversion == "u" else conversion)) % reader.varint())
+        elif conversion == "c":
+            out.append((spec + "c") % reader.varint())
+        elif conversion in "fFeEgG":
+            out.append((spec + conversion) % reader.double())
+        elif conversion in "aA":
+            text = reader.double().hex()
+            out.append(text.upper() if conversion == "A" else text)
+        elif conversion == "s":
+            out.append((spec + "s") % reader.string())
+        elif conversion == "p":
+            out.append((spec + "s") % ("0x%x" % reader.varint()))
+        else:
+            reader.varint()     # %n
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode_frame(payload, table):
+    reader = Reader(payload)
+    level = reader.byte()
+    timestamp = reader.varint()
+    tag_address = reader.u32()
+    fmt_address = reader.u32()
+
+    tag = table.lookup(tag_address) or "0x%08x" % tag_address
+    fmt = table.lookup(fmt_address)
+    if fmt is None:
+        message = "<未知格式串 0x%08x>" % fmt_address
+    else:
+        message = render(fmt, reader, level & 0x80).rstrip("\n")
+    level_char = LEVEL_CHARS[level & 0x7F] if (level & 0x7F) < len(LEVEL_CHARS) else "?"
+    return "[%s] %d.%03d %s: %s" % (level_char, timestamp // 1000, timestamp % 1000, tag, message)
+
+
+def decode_stream(chunks, table, out):
+    """从字节流中找出帧并解码，其余字节原样输出"""
+    buf = bytearray()
+    text_decoder = codecs.getincrementaldecoder("utf-8")("replace")     # 多字节字符可能跨块
+    at_line_start = True
+
+    def emit_text(data):
+        nonlocal at_line_start
+        if data:
+            out.write(text_decoder.decode(data))
+            at_line_start = data.endswith(b"\n")
+
+    for chunk in chunks:
+        buf += chunk
+        while True:
+            start = buf.find(FRAME_MAGIC)
+            if start < 0:
+                emit_text(bytes(buf))
+                buf.clear()
+                break
+            emit_text(bytes(buf[:start]))
+            del buf[:start]
+            if len(buf) < 2 or len(buf) < buf[1] + 3:
+                break       # 帧不完整，等更多数据
+
+            length = buf[1]
+            payload = bytes(buf[2:2 + length])
+            if sum(payload) & 0xFF != buf[2 + length]:
+                del buf[:1]     # 不是有效帧，跳过起始字节继续同步
+                continue
+            del buf[:length + 3]
+
+            try:
+                line = decode_frame(payload, table)
+            except (IndexError, struct.error, ValueError, TypeError) as e:
+                line = "<帧解码失败: %s>" % e
+            if not at_line_start:
+                out.write("\n")
+            out.write(line + "\n")
+            at_line_start = True
+        out.flush()
+
+
+def read_chunks(args):
+    if args.port:
+        import serial  # pyserial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            while True:
+                data = port.read(4096)
+                if data:
+                    yield data
+    else:
+        source = open(args.input, "rb") if args.input else sys.stdin.buffer
+        while True:
+            data = source.read1(4096) if hasattr(source, "read1") else source.read(4096)
+            if not data:
+                return
+            yield data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="解码 PawCounter 二进制日志")
+    parser.add_argument("table", nargs="?", help="logfmt.json 或 firmware.elf")
+    parser.add_argument("input", nargs="?", help="抓取的串口数据文件（默认读标准输入）")
+    parser.add_argument("--port", help="直接读取串口（需要 pyserial）")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--extract", nargs=2, metavar=("ELF", "JSON"), help="从 ELF 提取字符串表")
+    args = parser.parse_args()
+
+    if args.extract:
+        elf, output = args.extract
+        print("提取 %d 条字符串 -> %s" % (write_table(elf, output), output))
+        return
+    if not args.table:
+        parser.error("需要指定 logfmt.json 或 firmware.elf")
+
+    table = StringTable.load(args.table)
+    try:
+        decode_stream(read_chunks(args), table, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,19 @@
+# project/tools/log_table.py
+# 构建后从 firmware.elf 提取日志字符串表（logfmt.json），供 tools/log_decode.py 解码二进制日志
+import os
+import sys
+from SCons.Script import DefaultEnvironment
+
+env = DefaultEnvironment()
+sys.path.insert(0, os.path.join(env.subst("$PROJECT_DIR"), "tools"))
+import log_decode
+
+
+def extract_log_table(source, target, env):
+    elf = str(target[0])
+    output = os.path.join(env.subst("$BUILD_DIR"), "logfmt.json")
+    count = log_decode.write_table(elf, output)
+    print(f"⮕ Log string table: {count} strings -> {output}")
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", extract_log_table)
@@ -0,0 +1,9 @@
+# project/tools/native_fuzz.py
+# native-fuzz 环境：改用clang编译，链接libFuzzer和AddressSanitizer（GCC没有libFuzzer）
+from SCons.Script import DefaultEnvironment
+
+env = DefaultEnvironment()
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+
+SANITIZE = ["-fsanitize=fuzzer,address,undefined"]
+env.Append(CCFLAGS=SANITIZE, LINKFLAGS=SANITIZE)
@@ -0,0 +1,324 @@
+# project/tools/splash_pack.py
+"""
+启动画面打包：生成压缩的RGB565启动图 src/SplashData.h
+
+压缩格式是按RGB565改写的QOI（逐像素流式解码，状态只有前一像素和64项颜色表，
+BootSplash可以逐条带解码后直接交给显示总线，不需要整帧缓冲）：
+  0b00iiiiii          INDEX  颜色表第i项
+  0b01rrggbb          DIFF   各通道差值-2~1（模通道位宽回绕）
+  0b10gggggg drrrdbbb LUMA   绿差dg -32~31；红/蓝差减去dg>>1后为-8~7（第二字节高/低4位，偏移8）
+  0b11rrrrrr          RUN    重复前一像素1~62次（存储值0~61）
+  0xFE hi lo          RGB    原样RGB565（大端）
+颜色表槽位 = (r*3 + g*5 + b*7) & 63（r/g/b为565各通道值），初始前一像素为0x0000。
+
+图像来源：
+  - 环境变量 SPLASH_IMAGE 指定的图片（二进制PPM或8位RGB/RGBA非隔行PNG），居中放到屏幕大小，
+    四周用左上角像素的颜色填充
+  - 否则生成默认画面：左侧爪印，右侧"PawCounter"（字体同 font_bake.py，找不到时只画爪印）
+
+生成的头文件随仓库提交；构建时作为 pre 脚本运行，脚本比生成文件新或指定了 SPLASH_IMAGE 时重新生成。
+
+用法：
+    python tools/splash_pack.py [图片.ppm|图片.png]
+"""
+import math
+import os
+import re
+import struct
+import sys
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import font_bake  # noqa: E402
+
+OP_INDEX = 0x00
+OP_DIFF = 0x40
+OP_LUMA = 0x80
+OP_RUN = 0xC0
+OP_RGB = 0xFE
+MAX_RUN = 62
+
+BACKGROUND = (0, 0, 0)
+PAW_COLOR = (255, 166, 0)
+TITLE_COLOR = (255, 255, 255)
+TITLE = "PawCounter"
+
+
+def split565(p):
+    return (p >> 11) & 0x1F, (p >> 5) & 0x3F, p & 0x1F
+
+
+def hash565(p):
+    r, g, b = split565(p)
+    return (r * 3 + g * 5 + b * 7) & 63
+
+
+def wrap(value, bits):
+    """把差值回绕到 [-2^(bits-1), 2^(bits-1))"""
+    half = 1 << (bits - 1)
+    return ((value + half) & ((1 << bits) - 1)) - half
+
+
+def encode(pixels):
+    out = bytearray()
+    index = [0] * 64
+    prev = 0
+    run = 0
+    for p in pixels:
+        if p == prev:
+            run += 1
+            if run == MAX_RUN:
+                out.append(OP_RUN | (run - 1))
+                run = 0
+            continue
+        if run:
+            out.append(OP_RUN | (run - 1))
+            run = 0
+
+        slot = hash565(p)
+        if index[slot] == p:
+            out.append(OP_INDEX | slot)
+        else:
+            index[slot] = p
+            r, g, b = split565(p)
+            pr, pg, pb = split565(prev)
+            dr, dg, db = wrap(r - pr, 5), wrap(g - pg, 6), wrap(b - pb, 5)
+            dr_dg, db_dg = wrap(dr - (dg >> 1), 5), wrap(db - (dg >> 1), 5)
+            if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                out.append(OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))
+            elif -8 <= dr_dg <= 7 and -8 <= db_dg <= 7:
+                out.append(OP_LUMA | (dg + 32))
+                out.append(((dr_dg + 8) << 4) | (db_dg + 8))
+            else:
+                out.extend((OP_RGB, p >> 8, p & 0xFF))
+        prev = p
+    if run:
+        out.append(OP_RUN | (run - 1))
+    return bytes(out)
+
+
+def decode(data, count):
+    """与 BootSplash.cpp 的解码器一致，用于打包后自检"""
+    index = [0] * 64
+    prev = 0
+    pos = 0
+    pixels = []
+    while len(pixels) < count:
+        op = data[pos]
+        pos += 1
+        if op == OP_RGB:
+            prev = (data[pos] << 8) | data[pos + 1]
+            pos += 2
+        elif (op & 0xC0) == OP_INDEX:
+            prev = index[op & 63]
+            pixels.append(prev)
+            continue
+        elif (op & 0xC0) == OP_DIFF:
+            r, g, b = split565(prev)
+            r = (r + ((op >> 4) & 3) - 2) & 0x1F
+            g = (g + ((op >> 2) & 3) - 2) & 0x3F
+            b = (b + (op & 3) - 2) & 0x1F
+            prev = (r << 11) | (g << 5) | b
+        elif (op & 0xC0) == OP_LUMA:
+            dg = (op & 0x3F) - 32
+            extra = data[pos]
+            pos += 1
+            r, g, b = split565(prev)
+            r = (r + (dg >> 1) + (extra >> 4) - 8) & 0x1F
+            g = (g + dg) & 0x3F
+            b = (b + (dg >> 1) + (extra & 0x0F) - 8) & 0x1F
+            prev = (r << 11) | (g << 5) | b
+        else:
+            pixels.extend([prev] * ((op & 0x3F) + 1))
+            continue
+        index[hash565(prev)] = prev
+        pixels.append(prev)
+    return pixels
+
+
+def to565(rgb):
+    r, g, b = rgb
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+
+
+def mix(bg, fg, coverage):
+    return tuple((f * coverage + b * (15 - coverage) + 7) // 15 for f, b in zip(fg, bg))
+
+
+def read_ppm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    fields = re.match(rb"P6\s+(?:#.*\s+)*(\d+)\s+(\d+)\s+(\d+)\s", data)
+    if not fields or int(fields.group(3)) != 255:
+        raise ValueError("只支持8位二进制PPM（P6）")
+    width, height = int(fields.group(1)), int(fields.group(2))
+    raw = data[fields.end():]
+    return width, height, [tuple(raw[i:i + 3]) for i in range(0, width * height * 3, 3)]
+
+
+def read_png(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("不是PNG文件")
+    pos, idat = 8, b""
+    while pos < len(data):
+        length, tag = struct.unpack_from(">I4s", data, pos)
+        body = data[pos + 8:pos + 8 + length]
+        if tag == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", body)
+            if depth != 8 or color not in (2, 6) or interlace:
+                raise ValueError("只支持8位RGB/RGBA非隔行PNG")
+            channels = 3 if color == 2 else 4
+        elif tag == b"IDAT":
+            idat += body
+        pos += 12 + length
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    prev = bytearray(stride)
+    pixels = []
+    for y in range(height):
+        kind = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            left = line[i - channels] if i >= channels else 0
+            up = prev[i]
+            corner = prev[i - channels] if i >= channels else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + ((left + up) >> 1)) & 0xFF
+            elif kind == 4:
+                p = left + up - corner
+                pa, pb, pc = abs(p - left), abs(p - up), abs(p - corner)
+                pred = left if pa <= pb and pa <= pc else (up if pb <= pc else corner)
+                line[i] = (line[i] + pred) & 0xFF
+        pixels.extend(tuple(line[i:i + 3]) for i in range(0, stride, channels))
+        prev = line
+    return width, height, pixels
+
+
+def load_image(path, width, height):
+    w, h, src = (read_png if path.lower().endswith(".png") else read_ppm)(path)
+    fill = src[0]
+    image = [fill] * (width * height)
+    ox, oy = (width - w) // 2, (height - h) // 2
+    for y in range(max(0, -oy), min(h, height - oy)):
+        for x in range(max(0, -ox), min(w, width - ox)):
+            image[(y + oy) * width + x + ox] = src[y * w + x]
+    return image
+
+
+def ellipse(cx, cy, rx, ry, steps=40):
+    return [(cx + rx * math.cos(2 * math.pi * k / steps), cy + ry * math.sin(2 * math.pi * k / steps))
+            for k in range(steps)]
+
+
+def default_image(width, height):
+    image = [BACKGROUND] * (width * height)
+
+    def paint(polys, color):
+        coverage = font_bake.rasterize(polys, width, height)
+        for y, row in enumerate(coverage):
+            for x, c in enumerate(row):
+                if c:
+                    image[y * width + x] = mix(image[y * width + x], color, c)
+
+    # 标题按字体排好，与爪印一起水平居中
+    unit = height / 135.0
+    cy = height * 0.5
+    title, title_width = [], 0.0
+    font_path = font_bake.find_font()
+    if font_path:
+        font = font_bake.TrueTypeFont(font_path, TITLE)
+        cap = max(y for contour in font.contours(font.cmap["P"]) for _, y, _ in contour)
+        scale = 36 * unit / float(cap)
+        for ch in TITLE:
+            glyph = font.cmap.get(ch, 0)
+            title.append((title_width, [[(px * scale, -py * scale) for px, py in font_bake.flatten(contour)]
+                                        for contour in font.contours(glyph)]))
+            title_width += font.advance(glyph) * scale
+    paw_width = 86 * unit
+    gap = 24 * unit if title else 0
+    cx = (width - paw_width - gap - title_width) / 2.0 + paw_width / 2.0
+
+    # 爪印：掌垫加四个趾垫
+    paint([ellipse(cx, cy + 18 * unit, 30 * unit, 24 * unit),
+           ellipse(cx - 33 * unit, cy - 10 * unit, 10 * unit, 13 * unit),
+           ellipse(cx - 12 * unit, cy - 30 * unit, 10 * unit, 14 * unit),
+           ellipse(cx + 12 * unit, cy - 30 * unit, 10 * unit, 14 * unit),
+           ellipse(cx + 33 * unit, cy - 10 * unit, 10 * unit, 13 * unit)], PAW_COLOR)
+
+    if title:
+        left = cx + paw_width / 2.0 + gap
+        baseline = cy + 18 * unit
+        paint([[(left + x + px, baseline + py) for px, py in poly] for x, polys in title for poly in polys],
+              TITLE_COLOR)
+    return image, font_path
+
+
+def display_size(project_dir):
+    with open(os.path.join(project_dir, "src", "config.h"), encoding="utf-8") as f:
+        text = f.read()
+    width = int(re.search(r"#define DISPLAY_WIDTH (\d+)", text).group(1))
+    height = int(re.search(r"#define DISPLAY_HEIGHT (\d+)", text).group(1))
+    return width, height
+
+
+def write_header(output, source, width, height, data):
+    lines = [
+        "// 由 tools/splash_pack.py 生成，不要手工修改",
+        "// 来源: %s" % source,
+        "// %dx%d RGB565，QOI565压缩 %d 字节（原始 %d 字节）" % (width, height, len(data), width * height * 2),
+        "",
+        "#ifndef SPLASH_DATA_H",
+        "#define SPLASH_DATA_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "static const uint16_t SPLASH_WIDTH = %d;" % width,
+        "static const uint16_t SPLASH_HEIGHT = %d;" % height,
+        "static const uint32_t SPLASH_DATA_SIZE = %d;" % len(data),
+        "",
+        "static const uint8_t SPLASH_DATA[%d] = {" % len(data),
+    ]
+    for i in range(0, len(data), 24):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 24]) + ",")
+    lines += ["};", "", "#endif // SPLASH_DATA_H", ""]
+    with open(output, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+def pack(project_dir, explicit=None, force=False):
+    output = os.path.join(project_dir, "src", "SplashData.h")
+    image_path = explicit or os.environ.get("SPLASH_IMAGE")
+    if not force and not image_path and os.path.isfile(output) and \
+            os.path.getmtime(output) >= os.path.getmtime(__file__):
+        return
+
+    width, height = display_size(project_dir)
+    if image_path:
+        image = load_image(image_path, width, height)
+        source = os.path.basename(image_path)
+    else:
+        image, font_path = default_image(width, height)
+        source = "默认画面（字体: %s）" % (os.path.basename(font_path) if font_path else "无")
+    pixels = [to565(rgb) for rgb in image]
+    data = encode(pixels)
+    if decode(data, len(pixels)) != pixels:
+        raise ValueError("启动画面编码自检失败")
+    write_header(output, source, width, height, data)
+    print("⮕ splash_pack: %s -> %s (%d 字节)" % (source, output, len(data)))
+
+
+if __name__ == "__main__":
+    pack(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+         sys.argv[1] if len(sys.argv) > 1 else None, force=True)
+elif __name__ != "splash_pack":
+    from SCons.Script import DefaultEnvironment
+
+    env = DefaultEnvironment()
+    pack(env.subst("$PROJECT_DIR"))